@@ -1003,6 +1003,13 @@ parser.add_argument('--v8-enable-snapshot-compression',
     default=None,
     help='Enable the built-in snapshot compression in V8.')
 
+parser.add_argument('--compress-builtins',
+    action='store_true',
+    dest='compress_builtins',
+    default=None,
+    help='store the sources of the builtin modules compressed with zstd in '
+         'the binary, they are decompressed when first needed')
+
 parser.add_argument('--node-builtin-modules-path',
     action='store',
     dest='node_builtin_modules_path',
@@ -1516,6 +1523,8 @@ def configure_node(o):
     o['variables']['node_use_node_code_cache'] = b(
       not cross_compiling and not options.shared)
 
+  o['variables']['node_compress_builtins'] = b(options.compress_builtins)
+
   if options.write_snapshot_as_array_literals is not None:
      o['variables']['node_write_snapshot_as_array_literals'] = b(options.write_snapshot_as_array_literals)
   else:
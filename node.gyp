@@ -33,6 +33,7 @@
     'node_lib_target_name%': 'libnode',
     'node_intermediate_lib_type%': 'static_library',
     'node_builtin_modules_path%': '',
+    'node_compress_builtins%': 'false',
     'linked_module_files': [
     ],
     # We list the deps/ files out instead of globbing them in js2c.cc since we
@@ -86,6 +87,7 @@
       'src/fs_event_wrap.cc',
       'src/handle_wrap.cc',
       'src/heap_utils.cc',
+      'src/hex_encoding.cc',
       'src/histogram.cc',
       'src/internal_only_v8.cc',
       'src/js_native_api.h',
@@ -98,9 +100,11 @@
       'src/js_udp_wrap.cc',
       'src/json_parser.h',
       'src/json_parser.cc',
+      'src/loop_metrics.cc',
       'src/module_wrap.cc',
       'src/node.cc',
       'src/node_api.cc',
+      'src/node_auto_tune.cc',
       'src/node_binding.cc',
       'src/node_blob.cc',
       'src/node_buffer.cc',
@@ -124,6 +128,7 @@
       'src/node_messaging.cc',
       'src/node_metadata.cc',
       'src/node_modules.cc',
+      'src/node_numa.cc',
       'src/node_options.cc',
       'src/node_os.cc',
       'src/node_perf.cc',
@@ -139,8 +144,11 @@
       'src/node_sea.cc',
       'src/node_serdes.cc',
       'src/node_shadow_realm.cc',
+      'src/node_shm.cc',
       'src/node_snapshotable.cc',
       'src/node_sockaddr.cc',
+      'src/node_source_map.cc',
+      'src/node_startup_profile.cc',
       'src/node_stat_watcher.cc',
       'src/node_symbols.cc',
       'src/node_task_queue.cc',
@@ -172,12 +180,15 @@
       'src/stream_wrap.cc',
       'src/string_bytes.cc',
       'src/string_decoder.cc',
+      'src/string_search.cc',
       'src/tcp_wrap.cc',
+      'src/threadpoolwork.cc',
       'src/timers.cc',
       'src/timer_wrap.cc',
       'src/tracing/agent.cc',
       'src/tracing/node_trace_buffer.cc',
       'src/tracing/node_trace_writer.cc',
+      'src/tracing/perfetto_trace_writer.cc',
       'src/tracing/trace_event.cc',
       'src/tracing/traced_value.cc',
       'src/tty_wrap.cc',
@@ -214,18 +225,21 @@
       'src/env.h',
       'src/env-inl.h',
       'src/handle_wrap.h',
+      'src/hex_encoding.h',
       'src/histogram.h',
       'src/histogram-inl.h',
       'src/js_stream.h',
       'src/json_utils.h',
       'src/large_pages/node_large_page.cc',
       'src/large_pages/node_large_page.h',
+      'src/loop_metrics.h',
       'src/memory_tracker.h',
       'src/memory_tracker-inl.h',
       'src/module_wrap.h',
       'src/node.h',
       'src/node_api.h',
       'src/node_api_types.h',
+      'src/node_auto_tune.h',
       'src/node_binding.h',
       'src/node_blob.h',
       'src/node_buffer.h',
@@ -255,6 +269,7 @@
       'src/node_metadata.h',
       'src/node_mutex.h',
       'src/node_modules.h',
+      'src/node_numa.h',
       'src/node_object_wrap.h',
       'src/node_options.h',
       'src/node_options-inl.h',
@@ -274,6 +289,8 @@
       'src/node_snapshot_builder.h',
       'src/node_sockaddr.h',
       'src/node_sockaddr-inl.h',
+      'src/node_source_map.h',
+      'src/node_startup_profile.h',
       'src/node_stat_watcher.h',
       'src/node_union_bytes.h',
       'src/node_url.h',
@@ -302,11 +319,15 @@
       'src/string_bytes.h',
       'src/string_decoder.h',
       'src/string_decoder-inl.h',
+      'src/string_search.h',
       'src/tcp_wrap.h',
+      'src/threadpoolwork.h',
+      'src/threadpoolwork-inl.h',
       'src/timers.h',
       'src/tracing/agent.h',
       'src/tracing/node_trace_buffer.h',
       'src/tracing/node_trace_writer.h',
+      'src/tracing/perfetto_trace_writer.h',
       'src/tracing/trace_event.h',
       'src/tracing/trace_event_common.h',
       'src/tracing/traced_value.h',
@@ -379,6 +400,7 @@
       'src/quic/logstream.cc',
       'src/quic/packet.cc',
       'src/quic/preferredaddress.cc',
+      'src/quic/routing.cc',
       'src/quic/session.cc',
       'src/quic/sessionticket.cc',
       'src/quic/streams.cc',
@@ -394,6 +416,7 @@
       'src/quic/logstream.h',
       'src/quic/packet.h',
       'src/quic/preferredaddress.h',
+      'src/quic/routing.h',
       'src/quic/session.h',
       'src/quic/sessionticket.h',
       'src/quic/streams.h',
@@ -402,12 +425,26 @@
       'src/quic/transportparams.h',
       'src/quic/quic.cc',
     ],
+    'node_microbench_sources': [
+      'test/microbench/bench_blocklist.cc',
+      'test/microbench/bench_fs_permission.cc',
+      'test/microbench/bench_http_parser.cc',
+      'test/microbench/bench_node_bio.cc',
+      'test/microbench/bench_string_bytes.cc',
+      'test/microbench/microbench.h',
+      'test/microbench/microbench_main.cc',
+    ],
     'node_cctest_openssl_sources': [
       'test/cctest/test_crypto_clienthello.cc',
+      'test/cctest/test_crypto_ktls.cc',
+      'test/cctest/test_crypto_random.cc',
+      'test/cctest/test_crypto_scrypt.cc',
+      'test/cctest/test_crypto_x509.cc',
       'test/cctest/test_node_crypto.cc',
       'test/cctest/test_node_crypto_env.cc',
       'test/cctest/test_quic_cid.cc',
       'test/cctest/test_quic_error.cc',
+      'test/cctest/test_quic_http3.cc',
       'test/cctest/test_quic_tokens.cc',
     ],
     'node_cctest_inspector_sources': [
@@ -1254,6 +1291,74 @@
       ],
     }, # cctest
 
+    {
+      'target_name': 'node_microbench',
+      'type': 'executable',
+
+      'dependencies': [
+        '<(node_lib_target_name)',
+        'deps/histogram/histogram.gyp:histogram',
+        'deps/nbytes/nbytes.gyp:nbytes',
+        'tools/v8_gypfiles/abseil.gyp:abseil',
+      ],
+
+      'includes': [
+        'node.gypi'
+      ],
+
+      'include_dirs': [
+        'src',
+        'tools/msvs/genfiles',
+        'deps/v8/include',
+        'deps/cares/include',
+        'deps/uv/include',
+        'deps/llhttp/include',
+        'test/microbench',
+      ],
+
+      'defines': [
+        'NODE_ARCH="<(target_arch)"',
+        'NODE_PLATFORM="<(OS)"',
+        'NODE_WANT_INTERNALS=1',
+      ],
+
+      'sources': [
+        'src/node_snapshot_stub.cc',
+        '<@(node_microbench_sources)',
+      ],
+
+      'conditions': [
+        [ 'node_use_openssl=="true"', {
+          'defines': [
+            'HAVE_OPENSSL=1',
+          ],
+          'dependencies': [
+            'deps/ncrypto/ncrypto.gyp:ncrypto',
+          ],
+        }],
+        # Like cctest, skip it while building shared lib node for Windows.
+        [ 'OS=="win" and node_shared=="true"', {
+          'type': 'none',
+        }],
+        [ 'node_shared=="true"', {
+          'xcode_settings': {
+            'OTHER_LDFLAGS': [ '-Wl,-rpath,@loader_path', ],
+          },
+        }],
+        ['OS=="win"', {
+          'libraries': [
+            'Dbghelp.lib',
+            'winmm.lib',
+            'Ws2_32.lib',
+          ],
+        }],
+        # Avoid excessive LTO
+        ['enable_lto=="true"', {
+          'ldflags': [ '-fno-lto' ],
+        }],
+      ],
+    }, # node_microbench
+
     {
       'target_name': 'embedtest',
       'type': 'executable',
@@ -1355,6 +1460,14 @@
         [ 'OS in "linux mac"', {
           'defines': ['NODE_JS2C_USE_STRING_LITERALS'],
         }],
+        [ 'node_compress_builtins=="true"', {
+          'defines': ['NODE_JS2C_COMPRESS'],
+          'conditions': [
+            [ 'node_shared_zstd=="false"', {
+              'dependencies': [ 'deps/zstd/zstd.gyp:zstd#host' ],
+            }],
+          ],
+        }],
         [ 'debug_node=="true"', {
           'cflags!': [ '-O3' ],
           'cflags': [ '-g', '-O0' ],
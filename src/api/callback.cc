@@ -81,8 +81,11 @@ InternalCallbackScope::InternalCallbackScope(Environment* env,
 
   isolate->SetIdle(false);
 
-  prior_context_frame_.Reset(
-      isolate, async_context_frame::exchange(isolate, context_frame));
+  if (env->options()->async_context_frame) {
+    Local<Value> prior = async_context_frame::exchange(isolate, context_frame);
+    if (!prior->IsUndefined()) prior_context_frame_.Reset(isolate, prior);
+    swapped_context_frame_ = true;
+  }
 
   env->async_hooks()->push_async_context(
     async_context_.async_id, async_context_.trigger_async_id, object);
@@ -128,7 +131,12 @@ void InternalCallbackScope::Close() {
   if (pushed_ids_) {
     env_->async_hooks()->pop_async_context(async_context_.async_id);
 
-    async_context_frame::exchange(isolate, prior_context_frame_.Get(isolate));
+    if (swapped_context_frame_) {
+      async_context_frame::set(isolate,
+                               prior_context_frame_.IsEmpty()
+                                   ? Undefined(isolate).As<Value>()
+                                   : prior_context_frame_.Get(isolate));
+    }
   }
 
   if (failed_) return;
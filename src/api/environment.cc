@@ -1,6 +1,8 @@
 #include <cstdlib>
 #include "env_properties.h"
+#include "large_pages/node_large_page.h"
 #include "node.h"
+#include "node_auto_tune.h"
 #include "node_builtins.h"
 #include "node_context_data.h"
 #include "node_errors.h"
@@ -106,12 +108,104 @@ MaybeLocal<Value> PrepareStackTraceCallback(Local<Context> context,
   return result;
 }
 
+NodeArrayBufferAllocator::NodeArrayBufferAllocator()
+    : pool_limit_(static_cast<size_t>(
+          per_process::cli_options->array_buffer_pool_size) *
+                  1024 * 1024),
+      huge_pages_(per_process::cli_options->array_buffer_huge_pages) {}
+
+NodeArrayBufferAllocator::~NodeArrayBufferAllocator() {
+  ReleasePooledMemory();
+}
+
+// Size class 0 is kMinPooledSize itself. Every following power of two is
+// split into four classes, e.g. 20, 24, 28 and 32 KiB, up to kMaxPooledSize.
+size_t NodeArrayBufferAllocator::GetSizeClass(size_t size) {
+  DCHECK(size >= kMinPooledSize && size <= kMaxPooledSize);
+  if (size == kMinPooledSize) return 0;
+  size_t v = size - 1;
+  size_t msb = 0;
+  while ((v >> (msb + 1)) != 0) msb++;
+  size_t doubling = msb - 14;  // kMinPooledSize is 2^14.
+  size_t quarter = (v >> (msb - 2)) & 3;
+  return doubling * 4 + quarter + 1;
+}
+
+size_t NodeArrayBufferAllocator::GetSizeClassSize(size_t size_class) {
+  DCHECK_LT(size_class, kSizeClassCount);
+  if (size_class == 0) return kMinPooledSize;
+  size_t i = size_class - 1;
+  return (5 + i % 4) << (12 + i / 4);
+}
+
+void* NodeArrayBufferAllocator::AllocatePooled(size_t size, bool zero_fill) {
+  size_t size_class = GetSizeClass(size);
+  size_t block_size = GetSizeClassSize(size_class);
+  void* ret = nullptr;
+  {
+    SizeClass& cls = size_classes_[size_class];
+    Mutex::ScopedLock lock(cls.mutex);
+    if (!cls.blocks.empty()) {
+      ret = cls.blocks.back();
+      cls.blocks.pop_back();
+    }
+  }
+  if (ret != nullptr) {
+    pooled_bytes_.fetch_sub(block_size, std::memory_order_relaxed);
+    if (zero_fill) memset(ret, 0, size);
+    return ret;
+  }
+  // Always allocate the whole class so that the block can be reused by any
+  // other allocation of the same class later on.
+  return zero_fill ? allocator_->Allocate(block_size)
+                   : allocator_->AllocateUninitialized(block_size);
+}
+
+void NodeArrayBufferAllocator::FreePooled(void* data, size_t size) {
+  size_t size_class = GetSizeClass(size);
+  size_t block_size = GetSizeClassSize(size_class);
+  size_t pooled = pooled_bytes_.fetch_add(block_size,
+                                          std::memory_order_relaxed);
+  if (pooled + block_size <= pool_limit_) {
+    SizeClass& cls = size_classes_[size_class];
+    Mutex::ScopedLock lock(cls.mutex);
+    cls.blocks.push_back(data);
+    return;
+  }
+  pooled_bytes_.fetch_sub(block_size, std::memory_order_relaxed);
+  allocator_->Free(data, block_size);
+}
+
+void NodeArrayBufferAllocator::ReleasePooledMemory() {
+  for (size_t i = 0; i < kSizeClassCount; i++) {
+    std::vector<void*> blocks;
+    {
+      Mutex::ScopedLock lock(size_classes_[i].mutex);
+      blocks.swap(size_classes_[i].blocks);
+    }
+    size_t block_size = GetSizeClassSize(i);
+    for (void* block : blocks) allocator_->Free(block, block_size);
+    pooled_bytes_.fetch_sub(blocks.size() * block_size,
+                            std::memory_order_relaxed);
+  }
+}
+
+void* NodeArrayBufferAllocator::MaybeAdviseHugePages(void* data,
+                                                     size_t size) const {
+  if (huge_pages_ && size >= kMinHugePageSize) AdviseHugePages(data, size);
+  return data;
+}
+
 void* NodeArrayBufferAllocator::Allocate(size_t size) {
   void* ret;
-  if (zero_fill_field_ || per_process::cli_options->zero_fill_all_buffers)
-    ret = allocator_->Allocate(size);
+  bool zero_fill =
+      zero_fill_field_ || per_process::cli_options->zero_fill_all_buffers;
+  if (IsPooledSize(size))
+    ret = AllocatePooled(size, zero_fill);
+  else if (zero_fill)
+    ret = MaybeAdviseHugePages(allocator_->Allocate(size), size);
   else
-    ret = allocator_->AllocateUninitialized(size);
+    ret = MaybeAdviseHugePages(allocator_->AllocateUninitialized(size), size);
   if (ret != nullptr) [[likely]] {
     total_mem_usage_.fetch_add(size, std::memory_order_relaxed);
   }
@@ -119,7 +213,10 @@ void* NodeArrayBufferAllocator::Allocate(size_t size) {
 }
 
 void* NodeArrayBufferAllocator::AllocateUninitialized(size_t size) {
-  void* ret = allocator_->AllocateUninitialized(size);
+  void* ret = IsPooledSize(size) ? AllocatePooled(size, false)
+                                 : MaybeAdviseHugePages(
+                                       allocator_->AllocateUninitialized(size),
+                                       size);
   if (ret != nullptr) [[likely]] {
     total_mem_usage_.fetch_add(size, std::memory_order_relaxed);
   }
@@ -128,6 +225,10 @@ void* NodeArrayBufferAllocator::AllocateUninitialized(size_t size) {
 
 void NodeArrayBufferAllocator::Free(void* data, size_t size) {
   total_mem_usage_.fetch_sub(size, std::memory_order_relaxed);
+  if (IsPooledSize(size) && data != nullptr) {
+    FreePooled(data, size);
+    return;
+  }
   allocator_->Free(data, size);
 }
 
@@ -212,7 +313,10 @@ void SetIsolateCreateParamsForNode(Isolate::CreateParams* params) {
     // V8 defaults to 700MB or 1.4GB on 32 and 64 bit platforms respectively.
     // This default is based on browser use-cases. Tell V8 to configure the
     // heap based on the actual physical memory.
-    params->constraints.ConfigureDefaults(total_memory, 0);
+    if (!auto_tune::IsEnabled() ||
+        !auto_tune::ConfigureHeap(&params->constraints)) {
+      params->constraints.ConfigureDefaults(total_memory, 0);
+    }
   }
   params->embedder_wrapper_object_index = BaseObject::InternalFields::kSlot;
   params->embedder_wrapper_type_index = std::numeric_limits<int>::max();
@@ -337,8 +441,13 @@ Isolate* NewIsolate(Isolate::CreateParams* params,
     params->cpp_heap = settings.cpp_heap;
   }
 
+  const bool auto_tune_heap =
+      auto_tune::IsEnabled() &&
+      params->constraints.max_old_generation_size_in_bytes() == 0 &&
+      uv_get_constrained_memory() > 0;
   SetIsolateCreateParamsForNode(params);
   Isolate::Initialize(isolate, *params);
+  if (auto_tune_heap) auto_tune::SetUpIsolate(isolate);
 
   Isolate::Scope isolate_scope(isolate);
 
@@ -15,6 +15,7 @@ using v8::Isolate;
 using v8::Local;
 using v8::Object;
 using v8::String;
+using v8::Undefined;
 using v8::Value;
 
 namespace node {
@@ -25,12 +26,16 @@ namespace async_context_frame {
 //
 Scope::Scope(Isolate* isolate, Local<Value> object) : isolate_(isolate) {
   auto prior = exchange(isolate, object);
-  prior_.Reset(isolate, prior);
+  // Avoid creating a persistent handle for the empty frame.
+  if (!prior->IsUndefined()) prior_.Reset(isolate, prior);
 }
 
 Scope::~Scope() {
-  auto value = prior_.Get(isolate_);
-  set(isolate_, value);
+  if (prior_.IsEmpty()) {
+    set(isolate_, Undefined(isolate_));
+  } else {
+    set(isolate_, prior_.Get(isolate_));
+  }
 }
 
 Local<Value> current(Isolate* isolate) {
@@ -36,6 +36,10 @@ inline AsyncWrap::ProviderType AsyncWrap::provider_type() const {
 
 inline AsyncWrap::ProviderType AsyncWrap::set_provider_type(
     AsyncWrap::ProviderType provider) {
+  if (provider_type_ != PROVIDER_NONE)
+    env()->async_hooks()->IncrementProviderDestroyed(provider_type_);
+  if (provider != PROVIDER_NONE)
+    env()->async_hooks()->IncrementProviderCreated(provider);
   provider_type_ = provider;
   return provider_type_;
 }
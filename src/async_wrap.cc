@@ -416,6 +416,12 @@ void AsyncWrap::CreatePerContextProperties(Local<Object> target,
                          "async_id_fields",
                          env->async_hooks()->async_id_fields().GetJSArray());
 
+  // Per-provider counts of created and destroyed resources, see
+  // AsyncHooks::provider_counts().
+  FORCE_SET_TARGET_FIELD(target,
+                         "async_provider_counts",
+                         env->async_hooks()->provider_counts().GetJSArray());
+
   FORCE_SET_TARGET_FIELD(target,
                          "execution_async_resources",
                          env->async_hooks()->js_execution_async_resources());
@@ -490,7 +496,7 @@ AsyncWrap::AsyncWrap(Environment* env,
                      double execution_async_id)
     : AsyncWrap(env, object) {
   CHECK_NE(provider, PROVIDER_NONE);
-  provider_type_ = provider;
+  set_provider_type(provider);
 
   // Use AsyncReset() call to execute the init() callbacks.
   AsyncReset(object, execution_async_id);
@@ -530,6 +536,8 @@ bool AsyncWrap::IsDoneInitializing() const {
 AsyncWrap::~AsyncWrap() {
   EmitTraceEventDestroy();
   EmitDestroy(true /* from gc */);
+  if (provider_type_ != PROVIDER_NONE)
+    env()->async_hooks()->IncrementProviderDestroyed(provider_type_);
 }
 
 void AsyncWrap::EmitTraceEventDestroy() {
@@ -604,7 +612,7 @@ void AsyncWrap::AsyncReset(Local<Object> resource, double execution_async_id) {
   switch (provider_type()) {
 #define V(PROVIDER)                                                           \
     case PROVIDER_ ## PROVIDER:                                               \
-      if (*TRACE_EVENT_API_GET_CATEGORY_GROUP_ENABLED(                        \
+      if (TRACE_EVENT_CATEGORY_ENABLED(                                       \
           TRACING_CATEGORY_NODE1(async_hooks))) {                             \
         auto data = tracing::TracedValue::Create();                           \
         data->SetInteger("executionAsyncId",                                  \
@@ -666,6 +674,8 @@ MaybeLocal<Value> AsyncWrap::MakeCallback(const Local<Function> cb,
 
   ProviderType provider = provider_type();
   async_context context { get_async_id(), get_trigger_async_id() };
+  EventLoopMetrics::CallbackScope metrics_scope(env()->event_loop_metrics(),
+                                                provider);
   MaybeLocal<Value> ret =
       InternalMakeCallback(env(),
                            object(),
@@ -73,6 +73,7 @@ namespace node {
   V(TCPCONNECTWRAP)                                                            \
   V(TCPSERVERWRAP)                                                             \
   V(TCPWRAP)                                                                   \
+  V(TIMERWHEEL)                                                                \
   V(TTYWRAP)                                                                   \
   V(UDPSENDWRAP)                                                               \
   V(UDPWRAP)                                                                   \
@@ -21,6 +21,7 @@ namespace node {
   V(modules_binding_data, modules::BindingData)
 
 #define UNSERIALIZABLE_BINDING_TYPES(V)                                        \
+  V(crypto_random_binding_data, crypto::RandomPool)                            \
   V(http2_binding_data, http2::BindingData)                                    \
   V(http_parser_binding_data, http_parser::BindingData)                        \
   V(quic_binding_data, quic::BindingData)
@@ -791,10 +791,12 @@ ChannelWrap::ChannelWrap(
       Environment* env,
       Local<Object> object,
       int timeout,
-      int tries)
+      int tries,
+      int64_t max_cache_ttl)
     : AsyncWrap(env, object, PROVIDER_DNSCHANNEL),
       timeout_(timeout),
-      tries_(tries) {
+      tries_(tries),
+      max_cache_ttl_(max_cache_ttl) {
   MakeWeak();
 
   Setup();
@@ -808,13 +810,20 @@ void ChannelWrap::MemoryInfo(MemoryTracker* tracker) const {
 
 void ChannelWrap::New(const FunctionCallbackInfo<Value>& args) {
   CHECK(args.IsConstructCall());
-  CHECK_EQ(args.Length(), 2);
+  CHECK_GE(args.Length(), 2);  // timeout, tries, [maxCacheTtl]
   CHECK(args[0]->IsInt32());
   CHECK(args[1]->IsInt32());
   const int timeout = args[0].As<Int32>()->Value();
   const int tries = args[1].As<Int32>()->Value();
+  int64_t max_cache_ttl;
+  if (args[2]->IsUint32()) {
+    max_cache_ttl = args[2].As<Uint32>()->Value();
+  } else {
+    Mutex::ScopedLock lock(per_process::cli_options_mutex);
+    max_cache_ttl = per_process::cli_options->dns_cache_max_ttl;
+  }
   Environment* env = Environment::GetCurrent(args);
-  new ChannelWrap(env, args.This(), timeout, tries);
+  new ChannelWrap(env, args.This(), timeout, tries, max_cache_ttl);
 }
 
 GetAddrInfoReqWrap::GetAddrInfoReqWrap(Environment* env,
@@ -858,6 +867,16 @@ NodeAresTask* NodeAresTask::Create(ChannelWrap* channel, ares_socket_t sock) {
   return task;
 }
 
+int SetQueryCacheOptions(ares_options* options, int64_t max_cache_ttl) {
+  // c-ares enables its query cache by default, which is kept unless the TTL
+  // has been set explicitly.
+  if (max_cache_ttl < 0) return 0;
+  // The c-ares query cache honors the TTL of the answer records, bounded by
+  // qcache_max_ttl, and caches negative answers for the SOA minimum TTL.
+  options->qcache_max_ttl = static_cast<unsigned int>(max_cache_ttl);
+  return ARES_OPT_QUERY_CACHE;
+}
+
 void ChannelWrap::Setup() {
   struct ares_options options;
   memset(&options, 0, sizeof(options));
@@ -866,7 +885,6 @@ void ChannelWrap::Setup() {
   options.sock_state_cb_data = this;
   options.timeout = timeout_;
   options.tries = tries_;
-  options.qcache_max_ttl = 0;
 
   int r;
   if (!library_inited_) {
@@ -880,8 +898,8 @@ void ChannelWrap::Setup() {
 
   /* We do the call to ares_init_option for caller. */
   const int optmask =
-      ARES_OPT_FLAGS | ARES_OPT_TIMEOUTMS |
-      ARES_OPT_SOCK_STATE_CB | ARES_OPT_TRIES;
+      ARES_OPT_FLAGS | ARES_OPT_TIMEOUTMS | ARES_OPT_SOCK_STATE_CB |
+      ARES_OPT_TRIES | SetQueryCacheOptions(&options, max_cache_ttl_);
   r = ares_init_options(&channel_, &options, optmask);
 
   if (r != ARES_SUCCESS) {
@@ -1689,10 +1707,144 @@ static void Query(const FunctionCallbackInfo<Value>& args) {
 }
 
 
-void AfterGetAddrInfo(uv_getaddrinfo_t* req, int status, struct addrinfo* res) {
-  auto cleanup = OnScopeLeave([&]() { uv_freeaddrinfo(res); });
-  BaseObjectPtr<GetAddrInfoReqWrap> req_wrap{
-      static_cast<GetAddrInfoReqWrap*>(req->data)};
+// (family, address) pairs in the order returned by getaddrinfo().
+using AddressList = std::vector<std::pair<int, std::string>>;
+
+// Process-wide cache of dns.lookup() results, enabled with
+// --dns-lookup-cache-ttl. getaddrinfo() does not expose record TTLs, so
+// entries expire after the configured time. Negative answers (EAI_NONAME,
+// EAI_NODATA) are cached as well, transient failures are not. Within
+// --dns-lookup-cache-stale-ttl after expiry an entry is still served while a
+// single background lookup refreshes it.
+class DnsLookupCache {
+ public:
+  enum class Result { kMiss, kFresh, kStale };
+
+  struct Entry {
+    int status = 0;
+    AddressList addresses;
+    uint64_t expires_at = 0;
+    bool refreshing = false;
+  };
+
+  // Returns nullptr when the cache is disabled.
+  static DnsLookupCache* Get() {
+    static DnsLookupCache* cache = []() -> DnsLookupCache* {
+      Mutex::ScopedLock lock(per_process::cli_options_mutex);
+      const int64_t ttl = per_process::cli_options->dns_lookup_cache_ttl;
+      if (ttl <= 0) return nullptr;
+      return new DnsLookupCache(
+          ttl, per_process::cli_options->dns_lookup_cache_stale_ttl);
+    }();
+    return cache;
+  }
+
+  static std::string MakeKey(std::string_view hostname,
+                             int family,
+                             int flags) {
+    std::string key(hostname);
+    key.push_back('\0');
+    key += std::to_string(family);
+    key.push_back('\0');
+    key += std::to_string(flags);
+    return key;
+  }
+
+  // Copies the entry for key into *out. A stale entry is reported only to
+  // the first caller after expiry, which becomes responsible for refreshing
+  // it; other callers see it as fresh until the refresh completes.
+  Result Find(const std::string& key, Entry* out) {
+    Mutex::ScopedLock lock(mutex_);
+    auto it = entries_.find(key);
+    if (it == entries_.end()) return Result::kMiss;
+    Entry& entry = it->second;
+    const uint64_t now = uv_hrtime();
+    if (now < entry.expires_at) {
+      *out = entry;
+      return Result::kFresh;
+    }
+    if (now >= entry.expires_at + stale_ttl_ns_) {
+      if (entry.refreshing) {
+        *out = entry;
+        return Result::kFresh;
+      }
+      entries_.erase(it);
+      return Result::kMiss;
+    }
+    *out = entry;
+    if (entry.refreshing) return Result::kFresh;
+    entry.refreshing = true;
+    return Result::kStale;
+  }
+
+  void Store(const std::string& key, int status, const AddressList& addresses) {
+    if (status != 0 && status != UV_EAI_NONAME && status != UV_EAI_NODATA) {
+      // Keep serving what we have until it goes out of the stale window.
+      return CancelRefresh(key);
+    }
+    Mutex::ScopedLock lock(mutex_);
+    const uint64_t now = uv_hrtime();
+    if (entries_.size() >= kMaxEntries && !entries_.contains(key)) {
+      std::erase_if(entries_, [&](const auto& item) {
+        return !item.second.refreshing &&
+               now >= item.second.expires_at + stale_ttl_ns_;
+      });
+      if (entries_.size() >= kMaxEntries) entries_.clear();
+    }
+    Entry& entry = entries_[key];
+    entry.status = status;
+    entry.addresses = addresses;
+    entry.expires_at = now + ttl_ns_;
+    entry.refreshing = false;
+  }
+
+  void CancelRefresh(const std::string& key) {
+    Mutex::ScopedLock lock(mutex_);
+    auto it = entries_.find(key);
+    if (it != entries_.end()) it->second.refreshing = false;
+  }
+
+ private:
+  static constexpr size_t kMaxEntries = 4096;
+
+  DnsLookupCache(int64_t ttl_ms, int64_t stale_ttl_ms)
+      : ttl_ns_(ttl_ms * 1000000), stale_ttl_ns_(stale_ttl_ms * 1000000) {}
+
+  Mutex mutex_;
+  std::unordered_map<std::string, Entry> entries_;
+  const uint64_t ttl_ns_;
+  const uint64_t stale_ttl_ns_;
+};
+
+AddressList CollectAddresses(const struct addrinfo* res) {
+  AddressList addresses;
+  for (auto p = res; p != nullptr; p = p->ai_next) {
+    CHECK_EQ(p->ai_socktype, SOCK_STREAM);
+
+    const char* addr;
+    if (p->ai_family == AF_INET) {
+      addr = reinterpret_cast<char*>(
+          &(reinterpret_cast<struct sockaddr_in*>(p->ai_addr)->sin_addr));
+    } else if (p->ai_family == AF_INET6) {
+      addr = reinterpret_cast<char*>(
+          &(reinterpret_cast<struct sockaddr_in6*>(p->ai_addr)->sin6_addr));
+    } else {
+      continue;
+    }
+
+    char ip[INET6_ADDRSTRLEN];
+    if (uv_inet_ntop(p->ai_family, addr, ip, sizeof(ip)))
+      continue;
+
+    addresses.emplace_back(p->ai_family, ip);
+  }
+  return addresses;
+}
+
+void OnLookupComplete(AsyncWrap* req_wrap,
+                      uint8_t order,
+                      int status,
+                      const AddressList& addresses) {
   Environment* env = req_wrap->env();
 
   HandleScope handle_scope(env->isolate());
@@ -1704,30 +1856,17 @@ void AfterGetAddrInfo(uv_getaddrinfo_t* req, int status, struct addrinfo* res) {
   };
 
   uint32_t n = 0;
-  const uint8_t order = req_wrap->order();
 
   if (status == 0) {
     Local<Array> results = Array::New(env->isolate());
 
     auto add = [&](bool want_ipv4, bool want_ipv6) -> Maybe<void> {
-      for (auto p = res; p != nullptr; p = p->ai_next) {
-        CHECK_EQ(p->ai_socktype, SOCK_STREAM);
-
-        const char* addr;
-        if (want_ipv4 && p->ai_family == AF_INET) {
-          addr = reinterpret_cast<char*>(
-              &(reinterpret_cast<struct sockaddr_in*>(p->ai_addr)->sin_addr));
-        } else if (want_ipv6 && p->ai_family == AF_INET6) {
-          addr = reinterpret_cast<char*>(
-              &(reinterpret_cast<struct sockaddr_in6*>(p->ai_addr)->sin6_addr));
-        } else {
+      for (const auto& [family, ip] : addresses) {
+        if (!(want_ipv4 && family == AF_INET) &&
+            !(want_ipv6 && family == AF_INET6)) {
           continue;
         }
 
-        char ip[INET6_ADDRSTRLEN];
-        if (uv_inet_ntop(p->ai_family, addr, ip, sizeof(ip)))
-          continue;
-
         Local<String> s = OneByteString(env->isolate(), ip);
         if (results->Set(env->context(), n, s).IsNothing())
           return Nothing<void>();
@@ -1763,7 +1902,7 @@ void AfterGetAddrInfo(uv_getaddrinfo_t* req, int status, struct addrinfo* res) {
 
   TRACE_EVENT_NESTABLE_ASYNC_END2(TRACING_CATEGORY_NODE2(dns, native),
                                   "lookup",
-                                  req_wrap.get(),
+                                  req_wrap,
                                   "count",
                                   n,
                                   "order",
@@ -1773,6 +1912,48 @@ void AfterGetAddrInfo(uv_getaddrinfo_t* req, int status, struct addrinfo* res) {
   req_wrap->MakeCallback(env->oncomplete_string(), arraysize(argv), argv);
 }
 
+void AfterGetAddrInfo(uv_getaddrinfo_t* req, int status, struct addrinfo* res) {
+  auto cleanup = OnScopeLeave([&]() { uv_freeaddrinfo(res); });
+  BaseObjectPtr<GetAddrInfoReqWrap> req_wrap{
+      static_cast<GetAddrInfoReqWrap*>(req->data)};
+
+  AddressList addresses;
+  if (status == 0) addresses = CollectAddresses(res);
+  if (!req_wrap->cache_key().empty()) {
+    DnsLookupCache::Get()->Store(req_wrap->cache_key(), status, addresses);
+  }
+  if (req_wrap->is_refresh()) return;
+
+  OnLookupComplete(req_wrap.get(), req_wrap->order(), status, addresses);
+}
+
+// Looks up a stale dns.lookup() cache entry again without a JS callback.
+void RefreshLookup(Environment* env,
+                   std::string&& key,
+                   const char* hostname,
+                   const struct addrinfo& hints,
+                   uint8_t order) {
+  DnsLookupCache* cache = DnsLookupCache::Get();
+  Local<Object> req_wrap_obj;
+  if (!BaseObject::MakeLazilyInitializedJSTemplate(env)
+           ->InstanceTemplate()
+           ->NewInstance(env->context())
+           .ToLocal(&req_wrap_obj)) {
+    return cache->CancelRefresh(key);
+  }
+  auto req_wrap =
+      std::make_unique<GetAddrInfoReqWrap>(env, req_wrap_obj, order);
+  req_wrap->set_cache_key(std::move(key));
+  req_wrap->set_refresh();
+  int err = req_wrap->Dispatch(
+      uv_getaddrinfo, AfterGetAddrInfo, hostname, nullptr, &hints);
+  if (err == 0) {
+    USE(req_wrap.release());
+  } else {
+    cache->CancelRefresh(req_wrap->cache_key());
+  }
+}
+
 
 void AfterGetNameInfo(uv_getnameinfo_t* req,
                       int status,
@@ -1895,6 +2076,31 @@ void GetAddrInfo(const FunctionCallbackInfo<Value>& args) {
                                     : family == AF_INET6 ? "ipv6"
                                                          : "unspec");
 
+  if (DnsLookupCache* cache = DnsLookupCache::Get()) {
+    std::string key = DnsLookupCache::MakeKey(ascii_hostname, family, flags);
+    DnsLookupCache::Entry entry;
+    DnsLookupCache::Result result = cache->Find(key, &entry);
+    if (result == DnsLookupCache::Result::kMiss) {
+      req_wrap->set_cache_key(std::move(key));
+    } else {
+      if (result == DnsLookupCache::Result::kStale) {
+        RefreshLookup(
+            env, std::move(key), ascii_hostname.data(), hints, order->Value());
+      }
+      // Complete asynchronously, as if the lookup had been dispatched.
+      BaseObjectPtr<GetAddrInfoReqWrap> cached{req_wrap.release()};
+      cached->Detach();
+      env->SetImmediate([req_wrap = std::move(cached),
+                         entry = std::move(entry)](Environment* env) {
+        OnLookupComplete(req_wrap.get(),
+                         req_wrap->order(),
+                         entry.status,
+                         entry.addresses);
+      });
+      return args.GetReturnValue().Set(0);
+    }
+  }
+
   int err = req_wrap->Dispatch(
       uv_getaddrinfo, AfterGetAddrInfo, ascii_hostname.data(), nullptr, &hints);
   if (err == 0)
@@ -1905,6 +2111,165 @@ void GetAddrInfo(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// Maps ares_getaddrinfo() errors to the getaddrinfo() errors that the
+// uv_getaddrinfo() based dns.lookup() reports.
+int AresToAddrInfoError(int status) {
+  switch (status) {
+    case ARES_SUCCESS:
+      return 0;
+    case ARES_ENOTFOUND:
+    case ARES_ENONAME:
+      return UV_EAI_NONAME;
+    case ARES_ENODATA:
+      return UV_EAI_NODATA;
+    case ARES_EBADFAMILY:
+      return UV_EAI_FAMILY;
+    case ARES_EBADFLAGS:
+      return UV_EAI_BADFLAGS;
+    case ARES_ENOMEM:
+      return UV_EAI_MEMORY;
+    case ARES_ECANCELLED:
+    case ARES_EDESTRUCTION:
+      return UV_EAI_CANCELED;
+    case ARES_ETIMEOUT:
+    case ARES_ECONNREFUSED:
+    case ARES_ESERVFAIL:
+      return UV_EAI_AGAIN;
+    default:
+      return UV_EAI_FAIL;
+  }
+}
+
+}  // namespace
+
+AresGetAddrInfoWrap::AresGetAddrInfoWrap(ChannelWrap* channel,
+                                         Local<Object> req_wrap_obj,
+                                         uint8_t order)
+    : AsyncWrap(channel->env(),
+                req_wrap_obj,
+                AsyncWrap::PROVIDER_GETADDRINFOREQWRAP),
+      channel_(channel),
+      order_(order) {}
+
+AresGetAddrInfoWrap::~AresGetAddrInfoWrap() {
+  if (callback_ptr_ != nullptr) *callback_ptr_ = nullptr;
+}
+
+void AresGetAddrInfoWrap::Send(const char* hostname,
+                               const struct ares_addrinfo_hints& hints) {
+  channel_->EnsureServers();
+  channel_->ModifyActivityQueryCount(1);
+  TRACE_EVENT_NESTABLE_ASYNC_BEGIN1(TRACING_CATEGORY_NODE2(dns, native),
+                                    "lookup",
+                                    static_cast<AsyncWrap*>(this),
+                                    "hostname",
+                                    TRACE_STR_COPY(hostname));
+  CHECK_NULL(callback_ptr_);
+  callback_ptr_ = new AresGetAddrInfoWrap*(this);
+  // This may call Callback() synchronously, e.g. for hosts file entries.
+  ares_getaddrinfo(channel_->cares_channel(),
+                   hostname,
+                   nullptr,
+                   &hints,
+                   Callback,
+                   callback_ptr_);
+}
+
+void AresGetAddrInfoWrap::Callback(void* arg,
+                                   int status,
+                                   int timeouts,
+                                   struct ares_addrinfo* result) {
+  auto cleanup = OnScopeLeave([&]() {
+    if (result != nullptr) ares_freeaddrinfo(result);
+  });
+  std::unique_ptr<AresGetAddrInfoWrap*> wrap_ptr{
+      static_cast<AresGetAddrInfoWrap**>(arg)};
+  AresGetAddrInfoWrap* wrap = *wrap_ptr;
+  if (wrap == nullptr) return;
+  wrap->callback_ptr_ = nullptr;
+
+  AddressList addresses;
+  if (status == ARES_SUCCESS) {
+    for (auto p = result->nodes; p != nullptr; p = p->ai_next) {
+      const void* addr;
+      if (p->ai_family == AF_INET) {
+        addr = &reinterpret_cast<struct sockaddr_in*>(p->ai_addr)->sin_addr;
+      } else if (p->ai_family == AF_INET6) {
+        addr = &reinterpret_cast<struct sockaddr_in6*>(p->ai_addr)->sin6_addr;
+      } else {
+        continue;
+      }
+      char ip[INET6_ADDRSTRLEN];
+      if (uv_inet_ntop(p->ai_family, addr, ip, sizeof(ip))) continue;
+      addresses.emplace_back(p->ai_family, ip);
+    }
+  }
+
+  wrap->channel_->set_query_last_ok(status != ARES_ECONNREFUSED);
+  wrap->channel_->ModifyActivityQueryCount(-1);
+
+  // Always complete asynchronously, Callback() may run inside Send().
+  BaseObjectPtr<AresGetAddrInfoWrap> strong_ref{wrap};
+  wrap->env()->SetImmediate([strong_ref,
+                             status = AresToAddrInfoError(status),
+                             addresses = std::move(addresses)](Environment*) {
+    OnLookupComplete(strong_ref.get(), strong_ref->order_, status, addresses);
+    // Delete once strong_ref goes out of scope.
+    strong_ref->Detach();
+  });
+}
+
+namespace {
+
+// channel.getaddrinfo(req, hostname, family, hints, order) mirrors
+// GetAddrInfo() below, including its oncomplete(err, addresses) result.
+void AresGetAddrInfo(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  ChannelWrap* channel;
+  ASSIGN_OR_RETURN_UNWRAP(&channel, args.This());
+
+  CHECK(args[0]->IsObject());
+  CHECK(args[1]->IsString());
+  CHECK(args[2]->IsInt32());
+  CHECK(args[4]->IsUint32());
+  Local<Object> req_wrap_obj = args[0].As<Object>();
+  node::Utf8Value hostname(env->isolate(), args[1]);
+  std::string ascii_hostname = ada::idna::to_ascii(hostname.ToStringView());
+
+  int32_t flags = 0;
+  if (args[3]->IsInt32()) {
+    flags = args[3].As<Int32>()->Value();
+  }
+
+  struct ares_addrinfo_hints hints;
+  memset(&hints, 0, sizeof(hints));
+  switch (args[2].As<Int32>()->Value()) {
+    case 0:
+      hints.ai_family = AF_UNSPEC;
+      break;
+    case 4:
+      hints.ai_family = AF_INET;
+      break;
+    case 6:
+      hints.ai_family = AF_INET6;
+      break;
+    default:
+      UNREACHABLE("bad address family");
+  }
+  hints.ai_socktype = SOCK_STREAM;
+  if (flags & AI_ADDRCONFIG) hints.ai_flags |= ARES_AI_ADDRCONFIG;
+  if (flags & AI_V4MAPPED) hints.ai_flags |= ARES_AI_V4MAPPED;
+  if (flags & AI_ALL) hints.ai_flags |= ARES_AI_ALL;
+
+  auto wrap = std::make_unique<AresGetAddrInfoWrap>(
+      channel, req_wrap_obj, args[4].As<Uint32>()->Value());
+  wrap->Send(ascii_hostname.c_str(), hints);
+  // Release ownership of the pointer allowing the ownership to be transferred
+  USE(wrap.release());
+
+  args.GetReturnValue().Set(0);
+}
+
 void GetNameInfo(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -2148,7 +2513,7 @@ void StrError(const FunctionCallbackInfo<Value>& args) {
 
 }  // namespace
 
-inline void safe_free_hostent(struct hostent* host) {
+void safe_free_hostent(struct hostent* host) {
   int idx;
 
   if (host->h_addr_list != nullptr) {
@@ -2228,6 +2593,7 @@ void Initialize(Local<Object> target,
   SetProtoMethod(isolate, channel_wrap, "setServers", SetServers);
   SetProtoMethod(isolate, channel_wrap, "setLocalAddress", SetLocalAddress);
   SetProtoMethod(isolate, channel_wrap, "cancel", Cancel);
+  SetProtoMethod(isolate, channel_wrap, "getaddrinfo", AresGetAddrInfo);
 
   SetConstructorFunction(context, target, "ChannelWrap", channel_wrap);
 }
@@ -2248,6 +2614,7 @@ void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(SetServers);
   registry->Register(SetLocalAddress);
   registry->Register(Cancel);
+  registry->Register(AresGetAddrInfo);
 }
 
 }  // namespace cares_wrap
@@ -17,6 +17,7 @@
 #include "v8.h"
 #include "uv.h"
 
+#include <string>
 #include <unordered_set>
 
 #ifdef __POSIX__
@@ -36,7 +37,7 @@ constexpr uint8_t DNS_ORDER_IPV6_FIRST = 2;
 
 class ChannelWrap;
 
-inline void safe_free_hostent(struct hostent* host);
+void safe_free_hostent(struct hostent* host);
 
 using HostEntPointer = DeleteFnPtr<hostent, ares_free_hostent>;
 using SafeHostEntPointer = DeleteFnPtr<hostent, safe_free_hostent>;
@@ -149,13 +150,19 @@ struct NodeAresTask final : public MemoryRetainer {
   using List = std::unordered_set<NodeAresTask*, Hash, Equal>;
 };
 
+// Sets up the query cache in `options` for a maximum TTL of `max_cache_ttl`
+// seconds and returns the ares_init_options() mask bits for it. A negative
+// TTL keeps the default cache of c-ares.
+int SetQueryCacheOptions(ares_options* options, int64_t max_cache_ttl);
+
 class ChannelWrap final : public AsyncWrap {
  public:
   ChannelWrap(
       Environment* env,
       v8::Local<v8::Object> object,
       int timeout,
-      int tries);
+      int tries,
+      int64_t max_cache_ttl);
   ~ChannelWrap() override;
 
   static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -190,6 +197,9 @@ class ChannelWrap final : public AsyncWrap {
   bool library_inited_ = false;
   int timeout_;
   int tries_;
+  // Maximum TTL in seconds of the c-ares query cache, 0 if it is disabled
+  // and -1 to keep the default of c-ares.
+  int64_t max_cache_ttl_;
   int active_query_count_ = 0;
   NodeAresTask::List task_list_;
 };
@@ -206,8 +216,48 @@ class GetAddrInfoReqWrap final : public ReqWrap<uv_getaddrinfo_t> {
 
   uint8_t order() const { return order_; }
 
+  // Set when the result should be stored in the dns.lookup() cache.
+  const std::string& cache_key() const { return cache_key_; }
+  void set_cache_key(std::string&& key) { cache_key_ = std::move(key); }
+
+  // Background refreshes of stale cache entries have no JS callback.
+  bool is_refresh() const { return is_refresh_; }
+  void set_refresh() { is_refresh_ = true; }
+
  private:
   const uint8_t order_;
+  std::string cache_key_;
+  bool is_refresh_ = false;
+};
+
+// A dns.lookup() that goes through ares_getaddrinfo() on a ChannelWrap
+// instead of the blocking getaddrinfo() on the libuv threadpool. c-ares
+// consults the hosts file and applies the lookup order from nsswitch.conf or
+// resolv.conf itself.
+class AresGetAddrInfoWrap final : public AsyncWrap {
+ public:
+  AresGetAddrInfoWrap(ChannelWrap* channel,
+                      v8::Local<v8::Object> req_wrap_obj,
+                      uint8_t order);
+  ~AresGetAddrInfoWrap() override;
+
+  void Send(const char* hostname, const struct ares_addrinfo_hints& hints);
+
+  SET_NO_MEMORY_INFO()
+  SET_MEMORY_INFO_NAME(AresGetAddrInfoWrap)
+  SET_SELF_SIZE(AresGetAddrInfoWrap)
+
+ private:
+  static void Callback(void* arg,
+                       int status,
+                       int timeouts,
+                       struct ares_addrinfo* result);
+
+  BaseObjectPtr<ChannelWrap> channel_;
+  const uint8_t order_;
+  // Cleared on destruction so that Callback() can tell that this object no
+  // longer exists, see QueryWrap.
+  AresGetAddrInfoWrap** callback_ptr_ = nullptr;
 };
 
 class GetNameInfoReqWrap final : public ReqWrap<uv_getnameinfo_t> {
@@ -9,24 +9,27 @@
 namespace node {
 
 inline size_t CleanupQueue::SelfSize() const {
-  return sizeof(CleanupQueue) +
-         cleanup_hooks_.size() * sizeof(CleanupHookCallback);
+  return sizeof(CleanupQueue) + hooks_.capacity() * sizeof(CleanupHook) +
+         index_.size() * (sizeof(CleanupHook) + sizeof(size_t));
 }
 
 bool CleanupQueue::empty() const {
-  return cleanup_hooks_.empty();
+  return index_.empty();
 }
 
 void CleanupQueue::Add(Callback cb, void* arg) {
-  auto insertion_info =
-      cleanup_hooks_.emplace(cb, arg, cleanup_hook_counter_++);
+  auto insertion_info = index_.emplace(CleanupHook{cb, arg}, hooks_.size());
   // Make sure there was no existing element with these values.
   CHECK_EQ(insertion_info.second, true);
+  hooks_.push_back({cb, arg});
 }
 
 void CleanupQueue::Remove(Callback cb, void* arg) {
-  CleanupHookCallback search{cb, arg, 0};
-  cleanup_hooks_.erase(search);
+  auto it = index_.find(CleanupHook{cb, arg});
+  if (it == index_.end()) return;
+  hooks_[it->second].fn = nullptr;
+  index_.erase(it);
+  if (!draining_ && index_.size() < hooks_.size() / 2) Compact();
 }
 
 }  // namespace node
@@ -1,52 +1,55 @@
 #include "cleanup_queue.h"  // NOLINT(build/include_inline)
-#include <algorithm>
 #include <vector>
 #include "cleanup_queue-inl.h"
 
 namespace node {
 
-std::vector<CleanupQueue::CleanupHookCallback> CleanupQueue::GetOrdered()
-    const {
-  // Copy into a vector, since we can't sort an unordered_set in-place.
-  std::vector<CleanupHookCallback> callbacks(cleanup_hooks_.begin(),
-                                             cleanup_hooks_.end());
-  // We can't erase the copied elements from `cleanup_hooks_` yet, because we
-  // need to be able to check whether they were un-scheduled by another hook.
-
-  std::sort(callbacks.begin(),
-            callbacks.end(),
-            [](const CleanupHookCallback& a, const CleanupHookCallback& b) {
-              // Sort in descending order so that the most recently inserted
-              // callbacks are run first.
-              return a.insertion_order_counter_ > b.insertion_order_counter_;
-            });
-
-  return callbacks;
+void CleanupQueue::Compact() {
+  size_t live = 0;
+  for (size_t i = 0; i < hooks_.size(); ++i) {
+    if (hooks_[i].fn == nullptr) continue;
+    hooks_[live] = hooks_[i];
+    index_[hooks_[live]] = live;
+    ++live;
+  }
+  hooks_.resize(live);
 }
 
 void CleanupQueue::Drain() {
-  std::vector<CleanupHookCallback> callbacks = GetOrdered();
-
-  for (const CleanupHookCallback& cb : callbacks) {
-    if (cleanup_hooks_.count(cb) == 0) {
-      // This hook was removed from the `cleanup_hooks_` set during another
-      // hook that was run earlier. Nothing to do here.
+  CHECK(!draining_);
+  draining_ = true;
+
+  // Hooks that are added while draining are appended after `end` and will
+  // only be run by the next call.
+  size_t end = hooks_.size();
+  for (size_t i = end; i-- > 0;) {
+    // Copy the hook, since running it may grow `hooks_`.
+    CleanupHook hook = hooks_[i];
+    if (hook.fn == nullptr) {
+      // This hook was removed from the queue during another hook that was
+      // run earlier. Nothing to do here.
       continue;
     }
-
-    cb.fn_(cb.arg_);
-    cleanup_hooks_.erase(cb);
+    hook.fn(hook.arg);
+    // The hook may have removed itself already.
+    if (hooks_[i].fn == nullptr) continue;
+    index_.erase(hook);
+    hooks_[i].fn = nullptr;
   }
+
+  hooks_.erase(hooks_.begin(), hooks_.begin() + end);
+  Compact();
+  draining_ = false;
 }
 
-size_t CleanupQueue::CleanupHookCallback::Hash::operator()(
-    const CleanupHookCallback& cb) const {
-  return std::hash<void*>()(cb.arg_);
+size_t CleanupQueue::CleanupHook::Hash::operator()(
+    const CleanupHook& hook) const {
+  return std::hash<void*>()(hook.arg);
 }
 
-bool CleanupQueue::CleanupHookCallback::Equal::operator()(
-    const CleanupHookCallback& a, const CleanupHookCallback& b) const {
-  return a.fn_ == b.fn_ && a.arg_ == b.arg_;
+bool CleanupQueue::CleanupHook::Equal::operator()(
+    const CleanupHook& a, const CleanupHook& b) const {
+  return a.fn == b.fn && a.arg == b.arg;
 }
 
 }  // namespace node
@@ -5,7 +5,7 @@
 
 #include <cstddef>
 #include <cstdint>
-#include <unordered_set>
+#include <unordered_map>
 #include <vector>
 
 #include "memory_tracker.h"
@@ -32,44 +32,35 @@ class CleanupQueue : public MemoryRetainer {
   void Drain();
 
  private:
-  class CleanupHookCallback {
-   public:
-    CleanupHookCallback(Callback fn,
-                        void* arg,
-                        uint64_t insertion_order_counter)
-        : fn_(fn),
-          arg_(arg),
-          insertion_order_counter_(insertion_order_counter) {}
-
-    // Only hashes `arg_`, since that is usually enough to identify the hook.
+  struct CleanupHook {
+    Callback fn;
+    void* arg;
+
+    // Only hashes `arg`, since that is usually enough to identify the hook.
     struct Hash {
-      size_t operator()(const CleanupHookCallback& cb) const;
+      size_t operator()(const CleanupHook& hook) const;
     };
-
-    // Compares by `fn_` and `arg_` being equal.
+    // Compares by `fn` and `arg` being equal.
     struct Equal {
-      bool operator()(const CleanupHookCallback& a,
-                      const CleanupHookCallback& b) const;
+      bool operator()(const CleanupHook& a, const CleanupHook& b) const;
     };
-
-   private:
-    friend class CleanupQueue;
-    Callback fn_;
-    void* arg_;
-
-    // We keep track of the insertion order for these objects, so that we can
-    // call the callbacks in reverse order when we are cleaning up.
-    uint64_t insertion_order_counter_;
   };
 
-  std::vector<CleanupHookCallback> GetOrdered() const;
-
-  // Use an unordered_set, so that we have efficient insertion and removal.
-  std::unordered_set<CleanupHookCallback,
-                     CleanupHookCallback::Hash,
-                     CleanupHookCallback::Equal>
-      cleanup_hooks_;
-  uint64_t cleanup_hook_counter_ = 0;
+  // Drops removed hooks from `hooks_` and renumbers `index_` accordingly.
+  void Compact();
+
+  // Hooks in insertion order, so that they can be run in reverse order
+  // without sorting. Removing a hook only clears its `fn`; the slot is
+  // reclaimed once at least half of the slots are unused, or when the queue
+  // is drained.
+  std::vector<CleanupHook> hooks_;
+  // Position of each live hook in `hooks_`, for O(1) removal.
+  std::unordered_map<CleanupHook,
+                     size_t,
+                     CleanupHook::Hash,
+                     CleanupHook::Equal>
+      index_;
+  bool draining_ = false;
 };
 
 }  // namespace node
@@ -4,8 +4,10 @@
 #include "env-inl.h"
 #include "node_file.h"
 #include "node_internals.h"
+#include "node_mutex.h"
 #include "node_version.h"
 #include "path.h"
+#include "simdutf.h"
 #include "util.h"
 #include "zlib.h"
 
@@ -13,10 +15,18 @@
 #include <unistd.h>  // getuid
 #endif
 
+#ifndef _WIN32
+#include <sys/mman.h>  // mmap
+#endif
+
+#include <limits>
+
 namespace node {
 
 using v8::Function;
+using v8::Isolate;
 using v8::Local;
+using v8::MaybeLocal;
 using v8::Module;
 using v8::ScriptCompiler;
 using v8::String;
@@ -72,8 +82,96 @@ inline void CompileCacheHandler::Debug(const char* format,
   }
 }
 
+// Caches loaded by the handlers of different threads (e.g. Workers running
+// the same modules) are deduplicated, so that every thread does not keep its
+// own copy of the same content. The content is read-only once shared, and
+// freed when no entry uses it anymore.
+struct SharedCodeCache {
+  std::unique_ptr<uint8_t[]> data;
+  int length;
+  uint32_t code_hash;
+  uint32_t code_size;
+};
+
+namespace {
+Mutex shared_code_cache_mutex;
+// Keyed by the cache file name, which includes the cache directory.
+std::unordered_map<std::string, std::weak_ptr<const SharedCodeCache>>
+    shared_code_caches;
+
+std::shared_ptr<const SharedCodeCache> LookupSharedCodeCache(
+    const CompileCacheEntry& entry) {
+  Mutex::ScopedLock lock(shared_code_cache_mutex);
+  auto it = shared_code_caches.find(entry.cache_filename);
+  if (it == shared_code_caches.end()) return nullptr;
+  std::shared_ptr<const SharedCodeCache> shared = it->second.lock();
+  if (!shared) {
+    shared_code_caches.erase(it);
+    return nullptr;
+  }
+  if (shared->code_hash != entry.code_hash ||
+      shared->code_size != entry.code_size) {
+    return nullptr;
+  }
+  return shared;
+}
+
+// Takes ownership of `buffer`. Returns an equivalent cache shared by another
+// thread instead if there already is one.
+std::shared_ptr<const SharedCodeCache> ShareCodeCache(
+    const CompileCacheEntry& entry, uint8_t* buffer, int length) {
+  auto created = std::make_shared<SharedCodeCache>(
+      SharedCodeCache{std::unique_ptr<uint8_t[]>(buffer),
+                      length,
+                      entry.code_hash,
+                      entry.code_size});
+  Mutex::ScopedLock lock(shared_code_cache_mutex);
+  std::weak_ptr<const SharedCodeCache>& slot =
+      shared_code_caches[entry.cache_filename];
+  std::shared_ptr<const SharedCodeCache> existing = slot.lock();
+  if (existing && existing->code_hash == entry.code_hash &&
+      existing->code_size == entry.code_size) {
+    return existing;
+  }
+  slot = created;
+  return created;
+}
+
+// A string that points into a cache that may be shared by other threads, and
+// keeps it alive for as long as the string is.
+class SharedCacheString final : public String::ExternalOneByteStringResource {
+ public:
+  explicit SharedCacheString(std::shared_ptr<const SharedCodeCache> cache)
+      : cache_(std::move(cache)) {}
+
+  const char* data() const override {
+    return reinterpret_cast<const char*>(cache_->data.get());
+  }
+  size_t length() const override { return cache_->length; }
+
+ private:
+  std::shared_ptr<const SharedCodeCache> cache_;
+};
+
+// Shorter code is cheaper to copy than to track as an external string.
+constexpr int kMinSharedTranspiledLength = 4096;
+
+void UseSharedCodeCache(CompileCacheEntry* entry,
+                        std::shared_ptr<const SharedCodeCache> shared) {
+  entry->cache.reset(
+      new ScriptCompiler::CachedData(shared->data.get(),
+                                     shared->length,
+                                     ScriptCompiler::CachedData::BufferNotOwned));
+  entry->shared_cache = std::move(shared);
+}
+}  // anonymous namespace
+
 ScriptCompiler::CachedData* CompileCacheEntry::CopyCache() const {
   DCHECK_NOT_NULL(cache);
+  if (shared_cache) {
+    return new ScriptCompiler::CachedData(
+        cache->data, cache->length, ScriptCompiler::CachedData::BufferNotOwned);
+  }
   int cache_size = cache->length;
   uint8_t* data = new uint8_t[cache_size];
   memcpy(data, cache->data, cache_size);
@@ -81,9 +179,32 @@ ScriptCompiler::CachedData* CompileCacheEntry::CopyCache() const {
       data, cache_size, ScriptCompiler::CachedData::BufferOwned);
 }
 
+MaybeLocal<String> CompileCacheEntry::ShareTranspiledCode(
+    Isolate* isolate) const {
+  DCHECK_NOT_NULL(cache);
+  if (!shared_cache || cache->length < kMinSharedTranspiledLength ||
+      !simdutf::validate_ascii(reinterpret_cast<const char*>(cache->data),
+                               cache->length)) {
+    return MaybeLocal<String>();
+  }
+  auto* resource = new SharedCacheString(shared_cache);
+  Local<String> result;
+  if (!String::NewExternalOneByte(isolate, resource).ToLocal(&result)) {
+    delete resource;
+    return MaybeLocal<String>();
+  }
+  return result;
+}
+
 // Used for identifying and verifying a file is a compile cache file.
 // See comments in CompileCacheHandler::Persist().
 constexpr uint32_t kCacheMagicNumber = 0x8adfdbb2;
+// Used for identifying and verifying the packed cache archive.
+constexpr uint32_t kPackedCacheMagicNumber = 0x8adfdbb3;
+constexpr const char* kPackedCacheFilename = "packed.cache";
+// Used for identifying and verifying the module resolution cache.
+constexpr uint32_t kResolutionCacheMagicNumber = 0x8adfdbb4;
+constexpr const char* kResolutionCacheFilename = "resolution.cache";
 
 const char* CompileCacheEntry::type_name() const {
   switch (type) {
@@ -102,7 +223,204 @@ const char* CompileCacheEntry::type_name() const {
   }
 }
 
+void CompileCacheHandler::MaybeLoadPackedCache() {
+  if (packed_cache_loaded_) return;
+  // Pick up the archive that is being written, if any.
+  WaitForPendingPersist();
+  packed_cache_loaded_ = true;
+
+  Debug("[compile cache] loading packed cache from %s...",
+        packed_cache_filename_);
+
+  uv_fs_t req;
+  auto defer_req_cleanup = OnScopeLeave([&req]() { uv_fs_req_cleanup(&req); });
+  const char* path = packed_cache_filename_.c_str();
+  uv_file file = uv_fs_open(nullptr, &req, path, O_RDONLY, 0, nullptr);
+  if (req.result < 0) {
+    Debug(" %s\n", uv_strerror(req.result));
+    return;
+  }
+  uv_fs_req_cleanup(&req);
+
+  auto defer_close = OnScopeLeave([file]() {
+    uv_fs_t close_req;
+    CHECK_EQ(0, uv_fs_close(nullptr, &close_req, file, nullptr));
+    uv_fs_req_cleanup(&close_req);
+  });
+
+  if (uv_fs_fstat(nullptr, &req, file, nullptr) < 0) {
+    Debug(" %s\n", uv_strerror(req.result));
+    return;
+  }
+  const size_t size = static_cast<size_t>(req.statbuf.st_size);
+  packed_cache_key_ = GetStatKey(req.statbuf);
+  uv_fs_req_cleanup(&req);
+
+  if (size < kPackedHeaderCount * sizeof(uint32_t)) {
+    Debug(" file too small, size=%d\n", size);
+    return;
+  }
+
+#ifndef _WIN32
+  void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+  if (mapped != MAP_FAILED) {
+    packed_cache_data_ = static_cast<const uint8_t*>(mapped);
+    packed_cache_mapped_ = true;
+  }
+#endif
+  if (!packed_cache_mapped_) {
+    if (!ReadPackedCacheFile(file, size, &packed_cache_buffer_)) {
+      UnloadPackedCache();
+      packed_cache_loaded_ = true;
+      return;
+    }
+    packed_cache_data_ = packed_cache_buffer_.data();
+  }
+  packed_cache_size_ = size;
+
+  if (!ParsePackedCacheIndex(
+          packed_cache_data_, packed_cache_size_, &packed_cache_index_)) {
+    UnloadPackedCache();
+    packed_cache_loaded_ = true;
+    return;
+  }
+
+  Debug(" %s, entries=%d\n",
+        packed_cache_mapped_ ? "mapped" : "read",
+        packed_cache_index_.size());
+}
+
+bool CompileCacheHandler::ReadPackedCacheFile(
+    uv_file file, size_t size, std::vector<uint8_t>* buffer) const {
+  buffer->resize(size);
+  size_t total_read = 0;
+  while (total_read < size) {
+    uv_fs_t req;
+    uv_buf_t iov = uv_buf_init(
+        reinterpret_cast<char*>(buffer->data() + total_read),
+        size - total_read);
+    int bytes_read =
+        uv_fs_read(nullptr, &req, file, &iov, 1, total_read, nullptr);
+    uv_fs_req_cleanup(&req);
+    if (bytes_read <= 0) {
+      Debug(" reading failed, bytes read %d\n", bytes_read);
+      return false;
+    }
+    total_read += bytes_read;
+  }
+  return true;
+}
+
+bool CompileCacheHandler::ParsePackedCacheIndex(
+    const uint8_t* data,
+    size_t size,
+    std::unordered_map<uint32_t, PackedCacheEntry>* index) const {
+  const size_t header_size = kPackedHeaderCount * sizeof(uint32_t);
+  if (size < header_size) {
+    Debug(" file too small, size=%d\n", size);
+    return false;
+  }
+
+  uint32_t header[kPackedHeaderCount];
+  memcpy(header, data, header_size);
+  if (header[kPackedMagicNumberOffset] != kPackedCacheMagicNumber) {
+    Debug(" magic number mismatch: expected %d, actual %d\n",
+          kPackedCacheMagicNumber,
+          header[kPackedMagicNumberOffset]);
+    return false;
+  }
+
+  const size_t count = header[kPackedEntryCountOffset];
+  const size_t index_entry_size = kPackedIndexFieldCount * sizeof(uint32_t);
+  if (count > (size - header_size) / index_entry_size) {
+    Debug(" index out of bounds, entries=%d\n", count);
+    return false;
+  }
+
+  std::vector<uint32_t> fields(count * kPackedIndexFieldCount);
+  memcpy(fields.data(), data + header_size, count * index_entry_size);
+  index->reserve(count);
+  for (size_t i = 0; i < count; i++) {
+    const uint32_t* field = &fields[i * kPackedIndexFieldCount];
+    PackedCacheEntry packed{field[1], field[2], field[3], field[4], field[5]};
+    if (packed.offset > size || packed.cache_size > size - packed.offset) {
+      Debug(" entry %d out of bounds\n", i);
+      index->clear();
+      return false;
+    }
+    index->emplace(field[0], packed);
+  }
+  return true;
+}
+
+void CompileCacheHandler::UnloadPackedCache() {
+#ifndef _WIN32
+  if (packed_cache_mapped_) {
+    munmap(const_cast<uint8_t*>(packed_cache_data_), packed_cache_size_);
+  }
+#endif
+  packed_cache_mapped_ = false;
+  packed_cache_data_ = nullptr;
+  packed_cache_size_ = 0;
+  packed_cache_buffer_.clear();
+  packed_cache_buffer_.shrink_to_fit();
+  packed_cache_index_.clear();
+  packed_cache_key_.reset();
+  packed_cache_loaded_ = false;
+}
+
+// Returns true if the packed archive has an entry for the key, whether or
+// not it could be used.
+bool CompileCacheHandler::ReadPackedCacheEntry(CompileCacheEntry* entry) {
+  MaybeLoadPackedCache();
+  auto it = packed_cache_index_.find(entry->cache_key);
+  if (it == packed_cache_index_.end()) {
+    return false;
+  }
+  const PackedCacheEntry& packed = it->second;
+
+  Debug("[compile cache] reading packed cache for %s %s...",
+        entry->type_name(),
+        entry->source_filename);
+
+  if (packed.code_size != entry->code_size) {
+    Debug("code size mismatch: expected %d, actual %d\n",
+          entry->code_size,
+          packed.code_size);
+    return true;
+  }
+  if (packed.code_hash != entry->code_hash) {
+    Debug("code hash mismatch: expected %d, actual %d\n",
+          entry->code_hash,
+          packed.code_hash);
+    return true;
+  }
+
+  const uint8_t* data = packed_cache_data_ + packed.offset;
+  uint32_t cache_hash =
+      GetHash(reinterpret_cast<const char*>(data), packed.cache_size);
+  if (packed.cache_hash != cache_hash) {
+    Debug("cache hash mismatch: expected %d, actual %d\n",
+          packed.cache_hash,
+          cache_hash);
+    return true;
+  }
+
+  // Copy the entry out so that it stays valid when the mapping is replaced
+  // by the next Persist().
+  uint8_t* buffer = new uint8_t[packed.cache_size];
+  memcpy(buffer, data, packed.cache_size);
+  UseSharedCodeCache(entry, ShareCodeCache(*entry, buffer, packed.cache_size));
+  Debug(" success, size=%d\n", packed.cache_size);
+  return true;
+}
+
 void CompileCacheHandler::ReadCacheFile(CompileCacheEntry* entry) {
+  if (ReadPackedCacheEntry(entry)) {
+    return;
+  }
+
+  // Fall back to a per-file cache entry.
   Debug("[compile cache] reading cache from %s for %s %s...",
         entry->cache_filename,
         entry->type_name(),
@@ -218,8 +536,7 @@ void CompileCacheHandler::ReadCacheFile(CompileCacheEntry* entry) {
     return;
   }
 
-  entry->cache.reset(new ScriptCompiler::CachedData(
-      buffer, total_read, ScriptCompiler::CachedData::BufferOwned));
+  UseSharedCodeCache(entry, ShareCodeCache(*entry, buffer, total_read));
   Debug(" success, size=%d\n", total_read);
 }
 
@@ -259,6 +576,16 @@ CompileCacheEntry* CompileCacheHandler::GetOrInsert(Local<String> code,
   result->cache = nullptr;
   result->type = type;
 
+  // Another thread may have read the same cache already.
+  if (std::shared_ptr<const SharedCodeCache> shared =
+          LookupSharedCodeCache(*result)) {
+    Debug("[compile cache] using cache shared by another thread for %s %s\n",
+          result->type_name(),
+          result->source_filename);
+    UseSharedCodeCache(result, std::move(shared));
+    return result;
+  }
+
   // TODO(joyeecheung): if we fail enough times, stop trying for any future
   // files.
   ReadCacheFile(result);
@@ -296,6 +623,7 @@ void CompileCacheHandler::MaybeSaveImpl(CompileCacheEntry* entry,
   DCHECK_EQ(data->buffer_policy, ScriptCompiler::CachedData::BufferOwned);
   entry->refreshed = true;
   entry->cache.reset(data);
+  entry->shared_cache.reset();
 }
 
 void CompileCacheHandler::MaybeSave(CompileCacheEntry* entry,
@@ -327,36 +655,59 @@ void CompileCacheHandler::MaybeSave(CompileCacheEntry* entry,
   memcpy(data, transpiled.data(), cache_size);
   entry->cache.reset(new ScriptCompiler::CachedData(
       data, cache_size, ScriptCompiler::CachedData::BufferOwned));
+  entry->shared_cache.reset();
   entry->refreshed = true;
 }
 
 /**
  * Persist the compile cache accumulated in memory to disk.
  *
- * To avoid race conditions, the cache file includes hashes of the original
- * source code and the cache content. It's first written to a temporary file
- * before being renamed to the target name.
+ * All entries are written into a single packed archive in the cache
+ * directory, which is mapped and indexed lazily on the next run. To keep the
+ * archive compact, it is rewritten as a whole: entries refreshed in this run
+ * replace their old copies, entries whose code changed are dropped, and the
+ * remaining entries of the previous archive are carried over. To avoid race
+ * conditions, each entry includes hashes of the original source code and the
+ * cache content, and the archive is first written to a temporary file before
+ * being renamed to the target name.
  *
- * Layout of a cache file:
+ * Several processes may share the cache directory. Before publishing, the
+ * writer merges the entries of an archive that another process published
+ * after this one was loaded, instead of discarding them, and skips the write
+ * if that archive already has caches for all of the refreshed code. If the
+ * archive is replaced again while the temporary file is written, the merge
+ * is retried a few times. Readers are never blocked since the archive is
+ * only ever replaced by rename.
+ *
+ * Serialization happens on the isolate thread, but hashing and writing are
+ * done on a separate thread. Unless `wait` is true, this returns before the
+ * archive has been written; the next Persist() or lookup waits for it.
+ *
+ * Layout of the archive:
  *   [uint32_t] magic number
- *   [uint32_t] code size
- *   [uint32_t] code hash
- *   [uint32_t] cache size
- *   [uint32_t] cache hash
- *   .... compile cache content ....
+ *   [uint32_t] entry count
+ *   For each entry:
+ *     [uint32_t] cache key
+ *     [uint32_t] code size
+ *     [uint32_t] code hash
+ *     [uint32_t] cache size
+ *     [uint32_t] cache hash
+ *     [uint32_t] offset of the cache content from the start of the file
+ *   .... compile cache contents ....
  */
-void CompileCacheHandler::Persist() {
+void CompileCacheHandler::Persist(bool wait) {
   DCHECK(!compile_cache_dir_.empty());
 
-  // TODO(joyeecheung): do this using a separate event loop to utilize the
-  // libuv thread pool and do the file system operations concurrently.
-  // TODO(joyeecheung): Currently flushing is triggered by either process
-  // shutdown or user requests. In the future we should simply start the
-  // writes right after module loading on a separate thread, and this method
-  // only blocks until all the pending writes (if any) on the other thread are
-  // finished. In that case, the off-thread writes should finish long
-  // before any attempt of flushing is made so the method would then only
-  // incur a negligible overhead from thread synchronization.
+  // Only one archive is written at a time, and the next one has to carry
+  // over the entries of the previous one.
+  WaitForPendingPersist();
+
+  // The resolution cache is small, write it on this thread.
+  if (resolution_cache_dirty_) {
+    WriteResolutionCache();
+  }
+
+  bool needs_write = false;
   for (auto& pair : compiler_cache_store_) {
     auto* entry = pair.second.get();
     const char* type_name = entry->type_name();
@@ -381,113 +732,475 @@ void CompileCacheHandler::Persist() {
             entry->source_filename);
       continue;
     }
+    needs_write = true;
+  }
 
-    DCHECK_EQ(entry->cache->buffer_policy,
-              ScriptCompiler::CachedData::BufferOwned);
-    char* cache_ptr =
-        reinterpret_cast<char*>(const_cast<uint8_t*>(entry->cache->data));
-    uint32_t cache_size = static_cast<uint32_t>(entry->cache->length);
-    uint32_t cache_hash = GetHash(cache_ptr, cache_size);
-
-    // Generating headers.
-    std::vector<uint32_t> headers(kHeaderCount);
-    headers[kMagicNumberOffset] = kCacheMagicNumber;
-    headers[kCodeSizeOffset] = entry->code_size;
-    headers[kCacheSizeOffset] = cache_size;
-    headers[kCodeHashOffset] = entry->code_hash;
-    headers[kCacheHashOffset] = cache_hash;
-
-    // Generate the temporary filename.
-    // The temporary file should be placed in a location like:
-    //
-    // $NODE_COMPILE_CACHE_DIR/v23.0.0-pre-arm64-5fad6d45-501/e7f8ef7f.cache.tcqrsK
-    //
-    // 1. $NODE_COMPILE_CACHE_DIR either comes from the $NODE_COMPILE_CACHE
-    // environment
-    //    variable or `module.enableCompileCache()`.
-    // 2. v23.0.0-pre-arm64-5fad6d45-501 is the sub cache directory and
-    //    e7f8ef7f is the hash for the cache (see
-    //    CompileCacheHandler::Enable()),
-    // 3. tcqrsK is generated by uv_fs_mkstemp() as a temporary identifier.
-    uv_fs_t mkstemp_req;
-    auto cleanup_mkstemp =
-        OnScopeLeave([&mkstemp_req]() { uv_fs_req_cleanup(&mkstemp_req); });
-    std::string cache_filename_tmp = entry->cache_filename + ".XXXXXX";
-    Debug("[compile cache] Creating temporary file for cache of %s (%s)...",
-          entry->source_filename,
-          type_name);
-    int err = uv_fs_mkstemp(
-        nullptr, &mkstemp_req, cache_filename_tmp.c_str(), nullptr);
-    if (err < 0) {
-      Debug("failed. %s\n", uv_strerror(err));
-      continue;
+  if (needs_write) {
+    pending_write_ = CollectPackedCache();
+    // Hashing and file system operations happen on a separate thread; the
+    // isolate thread only had to hand over the serialized caches.
+    int err = uv_thread_create(
+        &persist_thread_,
+        [](void* data) {
+          auto* handler = static_cast<CompileCacheHandler*>(data);
+          handler->WritePackedCache(handler->pending_write_.get());
+        },
+        this);
+    if (err == 0) {
+      persist_thread_started_ = true;
+    } else {
+      Debug("[compile cache] cannot start persist thread: %s\n",
+            uv_strerror(err));
+      WritePackedCache(pending_write_.get());
     }
-    Debug(" -> %s\n", mkstemp_req.path);
-    Debug("[compile cache] writing cache for %s %s to temporary file %s [%d "
-          "%d %d "
-          "%d %d]...",
-          type_name,
-          entry->source_filename,
-          mkstemp_req.path,
-          headers[kMagicNumberOffset],
-          headers[kCodeSizeOffset],
-          headers[kCacheSizeOffset],
-          headers[kCodeHashOffset],
-          headers[kCacheHashOffset]);
-
-    // Write to the temporary file.
-    uv_buf_t headers_buf = uv_buf_init(reinterpret_cast<char*>(headers.data()),
-                                       headers.size() * sizeof(uint32_t));
-    uv_buf_t data_buf = uv_buf_init(cache_ptr, entry->cache->length);
-    uv_buf_t bufs[] = {headers_buf, data_buf};
-
-    uv_fs_t write_req;
-    auto cleanup_write =
-        OnScopeLeave([&write_req]() { uv_fs_req_cleanup(&write_req); });
-    err = uv_fs_write(
-        nullptr, &write_req, mkstemp_req.result, bufs, 2, 0, nullptr);
-    if (err < 0) {
-      Debug("failed: %s\n", uv_strerror(err));
-      continue;
+  }
+
+  // The archive may be replaced, map it again on the next lookup.
+  UnloadPackedCache();
+
+  // Clear the map at the end in one go instead of during the iteration to
+  // avoid rehashing costs.
+  Debug("[compile cache] Clear deserialized cache.\n");
+  compiler_cache_store_.clear();
+
+  if (wait) {
+    WaitForPendingPersist();
+  }
+}
+
+void CompileCacheHandler::WaitForPendingPersist() {
+  if (persist_thread_started_) {
+    CHECK_EQ(uv_thread_join(&persist_thread_), 0);
+    persist_thread_started_ = false;
+  }
+  pending_write_.reset();
+}
+
+// Everything the persist thread needs, detached from the handler so that
+// the isolate thread can keep using (and re-filling) compiler_cache_store_.
+struct CompileCacheHandler::PackedCacheWrite {
+  struct Item {
+    uint32_t key;
+    uint32_t code_size;
+    uint32_t code_hash;
+    // Only known up-front for entries carried over from the old archive.
+    std::optional<uint32_t> cache_hash;
+    const uint8_t* data;
+    uint32_t cache_size;
+  };
+
+  ~PackedCacheWrite() {
+#ifndef _WIN32
+    if (old_archive_mapped) {
+      munmap(const_cast<uint8_t*>(old_archive_data), old_archive_size);
     }
+#endif
+  }
+
+  std::vector<Item> items;
+  std::vector<std::unique_ptr<ScriptCompiler::CachedData>> caches;
+  // Keeps the buffers of caches that are views of shared ones alive.
+  std::vector<std::shared_ptr<const SharedCodeCache>> shared_caches;
+  // The previous archive, which carried-over items point into.
+  const uint8_t* old_archive_data = nullptr;
+  size_t old_archive_size = 0;
+  bool old_archive_mapped = false;
+  std::vector<uint8_t> old_archive_buffer;
+  // Identifies the archive on disk that has been merged last, so that
+  // archives published by other processes since can be detected.
+  std::optional<ResolutionCacheKey> archive_key;
+  // Archives published by other processes, which merged items point into.
+  std::vector<std::vector<uint8_t>> published_archives;
+};
 
+std::unique_ptr<CompileCacheHandler::PackedCacheWrite>
+CompileCacheHandler::CollectPackedCache() {
+  MaybeLoadPackedCache();
+
+  auto write = std::make_unique<PackedCacheWrite>();
+  write->items.reserve(compiler_cache_store_.size() +
+                       packed_cache_index_.size());
+  for (auto& pair : compiler_cache_store_) {
+    auto* entry = pair.second.get();
+    if (entry->cache == nullptr) continue;
+    write->items.push_back({entry->cache_key,
+                            entry->code_size,
+                            entry->code_hash,
+                            std::nullopt,
+                            entry->cache->data,
+                            static_cast<uint32_t>(entry->cache->length)});
+    write->caches.push_back(std::move(entry->cache));
+    if (entry->shared_cache)
+      write->shared_caches.push_back(std::move(entry->shared_cache));
+  }
+  for (auto& pair : packed_cache_index_) {
+    // Anything looked up in this run is either in the items already or stale.
+    if (compiler_cache_store_.count(pair.first) != 0) continue;
+    const PackedCacheEntry& packed = pair.second;
+    write->items.push_back({pair.first,
+                            packed.code_size,
+                            packed.code_hash,
+                            packed.cache_hash,
+                            packed_cache_data_ + packed.offset,
+                            packed.cache_size});
+  }
+
+  // Hand the old archive over to the write.
+  write->old_archive_data = packed_cache_data_;
+  write->old_archive_size = packed_cache_size_;
+  write->old_archive_mapped = packed_cache_mapped_;
+  write->old_archive_buffer = std::move(packed_cache_buffer_);
+  write->archive_key = packed_cache_key_;
+  packed_cache_mapped_ = false;
+  return write;
+}
+
+std::optional<CompileCacheHandler::ResolutionCacheKey>
+CompileCacheHandler::GetPackedCacheKey() const {
+  uv_fs_t req;
+  auto cleanup = OnScopeLeave([&req]() { uv_fs_req_cleanup(&req); });
+  if (uv_fs_stat(nullptr, &req, packed_cache_filename_.c_str(), nullptr) < 0) {
+    return std::nullopt;
+  }
+  return GetStatKey(req.statbuf);
+}
+
+bool CompileCacheHandler::MergePublishedCache(PackedCacheWrite* write) const {
+  Debug("[compile cache] merging packed cache published by another process...");
+
+  uv_fs_t req;
+  auto defer_req_cleanup = OnScopeLeave([&req]() { uv_fs_req_cleanup(&req); });
+  uv_file file = uv_fs_open(
+      nullptr, &req, packed_cache_filename_.c_str(), O_RDONLY, 0, nullptr);
+  if (req.result < 0) {
+    // It has been removed in the meantime, just write ours.
+    Debug(" %s\n", uv_strerror(req.result));
+    write->archive_key.reset();
+    return true;
+  }
+  uv_fs_req_cleanup(&req);
+
+  auto defer_close = OnScopeLeave([file]() {
     uv_fs_t close_req;
-    auto cleanup_close =
-        OnScopeLeave([&close_req]() { uv_fs_req_cleanup(&close_req); });
-    err = uv_fs_close(nullptr, &close_req, mkstemp_req.result, nullptr);
+    CHECK_EQ(0, uv_fs_close(nullptr, &close_req, file, nullptr));
+    uv_fs_req_cleanup(&close_req);
+  });
 
-    if (err < 0) {
-      Debug("failed: %s\n", uv_strerror(err));
-      continue;
+  if (uv_fs_fstat(nullptr, &req, file, nullptr) < 0) {
+    Debug(" %s\n", uv_strerror(req.result));
+    return true;
+  }
+  const size_t size = static_cast<size_t>(req.statbuf.st_size);
+  // Replace it even if it turns out to be invalid.
+  write->archive_key = GetStatKey(req.statbuf);
+  uv_fs_req_cleanup(&req);
+
+  std::vector<uint8_t> buffer;
+  std::unordered_map<uint32_t, PackedCacheEntry> index;
+  if (!ReadPackedCacheFile(file, size, &buffer) ||
+      !ParsePackedCacheIndex(buffer.data(), size, &index)) {
+    return true;
+  }
+
+  std::vector<PackedCacheWrite::Item>& items = write->items;
+  // Items without a known cache hash were refreshed in this process.
+  bool has_new_code = false;
+  std::unordered_map<uint32_t, size_t> positions;
+  positions.reserve(items.size());
+  for (size_t i = 0; i < items.size(); i++) {
+    const PackedCacheWrite::Item& item = items[i];
+    positions.emplace(item.key, i);
+    if (item.cache_hash.has_value()) continue;
+    auto it = index.find(item.key);
+    if (it == index.end() || it->second.code_size != item.code_size ||
+        it->second.code_hash != item.code_hash) {
+      has_new_code = true;
     }
+  }
+  if (!has_new_code) {
+    Debug(" it already has the refreshed entries\n");
+    return false;
+  }
 
-    Debug("success\n");
-
-    // Rename the temporary file to the actual cache file.
-    uv_fs_t rename_req;
-    auto cleanup_rename =
-        OnScopeLeave([&rename_req]() { uv_fs_req_cleanup(&rename_req); });
-    std::string cache_filename_final = entry->cache_filename;
-    Debug("[compile cache] Renaming %s to %s...",
-          mkstemp_req.path,
-          cache_filename_final);
-    err = uv_fs_rename(nullptr,
-                       &rename_req,
-                       mkstemp_req.path,
-                       cache_filename_final.c_str(),
-                       nullptr);
-    if (err < 0) {
-      Debug("failed: %s\n", uv_strerror(err));
+  size_t merged = 0;
+  for (const auto& [key, packed] : index) {
+    PackedCacheWrite::Item item{key,
+                                packed.code_size,
+                                packed.code_hash,
+                                packed.cache_hash,
+                                buffer.data() + packed.offset,
+                                packed.cache_size};
+    auto it = positions.find(key);
+    if (it == positions.end()) {
+      items.push_back(item);
+    } else if (items[it->second].cache_hash.has_value()) {
+      // Carried over from an older archive, the published one is newer.
+      items[it->second] = item;
+    } else {
       continue;
     }
-    Debug("success\n");
-    entry->persisted = true;
+    merged++;
   }
+  write->published_archives.push_back(std::move(buffer));
+  Debug(" merged %d entries\n", merged);
+  return true;
+}
 
-  // Clear the map at the end in one go instead of during the iteration to
-  // avoid rehashing costs.
-  Debug("[compile cache] Clear deserialized cache.\n");
-  compiler_cache_store_.clear();
+bool CompileCacheHandler::WritePackedCache(PackedCacheWrite* write) const {
+  static constexpr int kMaxPublishAttempts = 4;
+  for (int attempt = 1;; attempt++) {
+    if (GetPackedCacheKey() != write->archive_key &&
+        !MergePublishedCache(write)) {
+      return true;
+    }
+    bool replaced = false;
+    bool written = WritePackedCacheFile(*write, [&]() {
+      replaced = attempt < kMaxPublishAttempts &&
+                 GetPackedCacheKey() != write->archive_key;
+      return !replaced;
+    });
+    if (!replaced) return written;
+    Debug("[compile cache] packed cache was replaced while writing, "
+          "retrying\n");
+  }
+}
+
+bool CompileCacheHandler::WritePackedCacheFile(
+    const PackedCacheWrite& write,
+    const std::function<bool()>& before_rename) const {
+  const std::vector<PackedCacheWrite::Item>& items = write.items;
+  std::vector<uint32_t> index(kPackedHeaderCount);
+  index.reserve(kPackedHeaderCount + items.size() * kPackedIndexFieldCount);
+  std::vector<uv_buf_t> bufs(1);
+  bufs.reserve(items.size() + 1);
+  size_t offset =
+      (kPackedHeaderCount + items.size() * kPackedIndexFieldCount) *
+      sizeof(uint32_t);
+  size_t count = 0;
+  for (const auto& item : items) {
+    if (offset + item.cache_size > std::numeric_limits<uint32_t>::max()) {
+      Debug("[compile cache] packed cache is full, dropping %d entries\n",
+            items.size() - count);
+      break;
+    }
+    uint32_t cache_hash = item.cache_hash.has_value()
+                              ? item.cache_hash.value()
+                              : GetHash(reinterpret_cast<const char*>(item.data),
+                                        item.cache_size);
+    index.insert(index.end(),
+                 {item.key,
+                  item.code_size,
+                  item.code_hash,
+                  item.cache_size,
+                  cache_hash,
+                  static_cast<uint32_t>(offset)});
+    bufs.push_back(uv_buf_init(
+        reinterpret_cast<char*>(const_cast<uint8_t*>(item.data)),
+        item.cache_size));
+    offset += item.cache_size;
+    count++;
+  }
+  // Offsets were computed for the full index; pad the index of a truncated
+  // archive so that they stay valid.
+  index.resize(kPackedHeaderCount + items.size() * kPackedIndexFieldCount, 0);
+  index[kPackedMagicNumberOffset] = kPackedCacheMagicNumber;
+  index[kPackedEntryCountOffset] = static_cast<uint32_t>(count);
+  bufs[0] = uv_buf_init(reinterpret_cast<char*>(index.data()),
+                        index.size() * sizeof(uint32_t));
+
+  Debug("[compile cache] writing %d entries to packed cache\n", count);
+  return WriteFileAtomically(packed_cache_filename_, &bufs, before_rename);
+}
+
+bool CompileCacheHandler::WriteFileAtomically(
+    const std::string& filename,
+    std::vector<uv_buf_t>* bufs,
+    const std::function<bool()>& before_rename) const {
+  // The temporary file is placed next to the target, e.g.
+  // $NODE_COMPILE_CACHE_DIR/v23.0.0-pre-arm64-5fad6d45-501/packed.cache.tcqrsK
+  // where tcqrsK is generated by uv_fs_mkstemp() as a temporary identifier.
+  uv_fs_t mkstemp_req;
+  auto cleanup_mkstemp =
+      OnScopeLeave([&mkstemp_req]() { uv_fs_req_cleanup(&mkstemp_req); });
+  std::string filename_tmp = filename + ".XXXXXX";
+  Debug("[compile cache] Creating temporary file for %s...", filename);
+  int err =
+      uv_fs_mkstemp(nullptr, &mkstemp_req, filename_tmp.c_str(), nullptr);
+  if (err < 0) {
+    Debug("failed. %s\n", uv_strerror(err));
+    return false;
+  }
+  Debug(" -> %s\n", mkstemp_req.path);
+  Debug("[compile cache] writing to temporary file %s...", mkstemp_req.path);
+
+  uv_fs_t write_req;
+  auto cleanup_write =
+      OnScopeLeave([&write_req]() { uv_fs_req_cleanup(&write_req); });
+  err = uv_fs_write(nullptr,
+                    &write_req,
+                    mkstemp_req.result,
+                    bufs->data(),
+                    bufs->size(),
+                    0,
+                    nullptr);
+
+  uv_fs_t close_req;
+  auto cleanup_close =
+      OnScopeLeave([&close_req]() { uv_fs_req_cleanup(&close_req); });
+  int close_err =
+      uv_fs_close(nullptr, &close_req, mkstemp_req.result, nullptr);
+  if (err < 0 || close_err < 0) {
+    Debug("failed: %s\n", uv_strerror(err < 0 ? err : close_err));
+    uv_fs_t unlink_req;
+    uv_fs_unlink(nullptr, &unlink_req, mkstemp_req.path, nullptr);
+    uv_fs_req_cleanup(&unlink_req);
+    return false;
+  }
+  Debug("success\n");
+
+  if (before_rename && !before_rename()) {
+    uv_fs_t unlink_req;
+    uv_fs_unlink(nullptr, &unlink_req, mkstemp_req.path, nullptr);
+    uv_fs_req_cleanup(&unlink_req);
+    return false;
+  }
+
+  // Atomically replace the target, so that concurrent readers see either
+  // the old or the new file in full.
+  uv_fs_t rename_req;
+  auto cleanup_rename =
+      OnScopeLeave([&rename_req]() { uv_fs_req_cleanup(&rename_req); });
+  Debug("[compile cache] Renaming %s to %s...", mkstemp_req.path, filename);
+  err = uv_fs_rename(
+      nullptr, &rename_req, mkstemp_req.path, filename.c_str(), nullptr);
+  if (err < 0) {
+    Debug("failed: %s\n", uv_strerror(err));
+    return false;
+  }
+  Debug("success\n");
+  return true;
+}
+
+CompileCacheHandler::ResolutionCacheKey CompileCacheHandler::GetStatKey(
+    const uv_stat_t& stat) {
+  return {stat.st_size,
+          stat.st_ino,
+          static_cast<uint64_t>(stat.st_mtim.tv_sec),
+          static_cast<uint64_t>(stat.st_mtim.tv_nsec),
+          static_cast<uint64_t>(stat.st_ctim.tv_sec),
+          static_cast<uint64_t>(stat.st_ctim.tv_nsec)};
+}
+
+/**
+ * Layout of the module resolution cache:
+ *   [uint32_t] magic number
+ *   [uint32_t] entry count
+ *   For each entry:
+ *     [uint32_t] path length
+ *     [uint32_t] data length
+ *     [uint64_t x 6] size, inode, mtime and ctime of the file at `path`
+ *     .... path ....
+ *     .... data ....
+ */
+void CompileCacheHandler::MaybeLoadResolutionCache() {
+  if (resolution_cache_loaded_) return;
+  resolution_cache_loaded_ = true;
+
+  Debug("[compile cache] loading resolution cache from %s...",
+        resolution_cache_filename_);
+  std::string content;
+  int err = ReadFileSync(&content, resolution_cache_filename_.c_str());
+  if (err < 0) {
+    Debug(" %s\n", uv_strerror(err));
+    return;
+  }
+
+  size_t offset = 0;
+  const auto read = [&](void* out, size_t size) {
+    if (size > content.size() - offset) return false;
+    memcpy(out, content.data() + offset, size);
+    offset += size;
+    return true;
+  };
+
+  uint32_t header[2];
+  if (!read(header, sizeof(header)) ||
+      header[0] != kResolutionCacheMagicNumber) {
+    Debug(" invalid header\n");
+    return;
+  }
+  for (uint32_t i = 0; i < header[1]; i++) {
+    uint32_t lengths[2];
+    ResolutionCacheEntry entry;
+    if (!read(lengths, sizeof(lengths)) ||
+        !read(entry.key.data(), sizeof(entry.key)) ||
+        lengths[0] > content.size() - offset ||
+        lengths[1] > content.size() - offset - lengths[0]) {
+      Debug(" entry %d out of bounds\n", i);
+      resolution_cache_.clear();
+      return;
+    }
+    std::string path = content.substr(offset, lengths[0]);
+    entry.data = content.substr(offset + lengths[0], lengths[1]);
+    offset += lengths[0] + lengths[1];
+    resolution_cache_.emplace(std::move(path), std::move(entry));
+  }
+  Debug(" entries=%d\n", resolution_cache_.size());
+}
+
+std::optional<std::string_view> CompileCacheHandler::GetResolutionCacheEntry(
+    const std::string& path, const uv_stat_t& stat) {
+  MaybeLoadResolutionCache();
+  auto it = resolution_cache_.find(path);
+  if (it == resolution_cache_.end()) return std::nullopt;
+  if (it->second.key != GetStatKey(stat)) {
+    Debug("[compile cache] resolution cache for %s is stale\n", path);
+    resolution_cache_.erase(it);
+    resolution_cache_dirty_ = true;
+    return std::nullopt;
+  }
+  return it->second.data;
+}
+
+void CompileCacheHandler::SaveResolutionCacheEntry(const std::string& path,
+                                                   const uv_stat_t& stat,
+                                                   std::string data) {
+  MaybeLoadResolutionCache();
+  resolution_cache_[path] = {GetStatKey(stat), std::move(data)};
+  resolution_cache_dirty_ = true;
+}
+
+bool CompileCacheHandler::WriteResolutionCache() {
+  resolution_cache_dirty_ = false;
+  std::vector<uint32_t> header = {
+      kResolutionCacheMagicNumber,
+      static_cast<uint32_t>(resolution_cache_.size())};
+  std::vector<uint32_t> lengths;
+  lengths.reserve(resolution_cache_.size() * 2);
+  std::vector<uv_buf_t> bufs;
+  bufs.reserve(1 + resolution_cache_.size() * 4);
+  bufs.push_back(uv_buf_init(reinterpret_cast<char*>(header.data()),
+                             header.size() * sizeof(uint32_t)));
+  for (auto& [path, entry] : resolution_cache_) {
+    lengths.push_back(static_cast<uint32_t>(path.size()));
+    lengths.push_back(static_cast<uint32_t>(entry.data.size()));
+    bufs.push_back(uv_buf_init(
+        reinterpret_cast<char*>(&lengths[lengths.size() - 2]),
+        2 * sizeof(uint32_t)));
+    bufs.push_back(uv_buf_init(reinterpret_cast<char*>(entry.key.data()),
+                               sizeof(entry.key)));
+    bufs.push_back(uv_buf_init(const_cast<char*>(path.data()), path.size()));
+    bufs.push_back(
+        uv_buf_init(const_cast<char*>(entry.data.data()), entry.data.size()));
+  }
+  Debug("[compile cache] writing %d entries to resolution cache\n",
+        resolution_cache_.size());
+  return WriteFileAtomically(resolution_cache_filename_, &bufs);
+}
+
+CompileCacheHandler::~CompileCacheHandler() {
+  WaitForPendingPersist();
+  UnloadPackedCache();
 }
 
 CompileCacheHandler::CompileCacheHandler(Environment* env)
@@ -498,7 +1211,11 @@ CompileCacheHandler::CompileCacheHandler(Environment* env)
 // Directory structure:
 // - Compile cache directory (from NODE_COMPILE_CACHE)
 //   - $NODE_VERSION-$ARCH-$CACHE_DATA_VERSION_TAG-$UID
-//     - $FILENAME_AND_MODULE_TYPE_HASH.cache: a hash of filename + module type
+//     - packed.cache: all entries, see CompileCacheHandler::Persist()
+//     - resolution.cache: module resolution results, such as parsed
+//       package.json files, see CompileCacheHandler::MaybeLoadResolutionCache()
+//     - $FILENAME_AND_MODULE_TYPE_HASH.cache: a hash of filename + module type,
+//       per-file entries, only read as a fallback when packed.cache has none
 CompileCacheEnableResult CompileCacheHandler::Enable(Environment* env,
                                                      const std::string& dir) {
   std::string cache_tag = GetCacheVersionTag();
@@ -548,6 +1265,10 @@ CompileCacheEnableResult CompileCacheHandler::Enable(Environment* env,
 
   result.cache_directory = absolute_cache_dir_base;
   compile_cache_dir_ = cache_dir_with_tag;
+  packed_cache_filename_ =
+      compile_cache_dir_ + kPathSeparator + kPackedCacheFilename;
+  resolution_cache_filename_ =
+      compile_cache_dir_ + kPathSeparator + kResolutionCacheFilename;
   result.status = CompileCacheEnableStatus::ENABLED;
   return result;
 }
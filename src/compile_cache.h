@@ -3,11 +3,16 @@
 
 #if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
 
+#include <array>
 #include <cinttypes>
+#include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <unordered_map>
+#include <vector>
+#include "uv.h"
 #include "v8.h"
 
 namespace node {
@@ -26,8 +31,13 @@ enum class CachedCodeType : uint8_t {
 #undef V
 };
 
+// Cache content read from disk, shared by all threads that use it.
+struct SharedCodeCache;
+
 struct CompileCacheEntry {
   std::unique_ptr<v8::ScriptCompiler::CachedData> cache{nullptr};
+  // If set, `cache` does not own its buffer but points into this.
+  std::shared_ptr<const SharedCodeCache> shared_cache;
   uint32_t cache_key;
   uint32_t code_hash;
   uint32_t code_size;
@@ -38,9 +48,14 @@ struct CompileCacheEntry {
   bool refreshed = false;
   bool persisted = false;
 
-  // Copy the cache into a new store for V8 to consume. Caller takes
-  // ownership.
+  // Copy the cache into a new store for V8 to consume, or make a view of it
+  // if the cache is shared. Caller takes ownership, and must not use it
+  // after the entry has been modified.
   v8::ScriptCompiler::CachedData* CopyCache() const;
+  // Returns transpiled code in the cache as a string that points into the
+  // shared cache instead of copying it, or an empty handle if the cache is not
+  // shared or not ASCII. Does not throw.
+  v8::MaybeLocal<v8::String> ShareTranspiledCode(v8::Isolate* isolate) const;
   const char* type_name() const;
 };
 
@@ -65,9 +80,11 @@ struct CompileCacheEnableResult {
 class CompileCacheHandler {
  public:
   explicit CompileCacheHandler(Environment* env);
+  ~CompileCacheHandler();
   CompileCacheEnableResult Enable(Environment* env, const std::string& dir);
 
-  void Persist();
+  void Persist(bool wait = true);
+  void WaitForPendingPersist();
 
   CompileCacheEntry* GetOrInsert(v8::Local<v8::String> code,
                                  v8::Local<v8::String> filename,
@@ -81,8 +98,65 @@ class CompileCacheHandler {
   void MaybeSave(CompileCacheEntry* entry, std::string_view transpiled);
   std::string_view cache_dir() { return compile_cache_dir_; }
 
+  // Module resolution results that are derived from the file at `path`,
+  // e.g. a parsed package.json, persisted next to the compile cache. An
+  // entry is only returned if `stat` of the file still matches the one it
+  // was saved with.
+  std::optional<std::string_view> GetResolutionCacheEntry(
+      const std::string& path, const uv_stat_t& stat);
+  void SaveResolutionCacheEntry(const std::string& path,
+                                const uv_stat_t& stat,
+                                std::string data);
+
  private:
+  // Location of an entry in the packed cache archive, see Persist().
+  struct PackedCacheEntry {
+    uint32_t code_size;
+    uint32_t code_hash;
+    uint32_t cache_size;
+    uint32_t cache_hash;
+    uint32_t offset;
+  };
+
+  // Size, inode, mtime and ctime of the file an entry was derived from.
+  using ResolutionCacheKey = std::array<uint64_t, 6>;
+
   void ReadCacheFile(CompileCacheEntry* entry);
+  bool ReadPackedCacheEntry(CompileCacheEntry* entry);
+  void MaybeLoadPackedCache();
+  void UnloadPackedCache();
+  bool ReadPackedCacheFile(uv_file file,
+                           size_t size,
+                           std::vector<uint8_t>* buffer) const;
+  bool ParsePackedCacheIndex(
+      const uint8_t* data,
+      size_t size,
+      std::unordered_map<uint32_t, PackedCacheEntry>* index) const;
+
+  struct PackedCacheWrite;
+  std::unique_ptr<PackedCacheWrite> CollectPackedCache();
+  bool WritePackedCache(PackedCacheWrite* write) const;
+  bool WritePackedCacheFile(const PackedCacheWrite& write,
+                            const std::function<bool()>& before_rename) const;
+  // Identifies the packed archive currently on disk, if any.
+  std::optional<ResolutionCacheKey> GetPackedCacheKey() const;
+  // Merges the entries of the archive that another process published into
+  // `write`. Returns false if that archive already has all of the entries
+  // that were refreshed in this process, so that nothing needs to be written.
+  bool MergePublishedCache(PackedCacheWrite* write) const;
+  // If `before_rename` returns false, the temporary file is removed instead
+  // of replacing `filename`.
+  bool WriteFileAtomically(
+      const std::string& filename,
+      std::vector<uv_buf_t>* bufs,
+      const std::function<bool()>& before_rename = nullptr) const;
+  struct ResolutionCacheEntry {
+    ResolutionCacheKey key;
+    std::string data;
+  };
+  static ResolutionCacheKey GetStatKey(const uv_stat_t& stat);
+  void MaybeLoadResolutionCache();
+  bool WriteResolutionCache();
 
   template <typename T>
   void MaybeSaveImpl(CompileCacheEntry* entry,
@@ -99,12 +173,38 @@ class CompileCacheHandler {
   static constexpr size_t kCacheHashOffset = 4;
   static constexpr size_t kHeaderCount = 5;
 
+  static constexpr size_t kPackedMagicNumberOffset = 0;
+  static constexpr size_t kPackedEntryCountOffset = 1;
+  static constexpr size_t kPackedHeaderCount = 2;
+  static constexpr size_t kPackedIndexFieldCount = 6;
+
   v8::Isolate* isolate_ = nullptr;
   bool is_debug_ = false;
 
   std::string compile_cache_dir_;
   std::unordered_map<uint32_t, std::unique_ptr<CompileCacheEntry>>
       compiler_cache_store_;
+
+  // The packed archive is mapped on the first lookup and kept until the next
+  // Persist(), which rewrites it.
+  std::string packed_cache_filename_;
+  bool packed_cache_loaded_ = false;
+  const uint8_t* packed_cache_data_ = nullptr;
+  size_t packed_cache_size_ = 0;
+  bool packed_cache_mapped_ = false;
+  std::vector<uint8_t> packed_cache_buffer_;  // When it could not be mapped.
+  std::unordered_map<uint32_t, PackedCacheEntry> packed_cache_index_;
+  std::optional<ResolutionCacheKey> packed_cache_key_;
+
+  // An archive being written by persist_thread_.
+  std::unique_ptr<PackedCacheWrite> pending_write_;
+  uv_thread_t persist_thread_;
+  bool persist_thread_started_ = false;
+
+  std::string resolution_cache_filename_;
+  bool resolution_cache_loaded_ = false;
+  bool resolution_cache_dirty_ = false;
+  std::unordered_map<std::string, ResolutionCacheEntry> resolution_cache_;
 };
 }  // namespace node
 
@@ -10,12 +10,17 @@
 
 namespace node {
 
+using v8::Array;
 using v8::Boolean;
 using v8::Context;
+using v8::FunctionCallbackInfo;
+using v8::Global;
 using v8::HandleScope;
 using v8::Integer;
+using v8::Isolate;
 using v8::Local;
 using v8::Object;
+using v8::Uint32;
 using v8::Value;
 
 
@@ -63,9 +68,27 @@ void ConnectionWrap<WrapType, UVType>::OnConnection(uv_stream_t* handle,
     if (uv_accept(handle, client))
       return;
 
+    if (wrap_data->accept_batch_size_ > 1) {
+      // libuv invokes this callback once per connection while it drains the
+      // accept backlog, so queue the client and deliver the whole batch
+      // either when it is full or from the check phase of this iteration.
+      wrap_data->accepted_connections_.emplace_back(env->isolate(),
+                                                    client_obj);
+      if (wrap_data->accepted_connections_.size() >=
+          wrap_data->accept_batch_size_) {
+        wrap_data->FlushAcceptedConnections();
+      } else {
+        wrap_data->ScheduleAcceptFlush();
+      }
+      return;
+    }
+
     // Successful accept. Call the onconnection callback in JavaScript land.
     client_handle = client_obj;
   } else {
+    // Deliver connections accepted before the error first.
+    wrap_data->FlushAcceptedConnections();
+    if (wrap_data->IsHandleClosing()) return;
     client_handle = Undefined(env->isolate());
   }
 
@@ -74,6 +97,63 @@ void ConnectionWrap<WrapType, UVType>::OnConnection(uv_stream_t* handle,
 }
 
 
+template <typename WrapType, typename UVType>
+void ConnectionWrap<WrapType, UVType>::FlushAcceptedConnections() {
+  if (accepted_connections_.empty()) return;
+
+  Environment* env = this->env();
+  Isolate* isolate = env->isolate();
+  std::vector<Local<Value>> clients;
+  clients.reserve(accepted_connections_.size());
+  for (const Global<Object>& client : accepted_connections_)
+    clients.push_back(client.Get(isolate));
+  accepted_connections_.clear();
+
+  Local<Value> argv[] = {
+      Integer::New(isolate, 0),
+      Array::New(isolate, clients.data(), clients.size())};
+  MakeCallback(env->onconnection_string(), arraysize(argv), argv);
+}
+
+
+template <typename WrapType, typename UVType>
+void ConnectionWrap<WrapType, UVType>::ScheduleAcceptFlush() {
+  if (accept_flush_scheduled_) return;
+  accept_flush_scheduled_ = true;
+  env()->SetImmediate([self = BaseObjectPtr<WrapType>(
+                           static_cast<WrapType*>(this))](Environment* env) {
+    self->accept_flush_scheduled_ = false;
+    HandleScope handle_scope(env->isolate());
+    Context::Scope context_scope(env->context());
+    if (self->IsHandleClosing()) {
+      // The server went away before the batch was delivered, nobody is
+      // left to take ownership of the accepted handles.
+      for (const Global<Object>& client_obj : self->accepted_connections_) {
+        WrapType* client =
+            BaseObject::FromJSObject<WrapType>(client_obj.Get(env->isolate()));
+        if (client != nullptr) client->Close();
+      }
+      self->accepted_connections_.clear();
+      return;
+    }
+    self->FlushAcceptedConnections();
+  });
+}
+
+
+template <typename WrapType, typename UVType>
+void ConnectionWrap<WrapType, UVType>::SetAcceptBatchSize(
+    const FunctionCallbackInfo<Value>& args) {
+  WrapType* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(
+      &wrap, args.This(), args.GetReturnValue().Set(UV_EBADF));
+  CHECK(args[0]->IsUint32());
+  uint32_t batch_size = args[0].As<Uint32>()->Value();
+  wrap->accept_batch_size_ = batch_size > 1 ? batch_size : 1;
+  args.GetReturnValue().Set(0);
+}
+
+
 template <typename WrapType, typename UVType>
 void ConnectionWrap<WrapType, UVType>::AfterConnect(uv_connect_t* req,
                                                     int status) {
@@ -132,6 +212,12 @@ template void ConnectionWrap<PipeWrap, uv_pipe_t>::OnConnection(
 template void ConnectionWrap<TCPWrap, uv_tcp_t>::OnConnection(
     uv_stream_t* handle, int status);
 
+template void ConnectionWrap<PipeWrap, uv_pipe_t>::SetAcceptBatchSize(
+    const FunctionCallbackInfo<Value>& args);
+
+template void ConnectionWrap<TCPWrap, uv_tcp_t>::SetAcceptBatchSize(
+    const FunctionCallbackInfo<Value>& args);
+
 template void ConnectionWrap<PipeWrap, uv_pipe_t>::AfterConnect(
     uv_connect_t* handle, int status);
 
@@ -5,6 +5,8 @@
 
 #include "stream_wrap.h"
 
+#include <vector>
+
 namespace node {
 
 class Environment;
@@ -14,6 +16,12 @@ class ConnectionWrap : public LibuvStreamWrap {
  public:
   static void OnConnection(uv_stream_t* handle, int status);
   static void AfterConnect(uv_connect_t* req, int status);
+  // setAcceptBatchSize(n) makes a listening handle collect the connections
+  // accepted during one event loop iteration and pass them to
+  // onconnection(status, clients) as an array of at most n handles, rather
+  // than making one callback per connection. n <= 1 disables batching.
+  static void SetAcceptBatchSize(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
 
  protected:
   ConnectionWrap(Environment* env,
@@ -21,6 +29,14 @@ class ConnectionWrap : public LibuvStreamWrap {
                  ProviderType provider);
 
   UVType handle_;
+
+ private:
+  void FlushAcceptedConnections();
+  void ScheduleAcceptFlush();
+
+  uint32_t accept_batch_size_ = 1;
+  bool accept_flush_scheduled_ = false;
+  std::vector<v8::Global<v8::Object>> accepted_connections_;
 };
 
 }  // namespace node
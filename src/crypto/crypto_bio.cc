@@ -289,6 +289,10 @@ size_t NodeBIO::Read(char* out, size_t size) {
   // Free all empty buffers, but write_head's child
   FreeEmpty();
 
+  // Drained, start over with small chunks for the next burst.
+  if (length_ == 0)
+    throughput_length_ = kThroughputBufferLength;
+
   return bytes_read;
 }
 
@@ -434,8 +438,9 @@ void NodeBIO::TryAllocateForWrite(size_t hint) {
   if (w == nullptr ||
       (w->write_pos_ == w->len_ &&
        (w->next_ == r || w->next_->write_pos_ != 0))) {
-    size_t len = w == nullptr ? initial_ :
-                             kThroughputBufferLength;
+    size_t len = w == nullptr ? initial_ : throughput_length_;
+    if (w != nullptr && throughput_length_ < kMaxThroughputBufferLength)
+      throughput_length_ *= 2;
     if (len < hint)
       len = hint;
 
@@ -474,6 +479,7 @@ void NodeBIO::Reset() {
   }
   write_head_ = read_head_;
   CHECK_EQ(length_, 0);
+  throughput_length_ = kThroughputBufferLength;
 }
 
 
@@ -147,6 +147,10 @@ class NodeBIO : public MemoryRetainer {
   // Enough to handle the most of the client hellos
   static const size_t kInitialBufferLength = 1024;
   static const size_t kThroughputBufferLength = 16384;
+  // Chunks grow by doubling while data keeps piling up faster than it is
+  // drained, so that a large write ends up in a few big contiguous buffers
+  // that the stream can hand to writev() instead of many 16k ones.
+  static const size_t kMaxThroughputBufferLength = 256 * 1024;
 
   class Buffer {
    public:
@@ -178,6 +182,7 @@ class NodeBIO : public MemoryRetainer {
 
   Environment* env_ = nullptr;
   size_t initial_ = kInitialBufferLength;
+  size_t throughput_length_ = kThroughputBufferLength;
   size_t length_ = 0;
   size_t allocate_hint_ = 0;
   int eof_return_ = -1;
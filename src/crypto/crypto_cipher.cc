@@ -6,6 +6,7 @@
 #include "node_buffer.h"
 #include "node_internals.h"
 #include "node_process-inl.h"
+#include "threadpoolwork-inl.h"
 #include "v8.h"
 
 namespace node {
@@ -21,22 +22,28 @@ using ncrypto::SSLCtxPointer;
 using ncrypto::SSLPointer;
 using v8::Array;
 using v8::ArrayBuffer;
+using v8::ArrayBufferView;
 using v8::BackingStore;
 using v8::BackingStoreInitializationMode;
 using v8::Context;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
+using v8::Global;
 using v8::HandleScope;
 using v8::Int32;
 using v8::Isolate;
 using v8::Local;
 using v8::LocalVector;
 using v8::Object;
+using v8::Promise;
+using v8::TryCatch;
 using v8::Uint32;
 using v8::Value;
 
 namespace crypto {
 namespace {
+constexpr const char* kBusyMessage = "Cipher is busy with an update batch";
+
 // Collects and returns information on the given cipher
 void GetCipherInfo(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
@@ -215,7 +222,8 @@ CipherBase::CipherBase(Environment* env,
       kind_(kind),
       auth_tag_state_(kAuthTagUnknown),
       auth_tag_len_(kNoAuthTagLength),
-      pending_auth_failed_(false) {
+      pending_auth_failed_(false),
+      busy_(false) {
   MakeWeak();
 }
 
@@ -232,6 +240,8 @@ void CipherBase::Initialize(Environment* env, Local<Object> target) {
   t->InstanceTemplate()->SetInternalFieldCount(CipherBase::kInternalFieldCount);
 
   SetProtoMethod(isolate, t, "update", Update);
+  SetProtoMethod(isolate, t, "updateInto", UpdateInto);
+  SetProtoMethod(isolate, t, "updateBatch", UpdateBatch);
   SetProtoMethod(isolate, t, "final", Final);
   SetProtoMethod(isolate, t, "setAutoPadding", SetAutoPadding);
   SetProtoMethodNoSideEffect(isolate, t, "getAuthTag", GetAuthTag);
@@ -274,6 +284,8 @@ void CipherBase::RegisterExternalReferences(
   registry->Register(New);
 
   registry->Register(Update);
+  registry->Register(UpdateInto);
+  registry->Register(UpdateBatch);
   registry->Register(Final);
   registry->Register(SetAutoPadding);
   registry->Register(GetAuthTag);
@@ -514,7 +526,7 @@ void CipherBase::GetAuthTag(const FunctionCallbackInfo<Value>& args) {
   ASSIGN_OR_RETURN_UNWRAP(&cipher, args.This());
 
   // Only callable after Final and if encrypting.
-  if (cipher->ctx_ ||
+  if (cipher->ctx_ || cipher->busy_ ||
       cipher->kind_ != kCipher ||
       cipher->auth_tag_len_ == kNoAuthTagLength) {
     return;
@@ -532,7 +544,7 @@ void CipherBase::SetAuthTag(const FunctionCallbackInfo<Value>& args) {
   ASSIGN_OR_RETURN_UNWRAP(&cipher, args.This());
   Environment* env = Environment::GetCurrent(args);
 
-  if (!cipher->ctx_ ||
+  if (!cipher->ctx_ || cipher->busy_ ||
       !cipher->IsAuthenticatedMode() ||
       cipher->kind_ != kDecipher ||
       cipher->auth_tag_state_ != kAuthTagUnknown) {
@@ -656,52 +668,88 @@ void CipherBase::SetAAD(const FunctionCallbackInfo<Value>& args) {
   if (!buf.CheckSizeInt32()) [[unlikely]] {
     return THROW_ERR_OUT_OF_RANGE(env, "buffer is too big");
   }
+  if (cipher->busy_) [[unlikely]] {
+    return THROW_ERR_CRYPTO_INVALID_STATE(env, kBusyMessage);
+  }
   args.GetReturnValue().Set(cipher->SetAAD(buf, plaintext_len));
 }
 
-CipherBase::UpdateResult CipherBase::Update(
-    const char* data,
-    size_t len,
-    std::unique_ptr<BackingStore>* out) {
+CipherBase::UpdateResult CipherBase::GetUpdateOutputSize(
+    const unsigned char* data, size_t len, int* size) {
   if (!ctx_ || len > INT_MAX) return kErrorState;
-  MarkPopErrorOnReturn mark_pop_error_on_return;
 
   if (ctx_.isCcmMode() && !CheckCCMMessageLength(len)) {
     return kErrorMessageSize;
   }
 
-  // Pass the authentication tag to OpenSSL if possible. This will only happen
-  // once, usually on the first update.
-  if (kind_ == kDecipher && IsAuthenticatedMode()) {
-    CHECK(MaybePassAuthTagToOpenSSL());
-  }
-
+  // EVP_CipherUpdate() writes at most len + block_size - 1 bytes when
+  // encrypting and len + block_size bytes when decrypting. Stream ciphers
+  // and modes such as GCM and CTR have a block size of 1 and never write
+  // more than len bytes, so the output can be allocated exactly.
   const int block_size = ctx_.getBlockSize();
   CHECK_GT(block_size, 0);
+  if (block_size == 1) {
+    *size = len;
+    return kSuccess;
+  }
   if (len + block_size > INT_MAX) return kErrorState;
-  int buf_len = len + block_size;
+  *size = len + block_size;
 
   ncrypto::Buffer<const unsigned char> buffer = {
-      .data = reinterpret_cast<const unsigned char*>(data),
+      .data = data,
       .len = len,
   };
   if (kind_ == kCipher && ctx_.isWrapMode() &&
-      !ctx_.update(buffer, nullptr, &buf_len)) {
+      !ctx_.update(buffer, nullptr, size)) {
     return kErrorState;
   }
+  return kSuccess;
+}
+
+CipherBase::UpdateResult CipherBase::UpdateInto(const unsigned char* data,
+                                                size_t len,
+                                                unsigned char* out,
+                                                int* out_len) {
+  // Pass the authentication tag to OpenSSL if possible. This will only happen
+  // once, usually on the first update.
+  if (kind_ == kDecipher && IsAuthenticatedMode()) {
+    CHECK(MaybePassAuthTagToOpenSSL());
+  }
+
+  ncrypto::Buffer<const unsigned char> buffer = {
+      .data = data,
+      .len = len,
+  };
+  bool r = ctx_.update(buffer, out, out_len);
+
+  // When in CCM mode, EVP_CipherUpdate will fail if the authentication tag is
+  // invalid. In that case, remember the error and throw in final().
+  if (!r && kind_ == kDecipher && ctx_.isCcmMode()) {
+    pending_auth_failed_ = true;
+    *out_len = 0;
+    return kSuccess;
+  }
+  return r == 1 ? kSuccess : kErrorState;
+}
+
+CipherBase::UpdateResult CipherBase::Update(
+    const char* data,
+    size_t len,
+    std::unique_ptr<BackingStore>* out) {
+  MarkPopErrorOnReturn mark_pop_error_on_return;
+  const unsigned char* in = reinterpret_cast<const unsigned char*>(data);
+
+  int buf_len;
+  UpdateResult r = GetUpdateOutputSize(in, len, &buf_len);
+  if (r != kSuccess) return r;
 
   *out = ArrayBuffer::NewBackingStore(
       env()->isolate(),
       buf_len,
       BackingStoreInitializationMode::kUninitialized);
 
-  buffer = {
-      .data = reinterpret_cast<const unsigned char*>(data),
-      .len = len,
-  };
-
-  bool r = ctx_.update(
-      buffer, static_cast<unsigned char*>((*out)->Data()), &buf_len);
+  r = UpdateInto(
+      in, len, static_cast<unsigned char*>((*out)->Data()), &buf_len);
 
   CHECK_LE(static_cast<size_t>(buf_len), (*out)->ByteLength());
   if (buf_len == 0) {
@@ -711,14 +759,7 @@ CipherBase::UpdateResult CipherBase::Update(
     *out = ArrayBuffer::NewBackingStore(env()->isolate(), buf_len);
     memcpy((*out)->Data(), old_out->Data(), buf_len);
   }
-
-  // When in CCM mode, EVP_CipherUpdate will fail if the authentication tag is
-  // invalid. In that case, remember the error and throw in final().
-  if (!r && kind_ == kDecipher && ctx_.isCcmMode()) {
-    pending_auth_failed_ = true;
-    return kSuccess;
-  }
-  return r == 1 ? kSuccess : kErrorState;
+  return r;
 }
 
 void CipherBase::Update(const FunctionCallbackInfo<Value>& args) {
@@ -732,6 +773,9 @@ void CipherBase::Update(const FunctionCallbackInfo<Value>& args) {
         std::unique_ptr<BackingStore> out;
         Environment* env = Environment::GetCurrent(args);
 
+        if (cipher->busy_) [[unlikely]] {
+          return THROW_ERR_CRYPTO_INVALID_STATE(env, kBusyMessage);
+        }
         if (size > INT_MAX) [[unlikely]] {
           return THROW_ERR_OUT_OF_RANGE(env, "data is too long");
         }
@@ -752,6 +796,220 @@ void CipherBase::Update(const FunctionCallbackInfo<Value>& args) {
       });
 }
 
+// updateInto(data, output, offset) writes the result of updating with `data`
+// into `output`, starting at `offset`, and returns the number of bytes
+// written. `output` may be the same memory as `data` to encrypt or decrypt in
+// place. Unlike update(), this does not allocate, but `output` must have room
+// for as many bytes as update() could return, i.e. the size of `data` for
+// stream ciphers and AEAD modes such as GCM, or one more block otherwise.
+void CipherBase::UpdateInto(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  MarkPopErrorOnReturn mark_pop_error_on_return;
+
+  CipherBase* cipher;
+  ASSIGN_OR_RETURN_UNWRAP(&cipher, args.This());
+  CHECK(args[0]->IsArrayBufferView());
+  CHECK(args[1]->IsArrayBufferView());
+  CHECK(args[2]->IsUint32());
+
+  if (cipher->busy_) [[unlikely]] {
+    return THROW_ERR_CRYPTO_INVALID_STATE(env, kBusyMessage);
+  }
+
+  ArrayBufferViewContents<unsigned char> data(args[0]);
+  SPREAD_BUFFER_ARG(args[1], output);
+  size_t offset = args[2].As<Uint32>()->Value();
+  if (offset > output_length) [[unlikely]] {
+    return THROW_ERR_OUT_OF_RANGE(env, "offset is out of bounds");
+  }
+
+  int max_len;
+  UpdateResult r =
+      cipher->GetUpdateOutputSize(data.data(), data.length(), &max_len);
+  if (r == kSuccess && static_cast<size_t>(max_len) > output_length - offset) {
+    return THROW_ERR_OUT_OF_RANGE(
+        env, "output must have room for at least %d bytes", max_len);
+  }
+  int written = max_len;
+  if (r == kSuccess) {
+    r = cipher->UpdateInto(
+        data.data(),
+        data.length(),
+        reinterpret_cast<unsigned char*>(output_data) + offset,
+        &written);
+  }
+
+  if (r != kSuccess) {
+    if (r == kErrorState) {
+      ThrowCryptoError(env,
+                       mark_pop_error_on_return.peekError(),
+                       "Trying to add data in unsupported state");
+    }
+    return;
+  }
+  CHECK_LE(written, max_len);
+  args.GetReturnValue().Set(written);
+}
+
+// Updates a cipher with a list of chunks on the threadpool, so that large
+// streams do not need one round trip to the threadpool, or a blocking call on
+// the main thread, per chunk. The cipher cannot be used otherwise until the
+// job is done.
+class CipherBase::UpdateBatchJob final : public ThreadPoolWork {
+ public:
+  struct Chunk {
+    std::shared_ptr<BackingStore> input_store;
+    std::shared_ptr<BackingStore> output_store;
+    const unsigned char* input;
+    size_t input_length;
+    unsigned char* output;
+    int written;
+  };
+
+  UpdateBatchJob(Environment* env,
+                 BaseObjectPtr<CipherBase> cipher,
+                 std::vector<Chunk>&& chunks,
+                 Local<Promise::Resolver> resolver)
+      : ThreadPoolWork(env, "crypto"),
+        env_(env),
+        cipher_(std::move(cipher)),
+        chunks_(std::move(chunks)),
+        resolver_(env->isolate(), resolver) {
+    cipher_->busy_ = true;
+  }
+
+  void DoThreadPoolWork() override {
+    MarkPopErrorOnReturn mark_pop_error_on_return;
+    for (Chunk& chunk : chunks_) {
+      if (cipher_->UpdateInto(chunk.input,
+                              chunk.input_length,
+                              chunk.output,
+                              &chunk.written) != kSuccess) {
+        errors_.Capture();
+        if (errors_.Empty()) errors_.Insert(NodeCryptoError::CIPHER_JOB_FAILED);
+        return;
+      }
+    }
+  }
+
+  void AfterThreadPoolWork(int status) override {
+    std::unique_ptr<UpdateBatchJob> self(this);
+    cipher_->busy_ = false;
+
+    Isolate* isolate = env_->isolate();
+    HandleScope handle_scope(isolate);
+    Local<Context> context = env_->context();
+    Context::Scope context_scope(context);
+    Local<Promise::Resolver> resolver = resolver_.Get(isolate);
+
+    TryCatch try_catch(isolate);
+    if (status == UV_ECANCELED) {
+      USE(resolver->Reject(
+          context, ERR_CRYPTO_INVALID_STATE(isolate, "update was cancelled")));
+      return;
+    }
+
+    Local<Value> result;
+    if (!errors_.Empty()) {
+      if (errors_.ToException(env_).ToLocal(&result)) {
+        USE(resolver->Reject(context, result));
+      }
+    } else {
+      LocalVector<Value> written(isolate);
+      written.reserve(chunks_.size());
+      for (const Chunk& chunk : chunks_) {
+        written.push_back(Int32::New(isolate, chunk.written));
+      }
+      USE(resolver->Resolve(
+          context, Array::New(isolate, written.data(), written.size())));
+    }
+    if (try_catch.HasCaught() && try_catch.CanContinue()) {
+      USE(resolver->Reject(context, try_catch.Exception()));
+    }
+  }
+
+ private:
+  Environment* env_;
+  BaseObjectPtr<CipherBase> cipher_;
+  std::vector<Chunk> chunks_;
+  CryptoErrorStore errors_;
+  Global<Promise::Resolver> resolver_;
+};
+
+// updateBatch(inputs, outputs) updates the cipher with each view in `inputs`
+// on the threadpool and writes the results to the view at the same index in
+// `outputs`, which may be the input itself. Returns a promise for the number
+// of bytes written to each output. The outputs must be as large as required
+// by updateInto().
+void CipherBase::UpdateBatch(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Local<Context> context = env->context();
+  MarkPopErrorOnReturn mark_pop_error_on_return;
+
+  CipherBase* cipher;
+  ASSIGN_OR_RETURN_UNWRAP(&cipher, args.This());
+  CHECK(args[0]->IsArray());
+  CHECK(args[1]->IsArray());
+  Local<Array> inputs = args[0].As<Array>();
+  Local<Array> outputs = args[1].As<Array>();
+  CHECK_EQ(inputs->Length(), outputs->Length());
+
+  if (cipher->busy_) [[unlikely]] {
+    return THROW_ERR_CRYPTO_INVALID_STATE(env, kBusyMessage);
+  }
+  if (!cipher->ctx_) [[unlikely]] {
+    return THROW_ERR_CRYPTO_INVALID_STATE(env);
+  }
+
+  std::vector<UpdateBatchJob::Chunk> chunks(inputs->Length());
+  for (uint32_t i = 0; i < inputs->Length(); i++) {
+    Local<Value> input;
+    Local<Value> output;
+    if (!inputs->Get(context, i).ToLocal(&input) ||
+        !outputs->Get(context, i).ToLocal(&output)) {
+      return;
+    }
+    if (!input->IsArrayBufferView() || !output->IsArrayBufferView()) {
+      return THROW_ERR_INVALID_ARG_TYPE(env, "Chunks must be ArrayBufferViews");
+    }
+    Local<ArrayBufferView> in = input.As<ArrayBufferView>();
+    Local<ArrayBufferView> out = output.As<ArrayBufferView>();
+
+    // The backing stores keep the memory alive, even if the buffers are
+    // transferred while the job runs.
+    UpdateBatchJob::Chunk& chunk = chunks[i];
+    chunk.input_store = in->Buffer()->GetBackingStore();
+    chunk.output_store = out->Buffer()->GetBackingStore();
+    chunk.input = static_cast<const unsigned char*>(chunk.input_store->Data()) +
+                  in->ByteOffset();
+    chunk.input_length = in->ByteLength();
+    chunk.output =
+        static_cast<unsigned char*>(chunk.output_store->Data()) +
+        out->ByteOffset();
+
+    UpdateResult r = cipher->GetUpdateOutputSize(
+        chunk.input, chunk.input_length, &chunk.written);
+    if (r == kErrorState) {
+      return ThrowCryptoError(env,
+                              mark_pop_error_on_return.peekError(),
+                              "Trying to add data in unsupported state");
+    }
+    if (r != kSuccess) return;
+    if (static_cast<size_t>(chunk.written) > out->ByteLength()) {
+      return THROW_ERR_OUT_OF_RANGE(
+          env, "output %u must have room for at least %d bytes",
+          i, chunk.written);
+    }
+  }
+
+  Local<Promise::Resolver> resolver;
+  if (!Promise::Resolver::New(context).ToLocal(&resolver)) return;
+  auto* job = new UpdateBatchJob(
+      env, BaseObjectPtr<CipherBase>(cipher), std::move(chunks), resolver);
+  job->ScheduleWork();
+  args.GetReturnValue().Set(resolver->GetPromise());
+}
+
 bool CipherBase::SetAutoPadding(bool auto_padding) {
   if (!ctx_) return false;
   MarkPopErrorOnReturn mark_pop_error_on_return;
@@ -761,6 +1019,10 @@ bool CipherBase::SetAutoPadding(bool auto_padding) {
 void CipherBase::SetAutoPadding(const FunctionCallbackInfo<Value>& args) {
   CipherBase* cipher;
   ASSIGN_OR_RETURN_UNWRAP(&cipher, args.This());
+  if (cipher->busy_) [[unlikely]] {
+    return THROW_ERR_CRYPTO_INVALID_STATE(
+        Environment::GetCurrent(args), kBusyMessage);
+  }
 
   bool b = cipher->SetAutoPadding(args.Length() < 1 || args[0]->IsTrue());
   args.GetReturnValue().Set(b);  // Possibly report invalid state failure
@@ -832,6 +1094,9 @@ void CipherBase::Final(const FunctionCallbackInfo<Value>& args) {
 
   CipherBase* cipher;
   ASSIGN_OR_RETURN_UNWRAP(&cipher, args.This());
+  if (cipher->busy_) [[unlikely]] {
+    return THROW_ERR_CRYPTO_INVALID_STATE(env, kBusyMessage);
+  }
   if (cipher->ctx_ == nullptr) {
     return THROW_ERR_CRYPTO_INVALID_STATE(env);
   }
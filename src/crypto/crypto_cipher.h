@@ -58,6 +58,18 @@ class CipherBase : public BaseObject {
                          int iv_len,
                          unsigned int auth_tag_len);
   bool CheckCCMMessageLength(int message_len);
+  // Computes how many bytes updating with |len| bytes of |data| may write.
+  // Must be called on the main thread, since it may throw.
+  UpdateResult GetUpdateOutputSize(const unsigned char* data,
+                                   size_t len,
+                                   int* size);
+  // Writes the output to |out|, which must have room for the size returned
+  // by GetUpdateOutputSize(). Does not use V8, so it can run on the
+  // threadpool.
+  UpdateResult UpdateInto(const unsigned char* data,
+                          size_t len,
+                          unsigned char* out,
+                          int* out_len);
   UpdateResult Update(const char* data, size_t len,
                       std::unique_ptr<v8::BackingStore>* out);
   bool Final(std::unique_ptr<v8::BackingStore>* out);
@@ -71,6 +83,8 @@ class CipherBase : public BaseObject {
 
   static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Update(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void UpdateInto(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void UpdateBatch(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Final(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetAutoPadding(const v8::FunctionCallbackInfo<v8::Value>& args);
 
@@ -81,12 +95,16 @@ class CipherBase : public BaseObject {
   CipherBase(Environment* env, v8::Local<v8::Object> wrap, CipherKind kind);
 
  private:
+  class UpdateBatchJob;
+
   ncrypto::CipherCtxPointer ctx_;
   const CipherKind kind_;
   AuthTagState auth_tag_state_;
   unsigned int auth_tag_len_;
   char auth_tag_[ncrypto::Cipher::MAX_AUTH_TAG_LENGTH];
   bool pending_auth_failed_;
+  // Set while an UpdateBatchJob uses ctx_ on the threadpool.
+  bool busy_;
   int max_message_size_;
 };
 
@@ -27,6 +27,9 @@
 #include <wincrypt.h>
 #endif
 
+#include <list>
+#include <string_view>
+
 namespace node {
 
 using ncrypto::BignumPointer;
@@ -34,6 +37,7 @@ using ncrypto::BIOPointer;
 using ncrypto::Cipher;
 using ncrypto::ClearErrorOnReturn;
 using ncrypto::CryptoErrorList;
+using ncrypto::DataPointer;
 using ncrypto::DHPointer;
 using ncrypto::Digest;
 #ifndef OPENSSL_NO_ENGINE
@@ -70,6 +74,7 @@ using v8::PropertyAttribute;
 using v8::ReadOnly;
 using v8::Signature;
 using v8::String;
+using v8::Uint32;
 using v8::Value;
 
 namespace crypto {
@@ -85,6 +90,22 @@ static std::atomic<bool> has_cached_bundled_root_certs{false};
 static std::atomic<bool> has_cached_system_root_certs{false};
 static std::atomic<bool> has_cached_extra_root_certs{false};
 
+// Applications commonly pass the same custom CAs to every SecureContext they
+// create, e.g. one per tenant, and parsing them dominates the cost of creating
+// those contexts. The certificates parsed from the most recently used CA
+// inputs are therefore shared by the SecureContexts of all threads.
+static constexpr size_t kMaxCachedCACerts = 64;
+
+struct CachedCACerts {
+  size_t hash;
+  std::string pem;
+  std::shared_ptr<const std::vector<X509Pointer>> certs;
+};
+
+static Mutex ca_certs_cache_mutex;
+// Ordered from the most to the least recently used entry.
+static std::list<CachedCACerts> ca_certs_cache;
+
 X509_STORE* GetOrCreateRootCertStore() {
   // Guaranteed thread-safe by standard, just don't use -fno-threadsafe-statics.
   static X509_STORE* store = NewRootCertStore();
@@ -868,6 +889,10 @@ X509_STORE* NewRootCertStore() {
 }
 
 void CleanupCachedRootCertificates() {
+  {
+    Mutex::ScopedLock lock(ca_certs_cache_mutex);
+    ca_certs_cache.clear();
+  }
   if (has_cached_bundled_root_certs.load()) {
     for (X509* cert : GetBundledRootCertificates()) {
       X509_free(cert);
@@ -992,6 +1017,7 @@ Local<FunctionTemplate> SecureContext::GetConstructorTemplate(
     SetProtoMethod(isolate, tmpl, "close", Close);
     SetProtoMethod(isolate, tmpl, "loadPKCS12", LoadPKCS12);
     SetProtoMethod(isolate, tmpl, "setTicketKeys", SetTicketKeys);
+    SetProtoMethod(isolate, tmpl, "setTicketKeySecret", SetTicketKeySecret);
     SetProtoMethod(
         isolate, tmpl, "enableTicketKeyCallback", EnableTicketKeyCallback);
 
@@ -1073,6 +1099,7 @@ void SecureContext::RegisterExternalReferences(
   registry->Register(Close);
   registry->Register(LoadPKCS12);
   registry->Register(SetTicketKeys);
+  registry->Register(SetTicketKeySecret);
   registry->Register(EnableTicketKeyCallback);
   registry->Register(GetTicketKeys);
   registry->Register(GetCertificate<true>);
@@ -1447,14 +1474,46 @@ void SecureContext::SetAllowPartialTrustChain(
   sc->SetX509StoreFlag(X509_V_FLAG_PARTIAL_CHAIN);
 }
 
+namespace {
+std::shared_ptr<const std::vector<X509Pointer>> GetOrParseCACerts(
+    std::string_view pem) {
+  size_t hash = std::hash<std::string_view>()(pem);
+  {
+    Mutex::ScopedLock lock(ca_certs_cache_mutex);
+    for (auto it = ca_certs_cache.begin(); it != ca_certs_cache.end(); ++it) {
+      if (it->hash != hash || it->pem != pem) continue;
+      ca_certs_cache.splice(ca_certs_cache.begin(), ca_certs_cache, it);
+      return it->certs;
+    }
+  }
+
+  auto certs = std::make_shared<std::vector<X509Pointer>>();
+  auto bio = BIOPointer::New(pem.data(), pem.size());
+  if (!bio) return certs;
+  while (X509Pointer x509 = X509Pointer(PEM_read_bio_X509_AUX(
+             bio.get(), nullptr, NoPasswordCallback, nullptr))) {
+    certs->push_back(std::move(x509));
+  }
+
+  Mutex::ScopedLock lock(ca_certs_cache_mutex);
+  ca_certs_cache.push_front({hash, std::string(pem), certs});
+  if (ca_certs_cache.size() > kMaxCachedCACerts) ca_certs_cache.pop_back();
+  return certs;
+}
+}  // namespace
+
 void SecureContext::SetCACert(const BIOPointer& bio) {
   ClearErrorOnReturn clear_error_on_return;
   if (!bio) return;
-  while (X509Pointer x509 = X509Pointer(PEM_read_bio_X509_AUX(
-             bio.get(), nullptr, NoPasswordCallback, nullptr))) {
+  char* data;
+  long len = BIO_get_mem_data(bio.get(), &data);  // NOLINT(runtime/int)
+  if (len <= 0) return;
+  auto certs = GetOrParseCACerts(std::string_view(data, len));
+  for (const X509Pointer& x509 : *certs) {
     CHECK_EQ(1,
-             X509_STORE_add_cert(GetCertStoreOwnedByThisSecureContext(), x509));
-    CHECK_EQ(1, SSL_CTX_add_client_CA(ctx_.get(), x509));
+             X509_STORE_add_cert(GetCertStoreOwnedByThisSecureContext(),
+                                 x509.get()));
+    CHECK_EQ(1, SSL_CTX_add_client_CA(ctx_.get(), x509.get()));
   }
 }
 
@@ -1922,6 +1981,68 @@ void SecureContext::SetTicketKeys(const FunctionCallbackInfo<Value>& args) {
   args.GetReturnValue().Set(true);
 }
 
+// Derives the ticket keys from a secret instead of using random per-process
+// ones. Every SecureContext given the same secret, in any thread or process,
+// derives the same keys for the same period of wall clock time, so a client
+// can resume on whichever cluster worker it lands on and rotation needs no
+// coordination beyond distributing the secret once.
+void SecureContext::SetTicketKeySecret(
+    const FunctionCallbackInfo<Value>& args) {
+  SecureContext* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap, args.This());
+
+  CHECK_EQ(args.Length(), 2);
+  CHECK(args[0]->IsArrayBufferView());
+  CHECK(args[1]->IsUint32());
+  ArrayBufferViewContents<unsigned char> secret(args[0].As<ArrayBufferView>());
+  uint32_t period = args[1].As<Uint32>()->Value();
+  CHECK_GE(secret.length(), 32);
+  CHECK_GT(period, 0);
+
+  wrap->ticket_key_secret_.assign(secret.data(),
+                                  secret.data() + secret.length());
+  wrap->ticket_key_period_ = period;
+  for (DerivedTicketKey& key : wrap->derived_ticket_keys_)
+    key.epoch = UINT64_MAX;
+
+  if (!wrap->UpdateDerivedTicketKeys()) {
+    wrap->ticket_key_secret_.clear();
+    return THROW_ERR_CRYPTO_OPERATION_FAILED(
+        wrap->env(), "Error deriving ticket keys");
+  }
+}
+
+bool SecureContext::UpdateDerivedTicketKeys() {
+  uint64_t now = static_cast<uint64_t>(time(nullptr)) / ticket_key_period_;
+  if (derived_ticket_keys_[0].epoch == now)
+    return true;
+
+  static constexpr char kSalt[] = "node tls ticket keys";
+  const uint64_t epochs[kDerivedTicketKeyCount] = {now, now - 1, now + 1};
+  DerivedTicketKey keys[kDerivedTicketKeyCount];
+  for (size_t i = 0; i < kDerivedTicketKeyCount; i++) {
+    unsigned char info[sizeof(uint64_t)];
+    for (size_t n = 0; n < sizeof(info); n++)
+      info[n] = static_cast<unsigned char>(epochs[i] >> (8 * (7 - n)));
+
+    DataPointer out = ncrypto::hkdf(
+        Digest::SHA256,
+        {ticket_key_secret_.data(), ticket_key_secret_.size()},
+        {info, sizeof(info)},
+        {reinterpret_cast<const unsigned char*>(kSalt), sizeof(kSalt) - 1},
+        48);
+    if (!out) return false;
+    const unsigned char* data = static_cast<const unsigned char*>(out.get());
+    keys[i].epoch = epochs[i];
+    memcpy(keys[i].name, data, 16);
+    memcpy(keys[i].hmac, data + 16, 16);
+    memcpy(keys[i].aes, data + 32, 16);
+  }
+  memcpy(derived_ticket_keys_, keys, sizeof(keys));
+  OPENSSL_cleanse(keys, sizeof(keys));
+  return true;
+}
+
 // Currently, EnableTicketKeyCallback and TicketKeyCallback are only present for
 // the regression test in test/parallel/test-https-resume-after-renew.js.
 void SecureContext::EnableTicketKeyCallback(
@@ -2031,6 +2152,39 @@ int SecureContext::TicketCompatibilityCallback(SSL* ssl,
   SecureContext* sc = static_cast<SecureContext*>(
       SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl)));
 
+  if (!sc->ticket_key_secret_.empty()) {
+    if (!sc->UpdateDerivedTicketKeys()) return -1;
+
+    const DerivedTicketKey* key = nullptr;
+    if (enc) {
+      key = &sc->derived_ticket_keys_[0];
+      memcpy(name, key->name, sizeof(key->name));
+      if (!ncrypto::CSPRNG(iv, 16)) return -1;
+    } else {
+      for (const DerivedTicketKey& candidate : sc->derived_ticket_keys_) {
+        if (memcmp(name, candidate.name, sizeof(candidate.name)) == 0) {
+          key = &candidate;
+          break;
+        }
+      }
+      // Unknown or expired key, do a full handshake.
+      if (key == nullptr) return 0;
+    }
+
+    int init = enc ? EVP_EncryptInit_ex(
+                         ectx, Cipher::AES_128_CBC, nullptr, key->aes, iv)
+                   : EVP_DecryptInit_ex(
+                         ectx, Cipher::AES_128_CBC, nullptr, key->aes, iv);
+    if (init <= 0 ||
+        HMAC_Init_ex(
+            hctx, key->hmac, sizeof(key->hmac), Digest::SHA256, nullptr) <=
+            0) {
+      return -1;
+    }
+    // Ask for a fresh ticket if this one was issued in another period.
+    return !enc && key != &sc->derived_ticket_keys_[0] ? 2 : 1;
+  }
+
   if (enc) {
     memcpy(name, sc->ticket_key_name_, sizeof(sc->ticket_key_name_));
     if (!ncrypto::CSPRNG(iv, 16) ||
@@ -119,6 +119,8 @@ class SecureContext final : public BaseObject {
 #endif  // !OPENSSL_NO_ENGINE
   static void GetTicketKeys(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetTicketKeys(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetTicketKeySecret(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
   static void EnableTicketKeyCallback(
       const v8::FunctionCallbackInfo<v8::Value>& args);
   static void CtxGetter(const v8::FunctionCallbackInfo<v8::Value>& info);
@@ -144,6 +146,19 @@ class SecureContext final : public BaseObject {
   void Reset();
 
  private:
+  // Ticket keys derived from a secret shared by all workers, one set per
+  // rotation period. See SetTicketKeySecret().
+  struct DerivedTicketKey {
+    uint64_t epoch = UINT64_MAX;
+    unsigned char name[16];
+    unsigned char hmac[16];
+    unsigned char aes[16];
+  };
+  // Current, previous and next period, the latter covers clock skew.
+  static constexpr size_t kDerivedTicketKeyCount = 3;
+
+  bool UpdateDerivedTicketKeys();
+
   ncrypto::SSLCtxPointer ctx_;
   ncrypto::X509Pointer cert_;
   ncrypto::X509Pointer issuer_;
@@ -157,6 +172,10 @@ class SecureContext final : public BaseObject {
   unsigned char ticket_key_name_[16];
   unsigned char ticket_key_aes_[16];
   unsigned char ticket_key_hmac_[16];
+
+  std::vector<unsigned char> ticket_key_secret_;
+  uint64_t ticket_key_period_ = 0;
+  DerivedTicketKey derived_ticket_keys_[kDerivedTicketKeyCount];
 };
 
 int SSL_CTX_use_certificate_chain(SSL_CTX* ctx,
@@ -489,6 +489,11 @@ bool ECDHBitsTraits::DeriveBits(Environment* env,
   return true;
 }
 
+std::string EcKeyGenTraits::GetPoolKey(const EcKeyPairGenConfig& params) {
+  return "ec:" + std::to_string(params.params.curve_nid) + ":" +
+         std::to_string(params.params.param_encoding);
+}
+
 EVPKeyCtxPointer EcKeyGenTraits::Setup(EcKeyPairGenConfig* params) {
   EVPKeyCtxPointer key_ctx;
   switch (params->params.curve_nid) {
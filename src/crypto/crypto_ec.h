@@ -104,6 +104,7 @@ struct EcKeyGenTraits final {
   static constexpr const char* JobName = "EcKeyPairGenJob";
 
   static ncrypto::EVPKeyCtxPointer Setup(EcKeyPairGenConfig* params);
+  static std::string GetPoolKey(const EcKeyPairGenConfig& params);
 
   static v8::Maybe<void> AdditionalConfig(
       CryptoJobMode mode,
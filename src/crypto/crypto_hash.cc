@@ -14,6 +14,7 @@ namespace node {
 using ncrypto::DataPointer;
 using ncrypto::EVPMDCtxPointer;
 using ncrypto::MarkPopErrorOnReturn;
+using v8::Array;
 using v8::Context;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
@@ -279,6 +280,7 @@ void Hash::Initialize(Environment* env, Local<Object> target) {
   SetMethodNoSideEffect(context, target, "oneShotDigest", OneShotDigest);
 
   HashJob::Initialize(env, target);
+  BatchHashJob::Initialize(env, target);
 }
 
 void Hash::RegisterExternalReferences(ExternalReferenceRegistry* registry) {
@@ -290,6 +292,7 @@ void Hash::RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(OneShotDigest);
 
   HashJob::RegisterExternalReferences(registry);
+  BatchHashJob::RegisterExternalReferences(registry);
 }
 
 // new Hash(algorithm, algorithmId, xofLen, algorithmCache)
@@ -499,5 +502,138 @@ bool HashTraits::DeriveBits(
   return true;
 }
 
+BatchHashConfig::BatchHashConfig(BatchHashConfig&& other) noexcept
+    : mode(other.mode),
+      storage(std::move(other.storage)),
+      inputs(std::move(other.inputs)),
+      digest(other.digest),
+      length(other.length) {}
+
+BatchHashConfig& BatchHashConfig::operator=(BatchHashConfig&& other) noexcept {
+  if (&other == this) return *this;
+  this->~BatchHashConfig();
+  return *new (this) BatchHashConfig(std::move(other));
+}
+
+void BatchHashConfig::MemoryInfo(MemoryTracker* tracker) const {
+  // If the Job is sync, then the inputs are not owned.
+  if (mode == kCryptoJobAsync)
+    tracker->TrackFieldWithSize("storage", storage.size());
+}
+
+MaybeLocal<Value> BatchHashTraits::EncodeOutput(Environment* env,
+                                                const BatchHashConfig& params,
+                                                ByteSource* out) {
+  return out->ToArrayBuffer(env);
+}
+
+// BatchHashJob(mode, algorithm, inputs, outputLength)
+Maybe<void> BatchHashTraits::AdditionalConfig(
+    CryptoJobMode mode,
+    const FunctionCallbackInfo<Value>& args,
+    unsigned int offset,
+    BatchHashConfig* params) {
+  Environment* env = Environment::GetCurrent(args);
+
+  params->mode = mode;
+
+  CHECK(args[offset]->IsString());     // Hash algorithm
+  CHECK(args[offset + 1]->IsArray());  // Inputs
+  Utf8Value digest(env->isolate(), args[offset]);
+  params->digest = ncrypto::getDigestByName(*digest);
+  if (params->digest == nullptr) [[unlikely]] {
+    THROW_ERR_CRYPTO_INVALID_DIGEST(env, "Invalid digest: %s", *digest);
+    return Nothing<void>();
+  }
+
+  unsigned int expected = EVP_MD_size(params->digest);
+  params->length = expected;
+  if (args[offset + 2]->IsUint32()) [[unlikely]] {
+    // length is expressed in terms of bits
+    params->length =
+        static_cast<uint32_t>(args[offset + 2]
+            .As<Uint32>()->Value()) / CHAR_BIT;
+    if (params->length != expected) {
+      if ((EVP_MD_flags(params->digest) & EVP_MD_FLAG_XOF) == 0) [[unlikely]] {
+        THROW_ERR_CRYPTO_INVALID_DIGEST(env, "Digest method not supported");
+        return Nothing<void>();
+      }
+    }
+  }
+
+  Local<Array> inputs = args[offset + 1].As<Array>();
+  const uint32_t count = inputs->Length();
+  if (static_cast<uint64_t>(count) * params->length >
+      static_cast<uint64_t>(v8::TypedArray::kMaxByteLength)) [[unlikely]] {
+    THROW_ERR_OUT_OF_RANGE(env, "too many inputs");
+    return Nothing<void>();
+  }
+
+  LocalVector<Value> views(env->isolate(), count);
+  size_t total = 0;
+  for (uint32_t i = 0; i < count; i++) {
+    if (!inputs->Get(env->context(), i).ToLocal(&views[i]))
+      return Nothing<void>();
+    CHECK(IsAnyBufferSource(views[i]));
+    total += ArrayBufferOrViewContents<char>(views[i]).size();
+  }
+
+  // Async jobs copy everything into one allocation instead of one per input,
+  // sync jobs read straight from the JS buffers.
+  char* copy = nullptr;
+  if (mode == kCryptoJobAsync && total > 0) {
+    auto buf = DataPointer::Alloc(total);
+    if (!buf) [[unlikely]] {
+      THROW_ERR_MEMORY_ALLOCATION_FAILED(env);
+      return Nothing<void>();
+    }
+    copy = static_cast<char*>(buf.get());
+    params->storage = ByteSource::Allocated(buf.release());
+  }
+
+  params->inputs.reserve(count);
+  for (uint32_t i = 0; i < count; i++) {
+    ArrayBufferOrViewContents<char> data(views[i]);
+    const void* ptr = data.data();
+    if (copy != nullptr && data.size() > 0) {
+      memcpy(copy, data.data(), data.size());
+      ptr = copy;
+      copy += data.size();
+    }
+    params->inputs.push_back({ptr, data.size()});
+  }
+
+  return JustVoid();
+}
+
+bool BatchHashTraits::DeriveBits(
+    Environment* env,
+    const BatchHashConfig& params,
+    ByteSource* out) {
+  const size_t total = params.inputs.size() * params.length;
+  if (total == 0) return true;
+
+  auto buf = DataPointer::Alloc(total);
+  if (!buf) [[unlikely]]
+    return false;
+
+  // OpenSSL does not expose its multi-buffer SHA-256 outside of the stitched
+  // TLS ciphers, so the win here is one context reused for every input and
+  // one job, allocation and callback for the whole batch.
+  auto ctx = EVPMDCtxPointer::New();
+  char* dest = static_cast<char*>(buf.get());
+  for (const auto& input : params.inputs) {
+    ncrypto::Buffer<void> result{dest, params.length};
+    if (!ctx.digestInit(params.digest) || !ctx.digestUpdate(input) ||
+        !ctx.digestFinalInto(&result)) [[unlikely]] {
+      return false;
+    }
+    dest += params.length;
+  }
+
+  *out = ByteSource::Allocated(buf.release());
+  return true;
+}
+
 }  // namespace crypto
 }  // namespace node
@@ -82,6 +82,51 @@ struct HashTraits final {
 
 using HashJob = DeriveBitsJob<HashTraits>;
 
+// Hashes many inputs with the same digest in a single job. The digests are
+// written back to back into one output buffer, each `length` bytes long.
+struct BatchHashConfig final : public MemoryRetainer {
+  CryptoJobMode mode;
+  // Owns a contiguous copy of all inputs for async jobs, empty otherwise.
+  ByteSource storage;
+  std::vector<ncrypto::Buffer<const void>> inputs;
+  const EVP_MD* digest;
+  unsigned int length;
+
+  BatchHashConfig() = default;
+
+  explicit BatchHashConfig(BatchHashConfig&& other) noexcept;
+
+  BatchHashConfig& operator=(BatchHashConfig&& other) noexcept;
+
+  void MemoryInfo(MemoryTracker* tracker) const override;
+  SET_MEMORY_INFO_NAME(BatchHashConfig)
+  SET_SELF_SIZE(BatchHashConfig)
+};
+
+struct BatchHashTraits final {
+  using AdditionalParameters = BatchHashConfig;
+  static constexpr const char* JobName = "BatchHashJob";
+  static constexpr AsyncWrap::ProviderType Provider =
+      AsyncWrap::PROVIDER_HASHREQUEST;
+
+  static v8::Maybe<void> AdditionalConfig(
+      CryptoJobMode mode,
+      const v8::FunctionCallbackInfo<v8::Value>& args,
+      unsigned int offset,
+      BatchHashConfig* params);
+
+  static bool DeriveBits(
+      Environment* env,
+      const BatchHashConfig& params,
+      ByteSource* out);
+
+  static v8::MaybeLocal<v8::Value> EncodeOutput(Environment* env,
+                                                const BatchHashConfig& params,
+                                                ByteSource* out);
+};
+
+using BatchHashJob = DeriveBitsJob<BatchHashTraits>;
+
 }  // namespace crypto
 }  // namespace node
 
@@ -14,17 +14,109 @@ namespace node {
 
 using ncrypto::DataPointer;
 using ncrypto::EVPKeyCtxPointer;
+using ncrypto::EVPKeyPointer;
+using v8::Array;
 using v8::FunctionCallbackInfo;
 using v8::Int32;
+using v8::Number;
 using v8::JustVoid;
 using v8::Local;
 using v8::Maybe;
 using v8::MaybeLocal;
 using v8::Object;
+using v8::Task;
+using v8::TaskPriority;
 using v8::Uint32;
 using v8::Value;
 
 namespace crypto {
+KeyPairPool* KeyPairPool::GetInstance() {
+  // Leaked on purpose, refill tasks may still be running at exit.
+  static KeyPairPool* instance = new KeyPairPool();
+  return instance;
+}
+
+EVPKeyPointer KeyPairPool::Take(MultiIsolatePlatform* platform,
+                                const std::string& params,
+                                Generator generate) {
+  Mutex::ScopedLock lock(mutex_);
+  auto it = queues_.find(params);
+  if (it == queues_.end()) {
+    if (queues_.size() >= kMaxQueues) {
+      misses_++;
+      return {};
+    }
+    it = queues_.emplace(params, Queue{}).first;
+    it->second.generate = std::move(generate);
+  }
+
+  EVPKeyPointer key;
+  if (it->second.keys.empty()) {
+    misses_++;
+  } else {
+    hits_++;
+    key = std::move(it->second.keys.front());
+    it->second.keys.pop_front();
+  }
+  Refill(platform, params);
+  return key;
+}
+
+void KeyPairPool::Refill(MultiIsolatePlatform* platform,
+                         const std::string& params) {
+  class RefillTask final : public Task {
+   public:
+    RefillTask(std::string params, Generator generate)
+        : params_(std::move(params)), generate_(std::move(generate)) {}
+
+    void Run() override {
+      ncrypto::ClearErrorOnReturn clear_error_on_return;
+      KeyPairPool::GetInstance()->OnGenerated(params_, generate_());
+    }
+
+   private:
+    std::string params_;
+    Generator generate_;
+  };
+
+  Queue& queue = queues_[params];
+  size_t depth = depth_.load(std::memory_order_relaxed);
+  while (queue.keys.size() + queue.pending < depth) {
+    queue.pending++;
+    platform->PostTaskOnWorkerThread(
+        TaskPriority::kBestEffort,
+        std::make_unique<RefillTask>(params, queue.generate));
+  }
+}
+
+void KeyPairPool::OnGenerated(const std::string& params, EVPKeyPointer&& key) {
+  Mutex::ScopedLock lock(mutex_);
+  auto it = queues_.find(params);
+  CHECK(it != queues_.end());
+  it->second.pending--;
+  if (!key) return;
+  generated_++;
+  if (it->second.keys.size() < depth_.load(std::memory_order_relaxed))
+    it->second.keys.push_back(std::move(key));
+}
+
+void KeyPairPool::SetDepth(size_t depth) {
+  Mutex::ScopedLock lock(mutex_);
+  depth_.store(depth, std::memory_order_relaxed);
+  // The queues themselves are kept, refill tasks may still be pending.
+  for (auto& [params, queue] : queues_) {
+    if (queue.keys.size() > depth) queue.keys.resize(depth);
+  }
+}
+
+KeyPairPool::Stats KeyPairPool::GetStats() {
+  Mutex::ScopedLock lock(mutex_);
+  Stats stats{hits_, misses_, generated_, 0};
+  for (const auto& [params, queue] : queues_)
+    stats.available += queue.keys.size();
+  return stats;
+}
+
 // NidKeyPairGenJob input arguments:
 //   1. CryptoJobMode
 //   2. NID
@@ -47,6 +139,11 @@ Maybe<void> NidKeyPairGenTraits::AdditionalConfig(
   return JustVoid();
 }
 
+std::string NidKeyPairGenTraits::GetPoolKey(
+    const NidKeyPairGenConfig& params) {
+  return "nid:" + std::to_string(params.params.id);
+}
+
 EVPKeyCtxPointer NidKeyPairGenTraits::Setup(NidKeyPairGenConfig* params) {
   auto ctx = EVPKeyCtxPointer::NewFromID(params->params.id);
   if (!ctx || !ctx.initForKeygen()) return {};
@@ -87,14 +184,44 @@ MaybeLocal<Value> SecretKeyGenTraits::EncodeKey(Environment* env,
 }
 
 namespace Keygen {
+namespace {
+// configureKeyPairPool(depth) sets the number of keys kept ready for each
+// set of key pair generation parameters. Zero disables the pool.
+void ConfigureKeyPairPool(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args[0]->IsUint32());
+  KeyPairPool::GetInstance()->SetDepth(args[0].As<Uint32>()->Value());
+}
+
+// getKeyPairPoolStats() returns [hits, misses, generated, available].
+void GetKeyPairPoolStats(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  KeyPairPool::Stats stats = KeyPairPool::GetInstance()->GetStats();
+  Local<Value> values[] = {
+      Number::New(env->isolate(), static_cast<double>(stats.hits)),
+      Number::New(env->isolate(), static_cast<double>(stats.misses)),
+      Number::New(env->isolate(), static_cast<double>(stats.generated)),
+      Number::New(env->isolate(), static_cast<double>(stats.available)),
+  };
+  args.GetReturnValue().Set(
+      Array::New(env->isolate(), values, arraysize(values)));
+}
+}  // namespace
+
 void Initialize(Environment* env, Local<Object> target) {
   NidKeyPairGenJob::Initialize(env, target);
   SecretKeyGenJob::Initialize(env, target);
+
+  SetMethod(
+      env->context(), target, "configureKeyPairPool", ConfigureKeyPairPool);
+  SetMethodNoSideEffect(
+      env->context(), target, "getKeyPairPoolStats", GetKeyPairPoolStats);
 }
 
 void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   NidKeyPairGenJob::RegisterExternalReferences(registry);
   SecretKeyGenJob::RegisterExternalReferences(registry);
+  registry->Register(ConfigureKeyPairPool);
+  registry->Register(GetKeyPairPoolStats);
 }
 }  // namespace Keygen
 }  // namespace crypto
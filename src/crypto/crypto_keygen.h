@@ -9,8 +9,15 @@
 #include "crypto/crypto_util.h"
 #include "env.h"
 #include "memory_tracker.h"
+#include "node_mutex.h"
 #include "v8.h"
 
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <string>
+#include <unordered_map>
+
 namespace node::crypto {
 namespace Keygen {
 void Initialize(Environment* env, v8::Local<v8::Object> target);
@@ -22,6 +29,59 @@ enum class KeyGenJobStatus {
   FAILED
 };
 
+// Key pairs generated ahead of time on worker threads, so that bursts of
+// generateKeyPair() calls do not have to wait for slow algorithms such as
+// RSA. Disabled unless configureKeyPairPool() sets a depth. There is one
+// queue per set of generation parameters that has been requested, each
+// refilled up to the depth whenever a key is taken from it.
+class KeyPairPool final {
+ public:
+  using Generator = std::function<ncrypto::EVPKeyPointer()>;
+
+  static constexpr size_t kMaxQueues = 16;
+
+  static KeyPairPool* GetInstance();
+
+  bool enabled() const { return depth_.load(std::memory_order_relaxed) > 0; }
+
+  // Returns a key from the queue for `params`, a string identifying the
+  // generation parameters, or an empty pointer if there is none yet. The
+  // queue is then refilled with `generate` on worker threads of `platform`.
+  ncrypto::EVPKeyPointer Take(MultiIsolatePlatform* platform,
+                              const std::string& params,
+                              Generator generate);
+
+  // A depth of zero disables the pool and frees the keys in it.
+  void SetDepth(size_t depth);
+
+  struct Stats {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t generated;
+    uint64_t available;
+  };
+  Stats GetStats();
+
+ private:
+  struct Queue {
+    std::deque<ncrypto::EVPKeyPointer> keys;
+    size_t pending = 0;
+    Generator generate;
+  };
+
+  KeyPairPool() = default;
+
+  void Refill(MultiIsolatePlatform* platform, const std::string& params);
+  void OnGenerated(const std::string& params, ncrypto::EVPKeyPointer&& key);
+
+  Mutex mutex_;
+  std::atomic<size_t> depth_{0};
+  std::unordered_map<std::string, Queue> queues_;
+  uint64_t hits_ = 0;
+  uint64_t misses_ = 0;
+  uint64_t generated_ = 0;
+};
+
 // A Base CryptoJob for generating secret keys or key pairs.
 // The KeyGenTraits is largely responsible for the details of
 // the implementation, while KeyGenJob handles the common
@@ -159,21 +219,46 @@ struct KeyPairGenTraits final {
     return v8::JustVoid();
   }
 
-  static KeyGenJobStatus DoKeyGen(
-      Environment* env,
-      AdditionalParameters* params) {
+  static ncrypto::EVPKeyPointer Generate(AdditionalParameters* params) {
     ncrypto::EVPKeyCtxPointer ctx = KeyPairAlgorithmTraits::Setup(params);
 
     if (!ctx)
-      return KeyGenJobStatus::FAILED;
+      return {};
 
     // Generate the key
     EVP_PKEY* pkey = nullptr;
     if (!EVP_PKEY_keygen(ctx.get(), &pkey))
+      return {};
+
+    return ncrypto::EVPKeyPointer(pkey);
+  }
+
+  static KeyGenJobStatus DoKeyGen(
+      Environment* env,
+      AdditionalParameters* params) {
+    ncrypto::EVPKeyPointer pkey;
+
+    // Algorithms that can identify their parameters by a string can take
+    // their keys from the KeyPairPool.
+    if constexpr (requires { KeyPairAlgorithmTraits::GetPoolKey(*params); }) {
+      KeyPairPool* pool = KeyPairPool::GetInstance();
+      if (pool->enabled()) {
+        pkey = pool->Take(env->isolate_data()->platform(),
+                          KeyPairAlgorithmTraits::GetPoolKey(*params),
+                          [algorithm_params = params->params]() {
+                            AdditionalParameters config;
+                            config.params = algorithm_params;
+                            return Generate(&config);
+                          });
+      }
+    }
+
+    if (!pkey) pkey = Generate(params);
+    if (!pkey)
       return KeyGenJobStatus::FAILED;
 
     auto data = KeyObjectData::CreateAsymmetric(KeyType::kKeyTypePrivate,
-                                                ncrypto::EVPKeyPointer(pkey));
+                                                std::move(pkey));
     if (!data) [[unlikely]]
       return KeyGenJobStatus::FAILED;
     params->key = std::move(data);
@@ -273,6 +358,7 @@ struct NidKeyPairGenTraits final {
   static constexpr const char* JobName = "NidKeyPairGenJob";
 
   static ncrypto::EVPKeyCtxPointer Setup(NidKeyPairGenConfig* params);
+  static std::string GetPoolKey(const NidKeyPairGenConfig& params);
 
   static v8::Maybe<void> AdditionalConfig(
       CryptoJobMode mode,
@@ -46,6 +46,7 @@ struct PBKDF2Config final : public MemoryRetainer {
 struct PBKDF2Traits final {
   using AdditionalParameters = PBKDF2Config;
   static constexpr const char* JobName = "PBKDF2Job";
+  static constexpr const char* ThreadPoolWorkType = "crypto_kdf";
   static constexpr AsyncWrap::ProviderType Provider =
       AsyncWrap::PROVIDER_PBKDF2REQUEST;
 
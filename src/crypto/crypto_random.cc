@@ -4,6 +4,8 @@
 #include "env-inl.h"
 #include "memory_tracker-inl.h"
 #include "ncrypto.h"
+#include "node_debug.h"
+#include "node_errors.h"
 #include "threadpoolwork-inl.h"
 #include "v8.h"
 
@@ -16,7 +18,10 @@ using ncrypto::ClearErrorOnReturn;
 using ncrypto::DataPointer;
 using v8::ArrayBuffer;
 using v8::Boolean;
+using v8::CFunction;
+using v8::FastApiCallbackOptions;
 using v8::FunctionCallbackInfo;
+using v8::HandleScope;
 using v8::Int32;
 using v8::JustVoid;
 using v8::Local;
@@ -37,6 +42,133 @@ BignumPointer::PrimeCheckCallback getPrimeCheckCallback(Environment* env) {
   return [env](int a, int b) -> bool { return !env->is_stopping(); };
 }
 
+}  // namespace
+
+// Serves small random requests (UUIDs, IDs, getRandomValues() on a few
+// bytes) from a block of CSPRNG output generated ahead of time on the
+// threadpool, instead of entering OpenSSL for every call. The pool is the
+// binding data of the crypto binding, so it is only used from its realm's
+// thread, and the refill job writes into its own block, which is swapped in
+// on completion, so no locking is involved. Bytes are wiped from the block
+// as they are handed out.
+class RandomPool final : public BaseObject {
+ public:
+  static constexpr size_t kBlockSize = 4096;
+  // Larger requests go straight to the CSPRNG, which is efficient at that
+  // size and would otherwise drain the block.
+  static constexpr size_t kMaxPooledRequest = 256;
+  static constexpr size_t kRefillThreshold = kBlockSize / 4;
+
+  RandomPool(Realm* realm, Local<Object> wrap) : BaseObject(realm, wrap) {}
+
+  ~RandomPool() override {
+    if (refill_ != nullptr) refill_->pool_ = nullptr;
+    OPENSSL_cleanse(block_, kBlockSize);
+  }
+
+  SET_BINDING_ID(crypto_random_binding_data)
+
+  bool Fill(unsigned char* out, size_t size) {
+    if (size > kMaxPooledRequest) return ncrypto::CSPRNG(out, size);
+
+    if (kBlockSize - pos_ < size) {
+      // Drained before the refill arrived, top up synchronously.
+      if (!ncrypto::CSPRNG(block_, kBlockSize)) return false;
+      pos_ = 0;
+    }
+
+    memcpy(out, block_ + pos_, size);
+    OPENSSL_cleanse(block_ + pos_, size);
+    pos_ += size;
+
+    if (kBlockSize - pos_ < kRefillThreshold && refill_ == nullptr) {
+      refill_ = new RefillWork(env(), this);
+      refill_->ScheduleWork();
+    }
+    return true;
+  }
+
+  SET_NO_MEMORY_INFO()
+  SET_MEMORY_INFO_NAME(RandomPool)
+  SET_SELF_SIZE(RandomPool)
+
+ private:
+  class RefillWork final : public ThreadPoolWork {
+   public:
+    RefillWork(Environment* env, RandomPool* pool)
+        : ThreadPoolWork(env, "crypto"), pool_(pool) {}
+
+    void DoThreadPoolWork() override {
+      ok_ = ncrypto::CSPRNG(block_, kBlockSize);
+    }
+
+    void AfterThreadPoolWork(int status) override {
+      std::unique_ptr<RefillWork> self(this);
+      if (pool_ == nullptr) return;
+      pool_->refill_ = nullptr;
+      if (status == 0 && ok_) {
+        memcpy(pool_->block_, block_, kBlockSize);
+        pool_->pos_ = 0;
+      }
+    }
+
+    ~RefillWork() override { OPENSSL_cleanse(block_, kBlockSize); }
+
+    RandomPool* pool_;
+    bool ok_ = false;
+    unsigned char block_[kBlockSize];
+  };
+
+  RefillWork* refill_ = nullptr;
+  // Starts out empty, the first request fills it synchronously.
+  size_t pos_ = kBlockSize;
+  unsigned char block_[kBlockSize];
+};
+
+namespace {
+
+// secureRandomFill(buffer, offset, size)
+void SecureRandomFill(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  RandomPool* pool = Realm::GetBindingData<RandomPool>(args);
+  CHECK(IsAnyBufferSource(args[0]));  // Buffer to fill
+  CHECK(args[1]->IsUint32());  // Offset
+  CHECK(args[2]->IsUint32());  // Size
+
+  ArrayBufferOrViewContents<unsigned char> in(args[0]);
+  const uint32_t byte_offset = args[1].As<Uint32>()->Value();
+  const uint32_t size = args[2].As<Uint32>()->Value();
+  CHECK_GE(byte_offset + size, byte_offset);  // Overflow check.
+  CHECK_LE(byte_offset + size, in.size());  // Bounds check.
+
+  if (!pool->Fill(in.data() + byte_offset, size))
+    return THROW_ERR_CRYPTO_OPERATION_FAILED(env, "Error generating random");
+}
+
+bool FastSecureRandomFill(Local<Value> receiver,
+                          Local<Value> buffer,
+                          uint32_t byte_offset,
+                          uint32_t size,
+                          // NOLINTNEXTLINE(runtime/references)
+                          FastApiCallbackOptions& options) {
+  HandleScope scope(options.isolate);
+  ArrayBufferOrViewContents<unsigned char> in(buffer);
+  CHECK_GE(byte_offset + size, byte_offset);  // Overflow check.
+  CHECK_LE(byte_offset + size, in.size());  // Bounds check.
+  RandomPool* pool = Realm::GetCurrent(options.isolate)
+                         ->GetBindingData<RandomPool>();
+  if (!pool->Fill(in.data() + byte_offset, size)) {
+    TRACK_V8_FAST_API_CALL("crypto.secureRandomFill.error");
+    THROW_ERR_CRYPTO_OPERATION_FAILED(options.isolate,
+                                      "Error generating random");
+    return false;
+  }
+  TRACK_V8_FAST_API_CALL("crypto.secureRandomFill.ok");
+  return true;
+}
+
+CFunction fast_secure_random_fill(CFunction::Make(FastSecureRandomFill));
+
 }  // namespace
 MaybeLocal<Value> RandomBytesTraits::EncodeOutput(
     Environment* env, const RandomBytesConfig& params, ByteSource* unused) {
@@ -214,12 +346,22 @@ void Initialize(Environment* env, Local<Object> target) {
   RandomBytesJob::Initialize(env, target);
   RandomPrimeJob::Initialize(env, target);
   CheckPrimeJob::Initialize(env, target);
+  Realm::GetCurrent(target->GetCreationContextChecked())
+      ->AddBindingData<RandomPool>(target);
+  SetFastMethod(env->context(),
+                target,
+                "secureRandomFill",
+                SecureRandomFill,
+                &fast_secure_random_fill);
 }
 
 void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   RandomBytesJob::RegisterExternalReferences(registry);
   RandomPrimeJob::RegisterExternalReferences(registry);
   CheckPrimeJob::RegisterExternalReferences(registry);
+  registry->Register(SecureRandomFill);
+  registry->Register(FastSecureRandomFill);
+  registry->Register(fast_secure_random_fill.GetTypeInfo());
 }
 }  // namespace Random
 }  // namespace crypto
@@ -36,6 +36,18 @@ using v8::Uint32;
 using v8::Value;
 
 namespace crypto {
+std::string RsaKeyGenTraits::GetPoolKey(const RsaKeyPairGenConfig& params) {
+  const RsaKeyPairParams& rsa = params.params;
+  auto digest_type = [](const Digest& md) {
+    return md ? EVP_MD_type(md.get()) : 0;
+  };
+  return "rsa:" + std::to_string(rsa.variant) + ":" +
+         std::to_string(rsa.modulus_bits) + ":" + std::to_string(rsa.exponent) +
+         ":" + std::to_string(digest_type(rsa.md)) + ":" +
+         std::to_string(digest_type(rsa.mgf1_md)) + ":" +
+         std::to_string(rsa.saltlen);
+}
+
 EVPKeyCtxPointer RsaKeyGenTraits::Setup(RsaKeyPairGenConfig* params) {
   auto ctx = EVPKeyCtxPointer::NewFromID(
       params->params.variant == kKeyVariantRSA_PSS ? EVP_PKEY_RSA_PSS
@@ -42,6 +42,7 @@ struct RsaKeyGenTraits final {
   static constexpr const char* JobName = "RsaKeyPairGenJob";
 
   static ncrypto::EVPKeyCtxPointer Setup(RsaKeyPairGenConfig* params);
+  static std::string GetPoolKey(const RsaKeyPairGenConfig& params);
 
   static v8::Maybe<void> AdditionalConfig(
       CryptoJobMode mode,
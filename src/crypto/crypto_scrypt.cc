@@ -4,9 +4,15 @@
 #include "env-inl.h"
 #include "memory_tracker-inl.h"
 #include "node_buffer.h"
+#include "node_mutex.h"
 #include "threadpoolwork-inl.h"
 #include "v8.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+
 namespace node {
 
 using v8::FunctionCallbackInfo;
@@ -21,6 +27,225 @@ using v8::Value;
 namespace crypto {
 #ifndef OPENSSL_NO_SCRYPT
 
+namespace {
+
+// OpenSSL's limit when maxmem is 0.
+constexpr uint64_t kDefaultScryptMaxMem = 32 * 1024 * 1024;
+
+inline uint32_t Rotl32(uint32_t value, int shift) {
+  return (value << shift) | (value >> (32 - shift));
+}
+
+// The Salsa20/8 core from RFC 7914, section 3.
+void Salsa20_8(uint32_t b[16]) {
+  uint32_t x[16];
+  memcpy(x, b, sizeof(x));
+  for (int i = 0; i < 8; i += 2) {
+    // Columns.
+    x[4] ^= Rotl32(x[0] + x[12], 7);
+    x[8] ^= Rotl32(x[4] + x[0], 9);
+    x[12] ^= Rotl32(x[8] + x[4], 13);
+    x[0] ^= Rotl32(x[12] + x[8], 18);
+    x[9] ^= Rotl32(x[5] + x[1], 7);
+    x[13] ^= Rotl32(x[9] + x[5], 9);
+    x[1] ^= Rotl32(x[13] + x[9], 13);
+    x[5] ^= Rotl32(x[1] + x[13], 18);
+    x[14] ^= Rotl32(x[10] + x[6], 7);
+    x[2] ^= Rotl32(x[14] + x[10], 9);
+    x[6] ^= Rotl32(x[2] + x[14], 13);
+    x[10] ^= Rotl32(x[6] + x[2], 18);
+    x[3] ^= Rotl32(x[15] + x[11], 7);
+    x[7] ^= Rotl32(x[3] + x[15], 9);
+    x[11] ^= Rotl32(x[7] + x[3], 13);
+    x[15] ^= Rotl32(x[11] + x[7], 18);
+    // Rows.
+    x[1] ^= Rotl32(x[0] + x[3], 7);
+    x[2] ^= Rotl32(x[1] + x[0], 9);
+    x[3] ^= Rotl32(x[2] + x[1], 13);
+    x[0] ^= Rotl32(x[3] + x[2], 18);
+    x[6] ^= Rotl32(x[5] + x[4], 7);
+    x[7] ^= Rotl32(x[6] + x[5], 9);
+    x[4] ^= Rotl32(x[7] + x[6], 13);
+    x[5] ^= Rotl32(x[4] + x[7], 18);
+    x[11] ^= Rotl32(x[10] + x[9], 7);
+    x[8] ^= Rotl32(x[11] + x[10], 9);
+    x[9] ^= Rotl32(x[8] + x[11], 13);
+    x[10] ^= Rotl32(x[9] + x[8], 18);
+    x[12] ^= Rotl32(x[15] + x[14], 7);
+    x[13] ^= Rotl32(x[12] + x[15], 9);
+    x[14] ^= Rotl32(x[13] + x[12], 13);
+    x[15] ^= Rotl32(x[14] + x[13], 18);
+  }
+  for (int i = 0; i < 16; i++) b[i] += x[i];
+}
+
+// scryptBlockMix from RFC 7914, section 4, on 2 * r blocks of 16 words.
+void BlockMix(const uint32_t* in, uint32_t* out, uint32_t r) {
+  uint32_t x[16];
+  memcpy(x, in + (2 * r - 1) * 16, sizeof(x));
+  for (uint32_t i = 0; i < 2 * r; i++) {
+    for (int k = 0; k < 16; k++) x[k] ^= in[i * 16 + k];
+    Salsa20_8(x);
+    // Even blocks go to the first half of the output, odd ones to the second.
+    memcpy(out + ((i / 2) + (i & 1) * r) * 16, x, sizeof(x));
+  }
+}
+
+// The memory one lane needs besides its block: V and two blocks for
+// BlockMix(), in words.
+inline size_t LaneScratchWords(uint64_t N, uint32_t r) {
+  return 32 * static_cast<size_t>(r) * (static_cast<size_t>(N) + 2);
+}
+
+// scryptROMix from RFC 7914, section 5, in place on one lane of 32 * r words.
+void ROMix(uint32_t* b, uint64_t N, uint32_t r, uint32_t* scratch) {
+  const size_t lane_words = 32 * static_cast<size_t>(r);
+  uint32_t* v = scratch;
+  uint32_t* x = scratch + N * lane_words;
+  uint32_t* y = x + lane_words;
+  memcpy(x, b, lane_words * sizeof(*x));
+  for (uint64_t i = 0; i < N; i++) {
+    memcpy(v + i * lane_words, x, lane_words * sizeof(*x));
+    BlockMix(x, y, r);
+    std::swap(x, y);
+  }
+  for (uint64_t i = 0; i < N; i++) {
+    // Integerify(): N is a power of two below 2^32 here, so the low word of
+    // the last block is enough.
+    uint64_t j = x[(2 * r - 1) * 16] & (N - 1);
+    const uint32_t* vj = v + j * lane_words;
+    for (size_t k = 0; k < lane_words; k++) x[k] ^= vj[k];
+    BlockMix(x, y, r);
+    std::swap(x, y);
+  }
+  memcpy(b, x, lane_words * sizeof(*x));
+}
+
+// The lanes of one derivation, shared by the deriving thread and the helper
+// threads. Every thread takes lanes until none are left, so the derivation
+// finishes even if no helper could be started.
+struct ScryptLanes {
+  ScryptLanes(uint64_t N, uint32_t r, uint32_t p)
+      : N(N), r(r), p(p), words(static_cast<size_t>(p) * 32 * r) {}
+  ~ScryptLanes() { OPENSSL_cleanse(words.data(), words.size() * 4); }
+
+  // Returns false if the scratch memory could not be allocated.
+  bool Run() {
+    // Helpers that start late must not allocate scratch memory for nothing.
+    if (next.load() >= p) return true;
+    size_t scratch_words = LaneScratchWords(N, r);
+    std::unique_ptr<uint32_t[]> scratch(new (std::nothrow)
+                                            uint32_t[scratch_words]);
+    if (!scratch) return false;
+    uint32_t lane;
+    while ((lane = next.fetch_add(1)) < p) {
+      ROMix(words.data() + static_cast<size_t>(lane) * 32 * r,
+            N,
+            r,
+            scratch.get());
+      Mutex::ScopedLock lock(mutex);
+      if (++done == p) finished.Broadcast(lock);
+    }
+    OPENSSL_cleanse(scratch.get(), scratch_words * sizeof(uint32_t));
+    return true;
+  }
+
+  const uint64_t N;
+  const uint32_t r;
+  const uint32_t p;
+  std::vector<uint32_t> words;
+  std::atomic<uint32_t> next{0};
+  Mutex mutex;
+  ConditionVariable finished;
+  uint32_t done = 0;
+};
+
+}  // namespace
+
+size_t ScryptParallelism(const ScryptConfig& params, size_t max_threads) {
+  if (params.p <= 1 || max_threads <= 1) return 1;
+  uint64_t maxmem =
+      params.maxmem == 0 ? kDefaultScryptMaxMem : params.maxmem;
+  uint64_t block_bytes = uint64_t{128} * params.r * params.p;
+  uint64_t lane_bytes = LaneScratchWords(params.N, params.r) * 4;
+  if (block_bytes + lane_bytes > maxmem) return 1;
+  // Lanes running at the same time each need their own scratch memory, and
+  // together they must stay within maxmem like the sequential derivation.
+  uint64_t by_memory = (maxmem - block_bytes) / lane_bytes;
+  return static_cast<size_t>(
+      std::min<uint64_t>({params.p, max_threads, by_memory}));
+}
+
+bool ScryptParallel(const ScryptConfig& params,
+                    size_t threads,
+                    ByteSource* out) {
+  ncrypto::Buffer<const char> pass{
+      .data = params.pass.data<char>(),
+      .len = params.pass.size(),
+  };
+  auto lanes = std::make_shared<ScryptLanes>(params.N, params.r, params.p);
+
+  // B = PBKDF2-HMAC-SHA256(P, S, 1, p * 128 * r), read as little-endian words.
+  auto b = ncrypto::pbkdf2(ncrypto::Digest::SHA256,
+                           pass,
+                           ncrypto::Buffer<const unsigned char>{
+                               .data = params.salt.data<unsigned char>(),
+                               .len = params.salt.size(),
+                           },
+                           1,
+                           lanes->words.size() * 4);
+  if (!b) return false;
+  const uint8_t* b_bytes = static_cast<const uint8_t*>(b.get());
+  for (size_t i = 0; i < lanes->words.size(); i++) {
+    const uint8_t* w = b_bytes + i * 4;
+    lanes->words[i] = uint32_t{w[0]} | uint32_t{w[1]} << 8 |
+                      uint32_t{w[2]} << 16 | uint32_t{w[3]} << 24;
+  }
+
+  // The helpers are threads of their own. A lane takes tens of milliseconds
+  // or more, which would keep the V8 platform's workers from GC tasks, and
+  // uv_queue_work() can only be called on the event loop's thread.
+  std::vector<uv_thread_t> helpers(threads - 1);
+  size_t started = 0;
+  for (; started < helpers.size(); started++) {
+    if (uv_thread_create(
+            &helpers[started],
+            [](void* arg) { static_cast<ScryptLanes*>(arg)->Run(); },
+            lanes.get()) != 0) {
+      break;
+    }
+  }
+  bool ok = lanes->Run();
+  if (ok) {
+    Mutex::ScopedLock lock(lanes->mutex);
+    while (lanes->done < params.p) lanes->finished.Wait(lock);
+  }
+  for (size_t i = 0; i < started; i++) CHECK_EQ(uv_thread_join(&helpers[i]), 0);
+  if (!ok) return false;
+
+  // DK = PBKDF2-HMAC-SHA256(P, B, 1, dkLen)
+  uint8_t* mixed = static_cast<uint8_t*>(b.get());
+  for (size_t i = 0; i < lanes->words.size(); i++) {
+    uint32_t word = lanes->words[i];
+    mixed[i * 4] = static_cast<uint8_t>(word);
+    mixed[i * 4 + 1] = static_cast<uint8_t>(word >> 8);
+    mixed[i * 4 + 2] = static_cast<uint8_t>(word >> 16);
+    mixed[i * 4 + 3] = static_cast<uint8_t>(word >> 24);
+  }
+  auto dp = ncrypto::pbkdf2(ncrypto::Digest::SHA256,
+                            pass,
+                            ncrypto::Buffer<const unsigned char>{
+                                .data = mixed,
+                                .len = b.size(),
+                            },
+                            1,
+                            params.length);
+  OPENSSL_cleanse(b.get(), b.size());
+  if (!dp) return false;
+  *out = ByteSource::Allocated(dp.release());
+  return true;
+}
+
 ScryptConfig::ScryptConfig(ScryptConfig&& other) noexcept
   : mode(other.mode),
     pass(std::move(other.pass)),
@@ -124,6 +349,12 @@ bool ScryptTraits::DeriveBits(
     return true;
   }
 
+  // OpenSSL derives the p lanes one after another. Run them on helper
+  // threads as well, rather than occupying more threads of the libuv
+  // threadpool.
+  size_t threads = ScryptParallelism(params, uv_available_parallelism());
+  if (threads > 1) return ScryptParallel(params, threads, out);
+
   auto dp = ncrypto::scrypt(
       ncrypto::Buffer<const char>{
           .data = params.pass.data<char>(),
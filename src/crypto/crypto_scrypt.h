@@ -48,6 +48,7 @@ struct ScryptConfig final : public MemoryRetainer {
 struct ScryptTraits final {
   using AdditionalParameters = ScryptConfig;
   static constexpr const char* JobName = "ScryptJob";
+  static constexpr const char* ThreadPoolWorkType = "crypto_kdf";
   static constexpr AsyncWrap::ProviderType Provider =
       AsyncWrap::PROVIDER_SCRYPTREQUEST;
 
@@ -69,6 +70,16 @@ struct ScryptTraits final {
 
 using ScryptJob = DeriveBitsJob<ScryptTraits>;
 
+// Returns on how many threads, at most `max_threads`, the lanes of a
+// derivation with `params` can run without exceeding params.maxmem.
+size_t ScryptParallelism(const ScryptConfig& params, size_t max_threads);
+
+// Derives the same key as ncrypto::scrypt(), but runs the p lanes on the
+// calling thread and up to `threads - 1` helper threads.
+bool ScryptParallel(const ScryptConfig& params,
+                    size_t threads,
+                    ByteSource* out);
+
 #else
 // If there is no Scrypt support, ScryptJob becomes a non-op
 struct ScryptJob {
@@ -20,6 +20,7 @@ using ncrypto::ECDSASigPointer;
 using ncrypto::EVPKeyCtxPointer;
 using ncrypto::EVPKeyPointer;
 using ncrypto::EVPMDCtxPointer;
+using v8::Array;
 using v8::ArrayBuffer;
 using v8::BackingStore;
 using v8::BackingStoreInitializationMode;
@@ -31,6 +32,7 @@ using v8::Int32;
 using v8::Isolate;
 using v8::JustVoid;
 using v8::Local;
+using v8::LocalVector;
 using v8::Maybe;
 using v8::MaybeLocal;
 using v8::Nothing;
@@ -228,6 +230,63 @@ void CheckThrow(Environment* env, SignBase::Error error) {
 bool UseP1363Encoding(const EVPKeyPointer& key, const DSASigEnc dsa_encoding) {
   return key.isSigVariant() && dsa_encoding == DSASigEnc::P1363;
 }
+
+// Initializes `context` for signing or verifying with `key`, including the
+// RSA padding options.
+SignBase::Error InitContext(EVPMDCtxPointer* context,
+                            SignConfiguration::Mode mode,
+                            const EVPKeyPointer& key,
+                            const Digest& digest,
+                            int padding,
+                            std::optional<int> salt_length) {
+  auto pkctx = ([&] {
+    switch (mode) {
+      case SignConfiguration::Mode::Sign:
+        return context->signInit(key, digest);
+      case SignConfiguration::Mode::Verify:
+        return context->verifyInit(key, digest);
+    }
+    UNREACHABLE();
+  })();
+
+  if (!pkctx.has_value()) [[unlikely]]
+    return SignBase::Error::Init;
+
+  if (!ApplyRSAOptions(key, *pkctx, padding, salt_length)) [[unlikely]]
+    return SignBase::Error::PrivateKey;
+
+  return SignBase::Error::Ok;
+}
+
+// Signs `data` with a `context` that InitContext() prepared for signing.
+bool SignWithContext(Environment* env,
+                     const EVPMDCtxPointer& context,
+                     const EVPKeyPointer& key,
+                     DSASigEnc dsa_encoding,
+                     const ByteSource& data,
+                     ByteSource* out) {
+  if (key.isOneShotVariant()) {
+    auto sig = context.signOneShot(data);
+    if (!sig) [[unlikely]]
+      return false;
+    DCHECK(!sig.isSecure());
+    *out = ByteSource::Allocated(sig.release());
+    return true;
+  }
+
+  auto sig = context.sign(data);
+  if (!sig) [[unlikely]]
+    return false;
+  DCHECK(!sig.isSecure());
+  auto bs = ByteSource::Allocated(sig.release());
+
+  if (UseP1363Encoding(key, dsa_encoding)) {
+    *out = ConvertSignatureToP1363(env, key, std::move(bs));
+  } else {
+    *out = std::move(bs);
+  }
+  return true;
+}
 }  // namespace
 
 SignBase::Error SignBase::Init(const char* digest) {
@@ -644,21 +703,6 @@ bool SignTraits::DeriveBits(
     return false;
   const auto& key = params.key.GetAsymmetricKey();
 
-  auto ctx = ([&] {
-    switch (params.mode) {
-      case SignConfiguration::Mode::Sign:
-        return context.signInit(key, params.digest);
-      case SignConfiguration::Mode::Verify:
-        return context.verifyInit(key, params.digest);
-    }
-    UNREACHABLE();
-  })();
-
-  if (!ctx.has_value()) [[unlikely]] {
-    crypto::CheckThrow(env, SignBase::Error::Init);
-    return false;
-  }
-
   int padding = params.flags & SignConfiguration::kHasPadding
                     ? params.padding
                     : key.getDefaultSignPadding();
@@ -668,35 +712,20 @@ bool SignTraits::DeriveBits(
           ? std::optional<int>(params.salt_length)
           : std::nullopt;
 
-  if (!ApplyRSAOptions(key, *ctx, padding, salt_length)) {
-    crypto::CheckThrow(env, SignBase::Error::PrivateKey);
+  SignBase::Error error = InitContext(
+      &context, params.mode, key, params.digest, padding, salt_length);
+  if (error != SignBase::Error::Ok) [[unlikely]] {
+    crypto::CheckThrow(env, error);
     return false;
   }
 
   switch (params.mode) {
     case SignConfiguration::Mode::Sign: {
-      if (key.isOneShotVariant()) {
-        auto data = context.signOneShot(params.data);
-        if (!data) [[unlikely]] {
-          crypto::CheckThrow(env, SignBase::Error::PrivateKey);
-          return false;
-        }
-        DCHECK(!data.isSecure());
-        *out = ByteSource::Allocated(data.release());
-      } else {
-        auto data = context.sign(params.data);
-        if (!data) [[unlikely]] {
-          crypto::CheckThrow(env, SignBase::Error::PrivateKey);
-          return false;
-        }
-        DCHECK(!data.isSecure());
-        auto bs = ByteSource::Allocated(data.release());
-
-        if (UseP1363Encoding(key, params.dsa_encoding)) {
-          *out = ConvertSignatureToP1363(env, key, std::move(bs));
-        } else {
-          *out = std::move(bs);
-        }
+      if (!SignWithContext(
+              env, context, key, params.dsa_encoding, params.data, out))
+          [[unlikely]] {
+        crypto::CheckThrow(env, SignBase::Error::PrivateKey);
+        return false;
       }
       break;
     }
@@ -725,5 +754,343 @@ MaybeLocal<Value> SignTraits::EncodeOutput(Environment* env,
   UNREACHABLE();
 }
 
+SignContext::Prototype::Prototype(SignConfiguration::Mode mode,
+                                  KeyObjectData&& key,
+                                  DSASigEnc dsa_encoding,
+                                  EVPMDCtxPointer&& ctx)
+    : mode_(mode),
+      key_(std::move(key)),
+      dsa_encoding_(dsa_encoding),
+      ctx_(std::move(ctx)) {}
+
+EVPMDCtxPointer SignContext::Prototype::Copy() const {
+  auto ctx = EVPMDCtxPointer::New();
+  if (!ctx) [[unlikely]]
+    return {};
+  Mutex::ScopedLock lock(mutex_);
+  if (!ctx_.copyTo(ctx)) [[unlikely]]
+    return {};
+  return ctx;
+}
+
+bool SignContext::Prototype::Sign(Environment* env,
+                                  const ByteSource& data,
+                                  ByteSource* out) const {
+  CHECK_EQ(mode_, SignConfiguration::Mode::Sign);
+  auto ctx = Copy();
+  if (!ctx) [[unlikely]]
+    return false;
+  return SignWithContext(
+      env, ctx, key_.GetAsymmetricKey(), dsa_encoding_, data, out);
+}
+
+bool SignContext::Prototype::Verify(const ByteSource& data,
+                                    const ByteSource& signature) const {
+  CHECK_EQ(mode_, SignConfiguration::Mode::Verify);
+  auto ctx = Copy();
+  return ctx && ctx.verify(data, signature);
+}
+
+SignContext::SignContext(Environment* env,
+                         Local<Object> wrap,
+                         std::shared_ptr<Prototype> prototype)
+    : BaseObject(env, wrap), prototype_(std::move(prototype)) {
+  MakeWeak();
+}
+
+void SignContext::MemoryInfo(MemoryTracker* tracker) const {
+  tracker->TrackField("key", prototype_->key());
+  tracker->TrackFieldWithSize("ctx", kSizeOf_EVP_MD_CTX);
+}
+
+void SignContext::Initialize(Environment* env, Local<Object> target) {
+  Isolate* isolate = env->isolate();
+  Local<FunctionTemplate> t = NewFunctionTemplate(isolate, New);
+
+  t->InstanceTemplate()->SetInternalFieldCount(
+      SignContext::kInternalFieldCount);
+
+  SetProtoMethod(isolate, t, "sign", Sign);
+  SetProtoMethod(isolate, t, "verify", Verify);
+
+  SetConstructorFunction(env->context(), target, "SignContext", t);
+
+  SignBatchJob::Initialize(env, target);
+}
+
+void SignContext::RegisterExternalReferences(
+    ExternalReferenceRegistry* registry) {
+  registry->Register(New);
+  registry->Register(Sign);
+  registry->Register(Verify);
+  SignBatchJob::RegisterExternalReferences(registry);
+}
+
+// new SignContext(mode, key..., digest, saltLength, padding, dsaEncoding)
+// with the same key, digest and options as the arguments of SignJob.
+void SignContext::New(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  ClearErrorOnReturn clear_error_on_return;
+
+  CHECK(args.IsConstructCall());
+  CHECK(args[0]->IsUint32());
+  auto mode =
+      static_cast<SignConfiguration::Mode>(args[0].As<Uint32>()->Value());
+
+  unsigned int offset = 1;
+  KeyObjectData data =
+      mode == SignConfiguration::Mode::Verify
+          ? KeyObjectData::GetPublicOrPrivateKeyFromJs(args, &offset)
+          : KeyObjectData::GetPrivateKeyFromJs(args, &offset, true);
+  if (!data) [[unlikely]]
+    return;
+  const auto& key = data.GetAsymmetricKey();
+
+  Digest digest;
+  if (args[offset]->IsString()) {
+    Utf8Value name(env->isolate(), args[offset]);
+    digest = Digest::FromName(*name);
+    if (!digest) [[unlikely]]
+      return THROW_ERR_CRYPTO_INVALID_DIGEST(env, "Invalid digest: %s", *name);
+  }
+
+  std::optional<int> salt_length;
+  if (args[offset + 1]->IsInt32())
+    salt_length = GetSaltLenFromJS(args[offset + 1]);
+  int padding = key.getDefaultSignPadding();
+  if (args[offset + 2]->IsUint32())
+    padding = GetPaddingFromJS(key, args[offset + 2]);
+  DSASigEnc dsa_encoding = DSASigEnc::DER;
+  if (args[offset + 3]->IsUint32()) {
+    dsa_encoding = GetDSASigEncFromJS(args[offset + 3]);
+    if (dsa_encoding == DSASigEnc::Invalid) [[unlikely]]
+      return THROW_ERR_OUT_OF_RANGE(env, "invalid signature encoding");
+  }
+
+  auto ctx = EVPMDCtxPointer::New();
+  if (!ctx) [[unlikely]]
+    return crypto::CheckThrow(env, SignBase::Error::Init);
+  SignBase::Error error =
+      InitContext(&ctx, mode, key, digest, padding, salt_length);
+  if (error != SignBase::Error::Ok) [[unlikely]]
+    return crypto::CheckThrow(env, error);
+
+  new SignContext(env,
+                  args.This(),
+                  std::make_shared<Prototype>(
+                      mode, std::move(data), dsa_encoding, std::move(ctx)));
+}
+
+// signContext.sign(data) returns the signature of `data` as a Buffer.
+void SignContext::Sign(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  ClearErrorOnReturn clear_error_on_return;
+  SignContext* context;
+  ASSIGN_OR_RETURN_UNWRAP(&context, args.This());
+
+  ArrayBufferOrViewContents<char> data(args[0]);
+  if (!data.CheckSizeInt32()) [[unlikely]]
+    return THROW_ERR_OUT_OF_RANGE(env, "data is too big");
+
+  ByteSource out;
+  if (!context->prototype_->Sign(env, data.ToByteSource(), &out)) [[unlikely]]
+    return crypto::CheckThrow(env, SignBase::Error::PrivateKey);
+
+  Local<Value> ret;
+  if (out.ToBuffer(env).ToLocal(&ret)) args.GetReturnValue().Set(ret);
+}
+
+namespace {
+bool GetVerifySignature(Environment* env,
+                        const KeyObjectData& key,
+                        DSASigEnc dsa_encoding,
+                        CryptoJobMode mode,
+                        Local<Value> value,
+                        ByteSource* out) {
+  ArrayBufferOrViewContents<char> signature(value);
+  if (!signature.CheckSizeInt32()) [[unlikely]] {
+    THROW_ERR_OUT_OF_RANGE(env, "signature is too big");
+    return false;
+  }
+  const auto& akey = key.GetAsymmetricKey();
+  if (UseP1363Encoding(akey, dsa_encoding)) {
+    *out = ConvertSignatureToDER(akey, signature.ToByteSource());
+  } else {
+    *out = mode == kCryptoJobAsync ? signature.ToCopy()
+                                   : signature.ToByteSource();
+  }
+  return true;
+}
+}  // namespace
+
+// signContext.verify(data, signature) returns whether `signature` is a valid
+// signature of `data`.
+void SignContext::Verify(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  ClearErrorOnReturn clear_error_on_return;
+  SignContext* context;
+  ASSIGN_OR_RETURN_UNWRAP(&context, args.This());
+  const Prototype& prototype = *context->prototype_;
+
+  ArrayBufferOrViewContents<char> data(args[0]);
+  if (!data.CheckSizeInt32()) [[unlikely]]
+    return THROW_ERR_OUT_OF_RANGE(env, "data is too big");
+
+  ByteSource signature;
+  if (!GetVerifySignature(env,
+                          prototype.key(),
+                          prototype.dsa_encoding(),
+                          kCryptoJobSync,
+                          args[1],
+                          &signature)) {
+    return;
+  }
+
+  args.GetReturnValue().Set(
+      prototype.Verify(data.ToByteSource(), signature));
+}
+
+void SignBatchConfiguration::MemoryInfo(MemoryTracker* tracker) const {
+  if (job_mode == kCryptoJobAsync) {
+    size_t size = 0;
+    for (const ByteSource& item : data) size += item.size();
+    for (const ByteSource& item : signatures) size += item.size();
+    tracker->TrackFieldWithSize("data", size);
+  }
+}
+
+// new SignBatchJob(jobMode, signContext, data[, signatures]) signs each
+// element of the `data` array, or verifies it against the element of the
+// `signatures` array with the same index.
+Maybe<void> SignBatchTraits::AdditionalConfig(
+    CryptoJobMode mode,
+    const FunctionCallbackInfo<Value>& args,
+    unsigned int offset,
+    SignBatchConfiguration* params) {
+  Environment* env = Environment::GetCurrent(args);
+  ClearErrorOnReturn clear_error_on_return;
+
+  params->job_mode = mode;
+
+  CHECK(args[offset]->IsObject());
+  SignContext* context;
+  ASSIGN_OR_RETURN_UNWRAP(
+      &context, args[offset].As<Object>(), Nothing<void>());
+  params->prototype = context->prototype();
+  const SignContext::Prototype& prototype = *params->prototype;
+
+  CHECK(args[offset + 1]->IsArray());
+  Local<Array> data = args[offset + 1].As<Array>();
+  bool verify = prototype.mode() == SignConfiguration::Mode::Verify;
+  Local<Array> signatures;
+  if (verify) {
+    CHECK(args[offset + 2]->IsArray());
+    signatures = args[offset + 2].As<Array>();
+    CHECK_EQ(signatures->Length(), data->Length());
+  }
+
+  params->data.reserve(data->Length());
+  for (uint32_t i = 0; i < data->Length(); i++) {
+    Local<Value> item;
+    if (!data->Get(env->context(), i).ToLocal(&item)) return Nothing<void>();
+    CHECK(IsAnyBufferSource(item));
+    ArrayBufferOrViewContents<char> contents(item);
+    if (!contents.CheckSizeInt32()) [[unlikely]] {
+      THROW_ERR_OUT_OF_RANGE(env, "data is too big");
+      return Nothing<void>();
+    }
+    params->data.push_back(mode == kCryptoJobAsync ? contents.ToCopy()
+                                                   : contents.ToByteSource());
+    if (!verify) continue;
+
+    ByteSource signature;
+    if (!signatures->Get(env->context(), i).ToLocal(&item) ||
+        !GetVerifySignature(env,
+                            prototype.key(),
+                            prototype.dsa_encoding(),
+                            mode,
+                            item,
+                            &signature)) {
+      return Nothing<void>();
+    }
+    params->signatures.push_back(std::move(signature));
+  }
+
+  return JustVoid();
+}
+
+// The signatures are written to `out` one after another, each preceded by
+// its length as a uint32_t. The results of verification are one byte each.
+bool SignBatchTraits::DeriveBits(Environment* env,
+                                 const SignBatchConfiguration& params,
+                                 ByteSource* out) {
+  ClearErrorOnReturn clear_error_on_return;
+  const SignContext::Prototype& prototype = *params.prototype;
+
+  if (prototype.mode() == SignConfiguration::Mode::Verify) {
+    auto buf = DataPointer::Alloc(std::max<size_t>(params.data.size(), 1));
+    if (!buf) [[unlikely]]
+      return false;
+    char* results = static_cast<char*>(buf.get());
+    for (size_t i = 0; i < params.data.size(); i++) {
+      results[i] = prototype.Verify(params.data[i], params.signatures[i]);
+    }
+    *out = ByteSource::Allocated(buf.release());
+    return true;
+  }
+
+  std::vector<ByteSource> signatures(params.data.size());
+  size_t size = 0;
+  for (size_t i = 0; i < params.data.size(); i++) {
+    if (!prototype.Sign(env, params.data[i], &signatures[i])) [[unlikely]] {
+      crypto::CheckThrow(env, SignBase::Error::PrivateKey);
+      return false;
+    }
+    size += sizeof(uint32_t) + signatures[i].size();
+  }
+
+  auto buf = DataPointer::Alloc(std::max<size_t>(size, 1));
+  if (!buf) [[unlikely]]
+    return false;
+  char* ptr = static_cast<char*>(buf.get());
+  for (const ByteSource& signature : signatures) {
+    uint32_t length = signature.size();
+    memcpy(ptr, &length, sizeof(length));
+    ptr += sizeof(length);
+    if (length > 0) memcpy(ptr, signature.data(), length);
+    ptr += length;
+  }
+  *out = ByteSource::Allocated(buf.release());
+  return true;
+}
+
+// Returns an array with an ArrayBuffer for each signature, or a boolean for
+// each verification.
+MaybeLocal<Value> SignBatchTraits::EncodeOutput(
+    Environment* env, const SignBatchConfiguration& params, ByteSource* out) {
+  Isolate* isolate = env->isolate();
+  LocalVector<Value> results(isolate);
+  results.reserve(params.data.size());
+
+  if (params.prototype->mode() == SignConfiguration::Mode::Verify) {
+    for (size_t i = 0; i < params.data.size(); i++)
+      results.push_back(Boolean::New(isolate, out->data<char>()[i] != 0));
+    return Array::New(isolate, results.data(), results.size());
+  }
+
+  const char* ptr = out->data<char>();
+  for (size_t i = 0; i < params.data.size(); i++) {
+    uint32_t length;
+    memcpy(&length, ptr, sizeof(length));
+    ptr += sizeof(length);
+    Local<ArrayBuffer> ab = ArrayBuffer::New(
+        isolate, length, BackingStoreInitializationMode::kUninitialized);
+    if (length > 0) memcpy(ab->Data(), ptr, length);
+    ptr += length;
+    results.push_back(ab);
+  }
+  return Array::New(isolate, results.data(), results.size());
+}
+
 }  // namespace crypto
 }  // namespace node
@@ -8,6 +8,10 @@
 #include "crypto/crypto_util.h"
 #include "env.h"
 #include "memory_tracker.h"
+#include "node_mutex.h"
+
+#include <memory>
+#include <vector>
 
 namespace node {
 namespace crypto {
@@ -149,6 +153,102 @@ struct SignTraits final {
 
 using SignJob = DeriveBitsJob<SignTraits>;
 
+// A signing or verification context bound to one key and set of options.
+// The EVP_MD_CTX is initialized once, and every operation works on a copy
+// of it, so that many messages can be signed or verified with the same key
+// without setting up the key and padding contexts again for each of them.
+class SignContext final : public BaseObject {
+ public:
+  static void Initialize(Environment* env, v8::Local<v8::Object> target);
+  static void RegisterExternalReferences(ExternalReferenceRegistry* registry);
+
+  // The part of a SignContext that SignBatchJobs work with, which may
+  // outlive the SignContext itself.
+  class Prototype final {
+   public:
+    Prototype(SignConfiguration::Mode mode,
+              KeyObjectData&& key,
+              DSASigEnc dsa_encoding,
+              ncrypto::EVPMDCtxPointer&& ctx);
+
+    SignConfiguration::Mode mode() const { return mode_; }
+    const KeyObjectData& key() const { return key_; }
+    DSASigEnc dsa_encoding() const { return dsa_encoding_; }
+
+    // `signature` is expected in DER format if the key uses DSA signatures.
+    bool Sign(Environment* env, const ByteSource& data, ByteSource* out) const;
+    bool Verify(const ByteSource& data, const ByteSource& signature) const;
+
+   private:
+    ncrypto::EVPMDCtxPointer Copy() const;
+
+    SignConfiguration::Mode mode_;
+    KeyObjectData key_;
+    DSASigEnc dsa_encoding_;
+    // Guards copying ctx_, which is never used for an operation directly.
+    mutable Mutex mutex_;
+    ncrypto::EVPMDCtxPointer ctx_;
+  };
+
+  const std::shared_ptr<Prototype>& prototype() const { return prototype_; }
+
+  void MemoryInfo(MemoryTracker* tracker) const override;
+  SET_MEMORY_INFO_NAME(SignContext)
+  SET_SELF_SIZE(SignContext)
+
+ private:
+  SignContext(Environment* env,
+              v8::Local<v8::Object> wrap,
+              std::shared_ptr<Prototype> prototype);
+
+  static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Sign(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Verify(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  std::shared_ptr<Prototype> prototype_;
+};
+
+// Signs or verifies many messages with one SignContext in a single job.
+struct SignBatchConfiguration final : public MemoryRetainer {
+  CryptoJobMode job_mode;
+  std::shared_ptr<SignContext::Prototype> prototype;
+  std::vector<ByteSource> data;
+  // In DER format, for verification only.
+  std::vector<ByteSource> signatures;
+
+  SignBatchConfiguration() = default;
+  SignBatchConfiguration(SignBatchConfiguration&& other) noexcept = default;
+  SignBatchConfiguration& operator=(SignBatchConfiguration&& other) noexcept =
+      default;
+
+  void MemoryInfo(MemoryTracker* tracker) const override;
+  SET_MEMORY_INFO_NAME(SignBatchConfiguration)
+  SET_SELF_SIZE(SignBatchConfiguration)
+};
+
+struct SignBatchTraits final {
+  using AdditionalParameters = SignBatchConfiguration;
+  static constexpr const char* JobName = "SignBatchJob";
+
+  static constexpr AsyncWrap::ProviderType Provider =
+      AsyncWrap::PROVIDER_SIGNREQUEST;
+
+  static v8::Maybe<void> AdditionalConfig(
+      CryptoJobMode mode,
+      const v8::FunctionCallbackInfo<v8::Value>& args,
+      unsigned int offset,
+      SignBatchConfiguration* params);
+
+  static bool DeriveBits(Environment* env,
+                         const SignBatchConfiguration& params,
+                         ByteSource* out);
+
+  static v8::MaybeLocal<v8::Value> EncodeOutput(
+      Environment* env, const SignBatchConfiguration& params, ByteSource* out);
+};
+
+using SignBatchJob = DeriveBitsJob<SignBatchTraits>;
+
 }  // namespace crypto
 }  // namespace node
 
@@ -21,6 +21,8 @@
 
 #include "crypto/crypto_tls.h"
 #include <cstdio>
+#include <deque>
+#include <unordered_map>
 #include "async_wrap-inl.h"
 #include "crypto/crypto_bio.h"
 #include "crypto/crypto_clienthello-inl.h"
@@ -34,6 +36,20 @@
 #include "stream_base-inl.h"
 #include "util-inl.h"
 
+#include <openssl/kdf.h>
+#include <openssl/rand.h>
+
+#if defined(__linux__) && __has_include(<linux/tls.h>)
+#include <linux/tls.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#ifndef SOL_TLS
+#define SOL_TLS 282
+#endif
+#define NODE_HAVE_KTLS 1
+#endif
+
 namespace node {
 
 using ncrypto::BIOPointer;
@@ -74,6 +90,99 @@ namespace crypto {
 
 namespace {
 
+// Largest run of small cleartext buffers DoWrite() gathers into one
+// SSL_write(), i.e. the payload of a single TLS record.
+constexpr size_t kMaxCoalescedWrite = 16 * 1024;
+
+// Server handshakes do their private key operation synchronously inside
+// SSL_read(), which for RSA-2048 is around a millisecond. After a failover
+// thousands of ClientHellos can arrive in a single poll phase. With
+// --tls-handshakes-per-iteration, only that many server handshake steps run
+// per event loop iteration. The rest are resumed from an idle handle, letting
+// established connections and timers get a turn in between.
+class HandshakeScheduler final {
+ public:
+  static HandshakeScheduler* Get(Environment* env) {
+    auto it = schedulers_.find(env);
+    if (it != schedulers_.end()) return it->second;
+    HandshakeScheduler* scheduler = new HandshakeScheduler(env);
+    schedulers_.emplace(env, scheduler);
+    return scheduler;
+  }
+
+  // Returns true if the caller may run a handshake step right now.
+  bool TakeStep() {
+    uv_metrics_t metrics;
+    if (uv_metrics_info(env_->event_loop(), &metrics) == 0 &&
+        metrics.loop_count != loop_count_) {
+      loop_count_ = metrics.loop_count;
+      steps_ = 0;
+    }
+    if (!deferred_.empty() || steps_ >= limit_) return false;
+    steps_++;
+    return true;
+  }
+
+  void Defer(TLSWrap* wrap) {
+    if (deferred_.empty()) uv_idle_start(&idle_, OnIdle);
+    deferred_.emplace_back(wrap);
+  }
+
+ private:
+  explicit HandshakeScheduler(Environment* env)
+      : env_(env), limit_(env->options()->tls_handshakes_per_iteration) {
+    CHECK_EQ(uv_idle_init(env->event_loop(), &idle_), 0);
+    uv_unref(reinterpret_cast<uv_handle_t*>(&idle_));
+    env->AddCleanupHook(Cleanup, this);
+  }
+
+  static void OnIdle(uv_idle_t* handle) {
+    HandshakeScheduler* scheduler =
+        ContainerOf(&HandshakeScheduler::idle_, handle);
+    Environment* env = scheduler->env_;
+    HandleScope handle_scope(env->isolate());
+    Context::Scope context_scope(env->context());
+
+    std::deque<BaseObjectPtr<TLSWrap>> batch;
+    while (!scheduler->deferred_.empty() &&
+           batch.size() < scheduler->limit_) {
+      batch.emplace_back(std::move(scheduler->deferred_.front()));
+      scheduler->deferred_.pop_front();
+    }
+    if (scheduler->deferred_.empty()) uv_idle_stop(handle);
+
+    // The resumed steps are this iteration's budget.
+    scheduler->steps_ = scheduler->limit_;
+    for (BaseObjectPtr<TLSWrap>& wrap : batch)
+      wrap->ResumeDeferredHandshake();
+  }
+
+  static void Cleanup(void* arg) {
+    HandshakeScheduler* scheduler = static_cast<HandshakeScheduler*>(arg);
+    schedulers_.erase(scheduler->env_);
+    scheduler->deferred_.clear();
+    uv_idle_stop(&scheduler->idle_);
+    scheduler->env_->CloseHandle(&scheduler->idle_, [](uv_idle_t* handle) {
+      HandshakeScheduler* scheduler =
+          ContainerOf(&HandshakeScheduler::idle_, handle);
+      delete scheduler;
+    });
+  }
+
+  static thread_local std::unordered_map<Environment*, HandshakeScheduler*>
+      schedulers_;
+
+  Environment* env_;
+  const uint64_t limit_;
+  uv_idle_t idle_;
+  uint64_t loop_count_ = 0;
+  uint64_t steps_ = 0;
+  std::deque<BaseObjectPtr<TLSWrap>> deferred_;
+};
+
+thread_local std::unordered_map<Environment*, HandshakeScheduler*>
+    HandshakeScheduler::schedulers_;
+
 // Our custom implementation of the certificate verify callback
 // used when establishing a TLS handshake. Because we cannot perform
 // I/O quickly enough with X509_STORE_CTX_ APIs in this callback,
@@ -680,6 +789,8 @@ void TLSWrap::EncOut() {
   // No encrypted output ready to write to the underlying stream.
   if (BIO_pending(enc_out_) == 0) {
     Debug(this, "No pending encrypted output");
+    if (ktls_requested_ && !ktls_tx_ && established_)
+      MaybeEnableKTLS();
     if (!pending_cleartext_input_ ||
         pending_cleartext_input_->ByteLength() == 0) {
       if (!in_dowrite_) {
@@ -928,8 +1039,8 @@ void TLSWrap::ClearIn() {
   std::unique_ptr<BackingStore> bs = std::move(pending_cleartext_input_);
   MarkPopErrorOnReturn mark_pop_error_on_return;
 
-  NodeBIO::FromBIO(enc_out_)->set_allocate_tls_hint(bs->ByteLength());
-  int written = SSL_write(ssl_.get(), bs->Data(), bs->ByteLength());
+  int written = WriteCleartext(static_cast<const char*>(bs->Data()),
+                               bs->ByteLength());
   Debug(this, "Writing %zu bytes, written = %d", bs->ByteLength(), written);
   CHECK(written == -1 || written == static_cast<int>(bs->ByteLength()));
 
@@ -956,6 +1067,141 @@ void TLSWrap::ClearIn() {
   pending_cleartext_input_ = std::move(bs);
 }
 
+int TLSWrap::WriteCleartext(const char* data, size_t length) {
+  if (ktls_tx_) {
+    // The kernel frames and encrypts whatever is written to the socket.
+    NodeBIO::FromBIO(enc_out_)->Write(data, length);
+    return static_cast<int>(length);
+  }
+
+  NodeBIO::FromBIO(enc_out_)->set_allocate_tls_hint(length);
+  int written = SSL_write(ssl_.get(), data, length);
+  if (written > 0)
+    app_data_written_ = true;
+  return written;
+}
+
+void TLSWrap::MaybeEnableKTLS() {
+  // Whatever happens, this is only ever attempted once per connection.
+  ktls_requested_ = false;
+#ifdef NODE_HAVE_KTLS
+  SSL* ssl = ssl_.get();
+  if (app_data_written_ || write_size_ != 0 || current_empty_write_ ||
+      SSL_version(ssl) != TLS1_2_VERSION || SSL_renegotiate_pending(ssl)) {
+    return;
+  }
+
+  const SSL_CIPHER* cipher = SSL_get_current_cipher(ssl);
+  if (cipher == nullptr) return;
+  const int cipher_nid = SSL_CIPHER_get_cipher_nid(cipher);
+  size_t key_len;
+  if (cipher_nid == NID_aes_128_gcm) {
+    key_len = TLS_CIPHER_AES_GCM_128_KEY_SIZE;
+  } else if (cipher_nid == NID_aes_256_gcm) {
+    key_len = TLS_CIPHER_AES_GCM_256_KEY_SIZE;
+  } else {
+    return;
+  }
+
+  int fd = GetFD();
+  if (fd < 0) return;
+
+  ClearErrorOnReturn clear_error_on_return;
+
+  // RFC 5246, Section 6.3: for AEAD ciphers the key block is
+  // client_write_key, server_write_key, client_write_IV, server_write_IV,
+  // where the IVs are the 4 byte implicit salts.
+  constexpr size_t kSaltLen = TLS_CIPHER_AES_GCM_128_SALT_SIZE;
+  unsigned char master[SSL_MAX_MASTER_KEY_LENGTH];
+  unsigned char randoms[2 * SSL3_RANDOM_SIZE];
+  unsigned char key_block[2 * (TLS_CIPHER_AES_GCM_256_KEY_SIZE + kSaltLen)];
+  const size_t key_block_len = 2 * (key_len + kSaltLen);
+  size_t master_len = SSL_SESSION_get_master_key(
+      SSL_get_session(ssl), master, sizeof(master));
+  SSL_get_server_random(ssl, randoms, SSL3_RANDOM_SIZE);
+  SSL_get_client_random(ssl, randoms + SSL3_RANDOM_SIZE, SSL3_RANDOM_SIZE);
+
+  const EVP_MD* md = SSL_CIPHER_get_handshake_digest(cipher);
+  EVP_PKEY_CTX* pctx = EVP_PKEY_CTX_new_id(EVP_PKEY_TLS1_PRF, nullptr);
+  static constexpr char kLabel[] = "key expansion";
+  size_t out_len = key_block_len;
+  bool derived =
+      pctx != nullptr && md != nullptr && master_len > 0 &&
+      EVP_PKEY_derive_init(pctx) > 0 &&
+      EVP_PKEY_CTX_set_tls1_prf_md(pctx, md) > 0 &&
+      EVP_PKEY_CTX_set1_tls1_prf_secret(pctx, master, master_len) > 0 &&
+      EVP_PKEY_CTX_add1_tls1_prf_seed(
+          pctx,
+          reinterpret_cast<const unsigned char*>(kLabel),
+          sizeof(kLabel) - 1) > 0 &&
+      EVP_PKEY_CTX_add1_tls1_prf_seed(pctx, randoms, sizeof(randoms)) > 0 &&
+      EVP_PKEY_derive(pctx, key_block, &out_len) > 0 &&
+      out_len == key_block_len;
+  EVP_PKEY_CTX_free(pctx);
+  OPENSSL_cleanse(master, sizeof(master));
+  if (!derived) {
+    OPENSSL_cleanse(key_block, sizeof(key_block));
+    return;
+  }
+
+  const unsigned char* key = key_block + (is_server() ? key_len : 0);
+  const unsigned char* salt =
+      key_block + 2 * key_len + (is_server() ? kSaltLen : 0);
+
+  // Both directions have sent exactly one record, Finished, under the new
+  // keys. OpenSSL starts its explicit nonces at a random value, so do the
+  // same rather than reusing its counter.
+  union {
+    tls12_crypto_info_aes_gcm_128 gcm128;
+    tls12_crypto_info_aes_gcm_256 gcm256;
+  } info;
+  memset(&info, 0, sizeof(info));
+  socklen_t info_len;
+  unsigned char* info_iv;
+  unsigned char* info_rec_seq;
+  if (cipher_nid == NID_aes_128_gcm) {
+    info.gcm128.info.version = TLS_1_2_VERSION;
+    info.gcm128.info.cipher_type = TLS_CIPHER_AES_GCM_128;
+    memcpy(info.gcm128.key, key, key_len);
+    memcpy(info.gcm128.salt, salt, kSaltLen);
+    info_iv = info.gcm128.iv;
+    info_rec_seq = info.gcm128.rec_seq;
+    info_len = sizeof(info.gcm128);
+  } else {
+    info.gcm256.info.version = TLS_1_2_VERSION;
+    info.gcm256.info.cipher_type = TLS_CIPHER_AES_GCM_256;
+    memcpy(info.gcm256.key, key, key_len);
+    memcpy(info.gcm256.salt, salt, kSaltLen);
+    info_iv = info.gcm256.iv;
+    info_rec_seq = info.gcm256.rec_seq;
+    info_len = sizeof(info.gcm256);
+  }
+  OPENSSL_cleanse(key_block, sizeof(key_block));
+  info_rec_seq[TLS_CIPHER_AES_GCM_128_REC_SEQ_SIZE - 1] = 1;
+
+  bool enabled =
+      RAND_bytes(info_iv, TLS_CIPHER_AES_GCM_128_IV_SIZE) == 1 &&
+      setsockopt(fd, SOL_TCP, TCP_ULP, "tls", sizeof("tls")) == 0 &&
+      setsockopt(fd, SOL_TLS, TLS_TX, &info, info_len) == 0;
+  OPENSSL_cleanse(&info, sizeof(info));
+  if (!enabled) {
+    Debug(this, "kTLS offload unavailable (errno = %d)", errno);
+    return;
+  }
+
+  // From here on OpenSSL must never emit another record of its own, its
+  // sequence numbers no longer match the connection. Detach enc_out_ so
+  // that alerts and close_notify are dropped and the BIO carries clear text
+  // for the kernel only.
+  Debug(this, "kTLS transmit offload enabled");
+  SSL_set_options(ssl, SSL_OP_NO_RENEGOTIATION);
+  CHECK_EQ(BIO_up_ref(enc_out_), 1);
+  ktls_out_.reset(enc_out_);
+  SSL_set0_wbio(ssl, BIO_new(BIO_s_null()));
+  ktls_tx_ = true;
+#endif  // NODE_HAVE_KTLS
+}
+
 std::string TLSWrap::diagnostic_name() const {
   std::string name = "TLSWrap ";
   name += is_server() ? "server (" : "client (";
@@ -1085,24 +1331,65 @@ int TLSWrap::DoWrite(WriteWrap* w,
   // and copying it when it could just be used.
 
   if (nonempty_count != 1) {
-    bs = ArrayBuffer::NewBackingStore(
-        env()->isolate(),
-        length,
-        BackingStoreInitializationMode::kUninitialized);
-    size_t offset = 0;
-    for (i = 0; i < count; i++) {
-      memcpy(static_cast<char*>(bs->Data()) + offset,
-             bufs[i].base, bufs[i].len);
-      offset += bufs[i].len;
+    // Encrypt straight out of the caller's buffers. Runs of small buffers
+    // are still gathered so that they share a TLS record, but anything of
+    // at least a full record is handed to SSL_write() as is.
+    MaybeStackBuffer<char, kMaxCoalescedWrite> gather;
+    size_t done = 0;
+    for (i = 0; i < count && written != -1;) {
+      size_t run = 0;
+      size_t end = i;
+      while (end < count && run + bufs[end].len <= kMaxCoalescedWrite)
+        run += bufs[end++].len;
+
+      if (end == i) {
+        written = WriteCleartext(bufs[i].base, bufs[i].len);
+        run = bufs[i].len;
+        end = i + 1;
+      } else if (run == 0) {
+        // Only empty buffers, nothing to encrypt.
+      } else if (end == i + 1) {
+        written = WriteCleartext(bufs[i].base, run);
+      } else {
+        size_t offset = 0;
+        for (size_t j = i; j < end; j++) {
+          memcpy(gather.out() + offset, bufs[j].base, bufs[j].len);
+          offset += bufs[j].len;
+        }
+        written = WriteCleartext(gather.out(), run);
+      }
+
+      if (written != -1)
+        done += run;
+      i = end;
     }
 
-    NodeBIO::FromBIO(enc_out_)->set_allocate_tls_hint(length);
-    written = SSL_write(ssl_.get(), bs->Data(), length);
+    if (written != -1) {
+      written = static_cast<int>(length);
+    } else {
+      // Keep whatever SSL_write() did not take for ClearIn().
+      bs = ArrayBuffer::NewBackingStore(
+          env()->isolate(),
+          length - done,
+          BackingStoreInitializationMode::kUninitialized);
+      size_t skip = done;
+      size_t offset = 0;
+      for (i = 0; i < count; i++) {
+        if (skip >= bufs[i].len) {
+          skip -= bufs[i].len;
+          continue;
+        }
+        memcpy(static_cast<char*>(bs->Data()) + offset,
+               bufs[i].base + skip,
+               bufs[i].len - skip);
+        offset += bufs[i].len - skip;
+        skip = 0;
+      }
+    }
   } else {
     // Only one buffer: try to write directly, only store if it fails
     uv_buf_t* buf = &bufs[nonempty_i];
-    NodeBIO::FromBIO(enc_out_)->set_allocate_tls_hint(buf->len);
-    written = SSL_write(ssl_.get(), buf->base, buf->len);
+    written = WriteCleartext(buf->base, buf->len);
 
     if (written == -1) {
       bs = ArrayBuffer::NewBackingStore(
@@ -1192,10 +1479,32 @@ void TLSWrap::OnStreamRead(ssize_t nread, const uv_buf_t& buf) {
     return hello_parser_.Parse(data, avail);
   }
 
+  // The data stays in enc_in_ until the postponed handshake step runs.
+  if (handshake_deferred_)
+    return;
+
+  if (is_server() && !established_ &&
+      env()->options()->tls_handshakes_per_iteration != 0 &&
+      !HandshakeScheduler::Get(env())->TakeStep()) {
+    Debug(this, "Handshake budget exhausted, deferring handshake step");
+    handshake_deferred_ = true;
+    HandshakeScheduler::Get(env())->Defer(this);
+    return;
+  }
+
   // Cycle OpenSSL's state
   Cycle();
 }
 
+void TLSWrap::ResumeDeferredHandshake() {
+  handshake_deferred_ = false;
+  if (ssl_ == nullptr)
+    return;
+  Debug(this, "Resuming deferred handshake step");
+  InternalCallbackScope callback_scope(this);
+  Cycle();
+}
+
 ShutdownWrap* TLSWrap::CreateShutdownWrap(Local<Object> req_wrap_object) {
   return underlying_stream()->CreateShutdownWrap(req_wrap_object);
 }
@@ -1319,6 +1628,7 @@ void TLSWrap::Destroy() {
 
   env()->external_memory_accounter()->Decrease(env()->isolate(), kExternalSize);
   ssl_.reset();
+  ktls_out_.reset();
 
   enc_in_ = nullptr;
   enc_out_ = nullptr;
@@ -1329,6 +1639,17 @@ void TLSWrap::Destroy() {
   sc_.reset();
 }
 
+void TLSWrap::EnableKTLS(const FunctionCallbackInfo<Value>& args) {
+  TLSWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap, args.This());
+  // Returns whether offload can be attempted at all. Whether it actually
+  // happens depends on the negotiated protocol and cipher and on the kernel.
+#ifdef NODE_HAVE_KTLS
+  wrap->ktls_requested_ = !wrap->established_ && !wrap->ktls_tx_;
+#endif
+  args.GetReturnValue().Set(wrap->ktls_requested_);
+}
+
 void TLSWrap::EnableCertCb(const FunctionCallbackInfo<Value>& args) {
   TLSWrap* wrap;
   ASSIGN_OR_RETURN_UNWRAP(&wrap, args.This());
@@ -2199,6 +2520,7 @@ void TLSWrap::Initialize(
   SetProtoMethod(isolate, t, "certCbDone", CertCbDone);
   SetProtoMethod(isolate, t, "destroySSL", DestroySSL);
   SetProtoMethod(isolate, t, "enableCertCb", EnableCertCb);
+  SetProtoMethod(isolate, t, "enableKTLS", EnableKTLS);
   SetProtoMethod(isolate, t, "enableALPNCb", EnableALPNCb);
   SetProtoMethod(isolate, t, "endParser", EndParser);
   SetProtoMethod(isolate, t, "enableKeylogCallback", EnableKeylogCallback);
@@ -2270,6 +2592,7 @@ void TLSWrap::RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(CertCbDone);
   registry->Register(DestroySSL);
   registry->Register(EnableCertCb);
+  registry->Register(EnableKTLS);
   registry->Register(EnableALPNCb);
   registry->Register(EndParser);
   registry->Register(EnableKeylogCallback);
@@ -70,6 +70,10 @@ class TLSWrap : public AsyncWrap,
   inline bool is_client() const { return kind_ == Kind::kClient; }
   inline bool is_awaiting_new_session() const { return awaiting_new_session_; }
 
+  // Resumes a server handshake that OnStreamRead() postponed because the
+  // per-loop-iteration handshake budget was used up.
+  void ResumeDeferredHandshake();
+
   // Implement StreamBase:
   bool IsAlive() override;
   bool IsClosing() override;
@@ -156,6 +160,15 @@ class TLSWrap : public AsyncWrap,
   void ClearOut();  // SSL_read() clear text "out" from SSL.
   void Destroy();
 
+  // SSL_write() clear text, or queue it unencrypted in enc_out_ once the
+  // kernel has taken over record encryption (see MaybeEnableKTLS()).
+  int WriteCleartext(const char* data, size_t length);
+  // Hands the transmit direction of an established TLS 1.2 AES-GCM session
+  // to the kernel TLS ULP. Only done while nothing is in flight and before
+  // any application data was encrypted, so that the kernel starts from a
+  // known record sequence number.
+  void MaybeEnableKTLS();
+
   // Call Done() on outstanding WriteWrap request.
   void InvokeQueued(int status, const char* error_str = nullptr);
 
@@ -177,6 +190,7 @@ class TLSWrap : public AsyncWrap,
   static void CertCbDone(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void DestroySSL(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void EnableCertCb(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void EnableKTLS(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void EnableALPNCb(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void EnableKeylogCallback(
       const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -260,6 +274,8 @@ class TLSWrap : public AsyncWrap,
   // BIO buffers hold encrypted data.
   BIO* enc_in_ = nullptr;   // StreamListener fills this for SSL_read().
   BIO* enc_out_ = nullptr;  // SSL_write()/handshake fills this for EncOut().
+  // Owns enc_out_ after MaybeEnableKTLS() detached it from ssl_.
+  ncrypto::BIOPointer ktls_out_;
   // Waiting for ClearIn() to pass to SSL_write().
   std::unique_ptr<v8::BackingStore> pending_cleartext_input_;
   size_t write_size_ = 0;
@@ -274,6 +290,10 @@ class TLSWrap : public AsyncWrap,
   bool shutdown_ = false;
   bool cert_cb_running_ = false;
   bool eof_ = false;
+  bool ktls_requested_ = false;
+  bool ktls_tx_ = false;
+  bool app_data_written_ = false;
+  bool handshake_deferred_ = false;
 
   // TODO(@jasnell): These state flags should be revisited.
   // The established_ flag indicates that the handshake is
@@ -240,6 +240,17 @@ enum CryptoJobMode {
 
 CryptoJobMode GetCryptoJobMode(v8::Local<v8::Value> args);
 
+// Traits may define ThreadPoolWorkType to run their jobs as a different kind
+// of ThreadPoolWork than "crypto", so that they can be limited separately.
+template <typename CryptoJobTraits>
+constexpr const char* GetCryptoJobWorkType() {
+  if constexpr (requires { CryptoJobTraits::ThreadPoolWorkType; }) {
+    return CryptoJobTraits::ThreadPoolWorkType;
+  } else {
+    return "crypto";
+  }
+}
+
 template <typename CryptoJobTraits>
 class CryptoJob : public AsyncWrap, public ThreadPoolWork {
  public:
@@ -251,7 +262,7 @@ class CryptoJob : public AsyncWrap, public ThreadPoolWork {
                      CryptoJobMode mode,
                      AdditionalParams&& params)
       : AsyncWrap(env, object, type),
-        ThreadPoolWork(env, "crypto"),
+        ThreadPoolWork(env, GetCryptoJobWorkType<CryptoJobTraits>()),
         mode_(mode),
         params_(std::move(params)) {
     // If the CryptoJob is async, then the instance will be
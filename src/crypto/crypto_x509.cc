@@ -10,7 +10,10 @@
 #include "util-inl.h"
 #include "v8.h"
 
+#include <list>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace node {
@@ -43,6 +46,7 @@ using v8::LocalVector;
 using v8::MaybeLocal;
 using v8::NewStringType;
 using v8::Object;
+using v8::PropertyCallbackInfo;
 using v8::String;
 using v8::Uint32;
 using v8::Value;
@@ -59,9 +63,172 @@ ManagedX509& ManagedX509::operator=(const ManagedX509& that) {
   cert_.reset(that.get());
   if (cert_) [[likely]]
     X509_up_ref(cert_.get());
+  Mutex::ScopedLock lock(fields_mutex_);
+  computed_.fill(false);
+  fields_ = {};
   return *this;
 }
 
+namespace {
+// A bounded LRU cache of certificates. Certificates do not change once they
+// have been parsed, so entries never become stale. The cache holds strong
+// references, so that certificates survive between e.g. TLS connections that
+// present the same certificate.
+class X509Cache final {
+ public:
+  static constexpr size_t kMaxEntries = 1024;
+
+  std::shared_ptr<ManagedX509> Get(const std::string& key) {
+    Mutex::ScopedLock lock(mutex_);
+    auto it = index_.find(key);
+    if (it == index_.end()) return {};
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return it->second->second;
+  }
+
+  // Returns the entry that is in the cache for |key| afterwards, which is
+  // not |cert| if another thread has added one in the meantime.
+  std::shared_ptr<ManagedX509> Add(const std::string& key,
+                                   std::shared_ptr<ManagedX509> cert) {
+    Mutex::ScopedLock lock(mutex_);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+      entries_.splice(entries_.begin(), entries_, it->second);
+      return it->second->second;
+    }
+    entries_.emplace_front(key, std::move(cert));
+    index_.emplace(key, entries_.begin());
+    if (entries_.size() > kMaxEntries) {
+      index_.erase(entries_.back().first);
+      entries_.pop_back();
+    }
+    return entries_.front().second;
+  }
+
+ private:
+  using Entry = std::pair<std::string, std::shared_ptr<ManagedX509>>;
+
+  Mutex mutex_;
+  std::list<Entry> entries_;
+  std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+};
+
+X509Cache* GetX509Cache() {
+  // Intentionally leaked, so that no certificate is freed after OpenSSL has
+  // been cleaned up at exit.
+  static X509Cache* cache = new X509Cache();
+  return cache;
+}
+
+std::optional<std::string> ToString(BIOPointer&& bio) {
+  if (!bio) [[unlikely]]
+    return std::nullopt;
+  BUF_MEM* mem = bio;
+  return std::string(mem->data, mem->length);
+}
+
+std::optional<std::string> ComputeField(const X509View& cert,
+                                        ManagedX509::Field field) {
+  using Field = ManagedX509::Field;
+  switch (field) {
+    case Field::kFingerprint:
+      return cert.getFingerprint(Digest::SHA1);
+    case Field::kFingerprint256:
+      return cert.getFingerprint(Digest::SHA256);
+    case Field::kFingerprint512:
+      return cert.getFingerprint(Digest::SHA512);
+    case Field::kSubject:
+      return ToString(cert.getSubject());
+    case Field::kIssuer:
+      return ToString(cert.getIssuer());
+    case Field::kSubjectAltName:
+      return ToString(cert.getSubjectAltName());
+    case Field::kInfoAccess:
+      return ToString(cert.getInfoAccess());
+    case Field::kValidFrom:
+      return ToString(cert.getValidFrom());
+    case Field::kValidTo:
+      return ToString(cert.getValidTo());
+    case Field::kSerialNumber:
+      if (auto serial = cert.getSerialNumber()) {
+        return std::string(static_cast<const char*>(serial.get()));
+      }
+      return std::nullopt;
+    case Field::kCount:
+      break;
+  }
+  UNREACHABLE();
+}
+}  // namespace
+
+std::shared_ptr<ManagedX509> ManagedX509::GetOrCreate(X509Pointer&& cert) {
+  X509View view(cert);
+  std::optional<std::string> fingerprint =
+      view ? view.getFingerprint(Digest::SHA256) : std::nullopt;
+  if (!fingerprint.has_value()) [[unlikely]] {
+    return std::make_shared<ManagedX509>(std::move(cert));
+  }
+
+  X509Cache* cache = GetX509Cache();
+  if (auto cached = cache->Get(*fingerprint)) return cached;
+  auto managed = std::make_shared<ManagedX509>(std::move(cert));
+  size_t index = static_cast<size_t>(Field::kFingerprint256);
+  managed->fields_[index] = *fingerprint;
+  managed->computed_[index] = true;
+  return cache->Add(*fingerprint, std::move(managed));
+}
+
+std::shared_ptr<ManagedX509> ManagedX509::GetOrCreate(const X509View& cert) {
+  std::optional<std::string> fingerprint =
+      cert ? cert.getFingerprint(Digest::SHA256) : std::nullopt;
+  if (fingerprint.has_value()) [[likely]] {
+    if (auto cached = GetX509Cache()->Get(*fingerprint)) return cached;
+  }
+  return GetOrCreate(cert.clone());
+}
+
+std::shared_ptr<ManagedX509> ManagedX509::Parse(
+    const ncrypto::Buffer<const unsigned char>& data,
+    std::optional<int>* error) {
+  // The input is hashed as is, so that the same PEM or DER input is only
+  // parsed once. This is a separate key from the certificate fingerprint.
+  std::string key;
+  if (auto digest = ncrypto::hashDigest(data, EVP_sha256())) {
+    key = "input:" + std::string(static_cast<const char*>(digest.get()),
+                                 digest.size());
+    if (auto cached = GetX509Cache()->Get(key)) return cached;
+  }
+
+  auto result = X509Pointer::Parse(data);
+  if (!result.value) [[unlikely]] {
+    *error = result.error;
+    return {};
+  }
+  auto managed = GetOrCreate(std::move(result.value));
+  if (!key.empty()) GetX509Cache()->Add(key, managed);
+  return managed;
+}
+
+const std::string* ManagedX509::GetField(Field field) {
+  size_t index = static_cast<size_t>(field);
+  CHECK_LT(index, kFieldCount);
+  {
+    Mutex::ScopedLock lock(fields_mutex_);
+    if (computed_[index]) {
+      return fields_[index].has_value() ? &*fields_[index] : nullptr;
+    }
+  }
+  // Computed without holding the lock. If two threads race here, both
+  // compute the same value and the first one is kept.
+  std::optional<std::string> value = ComputeField(view(), field);
+  Mutex::ScopedLock lock(fields_mutex_);
+  if (!computed_[index]) {
+    fields_[index] = std::move(value);
+    computed_[index] = true;
+  }
+  return fields_[index].has_value() ? &*fields_[index] : nullptr;
+}
+
 void ManagedX509::MemoryInfo(MemoryTracker* tracker) const {
   if (!cert_) return;
   // This is an approximation based on the der encoding size.
@@ -70,35 +237,33 @@ void ManagedX509::MemoryInfo(MemoryTracker* tracker) const {
 }
 
 namespace {
-MaybeLocal<Value> GetFingerprintDigest(Environment* env,
-                                       const Digest& method,
-                                       const X509View& cert) {
-  auto fingerprint = cert.getFingerprint(method);
-  // Returning an empty string indicates that the digest failed for
-  // some reason.
-  if (!fingerprint.has_value()) [[unlikely]] {
+MaybeLocal<String> ToV8Value(Environment* env, std::string_view val) {
+  return String::NewFromUtf8(
+      env->isolate(), val.data(), NewStringType::kNormal, val.size());
+}
+
+using Field = ManagedX509::Field;
+
+MaybeLocal<Value> GetCachedField(Environment* env,
+                                 ManagedX509* cert,
+                                 Field field) {
+  const std::string* value = cert->GetField(field);
+  if (value == nullptr) [[unlikely]]
     return Undefined(env->isolate());
-  }
-  auto& fp = fingerprint.value();
-  return OneByteString(env->isolate(), fp.data(), fp.length());
+  return ToV8Value(env, *value);
 }
 
-template <const ncrypto::Digest& algo>
-void Fingerprint(const FunctionCallbackInfo<Value>& args) {
+template <Field field>
+void CachedField(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
   X509Certificate* cert;
   ASSIGN_OR_RETURN_UNWRAP(&cert, args.This());
   Local<Value> ret;
-  if (GetFingerprintDigest(env, algo, cert->view()).ToLocal(&ret)) {
+  if (GetCachedField(env, cert->managed(), field).ToLocal(&ret)) {
     args.GetReturnValue().Set(ret);
   }
 }
 
-MaybeLocal<String> ToV8Value(Environment* env, std::string_view val) {
-  return String::NewFromUtf8(
-      env->isolate(), val.data(), NewStringType::kNormal, val.size());
-}
-
 MaybeLocal<Value> ToV8Value(Local<Context> context, BIOPointer&& bio) {
   if (!bio) [[unlikely]]
     return {};
@@ -155,49 +320,6 @@ MaybeLocal<Value> GetDer(Environment* env, const X509View& view) {
   return ret;
 }
 
-MaybeLocal<Value> GetSubjectAltNameString(Environment* env,
-                                          const X509View& view) {
-  Local<Value> ret;
-  auto bio = view.getSubjectAltName();
-  if (!bio) [[unlikely]]
-    return Undefined(env->isolate());
-  if (!ToV8Value(env->context(), bio).ToLocal(&ret)) return {};
-  return ret;
-}
-
-MaybeLocal<Value> GetInfoAccessString(Environment* env, const X509View& view) {
-  Local<Value> ret;
-  auto bio = view.getInfoAccess();
-  if (!bio) [[unlikely]]
-    return Undefined(env->isolate());
-  if (!ToV8Value(env->context(), bio).ToLocal(&ret)) {
-    return {};
-  }
-  return ret;
-}
-
-MaybeLocal<Value> GetValidFrom(Environment* env, const X509View& view) {
-  Local<Value> ret;
-  auto bio = view.getValidFrom();
-  if (!bio) [[unlikely]]
-    return Undefined(env->isolate());
-  if (!ToV8Value(env->context(), bio).ToLocal(&ret)) {
-    return {};
-  }
-  return ret;
-}
-
-MaybeLocal<Value> GetValidTo(Environment* env, const X509View& view) {
-  Local<Value> ret;
-  auto bio = view.getValidTo();
-  if (!bio) [[unlikely]]
-    return Undefined(env->isolate());
-  if (!ToV8Value(env->context(), bio).ToLocal(&ret)) {
-    return {};
-  }
-  return ret;
-}
-
 MaybeLocal<Value> GetValidFromDate(Environment* env, const X509View& view) {
   int64_t validFromTime = view.getValidFromTime();
   return Date::New(env->context(), validFromTime * 1000.);
@@ -208,14 +330,6 @@ MaybeLocal<Value> GetValidToDate(Environment* env, const X509View& view) {
   return Date::New(env->context(), validToTime * 1000.);
 }
 
-MaybeLocal<Value> GetSerialNumber(Environment* env, const X509View& view) {
-  if (auto serial = view.getSerialNumber()) {
-    return OneByteString(env->isolate(),
-                         static_cast<unsigned char*>(serial.get()));
-  }
-  return Undefined(env->isolate());
-}
-
 MaybeLocal<Value> GetKeyUsage(Environment* env, const X509View& cert) {
   LocalVector<Value> vec(env->isolate());
   bool res = cert.enumUsages([&](std::string_view view) {
@@ -245,66 +359,6 @@ void Der(const FunctionCallbackInfo<Value>& args) {
   }
 }
 
-void Subject(const FunctionCallbackInfo<Value>& args) {
-  Environment* env = Environment::GetCurrent(args);
-  X509Certificate* cert;
-  ASSIGN_OR_RETURN_UNWRAP(&cert, args.This());
-  Local<Value> ret;
-  if (ToV8Value(env->context(), cert->view().getSubject()).ToLocal(&ret)) {
-    args.GetReturnValue().Set(ret);
-  }
-}
-
-void SubjectAltName(const FunctionCallbackInfo<Value>& args) {
-  Environment* env = Environment::GetCurrent(args);
-  X509Certificate* cert;
-  ASSIGN_OR_RETURN_UNWRAP(&cert, args.This());
-  Local<Value> ret;
-  if (GetSubjectAltNameString(env, cert->view()).ToLocal(&ret)) {
-    args.GetReturnValue().Set(ret);
-  }
-}
-
-void Issuer(const FunctionCallbackInfo<Value>& args) {
-  Environment* env = Environment::GetCurrent(args);
-  X509Certificate* cert;
-  ASSIGN_OR_RETURN_UNWRAP(&cert, args.This());
-  Local<Value> ret;
-  if (ToV8Value(env->context(), cert->view().getIssuer()).ToLocal(&ret)) {
-    args.GetReturnValue().Set(ret);
-  }
-}
-
-void InfoAccess(const FunctionCallbackInfo<Value>& args) {
-  Environment* env = Environment::GetCurrent(args);
-  X509Certificate* cert;
-  ASSIGN_OR_RETURN_UNWRAP(&cert, args.This());
-  Local<Value> ret;
-  if (GetInfoAccessString(env, cert->view()).ToLocal(&ret)) {
-    args.GetReturnValue().Set(ret);
-  }
-}
-
-void ValidFrom(const FunctionCallbackInfo<Value>& args) {
-  Environment* env = Environment::GetCurrent(args);
-  X509Certificate* cert;
-  ASSIGN_OR_RETURN_UNWRAP(&cert, args.This());
-  Local<Value> ret;
-  if (GetValidFrom(env, cert->view()).ToLocal(&ret)) {
-    args.GetReturnValue().Set(ret);
-  }
-}
-
-void ValidTo(const FunctionCallbackInfo<Value>& args) {
-  Environment* env = Environment::GetCurrent(args);
-  X509Certificate* cert;
-  ASSIGN_OR_RETURN_UNWRAP(&cert, args.This());
-  Local<Value> ret;
-  if (GetValidTo(env, cert->view()).ToLocal(&ret)) {
-    args.GetReturnValue().Set(ret);
-  }
-}
-
 void ValidFromDate(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
   X509Certificate* cert;
@@ -325,16 +379,6 @@ void ValidToDate(const FunctionCallbackInfo<Value>& args) {
   }
 }
 
-void SerialNumber(const FunctionCallbackInfo<Value>& args) {
-  Environment* env = Environment::GetCurrent(args);
-  X509Certificate* cert;
-  ASSIGN_OR_RETURN_UNWRAP(&cert, args.This());
-  Local<Value> ret;
-  if (GetSerialNumber(env, cert->view()).ToLocal(&ret)) {
-    args.GetReturnValue().Set(ret);
-  }
-}
-
 void PublicKey(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
   X509Certificate* cert;
@@ -498,16 +542,19 @@ void Parse(const FunctionCallbackInfo<Value>& args) {
   ArrayBufferViewContents<unsigned char> buf(args[0].As<ArrayBufferView>());
   Local<Object> cert;
 
-  auto result = X509Pointer::Parse(ncrypto::Buffer<const unsigned char>{
-      .data = buf.data(),
-      .len = buf.length(),
-  });
+  std::optional<int> error;
+  std::shared_ptr<ManagedX509> managed =
+      ManagedX509::Parse(ncrypto::Buffer<const unsigned char>{
+                             .data = buf.data(),
+                             .len = buf.length(),
+                         },
+                         &error);
 
-  if (!result.value) [[unlikely]] {
-    return ThrowCryptoError(env, result.error.value_or(0));
+  if (!managed) [[unlikely]] {
+    return ThrowCryptoError(env, error.value_or(0));
   }
 
-  if (X509Certificate::New(env, std::move(result.value)).ToLocal(&cert)) {
+  if (X509Certificate::New(env, std::move(managed)).ToLocal(&cert)) {
     args.GetReturnValue().Set(cert);
   }
 }
@@ -672,26 +719,112 @@ MaybeLocal<Value> GetCurveName(Environment* env, const int nid) {
                      : MaybeLocal<Value>(Undefined(env->isolate()));
 }
 
-MaybeLocal<Object> X509ToObject(Environment* env, const X509View& cert) {
+// The properties of the legacy certificate objects that are expensive to
+// create, e.g. objects and buffers. They are only created when accessed, since
+// many users of TLS sockets never look at them.
+#define X509_LAZY_FIELDS(V)                                                    \
+  V(kSubject)                                                                  \
+  V(kIssuer)                                                                   \
+  V(kSubjectAltName)                                                           \
+  V(kInfoAccess)                                                               \
+  V(kModulus)                                                                  \
+  V(kPubkey)                                                                   \
+  V(kFingerprint)                                                              \
+  V(kFingerprint512)                                                           \
+  V(kExtKeyUsage)                                                              \
+  V(kRaw)
+
+enum class LazyField {
+#define V(name) name,
+  X509_LAZY_FIELDS(V)
+#undef V
+};
+
+MaybeLocal<Value> GetLazyField(Environment* env,
+                               X509Certificate* holder,
+                               LazyField field) {
+  ManagedX509* managed = holder->managed();
+  const X509View cert = managed->view();
+  switch (field) {
+    case LazyField::kSubject:
+      return GetX509NameObject(env, cert.getSubjectName());
+    case LazyField::kIssuer:
+      return GetX509NameObject(env, cert.getIssuerName());
+    case LazyField::kSubjectAltName:
+      return GetCachedField(env, managed, Field::kSubjectAltName);
+    case LazyField::kInfoAccess:
+      return GetCachedField(env, managed, Field::kInfoAccess);
+    case LazyField::kModulus: {
+      MaybeLocal<Value> modulus = Undefined(env->isolate());
+      cert.ifRsa([&](const ncrypto::Rsa& rsa) {
+        modulus = GetModulusString(env, rsa.getPublicKey().n);
+        return true;
+      });
+      return modulus;
+    }
+    case LazyField::kPubkey: {
+      MaybeLocal<Value> pubkey = Undefined(env->isolate());
+      cert.ifRsa([&](const ncrypto::Rsa& rsa) {
+        pubkey = GetPubKey(env, rsa);
+        return true;
+      });
+      cert.ifEc([&](const ncrypto::Ec& ec) {
+        pubkey = GetECPubKey(env, ec.getGroup(), ec);
+        return true;
+      });
+      return pubkey;
+    }
+    case LazyField::kFingerprint:
+      return GetCachedField(env, managed, Field::kFingerprint);
+    case LazyField::kFingerprint512:
+      return GetCachedField(env, managed, Field::kFingerprint512);
+    case LazyField::kExtKeyUsage:
+      return GetKeyUsage(env, cert);
+    case LazyField::kRaw:
+      return GetDer(env, cert);
+  }
+  UNREACHABLE();
+}
+
+// The holder is the X509Certificate that the object was created for, which
+// stays alive until all of the lazy properties have been accessed.
+template <LazyField field>
+void LazyFieldGetter(Local<v8::Name> property,
+                     const PropertyCallbackInfo<Value>& info) {
+  Environment* env = Environment::GetCurrent(info);
+  X509Certificate* holder;
+  ASSIGN_OR_RETURN_UNWRAP(&holder, info.Data().As<Object>());
+  ClearErrorOnReturn clear_error_on_return;
+  Local<Value> value;
+  if (GetLazyField(env, holder, field).ToLocal(&value)) {
+    info.GetReturnValue().Set(value);
+  }
+}
+
+template <LazyField field>
+bool SetLazy(Environment* env,
+             Local<Object> target,
+             Local<v8::Name> name,
+             X509Certificate* holder) {
+  return target
+      ->SetLazyDataProperty(
+          env->context(), name, LazyFieldGetter<field>, holder->object())
+      .FromMaybe(false);
+}
+
+MaybeLocal<Object> X509ToObject(Environment* env, X509Certificate* holder) {
+  const X509View cert = holder->view();
+  ManagedX509* managed = holder->managed();
   EscapableHandleScope scope(env->isolate());
   Local<Object> info = Object::New(env->isolate());
 
-  if (!Set<Value>(env,
-                  info,
-                  env->subject_string(),
-                  GetX509NameObject(env, cert.getSubjectName())) ||
-      !Set<Value>(env,
-                  info,
-                  env->issuer_string(),
-                  GetX509NameObject(env, cert.getIssuerName())) ||
-      !Set<Value>(env,
-                  info,
-                  env->subjectaltname_string(),
-                  GetSubjectAltNameString(env, cert)) ||
-      !Set<Value>(env,
-                  info,
-                  env->infoaccess_string(),
-                  GetInfoAccessString(env, cert)) ||
+  if (!SetLazy<LazyField::kSubject>(
+          env, info, env->subject_string(), holder) ||
+      !SetLazy<LazyField::kIssuer>(env, info, env->issuer_string(), holder) ||
+      !SetLazy<LazyField::kSubjectAltName>(
+          env, info, env->subjectaltname_string(), holder) ||
+      !SetLazy<LazyField::kInfoAccess>(
+          env, info, env->infoaccess_string(), holder) ||
       !Set<Boolean>(env,
                     info,
                     env->ca_string(),
@@ -701,10 +834,8 @@ MaybeLocal<Object> X509ToObject(Environment* env, const X509View& cert) {
 
   if (!cert.ifRsa([&](const ncrypto::Rsa& rsa) {
         auto pub_key = rsa.getPublicKey();
-        if (!Set<Value>(env,
-                        info,
-                        env->modulus_string(),
-                        GetModulusString(env, pub_key.n)) ||
+        if (!SetLazy<LazyField::kModulus>(
+                env, info, env->modulus_string(), holder) ||
             !Set<Value>(env,
                         info,
                         env->bits_string(),
@@ -714,8 +845,8 @@ MaybeLocal<Object> X509ToObject(Environment* env, const X509View& cert) {
                         info,
                         env->exponent_string(),
                         GetExponentString(env, pub_key.e)) ||
-            !Set<Object>(env, info, env->pubkey_string(), GetPubKey(env, rsa)))
-            [[unlikely]] {
+            !SetLazy<LazyField::kPubkey>(
+                env, info, env->pubkey_string(), holder)) [[unlikely]] {
           return false;
         }
         return true;
@@ -728,9 +859,8 @@ MaybeLocal<Object> X509ToObject(Environment* env, const X509View& cert) {
 
         if (!Set<Value>(
                 env, info, env->bits_string(), GetECGroupBits(env, group)) ||
-            !Set<Value>(
-                env, info, env->pubkey_string(), GetECPubKey(env, group, ec)))
-            [[unlikely]] {
+            !SetLazy<LazyField::kPubkey>(
+                env, info, env->pubkey_string(), holder)) [[unlikely]] {
           return false;
         }
 
@@ -759,26 +889,29 @@ MaybeLocal<Object> X509ToObject(Environment* env, const X509View& cert) {
     return {};
   }
 
-  if (!Set<Value>(
-          env, info, env->valid_from_string(), GetValidFrom(env, cert)) ||
-      !Set<Value>(env, info, env->valid_to_string(), GetValidTo(env, cert)) ||
+  if (!Set<Value>(env,
+                  info,
+                  env->valid_from_string(),
+                  GetCachedField(env, managed, Field::kValidFrom)) ||
       !Set<Value>(env,
                   info,
-                  env->fingerprint_string(),
-                  GetFingerprintDigest(env, Digest::SHA1, cert)) ||
+                  env->valid_to_string(),
+                  GetCachedField(env, managed, Field::kValidTo)) ||
+      !SetLazy<LazyField::kFingerprint>(
+          env, info, env->fingerprint_string(), holder) ||
       !Set<Value>(env,
                   info,
                   env->fingerprint256_string(),
-                  GetFingerprintDigest(env, Digest::SHA256, cert)) ||
+                  GetCachedField(env, managed, Field::kFingerprint256)) ||
+      !SetLazy<LazyField::kFingerprint512>(
+          env, info, env->fingerprint512_string(), holder) ||
+      !SetLazy<LazyField::kExtKeyUsage>(
+          env, info, env->ext_key_usage_string(), holder) ||
       !Set<Value>(env,
                   info,
-                  env->fingerprint512_string(),
-                  GetFingerprintDigest(env, Digest::SHA512, cert)) ||
-      !Set<Value>(
-          env, info, env->ext_key_usage_string(), GetKeyUsage(env, cert)) ||
-      !Set<Value>(
-          env, info, env->serial_number_string(), GetSerialNumber(env, cert)) ||
-      !Set<Value>(env, info, env->raw_string(), GetDer(env, cert)))
+                  env->serial_number_string(),
+                  GetCachedField(env, managed, Field::kSerialNumber)) ||
+      !SetLazy<LazyField::kRaw>(env, info, env->raw_string(), holder))
       [[unlikely]] {
     return {};
   }
@@ -797,22 +930,29 @@ Local<FunctionTemplate> X509Certificate::GetConstructorTemplate(
         BaseObject::kInternalFieldCount);
     tmpl->SetClassName(
         FIXED_ONE_BYTE_STRING(env->isolate(), "X509Certificate"));
-    SetProtoMethodNoSideEffect(isolate, tmpl, "subject", Subject);
-    SetProtoMethodNoSideEffect(isolate, tmpl, "subjectAltName", SubjectAltName);
-    SetProtoMethodNoSideEffect(isolate, tmpl, "infoAccess", InfoAccess);
-    SetProtoMethodNoSideEffect(isolate, tmpl, "issuer", Issuer);
-    SetProtoMethodNoSideEffect(isolate, tmpl, "validTo", ValidTo);
-    SetProtoMethodNoSideEffect(isolate, tmpl, "validFrom", ValidFrom);
+    SetProtoMethodNoSideEffect(
+        isolate, tmpl, "subject", CachedField<Field::kSubject>);
+    SetProtoMethodNoSideEffect(
+        isolate, tmpl, "subjectAltName", CachedField<Field::kSubjectAltName>);
+    SetProtoMethodNoSideEffect(
+        isolate, tmpl, "infoAccess", CachedField<Field::kInfoAccess>);
+    SetProtoMethodNoSideEffect(
+        isolate, tmpl, "issuer", CachedField<Field::kIssuer>);
+    SetProtoMethodNoSideEffect(
+        isolate, tmpl, "validTo", CachedField<Field::kValidTo>);
+    SetProtoMethodNoSideEffect(
+        isolate, tmpl, "validFrom", CachedField<Field::kValidFrom>);
     SetProtoMethodNoSideEffect(isolate, tmpl, "validToDate", ValidToDate);
     SetProtoMethodNoSideEffect(isolate, tmpl, "validFromDate", ValidFromDate);
     SetProtoMethodNoSideEffect(
-        isolate, tmpl, "fingerprint", Fingerprint<Digest::SHA1>);
+        isolate, tmpl, "fingerprint", CachedField<Field::kFingerprint>);
     SetProtoMethodNoSideEffect(
-        isolate, tmpl, "fingerprint256", Fingerprint<Digest::SHA256>);
+        isolate, tmpl, "fingerprint256", CachedField<Field::kFingerprint256>);
     SetProtoMethodNoSideEffect(
-        isolate, tmpl, "fingerprint512", Fingerprint<Digest::SHA512>);
+        isolate, tmpl, "fingerprint512", CachedField<Field::kFingerprint512>);
     SetProtoMethodNoSideEffect(isolate, tmpl, "keyUsage", KeyUsage);
-    SetProtoMethodNoSideEffect(isolate, tmpl, "serialNumber", SerialNumber);
+    SetProtoMethodNoSideEffect(
+        isolate, tmpl, "serialNumber", CachedField<Field::kSerialNumber>);
     SetProtoMethodNoSideEffect(isolate, tmpl, "pem", Pem);
     SetProtoMethodNoSideEffect(isolate, tmpl, "raw", Der);
     SetProtoMethodNoSideEffect(isolate, tmpl, "publicKey", PublicKey);
@@ -838,8 +978,7 @@ bool X509Certificate::HasInstance(Environment* env, Local<Object> object) {
 MaybeLocal<Object> X509Certificate::New(Environment* env,
                                         X509Pointer cert,
                                         STACK_OF(X509) * issuer_chain) {
-  std::shared_ptr<ManagedX509> mcert(new ManagedX509(std::move(cert)));
-  return New(env, std::move(mcert), issuer_chain);
+  return New(env, ManagedX509::GetOrCreate(std::move(cert)), issuer_chain);
 }
 
 MaybeLocal<Object> X509Certificate::New(Environment* env,
@@ -904,14 +1043,21 @@ MaybeLocal<Object> X509Certificate::GetPeerCert(Environment* env,
 }
 
 v8::MaybeLocal<v8::Value> X509Certificate::toObject(Environment* env) {
-  return toObject(env, view());
+  if (!view()) [[unlikely]]
+    return {};
+  return X509ToObject(env, this).FromMaybe(Local<Value>());
 }
 
 v8::MaybeLocal<v8::Value> X509Certificate::toObject(Environment* env,
                                                     const X509View& cert) {
   if (!cert) [[unlikely]]
     return {};
-  return X509ToObject(env, cert).FromMaybe(Local<Value>());
+  // Peer certificates are usually the same for many connections, so the
+  // fields derived from them are taken from the shared cache entry.
+  Local<Object> holder;
+  if (!New(env, ManagedX509::GetOrCreate(cert)).ToLocal(&holder)) return {};
+  return X509ToObject(env, Unwrap<X509Certificate>(holder))
+      .FromMaybe(Local<Value>());
 }
 
 X509Certificate::X509Certificate(Environment* env,
@@ -971,19 +1117,22 @@ void X509Certificate::Initialize(Environment* env, Local<Object> target) {
 void X509Certificate::RegisterExternalReferences(
     ExternalReferenceRegistry* registry) {
   registry->Register(Parse);
-  registry->Register(Subject);
-  registry->Register(SubjectAltName);
-  registry->Register(InfoAccess);
-  registry->Register(Issuer);
-  registry->Register(ValidTo);
-  registry->Register(ValidFrom);
+#define V(name) registry->Register(LazyFieldGetter<LazyField::name>);
+  X509_LAZY_FIELDS(V)
+#undef V
+  registry->Register(CachedField<Field::kSubject>);
+  registry->Register(CachedField<Field::kSubjectAltName>);
+  registry->Register(CachedField<Field::kInfoAccess>);
+  registry->Register(CachedField<Field::kIssuer>);
+  registry->Register(CachedField<Field::kValidTo>);
+  registry->Register(CachedField<Field::kValidFrom>);
   registry->Register(ValidToDate);
   registry->Register(ValidFromDate);
-  registry->Register(Fingerprint<Digest::SHA1>);
-  registry->Register(Fingerprint<Digest::SHA256>);
-  registry->Register(Fingerprint<Digest::SHA512>);
+  registry->Register(CachedField<Field::kFingerprint>);
+  registry->Register(CachedField<Field::kFingerprint256>);
+  registry->Register(CachedField<Field::kFingerprint512>);
   registry->Register(KeyUsage);
-  registry->Register(SerialNumber);
+  registry->Register(CachedField<Field::kSerialNumber>);
   registry->Register(Pem);
   registry->Register(Der);
   registry->Register(PublicKey);
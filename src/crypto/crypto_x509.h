@@ -8,9 +8,15 @@
 #include "env.h"
 #include "memory_tracker.h"
 #include "ncrypto.h"
+#include "node_mutex.h"
 #include "node_worker.h"
 #include "v8.h"
 
+#include <array>
+#include <memory>
+#include <optional>
+#include <string>
+
 namespace node {
 namespace crypto {
 
@@ -18,13 +24,47 @@ namespace crypto {
 // X509 objects that allows an X509Certificate instance to
 // be cloned at the JS level while pointing at the same
 // underlying X509 instance.
+//
+// Instances obtained through GetOrCreate() or Parse() are shared through a
+// process-wide cache keyed by the SHA-256 digest of the certificate, so that
+// e.g. the same client certificate seen on many TLS connections is only
+// wrapped once, and the text fields derived from it are only computed once.
 class ManagedX509 final : public MemoryRetainer {
  public:
+  enum class Field {
+    kFingerprint,
+    kFingerprint256,
+    kFingerprint512,
+    kSubject,
+    kIssuer,
+    kSubjectAltName,
+    kInfoAccess,
+    kValidFrom,
+    kValidTo,
+    kSerialNumber,
+    kCount
+  };
+
   ManagedX509() = default;
   explicit ManagedX509(ncrypto::X509Pointer&& cert);
   ManagedX509(const ManagedX509& that);
   ManagedX509& operator=(const ManagedX509& that);
 
+  // Returns the cached entry for the certificate that |cert| encodes, adding
+  // one if there is none yet.
+  static std::shared_ptr<ManagedX509> GetOrCreate(ncrypto::X509Pointer&& cert);
+  static std::shared_ptr<ManagedX509> GetOrCreate(
+      const ncrypto::X509View& cert);
+  // Parses a PEM or DER certificate, skipping the parsing if the same input
+  // has been parsed before. Sets |error| if parsing fails.
+  static std::shared_ptr<ManagedX509> Parse(
+      const ncrypto::Buffer<const unsigned char>& data,
+      std::optional<int>* error);
+
+  // Returns the text of |field|, which is computed on first use, or nullptr
+  // if the certificate does not have the field. Can be used from any thread.
+  const std::string* GetField(Field field);
+
   inline operator bool() const { return !!cert_; }
   inline X509* get() const { return cert_.get(); }
   inline ncrypto::X509View view() const { return cert_; }
@@ -35,7 +75,12 @@ class ManagedX509 final : public MemoryRetainer {
   SET_SELF_SIZE(ManagedX509)
 
  private:
+  static constexpr size_t kFieldCount = static_cast<size_t>(Field::kCount);
+
   ncrypto::X509Pointer cert_;
+  Mutex fields_mutex_;
+  std::array<bool, kFieldCount> computed_{};
+  std::array<std::optional<std::string>, kFieldCount> fields_;
 };
 
 class X509Certificate final : public BaseObject {
@@ -78,6 +123,7 @@ class X509Certificate final : public BaseObject {
 
   inline ncrypto::X509View view() const { return *cert_; }
   inline X509* get() { return cert_->get(); }
+  inline ManagedX509* managed() const { return cert_.get(); }
 
   v8::MaybeLocal<v8::Value> toObject(Environment* env);
   static v8::MaybeLocal<v8::Value> toObject(Environment* env,
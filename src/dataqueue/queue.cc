@@ -15,6 +15,9 @@
 #include <algorithm>
 #include <deque>
 #include <initializer_list>
+#ifndef _WIN32
+#include <fcntl.h>
+#endif
 #include <memory>
 #include <vector>
 
@@ -24,6 +27,7 @@ using v8::ArrayBufferView;
 using v8::BackingStore;
 using v8::Local;
 using v8::Object;
+using v8::String;
 using v8::Value;
 
 namespace {
@@ -644,12 +648,28 @@ class InMemoryEntry final : public EntryImpl {
     bool ended_ = false;
   };
 
+  // Releases the bytes charged to a MemoryBudget once the entry that was
+  // charged and all of its slices are gone.
+  struct BudgetCharge final {
+    std::shared_ptr<DataQueue::MemoryBudget> budget;
+    uint64_t length;
+
+    BudgetCharge(std::shared_ptr<DataQueue::MemoryBudget> budget,
+                 uint64_t length)
+        : budget(std::move(budget)), length(length) {
+      this->budget->Charge(length);
+    }
+    ~BudgetCharge() { budget->Release(length); }
+  };
+
   InMemoryEntry(std::shared_ptr<BackingStore> backing_store,
                 uint64_t offset,
-                uint64_t byte_length)
+                uint64_t byte_length,
+                std::shared_ptr<BudgetCharge> charge = nullptr)
       : backing_store_(std::move(backing_store)),
         offset_(offset),
-        byte_length_(byte_length) {
+        byte_length_(byte_length),
+        charge_(std::move(charge)) {
     // The offset_ + byte_length_ cannot extend beyond the size of the
     // backing store, because that would just be silly.
     CHECK_LE(offset_ + byte_length_, backing_store_->ByteLength());
@@ -674,7 +694,8 @@ class InMemoryEntry final : public EntryImpl {
         return std::make_unique<EmptyEntry>();
       }
 
-      return std::make_unique<InMemoryEntry>(backing_store_, start, len);
+      return std::make_unique<InMemoryEntry>(
+          backing_store_, start, len, charge_);
     };
 
     start += offset_;
@@ -711,6 +732,7 @@ class InMemoryEntry final : public EntryImpl {
   std::shared_ptr<BackingStore> backing_store_;
   uint64_t offset_;
   uint64_t byte_length_;
+  std::shared_ptr<BudgetCharge> charge_;
 
   friend class InMemoryReader;
 };
@@ -819,7 +841,9 @@ class FdEntry final : public EntryImpl {
   // the race
   //   condition described in the comment above.
  public:
-  static std::unique_ptr<FdEntry> Create(Environment* env, Local<Value> path) {
+  static std::unique_ptr<FdEntry> Create(Environment* env,
+                                         Local<Value> path,
+                                         uint64_t readahead) {
     // We're only going to create the FdEntry if the file exists.
     uv_fs_t req = uv_fs_t();
     auto cleanup = OnScopeLeave([&] { uv_fs_req_cleanup(&req); });
@@ -828,19 +852,88 @@ class FdEntry final : public EntryImpl {
     if (uv_fs_stat(nullptr, &req, buf->out(), nullptr) < 0) return nullptr;
 
     return std::make_unique<FdEntry>(
-        env, std::move(buf), req.statbuf, 0, req.statbuf.st_size);
+        env, std::move(buf), req.statbuf, 0, req.statbuf.st_size, readahead);
+  }
+
+  static std::unique_ptr<FdEntry> CreateTemp(Environment* env,
+                                             const uint8_t* data,
+                                             uint64_t length) {
+    char tmpdir[PATH_MAX_BYTES];
+    size_t tmpdir_len = sizeof(tmpdir);
+    if (uv_os_tmpdir(tmpdir, &tmpdir_len) != 0) return nullptr;
+    std::string tmpl = std::string(tmpdir, tmpdir_len) + kPathSeparator +
+                       "node-blob-XXXXXX";
+
+    uv_fs_t req = uv_fs_t();
+    auto cleanup = OnScopeLeave([&] { uv_fs_req_cleanup(&req); });
+    int fd = uv_fs_mkstemp(nullptr, &req, tmpl.c_str(), nullptr);
+    if (fd < 0) return nullptr;
+    std::string path = req.path;
+    uv_fs_req_cleanup(&req);
+
+    auto remove = [](const char* path) {
+      uv_fs_t req;
+      uv_fs_unlink(nullptr, &req, path, nullptr);
+      uv_fs_req_cleanup(&req);
+    };
+
+    int64_t offset = 0;
+    int err = 0;
+    while (static_cast<uint64_t>(offset) < length) {
+      size_t chunk = static_cast<size_t>(
+          std::min<uint64_t>(length - offset, INT32_MAX));
+      uv_buf_t buf = uv_buf_init(
+          const_cast<char*>(reinterpret_cast<const char*>(data + offset)),
+          static_cast<unsigned int>(chunk));
+      err = uv_fs_write(nullptr, &req, fd, &buf, 1, offset, nullptr);
+      uv_fs_req_cleanup(&req);
+      if (err <= 0) break;
+      offset += err;
+      err = 0;
+    }
+    if (err == 0) err = uv_fs_fstat(nullptr, &req, fd, nullptr);
+    uv_stat_t stat = req.statbuf;
+    uv_fs_req_cleanup(&req);
+    uv_fs_close(nullptr, &req, fd, nullptr);
+    if (err < 0) {
+      remove(path.c_str());
+      return nullptr;
+    }
+
+    Local<String> path_string;
+    if (!String::NewFromUtf8(env->isolate(), path.c_str())
+             .ToLocal(&path_string)) {
+      remove(path.c_str());
+      return nullptr;
+    }
+    // The path is shared by all slices of the entry, so the file is removed
+    // along with the last of them.
+    std::shared_ptr<BufferValue> buf(
+        new BufferValue(env->isolate(), path_string),
+        [remove](BufferValue* value) {
+          remove(value->out());
+          delete value;
+        });
+    return std::make_unique<FdEntry>(env,
+                                     std::move(buf),
+                                     stat,
+                                     0,
+                                     length,
+                                     DataQueue::kDefaultFdReadahead);
   }
 
   FdEntry(Environment* env,
           std::shared_ptr<BufferValue> path_,
           uv_stat_t stat,
           uint64_t start,
-          uint64_t end)
+          uint64_t end,
+          uint64_t readahead)
       : env_(env),
         path_(std::move(path_)),
         stat_(stat),
         start_(start),
-        end_(end) {
+        end_(end),
+        readahead_(readahead) {
     CHECK_LE(start, end);
   }
 
@@ -859,7 +952,8 @@ class FdEntry final : public EntryImpl {
     CHECK(new_start >= start_);
     CHECK(new_end <= end_);
 
-    return std::make_unique<FdEntry>(env_, path_, stat_, new_start, new_end);
+    return std::make_unique<FdEntry>(
+        env_, path_, stat_, new_start, new_end, readahead_);
   }
 
   std::optional<uint64_t> size() const override { return end_ - start_; }
@@ -878,6 +972,7 @@ class FdEntry final : public EntryImpl {
   uv_stat_t stat_;
   uint64_t start_ = 0;
   uint64_t end_ = 0;
+  uint64_t readahead_ = 0;
 
   bool is_modified(const uv_stat_t& other) {
     return other.st_size != stat_.st_size ||
@@ -910,6 +1005,14 @@ class FdEntry final : public EntryImpl {
         uv_fs_close(nullptr, &req, file, nullptr);
         return nullptr;
       }
+#ifdef POSIX_FADV_SEQUENTIAL
+      // Let the kernel read ahead aggressively too. This is only a hint, so
+      // failures are ignored.
+      USE(posix_fadvise(file,
+                        entry->start_,
+                        entry->end_ - entry->start_,
+                        POSIX_FADV_SEQUENTIAL));
+#endif
       Realm* realm = entry->env()->principal_realm();
       return std::make_shared<ReaderImpl>(
           BaseObjectPtr<fs::FileHandle>(
@@ -922,7 +1025,15 @@ class FdEntry final : public EntryImpl {
     }
 
     explicit ReaderImpl(BaseObjectPtr<fs::FileHandle> handle, FdEntry* entry)
-        : env_(handle->env()), handle_(std::move(handle)), entry_(entry) {
+        : env_(handle->env()),
+          handle_(std::move(handle)),
+          entry_(entry),
+          readahead_(entry->readahead_) {
+      if (readahead_ > 0) {
+        uint64_t chunk_size =
+            std::clamp<uint64_t>(readahead_ / 2, kMinChunkSize, kMaxChunkSize);
+        handle_->set_read_chunk_size(static_cast<int64_t>(chunk_size));
+      }
       handle_->PushStreamListener(this);
       handle_->env()->AddCleanupHook(cleanup, this);
     }
@@ -949,32 +1060,46 @@ class FdEntry final : public EntryImpl {
       }
 
       CHECK(reading_);
-      auto pending = DequeuePendingPull();
 
+      int status = bob::STATUS_CONTINUE;
       if (CheckModified(entry_, handle_->GetFD())) {
-        DrainAndClose();
         // The file was modified while the read was pending. We need to error.
-        std::move(pending.next)(UV_EINVAL, nullptr, 0, [](uint64_t) {});
-        return;
+        status = UV_EINVAL;
+      } else if (nread < 0) {
+        status = nread == UV_EOF ? bob::STATUS_EOS : static_cast<int>(nread);
       }
 
-      if (nread < 0) {
-        if (nread == UV_EOF) {
-          std::move(pending.next)(bob::STATUS_EOS, nullptr, 0, [](uint64_t) {});
-        } else {
-          std::move(pending.next)(nread, nullptr, 0, [](uint64_t) {});
+      if (status != bob::STATUS_CONTINUE) {
+        if (pending_pulls_.empty()) {
+          // Hand out the buffered data first, then report the status.
+          final_status_ = status;
+          reading_ = false;
+          if (handle_->IsAlive()) handle_->ReadStop();
+          return;
         }
-
-        return DrainAndClose();
+        auto pending = DequeuePendingPull();
+        DrainAndClose();
+        std::move(pending.next)(status, nullptr, 0, [](uint64_t) {});
+        return;
       }
 
-      DataQueue::Vec vec;
-      vec.base = static_cast<uint8_t*>(store->Data());
-      vec.len = static_cast<uint64_t>(nread);
-      std::move(pending.next)(
-          bob::STATUS_CONTINUE, &vec, 1, [store](uint64_t) {});
-
       if (pending_pulls_.empty()) {
+        // Read ahead of the consumer.
+        buffered_bytes_ += nread;
+        buffered_.push_back({std::move(store), static_cast<size_t>(nread)});
+      } else {
+        // Data is only buffered while no pulls are pending.
+        CHECK(buffered_.empty());
+        auto pending = DequeuePendingPull();
+        DataQueue::Vec vec;
+        vec.base = static_cast<uint8_t*>(store->Data());
+        vec.len = static_cast<uint64_t>(nread);
+        std::move(pending.next)(
+            bob::STATUS_CONTINUE, &vec, 1, [store](uint64_t) {});
+      }
+
+      if (pending_pulls_.empty() && buffered_bytes_ >= readahead_ &&
+          reading_ && !ended_) {
         reading_ = false;
         if (handle_->IsAlive()) handle_->ReadStop();
       }
@@ -996,11 +1121,38 @@ class FdEntry final : public EntryImpl {
         return UV_EINVAL;
       }
 
-      pending_pulls_.emplace_back(std::move(next), shared_from_this());
-      if (!reading_) {
-        reading_ = true;
-        handle_->ReadStart();
+      if (!buffered_.empty()) {
+        // Serve the pull synchronously from the readahead buffer.
+        size_t n =
+            std::min(buffered_.size(), std::max<size_t>(max_count_hint, 1));
+        std::vector<DataQueue::Vec> vecs(n);
+        std::vector<std::shared_ptr<v8::BackingStore>> stores;
+        stores.reserve(n);
+        for (size_t i = 0; i < n; i++) {
+          BufferedChunk& chunk = buffered_.front();
+          vecs[i].base = static_cast<uint8_t*>(chunk.store->Data());
+          vecs[i].len = chunk.length;
+          buffered_bytes_ -= chunk.length;
+          stores.push_back(std::move(chunk.store));
+          buffered_.pop_front();
+        }
+        MaybeStartReading();
+        std::move(next)(bob::STATUS_CONTINUE,
+                        vecs.data(),
+                        vecs.size(),
+                        [stores = std::move(stores)](uint64_t) {});
+        return bob::STATUS_CONTINUE;
       }
+
+      if (final_status_.has_value()) {
+        int status = final_status_.value();
+        DrainAndClose();
+        std::move(next)(status, nullptr, 0, [](uint64_t) {});
+        return status;
+      }
+
+      pending_pulls_.emplace_back(std::move(next), shared_from_this());
+      MaybeStartReading();
       return bob::STATUS_WAIT;
     }
 
@@ -1009,6 +1161,10 @@ class FdEntry final : public EntryImpl {
     SET_SELF_SIZE(ReaderImpl)
 
    private:
+    // Bounds of the read size derived from the readahead.
+    static constexpr uint64_t kMinChunkSize = 64 * 1024;
+    static constexpr uint64_t kMaxChunkSize = 8 * 1024 * 1024;
+
     struct PendingPull {
       Next next;
       std::shared_ptr<ReaderImpl> self;
@@ -1016,13 +1172,33 @@ class FdEntry final : public EntryImpl {
           : next(std::move(next)), self(std::move(self)) {}
     };
 
+    struct BufferedChunk {
+      std::shared_ptr<v8::BackingStore> store;
+      size_t length;
+    };
+
     Environment* env_;
     BaseObjectPtr<fs::FileHandle> handle_;
     FdEntry* entry_;
     std::deque<PendingPull> pending_pulls_;
+    // Data read ahead of the consumer, and the EOS or error status that
+    // follows it once the file has been read completely.
+    std::deque<BufferedChunk> buffered_;
+    uint64_t buffered_bytes_ = 0;
+    std::optional<int> final_status_;
+    const uint64_t readahead_;
     bool reading_ = false;
     bool ended_ = false;
 
+    // Keeps reading while pulls are pending or the readahead buffer has
+    // room left.
+    void MaybeStartReading() {
+      if (reading_ || ended_ || final_status_.has_value()) return;
+      if (pending_pulls_.empty() && buffered_bytes_ >= readahead_) return;
+      reading_ = true;
+      handle_->ReadStart();
+    }
+
     static void cleanup(void* self) {
       auto ptr = static_cast<ReaderImpl*>(self);
       ptr->DrainAndClose();
@@ -1031,6 +1207,8 @@ class FdEntry final : public EntryImpl {
     void DrainAndClose() {
       if (ended_) return;
       ended_ = true;
+      buffered_.clear();
+      buffered_bytes_ = 0;
       while (!pending_pulls_.empty()) {
         auto pending = DequeuePendingPull();
         std::move(pending.next)(bob::STATUS_EOS, nullptr, 0, [](uint64_t) {});
@@ -1119,12 +1297,21 @@ std::unique_ptr<DataQueue::Entry> DataQueue::CreateInMemoryEntryFromView(
 
 std::unique_ptr<DataQueue::Entry>
 DataQueue::CreateInMemoryEntryFromBackingStore(
-    std::shared_ptr<BackingStore> store, uint64_t offset, uint64_t length) {
+    std::shared_ptr<BackingStore> store,
+    uint64_t offset,
+    uint64_t length,
+    std::shared_ptr<MemoryBudget> budget) {
   CHECK(store);
   if (offset + length > store->ByteLength()) {
     return nullptr;
   }
-  return std::make_unique<InMemoryEntry>(std::move(store), offset, length);
+  std::shared_ptr<InMemoryEntry::BudgetCharge> charge;
+  if (budget) {
+    charge = std::make_shared<InMemoryEntry::BudgetCharge>(std::move(budget),
+                                                           length);
+  }
+  return std::make_unique<InMemoryEntry>(
+      std::move(store), offset, length, std::move(charge));
 }
 
 std::unique_ptr<DataQueue::Entry> DataQueue::CreateDataQueueEntry(
@@ -1132,9 +1319,14 @@ std::unique_ptr<DataQueue::Entry> DataQueue::CreateDataQueueEntry(
   return std::make_unique<DataQueueEntry>(std::move(data_queue));
 }
 
-std::unique_ptr<DataQueue::Entry> DataQueue::CreateFdEntry(Environment* env,
-                                                           Local<Value> path) {
-  return FdEntry::Create(env, path);
+std::unique_ptr<DataQueue::Entry> DataQueue::CreateFdEntry(
+    Environment* env, Local<Value> path, uint64_t readahead) {
+  return FdEntry::Create(env, path, readahead);
+}
+
+std::unique_ptr<DataQueue::Entry> DataQueue::CreateTempFileEntry(
+    Environment* env, const uint8_t* data, uint64_t length) {
+  return FdEntry::CreateTemp(env, data, length);
 }
 
 void DataQueue::Initialize(Environment* env, v8::Local<v8::Object> target) {
@@ -11,6 +11,7 @@
 #include <uv.h>
 #include <v8.h>
 
+#include <atomic>
 #include <memory>
 #include <optional>
 #include <vector>
@@ -149,6 +150,37 @@ class DataQueue : public MemoryRetainer {
     virtual void EntryRead(size_t amount) = 0;
   };
 
+  // Keeps count of the bytes held by the in-memory entries charged to it.
+  // Entries release their charge when the last slice sharing their memory
+  // is destroyed, on whichever thread that happens.
+  class MemoryBudget final {
+   public:
+    explicit MemoryBudget(uint64_t limit) : limit_(limit) {}
+
+    uint64_t limit() const { return limit_.load(std::memory_order_relaxed); }
+    void set_limit(uint64_t limit) {
+      limit_.store(limit, std::memory_order_relaxed);
+    }
+    uint64_t used() const { return used_.load(std::memory_order_relaxed); }
+
+    // Returns true if `length` more bytes fit into the budget.
+    bool Fits(uint64_t length) const {
+      uint64_t max = limit();
+      return length <= max && used() <= max - length;
+    }
+
+    void Charge(uint64_t length) {
+      used_.fetch_add(length, std::memory_order_relaxed);
+    }
+    void Release(uint64_t length) {
+      used_.fetch_sub(length, std::memory_order_relaxed);
+    }
+
+   private:
+    std::atomic<uint64_t> limit_;
+    std::atomic<uint64_t> used_{0};
+  };
+
   // A DataQueue::Entry represents a logical chunk of data in the queue.
   // The entry may or may not represent memory-resident data. It may
   // or may not be consumable more than once.
@@ -212,17 +244,37 @@ class DataQueue : public MemoryRetainer {
   // Creates an idempotent Entry from a v8::BackingStore. It is the
   // callers responsibility to ensure that the BackingStore is not
   // otherwise modified through any other means. If the ArrayBuffer
-  // is not detachable, nullptr will be returned.
+  // is not detachable, nullptr will be returned. If a budget is given,
+  // `length` bytes are charged to it for as long as the entry or any of
+  // its slices is alive.
   static std::unique_ptr<Entry> CreateInMemoryEntryFromBackingStore(
       std::shared_ptr<v8::BackingStore> store,
       uint64_t offset,
-      uint64_t length);
+      uint64_t length,
+      std::shared_ptr<MemoryBudget> budget = nullptr);
 
   static std::unique_ptr<Entry> CreateDataQueueEntry(
       std::shared_ptr<DataQueue> data_queue);
 
-  static std::unique_ptr<Entry> CreateFdEntry(Environment* env,
-                                              v8::Local<v8::Value> path);
+  // Readers of an fd-backed entry keep reading ahead of the consumer until
+  // this many bytes are buffered, using reads of half that size so that one
+  // buffer can be filled while the other is consumed. A readahead of 0
+  // only reads when data is pulled.
+  static constexpr uint64_t kDefaultFdReadahead = 2 * 1024 * 1024;
+
+  static std::unique_ptr<Entry> CreateFdEntry(
+      Environment* env,
+      v8::Local<v8::Value> path,
+      uint64_t readahead = kDefaultFdReadahead);
+
+  // Copies `length` bytes from `data` into a new file in the temporary
+  // directory and returns an fd-backed entry for it, so that the data no
+  // longer needs to be held in memory. The file is removed once the entry
+  // and all of its slices are gone. Returns nullptr if the file could not
+  // be written.
+  static std::unique_ptr<Entry> CreateTempFileEntry(Environment* env,
+                                                    const uint8_t* data,
+                                                    uint64_t length);
 
   // Creates a Reader for the given queue. If the queue is idempotent,
   // any number of readers can be created, all of which are guaranteed
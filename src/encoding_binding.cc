@@ -8,6 +8,7 @@
 #include "string_bytes.h"
 #include "v8.h"
 
+#include <algorithm>
 #include <cstdint>
 
 namespace node {
@@ -19,8 +20,10 @@ using v8::BackingStoreInitializationMode;
 using v8::Context;
 using v8::FunctionCallbackInfo;
 using v8::HandleScope;
+using v8::Integer;
 using v8::Isolate;
 using v8::Local;
+using v8::MaybeLocal;
 using v8::Object;
 using v8::ObjectTemplate;
 using v8::SnapshotCreator;
@@ -188,6 +191,187 @@ void BindingData::DecodeUTF8(const FunctionCallbackInfo<Value>& args) {
   }
 }
 
+namespace {
+
+constexpr char kReplacementCharacter[] = "\xEF\xBF\xBD";
+
+// Returns the length of the sequence started by `lead`, or 0 if `lead` can't
+// start a sequence.
+inline size_t Utf8SequenceLength(uint8_t lead) {
+  if (lead < 0x80) return 1;
+  if (lead >= 0xC2 && lead <= 0xDF) return 2;
+  if (lead >= 0xE0 && lead <= 0xEF) return 3;
+  if (lead >= 0xF0 && lead <= 0xF4) return 4;
+  return 0;
+}
+
+// Whether `byte` may follow at position `index` of a sequence started by
+// `lead`. The second byte is restricted so that overlong forms, surrogates
+// and code points above U+10FFFF are rejected as early as possible, as the
+// Encoding Standard requires.
+inline bool IsUtf8Continuation(uint8_t lead, size_t index, uint8_t byte) {
+  uint8_t lower = 0x80;
+  uint8_t upper = 0xBF;
+  if (index == 1) {
+    if (lead == 0xE0) lower = 0xA0;
+    if (lead == 0xED) upper = 0x9F;
+    if (lead == 0xF0) lower = 0x90;
+    if (lead == 0xF4) upper = 0x8F;
+  }
+  return byte >= lower && byte <= upper;
+}
+
+// Returns the number of bytes at the end of `data` that form the valid
+// beginning of a sequence still waiting for more bytes.
+size_t IncompleteUtf8TailLength(const uint8_t* data, size_t length) {
+  for (size_t k = 1; k <= std::min<size_t>(3, length); k++) {
+    const uint8_t* lead = data + length - k;
+    if ((*lead & 0xC0) == 0x80) continue;
+    if (Utf8SequenceLength(*lead) <= k) return 0;
+    for (size_t i = 1; i < k; i++) {
+      if (!IsUtf8Continuation(*lead, i, lead[i])) return 0;
+    }
+    return k;
+  }
+  return 0;
+}
+
+}  // anonymous namespace
+
+MaybeLocal<Value> Utf8StreamDecoder::Decode(Isolate* isolate,
+                                            const char* data,
+                                            size_t length,
+                                            bool ignore_bom,
+                                            bool fatal,
+                                            bool flush) {
+  const uint8_t* input = reinterpret_cast<const uint8_t*>(data);
+  size_t pos = 0;
+
+  // Complete the sequence left over from the previous chunk, if any.
+  char prefix[4];
+  size_t prefix_length = 0;
+  if (state_[kPendingLength] > 0) {
+    uint8_t* pending = state_ + kPendingBytesStart;
+    size_t have = state_[kPendingLength];
+    const size_t needed = Utf8SequenceLength(pending[0]);
+    bool invalid = false;
+    while (have < needed && pos < length) {
+      if (!IsUtf8Continuation(pending[0], have, input[pos])) {
+        // The byte is not consumed, it starts the next sequence.
+        invalid = true;
+        break;
+      }
+      pending[have++] = input[pos++];
+    }
+
+    if (have < needed && !invalid && !flush) {
+      state_[kPendingLength] = have;
+      return String::Empty(isolate);
+    }
+    state_[kPendingLength] = 0;
+    if (have == needed) {
+      memcpy(prefix, pending, have);
+      prefix_length = have;
+    } else if (fatal) {
+      Reset();
+      THROW_ERR_ENCODING_INVALID_ENCODED_DATA(
+          isolate, "The encoded data was not valid for encoding utf-8");
+      return MaybeLocal<Value>();
+    } else {
+      memcpy(prefix, kReplacementCharacter, 3);
+      prefix_length = 3;
+    }
+  }
+
+  size_t end = length;
+  if (!flush) end -= IncompleteUtf8TailLength(input + pos, length - pos);
+  const char* body = data + pos;
+  size_t body_length = end - pos;
+
+  if (fatal && !simdutf::validate_utf8(body, body_length)) {
+    Reset();
+    THROW_ERR_ENCODING_INVALID_ENCODED_DATA(
+        isolate, "The encoded data was not valid for encoding utf-8");
+    return MaybeLocal<Value>();
+  }
+
+  // The BOM can only be the first code point of the stream.
+  if (!state_[kBOMSeen] && (prefix_length > 0 || body_length > 0)) {
+    state_[kBOMSeen] = 1;
+    if (!ignore_bom) {
+      if (prefix_length > 0) {
+        if (prefix_length == 3 && memcmp(prefix, "\xEF\xBB\xBF", 3) == 0)
+          prefix_length = 0;
+      } else if (body_length >= 3 && memcmp(body, "\xEF\xBB\xBF", 3) == 0) {
+        body += 3;
+        body_length -= 3;
+      }
+    }
+  }
+
+  if (flush) {
+    Reset();
+  } else {
+    memcpy(state_ + kPendingBytesStart, data + end, length - end);
+    state_[kPendingLength] = length - end;
+  }
+
+  // Invalid sequences in non-fatal mode are replaced with U+FFFD by V8,
+  // which follows the Encoding Standard here.
+  Local<Value> body_string;
+  if (body_length == 0) {
+    body_string = String::Empty(isolate);
+  } else if (!StringBytes::Encode(isolate, body, body_length, UTF8)
+                  .ToLocal(&body_string)) {
+    return MaybeLocal<Value>();
+  }
+  if (prefix_length == 0) return body_string;
+
+  Local<String> prefix_string;
+  if (!String::NewFromUtf8(
+           isolate, prefix, v8::NewStringType::kNormal, prefix_length)
+           .ToLocal(&prefix_string)) {
+    return MaybeLocal<Value>();
+  }
+  return String::Concat(isolate, prefix_string, body_string.As<String>());
+}
+
+void BindingData::DecodeUTF8Stream(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);  // state, input, flags
+
+  CHECK_GE(args.Length(), 2);
+  CHECK(args[0]->IsArrayBufferView());
+  CHECK_EQ(Buffer::Length(args[0]), sizeof(Utf8StreamDecoder));
+  Utf8StreamDecoder* decoder =
+      reinterpret_cast<Utf8StreamDecoder*>(Buffer::Data(args[0]));
+
+  if (!(args[1]->IsArrayBuffer() || args[1]->IsSharedArrayBuffer() ||
+        args[1]->IsArrayBufferView())) {
+    return node::THROW_ERR_INVALID_ARG_TYPE(
+        env->isolate(),
+        "The \"list\" argument must be an instance of SharedArrayBuffer, "
+        "ArrayBuffer or ArrayBufferView.");
+  }
+
+  ArrayBufferViewContents<char> buffer(args[1]);
+
+  bool ignore_bom = args[2]->IsTrue();
+  bool has_fatal = args[3]->IsTrue();
+  bool flush = args[4]->IsTrue();
+
+  Local<Value> ret;
+  if (decoder
+          ->Decode(env->isolate(),
+                   buffer.data(),
+                   buffer.length(),
+                   ignore_bom,
+                   has_fatal,
+                   flush)
+          .ToLocal(&ret)) {
+    args.GetReturnValue().Set(ret);
+  }
+}
+
 void BindingData::ToASCII(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
   CHECK_GE(args.Length(), 1);
@@ -220,6 +404,9 @@ void BindingData::CreatePerIsolateProperties(IsolateData* isolate_data,
   SetMethod(isolate, target, "encodeInto", EncodeInto);
   SetMethodNoSideEffect(isolate, target, "encodeUtf8String", EncodeUtf8String);
   SetMethodNoSideEffect(isolate, target, "decodeUTF8", DecodeUTF8);
+  SetMethod(isolate, target, "decodeUTF8Stream", DecodeUTF8Stream);
+  target->Set(FIXED_ONE_BYTE_STRING(isolate, "kUtf8StreamDecoderSize"),
+              Integer::New(isolate, sizeof(Utf8StreamDecoder)));
   SetMethodNoSideEffect(isolate, target, "toASCII", ToASCII);
   SetMethodNoSideEffect(isolate, target, "toUnicode", ToUnicode);
   SetMethodNoSideEffect(isolate, target, "decodeLatin1", DecodeLatin1);
@@ -238,6 +425,7 @@ void BindingData::RegisterTimerExternalReferences(
   registry->Register(EncodeInto);
   registry->Register(EncodeUtf8String);
   registry->Register(DecodeUTF8);
+  registry->Register(DecodeUTF8Stream);
   registry->Register(ToASCII);
   registry->Register(ToUnicode);
   registry->Register(DecodeLatin1);
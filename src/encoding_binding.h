@@ -4,6 +4,7 @@
 #if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
 
 #include <cinttypes>
+#include <cstring>
 #include "aliased_buffer.h"
 #include "node_snapshotable.h"
 #include "v8-fast-api-calls.h"
@@ -12,6 +13,38 @@ namespace node {
 class ExternalReferenceRegistry;
 
 namespace encoding_binding {
+
+// State of a streaming UTF-8 TextDecoder. Like string_decoder, JS allocates
+// kSize bytes for it and passes them to every decodeUTF8Stream() call, so
+// that incomplete sequences at the end of a chunk are carried over to the
+// next one without any buffering in JS.
+class Utf8StreamDecoder {
+ public:
+  // Decodes the next chunk of the stream. If `flush` is true, this is the
+  // last chunk and the decoder is reset for the next stream afterwards.
+  // Throws and returns an empty handle if `fatal` is true and the input is
+  // not valid UTF-8.
+  v8::MaybeLocal<v8::Value> Decode(v8::Isolate* isolate,
+                                   const char* data,
+                                   size_t length,
+                                   bool ignore_bom,
+                                   bool fatal,
+                                   bool flush);
+
+  // The pending bytes are the start of a sequence of up to four bytes.
+  enum Fields {
+    kPendingBytesStart = 0,
+    kPendingLength = 4,
+    kBOMSeen = 5,
+    kNumFields = 6
+  };
+
+ private:
+  inline void Reset() { memset(state_, 0, sizeof(state_)); }
+
+  uint8_t state_[kNumFields] = {};
+};
+
 class BindingData : public SnapshotableObject {
  public:
   struct InternalFieldInfo : public node::InternalFieldInfoBase {
@@ -31,6 +64,8 @@ class BindingData : public SnapshotableObject {
   static void EncodeInto(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void EncodeUtf8String(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void DecodeUTF8(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void DecodeUTF8Stream(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
   static void DecodeLatin1(const v8::FunctionCallbackInfo<v8::Value>& args);
 
   static void ToASCII(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -81,6 +81,16 @@ inline worker::Worker* IsolateData::worker_context() const {
   return worker_context_;
 }
 
+inline builtins::BuiltinLoader* IsolateData::shared_builtin_loader() const {
+  return shared_builtin_loader_.get();
+}
+
+inline void IsolateData::set_shared_builtin_loader(
+    std::unique_ptr<builtins::BuiltinLoader> loader) {
+  CHECK(!shared_builtin_loader_);  // Should be set only once.
+  shared_builtin_loader_ = std::move(loader);
+}
+
 inline v8::Local<v8::String> IsolateData::async_wrap_provider(int index) const {
   return async_wrap_providers_[index].Get(isolate_);
 }
@@ -89,6 +99,20 @@ inline AliasedUint32Array& AsyncHooks::fields() {
   return fields_;
 }
 
+inline AliasedUint32Array& AsyncHooks::provider_counts() {
+  return provider_counts_;
+}
+
+inline void AsyncHooks::IncrementProviderCreated(
+    AsyncWrap::ProviderType provider) {
+  provider_counts_[provider] += 1;
+}
+
+inline void AsyncHooks::IncrementProviderDestroyed(
+    AsyncWrap::ProviderType provider) {
+  provider_counts_[AsyncWrap::PROVIDERS_LENGTH + provider] += 1;
+}
+
 inline AliasedFloat64Array& AsyncHooks::async_id_fields() {
   return async_id_fields_;
 }
@@ -284,6 +308,14 @@ inline ImmediateInfo* Environment::immediate_info() {
   return &immediate_info_;
 }
 
+inline ThreadPoolWorkQueue* Environment::thread_pool_work_queue() {
+  return &thread_pool_work_queue_;
+}
+
+inline EventLoopMetrics* Environment::event_loop_metrics() {
+  return &event_loop_metrics_;
+}
+
 inline AliasedInt32Array& Environment::timeout_info() {
   return timeout_info_;
 }
@@ -711,6 +743,14 @@ inline void Environment::remove_sub_worker_context(worker::Worker* context) {
   sub_worker_contexts_.erase(context);
 }
 
+inline worker::WarmIsolatePool* Environment::warm_isolate_pool() const {
+  return warm_isolate_pool_.get();
+}
+
+inline contextify::ContextPool* Environment::vm_context_pool() const {
+  return vm_context_pool_.get();
+}
+
 template <typename Fn>
 inline void Environment::ForEachWorker(Fn&& iterator) {
   for (worker::Worker* w : sub_worker_contexts_) iterator(w);
@@ -14,6 +14,7 @@
 #include "node_process-inl.h"
 #include "node_shadow_realm.h"
 #include "node_snapshotable.h"
+#include "node_startup_profile.h"
 #include "node_v8_platform-inl.h"
 #include "node_worker.h"
 #include "req_wrap-inl.h"
@@ -33,6 +34,7 @@
 #include <limits>
 #include <memory>
 #include <optional>
+#include <ranges>
 #include <unordered_map>
 
 namespace node {
@@ -46,6 +48,7 @@ using v8::Boolean;
 using v8::Context;
 using v8::EmbedderGraph;
 using v8::EscapableHandleScope;
+using v8::Eternal;
 using v8::ExternalMemoryAccounter;
 using v8::Function;
 using v8::HandleScope;
@@ -607,6 +610,29 @@ IsolateData::IsolateData(Isolate* isolate,
 
 IsolateData::~IsolateData() {}
 
+MaybeLocal<String> IsolateData::InternedString(std::string_view value) {
+  auto it = interned_strings_.find(value);
+  if (it != interned_strings_.end()) return it->second.Get(isolate_);
+
+  if (value.size() > static_cast<size_t>(String::kMaxLength)) {
+    isolate_->ThrowException(ERR_STRING_TOO_LONG(isolate_));
+    return MaybeLocal<String>();
+  }
+  Local<String> string;
+  if (!String::NewFromUtf8(isolate_,
+                           value.data(),
+                           NewStringType::kInternalized,
+                           static_cast<int>(value.size()))
+           .ToLocal(&string)) {
+    return MaybeLocal<String>();
+  }
+  if (interned_strings_.size() < kMaxInternedStrings &&
+      value.size() <= kMaxInternedStringLength) {
+    interned_strings_.emplace(value, Eternal<String>(isolate_, string));
+  }
+  return string;
+}
+
 // Deprecated API, embedders should use v8::Object::Wrap() directly instead.
 void SetCppgcReference(Isolate* isolate,
                        Local<Object> object,
@@ -818,15 +844,60 @@ Environment::Environment(IsolateData* isolate_data,
     CHECK_NOT_NULL(isolate_data->worker_context());
     builtin_loader()->CopySourceAndCodeCacheReferenceFrom(
         isolate_data->worker_context()->env()->builtin_loader());
-  } else if (isolate_data->snapshot_data() != nullptr) {
-    // ... otherwise, if a snapshot was provided, use its code cache.
-    size_t cache_size = isolate_data->snapshot_data()->code_cache.size();
-    per_process::Debug(DebugCategory::CODE_CACHE,
-                       "snapshot contains %zu code cache\n",
-                       cache_size);
-    if (cache_size > 0) {
-      builtin_loader()->RefreshCodeCache(
-          isolate_data->snapshot_data()->code_cache);
+  } else if (isolate_data->shared_builtin_loader() != nullptr) {
+    // ... otherwise, share the code cache with the other Environments of
+    // the isolate, which has been refreshed from the snapshot already.
+    builtin_loader()->CopySourceAndCodeCacheReferenceFrom(
+        isolate_data->shared_builtin_loader());
+  } else {
+    if (isolate_data->snapshot_data() != nullptr) {
+      // ... otherwise, if a snapshot was provided, use its code cache.
+      size_t cache_size = isolate_data->snapshot_data()->code_cache.size();
+      per_process::Debug(DebugCategory::CODE_CACHE,
+                         "snapshot contains %zu code cache\n",
+                         cache_size);
+      if (cache_size > 0) {
+        builtin_loader()->RefreshCodeCache(
+            isolate_data->snapshot_data()->code_cache);
+      }
+    }
+    // The builtins of the isolate are only modified when building a
+    // snapshot.
+    if (!isolate_data->is_building_snapshot()) {
+      auto shared = std::make_unique<builtins::BuiltinLoader>();
+      shared->CopySourceAndCodeCacheReferenceFrom(builtin_loader());
+      isolate_data->set_shared_builtin_loader(std::move(shared));
+    }
+  }
+
+  // Page in the builtins that the application is known to load, so that
+  // compiling them during startup is not bottlenecked on page faults.
+  if (is_main_thread() && !isolate_data->is_building_snapshot() &&
+      !per_process::cli_options->prefetch_builtins.empty()) {
+    std::string profile;
+    if (ReadFileSync(&profile,
+                     per_process::cli_options->prefetch_builtins.c_str()) ==
+        0) {
+      std::vector<std::string> ids;
+      for (auto line : std::views::split(profile, '\n')) {
+        std::string_view id(line.begin(), line.end());
+        if (id.ends_with('\r')) id.remove_suffix(1);
+        if (!id.empty()) ids.emplace_back(id);
+      }
+      builtin_loader()->PrefetchBuiltins(isolate_data->platform(), ids);
+    }
+  }
+  if (is_main_thread() && !isolate_data->is_building_snapshot()) {
+    if (!per_process::cli_options->startup_profile_use.empty()) {
+      startup_profile::Use(this, per_process::cli_options->startup_profile_use);
+    }
+    if (!per_process::cli_options->startup_profile.empty()) {
+      AtExit(
+          [](void* env) {
+            startup_profile::Write(static_cast<Environment*>(env),
+                                   per_process::cli_options->startup_profile);
+          },
+          this);
     }
   }
 
@@ -1079,6 +1150,8 @@ void Environment::InitializeLibuv() {
   uv_unref(reinterpret_cast<uv_handle_t*>(&idle_check_handle_));
   uv_unref(reinterpret_cast<uv_handle_t*>(&task_queues_async_));
 
+  event_loop_metrics_.InitializeHandles(event_loop());
+
   {
     Mutex::ScopedLock lock(native_immediates_threadsafe_mutex_);
     task_queues_async_initialized_ = true;
@@ -1141,11 +1214,11 @@ CompileCacheEnableResult Environment::EnableCompileCache(
   return result;
 }
 
-void Environment::FlushCompileCache() {
+void Environment::FlushCompileCache(bool wait) {
   if (!compile_cache_handler_ || compile_cache_handler_->cache_dir().empty()) {
     return;
   }
-  compile_cache_handler_->Persist();
+  compile_cache_handler_->Persist(wait);
 }
 
 void Environment::ExitEnv(StopFlags::Flags flags) {
@@ -1187,6 +1260,8 @@ void Environment::ClosePerEnvHandles() {
   close_and_finish(reinterpret_cast<uv_handle_t*>(&idle_prepare_handle_));
   close_and_finish(reinterpret_cast<uv_handle_t*>(&idle_check_handle_));
   close_and_finish(reinterpret_cast<uv_handle_t*>(&task_queues_async_));
+  close_and_finish(event_loop_metrics_.prepare_handle());
+  close_and_finish(event_loop_metrics_.check_handle());
 }
 
 void Environment::CleanupHandles() {
@@ -1259,6 +1334,31 @@ MaybeLocal<Value> Environment::RunSnapshotDeserializeMain() const {
   return handle_scope.Escape(Undefined(isolate()));
 }
 
+Maybe<void> Environment::SelectSnapshotEntry(std::string_view name) {
+  HandleScope handle_scope(isolate());
+  Local<Context> ctx = context();
+  Local<Object> entries = snapshot_deserialize_entries();
+  Local<Value> entry;
+  if (!entries.IsEmpty()) {
+    Local<String> key;
+    if (!String::NewFromUtf8(
+             isolate(), name.data(), NewStringType::kNormal, name.size())
+             .ToLocal(&key) ||
+        !entries->Get(ctx, key).ToLocal(&entry)) {
+      return Nothing<void>();
+    }
+  }
+  if (entry.IsEmpty() || !entry->IsFunction()) {
+    THROW_ERR_INVALID_ARG_VALUE(
+        this,
+        "The snapshot does not contain an entry named \"%s\"",
+        std::string(name));
+    return Nothing<void>();
+  }
+  set_snapshot_deserialize_main(entry.As<Function>());
+  return JustVoid();
+}
+
 void Environment::RunCleanup() {
   started_cleanup_ = true;
   TRACE_EVENT0(TRACING_CATEGORY_NODE1(environment), "RunCleanup");
@@ -1463,6 +1563,8 @@ void Environment::ToggleTimerRef(bool ref) {
 void Environment::RunTimers(uv_timer_t* handle) {
   Environment* env = Environment::from_timer_handle(handle);
   TRACE_EVENT0(TRACING_CATEGORY_NODE1(environment), "RunTimers");
+  EventLoopMetrics::PhaseScope phase_scope(env->event_loop_metrics(),
+                                           EventLoopMetrics::kTimers);
 
   if (!env->can_call_into_js())
     return;
@@ -1524,6 +1626,8 @@ void Environment::RunTimers(uv_timer_t* handle) {
 void Environment::CheckImmediate(uv_check_t* handle) {
   Environment* env = Environment::from_immediate_check_handle(handle);
   TRACE_EVENT0(TRACING_CATEGORY_NODE1(environment), "CheckImmediate");
+  EventLoopMetrics::PhaseScope phase_scope(env->event_loop_metrics(),
+                                           EventLoopMetrics::kCheck);
 
   HandleScope scope(env->isolate());
   Context::Scope context_scope(env->context());
@@ -1694,6 +1798,9 @@ AsyncHooks::AsyncHooks(Isolate* isolate, const SerializeInfo* info)
       fields_(isolate, kFieldsCount, MAYBE_FIELD_PTR(info, fields)),
       async_id_fields_(
           isolate, kUidFieldsCount, MAYBE_FIELD_PTR(info, async_id_fields)),
+      provider_counts_(isolate,
+                       AsyncWrap::PROVIDERS_LENGTH * 2,
+                       MAYBE_FIELD_PTR(info, provider_counts)),
       native_execution_async_resources_(isolate),
       info_(info) {
   HandleScope handle_scope(isolate);
@@ -1723,6 +1830,7 @@ void AsyncHooks::Deserialize(Local<Context> context) {
   async_ids_stack_.Deserialize(context);
   fields_.Deserialize(context);
   async_id_fields_.Deserialize(context);
+  provider_counts_.Deserialize(context);
 
   Local<Array> js_execution_async_resources;
   if (info_->js_execution_async_resources != 0) {
@@ -1760,6 +1868,7 @@ std::ostream& operator<<(std::ostream& output,
          << ",  // js_execution_async_resources\n"
          << "  " << i.native_execution_async_resources
          << ",  // native_execution_async_resources\n"
+         << "  " << i.provider_counts << ",  // provider_counts\n"
          << "}";
   return output;
 }
@@ -1771,6 +1880,7 @@ AsyncHooks::SerializeInfo AsyncHooks::Serialize(Local<Context> context,
   info.async_ids_stack = async_ids_stack_.Serialize(context, creator);
   info.fields = fields_.Serialize(context, creator);
   info.async_id_fields = async_id_fields_.Serialize(context, creator);
+  info.provider_counts = provider_counts_.Serialize(context, creator);
   if (!js_execution_async_resources_.IsEmpty()) {
     info.js_execution_async_resources = creator->AddData(
         context, js_execution_async_resources_.Get(context->GetIsolate()));
@@ -1803,6 +1913,7 @@ void AsyncHooks::MemoryInfo(MemoryTracker* tracker) const {
   tracker->TrackField("async_ids_stack", async_ids_stack_);
   tracker->TrackField("fields", fields_);
   tracker->TrackField("async_id_fields", async_id_fields_);
+  tracker->TrackField("provider_counts", provider_counts_);
   tracker->TrackField("js_promise_hooks", js_promise_hooks_);
 }
 
@@ -1870,6 +1981,16 @@ void Environment::stop_sub_worker_contexts() {
   }
 }
 
+void Environment::set_warm_isolate_pool(
+    std::unique_ptr<worker::WarmIsolatePool> pool) {
+  warm_isolate_pool_ = std::move(pool);
+}
+
+void Environment::set_vm_context_pool(
+    std::unique_ptr<contextify::ContextPool> pool) {
+  vm_context_pool_ = std::move(pool);
+}
+
 Environment* Environment::worker_parent_env() const {
   if (worker_context() == nullptr) return nullptr;
   return worker_context()->env();
@@ -1931,6 +2052,23 @@ void Environment::EnqueueDeserializeRequest(DeserializeRequestCallback cb,
   deserialize_requests_.push_back(std::move(request));
 }
 
+// Binding data that is only reached through Realm::GetBindingData() can be
+// deserialized on first access. The others are either unwrapped from the
+// receiver in fast API calls or used by the Environment itself.
+static constexpr bool CanDeferDeserialization(EmbedderObjectType type) {
+  switch (type) {
+    case EmbedderObjectType::k_encoding_binding_data:
+    case EmbedderObjectType::k_fs_binding_data:
+    case EmbedderObjectType::k_v8_binding_data:
+    case EmbedderObjectType::k_blob_binding_data:
+    case EmbedderObjectType::k_url_binding_data:
+    case EmbedderObjectType::k_modules_binding_data:
+      return true;
+    default:
+      return false;
+  }
+}
+
 void Environment::RunDeserializeRequests() {
   HandleScope scope(isolate());
   Local<Context> ctx = context();
@@ -1938,6 +2076,12 @@ void Environment::RunDeserializeRequests() {
   while (!deserialize_requests_.empty()) {
     DeserializeRequest request(std::move(deserialize_requests_.front()));
     deserialize_requests_.pop_front();
+    EmbedderObjectType type = request.info->type;
+    if (CanDeferDeserialization(type)) {
+      principal_realm_->DeferBindingDataDeserialization(
+          static_cast<BindingDataType>(type), std::move(request));
+      continue;
+    }
     Local<Object> holder = request.holder.Get(is);
     request.cb(ctx, holder, request.index, request.info);
     request.holder.Reset();
@@ -35,6 +35,7 @@
 #include "debug_utils.h"
 #include "env_properties.h"
 #include "handle_wrap.h"
+#include "loop_metrics.h"
 #include "node.h"
 #include "node_binding.h"
 #include "node_builtins.h"
@@ -46,6 +47,7 @@
 #include "node_snapshotable.h"
 #include "permission/permission.h"
 #include "req_wrap.h"
+#include "threadpoolwork.h"
 #include "util.h"
 #include "uv.h"
 #include "v8-external-memory-accounter.h"
@@ -64,6 +66,7 @@
 #include <ostream>
 #include <set>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -76,6 +79,7 @@ class ShadowRealm;
 namespace contextify {
 class ContextifyScript;
 class CompiledFnEntry;
+class ContextPool;
 }
 
 namespace performance {
@@ -99,6 +103,7 @@ class ParentInspectorHandle;
 #endif  // HAVE_INSPECTOR
 
 namespace worker {
+class WarmIsolatePool;
 class Worker;
 }
 
@@ -169,6 +174,14 @@ class NODE_EXTERN_PRIVATE IsolateData : public MemoryRetainer {
   inline worker::Worker* worker_context() const;
   inline void set_worker_context(worker::Worker* context);
 
+  // The builtin sources and code cache shared by the main thread Environments
+  // of this isolate, so that embedders creating many Environments do not copy
+  // the code cache of the snapshot for each of them. Null until the first
+  // Environment has been created.
+  inline builtins::BuiltinLoader* shared_builtin_loader() const;
+  inline void set_shared_builtin_loader(
+      std::unique_ptr<builtins::BuiltinLoader> loader);
+
 #define VP(PropertyName, StringValue) V(v8::Private, PropertyName)
 #define VY(PropertyName, StringValue) V(v8::Symbol, PropertyName)
 #define VS(PropertyName, StringValue) V(v8::String, PropertyName)
@@ -199,6 +212,15 @@ class NODE_EXTERN_PRIVATE IsolateData : public MemoryRetainer {
   size_t max_young_gen_size = 1;
   std::unordered_map<const char*, v8::Eternal<v8::String>> static_str_map;
 
+  // Returns the internalized string for the UTF-8 `value`, e.g. for property
+  // keys that bindings create over and over again, like the column names of
+  // SQLite results. The strings are kept for the lifetime of the isolate, up
+  // to kMaxInternedStrings of them; once the table is full, or if `value` is
+  // longer than kMaxInternedStringLength, a new string is returned instead.
+  static constexpr size_t kMaxInternedStrings = 1024;
+  static constexpr size_t kMaxInternedStringLength = 256;
+  v8::MaybeLocal<v8::String> InternedString(std::string_view value);
+
   inline v8::Isolate* isolate() const;
   IsolateData(const IsolateData&) = delete;
   IsolateData& operator=(const IsolateData&) = delete;
@@ -245,6 +267,19 @@ class NODE_EXTERN_PRIVATE IsolateData : public MemoryRetainer {
   std::shared_ptr<PerIsolateOptions> options_;
   worker::Worker* worker_context_ = nullptr;
   PerIsolateWrapperData* wrapper_data_;
+  std::unique_ptr<builtins::BuiltinLoader> shared_builtin_loader_;
+
+  struct InternedStringHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view value) const {
+      return std::hash<std::string_view>()(value);
+    }
+  };
+  std::unordered_map<std::string,
+                     v8::Eternal<v8::String>,
+                     InternedStringHash,
+                     std::equal_to<>>
+      interned_strings_;
 
   static Mutex isolate_data_mutex_;
   static std::unordered_map<uint16_t, std::unique_ptr<PerIsolateWrapperData>>
@@ -298,6 +333,13 @@ class AsyncHooks : public MemoryRetainer {
   inline AliasedUint32Array& fields();
   inline AliasedFloat64Array& async_id_fields();
   inline AliasedFloat64Array& async_ids_stack();
+  // Number of AsyncWraps created and destroyed for each provider type, laid
+  // out as [created..., destroyed...]. These are maintained whether or not
+  // any hooks are enabled. They wrap around, but the number of live resources
+  // is still (created - destroyed) >>> 0.
+  inline AliasedUint32Array& provider_counts();
+  inline void IncrementProviderCreated(AsyncWrap::ProviderType provider);
+  inline void IncrementProviderDestroyed(AsyncWrap::ProviderType provider);
   inline v8::Local<v8::Array> js_execution_async_resources();
   // Returns the native executionAsyncResource value at stack index `index`.
   // Resources provided on the JS side are not stored on the native stack,
@@ -361,6 +403,7 @@ class AsyncHooks : public MemoryRetainer {
     AliasedBufferIndex async_id_fields;
     SnapshotIndex js_execution_async_resources;
     std::vector<SnapshotIndex> native_execution_async_resources;
+    AliasedBufferIndex provider_counts;
   };
 
   SerializeInfo Serialize(v8::Local<v8::Context> context,
@@ -380,6 +423,7 @@ class AsyncHooks : public MemoryRetainer {
   AliasedUint32Array fields_;
   // Attached to a Float64Array that tracks the state of async resources.
   AliasedFloat64Array async_id_fields_;
+  AliasedUint32Array provider_counts_;
 
   void grow_async_ids_stack();
 
@@ -503,17 +547,6 @@ class ShouldNotAbortOnUncaughtScope {
   Environment* env_;
 };
 
-typedef void (*DeserializeRequestCallback)(v8::Local<v8::Context> context,
-                                           v8::Local<v8::Object> holder,
-                                           int index,
-                                           InternalFieldInfoBase* info);
-struct DeserializeRequest {
-  DeserializeRequestCallback cb;
-  v8::Global<v8::Object> holder;
-  int index;
-  InternalFieldInfoBase* info = nullptr;  // Owned by the request
-};
-
 struct EnvSerializeInfo {
   AsyncHooks::SerializeInfo async_hooks;
   TickInfo::SerializeInfo tick_info;
@@ -543,7 +576,7 @@ struct SnapshotMetadata {
 struct SnapshotData {
   enum class DataOwnership { kOwned, kNotOwned };
 
-  static const uint32_t kMagic = 0x143da19;
+  static const uint32_t kMagic = 0x143da1b;
   static const SnapshotIndex kNodeVMContextIndex = 0;
   static const SnapshotIndex kNodeBaseContextIndex = kNodeVMContextIndex + 1;
   static const SnapshotIndex kNodeMainContextIndex = kNodeBaseContextIndex + 1;
@@ -710,6 +743,8 @@ class Environment final : public MemoryRetainer {
 
   inline AsyncHooks* async_hooks();
   inline ImmediateInfo* immediate_info();
+  inline ThreadPoolWorkQueue* thread_pool_work_queue();
+  inline EventLoopMetrics* event_loop_metrics();
   inline AliasedInt32Array& timeout_info();
   inline TickInfo* tick_info();
   inline uint64_t timer_base() const;
@@ -811,6 +846,14 @@ class Environment final : public MemoryRetainer {
   inline void add_sub_worker_context(worker::Worker* context);
   inline void remove_sub_worker_context(worker::Worker* context);
   void stop_sub_worker_contexts();
+  // Isolates prepared ahead of time for Workers started from this
+  // Environment, or nullptr if none have been requested.
+  inline worker::WarmIsolatePool* warm_isolate_pool() const;
+  void set_warm_isolate_pool(std::unique_ptr<worker::WarmIsolatePool> pool);
+  // Contexts prepared ahead of time for vm.createContext(), or nullptr if
+  // none have been requested.
+  inline contextify::ContextPool* vm_context_pool() const;
+  void set_vm_context_pool(std::unique_ptr<contextify::ContextPool> pool);
   template <typename Fn>
   inline void ForEachWorker(Fn&& iterator);
   // Determine if the environment is stopping. This getter is thread-safe.
@@ -849,6 +892,9 @@ class Environment final : public MemoryRetainer {
   v8::MaybeLocal<v8::Value> RunSnapshotSerializeCallback() const;
   v8::MaybeLocal<v8::Value> RunSnapshotDeserializeCallback() const;
   v8::MaybeLocal<v8::Value> RunSnapshotDeserializeMain() const;
+  // Makes the entry function registered under |name| the deserialize main
+  // function, for snapshots with several entry points.
+  v8::Maybe<void> SelectSnapshotEntry(std::string_view name);
 
   // Primitive values are shared across realms.
   // The getters simply proxy to the per-isolate primitive.
@@ -1022,7 +1068,8 @@ class Environment final : public MemoryRetainer {
   // Enable built-in compile cache if it has not yet been enabled.
   // The cache will be persisted to disk on exit.
   CompileCacheEnableResult EnableCompileCache(const std::string& cache_dir);
-  void FlushCompileCache();
+  // If wait is false, the cache may still be written after this returns.
+  void FlushCompileCache(bool wait = true);
 
   void RunAndClearNativeImmediates(bool only_refed = false);
   void RunAndClearInterrupts();
@@ -1093,6 +1140,8 @@ class Environment final : public MemoryRetainer {
 
   AsyncHooks async_hooks_;
   ImmediateInfo immediate_info_;
+  ThreadPoolWorkQueue thread_pool_work_queue_{this};
+  EventLoopMetrics event_loop_metrics_;
   AliasedInt32Array timeout_info_;
   TickInfo tick_info_;
   permission::Permission permission_;
@@ -1173,6 +1222,8 @@ class Environment final : public MemoryRetainer {
   uint64_t flags_;
   uint64_t thread_id_;
   std::unordered_set<worker::Worker*> sub_worker_contexts_;
+  std::unique_ptr<worker::WarmIsolatePool> warm_isolate_pool_;
+  std::unique_ptr<contextify::ContextPool> vm_context_pool_;
 
 #if HAVE_INSPECTOR
   std::unique_ptr<inspector::Agent> inspector_agent_;
@@ -27,8 +27,20 @@
 #include "permission/permission.h"
 #include "string_bytes.h"
 
+#ifdef __linux__
+#include <dirent.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#endif
+
 namespace node {
 
+using v8::Array;
 using v8::Context;
 using v8::DontDelete;
 using v8::DontEnum;
@@ -38,7 +50,9 @@ using v8::HandleScope;
 using v8::Integer;
 using v8::Isolate;
 using v8::Local;
+using v8::LocalVector;
 using v8::MaybeLocal;
+using v8::Null;
 using v8::Object;
 using v8::PropertyAttribute;
 using v8::ReadOnly;
@@ -49,6 +63,67 @@ using v8::Value;
 
 namespace {
 
+#ifdef __linux__
+// Recursive watcher backed by a single inotify instance. libuv (and the JS
+// fallback built on it) needs one uv_fs_event_t, and thus one inotify
+// instance, per directory; here every directory of the tree is added to the
+// same instance and its watch descriptor is mapped back to the directory's
+// path relative to the root. All events read in one loop iteration are
+// coalesced per path and delivered to JS in a single callback:
+//
+//   onchange(status, [filename0, events0, filename1, events1, ...])
+//
+// where events is a combination of UV_RENAME and UV_CHANGE. A filename of
+// '' is the root itself, e.g. when it was deleted or moved, and a null
+// filename signals that events were lost and the tree should be rescanned.
+class RecursiveFSEventWrap : public HandleWrap {
+ public:
+  static void Initialize(Environment* env, Local<Object> target);
+  static void RegisterExternalReferences(ExternalReferenceRegistry* registry);
+  static void New(const FunctionCallbackInfo<Value>& args);
+  static void Start(const FunctionCallbackInfo<Value>& args);
+
+  SET_NO_MEMORY_INFO()
+  SET_MEMORY_INFO_NAME(RecursiveFSEventWrap)
+  SET_SELF_SIZE(RecursiveFSEventWrap)
+
+ private:
+  static const encoding kDefaultEncoding = UTF8;
+  static constexpr uint32_t kWatchMask =
+      IN_ATTRIB | IN_CREATE | IN_MODIFY | IN_DELETE | IN_DELETE_SELF |
+      IN_MOVE_SELF | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR;
+
+  RecursiveFSEventWrap(Environment* env, Local<Object> object);
+  ~RecursiveFSEventWrap() override = default;
+
+  void OnClose() override;
+
+  // Adds watches for `relative` and every directory below it. When `report`
+  // is set, entries found on the way are reported as renames, for
+  // directories created after the watch started.
+  int AddWatches(const std::string& relative, bool report);
+  // Removes the watches of `relative` and every directory below it, for
+  // directories that were moved away and are no longer at that path.
+  void RemoveWatches(const std::string& relative);
+  void AddEvent(std::string&& filename, int events);
+  void ReadEvents();
+  void Flush();
+
+  static void OnPoll(uv_poll_t* handle, int status, int events);
+
+  uv_poll_t handle_;
+  int inotify_fd_ = -1;
+  std::string root_;
+  std::unordered_map<int, std::string> directories_;
+  // Pending events of the current batch, in arrival order.
+  std::vector<std::pair<std::string, int>> events_;
+  std::unordered_map<std::string, size_t> event_index_;
+  // Set when the kernel queue overflowed during the current batch.
+  bool overflowed_ = false;
+  enum encoding encoding_ = kDefaultEncoding;
+};
+#endif  // __linux__
+
 class FSEventWrap: public HandleWrap {
  public:
   static void Initialize(Local<Object> target,
@@ -120,6 +195,10 @@ void FSEventWrap::Initialize(Local<Object> target,
       static_cast<PropertyAttribute>(ReadOnly | DontDelete | DontEnum));
 
   SetConstructorFunction(context, target, "FSEvent", t);
+
+#ifdef __linux__
+  RecursiveFSEventWrap::Initialize(env, target);
+#endif
 }
 
 void FSEventWrap::RegisterExternalReferences(
@@ -127,6 +206,9 @@ void FSEventWrap::RegisterExternalReferences(
   registry->Register(New);
   registry->Register(Start);
   registry->Register(GetInitialized);
+#ifdef __linux__
+  RecursiveFSEventWrap::RegisterExternalReferences(registry);
+#endif
 }
 
 void FSEventWrap::New(const FunctionCallbackInfo<Value>& args) {
@@ -239,6 +321,269 @@ void FSEventWrap::OnEvent(uv_fs_event_t* handle, const char* filename,
   wrap->MakeCallback(env->onchange_string(), arraysize(argv), argv);
 }
 
+#ifdef __linux__
+
+RecursiveFSEventWrap::RecursiveFSEventWrap(Environment* env,
+                                           Local<Object> object)
+    : HandleWrap(env,
+                 object,
+                 reinterpret_cast<uv_handle_t*>(&handle_),
+                 AsyncWrap::PROVIDER_FSEVENTWRAP) {
+  MarkAsUninitialized();
+}
+
+void RecursiveFSEventWrap::Initialize(Environment* env,
+                                      Local<Object> target) {
+  Isolate* isolate = env->isolate();
+  Local<FunctionTemplate> t = NewFunctionTemplate(isolate, New);
+  t->InstanceTemplate()->SetInternalFieldCount(
+      RecursiveFSEventWrap::kInternalFieldCount);
+  t->Inherit(HandleWrap::GetConstructorTemplate(env));
+  SetProtoMethod(isolate, t, "start", Start);
+  SetConstructorFunction(env->context(), target, "RecursiveFSEvent", t);
+}
+
+void RecursiveFSEventWrap::RegisterExternalReferences(
+    ExternalReferenceRegistry* registry) {
+  registry->Register(New);
+  registry->Register(Start);
+}
+
+void RecursiveFSEventWrap::New(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args.IsConstructCall());
+  Environment* env = Environment::GetCurrent(args);
+  new RecursiveFSEventWrap(env, args.This());
+}
+
+// wrap.start(filename, persistent, encoding)
+void RecursiveFSEventWrap::Start(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  RecursiveFSEventWrap* wrap = Unwrap<RecursiveFSEventWrap>(args.This());
+  CHECK_NOT_NULL(wrap);
+  CHECK(wrap->IsHandleClosing());  // Check that Start() has not been called.
+
+  CHECK_GE(args.Length(), 3);
+
+  BufferValue path(env->isolate(), args[0]);
+  CHECK_NOT_NULL(*path);
+  THROW_IF_INSUFFICIENT_PERMISSIONS(
+      env, permission::PermissionScope::kFileSystemRead, *path);
+
+  wrap->encoding_ = ParseEncoding(env->isolate(), args[2], kDefaultEncoding);
+  wrap->root_ = path.ToString();
+  while (wrap->root_.size() > 1 && wrap->root_.back() == '/') {
+    wrap->root_.pop_back();
+  }
+
+  wrap->inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (wrap->inotify_fd_ == -1) {
+    return args.GetReturnValue().Set(uv_translate_sys_error(errno));
+  }
+
+  int err = uv_poll_init(env->event_loop(), &wrap->handle_, wrap->inotify_fd_);
+  if (err != 0) {
+    close(wrap->inotify_fd_);
+    wrap->inotify_fd_ = -1;
+    return args.GetReturnValue().Set(err);
+  }
+  wrap->MarkAsInitialized();
+
+  err = wrap->AddWatches(std::string(), false);
+  if (err == 0) {
+    err = uv_poll_start(&wrap->handle_, UV_READABLE, OnPoll);
+  }
+  if (err != 0) {
+    RecursiveFSEventWrap::Close(args);
+    return args.GetReturnValue().Set(err);
+  }
+
+  // Check for persistent argument
+  if (!args[1]->IsTrue()) {
+    uv_unref(reinterpret_cast<uv_handle_t*>(&wrap->handle_));
+  }
+
+  args.GetReturnValue().Set(0);
+}
+
+void RecursiveFSEventWrap::OnClose() {
+  if (inotify_fd_ != -1) {
+    close(inotify_fd_);
+    inotify_fd_ = -1;
+  }
+  directories_.clear();
+}
+
+int RecursiveFSEventWrap::AddWatches(const std::string& relative,
+                                     bool report) {
+  std::vector<std::string> pending = {relative};
+  while (!pending.empty()) {
+    std::string directory = std::move(pending.back());
+    pending.pop_back();
+    std::string full = directory.empty() ? root_ : root_ + '/' + directory;
+
+    int wd = inotify_add_watch(inotify_fd_, full.c_str(), kWatchMask);
+    if (wd == -1) {
+      // Directories may disappear while the tree is being walked.
+      if (errno == ENOENT || errno == ENOTDIR) continue;
+      return uv_translate_sys_error(errno);
+    }
+    directories_[wd] = directory;
+
+    DIR* dir = opendir(full.c_str());
+    if (dir == nullptr) continue;
+    while (struct dirent* ent = readdir(dir)) {
+      std::string_view name = ent->d_name;
+      if (name == "." || name == "..") continue;
+      std::string child =
+          directory.empty() ? std::string(name)
+                            : directory + '/' + std::string(name);
+      bool is_dir = ent->d_type == DT_DIR;
+      if (ent->d_type == DT_UNKNOWN) {
+        struct stat st;
+        is_dir = lstat((root_ + '/' + child).c_str(), &st) == 0 &&
+                 S_ISDIR(st.st_mode);
+      }
+      if (report) AddEvent(std::string(child), UV_RENAME);
+      if (is_dir) pending.push_back(std::move(child));
+    }
+    closedir(dir);
+  }
+  return 0;
+}
+
+void RecursiveFSEventWrap::RemoveWatches(const std::string& relative) {
+  for (auto it = directories_.begin(); it != directories_.end();) {
+    const std::string& directory = it->second;
+    if (directory == relative ||
+        (directory.starts_with(relative) &&
+         directory[relative.size()] == '/')) {
+      inotify_rm_watch(inotify_fd_, it->first);
+      it = directories_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void RecursiveFSEventWrap::AddEvent(std::string&& filename, int events) {
+  auto it = event_index_.find(filename);
+  if (it != event_index_.end()) {
+    events_[it->second].second |= events;
+    return;
+  }
+  event_index_.emplace(filename, events_.size());
+  events_.emplace_back(std::move(filename), events);
+}
+
+void RecursiveFSEventWrap::ReadEvents() {
+  alignas(struct inotify_event) char buffer[16 * 1024];
+  while (true) {
+    ssize_t n = read(inotify_fd_, buffer, sizeof(buffer));
+    if (n <= 0) {
+      if (n == -1 && errno == EINTR) continue;
+      break;
+    }
+    for (char* p = buffer; p < buffer + n;) {
+      const struct inotify_event* ev =
+          reinterpret_cast<const struct inotify_event*>(p);
+      p += sizeof(*ev) + ev->len;
+
+      if (ev->mask & IN_Q_OVERFLOW) {
+        overflowed_ = true;
+        continue;
+      }
+      auto it = directories_.find(ev->wd);
+      if (it == directories_.end()) continue;
+      if (ev->mask & IN_IGNORED) {
+        directories_.erase(it);
+        continue;
+      }
+
+      std::string filename = it->second;
+      if (ev->len > 0) {
+        if (!filename.empty()) filename += '/';
+        filename += ev->name;
+      }
+      int events = (ev->mask & (IN_ATTRIB | IN_MODIFY)) ? UV_CHANGE : 0;
+      if (ev->mask & ~(IN_ATTRIB | IN_MODIFY | IN_ISDIR)) events |= UV_RENAME;
+
+      if ((ev->mask & IN_ISDIR) && (ev->mask & IN_MOVED_FROM)) {
+        // The subtree is watched again under its new name if it was moved
+        // within the root, which IN_MOVED_TO below takes care of.
+        RemoveWatches(filename);
+      }
+      if ((ev->mask & IN_ISDIR) && (ev->mask & (IN_CREATE | IN_MOVED_TO))) {
+        // Watch the new subtree. Failures, e.g. when it was removed again
+        // already, are reported through the rename of the directory itself.
+        AddWatches(filename, true);
+      }
+      AddEvent(std::move(filename), events);
+    }
+  }
+}
+
+void RecursiveFSEventWrap::Flush() {
+  if (events_.empty() && !overflowed_) return;
+
+  Environment* env = this->env();
+  Isolate* isolate = env->isolate();
+  HandleScope handle_scope(isolate);
+  Context::Scope context_scope(env->context());
+
+  std::vector<std::pair<std::string, int>> events;
+  events.swap(events_);
+  event_index_.clear();
+
+  // Filenames that can not be encoded are passed as Buffers instead.
+  TryCatch try_catch(isolate);
+  LocalVector<Value> values(isolate);
+  values.reserve(events.size() * 2 + 2);
+  if (overflowed_) {
+    overflowed_ = false;
+    values.push_back(Null(isolate));
+    values.push_back(Integer::New(isolate, UV_RENAME));
+  }
+  for (const auto& [filename, flags] : events) {
+    Local<Value> name;
+    if (!StringBytes::Encode(isolate,
+                             filename.data(),
+                             filename.size(),
+                             encoding_).ToLocal(&name)) {
+      name = StringBytes::Encode(
+                 isolate, filename.data(), filename.size(), BUFFER)
+                 .ToLocalChecked();
+    }
+    values.push_back(name);
+    values.push_back(Integer::New(isolate, flags));
+  }
+
+  Local<Value> argv[] = {
+      Integer::New(isolate, 0),
+      Array::New(isolate, values.data(), values.size()),
+  };
+  MakeCallback(env->onchange_string(), arraysize(argv), argv);
+}
+
+void RecursiveFSEventWrap::OnPoll(uv_poll_t* handle, int status, int events) {
+  RecursiveFSEventWrap* wrap =
+      ContainerOf(&RecursiveFSEventWrap::handle_, handle);
+  if (status != 0) {
+    Environment* env = wrap->env();
+    HandleScope handle_scope(env->isolate());
+    Context::Scope context_scope(env->context());
+    Local<Value> argv[] = {
+        Integer::New(env->isolate(), status),
+        Array::New(env->isolate()),
+    };
+    wrap->MakeCallback(env->onchange_string(), arraysize(argv), argv);
+    return;
+  }
+  wrap->ReadEvents();
+  wrap->Flush();
+}
+#endif  // __linux__
+
 }  // anonymous namespace
 }  // namespace node
 
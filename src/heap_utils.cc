@@ -6,6 +6,10 @@
 #include "permission/permission.h"
 #include "stream_base-inl.h"
 #include "util-inl.h"
+#include "zlib.h"
+
+#include <deque>
+#include <vector>
 
 // Copied from https://github.com/nodejs/node/blob/b07dc4d19fdbc15b4f76557dc45b3ce3a43ad0c3/src/util.cc#L36-L41.
 #ifdef _WIN32
@@ -220,45 +224,139 @@ void BuildEmbedderGraph(const FunctionCallbackInfo<Value>& args) {
 }
 
 namespace {
+// Writes the serialized snapshot from a dedicated thread, so the thread that
+// owns the isolate only pays for V8's own serialization while the disk writes
+// and the optional gzip compression overlap with it. At most
+// kMaxPendingChunks chunks are in flight, which lets a slow disk apply
+// backpressure instead of growing a second copy of the snapshot in memory.
 class FileOutputStream : public v8::OutputStream {
  public:
-  FileOutputStream(const int fd, uv_fs_t* req) : fd_(fd), req_(req) {}
-
-  int GetChunkSize() override {
-    return 65536;  // big chunks == faster
+  static constexpr size_t kChunkSize = 65536;  // big chunks == faster
+  static constexpr size_t kMaxPendingChunks = 16;
+
+  FileOutputStream(const int fd, bool compress) : fd_(fd) {
+    if (compress) {
+      if (deflateInit2(&zstream_, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16,
+                       8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        status_ = UV_ENOMEM;
+        return;
+      }
+      compress_ = true;
+      compressed_.resize(kChunkSize);
+    }
+    status_ = uv_thread_create(&thread_, ThreadMain, this);
+    started_ = status_ == 0;
   }
 
+  ~FileOutputStream() override { Finish(); }
+
+  int GetChunkSize() override { return kChunkSize; }
+
   void EndOfStream() override {}
 
   WriteResult WriteAsciiChunk(char* data, const int size) override {
-    DCHECK_EQ(status_, 0);
-    int offset = 0;
+    Mutex::ScopedLock lock(mutex_);
+    while (status_ == 0 && pending_.size() >= kMaxPendingChunks)
+      has_space_.Wait(lock);
+    if (status_ < 0) return kAbort;
+    pending_.emplace_back(data, data + size);
+    has_work_.Signal(lock);
+    return kContinue;
+  }
+
+  // Waits for every queued chunk to reach the file and returns the first
+  // error encountered, if any.
+  int Finish() {
+    if (started_) {
+      {
+        Mutex::ScopedLock lock(mutex_);
+        finished_ = true;
+        has_work_.Signal(lock);
+      }
+      CHECK_EQ(uv_thread_join(&thread_), 0);
+      started_ = false;
+    }
+    if (compress_) {
+      deflateEnd(&zstream_);
+      compress_ = false;
+    }
+    return status_;
+  }
+
+ private:
+  static void ThreadMain(void* data) {
+    static_cast<FileOutputStream*>(data)->Run();
+  }
+
+  void Run() {
+    for (;;) {
+      std::vector<char> chunk;
+      {
+        Mutex::ScopedLock lock(mutex_);
+        while (pending_.empty() && !finished_) has_work_.Wait(lock);
+        if (!pending_.empty()) {
+          chunk = std::move(pending_.front());
+          pending_.pop_front();
+          has_space_.Signal(lock);
+        }
+      }
+
+      // An empty chunk means the stream has finished and the queue is drained.
+      const bool last = chunk.empty();
+      int err = compress_ ? Deflate(chunk, last ? Z_FINISH : Z_NO_FLUSH)
+                          : WriteAll(chunk.data(), chunk.size());
+      if (err < 0) {
+        Mutex::ScopedLock lock(mutex_);
+        status_ = err;
+        has_space_.Signal(lock);
+        return;
+      }
+      if (last) return;
+    }
+  }
+
+  int Deflate(const std::vector<char>& chunk, int flush) {
+    zstream_.next_in =
+        reinterpret_cast<Bytef*>(const_cast<char*>(chunk.data()));
+    zstream_.avail_in = chunk.size();
+    do {
+      zstream_.next_out = reinterpret_cast<Bytef*>(compressed_.data());
+      zstream_.avail_out = compressed_.size();
+      if (deflate(&zstream_, flush) == Z_STREAM_ERROR) return UV_EIO;
+      const int err = WriteAll(compressed_.data(),
+                               compressed_.size() - zstream_.avail_out);
+      if (err < 0) return err;
+    } while (zstream_.avail_out == 0);
+    return 0;
+  }
+
+  int WriteAll(char* data, size_t size) {
+    uv_fs_t req;
+    size_t offset = 0;
     while (offset < size) {
       const uv_buf_t buf = uv_buf_init(data + offset, size - offset);
-      const int num_bytes_written = uv_fs_write(nullptr,
-                                                req_,
-                                                fd_,
-                                                &buf,
-                                                1,
-                                                -1,
-                                                nullptr);
-      uv_fs_req_cleanup(req_);
-      if (num_bytes_written < 0) {
-        status_ = num_bytes_written;
-        return kAbort;
-      }
+      const int num_bytes_written =
+          uv_fs_write(nullptr, &req, fd_, &buf, 1, -1, nullptr);
+      uv_fs_req_cleanup(&req);
+      if (num_bytes_written < 0) return num_bytes_written;
       DCHECK_LE(static_cast<size_t>(num_bytes_written), buf.len);
       offset += num_bytes_written;
     }
-    DCHECK_EQ(offset, size);
-    return kContinue;
+    return 0;
   }
 
-  int status() const { return status_; }
-
- private:
   const int fd_;
-  uv_fs_t* req_;
+  bool compress_ = false;
+  bool started_ = false;
+  z_stream zstream_{};
+  std::vector<char> compressed_;
+  uv_thread_t thread_;
+
+  Mutex mutex_;
+  ConditionVariable has_work_;
+  ConditionVariable has_space_;
+  std::deque<std::vector<char>> pending_;
+  bool finished_ = false;
   int status_ = 0;
 };
 
@@ -354,7 +452,8 @@ inline void TakeSnapshot(Environment* env,
 
 Maybe<void> WriteSnapshot(Environment* env,
                           const char* filename,
-                          HeapProfiler::HeapSnapshotOptions options) {
+                          HeapProfiler::HeapSnapshotOptions options,
+                          bool compress) {
   uv_fs_t req;
   int err;
 
@@ -370,9 +469,11 @@ Maybe<void> WriteSnapshot(Environment* env,
     return Nothing<void>();
   }
 
-  FileOutputStream stream(fd, &req);
+  FileOutputStream stream(fd, compress);
   TakeSnapshot(env, &stream, options);
-  if ((err = stream.status()) < 0) {
+  if ((err = stream.Finish()) < 0) {
+    uv_fs_close(nullptr, &req, fd, nullptr);
+    uv_fs_req_cleanup(&req);
     env->ThrowUVException(err, "write", nullptr, filename);
     return Nothing<void>();
   }
@@ -432,6 +533,15 @@ HeapProfiler::HeapSnapshotOptions GetHeapSnapshotOptions(
   return result;
 }
 
+// The third option byte is optional and requests a gzip-compressed file.
+bool GetHeapSnapshotCompression(Local<Value> options_value) {
+  Local<Uint8Array> arr = options_value.As<Uint8Array>();
+  if (arr->ByteLength() < 3) return false;
+  uint8_t* options =
+      static_cast<uint8_t*>(arr->Buffer()->Data()) + arr->ByteOffset();
+  return options[2] != 0;
+}
+
 void CreateHeapSnapshotStream(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
   CHECK_EQ(args.Length(), 1);
@@ -451,14 +561,16 @@ void TriggerHeapSnapshot(const FunctionCallbackInfo<Value>& args) {
   CHECK_EQ(args.Length(), 2);
   Local<Value> filename_v = args[0];
   auto options = GetHeapSnapshotOptions(args[1]);
+  const bool compress = GetHeapSnapshotCompression(args[1]);
 
   if (filename_v->IsUndefined()) {
-    DiagnosticFilename name(env, "Heap", "heapsnapshot");
+    DiagnosticFilename name(
+        env, "Heap", compress ? "heapsnapshot.gz" : "heapsnapshot");
     THROW_IF_INSUFFICIENT_PERMISSIONS(
         env,
         permission::PermissionScope::kFileSystemWrite,
         Environment::GetCwd(env->exec_path()));
-    if (WriteSnapshot(env, *name, options).IsNothing()) return;
+    if (WriteSnapshot(env, *name, options, compress).IsNothing()) return;
     if (String::NewFromUtf8(isolate, *name).ToLocal(&filename_v)) {
       args.GetReturnValue().Set(filename_v);
     }
@@ -470,7 +582,7 @@ void TriggerHeapSnapshot(const FunctionCallbackInfo<Value>& args) {
   ToNamespacedPath(env, &path);
   THROW_IF_INSUFFICIENT_PERMISSIONS(
       env, permission::PermissionScope::kFileSystemWrite, path.ToStringView());
-  if (WriteSnapshot(env, *path, options).IsNothing()) return;
+  if (WriteSnapshot(env, *path, options, compress).IsNothing()) return;
   return args.GetReturnValue().Set(filename_v);
 }
 
@@ -0,0 +1,133 @@
+#include "hex_encoding.h"
+
+#include "util.h"  // CHECK(), which nbytes.h relies on.
+
+#include "nbytes.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <emmintrin.h>
+#define NODE_HEX_ENCODING_SSE2 1
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define NODE_HEX_ENCODING_NEON 1
+#endif
+
+namespace node {
+namespace hex_encoding {
+
+namespace {
+
+#if NODE_HEX_ENCODING_SSE2
+// Maps every nibble in `n` to '0'...'9' or 'a'...'f'.
+inline __m128i NibblesToHex(__m128i n) {
+  const __m128i above_nine = _mm_cmpgt_epi8(n, _mm_set1_epi8(9));
+  return _mm_add_epi8(
+      _mm_add_epi8(n, _mm_set1_epi8('0')),
+      _mm_and_si128(above_nine, _mm_set1_epi8('a' - '0' - 10)));
+}
+
+// Maps every hex character in `c` to its value, and sets the matching byte
+// of `*valid` to 0xff if the character is a hex digit, or 0 otherwise.
+// Characters >= 0x80 are negative as signed bytes, so they fail both range
+// checks.
+inline __m128i HexToNibbles(__m128i c, __m128i* valid) {
+  const __m128i lower = _mm_or_si128(c, _mm_set1_epi8(0x20));
+  const __m128i is_digit = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('/')),
+                                         _mm_cmplt_epi8(c, _mm_set1_epi8(':')));
+  const __m128i is_alpha =
+      _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                    _mm_cmplt_epi8(lower, _mm_set1_epi8('g')));
+  *valid = _mm_or_si128(is_digit, is_alpha);
+  return _mm_or_si128(
+      _mm_and_si128(is_digit, _mm_sub_epi8(c, _mm_set1_epi8('0'))),
+      _mm_and_si128(is_alpha,
+                    _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10))));
+}
+
+// Combines pairs of nibbles, high nibble first, into one byte per 16-bit lane.
+inline __m128i CombineNibbles(__m128i n) {
+  const __m128i high = _mm_slli_epi16(_mm_and_si128(n, _mm_set1_epi16(0xff)),
+                                      4);
+  return _mm_or_si128(high, _mm_srli_epi16(n, 8));
+}
+#endif  // NODE_HEX_ENCODING_SSE2
+
+#if NODE_HEX_ENCODING_NEON
+inline uint8x16_t HexToNibbles(uint8x16_t c, uint8x16_t* valid) {
+  const uint8x16_t digit = vsubq_u8(c, vdupq_n_u8('0'));
+  const uint8x16_t alpha =
+      vsubq_u8(vorrq_u8(c, vdupq_n_u8(0x20)), vdupq_n_u8('a'));
+  const uint8x16_t is_digit = vcltq_u8(digit, vdupq_n_u8(10));
+  const uint8x16_t is_alpha = vcltq_u8(alpha, vdupq_n_u8(6));
+  *valid = vorrq_u8(is_digit, is_alpha);
+  return vbslq_u8(is_digit, digit, vaddq_u8(alpha, vdupq_n_u8(10)));
+}
+#endif  // NODE_HEX_ENCODING_NEON
+
+}  // anonymous namespace
+
+size_t Encode(const char* src, size_t slen, char* dst, size_t dlen) {
+  CHECK_GE(dlen / 2, slen);
+  size_t i = 0;
+#if NODE_HEX_ENCODING_SSE2
+  for (; i + 16 <= slen; i += 16) {
+    const __m128i v =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    const __m128i mask = _mm_set1_epi8(0x0f);
+    const __m128i hi = NibblesToHex(_mm_and_si128(_mm_srli_epi16(v, 4), mask));
+    const __m128i lo = NibblesToHex(_mm_and_si128(v, mask));
+    __m128i* out = reinterpret_cast<__m128i*>(dst + i * 2);
+    _mm_storeu_si128(out, _mm_unpacklo_epi8(hi, lo));
+    _mm_storeu_si128(out + 1, _mm_unpackhi_epi8(hi, lo));
+  }
+#elif NODE_HEX_ENCODING_NEON
+  const uint8x16_t table = vld1q_u8(
+      reinterpret_cast<const uint8_t*>("0123456789abcdef"));
+  for (; i + 16 <= slen; i += 16) {
+    const uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(src + i));
+    uint8x16x2_t out;
+    out.val[0] = vqtbl1q_u8(table, vshrq_n_u8(v, 4));
+    out.val[1] = vqtbl1q_u8(table, vandq_u8(v, vdupq_n_u8(0x0f)));
+    vst2q_u8(reinterpret_cast<uint8_t*>(dst + i * 2), out);
+  }
+#endif
+  nbytes::HexEncode(src + i, slen - i, dst + i * 2, dlen - i * 2);
+  return slen * 2;
+}
+
+size_t Decode(char* dst, size_t dlen, const char* src, size_t slen) {
+  size_t i = 0;
+#if NODE_HEX_ENCODING_SSE2
+  for (; i + 16 <= dlen && i * 2 + 32 <= slen; i += 16) {
+    const __m128i* in = reinterpret_cast<const __m128i*>(src + i * 2);
+    __m128i valid_a, valid_b;
+    const __m128i a = HexToNibbles(_mm_loadu_si128(in), &valid_a);
+    const __m128i b = HexToNibbles(_mm_loadu_si128(in + 1), &valid_b);
+    // Leave the block to the scalar loop, which finds the invalid pair.
+    if (_mm_movemask_epi8(_mm_and_si128(valid_a, valid_b)) != 0xffff) break;
+    _mm_storeu_si128(
+        reinterpret_cast<__m128i*>(dst + i),
+        _mm_packus_epi16(CombineNibbles(a), CombineNibbles(b)));
+  }
+#elif NODE_HEX_ENCODING_NEON
+  for (; i + 16 <= dlen && i * 2 + 32 <= slen; i += 16) {
+    const uint8x16x2_t in =
+        vld2q_u8(reinterpret_cast<const uint8_t*>(src + i * 2));
+    uint8x16_t valid_hi, valid_lo;
+    const uint8x16_t hi = HexToNibbles(in.val[0], &valid_hi);
+    const uint8x16_t lo = HexToNibbles(in.val[1], &valid_lo);
+    // Leave the block to the scalar loop, which finds the invalid pair.
+    if (vminvq_u8(vandq_u8(valid_hi, valid_lo)) != 0xff) break;
+    vst1q_u8(reinterpret_cast<uint8_t*>(dst + i),
+             vorrq_u8(vshlq_n_u8(hi, 4), lo));
+  }
+#endif
+  return i + nbytes::HexDecode(dst + i, dlen - i, src + i * 2, slen - i * 2);
+}
+
+size_t Decode(char* dst, size_t dlen, const uint16_t* src, size_t slen) {
+  return nbytes::HexDecode(dst, dlen, src, slen);
+}
+
+}  // namespace hex_encoding
+}  // namespace node
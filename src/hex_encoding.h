@@ -0,0 +1,31 @@
+#ifndef SRC_HEX_ENCODING_H_
+#define SRC_HEX_ENCODING_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include <cstddef>
+#include <cstdint>
+
+namespace node {
+namespace hex_encoding {
+
+// Drop-in replacements for nbytes::HexEncode() and nbytes::HexDecode() that
+// process 16 bytes at a time on SSE2 (x86-64) and NEON (arm64), and fall
+// back to nbytes for the tail and on other architectures.
+
+// Writes the lowercase hex representation of `src` into `dst`, which must
+// have room for at least `slen * 2` characters. Returns `slen * 2`.
+size_t Encode(const char* src, size_t slen, char* dst, size_t dlen);
+
+// Decodes at most `dlen` bytes from the hex characters in `src`. Like
+// nbytes::HexDecode(), stops at the first invalid pair of characters and
+// ignores a trailing odd character. Returns the number of bytes written.
+size_t Decode(char* dst, size_t dlen, const char* src, size_t slen);
+size_t Decode(char* dst, size_t dlen, const uint16_t* src, size_t slen);
+
+}  // namespace hex_encoding
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_HEX_ENCODING_H_
@@ -18,7 +18,18 @@ void Histogram::Reset() {
 }
 
 double Histogram::Add(const Histogram& other) {
-  Mutex::ScopedLock lock(mutex_);
+  if (&other == this) {
+    Mutex::ScopedLock lock(mutex_);
+    count_ += count_;
+    exceeds_ += exceeds_;
+    return static_cast<double>(hdr_add(histogram_.get(), histogram_.get()));
+  }
+  // Lock in the order of the addresses, so that adding two histograms to
+  // each other on different threads does not deadlock.
+  const Histogram* first = this < &other ? this : &other;
+  const Histogram* second = this < &other ? &other : this;
+  Mutex::ScopedLock first_lock(first->mutex_);
+  Mutex::ScopedLock second_lock(second->mutex_);
   count_ += other.count_;
   exceeds_ += other.exceeds_;
   if (other.prev_ > prev_)
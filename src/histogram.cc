@@ -35,6 +35,25 @@ Histogram::Histogram(const Options& options) {
   histogram_.reset(histogram);
 }
 
+std::unique_ptr<Histogram> Histogram::SnapshotAndReset() {
+  Options options;
+  {
+    Mutex::ScopedLock lock(mutex_);
+    options.lowest = histogram_->lowest_discernible_value;
+    options.highest = histogram_->highest_trackable_value;
+    options.figures = histogram_->significant_figures;
+  }
+  // hdr_init() allocates the counts, do that without holding the lock.
+  std::unique_ptr<Histogram> snapshot = std::make_unique<Histogram>(options);
+  Mutex::ScopedLock lock(mutex_);
+  std::swap(histogram_, snapshot->histogram_);
+  std::swap(count_, snapshot->count_);
+  std::swap(exceeds_, snapshot->exceeds_);
+  // Keep measuring the delay since the last RecordDelta().
+  snapshot->prev_ = prev_;
+  return snapshot;
+}
+
 void Histogram::MemoryInfo(MemoryTracker* tracker) const {
   tracker->TrackFieldWithSize("histogram", GetMemorySize());
 }
@@ -218,6 +237,17 @@ void HistogramBase::Add(const FunctionCallbackInfo<Value>& args) {
   args.GetReturnValue().Set(count);
 }
 
+// snapshotAndReset() returns a new histogram with the values recorded so
+// far and resets this one.
+void HistogramBase::SnapshotAndReset(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  HistogramBase* histogram;
+  ASSIGN_OR_RETURN_UNWRAP(&histogram, args.This());
+  std::shared_ptr<Histogram> snapshot = (*histogram)->SnapshotAndReset();
+  BaseObjectPtr<HistogramBase> result = Create(env, std::move(snapshot));
+  if (result) args.GetReturnValue().Set(result->object());
+}
+
 BaseObjectPtr<HistogramBase> HistogramBase::Create(
     Environment* env,
     const Histogram::Options& options) {
@@ -290,6 +320,7 @@ Local<FunctionTemplate> HistogramBase::GetConstructorTemplate(
     SetFastMethod(
         isolate, instance, "recordDelta", RecordDelta, &fast_record_delta_);
     SetProtoMethod(isolate, tmpl, "add", Add);
+    SetProtoMethod(isolate, tmpl, "snapshotAndReset", SnapshotAndReset);
     HistogramImpl::AddMethods(isolate, tmpl);
     isolate_data->set_histogram_ctor_template(tmpl);
   }
@@ -300,6 +331,7 @@ void HistogramBase::RegisterExternalReferences(
     ExternalReferenceRegistry* registry) {
   registry->Register(New);
   registry->Register(Add);
+  registry->Register(SnapshotAndReset);
   registry->Register(Record);
   registry->Register(RecordDelta);
   registry->Register(fast_record_.GetTypeInfo());
@@ -14,6 +14,7 @@
 #include <functional>
 #include <limits>
 #include <map>
+#include <memory>
 #include <string>
 
 namespace node {
@@ -47,6 +48,13 @@ class Histogram : public MemoryRetainer {
 
   inline double Add(const Histogram& other);
 
+  // Moves the recorded values into a new Histogram and resets this one.
+  // The lock is only held to swap the underlying histograms, so that a
+  // thread can publish snapshots of a histogram that other threads keep
+  // recording into without delaying them for the time needed to compute
+  // the percentiles, or to merge the snapshots of several histograms.
+  std::unique_ptr<Histogram> SnapshotAndReset();
+
   // Iterator is a function type that takes two doubles as argument, one for
   // percentile and one for the value at that percentile.
   template <typename Iterator>
@@ -164,6 +172,8 @@ class HistogramBase final : public BaseObject, public HistogramImpl {
   static void Record(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void RecordDelta(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Add(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SnapshotAndReset(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
 
   static void FastRecord(
       v8::Local<v8::Value> unused,
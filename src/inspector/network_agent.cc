@@ -201,7 +201,17 @@ void NetworkAgent::Wire(protocol::UberDispatcher* dispatcher) {
   protocol::Network::Dispatcher::wire(dispatcher, this);
 }
 
-protocol::DispatchResponse NetworkAgent::enable() {
+protocol::DispatchResponse NetworkAgent::enable(
+    std::optional<double> in_samplingRate,
+    std::optional<protocol::String> in_urlFilter) {
+  double sampling_rate = in_samplingRate.value_or(1);
+  if (!(sampling_rate >= 0 && sampling_rate <= 1)) {
+    return protocol::DispatchResponse::InvalidParams(
+        "samplingRate must be between 0 and 1");
+  }
+  sampling_rate_ = sampling_rate;
+  url_filter_ = in_urlFilter.value_or("");
+  ForgetTrackedRequests();
   inspector_->Enable();
   return protocol::DispatchResponse::Success();
 }
@@ -211,6 +221,28 @@ protocol::DispatchResponse NetworkAgent::disable() {
   return protocol::DispatchResponse::Success();
 }
 
+void NetworkAgent::ForgetTrackedRequests() {
+  tracked_requests_.clear();
+  tracked_order_.clear();
+}
+
+bool NetworkAgent::ShouldTrackRequest(const protocol::String& request_id,
+                                      const protocol::String& url) const {
+  if (!url_filter_.empty() && url.find(url_filter_) == protocol::String::npos)
+    return false;
+  if (sampling_rate_ >= 1) return true;
+  // Choose by the identifier rather than at random, so that the same
+  // requests are chosen in every session.
+  constexpr size_t kBuckets = 1 << 16;
+  size_t bucket = std::hash<protocol::String>{}(request_id) % kBuckets;
+  return bucket < sampling_rate_ * kBuckets;
+}
+
+bool NetworkAgent::IsTrackedRequest(const protocol::String& request_id) const {
+  if (sampling_rate_ >= 1 && url_filter_.empty()) return true;
+  return tracked_requests_.contains(request_id);
+}
+
 void NetworkAgent::requestWillBeSent(v8::Local<v8::Context> context,
                                      v8::Local<v8::Object> params) {
   protocol::String request_id;
@@ -229,6 +261,19 @@ void NetworkAgent::requestWillBeSent(v8::Local<v8::Context> context,
   if (!ObjectGetObject(context, params, "request").ToLocal(&request_obj)) {
     return;
   }
+  if (sampling_rate_ < 1 || !url_filter_.empty()) {
+    protocol::String url;
+    if (!ObjectGetProtocolString(context, request_obj, "url").To(&url) ||
+        !ShouldTrackRequest(request_id, url)) {
+      return;
+    }
+    tracked_requests_.insert(request_id);
+    tracked_order_.push_back(request_id);
+    if (tracked_order_.size() > kMaxTrackedRequests) {
+      tracked_requests_.erase(tracked_order_.front());
+      tracked_order_.pop_front();
+    }
+  }
   std::unique_ptr<protocol::Network::Request> request =
       createRequestFromObject(context, request_obj);
   if (!request) {
@@ -255,6 +300,7 @@ void NetworkAgent::responseReceived(v8::Local<v8::Context> context,
   if (!ObjectGetProtocolString(context, params, "requestId").To(&request_id)) {
     return;
   }
+  if (!IsTrackedRequest(request_id)) return;
   double timestamp;
   if (!ObjectGetDouble(context, params, "timestamp").To(&timestamp)) {
     return;
@@ -281,6 +327,8 @@ void NetworkAgent::loadingFailed(v8::Local<v8::Context> context,
   if (!ObjectGetProtocolString(context, params, "requestId").To(&request_id)) {
     return;
   }
+  if (!IsTrackedRequest(request_id)) return;
+  tracked_requests_.erase(request_id);
   double timestamp;
   if (!ObjectGetDouble(context, params, "timestamp").To(&timestamp)) {
     return;
@@ -303,6 +351,8 @@ void NetworkAgent::loadingFinished(v8::Local<v8::Context> context,
   if (!ObjectGetProtocolString(context, params, "requestId").To(&request_id)) {
     return;
   }
+  if (!IsTrackedRequest(request_id)) return;
+  tracked_requests_.erase(request_id);
   double timestamp;
   if (!ObjectGetDouble(context, params, "timestamp").To(&timestamp)) {
     return;
@@ -3,7 +3,10 @@
 
 #include "node/inspector/protocol/Network.h"
 
+#include <deque>
+#include <optional>
 #include <unordered_map>
+#include <unordered_set>
 
 namespace node {
 namespace inspector {
@@ -17,7 +20,9 @@ class NetworkAgent : public protocol::Network::Backend {
 
   void Wire(protocol::UberDispatcher* dispatcher);
 
-  protocol::DispatchResponse enable() override;
+  protocol::DispatchResponse enable(
+      std::optional<double> in_samplingRate,
+      std::optional<protocol::String> in_urlFilter) override;
 
   protocol::DispatchResponse disable() override;
 
@@ -37,13 +42,35 @@ class NetworkAgent : public protocol::Network::Backend {
   void loadingFinished(v8::Local<v8::Context> context,
                        v8::Local<v8::Object> params);
 
+  // Called when network tracking is disabled or the session goes away.
+  void ForgetTrackedRequests();
+
  private:
+  // Requests whose events stop without loadingFinished or loadingFailed,
+  // e.g. because their socket was destroyed, are forgotten once this many
+  // newer requests have been tracked.
+  static constexpr size_t kMaxTrackedRequests = 10000;
+
+  // Whether the events of a request that is about to be sent are delivered.
+  bool ShouldTrackRequest(const protocol::String& request_id,
+                          const protocol::String& url) const;
+  // Whether the events that follow requestWillBeSent are delivered.
+  bool IsTrackedRequest(const protocol::String& request_id) const;
+
   NetworkInspector* inspector_;
   v8_inspector::V8Inspector* v8_inspector_;
   std::shared_ptr<protocol::Network::Frontend> frontend_;
   using EventNotifier = void (NetworkAgent::*)(v8::Local<v8::Context> context,
                                                v8::Local<v8::Object>);
   std::unordered_map<protocol::String, EventNotifier> event_notifier_map_;
+  // Requests that are not sampled are dropped before their stack trace and
+  // headers are collected, which is where the cost of the events is.
+  double sampling_rate_ = 1;
+  protocol::String url_filter_;
+  // With sampling or a filter, the requests whose events are delivered,
+  // until they have finished or failed, and the order they were sent in.
+  std::unordered_set<protocol::String> tracked_requests_;
+  std::deque<protocol::String> tracked_order_;
 };
 
 }  // namespace inspector
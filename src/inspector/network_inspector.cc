@@ -42,6 +42,7 @@ void NetworkInspector::Disable() {
   if (auto agent = env_->inspector_agent()) {
     agent->DisableNetworkTracking();
   }
+  network_agent_->ForgetTrackedRequests();
   enabled_ = false;
 }
 
@@ -848,9 +848,24 @@ bool Agent::Start(const std::string& path,
     }
   }, parent_env_);
 
-  if (!parent_handle_ &&
-      (!options.inspector_enabled || !options.allow_attaching_debugger ||
-       !StartIoThread())) {
+  if (parent_handle_) {
+    // Sessions of Workers are usually relayed by the main thread, which
+    // keeps routing messages while the Worker is busy. With their own
+    // server, the messages go from the I/O thread to the Worker's thread
+    // directly. The parent's port is taken, so let the system pick one.
+    // Like the main thread's server, this needs --inspect or similar.
+    if (options.worker_inspector_io && options.inspector_enabled &&
+        options.allow_attaching_debugger) {
+      {
+        ExclusiveAccess<HostPort>::Scoped host_port(host_port_);
+        host_port->set_port(0);
+      }
+      StartIoThread();
+    }
+    return true;
+  }
+  if (!options.inspector_enabled || !options.allow_attaching_debugger ||
+      !StartIoThread()) {
     return false;
   }
   return true;
@@ -9,10 +9,16 @@
 #include "node_internals.h"
 #include "util-inl.h"
 #include "v8-inspector.h"
+#include "v8-profiler.h"
+#include "zlib.h"
 
 #include <cinttypes>
 #include <limits>
+#include <memory>
 #include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include "simdutf.h"
 
 namespace node {
@@ -465,6 +471,459 @@ static void EndStartedProfilers(Environment* env) {
   }
 }
 
+namespace {
+
+// Just enough of a protobuf encoder to produce pprof profiles
+// (https://github.com/google/pprof/blob/main/proto/profile.proto).
+class ProtoWriter {
+ public:
+  void Varint(uint64_t value) {
+    while (value >= 0x80) {
+      data_.push_back(static_cast<char>(value | 0x80));
+      value >>= 7;
+    }
+    data_.push_back(static_cast<char>(value));
+  }
+
+  // Zero is the default value of proto3 scalar fields and can be omitted.
+  void Int(int field, uint64_t value) {
+    if (value == 0) return;
+    Varint(static_cast<uint64_t>(field) << 3);
+    Varint(value);
+  }
+
+  void Bytes(int field, std::string_view bytes) {
+    Varint((static_cast<uint64_t>(field) << 3) | 2);
+    Varint(bytes.size());
+    data_.append(bytes);
+  }
+
+  void Message(int field, const ProtoWriter& message) {
+    Bytes(field, message.data_);
+  }
+
+  void Packed(int field, const std::vector<uint64_t>& values) {
+    ProtoWriter packed;
+    for (uint64_t value : values) packed.Varint(value);
+    Message(field, packed);
+  }
+
+  const std::string& data() const { return data_; }
+
+ private:
+  std::string data_;
+};
+
+// Collects the functions, locations and samples of a pprof Profile message.
+// Locations are deduplicated by function and line, so call paths that pass
+// through the same code share their entries.
+class PprofBuilder {
+ public:
+  PprofBuilder() { Intern(""); }
+
+  void AddSampleType(std::string_view type, std::string_view unit) {
+    sample_types_.emplace_back(ValueType(Intern(type), Intern(unit)));
+  }
+
+  uint64_t AddLocation(std::string name, std::string_view file, int line) {
+    if (name.empty()) name = "(anonymous)";
+    if (line < 0) line = 0;
+    uint64_t function_id = FunctionId(name, file, line);
+    std::string key = std::to_string(function_id) + ':' + std::to_string(line);
+    auto it = location_ids_.find(key);
+    if (it != location_ids_.end()) return it->second;
+
+    uint64_t id = locations_.size() + 1;
+    ProtoWriter line_message;
+    line_message.Int(1, function_id);
+    line_message.Int(2, line);
+    ProtoWriter location;
+    location.Int(1, id);
+    location.Message(4, line_message);
+    locations_.emplace_back(std::move(location));
+    location_ids_.emplace(std::move(key), id);
+    return id;
+  }
+
+  // `stack` lists location ids from the root to the leaf.
+  void AddSample(const std::vector<uint64_t>& stack,
+                 const std::vector<uint64_t>& values) {
+    // pprof expects the leaf first.
+    std::vector<uint64_t> ids(stack.rbegin(), stack.rend());
+    ProtoWriter sample;
+    sample.Packed(1, ids);
+    sample.Packed(2, values);
+    samples_.emplace_back(std::move(sample));
+  }
+
+  std::string Build(std::string_view period_type,
+                    std::string_view period_unit,
+                    uint64_t period,
+                    uint64_t time_ns,
+                    uint64_t duration_ns) {
+    ProtoWriter period_value_type =
+        ValueType(Intern(period_type), Intern(period_unit));
+    ProtoWriter out;
+    for (const ProtoWriter& type : sample_types_) out.Message(1, type);
+    for (const ProtoWriter& sample : samples_) out.Message(2, sample);
+    for (const ProtoWriter& location : locations_) out.Message(4, location);
+    for (const ProtoWriter& function : functions_) out.Message(5, function);
+    for (const std::string& str : strings_) out.Bytes(6, str);
+    out.Int(9, time_ns);
+    out.Int(10, duration_ns);
+    out.Message(11, period_value_type);
+    out.Int(12, period);
+    return out.data();
+  }
+
+ private:
+  static ProtoWriter ValueType(uint64_t type, uint64_t unit) {
+    ProtoWriter value_type;
+    value_type.Int(1, type);
+    value_type.Int(2, unit);
+    return value_type;
+  }
+
+  uint64_t Intern(std::string_view str) {
+    auto it = string_ids_.find(std::string(str));
+    if (it != string_ids_.end()) return it->second;
+    uint64_t id = strings_.size();
+    strings_.emplace_back(str);
+    string_ids_.emplace(strings_.back(), id);
+    return id;
+  }
+
+  uint64_t FunctionId(const std::string& name, std::string_view file,
+                      int line) {
+    std::string key = name + '\0' + std::string(file) + '\0' +
+                      std::to_string(line);
+    auto it = function_ids_.find(key);
+    if (it != function_ids_.end()) return it->second;
+
+    uint64_t id = functions_.size() + 1;
+    ProtoWriter function;
+    function.Int(1, id);
+    uint64_t name_id = Intern(name);
+    function.Int(2, name_id);
+    function.Int(3, name_id);
+    function.Int(4, Intern(file));
+    function.Int(5, line);
+    functions_.emplace_back(std::move(function));
+    function_ids_.emplace(std::move(key), id);
+    return id;
+  }
+
+  std::vector<std::string> strings_;
+  std::unordered_map<std::string, uint64_t> string_ids_;
+  std::unordered_map<std::string, uint64_t> function_ids_;
+  std::unordered_map<std::string, uint64_t> location_ids_;
+  std::vector<ProtoWriter> sample_types_;
+  std::vector<ProtoWriter> samples_;
+  std::vector<ProtoWriter> locations_;
+  std::vector<ProtoWriter> functions_;
+};
+
+// Every node of a v8::CpuProfile call tree with self samples becomes a
+// Sample whose stack is the path from the root to that node.
+void VisitCpuProfileNode(const v8::CpuProfileNode* node,
+                         uint64_t period_ns,
+                         PprofBuilder* builder,
+                         std::vector<uint64_t>* stack) {
+  stack->push_back(builder->AddLocation(node->GetFunctionNameStr(),
+                                        node->GetScriptResourceNameStr(),
+                                        node->GetLineNumber()));
+  if (unsigned hits = node->GetHitCount())
+    builder->AddSample(*stack, {hits, hits * period_ns});
+  for (int i = 0; i < node->GetChildrenCount(); i++)
+    VisitCpuProfileNode(node->GetChild(i), period_ns, builder, stack);
+  stack->pop_back();
+}
+
+std::string CpuProfileToPprof(const v8::CpuProfile* profile,
+                              uint64_t period_ns,
+                              uint64_t wall_start_ns) {
+  PprofBuilder builder;
+  builder.AddSampleType("samples", "count");
+  builder.AddSampleType("cpu", "nanoseconds");
+  std::vector<uint64_t> stack;
+  const v8::CpuProfileNode* root = profile->GetTopDownRoot();
+  for (int i = 0; i < root->GetChildrenCount(); i++)
+    VisitCpuProfileNode(root->GetChild(i), period_ns, &builder, &stack);
+  return builder.Build(
+      "cpu", "nanoseconds", period_ns, wall_start_ns,
+      static_cast<uint64_t>(profile->GetEndTime() - profile->GetStartTime()) *
+          1000);
+}
+
+// The allocations V8 attributes to a node of the sampling heap profile are
+// aggregated into one Sample per allocation site, i.e. per call path. V8
+// already scales the sampled counts to estimate the real ones.
+void VisitAllocationNode(Isolate* isolate,
+                         const v8::AllocationProfile::Node* node,
+                         PprofBuilder* builder,
+                         std::vector<uint64_t>* stack) {
+  Utf8Value name(isolate, node->name);
+  Utf8Value script_name(isolate, node->script_name);
+  stack->push_back(builder->AddLocation(
+      name.ToString(), script_name.ToStringView(), node->line_number));
+  uint64_t count = 0;
+  uint64_t bytes = 0;
+  for (const v8::AllocationProfile::Allocation& allocation :
+       node->allocations) {
+    count += allocation.count;
+    bytes += static_cast<uint64_t>(allocation.size) * allocation.count;
+  }
+  if (count != 0) builder->AddSample(*stack, {count, bytes});
+  for (const v8::AllocationProfile::Node* child : node->children)
+    VisitAllocationNode(isolate, child, builder, stack);
+  stack->pop_back();
+}
+
+std::string AllocationProfileToPprof(Isolate* isolate,
+                                     v8::AllocationProfile* profile,
+                                     uint64_t interval_bytes,
+                                     uint64_t time_ns,
+                                     uint64_t duration_ns) {
+  PprofBuilder builder;
+  builder.AddSampleType("inuse_objects", "count");
+  builder.AddSampleType("inuse_space", "bytes");
+  std::vector<uint64_t> stack;
+  const v8::AllocationProfile::Node* root = profile->GetRootNode();
+  for (const v8::AllocationProfile::Node* child : root->children)
+    VisitAllocationNode(isolate, child, &builder, &stack);
+  return builder.Build(
+      "space", "bytes", interval_bytes, time_ns, duration_ns);
+}
+
+uint64_t WallTimeNs() {
+  uv_timeval64_t now;
+  CHECK_EQ(uv_gettimeofday(&now), 0);
+  return static_cast<uint64_t>(now.tv_sec) * 1000000000 + now.tv_usec * 1000;
+}
+
+bool Gzip(std::string_view input, std::string* output) {
+  z_stream stream = {};
+  if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8,
+                   Z_DEFAULT_STRATEGY) != Z_OK) {
+    return false;
+  }
+  output->resize(deflateBound(&stream, input.size()));
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+  stream.avail_in = input.size();
+  stream.next_out = reinterpret_cast<Bytef*>(output->data());
+  stream.avail_out = output->size();
+  int ret = deflate(&stream, Z_FINISH);
+  output->resize(stream.total_out);
+  deflateEnd(&stream);
+  return ret == Z_STREAM_END;
+}
+
+// Implements --cpu-prof-continuous. Unlike --cpu-prof, this talks to the
+// v8::CpuProfiler directly instead of going through an inspector session,
+// and writes one gzipped pprof file per window. The next window's profile is
+// started before the previous one is stopped so that no samples are lost.
+class ContinuousCpuProfiler {
+ public:
+  static void Start(Environment* env,
+                    std::string directory,
+                    uint64_t interval_us,
+                    uint64_t window_ms) {
+    new ContinuousCpuProfiler(env, std::move(directory), interval_us,
+                              window_ms);
+  }
+
+ private:
+  ContinuousCpuProfiler(Environment* env,
+                        std::string directory,
+                        uint64_t interval_us,
+                        uint64_t window_ms)
+      : env_(env),
+        directory_(std::move(directory)),
+        interval_us_(static_cast<int>(std::min<uint64_t>(
+            interval_us, std::numeric_limits<int>::max()))),
+        profiler_(v8::CpuProfiler::New(env->isolate())) {
+    profiler_->SetSamplingInterval(interval_us_);
+    BeginWindow();
+    CHECK_EQ(uv_timer_init(env->event_loop(), &timer_), 0);
+    uv_timer_start(&timer_, OnTimer, window_ms, window_ms);
+    uv_unref(reinterpret_cast<uv_handle_t*>(&timer_));
+    // The cleanup hook writes the last profile and deletes this. An AtExit
+    // callback would only run after that.
+    env->AddCleanupHook(Cleanup, this);
+  }
+
+  ~ContinuousCpuProfiler() { profiler_->Dispose(); }
+
+  void BeginWindow() {
+    v8::CpuProfilingResult result = profiler_->Start(v8::CpuProfilingOptions(
+        v8::kLeafNodeLineNumbers, v8::CpuProfilingOptions::kNoSampleLimit,
+        interval_us_));
+    current_ = result.status == v8::CpuProfilingStatus::kErrorTooManyProfilers
+                   ? 0
+                   : result.id;
+    current_start_ns_ = WallTimeNs();
+  }
+
+  void EndWindow(bool restart) {
+    v8::ProfilerId id = current_;
+    uint64_t start_ns = current_start_ns_;
+    if (restart) BeginWindow();
+    if (id == 0) return;
+    v8::CpuProfile* profile = profiler_->Stop(id);
+    if (profile == nullptr) return;
+    Write(profile, start_ns);
+    profile->Delete();
+  }
+
+  void Write(const v8::CpuProfile* profile, uint64_t start_ns) {
+    std::string compressed;
+    if (!Gzip(CpuProfileToPprof(profile,
+                                static_cast<uint64_t>(interval_us_) * 1000,
+                                start_ns),
+              &compressed)) {
+      fprintf(stderr, "Failed to compress CPU profile\n");
+      return;
+    }
+    if (!EnsureDirectory(directory_, "CPU")) return;
+    std::string path = directory_ + kPathSeparator +
+                       SPrintF("CPU.%s.%s.%s.pb.gz",
+                               uv_os_getpid(),
+                               env_->thread_id(),
+                               ++sequence_);
+    WriteResult(env_, path.c_str(), compressed);
+  }
+
+  void Stop() {
+    if (stopped_) return;
+    stopped_ = true;
+    uv_timer_stop(&timer_);
+    HandleScope handle_scope(env_->isolate());
+    EndWindow(false);
+  }
+
+  static void OnTimer(uv_timer_t* handle) {
+    ContinuousCpuProfiler* profiler =
+        ContainerOf(&ContinuousCpuProfiler::timer_, handle);
+    HandleScope handle_scope(profiler->env_->isolate());
+    profiler->EndWindow(true);
+  }
+
+  static void Cleanup(void* data) {
+    ContinuousCpuProfiler* profiler = static_cast<ContinuousCpuProfiler*>(data);
+    profiler->Stop();
+    profiler->env_->CloseHandle(&profiler->timer_, [](uv_timer_t* handle) {
+      ContinuousCpuProfiler* profiler =
+          ContainerOf(&ContinuousCpuProfiler::timer_, handle);
+      delete profiler;
+    });
+  }
+
+  Environment* env_;
+  std::string directory_;
+  int interval_us_;
+  v8::CpuProfiler* profiler_;
+  v8::ProfilerId current_ = 0;
+  uint64_t current_start_ns_ = 0;
+  uint64_t sequence_ = 0;
+  uv_timer_t timer_;
+  bool stopped_ = false;
+};
+
+// Implements --heap-prof-continuous. Drives the sampling heap profiler of
+// the v8::HeapProfiler directly, without an inspector session, and writes a
+// gzipped pprof profile of the sampled allocations that are still alive once
+// per window and once more at exit.
+class ContinuousHeapProfiler {
+ public:
+  static void Start(Environment* env,
+                    std::string directory,
+                    uint64_t interval_bytes,
+                    uint64_t window_ms) {
+    new ContinuousHeapProfiler(env, std::move(directory), interval_bytes,
+                               window_ms);
+  }
+
+ private:
+  ContinuousHeapProfiler(Environment* env,
+                         std::string directory,
+                         uint64_t interval_bytes,
+                         uint64_t window_ms)
+      : env_(env),
+        directory_(std::move(directory)),
+        interval_bytes_(interval_bytes),
+        start_ns_(WallTimeNs()) {
+    started_ = env->isolate()->GetHeapProfiler()->StartSamplingHeapProfiler(
+        interval_bytes_);
+    CHECK_EQ(uv_timer_init(env->event_loop(), &timer_), 0);
+    uv_timer_start(&timer_, OnTimer, window_ms, window_ms);
+    uv_unref(reinterpret_cast<uv_handle_t*>(&timer_));
+    // The cleanup hook writes the last profile and deletes this. An AtExit
+    // callback would only run after that.
+    env->AddCleanupHook(Cleanup, this);
+  }
+
+  void Write() {
+    if (!started_) return;
+    Isolate* isolate = env_->isolate();
+    HandleScope handle_scope(isolate);
+    std::unique_ptr<v8::AllocationProfile> profile(
+        isolate->GetHeapProfiler()->GetAllocationProfile());
+    if (!profile) return;
+    uint64_t now_ns = WallTimeNs();
+    std::string compressed;
+    if (!Gzip(AllocationProfileToPprof(isolate, profile.get(), interval_bytes_,
+                                       now_ns, now_ns - start_ns_),
+              &compressed)) {
+      fprintf(stderr, "Failed to compress heap profile\n");
+      return;
+    }
+    if (!EnsureDirectory(directory_, "heap")) return;
+    std::string path = directory_ + kPathSeparator +
+                       SPrintF("Heap.%s.%s.%s.pb.gz",
+                               uv_os_getpid(),
+                               env_->thread_id(),
+                               ++sequence_);
+    WriteResult(env_, path.c_str(), compressed);
+  }
+
+  void Stop() {
+    if (stopped_) return;
+    stopped_ = true;
+    uv_timer_stop(&timer_);
+    Write();
+    if (started_)
+      env_->isolate()->GetHeapProfiler()->StopSamplingHeapProfiler();
+  }
+
+  static void OnTimer(uv_timer_t* handle) {
+    ContinuousHeapProfiler* profiler =
+        ContainerOf(&ContinuousHeapProfiler::timer_, handle);
+    profiler->Write();
+  }
+
+  static void Cleanup(void* data) {
+    ContinuousHeapProfiler* profiler =
+        static_cast<ContinuousHeapProfiler*>(data);
+    profiler->Stop();
+    profiler->env_->CloseHandle(&profiler->timer_, [](uv_timer_t* handle) {
+      ContinuousHeapProfiler* profiler =
+          ContainerOf(&ContinuousHeapProfiler::timer_, handle);
+      delete profiler;
+    });
+  }
+
+  Environment* env_;
+  std::string directory_;
+  uint64_t interval_bytes_;
+  uint64_t start_ns_;
+  uint64_t sequence_ = 0;
+  uv_timer_t timer_;
+  bool started_ = false;
+  bool stopped_ = false;
+};
+
+}  // anonymous namespace
+
 void StartProfilers(Environment* env) {
   AtExit(env, [](void* env) {
     EndStartedProfilers(static_cast<Environment*>(env));
@@ -493,6 +952,19 @@ void StartProfilers(Environment* env) {
         std::make_unique<V8CpuProfilerConnection>(env));
     env->cpu_profiler_connection()->Start();
   }
+  if (env->options()->cpu_prof_continuous) {
+    const std::string& dir = env->options()->cpu_prof_dir;
+    uint64_t interval = env->options()->cpu_prof_interval;
+    // Sample at a lower rate than --cpu-prof unless asked otherwise, since
+    // this is meant to stay enabled in production.
+    if (interval == EnvironmentOptions::kDefaultCpuProfInterval)
+      interval = 10 * EnvironmentOptions::kDefaultCpuProfInterval;
+    ContinuousCpuProfiler::Start(
+        env,
+        dir.empty() ? Environment::GetCwd(env->exec_path()) : dir,
+        interval,
+        env->options()->cpu_prof_window);
+  }
   if (env->options()->heap_prof) {
     const std::string& dir = env->options()->heap_prof_dir;
     env->set_heap_prof_interval(env->options()->heap_prof_interval);
@@ -508,6 +980,14 @@ void StartProfilers(Environment* env) {
         std::make_unique<profiler::V8HeapProfilerConnection>(env));
     env->heap_profiler_connection()->Start();
   }
+  if (env->options()->heap_prof_continuous) {
+    const std::string& dir = env->options()->heap_prof_dir;
+    ContinuousHeapProfiler::Start(
+        env,
+        dir.empty() ? Environment::GetCwd(env->exec_path()) : dir,
+        env->options()->heap_prof_interval,
+        env->options()->heap_prof_window);
+  }
 }
 
 static void SetCoverageDirectory(const FunctionCallbackInfo<Value>& args) {
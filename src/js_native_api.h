@@ -536,6 +536,36 @@ node_api_post_finalizer(node_api_basic_env env,
                         void* finalize_data,
                         void* finalize_hint);
 
+#define NODE_API_EXPERIMENTAL_HAS_EXTERNAL_STRING_UTF8
+
+// Like node_api_create_external_string_latin1, for UTF-8 input. Only ASCII
+// input can be referenced without copying it; otherwise the string is copied,
+// `finalize_callback` is called right away and `*copied` is set to true.
+NAPI_EXTERN napi_status NAPI_CDECL
+node_api_create_external_string_utf8(napi_env env,
+                                     char* str,
+                                     size_t length,
+                                     node_api_basic_finalize finalize_callback,
+                                     void* finalize_hint,
+                                     napi_value* result,
+                                     bool* copied);
+
+#define NODE_API_EXPERIMENTAL_HAS_FAST_FUNCTION
+
+// Like napi_create_function, but also registers `signature` as a V8 fast API
+// call. Optimized code calls `signature->function` directly, without creating
+// a napi_callback_info; `cb` is used whenever V8 cannot take the fast path.
+// The fast function must not call into JavaScript, allocate JavaScript values
+// or throw.
+NAPI_EXTERN napi_status NAPI_CDECL
+node_api_create_fast_function(napi_env env,
+                              const char* utf8name,
+                              size_t length,
+                              napi_callback cb,
+                              const node_api_fast_signature* signature,
+                              void* data,
+                              napi_value* result);
+
 #endif  // NAPI_EXPERIMENTAL
 
 #if NAPI_VERSION >= 6
@@ -208,4 +208,29 @@ typedef struct {
 } napi_type_tag;
 #endif  // NAPI_VERSION >= 8
 
+#ifdef NAPI_EXPERIMENTAL
+typedef enum {
+  node_api_fast_void,
+  node_api_fast_bool,
+  node_api_fast_int32,
+  node_api_fast_uint32,
+  node_api_fast_int64,
+  node_api_fast_uint64,
+  node_api_fast_float32,
+  node_api_fast_float64,
+  // A napi_value that is only valid for the duration of the call. This is
+  // also how TypedArrays are passed.
+  node_api_fast_value
+} node_api_fast_type;
+
+typedef struct {
+  // Address of the C function. Its first parameter is the receiver as a
+  // napi_value, followed by one parameter for each entry in `arg_types`.
+  const void* function;
+  node_api_fast_type return_type;
+  size_t arg_count;
+  const node_api_fast_type* arg_types;
+} node_api_fast_signature;
+#endif  // NAPI_EXPERIMENTAL
+
 #endif  // SRC_JS_NATIVE_API_TYPES_H_
@@ -5,6 +5,7 @@
 #include "env-inl.h"
 #include "js_native_api.h"
 #include "js_native_api_v8.h"
+#include "simdutf.h"
 #include "util-inl.h"
 
 #define CHECK_MAYBE_NOTHING(env, maybe, status)                                \
@@ -101,6 +102,37 @@ napi_status NewString(napi_env env,
   return napi_clear_last_error(env);
 }
 
+// Like NewString, but returns the string from `cache` if the same key has
+// been created before.
+template <typename StringMaker>
+napi_status NewPropertyKey(napi_env env,
+                           PropertyKeyCache* cache,
+                           const char* str,
+                           size_t length,
+                           napi_value* result,
+                           StringMaker string_maker) {
+  CHECK_NEW_STRING_ARGS(env, str, length, result);
+
+  if (length == NAPI_AUTO_LENGTH) length = strlen(str);
+  std::string_view key(str, length);
+  auto it = cache->find(key);
+  if (it != cache->end()) {
+    *result = v8impl::JsValueFromV8LocalValue(it->second.Get(env->isolate));
+    return napi_clear_last_error(env);
+  }
+
+  auto isolate = env->isolate;
+  auto str_maybe = string_maker(isolate, length);
+  CHECK_MAYBE_EMPTY(env, str_maybe, napi_generic_failure);
+  v8::Local<v8::String> string = str_maybe.ToLocalChecked();
+  if (cache->size() < napi_env__::kMaxPropertyKeys &&
+      length <= napi_env__::kMaxPropertyKeyLength) {
+    cache->emplace(key, Persistent<v8::String>(isolate, string));
+  }
+  *result = v8impl::JsValueFromV8LocalValue(string);
+  return napi_clear_last_error(env);
+}
+
 template <typename CharType, typename CreateAPI, typename StringMaker>
 napi_status NewExternalString(napi_env env,
                               CharType* str,
@@ -960,6 +992,124 @@ napi_status NAPI_CDECL napi_create_function(napi_env env,
   return GET_RETURN_STATUS(env);
 }
 
+namespace v8impl {
+
+static bool FastTypeToCType(node_api_fast_type type, v8::CTypeInfo* result) {
+  v8::CTypeInfo::Type ctype;
+  switch (type) {
+    case node_api_fast_void:
+      ctype = v8::CTypeInfo::Type::kVoid;
+      break;
+    case node_api_fast_bool:
+      ctype = v8::CTypeInfo::Type::kBool;
+      break;
+    case node_api_fast_int32:
+      ctype = v8::CTypeInfo::Type::kInt32;
+      break;
+    case node_api_fast_uint32:
+      ctype = v8::CTypeInfo::Type::kUint32;
+      break;
+    case node_api_fast_int64:
+      ctype = v8::CTypeInfo::Type::kInt64;
+      break;
+    case node_api_fast_uint64:
+      ctype = v8::CTypeInfo::Type::kUint64;
+      break;
+    case node_api_fast_float32:
+      ctype = v8::CTypeInfo::Type::kFloat32;
+      break;
+    case node_api_fast_float64:
+      ctype = v8::CTypeInfo::Type::kFloat64;
+      break;
+    case node_api_fast_value:
+      ctype = v8::CTypeInfo::Type::kV8Value;
+      break;
+    default:
+      return false;
+  }
+  *result = v8::CTypeInfo(ctype);
+  return true;
+}
+
+}  // end of namespace v8impl
+
+napi_status NAPI_CDECL
+node_api_create_fast_function(napi_env env,
+                              const char* utf8name,
+                              size_t length,
+                              napi_callback cb,
+                              const node_api_fast_signature* signature,
+                              void* callback_data,
+                              napi_value* result) {
+  NAPI_PREAMBLE(env);
+  CHECK_ARG(env, result);
+  CHECK_ARG(env, cb);
+  CHECK_ARG(env, signature);
+  CHECK_ARG(env, signature->function);
+  if (signature->arg_count > 0) {
+    CHECK_ARG(env, signature->arg_types);
+  }
+  // V8 cannot return JavaScript values from fast calls.
+  RETURN_STATUS_IF_FALSE(env,
+                         signature->return_type != node_api_fast_value,
+                         napi_invalid_arg);
+
+  auto info = std::make_unique<v8impl::FastFunctionInfo>();
+  // The receiver is always passed first.
+  info->arg_info.reserve(signature->arg_count + 1);
+  info->arg_info.emplace_back(v8::CTypeInfo::Type::kV8Value);
+  for (size_t i = 0; i < signature->arg_count; i++) {
+    v8::CTypeInfo arg(v8::CTypeInfo::Type::kVoid);
+    RETURN_STATUS_IF_FALSE(
+        env,
+        signature->arg_types[i] != node_api_fast_void &&
+            v8impl::FastTypeToCType(signature->arg_types[i], &arg),
+        napi_invalid_arg);
+    info->arg_info.push_back(arg);
+  }
+  v8::CTypeInfo return_info(v8::CTypeInfo::Type::kVoid);
+  RETURN_STATUS_IF_FALSE(
+      env,
+      v8impl::FastTypeToCType(signature->return_type, &return_info),
+      napi_invalid_arg);
+  info->type_info = std::make_unique<v8::CFunctionInfo>(
+      return_info, info->arg_info.size(), info->arg_info.data());
+  info->c_function =
+      v8::CFunction(signature->function, info->type_info.get());
+
+  v8::EscapableHandleScope scope(env->isolate);
+  v8::Local<v8::Value> cbdata =
+      v8impl::CallbackBundle::New(env, cb, callback_data);
+  RETURN_STATUS_IF_FALSE(env, !cbdata.IsEmpty(), napi_generic_failure);
+
+  v8::Local<v8::FunctionTemplate> tpl =
+      v8::FunctionTemplate::New(env->isolate,
+                                v8impl::FunctionCallbackWrapper::Invoke,
+                                cbdata,
+                                v8::Local<v8::Signature>(),
+                                static_cast<int>(signature->arg_count),
+                                v8::ConstructorBehavior::kThrow,
+                                v8::SideEffectType::kHasSideEffect,
+                                &info->c_function);
+  v8::MaybeLocal<v8::Function> maybe_function =
+      tpl->GetFunction(env->context());
+  CHECK_MAYBE_EMPTY(env, maybe_function, napi_generic_failure);
+  env->fast_functions.push_back(std::move(info));
+
+  v8::Local<v8::Function> return_value =
+      scope.Escape(maybe_function.ToLocalChecked());
+
+  if (utf8name != nullptr) {
+    v8::Local<v8::String> name_string;
+    CHECK_NEW_FROM_UTF8_LEN(env, name_string, utf8name, length);
+    return_value->SetName(name_string);
+  }
+
+  *result = v8impl::JsValueFromV8LocalValue(return_value);
+
+  return GET_RETURN_STATUS(env);
+}
+
 napi_status NAPI_CDECL
 napi_define_class(napi_env env,
                   const char* utf8name,
@@ -1629,6 +1779,14 @@ napi_status NAPI_CDECL napi_create_string_utf8(napi_env env,
                                                size_t length,
                                                napi_value* result) {
   return v8impl::NewString(env, str, length, result, [&](v8::Isolate* isolate) {
+    if (length == NAPI_AUTO_LENGTH) length = strlen(str);
+    // ASCII input does not need to go through the UTF-8 decoder.
+    if (simdutf::validate_ascii(str, length)) {
+      return v8::String::NewFromOneByte(isolate,
+                                        reinterpret_cast<const uint8_t*>(str),
+                                        v8::NewStringType::kNormal,
+                                        static_cast<int>(length));
+    }
     return v8::String::NewFromUtf8(
         isolate, str, v8::NewStringType::kNormal, static_cast<int>(length));
   });
@@ -1675,6 +1833,41 @@ napi_status NAPI_CDECL node_api_create_external_string_latin1(
       });
 }
 
+napi_status NAPI_CDECL node_api_create_external_string_utf8(
+    napi_env env,
+    char* str,
+    size_t length,
+    node_api_basic_finalize basic_finalize_callback,
+    void* finalize_hint,
+    napi_value* result,
+    bool* copied) {
+  CHECK_NEW_STRING_ARGS(env, str, length, result);
+  if (length == NAPI_AUTO_LENGTH) length = strlen(str);
+
+  // ASCII is also valid Latin-1 and can be kept as an external one-byte
+  // string. Anything else has to be decoded, i.e. copied.
+  if (simdutf::validate_ascii(str, length)) {
+    return node_api_create_external_string_latin1(env,
+                                                  str,
+                                                  length,
+                                                  basic_finalize_callback,
+                                                  finalize_hint,
+                                                  result,
+                                                  copied);
+  }
+
+  STATUS_CALL(napi_create_string_utf8(env, str, length, result));
+  if (copied != nullptr) {
+    *copied = true;
+  }
+  if (basic_finalize_callback) {
+    env->CallFinalizer(reinterpret_cast<napi_finalize>(basic_finalize_callback),
+                       str,
+                       finalize_hint);
+  }
+  return napi_clear_last_error(env);
+}
+
 napi_status NAPI_CDECL node_api_create_external_string_utf16(
     napi_env env,
     char16_t* str,
@@ -1708,24 +1901,43 @@ napi_status node_api_create_property_key_latin1(napi_env env,
                                                 const char* str,
                                                 size_t length,
                                                 napi_value* result) {
-  return v8impl::NewString(env, str, length, result, [&](v8::Isolate* isolate) {
-    return v8::String::NewFromOneByte(isolate,
-                                      reinterpret_cast<const uint8_t*>(str),
-                                      v8::NewStringType::kInternalized,
-                                      length);
-  });
+  return v8impl::NewPropertyKey(
+      env,
+      &env->property_keys_latin1,
+      str,
+      length,
+      result,
+      [&](v8::Isolate* isolate, size_t len) {
+        return v8::String::NewFromOneByte(isolate,
+                                          reinterpret_cast<const uint8_t*>(str),
+                                          v8::NewStringType::kInternalized,
+                                          static_cast<int>(len));
+      });
 }
 
 napi_status node_api_create_property_key_utf8(napi_env env,
                                               const char* str,
                                               size_t length,
                                               napi_value* result) {
-  return v8impl::NewString(env, str, length, result, [&](v8::Isolate* isolate) {
-    return v8::String::NewFromUtf8(isolate,
-                                   str,
-                                   v8::NewStringType::kInternalized,
-                                   static_cast<int>(length));
-  });
+  return v8impl::NewPropertyKey(
+      env,
+      &env->property_keys_utf8,
+      str,
+      length,
+      result,
+      [&](v8::Isolate* isolate, size_t len) {
+        if (simdutf::validate_ascii(str, len)) {
+          return v8::String::NewFromOneByte(
+              isolate,
+              reinterpret_cast<const uint8_t*>(str),
+              v8::NewStringType::kInternalized,
+              static_cast<int>(len));
+        }
+        return v8::String::NewFromUtf8(isolate,
+                                       str,
+                                       v8::NewStringType::kInternalized,
+                                       static_cast<int>(len));
+      });
 }
 
 napi_status NAPI_CDECL node_api_create_property_key_utf16(napi_env env,
@@ -3,6 +3,7 @@
 
 #include "js_native_api_types.h"
 #include "js_native_api_v8_internals.h"
+#include "v8-fast-api-calls.h"
 
 inline napi_status napi_clear_last_error(node_api_basic_env env);
 
@@ -48,6 +49,28 @@ class RefTracker {
   RefList* prev_ = nullptr;
 };
 
+// Type information of a function created with
+// `node_api_create_fast_function`. V8 keeps raw pointers to it for as long as
+// the function template exists, so it is owned by the napi_env.
+struct FastFunctionInfo {
+  std::vector<v8::CTypeInfo> arg_info;
+  std::unique_ptr<v8::CFunctionInfo> type_info;
+  v8::CFunction c_function;
+};
+
+// Property keys created by an addon with `node_api_create_property_key_*`,
+// looked up by their bytes.
+struct PropertyKeyHash {
+  using is_transparent = void;
+  size_t operator()(std::string_view key) const {
+    return std::hash<std::string_view>()(key);
+  }
+};
+using PropertyKeyCache = std::unordered_map<std::string,
+                                            Persistent<v8::String>,
+                                            PropertyKeyHash,
+                                            std::equal_to<>>;
+
 }  // end of namespace v8impl
 
 struct napi_env__ {
@@ -154,6 +177,14 @@ struct napi_env__ {
   v8impl::RefTracker::RefList finalizing_reflist;
   // The invocation order of the finalizers is not determined.
   std::unordered_set<v8impl::RefTracker*> pending_finalizers;
+  std::vector<std::unique_ptr<v8impl::FastFunctionInfo>> fast_functions;
+  // Addons tend to create the same property keys over and over, e.g. the
+  // column names of every row of a query result. Up to kMaxPropertyKeys keys
+  // of up to kMaxPropertyKeyLength bytes are kept for each encoding.
+  static constexpr size_t kMaxPropertyKeys = 1024;
+  static constexpr size_t kMaxPropertyKeyLength = 256;
+  v8impl::PropertyKeyCache property_keys_latin1;
+  v8impl::PropertyKeyCache property_keys_utf8;
   napi_extended_error_info last_error;
   int open_handle_scopes = 0;
   int open_callback_scopes = 0;
@@ -119,16 +119,25 @@ int JSStream::DoWrite(WriteWrap* w,
 
   int value_int = UV_EPROTO;
 
-  MaybeStackBuffer<Local<Value>, 16> bufs_arr(count);
+  // Writes usually come in several small buffers, e.g. the TLS records
+  // of one write. Hand them to JS as a single Buffer, which takes one
+  // allocation instead of one per buffer and lets the JS stream issue a
+  // single write for them.
+  size_t total_length = 0;
+  for (size_t i = 0; i < count; i++) total_length += bufs[i].len;
+  Local<Object> chunk;
+  if (!Buffer::New(env(), total_length).ToLocal(&chunk)) return value_int;
+  char* data = Buffer::Data(chunk);
   for (size_t i = 0; i < count; i++) {
-    if (!Buffer::Copy(env(), bufs[i].base, bufs[i].len).ToLocal(&bufs_arr[i])) {
-      return value_int;
-    }
+    if (bufs[i].len == 0) continue;
+    memcpy(data, bufs[i].base, bufs[i].len);
+    data += bufs[i].len;
   }
+  Local<Value> chunks[] = {chunk};
 
   Local<Value> argv[] = {
     w->object(),
-    Array::New(env()->isolate(), bufs_arr.out(), count)
+    Array::New(env()->isolate(), chunks, arraysize(chunks))
   };
 
   TryCatchScope try_catch(env());
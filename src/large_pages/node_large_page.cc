@@ -105,6 +105,12 @@ extern char __start_lpstub;
 #endif  // defined(__linux__) || defined(__FreeBSD__)
 
 #endif  // defined(NODE_ENABLE_LARGE_CODE_PAGES) && NODE_ENABLE_LARGE_CODE_PAGES
+
+#include <cstdint>
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
 namespace node {
 #if defined(NODE_ENABLE_LARGE_CODE_PAGES) && NODE_ENABLE_LARGE_CODE_PAGES
 
@@ -438,6 +444,21 @@ int MapStaticCodeToLargePages() {
 #endif
 }
 
+bool AdviseHugePages(void* data, size_t size) {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  // Only the 2 MB aligned part of the range can be backed by huge pages; the
+  // head and tail keep using regular pages.
+  constexpr uintptr_t kHugePageSize = 2 * 1024 * 1024;
+  uintptr_t start = reinterpret_cast<uintptr_t>(data);
+  uintptr_t from = (start + kHugePageSize - 1) & ~(kHugePageSize - 1);
+  uintptr_t to = (start + size) & ~(kHugePageSize - 1);
+  if (data == nullptr || from >= to) return false;
+  return madvise(reinterpret_cast<void*>(from), to - from, MADV_HUGEPAGE) == 0;
+#else
+  return false;
+#endif
+}
+
 const char* LargePagesError(int status) {
   switch (status) {
     case ENOTSUP:
@@ -25,9 +25,14 @@
 
 #if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
 
+#include <cstddef>
+
 namespace node {
 int MapStaticCodeToLargePages();
 const char* LargePagesError(int status);
+// Asks the kernel to back the huge page aligned part of an anonymous memory
+// range with transparent huge pages. Returns false if nothing was advised.
+bool AdviseHugePages(void* data, size_t size);
 }  // namespace node
 
 #endif  // NODE_WANT_INTERNALS
@@ -0,0 +1,93 @@
+#include "loop_metrics.h"
+
+#include <algorithm>
+
+#include "env-inl.h"
+#include "histogram-inl.h"
+
+namespace node {
+
+void EventLoopMetrics::InitializeHandles(uv_loop_t* loop) {
+  CHECK_EQ(0, uv_prepare_init(loop, &prepare_handle_));
+  CHECK_EQ(0, uv_check_init(loop, &check_handle_));
+  uv_unref(prepare_handle());
+  uv_unref(check_handle());
+}
+
+const EventLoopMetrics::PhaseHistograms&
+EventLoopMetrics::EnablePhaseHistograms() {
+  if (!phases_enabled_) {
+    for (std::shared_ptr<Histogram>& histogram : phase_histograms_)
+      histogram = std::make_shared<Histogram>(Histogram::Options{});
+    iteration_start_ns_ = 0;
+    phases_enabled_ = true;
+    // libuv runs the handles of a phase in reverse order of starting them,
+    // so this check handle runs before the one that processes immediates.
+    CHECK_EQ(0, uv_prepare_start(&prepare_handle_, OnPrepare));
+    CHECK_EQ(0, uv_check_start(&check_handle_, OnCheck));
+  }
+  return phase_histograms_;
+}
+
+void EventLoopMetrics::DisablePhaseHistograms() {
+  if (!phases_enabled_) return;
+  uv_prepare_stop(&prepare_handle_);
+  uv_check_stop(&check_handle_);
+  phases_enabled_ = false;
+  phase_histograms_ = {};
+}
+
+const std::shared_ptr<Histogram>& EventLoopMetrics::EnableCallbackHistogram(
+    AsyncWrap::ProviderType provider) {
+  std::shared_ptr<Histogram>& histogram = callback_histograms_[provider];
+  if (!histogram) histogram = std::make_shared<Histogram>(Histogram::Options{});
+  return histogram;
+}
+
+void EventLoopMetrics::DisableCallbackHistogram(
+    AsyncWrap::ProviderType provider) {
+  callback_histograms_[provider].reset();
+}
+
+void EventLoopMetrics::Record(Histogram* histogram, uint64_t duration_ns) {
+  // The histograms cannot hold zero.
+  histogram->Record(std::max<int64_t>(duration_ns, 1));
+}
+
+void EventLoopMetrics::RecordPhase(Phase phase, uint64_t duration_ns) {
+  iteration_busy_ns_ += duration_ns;
+  Record(phase_histograms_[phase].get(), duration_ns);
+}
+
+void EventLoopMetrics::OnPrepare(uv_prepare_t* handle) {
+  EventLoopMetrics* metrics =
+      ContainerOf(&EventLoopMetrics::prepare_handle_, handle);
+  uint64_t now = uv_hrtime();
+  uint64_t idle = uv_metrics_idle_time(handle->loop);
+  // Whatever part of the previous iteration was neither spent waiting for
+  // events nor in one of the measured phases.
+  if (metrics->iteration_start_ns_ != 0) {
+    uint64_t active = (now - metrics->iteration_start_ns_) -
+                      (idle - metrics->iteration_start_idle_ns_);
+    if (active > metrics->iteration_busy_ns_)
+      Record(metrics->phase_histograms_[kOther].get(),
+             active - metrics->iteration_busy_ns_);
+  }
+  metrics->iteration_start_ns_ = now;
+  metrics->iteration_start_idle_ns_ = idle;
+  metrics->iteration_busy_ns_ = 0;
+}
+
+void EventLoopMetrics::OnCheck(uv_check_t* handle) {
+  EventLoopMetrics* metrics =
+      ContainerOf(&EventLoopMetrics::check_handle_, handle);
+  // The first iteration after enabling the histograms may not have passed
+  // the prepare phase yet.
+  if (metrics->iteration_start_ns_ == 0) return;
+  uint64_t elapsed = uv_hrtime() - metrics->iteration_start_ns_;
+  uint64_t idle = uv_metrics_idle_time(handle->loop) -
+                  metrics->iteration_start_idle_ns_;
+  metrics->RecordPhase(kPoll, elapsed > idle ? elapsed - idle : 0);
+}
+
+}  // namespace node
@@ -0,0 +1,120 @@
+#ifndef SRC_LOOP_METRICS_H_
+#define SRC_LOOP_METRICS_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include <array>
+#include <cstdint>
+#include <memory>
+
+#include "async_wrap.h"
+#include "uv.h"
+
+namespace node {
+
+class Histogram;
+
+// Per-Environment nanosecond histograms of where event loop time goes.
+//
+// The phase histograms record, once per loop iteration, the time spent
+// running timers, processing I/O in the poll phase (excluding the time spent
+// waiting for events), running immediates in the check phase, and everything
+// else (pending, idle, prepare and close callbacks). libuv has no hooks at
+// phase boundaries, so poll is measured between a prepare and a check handle
+// and the remainder is attributed to "other".
+//
+// The callback histograms record the duration of every
+// AsyncWrap::MakeCallback() for one provider type.
+//
+// Nothing is measured unless the corresponding histograms are enabled.
+// Only used on the thread of the Environment.
+class EventLoopMetrics {
+ public:
+  enum Phase : uint8_t { kTimers, kPoll, kCheck, kOther, kPhaseCount };
+
+  using PhaseHistograms = std::array<std::shared_ptr<Histogram>, kPhaseCount>;
+
+  EventLoopMetrics() = default;
+
+  EventLoopMetrics(const EventLoopMetrics&) = delete;
+  EventLoopMetrics& operator=(const EventLoopMetrics&) = delete;
+
+  void InitializeHandles(uv_loop_t* loop);
+  uv_handle_t* prepare_handle() {
+    return reinterpret_cast<uv_handle_t*>(&prepare_handle_);
+  }
+  uv_handle_t* check_handle() {
+    return reinterpret_cast<uv_handle_t*>(&check_handle_);
+  }
+
+  // Enabling histograms again returns the existing ones.
+  const PhaseHistograms& EnablePhaseHistograms();
+  void DisablePhaseHistograms();
+  const std::shared_ptr<Histogram>& EnableCallbackHistogram(
+      AsyncWrap::ProviderType provider);
+  void DisableCallbackHistogram(AsyncWrap::ProviderType provider);
+
+  // Measures a phase that Node.js itself drives, i.e. timers or check.
+  class PhaseScope {
+   public:
+    inline PhaseScope(EventLoopMetrics* metrics, Phase phase)
+        : metrics_(metrics->phases_enabled_ ? metrics : nullptr),
+          phase_(phase),
+          start_(metrics_ != nullptr ? uv_hrtime() : 0) {}
+    inline ~PhaseScope() {
+      if (metrics_ != nullptr)
+        metrics_->RecordPhase(phase_, uv_hrtime() - start_);
+    }
+
+    PhaseScope(const PhaseScope&) = delete;
+    PhaseScope& operator=(const PhaseScope&) = delete;
+
+   private:
+    EventLoopMetrics* metrics_;
+    Phase phase_;
+    uint64_t start_;
+  };
+
+  class CallbackScope {
+   public:
+    inline CallbackScope(EventLoopMetrics* metrics,
+                         AsyncWrap::ProviderType provider)
+        : histogram_(metrics->callback_histograms_[provider]),
+          start_(histogram_ ? uv_hrtime() : 0) {}
+    inline ~CallbackScope() {
+      if (histogram_) Record(histogram_.get(), uv_hrtime() - start_);
+    }
+
+    CallbackScope(const CallbackScope&) = delete;
+    CallbackScope& operator=(const CallbackScope&) = delete;
+
+   private:
+    // Keeps the histogram alive if the callback disables it.
+    std::shared_ptr<Histogram> histogram_;
+    uint64_t start_;
+  };
+
+ private:
+  static void Record(Histogram* histogram, uint64_t duration_ns);
+  void RecordPhase(Phase phase, uint64_t duration_ns);
+  static void OnPrepare(uv_prepare_t* handle);
+  static void OnCheck(uv_check_t* handle);
+
+  uv_prepare_t prepare_handle_;
+  uv_check_t check_handle_;
+  bool phases_enabled_ = false;
+  PhaseHistograms phase_histograms_;
+  std::array<std::shared_ptr<Histogram>, AsyncWrap::PROVIDERS_LENGTH>
+      callback_histograms_;
+
+  // State of the current loop iteration, which starts at the prepare phase.
+  uint64_t iteration_start_ns_ = 0;
+  uint64_t iteration_start_idle_ns_ = 0;
+  uint64_t iteration_busy_ns_ = 0;
+};
+
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_LOOP_METRICS_H_
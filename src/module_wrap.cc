@@ -6,6 +6,7 @@
 #include "node_errors.h"
 #include "node_external_reference.h"
 #include "node_internals.h"
+#include "node_platform.h"
 #include "node_process-inl.h"
 #include "node_watchdog.h"
 #include "util-inl.h"
@@ -13,6 +14,7 @@
 #include <sys/stat.h>  // S_IFDIR
 
 #include <algorithm>
+#include <memory>
 
 namespace node {
 namespace loader {
@@ -59,6 +61,8 @@ using v8::ScriptCompiler;
 using v8::ScriptOrigin;
 using v8::String;
 using v8::Symbol;
+using v8::Task;
+using v8::TaskPriority;
 using v8::UnboundModuleScript;
 using v8::Undefined;
 using v8::Value;
@@ -164,9 +168,125 @@ Local<PrimitiveArray> ModuleWrap::GetHostDefinedOptions(
   return host_defined_options;
 }
 
+// Hands a copy of the source to V8 in a single chunk.
+class ModuleSourceParse::SourceStream final
+    : public ScriptCompiler::ExternalSourceStream {
+ public:
+  SourceStream(std::unique_ptr<uint8_t[]> data, size_t length)
+      : data_(std::move(data)), length_(length) {}
+
+  size_t GetMoreData(const uint8_t** src) override {
+    if (!data_) return 0;
+    *src = data_.release();
+    return length_;
+  }
+
+ private:
+  std::unique_ptr<uint8_t[]> data_;
+  size_t length_;
+};
+
+class ModuleSourceParse::ParseTask final : public Task {
+ public:
+  explicit ParseTask(ModuleSourceParse* parse) : parse_(parse) {}
+
+  void Run() override {
+    parse_->task_->Run();
+    Mutex::ScopedLock lock(parse_->mutex_);
+    parse_->parsed_ = true;
+    parse_->parsed_cond_.Broadcast(lock);
+  }
+
+ private:
+  // The ModuleSourceParse waits for this task in its destructor.
+  ModuleSourceParse* parse_;
+};
+
+ModuleSourceParse::ModuleSourceParse(Realm* realm,
+                                     Local<Object> object,
+                                     Local<String> source)
+    : BaseObject(realm, object), source_(realm->isolate(), source) {
+  MakeWeak();
+
+  Isolate* isolate = realm->isolate();
+  uint32_t length = source->Length();
+  ScriptCompiler::StreamedSource::Encoding encoding;
+  std::unique_ptr<uint8_t[]> data;
+  if (source->IsOneByte()) {
+    encoding = ScriptCompiler::StreamedSource::ONE_BYTE;
+    source_bytes_ = length;
+    data = std::make_unique<uint8_t[]>(source_bytes_);
+    source->WriteOneByteV2(isolate, 0, length, data.get());
+  } else {
+    encoding = ScriptCompiler::StreamedSource::TWO_BYTE;
+    source_bytes_ = length * sizeof(uint16_t);
+    data = std::make_unique<uint8_t[]>(source_bytes_);
+    source->WriteV2(
+        isolate, 0, length, reinterpret_cast<uint16_t*>(data.get()));
+  }
+  streamed_source_ = std::make_unique<ScriptCompiler::StreamedSource>(
+      std::make_unique<SourceStream>(std::move(data), source_bytes_),
+      encoding);
+  task_.reset(ScriptCompiler::StartStreaming(
+      isolate, streamed_source_.get(), v8::ScriptType::kModule));
+  if (task_) {
+    realm->env()->isolate_data()->platform()->PostTaskOnWorkerThread(
+        TaskPriority::kUserBlocking, std::make_unique<ParseTask>(this));
+  }
+}
+
+ModuleSourceParse::~ModuleSourceParse() {
+  WaitForParse();
+}
+
+void ModuleSourceParse::WaitForParse() {
+  if (!task_) return;
+  Mutex::ScopedLock lock(mutex_);
+  while (!parsed_) parsed_cond_.Wait(lock);
+}
+
+// startModuleParse(source)
+void ModuleSourceParse::Start(const FunctionCallbackInfo<Value>& args) {
+  Realm* realm = Realm::GetCurrent(args);
+  CHECK(args[0]->IsString());
+
+  Local<Object> obj;
+  if (!realm->isolate_data()
+           ->module_source_parse_constructor_template()
+           ->InstanceTemplate()
+           ->NewInstance(realm->context())
+           .ToLocal(&obj)) {
+    return;
+  }
+  ModuleSourceParse* parse =
+      new ModuleSourceParse(realm, obj, args[0].As<String>());
+  // V8 does not stream every source, in which case the module is simply
+  // compiled on the main thread.
+  if (parse->task_) args.GetReturnValue().Set(obj);
+}
+
+bool ModuleSourceParse::CanCompile(Local<String> source) const {
+  return task_ && !used_ && source_.Get(env()->isolate())->StringEquals(source);
+}
+
+MaybeLocal<Module> ModuleSourceParse::Compile(Local<Context> context,
+                                              Local<String> source,
+                                              const ScriptOrigin& origin) {
+  CHECK(CanCompile(source));
+  WaitForParse();
+  used_ = true;
+  return ScriptCompiler::CompileModule(
+      context, streamed_source_.get(), source, origin);
+}
+
+void ModuleSourceParse::MemoryInfo(MemoryTracker* tracker) const {
+  tracker->TrackField("source", source_);
+  if (!used_) tracker->TrackFieldWithSize("streamed_source", source_bytes_);
+}
+
 // new ModuleWrap(url, context, source, lineOffset, columnOffset[, cachedData]);
 // new ModuleWrap(url, context, source, lineOffset, columnOffset,
-//                idSymbol);
+//                idSymbol[, parse]);
 // new ModuleWrap(url, context, exportNames, evaluationCallback[, cjsModule])
 void ModuleWrap::New(const FunctionCallbackInfo<Value>& args) {
   CHECK(args.IsConstructCall());
@@ -208,7 +328,7 @@ void ModuleWrap::New(const FunctionCallbackInfo<Value>& args) {
     // new ModuleWrap(url, context, source, lineOffset, columnOffset[,
     //                cachedData]);
     // new ModuleWrap(url, context, source, lineOffset, columnOffset,
-    //                idSymbol);
+    //                idSymbol[, parse]);
     CHECK(args[2]->IsString());
     CHECK(args[3]->IsNumber());
     line_offset = args[3].As<Int32>()->Value();
@@ -277,6 +397,10 @@ void ModuleWrap::New(const FunctionCallbackInfo<Value>& args) {
                                            cached_data_buf->ByteLength());
       }
       Local<String> source_text = args[2].As<String>();
+      ModuleSourceParse* parse = nullptr;
+      if (args.Length() > 6 && args[6]->IsObject()) {
+        parse = Unwrap<ModuleSourceParse>(args[6].As<Object>());
+      }
 
       bool cache_rejected = false;
       if (!CompileSourceTextModule(realm,
@@ -286,7 +410,8 @@ void ModuleWrap::New(const FunctionCallbackInfo<Value>& args) {
                                    column_offset,
                                    host_defined_options,
                                    user_cached_data,
-                                   &cache_rejected)
+                                   &cache_rejected,
+                                   parse)
                .ToLocal(&module)) {
         if (try_catch.HasCaught() && !try_catch.HasTerminated()) {
           CHECK(!try_catch.Message().IsEmpty());
@@ -359,7 +484,8 @@ MaybeLocal<Module> ModuleWrap::CompileSourceTextModule(
     int column_offset,
     Local<PrimitiveArray> host_defined_options,
     std::optional<ScriptCompiler::CachedData*> user_cached_data,
-    bool* cache_rejected) {
+    bool* cache_rejected,
+    ModuleSourceParse* parse) {
   Isolate* isolate = realm->isolate();
   EscapableHandleScope scope(isolate);
   ScriptOrigin origin(url,
@@ -398,8 +524,16 @@ MaybeLocal<Module> ModuleWrap::CompileSourceTextModule(
   }
 
   Local<Module> module;
-  if (!ScriptCompiler::CompileModule(isolate, &source, options)
-           .ToLocal(&module)) {
+  // A streamed parse cannot consume a code cache, so it is only used when
+  // there is none.
+  if (cached_data == nullptr && parse != nullptr &&
+      parse->CanCompile(source_text)) {
+    if (!parse->Compile(isolate->GetCurrentContext(), source_text, origin)
+             .ToLocal(&module)) {
+      return scope.EscapeMaybe(MaybeLocal<Module>());
+    }
+  } else if (!ScriptCompiler::CompileModule(isolate, &source, options)
+                  .ToLocal(&module)) {
     return scope.EscapeMaybe(MaybeLocal<Module>());
   }
 
@@ -676,6 +810,86 @@ void ModuleWrap::InstantiateSync(const FunctionCallbackInfo<Value>& args) {
   args.GetReturnValue().Set(module->IsGraphAsync());
 }
 
+// moduleWrap.instantiateGraph(moduleWraps, linkedModuleWraps)
+// Links every module of a fully resolved graph and instantiates the graph
+// rooted at this module in one call. linkedModuleWraps[i] lists the modules
+// that the requests of moduleWraps[i] resolve to, in the order returned by
+// getModuleRequests(), so the specifiers never have to cross into JS.
+void ModuleWrap::InstantiateGraph(const FunctionCallbackInfo<Value>& args) {
+  Realm* realm = Realm::GetCurrent(args);
+  Isolate* isolate = args.GetIsolate();
+  Local<Context> realm_context = realm->context();
+  ModuleWrap* obj;
+  ASSIGN_OR_RETURN_UNWRAP(&obj, args.This());
+  Environment* env = realm->env();
+
+  CHECK(args[0]->IsArray());
+  CHECK(args[1]->IsArray());
+  Local<Array> modules = args[0].As<Array>();
+  Local<Array> linked = args[1].As<Array>();
+  CHECK_EQ(modules->Length(), linked->Length());
+
+  Local<FunctionTemplate> module_wrap_template =
+      realm->isolate_data()->module_wrap_constructor_template();
+  std::vector<ModuleWrap*> dependents;
+  dependents.reserve(modules->Length());
+  for (uint32_t i = 0; i < modules->Length(); i++) {
+    Local<Value> module_value;
+    Local<Value> linked_value;
+    if (!modules->Get(realm_context, i).ToLocal(&module_value) ||
+        !linked->Get(realm_context, i).ToLocal(&linked_value)) {
+      return;
+    }
+    CHECK(module_wrap_template->HasInstance(module_value));
+    CHECK(linked_value->IsArray());
+    ModuleWrap* dependent = Unwrap<ModuleWrap>(module_value.As<Object>());
+    dependents.push_back(dependent);
+
+    Local<FixedArray> requests =
+        dependent->module_.Get(isolate)->GetModuleRequests();
+    Local<Array> linked_modules = linked_value.As<Array>();
+    CHECK_EQ(static_cast<uint32_t>(requests->Length()),
+             linked_modules->Length());
+    for (int j = 0; j < requests->Length(); j++) {
+      Local<Value> linked_module;
+      if (!linked_modules->Get(realm_context, j).ToLocal(&linked_module)) {
+        return;
+      }
+      CHECK(module_wrap_template->HasInstance(linked_module));
+      Local<String> specifier = requests->Get(realm_context, j)
+                                    .As<ModuleRequest>()
+                                    ->GetSpecifier();
+      Utf8Value specifier_utf8(isolate, specifier);
+      dependent->resolve_cache_[specifier_utf8.ToString()].Reset(
+          isolate, linked_module.As<Object>());
+    }
+  }
+
+  Local<Context> context = obj->context();
+  Local<Module> module = obj->module_.Get(isolate);
+  {
+    TryCatchScope try_catch(env);
+    USE(module->InstantiateModule(
+        context, ResolveModuleCallback, ResolveSourceCallback));
+
+    // The resolve caches are only needed during instantiation.
+    for (ModuleWrap* dependent : dependents) dependent->resolve_cache_.clear();
+
+    if (try_catch.HasCaught() && !try_catch.HasTerminated()) {
+      CHECK(!try_catch.Message().IsEmpty());
+      CHECK(!try_catch.Exception().IsEmpty());
+      AppendExceptionLine(env,
+                          try_catch.Exception(),
+                          try_catch.Message(),
+                          ErrorHandlingMode::MODULE_ERROR);
+      try_catch.ReThrow();
+      return;
+    }
+  }
+
+  args.GetReturnValue().Set(module->IsGraphAsync());
+}
+
 Maybe<void> ThrowIfPromiseRejected(Realm* realm, Local<Promise> promise) {
   Isolate* isolate = realm->isolate();
   Local<Context> context = realm->context();
@@ -1281,6 +1495,7 @@ void ModuleWrap::CreatePerIsolateProperties(IsolateData* isolate_data,
   SetProtoMethod(isolate, tpl, "link", Link);
   SetProtoMethod(isolate, tpl, "getModuleRequests", GetModuleRequests);
   SetProtoMethod(isolate, tpl, "instantiateSync", InstantiateSync);
+  SetProtoMethod(isolate, tpl, "instantiateGraph", InstantiateGraph);
   SetProtoMethod(isolate, tpl, "evaluateSync", EvaluateSync);
   SetProtoMethod(isolate, tpl, "getNamespaceSync", GetNamespaceSync);
   SetProtoMethod(isolate, tpl, "instantiate", Instantiate);
@@ -1297,6 +1512,14 @@ void ModuleWrap::CreatePerIsolateProperties(IsolateData* isolate_data,
   SetConstructorFunction(isolate, target, "ModuleWrap", tpl);
   isolate_data->set_module_wrap_constructor_template(tpl);
 
+  Local<FunctionTemplate> parse_tpl = NewFunctionTemplate(isolate, nullptr);
+  parse_tpl->InstanceTemplate()->SetInternalFieldCount(
+      BaseObject::kInternalFieldCount);
+  parse_tpl->SetClassName(
+      FIXED_ONE_BYTE_STRING(isolate, "ModuleSourceParse"));
+  isolate_data->set_module_source_parse_constructor_template(parse_tpl);
+  SetMethod(isolate, target, "startModuleParse", ModuleSourceParse::Start);
+
   SetMethod(isolate,
             target,
             "setImportModuleDynamicallyCallback",
@@ -1339,10 +1562,12 @@ void ModuleWrap::CreatePerContextProperties(Local<Object> target,
 void ModuleWrap::RegisterExternalReferences(
     ExternalReferenceRegistry* registry) {
   registry->Register(New);
+  registry->Register(ModuleSourceParse::Start);
 
   registry->Register(Link);
   registry->Register(GetModuleRequests);
   registry->Register(InstantiateSync);
+  registry->Register(InstantiateGraph);
   registry->Register(EvaluateSync);
   registry->Register(GetNamespaceSync);
   registry->Register(Instantiate);
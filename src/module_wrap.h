@@ -8,6 +8,7 @@
 #include <unordered_map>
 #include <vector>
 #include "base_object.h"
+#include "node_mutex.h"
 #include "v8-script.h"
 
 namespace node {
@@ -38,6 +39,49 @@ enum ModulePhase : int {
   kEvaluationPhase = 2,
 };
 
+// Parses the source of a module on a worker thread with V8's streaming
+// compiler, so that the parse overlaps with the loader fetching other
+// modules. Created by startModuleParse(source) and handed to
+// new ModuleWrap(), which finishes the compilation on the main thread.
+class ModuleSourceParse : public BaseObject {
+ public:
+  ModuleSourceParse(Realm* realm,
+                    v8::Local<v8::Object> object,
+                    v8::Local<v8::String> source);
+  ~ModuleSourceParse() override;
+
+  static void Start(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  // Returns false if the parse was started for a different source, or if it
+  // has already been used.
+  bool CanCompile(v8::Local<v8::String> source) const;
+  // Waits for the worker thread to finish parsing and compiles the module.
+  v8::MaybeLocal<v8::Module> Compile(v8::Local<v8::Context> context,
+                                     v8::Local<v8::String> source,
+                                     const v8::ScriptOrigin& origin);
+
+  void MemoryInfo(MemoryTracker* tracker) const override;
+  SET_MEMORY_INFO_NAME(ModuleSourceParse)
+  SET_SELF_SIZE(ModuleSourceParse)
+
+ private:
+  class SourceStream;
+  class ParseTask;
+
+  void WaitForParse();
+
+  v8::Global<v8::String> source_;
+  size_t source_bytes_ = 0;
+  std::unique_ptr<v8::ScriptCompiler::StreamedSource> streamed_source_;
+  std::unique_ptr<v8::ScriptCompiler::ScriptStreamingTask> task_;
+  bool used_ = false;
+
+  // This mutex protects access to all variables listed below it.
+  Mutex mutex_;
+  ConditionVariable parsed_cond_;
+  bool parsed_ = false;
+};
+
 class ModuleWrap : public BaseObject {
  public:
   enum InternalFields {
@@ -92,7 +136,8 @@ class ModuleWrap : public BaseObject {
       int column_offset,
       v8::Local<v8::PrimitiveArray> host_defined_options,
       std::optional<v8::ScriptCompiler::CachedData*> user_cached_data,
-      bool* cache_rejected);
+      bool* cache_rejected,
+      ModuleSourceParse* parse = nullptr);
 
   static void CreateRequiredModuleFacade(
       const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -110,6 +155,7 @@ class ModuleWrap : public BaseObject {
   static void GetModuleRequests(
       const v8::FunctionCallbackInfo<v8::Value>& args);
   static void InstantiateSync(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void InstantiateGraph(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void EvaluateSync(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void GetNamespaceSync(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetModuleSourceObject(
@@ -30,12 +30,14 @@
 #include "env-inl.h"
 #include "histogram-inl.h"
 #include "memory_tracker-inl.h"
+#include "node_auto_tune.h"
 #include "node_binding.h"
 #include "node_builtins.h"
 #include "node_errors.h"
 #include "node_internals.h"
 #include "node_main_instance.h"
 #include "node_metadata.h"
+#include "node_numa.h"
 #include "node_options-inl.h"
 #include "node_perf.h"
 #include "node_process-inl.h"
@@ -328,7 +330,7 @@ MaybeLocal<Value> StartExecution(Environment* env, StartExecutionCallback cb) {
 #ifndef DISABLE_SINGLE_EXECUTABLE_APPLICATION
   // Snapshot in SEA is only loaded for the main thread.
   if (sea::IsSingleExecutable() && env->is_main_thread()) {
-    sea::SeaResource sea = sea::FindSingleExecutableResource();
+    const sea::SeaResource& sea = sea::FindSingleExecutableResource();
     // The SEA preparation blob building process should already enforce this,
     // this check is just here to guard against the unlikely case where
     // the SEA preparation blob has been manually modified by someone.
@@ -348,6 +350,13 @@ MaybeLocal<Value> StartExecution(Environment* env, StartExecutionCallback cb) {
   // deserialize main function take precedence. For workers, we need to
   // move the pre-execution part into a different file that can be
   // reused when dealing with user-defined main functions.
+  const std::string& snapshot_entry = per_process::cli_options->snapshot_entry;
+  if (!snapshot_entry.empty() && env->is_main_thread()) {
+    if (env->SelectSnapshotEntry(snapshot_entry).IsNothing()) {
+      return MaybeLocal<Value>();
+    }
+  }
+
   if (!env->snapshot_deserialize_main().IsEmpty()) {
     // Custom worker snapshot is not supported yet,
     // so workers can't have deserialize main functions.
@@ -993,8 +1002,10 @@ static ExitCode InitializeNodeWithArgsInternal(
     // Initialize ICU.
     // If icu_data_dir is empty here, it will load the 'minimal' data.
     std::string icu_error;
-    if (!i18n::InitializeICUDirectory(per_process::cli_options->icu_data_dir,
-                                      &icu_error)) {
+    if (!i18n::InitializeICUDirectory(
+            per_process::cli_options->icu_data_dir,
+            &icu_error,
+            per_process::cli_options->icu_data_prefetch)) {
       errors->push_back(icu_error +
                         ": Could not initialize ICU. "
                         "Check the directory specified by NODE_ICU_DATA or "
@@ -1066,8 +1077,11 @@ InitializeOncePerProcessInternal(const std::vector<std::string>& args,
   if (!per_process::cli_options->run.empty()) {
     auto positional_args = task_runner::GetPositionalArgs(args);
     result->early_return_ = true;
-    task_runner::RunTask(
-        result, per_process::cli_options->run, positional_args);
+    task_runner::RunTask(result,
+                         per_process::cli_options->run,
+                         positional_args,
+                         per_process::cli_options->run_parallel,
+                         per_process::cli_options->run_concurrency);
     return result;
   }
 
@@ -1206,10 +1220,43 @@ InitializeOncePerProcessInternal(const std::vector<std::string>& args,
 #endif  // HAVE_OPENSSL
   }
 
+  if (per_process::cli_options->auto_tune == "container") {
+    auto_tune::ConfigureProcess(per_process::cli_options.get());
+  }
+  if (per_process::cli_options->v8_thread_pool_size < 0) {
+    per_process::cli_options->v8_thread_pool_size = 4;
+  }
+
   if (!(flags & ProcessInitializationFlags::kNoInitializeNodeV8Platform)) {
     uv_thread_setname("MainThread");
+    // Platform threads inherit the CPU affinity and memory policy of the
+    // thread that creates them, so bind the main thread only while the
+    // platform is being initialized, and then put back what it had, which
+    // may have been set up by numactl(8).
+    int numa_node =
+        static_cast<int>(per_process::cli_options->v8_thread_pool_numa_node);
+    std::vector<int> main_thread_cpus;
+    numa::SavedMemoryPolicy main_thread_policy;
+    bool rebind = false;
+    if (numa_node >= 0) {
+      int err = numa::GetCurrentThreadAffinity(&main_thread_cpus);
+      if (err == 0)
+        err = numa::GetCurrentThreadMemoryPolicy(&main_thread_policy);
+      rebind = err == 0;
+      if (err == 0)
+        err = numa::BindCurrentThread(numa_node,
+                                      numa::MemoryPolicy::kPreferred);
+      if (err != 0) {
+        result->errors_.emplace_back(
+            std::string("--v8-pool-numa-node: ") + uv_strerror(err));
+      }
+    }
     per_process::v8_platform.Initialize(
         static_cast<int>(per_process::cli_options->v8_thread_pool_size));
+    if (rebind) {
+      numa::SetCurrentThreadAffinity(main_thread_cpus);
+      numa::RestoreCurrentThreadMemoryPolicy(main_thread_policy);
+    }
     result->platform_ = per_process::v8_platform.Platform();
   }
 
@@ -1423,7 +1470,7 @@ bool LoadSnapshotData(const SnapshotData** snapshot_data_ptr) {
 #ifndef DISABLE_SINGLE_EXECUTABLE_APPLICATION
   if (sea::IsSingleExecutable()) {
     is_sea = true;
-    sea::SeaResource sea = sea::FindSingleExecutableResource();
+    const sea::SeaResource& sea = sea::FindSingleExecutableResource();
     if (sea.use_snapshot()) {
       std::unique_ptr<SnapshotData> read_data =
           std::make_unique<SnapshotData>();
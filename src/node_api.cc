@@ -16,9 +16,12 @@
 #include "tracing/traced_value.h"
 #include "util-inl.h"
 
+#include <algorithm>
 #include <atomic>
 #include <cstring>
 #include <memory>
+#include <thread>
+#include <vector>
 
 namespace v8impl {
 static void ThrowNodeApiVersionError(node::Environment* node_env,
@@ -198,6 +201,57 @@ class BufferFinalizer : private Finalizer {
   ~BufferFinalizer() { env()->Unref(); }
 };
 
+// Intrusive multi-producer, single-consumer queue. Push() may be called from
+// any thread and never blocks; Pop() must only be called by the consumer.
+class MPSCQueue {
+ public:
+  MPSCQueue() : head_(&stub_), tail_(&stub_) {}
+
+  ~MPSCQueue() {
+    void* data;
+    while (Pop(&data)) {
+    }
+    if (tail_ != &stub_) delete tail_;
+  }
+
+  MPSCQueue(const MPSCQueue&) = delete;
+  MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+  void Push(void* data) {
+    Node* node = new Node(data);
+    Node* prev = head_.exchange(node, std::memory_order_acq_rel);
+    prev->next.store(node, std::memory_order_release);
+  }
+
+  // Returns false when the queue is empty, or when the only remaining item is
+  // still being linked in by a concurrent Push(). In the latter case the
+  // producer notifies the consumer again once it is done.
+  bool Pop(void** data) {
+    Node* tail = tail_;
+    Node* next = tail->next.load(std::memory_order_acquire);
+    if (next == nullptr) return false;
+    tail_ = next;
+    *data = next->data;
+    if (tail != &stub_) delete tail;
+    return true;
+  }
+
+  bool empty() const {
+    return tail_->next.load(std::memory_order_acquire) == nullptr;
+  }
+
+ private:
+  struct Node {
+    explicit Node(void* data_ = nullptr) : data(data_) {}
+    std::atomic<Node*> next{nullptr};
+    void* data;
+  };
+
+  Node stub_;
+  std::atomic<Node*> head_;  // Most recently pushed node.
+  Node* tail_;               // Last popped node, owned by the consumer.
+};
+
 class ThreadSafeFunction : public node::AsyncResource {
  public:
   ThreadSafeFunction(v8::Local<v8::Function> func,
@@ -209,7 +263,9 @@ class ThreadSafeFunction : public node::AsyncResource {
                      node_napi_env env_,
                      void* finalize_data_,
                      napi_finalize finalize_cb_,
-                     napi_threadsafe_function_call_js call_js_cb_)
+                     napi_threadsafe_function_call_js call_js_cb_,
+                     node_api_threadsafe_function_call_js_batch
+                         call_js_batch_cb_ = nullptr)
       : AsyncResource(env_->isolate,
                       resource,
                       *v8::String::Utf8Value(env_->isolate, name)),
@@ -222,6 +278,7 @@ class ThreadSafeFunction : public node::AsyncResource {
         finalize_data(finalize_data_),
         finalize_cb(finalize_cb_),
         call_js_cb(call_js_cb_ == nullptr ? CallJs : call_js_cb_),
+        call_js_batch_cb(call_js_batch_cb_),
         handles_closing(false) {
     ref.Reset(env->isolate, func);
     node::AddEnvironmentCleanupHook(env->isolate, Cleanup, this);
@@ -236,6 +293,20 @@ class ThreadSafeFunction : public node::AsyncResource {
   // These methods can be called from any thread.
 
   napi_status Push(void* data, napi_threadsafe_function_call_mode mode) {
+    if (max_queue_size == 0) {
+      // Unbounded queues never block, so producers do not need the mutex
+      // unless the function is closing. `pending_pushes` makes the loop thread
+      // wait for pushes that raced with closing before the queue is drained.
+      pending_pushes++;
+      if (!is_closing) {
+        lock_free_queue.Push(data);
+        Send();
+        pending_pushes--;
+        return napi_ok;
+      }
+      pending_pushes--;
+    }
+
     node::Mutex::ScopedLock lock(this->mutex);
 
     while (queue.size() >= max_queue_size && max_queue_size > 0 &&
@@ -295,8 +366,31 @@ class ThreadSafeFunction : public node::AsyncResource {
   }
 
   void EmptyQueueAndDelete() {
+    // See Push(). Producers only stay in this state for a few instructions.
+    while (pending_pushes != 0) {
+      std::this_thread::yield();
+    }
+    batch.clear();
     for (; !queue.empty(); queue.pop()) {
-      call_js_cb(nullptr, nullptr, context, queue.front());
+      batch.push_back(queue.front());
+    }
+    void* data;
+    while (lock_free_queue.Pop(&data)) {
+      batch.push_back(data);
+    }
+    if (call_js_batch_cb != nullptr) {
+      // Like in DispatchOne(), never hand out more than kMaxBatchSize items.
+      for (size_t i = 0; i < batch.size(); i += kMaxBatchSize) {
+        call_js_batch_cb(nullptr,
+                         nullptr,
+                         context,
+                         batch.data() + i,
+                         std::min(kMaxBatchSize, batch.size() - i));
+      }
+    } else {
+      for (void* item : batch) {
+        call_js_cb(nullptr, nullptr, context, item);
+      }
     }
     delete this;
   }
@@ -371,24 +465,38 @@ class ThreadSafeFunction : public node::AsyncResource {
   }
 
   bool DispatchOne() {
-    void* data = nullptr;
-    bool popped_value = false;
+    // In batch mode, up to kMaxBatchSize items are handed to the callback at
+    // once; otherwise the callback is invoked once per item.
+    const size_t batch_limit = call_js_batch_cb != nullptr ? kMaxBatchSize : 1;
     bool has_more = false;
+    batch.clear();
 
     {
       node::Mutex::ScopedLock lock(this->mutex);
       if (is_closing) {
         CloseHandlesAndMaybeDelete();
       } else {
-        size_t size = queue.size();
-        if (size > 0) {
-          data = queue.front();
-          queue.pop();
-          popped_value = true;
-          if (size == max_queue_size && max_queue_size > 0) {
-            cond->Signal(lock);
+        size_t size;
+        if (max_queue_size == 0) {
+          void* data;
+          while (batch.size() < batch_limit && lock_free_queue.Pop(&data)) {
+            batch.push_back(data);
+          }
+          size = lock_free_queue.empty() ? 0 : 1;
+        } else {
+          bool was_full = queue.size() >= max_queue_size;
+          while (batch.size() < batch_limit && !queue.empty()) {
+            batch.push_back(queue.front());
+            queue.pop();
           }
-          size--;
+          if (was_full && !batch.empty()) {
+            if (batch.size() == 1) {
+              cond->Signal(lock);
+            } else {
+              cond->Broadcast(lock);
+            }
+          }
+          size = queue.size();
         }
 
         if (size == 0) {
@@ -405,7 +513,7 @@ class ThreadSafeFunction : public node::AsyncResource {
       }
     }
 
-    if (popped_value) {
+    if (!batch.empty()) {
       v8::HandleScope scope(env->isolate);
       CallbackScope cb_scope(this);
       napi_value js_callback = nullptr;
@@ -414,8 +522,16 @@ class ThreadSafeFunction : public node::AsyncResource {
             v8::Local<v8::Function>::New(env->isolate, ref);
         js_callback = v8impl::JsValueFromV8LocalValue(js_cb);
       }
-      env->CallbackIntoModule<false>(
-          [&](napi_env env) { call_js_cb(env, js_callback, context, data); });
+      if (call_js_batch_cb != nullptr) {
+        env->CallbackIntoModule<false>([&](napi_env env) {
+          call_js_batch_cb(
+              env, js_callback, context, batch.data(), batch.size());
+        });
+      } else {
+        void* data = batch[0];
+        env->CallbackIntoModule<false>(
+            [&](napi_env env) { call_js_cb(env, js_callback, context, data); });
+      }
     }
 
     return has_more;
@@ -443,6 +559,12 @@ class ThreadSafeFunction : public node::AsyncResource {
       return;
     }
     handles_closing = true;
+    // is_closing is set at this point, so no new producer gets past its check
+    // in Push(). Those that passed it already still call Send(), and must do
+    // so before the handle starts closing.
+    while (pending_pushes != 0) {
+      std::this_thread::yield();
+    }
     env->node_env()->CloseHandle(
         reinterpret_cast<uv_handle_t*>(&async),
         [](uv_handle_t* handle) -> void {
@@ -504,6 +626,7 @@ class ThreadSafeFunction : public node::AsyncResource {
   static const unsigned char kDispatchPending = 1 << 1;
 
   static const unsigned int kMaxIterationCount = 1000;
+  static constexpr size_t kMaxBatchSize = 1024;
 
   // These are variables protected by the mutex.
   node::Mutex mutex;
@@ -511,9 +634,15 @@ class ThreadSafeFunction : public node::AsyncResource {
   std::queue<void*> queue;
   uv_async_t async;
   size_t thread_count;
-  bool is_closing;
+  // Only written with the mutex held, but read without it by Push() when the
+  // queue is unbounded.
+  std::atomic_bool is_closing;
   std::atomic_uchar dispatch_state;
 
+  // Used instead of `queue` when max_queue_size is 0.
+  MPSCQueue lock_free_queue;
+  std::atomic_size_t pending_pushes{0};
+
   // These are variables set once, upon creation, and then never again, which
   // means we don't need the mutex to read them.
   void* context;
@@ -525,7 +654,9 @@ class ThreadSafeFunction : public node::AsyncResource {
   void* finalize_data;
   napi_finalize finalize_cb;
   napi_threadsafe_function_call_js call_js_cb;
+  node_api_threadsafe_function_call_js_batch call_js_batch_cb;
   bool handles_closing;
+  std::vector<void*> batch;
 };
 
 /**
@@ -1172,6 +1303,7 @@ class Work : public node::AsyncResource, public node::ThreadPoolWork {
                 v8::Local<v8::String> async_resource_name,
                 napi_async_execute_callback execute,
                 napi_async_complete_callback complete = nullptr,
+                node_api_async_complete_batch_callback complete_batch = nullptr,
                 void* data = nullptr)
       : AsyncResource(
             env->isolate,
@@ -1181,7 +1313,8 @@ class Work : public node::AsyncResource, public node::ThreadPoolWork {
         _env(env),
         _data(data),
         _execute(execute),
-        _complete(complete) {}
+        _complete(complete),
+        _complete_batch(complete_batch) {}
 
   ~Work() override = default;
 
@@ -1191,9 +1324,15 @@ class Work : public node::AsyncResource, public node::ThreadPoolWork {
                    v8::Local<v8::String> async_resource_name,
                    napi_async_execute_callback execute,
                    napi_async_complete_callback complete,
+                   node_api_async_complete_batch_callback complete_batch,
                    void* data) {
-    return new Work(
-        env, async_resource, async_resource_name, execute, complete, data);
+    return new Work(env,
+                    async_resource,
+                    async_resource_name,
+                    execute,
+                    complete,
+                    complete_batch,
+                    data);
   }
 
   static void Delete(Work* work) { delete work; }
@@ -1201,6 +1340,7 @@ class Work : public node::AsyncResource, public node::ThreadPoolWork {
   void DoThreadPoolWork() override { _execute(_env, _data); }
 
   void AfterThreadPoolWork(int status) override {
+    if (_complete_batch != nullptr) return QueueCompletion(status);
     if (_complete == nullptr) return;
 
     // Establish a handle scope here so that every callback doesn't have to.
@@ -1218,10 +1358,74 @@ class Work : public node::AsyncResource, public node::ThreadPoolWork {
   }
 
  private:
+  // Completions of batched works are collected and delivered from an
+  // immediate, so that all the works that finished in one iteration of the
+  // event loop are reported with one call per callback.
+  void QueueCompletion(int status) {
+    node_napi_env env = _env;
+    env->completed_async_work.push_back(
+        {reinterpret_cast<napi_async_work>(this),
+         _complete_batch,
+         _data,
+         ConvertUVErrorCode(status)});
+    if (env->async_work_delivery_scheduled) return;
+    env->async_work_delivery_scheduled = true;
+    env->Ref();
+    env->node_env()->SetImmediate([env](node::Environment* node_env) {
+      env->async_work_delivery_scheduled = false;
+      DeliverCompletions(env);
+      env->Unref();
+    });
+  }
+
+  static void DeliverCompletions(node_napi_env env) {
+    std::vector<node_napi_env__::CompletedAsyncWork> completed =
+        std::move(env->completed_async_work);
+    env->completed_async_work.clear();
+
+    v8::HandleScope scope(env->isolate);
+    // A callback may delete any of the works, including those of the groups
+    // that are delivered after it, so take what the callback scopes need
+    // from them up front.
+    v8::LocalVector<v8::Object> resources(env->isolate);
+    std::vector<node::async_context> async_contexts;
+    resources.reserve(completed.size());
+    async_contexts.reserve(completed.size());
+    for (const node_napi_env__::CompletedAsyncWork& item : completed) {
+      Work* work = reinterpret_cast<Work*>(item.work);
+      resources.push_back(work->get_resource());
+      async_contexts.push_back(
+          {work->get_async_id(), work->get_trigger_async_id()});
+    }
+
+    std::vector<napi_status> statuses;
+    std::vector<void*> data;
+    for (size_t i = 0; i < completed.size(); i++) {
+      node_api_async_complete_batch_callback complete_batch =
+          completed[i].complete_batch;
+      if (complete_batch == nullptr) continue;
+      statuses.clear();
+      data.clear();
+      for (size_t j = i; j < completed.size(); j++) {
+        if (completed[j].complete_batch != complete_batch) continue;
+        statuses.push_back(completed[j].status);
+        data.push_back(completed[j].data);
+        completed[j].complete_batch = nullptr;
+      }
+
+      node::CallbackScope callback_scope(
+          env->isolate, resources[i], async_contexts[i]);
+      env->CallbackIntoModule<true>([&](napi_env env) {
+        complete_batch(env, statuses.data(), data.data(), data.size());
+      });
+    }
+  }
+
   node_napi_env _env;
   void* _data;
   napi_async_execute_callback _execute;
   napi_async_complete_callback _complete;
+  node_api_async_complete_batch_callback _complete_batch;
 };
 
 }  // end of namespace uvimpl
@@ -1265,6 +1469,45 @@ napi_create_async_work(napi_env env,
                                          resource_name,
                                          execute,
                                          complete,
+                                         nullptr,
+                                         data);
+
+  *result = reinterpret_cast<napi_async_work>(work);
+
+  return napi_clear_last_error(env);
+}
+
+napi_status NAPI_CDECL node_api_create_async_work_batched(
+    napi_env env,
+    napi_value async_resource,
+    napi_value async_resource_name,
+    napi_async_execute_callback execute,
+    node_api_async_complete_batch_callback complete_batch,
+    void* data,
+    napi_async_work* result) {
+  CHECK_ENV_NOT_IN_GC(env);
+  CHECK_ARG(env, execute);
+  CHECK_ARG(env, complete_batch);
+  CHECK_ARG(env, result);
+
+  v8::Local<v8::Context> context = env->context();
+
+  v8::Local<v8::Object> resource;
+  if (async_resource != nullptr) {
+    CHECK_TO_OBJECT(env, context, resource, async_resource);
+  } else {
+    resource = v8::Object::New(env->isolate);
+  }
+
+  v8::Local<v8::String> resource_name;
+  CHECK_TO_STRING(env, context, resource_name, async_resource_name);
+
+  uvimpl::Work* work = uvimpl::Work::New(reinterpret_cast<node_napi_env>(env),
+                                         resource,
+                                         resource_name,
+                                         execute,
+                                         nullptr,
+                                         complete_batch,
                                          data);
 
   *result = reinterpret_cast<napi_async_work>(work);
@@ -1306,6 +1549,37 @@ napi_status NAPI_CDECL napi_queue_async_work(node_api_basic_env env,
   return napi_clear_last_error(env);
 }
 
+napi_status NAPI_CDECL
+node_api_queue_async_work_with_priority(node_api_basic_env env,
+                                        napi_async_work work,
+                                        node_api_async_work_priority priority) {
+  CHECK_ENV(env);
+  CHECK_ARG(env, work);
+
+  uvimpl::Work* w = reinterpret_cast<uvimpl::Work*>(work);
+
+  switch (priority) {
+    case node_api_async_work_priority_default:
+      w->set_kind(node::ThreadPoolWorkKind::kNodeApi);
+      w->set_urgent(false);
+      break;
+    case node_api_async_work_priority_high:
+      w->set_kind(node::ThreadPoolWorkKind::kNodeApi);
+      w->set_urgent(true);
+      break;
+    case node_api_async_work_priority_low:
+      w->set_kind(node::ThreadPoolWorkKind::kNodeApiBulk);
+      w->set_urgent(false);
+      break;
+    default:
+      return napi_set_last_error(env, napi_invalid_arg);
+  }
+
+  w->ScheduleWork();
+
+  return napi_clear_last_error(env);
+}
+
 napi_status NAPI_CDECL napi_cancel_async_work(node_api_basic_env env,
                                               napi_async_work work) {
   CHECK_ENV(env);
@@ -1318,18 +1592,21 @@ napi_status NAPI_CDECL napi_cancel_async_work(node_api_basic_env env,
   return napi_clear_last_error(env);
 }
 
-napi_status NAPI_CDECL
-napi_create_threadsafe_function(napi_env env,
-                                napi_value func,
-                                napi_value async_resource,
-                                napi_value async_resource_name,
-                                size_t max_queue_size,
-                                size_t initial_thread_count,
-                                void* thread_finalize_data,
-                                napi_finalize thread_finalize_cb,
-                                void* context,
-                                napi_threadsafe_function_call_js call_js_cb,
-                                napi_threadsafe_function* result) {
+namespace v8impl {
+
+static napi_status CreateThreadSafeFunction(
+    napi_env env,
+    napi_value func,
+    napi_value async_resource,
+    napi_value async_resource_name,
+    size_t max_queue_size,
+    size_t initial_thread_count,
+    void* thread_finalize_data,
+    napi_finalize thread_finalize_cb,
+    void* context,
+    napi_threadsafe_function_call_js call_js_cb,
+    node_api_threadsafe_function_call_js_batch call_js_batch_cb,
+    napi_threadsafe_function* result) {
   CHECK_ENV_NOT_IN_GC(env);
   CHECK_ARG(env, async_resource_name);
   RETURN_STATUS_IF_FALSE(env, initial_thread_count > 0, napi_invalid_arg);
@@ -1339,7 +1616,9 @@ napi_create_threadsafe_function(napi_env env,
 
   v8::Local<v8::Function> v8_func;
   if (func == nullptr) {
-    CHECK_ARG(env, call_js_cb);
+    RETURN_STATUS_IF_FALSE(env,
+                           call_js_cb != nullptr || call_js_batch_cb != nullptr,
+                           napi_invalid_arg);
   } else {
     CHECK_TO_FUNCTION(env, v8_func, func);
   }
@@ -1366,7 +1645,8 @@ napi_create_threadsafe_function(napi_env env,
                                      reinterpret_cast<node_napi_env>(env),
                                      thread_finalize_data,
                                      thread_finalize_cb,
-                                     call_js_cb);
+                                     call_js_cb,
+                                     call_js_batch_cb);
 
   if (ts_fn == nullptr) {
     status = napi_generic_failure;
@@ -1381,6 +1661,62 @@ napi_create_threadsafe_function(napi_env env,
   return napi_set_last_error(env, status);
 }
 
+}  // end of namespace v8impl
+
+napi_status NAPI_CDECL
+napi_create_threadsafe_function(napi_env env,
+                                napi_value func,
+                                napi_value async_resource,
+                                napi_value async_resource_name,
+                                size_t max_queue_size,
+                                size_t initial_thread_count,
+                                void* thread_finalize_data,
+                                napi_finalize thread_finalize_cb,
+                                void* context,
+                                napi_threadsafe_function_call_js call_js_cb,
+                                napi_threadsafe_function* result) {
+  return v8impl::CreateThreadSafeFunction(env,
+                                          func,
+                                          async_resource,
+                                          async_resource_name,
+                                          max_queue_size,
+                                          initial_thread_count,
+                                          thread_finalize_data,
+                                          thread_finalize_cb,
+                                          context,
+                                          call_js_cb,
+                                          nullptr,
+                                          result);
+}
+
+napi_status NAPI_CDECL node_api_create_threadsafe_function_batched(
+    napi_env env,
+    napi_value func,
+    napi_value async_resource,
+    napi_value async_resource_name,
+    size_t max_queue_size,
+    size_t initial_thread_count,
+    void* thread_finalize_data,
+    napi_finalize thread_finalize_cb,
+    void* context,
+    node_api_threadsafe_function_call_js_batch call_js_batch_cb,
+    napi_threadsafe_function* result) {
+  CHECK_ENV_NOT_IN_GC(env);
+  CHECK_ARG(env, call_js_batch_cb);
+  return v8impl::CreateThreadSafeFunction(env,
+                                          func,
+                                          async_resource,
+                                          async_resource_name,
+                                          max_queue_size,
+                                          initial_thread_count,
+                                          thread_finalize_data,
+                                          thread_finalize_cb,
+                                          context,
+                                          nullptr,
+                                          call_js_batch_cb,
+                                          result);
+}
+
 napi_status NAPI_CDECL napi_get_threadsafe_function_context(
     napi_threadsafe_function func, void** result) {
   CHECK_NOT_NULL(func);
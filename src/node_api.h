@@ -172,6 +172,32 @@ NAPI_EXTERN napi_status NAPI_CDECL napi_queue_async_work(node_api_basic_env env,
 NAPI_EXTERN napi_status NAPI_CDECL
 napi_cancel_async_work(node_api_basic_env env, napi_async_work work);
 
+#ifdef NAPI_EXPERIMENTAL
+#define NODE_API_EXPERIMENTAL_HAS_ASYNC_WORK_BATCH
+
+// Like napi_create_async_work, but `complete_batch` receives the status and
+// data of all works created with the same callback that finished since the
+// last dispatch in a single call, instead of being called once per work. The
+// call runs in the async context of the first work of the batch.
+NAPI_EXTERN napi_status NAPI_CDECL node_api_create_async_work_batched(
+    napi_env env,
+    napi_value async_resource,
+    napi_value async_resource_name,
+    napi_async_execute_callback execute,
+    node_api_async_complete_batch_callback complete_batch,
+    void* data,
+    napi_async_work* result);
+
+// Like napi_queue_async_work. High priority work is queued ahead of other
+// waiting work. Low priority work is accounted and can be limited as the
+// "node_api_bulk" kind of threadpool work, so that bulk jobs do not occupy
+// all the threads needed by latency-sensitive ones.
+NAPI_EXTERN napi_status NAPI_CDECL
+node_api_queue_async_work_with_priority(node_api_basic_env env,
+                                        napi_async_work work,
+                                        node_api_async_work_priority priority);
+#endif  // NAPI_EXPERIMENTAL
+
 // version management
 NAPI_EXTERN napi_status NAPI_CDECL napi_get_node_version(
     node_api_basic_env env, const napi_node_version** version);
@@ -242,6 +268,26 @@ NAPI_EXTERN napi_status NAPI_CDECL napi_unref_threadsafe_function(
 NAPI_EXTERN napi_status NAPI_CDECL napi_ref_threadsafe_function(
     node_api_basic_env env, napi_threadsafe_function func);
 
+#ifdef NAPI_EXPERIMENTAL
+#define NODE_API_EXPERIMENTAL_HAS_THREADSAFE_FUNCTION_BATCH
+
+// Like napi_create_threadsafe_function, but `call_js_batch_cb` receives all
+// items queued since the last dispatch (up to an implementation-defined
+// limit) in a single call, instead of being called once per item.
+NAPI_EXTERN napi_status NAPI_CDECL node_api_create_threadsafe_function_batched(
+    napi_env env,
+    napi_value func,
+    napi_value async_resource,
+    napi_value async_resource_name,
+    size_t max_queue_size,
+    size_t initial_thread_count,
+    void* thread_finalize_data,
+    napi_finalize thread_finalize_cb,
+    void* context,
+    node_api_threadsafe_function_call_js_batch call_js_batch_cb,
+    napi_threadsafe_function* result);
+#endif  // NAPI_EXPERIMENTAL
+
 #endif  // NAPI_VERSION >= 4
 
 #if NAPI_VERSION >= 8
@@ -39,6 +39,17 @@ struct node_napi_env__ : public napi_env__ {
   std::string filename;
   bool destructing = false;
   bool finalization_scheduled = false;
+
+  // Async work created with node_api_create_async_work_batched that has
+  // finished but whose completion has not been delivered yet.
+  struct CompletedAsyncWork {
+    napi_async_work work;
+    node_api_async_complete_batch_callback complete_batch;
+    void* data;
+    napi_status status;
+  };
+  std::vector<CompletedAsyncWork> completed_async_work;
+  bool async_work_delivery_scheduled = false;
 };
 
 using node_napi_env = node_napi_env__*;
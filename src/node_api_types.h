@@ -36,6 +36,24 @@ typedef void(NAPI_CDECL* napi_threadsafe_function_call_js)(
     napi_env env, napi_value js_callback, void* context, void* data);
 #endif  // NAPI_VERSION >= 4
 
+#ifdef NAPI_EXPERIMENTAL
+typedef void(NAPI_CDECL* node_api_threadsafe_function_call_js_batch)(
+    napi_env env,
+    napi_value js_callback,
+    void* context,
+    void** data,
+    size_t count);
+
+typedef void(NAPI_CDECL* node_api_async_complete_batch_callback)(
+    napi_env env, const napi_status* status, void** data, size_t count);
+
+typedef enum {
+  node_api_async_work_priority_default,
+  node_api_async_work_priority_high,
+  node_api_async_work_priority_low,
+} node_api_async_work_priority;
+#endif  // NAPI_EXPERIMENTAL
+
 typedef struct {
   uint32_t major;
   uint32_t minor;
@@ -0,0 +1,168 @@
+#include "node_auto_tune.h"
+#include "node_options.h"
+#include "uv.h"
+#include "v8.h"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <string>
+
+// --auto-tune=container sizes the heap and the thread pools for the memory
+// and CPU quota of the cgroup of the process instead of for the host, since
+// the defaults either get the process OOM-killed or oversubscribe the CPUs
+// in containers.
+
+namespace node {
+namespace auto_tune {
+
+namespace {
+
+constexpr size_t kMB = 1024 * 1024;
+
+// The share of the memory limit that goes to the JavaScript heap. The rest
+// is left to native memory, e.g. Buffers and the code space.
+constexpr uint64_t kHeapShareNumerator = 3;
+constexpr uint64_t kHeapShareDenominator = 4;
+// Workers share the memory limit with the main thread and with each other,
+// so each of them gets this fraction of the heap of the main thread.
+constexpr uint64_t kWorkerHeapShareDenominator = 4;
+
+constexpr size_t kMinSemiSpaceSize = 1 * kMB;
+constexpr size_t kMaxSemiSpaceSize = 16 * kMB;
+constexpr size_t kMinOldGenerationSize = 16 * kMB;
+
+// libuv does not allow for more.
+constexpr unsigned int kMaxThreadpoolSize = 1024;
+// Most of the work on the threadpool blocks on I/O.
+constexpr unsigned int kMinThreadpoolSize = 2;
+
+std::atomic<bool> enabled{false};
+
+HeapSize ComputeHeapSize(uint64_t heap, size_t max_old_generation_size) {
+  HeapSize size;
+  size_t semi_space = static_cast<size_t>(std::clamp<uint64_t>(
+      heap / 256, kMinSemiSpaceSize, kMaxSemiSpaceSize));
+  size.max_young_generation_size = 3 * semi_space;
+  uint64_t old_generation = heap > size.max_young_generation_size
+                                ? heap - size.max_young_generation_size
+                                : 0;
+  old_generation = std::max<uint64_t>(old_generation, kMinOldGenerationSize);
+  if (max_old_generation_size > 0) {
+    old_generation = std::min<uint64_t>(old_generation,
+                                        max_old_generation_size);
+  }
+  size.max_old_generation_size = static_cast<size_t>(
+      std::min<uint64_t>(old_generation, SIZE_MAX / 2));
+  return size;
+}
+
+// The old generation V8 picks for a host with unlimited memory, which
+// accounts for the pointer compression cage.
+size_t MaxOldGenerationSize() {
+  v8::ResourceConstraints constraints;
+  constraints.ConfigureDefaults(std::numeric_limits<uint64_t>::max(), 0);
+  return constraints.max_old_generation_size_in_bytes();
+}
+
+void SetHeapSize(v8::ResourceConstraints* constraints, const HeapSize& size) {
+  constraints->set_max_old_generation_size_in_bytes(
+      size.max_old_generation_size);
+  constraints->set_max_young_generation_size_in_bytes(
+      size.max_young_generation_size);
+}
+
+size_t NearHeapLimit(void* data,
+                     size_t current_heap_limit,
+                     size_t initial_heap_limit) {
+  Tuning tuning = ComputeTuning(GetLimits());
+  return std::max(current_heap_limit, tuning.heap.max_old_generation_size);
+}
+
+// libuv reads UV_THREADPOOL_SIZE only when it starts the threadpool, so
+// start it while the variable is set and remove the variable again
+// afterwards, so that child processes do not inherit it.
+void StartThreadpool(unsigned int size) {
+  std::string value = std::to_string(size);
+  if (uv_os_setenv("UV_THREADPOOL_SIZE", value.c_str()) != 0) return;
+  uv_loop_t loop;
+  if (uv_loop_init(&loop) == 0) {
+    uv_work_t req;
+    if (uv_queue_work(
+            &loop, &req, [](uv_work_t*) {}, [](uv_work_t*, int) {}) == 0) {
+      uv_run(&loop, UV_RUN_DEFAULT);
+    }
+    uv_loop_close(&loop);
+  }
+  uv_os_unsetenv("UV_THREADPOOL_SIZE");
+}
+
+}  // namespace
+
+Limits GetLimits() {
+  uint64_t memory = uv_get_constrained_memory();
+  // The constrained memory can exceed the physical memory, e.g. when the
+  // cgroup has no limit set.
+  if (memory > 0) memory = std::min(memory, uv_get_total_memory());
+  // uv_available_parallelism() applies the CPU quota of the cgroup, too.
+  return Limits{memory,
+                std::max(uv_available_parallelism(), 1u),
+                MaxOldGenerationSize()};
+}
+
+Tuning ComputeTuning(const Limits& limits) {
+  Tuning tuning{};
+  if (limits.memory > 0) {
+    uint64_t heap =
+        limits.memory / kHeapShareDenominator * kHeapShareNumerator;
+    tuning.heap = ComputeHeapSize(heap, limits.max_old_generation_size);
+    tuning.worker_heap = ComputeHeapSize(heap / kWorkerHeapShareDenominator,
+                                         limits.max_old_generation_size);
+  }
+  unsigned int cpus = std::max(limits.cpus, 1u);
+  tuning.threadpool_size =
+      std::clamp(cpus, kMinThreadpoolSize, kMaxThreadpoolSize);
+  // Leave a CPU to the main thread.
+  tuning.platform_worker_count = static_cast<int>(std::max(cpus - 1, 1u));
+  return tuning;
+}
+
+bool IsEnabled() {
+  return enabled.load(std::memory_order_relaxed);
+}
+
+void ConfigureProcess(PerProcessOptions* options) {
+  enabled.store(true, std::memory_order_relaxed);
+  Tuning tuning = ComputeTuning(GetLimits());
+
+  // A negative size means that --v8-pool-size has not been passed.
+  if (options->v8_thread_pool_size < 0)
+    options->v8_thread_pool_size = tuning.platform_worker_count;
+
+  char value[16];
+  size_t size = sizeof(value);
+  if (uv_os_getenv("UV_THREADPOOL_SIZE", value, &size) == UV_ENOENT)
+    StartThreadpool(tuning.threadpool_size);
+}
+
+bool ConfigureHeap(v8::ResourceConstraints* constraints) {
+  Tuning tuning = ComputeTuning(GetLimits());
+  if (tuning.heap.max_old_generation_size == 0) return false;
+  SetHeapSize(constraints, tuning.heap);
+  return true;
+}
+
+bool ConfigureWorkerHeap(v8::ResourceConstraints* constraints) {
+  if (!IsEnabled()) return false;
+  Tuning tuning = ComputeTuning(GetLimits());
+  if (tuning.worker_heap.max_old_generation_size == 0) return false;
+  SetHeapSize(constraints, tuning.worker_heap);
+  return true;
+}
+
+void SetUpIsolate(v8::Isolate* isolate) {
+  isolate->AddNearHeapLimitCallback(NearHeapLimit, nullptr);
+}
+
+}  // namespace auto_tune
+}  // namespace node
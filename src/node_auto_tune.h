@@ -0,0 +1,75 @@
+#ifndef SRC_NODE_AUTO_TUNE_H_
+#define SRC_NODE_AUTO_TUNE_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include <cstddef>
+#include <cstdint>
+
+namespace v8 {
+class Isolate;
+class ResourceConstraints;
+}  // namespace v8
+
+namespace node {
+
+class PerProcessOptions;
+
+namespace auto_tune {
+
+// The resources available to the process, taking the limits of its cgroup
+// into account.
+struct Limits {
+  uint64_t memory;    // The memory limit in bytes, 0 if there is none.
+  unsigned int cpus;  // At least 1.
+  // The largest old generation V8 configures by itself, 0 if unbounded.
+  size_t max_old_generation_size = 0;
+};
+
+struct HeapSize {
+  size_t max_old_generation_size;
+  // Includes both semi-spaces, V8 sizes the semi-space as a third of it.
+  size_t max_young_generation_size;
+};
+
+struct Tuning {
+  HeapSize heap;         // For the main thread's isolate.
+  HeapSize worker_heap;  // For each Worker's isolate.
+  unsigned int threadpool_size;
+  int platform_worker_count;
+};
+
+Limits GetLimits();
+
+// Sizes the heaps and the thread pools for `limits`. Without a memory
+// limit, the heap sizes are 0, i.e. are left to V8.
+Tuning ComputeTuning(const Limits& limits);
+
+// Whether --auto-tune=container is in effect.
+bool IsEnabled();
+
+// Enables the tuning for the process and sizes the libuv threadpool and the
+// platform's worker threads, unless UV_THREADPOOL_SIZE or --v8-pool-size
+// have been set. Must be called before the platform is initialized and
+// before anything is queued to the libuv threadpool.
+void ConfigureProcess(PerProcessOptions* options);
+
+// Sizes the heap of a new isolate for the memory limit of the process.
+// Returns false, leaving `constraints` alone, if there is no memory limit.
+bool ConfigureHeap(v8::ResourceConstraints* constraints);
+
+// Like ConfigureHeap(), for the isolate of a Worker, which gets a share of
+// the memory limit only.
+bool ConfigureWorkerHeap(v8::ResourceConstraints* constraints);
+
+// Raises the heap limit of `isolate` when it is reached after the memory
+// limit of the cgroup has been raised. Heap limits can not be lowered, so
+// lowering the memory limit only affects isolates created afterwards.
+void SetUpIsolate(v8::Isolate* isolate);
+
+}  // namespace auto_tune
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_NODE_AUTO_TUNE_H_
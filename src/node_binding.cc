@@ -65,6 +65,7 @@
   V(mksnapshot)                                                                \
   V(options)                                                                   \
   V(os)                                                                        \
+  V(path)                                                                      \
   V(performance)                                                               \
   V(permission)                                                                \
   V(pipe_wrap)                                                                 \
@@ -73,7 +74,9 @@
   V(report)                                                                    \
   V(sea)                                                                       \
   V(serdes)                                                                    \
+  V(shm)                                                                       \
   V(signal_wrap)                                                               \
+  V(source_map)                                                                \
   V(spawn_sync)                                                                \
   V(stream_pipe)                                                               \
   V(stream_wrap)                                                               \
@@ -10,6 +10,7 @@
 #include "node_file.h"
 #include "path.h"
 #include "permission/permission.h"
+#include "stream_base-inl.h"
 #include "util.h"
 #include "v8.h"
 
@@ -27,10 +28,12 @@ using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
 using v8::Global;
 using v8::HandleScope;
+using v8::Integer;
 using v8::Int32;
 using v8::Isolate;
 using v8::Local;
 using v8::NewStringType;
+using v8::Number;
 using v8::Object;
 using v8::ObjectTemplate;
 using v8::SnapshotCreator;
@@ -95,6 +98,23 @@ void Concat(const FunctionCallbackInfo<Value>& args) {
   args.GetReturnValue().Set(ArrayBuffer::New(env->isolate(), std::move(store)));
 }
 
+// setMemoryBudget(bytes), where a negative value lifts the limit.
+void SetMemoryBudget(const FunctionCallbackInfo<Value>& args) {
+  Realm* realm = Realm::GetCurrent(args);
+  CHECK(args[0]->IsNumber());
+  double value = args[0].As<Number>()->Value();
+  uint64_t limit = value < 0 ? UINT64_MAX : static_cast<uint64_t>(value);
+  BlobBindingData* binding_data = realm->GetBindingData<BlobBindingData>();
+  // Keep the existing budget, which the live entries are charged to.
+  if (binding_data->memory_budget) {
+    binding_data->memory_budget->set_limit(limit);
+  } else {
+    binding_data->memory_budget =
+        std::make_shared<DataQueue::MemoryBudget>(limit);
+  }
+}
+
+// createBlobFromFilePath(path[, readahead])
 void BlobFromFilePath(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
   BufferValue path(env->isolate(), args[0]);
@@ -102,7 +122,16 @@ void BlobFromFilePath(const FunctionCallbackInfo<Value>& args) {
   ToNamespacedPath(env, &path);
   THROW_IF_INSUFFICIENT_PERMISSIONS(
       env, permission::PermissionScope::kFileSystemRead, path.ToStringView());
-  auto entry = DataQueue::CreateFdEntry(env, args[0]);
+  uint64_t readahead = DataQueue::kDefaultFdReadahead;
+  if (args.Length() > 1 && args[1]->IsNumber()) {
+    // Clamp before converting, NaN and out of range values are undefined
+    // behavior for the cast. NaN and negative values disable readahead.
+    double value = args[1].As<Number>()->Value();
+    readahead = value > 0 ? static_cast<uint64_t>(std::min(
+                                value, static_cast<double>(kMaxSafeJsInteger)))
+                          : 0;
+  }
+  auto entry = DataQueue::CreateFdEntry(env, args[0], readahead);
   if (entry == nullptr) {
     return THROW_ERR_INVALID_ARG_VALUE(env, "Unable to open file as blob");
   }
@@ -132,6 +161,7 @@ void Blob::CreatePerIsolateProperties(IsolateData* isolate_data,
   SetMethod(isolate, target, "revokeObjectURL", RevokeObjectURL);
   SetMethod(isolate, target, "concat", Concat);
   SetMethod(isolate, target, "createBlobFromFilePath", BlobFromFilePath);
+  SetMethod(isolate, target, "setMemoryBudget", SetMemoryBudget);
 }
 
 void Blob::CreatePerContextProperties(Local<Object> target,
@@ -153,6 +183,7 @@ Local<FunctionTemplate> Blob::GetConstructorTemplate(Environment* env) {
         FIXED_ONE_BYTE_STRING(env->isolate(), "Blob"));
     SetProtoMethod(isolate, tmpl, "getReader", GetReader);
     SetProtoMethod(isolate, tmpl, "slice", ToSlice);
+    SetProtoMethod(isolate, tmpl, "writeTo", WriteTo);
     env->set_blob_constructor_template(tmpl);
   }
   return tmpl;
@@ -185,6 +216,10 @@ void Blob::New(const FunctionCallbackInfo<Value>& args) {
 
   Local<Array> array = args[0].As<Array>();
   std::vector<std::unique_ptr<DataQueue::Entry>> entries(array->Length());
+  std::shared_ptr<DataQueue::MemoryBudget> budget =
+      Realm::GetCurrent(context)
+          ->GetBindingData<BlobBindingData>()
+          ->memory_budget;
 
   std::vector<Global<Value>> sources;
   if (FromV8Array(context, array, &sources).IsNothing()) {
@@ -195,18 +230,29 @@ void Blob::New(const FunctionCallbackInfo<Value>& args) {
   for (size_t i = 0; i < count; i++) {
     Local<Value> entry = sources[i].Get(isolate);
 
-    auto entryFromArrayBuffer =
-        [isolate](Local<ArrayBuffer> buf,
-                  size_t byte_length,
-                  size_t byte_offset =
-                      0) mutable -> std::unique_ptr<DataQueue::Entry> {
+    auto entryFromArrayBuffer = [isolate, env, &budget](
+                                    Local<ArrayBuffer> buf,
+                                    size_t byte_length,
+                                    size_t byte_offset = 0) mutable
+        -> std::unique_ptr<DataQueue::Entry> {
+      if (budget && byte_length >= BlobBindingData::kMinSpillSize &&
+          !budget->Fits(byte_length)) {
+        // Over budget: keep the part on disk instead. If that fails, fall
+        // back to holding it in memory.
+        const uint8_t* ptr = static_cast<uint8_t*>(buf->Data()) + byte_offset;
+        if (auto entry =
+                DataQueue::CreateTempFileEntry(env, ptr, byte_length)) {
+          return entry;
+        }
+      }
+
       if (buf->IsDetachable()) {
         std::shared_ptr<BackingStore> store = buf->GetBackingStore();
         if (buf->Detach(Local<Value>()).IsNothing()) {
           return nullptr;
         }
         return DataQueue::CreateInMemoryEntryFromBackingStore(
-            std::move(store), byte_offset, byte_length);
+            std::move(store), byte_offset, byte_length, budget);
       }
 
       // If the ArrayBuffer is not detachable, we will copy from it instead.
@@ -215,7 +261,7 @@ void Blob::New(const FunctionCallbackInfo<Value>& args) {
       uint8_t* ptr = static_cast<uint8_t*>(buf->Data()) + byte_offset;
       std::copy(ptr, ptr + byte_length, static_cast<uint8_t*>(store->Data()));
       return DataQueue::CreateInMemoryEntryFromBackingStore(
-          std::move(store), 0, byte_length);
+          std::move(store), 0, byte_length, budget);
     };
 
     // Every entry should be either an ArrayBuffer, ArrayBufferView, or Blob.
@@ -262,6 +308,20 @@ void Blob::GetReader(const FunctionCallbackInfo<Value>& args) {
   if (reader) args.GetReturnValue().Set(reader->object());
 }
 
+// writer = blob.writeTo(streamHandle)
+void Blob::WriteTo(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Blob* blob;
+  ASSIGN_OR_RETURN_UNWRAP(&blob, args.This());
+  CHECK(args[0]->IsObject());
+  StreamBase* sink = StreamBase::FromObject(args[0].As<Object>());
+  CHECK_NOT_NULL(sink);
+
+  BaseObjectPtr<Blob::StreamWriter> writer =
+      Blob::StreamWriter::Create(env, BaseObjectPtr<Blob>(blob), sink);
+  if (writer) args.GetReturnValue().Set(writer->object());
+}
+
 void Blob::ToSlice(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
   Blob* blob;
@@ -401,6 +461,196 @@ void Blob::Reader::Pull(const FunctionCallbackInfo<Value>& args) {
       std::move(next), node::bob::OPTIONS_END, nullptr, 0));
 }
 
+Blob::StreamWriter::StreamWriter(Environment* env,
+                                 Local<Object> obj,
+                                 BaseObjectPtr<Blob> strong_ptr,
+                                 StreamBase* sink)
+    : AsyncWrap(env, obj, AsyncWrap::PROVIDER_BLOBREADER),
+      inner_(strong_ptr->data_queue_->get_reader()),
+      strong_ptr_(std::move(strong_ptr)),
+      sink_(sink) {
+  MakeWeak();
+}
+
+Blob::StreamWriter::~StreamWriter() {
+  if (pending_done_) std::move(pending_done_)(0);
+}
+
+Local<FunctionTemplate> Blob::StreamWriter::GetConstructorTemplate(
+    Environment* env) {
+  Local<FunctionTemplate> tmpl =
+      env->blob_stream_writer_constructor_template();
+  if (tmpl.IsEmpty()) {
+    Isolate* isolate = env->isolate();
+    tmpl = NewFunctionTemplate(isolate, nullptr);
+    tmpl->Inherit(AsyncWrap::GetConstructorTemplate(env));
+    tmpl->InstanceTemplate()->SetInternalFieldCount(
+        BaseObject::kInternalFieldCount);
+    tmpl->SetClassName(
+        FIXED_ONE_BYTE_STRING(env->isolate(), "BlobStreamWriter"));
+    SetProtoMethod(env->isolate(), tmpl, "start", Start);
+    env->set_blob_stream_writer_constructor_template(tmpl);
+  }
+  return tmpl;
+}
+
+BaseObjectPtr<Blob::StreamWriter> Blob::StreamWriter::Create(
+    Environment* env, BaseObjectPtr<Blob> blob, StreamBase* sink) {
+  Local<Object> obj;
+  if (!GetConstructorTemplate(env)
+           ->InstanceTemplate()
+           ->NewInstance(env->context())
+           .ToLocal(&obj)) {
+    return nullptr;
+  }
+
+  // Keep the sink alive for as long as the writer is.
+  if (obj->Set(env->context(), env->sink_string(), sink->GetObject())
+          .IsNothing()) {
+    return nullptr;
+  }
+
+  return MakeBaseObject<Blob::StreamWriter>(env, obj, std::move(blob), sink);
+}
+
+void Blob::StreamWriter::Start(const FunctionCallbackInfo<Value>& args) {
+  Blob::StreamWriter* writer;
+  ASSIGN_OR_RETURN_UNWRAP(&writer, args.This());
+  CHECK(!writer->started_);
+  writer->started_ = true;
+  // Stay alive until oncomplete has been called.
+  writer->ClearWeak();
+
+  if (!writer->sink_->IsAlive() || writer->inner_ == nullptr) {
+    return writer->Finish(UV_EPIPE);
+  }
+  writer->sink_->PushStreamListener(writer);
+  writer->Pump();
+}
+
+void Blob::StreamWriter::Pump() {
+  if (pumping_) return;
+  pumping_ = true;
+  BaseObjectPtr<StreamWriter> strong_ref{this};
+  while (!pulling_ && !writing_ && !finished_) {
+    pulling_ = true;
+    inner_->Pull(
+        [strong_ref](int status,
+                     const DataQueue::Vec* vecs,
+                     size_t count,
+                     bob::Done done) {
+          strong_ref->OnPull(status, vecs, count, std::move(done));
+        },
+        bob::OPTIONS_END,
+        nullptr,
+        0);
+  }
+  pumping_ = false;
+}
+
+void Blob::StreamWriter::OnPull(int status,
+                                const DataQueue::Vec* vecs,
+                                size_t count,
+                                bob::Done done) {
+  pulling_ = false;
+  if (finished_) return std::move(done)(0);
+
+  if (status == bob::STATUS_EOS && count == 0) {
+    std::move(done)(0);
+    return Finish(0);
+  }
+  if (status < 0) {
+    std::move(done)(0);
+    return Finish(status);
+  }
+
+  if (count > 0) {
+    HandleScope handle_scope(env()->isolate());
+    Context::Scope context_scope(env()->context());
+
+    MaybeStackBuffer<uv_buf_t, 16> bufs(count);
+    uint64_t total = 0;
+    for (size_t n = 0; n < count; n++) {
+      bufs[n] = uv_buf_init(reinterpret_cast<char*>(vecs[n].base),
+                            static_cast<unsigned int>(vecs[n].len));
+      total += vecs[n].len;
+    }
+
+    StreamWriteResult res = sink_->Write(*bufs, count);
+    if (res.err != 0) {
+      std::move(done)(0);
+      return Finish(res.err);
+    }
+    bytes_written_ += total;
+    if (res.async) {
+      // The buffers must outlive the write.
+      writing_ = true;
+      pending_done_ = std::move(done);
+    } else {
+      std::move(done)(total);
+    }
+  } else {
+    std::move(done)(0);
+  }
+
+  if (status == bob::STATUS_EOS && !writing_) return Finish(0);
+  if (status == bob::STATUS_EOS) {
+    // Finish once the last write is done.
+    inner_.reset();
+    return;
+  }
+
+  // Pulls that complete asynchronously need to restart the loop.
+  Pump();
+}
+
+void Blob::StreamWriter::Finish(int status) {
+  if (finished_) return;
+  finished_ = true;
+  if (stream() != nullptr) sink_->RemoveStreamListener(this);
+  inner_.reset();
+
+  BaseObjectPtr<StreamWriter> strong_ref{this};
+  MakeWeak();
+
+  Environment* env = this->env();
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+  Local<Value> argv[] = {
+      Integer::New(env->isolate(), status),
+      Number::New(env->isolate(), static_cast<double>(bytes_written_)),
+  };
+  MakeCallback(env->oncomplete_string(), arraysize(argv), argv);
+}
+
+uv_buf_t Blob::StreamWriter::OnStreamAlloc(size_t suggested_size) {
+  CHECK_NOT_NULL(previous_listener_);
+  return previous_listener_->OnStreamAlloc(suggested_size);
+}
+
+void Blob::StreamWriter::OnStreamRead(ssize_t nread, const uv_buf_t& buf) {
+  CHECK_NOT_NULL(previous_listener_);
+  return previous_listener_->OnStreamRead(nread, buf);
+}
+
+void Blob::StreamWriter::OnStreamAfterWrite(WriteWrap* w, int status) {
+  if (!writing_) {
+    // Not one of ours.
+    CHECK_NOT_NULL(previous_listener_);
+    return previous_listener_->OnStreamAfterWrite(w, status);
+  }
+  writing_ = false;
+  if (pending_done_) std::move(pending_done_)(0);
+  if (status != 0) return Finish(status);
+  if (inner_ == nullptr) return Finish(0);
+  Pump();
+}
+
+void Blob::StreamWriter::OnStreamDestroy() {
+  writing_ = false;
+  Finish(UV_EPIPE);
+}
+
 BaseObjectPtr<BaseObject>
 Blob::BlobTransferData::Deserialize(
     Environment* env,
@@ -577,6 +827,8 @@ InternalFieldInfoBase* BlobBindingData::Serialize(int index) {
 void Blob::RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(Blob::New);
   registry->Register(Blob::GetReader);
+  registry->Register(Blob::WriteTo);
+  registry->Register(Blob::StreamWriter::Start);
   registry->Register(Blob::ToSlice);
   registry->Register(Blob::StoreDataObject);
   registry->Register(Blob::GetDataObject);
@@ -584,6 +836,7 @@ void Blob::RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(Blob::Reader::Pull);
   registry->Register(Concat);
   registry->Register(BlobFromFilePath);
+  registry->Register(SetMemoryBudget);
 }
 
 }  // namespace node
@@ -13,6 +13,7 @@
 #include "node_internals.h"
 #include "node_snapshotable.h"
 #include "node_worker.h"
+#include "stream_base.h"
 #include "v8.h"
 
 #include <string>
@@ -35,6 +36,7 @@ class Blob : public BaseObject {
 
   static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void GetReader(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void WriteTo(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void ToSlice(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void StoreDataObject(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void GetDataObject(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -97,6 +99,57 @@ class Blob : public BaseObject {
     bool eos_ = false;
   };
 
+  // Writes the contents of a Blob to a StreamBase, passing the buffers
+  // produced by the DataQueue reader straight to the stream without
+  // copying them or going through JS. Calls oncomplete(status, bytes) on
+  // the JS object once everything has been written or writing failed.
+  // While active, the writer must be the only one writing to the stream.
+  class StreamWriter final : public AsyncWrap, public StreamListener {
+   public:
+    static v8::Local<v8::FunctionTemplate> GetConstructorTemplate(
+        Environment* env);
+    static BaseObjectPtr<StreamWriter> Create(Environment* env,
+                                              BaseObjectPtr<Blob> blob,
+                                              StreamBase* sink);
+    static void Start(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+    StreamWriter(Environment* env,
+                 v8::Local<v8::Object> obj,
+                 BaseObjectPtr<Blob> strong_ptr,
+                 StreamBase* sink);
+    ~StreamWriter() override;
+
+    // StreamListener interface, for the sink.
+    uv_buf_t OnStreamAlloc(size_t suggested_size) override;
+    void OnStreamRead(ssize_t nread, const uv_buf_t& buf) override;
+    void OnStreamAfterWrite(WriteWrap* w, int status) override;
+    void OnStreamDestroy() override;
+
+    SET_NO_MEMORY_INFO()
+    SET_MEMORY_INFO_NAME(Blob::StreamWriter)
+    SET_SELF_SIZE(StreamWriter)
+
+   private:
+    void Pump();
+    void OnPull(int status,
+                const DataQueue::Vec* vecs,
+                size_t count,
+                bob::Done done);
+    void Finish(int status);
+
+    std::shared_ptr<DataQueue::Reader> inner_;
+    BaseObjectPtr<Blob> strong_ptr_;
+    StreamBase* sink_;
+    // Releases the buffers of the write in progress.
+    bob::Done pending_done_;
+    uint64_t bytes_written_ = 0;
+    bool started_ = false;
+    bool pumping_ = false;
+    bool pulling_ = false;
+    bool writing_ = false;
+    bool finished_ = false;
+  };
+
   BaseObject::TransferMode GetTransferMode() const override;
   std::unique_ptr<worker::TransferData> CloneForMessaging() const override;
 
@@ -149,6 +202,12 @@ class BlobBindingData : public SnapshotableObject {
 
   StoredDataObject get_data_object(const std::string& uuid);
 
+  // Once the in-memory parts of the Blobs created in this realm exceed the
+  // budget, further parts of at least kMinSpillSize bytes are written to
+  // temporary files instead. Unset by default.
+  static constexpr size_t kMinSpillSize = 64 * 1024;
+  std::shared_ptr<DataQueue::MemoryBudget> memory_budget;
+
  private:
   std::unordered_map<std::string, StoredDataObject> data_objects_;
 };
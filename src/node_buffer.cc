@@ -29,8 +29,10 @@
 #include "node_internals.h"
 
 #include "env-inl.h"
+#include "hex_encoding.h"
 #include "simdutf.h"
 #include "string_bytes.h"
+#include "string_search.h"
 
 #include "util-inl.h"
 #include "v8-fast-api-calls.h"
@@ -550,6 +552,52 @@ void StringSlice(const FunctionCallbackInfo<Value>& args) {
   }
 }
 
+// Like latin1Slice(), but hands the memory of the underlying ArrayBuffer to
+// the returned string instead of copying it, so that large payloads are not
+// held twice. The ArrayBuffer is then detached, which empties this Buffer.
+// Payloads that are too small to be stored externally, Buffers that do not
+// span their whole ArrayBuffer, like the slices of the Buffer pool, and
+// non-detachable ArrayBuffers are copied and left alone.
+void Latin1SliceTransfer(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Isolate* isolate = env->isolate();
+
+  THROW_AND_RETURN_UNLESS_BUFFER(env, args.This());
+  Local<ArrayBufferView> view = args.This().As<ArrayBufferView>();
+  const size_t view_length = view->ByteLength();
+
+  if (view_length == 0) return args.GetReturnValue().SetEmptyString();
+
+  size_t start = 0;
+  size_t end = 0;
+  THROW_AND_RETURN_IF_OOB(ParseArrayIndex(env, args[0], 0, &start));
+  THROW_AND_RETURN_IF_OOB(ParseArrayIndex(env, args[1], view_length, &end));
+  if (end < start) end = start;
+  THROW_AND_RETURN_IF_OOB(Just(end <= view_length));
+  size_t length = end - start;
+
+  Local<ArrayBuffer> ab = view->Buffer();
+  Local<Value> ret;
+  if (!ab->IsDetachable() || !StringBytes::IsExternalLatin1Length(length) ||
+      view->ByteOffset() != 0 || view_length != ab->ByteLength()) {
+    ArrayBufferViewContents<char> buffer(view);
+    if (StringBytes::Encode(isolate, buffer.data() + start, length, LATIN1)
+            .ToLocal(&ret)) {
+      args.GetReturnValue().Set(ret);
+    }
+    return;
+  }
+
+  std::shared_ptr<BackingStore> store = ab->GetBackingStore();
+  const size_t offset = view->ByteOffset() + start;
+  if (ab->Detach(Local<Value>()).IsNothing()) return;
+  if (StringBytes::EncodeLatin1External(
+          isolate, std::move(store), offset, length)
+          .ToLocal(&ret)) {
+    args.GetReturnValue().Set(ret);
+  }
+}
+
 void CopyImpl(Local<Value> source_obj,
               Local<Value> target_obj,
               const uint32_t target_start,
@@ -592,6 +640,34 @@ uint32_t FastCopy(Local<Value> receiver,
 
 static CFunction fast_copy(CFunction::Make(FastCopy));
 
+// Assume caller has properly validated args. V8 only takes this path when
+// |value| is a number, which covers buf.fill(0) and Buffer.alloc(); strings
+// and buffers still go through Fill().
+int32_t FastFill(Local<Value> receiver,
+                 Local<Value> buffer_obj,
+                 uint32_t value,
+                 uint32_t start,
+                 uint32_t end,
+                 Local<Value> encoding,
+                 // NOLINTNEXTLINE(runtime/references)
+                 FastApiCallbackOptions& options) {
+  HandleScope scope(options.isolate);
+  if (!Buffer::HasInstance(buffer_obj)) {
+    THROW_ERR_INVALID_ARG_TYPE(options.isolate, "argument must be a buffer");
+    return 0;
+  }
+  SPREAD_BUFFER_ARG(buffer_obj, ts_obj);
+
+  // OOB Check. Throw the error in JS.
+  if (start > end || end > ts_obj_length) return -2;
+
+  TRACK_V8_FAST_API_CALL("buffer.fill");
+  memset(ts_obj_data + start, value & 255, end - start);
+  return 0;
+}
+
+static CFunction fast_fill(CFunction::Make(FastFill));
+
 void Fill(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
   Local<Context> ctx = env->context();
@@ -991,20 +1067,21 @@ void IndexOfString(const FunctionCallbackInfo<Value>& args) {
       if (decoded_string == nullptr)
         return args.GetReturnValue().Set(-1);
 
-      result = nbytes::SearchString(reinterpret_cast<const uint16_t*>(haystack),
-                                    haystack_length / 2,
-                                    decoded_string,
-                                    decoder.size() / 2,
-                                    offset / 2,
-                                    is_forward);
+      result = string_search::SearchString(
+          reinterpret_cast<const uint16_t*>(haystack),
+          haystack_length / 2,
+          decoded_string,
+          decoder.size() / 2,
+          offset / 2,
+          is_forward);
     } else {
-      result =
-          nbytes::SearchString(reinterpret_cast<const uint16_t*>(haystack),
-                               haystack_length / 2,
-                               reinterpret_cast<const uint16_t*>(*needle_value),
-                               needle_value.length(),
-                               offset / 2,
-                               is_forward);
+      result = string_search::SearchString(
+          reinterpret_cast<const uint16_t*>(haystack),
+          haystack_length / 2,
+          reinterpret_cast<const uint16_t*>(*needle_value),
+          needle_value.length(),
+          offset / 2,
+          is_forward);
     }
     result *= 2;
   } else if (enc == UTF8) {
@@ -1012,13 +1089,13 @@ void IndexOfString(const FunctionCallbackInfo<Value>& args) {
     if (*needle_value == nullptr)
       return args.GetReturnValue().Set(-1);
 
-    result =
-        nbytes::SearchString(reinterpret_cast<const uint8_t*>(haystack),
-                             haystack_length,
-                             reinterpret_cast<const uint8_t*>(*needle_value),
-                             needle_length,
-                             offset,
-                             is_forward);
+    result = string_search::SearchString(
+        reinterpret_cast<const uint8_t*>(haystack),
+        haystack_length,
+        reinterpret_cast<const uint8_t*>(*needle_value),
+        needle_length,
+        offset,
+        is_forward);
   } else if (enc == LATIN1) {
     uint8_t* needle_data = node::UncheckedMalloc<uint8_t>(needle_length);
     if (needle_data == nullptr) {
@@ -1027,12 +1104,13 @@ void IndexOfString(const FunctionCallbackInfo<Value>& args) {
     needle->WriteOneByte(
         isolate, needle_data, 0, needle_length, String::NO_NULL_TERMINATION);
 
-    result = nbytes::SearchString(reinterpret_cast<const uint8_t*>(haystack),
-                                  haystack_length,
-                                  needle_data,
-                                  needle_length,
-                                  offset,
-                                  is_forward);
+    result = string_search::SearchString(
+        reinterpret_cast<const uint8_t*>(haystack),
+        haystack_length,
+        needle_data,
+        needle_length,
+        offset,
+        is_forward);
     free(needle_data);
   }
 
@@ -1091,20 +1169,22 @@ void IndexOfBuffer(const FunctionCallbackInfo<Value>& args) {
     if (haystack_length < 2 || needle_length < 2) {
       return args.GetReturnValue().Set(-1);
     }
-    result = nbytes::SearchString(reinterpret_cast<const uint16_t*>(haystack),
-                                  haystack_length / 2,
-                                  reinterpret_cast<const uint16_t*>(needle),
-                                  needle_length / 2,
-                                  offset / 2,
-                                  is_forward);
+    result = string_search::SearchString(
+        reinterpret_cast<const uint16_t*>(haystack),
+        haystack_length / 2,
+        reinterpret_cast<const uint16_t*>(needle),
+        needle_length / 2,
+        offset / 2,
+        is_forward);
     result *= 2;
   } else {
-    result = nbytes::SearchString(reinterpret_cast<const uint8_t*>(haystack),
-                                  haystack_length,
-                                  reinterpret_cast<const uint8_t*>(needle),
-                                  needle_length,
-                                  offset,
-                                  is_forward);
+    result = string_search::SearchString(
+        reinterpret_cast<const uint8_t*>(haystack),
+        haystack_length,
+        reinterpret_cast<const uint8_t*>(needle),
+        needle_length,
+        offset,
+        is_forward);
   }
 
   args.GetReturnValue().Set(
@@ -1458,6 +1538,22 @@ uint32_t WriteOneByteString(const char* src,
     const auto size = std::min(src_len, dst_len);
     memcpy(dst, src, size);
     return size;
+  } else if constexpr (encoding == HEX) {
+    return hex_encoding::Decode(dst, dst_len, src, src_len);
+  } else if constexpr (encoding == BASE64 || encoding == BASE64URL) {
+    size_t written_len = dst_len;
+    auto result = simdutf::base64_to_binary_safe(
+        src,
+        src_len,
+        dst,
+        written_len,
+        encoding == BASE64URL ? simdutf::base64_url : simdutf::base64_default);
+    if (result.error == simdutf::error_code::SUCCESS) {
+      return written_len;
+    }
+    // The input does not follow the WHATWG forgiving-base64 specification
+    // https://infra.spec.whatwg.org/#forgiving-base64-decode
+    return nbytes::Base64Decode(dst, dst_len, src, src_len);
   } else {
     // TODO(ronag): Add support for more encoding.
     UNREACHABLE();
@@ -1532,6 +1628,43 @@ static const CFunction fast_write_string_latin1(
 static const CFunction fast_write_string_utf8(
     CFunction::Make(FastWriteString<UTF8>));
 
+// Fast version of StringWrite(), i.e. the hexWrite() and base64Write()
+// methods on Buffer.prototype. Only one-byte strings can take this path.
+template <encoding encoding>
+uint32_t FastStringWrite(Local<Value> receiver,
+                         const FastOneByteString& src,
+                         uint32_t offset,
+                         uint32_t max_length,
+                         // NOLINTNEXTLINE(runtime/references)
+                         FastApiCallbackOptions& options) {
+  HandleScope handle_scope(options.isolate);
+  if (!Buffer::HasInstance(receiver)) {
+    THROW_ERR_INVALID_ARG_TYPE(options.isolate, "argument must be a buffer");
+    return 0;
+  }
+  SPREAD_BUFFER_ARG(receiver, dst);
+  if (offset > dst_length) {
+    THROW_ERR_BUFFER_OUT_OF_BOUNDS(options.isolate,
+                                   "\"offset\" is outside of buffer bounds");
+    return 0;
+  }
+  CHECK(dst_length - offset <= std::numeric_limits<uint32_t>::max());
+  TRACK_V8_FAST_API_CALL("buffer.stringWrite");
+
+  return WriteOneByteString<encoding>(
+      src.data,
+      src.length,
+      dst_data + offset,
+      std::min<uint32_t>(dst_length - offset, max_length));
+}
+
+static const CFunction fast_string_write_base64(
+    CFunction::Make(FastStringWrite<BASE64>));
+static const CFunction fast_string_write_base64url(
+    CFunction::Make(FastStringWrite<BASE64URL>));
+static const CFunction fast_string_write_hex(
+    CFunction::Make(FastStringWrite<HEX>));
+
 void Initialize(Local<Object> target,
                 Local<Value> unused,
                 Local<Context> context,
@@ -1552,7 +1685,7 @@ void Initialize(Local<Object> target,
   SetFastMethod(context, target, "copy", SlowCopy, &fast_copy);
   SetFastMethodNoSideEffect(context, target, "compare", Compare, &fast_compare);
   SetMethodNoSideEffect(context, target, "compareOffset", CompareOffset);
-  SetMethod(context, target, "fill", Fill);
+  SetFastMethod(context, target, "fill", Fill, &fast_fill);
   SetMethodNoSideEffect(context, target, "indexOfBuffer", IndexOfBuffer);
   SetFastMethodNoSideEffect(context,
                             target,
@@ -1590,10 +1723,20 @@ void Initialize(Local<Object> target,
   SetMethodNoSideEffect(context, target, "hexSlice", StringSlice<HEX>);
   SetMethodNoSideEffect(context, target, "ucs2Slice", StringSlice<UCS2>);
   SetMethodNoSideEffect(context, target, "utf8Slice", StringSlice<UTF8>);
+  SetMethod(context, target, "latin1SliceTransfer", Latin1SliceTransfer);
 
-  SetMethod(context, target, "base64Write", StringWrite<BASE64>);
-  SetMethod(context, target, "base64urlWrite", StringWrite<BASE64URL>);
-  SetMethod(context, target, "hexWrite", StringWrite<HEX>);
+  SetFastMethod(context,
+                target,
+                "base64Write",
+                StringWrite<BASE64>,
+                &fast_string_write_base64);
+  SetFastMethod(context,
+                target,
+                "base64urlWrite",
+                StringWrite<BASE64URL>,
+                &fast_string_write_base64url);
+  SetFastMethod(
+      context, target, "hexWrite", StringWrite<HEX>, &fast_string_write_hex);
   SetMethod(context, target, "ucs2Write", StringWrite<UCS2>);
 
   SetFastMethod(context,
@@ -1631,6 +1774,8 @@ void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(fast_compare.GetTypeInfo());
   registry->Register(CompareOffset);
   registry->Register(Fill);
+  registry->Register(FastFill);
+  registry->Register(fast_fill.GetTypeInfo());
   registry->Register(IndexOfBuffer);
   registry->Register(SlowIndexOfNumber);
   registry->Register(FastIndexOfNumber);
@@ -1651,6 +1796,7 @@ void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(StringSlice<HEX>);
   registry->Register(StringSlice<UCS2>);
   registry->Register(StringSlice<UTF8>);
+  registry->Register(Latin1SliceTransfer);
 
   registry->Register(SlowWriteString<ASCII>);
   registry->Register(SlowWriteString<LATIN1>);
@@ -1668,6 +1814,12 @@ void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(StringWrite<HEX>);
   registry->Register(StringWrite<UCS2>);
   registry->Register(StringWrite<UTF8>);
+  registry->Register(FastStringWrite<BASE64>);
+  registry->Register(fast_string_write_base64.GetTypeInfo());
+  registry->Register(FastStringWrite<BASE64URL>);
+  registry->Register(fast_string_write_base64url.GetTypeInfo());
+  registry->Register(FastStringWrite<HEX>);
+  registry->Register(fast_string_write_hex.GetTypeInfo());
   registry->Register(GetZeroFillToggle);
 
   registry->Register(CopyArrayBuffer);
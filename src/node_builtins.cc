@@ -572,6 +572,74 @@ void BuiltinLoader::RefreshCodeCache(const std::vector<CodeCacheInfo>& in) {
   code_cache_->has_code_cache = true;
 }
 
+namespace {
+
+class PrefetchBuiltinsTask : public v8::Task {
+ public:
+  PrefetchBuiltinsTask(std::vector<UnionBytes>&& sources,
+                       std::vector<BuiltinCodeCacheData>&& code_caches)
+      : sources_(std::move(sources)), code_caches_(std::move(code_caches)) {}
+
+  void Run() override {
+    for (const UnionBytes& source : sources_) {
+      Touch(static_cast<const uint8_t*>(source.data()), source.byte_length());
+    }
+    for (const BuiltinCodeCacheData& code_cache : code_caches_) {
+      Touch(code_cache.data, code_cache.length);
+    }
+  }
+
+ private:
+  static void Touch(const uint8_t* data, size_t length) {
+    static constexpr size_t kPageSize = 4096;
+    uint8_t sum = 0;
+    for (size_t i = 0; i < length; i += kPageSize) {
+      sum += static_cast<const volatile uint8_t*>(data)[i];
+    }
+    USE(sum);
+  }
+
+  std::vector<UnionBytes> sources_;
+  // Keeps the code cache alive in case it is replaced by SaveCodeCache()
+  // while the task is pending.
+  std::vector<BuiltinCodeCacheData> code_caches_;
+};
+
+}  // anonymous namespace
+
+void BuiltinLoader::PrefetchBuiltins(MultiIsolatePlatform* platform,
+                                     const std::vector<std::string>& ids) {
+  std::vector<UnionBytes> sources;
+  std::vector<BuiltinCodeCacheData> code_caches;
+  sources.reserve(ids.size());
+  code_caches.reserve(ids.size());
+  {
+    auto source = source_.read();
+    for (const std::string& id : ids) {
+      auto source_it = source->find(id);
+      if (source_it != source->end()) sources.push_back(source_it->second);
+    }
+  }
+  {
+    RwLock::ScopedReadLock lock(code_cache_->mutex);
+    for (const std::string& id : ids) {
+      auto cache_it = code_cache_->map.find(id);
+      if (cache_it != code_cache_->map.end()) {
+        code_caches.push_back(cache_it->second);
+      }
+    }
+  }
+  per_process::Debug(DebugCategory::CODE_CACHE,
+                     "Prefetching %zu builtin sources and %zu code cache\n",
+                     sources.size(),
+                     code_caches.size());
+  if (sources.empty() && code_caches.empty()) return;
+  platform->PostTaskOnWorkerThread(
+      v8::TaskPriority::kUserBlocking,
+      std::make_unique<PrefetchBuiltinsTask>(std::move(sources),
+                                             std::move(code_caches)));
+}
+
 void BuiltinLoader::GetBuiltinCategories(
     Local<Name> property, const PropertyCallbackInfo<Value>& info) {
   Environment* env = Environment::GetCurrent(info);
@@ -23,6 +23,7 @@ class PerProcessTest;
 namespace node {
 class SnapshotBuilder;
 class ExternalReferenceRegistry;
+class MultiIsolatePlatform;
 class Realm;
 
 namespace builtins {
@@ -127,6 +128,13 @@ class NODE_EXTERN_PRIVATE BuiltinLoader {
 
   void CopySourceAndCodeCacheReferenceFrom(const BuiltinLoader* other);
 
+  // Pages in the source and code cache of the given builtins on a worker
+  // thread, so that compiling them later on the main thread does not stall
+  // on page faults in the binary. `ids` is typically a profile of the
+  // builtins an entry point loads, as reported by getCacheUsage().
+  void PrefetchBuiltins(MultiIsolatePlatform* platform,
+                        const std::vector<std::string>& ids);
+
   [[nodiscard]] auto GetBuiltinIds() const {
     return std::views::keys(*source_.read());
   }
@@ -58,6 +58,7 @@ using v8::Intercepted;
 using v8::Isolate;
 using v8::JustVoid;
 using v8::KeyCollectionMode;
+using v8::KeyConversionMode;
 using v8::Local;
 using v8::LocalVector;
 using v8::Maybe;
@@ -137,6 +138,11 @@ ContextifyContext* ContextifyContext::New(Environment* env,
           : env->isolate()->GetCurrentContext()->GetMicrotaskQueue();
 
   Local<Context> v8_context;
+  ContextPool* pool = env->vm_context_pool();
+  if (pool != nullptr &&
+      pool->Take(options->vanilla, queue).ToLocal(&v8_context)) {
+    return New(v8_context, env, sandbox_obj, options);
+  }
   if (!(CreateV8Context(env->isolate(), object_template, snapshot_data, queue)
             .ToLocal(&v8_context))) {
     // Allocation failure, maximum call stack size reached, termination, etc.
@@ -145,6 +151,65 @@ ContextifyContext* ContextifyContext::New(Environment* env,
   return New(v8_context, env, sandbox_obj, options);
 }
 
+void ContextPool::SetSize(size_t size) {
+  size_ = size;
+  for (auto& ready : ready_) {
+    if (ready.size() > size_) ready.resize(size_);
+  }
+  ScheduleFill();
+}
+
+MaybeLocal<Context> ContextPool::Take(bool vanilla, MicrotaskQueue* queue) {
+  std::vector<v8::Global<Context>>& ready = ready_[vanilla];
+  if (ready.empty() || queue != env_->context()->GetMicrotaskQueue()) {
+    return {};
+  }
+  Local<Context> context = ready.back().Get(env_->isolate());
+  ready.pop_back();
+  ScheduleFill();
+  return context;
+}
+
+void ContextPool::ScheduleFill() {
+  if (fill_scheduled_) return;
+  fill_scheduled_ = true;
+  // The pool is looked up again because it may have been replaced in the
+  // meantime. This should not keep the event loop alive.
+  env_->SetImmediate(
+      [](Environment* env) {
+        ContextPool* pool = env->vm_context_pool();
+        if (pool == nullptr) return;
+        pool->fill_scheduled_ = false;
+        if (pool->FillOne()) pool->ScheduleFill();
+      },
+      CallbackFlags::kUnrefed);
+}
+
+bool ContextPool::FillOne() {
+  for (bool vanilla : {false, true}) {
+    std::vector<v8::Global<Context>>& ready = ready_[vanilla];
+    if (ready.size() >= size_) continue;
+
+    Isolate* isolate = env_->isolate();
+    HandleScope scope(isolate);
+    Local<ObjectTemplate> object_template;
+    if (!vanilla) object_template = env_->contextify_global_template();
+    Local<Context> context;
+    if (!ContextifyContext::CreateV8Context(
+             isolate,
+             object_template,
+             env_->isolate_data()->snapshot_data(),
+             env_->context()->GetMicrotaskQueue())
+             .ToLocal(&context)) {
+      // Leave it to makeContext() to report the failure.
+      return false;
+    }
+    ready.emplace_back(isolate, context);
+    return true;
+  }
+  return false;
+}
+
 void ContextifyContext::Trace(cppgc::Visitor* visitor) const {
   CppgcMixin::Trace(visitor);
   visitor->Trace(context_);
@@ -388,12 +453,13 @@ void ContextifyContext::RegisterExternalReferences(
   registry->Register(IndexedPropertyEnumeratorCallback);
 }
 
-// makeContext(sandbox, name, origin, strings, wasm);
+// makeContext(sandbox, name, origin, strings, wasm, microtaskQueue,
+//             hostDefinedOptionId[, copySandbox]);
 void ContextifyContext::MakeContext(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
   ContextOptions options;
 
-  CHECK_EQ(args.Length(), 7);
+  CHECK(args.Length() == 7 || args.Length() == 8);
   Local<Object> sandbox;
   if (args[0]->IsObject()) {
     sandbox = args[0].As<Object>();
@@ -429,10 +495,27 @@ void ContextifyContext::MakeContext(const FunctionCallbackInfo<Value>& args) {
   CHECK(args[6]->IsSymbol());
   options.host_defined_options_id = args[6].As<Symbol>();
 
+  // With copySandbox, the sandbox is only used to populate the global of a
+  // vanilla context once. Global accesses in the context then no longer go
+  // through the interceptors and can be inline-cached by V8, but later
+  // changes to the sandbox are not reflected in the context, and vice versa.
+  Local<Object> copy_from;
+  if (args.Length() > 7 && args[7]->IsTrue()) {
+    CHECK(!sandbox.IsEmpty());
+    copy_from = sandbox;
+    sandbox = Local<Object>();
+    options.vanilla = true;
+  }
+
   TryCatchScope try_catch(env);
   ContextifyContext* context_ptr =
       ContextifyContext::New(env, sandbox, &options);
 
+  if (!try_catch.HasCaught() && context_ptr != nullptr &&
+      !copy_from.IsEmpty()) {
+    USE(CopySandboxToGlobal(env, copy_from, context_ptr->context()));
+  }
+
   if (try_catch.HasCaught()) {
     if (!try_catch.HasTerminated())
       try_catch.ReThrow();
@@ -446,6 +529,69 @@ void ContextifyContext::MakeContext(const FunctionCallbackInfo<Value>& args) {
   }
 }
 
+// Defines the own properties of `sandbox` on the global of `v8_context`
+// with the same attributes. Properties that the global does not allow to be
+// redefined, such as `undefined`, are skipped.
+// static
+Maybe<void> ContextifyContext::CopySandboxToGlobal(Environment* env,
+                                                   Local<Object> sandbox,
+                                                   Local<Context> v8_context) {
+  Local<Context> context = env->context();
+  Local<Object> global = v8_context->Global();
+  Local<Array> keys;
+  if (!sandbox
+           ->GetPropertyNames(
+               context,
+               KeyCollectionMode::kOwnOnly,
+               static_cast<PropertyFilter>(PropertyFilter::ALL_PROPERTIES),
+               IndexFilter::kIncludeIndices,
+               KeyConversionMode::kConvertToString)
+           .ToLocal(&keys)) {
+    return Nothing<void>();
+  }
+
+  for (uint32_t i = 0; i < keys->Length(); i++) {
+    Local<Value> key;
+    Local<Value> descriptor;
+    PropertyAttribute attributes;
+    if (!keys->Get(context, i).ToLocal(&key) ||
+        !sandbox->GetOwnPropertyDescriptor(context, key.As<Name>())
+             .ToLocal(&descriptor) ||
+        !sandbox->GetPropertyAttributes(context, key).To(&attributes)) {
+      return Nothing<void>();
+    }
+    // The property was deleted by a getter that ran earlier in the loop.
+    if (!descriptor->IsObject()) continue;
+
+    Local<Object> desc_obj = descriptor.As<Object>();
+    bool is_accessor;
+    if (!desc_obj->HasOwnProperty(context, env->get_string())
+             .To(&is_accessor)) {
+      return Nothing<void>();
+    }
+    Local<Value> value;
+    Local<Value> setter;
+    if (!desc_obj
+             ->Get(context,
+                   is_accessor ? env->get_string() : env->value_string())
+             .ToLocal(&value) ||
+        (is_accessor &&
+         !desc_obj->Get(context, env->set_string()).ToLocal(&setter))) {
+      return Nothing<void>();
+    }
+
+    bool writable = !(attributes & PropertyAttribute::ReadOnly);
+    PropertyDescriptor desc = is_accessor ? PropertyDescriptor(value, setter)
+                                          : PropertyDescriptor(value, writable);
+    desc.set_enumerable(!(attributes & PropertyAttribute::DontEnum));
+    desc.set_configurable(!(attributes & PropertyAttribute::DontDelete));
+    if (global->DefineProperty(context, key.As<Name>(), desc).IsNothing()) {
+      return Nothing<void>();
+    }
+  }
+  return JustVoid();
+}
+
 // static
 ContextifyContext* ContextifyContext::ContextFromContextifiedSandbox(
     Environment* env, const Local<Object>& wrapper_holder) {
@@ -1032,8 +1178,7 @@ void ContextifyScript::New(const FunctionCallbackInfo<Value>& args) {
 
   ContextifyScript* contextify_script = New(env, args.This());
 
-  if (*TRACE_EVENT_API_GET_CATEGORY_GROUP_ENABLED(
-          TRACING_CATEGORY_NODE2(vm, script)) != 0) {
+  if (TRACE_EVENT_CATEGORY_ENABLED(TRACING_CATEGORY_NODE2(vm, script))) {
     Utf8Value fn(isolate, filename);
     TRACE_EVENT_BEGIN1(TRACING_CATEGORY_NODE2(vm, script),
                        "ContextifyScript::New",
@@ -1756,7 +1901,7 @@ static void CompileFunctionForCJSLoader(
   ScriptCompiler::CachedData* cached_data = nullptr;
 #ifndef DISABLE_SINGLE_EXECUTABLE_APPLICATION
   if (is_sea_main) {
-    sea::SeaResource sea = sea::FindSingleExecutableResource();
+    const sea::SeaResource& sea = sea::FindSingleExecutableResource();
     // Use the "main" field in SEA config for the filename.
     Local<Value> filename_from_sea;
     if (!ToV8Value(context, sea.code_path).ToLocal(&filename_from_sea)) {
@@ -1770,6 +1915,18 @@ static void CompileFunctionForCJSLoader(
           static_cast<int>(data.size()),
           v8::ScriptCompiler::CachedData::BufferNotOwned);
     }
+  } else if (sea::IsSingleExecutable() &&
+             !sea::FindSingleExecutableResource().modules.empty()) {
+    // Modules bundled into the executable carry their own code cache.
+    Utf8Value filename_utf8(isolate, filename);
+    const sea::SeaModule* module =
+        sea::FindSingleExecutableModule(filename_utf8.ToStringView());
+    if (module != nullptr && !module->code_cache.empty()) {
+      cached_data = new ScriptCompiler::CachedData(
+          reinterpret_cast<const uint8_t*>(module->code_cache.data()),
+          static_cast<int>(module->code_cache.size()),
+          v8::ScriptCompiler::CachedData::BufferNotOwned);
+    }
   }
 #endif
 
@@ -1787,6 +1944,14 @@ static void CompileFunctionForCJSLoader(
     }
   }
 
+  // Only the principal realm is written to the startup profile, so do not
+  // collect the modules of ShadowRealms, which would only accumulate.
+  if (!fn.IsEmpty() && realm == env->principal_realm() &&
+      !per_process::cli_options->startup_profile.empty()) {
+    Utf8Value filename_utf8(isolate, filename);
+    realm->cjs_modules_compiled.push_back(filename_utf8.ToString());
+  }
+
   bool can_parse_as_esm = false;
   if (!cjs_exception.IsEmpty()) {
     // Use the URL to match what would be used in the origin if it's going to
@@ -1968,6 +2133,23 @@ static void MeasureMemory(const FunctionCallbackInfo<Value>& args) {
   args.GetReturnValue().Set(promise);
 }
 
+// Keeps the given number of contexts of each kind ready for makeContext().
+// 0 disposes of the pool.
+static void SetContextPoolSize(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsUint32());
+  uint32_t size = args[0].As<Uint32>()->Value();
+
+  if (size == 0) {
+    env->set_vm_context_pool(nullptr);
+    return;
+  }
+  if (env->vm_context_pool() == nullptr) {
+    env->set_vm_context_pool(std::make_unique<ContextPool>(env));
+  }
+  env->vm_context_pool()->SetSize(size);
+}
+
 void CreatePerIsolateProperties(IsolateData* isolate_data,
                                 Local<ObjectTemplate> target) {
   Isolate* isolate = isolate_data->isolate();
@@ -1982,6 +2164,7 @@ void CreatePerIsolateProperties(IsolateData* isolate_data,
       isolate, target, "watchdogHasPendingSigint", WatchdogHasPendingSigint);
 
   SetMethod(isolate, target, "measureMemory", MeasureMemory);
+  SetMethod(isolate, target, "setContextPoolSize", SetContextPoolSize);
   SetMethod(isolate,
             target,
             "compileFunctionForCJSLoader",
@@ -2032,6 +2215,7 @@ void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(StopSigintWatchdog);
   registry->Register(WatchdogHasPendingSigint);
   registry->Register(MeasureMemory);
+  registry->Register(SetContextPoolSize);
   registry->Register(ContainsModuleSyntax);
 }
 }  // namespace contextify
@@ -142,6 +142,9 @@ class ContextifyContext final : CPPGC_MIXIN(ContextifyContext) {
 
   static bool IsStillInitializing(const ContextifyContext* ctx);
   static void MakeContext(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static v8::Maybe<void> CopySandboxToGlobal(Environment* env,
+                                             v8::Local<v8::Object> sandbox,
+                                             v8::Local<v8::Context> v8_context);
   static void IsContext(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void CompileFunction(
       const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -200,6 +203,36 @@ class ContextifyContext final : CPPGC_MIXIN(ContextifyContext) {
   std::unique_ptr<v8::MicrotaskQueue> microtask_queue_;
 };
 
+// Fresh V8 contexts created ahead of time, which makeContext() contextifies
+// instead of creating and deserializing a context on the spot. Contexts are
+// never returned to the pool after use, since the code that ran in them can
+// leave arbitrary state behind in their builtins.
+class ContextPool {
+ public:
+  explicit ContextPool(Environment* env) : env_(env) {}
+
+  ContextPool(const ContextPool&) = delete;
+  ContextPool& operator=(const ContextPool&) = delete;
+
+  // Keeps up to `size` contexts of each kind (vanilla or with the
+  // interceptors of a contextified sandbox) ready. The pool is refilled one
+  // context per event loop iteration after every Take().
+  void SetSize(size_t size);
+  // Returns an empty handle if no suitable context is ready. Only contexts
+  // using the main context's microtask queue can be taken from the pool.
+  v8::MaybeLocal<v8::Context> Take(bool vanilla, v8::MicrotaskQueue* queue);
+
+ private:
+  void ScheduleFill();
+  // Creates one missing context, returns false if there are none missing.
+  bool FillOne();
+
+  Environment* const env_;
+  size_t size_ = 0;
+  std::vector<v8::Global<v8::Context>> ready_[2];
+  bool fill_scheduled_ = false;
+};
+
 class ContextifyScript final : CPPGC_MIXIN(ContextifyScript) {
  public:
   SET_CPPGC_NAME(ContextifyScript)
@@ -53,6 +53,7 @@ namespace crypto {
   V(RSAAlg)                                                                    \
   V(SecureContext)                                                             \
   V(Sign)                                                                      \
+  V(SignContext)                                                               \
   V(SPKAC)                                                                     \
   V(Timing)                                                                    \
   V(Util)                                                                      \
@@ -1,5 +1,6 @@
 #include "node_dir.h"
 #include "memory_tracker-inl.h"
+#include "node_buffer.h"
 #include "node_external_reference.h"
 #include "node_file-inl.h"
 #include "node_process-inl.h"
@@ -61,8 +62,7 @@ static const char* get_dir_func_name_by_type(uv_fs_type req_type) {
 
 #define TRACE_NAME(name) "fs_dir.sync." #name
 #define GET_TRACE_ENABLED                                                      \
-  (*TRACE_EVENT_API_GET_CATEGORY_GROUP_ENABLED(                                \
-       TRACING_CATEGORY_NODE2(fs_dir, sync)) != 0)
+  TRACE_EVENT_CATEGORY_ENABLED(TRACING_CATEGORY_NODE2(fs_dir, sync))
 #define FS_DIR_SYNC_TRACE_BEGIN(syscall, ...)                                  \
   if (GET_TRACE_ENABLED)                                                       \
     TRACE_EVENT_BEGIN(TRACING_CATEGORY_NODE2(fs_dir, sync),                    \
@@ -230,6 +230,71 @@ static MaybeLocal<Array> DirentListToArray(Environment* env,
   return Array::New(env->isolate(), entries.out(), j);
 }
 
+// Packs a batch of dirents into [names, types]: one Buffer holding the
+// NUL-terminated names and a Uint8Array of their types. This avoids creating
+// a string per entry; decoding is left to the caller.
+static MaybeLocal<Array> DirentListToPackedArray(Environment* env,
+                                                 uv_dirent_t* ents,
+                                                 int num) {
+  Isolate* isolate = env->isolate();
+  size_t names_length = 0;
+  for (int i = 0; i < num; i++) {
+    names_length += strlen(ents[i].name) + 1;
+  }
+
+  Local<Object> names;
+  if (!Buffer::New(isolate, names_length).ToLocal(&names)) {
+    return {};
+  }
+  char* data = Buffer::Data(names);
+  Local<v8::ArrayBuffer> types_buffer = v8::ArrayBuffer::New(isolate, num);
+  uint8_t* types = static_cast<uint8_t*>(types_buffer->Data());
+  for (int i = 0; i < num; i++) {
+    const size_t namelen = strlen(ents[i].name) + 1;
+    memcpy(data, ents[i].name, namelen);
+    data += namelen;
+    types[i] = static_cast<uint8_t>(ents[i].type);
+  }
+
+  Local<Value> result[] = {names, v8::Uint8Array::New(types_buffer, 0, num)};
+  return Array::New(isolate, result, arraysize(result));
+}
+
+static void AfterDirReadPacked(uv_fs_t* req) {
+  BaseObjectPtr<FSReqBase> req_wrap { FSReqBase::from_req(req) };
+  FSReqAfterScope after(req_wrap.get(), req);
+  FS_DIR_ASYNC_TRACE_END1(
+      req->fs_type, req_wrap, "result", static_cast<int>(req->result))
+  if (!after.Proceed()) {
+    return;
+  }
+
+  Environment* env = req_wrap->env();
+  Isolate* isolate = env->isolate();
+
+  if (req->result == 0) {
+    // Done
+    after.Clear();
+    req_wrap->Resolve(Null(isolate));
+    return;
+  }
+
+  uv_dir_t* dir = static_cast<uv_dir_t*>(req->ptr);
+
+  TryCatch try_catch(isolate);
+  Local<Array> js_array;
+  if (!DirentListToPackedArray(
+           env, dir->dirents, static_cast<int>(req->result))
+           .ToLocal(&js_array)) {
+    after.Clear();
+    CHECK(try_catch.CanContinue());
+    return req_wrap->Reject(try_catch.Exception());
+  }
+
+  after.Clear();
+  req_wrap->Resolve(js_array);
+}
+
 static void AfterDirRead(uv_fs_t* req) {
   BaseObjectPtr<FSReqBase> req_wrap { FSReqBase::from_req(req) };
   FSReqAfterScope after(req_wrap.get(), req);
@@ -275,7 +340,8 @@ void DirHandle::Read(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
   Isolate* isolate = env->isolate();
 
-  CHECK_GE(args.Length(), 2);  // encoding, bufferSize, [callback]
+  // encoding, bufferSize, [callback], [packed]
+  CHECK_GE(args.Length(), 2);
 
   const enum encoding encoding = ParseEncoding(isolate, args[0], UTF8);
 
@@ -285,6 +351,10 @@ void DirHandle::Read(const FunctionCallbackInfo<Value>& args) {
   CHECK(args[1]->IsNumber());
   uint64_t buffer_size = static_cast<uint64_t>(args[1].As<Number>()->Value());
 
+  // When packed, entries come back as [names, types] (see
+  // DirentListToPackedArray()) and `encoding` is left to the caller.
+  const bool packed = args.Length() > 3 && args[3]->IsTrue();
+
   if (buffer_size != dir->dirents_.size()) {
     dir->dirents_.resize(buffer_size);
     dir->dir_->nentries = buffer_size;
@@ -296,7 +366,8 @@ void DirHandle::Read(const FunctionCallbackInfo<Value>& args) {
     CHECK_NOT_NULL(req_wrap_async);
     FS_DIR_ASYNC_TRACE_BEGIN0(UV_FS_READDIR, req_wrap_async)
     AsyncCall(env, req_wrap_async, args, "readdir", encoding,
-              AfterDirRead, uv_fs_readdir, dir->dir());
+              packed ? AfterDirReadPacked : AfterDirRead,
+              uv_fs_readdir, dir->dir());
   } else {  // dir.read(encoding, bufferSize)
     FSReqWrapSync req_wrap_sync("readdir");
     FS_DIR_SYNC_TRACE_BEGIN(readdir);
@@ -316,11 +387,16 @@ void DirHandle::Read(const FunctionCallbackInfo<Value>& args) {
 
     TryCatch try_catch(isolate);
     Local<Array> js_array;
-    if (!DirentListToArray(env,
-                           dir->dir()->dirents,
-                           static_cast<int>(req_wrap_sync.req.result),
-                           encoding)
-             .ToLocal(&js_array)) {
+    MaybeLocal<Array> maybe_array =
+        packed ? DirentListToPackedArray(
+                     env,
+                     dir->dir()->dirents,
+                     static_cast<int>(req_wrap_sync.req.result))
+               : DirentListToArray(env,
+                                   dir->dir()->dirents,
+                                   static_cast<int>(req_wrap_sync.req.result),
+                                   encoding);
+    if (!maybe_array.ToLocal(&js_array)) {
       // TODO(anonrig): Initializing BufferValue here is wasteful.
       CHECK(try_catch.CanContinue());
       BufferValue error_payload(isolate, try_catch.Exception());
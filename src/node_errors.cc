@@ -29,7 +29,9 @@ using v8::Local;
 using v8::Maybe;
 using v8::MaybeLocal;
 using v8::Message;
+using v8::Name;
 using v8::Object;
+using v8::PropertyCallbackInfo;
 using v8::ScriptOrigin;
 using v8::StackFrame;
 using v8::StackTrace;
@@ -1098,7 +1100,35 @@ static void TriggerUncaughtException(const FunctionCallbackInfo<Value>& args) {
   errors::TriggerUncaughtException(isolate, exception, message, from_promise);
 }
 
+// The value of `stack` of a decorated error, see DecorateErrorStack(). The
+// data is [original stack getter, arrow].
+static void DecoratedStackGetter(Local<Name> name,
+                                 const PropertyCallbackInfo<Value>& info) {
+  Isolate* isolate = info.GetIsolate();
+  Local<Context> context = isolate->GetCurrentContext();
+  Local<v8::Array> data = info.Data().As<v8::Array>();
+  Local<Value> getter;
+  Local<Value> arrow;
+  Local<Value> stack;
+  if (!data->Get(context, 0).ToLocal(&getter) ||
+      !data->Get(context, 1).ToLocal(&arrow) ||
+      !getter.As<Function>()->Call(context, info.This(), 0, nullptr)
+           .ToLocal(&stack)) {
+    return;
+  }
+  if (!stack->IsString()) {
+    return info.GetReturnValue().Set(stack);
+  }
+  Local<String> decorated_stack = String::Concat(
+      isolate,
+      String::Concat(
+          isolate, arrow.As<String>(), FIXED_ONE_BYTE_STRING(isolate, "\n")),
+      stack.As<String>());
+  info.GetReturnValue().Set(decorated_stack);
+}
+
 void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
+  registry->Register(DecoratedStackGetter);
   registry->Register(SetPrepareStackTraceCallback);
   registry->Register(SetGetSourceMapErrorSource);
   registry->Register(SetSourceMapsEnabled);
@@ -1162,7 +1192,6 @@ void DecorateErrorStack(Environment* env,
 
   AppendExceptionLine(env, exception, message, CONTEXTIFY_ERROR);
   TryCatchScope try_catch_scope(env);  // Ignore exceptions below.
-  MaybeLocal<Value> stack = err_obj->Get(env->context(), env->stack_string());
   MaybeLocal<Value> maybe_value =
       err_obj->GetPrivate(env->context(), env->arrow_message_private_symbol());
 
@@ -1171,17 +1200,50 @@ void DecorateErrorStack(Environment* env,
     return;
   }
 
-  if (stack.IsEmpty() || !stack.ToLocalChecked()->IsString()) {
+  // Formatting the stack trace means symbolizing all of its frames and
+  // running Error.prepareStackTrace(), which is wasted if the error is caught
+  // and discarded. If `stack` is still V8's accessor, it is replaced with one
+  // that prepends the arrow only when the stack is first read.
+  Local<Value> descriptor;
+  Local<Value> getter;
+  if (!err_obj->GetOwnPropertyDescriptor(env->context(), env->stack_string())
+           .ToLocal(&descriptor) ||
+      !descriptor->IsObject() ||
+      !descriptor.As<Object>()
+           ->Get(env->context(), FIXED_ONE_BYTE_STRING(env->isolate(), "get"))
+           .ToLocal(&getter)) {
     return;
   }
+  if (getter->IsFunction()) {
+    Local<Value> data_elements[] = {getter, arrow};
+    Local<v8::Array> data =
+        v8::Array::New(env->isolate(), data_elements, arraysize(data_elements));
+    if (err_obj
+            ->SetLazyDataProperty(env->context(),
+                                  env->stack_string(),
+                                  DecoratedStackGetter,
+                                  data,
+                                  v8::DontEnum)
+            .IsNothing()) {
+      return;
+    }
+  } else {
+    Local<Value> stack;
+    if (!descriptor.As<Object>()
+             ->Get(env->context(), env->value_string())
+             .ToLocal(&stack) ||
+        !stack->IsString()) {
+      return;
+    }
 
-  Local<String> decorated_stack = String::Concat(
-      env->isolate(),
-      String::Concat(env->isolate(),
-                     arrow.As<String>(),
-                     FIXED_ONE_BYTE_STRING(env->isolate(), "\n")),
-      stack.ToLocalChecked().As<String>());
-  USE(err_obj->Set(env->context(), env->stack_string(), decorated_stack));
+    Local<String> decorated_stack = String::Concat(
+        env->isolate(),
+        String::Concat(env->isolate(),
+                       arrow.As<String>(),
+                       FIXED_ONE_BYTE_STRING(env->isolate(), "\n")),
+        stack.As<String>());
+    USE(err_obj->Set(env->context(), env->stack_string(), decorated_stack));
+  }
   err_obj->SetPrivate(
       env->context(), env->decorated_private_symbol(), True(env->isolate()));
 }
@@ -68,6 +68,18 @@ using CFunctionWithUint32 = uint32_t (*)(v8::Local<v8::Value>,
                                          const uint32_t input);
 using CFunctionWithReturnUint32 = uint32_t (*)(v8::Local<v8::Value>);
 using CFunctionWithReturnDouble = double (*)(v8::Local<v8::Value>);
+using CFunctionWithReturnUint32AndOptions =
+    uint32_t (*)(v8::Local<v8::Value>, v8::FastApiCallbackOptions&);
+using CFunctionWithReturnDoubleAndOptions =
+    double (*)(v8::Local<v8::Value>, v8::FastApiCallbackOptions&);
+using CFunctionVoidWithValueAndOptions = void (*)(v8::Local<v8::Value>,
+                                                  v8::Local<v8::Value>,
+                                                  v8::FastApiCallbackOptions&);
+using CFunctionVoidWithUint32 = void (*)(v8::Local<v8::Value>, uint32_t);
+using CFunctionVoidWithTwoUint32 = void (*)(v8::Local<v8::Value>,
+                                            uint32_t,
+                                            uint32_t);
+using CFunctionVoidWithDouble = void (*)(v8::Local<v8::Value>, double);
 using CFunctionWithDoubleReturnDouble = double (*)(v8::Local<v8::Value>,
                                                    v8::Local<v8::Value>,
                                                    const double);
@@ -94,6 +106,26 @@ using CFunctionBufferCopy = uint32_t (*)(v8::Local<v8::Value>,
                                          uint32_t,
                                          v8::FastApiCallbackOptions&);
 
+using CFunctionBufferFill = int32_t (*)(v8::Local<v8::Value>,
+                                        v8::Local<v8::Value>,
+                                        uint32_t,
+                                        uint32_t,
+                                        uint32_t,
+                                        v8::Local<v8::Value>,
+                                        v8::FastApiCallbackOptions&);
+
+using CFunctionStringWrite = uint32_t (*)(v8::Local<v8::Value>,
+                                          const v8::FastOneByteString&,
+                                          uint32_t,
+                                          uint32_t,
+                                          v8::FastApiCallbackOptions&);
+
+using CFunctionRandomFill = bool (*)(v8::Local<v8::Value>,
+                                     v8::Local<v8::Value>,
+                                     uint32_t,
+                                     uint32_t,
+                                     v8::FastApiCallbackOptions&);
+
 // This class manages the external references from the V8 heap
 // to the C++ addresses in Node.js.
 class ExternalReferenceRegistry {
@@ -119,11 +151,20 @@ class ExternalReferenceRegistry {
   V(CFunctionCallbackWithTwoUint8Arrays)                                       \
   V(CFunctionCallbackWithUint8ArrayUint32Int64Bool)                            \
   V(CFunctionWithUint32)                                                       \
+  V(CFunctionWithReturnUint32AndOptions)                                       \
+  V(CFunctionWithReturnDoubleAndOptions)                                       \
+  V(CFunctionVoidWithValueAndOptions)                                          \
+  V(CFunctionVoidWithUint32)                                                   \
+  V(CFunctionVoidWithTwoUint32)                                                \
+  V(CFunctionVoidWithDouble)                                                   \
   V(CFunctionWithDoubleReturnDouble)                                           \
   V(CFunctionWithInt64Fallback)                                                \
   V(CFunctionWithBool)                                                         \
   V(CFunctionBufferCopy)                                                       \
   V(CFunctionWriteString)                                                      \
+  V(CFunctionBufferFill)                                                       \
+  V(CFunctionStringWrite)                                                      \
+  V(CFunctionRandomFill)                                                       \
   V(const v8::CFunctionInfo*)                                                  \
   V(v8::FunctionCallback)                                                      \
   V(v8::AccessorNameGetterCallback)                                            \
@@ -186,6 +227,7 @@ class ExternalReferenceRegistry {
   V(modules)                                                                   \
   V(options)                                                                   \
   V(os)                                                                        \
+  V(path)                                                                      \
   V(performance)                                                               \
   V(permission)                                                                \
   V(process_methods)                                                           \
@@ -202,9 +244,11 @@ class ExternalReferenceRegistry {
   V(pipe_wrap)                                                                 \
   V(sea)                                                                       \
   V(serdes)                                                                    \
+  V(shm)                                                                       \
   V(string_decoder)                                                            \
   V(stream_wrap)                                                               \
   V(signal_wrap)                                                               \
+  V(source_map)                                                                \
   V(spawn_sync)                                                                \
   V(trace_events)                                                              \
   V(timers)                                                                    \
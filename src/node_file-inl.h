@@ -82,13 +82,10 @@ FSReqCallback::FSReqCallback(BindingData* binding_data,
               AsyncWrap::PROVIDER_FSREQCALLBACK,
               use_bigint) {}
 
-template <typename NativeT, typename V8T>
-void FillStatsArray(AliasedBufferBase<NativeT, V8T>* fields,
-                    const uv_stat_t* s,
-                    const size_t offset) {
+template <typename NativeT, typename Setter>
+void WriteStatFields(const uv_stat_t* s, Setter&& set) {
 #define SET_FIELD_WITH_STAT(stat_offset, stat)                                 \
-  fields->SetValue(offset + static_cast<size_t>(FsStatsOffset::stat_offset),   \
-                   static_cast<NativeT>(stat))
+  set(FsStatsOffset::stat_offset, static_cast<NativeT>(stat))
 
 // On win32, time is stored in uint64_t and starts from 1601-01-01.
 // libuv calculates tv_sec and tv_nsec from it and converts to signed long,
@@ -127,6 +124,22 @@ void FillStatsArray(AliasedBufferBase<NativeT, V8T>* fields,
 #undef SET_FIELD_WITH_STAT
 }
 
+template <typename NativeT, typename V8T>
+void FillStatsArray(AliasedBufferBase<NativeT, V8T>* fields,
+                    const uv_stat_t* s,
+                    const size_t offset) {
+  WriteStatFields<NativeT>(s, [&](FsStatsOffset field, NativeT value) {
+    fields->SetValue(offset + static_cast<size_t>(field), value);
+  });
+}
+
+template <typename NativeT>
+void FillStatsRecord(NativeT* fields, const uv_stat_t* s) {
+  WriteStatFields<NativeT>(s, [&](FsStatsOffset field, NativeT value) {
+    fields[static_cast<size_t>(field)] = value;
+  });
+}
+
 v8::Local<v8::Value> FillGlobalStatsArray(BindingData* binding_data,
                                           const bool use_bigint,
                                           const uv_stat_t* s,
@@ -40,9 +40,11 @@
 #include "req_wrap-inl.h"
 #include "stream_base-inl.h"
 #include "string_bytes.h"
+#include "threadpoolwork-inl.h"
 #include "uv.h"
 #include "v8-fast-api-calls.h"
 
+#include <deque>
 #include <filesystem>
 
 #if defined(__MINGW32__) || defined(_MSC_VER)
@@ -52,9 +54,20 @@
 #ifdef _WIN32
 #include <windows.h>
 #else
+#include <sys/mman.h>
 #include <unistd.h>
 #endif
 
+#ifdef __APPLE__
+#include <sys/clonefile.h>
+#endif
+
+#ifdef __linux__
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/syscall.h>
+#endif
+
 namespace node {
 
 namespace fs {
@@ -64,6 +77,7 @@ using v8::BigInt;
 using v8::Context;
 using v8::EscapableHandleScope;
 using v8::FastApiCallbackOptions;
+using v8::Function;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
 using v8::HandleScope;
@@ -145,8 +159,7 @@ static const char* get_fs_func_name_by_type(uv_fs_type req_type) {
 
 #define TRACE_NAME(name) "fs.sync." #name
 #define GET_TRACE_ENABLED                                                      \
-  (*TRACE_EVENT_API_GET_CATEGORY_GROUP_ENABLED(                                \
-       TRACING_CATEGORY_NODE2(fs, sync)) != 0)
+  TRACE_EVENT_CATEGORY_ENABLED(TRACING_CATEGORY_NODE2(fs, sync))
 #define FS_SYNC_TRACE_BEGIN(syscall, ...)                                      \
   if (GET_TRACE_ENABLED)                                                       \
     TRACE_EVENT_BEGIN(                                                         \
@@ -540,6 +553,49 @@ FileHandleReadWrap::FileHandleReadWrap(FileHandle* handle, Local<Object> obj)
   : ReqWrap(handle->env(), obj, AsyncWrap::PROVIDER_FSREQCALLBACK),
     file_handle_(handle) {}
 
+BaseObjectPtr<FileHandleReadWrap> FileHandle::GetReadWrap() {
+  // Create a new FileHandleReadWrap or re-use one.
+  // Either way, we need these two scopes for AsyncReset() or otherwise
+  // for creating the new instance.
+  HandleScope handle_scope(env()->isolate());
+  AsyncHooks::DefaultTriggerAsyncIdScope trigger_scope(this);
+
+  auto& freelist = binding_data_->file_handle_read_wrap_freelist;
+  if (freelist.size() > 0) {
+    BaseObjectPtr<FileHandleReadWrap> read_wrap = std::move(freelist.back());
+    freelist.pop_back();
+    // Use a fresh async resource.
+    // Lifetime is ensured via AsyncWrap::resource_.
+    Local<Object> resource = Object::New(env()->isolate());
+    USE(resource->Set(
+        env()->context(), env()->handle_string(), read_wrap->object()));
+    read_wrap->AsyncReset(resource);
+    read_wrap->file_handle_ = this;
+    return read_wrap;
+  }
+
+  Local<Object> wrap_obj;
+  if (!env()
+           ->filehandlereadwrap_template()
+           ->NewInstance(env()->context())
+           .ToLocal(&wrap_obj)) {
+    return {};
+  }
+  return MakeDetachedBaseObject<FileHandleReadWrap>(this, wrap_obj);
+}
+
+void FileHandle::RecycleReadWrap(
+    BaseObjectPtr<FileHandleReadWrap>&& read_wrap) {
+  // Push the read wrap back to the freelist, or let it be destroyed
+  // once the caller's reference goes away.
+  constexpr size_t kWantedFreelistFill = 100;
+  auto& freelist = binding_data_->file_handle_read_wrap_freelist;
+  if (freelist.size() < kWantedFreelistFill) {
+    read_wrap->Reset();
+    freelist.emplace_back(std::move(read_wrap));
+  }
+}
+
 int FileHandle::ReadStart() {
   if (!IsAlive() || IsClosing())
     return UV_EOF;
@@ -549,43 +605,15 @@ int FileHandle::ReadStart() {
   if (current_read_)
     return 0;
 
-  BaseObjectPtr<FileHandleReadWrap> read_wrap;
-
   if (read_length_ == 0) {
     EmitRead(UV_EOF);
     return 0;
   }
 
-  {
-    // Create a new FileHandleReadWrap or re-use one.
-    // Either way, we need these two scopes for AsyncReset() or otherwise
-    // for creating the new instance.
-    HandleScope handle_scope(env()->isolate());
-    AsyncHooks::DefaultTriggerAsyncIdScope trigger_scope(this);
-
-    auto& freelist = binding_data_->file_handle_read_wrap_freelist;
-    if (freelist.size() > 0) {
-      read_wrap = std::move(freelist.back());
-      freelist.pop_back();
-      // Use a fresh async resource.
-      // Lifetime is ensured via AsyncWrap::resource_.
-      Local<Object> resource = Object::New(env()->isolate());
-      USE(resource->Set(
-          env()->context(), env()->handle_string(), read_wrap->object()));
-      read_wrap->AsyncReset(resource);
-      read_wrap->file_handle_ = this;
-    } else {
-      Local<Object> wrap_obj;
-      if (!env()
-               ->filehandlereadwrap_template()
-               ->NewInstance(env()->context())
-               .ToLocal(&wrap_obj)) {
-        return UV_EBUSY;
-      }
-      read_wrap = MakeDetachedBaseObject<FileHandleReadWrap>(this, wrap_obj);
-    }
-  }
-  int64_t recommended_read = 65536;
+  BaseObjectPtr<FileHandleReadWrap> read_wrap = GetReadWrap();
+  if (!read_wrap) return UV_EBUSY;
+
+  int64_t recommended_read = read_chunk_size_;
   if (read_length_ >= 0 && read_length_ <= recommended_read)
     recommended_read = read_length_;
 
@@ -619,14 +647,7 @@ int FileHandle::ReadStart() {
 
     uv_fs_req_cleanup(req);
 
-    // Push the read wrap back to the freelist, or let it be destroyed
-    // once we’re exiting the current scope.
-    constexpr size_t kWantedFreelistFill = 100;
-    auto& freelist = handle->binding_data_->file_handle_read_wrap_freelist;
-    if (freelist.size() < kWantedFreelistFill) {
-      read_wrap->Reset();
-      freelist.emplace_back(std::move(read_wrap));
-    }
+    handle->RecycleReadWrap(std::move(read_wrap));
 
     if (result >= 0) {
       // Read at most as many bytes as we originally planned to.
@@ -658,6 +679,72 @@ int FileHandle::ReadStart() {
   return 0;
 }
 
+int FileHandle::SendFile(uv_file out_fd, size_t length, SendFileCallback cb) {
+  if (!IsAlive() || IsClosing())
+    return UV_EOF;
+
+  if (current_read_)
+    return UV_EBUSY;
+
+  // uv_fs_sendfile() always transfers from an explicit offset and leaves the
+  // file position untouched, so it cannot stand in for position-based reads.
+  if (read_offset_ < 0)
+    return UV_ENOTSUP;
+
+  if (read_length_ >= 0 && static_cast<uint64_t>(read_length_) < length)
+    length = static_cast<size_t>(read_length_);
+
+  if (length == 0) {
+    cb(0);
+    return 0;
+  }
+
+  BaseObjectPtr<FileHandleReadWrap> read_wrap = GetReadWrap();
+  if (!read_wrap) return UV_EBUSY;
+
+  current_read_ = std::move(read_wrap);
+  sendfile_cb_ = std::move(cb);
+  FS_ASYNC_TRACE_BEGIN0(UV_FS_SENDFILE, current_read_.get())
+  int err = current_read_->Dispatch(uv_fs_sendfile,
+                                    out_fd,
+                                    fd_,
+                                    read_offset_,
+                                    length,
+                                    uv_fs_callback_t{[](uv_fs_t* req) {
+    FileHandle* handle;
+    {
+      FileHandleReadWrap* req_wrap = FileHandleReadWrap::from_req(req);
+      FS_ASYNC_TRACE_END1(
+          req->fs_type, req_wrap, "result", static_cast<int>(req->result))
+      handle = req_wrap->file_handle_;
+      CHECK_EQ(handle->current_read_.get(), req_wrap);
+    }
+
+    BaseObjectPtr<FileHandleReadWrap> read_wrap =
+        std::move(handle->current_read_);
+    SendFileCallback cb = std::move(handle->sendfile_cb_);
+
+    ssize_t result = req->result;
+    uv_fs_req_cleanup(req);
+
+    handle->RecycleReadWrap(std::move(read_wrap));
+
+    if (result > 0) {
+      if (handle->read_length_ >= 0)
+        handle->read_length_ -= result;
+      handle->read_offset_ += result;
+    }
+
+    cb(result);
+  }});
+
+  if (err < 0) {
+    current_read_.reset();
+    sendfile_cb_ = nullptr;
+  }
+  return err;
+}
+
 int FileHandle::ReadStop() {
   reading_ = false;
   return 0;
@@ -1198,6 +1285,186 @@ static void LStat(const FunctionCallbackInfo<Value>& args) {
   }
 }
 
+// Shared state of one statMany() call. Results are written into `stats` and
+// `errors` at the index of each path, so chunks can run concurrently.
+struct StatManyJob {
+  StatManyJob(Environment* env,
+              std::vector<std::string>&& paths,
+              bool use_lstat,
+              bool use_bigint)
+      : env(env),
+        paths(std::move(paths)),
+        stats(this->paths.size()),
+        errors(this->paths.size()),
+        use_lstat(use_lstat),
+        use_bigint(use_bigint) {}
+
+  void Run(size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      uv_fs_t req;
+      int err = use_lstat
+                    ? uv_fs_lstat(nullptr, &req, paths[i].c_str(), nullptr)
+                    : uv_fs_stat(nullptr, &req, paths[i].c_str(), nullptr);
+      if (err == 0) {
+        stats[i] = req.statbuf;
+      } else {
+        errors[i] = err;
+      }
+      uv_fs_req_cleanup(&req);
+    }
+  }
+
+  template <typename NativeT, typename ArrayT>
+  Local<Value> StatsArray() {
+    constexpr size_t kFields =
+        static_cast<size_t>(FsStatsOffset::kFsStatsFieldsNumber);
+    size_t length = paths.size() * kFields;
+    Local<v8::ArrayBuffer> buffer =
+        v8::ArrayBuffer::New(env->isolate(), length * sizeof(NativeT));
+    NativeT* data = static_cast<NativeT*>(buffer->Data());
+    for (size_t i = 0; i < paths.size(); i++) {
+      // Records of failed entries are left zeroed.
+      if (errors[i] == 0) FillStatsRecord(data + i * kFields, &stats[i]);
+    }
+    return ArrayT::New(buffer, 0, length);
+  }
+
+  // Returns [stats, errors]: one record of kFsStatsFieldsNumber values per
+  // path, and the libuv error code (or 0) of each path.
+  Local<Value> Result() {
+    Isolate* isolate = env->isolate();
+    Local<Value> stats_array =
+        use_bigint ? StatsArray<int64_t, v8::BigInt64Array>()
+                   : StatsArray<double, v8::Float64Array>();
+    Local<v8::ArrayBuffer> errors_buffer =
+        v8::ArrayBuffer::New(isolate, errors.size() * sizeof(int32_t));
+    if (!errors.empty()) {
+      memcpy(errors_buffer->Data(),
+             errors.data(),
+             errors.size() * sizeof(int32_t));
+    }
+    Local<Value> result[] = {
+        stats_array, v8::Int32Array::New(errors_buffer, 0, errors.size())};
+    return Array::New(isolate, result, arraysize(result));
+  }
+
+  void Finish() {
+    BaseObjectPtr<FSReqBase> wrap = std::move(req_wrap);
+    if (env->can_call_into_js()) {
+      HandleScope handle_scope(env->isolate());
+      Context::Scope context_scope(env->context());
+      wrap->Resolve(Result());
+    }
+    wrap->Detach();
+  }
+
+  Environment* env;
+  std::vector<std::string> paths;
+  std::vector<uv_stat_t> stats;
+  std::vector<int32_t> errors;
+  const bool use_lstat;
+  const bool use_bigint;
+  BaseObjectPtr<FSReqBase> req_wrap;
+  size_t pending = 0;
+};
+
+class StatManyWork final : public ThreadPoolWork {
+ public:
+  StatManyWork(Environment* env,
+               std::shared_ptr<StatManyJob> job,
+               size_t begin,
+               size_t end)
+      : ThreadPoolWork(env, "fs_stat"),
+        job_(std::move(job)),
+        begin_(begin),
+        end_(end) {}
+
+  void DoThreadPoolWork() override { job_->Run(begin_, end_); }
+
+  void AfterThreadPoolWork(int status) override {
+    std::shared_ptr<StatManyJob> job = std::move(job_);
+    if (status == UV_ECANCELED) {
+      std::fill(job->errors.begin() + begin_,
+                job->errors.begin() + end_,
+                static_cast<int32_t>(UV_ECANCELED));
+    }
+    delete this;
+    if (--job->pending == 0) job->Finish();
+  }
+
+ private:
+  std::shared_ptr<StatManyJob> job_;
+  const size_t begin_;
+  const size_t end_;
+};
+
+// Number of paths stat'ed by one threadpool work item.
+static constexpr size_t kStatManyChunkSize = 256;
+
+// statMany(paths, use_bigint, use_lstat, req)
+static void StatMany(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Isolate* isolate = env->isolate();
+  Local<Context> context = env->context();
+
+  CHECK_GE(args.Length(), 3);
+  CHECK(args[0]->IsArray());
+  Local<Array> array = args[0].As<Array>();
+  bool use_bigint = args[1]->IsTrue();
+  bool use_lstat = args[2]->IsTrue();
+  bool is_async = args.Length() > 3 && !args[3]->IsUndefined();
+  FSReqBase* req_wrap_async =
+      is_async ? GetReqWrap(args, 3, use_bigint) : nullptr;
+
+  std::vector<std::string> paths;
+  paths.reserve(array->Length());
+  for (uint32_t i = 0; i < array->Length(); i++) {
+    Local<Value> item;
+    if (!array->Get(context, i).ToLocal(&item)) return;
+    BufferValue path(isolate, item);
+    CHECK_NOT_NULL(*path);
+    ToNamespacedPath(env, &path);
+    if (is_async) {
+      ASYNC_THROW_IF_INSUFFICIENT_PERMISSIONS(
+          env,
+          req_wrap_async,
+          permission::PermissionScope::kFileSystemRead,
+          path.ToStringView());
+    } else {
+      THROW_IF_INSUFFICIENT_PERMISSIONS(
+          env,
+          permission::PermissionScope::kFileSystemRead,
+          path.ToStringView());
+    }
+    paths.emplace_back(path.ToString());
+  }
+
+  auto job = std::make_shared<StatManyJob>(
+      env, std::move(paths), use_lstat, use_bigint);
+  size_t count = job->paths.size();
+
+  if (!is_async) {  // statMany(paths, use_bigint, use_lstat)
+    job->Run(0, count);
+    args.GetReturnValue().Set(job->Result());
+    return;
+  }
+
+  // statMany(paths, use_bigint, use_lstat, req)
+  CHECK_NOT_NULL(req_wrap_async);
+  job->req_wrap = BaseObjectPtr<FSReqBase>(req_wrap_async);
+  req_wrap_async->SetReturnValue(args);
+  // An empty list still goes through the threadpool once, so that the
+  // request always completes asynchronously.
+  size_t chunks = std::max<size_t>(
+      1, (count + kStatManyChunkSize - 1) / kStatManyChunkSize);
+  job->pending = chunks;
+  for (size_t i = 0; i < chunks; i++) {
+    size_t begin = std::min(i * kStatManyChunkSize, count);
+    size_t end = std::min(begin + kStatManyChunkSize, count);
+    (new StatManyWork(env, job, begin, end))->ScheduleWork();
+  }
+}
+
 static void FStat(const FunctionCallbackInfo<Value>& args) {
   Realm* realm = Realm::GetCurrent(args);
   BindingData* binding_data = realm->GetBindingData<BindingData>();
@@ -2755,6 +3022,406 @@ static void ReadFileUtf8(const FunctionCallbackInfo<Value>& args) {
   args.GetReturnValue().Set(val);
 }
 
+// Reads a batch of whole files on a single threadpool work item. For every
+// path, the open/fstat/read/close sequence runs back to back on the worker
+// thread, so reading N small files costs one threadpool hop instead of 4 * N.
+class ReadFileBatchWork final : public ThreadPoolWork {
+ public:
+  struct Entry {
+    std::string path;
+    int err = 0;
+    const char* syscall = nullptr;
+    char* data = nullptr;
+    size_t length = 0;
+  };
+
+  ReadFileBatchWork(Environment* env,
+                    FSReqBase* req_wrap,
+                    std::vector<Entry>&& entries,
+                    int flags,
+                    enum encoding encoding)
+      : ThreadPoolWork(env, "readFileBatch"),
+        req_wrap_(req_wrap),
+        entries_(std::move(entries)),
+        flags_(flags),
+        encoding_(encoding) {}
+
+  ~ReadFileBatchWork() override {
+    for (Entry& entry : entries_) free(entry.data);
+  }
+
+  void DoThreadPoolWork() override {
+    for (Entry& entry : entries_) ReadOne(&entry, flags_);
+  }
+
+  void AfterThreadPoolWork(int status) override {
+    std::unique_ptr<ReadFileBatchWork> self(this);
+    if (!env()->can_call_into_js()) return;
+
+    HandleScope handle_scope(env()->isolate());
+    Context::Scope context_scope(env()->context());
+    BaseObjectPtr<FSReqBase> req_wrap = std::move(req_wrap_);
+    // The work was cancelled before it ran, e.g. through its admission
+    // queue, so none of the files have been read.
+    if (status != 0) {
+      return req_wrap->Reject(UVException(env()->isolate(), status, "read"));
+    }
+    TryCatch try_catch(env()->isolate());
+    Local<Array> result;
+    if (!ToArray(env(), &entries_, encoding_).ToLocal(&result)) {
+      CHECK(try_catch.CanContinue());
+      return req_wrap->Reject(try_catch.Exception());
+    }
+    req_wrap->Resolve(result);
+  }
+
+  // Reads the file at entry->path in full. Failures are recorded on the entry
+  // rather than aborting the batch, so that one missing file does not hide
+  // the contents of the others.
+  static void ReadOne(Entry* entry, int flags) {
+    uv_fs_t req;
+    const int fd =
+        uv_fs_open(nullptr, &req, entry->path.c_str(), flags, 0666, nullptr);
+    uv_fs_req_cleanup(&req);
+    if (fd < 0) {
+      entry->err = fd;
+      entry->syscall = "open";
+      return;
+    }
+    auto defer_close = OnScopeLeave([fd]() {
+      uv_fs_t close_req;
+      CHECK_EQ(0, uv_fs_close(nullptr, &close_req, fd, nullptr));
+      uv_fs_req_cleanup(&close_req);
+    });
+
+    int err = uv_fs_fstat(nullptr, &req, fd, nullptr);
+    const uint64_t size = req.statbuf.st_size;
+    const bool is_regular = (req.statbuf.st_mode & S_IFMT) == S_IFREG;
+    uv_fs_req_cleanup(&req);
+    if (err < 0) {
+      entry->err = err;
+      entry->syscall = "fstat";
+      return;
+    }
+    if (size > Buffer::kMaxLength) {
+      entry->err = UV_EFBIG;
+      entry->syscall = "read";
+      return;
+    }
+
+    // Files such as those in procfs report a size of 0 even though they have
+    // content, so only trust the size for regular, non-empty files.
+    const bool trust_size = is_regular && size > 0;
+    size_t capacity = trust_size ? static_cast<size_t>(size) : 8192;
+    while (true) {
+      if (entry->data == nullptr || entry->length == capacity) {
+        if (entry->data != nullptr) capacity *= 2;
+        if (capacity > Buffer::kMaxLength) {
+          entry->err = UV_EFBIG;
+          entry->syscall = "read";
+          return;
+        }
+        char* data = UncheckedRealloc(entry->data, capacity);
+        if (data == nullptr) {
+          entry->err = UV_ENOMEM;
+          entry->syscall = "read";
+          return;
+        }
+        entry->data = data;
+      }
+
+      uv_buf_t buf = uv_buf_init(entry->data + entry->length,
+                                 capacity - entry->length);
+      const int r = uv_fs_read(nullptr, &req, fd, &buf, 1, -1, nullptr);
+      uv_fs_req_cleanup(&req);
+      if (r < 0) {
+        entry->err = r;
+        entry->syscall = "read";
+        return;
+      }
+      if (r == 0) break;
+      entry->length += r;
+      // Once a regular file has been read up to its reported size, skip the
+      // extra read(2) that would only confirm EOF.
+      if (trust_size && entry->length == size) break;
+    }
+  }
+
+  // Converts the entries into a JS array holding, for every path in order,
+  // either the file contents or the error that was encountered while reading
+  // it. Ownership of the read data is transferred to the JS Buffers.
+  static MaybeLocal<Array> ToArray(Environment* env,
+                                   std::vector<Entry>* entries,
+                                   enum encoding encoding) {
+    Isolate* isolate = env->isolate();
+    EscapableHandleScope scope(isolate);
+    LocalVector<Value> values(isolate);
+    values.reserve(entries->size());
+
+    for (Entry& entry : *entries) {
+      Local<Value> value;
+      if (entry.err < 0) {
+        value = UVException(
+            isolate, entry.err, entry.syscall, nullptr, entry.path.c_str());
+      } else if (encoding == BUFFER) {
+        char* data = entry.data;
+        entry.data = nullptr;
+        Local<Object> buffer;
+        if (!Buffer::New(env, data, entry.length).ToLocal(&buffer)) {
+          return MaybeLocal<Array>();
+        }
+        value = buffer;
+      } else if (!StringBytes::Encode(
+                      isolate, entry.data, entry.length, encoding)
+                      .ToLocal(&value)) {
+        return MaybeLocal<Array>();
+      }
+      values.push_back(value);
+    }
+
+    return scope.Escape(Array::New(isolate, values.data(), values.size()));
+  }
+
+ private:
+  BaseObjectPtr<FSReqBase> req_wrap_;
+  std::vector<Entry> entries_;
+  const int flags_;
+  const enum encoding encoding_;
+};
+
+// Reads several whole files with a single native call.
+//
+// results = fs.readFileBatch(paths, flags, encoding[, req])
+// 0 paths     array of paths to read
+// 1 flags     integer. flags used to open every file
+// 2 encoding  encoding of the results, or 'buffer' for Buffers
+// 3 req       if present, the files are read on one threadpool work item
+//             and req is resolved with the results
+//
+// The results array contains, for each path, either its contents or the
+// uv exception describing why it could not be read.
+static void ReadFileBatch(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Isolate* isolate = env->isolate();
+
+  const int argc = args.Length();
+  CHECK_GE(argc, 3);
+
+  CHECK(args[0]->IsArray());
+  Local<Array> paths = args[0].As<Array>();
+
+  CHECK(args[1]->IsInt32());
+  const int flags = args[1].As<Int32>()->Value();
+
+  const enum encoding encoding = ParseEncoding(isolate, args[2], BUFFER);
+
+  FSReqBase* req_wrap_async = nullptr;
+  if (argc > 3) {  // readFileBatch(paths, flags, encoding, req)
+    req_wrap_async = GetReqWrap(args, 3);
+    CHECK_NOT_NULL(req_wrap_async);
+  }
+
+  std::vector<ReadFileBatchWork::Entry> entries(paths->Length());
+  for (uint32_t i = 0; i < entries.size(); i++) {
+    Local<Value> value;
+    if (!paths->Get(env->context(), i).ToLocal(&value)) return;
+    BufferValue path(isolate, value);
+    CHECK_NOT_NULL(*path);
+    ToNamespacedPath(env, &path);
+    if (req_wrap_async != nullptr) {
+      if (AsyncCheckOpenPermissions(env, req_wrap_async, path, flags)
+              .IsNothing()) {
+        return;
+      }
+    } else if (CheckOpenPermissions(env, path, flags).IsNothing()) {
+      return;
+    }
+    entries[i].path = path.ToString();
+  }
+
+  if (req_wrap_async != nullptr) {
+    req_wrap_async->Init("read", nullptr, 0, encoding);
+    auto* work = new ReadFileBatchWork(
+        env, req_wrap_async, std::move(entries), flags, encoding);
+    work->ScheduleWork();
+    req_wrap_async->SetReturnValue(args);
+    return;
+  }
+
+  FS_SYNC_TRACE_BEGIN(read);
+  for (ReadFileBatchWork::Entry& entry : entries) {
+    ReadFileBatchWork::ReadOne(&entry, flags);
+  }
+  FS_SYNC_TRACE_END(read);
+
+  auto defer_free = OnScopeLeave([&entries]() {
+    for (ReadFileBatchWork::Entry& entry : entries) free(entry.data);
+  });
+  Local<Array> result;
+  if (ReadFileBatchWork::ToArray(env, &entries, encoding).ToLocal(&result)) {
+    args.GetReturnValue().Set(result);
+  }
+}
+
+namespace {
+
+// A file mapping backing a Buffer created by mapFile(). `base` and `length`
+// describe the whole mapping, which starts at a page-aligned offset at or
+// before the requested one.
+struct FileMapping {
+  void* base;
+  size_t length;
+#ifdef _WIN32
+  HANDLE handle;
+#endif
+};
+
+void FreeFileMapping(char* data, void* hint) {
+  FileMapping* mapping = static_cast<FileMapping*>(hint);
+#ifdef _WIN32
+  UnmapViewOfFile(mapping->base);
+  CloseHandle(mapping->handle);
+#else
+  munmap(mapping->base, mapping->length);
+#endif
+  delete mapping;
+}
+
+}  // namespace
+
+// Maps part of a file into memory and returns it as a Buffer, without
+// copying. The mapping is private and copy-on-write: writes through the
+// Buffer are never written back to the file, and pages are only copied when
+// written to. It is unmapped once the Buffer's backing store is freed. As with
+// any mapping, truncating the file while it is mapped makes accesses past its
+// new end fault.
+//
+// buffer = fs.mapFile(path, offset, length, advice)
+// 0 path    path of the file to map
+// 1 offset  number. byte offset into the file
+// 2 length  number of bytes to map, or -1 for the rest of the file
+// 3 advice  0 (normal), 1 (sequential), 2 (random) or 3 (willneed),
+//           passed to madvise(2) where available
+static void MapFile(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Isolate* isolate = env->isolate();
+
+  CHECK_EQ(args.Length(), 4);
+
+  BufferValue path(isolate, args[0]);
+  CHECK_NOT_NULL(*path);
+  ToNamespacedPath(env, &path);
+  THROW_IF_INSUFFICIENT_PERMISSIONS(
+      env, permission::PermissionScope::kFileSystemRead, path.ToStringView());
+
+  CHECK(IsSafeJsInt(args[1]));
+  const int64_t offset = args[1].As<Integer>()->Value();
+  CHECK_GE(offset, 0);
+  CHECK(IsSafeJsInt(args[2]));
+  int64_t length = args[2].As<Integer>()->Value();
+  CHECK(args[3]->IsInt32());
+  const int advice = args[3].As<Int32>()->Value();
+
+  uv_fs_t req;
+  auto cleanup = OnScopeLeave([&req]() { uv_fs_req_cleanup(&req); });
+  int fd = uv_fs_open(nullptr, &req, *path, O_RDONLY, 0, nullptr);
+  uv_fs_req_cleanup(&req);
+  if (fd < 0) {
+    return env->ThrowUVException(fd, "open", nullptr, *path);
+  }
+  auto close_fd = OnScopeLeave([fd]() {
+    uv_fs_t close_req;
+    CHECK_EQ(0, uv_fs_close(nullptr, &close_req, fd, nullptr));
+    uv_fs_req_cleanup(&close_req);
+  });
+
+  int err = uv_fs_fstat(nullptr, &req, fd, nullptr);
+  if (err < 0) {
+    return env->ThrowUVException(err, "fstat", nullptr, *path);
+  }
+  const int64_t file_size = static_cast<int64_t>(req.statbuf.st_size);
+  if (offset > file_size || (length >= 0 && offset + length > file_size)) {
+    return env->ThrowUVException(UV_EINVAL, "mmap", nullptr, *path);
+  }
+  if (length < 0) length = file_size - offset;
+  if (static_cast<uint64_t>(length) > Buffer::kMaxLength) {
+    isolate->ThrowException(ERR_BUFFER_TOO_LARGE(isolate));
+    return;
+  }
+  if (length == 0) {
+    Local<Object> empty;
+    if (Buffer::New(isolate, 0).ToLocal(&empty)) {
+      args.GetReturnValue().Set(empty);
+    }
+    return;
+  }
+
+  auto* mapping = new FileMapping();
+#ifdef _WIN32
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  const int64_t granularity = info.dwAllocationGranularity;
+#else
+  const int64_t granularity = sysconf(_SC_PAGESIZE);
+#endif
+  const int64_t aligned_offset = offset - (offset % granularity);
+  const size_t delta = static_cast<size_t>(offset - aligned_offset);
+  mapping->length = static_cast<size_t>(length) + delta;
+
+#ifdef _WIN32
+  mapping->handle = CreateFileMappingW(
+      reinterpret_cast<HANDLE>(uv_get_osfhandle(fd)),
+      nullptr,
+      PAGE_WRITECOPY,
+      0,
+      0,
+      nullptr);
+  if (mapping->handle != nullptr) {
+    mapping->base = MapViewOfFile(mapping->handle,
+                                  FILE_MAP_COPY,
+                                  static_cast<DWORD>(aligned_offset >> 32),
+                                  static_cast<DWORD>(aligned_offset),
+                                  mapping->length);
+    if (mapping->base == nullptr) CloseHandle(mapping->handle);
+  } else {
+    mapping->base = nullptr;
+  }
+  if (mapping->base == nullptr) {
+    int uv_err = uv_translate_sys_error(GetLastError());
+    delete mapping;
+    return env->ThrowUVException(uv_err, "mmap", nullptr, *path);
+  }
+#else
+  mapping->base = mmap(nullptr,
+                       mapping->length,
+                       PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE,
+                       fd,
+                       aligned_offset);
+  if (mapping->base == MAP_FAILED) {
+    int uv_err = uv_translate_sys_error(errno);
+    delete mapping;
+    return env->ThrowUVException(uv_err, "mmap", nullptr, *path);
+  }
+  static constexpr int kAdvice[] = {
+      MADV_NORMAL, MADV_SEQUENTIAL, MADV_RANDOM, MADV_WILLNEED};
+  if (advice > 0 && advice < static_cast<int>(arraysize(kAdvice))) {
+    // The advice is only a hint, so failures are ignored.
+    madvise(mapping->base, mapping->length, kAdvice[advice]);
+  }
+#endif
+
+  Local<Object> buffer;
+  if (Buffer::New(env,
+                  static_cast<char*>(mapping->base) + delta,
+                  static_cast<size_t>(length),
+                  FreeFileMapping,
+                  mapping)
+          .ToLocal(&buffer)) {
+    args.GetReturnValue().Set(buffer);
+  }
+}
+
 // Wrapper for readv(2).
 //
 // bytesRead = fs.readv(fd, buffers[, position], callback)
@@ -3350,6 +4017,952 @@ static void CpSyncCheckPaths(const FunctionCallbackInfo<Value>& args) {
   }
 }
 
+// Native engine for recursive fs.cp(). The tree is walked and copied by a
+// small pool of dedicated threads using synchronous libuv calls. Regular files
+// go through uv_fs_copyfile(), which clones with FICLONE (Linux) or
+// copyfile(3) (macOS) when UV_FS_COPYFILE_FICLONE is set, and otherwise uses
+// copy_file_range()/sendfile(). Directory modes and timestamps are applied in
+// one pass once all of their contents have been copied.
+class CpJob final {
+ public:
+  enum Flags : int {
+    kForce = 1 << 0,
+    kErrorOnExist = 1 << 1,
+    kDereference = 1 << 2,
+    kPreserveTimestamps = 1 << 3,
+    kVerbatimSymlinks = 1 << 4,
+  };
+
+  CpJob(Environment* env,
+        FSReqBase* req_wrap,
+        std::string&& src,
+        std::string&& dest,
+        int flags,
+        int copyfile_mode,
+        unsigned int concurrency,
+        Local<Value> on_progress)
+      : env_(env),
+        req_wrap_(req_wrap),
+        flags_(flags),
+        copyfile_mode_(copyfile_mode),
+        concurrency_(concurrency) {
+    if (on_progress->IsFunction()) {
+      on_progress_.Reset(env->isolate(), on_progress.As<Function>());
+    }
+    tasks_.push_back({std::move(src), std::move(dest)});
+  }
+
+  // Returns 0, or a libuv error code if the job could not be started, in
+  // which case the request is left for the caller to reject. Either way the
+  // job deletes itself after it is done with the request.
+  int Start() {
+    int err = uv_async_init(env_->event_loop(), &async_, OnAsync);
+    if (err != 0) {
+      req_wrap_->Detach();
+      delete this;
+      return err;
+    }
+
+    {
+      // Workers block on the mutex until the thread count is final.
+      Mutex::ScopedLock lock(mutex_);
+      threads_.resize(concurrency_);
+      unsigned int started = 0;
+      for (; started < concurrency_; started++) {
+        err = uv_thread_create(
+            &threads_[started],
+            [](void* arg) { static_cast<CpJob*>(arg)->Work(); },
+            this);
+        if (err != 0) break;
+      }
+      threads_.resize(started);
+      concurrency_ = started;
+    }
+
+    if (concurrency_ == 0) {
+      Close();
+      return err;
+    }
+    env_->AddCleanupHook(Cleanup, this);
+    return 0;
+  }
+
+ private:
+  struct Task {
+    std::string src;
+    std::string dest;
+  };
+
+  struct DirectoryMetadata {
+    std::string path;
+    int mode;
+    uv_timespec_t atime;
+    uv_timespec_t mtime;
+    bool created;
+  };
+
+  void Work() {
+    Mutex::ScopedLock lock(mutex_);
+    while (true) {
+      while (tasks_.empty() && active_ > 0 && error_ == 0) {
+        cond_.Wait(lock);
+      }
+      if (tasks_.empty() || error_ != 0) break;
+
+      Task task = std::move(tasks_.front());
+      tasks_.pop_front();
+      active_++;
+      {
+        Mutex::ScopedUnlock unlock(lock);
+        CopyEntry(task);
+      }
+      active_--;
+    }
+    cond_.Broadcast(lock);
+
+    if (++finished_ == concurrency_) {
+      if (error_ == 0) ApplyDirectoryMetadata();
+      done_ = true;
+      uv_async_send(&async_);
+    }
+  }
+
+  void Push(std::string&& src, std::string&& dest) {
+    Mutex::ScopedLock lock(mutex_);
+    tasks_.push_back({std::move(src), std::move(dest)});
+    cond_.Signal(lock);
+  }
+
+  void Fail(int err, const char* syscall, const std::string& path) {
+    Mutex::ScopedLock lock(mutex_);
+    if (error_ != 0) return;
+    error_ = err;
+    error_syscall_ = syscall;
+    error_path_ = path;
+    cond_.Broadcast(lock);
+  }
+
+  // Every entry is checked against the permission model, not just the
+  // roots: a grant for a directory does not cover what its symlinks point
+  // to. Fails the job if access to path is denied.
+  bool CheckPermission(permission::PermissionScope scope,
+                       const std::string& path) {
+    if (env_->permission()->is_granted(env_, scope, path)) return true;
+    Mutex::ScopedLock lock(mutex_);
+    if (error_ != 0) return false;
+    error_ = UV_EPERM;
+    error_path_ = path;
+    denied_scope_ = scope;
+    cond_.Broadcast(lock);
+    return false;
+  }
+
+  void CopyEntry(const Task& task) {
+    if (!CheckPermission(permission::PermissionScope::kFileSystemRead,
+                         task.src) ||
+        !CheckPermission(permission::PermissionScope::kFileSystemWrite,
+                         task.dest)) {
+      return;
+    }
+
+    uv_fs_t req;
+    const bool dereference = flags_ & kDereference;
+    int err = uv_fs_lstat(nullptr, &req, task.src.c_str(), nullptr);
+    uv_stat_t stat = req.statbuf;
+    uv_fs_req_cleanup(&req);
+    if (err < 0) return Fail(err, "lstat", task.src);
+
+    if (dereference && (stat.st_mode & S_IFMT) == S_IFLNK) {
+      // What is copied is the target, which must be readable as well. The
+      // walk continues from there, so that the entries of a directory are
+      // checked by their real paths too.
+      err = uv_fs_realpath(nullptr, &req, task.src.c_str(), nullptr);
+      if (err < 0) {
+        uv_fs_req_cleanup(&req);
+        return Fail(err, "realpath", task.src);
+      }
+      Task resolved{static_cast<const char*>(req.ptr), task.dest};
+      uv_fs_req_cleanup(&req);
+      if (!CheckPermission(permission::PermissionScope::kFileSystemRead,
+                           resolved.src)) {
+        return;
+      }
+      err = uv_fs_stat(nullptr, &req, resolved.src.c_str(), nullptr);
+      stat = req.statbuf;
+      uv_fs_req_cleanup(&req);
+      if (err < 0) return Fail(err, "stat", task.src);
+      return CopyByType(resolved, stat);
+    }
+
+    CopyByType(task, stat);
+  }
+
+  void CopyByType(const Task& task, const uv_stat_t& stat) {
+    switch (stat.st_mode & S_IFMT) {
+      case S_IFDIR:
+        return CopyDirectory(task, stat);
+      case S_IFREG:
+        return CopyRegularFile(task, stat);
+      case S_IFLNK:
+        return CopySymlink(task);
+      default:
+        return Fail(UV_EINVAL, "cp", task.src);
+    }
+  }
+
+  void CopyDirectory(const Task& task, const uv_stat_t& stat) {
+    uv_fs_t req;
+#ifdef __APPLE__
+    // clonefile(2) copies a whole tree, including metadata, in one call when
+    // the destination does not exist yet.
+    // It copies whatever is below the directory without checking it against
+    // the permission model though.
+    if ((flags_ & kPreserveTimestamps) && !(flags_ & kDereference) &&
+        !env_->permission()->enabled() &&
+        (copyfile_mode_ & (UV_FS_COPYFILE_FICLONE |
+                           UV_FS_COPYFILE_FICLONE_FORCE)) &&
+        clonefile(task.src.c_str(), task.dest.c_str(), CLONE_NOFOLLOW) == 0) {
+      return;
+    }
+#endif
+
+    // Create the directory writable; its real mode is applied at the end.
+    int err = uv_fs_mkdir(nullptr, &req, task.dest.c_str(), 0777, nullptr);
+    uv_fs_req_cleanup(&req);
+    bool created = err == 0;
+    if (err == UV_EEXIST) {
+      // Without dereferencing, a symlink at the destination is not followed.
+      err = (flags_ & kDereference)
+                ? uv_fs_stat(nullptr, &req, task.dest.c_str(), nullptr)
+                : uv_fs_lstat(nullptr, &req, task.dest.c_str(), nullptr);
+      if (err == 0 && (req.statbuf.st_mode & S_IFMT) != S_IFDIR) {
+        err = UV_ENOTDIR;
+      }
+      uv_fs_req_cleanup(&req);
+    }
+    if (err < 0) return Fail(err, "mkdir", task.dest);
+
+    {
+      Mutex::ScopedLock lock(mutex_);
+      directories_.push_back({task.dest,
+                              static_cast<int>(stat.st_mode & 07777),
+                              stat.st_atim,
+                              stat.st_mtim,
+                              created});
+    }
+
+    err = uv_fs_scandir(nullptr, &req, task.src.c_str(), 0, nullptr);
+    if (err < 0) {
+      uv_fs_req_cleanup(&req);
+      return Fail(err, "scandir", task.src);
+    }
+    uv_dirent_t ent;
+    while (uv_fs_scandir_next(&req, &ent) != UV_EOF) {
+      Push(task.src + kPathSeparator + ent.name,
+           task.dest + kPathSeparator + ent.name);
+    }
+    uv_fs_req_cleanup(&req);
+  }
+
+  void CopyRegularFile(const Task& task, const uv_stat_t& stat) {
+    uv_fs_t req;
+    int mode = copyfile_mode_;
+    if (!(flags_ & kForce)) mode |= UV_FS_COPYFILE_EXCL;
+
+    // uv_fs_copyfile() would write through a symlink at the destination,
+    // which is only wanted when dereferencing. Otherwise the symlink itself
+    // is replaced.
+    if (!(flags_ & kDereference) &&
+        uv_fs_lstat(nullptr, &req, task.dest.c_str(), nullptr) == 0 &&
+        (req.statbuf.st_mode & S_IFMT) == S_IFLNK) {
+      uv_fs_req_cleanup(&req);
+      if (!(flags_ & kForce)) {
+        if (flags_ & kErrorOnExist) return Fail(UV_EEXIST, "cp", task.dest);
+        return;
+      }
+      int err = uv_fs_unlink(nullptr, &req, task.dest.c_str(), nullptr);
+      uv_fs_req_cleanup(&req);
+      if (err < 0) return Fail(err, "unlink", task.dest);
+    } else {
+      uv_fs_req_cleanup(&req);
+    }
+
+    int err = uv_fs_copyfile(
+        nullptr, &req, task.src.c_str(), task.dest.c_str(), mode, nullptr);
+    uv_fs_req_cleanup(&req);
+    if (err == UV_EEXIST && !(flags_ & kForce)) {
+      if (flags_ & kErrorOnExist) return Fail(err, "cp", task.dest);
+      return;
+    }
+    if (err < 0) return Fail(err, "copyfile", task.src);
+
+    if (flags_ & kPreserveTimestamps) {
+      err = uv_fs_utime(nullptr,
+                        &req,
+                        task.dest.c_str(),
+                        TimespecToDouble(stat.st_atim),
+                        TimespecToDouble(stat.st_mtim),
+                        nullptr);
+      uv_fs_req_cleanup(&req);
+      if (err < 0) return Fail(err, "utime", task.dest);
+    }
+
+    files_copied_++;
+    bytes_copied_ += stat.st_size;
+    uv_async_send(&async_);
+  }
+
+  void CopySymlink(const Task& task) {
+    uv_fs_t req;
+    int err = uv_fs_readlink(nullptr, &req, task.src.c_str(), nullptr);
+    if (err < 0) {
+      uv_fs_req_cleanup(&req);
+      return Fail(err, "readlink", task.src);
+    }
+    std::string target(static_cast<const char*>(req.ptr));
+    uv_fs_req_cleanup(&req);
+
+    if (!(flags_ & kVerbatimSymlinks) &&
+        !std::filesystem::path(target).is_absolute()) {
+      // Like path.resolve(path.dirname(src), target) in JS.
+      std::filesystem::path resolved =
+          std::filesystem::path(task.src).parent_path() / target;
+      target = resolved.lexically_normal().string();
+    }
+
+    int symlink_flags = 0;
+#ifdef _WIN32
+    err = uv_fs_stat(nullptr, &req, target.c_str(), nullptr);
+    if (err == 0 && (req.statbuf.st_mode & S_IFMT) == S_IFDIR) {
+      symlink_flags = UV_FS_SYMLINK_DIR;
+    }
+    uv_fs_req_cleanup(&req);
+#endif
+
+    err = uv_fs_symlink(nullptr,
+                        &req,
+                        target.c_str(),
+                        task.dest.c_str(),
+                        symlink_flags,
+                        nullptr);
+    uv_fs_req_cleanup(&req);
+    if (err == UV_EEXIST) {
+      if (!(flags_ & kForce)) {
+        if (flags_ & kErrorOnExist) return Fail(err, "cp", task.dest);
+        return;
+      }
+      err = uv_fs_unlink(nullptr, &req, task.dest.c_str(), nullptr);
+      uv_fs_req_cleanup(&req);
+      if (err == 0) {
+        err = uv_fs_symlink(nullptr,
+                            &req,
+                            target.c_str(),
+                            task.dest.c_str(),
+                            symlink_flags,
+                            nullptr);
+        uv_fs_req_cleanup(&req);
+      }
+    }
+    if (err < 0) return Fail(err, "symlink", task.dest);
+  }
+
+  // Called by the last worker to finish, with the mutex held. A directory is
+  // always recorded before its subdirectories, so going backwards handles
+  // the children first, before the mode of a parent may take away the right
+  // to access them.
+  void ApplyDirectoryMetadata() {
+    uv_fs_t req;
+    for (auto dir = directories_.rbegin(); dir != directories_.rend(); ++dir) {
+      int err = 0;
+      const char* syscall = "utime";
+      if (flags_ & kPreserveTimestamps) {
+        err = uv_fs_utime(nullptr,
+                          &req,
+                          dir->path.c_str(),
+                          TimespecToDouble(dir->atime),
+                          TimespecToDouble(dir->mtime),
+                          nullptr);
+        uv_fs_req_cleanup(&req);
+      }
+      if (err == 0 && dir->created) {
+        syscall = "chmod";
+        err =
+            uv_fs_chmod(nullptr, &req, dir->path.c_str(), dir->mode, nullptr);
+        uv_fs_req_cleanup(&req);
+      }
+      if (err < 0) {
+        error_ = err;
+        error_syscall_ = syscall;
+        error_path_ = dir->path;
+        return;
+      }
+    }
+  }
+
+  static double TimespecToDouble(const uv_timespec_t& ts) {
+    return static_cast<double>(ts.tv_sec) + ts.tv_nsec / 1e9;
+  }
+
+  static void OnAsync(uv_async_t* handle) {
+    CpJob* job = ContainerOf(&CpJob::async_, handle);
+    job->OnProgressOrDone();
+  }
+
+  void OnProgressOrDone() {
+    bool done;
+    {
+      Mutex::ScopedLock lock(mutex_);
+      done = done_;
+    }
+
+    HandleScope handle_scope(env_->isolate());
+    Context::Scope context_scope(env_->context());
+    if (!on_progress_.IsEmpty() && env_->can_call_into_js()) {
+      Local<Value> argv[] = {
+          Number::New(env_->isolate(),
+                      static_cast<double>(files_copied_.load())),
+          Number::New(env_->isolate(),
+                      static_cast<double>(bytes_copied_.load())),
+      };
+      req_wrap_->MakeCallback(
+          on_progress_.Get(env_->isolate()), arraysize(argv), argv);
+    }
+    if (!done) return;
+
+    JoinThreads();
+    env_->RemoveCleanupHook(Cleanup, this);
+    if (env_->can_call_into_js()) {
+      BaseObjectPtr<FSReqBase> wrap = req_wrap_;
+      if (denied_scope_.has_value()) {
+        permission::Permission::AsyncThrowAccessDenied(
+            env_, wrap.get(), *denied_scope_, error_path_);
+      } else if (error_ != 0) {
+        wrap->Reject(UVException(env_->isolate(),
+                                 error_,
+                                 error_syscall_,
+                                 nullptr,
+                                 error_path_.c_str()));
+      } else {
+        wrap->Resolve(Undefined(env_->isolate()));
+      }
+    }
+    Close();
+  }
+
+  void JoinThreads() {
+    for (uv_thread_t& thread : threads_) {
+      CHECK_EQ(uv_thread_join(&thread), 0);
+    }
+    threads_.clear();
+  }
+
+  void Close() {
+    req_wrap_->Detach();
+    req_wrap_.reset();
+    env_->CloseHandle(&async_, [](uv_async_t* handle) {
+      CpJob* job = ContainerOf(&CpJob::async_, handle);
+      delete job;
+    });
+  }
+
+  // Stops the workers after their current entry when the environment exits.
+  static void Cleanup(void* arg) {
+    CpJob* job = static_cast<CpJob*>(arg);
+    job->Fail(UV_ECANCELED, "cp", std::string());
+    job->JoinThreads();
+    job->Close();
+  }
+
+  Environment* const env_;
+  BaseObjectPtr<FSReqBase> req_wrap_;
+  v8::Global<Function> on_progress_;
+  const int flags_;
+  const int copyfile_mode_;
+  uv_async_t async_;
+  std::vector<uv_thread_t> threads_;
+
+  // These are protected by the mutex.
+  Mutex mutex_;
+  ConditionVariable cond_;
+  std::deque<Task> tasks_;
+  std::vector<DirectoryMetadata> directories_;
+  unsigned int concurrency_;
+  unsigned int active_ = 0;
+  unsigned int finished_ = 0;
+  bool done_ = false;
+  int error_ = 0;
+  const char* error_syscall_ = nullptr;
+  std::string error_path_;
+  // Set if error_ is because access to error_path_ was denied.
+  std::optional<permission::PermissionScope> denied_scope_;
+
+  std::atomic<uint64_t> files_copied_{0};
+  std::atomic<uint64_t> bytes_copied_{0};
+};
+
+// cpRecursive(src, dest, flags, copyfileMode, concurrency, onProgress, req)
+static void CpRecursive(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Isolate* isolate = env->isolate();
+
+  CHECK_EQ(args.Length(), 7);
+
+  BufferValue src(isolate, args[0]);
+  CHECK_NOT_NULL(*src);
+  ToNamespacedPath(env, &src);
+
+  BufferValue dest(isolate, args[1]);
+  CHECK_NOT_NULL(*dest);
+  ToNamespacedPath(env, &dest);
+
+  CHECK(args[2]->IsInt32());
+  int flags = args[2].As<Int32>()->Value();
+
+  int copyfile_mode;
+  if (!GetValidFileMode(env, args[3], UV_FS_COPYFILE).To(&copyfile_mode)) {
+    return;
+  }
+
+  CHECK(args[4]->IsUint32());
+  unsigned int concurrency = args[4].As<v8::Uint32>()->Value();
+  if (concurrency == 0) {
+    concurrency = std::min(4u, uv_available_parallelism());
+  }
+
+  FSReqBase* req_wrap_async = GetReqWrap(args, 6);
+  CHECK_NOT_NULL(req_wrap_async);
+  // The job checks every entry below the roots as well.
+  ASYNC_THROW_IF_INSUFFICIENT_PERMISSIONS(
+      env,
+      req_wrap_async,
+      permission::PermissionScope::kFileSystemRead,
+      src.ToStringView());
+  ASYNC_THROW_IF_INSUFFICIENT_PERMISSIONS(
+      env,
+      req_wrap_async,
+      permission::PermissionScope::kFileSystemWrite,
+      dest.ToStringView());
+
+  // Keep the request alive in case the job fails to start and releases it.
+  BaseObjectPtr<FSReqBase> req_wrap(req_wrap_async);
+  CpJob* job = new CpJob(env,
+                         req_wrap_async,
+                         src.ToString(),
+                         dest.ToString(),
+                         flags,
+                         copyfile_mode,
+                         concurrency,
+                         args[5]);
+  int err = job->Start();
+  if (err != 0) {
+    req_wrap->Reject(UVException(isolate, err, "cp", nullptr, *src));
+  }
+  req_wrap->SetReturnValue(args);
+}
+
+// Recursive directory walker backing readdirRecursive(). Directories are read
+// in large batches, using getdents64(2) on Linux and uv_fs_readdir()
+// elsewhere, from a queue of directories that one or more threads take from.
+// No thread ever waits for directories that another one is still reading.
+// Entries are reported as a NUL-separated list of paths relative to the root,
+// plus one UV_DIRENT_* type byte per entry.
+class ReaddirWalker final {
+ public:
+  ReaddirWalker(std::string&& root,
+                std::vector<std::string>&& include,
+                std::vector<std::string>&& exclude)
+      : root_(std::move(root)),
+        include_(std::move(include)),
+        exclude_(std::move(exclude)) {
+    directories_.emplace_back();
+  }
+
+  // Reads every directory on the calling thread.
+  void Work() {
+    while (ReadNextDirectory()) {
+    }
+  }
+
+  // Reads one queued directory, queueing its subdirectories. Returns false
+  // if there was none left to read or an error has occurred. Safe to call
+  // from several threads at once.
+  bool ReadNextDirectory() {
+    std::string directory;
+    {
+      Mutex::ScopedLock lock(mutex_);
+      if (directories_.empty() || error_ != 0) return false;
+      directory = std::move(directories_.front());
+      directories_.pop_front();
+    }
+    Result result;
+    ReadDirectory(directory, &result);
+    Mutex::ScopedLock lock(mutex_);
+    names_ += result.names;
+    types_.insert(types_.end(), result.types.begin(), result.types.end());
+    return true;
+  }
+
+  bool HasPendingDirectories() {
+    Mutex::ScopedLock lock(mutex_);
+    return !directories_.empty() && error_ == 0;
+  }
+
+  // Only valid once no ReadNextDirectory() call is running.
+  const std::string& names() const { return names_; }
+  const std::vector<uint8_t>& types() const { return types_; }
+  int error() const { return error_; }
+  const char* error_syscall() const { return error_syscall_; }
+  const std::string& error_path() const { return error_path_; }
+
+ private:
+  struct Result {
+    std::string names;
+    std::vector<uint8_t> types;
+  };
+
+  std::string FullPath(const std::string& relative) const {
+    if (relative.empty()) return root_;
+    return root_ + kPathSeparator + relative;
+  }
+
+  static bool MatchesAny(const std::vector<std::string>& patterns,
+                         const std::string& relative) {
+#ifdef _WIN32
+    std::string path = relative;
+    std::replace(path.begin(), path.end(), '\\', '/');
+#else
+    const std::string& path = relative;
+#endif
+    for (const std::string& pattern : patterns) {
+      if (GlobMatch(pattern, path)) return true;
+    }
+    return false;
+  }
+
+  void Fail(int err, const char* syscall, std::string&& path) {
+    Mutex::ScopedLock lock(mutex_);
+    if (error_ != 0) return;
+    error_ = err;
+    error_syscall_ = syscall;
+    error_path_ = std::move(path);
+  }
+
+  void AddEntry(const std::string& directory,
+                std::string_view name,
+                int type,
+                Result* result) {
+    if (name == "." || name == "..") return;
+    std::string relative =
+        directory.empty() ? std::string(name)
+                          : directory + kPathSeparator + std::string(name);
+    if (type == UV_DIRENT_UNKNOWN) {
+      uv_fs_t req;
+      if (uv_fs_lstat(nullptr, &req, FullPath(relative).c_str(), nullptr) ==
+          0) {
+        switch (req.statbuf.st_mode & S_IFMT) {
+          case S_IFREG:
+            type = UV_DIRENT_FILE;
+            break;
+          case S_IFDIR:
+            type = UV_DIRENT_DIR;
+            break;
+          case S_IFLNK:
+            type = UV_DIRENT_LINK;
+            break;
+#ifndef _WIN32
+          case S_IFIFO:
+            type = UV_DIRENT_FIFO;
+            break;
+          case S_IFSOCK:
+            type = UV_DIRENT_SOCKET;
+            break;
+          case S_IFBLK:
+            type = UV_DIRENT_BLOCK;
+            break;
+#endif
+          case S_IFCHR:
+            type = UV_DIRENT_CHAR;
+            break;
+        }
+      }
+      uv_fs_req_cleanup(&req);
+    }
+
+    if (!exclude_.empty() && MatchesAny(exclude_, relative)) return;
+    if (include_.empty() || MatchesAny(include_, relative)) {
+      result->names.append(relative);
+      result->names.push_back('\0');
+      result->types.push_back(static_cast<uint8_t>(type));
+    }
+    if (type == UV_DIRENT_DIR) {
+      Mutex::ScopedLock lock(mutex_);
+      directories_.push_back(std::move(relative));
+    }
+  }
+
+#ifdef __linux__
+  // Layout of the records returned by getdents64(2).
+  struct LinuxDirent64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    uint16_t d_reclen;
+    uint8_t d_type;
+    char d_name[1];
+  };
+
+  static int DirentType(uint8_t d_type) {
+    switch (d_type) {
+      case DT_REG:
+        return UV_DIRENT_FILE;
+      case DT_DIR:
+        return UV_DIRENT_DIR;
+      case DT_LNK:
+        return UV_DIRENT_LINK;
+      case DT_FIFO:
+        return UV_DIRENT_FIFO;
+      case DT_SOCK:
+        return UV_DIRENT_SOCKET;
+      case DT_CHR:
+        return UV_DIRENT_CHAR;
+      case DT_BLK:
+        return UV_DIRENT_BLOCK;
+      default:
+        return UV_DIRENT_UNKNOWN;
+    }
+  }
+
+  void ReadDirectory(const std::string& directory, Result* result) {
+    std::string path = FullPath(directory);
+    int fd = open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd == -1) {
+      return Fail(uv_translate_sys_error(errno), "open", std::move(path));
+    }
+
+    alignas(LinuxDirent64) char buffer[32 * 1024];
+    while (true) {
+      long n = syscall(SYS_getdents64, fd, buffer, sizeof(buffer));  // NOLINT
+      if (n == 0) break;
+      if (n < 0) {
+        if (errno == EINTR) continue;
+        Fail(uv_translate_sys_error(errno), "getdents64", std::move(path));
+        break;
+      }
+      for (long offset = 0; offset < n;) {  // NOLINT(runtime/int)
+        const LinuxDirent64* ent =
+            reinterpret_cast<const LinuxDirent64*>(buffer + offset);
+        const char* name = buffer + offset + offsetof(LinuxDirent64, d_name);
+        AddEntry(directory, name, DirentType(ent->d_type), result);
+        offset += ent->d_reclen;
+      }
+    }
+    close(fd);
+  }
+#else
+  void ReadDirectory(const std::string& directory, Result* result) {
+    std::string path = FullPath(directory);
+    uv_fs_t req;
+    int err = uv_fs_opendir(nullptr, &req, path.c_str(), nullptr);
+    if (err < 0) {
+      uv_fs_req_cleanup(&req);
+      return Fail(err, "opendir", std::move(path));
+    }
+    uv_dir_t* dir = static_cast<uv_dir_t*>(req.ptr);
+    uv_fs_req_cleanup(&req);
+
+    uv_dirent_t dirents[128];
+    dir->dirents = dirents;
+    dir->nentries = arraysize(dirents);
+    while (true) {
+      err = uv_fs_readdir(nullptr, &req, dir, nullptr);
+      if (err <= 0) {
+        uv_fs_req_cleanup(&req);
+        if (err < 0) Fail(err, "readdir", std::move(path));
+        break;
+      }
+      for (int i = 0; i < err; i++) {
+        AddEntry(directory, dirents[i].name, dirents[i].type, result);
+      }
+      uv_fs_req_cleanup(&req);
+    }
+    uv_fs_closedir(nullptr, &req, dir, nullptr);
+    uv_fs_req_cleanup(&req);
+  }
+#endif  // __linux__
+
+  const std::string root_;
+  const std::vector<std::string> include_;
+  const std::vector<std::string> exclude_;
+
+  // These are protected by the mutex.
+  Mutex mutex_;
+  std::deque<std::string> directories_;
+  int error_ = 0;
+  const char* error_syscall_ = nullptr;
+  std::string error_path_;
+  std::string names_;
+  std::vector<uint8_t> types_;
+};
+
+static MaybeLocal<Value> ReaddirWalkerResult(Environment* env,
+                                             const ReaddirWalker& walker) {
+  Isolate* isolate = env->isolate();
+  Local<Object> names;
+  if (!Buffer::Copy(env, walker.names().data(), walker.names().size())
+           .ToLocal(&names)) {
+    return MaybeLocal<Value>();
+  }
+  size_t count = walker.types().size();
+  Local<v8::ArrayBuffer> types_buffer = v8::ArrayBuffer::New(isolate, count);
+  if (count > 0) {
+    memcpy(types_buffer->Data(), walker.types().data(), count);
+  }
+  Local<Value> result[] = {names,
+                           v8::Uint8Array::New(types_buffer, 0, count)};
+  return Array::New(isolate, result, arraysize(result));
+}
+
+// Shared by the threadpool work items of one asynchronous
+// readdirRecursive(). Each item reads a single directory, so that no
+// threadpool thread is held while there is nothing to read yet; more items
+// are scheduled from the loop thread as subdirectories are discovered.
+struct ReaddirRecursiveJob {
+  ReaddirRecursiveJob(Environment* env,
+                      FSReqBase* req_wrap,
+                      ReaddirWalker* walker,
+                      unsigned int concurrency)
+      : env(env),
+        req_wrap(req_wrap),
+        walker(walker),
+        concurrency(concurrency) {}
+
+  void Finish() {
+    BaseObjectPtr<FSReqBase> wrap = std::move(req_wrap);
+    if (env->can_call_into_js()) {
+      HandleScope handle_scope(env->isolate());
+      Context::Scope context_scope(env->context());
+      if (walker->error() != 0) {
+        wrap->Reject(UVException(env->isolate(),
+                                 walker->error(),
+                                 walker->error_syscall(),
+                                 nullptr,
+                                 walker->error_path().c_str()));
+      } else {
+        Local<Value> result;
+        if (ReaddirWalkerResult(env, *walker).ToLocal(&result)) {
+          wrap->Resolve(result);
+        }
+      }
+    }
+    wrap->Detach();
+  }
+
+  Environment* env;
+  BaseObjectPtr<FSReqBase> req_wrap;
+  std::unique_ptr<ReaddirWalker> walker;
+  const unsigned int concurrency;
+  unsigned int in_flight = 0;
+};
+
+class ReaddirRecursiveWork final : public ThreadPoolWork {
+ public:
+  // Tops the job up to its concurrency with one item per queued directory.
+  static void Schedule(const std::shared_ptr<ReaddirRecursiveJob>& job) {
+    while (job->in_flight < job->concurrency &&
+           job->walker->HasPendingDirectories()) {
+      job->in_flight++;
+      (new ReaddirRecursiveWork(job->env, job))->ScheduleWork();
+    }
+  }
+
+  void DoThreadPoolWork() override { job_->walker->ReadNextDirectory(); }
+
+  void AfterThreadPoolWork(int status) override {
+    std::shared_ptr<ReaddirRecursiveJob> job = std::move(job_);
+    delete this;
+    job->in_flight--;
+    Schedule(job);
+    if (job->in_flight == 0) job->Finish();
+  }
+
+ private:
+  ReaddirRecursiveWork(Environment* env,
+                       std::shared_ptr<ReaddirRecursiveJob> job)
+      : ThreadPoolWork(env, "fs_readdir"), job_(std::move(job)) {}
+
+  std::shared_ptr<ReaddirRecursiveJob> job_;
+};
+
+static bool ToStringVector(Isolate* isolate,
+                           Local<Value> value,
+                           std::vector<std::string>* result) {
+  if (!value->IsArray()) return true;
+  Local<Array> array = value.As<Array>();
+  Local<Context> context = isolate->GetCurrentContext();
+  for (uint32_t i = 0; i < array->Length(); i++) {
+    Local<Value> item;
+    if (!array->Get(context, i).ToLocal(&item)) return false;
+    Utf8Value str(isolate, item);
+    result->emplace_back(str.ToString());
+  }
+  return true;
+}
+
+// readdirRecursive(path, concurrency, include, exclude, req)
+// Returns, or resolves with, [names, types]; see ReaddirWalker. The entries
+// are not sorted.
+static void ReaddirRecursive(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Isolate* isolate = env->isolate();
+
+  CHECK_GE(args.Length(), 4);
+
+  BufferValue path(isolate, args[0]);
+  CHECK_NOT_NULL(*path);
+  ToNamespacedPath(env, &path);
+
+  CHECK(args[1]->IsUint32());
+  unsigned int concurrency = args[1].As<v8::Uint32>()->Value();
+  if (concurrency == 0) concurrency = 2;
+
+  std::vector<std::string> include;
+  std::vector<std::string> exclude;
+  if (!ToStringVector(isolate, args[2], &include) ||
+      !ToStringVector(isolate, args[3], &exclude)) {
+    return;
+  }
+
+  auto walker = std::make_unique<ReaddirWalker>(
+      path.ToString(), std::move(include), std::move(exclude));
+
+  if (args.Length() > 4) {  // readdirRecursive(..., req)
+    FSReqBase* req_wrap_async = GetReqWrap(args, 4);
+    CHECK_NOT_NULL(req_wrap_async);
+    ASYNC_THROW_IF_INSUFFICIENT_PERMISSIONS(
+        env,
+        req_wrap_async,
+        permission::PermissionScope::kFileSystemRead,
+        path.ToStringView());
+    auto job = std::make_shared<ReaddirRecursiveJob>(
+        env, req_wrap_async, walker.release(), concurrency);
+    ReaddirRecursiveWork::Schedule(job);
+    req_wrap_async->SetReturnValue(args);
+  } else {  // readdirRecursive(path, concurrency, include, exclude)
+    THROW_IF_INSUFFICIENT_PERMISSIONS(
+        env, permission::PermissionScope::kFileSystemRead, path.ToStringView());
+    walker->Work();
+    if (walker->error() != 0) {
+      return env->ThrowUVException(walker->error(),
+                                   walker->error_syscall(),
+                                   nullptr,
+                                   walker->error_path().c_str());
+    }
+    Local<Value> result;
+    if (ReaddirWalkerResult(env, *walker).ToLocal(&result)) {
+      args.GetReturnValue().Set(result);
+    }
+  }
+}
+
 BindingData::FilePathIsFileReturnType BindingData::FilePathIsFile(
     Environment* env, const std::string& file_path) {
   THROW_IF_INSUFFICIENT_PERMISSIONS(
@@ -3646,6 +5259,8 @@ static void CreatePerIsolateProperties(IsolateData* isolate_data,
   SetMethod(isolate, target, "openFileHandle", OpenFileHandle);
   SetMethod(isolate, target, "read", Read);
   SetMethod(isolate, target, "readFileUtf8", ReadFileUtf8);
+  SetMethod(isolate, target, "readFileBatch", ReadFileBatch);
+  SetMethod(isolate, target, "mapFile", MapFile);
   SetMethod(isolate, target, "readBuffers", ReadBuffers);
   SetMethod(isolate, target, "fdatasync", Fdatasync);
   SetMethod(isolate, target, "fsync", Fsync);
@@ -3662,6 +5277,7 @@ static void CreatePerIsolateProperties(IsolateData* isolate_data,
                 &fast_internal_module_stat_);
   SetMethod(isolate, target, "stat", Stat);
   SetMethod(isolate, target, "lstat", LStat);
+  SetMethod(isolate, target, "statMany", StatMany);
   SetMethod(isolate, target, "fstat", FStat);
   SetMethod(isolate, target, "statfs", StatFs);
   SetMethod(isolate, target, "link", Link);
@@ -3689,6 +5305,8 @@ static void CreatePerIsolateProperties(IsolateData* isolate_data,
   SetMethod(isolate, target, "mkdtemp", Mkdtemp);
 
   SetMethod(isolate, target, "cpSyncCheckPaths", CpSyncCheckPaths);
+  SetMethod(isolate, target, "cpRecursive", CpRecursive);
+  SetMethod(isolate, target, "readdirRecursive", ReaddirRecursive);
 
   StatWatcher::CreatePerIsolateProperties(isolate_data, target);
   BindingData::CreatePerIsolateProperties(isolate_data, target);
@@ -3773,6 +5391,8 @@ void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(OpenFileHandle);
   registry->Register(Read);
   registry->Register(ReadFileUtf8);
+  registry->Register(ReadFileBatch);
+  registry->Register(MapFile);
   registry->Register(ReadBuffers);
   registry->Register(Fdatasync);
   registry->Register(Fsync);
@@ -3787,6 +5407,7 @@ void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(fast_internal_module_stat_.GetTypeInfo());
   registry->Register(Stat);
   registry->Register(LStat);
+  registry->Register(StatMany);
   registry->Register(FStat);
   registry->Register(StatFs);
   registry->Register(Link);
@@ -3801,6 +5422,8 @@ void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(CopyFile);
 
   registry->Register(CpSyncCheckPaths);
+  registry->Register(CpRecursive);
+  registry->Register(ReaddirRecursive);
 
   registry->Register(Chmod);
   registry->Register(FChmod);
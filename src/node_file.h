@@ -3,13 +3,17 @@
 
 #if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
 
+#include <functional>
 #include <optional>
+#include <unordered_map>
 #include "aliased_buffer.h"
 #include "node_messaging.h"
 #include "node_snapshotable.h"
 #include "stream_base.h"
 
 namespace node {
+class StatWatcherGroup;
+
 namespace fs {
 
 class FileHandleReadWrap;
@@ -83,6 +87,9 @@ class BindingData : public SnapshotableObject {
   std::vector<BaseObjectPtr<FileHandleReadWrap>>
       file_handle_read_wrap_freelist;
 
+  // Groups of active StatWatchers, keyed by polling interval.
+  std::unordered_map<uint32_t, StatWatcherGroup*> stat_watcher_groups;
+
   SERIALIZABLE_OBJECT_METHODS()
   SET_BINDING_ID(fs_binding_data)
 
@@ -200,7 +207,8 @@ class FSReqBase : public ReqWrap<uv_fs_t> {
   FSReqBuffer buffer_;
 };
 
-class FSReqCallback final : public FSReqBase {
+class FSReqCallback final : public FSReqBase,
+                            public ThreadLocalFreeList<FSReqCallback> {
  public:
   inline FSReqCallback(BindingData* binding_data,
                        v8::Local<v8::Object> req,
@@ -224,6 +232,11 @@ void FillStatsArray(AliasedBufferBase<NativeT, V8T>* fields,
                     const uv_stat_t* s,
                     const size_t offset = 0);
 
+// Writes one record of kFsStatsFieldsNumber values, laid out like the
+// fs.Stats arrays above, into plain memory.
+template <typename NativeT>
+void FillStatsRecord(NativeT* fields, const uv_stat_t* s);
+
 inline v8::Local<v8::Value> FillGlobalStatsArray(BindingData* binding_data,
                                                  const bool use_bigint,
                                                  const uv_stat_t* s,
@@ -294,8 +307,8 @@ class FSReqAfterScope final {
 
 class FileHandle;
 
-// A request wrap specifically for uv_fs_read()s scheduled for reading
-// from a FileHandle.
+// A request wrap specifically for uv_fs_read()s and uv_fs_sendfile()s
+// scheduled for reading from a FileHandle.
 class FileHandleReadWrap final : public ReqWrap<uv_fs_t> {
  public:
   FileHandleReadWrap(FileHandle* handle, v8::Local<v8::Object> obj);
@@ -350,6 +363,24 @@ class FileHandle final : public AsyncWrap, public StreamBase {
   int ReadStart() override;
   int ReadStop() override;
 
+  using SendFileCallback = std::function<void(ssize_t result)>;
+
+  // Transfers up to `length` bytes from the current read position straight
+  // into `out_fd` with sendfile(2), advancing the read position like a
+  // regular read would without copying the data into userland. `cb` is
+  // called with the number of bytes sent, 0 at the end of the readable range,
+  // or a libuv error code. Returns an error if the transfer could not be
+  // started, e.g. because a read is in progress or the FileHandle has no
+  // explicit read offset.
+  int SendFile(uv_file out_fd, size_t length, SendFileCallback cb);
+
+  // Sets the size of the reads issued while reading the FileHandle as a
+  // stream. Defaults to 64 KiB.
+  void set_read_chunk_size(int64_t size) {
+    CHECK_GT(size, 0);
+    read_chunk_size_ = size;
+  }
+
   bool IsAlive() override { return !closed_; }
   bool IsClosing() override { return closing_; }
   AsyncWrap* GetAsyncWrap() override { return this; }
@@ -437,14 +468,19 @@ class FileHandle final : public AsyncWrap, public StreamBase {
   // Asynchronous close
   v8::MaybeLocal<v8::Promise> ClosePromise();
 
+  BaseObjectPtr<FileHandleReadWrap> GetReadWrap();
+  void RecycleReadWrap(BaseObjectPtr<FileHandleReadWrap>&& read_wrap);
+
   int fd_;
   bool closing_ = false;
   bool closed_ = false;
   bool reading_ = false;
   int64_t read_offset_ = -1;
   int64_t read_length_ = -1;
+  int64_t read_chunk_size_ = 65536;
 
   BaseObjectPtr<FileHandleReadWrap> current_read_;
+  SendFileCallback sendfile_cb_;
 
   BaseObjectPtr<BindingData> binding_data_;
 };
@@ -55,6 +55,12 @@ namespace {
 
 const char zero_bytes_256[256] = {};
 
+// Opaque payload of the PINGs used to sample the bandwidth-delay product.
+const uint8_t kBdpPingPayload[8] = {'n', 'o', 'd', 'e', 'b', 'd', 'p', 0};
+
+// The largest flow control window permitted by RFC 9113.
+constexpr uint32_t kMaxWindowSize = 0x7fffffffu;
+
 bool HasHttp2Observer(Environment* env) {
   AliasedUint32Array& observers = env->performance_state()->observers;
   return observers[performance::NODE_PERFORMANCE_ENTRY_TYPE_HTTP2] != 0;
@@ -218,6 +224,12 @@ Http2Options::Http2Options(Http2State* http2_state, SessionType type) {
         static_cast<uint64_t>(buffer[IDX_OPTIONS_STREAM_RESET_BURST]),
         static_cast<uint64_t>(buffer[IDX_OPTIONS_STREAM_RESET_RATE]));
   }
+
+  // When set, the receive windows of the session are grown according to the
+  // measured bandwidth-delay product of the connection, up to the given
+  // number of bytes, instead of staying at their configured size.
+  if (flags & (1 << IDX_OPTIONS_BDP_MAX_WINDOW))
+    set_bdp_max_window(buffer[IDX_OPTIONS_BDP_MAX_WINDOW]);
 }
 
 #define GRABSETTING(entries, count, name)                                      \
@@ -526,6 +538,8 @@ Http2Session::Callbacks::Callbacks(bool kHasGetPaddingCallback) {
   nghttp2_session_callbacks_set_error_callback2(callbacks_, OnNghttpError);
   nghttp2_session_callbacks_set_send_data_callback(
     callbacks_, OnSendData);
+  nghttp2_session_callbacks_set_data_source_read_length_callback(
+    callbacks_, OnDataSourceReadLength);
   nghttp2_session_callbacks_set_on_invalid_frame_recv_callback(
     callbacks_, OnInvalidFrame);
   nghttp2_session_callbacks_set_on_frame_send_callback(
@@ -569,6 +583,7 @@ Http2Session::Http2Session(Http2State* http2_state,
   Http2Options opts(http2_state, type);
 
   max_session_memory_ = opts.max_session_memory();
+  bdp_max_window_ = std::min(opts.bdp_max_window(), kMaxWindowSize);
 
   uint32_t maxHeaderPairs = opts.max_header_pairs();
   max_header_pairs_ =
@@ -728,6 +743,7 @@ MaybeLocal<Object> Http2SessionPerformanceEntryTraits::GetDetails(
   SET(ping_rtt_string, ping_rtt)
   SET(stream_average_duration_string, stream_average_duration)
   SET(stream_count_string, stream_count)
+  SET(bdp_estimate_string, bdp_estimate)
 
   if (!obj->Set(env->context(),
                 env->type_string(),
@@ -888,6 +904,7 @@ void Http2Session::AddStream(Http2Stream* stream) {
   if (size > statistics_.max_concurrent_streams)
     statistics_.max_concurrent_streams = size;
   IncrementCurrentSessionMemory(sizeof(*stream));
+  ApplyBdpWindow(stream->id());
 }
 
 
@@ -904,6 +921,27 @@ BaseObjectPtr<Http2Stream> Http2Session::RemoveStream(int32_t id) {
   return stream;
 }
 
+std::vector<Http2Header> Http2Session::AcquireHeaderBuffer() {
+  std::vector<Http2Header> headers;
+  if (!header_buffer_pool_.empty()) {
+    headers = std::move(header_buffer_pool_.back());
+    header_buffer_pool_.pop_back();
+  }
+  return headers;
+}
+
+void Http2Session::ReleaseHeaderBuffer(std::vector<Http2Header>&& headers) {
+  // Oversized buffers are dropped so that a single stream with a large
+  // header block does not pin that memory for the lifetime of the session.
+  if (header_buffer_pool_.size() >= kMaxPooledHeaderBuffers ||
+      headers.capacity() == 0 ||
+      headers.capacity() > kMaxPooledHeaderBufferPairs) {
+    return;
+  }
+  headers.clear();
+  header_buffer_pool_.emplace_back(std::move(headers));
+}
+
 // Used as one of the Padding Strategy functions. Will attempt to ensure
 // that the total frame size, including header bytes, are 8-byte aligned.
 // If maxPayloadLen is smaller than the number of bytes necessary to align,
@@ -1336,6 +1374,10 @@ int Http2Session::OnDataChunkReceived(nghttp2_session* handle,
   // so that it can send a WINDOW_UPDATE frame. This is a critical part of
   // the flow control process in http2
   CHECK_EQ(nghttp2_session_consume_connection(handle, len), 0);
+  if (session->bdp_max_window_ > 0) {
+    session->bdp_bytes_ += len;
+    session->MaybeSendBdpPing();
+  }
   BaseObjectPtr<Http2Stream> stream = session->FindStream(id);
 
   // If the stream has been destroyed, ignore this chunk
@@ -1420,6 +1462,26 @@ ssize_t Http2Session::OnSelectPadding(nghttp2_session* handle,
   return padding;
 }
 
+// Called by nghttp2 to size the next DATA frame. Without this callback it
+// never exceeds 16 KiB, even when the peer advertised a larger
+// SETTINGS_MAX_FRAME_SIZE. Since DATA payloads are written straight from the
+// stream's queue (see OnSendData), larger frames mean fewer frame header
+// copies and iovecs per message, not more payload copying.
+ssize_t Http2Session::OnDataSourceReadLength(
+    nghttp2_session* handle,
+    uint8_t frame_type,
+    int32_t stream_id,
+    int32_t session_remote_window_size,
+    int32_t stream_remote_window_size,
+    uint32_t remote_max_frame_size,
+    void* user_data) {
+  int64_t length = std::min<int64_t>(
+      {session_remote_window_size,
+       stream_remote_window_size,
+       static_cast<int64_t>(remote_max_frame_size)});
+  return static_cast<ssize_t>(std::max<int64_t>(length, 1));
+}
+
 // We use this currently to determine when an attempt is made to use the http2
 // protocol with a non-http2 peer.
 int Http2Session::OnNghttpError(nghttp2_session* handle,
@@ -1674,6 +1736,14 @@ void Http2Session::HandlePingFrame(const nghttp2_frame* frame) {
   Local<Value> arg;
   bool ack = frame->hd.flags & NGHTTP2_FLAG_ACK;
   if (ack) {
+    if (bdp_ping_sent_at_ != 0 &&
+        memcmp(frame->ping.opaque_data,
+               kBdpPingPayload,
+               sizeof(kBdpPingPayload)) == 0) {
+      HandleBdpPingAck();
+      return;
+    }
+
     BaseObjectPtr<Http2Ping> ping = PopPing();
 
     if (!ping) {
@@ -2229,7 +2299,9 @@ Http2Stream::Http2Stream(Http2Session* session,
   if (max_header_pairs_ == 0) {
     max_header_pairs_ = DEFAULT_MAX_HEADER_LIST_PAIRS;
   }
-  current_headers_.reserve(std::min(max_header_pairs_, 12u));
+  current_headers_ = session->AcquireHeaderBuffer();
+  if (current_headers_.capacity() == 0)
+    current_headers_.reserve(std::min(max_header_pairs_, 12u));
 
   // Limit the number of header octets
   max_header_length_ =
@@ -2328,6 +2400,7 @@ void Http2Stream::Destroy() {
   // Wait until the start of the next loop to delete because there
   // may still be some pending operations queued for this stream.
   BaseObjectPtr<Http2Stream> strong_ref = session_->RemoveStream(id_);
+  session_->ReleaseHeaderBuffer(std::move(current_headers_));
   if (strong_ref) {
     env()->SetImmediate([this, strong_ref = std::move(strong_ref)](
         Environment* env) {
@@ -3006,12 +3079,21 @@ void Http2Stream::Respond(const FunctionCallbackInfo<Value>& args) {
   Http2Stream* stream;
   ASSIGN_OR_RETURN_UNWRAP(&stream, args.This());
 
-  Local<Array> headers = args[0].As<Array>();
   int32_t options;
   if (!args[1]->Int32Value(env->context()).To(&options)) {
     return;
   }
 
+  if (Http2HeadersTemplate::HasInstance(env, args[0])) {
+    Http2HeadersTemplate* headers;
+    ASSIGN_OR_RETURN_UNWRAP(&headers, args[0]);
+    args.GetReturnValue().Set(
+        stream->SubmitResponse(headers->headers(), static_cast<int>(options)));
+    Debug(stream, "response submitted from template");
+    return;
+  }
+
+  Local<Array> headers = args[0].As<Array>();
   args.GetReturnValue().Set(
       stream->SubmitResponse(
           Http2Headers(env, headers),
@@ -3037,6 +3119,13 @@ void Http2Stream::Trailers(const FunctionCallbackInfo<Value>& args) {
   Http2Stream* stream;
   ASSIGN_OR_RETURN_UNWRAP(&stream, args.This());
 
+  if (Http2HeadersTemplate::HasInstance(env, args[0])) {
+    Http2HeadersTemplate* headers;
+    ASSIGN_OR_RETURN_UNWRAP(&headers, args[0]);
+    args.GetReturnValue().Set(stream->SubmitTrailers(headers->headers()));
+    return;
+  }
+
   Local<Array> headers = args[0].As<Array>();
 
   args.GetReturnValue().Set(
@@ -3234,6 +3323,78 @@ void Http2Session::Settings(const FunctionCallbackInfo<Value>& args) {
   args.GetReturnValue().Set(session->AddSettings(args[0].As<Function>()));
 }
 
+// Starts a new bandwidth-delay product sample unless one is already being
+// taken. The sample covers the DATA received between sending the PING and
+// receiving its acknowledgement, i.e. one round trip. Probing stops once the
+// window has reached its configured maximum, so an idle or saturated session
+// does not keep sending PINGs.
+void Http2Session::MaybeSendBdpPing() {
+  if (bdp_ping_sent_at_ != 0 || bdp_window_ >= bdp_max_window_ ||
+      is_destroyed()) {
+    return;
+  }
+  if (nghttp2_submit_ping(session_.get(), NGHTTP2_FLAG_NONE,
+                          kBdpPingPayload) != 0) {
+    return;
+  }
+  Debug(this, "sending bdp ping");
+  bdp_ping_sent_at_ = uv_hrtime();
+  bdp_bytes_ = 0;
+}
+
+void Http2Session::HandleBdpPingAck() {
+  uint64_t sample = bdp_bytes_;
+  uint64_t rtt = uv_hrtime() - bdp_ping_sent_at_;
+  bdp_ping_sent_at_ = 0;
+  bdp_bytes_ = 0;
+  statistics_.bdp_estimate = sample;
+  Debug(this, "bdp sample of %" PRIu64 " bytes in %" PRIu64 " ns",
+        sample, rtt);
+
+  if (bdp_window_ == 0) {
+    bdp_window_ = static_cast<uint32_t>(
+        nghttp2_session_get_effective_local_window_size(session_.get()));
+  }
+
+  // The peer managed to fill most of the window within one round trip, so
+  // the window is what limits the transfer: double the window to the
+  // sample size. The window is never shrunk, and never exceeds what the
+  // session is allowed to buffer.
+  if (sample * 3 < static_cast<uint64_t>(bdp_window_) * 2)
+    return;
+  uint64_t target = std::min<uint64_t>(sample * 2, bdp_max_window_);
+  target = std::min<uint64_t>(target, max_session_memory_);
+  if (target <= bdp_window_)
+    return;
+
+  bdp_window_ = static_cast<uint32_t>(target);
+  statistics_.bdp_window = bdp_window_;
+  Debug(this, "bdp window grown to %d", bdp_window_);
+
+  Http2Scope h2scope(this);
+  ApplyBdpWindow(0);
+  for (const auto& [id, stream] : streams_)
+    ApplyBdpWindow(id);
+}
+
+void Http2Session::ApplyBdpWindow(int32_t stream_id) {
+  if (bdp_window_ == 0 || !session_)
+    return;
+  // Only grows the window; nghttp2 emits the WINDOW_UPDATE frame itself.
+  int32_t current = stream_id == 0
+      ? nghttp2_session_get_effective_local_window_size(session_.get())
+      : nghttp2_session_get_stream_effective_local_window_size(
+            session_.get(), stream_id);
+  if (current < 0 || static_cast<uint32_t>(current) >= bdp_window_)
+    return;
+  if (nghttp2_session_set_local_window_size(session_.get(),
+                                            NGHTTP2_FLAG_NONE,
+                                            stream_id,
+                                            bdp_window_) != 0) {
+    Debug(this, "unable to set window for stream %d", stream_id);
+  }
+}
+
 BaseObjectPtr<Http2Ping> Http2Session::PopPing() {
   BaseObjectPtr<Http2Ping> ping;
   if (!outstanding_pings_.empty()) {
@@ -3307,6 +3468,26 @@ bool Http2Session::AddSettings(Local<Function> callback) {
   return true;
 }
 
+Http2HeadersTemplate::Http2HeadersTemplate(Environment* env,
+                                           Local<Object> obj,
+                                           Local<Array> headers)
+    : BaseObject(env, obj), headers_(env, headers) {
+  MakeWeak();
+}
+
+// new Http2HeadersTemplate([headerString, headerCount])
+void Http2HeadersTemplate::New(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args.IsConstructCall());
+  CHECK(args[0]->IsArray());
+  new Http2HeadersTemplate(env, args.This(), args[0].As<Array>());
+}
+
+bool Http2HeadersTemplate::HasInstance(Environment* env, Local<Value> value) {
+  return value->IsObject() &&
+         env->http2headerstemplate_constructor_template()->HasInstance(value);
+}
+
 Http2Ping::Http2Ping(
     Http2Session* session,
     Local<Object> obj,
@@ -3455,6 +3636,14 @@ void Initialize(Local<Object> target,
   SetMethod(context, target, "packSettings", PackSettings);
   SetMethod(context, target, "setCallbackFunctions", SetCallbackFunctions);
 
+  Local<FunctionTemplate> headers_template =
+      NewFunctionTemplate(isolate, Http2HeadersTemplate::New);
+  headers_template->InstanceTemplate()->SetInternalFieldCount(
+      Http2HeadersTemplate::kInternalFieldCount);
+  env->set_http2headerstemplate_constructor_template(headers_template);
+  SetConstructorFunction(
+      context, target, "Http2HeadersTemplate", headers_template);
+
   Local<FunctionTemplate> ping = FunctionTemplate::New(env->isolate());
   ping->SetClassName(FIXED_ONE_BYTE_STRING(env->isolate(), "Http2Ping"));
   ping->Inherit(AsyncWrap::GetConstructorTemplate(env));
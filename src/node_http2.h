@@ -39,6 +39,12 @@ constexpr size_t kDefaultMaxSettings = 10;
 // Default maximum total memory cap for Http2Session.
 constexpr uint64_t kDefaultMaxSessionMemory = 10000000;
 
+// Header storage of destroyed streams is kept for reuse by new streams on the
+// same session, so that short-lived streams do not each allocate their own.
+// These bound how many buffers are kept and how large a kept buffer may be.
+constexpr size_t kMaxPooledHeaderBuffers = 32;
+constexpr size_t kMaxPooledHeaderBufferPairs = 64;
+
 // These are the standard HTTP/2 defaults as specified by the RFC
 constexpr uint32_t DEFAULT_SETTINGS_HEADER_TABLE_SIZE = 4096;
 constexpr uint32_t DEFAULT_SETTINGS_ENABLE_PUSH = 1;
@@ -234,9 +240,18 @@ class Http2Options {
     return max_session_memory_;
   }
 
+  void set_bdp_max_window(uint32_t max) {
+    bdp_max_window_ = max;
+  }
+
+  uint32_t bdp_max_window() const {
+    return bdp_max_window_;
+  }
+
  private:
   Nghttp2OptionPointer options_;
   uint64_t max_session_memory_ = kDefaultMaxSessionMemory;
+  uint32_t bdp_max_window_ = 0;
   uint32_t max_header_pairs_ = DEFAULT_MAX_HEADER_LIST_PAIRS;
   PaddingStrategy padding_strategy_ = PADDING_STRATEGY_NONE;
   size_t max_outstanding_pings_ = kDefaultMaxPings;
@@ -672,6 +687,10 @@ class Http2Session : public AsyncWrap,
   // Removes a stream instance from this session
   BaseObjectPtr<Http2Stream> RemoveStream(int32_t id);
 
+  // Hands out and takes back the header storage of streams.
+  std::vector<Http2Header> AcquireHeaderBuffer();
+  void ReleaseHeaderBuffer(std::vector<Http2Header>&& headers);
+
   // Indicates whether there currently exist outgoing buffers for this stream.
   bool HasWritesOnSocketForStream(Http2Stream* stream);
 
@@ -783,6 +802,8 @@ class Http2Session : public AsyncWrap,
     int32_t stream_count;
     size_t max_concurrent_streams;
     double stream_average_duration;
+    uint64_t bdp_estimate;     // Latest bandwidth-delay product sample
+    uint32_t bdp_window;       // Receive window set by BDP autotuning
     SessionType session_type;
   };
 
@@ -867,6 +888,14 @@ class Http2Session : public AsyncWrap,
       const nghttp2_frame* frame,
       size_t maxPayloadLen,
       void* user_data);
+  static ssize_t OnDataSourceReadLength(
+      nghttp2_session* session,
+      uint8_t frame_type,
+      int32_t stream_id,
+      int32_t session_remote_window_size,
+      int32_t stream_remote_window_size,
+      uint32_t remote_max_frame_size,
+      void* user_data);
   static int OnNghttpError(nghttp2_session* session,
                            int lib_error_code,
                            const char* message,
@@ -915,6 +944,9 @@ class Http2Session : public AsyncWrap,
   // The collection of active Http2Streams associated with this session
   std::unordered_map<int32_t, BaseObjectPtr<Http2Stream>> streams_;
 
+  // Empty header buffers left behind by destroyed streams
+  std::vector<std::vector<Http2Header>> header_buffer_pool_;
+
   int flags_ = kSessionStateNone;
 
   // The StreamBase instance being used for i/o
@@ -936,6 +968,19 @@ class Http2Session : public AsyncWrap,
   size_t max_outstanding_pings_ = kDefaultMaxPings;
   std::queue<BaseObjectPtr<Http2Ping>> outstanding_pings_;
 
+  // Receive window autotuning. While a BDP probe PING is in flight, the
+  // DATA bytes received are counted; when its ACK arrives that count is
+  // one sample of the bandwidth-delay product of the connection, and the
+  // connection and stream receive windows are grown to stay ahead of it.
+  // Disabled when bdp_max_window_ is 0.
+  void MaybeSendBdpPing();
+  void HandleBdpPingAck();
+  void ApplyBdpWindow(int32_t stream_id);
+  uint32_t bdp_max_window_ = 0;
+  uint32_t bdp_window_ = 0;
+  uint64_t bdp_bytes_ = 0;
+  uint64_t bdp_ping_sent_at_ = 0;
+
   size_t max_outstanding_settings_ = kDefaultMaxSettings;
   std::queue<BaseObjectPtr<Http2Settings>> outstanding_settings_;
 
@@ -999,6 +1044,29 @@ using Http2SessionPerformanceEntry =
 using Http2StreamPerformanceEntry =
     performance::PerformanceEntry<Http2StreamPerformanceEntryTraits>;
 
+// A block of headers converted to nghttp2_nv entries once, for responses or
+// trailers that repeat on every stream (`:status 200`, `content-type`,
+// `grpc-status`). nghttp2 copies the nv array when a frame is submitted, so a
+// single template can back any number of concurrent streams.
+class Http2HeadersTemplate : public BaseObject {
+ public:
+  Http2HeadersTemplate(Environment* env,
+                       v8::Local<v8::Object> obj,
+                       v8::Local<v8::Array> headers);
+
+  static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static bool HasInstance(Environment* env, v8::Local<v8::Value> value);
+
+  const Http2Headers& headers() const { return headers_; }
+
+  SET_NO_MEMORY_INFO()
+  SET_MEMORY_INFO_NAME(Http2HeadersTemplate)
+  SET_SELF_SIZE(Http2HeadersTemplate)
+
+ private:
+  Http2Headers headers_;
+};
+
 class Http2Ping : public AsyncWrap {
  public:
   explicit Http2Ping(
@@ -156,7 +156,7 @@ v8::MaybeLocal<v8::String> NgHeader<T>::GetName(
   // a statically defined name. We can safely internalize it here.
   if (header_name != nullptr) {
     auto& static_str_map = env_->isolate_data()->static_str_map;
-    v8::Eternal<v8::String> eternal = static_str_map[header_name];
+    v8::Eternal<v8::String>& eternal = static_str_map[header_name];
     if (eternal.IsEmpty()) {
       v8::Local<v8::String> str = OneByteString(env_->isolate(), header_name);
       eternal.Set(env_->isolate(), str);
@@ -170,6 +170,14 @@ v8::MaybeLocal<v8::String> NgHeader<T>::GetName(
 template <typename T>
 v8::MaybeLocal<v8::String> NgHeader<T>::GetValue(
     NgHeader<T>::allocator_t* allocator) const {
+  // Short values are overwhelmingly repeated ones ("200", "0", "gzip",
+  // "application/grpc"). Looking them up in the isolate's string table
+  // returns the existing string instead of allocating an external string and
+  // its resource for every header of every stream.
+  static constexpr size_t kMaxInternalizedValueLength = 24;
+  size_t len = value_.len();
+  if (len > 0 && len <= kMaxInternalizedValueLength && !value_.IsStatic())
+    return rcbufferpointer_t::External::GetInternalizedString(env_, value_);
   return rcbufferpointer_t::External::New(allocator, value_);
 }
 
@@ -21,6 +21,7 @@
 
 #include "node.h"
 #include "node_buffer.h"
+#include "node_errors.h"
 #include "util.h"
 
 #include "async_wrap-inl.h"
@@ -28,9 +29,11 @@
 #include "llhttp.h"
 #include "memory_tracker-inl.h"
 #include "node_external_reference.h"
+#include "node_http_common.h"
 #include "stream_base-inl.h"
 #include "v8.h"
 
+#include <algorithm>
 #include <cstdlib>  // free()
 #include <cstring>  // strdup(), strchr()
 
@@ -51,6 +54,9 @@ namespace node {
 namespace http_parser {  // NOLINT(build/namespaces)
 
 using v8::Array;
+using v8::ArrayBuffer;
+using v8::ArrayBufferView;
+using v8::BackingStore;
 using v8::Boolean;
 using v8::Context;
 using v8::EscapableHandleScope;
@@ -61,10 +67,15 @@ using v8::FunctionTemplate;
 using v8::HandleScope;
 using v8::Int32;
 using v8::Integer;
+using v8::Global;
 using v8::Isolate;
+using v8::Just;
+using v8::JustVoid;
 using v8::Local;
 using v8::LocalVector;
+using v8::Maybe;
 using v8::MaybeLocal;
+using v8::Nothing;
 using v8::Number;
 using v8::Object;
 using v8::ObjectTemplate;
@@ -80,11 +91,20 @@ const uint32_t kOnBody = 3;
 const uint32_t kOnMessageComplete = 4;
 const uint32_t kOnExecute = 5;
 const uint32_t kOnTimeout = 6;
+const uint32_t kOnMessages = 7;
 // Any more fields than this will be flushed into JS
 const size_t kMaxHeaderFieldsCount = 32;
 // Maximum size of chunk extensions
 const size_t kMaxChunkExtensionsSize = 16384;
 
+// Flags accepted by serializeHead()
+const uint32_t kSerializeAddDate = 1 << 0;
+const uint32_t kSerializeChunked = 1 << 1;
+const uint32_t kSerializeLastChunk = 1 << 2;
+
+// Length of an IMF-fixdate, e.g. "Sun, 06 Nov 1994 08:49:37 GMT"
+constexpr size_t kHttpDateLength = 29;
+
 const uint32_t kLenientNone = 0;
 const uint32_t kLenientHeaders = 1 << 0;
 const uint32_t kLenientChunkedLength = 1 << 1;
@@ -102,10 +122,134 @@ const uint32_t kLenientAll =
     kLenientOptionalLFAfterCR | kLenientOptionalCRLFAfterChunk |
     kLenientOptionalCRBeforeLF | kLenientSpacesAfterChunkSize;
 
+// Flags for handing headers to JS as an object, see Parser::Initialize().
+const uint32_t kHeadersAsArray = 0;
+const uint32_t kHeadersAsObject = 1 << 0;
+const uint32_t kJoinDuplicateHeaders = 1 << 1;
+// Deliver the requests parsed from one read through a single kOnMessages
+// callback instead of per-message callbacks.
+const uint32_t kBatchMessages = 1 << 2;
+// Deliver body chunks to kOnBody as views into the data that was read instead
+// of copies. Reads are then never made into the shared parser buffer, and
+// the memory of a read stays alive for as long as JS holds on to one of its
+// chunks.
+const uint32_t kZeroCopyBody = 1 << 3;
+
+// Limits for batched delivery. A message whose body grows beyond
+// kMaxBatchedBodySize, or the kMaxBatchedMessages-th message, causes the
+// batch to be delivered early, and parsing continues with the regular
+// per-event callbacks.
+const size_t kMaxBatchedMessages = 64;
+const size_t kMaxBatchedBodySize = 16384;
+
+// Layout of the descriptors passed to kOnMessages. The first fields match
+// the arguments of `parserOnHeadersComplete` in lib/_http_common.js.
+enum BatchedMessageIndex {
+  kBatchedVersionMajor = 0,
+  kBatchedVersionMinor,
+  kBatchedHeaders,
+  kBatchedMethod,
+  kBatchedUrl,
+  kBatchedUpgrade,
+  kBatchedShouldKeepAlive,
+  // Buffer with the body received so far, or undefined
+  kBatchedBody,
+  // false when the message continues through kOnBody/kOnMessageComplete
+  kBatchedComplete,
+  kBatchedCount
+};
+
 inline bool IsOWS(char c) {
   return c == ' ' || c == '\t';
 }
 
+// How repeated occurrences of a header field are merged into the header
+// object. This mirrors the rules of IncomingMessage in lib/_http_incoming.js.
+enum class HeaderDuplicates {
+  kJoinComma,
+  kJoinSemicolon,
+  kArray,
+  kDiscard,
+};
+
+struct KnownHeaderName {
+  const char* name;
+  size_t length;
+};
+
+// Lowercased header names that are common enough to be worth interning.
+constexpr KnownHeaderName kKnownHeaderNames[] = {
+#define V(name, value) {value, sizeof(value) - 1},
+    HTTP_REGULAR_HEADERS(V) HTTP_ADDITIONAL_HEADERS(V)
+#undef V
+};
+
+inline HeaderDuplicates GetHeaderDuplicates(std::string_view name) {
+  if (name == "set-cookie") return HeaderDuplicates::kArray;
+  if (name == "cookie") return HeaderDuplicates::kJoinSemicolon;
+  static constexpr std::string_view kDiscardDuplicates[] = {
+      "content-type",        "content-length",
+      "user-agent",          "referer",
+      "host",                "authorization",
+      "proxy-authorization", "if-modified-since",
+      "if-unmodified-since", "from",
+      "location",            "max-forwards",
+      "retry-after",         "etag",
+      "last-modified",       "server",
+      "age",                 "expires",
+  };
+  for (std::string_view discard : kDiscardDuplicates) {
+    if (name == discard) return HeaderDuplicates::kDiscard;
+  }
+  return HeaderDuplicates::kJoinComma;
+}
+
+// A free list of fixed-size read buffers. Parsers hand these out from
+// OnStreamAlloc() whenever the shared parser buffer is already in use, so
+// that read buffers are recycled across reads and keep-alive requests instead
+// of going through malloc() and free() for every chunk.
+class SlabPool : public MemoryRetainer {
+ public:
+  static const size_t kSlabSize = 64 * 1024;
+  static const size_t kMaxFreeSlabs = 64;
+
+  SlabPool() = default;
+  ~SlabPool() override {
+    for (char* slab : free_slabs_) free(slab);
+  }
+
+  SlabPool(const SlabPool&) = delete;
+  SlabPool& operator=(const SlabPool&) = delete;
+
+  uv_buf_t Acquire() {
+    char* slab;
+    if (free_slabs_.empty()) {
+      slab = Malloc(kSlabSize);
+    } else {
+      slab = free_slabs_.back();
+      free_slabs_.pop_back();
+    }
+    return uv_buf_init(slab, kSlabSize);
+  }
+
+  void Release(char* slab) {
+    if (free_slabs_.size() < kMaxFreeSlabs)
+      free_slabs_.push_back(slab);
+    else
+      free(slab);
+  }
+
+  void MemoryInfo(MemoryTracker* tracker) const override {
+    tracker->TrackFieldWithSize("free_slabs",
+                                free_slabs_.size() * kSlabSize);
+  }
+  SET_MEMORY_INFO_NAME(SlabPool)
+  SET_SELF_SIZE(SlabPool)
+
+ private:
+  std::vector<char*> free_slabs_;
+};
+
 class BindingData : public BaseObject {
  public:
   BindingData(Realm* realm, Local<Object> obj) : BaseObject(realm, obj) {}
@@ -114,9 +258,22 @@ class BindingData : public BaseObject {
 
   std::vector<char> parser_buffer;
   bool parser_buffer_in_use = false;
+  // Used by parsers that are not tracked by a ConnectionsList.
+  SlabPool slab_pool;
+
+  // Returns the current time formatted for the Date header. The value is
+  // only regenerated when the wall clock second changes.
+  const char* CurrentDate();
+
+ private:
+  int64_t date_second_ = -1;
+  char date_[kHttpDateLength + 1] = {};
+
+ public:
 
   void MemoryInfo(MemoryTracker* tracker) const override {
     tracker->TrackField("parser_buffer", parser_buffer);
+    tracker->TrackField("slab_pool", slab_pool);
   }
   SET_SELF_SIZE(BindingData)
   SET_MEMORY_INFO_NAME(BindingData)
@@ -228,15 +385,27 @@ class ConnectionsList : public BaseObject {
       all_connections_.erase(parser);
     }
 
+    // A connection becomes active when a new message starts, at which point
+    // its headers are still outstanding.
     void PushActive(Parser* parser) {
       active_connections_.insert(parser);
+      awaiting_headers_.insert(parser);
     }
 
     void PopActive(Parser* parser) {
       active_connections_.erase(parser);
+      awaiting_headers_.erase(parser);
     }
 
-    SET_NO_MEMORY_INFO()
+    void HeadersCompleted(Parser* parser) {
+      awaiting_headers_.erase(parser);
+    }
+
+    SlabPool* slab_pool() { return &slab_pool_; }
+
+    void MemoryInfo(MemoryTracker* tracker) const override {
+      tracker->TrackField("slab_pool", slab_pool_);
+    }
     SET_MEMORY_INFO_NAME(ConnectionsList)
     SET_SELF_SIZE(ConnectionsList)
 
@@ -248,6 +417,14 @@ class ConnectionsList : public BaseObject {
 
     std::set<Parser*, ParserComparator> all_connections_;
     std::set<Parser*, ParserComparator> active_connections_;
+    // The subset of active_connections_ that has not received the complete
+    // headers of the current message yet. Both sets are ordered by the start
+    // time of the current message, so Expired() only needs to look at the
+    // connections that have actually expired.
+    std::set<Parser*, ParserComparator> awaiting_headers_;
+    // Shared by all connections of one server, so that buffers freed by one
+    // connection are reused by the next one that needs them.
+    SlabPool slab_pool_;
 };
 
 class Parser : public AsyncWrap, public StreamListener {
@@ -275,6 +452,8 @@ class Parser : public AsyncWrap, public StreamListener {
     }
 
     num_fields_ = num_values_ = 0;
+    header_pairs_ = 0;
+    headers_object_.Reset();
     headers_completed_ = false;
     chunk_extensions_nread_ = 0;
     last_message_start_ = uv_hrtime();
@@ -286,18 +465,14 @@ class Parser : public AsyncWrap, public StreamListener {
       connectionsList_->PushActive(this);
     }
 
-    Local<Value> cb = object()->Get(env()->context(), kOnMessageBegin)
-                              .ToLocalChecked();
-    if (cb->IsFunction()) {
-      InternalCallbackScope callback_scope(
-        this, InternalCallbackScope::kSkipTaskQueues);
-
-      MaybeLocal<Value> r = cb.As<Function>()->Call(
-        env()->context(), object(), 0, nullptr);
-
-      if (r.IsEmpty()) callback_scope.MarkAsFailed();
+    // A batched message needs no kOnMessageBegin, so in batch mode it is
+    // only issued once the message falls back to the regular callbacks.
+    if (header_flags_ & kBatchMessages) {
+      message_begin_pending_ = true;
+      return 0;
     }
 
+    EmitMessageBegin();
     return 0;
   }
 
@@ -334,8 +509,21 @@ class Parser : public AsyncWrap, public StreamListener {
       // start of new field name
       num_fields_++;
       if (num_fields_ == kMaxHeaderFieldsCount) {
-        // ran out of space - flush to javascript land
-        Flush();
+        // ran out of space - flush to javascript land, or into the
+        // header object that is handed to javascript land later
+        if (header_flags_ & kHeadersAsObject) {
+          HandleScope scope(env()->isolate());
+          if (AddHeadersToObject().IsNothing()) {
+            got_exception_ = true;
+            return HPE_USER;
+          }
+        } else {
+          if ((header_flags_ & kBatchMessages) &&
+              LeaveBatch().IsNothing()) {
+            return HPE_USER;
+          }
+          Flush();
+        }
         num_fields_ = 1;
         num_values_ = 0;
       }
@@ -375,6 +563,15 @@ class Parser : public AsyncWrap, public StreamListener {
   int on_headers_complete() {
     headers_completed_ = true;
     header_nread_ = 0;
+    if (connectionsList_ != nullptr)
+      connectionsList_->HeadersCompleted(this);
+
+    if (header_flags_ & kBatchMessages) {
+      if (CanBatchMessage())
+        return BatchMessage();
+      if (LeaveBatch().IsNothing())
+        return -1;
+    }
 
     // Arguments for the on-headers-complete javascript callback. This
     // list needs to be kept in sync with the actual argument list for
@@ -404,12 +601,22 @@ class Parser : public AsyncWrap, public StreamListener {
     for (size_t i = 0; i < arraysize(argv); i++)
       argv[i] = undefined;
 
-    if (have_flushed_) {
+    // In object mode, headers never leave the parser before this point.
+    if (have_flushed_ && !(header_flags_ & kHeadersAsObject)) {
       // Slow case, flush remaining headers.
       Flush();
     } else {
       // Fast case, pass headers and URL to JS land.
-      argv[A_HEADERS] = CreateHeaders();
+      if (header_flags_ & kHeadersAsObject) {
+        Local<Object> headers;
+        if (!TakeHeadersObject().ToLocal(&headers)) {
+          got_exception_ = true;
+          return -1;
+        }
+        argv[A_HEADERS] = headers;
+      } else {
+        argv[A_HEADERS] = CreateHeaders();
+      }
       if (parser_.type == HTTP_REQUEST)
         argv[A_URL] = url_.ToString(env());
     }
@@ -468,6 +675,17 @@ class Parser : public AsyncWrap, public StreamListener {
     if (length == 0)
       return 0;
 
+    if (batching_message_) {
+      if (batched_body_.size() + length <= kMaxBatchedBodySize) {
+        batched_body_.append(at, length);
+        return 0;
+      }
+      if (FlushBatch().IsNothing()) {
+        llhttp_set_error_reason(&parser_, "HPE_JS_EXCEPTION:JS Exception");
+        return HPE_USER;
+      }
+    }
+
     Environment* env = this->env();
     HandleScope handle_scope(env->isolate());
 
@@ -476,7 +694,12 @@ class Parser : public AsyncWrap, public StreamListener {
     if (!cb->IsFunction())
       return 0;
 
-    Local<Value> buffer = Buffer::Copy(env, at, length).ToLocalChecked();
+    Local<Value> buffer;
+    if (!GetBodyChunk(at, length).ToLocal(&buffer)) {
+      got_exception_ = true;
+      llhttp_set_error_reason(&parser_, "HPE_JS_EXCEPTION:JS Exception");
+      return HPE_USER;
+    }
 
     MaybeLocal<Value> r = MakeCallback(cb.As<Function>(), 1, &buffer);
 
@@ -506,6 +729,22 @@ class Parser : public AsyncWrap, public StreamListener {
       connectionsList_->Push(this);
     }
 
+    if (batching_message_) {
+      if (num_fields_ == 0) {
+        // The message is complete, so it stays in the batch in its entirety.
+        if (FinishBatchedMessage(true).IsNothing()) {
+          got_exception_ = true;
+          return -1;
+        }
+        if (batch_length_ < kMaxBatchedMessages)
+          return 0;
+        return FlushBatch().IsJust() ? 0 : -1;
+      }
+      // Trailers are delivered through the regular callbacks.
+      if (FlushBatch().IsNothing())
+        return -1;
+    }
+
     if (num_fields_)
       Flush();  // Flush trailing HTTP headers.
 
@@ -613,7 +852,19 @@ class Parser : public AsyncWrap, public StreamListener {
 
     ArrayBufferViewContents<char> buffer(args[0]);
 
+    // Body chunks can be views into the buffer that is parsed.
+    Isolate* isolate = args.GetIsolate();
+    Local<ArrayBuffer> previous_array_buffer =
+        parser->current_array_buffer_.Get(isolate);
+    size_t previous_offset = parser->current_array_buffer_offset_;
+    if (parser->header_flags_ & kZeroCopyBody) {
+      Local<ArrayBufferView> view = args[0].As<ArrayBufferView>();
+      parser->current_array_buffer_.Reset(isolate, view->Buffer());
+      parser->current_array_buffer_offset_ = view->ByteOffset();
+    }
     Local<Value> ret = parser->Execute(buffer.data(), buffer.length());
+    parser->current_array_buffer_.Reset(isolate, previous_array_buffer);
+    parser->current_array_buffer_offset_ = previous_offset;
 
     if (!ret.IsEmpty())
       args.GetReturnValue().Set(ret);
@@ -637,6 +888,8 @@ class Parser : public AsyncWrap, public StreamListener {
     uint64_t max_http_header_size = 0;
     uint32_t lenient_flags = kLenientNone;
     ConnectionsList* connectionsList = nullptr;
+    uint32_t header_flags = kHeadersAsArray;
+    uint32_t max_header_pairs = 0;
 
     CHECK(args[0]->IsInt32());
     CHECK(args[1]->IsObject());
@@ -660,6 +913,16 @@ class Parser : public AsyncWrap, public StreamListener {
       ASSIGN_OR_RETURN_UNWRAP(&connectionsList, args[4]);
     }
 
+    if (args.Length() > 5) {
+      CHECK(args[5]->IsUint32());
+      header_flags = args[5].As<Uint32>()->Value();
+    }
+
+    if (args.Length() > 6) {
+      CHECK(args[6]->IsUint32());
+      max_header_pairs = args[6].As<Uint32>()->Value();
+    }
+
     llhttp_type_t type =
         static_cast<llhttp_type_t>(args[0].As<Int32>()->Value());
 
@@ -677,6 +940,8 @@ class Parser : public AsyncWrap, public StreamListener {
     parser->set_provider_type(provider);
     parser->AsyncReset(args[1].As<Object>());
     parser->Init(type, max_http_header_size, lenient_flags);
+    parser->header_flags_ = header_flags;
+    parser->max_header_pairs_ = max_header_pairs;
 
     if (connectionsList != nullptr) {
       parser->connectionsList_ = connectionsList;
@@ -749,13 +1014,22 @@ class Parser : public AsyncWrap, public StreamListener {
 
  protected:
   static const size_t kAllocBufferSize = 64 * 1024;
+  static const size_t kMinZeroCopyRead = SlabPool::kSlabSize / 2;
+
+  SlabPool* slab_pool() {
+    if (connectionsList_ != nullptr) return connectionsList_->slab_pool();
+    return &binding_data_->slab_pool;
+  }
 
   uv_buf_t OnStreamAlloc(size_t suggested_size) override {
     // For most types of streams, OnStreamRead will be immediately after
     // OnStreamAlloc, and will consume all data, so using a static buffer for
-    // reading is more efficient. For other streams, just use Malloc() directly.
-    if (binding_data_->parser_buffer_in_use)
-      return uv_buf_init(Malloc(suggested_size), suggested_size);
+    // reading is more efficient. For other streams, use a recycled slab.
+    // Slabs can also be handed over to JS with kZeroCopyBody.
+    if (binding_data_->parser_buffer_in_use ||
+        (header_flags_ & kZeroCopyBody)) {
+      return slab_pool()->Acquire();
+    }
     binding_data_->parser_buffer_in_use = true;
 
     if (binding_data_->parser_buffer.empty())
@@ -768,13 +1042,23 @@ class Parser : public AsyncWrap, public StreamListener {
   void OnStreamRead(ssize_t nread, const uv_buf_t& buf) override {
     HandleScope scope(env()->isolate());
     // Once we’re done here, either indicate that the HTTP parser buffer
-    // is free for re-use, or free() the data if it didn’t come from there
-    // in the first place.
+    // is free for re-use, or return the slab the data was read into.
+    bool is_slab =
+        buf.base != nullptr && buf.base != binding_data_->parser_buffer.data();
+    // Handing a slab to JS keeps all of it alive for as long as any chunk of
+    // the read is, so only do that when the read fills a good part of it.
+    bool zero_copy = is_slab && (header_flags_ & kZeroCopyBody) &&
+                     nread >= static_cast<ssize_t>(kMinZeroCopyRead);
+    if (zero_copy) current_slab_ = buf.base;
     auto on_scope_leave = OnScopeLeave([&]() {
+      // GetBodyChunk() clears current_slab_ when it hands the slab to JS.
+      bool transferred = zero_copy && current_slab_ == nullptr;
+      current_slab_ = nullptr;
+      current_array_buffer_.Reset();
       if (buf.base == binding_data_->parser_buffer.data())
         binding_data_->parser_buffer_in_use = false;
-      else
-        free(buf.base);
+      else if (is_slab && !transferred)
+        slab_pool()->Release(buf.base);
     });
 
     if (nread < 0) {
@@ -809,6 +1093,40 @@ class Parser : public AsyncWrap, public StreamListener {
   }
 
 
+  // Returns the `length` bytes at `at` of the data that is being parsed as
+  // a Buffer. With kZeroCopyBody, that is a view into the data if it is in
+  // an ArrayBuffer already, or in a slab that can be handed to JS.
+  MaybeLocal<Object> GetBodyChunk(const char* at, size_t length) {
+    if (!(header_flags_ & kZeroCopyBody))
+      return Buffer::Copy(env(), at, length);
+
+    // The ArrayBuffer is shared by all chunks of the data, which are created
+    // in HandleScopes of their own, so it is kept in a Global until the read
+    // or the execute() call is done.
+    Isolate* isolate = env()->isolate();
+
+    if (current_array_buffer_.IsEmpty() && current_slab_ != nullptr) {
+      std::unique_ptr<BackingStore> store = ArrayBuffer::NewBackingStore(
+          current_slab_,
+          SlabPool::kSlabSize,
+          [](void* data, size_t length, void* deleter_data) { free(data); },
+          nullptr);
+      current_array_buffer_.Reset(isolate,
+                                  ArrayBuffer::New(isolate, std::move(store)));
+      current_array_buffer_offset_ = current_buffer_data_ - current_slab_;
+      current_slab_ = nullptr;
+    }
+
+    if (current_array_buffer_.IsEmpty())
+      return Buffer::Copy(env(), at, length);
+
+    CHECK_GE(at, current_buffer_data_);
+    CHECK_LE(at + length, current_buffer_data_ + current_buffer_len_);
+    size_t offset = current_array_buffer_offset_ + (at - current_buffer_data_);
+    return Buffer::New(
+        env(), current_array_buffer_.Get(isolate), offset, length);
+  }
+
   Local<Value> Execute(const char* data, size_t len) {
     EscapableHandleScope scope(env()->isolate());
 
@@ -825,6 +1143,11 @@ class Parser : public AsyncWrap, public StreamListener {
       Save();
     }
 
+    // Deliver whatever was batched during this call. A message that is not
+    // complete yet continues through the regular callbacks.
+    if (!got_exception_ && FlushBatch().IsNothing())
+      got_exception_ = true;
+
     // Calculate bytes read and resume after Upgrade/CONNECT pause
     size_t nread = len;
     if (err != HPE_OK) {
@@ -889,6 +1212,156 @@ class Parser : public AsyncWrap, public StreamListener {
     return scope.Escape(nread_obj);
   }
 
+  bool CanBatchMessage() const {
+    // Upgrades hand the socket over to JS and responses need the return
+    // value of the headers callback, so neither can be deferred. The same
+    // goes for messages whose headers were already partially flushed.
+    return parser_.type == HTTP_REQUEST && !parser_.upgrade &&
+           !have_flushed_ && batch_length_ < kMaxBatchedMessages;
+  }
+
+  int BatchMessage() {
+    Isolate* isolate = env()->isolate();
+    Local<Context> context = env()->context();
+    HandleScope scope(isolate);
+
+    Local<Value> undefined = Undefined(isolate);
+    Local<Value> values[kBatchedCount];
+    for (size_t i = 0; i < arraysize(values); i++)
+      values[i] = undefined;
+
+    if (header_flags_ & kHeadersAsObject) {
+      Local<Object> headers;
+      if (!TakeHeadersObject().ToLocal(&headers)) {
+        got_exception_ = true;
+        return -1;
+      }
+      values[kBatchedHeaders] = headers;
+    } else {
+      values[kBatchedHeaders] = CreateHeaders();
+    }
+    num_fields_ = 0;
+    num_values_ = 0;
+
+    values[kBatchedVersionMajor] = Integer::New(isolate, parser_.http_major);
+    values[kBatchedVersionMinor] = Integer::New(isolate, parser_.http_minor);
+    values[kBatchedMethod] = Uint32::NewFromUnsigned(isolate, parser_.method);
+    values[kBatchedUrl] = url_.ToString(env());
+    values[kBatchedUpgrade] = Boolean::New(isolate, false);
+    values[kBatchedShouldKeepAlive] =
+        Boolean::New(isolate, llhttp_should_keep_alive(&parser_));
+    values[kBatchedComplete] = Boolean::New(isolate, false);
+
+    Local<Array> batch;
+    if (batch_.IsEmpty()) {
+      batch = Array::New(isolate);
+      batch_.Reset(isolate, batch);
+    } else {
+      batch = batch_.Get(isolate);
+    }
+    Local<Array> message = Array::New(isolate, values, arraysize(values));
+    if (batch->Set(context, batch_length_, message).IsNothing()) {
+      got_exception_ = true;
+      return -1;
+    }
+    batch_length_++;
+    batching_message_ = true;
+    message_begin_pending_ = false;
+    batched_body_.clear();
+    return 0;
+  }
+
+  // Attaches the body collected so far to the last batched message.
+  Maybe<void> FinishBatchedMessage(bool complete) {
+    Isolate* isolate = env()->isolate();
+    Local<Context> context = env()->context();
+    HandleScope scope(isolate);
+    batching_message_ = false;
+
+    Local<Value> message;
+    if (!batch_.Get(isolate)->Get(context, batch_length_ - 1)
+            .ToLocal(&message)) {
+      return Nothing<void>();
+    }
+    Local<Object> obj = message.As<Object>();
+    if (!batched_body_.empty()) {
+      Local<Object> body;
+      if (!Buffer::Copy(env(), batched_body_.data(), batched_body_.size())
+              .ToLocal(&body) ||
+          obj->Set(context, kBatchedBody, body).IsNothing()) {
+        return Nothing<void>();
+      }
+      batched_body_.clear();
+    }
+    if (complete &&
+        obj->Set(context, kBatchedComplete, Boolean::New(isolate, true))
+            .IsNothing()) {
+      return Nothing<void>();
+    }
+    return JustVoid();
+  }
+
+  // Hands the batched messages to JS in one kOnMessages call.
+  Maybe<void> FlushBatch() {
+    if (batch_length_ == 0)
+      return JustVoid();
+
+    HandleScope scope(env()->isolate());
+    if (batching_message_ && FinishBatchedMessage(false).IsNothing()) {
+      got_exception_ = true;
+      return Nothing<void>();
+    }
+
+    Local<Value> batch = batch_.Get(env()->isolate());
+    batch_.Reset();
+    batch_length_ = 0;
+
+    Local<Value> cb =
+        object()->Get(env()->context(), kOnMessages).ToLocalChecked();
+    if (!cb->IsFunction())
+      return JustVoid();
+
+    MaybeLocal<Value> r;
+    {
+      InternalCallbackScope callback_scope(
+          this, InternalCallbackScope::kSkipTaskQueues);
+      r = cb.As<Function>()->Call(env()->context(), object(), 1, &batch);
+      if (r.IsEmpty()) callback_scope.MarkAsFailed();
+    }
+
+    if (r.IsEmpty()) {
+      got_exception_ = true;
+      return Nothing<void>();
+    }
+    return JustVoid();
+  }
+
+  // Delivers the batch and then the deferred kOnMessageBegin of the current
+  // message, which continues through the regular callbacks.
+  Maybe<void> LeaveBatch() {
+    if (FlushBatch().IsNothing())
+      return Nothing<void>();
+    if (message_begin_pending_) {
+      message_begin_pending_ = false;
+      EmitMessageBegin();
+    }
+    return JustVoid();
+  }
+
+  void EmitMessageBegin() {
+    Local<Value> cb = object()->Get(env()->context(), kOnMessageBegin)
+                              .ToLocalChecked();
+    if (cb->IsFunction()) {
+      InternalCallbackScope callback_scope(
+        this, InternalCallbackScope::kSkipTaskQueues);
+
+      MaybeLocal<Value> r = cb.As<Function>()->Call(
+        env()->context(), object(), 0, nullptr);
+
+      if (r.IsEmpty()) callback_scope.MarkAsFailed();
+    }
+  }
+
   Local<Array> CreateHeaders() {
     // There could be extra entries but the max size should be fixed
     Local<Value> headers_v[kMaxHeaderFieldsCount * 2];
@@ -901,6 +1374,122 @@ class Parser : public AsyncWrap, public StreamListener {
     return Array::New(env()->isolate(), headers_v, num_values_ * 2);
   }
 
+  // Returns the lowercased name of a header field. Names that are common
+  // enough are served from per-isolate eternal strings instead of creating
+  // a new string for every message.
+  Local<String> HeaderFieldName(const StringPtr& field,
+                                HeaderDuplicates* duplicates) {
+    Isolate* isolate = env()->isolate();
+    MaybeStackBuffer<char, 64> lower(field.size_);
+    for (size_t i = 0; i < field.size_; i++)
+      lower[i] = ToLower(field.str_[i]);
+    std::string_view name(*lower, field.size_);
+    *duplicates = GetHeaderDuplicates(name);
+
+    for (const KnownHeaderName& known : kKnownHeaderNames) {
+      if (known.length != name.size() || name != known.name) continue;
+      v8::Eternal<String>& eternal =
+          env()->isolate_data()->static_str_map[known.name];
+      if (eternal.IsEmpty())
+        eternal.Set(isolate, OneByteString(isolate, known.name, known.length));
+      return eternal.Get(isolate);
+    }
+
+    if (name.empty()) return String::Empty(isolate);
+    return OneByteString(isolate, name.data(), name.size());
+  }
+
+  // Returns the object that header fields are accumulated into, creating it
+  // for the first fields of the current message.
+  Local<Object> HeadersObject() {
+    Isolate* isolate = env()->isolate();
+    if (headers_object_.IsEmpty()) {
+      Local<Object> headers = Object::New(isolate);
+      headers_object_.Reset(isolate, headers);
+      return headers;
+    }
+    return headers_object_.Get(isolate);
+  }
+
+  // Merges the pending header fields into the header object, so that JS
+  // land does not have to build it from a flat array of names and values.
+  Maybe<void> AddHeadersToObject() {
+    Isolate* isolate = env()->isolate();
+    Local<Context> context = env()->context();
+    Local<Object> headers = HeadersObject();
+    const bool join_duplicates = header_flags_ & kJoinDuplicateHeaders;
+
+    for (size_t i = 0; i < num_values_; ++i) {
+      if (max_header_pairs_ != 0 && header_pairs_ >= max_header_pairs_) break;
+      header_pairs_++;
+
+      HeaderDuplicates duplicates;
+      Local<String> name = HeaderFieldName(fields_[i], &duplicates);
+      Local<String> value = values_[i].ToTrimmedString(env());
+      Local<Value> existing;
+      if (!headers->Get(context, name).ToLocal(&existing))
+        return Nothing<void>();
+
+      Local<Value> result = value;
+      switch (duplicates) {
+        case HeaderDuplicates::kArray:
+          if (existing->IsArray()) {
+            Local<Array> values = existing.As<Array>();
+            if (values->Set(context, values->Length(), value).IsNothing())
+              return Nothing<void>();
+            continue;
+          }
+          result = Array::New(isolate, &result, 1);
+          break;
+        case HeaderDuplicates::kJoinComma:
+        case HeaderDuplicates::kJoinSemicolon:
+          if (existing->IsString()) {
+            const char* separator =
+                duplicates == HeaderDuplicates::kJoinComma ? ", " : "; ";
+            result = String::Concat(
+                isolate,
+                String::Concat(isolate,
+                               existing.As<String>(),
+                               OneByteString(isolate, separator)),
+                value);
+          }
+          break;
+        case HeaderDuplicates::kDiscard:
+          if (!existing->IsUndefined()) {
+            if (!join_duplicates) continue;
+            Local<String> existing_string;
+            if (!existing->ToString(context).ToLocal(&existing_string))
+              return Nothing<void>();
+            result = String::Concat(
+                isolate,
+                String::Concat(isolate,
+                               existing_string,
+                               FIXED_ONE_BYTE_STRING(isolate, ", ")),
+                value);
+          }
+          break;
+      }
+
+      if (headers->Set(context, name, result).IsNothing())
+        return Nothing<void>();
+    }
+
+    num_fields_ = 0;
+    num_values_ = 0;
+    return JustVoid();
+  }
+
+  // Completes the header object with the pending header fields and
+  // detaches it from the parser, ready for the next message.
+  MaybeLocal<Object> TakeHeadersObject() {
+    EscapableHandleScope scope(env()->isolate());
+    if (AddHeadersToObject().IsNothing()) return MaybeLocal<Object>();
+    Local<Object> headers = HeadersObject();
+    headers_object_.Reset();
+    header_pairs_ = 0;
+    return scope.Escape(headers);
+  }
+
 
   // spill headers and request path to JS land
   void Flush() {
@@ -912,8 +1501,20 @@ class Parser : public AsyncWrap, public StreamListener {
     if (!cb->IsFunction())
       return;
 
+    Local<Value> headers;
+    if (header_flags_ & kHeadersAsObject) {
+      Local<Object> headers_object;
+      if (!TakeHeadersObject().ToLocal(&headers_object)) {
+        got_exception_ = true;
+        return;
+      }
+      headers = headers_object;
+    } else {
+      headers = CreateHeaders();
+    }
+
     Local<Value> argv[2] = {
-      CreateHeaders(),
+      headers,
       url_.ToString(env())
     };
 
@@ -970,6 +1571,13 @@ class Parser : public AsyncWrap, public StreamListener {
     num_fields_ = 0;
     num_values_ = 0;
     have_flushed_ = false;
+    header_pairs_ = 0;
+    headers_object_.Reset();
+    batch_.Reset();
+    batch_length_ = 0;
+    batching_message_ = false;
+    message_begin_pending_ = false;
+    batched_body_.clear();
     got_exception_ = false;
     headers_completed_ = false;
     max_http_header_size_ = max_http_header_size;
@@ -1016,8 +1624,27 @@ class Parser : public AsyncWrap, public StreamListener {
   bool got_exception_;
   size_t current_buffer_len_;
   const char* current_buffer_data_;
+  // With kZeroCopyBody, the ArrayBuffer holding current_buffer_data_ at
+  // current_array_buffer_offset_ during Execute(), if there is one, or the
+  // slab being parsed if it can still be handed to JS.
+  Global<ArrayBuffer> current_array_buffer_;
+  size_t current_array_buffer_offset_ = 0;
+  char* current_slab_ = nullptr;
+  uint32_t header_flags_ = kHeadersAsArray;
+  uint32_t max_header_pairs_ = 0;
+  uint32_t header_pairs_ = 0;
+  Global<Object> headers_object_;
   bool headers_completed_ = false;
   bool pending_pause_ = false;
+  // Messages parsed during the current Execute() in kBatchMessages mode
+  Global<Array> batch_;
+  uint32_t batch_length_ = 0;
+  // Whether the message being parsed is the last entry of batch_
+  bool batching_message_ = false;
+  // Whether kOnMessageBegin of the message being parsed is still owed,
+  // see on_message_begin()
+  bool message_begin_pending_ = false;
+  std::string batched_body_;
   uint64_t header_nread_ = 0;
   uint64_t chunk_extensions_nread_ = 0;
   uint64_t max_http_header_size_;
@@ -1157,26 +1784,27 @@ void ConnectionsList::Expired(const FunctionCallbackInfo<Value>& args) {
     return args.GetReturnValue().Set(Array::New(isolate, 0));
   }
 
-  auto iter = list->active_connections_.begin();
-  auto end = list->active_connections_.end();
-
   LocalVector<Value> result(isolate);
-  result.reserve(list->active_connections_.size());
-  while (iter != end) {
-    Parser* parser = *iter;
-    iter++;
-
-    // Check for expiration.
-    if (
-      (!parser->headers_completed_ && headers_deadline > 0 &&
-        parser->last_message_start_ < headers_deadline) ||
-      (
-        request_deadline > 0 &&
-        parser->last_message_start_ < request_deadline)
-    ) {
-      result.emplace_back(parser->object());
+  auto expire = [&](Parser* parser) {
+    result.emplace_back(parser->object());
+    list->PopActive(parser);
+  };
 
-      list->active_connections_.erase(parser);
+  // Both sets are ordered oldest first, so the walk stops at the first
+  // connection that is still within its deadline.
+  if (request_deadline > 0) {
+    while (!list->active_connections_.empty()) {
+      Parser* parser = *list->active_connections_.begin();
+      if (parser->last_message_start_ >= request_deadline) break;
+      expire(parser);
+    }
+  }
+
+  if (headers_deadline > 0) {
+    while (!list->awaiting_headers_.empty()) {
+      Parser* parser = *list->awaiting_headers_.begin();
+      if (parser->last_message_start_ >= headers_deadline) break;
+      expire(parser);
     }
   }
 
@@ -1184,6 +1812,233 @@ void ConnectionsList::Expired(const FunctionCallbackInfo<Value>& args) {
       Array::New(isolate, result.data(), result.size()));
 }
 
+namespace {
+
+void FormatHttpDate(int64_t seconds, char* out) {
+  static const char kDays[][4] = {
+      "Thu", "Fri", "Sat", "Sun", "Mon", "Tue", "Wed"};
+  static const char kMonths[][4] = {
+      "Jan", "Feb", "Mar", "Apr", "May", "Jun",
+      "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+
+  int64_t days = seconds / 86400;
+  int64_t rem = seconds % 86400;
+  if (rem < 0) {
+    rem += 86400;
+    days--;
+  }
+  int weekday = static_cast<int>(((days % 7) + 7) % 7);
+
+  // Civil date from days since the epoch (proleptic Gregorian calendar).
+  int64_t z = days + 719468;
+  int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+  int64_t doe = z - era * 146097;
+  int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  int64_t mp = (5 * doy + 2) / 153;
+  int day = static_cast<int>(doy - (153 * mp + 2) / 5 + 1);
+  int month = static_cast<int>(mp < 10 ? mp + 3 : mp - 9);
+  int64_t year = yoe + era * 400 + (month <= 2);
+
+  snprintf(out, kHttpDateLength + 1,
+           "%s, %02d %s %04d %02d:%02d:%02d GMT",
+           kDays[weekday], day, kMonths[month - 1],
+           static_cast<int>(year),
+           static_cast<int>(rem / 3600),
+           static_cast<int>((rem / 60) % 60),
+           static_cast<int>(rem % 60));
+}
+
+// Mirrors checkInvalidHeaderChar() in lib/_http_common.js.
+inline bool IsValidHeaderByte(uint8_t c) {
+  return c == '\t' || (c >= 0x20 && c != 0x7f);
+}
+
+// Mirrors checkIsHttpToken() in lib/_http_common.js.
+inline bool IsTokenByte(uint8_t c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+         (c >= '0' && c <= '9') ||
+         (c != '\0' && strchr("!#$%&'*+-.^_`|~", c) != nullptr);
+}
+
+size_t ChunkSizeLength(size_t length) {
+  size_t digits = 1;
+  while (length >>= 4) digits++;
+  return digits;
+}
+
+char* WriteChunkSize(char* out, size_t length) {
+  static const char kHex[] = "0123456789abcdef";
+  size_t digits = ChunkSizeLength(length);
+  for (size_t i = digits; i > 0; i--) {
+    out[i - 1] = kHex[length & 0xf];
+    length >>= 4;
+  }
+  out += digits;
+  *out++ = '\r';
+  *out++ = '\n';
+  return out;
+}
+
+// Writes a one-byte copy of a string into a buffer. The string must only
+// contain characters up to U+00FF, which are written as 'latin1'.
+char* WriteLatin1(Isolate* isolate, Local<String> str, char* out) {
+  int length = str->Length();
+  str->WriteOneByte(isolate,
+                    reinterpret_cast<uint8_t*>(out),
+                    0,
+                    length,
+                    String::NO_NULL_TERMINATION);
+  return out + length;
+}
+
+}  // anonymous namespace
+
+const char* BindingData::CurrentDate() {
+  uv_timeval64_t tv;
+  CHECK_EQ(0, uv_gettimeofday(&tv));
+  if (tv.tv_sec != date_second_) {
+    FormatHttpDate(tv.tv_sec, date_);
+    date_second_ = tv.tv_sec;
+  }
+  return date_;
+}
+
+// serializeHead(statusCode, statusMessage, headers, flags[, body])
+// Produces the status line and header block of a response in a single
+// Buffer, so that it can be handed to the socket as one write. `headers` is
+// a flat array of [name, value, name, value, ...] strings. The optional body
+// is appended to the same Buffer, framed as a chunk when kSerializeChunked
+// is set, which lets small responses go out as one contiguous write; large
+// bodies are better passed to writev() separately to avoid the copy.
+// Throws if a header name is not a token, or if the status message or a
+// header value contains characters that are not permitted or that are
+// outside of Latin-1.
+static void SerializeHead(const FunctionCallbackInfo<Value>& args) {
+  Realm* realm = Realm::GetCurrent(args);
+  Environment* env = realm->env();
+  Isolate* isolate = env->isolate();
+  BindingData* binding_data = realm->GetBindingData<BindingData>();
+
+  CHECK(args[0]->IsUint32());
+  CHECK(args[1]->IsString());
+  CHECK(args[2]->IsArray());
+  CHECK(args[3]->IsUint32());
+  uint32_t status_code = args[0].As<Uint32>()->Value();
+  Local<String> status_message = args[1].As<String>();
+  Local<Array> headers = args[2].As<Array>();
+  uint32_t flags = args[3].As<Uint32>()->Value();
+  CHECK_GE(status_code, 100);
+  CHECK_LE(status_code, 999);
+  const uint32_t header_count = headers->Length();
+  CHECK_EQ(header_count % 2, 0);
+
+  // Characters outside of Latin-1 can not be written as one byte each.
+  const auto throw_invalid = [&]() {
+    THROW_ERR_INVALID_ARG_VALUE(env, "Invalid character in header content");
+  };
+  if (!status_message->ContainsOnlyOneByte()) return throw_invalid();
+  LocalVector<String> strings(isolate);
+  strings.reserve(header_count);
+  // "HTTP/1.1 200 " + message + CRLF
+  size_t length = 13 + status_message->Length() + 2;
+  for (uint32_t i = 0; i < header_count; i++) {
+    // Elements may be accessors, so do not trust their values.
+    Local<Value> value;
+    if (!headers->Get(env->context(), i).ToLocal(&value)) return;
+    if (!value->IsString()) {
+      return THROW_ERR_INVALID_ARG_TYPE(env,
+                                        "Header names and values must be "
+                                        "strings");
+    }
+    if (!value.As<String>()->ContainsOnlyOneByte()) return throw_invalid();
+    strings.push_back(value.As<String>());
+    // name + ": " or value + CRLF
+    length += strings.back()->Length() + 2;
+  }
+
+  // Read the body only now, after the accessors above have run, since they
+  // could have detached or resized it.
+  ArrayBufferViewContents<char> body;
+  if (args[4]->IsArrayBufferView()) body.Read(args[4].As<ArrayBufferView>());
+  bool chunked = flags & kSerializeChunked;
+
+  if (flags & kSerializeAddDate)
+    length += 6 + kHttpDateLength + 2;
+  length += 2;
+  if (body.length() > 0) {
+    length += body.length();
+    if (chunked) length += ChunkSizeLength(body.length()) + 4;
+  }
+  if (chunked && (flags & kSerializeLastChunk))
+    length += 5;
+
+  Local<Object> buffer;
+  if (!Buffer::New(isolate, length).ToLocal(&buffer)) return;
+  char* const start = Buffer::Data(buffer);
+  char* out = start;
+
+  out += snprintf(out, 14, "HTTP/1.1 %03u ", status_code);
+  // Writes a string and rejects it if it could be used to inject a line
+  // break into the header block.
+  auto write_checked = [&](Local<String> str) {
+    char* begin = out;
+    out = WriteLatin1(isolate, str, out);
+    return std::all_of(begin, out, [](char c) {
+      return IsValidHeaderByte(static_cast<uint8_t>(c));
+    });
+  };
+  // Writes a header name and rejects it if it is not a token.
+  auto write_token = [&](Local<String> str) {
+    char* begin = out;
+    out = WriteLatin1(isolate, str, out);
+    return begin != out && std::all_of(begin, out, [](char c) {
+             return IsTokenByte(static_cast<uint8_t>(c));
+           });
+  };
+  bool valid = write_checked(status_message);
+  for (size_t i = 0; valid && i < strings.size(); i += 2) {
+    *out++ = '\r';
+    *out++ = '\n';
+    if (!write_token(strings[i])) {
+      return THROW_ERR_INVALID_HTTP_TOKEN(
+          env, "Header name must be a valid HTTP token");
+    }
+    *out++ = ':';
+    *out++ = ' ';
+    valid = write_checked(strings[i + 1]);
+  }
+  if (!valid) return throw_invalid();
+  *out++ = '\r';
+  *out++ = '\n';
+  if (flags & kSerializeAddDate) {
+    memcpy(out, "Date: ", 6);
+    memcpy(out + 6, binding_data->CurrentDate(), kHttpDateLength);
+    out += 6 + kHttpDateLength;
+    *out++ = '\r';
+    *out++ = '\n';
+  }
+  *out++ = '\r';
+  *out++ = '\n';
+
+  if (body.length() > 0) {
+    if (chunked) out = WriteChunkSize(out, body.length());
+    memcpy(out, body.data(), body.length());
+    out += body.length();
+    if (chunked) {
+      *out++ = '\r';
+      *out++ = '\n';
+    }
+  }
+  if (chunked && (flags & kSerializeLastChunk)) {
+    memcpy(out, "0\r\n\r\n", 5);
+    out += 5;
+  }
+  CHECK_EQ(static_cast<size_t>(out - start), length);
+
+  args.GetReturnValue().Set(buffer);
+}
+
 const llhttp_settings_t Parser::settings = {
     Proxy<Call, &Parser::on_message_begin>::Raw,
 
@@ -1260,6 +2115,8 @@ void CreatePerIsolateProperties(IsolateData* isolate_data,
          Integer::NewFromUnsigned(isolate, kOnExecute));
   t->Set(FIXED_ONE_BYTE_STRING(isolate, "kOnTimeout"),
          Integer::NewFromUnsigned(isolate, kOnTimeout));
+  t->Set(FIXED_ONE_BYTE_STRING(isolate, "kOnMessages"),
+         Integer::NewFromUnsigned(isolate, kOnMessages));
 
   t->Set(FIXED_ONE_BYTE_STRING(isolate, "kLenientNone"),
          Integer::NewFromUnsigned(isolate, kLenientNone));
@@ -1287,6 +2144,17 @@ void CreatePerIsolateProperties(IsolateData* isolate_data,
   t->Set(FIXED_ONE_BYTE_STRING(isolate, "kLenientAll"),
          Integer::NewFromUnsigned(isolate, kLenientAll));
 
+  t->Set(FIXED_ONE_BYTE_STRING(isolate, "kHeadersAsArray"),
+         Integer::NewFromUnsigned(isolate, kHeadersAsArray));
+  t->Set(FIXED_ONE_BYTE_STRING(isolate, "kHeadersAsObject"),
+         Integer::NewFromUnsigned(isolate, kHeadersAsObject));
+  t->Set(FIXED_ONE_BYTE_STRING(isolate, "kJoinDuplicateHeaders"),
+         Integer::NewFromUnsigned(isolate, kJoinDuplicateHeaders));
+  t->Set(FIXED_ONE_BYTE_STRING(isolate, "kBatchMessages"),
+         Integer::NewFromUnsigned(isolate, kBatchMessages));
+  t->Set(FIXED_ONE_BYTE_STRING(isolate, "kZeroCopyBody"),
+         Integer::NewFromUnsigned(isolate, kZeroCopyBody));
+
   t->Inherit(AsyncWrap::GetConstructorTemplate(isolate_data));
   SetProtoMethod(isolate, t, "close", Parser::Close);
   SetProtoMethod(isolate, t, "free", Parser::Free);
@@ -1311,6 +2179,14 @@ void CreatePerIsolateProperties(IsolateData* isolate_data,
   SetProtoMethod(isolate, c, "active", ConnectionsList::Active);
   SetProtoMethod(isolate, c, "expired", ConnectionsList::Expired);
   SetConstructorFunction(isolate, target, "ConnectionsList", c);
+
+  SetMethod(isolate, target, "serializeHead", SerializeHead);
+  target->Set(FIXED_ONE_BYTE_STRING(isolate, "kSerializeAddDate"),
+              Integer::NewFromUnsigned(isolate, kSerializeAddDate));
+  target->Set(FIXED_ONE_BYTE_STRING(isolate, "kSerializeChunked"),
+              Integer::NewFromUnsigned(isolate, kSerializeChunked));
+  target->Set(FIXED_ONE_BYTE_STRING(isolate, "kSerializeLastChunk"),
+              Integer::NewFromUnsigned(isolate, kSerializeLastChunk));
 }
 
 void CreatePerContextProperties(Local<Object> target,
@@ -1373,6 +2249,7 @@ void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(ConnectionsList::Idle);
   registry->Register(ConnectionsList::Active);
   registry->Register(ConnectionsList::Expired);
+  registry->Register(SerializeHead);
 }
 
 }  // namespace http_parser
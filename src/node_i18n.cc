@@ -60,6 +60,7 @@
 #include <unicode/uchar.h>
 #include <unicode/uclean.h>
 #include <unicode/ucnv.h>
+#include <unicode/udata.h>
 #include <unicode/ulocdata.h>
 #include <unicode/urename.h>
 #include <unicode/utf16.h>
@@ -68,9 +69,14 @@
 #include <unicode/uversion.h>
 #include "nbytes.h"
 
-#ifdef NODE_HAVE_SMALL_ICU
-#include <unicode/udata.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
+#ifdef NODE_HAVE_SMALL_ICU
 /* if this is defined, we have a 'secondary' entry point.
    compare following to utypes.h defs for U_ICUDATA_ENTRY_POINT */
 #define SMALL_ICUDATA_ENTRY_POINT \
@@ -553,7 +559,39 @@ ConverterObject::ConverterObject(
   }
 }
 
-bool InitializeICUDirectory(const std::string& path, std::string* error) {
+namespace {
+
+// Maps the common ICU data file in `path` and asks the kernel to read it
+// ahead, so that the first formatting calls do not stall on page faults in
+// the data. ICU maps the file itself otherwise, and reads it in lazily.
+// The mapping is never released, like the one of ICU.
+bool PrefetchICUData(const std::string& path, UErrorCode* status) {
+#ifndef _WIN32
+  const std::string file = path + "/" U_ICUDATA_NAME ".dat";
+  int fd = open(file.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd == -1) return false;
+  struct stat st;
+  void* data = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && st.st_size > 0) {
+    data = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  }
+  close(fd);
+  if (data == MAP_FAILED) return false;
+  madvise(data, st.st_size, MADV_WILLNEED);
+  udata_setCommonData(data, status);
+  if (U_SUCCESS(*status)) return true;
+  munmap(data, st.st_size);
+  // Let ICU report the problem with the file, if there still is one.
+  *status = U_ZERO_ERROR;
+#endif  // _WIN32
+  return false;
+}
+
+}  // anonymous namespace
+
+bool InitializeICUDirectory(const std::string& path,
+                            std::string* error,
+                            bool prefetch) {
   UErrorCode status = U_ZERO_ERROR;
   if (path.empty()) {
 #ifdef NODE_HAVE_SMALL_ICU
@@ -564,6 +602,7 @@ bool InitializeICUDirectory(const std::string& path, std::string* error) {
 #endif  // !NODE_HAVE_SMALL_ICU
   } else {
     u_setDataDirectory(path.c_str());
+    if (prefetch) PrefetchICUData(path, &status);
     u_init(&status);
   }
   if (status == U_ZERO_ERROR) {
@@ -38,7 +38,11 @@
 namespace node {
 namespace i18n {
 
-bool InitializeICUDirectory(const std::string& path, std::string* error);
+// If `prefetch` is true, the data file in `path` is read ahead instead of
+// being paged in on first use.
+bool InitializeICUDirectory(const std::string& path,
+                            std::string* error,
+                            bool prefetch = false);
 
 void SetDefaultTimeZone(const char* tzid);
 
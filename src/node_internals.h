@@ -33,6 +33,7 @@
 #include "uv.h"
 #include "v8.h"
 
+#include <array>
 #include <cstdint>
 #include <cstdlib>
 
@@ -120,6 +121,9 @@ v8::MaybeLocal<v8::Object> InitializePrivateSymbols(
 
 class NodeArrayBufferAllocator : public ArrayBufferAllocator {
  public:
+  NodeArrayBufferAllocator();
+  ~NodeArrayBufferAllocator() override;
+
   inline uint32_t* zero_fill_field() { return &zero_fill_field_; }
 
   void* Allocate(size_t size) override;  // Defined in src/node.cc
@@ -138,9 +142,45 @@ class NodeArrayBufferAllocator : public ArrayBufferAllocator {
   }
 
  private:
+  // Freed backing stores between kMinPooledSize and kMaxPooledSize are kept
+  // in size classes (four per power of two, so at most 25% of a block is
+  // wasted) and handed out again by the next allocation of that class,
+  // instead of going through malloc() and free() each time. The pool is
+  // capped at --array-buffer-pool-size MiB and is disabled by default.
+  static constexpr size_t kMinPooledSize = 16 * 1024;
+  static constexpr size_t kMaxPooledSize = 1024 * 1024;
+  static constexpr size_t kSizeClassCount = 25;
+
+  struct SizeClass {
+    Mutex mutex;
+    std::vector<void*> blocks;
+  };
+
+  static size_t GetSizeClass(size_t size);
+  static size_t GetSizeClassSize(size_t size_class);
+  inline bool IsPooledSize(size_t size) const {
+    return pool_limit_ != 0 && size >= kMinPooledSize &&
+           size <= kMaxPooledSize;
+  }
+  void* AllocatePooled(size_t size, bool zero_fill);
+  void FreePooled(void* data, size_t size);
+  // Returns all cached blocks to the underlying allocator.
+  void ReleasePooledMemory();
+
+  // With --array-buffer-huge-pages, backing stores of at least this size are
+  // advised to use transparent huge pages. Twice the huge page size makes
+  // sure that every such allocation contains at least one full huge page.
+  static constexpr size_t kMinHugePageSize = 4 * 1024 * 1024;
+  void* MaybeAdviseHugePages(void* data, size_t size) const;
+
   uint32_t zero_fill_field_ = 1;  // Boolean but exposed as uint32 to JS land.
   std::atomic<size_t> total_mem_usage_ {0};
 
+  const size_t pool_limit_;
+  const bool huge_pages_;
+  std::atomic<size_t> pooled_bytes_{0};
+  std::array<SizeClass, kSizeClassCount> size_classes_;
+
   // Delegate to V8's allocator for compatibility with the V8 memory cage.
   std::unique_ptr<v8::ArrayBuffer::Allocator> allocator_{
       v8::ArrayBuffer::Allocator::NewDefaultAllocator()};
@@ -269,6 +309,9 @@ class InternalCallbackScope {
   bool failed_ = false;
   bool pushed_ids_ = false;
   bool closed_ = false;
+  bool swapped_context_frame_ = false;
+  // Left empty when the prior frame was undefined, which is the common case
+  // for callbacks entered from the event loop.
   v8::Global<v8::Value> prior_context_frame_;
 };
 
@@ -289,11 +332,13 @@ class DebugSealHandleScope {
 class ThreadPoolWork {
  public:
   explicit inline ThreadPoolWork(Environment* env, const char* type)
-      : env_(env), type_(type) {
+      : env_(env), type_(type), kind_(GetThreadPoolWorkKind(type)) {
     CHECK_NOT_NULL(env);
   }
   inline virtual ~ThreadPoolWork() = default;
 
+  // The work may wait in the Environment's ThreadPoolWorkQueue before it is
+  // submitted to libuv, depending on the limit set for its kind.
   inline void ScheduleWork();
   inline int CancelWork();
 
@@ -301,11 +346,33 @@ class ThreadPoolWork {
   virtual void AfterThreadPoolWork(int status) = 0;
 
   Environment* env() const { return env_; }
+  ThreadPoolWorkKind kind() const { return kind_; }
+
+  // These may only be changed while the work is not scheduled. Urgent work
+  // waits ahead of the other waiting work of its kind.
+  void set_kind(ThreadPoolWorkKind kind) { kind_ = kind; }
+  void set_urgent(bool urgent) { urgent_ = urgent; }
 
  private:
+  friend class ThreadPoolWorkQueue;
+
+  inline void Submit();
+  inline void Finish(int status);
+  // Time between ScheduleWork() and the start of DoThreadPoolWork(), or 0 if
+  // the work never started.
+  uint64_t wait_time() const {
+    return started_at_ == 0 ? 0 : started_at_ - scheduled_at_;
+  }
+  uint64_t run_time() const { return finished_at_ - started_at_; }
+
   Environment* env_;
   uv_work_t work_req_;
   const char* type_;
+  ThreadPoolWorkKind kind_;
+  bool urgent_ = false;
+  uint64_t scheduled_at_ = 0;
+  uint64_t started_at_ = 0;
+  uint64_t finished_at_ = 0;
 };
 
 #define TRACING_CATEGORY_NODE "node"
@@ -421,7 +488,8 @@ class DiagnosticFilename {
 namespace heap {
 v8::Maybe<void> WriteSnapshot(Environment* env,
                               const char* filename,
-                              v8::HeapProfiler::HeapSnapshotOptions options);
+                              v8::HeapProfiler::HeapSnapshotOptions options,
+                              bool compress = false);
 }
 
 namespace heap {
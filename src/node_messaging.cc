@@ -15,6 +15,7 @@ using node::errors::TryCatchScope;
 using v8::Array;
 using v8::ArrayBuffer;
 using v8::BackingStore;
+using v8::Boolean;
 using v8::CompiledWasmModule;
 using v8::Context;
 using v8::EscapableHandleScope;
@@ -302,14 +303,38 @@ void ThrowDataCloneException(Local<Context> context, Local<String> message) {
 // DeserializerDelegate understands how to unpack.
 class SerializerDelegate : public ValueSerializer::Delegate {
  public:
-  SerializerDelegate(Environment* env, Local<Context> context, Message* m)
-      : env_(env), context_(context), msg_(m) {}
+  SerializerDelegate(Environment* env,
+                     Local<Context> context,
+                     Message* m,
+                     size_t buffer_size_hint,
+                     bool plain_data)
+      : env_(env),
+        context_(context),
+        msg_(m),
+        buffer_size_hint_(buffer_size_hint),
+        plain_data_(plain_data) {}
+
+  // Messages sent through the same port tend to have similar sizes, so
+  // allocate what the previous one needed right away instead of letting the
+  // serializer grow the buffer step by step.
+  void* ReallocateBufferMemory(void* old_buffer,
+                               size_t size,
+                               size_t* actual_size) override {
+    if (old_buffer == nullptr) size = std::max(size, buffer_size_hint_);
+    void* result = realloc(old_buffer, size);
+    *actual_size = result == nullptr ? 0 : size;
+    return result;
+  }
 
   void ThrowDataCloneError(Local<String> message) override {
     ThrowDataCloneException(context_, message);
   }
 
-  bool HasCustomHostObject(Isolate* isolate) override { return true; }
+  // Without custom host objects, V8 treats only objects with internal fields
+  // as host objects and does not call IsHostObject() for every other object.
+  // Those that are not BaseObjects end up in WriteHostObject(), which can not
+  // clone them, see Message::Serialize().
+  bool HasCustomHostObject(Isolate* isolate) override { return !plain_data_; }
 
   Maybe<bool> IsHostObject(Isolate* isolate, Local<Object> object) override {
     if (BaseObject::IsBaseObject(env_->isolate_data(), object)) {
@@ -456,6 +481,8 @@ class SerializerDelegate : public ValueSerializer::Delegate {
   Environment* env_;
   Local<Context> context_;
   Message* msg_;
+  size_t buffer_size_hint_;
+  bool plain_data_;
   std::vector<Global<SharedArrayBuffer>> seen_shared_array_buffers_;
   std::vector<BaseObjectPtr<BaseObject>> host_objects_;
   size_t first_cloned_object_index_ = SIZE_MAX;
@@ -469,14 +496,17 @@ Maybe<bool> Message::Serialize(Environment* env,
                                Local<Context> context,
                                Local<Value> input,
                                const TransferList& transfer_list_v,
-                               Local<Object> source_port) {
+                               Local<Object> source_port,
+                               size_t buffer_size_hint,
+                               bool plain_data) {
   HandleScope handle_scope(env->isolate());
   Context::Scope context_scope(context);
 
   // Verify that we're not silently overwriting an existing message.
   CHECK(main_message_buf_.is_empty());
 
-  SerializerDelegate delegate(env, context, this);
+  SerializerDelegate delegate(
+      env, context, this, buffer_size_hint, plain_data);
   ValueSerializer serializer(env->isolate(), &delegate);
   delegate.serializer = &serializer;
 
@@ -630,15 +660,19 @@ MessagePortData::~MessagePortData() {
 
 void MessagePortData::MemoryInfo(MemoryTracker* tracker) const {
   Mutex::ScopedLock lock(mutex_);
+  tracker->TrackField("received_messages", received_messages_);
   tracker->TrackField("incoming_messages", incoming_messages_);
 }
 
 void MessagePortData::AddToIncomingQueue(std::shared_ptr<Message> message) {
   // This function will be called by other threads.
   Mutex::ScopedLock lock(mutex_);
+  bool was_empty = incoming_messages_.empty();
   incoming_messages_.emplace_back(std::move(message));
 
-  if (owner_ != nullptr) {
+  // If the queue was not empty, the owner has already been notified and will
+  // pick this message up together with the ones before it.
+  if (owner_ != nullptr && was_empty) {
     Debug(owner_, "Adding message to incoming queue");
     owner_->TriggerAsync();
   }
@@ -775,8 +809,13 @@ MaybeLocal<Value> MessagePort::ReceiveMessage(Local<Context> context,
                                               Local<Value>* port_list) {
   std::shared_ptr<Message> received;
   {
-    // Get the head of the message queue.
-    Mutex::ScopedLock lock(data_->mutex_);
+    std::deque<std::shared_ptr<Message>>& queue = data_->received_messages_;
+    if (queue.empty()) {
+      // Take everything that has arrived so far, so that the following
+      // messages can be read without locking.
+      Mutex::ScopedLock lock(data_->mutex_);
+      queue.swap(data_->incoming_messages_);
+    }
 
     Debug(this, "MessagePort has message");
 
@@ -787,14 +826,13 @@ MaybeLocal<Value> MessagePort::ReceiveMessage(Local<Context> context,
     // - There are no pending messages
     // - We are not intending to receive messages, and the message we would
     //   receive is not the final "close" message.
-    if (data_->incoming_messages_.empty() ||
-        (!wants_message &&
-         !data_->incoming_messages_.front()->IsCloseMessage())) {
+    if (queue.empty() ||
+        (!wants_message && !queue.front()->IsCloseMessage())) {
       return env()->no_message_symbol();
     }
 
-    received = data_->incoming_messages_.front();
-    data_->incoming_messages_.pop_front();
+    received = std::move(queue.front());
+    queue.pop_front();
   }
 
   if (received->IsCloseMessage()) {
@@ -823,7 +861,8 @@ void MessagePort::OnMessage(MessageProcessingMode mode) {
   size_t processing_limit;
   if (mode == MessageProcessingMode::kNormalOperation) {
     Mutex::ScopedLock lock(data_->mutex_);
-    processing_limit = std::max(data_->incoming_messages_.size(),
+    processing_limit = std::max(data_->received_messages_.size() +
+                                    data_->incoming_messages_.size(),
                                 static_cast<size_t>(1000));
   } else {
     processing_limit = std::numeric_limits<size_t>::max();
@@ -942,7 +981,8 @@ Maybe<bool> MessagePort::PostMessage(Environment* env,
   // serialize the input message, even if the MessagePort is closed or detached.
 
   Maybe<bool> serialization_maybe =
-      msg->Serialize(env, context, message_v, transfer_v, obj);
+      msg->Serialize(env, context, message_v, transfer_v, obj,
+                     last_payload_size_, plain_data_);
   if (try_catch.HasCaught() && !try_catch.HasTerminated()) {
     try_catch.ReThrow();
   }
@@ -952,6 +992,11 @@ Maybe<bool> MessagePort::PostMessage(Environment* env,
   if (serialization_maybe.IsNothing()) {
     return Nothing<bool>();
   }
+  // Only use the size of the previous message as an allocation hint up to a
+  // limit, so that a single large message does not make every following
+  // message on this port start out with an equally large buffer.
+  static constexpr size_t kMaxPayloadSizeHint = 64 * 1024;
+  last_payload_size_ = std::min(msg->payload_size(), kMaxPayloadSizeHint);
 
   std::string error;
   Maybe<bool> res = data_->Dispatch(msg, &error);
@@ -1113,7 +1158,8 @@ void MessagePort::Start() {
   Debug(this, "Start receiving messages");
   receiving_messages_ = true;
   Mutex::ScopedLock lock(data_->mutex_);
-  if (!data_->incoming_messages_.empty())
+  if (!data_->received_messages_.empty() ||
+      !data_->incoming_messages_.empty())
     TriggerAsync();
 }
 
@@ -1141,6 +1187,17 @@ void MessagePort::Stop(const FunctionCallbackInfo<Value>& args) {
   port->Stop();
 }
 
+// setMessagePortPlainData(port, enabled) makes postMessage() on `port`
+// serialize in plain data mode, for ports whose messages are known to be
+// plain data, e.g. the task descriptors of a worker pool.
+void MessagePort::SetPlainData(const FunctionCallbackInfo<Value>& args) {
+  MessagePort* port;
+  CHECK(args[0]->IsObject());
+  CHECK(args[1]->IsBoolean());
+  ASSIGN_OR_RETURN_UNWRAP(&port, args[0].As<Object>());
+  port->plain_data_ = args[1].As<Boolean>()->Value();
+}
+
 void MessagePort::Drain(const FunctionCallbackInfo<Value>& args) {
   MessagePort* port;
   ASSIGN_OR_RETURN_UNWRAP(&port, args[0].As<Object>());
@@ -1725,6 +1782,10 @@ static void CreatePerIsolateProperties(IsolateData* isolate_data,
   // the browser equivalents do not provide them.
   SetMethod(isolate, target, "stopMessagePort", MessagePort::Stop);
   SetMethod(isolate, target, "drainMessagePort", MessagePort::Drain);
+  SetMethod(isolate,
+            target,
+            "setMessagePortPlainData",
+            MessagePort::SetPlainData);
   SetMethod(
       isolate, target, "receiveMessageOnPort", MessagePort::ReceiveMessage);
   SetMethod(
@@ -1760,6 +1821,7 @@ static void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(MessagePort::Start);
   registry->Register(MessagePort::Stop);
   registry->Register(MessagePort::Drain);
+  registry->Register(MessagePort::SetPlainData);
   registry->Register(MessagePort::ReceiveMessage);
   registry->Register(MessagePort::MoveToContext);
   registry->Register(SetDeserializerCreateObjectFunction);
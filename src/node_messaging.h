@@ -72,12 +72,25 @@ class Message : public MemoryRetainer {
   // deserialization.
   // The source_port parameter, if provided, will make Serialize() throw a
   // "DataCloneError" DOMException if source_port is found in transfer_list.
+  // buffer_size_hint is the number of bytes to allocate for the payload up
+  // front, e.g. the size of the previous message sent through the same port.
+  // With plain_data, the input is known not to contain objects that are
+  // transferable from JavaScript, so objects are not checked for them one by
+  // one; such objects are cloned as ordinary objects instead. Objects backed
+  // by C++ objects, e.g. MessagePorts, are still recognized. V8 then treats
+  // every object with internal fields as backed by a C++ object, so other
+  // such objects, e.g. those created by addons from an ObjectTemplate, throw
+  // a "DataCloneError" instead of being cloned as ordinary objects.
   v8::Maybe<bool> Serialize(Environment* env,
                             v8::Local<v8::Context> context,
                             v8::Local<v8::Value> input,
                             const TransferList& transfer_list,
                             v8::Local<v8::Object> source_port =
-                                v8::Local<v8::Object>());
+                                v8::Local<v8::Object>(),
+                            size_t buffer_size_hint = 0,
+                            bool plain_data = false);
+
+  size_t payload_size() const { return main_message_buf_.size; }
 
   // Internal method of Message that is called when a new SharedArrayBuffer
   // object is encountered in the incoming value's structure.
@@ -179,8 +192,8 @@ class MessagePortData : public TransferData {
   MessagePortData(const MessagePortData& other) = delete;
   MessagePortData& operator=(const MessagePortData& other) = delete;
 
-  // Add a message to the incoming queue and notify the receiver.
-  // This may be called from any thread.
+  // Add a message to the incoming queue and notify the receiver if the queue
+  // was empty before. This may be called from any thread.
   void AddToIncomingQueue(std::shared_ptr<Message> message);
   v8::Maybe<bool> Dispatch(
       std::shared_ptr<Message> message,
@@ -206,6 +219,10 @@ class MessagePortData : public TransferData {
   SET_SELF_SIZE(MessagePortData)
 
  private:
+  // Messages that the owner has already taken out of incoming_messages_ in
+  // one batch but not yet processed. Only accessed from the owner's thread,
+  // so that the mutex is not taken for every received message.
+  std::deque<std::shared_ptr<Message>> received_messages_;
   // This mutex protects all fields below it, with the exception of
   // sibling_.
   mutable Mutex mutex_;
@@ -262,6 +279,7 @@ class MessagePort : public HandleWrap {
   static void Start(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Stop(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Drain(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetPlainData(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void ReceiveMessage(const v8::FunctionCallbackInfo<v8::Value>& args);
 
   /* static */
@@ -312,6 +330,12 @@ class MessagePort : public HandleWrap {
 
   std::unique_ptr<MessagePortData> data_ = nullptr;
   bool receiving_messages_ = false;
+  // Payload size of the last message posted through this port, capped, used to
+  // size the serialization buffer of the next one.
+  size_t last_payload_size_ = 0;
+  // Whether messages posted through this port are serialized in plain data
+  // mode, see Message::Serialize().
+  bool plain_data_ = false;
   uv_async_t async_;
   v8::Global<v8::Function> emit_message_fn_;
 
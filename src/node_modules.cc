@@ -1,9 +1,11 @@
 #include "node_modules.h"
+#include <algorithm>
 #include <cstdio>
 #include "base_object-inl.h"
 #include "compile_cache.h"
 #include "node_errors.h"
 #include "node_external_reference.h"
+#include "node_sea.h"
 #include "node_url.h"
 #include "path.h"
 #include "permission/permission.h"
@@ -27,16 +29,21 @@ using v8::FunctionCallbackInfo;
 using v8::HandleScope;
 using v8::Integer;
 using v8::Isolate;
+using v8::Just;
 using v8::Local;
 using v8::LocalVector;
+using v8::Maybe;
 using v8::Name;
 using v8::NewStringType;
+using v8::Nothing;
 using v8::Null;
 using v8::Object;
 using v8::ObjectTemplate;
 using v8::Primitive;
 using v8::PropertyCallbackInfo;
 using v8::String;
+using v8::TryCatch;
+using v8::Uint32;
 using v8::Undefined;
 using v8::Value;
 
@@ -74,6 +81,60 @@ void BindingData::Deserialize(v8::Local<v8::Context> context,
   CHECK_NOT_NULL(binding);
 }
 
+namespace {
+
+// Encoding of a PackageConfig in the module resolution cache of the compile
+// cache: for each field, a presence byte, a uint32_t length and the bytes.
+using PackageConfig = BindingData::PackageConfig;
+
+void AppendField(std::string* out, const std::optional<std::string>& field) {
+  out->push_back(field.has_value() ? 1 : 0);
+  uint32_t length = field.has_value() ? field->size() : 0;
+  out->append(reinterpret_cast<const char*>(&length), sizeof(length));
+  if (field.has_value()) out->append(*field);
+}
+
+bool ReadField(std::string_view* in, std::optional<std::string>* field) {
+  uint32_t length;
+  if (in->size() < 1 + sizeof(length)) return false;
+  bool present = (*in)[0] != 0;
+  memcpy(&length, in->data() + 1, sizeof(length));
+  in->remove_prefix(1 + sizeof(length));
+  if (length > in->size()) return false;
+  if (present) {
+    *field = std::string(in->substr(0, length));
+  } else {
+    field->reset();
+  }
+  in->remove_prefix(length);
+  return true;
+}
+
+std::string SerializePackageConfig(const PackageConfig& config) {
+  std::string out;
+  AppendField(&out, config.name);
+  AppendField(&out, config.main);
+  AppendField(&out, config.type);
+  AppendField(&out, config.exports);
+  AppendField(&out, config.imports);
+  AppendField(&out, config.scripts);
+  return out;
+}
+
+bool DeserializePackageConfig(std::string_view in, PackageConfig* config) {
+  std::optional<std::string> type;
+  if (!ReadField(&in, &config->name) || !ReadField(&in, &config->main) ||
+      !ReadField(&in, &type) || !ReadField(&in, &config->exports) ||
+      !ReadField(&in, &config->imports) || !ReadField(&in, &config->scripts) ||
+      !type.has_value() || !in.empty()) {
+    return false;
+  }
+  config->type = std::move(*type);
+  return true;
+}
+
+}  // anonymous namespace
+
 Local<Array> BindingData::PackageConfig::Serialize(Realm* realm) const {
   auto isolate = realm->isolate();
   const auto ToString = [isolate](std::string_view input) -> Local<Primitive> {
@@ -103,8 +164,37 @@ const BindingData::PackageConfig* BindingData::GetPackageJSON(
 
   PackageConfig package_config{};
   package_config.file_path = path;
+
+  // With the compile cache enabled, package.json files that have not
+  // changed since the last run are not read and parsed again.
+  Environment* env = realm->env();
+  CompileCacheHandler* compile_cache =
+      env->use_compile_cache() ? env->compile_cache_handler() : nullptr;
+  // package.json files bundled into a single executable are never read
+  // from disk.
+  const sea::SeaModule* embedded = sea::FindSingleExecutableModule(path);
+  if (embedded != nullptr) compile_cache = nullptr;
+  uv_stat_t stat;
+  if (compile_cache != nullptr) {
+    uv_fs_t req;
+    int err = uv_fs_stat(nullptr, &req, path.data(), nullptr);
+    stat = req.statbuf;
+    uv_fs_req_cleanup(&req);
+    if (err < 0) return nullptr;
+    auto cached =
+        compile_cache->GetResolutionCacheEntry(package_config.file_path, stat);
+    if (cached.has_value() &&
+        DeserializePackageConfig(*cached, &package_config)) {
+      auto inserted = binding_data->package_configs_.insert(
+          {std::string(path), std::move(package_config)});
+      return &inserted.first->second;
+    }
+  }
+
   // No need to exclude BOM since simdjson will skip it.
-  if (ReadFileSync(&package_config.raw_json, path.data()) < 0) {
+  if (embedded != nullptr) {
+    package_config.raw_json = embedded->source;
+  } else if (ReadFileSync(&package_config.raw_json, path.data()) < 0) {
     return nullptr;
   }
   // In some systems, std::string is annotated to generate an
@@ -246,6 +336,11 @@ const BindingData::PackageConfig* BindingData::GetPackageJSON(
       }
     }
   }
+  if (compile_cache != nullptr) {
+    compile_cache->SaveResolutionCacheEntry(
+        package_config.file_path, stat, SerializePackageConfig(package_config));
+  }
+
   // package_config could be quite large, so we should move it instead of
   // copying it.
   auto cached = binding_data->package_configs_.insert(
@@ -486,6 +581,447 @@ void BindingData::GetPackageScopeConfig(
   }
 }
 
+namespace {
+
+// Mirrors the `isRelative` check of Module._findPath().
+bool IsRelativeRequest(std::string_view request) {
+  const auto is_separator = [](char c) {
+#ifdef _WIN32
+    return c == '/' || c == '\\';
+#else
+    return c == '/';
+#endif
+  };
+  if (request.empty() || request[0] != '.') return false;
+  if (request.size() == 1 || is_separator(request[1])) return true;
+  return request[1] == '.' &&
+         (request.size() == 2 || is_separator(request[2]));
+}
+
+// Mirrors path.isAbsolute(), which Module._findPath() uses. Unlike
+// std::filesystem::path::is_absolute(), it treats "\\foo" as absolute and
+// "C:foo" as relative on Windows.
+bool IsAbsoluteRequest(std::string_view request) {
+  if (request.empty()) return false;
+#ifdef _WIN32
+  const auto is_separator = [](char c) { return c == '/' || c == '\\'; };
+  if (is_separator(request[0])) return true;
+  const char drive = request[0] | 0x20;
+  return request.size() > 2 && drive >= 'a' && drive <= 'z' &&
+         request[1] == ':' && is_separator(request[2]);
+#else
+  return request[0] == '/';
+#endif
+}
+
+// Mirrors the `trailingSlash` check of Module._findPath().
+bool HasTrailingSlash(std::string_view request) {
+  if (request.empty()) return false;
+#ifdef _WIN32
+  if (request.back() == '\\') return true;
+#endif
+  return request.back() == '/' || request == "." || request == ".." ||
+         request.ends_with("/.") || request.ends_with("/..");
+}
+
+// Returns the package name of a bare specifier as matched by the
+// EXPORTS_PATTERN of the CommonJS loader, i.e.
+// /^((?:@[^/\\%]+\/)?[^./\\%][^/\\%]*)(\/.*)?$/, or an empty view when the
+// specifier does not match.
+std::string_view GetExportsPackageName(std::string_view request) {
+  const auto is_reserved = [](char c) {
+    return c == '/' || c == '\\' || c == '%';
+  };
+  // Matches `[^./\\%][^/\\%]*(\/.*)?$` from `pos` and returns the end of the
+  // name, or std::string_view::npos.
+  const auto match_name = [&](size_t pos) {
+    if (pos == request.size() || request[pos] == '.' ||
+        is_reserved(request[pos])) {
+      return std::string_view::npos;
+    }
+    while (++pos < request.size() && !is_reserved(request[pos])) {
+    }
+    if (pos < request.size() && request[pos] != '/') {
+      return std::string_view::npos;
+    }
+    return pos;
+  };
+  size_t end = std::string_view::npos;
+  if (!request.empty() && request[0] == '@') {
+    size_t pos = 1;
+    while (pos < request.size() && !is_reserved(request[pos])) pos++;
+    if (pos > 1 && pos < request.size() && request[pos] == '/') {
+      end = match_name(pos + 1);
+    }
+  }
+  // Like the regular expression, fall back to matching the specifier without
+  // a scope, in which case the "@" is part of the name, e.g. "@foo" or the
+  // "@a" of "@a/.b".
+  if (end == std::string_view::npos) end = match_name(0);
+  if (end == std::string_view::npos) return {};
+  return request.substr(0, end);
+}
+
+bool ToStringVector(Isolate* isolate,
+                    Local<Context> context,
+                    Local<Array> array,
+                    std::vector<std::string>* out) {
+  out->reserve(array->Length());
+  for (uint32_t i = 0; i < array->Length(); i++) {
+    Local<Value> value;
+    if (!array->Get(context, i).ToLocal(&value)) return false;
+    CHECK(value->IsString());
+    Utf8Value utf8_value(isolate, value);
+    out->push_back(utf8_value.ToString());
+  }
+  return true;
+}
+
+}  // anonymous namespace
+
+// Runs the file system part of Module._findPath() for one request and a list
+// of lookup paths in a single call, caching stat() results for the duration
+// of the call. Returns the resolved (but not yet realpath()'d) filename,
+// false when nothing was found, or the index of the lookup path at which the
+// JS implementation must take over, e.g. because a package "exports" field or
+// an unresolvable "main" field was encountered.
+void BindingData::FindPath(const FunctionCallbackInfo<Value>& args) {
+  CHECK_GE(args.Length(), 4);  // request, paths, extensions, startIndex
+  CHECK(args[0]->IsString());
+  CHECK(args[1]->IsArray());
+  CHECK(args[2]->IsArray());
+  CHECK(args[3]->IsUint32());
+
+  Realm* realm = Realm::GetCurrent(args);
+  Environment* env = realm->env();
+  Isolate* isolate = realm->isolate();
+  Local<Context> context = realm->context();
+
+  Utf8Value request_value(isolate, args[0]);
+  std::string_view request = request_value.ToStringView();
+  std::vector<std::string> paths;
+  std::vector<std::string> extensions;
+  if (!ToStringVector(isolate, context, args[1].As<Array>(), &paths) ||
+      !ToStringVector(isolate, context, args[2].As<Array>(), &extensions)) {
+    return;
+  }
+  size_t start_index = args[3].As<Uint32>()->Value();
+
+  const bool absolute_request = IsAbsoluteRequest(request);
+  if (absolute_request) {
+    paths = {""};
+    start_index = 0;
+  }
+  const bool trailing_slash = HasTrailingSlash(request);
+  bool inside_path = true;
+  if (IsRelativeRequest(request)) {
+    inside_path = !NormalizeString(request, true, {&kPathSeparator, 1})
+                       .starts_with("..");
+  }
+
+  // Like internalModuleStat() and readPackageJSON(), which the JS
+  // implementation calls, probe the namespaced paths while the returned
+  // filename stays as resolved.
+  std::unordered_map<std::string, int> stat_cache;
+  const auto stat = [&](const std::string& path) -> int {
+    auto it = stat_cache.find(path);
+    if (it != stat_cache.end()) return it->second;
+    std::string namespaced_path = path;
+    ToNamespacedPath(env, &namespaced_path);
+    uv_fs_t req;
+    int rc = uv_fs_stat(
+        env->event_loop(), &req, namespaced_path.c_str(), nullptr);
+    if (rc == 0) {
+      const uv_stat_t* const s = static_cast<const uv_stat_t*>(req.ptr);
+      rc = S_ISDIR(s->st_mode);
+    }
+    uv_fs_req_cleanup(&req);
+    stat_cache.emplace(path, rc);
+    return rc;
+  };
+  const auto try_extensions =
+      [&](const std::string& base) -> std::optional<std::string> {
+    for (const std::string& extension : extensions) {
+      std::string filename = base + extension;
+      if (stat(filename) == 0) return filename;
+    }
+    return std::nullopt;
+  };
+
+  TryCatch try_catch(isolate);
+  const auto read_package = [&](std::string_view dir,
+                                std::string_view subpath)
+      -> Maybe<const PackageConfig*> {
+    std::string package_json_path =
+        PathResolve(env, {dir, subpath, "package.json"});
+    ToNamespacedPath(env, &package_json_path);
+    const PackageConfig* package_json =
+        GetPackageJSON(realm, package_json_path);
+    if (try_catch.HasCaught()) return Nothing<const PackageConfig*>();
+    return Just(package_json);
+  };
+
+  const std::string_view package_name =
+      absolute_request ? std::string_view() : GetExportsPackageName(request);
+
+  for (size_t i = start_index; i < paths.size(); i++) {
+    const std::string& current_path = paths[i];
+    if (inside_path && !current_path.empty() && stat(current_path) < 1) {
+      continue;
+    }
+
+    const PackageConfig* package_json;
+    if (!package_name.empty()) {
+      if (!read_package(current_path, package_name).To(&package_json)) {
+        try_catch.ReThrow();
+        return;
+      }
+      if (package_json != nullptr && package_json->exports.has_value()) {
+        return args.GetReturnValue().Set(static_cast<uint32_t>(i));
+      }
+    }
+
+    std::string base_path = PathResolve(env, {current_path, request});
+    const int rc = stat(base_path);
+    std::optional<std::string> filename;
+    if (!trailing_slash) {
+      filename = rc == 0 ? std::optional(base_path) : try_extensions(base_path);
+    }
+
+    if (!filename.has_value() && rc == 1) {
+      if (!read_package(base_path, "").To(&package_json)) {
+        try_catch.ReThrow();
+        return;
+      }
+      if (package_json == nullptr || !package_json->main.has_value() ||
+          package_json->main->empty()) {
+        filename = try_extensions(PathResolve(env, {base_path, "index"}));
+      } else {
+        std::string main_path =
+            PathResolve(env, {base_path, *package_json->main});
+        if (stat(main_path) == 0) {
+          filename = main_path;
+        } else {
+          filename = try_extensions(main_path);
+          if (!filename.has_value()) {
+            filename = try_extensions(PathResolve(env, {main_path, "index"}));
+          }
+        }
+        // Let the JS implementation handle the fallback to index.js and
+        // the associated deprecation warning or error.
+        if (!filename.has_value()) {
+          return args.GetReturnValue().Set(static_cast<uint32_t>(i));
+        }
+      }
+    }
+
+    if (filename.has_value()) {
+      Local<Value> ret;
+      if (ToV8Value(context, *filename, isolate).ToLocal(&ret)) {
+        args.GetReturnValue().Set(ret);
+      }
+      return;
+    }
+  }
+
+  args.GetReturnValue().Set(false);
+}
+
+namespace {
+
+// Mirrors patternKeyCompare() of the ESM resolver.
+int PatternKeyCompare(std::string_view a, std::string_view b) {
+  const size_t a_pattern_index = a.find('*');
+  const size_t b_pattern_index = b.find('*');
+  const size_t base_len_a = a_pattern_index == std::string_view::npos
+                                ? a.size()
+                                : a_pattern_index + 1;
+  const size_t base_len_b = b_pattern_index == std::string_view::npos
+                                ? b.size()
+                                : b_pattern_index + 1;
+  if (base_len_a > base_len_b) return -1;
+  if (base_len_b > base_len_a) return 1;
+  if (a_pattern_index == std::string_view::npos) return 1;
+  if (b_pattern_index == std::string_view::npos) return -1;
+  if (a.size() > b.size()) return -1;
+  if (b.size() > a.size()) return 1;
+  return 0;
+}
+
+// Compiles the "exports" or "imports" field of a package.json. Returns
+// nullptr when the field is not something that can be resolved natively, e.g.
+// an "exports" object mixing subpath keys and conditions, so that the JS
+// implementation can report the error.
+std::unique_ptr<BindingData::PackageMap> CompilePackageMap(
+    simdjson::ondemand::parser* parser,
+    const std::string& field,
+    bool is_imports) {
+  auto map = std::make_unique<BindingData::PackageMap>();
+  if (field.empty() || (field[0] != '{' && field[0] != '[')) {
+    if (is_imports) return nullptr;
+    map->plain_string = true;
+    map->exact.emplace(".", field);
+    return map;
+  }
+  if (field[0] == '[') {
+    if (is_imports) return nullptr;
+    map->exact.emplace(".", field);
+    return map;
+  }
+
+  simdjson::padded_string json(field);
+  simdjson::ondemand::document document;
+  simdjson::ondemand::object object;
+  if (parser->iterate(json).get(document) ||
+      document.get_object().get(object)) {
+    return nullptr;
+  }
+
+  bool has_subpath_keys = false;
+  bool has_condition_keys = false;
+  std::string_view key;
+  std::string_view target;
+  simdjson::ondemand::value value;
+  for (auto member : object) {
+    if (member.unescaped_key().get(key) || member.value().get(value) ||
+        value.raw_json().get(target)) {
+      return nullptr;
+    }
+    if (is_imports || key.starts_with('.')) {
+      has_subpath_keys = true;
+    } else {
+      has_condition_keys = true;
+    }
+    // Like JSON.parse(), the last of duplicate keys wins.
+    const size_t pattern_index = key.find('*');
+    if (pattern_index == std::string_view::npos) {
+      map->exact.insert_or_assign(std::string(key), std::string(target));
+    } else if (key.rfind('*') == pattern_index) {
+      auto it = std::find_if(
+          map->patterns.begin(), map->patterns.end(), [&](const auto& entry) {
+            return entry.key == key;
+          });
+      if (it != map->patterns.end()) {
+        it->target = target;
+      } else {
+        map->patterns.push_back({std::string(key), std::string(target)});
+      }
+    }
+    // Keys with more than one "*" never match in the JS resolver.
+  }
+  if (has_subpath_keys && has_condition_keys) return nullptr;
+  if (has_condition_keys) {
+    // Conditions sugar, equivalent to { ".": <exports> }.
+    map->exact.clear();
+    map->patterns.clear();
+    map->exact.emplace(".", field);
+    return map;
+  }
+  std::stable_sort(map->patterns.begin(),
+                   map->patterns.end(),
+                   [](const auto& a, const auto& b) {
+                     return PatternKeyCompare(a.key, b.key) < 0;
+                   });
+  return map;
+}
+
+}  // anonymous namespace
+
+// Resolves a package subpath (e.g. "./feature") or an import specifier (e.g.
+// "#dep") against the "exports" or "imports" field of a package.json, using a
+// compiled map instead of re-parsing the whole field on every lookup.
+// Returns [target, patternMatch, matchedKey] where target is the parsed JSON
+// value of the matching entry, null when no key matches, or undefined when
+// the field is missing or invalid and resolution has to fall back to JS.
+void BindingData::ResolvePackageMap(const FunctionCallbackInfo<Value>& args) {
+  CHECK_GE(args.Length(), 3);  // path, matchKey, isImports
+  CHECK(args[0]->IsString());
+  CHECK(args[1]->IsString());
+
+  Realm* realm = Realm::GetCurrent(args);
+  Isolate* isolate = realm->isolate();
+  Local<Context> context = realm->context();
+
+  BufferValue path(isolate, args[0]);
+  Utf8Value match_key_value(isolate, args[1]);
+  std::string_view match_key = match_key_value.ToStringView();
+  const bool is_imports = args[2]->IsTrue();
+
+  THROW_IF_INSUFFICIENT_PERMISSIONS(
+      realm->env(),
+      permission::PermissionScope::kFileSystemRead,
+      path.ToStringView());
+
+  ToNamespacedPath(realm->env(), &path);
+  const PackageConfig* package_json =
+      GetPackageJSON(realm, path.ToStringView());
+  if (package_json == nullptr) return;
+
+  const std::optional<std::string>& field =
+      is_imports ? package_json->imports : package_json->exports;
+  if (!field.has_value()) return;
+  auto& compiled =
+      is_imports ? package_json->imports_map : package_json->exports_map;
+  if (!compiled.has_value()) {
+    auto binding_data = realm->GetBindingData<BindingData>();
+    compiled =
+        CompilePackageMap(&binding_data->json_parser, *field, is_imports);
+  }
+  const PackageMap* map = compiled->get();
+  if (map == nullptr) return;
+
+  const std::string* target = nullptr;
+  std::string_view matched_key = match_key;
+  std::optional<std::string_view> pattern_match;
+  const bool exact_allowed = match_key.find('*') == std::string_view::npos &&
+                             (is_imports || !match_key.ends_with('/'));
+  if (exact_allowed) {
+    auto it = map->exact.find(std::string(match_key));
+    if (it != map->exact.end()) target = &it->second;
+  }
+  if (target == nullptr) {
+    for (const PackageMap::Entry& entry : map->patterns) {
+      const size_t pattern_index = entry.key.find('*');
+      const std::string_view key = entry.key;
+      const std::string_view base = key.substr(0, pattern_index);
+      const std::string_view trailer = key.substr(pattern_index + 1);
+      if (match_key.size() <= base.size() || !match_key.starts_with(base)) {
+        continue;
+      }
+      if (!trailer.empty() && (!match_key.ends_with(trailer) ||
+                               match_key.size() < entry.key.size())) {
+        continue;
+      }
+      target = &entry.target;
+      matched_key = entry.key;
+      pattern_match = match_key.substr(
+          base.size(), match_key.size() - base.size() - trailer.size());
+      break;
+    }
+  }
+  if (target == nullptr) {
+    return args.GetReturnValue().SetNull();
+  }
+
+  Local<Value> target_string;
+  Local<Value> target_value;
+  if (!ToV8Value(context, *target, isolate).ToLocal(&target_string)) return;
+  if (map->plain_string) {
+    target_value = target_string;
+  } else if (!v8::JSON::Parse(context, target_string.As<String>())
+                  .ToLocal(&target_value)) {
+    return;
+  }
+  Local<Value> values[3] = {
+      target_value, Undefined(isolate), Undefined(isolate)};
+  if ((pattern_match.has_value() &&
+       !ToV8Value(context, *pattern_match, isolate).ToLocal(&values[1])) ||
+      !ToV8Value(context, matched_key, isolate).ToLocal(&values[2])) {
+    return;
+  }
+  args.GetReturnValue().Set(Array::New(isolate, values, arraysize(values)));
+}
+
 void FlushCompileCache(const FunctionCallbackInfo<Value>& args) {
   Isolate* isolate = args.GetIsolate();
   Local<Context> context = isolate->GetCurrentContext();
@@ -496,10 +1032,14 @@ void FlushCompileCache(const FunctionCallbackInfo<Value>& args) {
                                "keepDeserializedCache should be a boolean");
     return;
   }
+  if (!args[1]->IsBoolean() && !args[1]->IsUndefined()) {
+    THROW_ERR_INVALID_ARG_TYPE(env, "wait should be a boolean");
+    return;
+  }
   Debug(env,
         DebugCategory::COMPILE_CACHE,
         "[compile cache] module.flushCompileCache() requested.\n");
-  env->FlushCompileCache();
+  env->FlushCompileCache(!args[1]->IsFalse());
   Debug(env,
         DebugCategory::COMPILE_CACHE,
         "[compile cache] module.flushCompileCache() finished.\n");
@@ -575,8 +1115,13 @@ void GetCompileCacheEntry(const FunctionCallbackInfo<Value>& args) {
         reinterpret_cast<const char*>(cache_entry->cache->data),
         cache_entry->cache->length);
     Local<Value> transpiled;
-    // TODO(joyeecheung): convert with simdutf and into external strings
-    if (!ToV8Value(context, cache).ToLocal(&transpiled)) {
+    // Code that was read from disk is usually shared with other threads and
+    // does not need to be copied.
+    Local<String> shared;
+    if (cache_entry->ShareTranspiledCode(isolate).ToLocal(&shared)) {
+      transpiled = shared;
+      Debug(env, DebugCategory::COMPILE_CACHE, "shared\n");
+    } else if (!ToV8Value(context, cache).ToLocal(&transpiled)) {
       Debug(env, DebugCategory::COMPILE_CACHE, "failed\n");
       return;
     } else {
@@ -693,6 +1238,8 @@ void BindingData::CreatePerIsolateProperties(IsolateData* isolate_data,
   SetMethod(
       isolate, target, "getPackageScopeConfig", GetPackageScopeConfig<false>);
   SetMethod(isolate, target, "getPackageType", GetPackageScopeConfig<true>);
+  SetMethod(isolate, target, "findPath", FindPath);
+  SetMethod(isolate, target, "resolvePackageMap", ResolvePackageMap);
   SetMethod(isolate, target, "enableCompileCache", EnableCompileCache);
   SetMethod(isolate, target, "getCompileCacheDir", GetCompileCacheDir);
   SetMethod(isolate, target, "flushCompileCache", FlushCompileCache);
@@ -749,6 +1296,8 @@ void BindingData::RegisterExternalReferences(
   registry->Register(GetNearestParentPackageJSON);
   registry->Register(GetPackageScopeConfig<false>);
   registry->Register(GetPackageScopeConfig<true>);
+  registry->Register(FindPath);
+  registry->Register(ResolvePackageMap);
   registry->Register(EnableCompileCache);
   registry->Register(GetCompileCacheDir);
   registry->Register(FlushCompileCache);
@@ -11,10 +11,12 @@
 #include "v8.h"
 
 #include <filesystem>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <unordered_map>
+#include <vector>
 
 namespace node {
 class ExternalReferenceRegistry;
@@ -25,6 +27,21 @@ class BindingData : public SnapshotableObject {
  public:
   using InternalFieldInfo = InternalFieldInfoBase;
 
+  // A compiled "exports" or "imports" field. Subpath keys map to the raw
+  // JSON text of their targets, so that resolving a specifier against a
+  // large map only parses the single target that matches.
+  struct PackageMap {
+    struct Entry {
+      std::string key;
+      std::string target;
+    };
+    std::unordered_map<std::string, std::string> exact;
+    // Keys containing a "*", in PATTERN_KEY_COMPARE order.
+    std::vector<Entry> patterns;
+    // The field was a plain string, stored unquoted as the "." target.
+    bool plain_string = false;
+  };
+
   struct PackageConfig {
     std::string file_path;
     std::optional<std::string> name;
@@ -34,6 +51,11 @@ class BindingData : public SnapshotableObject {
     std::optional<std::string> imports;
     std::optional<std::string> scripts;
     std::string raw_json;
+    // Compiled on first use by ResolvePackageMap(). nullptr after a
+    // compilation attempt means the field is invalid and has to be handled
+    // by the JS implementation.
+    mutable std::optional<std::unique_ptr<PackageMap>> exports_map;
+    mutable std::optional<std::unique_ptr<PackageMap>> imports_map;
 
     v8::Local<v8::Array> Serialize(Realm* realm) const;
   };
@@ -64,6 +86,9 @@ class BindingData : public SnapshotableObject {
       const v8::FunctionCallbackInfo<v8::Value>& args);
   static void GetPackageJSONScripts(
       const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void FindPath(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void ResolvePackageMap(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
 
   static void CreatePerIsolateProperties(IsolateData* isolate_data,
                                          v8::Local<v8::ObjectTemplate> ctor);
@@ -71,6 +71,8 @@ class MutexBase {
   inline MutexBase();
   inline ~MutexBase();
   inline void Lock();
+  // Returns true if the lock was acquired without blocking.
+  inline bool TryLock();
   inline void Unlock();
   inline void RdLock();
   inline void RdUnlock();
@@ -183,6 +185,10 @@ struct LibuvMutexTraits {
     uv_mutex_lock(mutex);
   }
 
+  static inline int mutex_trylock(MutexT* mutex) {
+    return uv_mutex_trylock(mutex);
+  }
+
   static inline void mutex_unlock(MutexT* mutex) {
     uv_mutex_unlock(mutex);
   }
@@ -211,6 +217,10 @@ struct LibuvRwlockTraits {
     uv_rwlock_wrlock(mutex);
   }
 
+  static inline int mutex_trylock(MutexT* mutex) {
+    return uv_rwlock_trywrlock(mutex);
+  }
+
   static inline void mutex_unlock(MutexT* mutex) {
     uv_rwlock_wrunlock(mutex);
   }
@@ -264,6 +274,11 @@ void MutexBase<Traits>::Lock() {
   Traits::mutex_lock(&mutex_);
 }
 
+template <typename Traits>
+bool MutexBase<Traits>::TryLock() {
+  return Traits::mutex_trylock(&mutex_) == 0;
+}
+
 template <typename Traits>
 void MutexBase<Traits>::Unlock() {
   Traits::mutex_unlock(&mutex_);
@@ -0,0 +1,218 @@
+#include "node_numa.h"
+#include "util.h"
+#include "uv.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <string>
+
+#if defined(__linux__)
+#include <dirent.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace node {
+namespace numa {
+
+namespace {
+
+bool ParseNumber(std::string_view* input, int* out) {
+  size_t i = 0;
+  int64_t value = 0;
+  while (i < input->size() && (*input)[i] >= '0' && (*input)[i] <= '9') {
+    value = value * 10 + ((*input)[i] - '0');
+    if (value > INT_MAX) return false;
+    i++;
+  }
+  if (i == 0) return false;
+  *out = static_cast<int>(value);
+  input->remove_prefix(i);
+  return true;
+}
+
+#if defined(__linux__)
+// From <linux/mempolicy.h>, which is not always installed.
+constexpr int kMpolDefault = 0;
+constexpr int kMpolPreferred = 1;
+constexpr int kMpolBind = 2;
+constexpr int kMpolInterleave = 3;
+
+constexpr size_t kBitsPerWord = sizeof(unsigned long) * CHAR_BIT;  // NOLINT
+// get_mempolicy(2) fails unless its mask can hold every possible node, and
+// kernels support at most 2**10 of them.
+constexpr size_t kMaxNodes = 1024;
+
+void AddToNodeMask(std::vector<unsigned long>* mask, int node) {  // NOLINT
+  size_t word = node / kBitsPerWord;
+  if (mask->size() <= word) mask->resize(word + 1);
+  (*mask)[word] |= 1UL << (node % kBitsPerWord);
+}
+#endif  // defined(__linux__)
+
+}  // namespace
+
+bool ParseCpuList(std::string_view list, std::vector<int>* cpus) {
+  // Lists read from sysfs end with a newline.
+  while (!list.empty() && (list.back() == '\n' || list.back() == ' '))
+    list.remove_suffix(1);
+  cpus->clear();
+  while (!list.empty()) {
+    int first;
+    int last;
+    if (!ParseNumber(&list, &first)) return false;
+    last = first;
+    if (!list.empty() && list.front() == '-') {
+      list.remove_prefix(1);
+      if (!ParseNumber(&list, &last) || last < first) return false;
+    }
+    for (int cpu = first; cpu <= last; cpu++) cpus->push_back(cpu);
+    if (list.empty()) break;
+    if (list.front() != ',') return false;
+    list.remove_prefix(1);
+    if (list.empty()) return false;
+  }
+  return true;
+}
+
+std::vector<Node> GetTopology() {
+  std::vector<Node> nodes;
+#if defined(__linux__)
+  const char* const kNodeDir = "/sys/devices/system/node";
+  DIR* dir = opendir(kNodeDir);
+  if (dir == nullptr) return nodes;
+  while (struct dirent* entry = readdir(dir)) {
+    std::string_view name(entry->d_name);
+    if (name.substr(0, 4) != "node") continue;
+    name.remove_prefix(4);
+    Node node;
+    if (!ParseNumber(&name, &node.id) || !name.empty()) continue;
+    std::string cpulist;
+    std::string path = std::string(kNodeDir) + "/" + entry->d_name + "/cpulist";
+    if (ReadFileSync(&cpulist, path.c_str()) != 0) continue;
+    if (!ParseCpuList(cpulist, &node.cpus)) continue;
+    nodes.push_back(std::move(node));
+  }
+  closedir(dir);
+  std::sort(nodes.begin(), nodes.end(), [](const Node& a, const Node& b) {
+    return a.id < b.id;
+  });
+#endif  // defined(__linux__)
+  return nodes;
+}
+
+int GetCurrentThreadAffinity(std::vector<int>* cpus) {
+  int mask_size = uv_cpumask_size();
+  if (mask_size < 0) return mask_size;
+  std::vector<char> mask(mask_size);
+  uv_thread_t self = uv_thread_self();
+  int err = uv_thread_getaffinity(&self, mask.data(), mask.size());
+  if (err != 0) return err;
+  cpus->clear();
+  for (int cpu = 0; cpu < mask_size; cpu++) {
+    if (mask[cpu]) cpus->push_back(cpu);
+  }
+  return 0;
+}
+
+int SetCurrentThreadAffinity(const std::vector<int>& cpus) {
+  int mask_size = uv_cpumask_size();
+  if (mask_size < 0) return mask_size;
+  std::vector<char> mask(mask_size);
+  for (int cpu : cpus) {
+    if (cpu < 0 || cpu >= mask_size) return UV_EINVAL;
+    mask[cpu] = 1;
+  }
+  uv_thread_t self = uv_thread_self();
+  return uv_thread_setaffinity(&self, mask.data(), nullptr, mask.size());
+}
+
+int SetCurrentThreadMemoryPolicy(int node, MemoryPolicy policy) {
+  if (policy == MemoryPolicy::kNone) return 0;
+  if (policy != MemoryPolicy::kDefault && node < 0) return UV_EINVAL;
+#if defined(__linux__) && defined(SYS_set_mempolicy)
+  std::vector<unsigned long> mask;  // NOLINT(runtime/int)
+  int mode = kMpolDefault;
+  switch (policy) {
+    case MemoryPolicy::kNone:
+    case MemoryPolicy::kDefault:
+      break;
+    case MemoryPolicy::kBind:
+      mode = kMpolBind;
+      AddToNodeMask(&mask, node);
+      break;
+    case MemoryPolicy::kPreferred:
+      mode = kMpolPreferred;
+      AddToNodeMask(&mask, node);
+      break;
+    case MemoryPolicy::kInterleave: {
+      mode = kMpolInterleave;
+      std::vector<Node> nodes = GetTopology();
+      for (const Node& n : nodes) AddToNodeMask(&mask, n.id);
+      if (nodes.empty()) AddToNodeMask(&mask, node);
+      break;
+    }
+  }
+  // The kernel expects the number of bits in the mask plus one.
+  unsigned long maxnode = mask.size() * kBitsPerWord + 1;  // NOLINT
+  if (syscall(SYS_set_mempolicy,
+              mode,
+              mask.empty() ? nullptr : mask.data(),
+              mask.empty() ? 0 : maxnode) != 0) {
+    return uv_translate_sys_error(errno);
+  }
+  return 0;
+#else
+  return UV_ENOTSUP;
+#endif
+}
+
+int GetCurrentThreadMemoryPolicy(SavedMemoryPolicy* saved) {
+#if defined(__linux__) && defined(SYS_get_mempolicy)
+  saved->nodes.assign(kMaxNodes / kBitsPerWord, 0);
+  if (syscall(SYS_get_mempolicy,
+              &saved->mode,
+              saved->nodes.data(),
+              kMaxNodes,
+              nullptr,
+              0) != 0) {
+    return uv_translate_sys_error(errno);
+  }
+  return 0;
+#else
+  return UV_ENOTSUP;
+#endif
+}
+
+int RestoreCurrentThreadMemoryPolicy(const SavedMemoryPolicy& saved) {
+#if defined(__linux__) && defined(SYS_set_mempolicy)
+  // A policy without nodes, e.g. MPOL_DEFAULT, must be set without a mask.
+  bool empty = std::all_of(saved.nodes.begin(),
+                           saved.nodes.end(),
+                           [](auto word) { return word == 0; });
+  unsigned long maxnode = saved.nodes.size() * kBitsPerWord + 1;  // NOLINT
+  if (syscall(SYS_set_mempolicy,
+              saved.mode,
+              empty ? nullptr : saved.nodes.data(),
+              empty ? 0 : maxnode) != 0) {
+    return uv_translate_sys_error(errno);
+  }
+  return 0;
+#else
+  return UV_ENOTSUP;
+#endif
+}
+
+int BindCurrentThread(int node, MemoryPolicy policy) {
+  for (const Node& n : GetTopology()) {
+    if (n.id != node) continue;
+    int err = SetCurrentThreadAffinity(n.cpus);
+    if (err != 0) return err;
+    return SetCurrentThreadMemoryPolicy(node, policy);
+  }
+  return UV_EINVAL;
+}
+
+}  // namespace numa
+}  // namespace node
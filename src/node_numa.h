@@ -0,0 +1,68 @@
+#ifndef SRC_NODE_NUMA_H_
+#define SRC_NODE_NUMA_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include <string_view>
+#include <vector>
+
+namespace node {
+namespace numa {
+
+// How the memory of a thread that is bound to a NUMA node is placed.
+enum class MemoryPolicy {
+  kNone,        // Leave the thread's memory policy alone.
+  kDefault,     // Reset to the system default, i.e. allocate locally.
+  kBind,        // Allocate only from the node.
+  kPreferred,   // Allocate from the node, falling back to the others.
+  kInterleave,  // Spread allocations over all nodes, page by page.
+};
+
+struct Node {
+  int id;
+  std::vector<int> cpus;
+};
+
+// A thread's memory policy as reported by the kernel, including its mode
+// flags.
+struct SavedMemoryPolicy {
+  int mode = 0;
+  std::vector<unsigned long> nodes;  // NOLINT(runtime/int)
+};
+
+// Parses a kernel CPU list such as "0-3,8,10-11". Returns false if the list
+// is malformed.
+bool ParseCpuList(std::string_view list, std::vector<int>* cpus);
+
+// Returns the NUMA nodes of the host together with their CPUs, sorted by
+// node id. Empty if the topology is not known, e.g. outside of Linux.
+std::vector<Node> GetTopology();
+
+// Returns the CPUs the calling thread may run on. Returns 0 or a libuv
+// error code.
+int GetCurrentThreadAffinity(std::vector<int>* cpus);
+
+// Restricts the calling thread to `cpus`. Returns 0 or a libuv error code.
+int SetCurrentThreadAffinity(const std::vector<int>& cpus);
+
+// Applies `policy` with respect to `node` to the calling thread. Memory that
+// has already been touched keeps its placement. Returns 0 or a libuv error
+// code; UV_ENOTSUP where memory policies are not available.
+int SetCurrentThreadMemoryPolicy(int node, MemoryPolicy policy);
+
+// Saves the calling thread's memory policy, which may have been inherited
+// from e.g. numactl(8), so that RestoreCurrentThreadMemoryPolicy() can put
+// it back. Both return 0 or a libuv error code; UV_ENOTSUP where memory
+// policies are not available.
+int GetCurrentThreadMemoryPolicy(SavedMemoryPolicy* saved);
+int RestoreCurrentThreadMemoryPolicy(const SavedMemoryPolicy& saved);
+
+// Runs both of the above for `node`, using the node's own CPUs as affinity.
+int BindCurrentThread(int node, MemoryPolicy policy);
+
+}  // namespace numa
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_NODE_NUMA_H_
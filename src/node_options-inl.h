@@ -219,6 +219,12 @@ template <typename ChildOptions>
 void OptionsParser<Options>::Insert(
     const OptionsParser<ChildOptions>& child_options_parser,
     ChildOptions* (Options::* get_child)()) {
+  // The parsers are created for every process start, avoid rehashing while
+  // merging the options of their children.
+  aliases_.reserve(aliases_.size() + child_options_parser.aliases_.size());
+  options_.reserve(options_.size() + child_options_parser.options_.size());
+  implications_.reserve(implications_.size() +
+                        child_options_parser.implications_.size());
   aliases_.insert(std::begin(child_options_parser.aliases_),
                   std::end(child_options_parser.aliases_));
 
@@ -254,20 +260,26 @@ struct ArgsInfo {
 
   std::vector<std::string>* exec_args;
 
+  // The number of entries after the program name in `*underlying` that have
+  // been consumed already. They are erased at once by EraseConsumed(), so
+  // that consuming an argument does not move all of the remaining ones.
+  size_t consumed = 0;
+
   ArgsInfo(std::vector<std::string>* args,
            std::vector<std::string>* exec_args)
     : underlying(args), exec_args(exec_args) {}
 
   size_t remaining() const {
     // -1 to account for the program name.
-    return underlying->size() - 1 + synthetic_args.size();
+    return underlying->size() - 1 - consumed + synthetic_args.size();
   }
 
   bool empty() const { return remaining() == 0; }
   const std::string& program_name() const { return underlying->at(0); }
 
   std::string& first() {
-    return synthetic_args.empty() ? underlying->at(1) : synthetic_args.front();
+    return synthetic_args.empty() ? underlying->at(1 + consumed)
+                                  : synthetic_args.front();
   }
 
   std::string pop_first() {
@@ -279,12 +291,18 @@ struct ArgsInfo {
       // which is why we do not include it.
       if (exec_args != nullptr && ret != "--")
         exec_args->push_back(ret);
-      underlying->erase(underlying->begin() + 1);
+      consumed++;
     } else {
       synthetic_args.erase(synthetic_args.begin());
     }
     return ret;
   }
+
+  void EraseConsumed() {
+    underlying->erase(underlying->begin() + 1,
+                      underlying->begin() + 1 + consumed);
+    consumed = 0;
+  }
 };
 
 template <typename Options>
@@ -482,6 +500,7 @@ void OptionsParser<Options>::Parse(
         UNREACHABLE();
     }
   }
+  args.EraseConsumed();
   options->CheckOptions(errors, orig_args);
 }
 
@@ -6,6 +6,7 @@
 #include "node_errors.h"
 #include "node_external_reference.h"
 #include "node_internals.h"
+#include "node_report.h"
 #include "node_sea.h"
 #if HAVE_OPENSSL
 #include "openssl/opensslv.h"
@@ -100,6 +101,42 @@ void PerProcessOptions::CheckOptions(std::vector<std::string>* errors,
       use_largepages != "silent") {
     errors->push_back("invalid value for --use-largepages");
   }
+
+  if (auto_tune != "none" && auto_tune != "container") {
+    errors->push_back("invalid value for --auto-tune");
+  }
+
+  if (run_concurrency < 0) {
+    errors->push_back("--run-concurrency must not be negative");
+  } else if (run_concurrency != 0 && !run_parallel) {
+    errors->push_back("--run-concurrency requires --run-parallel");
+  }
+
+  if (v8_thread_pool_numa_node < -1 || v8_thread_pool_numa_node > INT_MAX) {
+    errors->push_back("--v8-pool-numa-node is out of range");
+  }
+
+  if (array_buffer_pool_size < 0) {
+    errors->push_back("--array-buffer-pool-size must not be negative");
+  }
+
+  if (dns_cache_max_ttl < -1 || dns_cache_max_ttl > UINT32_MAX) {
+    errors->push_back("--dns-cache-max-ttl is out of range");
+  }
+  if (dns_lookup_cache_ttl < 0) {
+    errors->push_back("--dns-lookup-cache-ttl must not be negative");
+  }
+  if (dns_lookup_cache_stale_ttl < 0) {
+    errors->push_back("--dns-lookup-cache-stale-ttl must not be negative");
+  }
+
+  if (trace_event_format != "json" && trace_event_format != "perfetto") {
+    errors->push_back("invalid value for --trace-event-format");
+  }
+
+  if (trace_event_compression != "none" && trace_event_compression != "zstd") {
+    errors->push_back("invalid value for --trace-event-compression");
+  }
   per_isolate->CheckOptions(errors, argv);
 }
 
@@ -120,6 +157,13 @@ void EnvironmentOptions::CheckOptions(std::vector<std::string>* errors,
     }
   }
 
+  if (!report::ParseReportSections(report_exclude_sections).has_value()) {
+    errors->push_back(
+        "--report-exclude-sections must be a comma-separated list of "
+        "javascriptStack, javascriptHeap, nativeStack, resourceUsage, "
+        "libuv, workers, environmentVariables, userLimits and sharedObjects");
+  }
+
   if (syntax_check_only && has_eval_string) {
     errors->push_back("either --check or --eval can be used, not both");
   }
@@ -203,6 +247,9 @@ void EnvironmentOptions::CheckOptions(std::vector<std::string>* errors,
     if (!cpu_prof_name.empty()) {
       errors->push_back("--cpu-prof-name must be used with --cpu-prof");
     }
+  }
+
+  if (!cpu_prof && !cpu_prof_continuous) {
     if (!cpu_prof_dir.empty()) {
       errors->push_back("--cpu-prof-dir must be used with --cpu-prof");
     }
@@ -213,14 +260,24 @@ void EnvironmentOptions::CheckOptions(std::vector<std::string>* errors,
     }
   }
 
-  if (cpu_prof && cpu_prof_dir.empty() && !diagnostic_dir.empty()) {
+  if (!cpu_prof_continuous && cpu_prof_window != kDefaultCpuProfWindow) {
+    errors->push_back(
+        "--cpu-prof-window must be used with --cpu-prof-continuous");
+  }
+  if (cpu_prof_continuous && cpu_prof_window == 0) {
+    errors->push_back("--cpu-prof-window must be greater than 0");
+  }
+
+  if ((cpu_prof || cpu_prof_continuous) && cpu_prof_dir.empty() &&
+      !diagnostic_dir.empty()) {
       cpu_prof_dir = diagnostic_dir;
     }
 
-  if (!heap_prof) {
-    if (!heap_prof_name.empty()) {
-      errors->push_back("--heap-prof-name must be used with --heap-prof");
-    }
+  if (!heap_prof && !heap_prof_name.empty()) {
+    errors->push_back("--heap-prof-name must be used with --heap-prof");
+  }
+
+  if (!heap_prof && !heap_prof_continuous) {
     if (!heap_prof_dir.empty()) {
       errors->push_back("--heap-prof-dir must be used with --heap-prof");
     }
@@ -231,7 +288,20 @@ void EnvironmentOptions::CheckOptions(std::vector<std::string>* errors,
     }
   }
 
-  if (heap_prof && heap_prof_dir.empty() && !diagnostic_dir.empty()) {
+  if (heap_prof && heap_prof_continuous) {
+    errors->push_back(
+        "--heap-prof and --heap-prof-continuous cannot be used together");
+  }
+  if (!heap_prof_continuous && heap_prof_window != kDefaultHeapProfWindow) {
+    errors->push_back(
+        "--heap-prof-window must be used with --heap-prof-continuous");
+  }
+  if (heap_prof_continuous && heap_prof_window == 0) {
+    errors->push_back("--heap-prof-window must be greater than 0");
+  }
+
+  if ((heap_prof || heap_prof_continuous) && heap_prof_dir.empty() &&
+      !diagnostic_dir.empty()) {
     heap_prof_dir = diagnostic_dir;
   }
 
@@ -357,6 +427,13 @@ DebugOptionsParser::DebugOptionsParser() {
             "(default: stderr,http)",
             &DebugOptions::inspect_publish_uid_string,
             kAllowedInEnvvar);
+
+  AddOption("--experimental-worker-inspector-io",
+            "with --inspect, serve the inspector of each worker thread on a "
+            "port of its own, so that its sessions are not relayed through "
+            "the main thread",
+            &DebugOptions::worker_inspector_io,
+            kAllowedInEnvvar);
 }
 
 EnvironmentOptionsParser::EnvironmentOptionsParser() {
@@ -639,6 +716,17 @@ EnvironmentOptionsParser::EnvironmentOptionsParser() {
             "placed. Does not affect --prof.",
             &EnvironmentOptions::cpu_prof_dir,
             kAllowedInEnvvar);
+  AddOption("--cpu-prof-continuous",
+            "Keep the V8 CPU profiler running and write a gzipped pprof "
+            "profile for every --cpu-prof-window milliseconds of samples. "
+            "Samples every 10 ms unless --cpu-prof-interval is given.",
+            &EnvironmentOptions::cpu_prof_continuous,
+            kAllowedInEnvvar);
+  AddOption("--cpu-prof-window",
+            "length in milliseconds of each profile written by "
+            "--cpu-prof-continuous. (default: 60000)",
+            &EnvironmentOptions::cpu_prof_window,
+            kAllowedInEnvvar);
   AddOption("--experimental-network-inspection",
             "experimental network inspection support",
             &EnvironmentOptions::experimental_network_inspection);
@@ -667,6 +755,17 @@ EnvironmentOptionsParser::EnvironmentOptionsParser() {
             "profile generated with --heap-prof. (default: 512 * 1024)",
             &EnvironmentOptions::heap_prof_interval,
             kAllowedInEnvvar);
+  AddOption("--heap-prof-continuous",
+            "Keep the V8 sampling heap profiler running and write a gzipped "
+            "pprof profile of the live sampled allocations every "
+            "--heap-prof-window milliseconds and at exit.",
+            &EnvironmentOptions::heap_prof_continuous,
+            kAllowedInEnvvar);
+  AddOption("--heap-prof-window",
+            "interval in milliseconds between the profiles written by "
+            "--heap-prof-continuous. (default: 60000)",
+            &EnvironmentOptions::heap_prof_window,
+            kAllowedInEnvvar);
 #endif  // HAVE_INSPECTOR
   AddOption("--max-http-header-size",
             "set the maximum size of HTTP headers (default: 16384 (16KB))",
@@ -912,6 +1011,11 @@ EnvironmentOptionsParser::EnvironmentOptionsParser() {
             "log TLS decryption keys to named file for traffic analysis",
             &EnvironmentOptions::tls_keylog,
             kAllowedInEnvvar);
+  AddOption("--tls-handshakes-per-iteration",
+            "run at most this many server TLS handshake steps per event loop "
+            "iteration, deferring the rest (default: 0, unlimited)",
+            &EnvironmentOptions::tls_handshakes_per_iteration,
+            kAllowedInEnvvar);
 
   AddOption("--tls-min-v1.0",
             "set default TLS minimum to TLSv1.0 (default: TLSv1.2)",
@@ -952,6 +1056,11 @@ EnvironmentOptionsParser::EnvironmentOptionsParser() {
             " (default: false)",
             &EnvironmentOptions::report_exclude_network,
             kAllowedInEnvvar);
+  AddOption("--report-exclude-sections",
+            "comma-separated list of top-level report sections to leave out, "
+            "e.g. libuv,sharedObjects",
+            &EnvironmentOptions::report_exclude_sections,
+            kAllowedInEnvvar);
 }
 
 PerIsolateOptionsParser::PerIsolateOptionsParser(
@@ -1048,12 +1157,27 @@ PerProcessOptionsParser::PerProcessOptionsParser(
             "data, it supports ${rotation} and ${pid}.",
             &PerProcessOptions::trace_event_file_pattern,
             kAllowedInEnvvar);
+  AddOption("--trace-event-format",
+            "format of the trace-events data, either 'json' (default) or "
+            "'perfetto' for Perfetto protobuf packets",
+            &PerProcessOptions::trace_event_format,
+            kAllowedInEnvvar);
+  AddOption("--trace-event-compression",
+            "compression of the trace-events data, either 'none' (default) "
+            "or 'zstd'",
+            &PerProcessOptions::trace_event_compression,
+            kAllowedInEnvvar);
   AddAlias("--trace-events-enabled", {
     "--trace-event-categories", "v8,node,node.async_hooks" });
   AddOption("--v8-pool-size",
             "set V8's thread pool size",
             &PerProcessOptions::v8_thread_pool_size,
             kAllowedInEnvvar);
+  AddOption("--v8-pool-numa-node",
+            "run V8's thread pool on the CPUs of this NUMA node and prefer "
+            "its memory",
+            &PerProcessOptions::v8_thread_pool_numa_node,
+            kAllowedInEnvvar);
   AddOption("--zero-fill-buffers",
             "automatically zero-fill all newly allocated Buffer instances",
             &PerProcessOptions::zero_fill_all_buffers,
@@ -1062,6 +1186,30 @@ PerProcessOptionsParser::PerProcessOptionsParser(
             "", /* undocumented, only for debugging */
             &PerProcessOptions::debug_arraybuffer_allocations,
             kAllowedInEnvvar);
+  AddOption("--array-buffer-pool-size",
+            "maximum size in MiB of freed ArrayBuffer memory kept for reuse",
+            &PerProcessOptions::array_buffer_pool_size,
+            kAllowedInEnvvar);
+  AddOption("--array-buffer-huge-pages",
+            "back large ArrayBuffer allocations with transparent huge pages "
+            "where supported",
+            &PerProcessOptions::array_buffer_huge_pages,
+            kAllowedInEnvvar);
+  AddOption("--dns-cache-max-ttl",
+            "cache dns.Resolver answers for their record TTL but at most "
+            "this many seconds (0 disables the cache, default: the c-ares "
+            "default of 3600)",
+            &PerProcessOptions::dns_cache_max_ttl,
+            kAllowedInEnvvar);
+  AddOption("--dns-lookup-cache-ttl",
+            "cache dns.lookup() results for this many milliseconds",
+            &PerProcessOptions::dns_lookup_cache_ttl,
+            kAllowedInEnvvar);
+  AddOption("--dns-lookup-cache-stale-ttl",
+            "keep serving expired dns.lookup() results for this many "
+            "milliseconds while they are refreshed in the background",
+            &PerProcessOptions::dns_lookup_cache_stale_ttl,
+            kAllowedInEnvvar);
   AddOption("--disable-proto",
             "disable Object.prototype.__proto__",
             &PerProcessOptions::disable_proto,
@@ -1076,6 +1224,27 @@ PerProcessOptionsParser::PerProcessOptionsParser(
             "state",
             &PerProcessOptions::snapshot_blob,
             kAllowedInEnvvar);
+  AddOption("--prefetch-builtins",
+            "Path to a file listing the ids of built-in modules, one per "
+            "line, whose source and code cache are paged in on a worker "
+            "thread at startup",
+            &PerProcessOptions::prefetch_builtins,
+            kAllowedInEnvvar);
+  AddOption("--startup-profile",
+            "Write the builtins, bindings and CommonJS modules loaded during "
+            "this run, with the startup milestones, to a JSON file at exit",
+            &PerProcessOptions::startup_profile,
+            kAllowedInEnvvar);
+  AddOption("--startup-profile-use",
+            "Warm up the builtins and modules recorded by --startup-profile "
+            "on worker threads at startup",
+            &PerProcessOptions::startup_profile_use,
+            kAllowedInEnvvar);
+  AddOption("--snapshot-entry",
+            "Name of the entry function registered in the snapshot blob "
+            "to run after the application state is restored",
+            &PerProcessOptions::snapshot_entry,
+            kAllowedInEnvvar);
 
   // 12.x renamed this inadvertently, so alias it for consistency within the
   // release line, while using the original name for consistency with older
@@ -1124,6 +1293,11 @@ PerProcessOptionsParser::PerProcessOptionsParser(
             ,
             &PerProcessOptions::icu_data_dir,
             kAllowedInEnvvar);
+  AddOption("--icu-data-prefetch",
+            "read the ICU data file from the ICU data load path ahead at "
+            "startup instead of paging it in on first use",
+            &PerProcessOptions::icu_data_prefetch,
+            kAllowedInEnvvar);
 #endif
 
 #if HAVE_OPENSSL
@@ -1199,6 +1373,11 @@ PerProcessOptionsParser::PerProcessOptionsParser(
             "or 'silent' (map and silently ignore failure)",
             &PerProcessOptions::use_largepages,
             kAllowedInEnvvar);
+  AddOption("--auto-tune",
+            "size the heap and the thread pools for the limits of the "
+            "process's cgroup, either 'none' (default) or 'container'",
+            &PerProcessOptions::auto_tune,
+            kAllowedInEnvvar);
 
   AddOption("--trace-sigint",
             "enable printing JavaScript stacktrace on SIGINT",
@@ -1220,8 +1399,17 @@ PerProcessOptionsParser::PerProcessOptionsParser(
             &PerProcessOptions::experimental_sea_config);
 
   AddOption("--run",
-            "Run a script specified in package.json",
+            "Run a script specified in package.json; may be repeated to run "
+            "several scripts in sequence",
             &PerProcessOptions::run);
+  AddOption("--run-parallel",
+            "run the scripts passed to --run in parallel, prefixing each "
+            "line of their output with the script name",
+            &PerProcessOptions::run_parallel);
+  AddOption("--run-concurrency",
+            "maximum number of scripts run at once with --run-parallel "
+            "(default: no limit)",
+            &PerProcessOptions::run_concurrency);
   AddOption(
       "--disable-wasm-trap-handler",
       "Disable trap-handler-based WebAssembly bound checks. V8 will insert "
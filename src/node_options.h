@@ -81,6 +81,8 @@ class DebugOptions : public Options {
   bool break_node_first_line = false;
   // --inspect-publish-uid
   std::string inspect_publish_uid_string = "stderr,http";
+  // --experimental-worker-inspector-io
+  bool worker_inspector_io = false;
 
   InspectPublishUid inspect_publish_uid;
 
@@ -172,6 +174,9 @@ class EnvironmentOptions : public Options {
   uint64_t cpu_prof_interval = kDefaultCpuProfInterval;
   std::string cpu_prof_name;
   bool cpu_prof = false;
+  bool cpu_prof_continuous = false;
+  static const uint64_t kDefaultCpuProfWindow = 60000;
+  uint64_t cpu_prof_window = kDefaultCpuProfWindow;
   bool experimental_network_inspection = false;
   bool experimental_worker_inspection = false;
   std::string heap_prof_dir;
@@ -179,6 +184,9 @@ class EnvironmentOptions : public Options {
   static const uint64_t kDefaultHeapProfInterval = 512 * 1024;
   uint64_t heap_prof_interval = kDefaultHeapProfInterval;
   bool heap_prof = false;
+  bool heap_prof_continuous = false;
+  static const uint64_t kDefaultHeapProfWindow = 60000;
+  uint64_t heap_prof_window = kDefaultHeapProfWindow;
 #endif  // HAVE_INSPECTOR
   std::string redirect_warnings;
   std::string diagnostic_dir;
@@ -248,6 +256,7 @@ class EnvironmentOptions : public Options {
   bool tls_max_v1_2 = false;
   bool tls_max_v1_3 = false;
   std::string tls_keylog;
+  uint64_t tls_handshakes_per_iteration = 0;
 
   std::vector<std::string> preload_cjs_modules;
 
@@ -260,6 +269,7 @@ class EnvironmentOptions : public Options {
 
   bool report_exclude_env = false;
   bool report_exclude_network = false;
+  std::string report_exclude_sections;
   std::string experimental_config_file_path;
   bool experimental_default_config_file = false;
 
@@ -312,15 +322,29 @@ class PerProcessOptions : public Options {
   std::string title;
   std::string trace_event_categories;
   std::string trace_event_file_pattern = "node_trace.${rotation}.log";
-  int64_t v8_thread_pool_size = 4;
+  std::string trace_event_format = "json";
+  std::string trace_event_compression = "none";
+  // -1 for the default of 4, which --auto-tune can change.
+  int64_t v8_thread_pool_size = -1;
+  int64_t v8_thread_pool_numa_node = -1;
   bool zero_fill_all_buffers = false;
   bool debug_arraybuffer_allocations = false;
+  int64_t array_buffer_pool_size = 0;
+  bool array_buffer_huge_pages = false;
+  // -1 keeps the default query cache of c-ares.
+  int64_t dns_cache_max_ttl = -1;
+  int64_t dns_lookup_cache_ttl = 0;
+  int64_t dns_lookup_cache_stale_ttl = 0;
   std::string disable_proto;
   // We enable the shared read-only heap which currently requires that the
   // snapshot used in different isolates in the same process to be the same.
   // Therefore --node-snapshot is a per-process option.
   bool node_snapshot = true;
   std::string snapshot_blob;
+  std::string snapshot_entry;
+  std::string prefetch_builtins;
+  std::string startup_profile;
+  std::string startup_profile_use;
 
   std::vector<std::string> security_reverts;
   bool print_bash_completion = false;
@@ -328,10 +352,13 @@ class PerProcessOptions : public Options {
   bool print_v8_help = false;
   bool print_version = false;
   std::string experimental_sea_config;
-  std::string run;
+  std::vector<std::string> run;
+  bool run_parallel = false;
+  int64_t run_concurrency = 0;
 
 #ifdef NODE_HAVE_I18N_SUPPORT
   std::string icu_data_dir;
+  bool icu_data_prefetch = false;
 #endif
 
   // Per-process because they affect singleton OpenSSL shared library state,
@@ -367,6 +394,7 @@ class PerProcessOptions : public Options {
 
   // TODO(addaleax): Some of these could probably be per-Environment.
   std::string use_largepages = "off";
+  std::string auto_tune = "none";
   bool trace_sigint = false;
   std::vector<std::string> cmdline;
 
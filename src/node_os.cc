@@ -22,6 +22,7 @@
 #include "env-inl.h"
 #include "node_debug.h"
 #include "node_external_reference.h"
+#include "node_numa.h"
 #include "string_bytes.h"
 
 #ifdef __MINGW32__
@@ -421,6 +422,23 @@ uint32_t FastGetAvailableParallelism(v8::Local<v8::Value> receiver) {
 static v8::CFunction fast_get_available_parallelism(
     v8::CFunction::Make(FastGetAvailableParallelism));
 
+static void GetNumaTopology(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = args.GetIsolate();
+  std::vector<numa::Node> nodes = numa::GetTopology();
+
+  // The array is in the format [id, [cpu, ...], id2, [cpu, ...], ...].
+  LocalVector<Value> result(isolate);
+  result.reserve(nodes.size() * 2);
+  for (const numa::Node& node : nodes) {
+    LocalVector<Value> cpus(isolate);
+    cpus.reserve(node.cpus.size());
+    for (int cpu : node.cpus) cpus.emplace_back(Integer::New(isolate, cpu));
+    result.emplace_back(Integer::New(isolate, node.id));
+    result.emplace_back(Array::New(isolate, cpus.data(), cpus.size()));
+  }
+  args.GetReturnValue().Set(Array::New(isolate, result.data(), result.size()));
+}
+
 void Initialize(Local<Object> target,
                 Local<Value> unused,
                 Local<Context> context,
@@ -445,6 +463,7 @@ void Initialize(Local<Object> target,
                             GetAvailableParallelism,
                             &fast_get_available_parallelism);
   SetMethod(context, target, "getOSInformation", GetOSInformation);
+  SetMethodNoSideEffect(context, target, "getNumaTopology", GetNumaTopology);
   target
       ->Set(context,
             FIXED_ONE_BYTE_STRING(env->isolate(), "isBigEndian"),
@@ -472,6 +491,7 @@ void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(FastGetAvailableParallelism);
   registry->Register(fast_get_available_parallelism.GetTypeInfo());
   registry->Register(GetOSInformation);
+  registry->Register(GetNumaTopology);
 }
 
 }  // namespace os
@@ -4,12 +4,14 @@
 #include "histogram-inl.h"
 #include "memory_tracker-inl.h"
 #include "node_buffer.h"
+#include "node_errors.h"
 #include "node_external_reference.h"
 #include "node_internals.h"
 #include "node_process-inl.h"
 #include "util-inl.h"
 
 #include <cinttypes>
+#include <optional>
 
 namespace node {
 namespace performance {
@@ -21,14 +23,17 @@ using v8::Function;
 using v8::FunctionCallbackInfo;
 using v8::GCCallbackFlags;
 using v8::GCType;
+using v8::HeapSpaceStatistics;
 using v8::Integer;
 using v8::Isolate;
 using v8::Local;
+using v8::LocalVector;
 using v8::MaybeLocal;
 using v8::Object;
 using v8::ObjectTemplate;
 using v8::PropertyAttribute;
 using v8::ReadOnly;
+using v8::Uint32;
 using v8::Value;
 
 // Microseconds in a millisecond, as a float.
@@ -57,7 +62,15 @@ PerformanceState::PerformanceState(Isolate* isolate,
                 offsetof(performance_state_internal, observers),
                 NODE_PERFORMANCE_ENTRY_TYPE_INVALID,
                 root,
-                MAYBE_FIELD_PTR(info, observers)) {
+                MAYBE_FIELD_PTR(info, observers)),
+      gc_stats(isolate,
+               static_cast<size_t>(NODE_PERFORMANCE_GC_STATS_KIND_COUNT) *
+                   NODE_PERFORMANCE_GC_STATS_FIELD_COUNT,
+               MAYBE_FIELD_PTR(info, gc_stats)),
+      heap_space_stats(isolate,
+                       isolate->NumberOfHeapSpaces() *
+                           NODE_PERFORMANCE_HEAP_SPACE_FIELD_COUNT,
+                       MAYBE_FIELD_PTR(info, heap_space_stats)) {
   if (info == nullptr) {
     // For performance states initialized from scratch, reset
     // all the milestones and initialize the time origin.
@@ -83,7 +96,9 @@ PerformanceState::SerializeInfo PerformanceState::Serialize(
 
   SerializeInfo info{root.Serialize(context, creator),
                      milestones.Serialize(context, creator),
-                     observers.Serialize(context, creator)};
+                     observers.Serialize(context, creator),
+                     gc_stats.Serialize(context, creator),
+                     heap_space_stats.Serialize(context, creator)};
   return info;
 }
 
@@ -105,6 +120,8 @@ void PerformanceState::Deserialize(v8::Local<v8::Context> context,
   root.Deserialize(context);
   milestones.Deserialize(context);
   observers.Deserialize(context);
+  gc_stats.Deserialize(context);
+  heap_space_stats.Deserialize(context);
 
   // Re-initialize the time origin and timestamp i.e. the process start time.
   Initialize(time_origin, time_origin_timestamp);
@@ -116,6 +133,8 @@ std::ostream& operator<<(std::ostream& o,
     << "  " << i.root << ",  // root\n"
     << "  " << i.milestones << ",  // milestones\n"
     << "  " << i.observers << ",  // observers\n"
+    << "  " << i.gc_stats << ",  // gc_stats\n"
+    << "  " << i.heap_space_stats << ",  // heap_space_stats\n"
     << "}";
   return o;
 }
@@ -242,6 +261,119 @@ static void RemoveGarbageCollectionTracking(
   GarbageCollectionCleanupHook(env);
 }
 
+static PerformanceGCStatsKind GetGCStatsKind(GCType type) {
+  switch (type) {
+    case GCType::kGCTypeScavenge:
+    case GCType::kGCTypeMinorMarkSweep:
+      return NODE_PERFORMANCE_GC_STATS_MINOR;
+    case GCType::kGCTypeMarkSweepCompact:
+      return NODE_PERFORMANCE_GC_STATS_MAJOR;
+    case GCType::kGCTypeIncrementalMarking:
+      return NODE_PERFORMANCE_GC_STATS_INCREMENTAL;
+    default:
+      return NODE_PERFORMANCE_GC_STATS_WEAKCB;
+  }
+}
+
+static void MarkGCStatsStart(Isolate* isolate,
+                             GCType type,
+                             GCCallbackFlags flags,
+                             void* data) {
+  Environment* env = static_cast<Environment*>(data);
+  PerformanceState* state = env->performance_state();
+  // Like MarkGarbageCollectionStart(), ignore nested GC callbacks.
+  if (state->gc_stats_gc_type != 0) return;
+  state->gc_stats_start_mark = PERFORMANCE_NOW();
+  state->gc_stats_gc_type = type;
+}
+
+// Updates the cumulative counters of the GC that just ended and takes a
+// fresh sample of the heap space statistics. Nothing here allocates on the
+// JS heap.
+static void MarkGCStatsEnd(Isolate* isolate,
+                           GCType type,
+                           GCCallbackFlags flags,
+                           void* data) {
+  Environment* env = static_cast<Environment*>(data);
+  PerformanceState* state = env->performance_state();
+  if (type != state->gc_stats_gc_type) return;
+  state->gc_stats_gc_type = 0;
+
+  uint64_t duration_ns = PERFORMANCE_NOW() - state->gc_stats_start_mark;
+  double duration_ms = duration_ns / NANOS_PER_MILLIS;
+  PerformanceGCStatsKind kind = GetGCStatsKind(type);
+  size_t base =
+      static_cast<size_t>(kind) * NODE_PERFORMANCE_GC_STATS_FIELD_COUNT;
+  AliasedFloat64Array& stats = state->gc_stats;
+  stats[base + NODE_PERFORMANCE_GC_STATS_COUNT] += 1;
+  stats[base + NODE_PERFORMANCE_GC_STATS_TOTAL_DURATION] += duration_ms;
+  if (duration_ms > stats[base + NODE_PERFORMANCE_GC_STATS_MAX_DURATION])
+    stats[base + NODE_PERFORMANCE_GC_STATS_MAX_DURATION] = duration_ms;
+  if (const std::shared_ptr<Histogram>& histogram =
+          state->gc_pause_histograms[kind]) {
+    histogram->Record(std::max<int64_t>(duration_ns, 1));
+  }
+
+  HeapSpaceStatistics space;
+  size_t spaces = state->heap_space_stats.Length() /
+                  NODE_PERFORMANCE_HEAP_SPACE_FIELD_COUNT;
+  for (size_t i = 0; i < spaces; i++) {
+    if (!isolate->GetHeapSpaceStatistics(&space, i)) continue;
+    size_t offset = i * NODE_PERFORMANCE_HEAP_SPACE_FIELD_COUNT;
+    AliasedFloat64Array& fields = state->heap_space_stats;
+    fields[offset + NODE_PERFORMANCE_HEAP_SPACE_SIZE] = space.space_size();
+    fields[offset + NODE_PERFORMANCE_HEAP_SPACE_USED_SIZE] =
+        space.space_used_size();
+    fields[offset + NODE_PERFORMANCE_HEAP_SPACE_AVAILABLE_SIZE] =
+        space.space_available_size();
+    fields[offset + NODE_PERFORMANCE_HEAP_SPACE_PHYSICAL_SIZE] =
+        space.physical_space_size();
+  }
+}
+
+static void GCStatsCleanupHook(void* data) {
+  Environment* env = static_cast<Environment*>(data);
+  PerformanceState* state = env->performance_state();
+  state->gc_stats_gc_type = 0;
+  state->gc_pause_histograms = {};
+  env->isolate()->RemoveGCPrologueCallback(MarkGCStatsStart, data);
+  env->isolate()->RemoveGCEpilogueCallback(MarkGCStatsEnd, data);
+}
+
+// Starts maintaining the gcStats and heapSpaceStats arrays and returns the
+// pause histograms as an array indexed by NODE_PERFORMANCE_GC_STATS_*.
+static void InstallGCStatsTracking(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  PerformanceState* state = env->performance_state();
+  if (!state->gc_pause_histograms[0]) {
+    for (std::shared_ptr<Histogram>& histogram : state->gc_pause_histograms)
+      histogram = std::make_shared<Histogram>(Histogram::Options{});
+    state->gc_stats_gc_type = 0;
+    env->isolate()->AddGCPrologueCallback(MarkGCStatsStart,
+                                          static_cast<void*>(env));
+    env->isolate()->AddGCEpilogueCallback(MarkGCStatsEnd,
+                                          static_cast<void*>(env));
+    env->AddCleanupHook(GCStatsCleanupHook, env);
+  }
+
+  Local<Value> data[NODE_PERFORMANCE_GC_STATS_KIND_COUNT];
+  for (size_t i = 0; i < arraysize(data); i++) {
+    BaseObjectPtr<HistogramBase> histogram =
+        HistogramBase::Create(env, state->gc_pause_histograms[i]);
+    if (!histogram) return;
+    data[i] = histogram->object();
+  }
+  args.GetReturnValue().Set(
+      Array::New(env->isolate(), data, arraysize(data)));
+}
+
+static void RemoveGCStatsTracking(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  if (!env->performance_state()->gc_pause_histograms[0]) return;
+  env->RemoveCleanupHook(GCStatsCleanupHook, env);
+  GCStatsCleanupHook(env);
+}
+
 // Notify a custom PerformanceEntry to observers
 void Notify(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
@@ -299,6 +431,87 @@ void CreateELDHistogram(const FunctionCallbackInfo<Value>& args) {
   args.GetReturnValue().Set(histogram->object());
 }
 
+// Starts recording the queue and run time histograms for the given kind of
+// threadpool work and returns them as [queueTime, runTime].
+void CreateThreadPoolWorkHistograms(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsString());
+  Utf8Value name(env->isolate(), args[0]);
+  std::optional<ThreadPoolWorkKind> kind =
+      ParseThreadPoolWorkKind(name.ToStringView());
+  if (!kind.has_value()) {
+    return THROW_ERR_INVALID_ARG_VALUE(
+        env, "Unknown threadpool work kind: %s", *name);
+  }
+
+  const ThreadPoolWorkQueue::Histograms& histograms =
+      env->thread_pool_work_queue()->EnableHistograms(*kind);
+  BaseObjectPtr<HistogramBase> queue_time =
+      HistogramBase::Create(env, histograms.queue_time);
+  BaseObjectPtr<HistogramBase> run_time =
+      HistogramBase::Create(env, histograms.run_time);
+  if (!queue_time || !run_time) return;
+
+  Local<Value> data[] = {queue_time->object(), run_time->object()};
+  args.GetReturnValue().Set(
+      Array::New(env->isolate(), data, arraysize(data)));
+}
+
+void RemoveThreadPoolWorkHistograms(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsString());
+  Utf8Value name(env->isolate(), args[0]);
+  std::optional<ThreadPoolWorkKind> kind =
+      ParseThreadPoolWorkKind(name.ToStringView());
+  if (kind.has_value())
+    env->thread_pool_work_queue()->DisableHistograms(*kind);
+}
+
+// Starts recording the event loop phase histograms and returns them as
+// [timers, poll, check, other].
+void CreateEventLoopPhaseHistograms(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  const EventLoopMetrics::PhaseHistograms& histograms =
+      env->event_loop_metrics()->EnablePhaseHistograms();
+  Local<Value> data[EventLoopMetrics::kPhaseCount];
+  for (size_t i = 0; i < histograms.size(); i++) {
+    BaseObjectPtr<HistogramBase> histogram =
+        HistogramBase::Create(env, histograms[i]);
+    if (!histogram) return;
+    data[i] = histogram->object();
+  }
+  args.GetReturnValue().Set(
+      Array::New(env->isolate(), data, arraysize(data)));
+}
+
+void RemoveEventLoopPhaseHistograms(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  env->event_loop_metrics()->DisablePhaseHistograms();
+}
+
+// Starts recording the duration of the callbacks made by the given
+// async_wrap provider type and returns the histogram.
+void CreateCallbackHistogram(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsUint32());
+  uint32_t provider = args[0].As<Uint32>()->Value();
+  CHECK_LT(provider, AsyncWrap::PROVIDERS_LENGTH);
+  BaseObjectPtr<HistogramBase> histogram = HistogramBase::Create(
+      env,
+      env->event_loop_metrics()->EnableCallbackHistogram(
+          static_cast<AsyncWrap::ProviderType>(provider)));
+  if (histogram) args.GetReturnValue().Set(histogram->object());
+}
+
+void RemoveCallbackHistogram(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsUint32());
+  uint32_t provider = args[0].As<Uint32>()->Value();
+  CHECK_LT(provider, AsyncWrap::PROVIDERS_LENGTH);
+  env->event_loop_metrics()->DisableCallbackHistogram(
+      static_cast<AsyncWrap::ProviderType>(provider));
+}
+
 void MarkBootstrapComplete(const FunctionCallbackInfo<Value>& args) {
   Realm* realm = Realm::GetCurrent(args);
   CHECK_EQ(realm->kind(), Realm::Kind::kPrincipal);
@@ -337,9 +550,32 @@ static void CreatePerIsolateProperties(IsolateData* isolate_data,
             target,
             "removeGarbageCollectionTracking",
             RemoveGarbageCollectionTracking);
+  SetMethod(
+      isolate, target, "installGCStatsTracking", InstallGCStatsTracking);
+  SetMethod(isolate, target, "removeGCStatsTracking", RemoveGCStatsTracking);
   SetMethod(isolate, target, "notify", Notify);
   SetMethod(isolate, target, "loopIdleTime", LoopIdleTime);
   SetMethod(isolate, target, "createELDHistogram", CreateELDHistogram);
+  SetMethod(isolate,
+            target,
+            "createThreadPoolWorkHistograms",
+            CreateThreadPoolWorkHistograms);
+  SetMethod(isolate,
+            target,
+            "removeThreadPoolWorkHistograms",
+            RemoveThreadPoolWorkHistograms);
+  SetMethod(isolate,
+            target,
+            "createEventLoopPhaseHistograms",
+            CreateEventLoopPhaseHistograms);
+  SetMethod(isolate,
+            target,
+            "removeEventLoopPhaseHistograms",
+            RemoveEventLoopPhaseHistograms);
+  SetMethod(
+      isolate, target, "createCallbackHistogram", CreateCallbackHistogram);
+  SetMethod(
+      isolate, target, "removeCallbackHistogram", RemoveCallbackHistogram);
   SetMethod(isolate, target, "markBootstrapComplete", MarkBootstrapComplete);
   SetMethod(isolate, target, "uvMetricsInfo", UvMetricsInfo);
   SetFastMethodNoSideEffect(
@@ -360,6 +596,24 @@ void CreatePerContextProperties(Local<Object> target,
   target->Set(context,
               FIXED_ONE_BYTE_STRING(isolate, "milestones"),
               state->milestones.GetJSArray()).Check();
+  target->Set(context,
+              FIXED_ONE_BYTE_STRING(isolate, "gcStats"),
+              state->gc_stats.GetJSArray()).Check();
+  target->Set(context,
+              FIXED_ONE_BYTE_STRING(isolate, "heapSpaceStats"),
+              state->heap_space_stats.GetJSArray()).Check();
+
+  // The names of the heap spaces in the order of heapSpaceStats.
+  LocalVector<Value> space_names(isolate);
+  HeapSpaceStatistics space;
+  for (size_t i = 0; i < isolate->NumberOfHeapSpaces(); i++) {
+    isolate->GetHeapSpaceStatistics(&space, i);
+    space_names.push_back(OneByteString(isolate, space.space_name()));
+  }
+  target->Set(context,
+              FIXED_ONE_BYTE_STRING(isolate, "heapSpaceNames"),
+              Array::New(isolate, space_names.data(), space_names.size()))
+      .Check();
 
   Local<Object> constants = Object::New(isolate);
 
@@ -383,6 +637,28 @@ void CreatePerContextProperties(Local<Object> target,
   NODE_DEFINE_CONSTANT(
     constants, NODE_PERFORMANCE_GC_FLAGS_SCHEDULE_IDLE);
 
+  NODE_DEFINE_HIDDEN_CONSTANT(constants, NODE_PERFORMANCE_GC_STATS_MINOR);
+  NODE_DEFINE_HIDDEN_CONSTANT(constants, NODE_PERFORMANCE_GC_STATS_MAJOR);
+  NODE_DEFINE_HIDDEN_CONSTANT(constants,
+                              NODE_PERFORMANCE_GC_STATS_INCREMENTAL);
+  NODE_DEFINE_HIDDEN_CONSTANT(constants, NODE_PERFORMANCE_GC_STATS_WEAKCB);
+  NODE_DEFINE_HIDDEN_CONSTANT(constants, NODE_PERFORMANCE_GC_STATS_COUNT);
+  NODE_DEFINE_HIDDEN_CONSTANT(constants,
+                              NODE_PERFORMANCE_GC_STATS_TOTAL_DURATION);
+  NODE_DEFINE_HIDDEN_CONSTANT(constants,
+                              NODE_PERFORMANCE_GC_STATS_MAX_DURATION);
+  NODE_DEFINE_HIDDEN_CONSTANT(constants,
+                              NODE_PERFORMANCE_GC_STATS_FIELD_COUNT);
+  NODE_DEFINE_HIDDEN_CONSTANT(constants, NODE_PERFORMANCE_HEAP_SPACE_SIZE);
+  NODE_DEFINE_HIDDEN_CONSTANT(constants,
+                              NODE_PERFORMANCE_HEAP_SPACE_USED_SIZE);
+  NODE_DEFINE_HIDDEN_CONSTANT(constants,
+                              NODE_PERFORMANCE_HEAP_SPACE_AVAILABLE_SIZE);
+  NODE_DEFINE_HIDDEN_CONSTANT(constants,
+                              NODE_PERFORMANCE_HEAP_SPACE_PHYSICAL_SIZE);
+  NODE_DEFINE_HIDDEN_CONSTANT(constants,
+                              NODE_PERFORMANCE_HEAP_SPACE_FIELD_COUNT);
+
 #define V(name, _)                                                            \
   NODE_DEFINE_HIDDEN_CONSTANT(constants, NODE_PERFORMANCE_ENTRY_TYPE_##name);
   NODE_PERFORMANCE_ENTRY_TYPES(V)
@@ -404,9 +680,17 @@ void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(SetupPerformanceObservers);
   registry->Register(InstallGarbageCollectionTracking);
   registry->Register(RemoveGarbageCollectionTracking);
+  registry->Register(InstallGCStatsTracking);
+  registry->Register(RemoveGCStatsTracking);
   registry->Register(Notify);
   registry->Register(LoopIdleTime);
   registry->Register(CreateELDHistogram);
+  registry->Register(CreateThreadPoolWorkHistograms);
+  registry->Register(RemoveThreadPoolWorkHistograms);
+  registry->Register(CreateEventLoopPhaseHistograms);
+  registry->Register(RemoveEventLoopPhaseHistograms);
+  registry->Register(CreateCallbackHistogram);
+  registry->Register(RemoveCallbackHistogram);
   registry->Register(MarkBootstrapComplete);
   registry->Register(UvMetricsInfo);
   registry->Register(SlowPerformanceNow);
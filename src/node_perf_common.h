@@ -9,11 +9,16 @@
 #include "v8.h"
 
 #include <algorithm>
+#include <array>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <string>
 
 namespace node {
+
+class Histogram;
+
 namespace performance {
 
 #define PERFORMANCE_NOW() uv_hrtime()
@@ -55,12 +60,41 @@ enum PerformanceEntryType {
   NODE_PERFORMANCE_ENTRY_TYPE_INVALID
 };
 
+// Layout of PerformanceState::gc_stats: NODE_PERFORMANCE_GC_STATS_FIELD_COUNT
+// fields for every kind of GC, durations are in milliseconds.
+enum PerformanceGCStatsKind {
+  NODE_PERFORMANCE_GC_STATS_MINOR,
+  NODE_PERFORMANCE_GC_STATS_MAJOR,
+  NODE_PERFORMANCE_GC_STATS_INCREMENTAL,
+  NODE_PERFORMANCE_GC_STATS_WEAKCB,
+  NODE_PERFORMANCE_GC_STATS_KIND_COUNT
+};
+
+enum PerformanceGCStatsField {
+  NODE_PERFORMANCE_GC_STATS_COUNT,
+  NODE_PERFORMANCE_GC_STATS_TOTAL_DURATION,
+  NODE_PERFORMANCE_GC_STATS_MAX_DURATION,
+  NODE_PERFORMANCE_GC_STATS_FIELD_COUNT
+};
+
+// Layout of PerformanceState::heap_space_stats: these fields for every heap
+// space, in the order of v8::Isolate::GetHeapSpaceStatistics().
+enum PerformanceHeapSpaceStatsField {
+  NODE_PERFORMANCE_HEAP_SPACE_SIZE,
+  NODE_PERFORMANCE_HEAP_SPACE_USED_SIZE,
+  NODE_PERFORMANCE_HEAP_SPACE_AVAILABLE_SIZE,
+  NODE_PERFORMANCE_HEAP_SPACE_PHYSICAL_SIZE,
+  NODE_PERFORMANCE_HEAP_SPACE_FIELD_COUNT
+};
+
 class PerformanceState {
  public:
   struct SerializeInfo {
     AliasedBufferIndex root;
     AliasedBufferIndex milestones;
     AliasedBufferIndex observers;
+    AliasedBufferIndex gc_stats;
+    AliasedBufferIndex heap_space_stats;
   };
 
   explicit PerformanceState(v8::Isolate* isolate,
@@ -78,8 +112,19 @@ class PerformanceState {
   AliasedFloat64Array milestones;
   AliasedUint32Array observers;
 
+  // Updated from the GC epilogue while GC statistics tracking is installed,
+  // so that JS can poll them without allocating.
+  AliasedFloat64Array gc_stats;
+  AliasedFloat64Array heap_space_stats;
+  // Nanosecond pause histograms per PerformanceGCStatsKind, recorded into
+  // while GC statistics tracking is installed.
+  std::array<std::shared_ptr<Histogram>, NODE_PERFORMANCE_GC_STATS_KIND_COUNT>
+      gc_pause_histograms;
+
   uint64_t performance_last_gc_start_mark = 0;
   uint16_t current_gc_type = 0;
+  uint64_t gc_stats_start_mark = 0;
+  uint16_t gc_stats_gc_type = 0;
 
   void Mark(enum PerformanceMilestone milestone,
             uint64_t ts = PERFORMANCE_NOW());
@@ -18,7 +18,7 @@ using v8::TaskPriority;
 namespace {
 
 struct PlatformWorkerData {
-  TaskQueue<TaskQueueEntry>* task_queue;
+  WorkerThreadsTaskRunner* runner;
   Mutex* platform_workers_mutex;
   ConditionVariable* platform_workers_ready;
   int* pending_platform_workers;
@@ -48,42 +48,13 @@ static void PrintSourceLocation(const v8::SourceLocation& location) {
   }
 }
 
-static void PlatformWorkerThread(void* data) {
-  uv_thread_setname("V8Worker");
-  std::unique_ptr<PlatformWorkerData>
-      worker_data(static_cast<PlatformWorkerData*>(data));
-
-  TaskQueue<TaskQueueEntry>* pending_worker_tasks = worker_data->task_queue;
-  TRACE_EVENT_METADATA1("__metadata", "thread_name", "name",
-                        "PlatformWorkerThread");
+// The platform worker that the current thread runs, if any.
+struct CurrentPlatformWorker {
+  const WorkerThreadsTaskRunner* runner = nullptr;
+  int id = -1;
+};
 
-  // Notify the main thread that the platform worker is ready.
-  {
-    Mutex::ScopedLock lock(*worker_data->platform_workers_mutex);
-    (*worker_data->pending_platform_workers)--;
-    worker_data->platform_workers_ready->Signal(lock);
-  }
-
-  bool debug_log_enabled =
-      worker_data->debug_log_level != PlatformDebugLogLevel::kNone;
-  int id = worker_data->id;
-  while (std::unique_ptr<TaskQueueEntry> entry =
-             pending_worker_tasks->Lock().BlockingPop()) {
-    if (debug_log_enabled) {
-      fprintf(stderr,
-              "\nPlatformWorkerThread %d running task %p %s\n",
-              id,
-              entry->task.get(),
-              GetTaskPriorityName(entry->priority));
-      fflush(stderr);
-    }
-    entry->task->Run();
-    // See NodePlatform::DrainTasks().
-    if (entry->is_outstanding()) {
-      pending_worker_tasks->Lock().NotifyOfOutstandingCompletion();
-    }
-  }
-}
+thread_local CurrentPlatformWorker current_platform_worker;
 
 static int GetActualThreadPoolSize(int thread_pool_size) {
   if (thread_pool_size < 1) {
@@ -94,10 +65,57 @@ static int GetActualThreadPoolSize(int thread_pool_size) {
 
 }  // namespace
 
+// The queue of a single platform worker. Only its owner blocks on the lock,
+// other workers steal with TryLock() so that a busy owner is never held up
+// by a thief.
+class WorkerThreadsTaskRunner::WorkerQueue {
+ public:
+  void Push(std::unique_ptr<TaskQueueEntry> entry) {
+    Mutex::ScopedLock lock(mutex_);
+    tasks_.push(std::move(entry));
+    size_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // Pops the task with the highest priority if it is at least
+  // |min_priority|.
+  std::unique_ptr<TaskQueueEntry> Pop(TaskPriority min_priority) {
+    if (empty()) return nullptr;
+    Mutex::ScopedLock lock(mutex_);
+    return PopLocked(min_priority);
+  }
+
+  std::unique_ptr<TaskQueueEntry> TrySteal(TaskPriority min_priority) {
+    if (empty() || !mutex_.TryLock()) return nullptr;
+    std::unique_ptr<TaskQueueEntry> result = PopLocked(min_priority);
+    mutex_.Unlock();
+    return result;
+  }
+
+  bool empty() const { return size_.load(std::memory_order_relaxed) == 0; }
+
+ private:
+  std::unique_ptr<TaskQueueEntry> PopLocked(TaskPriority min_priority) {
+    if (tasks_.empty() || tasks_.top()->priority < min_priority) {
+      return nullptr;
+    }
+    // We have to use const_cast because std::priority_queue::top() does not
+    // return a movable item.
+    std::unique_ptr<TaskQueueEntry> result = std::move(
+        const_cast<std::unique_ptr<TaskQueueEntry>&>(tasks_.top()));
+    tasks_.pop();
+    size_.fetch_sub(1, std::memory_order_relaxed);
+    return result;
+  }
+
+  Mutex mutex_;
+  TaskQueue<TaskQueueEntry>::PriorityQueue tasks_;
+  std::atomic<size_t> size_{0};
+};
+
 class WorkerThreadsTaskRunner::DelayedTaskScheduler {
  public:
-  explicit DelayedTaskScheduler(TaskQueue<TaskQueueEntry>* tasks)
-      : pending_worker_tasks_(tasks) {}
+  explicit DelayedTaskScheduler(WorkerThreadsTaskRunner* runner)
+      : runner_(runner) {}
 
   std::unique_ptr<uv_thread_t> Start() {
     auto start_thread = [](void* data) {
@@ -143,6 +161,7 @@ class WorkerThreadsTaskRunner::DelayedTaskScheduler {
     CHECK_EQ(0, uv_loop_init(&loop_));
     flush_tasks_.data = this;
     CHECK_EQ(0, uv_async_init(&loop_, &flush_tasks_, FlushTasks));
+    CHECK_EQ(0, uv_timer_init(&loop_, &timer_));
     uv_sem_post(&ready_);
 
     uv_run(&loop_, UV_RUN_DEFAULT);
@@ -160,11 +179,13 @@ class WorkerThreadsTaskRunner::DelayedTaskScheduler {
       std::unique_ptr<Task> task =
           std::move(const_cast<std::unique_ptr<Task>&>(tasks_to_run.top()));
       tasks_to_run.pop();
-      // This runs either the ScheduleTasks that scheduels the timers to
-      // pop the tasks back into the worker task runner queue, or the
-      // or the StopTasks to stop the timers and drop all the pending tasks.
+      // This runs either the ScheduleTasks that insert the tasks into the
+      // timer heap, or the StopTasks to stop the timer and drop all the
+      // pending tasks.
       task->Run();
     }
+    if (!uv_is_closing(reinterpret_cast<uv_handle_t*>(&scheduler->timer_)))
+      scheduler->ArmTimer();
   }
 
   class StopTask : public Task {
@@ -172,11 +193,9 @@ class WorkerThreadsTaskRunner::DelayedTaskScheduler {
     explicit StopTask(DelayedTaskScheduler* scheduler): scheduler_(scheduler) {}
 
     void Run() override {
-      std::vector<uv_timer_t*> timers;
-      for (uv_timer_t* timer : scheduler_->timers_)
-        timers.push_back(timer);
-      for (uv_timer_t* timer : timers)
-        scheduler_->TakeTimerTask(timer);
+      scheduler_->delayed_tasks_ = DelayedTaskHeap();
+      uv_close(reinterpret_cast<uv_handle_t*>(&scheduler_->timer_),
+               [](uv_handle_t* handle) {});
       uv_close(reinterpret_cast<uv_handle_t*>(&scheduler_->flush_tasks_),
                [](uv_handle_t* handle) {});
     }
@@ -196,11 +215,10 @@ class WorkerThreadsTaskRunner::DelayedTaskScheduler {
 
     void Run() override {
       uint64_t delay_millis = llround(delay_in_seconds_ * 1000);
-      std::unique_ptr<uv_timer_t> timer(new uv_timer_t());
-      CHECK_EQ(0, uv_timer_init(&scheduler_->loop_, timer.get()));
-      timer->data = task_.release();
-      CHECK_EQ(0, uv_timer_start(timer.get(), RunTask, delay_millis, 0));
-      scheduler_->timers_.insert(timer.release());
+      scheduler_->delayed_tasks_.push(
+          DelayedTaskEntry{uv_now(&scheduler_->loop_) + delay_millis,
+                           scheduler_->next_sequence_++,
+                           std::move(task_)});
     }
 
    private:
@@ -209,37 +227,69 @@ class WorkerThreadsTaskRunner::DelayedTaskScheduler {
     double delay_in_seconds_;
   };
 
-  static void RunTask(uv_timer_t* timer) {
-    DelayedTaskScheduler* scheduler =
-        ContainerOf(&DelayedTaskScheduler::loop_, timer->loop);
-    auto entry = scheduler->TakeTimerTask(timer);
-    bool is_outstanding = entry->is_outstanding();
-    scheduler->pending_worker_tasks_->Lock().Push(std::move(entry),
-                                                  is_outstanding);
+  // A task waiting in the heap for its due time, in milliseconds of the
+  // loop's clock. Tasks that are due at the same time keep the order in
+  // which they were posted.
+  struct DelayedTaskEntry {
+    uint64_t due;
+    uint64_t sequence;
+    std::unique_ptr<TaskQueueEntry> task;
+  };
+
+  struct DelayedTaskCompare {
+    bool operator()(const DelayedTaskEntry& a,
+                    const DelayedTaskEntry& b) const {
+      return a.due > b.due || (a.due == b.due && a.sequence > b.sequence);
+    }
+  };
+
+  using DelayedTaskHeap = std::priority_queue<DelayedTaskEntry,
+                                              std::vector<DelayedTaskEntry>,
+                                              DelayedTaskCompare>;
+
+  // (Re-)starts the timer for the earliest task in the heap. A single timer
+  // serves all of the delayed tasks, instead of one handle per task.
+  void ArmTimer() {
+    if (delayed_tasks_.empty()) {
+      uv_timer_stop(&timer_);
+      return;
+    }
+    uint64_t due = delayed_tasks_.top().due;
+    uint64_t now = uv_now(&loop_);
+    CHECK_EQ(0, uv_timer_start(&timer_, RunTasks, due > now ? due - now : 0,
+                               0));
   }
 
-  std::unique_ptr<TaskQueueEntry> TakeTimerTask(uv_timer_t* timer) {
-    std::unique_ptr<TaskQueueEntry> task_entry(
-        static_cast<TaskQueueEntry*>(timer->data));
-    uv_timer_stop(timer);
-    uv_close(reinterpret_cast<uv_handle_t*>(timer), [](uv_handle_t* handle) {
-      delete reinterpret_cast<uv_timer_t*>(handle);
-    });
-    timers_.erase(timer);
-    return task_entry;
+  static void RunTasks(uv_timer_t* timer) {
+    DelayedTaskScheduler* scheduler =
+        ContainerOf(&DelayedTaskScheduler::timer_, timer);
+    // Hand all of the tasks that are due over to the worker threads at once.
+    std::vector<std::unique_ptr<TaskQueueEntry>> due_tasks;
+    uint64_t now = uv_now(&scheduler->loop_);
+    DelayedTaskHeap& heap = scheduler->delayed_tasks_;
+    while (!heap.empty() && heap.top().due <= now) {
+      // See FlushTasks() for the const_cast.
+      due_tasks.push_back(
+          std::move(const_cast<DelayedTaskEntry&>(heap.top()).task));
+      heap.pop();
+    }
+    scheduler->runner_->EnqueueBatch(std::move(due_tasks));
+    scheduler->ArmTimer();
   }
 
   uv_sem_t ready_;
-  // Task queue in the worker thread task runner, we push the delayed task back
-  // to it when the timer expires.
-  TaskQueue<TaskQueueEntry>* pending_worker_tasks_;
+  // The worker thread task runner, we push the delayed task back to it when
+  // the timer expires.
+  WorkerThreadsTaskRunner* runner_;
 
   // Locally scheduled tasks to be poped into the worker task runner queue.
   // It is flushed whenever the next closest timer expires.
   TaskQueue<Task> tasks_;
   uv_loop_t loop_;
   uv_async_t flush_tasks_;
-  std::unordered_set<uv_timer_t*> timers_;
+  uv_timer_t timer_;
+  DelayedTaskHeap delayed_tasks_;
+  uint64_t next_sequence_ = 0;
 };
 
 WorkerThreadsTaskRunner::WorkerThreadsTaskRunner(
@@ -251,13 +301,18 @@ WorkerThreadsTaskRunner::WorkerThreadsTaskRunner(
   Mutex::ScopedLock lock(platform_workers_mutex);
   int pending_platform_workers = thread_pool_size;
 
-  delayed_task_scheduler_ = std::make_unique<DelayedTaskScheduler>(
-      &pending_worker_tasks_);
+  delayed_task_scheduler_ = std::make_unique<DelayedTaskScheduler>(this);
   threads_.push_back(delayed_task_scheduler_->Start());
 
+  // Create all queues up-front so that workers can steal from each other
+  // without synchronizing on the vector.
+  for (int i = 0; i < thread_pool_size; i++) {
+    worker_queues_.push_back(std::make_unique<WorkerQueue>());
+  }
+
   for (int i = 0; i < thread_pool_size; i++) {
     PlatformWorkerData* worker_data =
-        new PlatformWorkerData{&pending_worker_tasks_,
+        new PlatformWorkerData{this,
                                &platform_workers_mutex,
                                &platform_workers_ready,
                                &pending_platform_workers,
@@ -278,12 +333,138 @@ WorkerThreadsTaskRunner::WorkerThreadsTaskRunner(
   }
 }
 
+// static
+void WorkerThreadsTaskRunner::PlatformWorkerThread(void* data) {
+  uv_thread_setname("V8Worker");
+  std::unique_ptr<PlatformWorkerData>
+      worker_data(static_cast<PlatformWorkerData*>(data));
+
+  WorkerThreadsTaskRunner* runner = worker_data->runner;
+  TRACE_EVENT_METADATA1("__metadata", "thread_name", "name",
+                        "PlatformWorkerThread");
+
+  int id = worker_data->id;
+  current_platform_worker = {runner, id};
+
+  // Notify the main thread that the platform worker is ready.
+  {
+    Mutex::ScopedLock lock(*worker_data->platform_workers_mutex);
+    (*worker_data->pending_platform_workers)--;
+    worker_data->platform_workers_ready->Signal(lock);
+  }
+
+  bool debug_log_enabled =
+      worker_data->debug_log_level != PlatformDebugLogLevel::kNone;
+  while (std::unique_ptr<TaskQueueEntry> entry = runner->NextTask(id)) {
+    if (debug_log_enabled) {
+      fprintf(stderr,
+              "\nPlatformWorkerThread %d running task %p %s\n",
+              id,
+              entry->task.get(),
+              GetTaskPriorityName(entry->priority));
+      fflush(stderr);
+    }
+    entry->task->Run();
+    runner->FinishTask(*entry);
+  }
+}
+
+void WorkerThreadsTaskRunner::EnqueueBatch(
+    std::vector<std::unique_ptr<TaskQueueEntry>> entries) {
+  if (entries.empty()) return;
+  size_t count = entries.size();
+  {
+    auto locked = pending_worker_tasks_.Lock();
+    for (auto& entry : entries) {
+      if (entry->is_outstanding()) {
+        outstanding_tasks_.fetch_add(1, std::memory_order_relaxed);
+      }
+      locked.Push(std::move(entry));
+    }
+  }
+  // See Enqueue().
+  queued_tasks_.fetch_add(count, std::memory_order_seq_cst);
+  if (idle_workers_.load(std::memory_order_seq_cst) > 0) {
+    Mutex::ScopedLock lock(idle_mutex_);
+    if (count == 1) {
+      tasks_available_.Signal(lock);
+    } else {
+      tasks_available_.Broadcast(lock);
+    }
+  }
+}
+
+void WorkerThreadsTaskRunner::Enqueue(std::unique_ptr<TaskQueueEntry> entry) {
+  if (entry->is_outstanding()) {
+    outstanding_tasks_.fetch_add(1, std::memory_order_relaxed);
+  }
+  if (current_platform_worker.runner == this) {
+    worker_queues_[current_platform_worker.id]->Push(std::move(entry));
+  } else {
+    pending_worker_tasks_.Lock().Push(std::move(entry));
+  }
+  // Pairs with the idle_workers_ increment in NextTask(): either the
+  // sleeping worker sees the new task, or we see the sleeping worker.
+  queued_tasks_.fetch_add(1, std::memory_order_seq_cst);
+  if (idle_workers_.load(std::memory_order_seq_cst) > 0) {
+    Mutex::ScopedLock lock(idle_mutex_);
+    tasks_available_.Signal(lock);
+  }
+}
+
+std::unique_ptr<TaskQueueEntry> WorkerThreadsTaskRunner::Steal(
+    int id, TaskPriority min_priority) {
+  size_t count = worker_queues_.size();
+  for (size_t i = 1; i < count; i++) {
+    WorkerQueue* victim = worker_queues_[(id + i) % count].get();
+    if (std::unique_ptr<TaskQueueEntry> entry = victim->TrySteal(min_priority))
+      return entry;
+  }
+  return nullptr;
+}
+
+std::unique_ptr<TaskQueueEntry> WorkerThreadsTaskRunner::NextTask(int id) {
+  WorkerQueue* own = worker_queues_[id].get();
+  while (!stopped_.load(std::memory_order_relaxed)) {
+    // A kUserBlocking task anywhere is run before the less urgent tasks
+    // in the own queue.
+    std::unique_ptr<TaskQueueEntry> entry =
+        own->Pop(TaskPriority::kUserBlocking);
+    if (!entry) entry = pending_worker_tasks_.Lock().Pop();
+    if (!entry) entry = Steal(id, TaskPriority::kUserBlocking);
+    if (!entry) entry = own->Pop(TaskPriority::kBestEffort);
+    if (!entry) entry = Steal(id, TaskPriority::kBestEffort);
+    if (entry) {
+      queued_tasks_.fetch_sub(1, std::memory_order_relaxed);
+      return entry;
+    }
+
+    Mutex::ScopedLock lock(idle_mutex_);
+    idle_workers_.fetch_add(1, std::memory_order_seq_cst);
+    // A thief may have failed to TryLock() a busy queue, so only sleep
+    // when there is nothing queued at all.
+    if (queued_tasks_.load(std::memory_order_seq_cst) == 0 &&
+        !stopped_.load(std::memory_order_relaxed)) {
+      tasks_available_.Wait(lock);
+    }
+    idle_workers_.fetch_sub(1, std::memory_order_relaxed);
+  }
+  return nullptr;
+}
+
+void WorkerThreadsTaskRunner::FinishTask(const TaskQueueEntry& entry) {
+  // See NodePlatform::DrainTasks().
+  if (entry.is_outstanding() &&
+      outstanding_tasks_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    Mutex::ScopedLock lock(outstanding_mutex_);
+    outstanding_tasks_drained_.Broadcast(lock);
+  }
+}
+
 void WorkerThreadsTaskRunner::PostTask(v8::TaskPriority priority,
                                        std::unique_ptr<v8::Task> task,
                                        const v8::SourceLocation& location) {
-  auto entry = std::make_unique<TaskQueueEntry>(std::move(task), priority);
-  bool is_outstanding = entry->is_outstanding();
-  pending_worker_tasks_.Lock().Push(std::move(entry), is_outstanding);
+  Enqueue(std::make_unique<TaskQueueEntry>(std::move(task), priority));
 }
 
 void WorkerThreadsTaskRunner::PostDelayedTask(
@@ -296,11 +477,18 @@ void WorkerThreadsTaskRunner::PostDelayedTask(
 }
 
 void WorkerThreadsTaskRunner::BlockingDrain() {
-  pending_worker_tasks_.Lock().BlockingDrain();
+  Mutex::ScopedLock lock(outstanding_mutex_);
+  while (outstanding_tasks_.load(std::memory_order_acquire) > 0) {
+    outstanding_tasks_drained_.Wait(lock);
+  }
 }
 
 void WorkerThreadsTaskRunner::Shutdown() {
-  pending_worker_tasks_.Lock().Stop();
+  {
+    Mutex::ScopedLock lock(idle_mutex_);
+    stopped_.store(true, std::memory_order_relaxed);
+    tasks_available_.Broadcast(lock);
+  }
   delayed_task_scheduler_->Stop();
   for (size_t i = 0; i < threads_.size(); i++) {
     CHECK_EQ(0, uv_thread_join(threads_[i].get()));
@@ -311,6 +499,55 @@ int WorkerThreadsTaskRunner::NumberOfWorkerThreads() const {
   return threads_.size();
 }
 
+// Posts into one of the lanes of a PerIsolatePlatformData. Non-blocking
+// lanes are only used for immediate tasks, delayed and idle tasks are
+// forwarded as-is.
+class PerIsolatePlatformData::PriorityTaskRunner : public v8::TaskRunner {
+ public:
+  PriorityTaskRunner(std::weak_ptr<PerIsolatePlatformData> platform_data,
+                     TaskPriority priority)
+      : platform_data_(std::move(platform_data)), priority_(priority) {}
+
+  bool IdleTasksEnabled() override { return true; }
+  bool NonNestableTasksEnabled() const override { return true; }
+  bool NonNestableDelayedTasksEnabled() const override { return true; }
+
+ private:
+  void PostTaskImpl(std::unique_ptr<Task> task,
+                    const v8::SourceLocation& location) override {
+    if (auto platform_data = platform_data_.lock()) {
+      platform_data->PostTaskWithPriority(std::move(task), priority_, location);
+    }
+  }
+  void PostNonNestableTaskImpl(std::unique_ptr<Task> task,
+                               const v8::SourceLocation& location) override {
+    PostTaskImpl(std::move(task), location);
+  }
+  void PostDelayedTaskImpl(std::unique_ptr<Task> task,
+                           double delay_in_seconds,
+                           const v8::SourceLocation& location) override {
+    if (auto platform_data = platform_data_.lock()) {
+      platform_data->PostDelayedTaskImpl(
+          std::move(task), delay_in_seconds, location);
+    }
+  }
+  void PostNonNestableDelayedTaskImpl(
+      std::unique_ptr<Task> task,
+      double delay_in_seconds,
+      const v8::SourceLocation& location) override {
+    PostDelayedTaskImpl(std::move(task), delay_in_seconds, location);
+  }
+  void PostIdleTaskImpl(std::unique_ptr<v8::IdleTask> task,
+                        const v8::SourceLocation& location) override {
+    if (auto platform_data = platform_data_.lock()) {
+      platform_data->PostIdleTaskImpl(std::move(task), location);
+    }
+  }
+
+  std::weak_ptr<PerIsolatePlatformData> platform_data_;
+  TaskPriority priority_;
+};
+
 PerIsolatePlatformData::PerIsolatePlatformData(
     Isolate* isolate, uv_loop_t* loop, PlatformDebugLogLevel debug_log_level)
     : isolate_(isolate), loop_(loop), debug_log_level_(debug_log_level) {
@@ -318,6 +555,11 @@ PerIsolatePlatformData::PerIsolatePlatformData(
   CHECK_EQ(0, uv_async_init(loop, flush_tasks_, FlushTasks));
   flush_tasks_->data = static_cast<void*>(this);
   uv_unref(reinterpret_cast<uv_handle_t*>(flush_tasks_));
+
+  idle_tasks_prepare_ = new uv_prepare_t();
+  CHECK_EQ(0, uv_prepare_init(loop, idle_tasks_prepare_));
+  idle_tasks_prepare_->data = static_cast<void*>(this);
+  uv_unref(reinterpret_cast<uv_handle_t*>(idle_tasks_prepare_));
 }
 
 std::shared_ptr<v8::TaskRunner>
@@ -325,6 +567,26 @@ PerIsolatePlatformData::GetForegroundTaskRunner() {
   return shared_from_this();
 }
 
+std::shared_ptr<v8::TaskRunner>
+PerIsolatePlatformData::GetForegroundTaskRunner(TaskPriority priority) {
+  std::shared_ptr<v8::TaskRunner>* runner;
+  switch (priority) {
+    case TaskPriority::kUserVisible:
+      runner = &user_visible_task_runner_;
+      break;
+    case TaskPriority::kBestEffort:
+      runner = &best_effort_task_runner_;
+      break;
+    default:
+      return shared_from_this();
+  }
+  Mutex::ScopedLock lock(priority_task_runners_mutex_);
+  if (!*runner) {
+    *runner = std::make_shared<PriorityTaskRunner>(weak_from_this(), priority);
+  }
+  return *runner;
+}
+
 void PerIsolatePlatformData::FlushTasks(uv_async_t* handle) {
   auto platform_data = static_cast<PerIsolatePlatformData*>(handle->data);
   platform_data->FlushForegroundTasksInternal();
@@ -332,11 +594,22 @@ void PerIsolatePlatformData::FlushTasks(uv_async_t* handle) {
 
 void PerIsolatePlatformData::PostIdleTaskImpl(
     std::unique_ptr<v8::IdleTask> task, const v8::SourceLocation& location) {
-  UNREACHABLE();
+  auto locked = foreground_idle_tasks_.Lock();
+  if (flush_tasks_ == nullptr) return;
+  locked.Push(std::move(task));
+  // The prepare handle can only be started on the loop thread.
+  uv_async_send(flush_tasks_);
 }
 
 void PerIsolatePlatformData::PostTaskImpl(std::unique_ptr<Task> task,
                                           const v8::SourceLocation& location) {
+  PostTaskWithPriority(std::move(task), TaskPriority::kUserBlocking, location);
+}
+
+void PerIsolatePlatformData::PostTaskWithPriority(
+    std::unique_ptr<Task> task,
+    TaskPriority priority,
+    const v8::SourceLocation& location) {
   // The task can be posted from any V8 background worker thread, even when
   // the foreground task runner is being cleaned up by Shutdown(). In that
   // case, make sure we wait until the shutdown is completed (which leads
@@ -350,11 +623,12 @@ void PerIsolatePlatformData::PostTaskImpl(std::unique_ptr<Task> task,
     fflush(stderr);
   }
 
-  auto locked = foreground_tasks_.Lock();
+  TaskQueue<TaskQueueEntry>& queue = priority == TaskPriority::kBestEffort
+                                         ? foreground_best_effort_tasks_
+                                         : foreground_tasks_;
+  auto locked = queue.Lock();
   if (flush_tasks_ == nullptr) return;
-  // All foreground tasks are treated as user blocking tasks.
-  locked.Push(std::make_unique<TaskQueueEntry>(
-      std::move(task), v8::TaskPriority::kUserBlocking));
+  locked.Push(std::make_unique<TaskQueueEntry>(std::move(task), priority));
   uv_async_send(flush_tasks_);
 }
 
@@ -410,11 +684,27 @@ void PerIsolatePlatformData::AddShutdownCallback(void (*callback)(void*),
 void PerIsolatePlatformData::Shutdown() {
   auto foreground_tasks_locked = foreground_tasks_.Lock();
   auto foreground_delayed_tasks_locked = foreground_delayed_tasks_.Lock();
+  auto foreground_best_effort_tasks_locked =
+      foreground_best_effort_tasks_.Lock();
+  auto foreground_idle_tasks_locked = foreground_idle_tasks_.Lock();
 
+  foreground_idle_tasks_locked.PopAll();
+  foreground_best_effort_tasks_locked.PopAll();
   foreground_delayed_tasks_locked.PopAll();
   foreground_tasks_locked.PopAll();
   scheduled_delayed_tasks_.clear();
 
+  if (idle_tasks_prepare_ != nullptr) {
+    uv_close(reinterpret_cast<uv_handle_t*>(idle_tasks_prepare_),
+             [](uv_handle_t* handle) {
+               std::unique_ptr<uv_prepare_t> prepare{
+                   reinterpret_cast<uv_prepare_t*>(handle)};
+               static_cast<PerIsolatePlatformData*>(prepare->data)
+                   ->DecreaseHandleCount();
+             });
+    idle_tasks_prepare_ = nullptr;
+  }
+
   if (flush_tasks_ != nullptr) {
     // Both destroying the scheduled_delayed_tasks_ lists and closing
     // flush_tasks_ handle add tasks to the event loop. We keep a count of all
@@ -537,7 +827,8 @@ int NodePlatform::NumberOfWorkerThreads() {
   return worker_thread_task_runner_->NumberOfWorkerThreads();
 }
 
-void PerIsolatePlatformData::RunForegroundTask(std::unique_ptr<Task> task) {
+template <typename Fn>
+void PerIsolatePlatformData::RunInCallbackScope(Fn&& fn) {
   if (isolate_->IsExecutionTerminating()) return;
   DebugSealHandleScope scope(isolate_);
   Environment* env = Environment::GetCurrent(isolate_);
@@ -545,7 +836,7 @@ void PerIsolatePlatformData::RunForegroundTask(std::unique_ptr<Task> task) {
     v8::HandleScope scope(isolate_);
     InternalCallbackScope cb_scope(env, Object::New(isolate_), { 0, 0 },
                                    InternalCallbackScope::kNoFlags);
-    task->Run();
+    fn();
   } else {
     // When the Environment was freed, the tasks of the Isolate should also be
     // canceled by `NodePlatform::UnregisterIsolate`. However, if the embedder
@@ -555,7 +846,73 @@ void PerIsolatePlatformData::RunForegroundTask(std::unique_ptr<Task> task) {
     // The task is moved out of InternalCallbackScope if env is not available.
     // This is a required else block, and should not be removed.
     // See comment: https://github.com/nodejs/node/pull/34688#pullrequestreview-463867489
-    task->Run();
+    fn();
+  }
+}
+
+void PerIsolatePlatformData::RunForegroundTask(std::unique_ptr<Task> task) {
+  RunInCallbackScope([&]() { task->Run(); });
+}
+
+bool PerIsolatePlatformData::RunBestEffortTasks() {
+  TaskQueue<TaskQueueEntry>::PriorityQueue tasks =
+      foreground_best_effort_tasks_.Lock().PopAll();
+  if (tasks.empty()) return false;
+
+  uint64_t deadline = uv_hrtime() + kBestEffortTaskBudgetMs * 1000 * 1000;
+  do {
+    // We have to use const_cast because std::priority_queue::top() does not
+    // return a movable item.
+    std::unique_ptr<TaskQueueEntry> entry =
+        std::move(const_cast<std::unique_ptr<TaskQueueEntry>&>(tasks.top()));
+    tasks.pop();
+    RunForegroundTask(std::move(entry->task));
+  } while (!tasks.empty() && uv_hrtime() < deadline);
+
+  if (!tasks.empty()) {
+    // Out of budget. Give the event loop a chance to process I/O before
+    // continuing with the rest.
+    auto locked = foreground_best_effort_tasks_.Lock();
+    if (flush_tasks_ == nullptr) return true;
+    while (!tasks.empty()) {
+      locked.Push(std::move(
+          const_cast<std::unique_ptr<TaskQueueEntry>&>(tasks.top())));
+      tasks.pop();
+    }
+    uv_async_send(flush_tasks_);
+  }
+  return true;
+}
+
+// static
+void PerIsolatePlatformData::RunIdleTasks(uv_prepare_t* handle) {
+  PerIsolatePlatformData* platform_data =
+      static_cast<PerIsolatePlatformData*>(handle->data);
+  // The loop is about to poll for I/O. If it will not block, e.g. because a
+  // timer is due, this is not an idle period.
+  int timeout = uv_backend_timeout(platform_data->loop_);
+  if (timeout == 0) return;
+  double budget = kMaxIdleTaskBudgetSeconds;
+  if (timeout > 0) budget = std::min(budget, timeout / 1000.0);
+
+  TaskQueue<v8::IdleTask>::PriorityQueue tasks =
+      platform_data->foreground_idle_tasks_.Lock().PopAll();
+  double deadline = uv_hrtime() / 1e9 + budget;
+  while (!tasks.empty() && uv_hrtime() / 1e9 < deadline) {
+    std::unique_ptr<v8::IdleTask> task =
+        std::move(const_cast<std::unique_ptr<v8::IdleTask>&>(tasks.top()));
+    tasks.pop();
+    platform_data->RunInCallbackScope([&]() { task->Run(deadline); });
+  }
+
+  auto locked = platform_data->foreground_idle_tasks_.Lock();
+  while (!tasks.empty()) {
+    locked.Push(
+        std::move(const_cast<std::unique_ptr<v8::IdleTask>&>(tasks.top())));
+    tasks.pop();
+  }
+  if (locked.empty() || platform_data->flush_tasks_ == nullptr) {
+    uv_prepare_stop(handle);
   }
 }
 
@@ -653,6 +1010,16 @@ bool PerIsolatePlatformData::FlushForegroundTasksInternal() {
     RunForegroundTask(std::move(entry->task));
   }
 
+  if (RunBestEffortTasks()) {
+    did_work = true;
+  }
+
+  if (idle_tasks_prepare_ != nullptr &&
+      !uv_is_active(reinterpret_cast<uv_handle_t*>(idle_tasks_prepare_)) &&
+      !foreground_idle_tasks_.Lock().empty()) {
+    uv_prepare_start(idle_tasks_prepare_, RunIdleTasks);
+  }
+
   return did_work;
 }
 
@@ -741,6 +1108,11 @@ bool NodePlatform::IdleTasksEnabled(Isolate* isolate) {
 
 std::shared_ptr<v8::TaskRunner> NodePlatform::GetForegroundTaskRunner(
     Isolate* isolate, v8::TaskPriority priority) {
+  // Isolates with a custom delegate only have a single lane.
+  if (std::shared_ptr<PerIsolatePlatformData> per_isolate =
+          ForNodeIsolate(isolate)) {
+    return per_isolate->GetForegroundTaskRunner(priority);
+  }
   return ForIsolate(isolate)->GetForegroundTaskRunner();
 }
 
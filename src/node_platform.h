@@ -3,6 +3,7 @@
 
 #if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
 
+#include <atomic>
 #include <functional>
 #include <queue>
 #include <type_traits>
@@ -55,6 +56,7 @@ class TaskQueue {
     void BlockingDrain();
     void Stop();
     PriorityQueue PopAll();
+    bool empty() const { return queue_->task_queue_.empty(); }
 
    private:
     friend class TaskQueue;
@@ -115,7 +117,12 @@ class PerIsolatePlatformData
   ~PerIsolatePlatformData() override;
 
   std::shared_ptr<v8::TaskRunner> GetForegroundTaskRunner() override;
-  bool IdleTasksEnabled() override { return false; }
+  // Returns a task runner that posts into the lane of |priority|.
+  std::shared_ptr<v8::TaskRunner> GetForegroundTaskRunner(
+      v8::TaskPriority priority);
+  // Idle tasks run right before the event loop would block for I/O, with a
+  // deadline derived from the next timer.
+  bool IdleTasksEnabled() override { return true; }
 
   // Non-nestable tasks are treated like regular tasks.
   bool NonNestableTasksEnabled() const override { return true; }
@@ -126,12 +133,19 @@ class PerIsolatePlatformData
 
   // Returns true if work was dispatched or executed. New tasks that are
   // posted during flushing of the queue are postponed until the next
-  // flushing.
+  // flushing. Best-effort tasks only run for kBestEffortTaskBudgetMs per
+  // flush, the rest is left for the next one so that they don't delay I/O.
   bool FlushForegroundTasksInternal();
 
+  static constexpr uint64_t kBestEffortTaskBudgetMs = 1;
+  // Upper bound of the deadline passed to idle tasks.
+  static constexpr double kMaxIdleTaskBudgetSeconds = 0.05;
+
   const uv_loop_t* event_loop() const { return loop_; }
 
  private:
+  class PriorityTaskRunner;
+
   // v8::TaskRunner implementation.
   void PostTaskImpl(std::unique_ptr<v8::Task> task,
                     const v8::SourceLocation& location) override;
@@ -147,14 +161,23 @@ class PerIsolatePlatformData
       double delay_in_seconds,
       const v8::SourceLocation& location) override;
 
+  void PostTaskWithPriority(std::unique_ptr<v8::Task> task,
+                            v8::TaskPriority priority,
+                            const v8::SourceLocation& location);
   void DeleteFromScheduledTasks(DelayedTask* task);
   void DecreaseHandleCount();
 
   static void FlushTasks(uv_async_t* handle);
+  template <typename Fn>
+  void RunInCallbackScope(Fn&& fn);
   void RunForegroundTask(std::unique_ptr<v8::Task> task);
   static void RunForegroundTask(uv_timer_t* timer);
+  bool RunBestEffortTasks();
+  static void RunIdleTasks(uv_prepare_t* handle);
 
   uv_async_t* flush_tasks_ = nullptr;
+  // Started on the loop thread while idle tasks are pending.
+  uv_prepare_t* idle_tasks_prepare_ = nullptr;
 
   struct ShutdownCallback {
     void (*cb)(void*);
@@ -164,15 +187,23 @@ class PerIsolatePlatformData
   ShutdownCbList shutdown_callbacks_;
   // shared_ptr to self to keep this object alive during shutdown.
   std::shared_ptr<PerIsolatePlatformData> self_reference_;
-  uint32_t uv_handle_count_ = 1;  // 1 = flush_tasks_
+  uint32_t uv_handle_count_ = 2;  // flush_tasks_ and idle_tasks_prepare_
 
   v8::Isolate* const isolate_;
   uv_loop_t* const loop_;
 
-  // When acquiring locks for both task queues, lock foreground_tasks_
-  // first then foreground_delayed_tasks_ to avoid deadlocks.
+  // When acquiring locks for several task queues, lock them in the order
+  // they are declared in to avoid deadlocks.
+  // kUserBlocking and kUserVisible tasks, which are all run on every flush.
   TaskQueue<TaskQueueEntry> foreground_tasks_;
   TaskQueue<DelayedTask> foreground_delayed_tasks_;
+  // kBestEffort tasks, which are run within a time budget.
+  TaskQueue<TaskQueueEntry> foreground_best_effort_tasks_;
+  TaskQueue<v8::IdleTask> foreground_idle_tasks_;
+
+  Mutex priority_task_runners_mutex_;
+  std::shared_ptr<v8::TaskRunner> user_visible_task_runner_;
+  std::shared_ptr<v8::TaskRunner> best_effort_task_runner_;
 
   // Use a custom deleter because libuv needs to close the handle first.
   typedef std::unique_ptr<DelayedTask, void (*)(DelayedTask*)>
@@ -201,15 +232,42 @@ class WorkerThreadsTaskRunner {
   int NumberOfWorkerThreads() const;
 
  private:
-  // A queue shared by all threads. The consumers are the worker threads which
-  // take tasks from it to run in PlatformWorkerThread(). The producers can be
-  // any thread. Both the foreground thread and the worker threads can push
-  // tasks into the queue via v8::Platform::PostTaskOnWorkerThread() which
-  // eventually calls PostTask() on this class. When any thread calls
-  // v8::Platform::PostDelayedTaskOnWorkerThread(), the DelayedTaskScheduler
-  // thread will schedule a timer that pushes the delayed tasks back into this
-  // queue when the timer expires.
+  class WorkerQueue;
+
+  static void PlatformWorkerThread(void* data);
+  void Enqueue(std::unique_ptr<TaskQueueEntry> entry);
+  // Like Enqueue(), for a batch of tasks posted from a thread that is not a
+  // platform worker, with a single lock of the shared queue.
+  void EnqueueBatch(std::vector<std::unique_ptr<TaskQueueEntry>> entries);
+  // Blocks until a task is available for the worker |id|, or returns nullptr
+  // once the runner is stopped.
+  std::unique_ptr<TaskQueueEntry> NextTask(int id);
+  std::unique_ptr<TaskQueueEntry> Steal(int id, v8::TaskPriority min_priority);
+  void FinishTask(const TaskQueueEntry& entry);
+
+  // A queue shared by all threads that are not platform workers, e.g. the
+  // foreground threads and the DelayedTaskScheduler thread, which pushes
+  // the tasks posted via v8::Platform::PostDelayedTaskOnWorkerThread() here
+  // when their timers expire.
   TaskQueue<TaskQueueEntry> pending_worker_tasks_;
+  // One queue per platform worker. Tasks that a worker posts (e.g. the
+  // follow-up tasks of concurrent marking or compile jobs) go to its own
+  // queue, so workers do not contend on a single lock. Idle workers steal
+  // from the others, high priority tasks first, before going to sleep.
+  std::vector<std::unique_ptr<WorkerQueue>> worker_queues_;
+
+  // Number of tasks in all of the queues above.
+  std::atomic<size_t> queued_tasks_{0};
+  std::atomic<int> idle_workers_{0};
+  std::atomic<bool> stopped_{false};
+  Mutex idle_mutex_;
+  ConditionVariable tasks_available_;
+
+  // Number of kUserBlocking tasks that are posted but not yet finished,
+  // see NodePlatform::DrainTasks().
+  std::atomic<int> outstanding_tasks_{0};
+  Mutex outstanding_mutex_;
+  ConditionVariable outstanding_tasks_drained_;
 
   class DelayedTaskScheduler;
   std::unique_ptr<DelayedTaskScheduler> delayed_task_scheduler_;
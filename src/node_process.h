@@ -50,6 +50,24 @@ v8::MaybeLocal<v8::Object> CreateProcessObject(Realm* env);
 void PatchProcessObject(const v8::FunctionCallbackInfo<v8::Value>& args);
 
 namespace process {
+
+// Fields of the Float64Array refreshed by the resource sampler. The memory
+// fields match process.memoryUsage(), the CPU fields process.cpuUsage().
+enum ResourceSamplerField {
+  kSamplerRss,
+  kSamplerHeapTotal,
+  kSamplerHeapUsed,
+  kSamplerExternal,
+  kSamplerArrayBuffers,
+  kSamplerUserCPU,
+  kSamplerSystemCPU,
+  // uv_hrtime() of the last sample, in milliseconds.
+  kSamplerTimestamp,
+  kSamplerFieldCount
+};
+
+class ResourceSampler;
+
 class BindingData : public SnapshotableObject {
  public:
   struct InternalFieldInfo : public node::InternalFieldInfoBase {
@@ -66,6 +84,7 @@ class BindingData : public SnapshotableObject {
   BindingData(Realm* realm,
               v8::Local<v8::Object> object,
               InternalFieldInfo* info = nullptr);
+  ~BindingData() override;
 
   void MemoryInfo(MemoryTracker* tracker) const override;
   SET_MEMORY_INFO_NAME(BindingData)
@@ -92,11 +111,21 @@ class BindingData : public SnapshotableObject {
 
   static void LoadEnvFile(const v8::FunctionCallbackInfo<v8::Value>& args);
 
+  // startResourceSampler(intervalMs) samples memory and CPU usage every
+  // `intervalMs` milliseconds without keeping the event loop alive and
+  // returns the Float64Array the samples are written to.
+  static void StartResourceSampler(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void StopResourceSampler(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
+
  private:
   // Buffer length in uint32.
   static constexpr size_t kHrTimeBufferLength = 3;
   AliasedUint32Array hrtime_buffer_;
   InternalFieldInfo* internal_field_info_ = nullptr;
+  // Created on first use and not part of the snapshot.
+  ResourceSampler* resource_sampler_ = nullptr;
 
   // These need to be static so that we have their addresses available to
   // register as external references in the snapshot at environment creation
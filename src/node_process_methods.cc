@@ -4,6 +4,7 @@
 #include "env-inl.h"
 #include "memory_tracker-inl.h"
 #include "node.h"
+#include "node_debug.h"
 #include "node_dotenv.h"
 #include "node_errors.h"
 #include "node_external_reference.h"
@@ -43,9 +44,11 @@ using v8::Array;
 using v8::ArrayBuffer;
 using v8::CFunction;
 using v8::Context;
+using v8::FastApiCallbackOptions;
 using v8::Float64Array;
 using v8::Function;
 using v8::FunctionCallbackInfo;
+using v8::HandleScope;
 using v8::HeapStatistics;
 using v8::Integer;
 using v8::Isolate;
@@ -115,6 +118,12 @@ inline Local<ArrayBuffer> get_fields_array_buffer(
 // which are uv_timeval_t structs (long tv_sec, long tv_usec).
 // Returns those values as Float64 microseconds in the elements of the array
 // passed to the function.
+static void FillCPUUsage(const uv_rusage_t& rusage, double* fields) {
+  // Set the elements to be user / system values in microseconds.
+  fields[0] = MICROS_PER_SEC * rusage.ru_utime.tv_sec + rusage.ru_utime.tv_usec;
+  fields[1] = MICROS_PER_SEC * rusage.ru_stime.tv_sec + rusage.ru_stime.tv_usec;
+}
+
 static void CPUUsage(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
   uv_rusage_t rusage;
@@ -126,13 +135,30 @@ static void CPUUsage(const FunctionCallbackInfo<Value>& args) {
 
   // Get the double array pointer from the Float64Array argument.
   Local<ArrayBuffer> ab = get_fields_array_buffer(args, 0, 2);
-  double* fields = static_cast<double*>(ab->Data());
+  FillCPUUsage(rusage, static_cast<double*>(ab->Data()));
+}
 
-  // Set the Float64Array elements to be user / system values in microseconds.
-  fields[0] = MICROS_PER_SEC * rusage.ru_utime.tv_sec + rusage.ru_utime.tv_usec;
-  fields[1] = MICROS_PER_SEC * rusage.ru_stime.tv_sec + rusage.ru_stime.tv_usec;
+// Assume caller has properly validated args.
+static void FastCPUUsage(Local<Value> receiver,
+                         Local<Value> fields_obj,
+                         // NOLINTNEXTLINE(runtime/references)
+                         FastApiCallbackOptions& options) {
+  HandleScope scope(options.isolate);
+  uv_rusage_t rusage;
+  int err = uv_getrusage(&rusage);
+  if (err) {
+    Environment::GetCurrent(options.isolate)
+        ->ThrowUVException(err, "uv_getrusage");
+    return;
+  }
+
+  TRACK_V8_FAST_API_CALL("process.cpuUsage");
+  Local<ArrayBuffer> ab = fields_obj.As<Float64Array>()->Buffer();
+  FillCPUUsage(rusage, static_cast<double*>(ab->Data()));
 }
 
+static CFunction fast_cpu_usage(CFunction::Make(FastCPUUsage));
+
 // ThreadCPUUsage use libuv's uv_getrusage_thread() this-thread resource usage
 // accessor, to access ru_utime (user CPU time used) and ru_stime
 // (system CPU time used), which are uv_timeval_t structs
@@ -149,11 +175,7 @@ static void ThreadCPUUsage(const FunctionCallbackInfo<Value>& args) {
 
   // Get the double array pointer from the Float64Array argument.
   Local<ArrayBuffer> ab = get_fields_array_buffer(args, 0, 2);
-  double* fields = static_cast<double*>(ab->Data());
-
-  // Set the Float64Array elements to be user / system values in microseconds.
-  fields[0] = MICROS_PER_SEC * rusage.ru_utime.tv_sec + rusage.ru_utime.tv_usec;
-  fields[1] = MICROS_PER_SEC * rusage.ru_stime.tv_sec + rusage.ru_stime.tv_usec;
+  FillCPUUsage(rusage, static_cast<double*>(ab->Data()));
 }
 
 static void Cwd(const FunctionCallbackInfo<Value>& args) {
@@ -210,25 +232,36 @@ static void Rss(const FunctionCallbackInfo<Value>& args) {
   args.GetReturnValue().Set(static_cast<double>(rss));
 }
 
-static void MemoryUsage(const FunctionCallbackInfo<Value>& args) {
-  Environment* env = Environment::GetCurrent(args);
+static double FastRss(Local<Value> receiver,
+                      // NOLINTNEXTLINE(runtime/references)
+                      FastApiCallbackOptions& options) {
+  size_t rss;
+  int err = uv_resident_set_memory(&rss);
+  if (err) {
+    HandleScope scope(options.isolate);
+    Environment::GetCurrent(options.isolate)
+        ->ThrowUVException(err, "uv_resident_set_memory");
+    return 0;
+  }
 
-  Isolate* isolate = env->isolate();
+  TRACK_V8_FAST_API_CALL("process.rss");
+  return static_cast<double>(rss);
+}
+
+static CFunction fast_rss(CFunction::Make(FastRss));
+
+// Fills the five memoryUsage() fields. Returns 0 or a libuv error code.
+static int FillMemoryUsage(Environment* env, double* fields) {
   // V8 memory usage
   HeapStatistics v8_heap_stats;
-  isolate->GetHeapStatistics(&v8_heap_stats);
+  env->isolate()->GetHeapStatistics(&v8_heap_stats);
 
   NodeArrayBufferAllocator* array_buffer_allocator =
       env->isolate_data()->node_allocator();
 
-  // Get the double array pointer from the Float64Array argument.
-  Local<ArrayBuffer> ab = get_fields_array_buffer(args, 0, 5);
-  double* fields = static_cast<double*>(ab->Data());
-
   size_t rss;
   int err = uv_resident_set_memory(&rss);
-  if (err)
-    return env->ThrowUVException(err, "uv_resident_set_memory");
+  if (err) return err;
 
   fields[0] = static_cast<double>(rss);
   fields[1] = static_cast<double>(v8_heap_stats.total_heap_size());
@@ -238,6 +271,17 @@ static void MemoryUsage(const FunctionCallbackInfo<Value>& args) {
       array_buffer_allocator == nullptr
           ? 0
           : static_cast<double>(array_buffer_allocator->total_mem_usage());
+  return 0;
+}
+
+static void MemoryUsage(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  // Get the double array pointer from the Float64Array argument.
+  Local<ArrayBuffer> ab = get_fields_array_buffer(args, 0, 5);
+  int err = FillMemoryUsage(env, static_cast<double*>(ab->Data()));
+  if (err)
+    return env->ThrowUVException(err, "uv_resident_set_memory");
 }
 
 static void GetConstrainedMemory(const FunctionCallbackInfo<Value>& args) {
@@ -382,6 +426,34 @@ static void ResourceUsage(const FunctionCallbackInfo<Value>& args) {
   fields[15] = static_cast<double>(rusage.ru_nivcsw);
 }
 
+// Limits the number of threadpool work items of the given kind ("crypto",
+// "crypto_kdf", "zlib", "node_api", "sqlite" or "other") this Environment
+// submits to libuv at a time. 0 removes the limit.
+static void SetThreadPoolWorkLimit(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsString());
+  CHECK(args[1]->IsUint32());
+
+  Utf8Value name(env->isolate(), args[0]);
+  std::optional<ThreadPoolWorkKind> kind =
+      ParseThreadPoolWorkKind(name.ToStringView());
+  if (!kind.has_value()) {
+    return THROW_ERR_INVALID_ARG_VALUE(
+        env, "Unknown threadpool work kind: %s", *name);
+  }
+  env->thread_pool_work_queue()->SetLimit(*kind,
+                                          args[1].As<Uint32>()->Value());
+}
+
+static void GetThreadPoolWorkStats(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Local<ArrayBuffer> ab = get_fields_array_buffer(
+      args,
+      0,
+      kThreadPoolWorkKindCount * ThreadPoolWorkQueue::kStatsFieldCount);
+  env->thread_pool_work_queue()->GetStats(static_cast<double*>(ab->Data()));
+}
+
 #ifdef __POSIX__
 static void DebugProcess(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
@@ -650,6 +722,81 @@ BindingData::BindingData(Realm* realm,
   hrtime_buffer_.MakeWeak();
 }
 
+// Refreshes a Float64Array with memory and CPU usage from an unref'd timer,
+// so that agents polling the values read memory instead of calling into C++
+// and making syscalls on every read. Deletes itself once Close() has closed
+// the timer.
+class ResourceSampler {
+ public:
+  explicit ResourceSampler(Environment* env)
+      : env_(env), fields_(env->isolate(), kSamplerFieldCount) {
+    CHECK_EQ(0, uv_timer_init(env->event_loop(), &timer_));
+    timer_.data = this;
+    uv_unref(reinterpret_cast<uv_handle_t*>(&timer_));
+  }
+
+  void Start(uint64_t interval) {
+    Sample();
+    CHECK_EQ(0, uv_timer_start(&timer_, OnTimeout, interval, interval));
+  }
+
+  void Stop() { uv_timer_stop(&timer_); }
+
+  void Close() {
+    fields_.Release();
+    env_->CloseHandle(&timer_, [](uv_timer_t* handle) {
+      delete static_cast<ResourceSampler*>(handle->data);
+    });
+  }
+
+  Local<Float64Array> GetJSArray() const { return fields_.GetJSArray(); }
+
+ private:
+  static void OnTimeout(uv_timer_t* handle) {
+    static_cast<ResourceSampler*>(handle->data)->Sample();
+  }
+
+  void Sample() {
+    double* fields = const_cast<double*>(fields_.GetNativeBuffer());
+    // Keep the previous values if a source fails; the timestamp tells the
+    // reader how fresh the sample is.
+    if (FillMemoryUsage(env_, fields + kSamplerRss) != 0) return;
+    uv_rusage_t rusage;
+    if (uv_getrusage(&rusage) != 0) return;
+    FillCPUUsage(rusage, fields + kSamplerUserCPU);
+    fields[kSamplerTimestamp] = static_cast<double>(uv_hrtime()) / 1e6;
+  }
+
+  Environment* env_;
+  uv_timer_t timer_;
+  AliasedFloat64Array fields_;
+};
+
+BindingData::~BindingData() {
+  if (resource_sampler_ != nullptr) resource_sampler_->Close();
+}
+
+void BindingData::StartResourceSampler(
+    const FunctionCallbackInfo<Value>& args) {
+  CHECK(args[0]->IsUint32());
+  uint32_t interval = args[0].As<Uint32>()->Value();
+  CHECK_GT(interval, 0);
+  BindingData* binding = FromJSObject<BindingData>(args.This());
+  if (binding->resource_sampler_ == nullptr) {
+    binding->resource_sampler_ = new ResourceSampler(binding->env());
+  }
+  binding->resource_sampler_->Start(interval);
+  args.GetReturnValue().Set(binding->resource_sampler_->GetJSArray());
+}
+
+void BindingData::StopResourceSampler(
+    const FunctionCallbackInfo<Value>& args) {
+  BindingData* binding = FromJSObject<BindingData>(args.This());
+  if (binding->resource_sampler_ != nullptr) {
+    binding->resource_sampler_->Stop();
+  }
+}
+
 v8::CFunction BindingData::fast_number_(v8::CFunction::Make(FastNumber));
 v8::CFunction BindingData::fast_bigint_(v8::CFunction::Make(FastBigInt));
 
@@ -658,6 +805,8 @@ void BindingData::AddMethods(Isolate* isolate, Local<ObjectTemplate> target) {
       isolate, target, "hrtime", SlowNumber, &fast_number_);
   SetFastMethodNoSideEffect(
       isolate, target, "hrtimeBigInt", SlowBigInt, &fast_bigint_);
+  SetMethod(isolate, target, "startResourceSampler", StartResourceSampler);
+  SetMethod(isolate, target, "stopResourceSampler", StopResourceSampler);
 }
 
 void BindingData::RegisterExternalReferences(
@@ -668,6 +817,8 @@ void BindingData::RegisterExternalReferences(
   registry->Register(FastBigInt);
   registry->Register(fast_number_.GetTypeInfo());
   registry->Register(fast_bigint_.GetTypeInfo());
+  registry->Register(StartResourceSampler);
+  registry->Register(StopResourceSampler);
 }
 
 BindingData* BindingData::FromV8Value(Local<Value> value) {
@@ -717,6 +868,12 @@ void BindingData::SlowNumber(const v8::FunctionCallbackInfo<v8::Value>& args) {
 bool BindingData::PrepareForSerialization(Local<Context> context,
                                           v8::SnapshotCreator* creator) {
   DCHECK_NULL(internal_field_info_);
+  // The sampler's timer cannot be snapshotted. Code deserialized from the
+  // snapshot starts a new one.
+  if (resource_sampler_ != nullptr) {
+    resource_sampler_->Close();
+    resource_sampler_ = nullptr;
+  }
   internal_field_info_ = InternalFieldInfoBase::New<InternalFieldInfo>(type());
   internal_field_info_->hrtime_buffer =
       hrtime_buffer_.Serialize(context, creator);
@@ -767,10 +924,14 @@ static void CreatePerIsolateProperties(IsolateData* isolate_data,
   SetMethod(isolate, target, "memoryUsage", MemoryUsage);
   SetMethod(isolate, target, "constrainedMemory", GetConstrainedMemory);
   SetMethod(isolate, target, "availableMemory", GetAvailableMemory);
-  SetMethod(isolate, target, "rss", Rss);
-  SetMethod(isolate, target, "cpuUsage", CPUUsage);
+  SetFastMethod(isolate, target, "rss", Rss, &fast_rss);
+  SetFastMethod(isolate, target, "cpuUsage", CPUUsage, &fast_cpu_usage);
   SetMethod(isolate, target, "threadCpuUsage", ThreadCPUUsage);
   SetMethod(isolate, target, "resourceUsage", ResourceUsage);
+  SetMethod(
+      isolate, target, "_setThreadPoolWorkLimit", SetThreadPoolWorkLimit);
+  SetMethod(
+      isolate, target, "_getThreadPoolWorkStats", GetThreadPoolWorkStats);
 
   SetMethod(isolate, target, "_debugEnd", DebugEnd);
   SetMethod(isolate, target, "_getActiveRequests", GetActiveRequests);
@@ -800,6 +961,16 @@ static void CreatePerContextProperties(Local<Object> target,
                                        void* priv) {
   Realm* realm = Realm::GetCurrent(context);
   realm->AddBindingData<BindingData>(target);
+
+  NODE_DEFINE_CONSTANT(target, kSamplerRss);
+  NODE_DEFINE_CONSTANT(target, kSamplerHeapTotal);
+  NODE_DEFINE_CONSTANT(target, kSamplerHeapUsed);
+  NODE_DEFINE_CONSTANT(target, kSamplerExternal);
+  NODE_DEFINE_CONSTANT(target, kSamplerArrayBuffers);
+  NODE_DEFINE_CONSTANT(target, kSamplerUserCPU);
+  NODE_DEFINE_CONSTANT(target, kSamplerSystemCPU);
+  NODE_DEFINE_CONSTANT(target, kSamplerTimestamp);
+  NODE_DEFINE_CONSTANT(target, kSamplerFieldCount);
 }
 
 void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
@@ -817,9 +988,15 @@ void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(GetConstrainedMemory);
   registry->Register(GetAvailableMemory);
   registry->Register(Rss);
+  registry->Register(FastRss);
+  registry->Register(fast_rss.GetTypeInfo());
   registry->Register(CPUUsage);
+  registry->Register(FastCPUUsage);
+  registry->Register(fast_cpu_usage.GetTypeInfo());
   registry->Register(ThreadCPUUsage);
   registry->Register(ResourceUsage);
+  registry->Register(SetThreadPoolWorkLimit);
+  registry->Register(GetThreadPoolWorkStats);
 
   registry->Register(GetActiveRequests);
   registry->Register(GetActiveHandles);
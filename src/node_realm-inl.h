@@ -80,7 +80,12 @@ inline T* Realm::GetBindingData() {
   static_assert(binding_index < std::tuple_size_v<BindingDataStore>);
   auto ptr = binding_data_store_[binding_index];
   if (!ptr) [[unlikely]] {
-    return nullptr;
+    if (deferred_binding_data_[binding_index].cb == nullptr) {
+      return nullptr;
+    }
+    RunDeferredBindingDataDeserialization(binding_index);
+    ptr = binding_data_store_[binding_index];
+    if (!ptr) return nullptr;
   }
   T* result = static_cast<T*>(ptr.get());
   DCHECK_NOT_NULL(result);
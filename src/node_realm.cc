@@ -1,6 +1,7 @@
 #include "node_realm.h"
 #include "env-inl.h"
 
+#include "debug_utils-inl.h"
 #include "memory_tracker-inl.h"
 #include "node_builtins.h"
 #include "node_process.h"
@@ -84,6 +85,10 @@ void Realm::CreateProperties() {
 }
 
 RealmSerializeInfo Realm::Serialize(SnapshotCreator* creator) {
+  // Binding data deferred from a previous snapshot has to be serialized
+  // again, which needs the native objects.
+  RunDeferredBindingDataDeserialization();
+
   RealmSerializeInfo info;
   Local<Context> ctx = context();
 
@@ -210,11 +215,50 @@ void Realm::DoneBootstrapping() {
   base_object_created_by_bootstrap_ = base_object_count_;
 }
 
+void Realm::DeferBindingDataDeserialization(BindingDataType type,
+                                            DeserializeRequest&& request) {
+  size_t index = static_cast<size_t>(type);
+  CHECK_LT(index, deferred_binding_data_.size());
+  CHECK_NULL(deferred_binding_data_[index].cb);
+  CHECK(!binding_data_store_[index]);
+  deferred_binding_data_[index] = std::move(request);
+}
+
+void Realm::RunDeferredBindingDataDeserialization(size_t index) {
+  DeserializeRequest request(std::move(deferred_binding_data_[index]));
+  deferred_binding_data_[index].cb = nullptr;
+  per_process::Debug(DebugCategory::MKSNAPSHOT,
+                     "Running deferred deserialization of binding data %d\n",
+                     static_cast<int>(index));
+  HandleScope scope(isolate());
+  Local<Context> ctx = context();
+  Context::Scope context_scope(ctx);
+  request.cb(ctx, request.holder.Get(isolate()), request.index, request.info);
+  request.holder.Reset();
+  request.info->Delete();
+}
+
+void Realm::RunDeferredBindingDataDeserialization() {
+  for (size_t i = 0; i < deferred_binding_data_.size(); ++i) {
+    if (deferred_binding_data_[i].cb != nullptr) {
+      RunDeferredBindingDataDeserialization(i);
+    }
+  }
+}
+
 void Realm::RunCleanup() {
   TRACE_EVENT0(TRACING_CATEGORY_NODE1(realm), "RunCleanup");
   for (size_t i = 0; i < binding_data_store_.size(); ++i) {
     binding_data_store_[i].reset();
   }
+  // Binding data that was never looked up does not need to be restored.
+  for (auto& request : deferred_binding_data_) {
+    if (request.cb == nullptr) continue;
+    request.cb = nullptr;
+    request.holder.Reset();
+    request.info->Delete();
+    request.info = nullptr;
+  }
   base_object_list_.Cleanup();
 }
 
@@ -105,6 +105,14 @@ class Realm : public MemoryRetainer {
   inline T* GetBindingData();
   inline BindingDataStore* binding_data_store();
 
+  // Binding data restored from the snapshot can be deserialized when it is
+  // first looked up via GetBindingData<T>() instead of during startup.
+  void DeferBindingDataDeserialization(BindingDataType type,
+                                       DeserializeRequest&& request);
+  // Finishes all deferred binding data deserialization, e.g. before the
+  // realm is serialized again.
+  void RunDeferredBindingDataDeserialization();
+
   // The BaseObject count is a debugging helper that makes sure that there are
   // no memory leaks caused by BaseObjects staying alive longer than expected
   // (in particular, no circular BaseObjectPtr references).
@@ -122,6 +130,8 @@ class Realm : public MemoryRetainer {
   std::set<struct node_module*> internal_bindings;
   std::set<std::string> builtins_with_cache;
   std::set<std::string> builtins_without_cache;
+  // Only filled for the principal realm when --startup-profile is used.
+  std::vector<std::string> cjs_modules_compiled;
   // This is only filled during deserialization. We use a vector since
   // it's only used for tests.
   std::vector<std::string> builtins_in_snapshot;
@@ -151,7 +161,12 @@ class Realm : public MemoryRetainer {
   int64_t base_object_count_ = 0;
   int64_t base_object_created_by_bootstrap_ = 0;
 
+  void RunDeferredBindingDataDeserialization(size_t index);
+
   BindingDataStore binding_data_store_;
+  std::array<DeserializeRequest,
+             static_cast<size_t>(BindingDataType::kBindingDataTypeCount)>
+      deferred_binding_data_;
 
   BaseObjectList base_object_list_;
 };
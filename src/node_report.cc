@@ -62,7 +62,7 @@ static void WriteNodeReport(Isolate* isolate,
                             Local<Value> error,
                             bool compact,
                             bool exclude_network = false,
-                            bool exclude_env = false);
+                            uint32_t excluded_sections = 0);
 static void PrintVersionInformation(JSONWriter* writer,
                                     bool exclude_network = false);
 static void PrintJavaScriptErrorStack(JSONWriter* writer,
@@ -80,7 +80,7 @@ static void PrintNativeStack(JSONWriter* writer);
 static void PrintResourceUsage(JSONWriter* writer);
 static void PrintGCStatistics(JSONWriter* writer, Isolate* isolate);
 static void PrintEnvironmentVariables(JSONWriter* writer);
-static void PrintSystemInformation(JSONWriter* writer);
+static void PrintUserLimits(JSONWriter* writer);
 static void PrintLoadedLibraries(JSONWriter* writer);
 static void PrintComponentVersions(JSONWriter* writer);
 static void PrintRelease(JSONWriter* writer);
@@ -98,7 +98,32 @@ static void WriteNodeReport(Isolate* isolate,
                             Local<Value> error,
                             bool compact,
                             bool exclude_network,
-                            bool exclude_env) {
+                            uint32_t excluded_sections) {
+  auto included = [&](ReportSection section) {
+    return (excluded_sections & (1u << section)) == 0;
+  };
+
+  // Ask the workers for their subreports first, so that they are generated
+  // while this thread writes its own sections instead of afterwards.
+  Mutex workers_mutex;
+  ConditionVariable notify;
+  std::vector<std::string> worker_infos;
+  size_t expected_results = 0;
+  if (env != nullptr && included(kWorkers)) {
+    env->ForEachWorker([&](Worker* w) {
+      expected_results += w->RequestInterrupt([&](Environment* env) {
+        std::ostringstream os;
+
+        GetNodeReport(
+            env, "Worker thread subreport", trigger, Local<Value>(), os);
+
+        Mutex::ScopedLock lock(workers_mutex);
+        worker_infos.emplace_back(os.str());
+        notify.Signal(lock);
+      });
+    });
+  }
+
   // Obtain the current time and the pid.
   TIME_TYPE tm_struct;
   DiagnosticFilename::LocalTime(&tm_struct);
@@ -182,82 +207,66 @@ static void WriteNodeReport(Isolate* isolate,
   PrintVersionInformation(&writer, exclude_network);
   writer.json_objectend();
 
-  if (isolate != nullptr) {
+  if (included(kJavaScriptStack)) {
     writer.json_objectstart("javascriptStack");
-    // Report summary JavaScript error stack backtrace
-    PrintJavaScriptErrorStack(&writer, isolate, error, trigger);
-
+    if (isolate != nullptr) {
+      // Report summary JavaScript error stack backtrace
+      PrintJavaScriptErrorStack(&writer, isolate, error, trigger);
+    } else {
+      PrintEmptyJavaScriptStack(&writer);
+    }
     writer.json_objectend();  // the end of 'javascriptStack'
+  }
 
-    // Report V8 Heap and Garbage Collector information
+  // Report V8 Heap and Garbage Collector information
+  if (isolate != nullptr && included(kJavaScriptHeap))
     PrintGCStatistics(&writer, isolate);
-  } else {
-    writer.json_objectstart("javascriptStack");
-    PrintEmptyJavaScriptStack(&writer);
-    writer.json_objectend();  // the end of 'javascriptStack'
-  }
 
   // Report native stack backtrace
-  PrintNativeStack(&writer);
+  if (included(kNativeStack)) PrintNativeStack(&writer);
 
   // Report OS and current thread resource usage
-  PrintResourceUsage(&writer);
+  if (included(kResourceUsage)) PrintResourceUsage(&writer);
 
-  writer.json_arraystart("libuv");
-  if (env != nullptr) {
-    uv_walk(env->event_loop(),
-            exclude_network ? WalkHandleNoNetwork : WalkHandleNetwork,
-            static_cast<void*>(&writer));
-
-    writer.json_start();
-    writer.json_keyvalue("type", "loop");
-    writer.json_keyvalue("is_active",
-        static_cast<bool>(uv_loop_alive(env->event_loop())));
-    writer.json_keyvalue("address",
-        ValueToHexString(reinterpret_cast<int64_t>(env->event_loop())));
-
-    // Report Event loop idle time
-    uint64_t idle_time = uv_metrics_idle_time(env->event_loop());
-    writer.json_keyvalue("loopIdleTimeSeconds", 1.0 * idle_time / 1e9);
-    writer.json_end();
-  }
-
-  writer.json_arrayend();
-
-  writer.json_arraystart("workers");
-  if (env != nullptr) {
-    Mutex workers_mutex;
-    ConditionVariable notify;
-    std::vector<std::string> worker_infos;
-    size_t expected_results = 0;
-
-    env->ForEachWorker([&](Worker* w) {
-      expected_results += w->RequestInterrupt([&](Environment* env) {
-        std::ostringstream os;
-
-        GetNodeReport(
-            env, "Worker thread subreport", trigger, Local<Value>(), os);
+  // Walking the handles is the slowest part of a report for processes with
+  // many of them, so it can be excluded as a whole.
+  if (included(kLibuv)) {
+    writer.json_arraystart("libuv");
+    if (env != nullptr) {
+      uv_walk(env->event_loop(),
+              exclude_network ? WalkHandleNoNetwork : WalkHandleNetwork,
+              static_cast<void*>(&writer));
+
+      writer.json_start();
+      writer.json_keyvalue("type", "loop");
+      writer.json_keyvalue("is_active",
+          static_cast<bool>(uv_loop_alive(env->event_loop())));
+      writer.json_keyvalue("address",
+          ValueToHexString(reinterpret_cast<int64_t>(env->event_loop())));
+
+      // Report Event loop idle time
+      uint64_t idle_time = uv_metrics_idle_time(env->event_loop());
+      writer.json_keyvalue("loopIdleTimeSeconds", 1.0 * idle_time / 1e9);
+      writer.json_end();
+    }
 
-        Mutex::ScopedLock lock(workers_mutex);
-        worker_infos.emplace_back(os.str());
-        notify.Signal(lock);
-      });
-    });
+    writer.json_arrayend();
+  }
 
+  if (included(kWorkers)) {
+    writer.json_arraystart("workers");
     Mutex::ScopedLock lock(workers_mutex);
-    worker_infos.reserve(expected_results);
     while (worker_infos.size() < expected_results)
       notify.Wait(lock);
     for (const std::string& worker_info : worker_infos)
       writer.json_element(JSONWriter::ForeignJSON { worker_info });
+    writer.json_arrayend();
   }
-  writer.json_arrayend();
 
   // Report operating system information
-  if (exclude_env == false) {
-    PrintEnvironmentVariables(&writer);
-  }
-  PrintSystemInformation(&writer);
+  if (included(kEnvironmentVariables)) PrintEnvironmentVariables(&writer);
+  if (included(kUserLimits)) PrintUserLimits(&writer);
+  if (included(kSharedObjects)) PrintLoadedLibraries(&writer);
 
   writer.json_objectend();
 
@@ -728,8 +737,8 @@ static void PrintEnvironmentVariables(JSONWriter* writer) {
   writer->json_objectend();
 }
 
-// Report operating system information.
-static void PrintSystemInformation(JSONWriter* writer) {
+// Report the resource limits of the process.
+static void PrintUserLimits(JSONWriter* writer) {
 #ifndef _WIN32
   static struct {
     const char* description;
@@ -778,8 +787,6 @@ static void PrintSystemInformation(JSONWriter* writer) {
   }
   writer->json_objectend();
 #endif  // _WIN32
-
-  PrintLoadedLibraries(writer);
 }
 
 // Report a list of loaded native libraries.
@@ -842,6 +849,20 @@ static void PrintRelease(JSONWriter* writer) {
   writer->json_objectend();
 }
 
+// The options of |env|, or of the process when there is no Environment.
+static const EnvironmentOptions* GetReportOptions(Environment* env) {
+  return env != nullptr ? env->options().get()
+                        : per_process::cli_options->per_isolate->per_env.get();
+}
+
+static uint32_t GetExcludedSections(const EnvironmentOptions* options) {
+  // The option is validated on startup.
+  uint32_t sections =
+      ParseReportSections(options->report_exclude_sections).value_or(0);
+  if (options->report_exclude_env) sections |= 1u << kEnvironmentVariables;
+  return sections;
+}
+
 }  // namespace report
 
 std::string TriggerNodeReport(Isolate* isolate,
@@ -926,13 +947,7 @@ std::string TriggerNodeReport(Isolate* isolate,
     compact = per_process::cli_options->report_compact;
   }
 
-  bool exclude_network = env != nullptr ? env->options()->report_exclude_network
-                                        : per_process::cli_options->per_isolate
-                                              ->per_env->report_exclude_network;
-  bool exclude_env =
-      env != nullptr
-          ? env->report_exclude_env()
-          : per_process::cli_options->per_isolate->per_env->report_exclude_env;
+  const EnvironmentOptions* options = report::GetReportOptions(env);
 
   report::WriteNodeReport(isolate,
                           env,
@@ -942,8 +957,8 @@ std::string TriggerNodeReport(Isolate* isolate,
                           *outstream,
                           error,
                           compact,
-                          exclude_network,
-                          exclude_env);
+                          options->report_exclude_network,
+                          report::GetExcludedSections(options));
 
   // Do not close stdout/stderr, only close files we opened.
   if (outfile.is_open()) {
@@ -994,13 +1009,7 @@ void GetNodeReport(Isolate* isolate,
   if (isolate != nullptr) {
     env = Environment::GetCurrent(isolate);
   }
-  bool exclude_network = env != nullptr ? env->options()->report_exclude_network
-                                        : per_process::cli_options->per_isolate
-                                              ->per_env->report_exclude_network;
-  bool exclude_env =
-      env != nullptr
-          ? env->report_exclude_env()
-          : per_process::cli_options->per_isolate->per_env->report_exclude_env;
+  const EnvironmentOptions* options = report::GetReportOptions(env);
   report::WriteNodeReport(isolate,
                           env,
                           message,
@@ -1009,8 +1018,8 @@ void GetNodeReport(Isolate* isolate,
                           out,
                           error,
                           false,
-                          exclude_network,
-                          exclude_env);
+                          options->report_exclude_network,
+                          report::GetExcludedSections(options));
 }
 
 // External function to trigger a report, writing to a supplied stream.
@@ -1023,13 +1032,7 @@ void GetNodeReport(Environment* env,
   if (env != nullptr) {
     isolate = env->isolate();
   }
-  bool exclude_network = env != nullptr ? env->options()->report_exclude_network
-                                        : per_process::cli_options->per_isolate
-                                              ->per_env->report_exclude_network;
-  bool exclude_env =
-      env != nullptr
-          ? env->report_exclude_env()
-          : per_process::cli_options->per_isolate->per_env->report_exclude_env;
+  const EnvironmentOptions* options = report::GetReportOptions(env);
   report::WriteNodeReport(isolate,
                           env,
                           message,
@@ -1038,8 +1041,8 @@ void GetNodeReport(Environment* env,
                           out,
                           error,
                           false,
-                          exclude_network,
-                          exclude_env);
+                          options->report_exclude_network,
+                          report::GetExcludedSections(options));
 }
 
 }  // namespace node
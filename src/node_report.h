@@ -13,11 +13,39 @@
 #include <unistd.h>
 #endif
 
+#include <cstdint>
 #include <iomanip>
+#include <optional>
 #include <sstream>
+#include <string_view>
 
 namespace node {
 namespace report {
+
+// Top-level report sections that --report-exclude-sections can leave out,
+// by the key they are written under.
+#define REPORT_SECTIONS(V)                                                     \
+  V(kJavaScriptStack, "javascriptStack")                                       \
+  V(kJavaScriptHeap, "javascriptHeap")                                         \
+  V(kNativeStack, "nativeStack")                                               \
+  V(kResourceUsage, "resourceUsage")                                           \
+  V(kLibuv, "libuv")                                                           \
+  V(kWorkers, "workers")                                                       \
+  V(kEnvironmentVariables, "environmentVariables")                             \
+  V(kUserLimits, "userLimits")                                                 \
+  V(kSharedObjects, "sharedObjects")
+
+enum ReportSection : uint32_t {
+#define V(section, name) section,
+  REPORT_SECTIONS(V)
+#undef V
+};
+
+// Parses a comma-separated list of section names into a bitmask with bit
+// (1 << ReportSection) set for every listed section. Returns std::nullopt
+// for unknown names.
+std::optional<uint32_t> ParseReportSections(std::string_view list);
+
 // Function declarations - utility functions in src/node_report_utils.cc
 void WalkHandleNetwork(uv_handle_t* h, void* arg);
 void WalkHandleNoNetwork(uv_handle_t* h, void* arg);
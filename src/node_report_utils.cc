@@ -8,6 +8,26 @@ namespace report {
 
 static constexpr auto null = JSONWriter::Null{};
 
+std::optional<uint32_t> ParseReportSections(std::string_view list) {
+  uint32_t sections = 0;
+  while (!list.empty()) {
+    size_t comma = list.find(',');
+    std::string_view name = list.substr(0, comma);
+    list = comma == std::string_view::npos ? std::string_view()
+                                           : list.substr(comma + 1);
+    if (name.empty()) continue;
+#define V(section, section_name)                                               \
+    if (name == section_name) {                                                \
+      sections |= 1u << section;                                               \
+      continue;                                                                \
+    }
+    REPORT_SECTIONS(V)
+#undef V
+    return std::nullopt;
+  }
+  return sections;
+}
+
 // Utility function to format socket information.
 static void ReportEndpoint(uv_handle_t* h,
                            struct sockaddr* addr,
@@ -12,6 +12,7 @@
 #include "node_union_bytes.h"
 #include "node_v8_platform-inl.h"
 #include "util-inl.h"
+#include "zstd.h"
 
 // The POSTJECT_SENTINEL_FUSE macro is a string of random characters selected by
 // the Node.js project that is present only once in the entire binary. It is
@@ -28,6 +29,7 @@
 #include <vector>
 
 using node::ExitCode;
+using v8::Array;
 using v8::ArrayBuffer;
 using v8::BackingStore;
 using v8::Context;
@@ -113,13 +115,35 @@ size_t SeaSerializer::Write(const SeaResource& sea) {
   if (!sea.assets.empty()) {
     Debug("Write SEA resource assets size %zu\n", sea.assets.size());
     written_total += WriteArithmetic<size_t>(sea.assets.size());
-    for (auto const& [key, content] : sea.assets) {
+    bool compress = static_cast<bool>(sea.flags & SeaFlags::kCompressAssets);
+    for (auto const& [key, asset] : sea.assets) {
       Debug("Write SEA resource asset %s at %p, size=%zu\n",
             key,
-            content.data(),
-            content.size());
+            asset.data.data(),
+            asset.data.size());
       written_total += WriteStringView(key, StringLogMode::kAddressAndContent);
-      written_total += WriteStringView(content, StringLogMode::kAddressOnly);
+      written_total +=
+          WriteStringView(asset.data, StringLogMode::kAddressOnly);
+      if (compress) {
+        written_total += WriteArithmetic<size_t>(asset.size);
+      }
+    }
+  }
+
+  if (!sea.modules.empty()) {
+    Debug("Write SEA resource modules size %zu\n", sea.modules.size());
+    written_total += WriteArithmetic<size_t>(sea.modules.size());
+    for (auto const& [filename, module] : sea.modules) {
+      Debug("Write SEA resource module %s, size=%zu, code cache size=%zu\n",
+            filename,
+            module.source.size(),
+            module.code_cache.size());
+      written_total +=
+          WriteStringView(filename, StringLogMode::kAddressAndContent);
+      written_total +=
+          WriteStringView(module.source, StringLogMode::kAddressOnly);
+      written_total +=
+          WriteStringView(module.code_cache, StringLogMode::kAddressOnly);
     }
   }
   return written_total;
@@ -170,21 +194,45 @@ SeaResource SeaDeserializer::Read() {
           code_cache.size());
   }
 
-  std::unordered_map<std::string_view, std::string_view> assets;
+  std::unordered_map<std::string_view, SeaAsset> assets;
   if (static_cast<bool>(flags & SeaFlags::kIncludeAssets)) {
+    bool compressed = static_cast<bool>(flags & SeaFlags::kCompressAssets);
     size_t assets_size = ReadArithmetic<size_t>();
     Debug("Read SEA resource assets size %zu\n", assets_size);
+    assets.reserve(assets_size);
     for (size_t i = 0; i < assets_size; ++i) {
       std::string_view key = ReadStringView(StringLogMode::kAddressAndContent);
-      std::string_view content = ReadStringView(StringLogMode::kAddressOnly);
+      SeaAsset asset;
+      asset.data = ReadStringView(StringLogMode::kAddressOnly);
+      asset.size =
+          compressed ? ReadArithmetic<size_t>() : asset.data.size();
       Debug("Read SEA resource asset %s at %p, size=%zu\n",
             key,
-            content.data(),
-            content.size());
-      assets.emplace(key, content);
+            asset.data.data(),
+            asset.data.size());
+      assets.emplace(key, asset);
+    }
+  }
+
+  std::unordered_map<std::string_view, SeaModule> modules;
+  if (static_cast<bool>(flags & SeaFlags::kIncludeModules)) {
+    size_t modules_size = ReadArithmetic<size_t>();
+    Debug("Read SEA resource modules size %zu\n", modules_size);
+    modules.reserve(modules_size);
+    for (size_t i = 0; i < modules_size; ++i) {
+      std::string_view filename =
+          ReadStringView(StringLogMode::kAddressAndContent);
+      SeaModule module;
+      module.source = ReadStringView(StringLogMode::kAddressOnly);
+      module.code_cache = ReadStringView(StringLogMode::kAddressOnly);
+      Debug("Read SEA resource module %s, size=%zu, code cache size=%zu\n",
+            filename,
+            module.source.size(),
+            module.code_cache.size());
+      modules.emplace(filename, module);
     }
   }
-  return {flags, code_path, code, code_cache, assets};
+  return {flags, code_path, code, code_cache, assets, modules};
 }
 
 std::string_view FindSingleExecutableBlob() {
@@ -224,7 +272,7 @@ bool SeaResource::use_code_cache() const {
   return static_cast<bool>(flags & SeaFlags::kUseCodeCache);
 }
 
-SeaResource FindSingleExecutableResource() {
+const SeaResource& FindSingleExecutableResource() {
   static const SeaResource sea_resource = []() -> SeaResource {
     std::string_view blob = FindSingleExecutableBlob();
     per_process::Debug(DebugCategory::SEA,
@@ -237,6 +285,13 @@ SeaResource FindSingleExecutableResource() {
   return sea_resource;
 }
 
+const SeaModule* FindSingleExecutableModule(std::string_view filename) {
+  if (!IsSingleExecutable()) return nullptr;
+  const SeaResource& sea = FindSingleExecutableResource();
+  auto it = sea.modules.find(filename);
+  return it == sea.modules.end() ? nullptr : &it->second;
+}
+
 bool IsSingleExecutable() {
   return postject_has_resource();
 }
@@ -258,7 +313,7 @@ void IsExperimentalSeaWarningNeeded(const FunctionCallbackInfo<Value>& args) {
     return;
   }
 
-  SeaResource sea_resource = FindSingleExecutableResource();
+  const SeaResource& sea_resource = FindSingleExecutableResource();
   args.GetReturnValue().Set(!static_cast<bool>(
       sea_resource.flags & SeaFlags::kDisableExperimentalSeaWarning));
 }
@@ -286,6 +341,7 @@ struct SeaConfig {
   std::string output_path;
   SeaFlags flags = SeaFlags::kDefault;
   std::unordered_map<std::string, std::string> assets;
+  std::unordered_map<std::string, std::string> modules;
 };
 
 std::optional<SeaConfig> ParseSingleExecutableConfig(
@@ -377,6 +433,29 @@ std::optional<SeaConfig> ParseSingleExecutableConfig(
     result.assets = std::move(assets_opt.value());
   }
 
+  std::optional<bool> compress_assets =
+      parser.GetTopLevelBoolField("compressAssets");
+  if (!compress_assets.has_value()) {
+    FPrintF(stderr,
+            "\"compressAssets\" field of %s is not a Boolean\n",
+            config_path);
+    return std::nullopt;
+  }
+  if (compress_assets.value() && !result.assets.empty()) {
+    result.flags |= SeaFlags::kCompressAssets;
+  }
+
+  auto modules_opt = parser.GetTopLevelStringDict("modules");
+  if (!modules_opt.has_value()) {
+    FPrintF(stderr,
+            "\"modules\" field of %s is not a map of strings\n",
+            config_path);
+    return std::nullopt;
+  } else if (!modules_opt.value().empty()) {
+    result.flags |= SeaFlags::kIncludeModules;
+    result.modules = std::move(modules_opt.value());
+  }
+
   return result;
 }
 
@@ -419,17 +498,12 @@ ExitCode GenerateSnapshotForSEA(const SeaConfig& config,
   return ExitCode::kNoFailure;
 }
 
-std::optional<std::string> GenerateCodeCache(std::string_view main_path,
+std::optional<std::string> GenerateCodeCache(Local<Context> context,
+                                             std::string_view main_path,
                                              std::string_view main_script) {
-  RAIIIsolate raii_isolate(SnapshotBuilder::GetEmbeddedSnapshotData());
-  Isolate* isolate = raii_isolate.get();
-
-  v8::Isolate::Scope isolate_scope(isolate);
+  Isolate* isolate = context->GetIsolate();
   HandleScope handle_scope(isolate);
 
-  Local<Context> context = Context::New(isolate);
-  Context::Scope context_scope(context);
-
   errors::PrinterTryCatch bootstrapCatch(
       isolate, errors::PrinterTryCatch::kPrintSourceLine);
 
@@ -476,8 +550,70 @@ std::optional<std::string> GenerateCodeCache(std::string_view main_path,
   return code_cache;
 }
 
+std::optional<std::string> GenerateCodeCache(std::string_view main_path,
+                                             std::string_view main_script) {
+  RAIIIsolate raii_isolate(SnapshotBuilder::GetEmbeddedSnapshotData());
+  Isolate* isolate = raii_isolate.get();
+
+  v8::Isolate::Scope isolate_scope(isolate);
+  HandleScope handle_scope(isolate);
+
+  Local<Context> context = Context::New(isolate);
+  Context::Scope context_scope(context);
+  return GenerateCodeCache(context, main_path, main_script);
+}
+
+struct BuiltModule {
+  std::string source;
+  std::string code_cache;
+};
+
+// Reads every module in the config and, if requested, compiles the CommonJS
+// ones to produce their code cache. All of them share one isolate.
+int BuildModules(const std::unordered_map<std::string, std::string>& config,
+                 bool use_code_cache,
+                 std::unordered_map<std::string, BuiltModule>* modules) {
+  for (auto const& [filename, path] : config) {
+    BuiltModule module;
+    int r = ReadFileSync(&module.source, path.c_str());
+    if (r != 0) {
+      const char* err = uv_strerror(r);
+      FPrintF(stderr, "Cannot read module %s: %s\n", path.c_str(), err);
+      return r;
+    }
+    modules->emplace(filename, std::move(module));
+  }
+
+  if (!use_code_cache) return 0;
+
+  RAIIIsolate raii_isolate(SnapshotBuilder::GetEmbeddedSnapshotData());
+  Isolate* isolate = raii_isolate.get();
+  v8::Isolate::Scope isolate_scope(isolate);
+  HandleScope handle_scope(isolate);
+  Local<Context> context = Context::New(isolate);
+  Context::Scope context_scope(context);
+
+  for (auto& [filename, module] : *modules) {
+    if (!filename.ends_with(".js") && !filename.ends_with(".cjs")) continue;
+    std::optional<std::string> code_cache =
+        GenerateCodeCache(context, filename, module.source);
+    if (!code_cache.has_value()) {
+      FPrintF(stderr, "Cannot generate V8 code cache for %s\n", filename);
+      return UV_EINVAL;
+    }
+    module.code_cache = std::move(code_cache.value());
+  }
+  return 0;
+}
+
+struct BuiltAsset {
+  std::string data;
+  size_t size;
+};
+
 int BuildAssets(const std::unordered_map<std::string, std::string>& config,
-                std::unordered_map<std::string, std::string>* assets) {
+                bool compress,
+                std::unordered_map<std::string, BuiltAsset>* assets) {
   for (auto const& [key, path] : config) {
     std::string blob;
     int r = ReadFileSync(&blob, path.c_str());
@@ -486,7 +622,22 @@ int BuildAssets(const std::unordered_map<std::string, std::string>& config,
       FPrintF(stderr, "Cannot read asset %s: %s\n", path.c_str(), err);
       return r;
     }
-    assets->emplace(key, std::move(blob));
+    size_t size = blob.size();
+    if (compress && size > 0) {
+      std::string compressed(ZSTD_compressBound(size), '\0');
+      size_t compressed_size = ZSTD_compress(compressed.data(),
+                                             compressed.size(),
+                                             blob.data(),
+                                             size,
+                                             ZSTD_CLEVEL_DEFAULT);
+      // Keep the asset uncompressed if compression does not pay off, so
+      // that it can still be handed out without a copy.
+      if (!ZSTD_isError(compressed_size) && compressed_size < size) {
+        compressed.resize(compressed_size);
+        blob = std::move(compressed);
+      }
+    }
+    assets->emplace(key, BuiltAsset{std::move(blob), size});
   }
   return 0;
 }
@@ -531,13 +682,28 @@ ExitCode GenerateSingleExecutableBlob(
     optional_sv_code_cache = code_cache;
   }
 
-  std::unordered_map<std::string, std::string> assets;
-  if (!config.assets.empty() && BuildAssets(config.assets, &assets) != 0) {
+  std::unordered_map<std::string, BuiltAsset> assets;
+  if (!config.assets.empty() &&
+      BuildAssets(config.assets,
+                  static_cast<bool>(config.flags & SeaFlags::kCompressAssets),
+                  &assets) != 0) {
+    return ExitCode::kGenericUserError;
+  }
+  std::unordered_map<std::string_view, SeaAsset> assets_view;
+  for (auto const& [key, asset] : assets) {
+    assets_view.emplace(key, SeaAsset{asset.data, asset.size});
+  }
+
+  std::unordered_map<std::string, BuiltModule> modules;
+  if (!config.modules.empty() &&
+      BuildModules(config.modules,
+                   static_cast<bool>(config.flags & SeaFlags::kUseCodeCache),
+                   &modules) != 0) {
     return ExitCode::kGenericUserError;
   }
-  std::unordered_map<std::string_view, std::string_view> assets_view;
-  for (auto const& [key, content] : assets) {
-    assets_view.emplace(key, content);
+  std::unordered_map<std::string_view, SeaModule> modules_view;
+  for (auto const& [filename, module] : modules) {
+    modules_view.emplace(filename, SeaModule{module.source, module.code_cache});
   }
   SeaResource sea{
       config.flags,
@@ -546,7 +712,8 @@ ExitCode GenerateSingleExecutableBlob(
           ? std::string_view{snapshot_blob.data(), snapshot_blob.size()}
           : std::string_view{main_script.data(), main_script.size()},
       optional_sv_code_cache,
-      assets_view};
+      assets_view,
+      modules_view};
 
   SeaSerializer serializer;
   serializer.Write(sea);
@@ -581,11 +748,42 @@ ExitCode BuildSingleExecutableBlob(const std::string& config_path,
   return ExitCode::kGenericUserError;
 }
 
+namespace {
+// Compressed assets are decompressed on first access and the result is
+// shared by every later getAsset() call in the process, from any thread.
+Mutex decompressed_assets_mutex;
+std::unordered_map<const char*, std::shared_ptr<BackingStore>>
+    decompressed_assets;
+
+std::shared_ptr<BackingStore> GetDecompressedAsset(const SeaAsset& asset) {
+  Mutex::ScopedLock lock(decompressed_assets_mutex);
+  auto it = decompressed_assets.find(asset.data.data());
+  if (it != decompressed_assets.end()) return it->second;
+
+  char* data = UncheckedMalloc(asset.size);
+  if (data == nullptr) return nullptr;
+  size_t result = ZSTD_decompress(
+      data, asset.size, asset.data.data(), asset.data.size());
+  // The blob was produced by BuildAssets(), so a mismatch means that it has
+  // been corrupted.
+  CHECK(!ZSTD_isError(result));
+  CHECK_EQ(result, asset.size);
+
+  std::shared_ptr<BackingStore> store = ArrayBuffer::NewBackingStore(
+      data,
+      asset.size,
+      [](void* data, size_t, void*) { free(data); },
+      nullptr);
+  decompressed_assets.emplace(asset.data.data(), store);
+  return store;
+}
+}  // anonymous namespace
+
 void GetAsset(const FunctionCallbackInfo<Value>& args) {
   CHECK_EQ(args.Length(), 1);
   CHECK(args[0]->IsString());
   Utf8Value key(args.GetIsolate(), args[0]);
-  SeaResource sea_resource = FindSingleExecutableResource();
+  const SeaResource& sea_resource = FindSingleExecutableResource();
   if (sea_resource.assets.empty()) {
     return;
   }
@@ -593,24 +791,62 @@ void GetAsset(const FunctionCallbackInfo<Value>& args) {
   if (it == sea_resource.assets.end()) {
     return;
   }
+  const SeaAsset& asset = it->second;
+  if (asset.compressed()) {
+    std::shared_ptr<BackingStore> store = GetDecompressedAsset(asset);
+    if (!store) {
+      return THROW_ERR_MEMORY_ALLOCATION_FAILED(args.GetIsolate());
+    }
+    args.GetReturnValue().Set(ArrayBuffer::New(args.GetIsolate(), store));
+    return;
+  }
   // We cast away the constness here, the JS land should ensure that
   // the data is not mutated.
-  std::unique_ptr<v8::BackingStore> store = ArrayBuffer::NewBackingStore(
-      const_cast<char*>(it->second.data()),
-      it->second.size(),
+  std::unique_ptr<BackingStore> store = ArrayBuffer::NewBackingStore(
+      const_cast<char*>(asset.data.data()),
+      asset.data.size(),
       [](void*, size_t, void*) {},
       nullptr);
   Local<ArrayBuffer> ab = ArrayBuffer::New(args.GetIsolate(), std::move(store));
   args.GetReturnValue().Set(ab);
 }
 
+void GetAssetKeys(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = args.GetIsolate();
+  Local<Context> context = isolate->GetCurrentContext();
+  const SeaResource& sea_resource = FindSingleExecutableResource();
+  LocalVector<Value> keys(isolate);
+  keys.reserve(sea_resource.assets.size());
+  for (auto const& [key, asset] : sea_resource.assets) {
+    Local<Value> key_str;
+    if (!ToV8Value(context, key).ToLocal(&key_str)) return;
+    keys.push_back(key_str);
+  }
+  args.GetReturnValue().Set(Array::New(isolate, keys.data(), keys.size()));
+}
+
+// Returns the source of a bundled module, or undefined. The CommonJS loader
+// consults this before the file system.
+void GetModuleSource(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args[0]->IsString());
+  Isolate* isolate = args.GetIsolate();
+  Utf8Value filename(isolate, args[0]);
+  const SeaModule* module = FindSingleExecutableModule(filename.ToStringView());
+  if (module == nullptr) return;
+  Local<Value> source;
+  if (ToV8Value(isolate->GetCurrentContext(), module->source)
+          .ToLocal(&source)) {
+    args.GetReturnValue().Set(source);
+  }
+}
+
 MaybeLocal<Value> LoadSingleExecutableApplication(
     const StartExecutionCallbackInfo& info) {
   // Here we are currently relying on the fact that in NodeMainInstance::Run(),
   // env->context() is entered.
   Local<Context> context = Isolate::GetCurrent()->GetCurrentContext();
   Environment* env = Environment::GetCurrent(context);
-  SeaResource sea = FindSingleExecutableResource();
+  const SeaResource& sea = FindSingleExecutableResource();
 
   CHECK(!sea.use_snapshot());
   // TODO(joyeecheung): this should be an external string. Refactor UnionBytes
@@ -627,7 +863,7 @@ bool MaybeLoadSingleExecutableApplication(Environment* env) {
     return false;
   }
 
-  SeaResource sea = FindSingleExecutableResource();
+  const SeaResource& sea = FindSingleExecutableResource();
 
   if (sea.use_snapshot()) {
     // The SEA preparation blob building process should already enforce this,
@@ -655,12 +891,16 @@ void Initialize(Local<Object> target,
             "isExperimentalSeaWarningNeeded",
             IsExperimentalSeaWarningNeeded);
   SetMethod(context, target, "getAsset", GetAsset);
+  SetMethod(context, target, "getAssetKeys", GetAssetKeys);
+  SetMethod(context, target, "getModuleSource", GetModuleSource);
 }
 
 void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(IsSea);
   registry->Register(IsExperimentalSeaWarningNeeded);
   registry->Register(GetAsset);
+  registry->Register(GetAssetKeys);
+  registry->Register(GetModuleSource);
 }
 
 }  // namespace sea
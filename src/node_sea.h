@@ -28,6 +28,27 @@ enum class SeaFlags : uint32_t {
   kUseSnapshot = 1 << 1,
   kUseCodeCache = 1 << 2,
   kIncludeAssets = 1 << 3,
+  kCompressAssets = 1 << 4,
+  kIncludeModules = 1 << 5,
+};
+
+struct SeaAsset {
+  // The asset as stored in the blob, possibly zstd-compressed.
+  std::string_view data;
+  // The size of the asset once decompressed. Assets are only stored
+  // compressed when that makes them smaller, so a size that differs from
+  // data.size() marks a compressed asset.
+  size_t size = 0;
+
+  bool compressed() const { return data.size() != size; }
+};
+
+// A CommonJS module or package.json file bundled into the executable, so
+// that loading it does not touch the disk.
+struct SeaModule {
+  std::string_view source;
+  // V8 code cache for the module wrapper, empty if there is none.
+  std::string_view code_cache;
 };
 
 struct SeaResource {
@@ -35,7 +56,9 @@ struct SeaResource {
   std::string_view code_path;
   std::string_view main_code_or_snapshot;
   std::optional<std::string_view> code_cache;
-  std::unordered_map<std::string_view, std::string_view> assets;
+  std::unordered_map<std::string_view, SeaAsset> assets;
+  // Keyed by the filename the module is loaded as.
+  std::unordered_map<std::string_view, SeaModule> modules;
 
   bool use_snapshot() const;
   bool use_code_cache() const;
@@ -44,7 +67,10 @@ struct SeaResource {
 };
 
 bool IsSingleExecutable();
-SeaResource FindSingleExecutableResource();
+const SeaResource& FindSingleExecutableResource();
+// Returns the embedded module with the given filename, or nullptr if this is
+// not a single executable application or the module is not bundled.
+const SeaModule* FindSingleExecutableModule(std::string_view filename);
 std::tuple<int, char**> FixupArgsForSEA(int argc, char** argv);
 node::ExitCode BuildSingleExecutableBlob(
     const std::string& config_path,
@@ -4,15 +4,23 @@
 #include "node_external_reference.h"
 #include "node_internals.h"
 #include "util-inl.h"
+#include "v8-fast-api-calls.h"
+
+#include <optional>
 
 namespace node {
 
 using v8::Array;
 using v8::ArrayBuffer;
+using v8::BackingStore;
+using v8::CFunction;
 using v8::Context;
+using v8::FastApiCallbackOptions;
 using v8::Function;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
+using v8::Global;
+using v8::HandleScope;
 using v8::Integer;
 using v8::Isolate;
 using v8::Just;
@@ -41,6 +49,10 @@ class SerializerContext : public BaseObject,
   Maybe<bool> WriteHostObject(Isolate* isolate, Local<Object> object) override;
   Maybe<uint32_t> GetSharedArrayBufferId(
       Isolate* isolate, Local<SharedArrayBuffer> shared_array_buffer) override;
+  void* ReallocateBufferMemory(void* old_buffer,
+                               size_t size,
+                               size_t* actual_size) override;
+  void FreeBufferMemory(void* buffer) override;
 
   static void SetTreatArrayBufferViewsAsHostObjects(
       const FunctionCallbackInfo<Value>& args);
@@ -49,18 +61,49 @@ class SerializerContext : public BaseObject,
   static void WriteHeader(const FunctionCallbackInfo<Value>& args);
   static void WriteValue(const FunctionCallbackInfo<Value>& args);
   static void ReleaseBuffer(const FunctionCallbackInfo<Value>& args);
+  static void SetOutputBuffer(const FunctionCallbackInfo<Value>& args);
+  static void Reset(const FunctionCallbackInfo<Value>& args);
   static void TransferArrayBuffer(const FunctionCallbackInfo<Value>& args);
   static void WriteUint32(const FunctionCallbackInfo<Value>& args);
+  static void FastWriteUint32(Local<Value> receiver, uint32_t value);
   static void WriteUint64(const FunctionCallbackInfo<Value>& args);
+  static void FastWriteUint64(Local<Value> receiver, uint32_t hi, uint32_t lo);
   static void WriteDouble(const FunctionCallbackInfo<Value>& args);
+  static void FastWriteDouble(Local<Value> receiver, double value);
   static void WriteRawBytes(const FunctionCallbackInfo<Value>& args);
 
+  static CFunction fast_write_uint32_;
+  static CFunction fast_write_uint64_;
+  static CFunction fast_write_double_;
+
   SET_NO_MEMORY_INFO()
   SET_MEMORY_INFO_NAME(SerializerContext)
   SET_SELF_SIZE(SerializerContext)
 
  private:
-  ValueSerializer serializer_;
+  // Returns the start of the buffer set by setOutputBuffer(), or nullptr.
+  uint8_t* output_data() const {
+    if (!output_store_) return nullptr;
+    return static_cast<uint8_t*>(output_store_->Data()) + output_offset_;
+  }
+  void ClearOutputBuffer();
+
+  bool treat_array_buffer_views_as_host_objects_ = false;
+  // Whether the serializer currently holds a buffer.
+  bool has_buffer_ = false;
+
+  // The memory of the buffer set by setOutputBuffer(), which the serializer
+  // writes into for as long as the output fits.
+  Global<ArrayBuffer> output_buffer_;
+  std::shared_ptr<BackingStore> output_store_;
+  size_t output_offset_ = 0;
+  size_t output_length_ = 0;
+
+  // Recreated by reset(), so that the object identities of values written
+  // before are not referenced by the values written after. This is declared
+  // last because its destructor calls FreeBufferMemory(), which looks at the
+  // output buffer.
+  std::optional<ValueSerializer> serializer_;
 };
 
 class DeserializerContext : public BaseObject,
@@ -80,10 +123,17 @@ class DeserializerContext : public BaseObject,
   static void TransferArrayBuffer(const FunctionCallbackInfo<Value>& args);
   static void GetWireFormatVersion(const FunctionCallbackInfo<Value>& args);
   static void ReadUint32(const FunctionCallbackInfo<Value>& args);
+  static uint32_t FastReadUint32(Local<Value> receiver,
+                                 FastApiCallbackOptions& options);
   static void ReadUint64(const FunctionCallbackInfo<Value>& args);
   static void ReadDouble(const FunctionCallbackInfo<Value>& args);
+  static double FastReadDouble(Local<Value> receiver,
+                               FastApiCallbackOptions& options);
   static void ReadRawBytes(const FunctionCallbackInfo<Value>& args);
 
+  static CFunction fast_read_uint32_;
+  static CFunction fast_read_double_;
+
   SET_NO_MEMORY_INFO()
   SET_MEMORY_INFO_NAME(DeserializerContext)
   SET_SELF_SIZE(DeserializerContext)
@@ -95,12 +145,64 @@ class DeserializerContext : public BaseObject,
   ValueDeserializer deserializer_;
 };
 
+CFunction SerializerContext::fast_write_uint32_(
+    CFunction::Make(&SerializerContext::FastWriteUint32));
+CFunction SerializerContext::fast_write_uint64_(
+    CFunction::Make(&SerializerContext::FastWriteUint64));
+CFunction SerializerContext::fast_write_double_(
+    CFunction::Make(&SerializerContext::FastWriteDouble));
+CFunction DeserializerContext::fast_read_uint32_(
+    CFunction::Make(&DeserializerContext::FastReadUint32));
+CFunction DeserializerContext::fast_read_double_(
+    CFunction::Make(&DeserializerContext::FastReadDouble));
+
 SerializerContext::SerializerContext(Environment* env, Local<Object> wrap)
-  : BaseObject(env, wrap),
-    serializer_(env->isolate(), this) {
+  : BaseObject(env, wrap) {
+  serializer_.emplace(env->isolate(), this);
   MakeWeak();
 }
 
+void* SerializerContext::ReallocateBufferMemory(void* old_buffer,
+                                                size_t size,
+                                                size_t* actual_size) {
+  uint8_t* output = output_data();
+  if (output != nullptr && (old_buffer == nullptr || old_buffer == output)) {
+    if (size <= output_length_) {
+      has_buffer_ = true;
+      *actual_size = output_length_;
+      return output;
+    }
+    // The value outgrew the output buffer, continue in memory of our own.
+    // The serializer only ever grows its buffer, so the whole output buffer
+    // is in use at this point if old_buffer is set.
+    void* data = malloc(size);
+    if (data == nullptr) return nullptr;
+    if (old_buffer != nullptr) memcpy(data, old_buffer, output_length_);
+    has_buffer_ = true;
+    *actual_size = size;
+    return data;
+  }
+
+  // Note: ReleaseBuffer() relies on this being allocated with malloc().
+  void* data = realloc(old_buffer, size);
+  if (data == nullptr) return nullptr;
+  has_buffer_ = true;
+  *actual_size = size;
+  return data;
+}
+
+void SerializerContext::FreeBufferMemory(void* buffer) {
+  has_buffer_ = false;
+  if (buffer != output_data()) free(buffer);
+}
+
+void SerializerContext::ClearOutputBuffer() {
+  output_buffer_.Reset();
+  output_store_.reset();
+  output_offset_ = 0;
+  output_length_ = 0;
+}
+
 void SerializerContext::ThrowDataCloneError(Local<String> message) {
   Local<Value> args[1] = { message };
   Local<Value> get_data_clone_error;
@@ -183,14 +285,14 @@ void SerializerContext::New(const FunctionCallbackInfo<Value>& args) {
 void SerializerContext::WriteHeader(const FunctionCallbackInfo<Value>& args) {
   SerializerContext* ctx;
   ASSIGN_OR_RETURN_UNWRAP(&ctx, args.This());
-  ctx->serializer_.WriteHeader();
+  ctx->serializer_->WriteHeader();
 }
 
 void SerializerContext::WriteValue(const FunctionCallbackInfo<Value>& args) {
   SerializerContext* ctx;
   ASSIGN_OR_RETURN_UNWRAP(&ctx, args.This());
   bool ret;
-  if (ctx->serializer_.WriteValue(ctx->env()->context(), args[0]).To(&ret)) {
+  if (ctx->serializer_->WriteValue(ctx->env()->context(), args[0]).To(&ret)) {
     args.GetReturnValue().Set(ret);
   }
 }
@@ -201,23 +303,80 @@ void SerializerContext::SetTreatArrayBufferViewsAsHostObjects(
   ASSIGN_OR_RETURN_UNWRAP(&ctx, args.This());
 
   bool value = args[0]->BooleanValue(ctx->env()->isolate());
-  ctx->serializer_.SetTreatArrayBufferViewsAsHostObjects(value);
+  ctx->treat_array_buffer_views_as_host_objects_ = value;
+  ctx->serializer_->SetTreatArrayBufferViewsAsHostObjects(value);
 }
 
 void SerializerContext::ReleaseBuffer(const FunctionCallbackInfo<Value>& args) {
   SerializerContext* ctx;
   ASSIGN_OR_RETURN_UNWRAP(&ctx, args.This());
 
-  // Note: Both ValueSerializer and this Buffer::New() variant use malloc()
-  // as the underlying allocator.
-  std::pair<uint8_t*, size_t> ret = ctx->serializer_.Release();
+  std::pair<uint8_t*, size_t> ret = ctx->serializer_->Release();
+  ctx->has_buffer_ = false;
   Local<Object> buf;
+
+  // If everything fit into the buffer passed to setOutputBuffer(), return a
+  // view of it. After this, the output buffer has to be set again.
+  if (ret.first != nullptr && ret.first == ctx->output_data()) {
+    Local<ArrayBuffer> ab = ctx->output_buffer_.Get(ctx->env()->isolate());
+    size_t offset = ctx->output_offset_;
+    ctx->ClearOutputBuffer();
+    if (Buffer::New(ctx->env(), ab, offset, ret.second).ToLocal(&buf)) {
+      args.GetReturnValue().Set(buf);
+    }
+    return;
+  }
+  ctx->ClearOutputBuffer();
+
+  // Note: Both ReallocateBufferMemory() and this Buffer::New() variant use
+  // malloc() as the underlying allocator.
   if (Buffer::New(ctx->env(), reinterpret_cast<char*>(ret.first), ret.second)
           .ToLocal(&buf)) {
     args.GetReturnValue().Set(buf);
   }
 }
 
+// serializer.setOutputBuffer(view)
+// The next value is written straight into the memory of `view`. If it does
+// not fit, the serializer moves on to memory of its own and releaseBuffer()
+// returns a new Buffer instead of a view of `view`.
+void SerializerContext::SetOutputBuffer(
+    const FunctionCallbackInfo<Value>& args) {
+  SerializerContext* ctx;
+  ASSIGN_OR_RETURN_UNWRAP(&ctx, args.This());
+
+  if (!args[0]->IsArrayBufferView()) {
+    return node::THROW_ERR_INVALID_ARG_TYPE(
+        ctx->env(), "buffer must be a TypedArray or a DataView");
+  }
+  if (ctx->has_buffer_) {
+    return node::THROW_ERR_INVALID_STATE(
+        ctx->env(), "The output buffer must be set before writing");
+  }
+
+  Local<v8::ArrayBufferView> view = args[0].As<v8::ArrayBufferView>();
+  Local<ArrayBuffer> ab = view->Buffer();
+  ctx->output_buffer_.Reset(ctx->env()->isolate(), ab);
+  ctx->output_store_ = ab->GetBackingStore();
+  ctx->output_offset_ = view->ByteOffset();
+  ctx->output_length_ = view->ByteLength();
+  if (ctx->output_length_ == 0) ctx->ClearOutputBuffer();
+}
+
+// serializer.reset()
+// Discards any pending output and the state of previously written values,
+// so that the serializer can be reused for an unrelated value.
+void SerializerContext::Reset(const FunctionCallbackInfo<Value>& args) {
+  SerializerContext* ctx;
+  ASSIGN_OR_RETURN_UNWRAP(&ctx, args.This());
+
+  ctx->serializer_.reset();
+  ctx->ClearOutputBuffer();
+  ctx->serializer_.emplace(ctx->env()->isolate(), ctx);
+  ctx->serializer_->SetTreatArrayBufferViewsAsHostObjects(
+      ctx->treat_array_buffer_views_as_host_objects_);
+}
+
 void SerializerContext::TransferArrayBuffer(
     const FunctionCallbackInfo<Value>& args) {
   SerializerContext* ctx;
@@ -234,7 +393,7 @@ void SerializerContext::TransferArrayBuffer(
   }
 
   Local<ArrayBuffer> ab = args[1].As<ArrayBuffer>();
-  ctx->serializer_.TransferArrayBuffer(id, ab);
+  ctx->serializer_->TransferArrayBuffer(id, ab);
 }
 
 void SerializerContext::WriteUint32(const FunctionCallbackInfo<Value>& args) {
@@ -243,10 +402,17 @@ void SerializerContext::WriteUint32(const FunctionCallbackInfo<Value>& args) {
 
   uint32_t value;
   if (args[0]->Uint32Value(ctx->env()->context()).To(&value)) {
-    ctx->serializer_.WriteUint32(value);
+    ctx->serializer_->WriteUint32(value);
   }
 }
 
+void SerializerContext::FastWriteUint32(Local<Value> receiver,
+                                        uint32_t value) {
+  SerializerContext* ctx;
+  ASSIGN_OR_RETURN_UNWRAP(&ctx, receiver);
+  ctx->serializer_->WriteUint32(value);
+}
+
 void SerializerContext::WriteUint64(const FunctionCallbackInfo<Value>& args) {
   SerializerContext* ctx;
   ASSIGN_OR_RETURN_UNWRAP(&ctx, args.This());
@@ -261,7 +427,15 @@ void SerializerContext::WriteUint64(const FunctionCallbackInfo<Value>& args) {
 
   uint64_t hiu64 = hi;
   uint64_t lou64 = lo;
-  ctx->serializer_.WriteUint64((hiu64 << 32) | lou64);
+  ctx->serializer_->WriteUint64((hiu64 << 32) | lou64);
+}
+
+void SerializerContext::FastWriteUint64(Local<Value> receiver,
+                                        uint32_t hi,
+                                        uint32_t lo) {
+  SerializerContext* ctx;
+  ASSIGN_OR_RETURN_UNWRAP(&ctx, receiver);
+  ctx->serializer_->WriteUint64((static_cast<uint64_t>(hi) << 32) | lo);
 }
 
 void SerializerContext::WriteDouble(const FunctionCallbackInfo<Value>& args) {
@@ -270,10 +444,16 @@ void SerializerContext::WriteDouble(const FunctionCallbackInfo<Value>& args) {
 
   double value;
   if (args[0]->NumberValue(ctx->env()->context()).To(&value)) {
-    ctx->serializer_.WriteDouble(value);
+    ctx->serializer_->WriteDouble(value);
   }
 }
 
+void SerializerContext::FastWriteDouble(Local<Value> receiver, double value) {
+  SerializerContext* ctx;
+  ASSIGN_OR_RETURN_UNWRAP(&ctx, receiver);
+  ctx->serializer_->WriteDouble(value);
+}
+
 void SerializerContext::WriteRawBytes(const FunctionCallbackInfo<Value>& args) {
   SerializerContext* ctx;
   ASSIGN_OR_RETURN_UNWRAP(&ctx, args.This());
@@ -284,7 +464,7 @@ void SerializerContext::WriteRawBytes(const FunctionCallbackInfo<Value>& args) {
   }
 
   ArrayBufferViewContents<char> bytes(args[0]);
-  ctx->serializer_.WriteRawBytes(bytes.data(), bytes.length());
+  ctx->serializer_->WriteRawBytes(bytes.data(), bytes.length());
 }
 
 DeserializerContext::DeserializerContext(Environment* env,
@@ -406,6 +586,20 @@ void DeserializerContext::ReadUint32(const FunctionCallbackInfo<Value>& args) {
   return args.GetReturnValue().Set(value);
 }
 
+uint32_t DeserializerContext::FastReadUint32(Local<Value> receiver,
+                                             FastApiCallbackOptions& options) {
+  DeserializerContext* ctx;
+  ASSIGN_OR_RETURN_UNWRAP(&ctx, receiver, 0);
+
+  uint32_t value;
+  if (!ctx->deserializer_.ReadUint32(&value)) {
+    HandleScope scope(options.isolate);
+    ctx->env()->ThrowError("ReadUint32() failed");
+    return 0;
+  }
+  return value;
+}
+
 void DeserializerContext::ReadUint64(const FunctionCallbackInfo<Value>& args) {
   DeserializerContext* ctx;
   ASSIGN_OR_RETURN_UNWRAP(&ctx, args.This());
@@ -436,6 +630,20 @@ void DeserializerContext::ReadDouble(const FunctionCallbackInfo<Value>& args) {
   return args.GetReturnValue().Set(value);
 }
 
+double DeserializerContext::FastReadDouble(Local<Value> receiver,
+                                           FastApiCallbackOptions& options) {
+  DeserializerContext* ctx;
+  ASSIGN_OR_RETURN_UNWRAP(&ctx, receiver, 0);
+
+  double value;
+  if (!ctx->deserializer_.ReadDouble(&value)) {
+    HandleScope scope(options.isolate);
+    ctx->env()->ThrowError("ReadDouble() failed");
+    return 0;
+  }
+  return value;
+}
+
 void DeserializerContext::ReadRawBytes(
     const FunctionCallbackInfo<Value>& args) {
   DeserializerContext* ctx;
@@ -478,13 +686,28 @@ void Initialize(Local<Object> target,
   SetProtoMethod(isolate, ser, "writeValue", SerializerContext::WriteValue);
   SetProtoMethod(
       isolate, ser, "releaseBuffer", SerializerContext::ReleaseBuffer);
+  SetProtoMethod(
+      isolate, ser, "setOutputBuffer", SerializerContext::SetOutputBuffer);
+  SetProtoMethod(isolate, ser, "reset", SerializerContext::Reset);
   SetProtoMethod(isolate,
                  ser,
                  "transferArrayBuffer",
                  SerializerContext::TransferArrayBuffer);
-  SetProtoMethod(isolate, ser, "writeUint32", SerializerContext::WriteUint32);
-  SetProtoMethod(isolate, ser, "writeUint64", SerializerContext::WriteUint64);
-  SetProtoMethod(isolate, ser, "writeDouble", SerializerContext::WriteDouble);
+  SetFastProtoMethod(isolate,
+                     ser,
+                     "writeUint32",
+                     SerializerContext::WriteUint32,
+                     &SerializerContext::fast_write_uint32_);
+  SetFastProtoMethod(isolate,
+                     ser,
+                     "writeUint64",
+                     SerializerContext::WriteUint64,
+                     &SerializerContext::fast_write_uint64_);
+  SetFastProtoMethod(isolate,
+                     ser,
+                     "writeDouble",
+                     SerializerContext::WriteDouble,
+                     &SerializerContext::fast_write_double_);
   SetProtoMethod(
       isolate, ser, "writeRawBytes", SerializerContext::WriteRawBytes);
   SetProtoMethod(isolate,
@@ -511,9 +734,17 @@ void Initialize(Local<Object> target,
                  des,
                  "transferArrayBuffer",
                  DeserializerContext::TransferArrayBuffer);
-  SetProtoMethod(isolate, des, "readUint32", DeserializerContext::ReadUint32);
+  SetFastProtoMethod(isolate,
+                     des,
+                     "readUint32",
+                     DeserializerContext::ReadUint32,
+                     &DeserializerContext::fast_read_uint32_);
   SetProtoMethod(isolate, des, "readUint64", DeserializerContext::ReadUint64);
-  SetProtoMethod(isolate, des, "readDouble", DeserializerContext::ReadDouble);
+  SetFastProtoMethod(isolate,
+                     des,
+                     "readDouble",
+                     DeserializerContext::ReadDouble,
+                     &DeserializerContext::fast_read_double_);
   SetProtoMethod(
       isolate, des, "_readRawBytes", DeserializerContext::ReadRawBytes);
 
@@ -528,10 +759,18 @@ void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(SerializerContext::WriteHeader);
   registry->Register(SerializerContext::WriteValue);
   registry->Register(SerializerContext::ReleaseBuffer);
+  registry->Register(SerializerContext::SetOutputBuffer);
+  registry->Register(SerializerContext::Reset);
   registry->Register(SerializerContext::TransferArrayBuffer);
   registry->Register(SerializerContext::WriteUint32);
+  registry->Register(SerializerContext::fast_write_uint32_.GetTypeInfo());
+  registry->Register(SerializerContext::FastWriteUint32);
   registry->Register(SerializerContext::WriteUint64);
+  registry->Register(SerializerContext::fast_write_uint64_.GetTypeInfo());
+  registry->Register(SerializerContext::FastWriteUint64);
   registry->Register(SerializerContext::WriteDouble);
+  registry->Register(SerializerContext::fast_write_double_.GetTypeInfo());
+  registry->Register(SerializerContext::FastWriteDouble);
   registry->Register(SerializerContext::WriteRawBytes);
   registry->Register(SerializerContext::SetTreatArrayBufferViewsAsHostObjects);
 
@@ -541,8 +780,12 @@ void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(DeserializerContext::GetWireFormatVersion);
   registry->Register(DeserializerContext::TransferArrayBuffer);
   registry->Register(DeserializerContext::ReadUint32);
+  registry->Register(DeserializerContext::fast_read_uint32_.GetTypeInfo());
+  registry->Register(DeserializerContext::FastReadUint32);
   registry->Register(DeserializerContext::ReadUint64);
   registry->Register(DeserializerContext::ReadDouble);
+  registry->Register(DeserializerContext::fast_read_double_.GetTypeInfo());
+  registry->Register(DeserializerContext::FastReadDouble);
   registry->Register(DeserializerContext::ReadRawBytes);
 }
 
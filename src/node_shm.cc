@@ -0,0 +1,347 @@
+#include "env-inl.h"
+#include "node_errors.h"
+#include "node_external_reference.h"
+#include "permission/permission.h"
+#include "util-inl.h"
+#include "uv.h"
+#include "v8.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <string>
+
+#ifdef __POSIX__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <ctime>
+#endif
+
+// Shared memory that can be mapped by more than one process. The regions are
+// returned as SharedArrayBuffers, so that they can be used with the Atomics
+// methods and passed to workers like any other SharedArrayBuffer. Since
+// Atomics.wait() and Atomics.notify() only wake up waiters in the current
+// process, wait() and notify() provide the same operations backed by futexes
+// that work across processes.
+
+namespace node {
+namespace shm {
+
+using permission::PermissionScope;
+using v8::ArrayBuffer;
+using v8::BackingStore;
+using v8::Context;
+using v8::FunctionCallbackInfo;
+using v8::Int32;
+using v8::Local;
+using v8::Number;
+using v8::Object;
+using v8::SharedArrayBuffer;
+using v8::Uint32;
+using v8::Value;
+
+namespace {
+
+// Results of wait(), in the order of the strings Atomics.wait() returns.
+enum WaitResult { kWaitOk, kWaitNotEqual, kWaitTimedOut };
+
+#ifdef __POSIX__
+int LastError() {
+  return uv_translate_sys_error(errno);
+}
+#endif
+
+// Returns the size in `value` in `*size`, or false after throwing if it is
+// not a valid size for a region.
+bool GetSize(Environment* env, Local<Value> value, size_t* size) {
+  double number = value.As<Number>()->Value();
+  if (!(number > 0) || std::trunc(number) != number ||
+      number > static_cast<double>(ArrayBuffer::kMaxByteLength)
+#ifdef __POSIX__
+      || number > static_cast<double>(std::numeric_limits<off_t>::max())
+#endif
+  ) {
+    THROW_ERR_OUT_OF_RANGE(env, "Invalid shared memory size");
+    return false;
+  }
+  *size = static_cast<size_t>(number);
+  return true;
+}
+
+// Returns the path of the file that backs the shared memory object `name`,
+// to which the file system permissions apply, or an empty string after
+// throwing if `name` is invalid. Names are a "/" followed by a file name.
+std::string GetBackingPath(Environment* env, std::string_view name) {
+  if (name.size() < 2 || name.size() > NAME_MAX + 1 || name[0] != '/' ||
+      name.find('/', 1) != std::string_view::npos || name == "/." ||
+      name == "/..") {
+    THROW_ERR_INVALID_ARG_VALUE(env, "Invalid shared memory name");
+    return std::string();
+  }
+#if defined(__linux__)
+  return "/dev/shm" + std::string(name);
+#else
+  return std::string(name);
+#endif
+}
+
+// open(name, size, create) opens the named shared memory object `name`,
+// which must start with a "/", and returns its file descriptor. If `create`
+// is set, the object must not exist yet and is created with `size` bytes.
+void Open(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsString());
+  CHECK(args[1]->IsNumber());
+  CHECK(args[2]->IsBoolean());
+  Utf8Value name(env->isolate(), args[0]);
+  bool create = args[2]->IsTrue();
+  std::string path = GetBackingPath(env, name.ToStringView());
+  if (path.empty()) return;
+  size_t size = 0;
+  if (create && !GetSize(env, args[1], &size)) return;
+  THROW_IF_INSUFFICIENT_PERMISSIONS(
+      env, PermissionScope::kFileSystemRead, path);
+  THROW_IF_INSUFFICIENT_PERMISSIONS(
+      env, PermissionScope::kFileSystemWrite, path);
+
+#ifdef __POSIX__
+  int flags = O_RDWR | O_CLOEXEC;
+  if (create) flags |= O_CREAT | O_EXCL;
+  int fd = shm_open(*name, flags, 0600);
+  if (fd == -1) return env->ThrowUVException(LastError(), "shm_open");
+  if (create) {
+    if (ftruncate(fd, static_cast<off_t>(size)) == -1) {
+      int err = LastError();
+      shm_unlink(*name);
+      close(fd);
+      return env->ThrowUVException(err, "ftruncate");
+    }
+  }
+  args.GetReturnValue().Set(fd);
+#else
+  env->ThrowUVException(UV_ENOTSUP, "shm_open");
+#endif
+}
+
+// createAnonymous(size) returns the file descriptor of a new shared memory
+// object that has no name, e.g. to be inherited by a child process through
+// its stdio.
+void CreateAnonymous(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsNumber());
+
+#if defined(__linux__) && defined(SYS_memfd_create)
+  size_t size;
+  if (!GetSize(env, args[0], &size)) return;
+  int fd = syscall(SYS_memfd_create, "node-shm", 0);
+  if (fd == -1) return env->ThrowUVException(LastError(), "memfd_create");
+  if (ftruncate(fd, static_cast<off_t>(size)) == -1) {
+    int err = LastError();
+    close(fd);
+    return env->ThrowUVException(err, "ftruncate");
+  }
+  args.GetReturnValue().Set(fd);
+#else
+  env->ThrowUVException(UV_ENOTSUP, "memfd_create");
+#endif
+}
+
+void Unlink(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsString());
+  Utf8Value name(env->isolate(), args[0]);
+  std::string path = GetBackingPath(env, name.ToStringView());
+  if (path.empty()) return;
+  THROW_IF_INSUFFICIENT_PERMISSIONS(
+      env, PermissionScope::kFileSystemWrite, path);
+
+#ifdef __POSIX__
+  if (shm_unlink(*name) == -1)
+    return env->ThrowUVException(LastError(), "shm_unlink");
+#else
+  env->ThrowUVException(UV_ENOTSUP, "shm_unlink");
+#endif
+}
+
+// map(fd, size) maps `size` bytes of the shared memory object `fd` and
+// returns them as a SharedArrayBuffer. The mapping stays valid after `fd` is
+// closed and is removed when the buffer is garbage collected.
+void Map(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsInt32());
+  CHECK(args[1]->IsNumber());
+  int fd = args[0].As<Int32>()->Value();
+  size_t length;
+  if (!GetSize(env, args[1], &length)) return;
+
+#ifdef __POSIX__
+  // Accessing pages past the end of the object raises SIGBUS, so the object
+  // has to cover the whole mapping.
+  struct stat st;
+  if (fstat(fd, &st) == -1) return env->ThrowUVException(LastError(), "fstat");
+  if (st.st_size < 0 || static_cast<uint64_t>(st.st_size) < length) {
+    return THROW_ERR_OUT_OF_RANGE(
+        env, "The shared memory object is smaller than the mapping");
+  }
+  void* data =
+      mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (data == MAP_FAILED) return env->ThrowUVException(LastError(), "mmap");
+
+  std::unique_ptr<BackingStore> store = SharedArrayBuffer::NewBackingStore(
+      data,
+      length,
+      [](void* data, size_t length, void* deleter_data) {
+        munmap(data, length);
+      },
+      nullptr);
+  args.GetReturnValue().Set(
+      SharedArrayBuffer::New(env->isolate(), std::move(store)));
+#else
+  env->ThrowUVException(UV_ENOTSUP, "mmap");
+#endif
+}
+
+// Returns the aligned int32 at `args[1]` bytes into the SharedArrayBuffer
+// `args[0]`, or nullptr after throwing if the offset is invalid.
+int32_t* GetWord(Environment* env, const FunctionCallbackInfo<Value>& args) {
+  CHECK(args[0]->IsSharedArrayBuffer());
+  CHECK(args[1]->IsUint32());
+  Local<SharedArrayBuffer> buffer = args[0].As<SharedArrayBuffer>();
+  size_t offset = args[1].As<Uint32>()->Value();
+  if (offset % sizeof(int32_t) != 0 ||
+      offset + sizeof(int32_t) > buffer->ByteLength()) {
+    THROW_ERR_OUT_OF_RANGE(env, "Invalid offset");
+    return nullptr;
+  }
+  return reinterpret_cast<int32_t*>(static_cast<char*>(buffer->Data()) +
+                                    offset);
+}
+
+// wait(buffer, byteOffset, value, timeout) blocks while the int32 at
+// `byteOffset` is `value`, until notify() is called from any process that
+// maps the same memory or `timeout` milliseconds have passed. A negative,
+// infinite or NaN timeout waits forever. Returns one of the WaitResult
+// values.
+//
+// The futex is waited on in slices, so that terminating a Worker is not
+// blocked by the wait. A notify() that comes between two slices is missed,
+// but one that follows a change of the value ends the wait as usual.
+void Wait(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  int32_t* word = GetWord(env, args);
+  if (word == nullptr) return;
+  CHECK(args[2]->IsInt32());
+  CHECK(args[3]->IsNumber());
+  int32_t value = args[2].As<Int32>()->Value();
+  double timeout = args[3].As<Number>()->Value();
+
+#if defined(__linux__)
+  constexpr uint64_t kNsPerMs = 1000 * 1000;
+  constexpr uint64_t kNsPerSec = 1000 * kNsPerMs;
+  constexpr uint64_t kSliceNs = 50 * kNsPerMs;
+  // Waits longer than this are not distinguishable from waiting forever.
+  constexpr double kMaxTimeoutMs = 1e12;
+  const bool forever = !(timeout >= 0 && timeout <= kMaxTimeoutMs);
+  const uint64_t deadline =
+      forever ? 0 : uv_hrtime() + static_cast<uint64_t>(timeout * kNsPerMs);
+  if (std::atomic_ref<int32_t>(*word).load() != value)
+    return args.GetReturnValue().Set(kWaitNotEqual);
+  bool waited = false;
+  for (;;) {
+    uint64_t slice = kSliceNs;
+    if (!forever) {
+      uint64_t now = uv_hrtime();
+      if (now >= deadline) return args.GetReturnValue().Set(kWaitTimedOut);
+      slice = std::min(slice, deadline - now);
+    }
+    struct timespec ts;
+    ts.tv_sec = static_cast<time_t>(slice / kNsPerSec);
+    ts.tv_nsec = static_cast<long>(slice % kNsPerSec);  // NOLINT(runtime/int)
+    // Not FUTEX_WAIT_PRIVATE: the waker may be another process.
+    int ret = syscall(SYS_futex, word, FUTEX_WAIT, value, &ts, nullptr, 0);
+    if (ret == 0) return args.GetReturnValue().Set(kWaitOk);
+    if (errno == EAGAIN) {
+      // After the first slice, the value has changed while waiting.
+      return args.GetReturnValue().Set(waited ? kWaitOk : kWaitNotEqual);
+    }
+    if (errno != ETIMEDOUT && errno != EINTR)
+      return env->ThrowUVException(LastError(), "futex");
+    // The Worker is being terminated, which does not run JavaScript anymore.
+    if (env->is_stopping()) return;
+    waited = true;
+  }
+#else
+  USE(value);
+  USE(timeout);
+  env->ThrowUVException(UV_ENOTSUP, "futex");
+#endif
+}
+
+// notify(buffer, byteOffset, count) wakes up to `count` waiters on the int32
+// at `byteOffset` and returns how many were woken up.
+void Notify(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  int32_t* word = GetWord(env, args);
+  if (word == nullptr) return;
+  CHECK(args[2]->IsUint32());
+  uint32_t count = args[2].As<Uint32>()->Value();
+
+#if defined(__linux__)
+  int woken = syscall(SYS_futex,
+                      word,
+                      FUTEX_WAKE,
+                      static_cast<int>(std::min<uint32_t>(count, INT_MAX)),
+                      nullptr,
+                      nullptr,
+                      0);
+  if (woken == -1) return env->ThrowUVException(LastError(), "futex");
+  args.GetReturnValue().Set(woken);
+#else
+  USE(count);
+  env->ThrowUVException(UV_ENOTSUP, "futex");
+#endif
+}
+
+}  // namespace
+
+static void Initialize(Local<Object> target,
+                       Local<Value> unused,
+                       Local<Context> context,
+                       void* priv) {
+  SetMethod(context, target, "open", Open);
+  SetMethod(context, target, "createAnonymous", CreateAnonymous);
+  SetMethod(context, target, "unlink", Unlink);
+  SetMethod(context, target, "map", Map);
+  SetMethod(context, target, "wait", Wait);
+  SetMethod(context, target, "notify", Notify);
+
+  NODE_DEFINE_CONSTANT(target, kWaitOk);
+  NODE_DEFINE_CONSTANT(target, kWaitNotEqual);
+  NODE_DEFINE_CONSTANT(target, kWaitTimedOut);
+}
+
+void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
+  registry->Register(Open);
+  registry->Register(CreateAnonymous);
+  registry->Register(Unlink);
+  registry->Register(Map);
+  registry->Register(Wait);
+  registry->Register(Notify);
+}
+
+}  // namespace shm
+}  // namespace node
+
+NODE_BINDING_CONTEXT_AWARE_INTERNAL(shm, node::shm::Initialize)
+NODE_BINDING_EXTERNAL_REFERENCE(shm, node::shm::RegisterExternalReferences)
@@ -42,6 +42,7 @@ using v8::HandleScope;
 using v8::Isolate;
 using v8::Local;
 using v8::LocalVector;
+using v8::Null;
 using v8::Object;
 using v8::ObjectTemplate;
 using v8::SnapshotCreator;
@@ -289,6 +290,7 @@ size_t SnapshotSerializer::Write(const PropInfo& data) {
 // [ 4/8 bytes ]  length of native_execution_async_resources
 // [   ...     ]  snapshot indices of each element in
 //                native_execution_async_resources
+// [ 4/8 bytes ]  snapshot index of provider_counts
 template <>
 AsyncHooks::SerializeInfo SnapshotDeserializer::Read() {
   Debug("Read<AsyncHooks::SerializeInfo>()\n");
@@ -299,6 +301,7 @@ AsyncHooks::SerializeInfo SnapshotDeserializer::Read() {
   result.async_id_fields = ReadArithmetic<AliasedBufferIndex>();
   result.js_execution_async_resources = ReadArithmetic<SnapshotIndex>();
   result.native_execution_async_resources = ReadVector<SnapshotIndex>();
+  result.provider_counts = ReadArithmetic<AliasedBufferIndex>();
 
   if (is_debug) {
     std::string str = ToStr(result);
@@ -322,6 +325,7 @@ size_t SnapshotSerializer::Write(const AsyncHooks::SerializeInfo& data) {
       WriteArithmetic<SnapshotIndex>(data.js_execution_async_resources);
   written_total +=
       WriteVector<SnapshotIndex>(data.native_execution_async_resources);
+  written_total += WriteArithmetic<AliasedBufferIndex>(data.provider_counts);
 
   Debug("Write<AsyncHooks::SerializeInfo>() wrote %d bytes\n", written_total);
   return written_total;
@@ -390,6 +394,8 @@ size_t SnapshotSerializer::Write(const ImmediateInfo::SerializeInfo& data) {
 // [ 4/8 bytes ]  snapshot index of root
 // [ 4/8 bytes ]  snapshot index of milestones
 // [ 4/8 bytes ]  snapshot index of observers
+// [ 4/8 bytes ]  snapshot index of gc_stats
+// [ 4/8 bytes ]  snapshot index of heap_space_stats
 template <>
 performance::PerformanceState::SerializeInfo SnapshotDeserializer::Read() {
   Debug("Read<PerformanceState::SerializeInfo>()\n");
@@ -398,6 +404,8 @@ performance::PerformanceState::SerializeInfo SnapshotDeserializer::Read() {
   result.root = ReadArithmetic<AliasedBufferIndex>();
   result.milestones = ReadArithmetic<AliasedBufferIndex>();
   result.observers = ReadArithmetic<AliasedBufferIndex>();
+  result.gc_stats = ReadArithmetic<AliasedBufferIndex>();
+  result.heap_space_stats = ReadArithmetic<AliasedBufferIndex>();
   if (is_debug) {
     std::string str = ToStr(result);
     Debug("Read<PerformanceState::SerializeInfo>() %s\n", str.c_str());
@@ -416,6 +424,8 @@ size_t SnapshotSerializer::Write(
   size_t written_total = WriteArithmetic<AliasedBufferIndex>(data.root);
   written_total += WriteArithmetic<AliasedBufferIndex>(data.milestones);
   written_total += WriteArithmetic<AliasedBufferIndex>(data.observers);
+  written_total += WriteArithmetic<AliasedBufferIndex>(data.gc_stats);
+  written_total += WriteArithmetic<AliasedBufferIndex>(data.heap_space_stats);
 
   Debug("Write<PerformanceState::SerializeInfo>() wrote %d bytes\n",
         written_total);
@@ -1511,9 +1521,34 @@ void SetDeserializeCallback(const FunctionCallbackInfo<Value>& args) {
 
 void SetDeserializeMainFunction(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
-  CHECK(env->snapshot_deserialize_main().IsEmpty());
   CHECK(args[0]->IsFunction());
-  env->set_snapshot_deserialize_main(args[0].As<Function>());
+  if (args[1]->IsUndefined()) {
+    CHECK(env->snapshot_deserialize_main().IsEmpty());
+    env->set_snapshot_deserialize_main(args[0].As<Function>());
+    return;
+  }
+
+  // Named entries are selected with --snapshot-entry when the snapshot is
+  // deserialized. They are kept in a null-prototype object so that they are
+  // captured together with the rest of the heap.
+  CHECK(args[1]->IsString());
+  Isolate* isolate = env->isolate();
+  Local<Context> context = env->context();
+  Local<Object> entries = env->snapshot_deserialize_entries();
+  if (entries.IsEmpty()) {
+    entries = Object::New(isolate, Null(isolate), nullptr, nullptr, 0);
+    env->set_snapshot_deserialize_entries(entries);
+  }
+  Local<String> name = args[1].As<String>();
+  bool has_entry;
+  if (!entries->HasOwnProperty(context, name).To(&has_entry)) return;
+  if (has_entry) {
+    Utf8Value name_utf8(isolate, name);
+    THROW_ERR_INVALID_STATE(
+        env, "Snapshot entry \"%s\" is already registered", *name_utf8);
+    return;
+  }
+  if (entries->Set(context, name, args[0]).IsNothing()) return;
 }
 
 constexpr const char* kAnonymousMainPath = "__node_anonymous_main";
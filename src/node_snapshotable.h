@@ -72,6 +72,17 @@ struct InternalFieldInfoBase {
   InternalFieldInfoBase() = default;
 };
 
+typedef void (*DeserializeRequestCallback)(v8::Local<v8::Context> context,
+                                           v8::Local<v8::Object> holder,
+                                           int index,
+                                           InternalFieldInfoBase* info);
+struct DeserializeRequest {
+  DeserializeRequestCallback cb = nullptr;
+  v8::Global<v8::Object> holder;
+  int index;
+  InternalFieldInfoBase* info = nullptr;  // Owned by the request
+};
+
 struct EmbedderTypeInfo {
   enum class MemoryMode : uint8_t { kBaseObject, kCppGC };
   EmbedderTypeInfo(EmbedderObjectType t, MemoryMode m) : type(t), mode(m) {}
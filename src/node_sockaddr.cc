@@ -7,6 +7,8 @@
 #include "node_sockaddr-inl.h"  // NOLINT(build/include_inline)
 #include "uv.h"
 
+#include <algorithm>
+#include <iterator>
 #include <memory>
 #include <string>
 #include <vector>
@@ -391,6 +393,80 @@ SocketAddressBlockList::SocketAddressBlockList(
     std::shared_ptr<SocketAddressBlockList> parent)
     : parent_(parent) {}
 
+bool SocketAddressBlockList::ToKey(const SocketAddress& address, Key* key) {
+  switch (address.family()) {
+    case AF_INET: {
+      const sockaddr_in* in =
+          reinterpret_cast<const sockaddr_in*>(address.data());
+      memcpy(key->data(), mask, sizeof(mask));
+      memcpy(key->data() + sizeof(mask), &in->sin_addr, sizeof(uint32_t));
+      return true;
+    }
+    case AF_INET6: {
+      const sockaddr_in6* in =
+          reinterpret_cast<const sockaddr_in6*>(address.data());
+      memcpy(key->data(), &in->sin6_addr, key->size());
+      return true;
+    }
+  }
+  return false;
+}
+
+void SocketAddressBlockList::PrefixTrie::Add(const Key& key,
+                                             int prefix,
+                                             int delta) {
+  if (nodes_.empty()) nodes_.emplace_back();
+  uint32_t index = 0;
+  for (int bit = 0; bit < prefix; bit++) {
+    int b = (key[bit >> 3] >> (7 - (bit & 7))) & 1;
+    if (nodes_[index].child[b] == 0) {
+      // Removals only ever target entries that were previously added.
+      CHECK_GT(delta, 0);
+      nodes_[index].child[b] = static_cast<uint32_t>(nodes_.size());
+      nodes_.emplace_back();
+    }
+    index = nodes_[index].child[b];
+  }
+  nodes_[index].count += delta;
+}
+
+bool SocketAddressBlockList::PrefixTrie::Match(const Key& key) const {
+  if (nodes_.empty()) return false;
+  uint32_t index = 0;
+  for (int bit = 0;; bit++) {
+    if (nodes_[index].count > 0) return true;
+    if (bit == 128) return false;
+    int b = (key[bit >> 3] >> (7 - (bit & 7))) & 1;
+    index = nodes_[index].child[b];
+    if (index == 0) return false;
+  }
+}
+
+void SocketAddressBlockList::AddInterval(IntervalSet* set,
+                                         const Key& start,
+                                         const Key& end) {
+  if (end < start) return;
+  Key first = start;
+  Key last = end;
+  // Absorb the interval that begins at or before start if it overlaps,
+  // then every interval that begins inside [first, last].
+  auto it = set->upper_bound(first);
+  if (it != set->begin() && std::prev(it)->second >= first) --it;
+  while (it != set->end() && it->first <= last) {
+    if (it->first < first) first = it->first;
+    if (it->second > last) last = it->second;
+    it = set->erase(it);
+  }
+  set->emplace(first, last);
+}
+
+bool SocketAddressBlockList::InInterval(const IntervalSet& set,
+                                        const Key& key) {
+  auto it = set.upper_bound(key);
+  if (it == set.begin()) return false;
+  return std::prev(it)->second >= key;
+}
+
 void SocketAddressBlockList::AddSocketAddress(
     const std::shared_ptr<SocketAddress>& address) {
   Mutex::ScopedLock lock(mutex_);
@@ -398,6 +474,8 @@ void SocketAddressBlockList::AddSocketAddress(
       std::make_unique<SocketAddressRule>(address);
   rules_.emplace_front(std::move(rule));
   address_rules_[*address.get()] = rules_.begin();
+  Key key;
+  if (ToKey(*address, &key)) prefixes_.Add(key, 128, 1);
 }
 
 void SocketAddressBlockList::RemoveSocketAddress(
@@ -405,6 +483,12 @@ void SocketAddressBlockList::RemoveSocketAddress(
   Mutex::ScopedLock lock(mutex_);
   auto it = address_rules_.find(*address.get());
   if (it != std::end(address_rules_)) {
+    // Remove the index entry of the rule being erased, which is not
+    // necessarily equal to the address passed in (e.g. the port may differ).
+    Key key;
+    SocketAddressRule* rule =
+        static_cast<SocketAddressRule*>(it->second->get());
+    if (ToKey(*rule->address, &key)) prefixes_.Add(key, 128, -1);
     rules_.erase(it->second);
     address_rules_.erase(it);
   }
@@ -416,6 +500,20 @@ void SocketAddressBlockList::AddSocketAddressRange(
   Mutex::ScopedLock lock(mutex_);
   std::unique_ptr<Rule> rule =
       std::make_unique<SocketAddressRangeRule>(start, end);
+  Key start_key;
+  Key end_key;
+  if (ToKey(*start, &start_key) && ToKey(*end, &end_key)) {
+    auto is_ipv4 = [](const Key& key) {
+      return memcmp(key.data(), mask, sizeof(mask)) == 0;
+    };
+    if (is_ipv4(start_key) && is_ipv4(end_key)) {
+      AddInterval(&ipv4_ranges_, start_key, end_key);
+    } else if (start->family() == AF_INET6 && end->family() == AF_INET6) {
+      AddInterval(&ipv6_ranges_, start_key, end_key);
+    } else {
+      other_ranges_.push_back(rule.get());
+    }
+  }
   rules_.emplace_front(std::move(rule));
 }
 
@@ -426,14 +524,26 @@ void SocketAddressBlockList::AddSocketAddressMask(
   std::unique_ptr<Rule> rule =
       std::make_unique<SocketAddressMaskRule>(network, prefix);
   rules_.emplace_front(std::move(rule));
+  Key key;
+  if (ToKey(*network, &key)) {
+    if (network->family() == AF_INET) prefix += 96;
+    prefixes_.Add(key, std::clamp(prefix, 0, 128), 1);
+  }
 }
 
 bool SocketAddressBlockList::Apply(
     const std::shared_ptr<SocketAddress>& address) {
   Mutex::ScopedLock lock(mutex_);
-  for (const auto& rule : rules_) {
-    if (rule->Apply(address))
+  Key key;
+  if (ToKey(*address, &key)) {
+    if (prefixes_.Match(key) || InInterval(ipv4_ranges_, key))
+      return true;
+    if (address->family() == AF_INET6 && InInterval(ipv6_ranges_, key))
       return true;
+    for (Rule* rule : other_ranges_) {
+      if (rule->Apply(address))
+        return true;
+    }
   }
   return parent_ ? parent_->Apply(address) : false;
 }
@@ -520,6 +630,7 @@ bool SocketAddressBlockList::ListRules(Environment* env,
 
 void SocketAddressBlockList::MemoryInfo(node::MemoryTracker* tracker) const {
   tracker->TrackField("rules", rules_);
+  tracker->TrackFieldWithSize("prefixes", prefixes_.memory_size());
 }
 
 void SocketAddressBlockList::SocketAddressRule::MemoryInfo(
@@ -11,11 +11,14 @@
 #include "uv.h"
 #include "v8.h"
 
+#include <array>
 #include <compare>
 #include <list>
+#include <map>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace node {
 
@@ -315,12 +318,55 @@ class SocketAddressBlockList : public MemoryRetainer {
   SET_SELF_SIZE(SocketAddressBlockList)
 
  private:
+  // Addresses are indexed as 128-bit big-endian keys. IPv4 addresses are
+  // stored in their IPv4-mapped IPv6 form (::ffff:a.b.c.d) so that rules
+  // and lookups of either family meet in the same key space, matching the
+  // cross-family semantics of SocketAddress::is_match and is_in_network.
+  using Key = std::array<uint8_t, 16>;
+
+  // Binary trie over the key bits. Each node counts the number of rules
+  // that terminate there; a lookup matches if any node on the path from
+  // the root has a non-zero count. Single addresses are /128 entries, so
+  // a lookup costs at most 128 steps regardless of the number of rules.
+  class PrefixTrie final {
+   public:
+    void Add(const Key& key, int prefix, int delta);
+    bool Match(const Key& key) const;
+    size_t memory_size() const { return nodes_.size() * sizeof(Node); }
+
+   private:
+    struct Node {
+      uint32_t child[2] = {0, 0};
+      uint32_t count = 0;
+    };
+    std::vector<Node> nodes_;
+  };
+
+  // Disjoint, merged [first, second] intervals keyed by their lower bound.
+  using IntervalSet = std::map<Key, Key>;
+
+  static bool ToKey(const SocketAddress& address, Key* key);
+  static void AddInterval(IntervalSet* set, const Key& start, const Key& end);
+  static bool InInterval(const IntervalSet& set, const Key& key);
+
   bool ListRules(Environment* env, v8::LocalVector<v8::Value>* vec);
 
   std::shared_ptr<SocketAddressBlockList> parent_;
   std::list<std::unique_ptr<Rule>> rules_;
   SocketAddress::Map<std::list<std::unique_ptr<Rule>>::iterator> address_rules_;
 
+  // Lookup indexes over rules_, which is kept for ListRules().
+  PrefixTrie prefixes_;
+  // Ranges whose endpoints are both IPv4 or IPv4-mapped; these match IPv4
+  // and IPv4-mapped addresses.
+  IntervalSet ipv4_ranges_;
+  // Ranges whose endpoints are both IPv6 and not both IPv4-mapped; these
+  // only match IPv6 addresses.
+  IntervalSet ipv6_ranges_;
+  // Mixed-family ranges, which have no single ordering and are evaluated
+  // rule by rule.
+  std::vector<Rule*> other_ranges_;
+
   Mutex mutex_;
 };
 
@@ -0,0 +1,296 @@
+#include "node_source_map.h"
+#include "compile_cache.h"
+#include "env-inl.h"
+#include "node_binding.h"
+#include "node_errors.h"
+#include "node_external_reference.h"
+#include "util-inl.h"
+#include "v8.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+
+// Decoding of the "mappings" of source maps, so that the generated positions
+// of stack trace frames can be mapped without decoding the Base64 VLQs in
+// JavaScript. The decoded entries of a source map file are kept in the
+// compile cache, if it is enabled, until the file changes.
+
+namespace node {
+namespace source_map {
+
+using v8::ArrayBuffer;
+using v8::BackingStore;
+using v8::Context;
+using v8::FunctionCallbackInfo;
+using v8::Int32;
+using v8::Int32Array;
+using v8::Local;
+using v8::Object;
+using v8::Value;
+
+namespace {
+
+// Identifies the format of Serialize() in the compile cache.
+constexpr uint32_t kSerializedMagic = 0x4d534e31;  // "NSM1"
+
+constexpr int8_t kNotBase64 = -1;
+
+constexpr std::array<int8_t, 128> MakeBase64Table() {
+  std::array<int8_t, 128> table{};
+  for (auto& value : table) value = kNotBase64;
+  constexpr char kChars[] =
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  for (int8_t i = 0; i < 64; i++) table[kChars[i]] = i;
+  return table;
+}
+
+constexpr std::array<int8_t, 128> kBase64Table = MakeBase64Table();
+
+// Decodes the Base64 VLQ at `*pos` and advances `*pos` past it.
+bool DecodeVLQ(std::string_view mappings, size_t* pos, int32_t* result) {
+  uint32_t value = 0;
+  uint32_t shift = 0;
+  while (true) {
+    if (*pos >= mappings.size()) return false;
+    unsigned char c = mappings[(*pos)++];
+    int8_t digit = c < kBase64Table.size() ? kBase64Table[c] : kNotBase64;
+    if (digit == kNotBase64 || shift > 30) return false;
+    value |= static_cast<uint32_t>(digit & 31) << shift;
+    if ((digit & 32) == 0) break;
+    shift += 5;
+  }
+  // The lowest bit is the sign.
+  int32_t magnitude = static_cast<int32_t>(value >> 1);
+  *result = (value & 1) ? -magnitude : magnitude;
+  return true;
+}
+
+// Decodes the delta at `*pos` and adds it to `*field`, failing instead of
+// overflowing for crafted mappings.
+bool DecodeField(std::string_view mappings, size_t* pos, int32_t* field) {
+  int32_t delta;
+  if (!DecodeVLQ(mappings, pos, &delta)) return false;
+  int64_t value = static_cast<int64_t>(*field) + delta;
+  if (value < std::numeric_limits<int32_t>::min() ||
+      value > std::numeric_limits<int32_t>::max()) {
+    return false;
+  }
+  *field = static_cast<int32_t>(value);
+  return true;
+}
+
+bool IsSegmentEnd(std::string_view mappings, size_t pos) {
+  return pos >= mappings.size() || mappings[pos] == ',' ||
+         mappings[pos] == ';';
+}
+
+bool IsBefore(const MappingEntry& entry, int32_t line, int32_t column) {
+  return entry.generated_line < line ||
+         (entry.generated_line == line && entry.generated_column <= column);
+}
+
+}  // namespace
+
+const MappingEntry* FindEntry(const MappingEntry* entries,
+                              size_t count,
+                              int32_t line,
+                              int32_t column) {
+  // The first entry that is after the position.
+  const MappingEntry* after = std::partition_point(
+      entries, entries + count, [&](const MappingEntry& entry) {
+        return IsBefore(entry, line, column);
+      });
+  return after == entries ? nullptr : after - 1;
+}
+
+std::optional<MappingIndex> MappingIndex::Decode(std::string_view mappings) {
+  MappingIndex index;
+  // Rough estimate, segments are usually longer than four characters.
+  index.entries_.reserve(mappings.size() / 4);
+
+  int32_t line = 0;
+  int32_t column = 0;
+  int32_t source = 0;
+  int32_t original_line = 0;
+  int32_t original_column = 0;
+  int32_t name = 0;
+  bool sorted = true;
+  size_t pos = 0;
+  while (pos < mappings.size()) {
+    char c = mappings[pos];
+    if (c == ';') {
+      if (line == std::numeric_limits<int32_t>::max()) return std::nullopt;
+      line++;
+      column = 0;
+      pos++;
+      continue;
+    }
+    if (c == ',') {
+      pos++;
+      continue;
+    }
+
+    if (!DecodeField(mappings, &pos, &column)) return std::nullopt;
+    MappingEntry entry{line, column, -1, -1, -1, -1};
+    if (!IsSegmentEnd(mappings, pos)) {
+      // Segments have 1, 4 or 5 fields.
+      if (!DecodeField(mappings, &pos, &source) ||
+          !DecodeField(mappings, &pos, &original_line) ||
+          !DecodeField(mappings, &pos, &original_column)) {
+        return std::nullopt;
+      }
+      entry.source = source;
+      entry.original_line = original_line;
+      entry.original_column = original_column;
+      if (!IsSegmentEnd(mappings, pos)) {
+        if (!DecodeField(mappings, &pos, &name)) return std::nullopt;
+        entry.name = name;
+      }
+      if (!IsSegmentEnd(mappings, pos)) return std::nullopt;
+    }
+    if (!index.entries_.empty() &&
+        !IsBefore(index.entries_.back(), line, column)) {
+      sorted = false;
+    }
+    index.entries_.push_back(entry);
+  }
+
+  // Generators usually emit the segments of a line in order already.
+  if (!sorted) {
+    std::stable_sort(index.entries_.begin(),
+                     index.entries_.end(),
+                     [](const MappingEntry& a, const MappingEntry& b) {
+                       return a.generated_line < b.generated_line ||
+                              (a.generated_line == b.generated_line &&
+                               a.generated_column < b.generated_column);
+                     });
+  }
+  return index;
+}
+
+std::string MappingIndex::Serialize() const {
+  std::string data(sizeof(kSerializedMagic) +
+                       entries_.size() * sizeof(MappingEntry),
+                   '\0');
+  memcpy(data.data(), &kSerializedMagic, sizeof(kSerializedMagic));
+  if (!entries_.empty()) {
+    memcpy(data.data() + sizeof(kSerializedMagic),
+           entries_.data(),
+           entries_.size() * sizeof(MappingEntry));
+  }
+  return data;
+}
+
+std::optional<MappingIndex> MappingIndex::Deserialize(std::string_view data) {
+  uint32_t magic;
+  if (data.size() < sizeof(magic)) return std::nullopt;
+  memcpy(&magic, data.data(), sizeof(magic));
+  data.remove_prefix(sizeof(magic));
+  if (magic != kSerializedMagic || data.size() % sizeof(MappingEntry) != 0) {
+    return std::nullopt;
+  }
+  MappingIndex index;
+  index.entries_.resize(data.size() / sizeof(MappingEntry));
+  if (!data.empty()) memcpy(index.entries_.data(), data.data(), data.size());
+  return index;
+}
+
+const MappingEntry* MappingIndex::Find(int32_t line, int32_t column) const {
+  return FindEntry(entries_.data(), entries_.size(), line, column);
+}
+
+namespace {
+
+// decodeMappings(mappings, path) returns the decoded entries of `mappings`
+// as an Int32Array with six elements per entry, in the order of the fields of
+// MappingEntry, or undefined if `mappings` is not valid. If `path` is the
+// source map file that `mappings` was read from, the entries are kept in
+// the compile cache until the file changes.
+void DecodeMappings(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsString());
+  CHECK(args[1]->IsString() || args[1]->IsUndefined());
+
+  CompileCacheHandler* compile_cache = nullptr;
+  std::string path;
+  uv_stat_t stat;
+  if (args[1]->IsString() && env->use_compile_cache()) {
+    path = Utf8Value(env->isolate(), args[1]).ToString();
+    uv_fs_t req;
+    int err = uv_fs_stat(nullptr, &req, path.c_str(), nullptr);
+    stat = req.statbuf;
+    uv_fs_req_cleanup(&req);
+    if (err == 0) compile_cache = env->compile_cache_handler();
+  }
+
+  std::optional<MappingIndex> index;
+  if (compile_cache != nullptr) {
+    auto cached = compile_cache->GetResolutionCacheEntry(path, stat);
+    if (cached.has_value()) index = MappingIndex::Deserialize(*cached);
+  }
+  if (!index.has_value()) {
+    Utf8Value mappings(env->isolate(), args[0]);
+    index = MappingIndex::Decode(mappings.ToStringView());
+    if (!index.has_value()) return;
+    if (compile_cache != nullptr) {
+      compile_cache->SaveResolutionCacheEntry(path, stat, index->Serialize());
+    }
+  }
+
+  const std::vector<MappingEntry>& entries = index->entries();
+  size_t length = entries.size() * 6;
+  if (length > std::numeric_limits<int32_t>::max()) {
+    return THROW_ERR_OUT_OF_RANGE(env, "Source map is too large");
+  }
+  std::unique_ptr<BackingStore> store = ArrayBuffer::NewBackingStore(
+      env->isolate(), entries.size() * sizeof(MappingEntry));
+  if (!entries.empty()) {
+    memcpy(store->Data(), entries.data(), store->ByteLength());
+  }
+  Local<ArrayBuffer> buffer =
+      ArrayBuffer::New(env->isolate(), std::move(store));
+  args.GetReturnValue().Set(Int32Array::New(buffer, 0, length));
+}
+
+// findEntry(entries, line, column) returns the number of the last entry in
+// the result of decodeMappings() at or before the zero-based generated
+// position, or -1 if there is none.
+void FindEntry(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args[0]->IsInt32Array());
+  CHECK(args[1]->IsInt32());
+  CHECK(args[2]->IsInt32());
+  ArrayBufferViewContents<uint8_t> contents(args[0]);
+  const MappingEntry* entries =
+      reinterpret_cast<const MappingEntry*>(contents.data());
+  size_t count = contents.length() / sizeof(MappingEntry);
+  int32_t line = args[1].As<Int32>()->Value();
+  int32_t column = args[2].As<Int32>()->Value();
+  const MappingEntry* entry =
+      source_map::FindEntry(entries, count, line, column);
+  args.GetReturnValue().Set(
+      entry == nullptr ? -1 : static_cast<int32_t>(entry - entries));
+}
+
+}  // namespace
+
+static void Initialize(Local<Object> target,
+                       Local<Value> unused,
+                       Local<Context> context,
+                       void* priv) {
+  SetMethod(context, target, "decodeMappings", DecodeMappings);
+  SetMethodNoSideEffect(context, target, "findEntry", FindEntry);
+}
+
+void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
+  registry->Register(DecodeMappings);
+  registry->Register(FindEntry);
+}
+
+}  // namespace source_map
+}  // namespace node
+
+NODE_BINDING_CONTEXT_AWARE_INTERNAL(source_map, node::source_map::Initialize)
+NODE_BINDING_EXTERNAL_REFERENCE(source_map,
+                                node::source_map::RegisterExternalReferences)
@@ -0,0 +1,65 @@
+#ifndef SRC_NODE_SOURCE_MAP_H_
+#define SRC_NODE_SOURCE_MAP_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace node {
+namespace source_map {
+
+// One segment of the "mappings" of a source map. All positions are zero-based
+// and absolute. `source` and `name` are indices into the "sources" and
+// "names" arrays, or -1 if the segment does not have them.
+struct MappingEntry {
+  int32_t generated_line;
+  int32_t generated_column;
+  int32_t source;
+  int32_t original_line;
+  int32_t original_column;
+  int32_t name;
+};
+
+static_assert(sizeof(MappingEntry) == 6 * sizeof(int32_t));
+
+// The decoded "mappings" of a source map, sorted by generated position, so
+// that frames of stack traces can be looked up without decoding the Base64
+// VLQs again.
+class MappingIndex {
+ public:
+  // Returns std::nullopt if `mappings` is not valid.
+  static std::optional<MappingIndex> Decode(std::string_view mappings);
+
+  // The entries in the format written by Serialize(), e.g. to persist them
+  // in the compile cache. Returns std::nullopt if `data` is not valid.
+  static std::optional<MappingIndex> Deserialize(std::string_view data);
+  std::string Serialize() const;
+
+  // Returns the last entry at or before the given generated position, or
+  // nullptr if there is none, like findEntry() of the JavaScript SourceMap.
+  const MappingEntry* Find(int32_t line, int32_t column) const;
+
+  const std::vector<MappingEntry>& entries() const { return entries_; }
+
+ private:
+  std::vector<MappingEntry> entries_;
+};
+
+// Like MappingIndex::Find(), for `count` entries already sorted by generated
+// position.
+const MappingEntry* FindEntry(const MappingEntry* entries,
+                              size_t count,
+                              int32_t line,
+                              int32_t column);
+
+}  // namespace source_map
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_NODE_SOURCE_MAP_H_
@@ -10,21 +10,31 @@
 #include "node_url.h"
 #include "sqlite3.h"
 #include "threadpoolwork-inl.h"
+#include "timer_wrap-inl.h"
 #include "util-inl.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cinttypes>
+#include <climits>
+#include <cmath>
+#include <variant>
 
 namespace node {
 namespace sqlite {
 
 using v8::Array;
 using v8::ArrayBuffer;
+using v8::ArrayBufferView;
+using v8::BackingStore;
 using v8::BigInt;
+using v8::BigInt64Array;
 using v8::Boolean;
 using v8::ConstructorBehavior;
 using v8::Context;
 using v8::DontDelete;
 using v8::Exception;
+using v8::Float64Array;
 using v8::Function;
 using v8::FunctionCallback;
 using v8::FunctionCallbackInfo;
@@ -46,7 +56,10 @@ using v8::Promise;
 using v8::SideEffectType;
 using v8::String;
 using v8::TryCatch;
+using v8::TypedArray;
+using v8::Uint32;
 using v8::Uint8Array;
+using v8::Undefined;
 using v8::Value;
 
 #define CHECK_ERROR_OR_THROW(isolate, db, expr, expected, ret)                 \
@@ -149,10 +162,10 @@ inline MaybeLocal<Object> CreateSQLiteError(Isolate* isolate, int errcode) {
   return e;
 }
 
-inline MaybeLocal<Object> CreateSQLiteError(Isolate* isolate, sqlite3* db) {
-  int errcode = sqlite3_extended_errcode(db);
+inline MaybeLocal<Object> CreateSQLiteError(Isolate* isolate,
+                                            int errcode,
+                                            const char* errmsg) {
   const char* errstr = sqlite3_errstr(errcode);
-  const char* errmsg = sqlite3_errmsg(db);
   Local<String> js_errmsg;
   Local<Object> e;
   Environment* env = Environment::GetCurrent(isolate);
@@ -169,6 +182,11 @@ inline MaybeLocal<Object> CreateSQLiteError(Isolate* isolate, sqlite3* db) {
   return e;
 }
 
+inline MaybeLocal<Object> CreateSQLiteError(Isolate* isolate, sqlite3* db) {
+  return CreateSQLiteError(
+      isolate, sqlite3_extended_errcode(db), sqlite3_errmsg(db));
+}
+
 void JSValueToSQLiteResult(Isolate* isolate,
                            sqlite3_context* ctx,
                            Local<Value> value) {
@@ -237,6 +255,32 @@ inline void THROW_ERR_SQLITE_ERROR(Isolate* isolate, int errcode) {
   }
 }
 
+// mmapSize is a byte count that can exceed 32 bits, so any safe integer is
+// accepted rather than just an Int32.
+inline std::optional<int64_t> GetMmapSize(Local<Value> value) {
+  if (!IsSafeJsInt(value) || value.As<Number>()->Value() < 0) {
+    return std::nullopt;
+  }
+  return static_cast<int64_t>(value.As<Number>()->Value());
+}
+
+// Applies the page cache settings of `config` to a new connection.
+inline int ConfigurePageCache(sqlite3* connection,
+                              const DatabaseOpenConfiguration& config) {
+  int r = SQLITE_OK;
+  if (config.get_mmap_size() > 0) {
+    std::string sql =
+        "PRAGMA mmap_size=" + std::to_string(config.get_mmap_size());
+    r = sqlite3_exec(connection, sql.c_str(), nullptr, nullptr, nullptr);
+  }
+  if (r == SQLITE_OK && config.get_cache_size() != 0) {
+    std::string sql =
+        "PRAGMA cache_size=" + std::to_string(config.get_cache_size());
+    r = sqlite3_exec(connection, sql.c_str(), nullptr, nullptr, nullptr);
+  }
+  return r;
+}
+
 inline MaybeLocal<Value> NullableSQLiteStringToValue(Isolate* isolate,
                                                      const char* str) {
   if (str == nullptr) {
@@ -247,18 +291,47 @@ inline MaybeLocal<Value> NullableSQLiteStringToValue(Isolate* isolate,
       .As<Value>();
 }
 
+// User-defined functions and aggregates with up to this many arguments do not
+// allocate their argument vectors on the heap.
+constexpr size_t kStackFunctionArgs = 16;
+
+// Converts the function arguments `argv` to JavaScript values in `out`.
+// Returns false if a JavaScript exception is pending.
+inline bool SQLiteArgumentsToJS(Isolate* isolate,
+                                bool use_bigint_args,
+                                int argc,
+                                sqlite3_value** argv,
+                                Local<Value>* out) {
+  for (int i = 0; i < argc; ++i) {
+    sqlite3_value* value = argv[i];
+    MaybeLocal<Value> js_val;
+    SQLITE_VALUE_TO_JS(value, isolate, use_bigint_args, js_val, value);
+    if (!js_val.ToLocal(&out[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
 class CustomAggregate {
  public:
+  // Larger batch sizes are clamped to this, so that the memory held by a
+  // pending batch stays bounded. The step function is called with fewer rows
+  // than requested at the end of every group anyway.
+  static constexpr uint32_t kMaxBatchSize = 64 * 1024;
+
   explicit CustomAggregate(Environment* env,
                            DatabaseSync* db,
                            bool use_bigint_args,
                            Local<Value> start,
                            Local<Function> step_fn,
                            Local<Function> inverse_fn,
-                           Local<Function> result_fn)
+                           Local<Function> result_fn,
+                           uint32_t batch_size)
       : env_(env),
         db_(db),
         use_bigint_args_(use_bigint_args),
+        batch_size_(batch_size),
         start_(env->isolate(), start),
         step_fn_(env->isolate(), step_fn),
         inverse_fn_(env->isolate(), inverse_fn),
@@ -268,6 +341,44 @@ class CustomAggregate {
     xStepBase(ctx, argc, argv, &CustomAggregate::step_fn_);
   }
 
+  // In batched mode, the arguments of up to `batch_size_` rows are copied and
+  // passed to a single call of the step function as one array per argument.
+  static void xStepBatched(sqlite3_context* ctx,
+                           int argc,
+                           sqlite3_value** argv) {
+    CustomAggregate* self =
+        static_cast<CustomAggregate*>(sqlite3_user_data(ctx));
+    HandleScope handle_scope(self->env_->isolate());
+    auto agg = self->GetAggregate(ctx);
+
+    if (!agg) {
+      return;
+    }
+
+    if (agg->pending == nullptr) {
+      agg->pending = new std::vector<sqlite3_value*>();
+      agg->pending->reserve(static_cast<size_t>(self->batch_size_) * argc);
+      agg->pending_argc = argc;
+    }
+    // Varargs aggregates may be called with a different number of arguments
+    // for every row, which cannot be represented as columns.
+    if (argc != agg->pending_argc && !self->FlushBatch(ctx, agg)) {
+      return;
+    }
+    agg->pending_argc = argc;
+    for (int i = 0; i < argc; ++i) {
+      sqlite3_value* copy = sqlite3_value_dup(argv[i]);
+      if (copy == nullptr) {
+        sqlite3_result_error_nomem(ctx);
+        return;
+      }
+      agg->pending->push_back(copy);
+    }
+    if (++agg->pending_rows == self->batch_size_) {
+      self->FlushBatch(ctx, agg);
+    }
+  }
+
   static void xInverse(sqlite3_context* ctx, int argc, sqlite3_value** argv) {
     xStepBase(ctx, argc, argv, &CustomAggregate::inverse_fn_);
   }
@@ -281,10 +392,17 @@ class CustomAggregate {
   }
 
  private:
+  // SQLite zero-initializes this memory, which is a valid empty state for all
+  // members.
   struct aggregate_data {
     Global<Value> value;
     bool initialized;
     bool is_window;
+    // The copied arguments of the rows that have not been passed to the step
+    // function yet, in batched mode.
+    std::vector<sqlite3_value*>* pending;
+    uint32_t pending_rows;
+    int pending_argc;
   };
 
   static inline void xStepBase(sqlite3_context* ctx,
@@ -295,6 +413,7 @@ class CustomAggregate {
         static_cast<CustomAggregate*>(sqlite3_user_data(ctx));
     Environment* env = self->env_;
     Isolate* isolate = env->isolate();
+    HandleScope handle_scope(isolate);
     auto agg = self->GetAggregate(ctx);
 
     if (!agg) {
@@ -302,35 +421,20 @@ class CustomAggregate {
     }
 
     auto recv = Undefined(isolate);
-    LocalVector<Value> js_argv(isolate);
-    js_argv.emplace_back(Local<Value>::New(isolate, agg->value));
-
-    for (int i = 0; i < argc; ++i) {
-      sqlite3_value* value = argv[i];
-      MaybeLocal<Value> js_val;
-      SQLITE_VALUE_TO_JS(value, isolate, self->use_bigint_args_, js_val, value);
-      if (js_val.IsEmpty()) {
-        // Ignore the SQLite error because a JavaScript exception is pending.
-        self->db_->SetIgnoreNextSQLiteError(true);
-        sqlite3_result_error(ctx, "", 0);
-        return;
-      }
-
-      Local<Value> local;
-      if (!js_val.ToLocal(&local)) {
-        // Ignore the SQLite error because a JavaScript exception is pending.
-        self->db_->SetIgnoreNextSQLiteError(true);
-        sqlite3_result_error(ctx, "", 0);
-        return;
-      }
-
-      js_argv.emplace_back(local);
+    MaybeStackBuffer<Local<Value>, kStackFunctionArgs> js_argv(argc + 1);
+    js_argv[0] = Local<Value>::New(isolate, agg->value);
+    if (!SQLiteArgumentsToJS(
+            isolate, self->use_bigint_args_, argc, argv, js_argv.out() + 1)) {
+      // Ignore the SQLite error because a JavaScript exception is pending.
+      self->db_->SetIgnoreNextSQLiteError(true);
+      sqlite3_result_error(ctx, "", 0);
+      return;
     }
 
     Local<Value> ret;
     if (!(self->*mptr)
              .Get(isolate)
-             ->Call(env->context(), recv, argc + 1, js_argv.data())
+             ->Call(env->context(), recv, argc + 1, js_argv.out())
              .ToLocal(&ret)) {
       self->db_->SetIgnoreNextSQLiteError(true);
       sqlite3_result_error(ctx, "", 0);
@@ -340,17 +444,82 @@ class CustomAggregate {
     agg->value.Reset(isolate, ret);
   }
 
+  // Passes the pending rows to the step function. Returns false if it threw.
+  bool FlushBatch(sqlite3_context* ctx, aggregate_data* agg) {
+    if (agg->pending_rows == 0) {
+      return true;
+    }
+
+    Isolate* isolate = env_->isolate();
+    HandleScope handle_scope(isolate);
+    uint32_t rows = agg->pending_rows;
+    int argc = agg->pending_argc;
+    sqlite3_value** values = agg->pending->data();
+    MaybeStackBuffer<Local<Value>, kStackFunctionArgs> js_argv(argc + 1);
+    js_argv[0] = Local<Value>::New(isolate, agg->value);
+    MaybeStackBuffer<Local<Value>, 64> column(rows);
+    bool ok = true;
+    for (int i = 0; ok && i < argc; ++i) {
+      for (uint32_t row = 0; ok && row < rows; ++row) {
+        ok = SQLiteArgumentsToJS(isolate,
+                                 use_bigint_args_,
+                                 1,
+                                 &values[static_cast<size_t>(row) * argc + i],
+                                 &column[row]);
+      }
+      if (ok) {
+        js_argv[i + 1] = Array::New(isolate, column.out(), rows);
+      }
+    }
+    ClearBatch(agg);
+
+    Local<Value> ret;
+    if (!ok || !step_fn_.Get(isolate)
+                    ->Call(env_->context(),
+                           Undefined(isolate),
+                           argc + 1,
+                           js_argv.out())
+                    .ToLocal(&ret)) {
+      // Ignore the SQLite error because a JavaScript exception is pending.
+      db_->SetIgnoreNextSQLiteError(true);
+      sqlite3_result_error(ctx, "", 0);
+      return false;
+    }
+
+    agg->value.Reset(isolate, ret);
+    return true;
+  }
+
+  static void ClearBatch(aggregate_data* agg) {
+    if (agg->pending == nullptr) {
+      return;
+    }
+    for (sqlite3_value* value : *agg->pending) {
+      sqlite3_value_free(value);
+    }
+    agg->pending->clear();
+    agg->pending_rows = 0;
+  }
+
   static inline void xValueBase(sqlite3_context* ctx, bool is_final) {
     CustomAggregate* self =
         static_cast<CustomAggregate*>(sqlite3_user_data(ctx));
     Environment* env = self->env_;
     Isolate* isolate = env->isolate();
+    HandleScope handle_scope(isolate);
     auto agg = self->GetAggregate(ctx);
 
     if (!agg) {
       return;
     }
 
+    if (!self->FlushBatch(ctx, agg)) {
+      if (is_final) {
+        DestroyAggregateData(ctx);
+      }
+      return;
+    }
+
     if (!is_final) {
       agg->is_window = true;
     } else if (agg->is_window) {
@@ -373,7 +542,9 @@ class CustomAggregate {
       result = Local<Value>::New(isolate, agg->value);
     }
 
-    JSValueToSQLiteResult(isolate, ctx, result);
+    if (!result.IsEmpty()) {
+      JSValueToSQLiteResult(isolate, ctx, result);
+    }
     if (is_final) {
       DestroyAggregateData(ctx);
     }
@@ -384,6 +555,9 @@ class CustomAggregate {
         sqlite3_aggregate_context(ctx, sizeof(aggregate_data)));
     CHECK(agg->initialized);
     agg->value.Reset();
+    ClearBatch(agg);
+    delete agg->pending;
+    agg->pending = nullptr;
   }
 
   aggregate_data* GetAggregate(sqlite3_context* ctx) {
@@ -413,6 +587,7 @@ class CustomAggregate {
   Environment* env_;
   DatabaseSync* db_;
   bool use_bigint_args_;
+  uint32_t batch_size_;
   Global<Value> start_;
   Global<Function> step_fn_;
   Global<Function> inverse_fn_;
@@ -428,11 +603,17 @@ class BackupJob : public ThreadPoolWork {
                      std::string destination_name,
                      std::string dest_db,
                      int pages,
+                     uint32_t interval,
+                     uint32_t step_time,
                      Local<Function> progressFunc)
       : ThreadPoolWork(env, "node_sqlite3.BackupJob"),
         env_(env),
         source_(source),
-        pages_(pages),
+        pages_(pages > 0 || step_time == 0 ? pages : kInitialAdaptivePages),
+        max_pages_(pages > 0 ? pages : INT_MAX),
+        interval_(interval),
+        step_time_ns_(static_cast<uint64_t>(step_time) * 1000000),
+        timer_(env, [this] { OnTimer(); }),
         source_db_(std::move(source_db)),
         destination_name_(std::move(destination_name)),
         dest_db_(std::move(dest_db)) {
@@ -466,7 +647,9 @@ class BackupJob : public ThreadPoolWork {
   }
 
   void DoThreadPoolWork() override {
+    uint64_t start = uv_hrtime();
     backup_status_ = sqlite3_backup_step(backup_, pages_);
+    step_duration_ns_ = uv_hrtime() - start;
   }
 
   void AfterThreadPoolWork(int status) override {
@@ -480,6 +663,10 @@ class BackupJob : public ThreadPoolWork {
       return;
     }
 
+    if (backup_status_ == SQLITE_OK) {
+      AdjustPages();
+    }
+
     int total_pages = sqlite3_backup_pagecount(backup_);
     int remaining_pages = sqlite3_backup_remaining(backup_);
     if (remaining_pages != 0) {
@@ -512,7 +699,7 @@ class BackupJob : public ThreadPoolWork {
       }
 
       // There's still work to do
-      this->ScheduleWork();
+      ScheduleNextStep();
       return;
     }
 
@@ -529,6 +716,7 @@ class BackupJob : public ThreadPoolWork {
 
   void Finalize() {
     Cleanup();
+    timer_.Close();
     source_->RemoveBackup(this);
   }
 
@@ -568,8 +756,59 @@ class BackupJob : public ThreadPoolWork {
     resolver->Reject(env()->context(), e).ToChecked();
   }
 
+  // Every step holds the lock of the source database, which blocks queries on
+  // the main thread for as long as it takes. With a step time, the number of
+  // pages of the next step is scaled so that a step takes about that long.
+  void AdjustPages() {
+    if (step_time_ns_ == 0 || step_duration_ns_ == 0) {
+      return;
+    }
+    double scaled = static_cast<double>(pages_) * step_time_ns_ /
+                    static_cast<double>(step_duration_ns_);
+    // Move halfway towards the estimate, since single steps can be noisy.
+    double next = (pages_ + scaled) / 2;
+    next = std::clamp(next, 1.0, static_cast<double>(max_pages_));
+    pages_ = static_cast<int>(next);
+  }
+
+  void ScheduleNextStep() {
+    if (interval_ == 0) {
+      ScheduleWork();
+      return;
+    }
+    timer_started_ns_ = uv_hrtime();
+    timer_.Update(interval_);
+  }
+
+  void OnTimer() {
+    if (backup_ == nullptr) {
+      // The source database has been closed, and source_ must not be used
+      // anymore.
+      timer_.Close();
+      HandleScope handle_scope(env()->isolate());
+      Local<Promise::Resolver> resolver =
+          Local<Promise::Resolver>::New(env()->isolate(), resolver_);
+      resolver
+          ->Reject(env()->context(),
+                   ERR_INVALID_STATE(env()->isolate(),
+                                     "database was closed during backup"))
+          .ToChecked();
+      return;
+    }
+    // A timer that fires late means that the event loop is busy, so back off
+    // before taking the lock of the source database again.
+    uint64_t delay_ns = uv_hrtime() - timer_started_ns_;
+    uint64_t expected_ns = static_cast<uint64_t>(interval_) * 1000000;
+    if (step_time_ns_ != 0 && delay_ns > expected_ns + step_time_ns_) {
+      pages_ = std::max(pages_ / 2, 1);
+    }
+    ScheduleWork();
+  }
+
   Environment* env() const { return env_; }
 
+  static constexpr int kInitialAdaptivePages = 100;
+
   Environment* env_;
   DatabaseSync* source_;
   Global<Promise::Resolver> resolver_;
@@ -577,6 +816,15 @@ class BackupJob : public ThreadPoolWork {
   sqlite3* dest_ = nullptr;
   sqlite3_backup* backup_ = nullptr;
   int pages_;
+  // The upper bound for pages_ when it is adjusted to the step time.
+  int max_pages_;
+  // The pause between two steps, in milliseconds.
+  uint32_t interval_;
+  // The target duration of a step, or 0 to always copy pages_ pages.
+  uint64_t step_time_ns_;
+  uint64_t step_duration_ns_ = 0;
+  uint64_t timer_started_ns_ = 0;
+  TimerWrapHandle timer_;
   int backup_status_ = SQLITE_OK;
   std::string source_db_;
   std::string destination_name_;
@@ -586,11 +834,13 @@ class BackupJob : public ThreadPoolWork {
 UserDefinedFunction::UserDefinedFunction(Environment* env,
                                          Local<Function> fn,
                                          DatabaseSync* db,
-                                         bool use_bigint_args)
+                                         bool use_bigint_args,
+                                         bool numeric_args)
     : env_(env),
       fn_(env->isolate(), fn),
       db_(db),
-      use_bigint_args_(use_bigint_args) {}
+      use_bigint_args_(use_bigint_args),
+      numeric_args_(numeric_args) {}
 
 UserDefinedFunction::~UserDefinedFunction() {}
 
@@ -601,34 +851,34 @@ void UserDefinedFunction::xFunc(sqlite3_context* ctx,
       static_cast<UserDefinedFunction*>(sqlite3_user_data(ctx));
   Environment* env = self->env_;
   Isolate* isolate = env->isolate();
+  // The function is called once per row of a statement that may be stepped
+  // many times by a single call from JavaScript, so the handles created for a
+  // row must not outlive it.
+  HandleScope handle_scope(isolate);
   auto recv = Undefined(isolate);
   auto fn = self->fn_.Get(isolate);
-  LocalVector<Value> js_argv(isolate);
-
-  for (int i = 0; i < argc; ++i) {
-    sqlite3_value* value = argv[i];
-    MaybeLocal<Value> js_val = MaybeLocal<Value>();
-    SQLITE_VALUE_TO_JS(value, isolate, self->use_bigint_args_, js_val, value);
-    if (js_val.IsEmpty()) {
-      // Ignore the SQLite error because a JavaScript exception is pending.
-      self->db_->SetIgnoreNextSQLiteError(true);
-      sqlite3_result_error(ctx, "", 0);
-      return;
-    }
+  MaybeStackBuffer<Local<Value>, kStackFunctionArgs> js_argv(argc);
 
-    Local<Value> local;
-    if (!js_val.ToLocal(&local)) {
-      // Ignore the SQLite error because a JavaScript exception is pending.
-      self->db_->SetIgnoreNextSQLiteError(true);
-      sqlite3_result_error(ctx, "", 0);
-      return;
+  if (self->numeric_args_) {
+    // Every argument is passed as a number, converted by SQLite's own rules,
+    // so that the type of the value does not need to be inspected.
+    for (int i = 0; i < argc; ++i) {
+      if (sqlite3_value_type(argv[i]) == SQLITE_NULL) {
+        js_argv[i] = Null(isolate);
+      } else {
+        js_argv[i] = Number::New(isolate, sqlite3_value_double(argv[i]));
+      }
     }
-
-    js_argv.emplace_back(local);
+  } else if (!SQLiteArgumentsToJS(
+                 isolate, self->use_bigint_args_, argc, argv, js_argv.out())) {
+    // Ignore the SQLite error because a JavaScript exception is pending.
+    self->db_->SetIgnoreNextSQLiteError(true);
+    sqlite3_result_error(ctx, "", 0);
+    return;
   }
 
   MaybeLocal<Value> retval =
-      fn->Call(env->context(), recv, argc, js_argv.data());
+      fn->Call(env->context(), recv, argc, js_argv.out());
   Local<Value> result;
   if (!retval.ToLocal(&result)) {
     // Ignore the SQLite error because a JavaScript exception is pending.
@@ -706,6 +956,8 @@ bool DatabaseSync::Open() {
   int flags = open_config_.get_read_only()
                   ? SQLITE_OPEN_READONLY
                   : SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE;
+  if (open_config_.get_shared_cache()) flags |= SQLITE_OPEN_SHAREDCACHE;
+  has_user_functions_ = false;
   int r = sqlite3_open_v2(open_config_.location().c_str(),
                           &connection_,
                           flags | default_flags,
@@ -734,6 +986,9 @@ bool DatabaseSync::Open() {
 
   sqlite3_busy_timeout(connection_, open_config_.get_timeout());
 
+  r = ConfigurePageCache(connection_, open_config_);
+  CHECK_ERROR_OR_THROW(env()->isolate(), this, r, SQLITE_OK, false);
+
   if (allow_load_extension_) {
     if (env()->permission()->enabled()) [[unlikely]] {
       THROW_ERR_LOAD_SQLITE_EXTENSION(env(),
@@ -759,6 +1014,8 @@ void DatabaseSync::FinalizeBackups() {
 }
 
 void DatabaseSync::FinalizeStatements() {
+  ClearStatementCache();
+
   for (auto stmt : statements_) {
     stmt->Finalize();
   }
@@ -766,6 +1023,53 @@ void DatabaseSync::FinalizeStatements() {
   statements_.clear();
 }
 
+sqlite3_stmt* DatabaseSync::TakeCachedStatement(const std::string& sql) {
+  auto it = statement_cache_.find(sql);
+  if (it == statement_cache_.end()) {
+    statement_cache_misses_++;
+    return nullptr;
+  }
+
+  sqlite3_stmt* stmt = it->second.idle;
+  statement_cache_lru_.erase(it->second.lru_position);
+  statement_cache_.erase(it);
+  statement_cache_hits_++;
+  return stmt;
+}
+
+// Called when a statement prepared with the cache enabled is garbage
+// collected. Returns true if its sqlite3_stmt has been kept for the next
+// prepare() of the same SQL instead of being finalized.
+bool DatabaseSync::ReleaseCachedStatement(StatementSync* statement) {
+  if (statement->cache_key_.empty() || !IsOpen()) return false;
+  const std::string& sql = statement->cache_key_;
+  if (statement_cache_.contains(sql)) return false;
+
+  if (statement_cache_.size() >=
+      static_cast<size_t>(open_config_.get_statement_cache_size())) {
+    auto evicted = statement_cache_.find(statement_cache_lru_.back());
+    CHECK_NE(evicted, statement_cache_.end());
+    sqlite3_finalize(evicted->second.idle);
+    statement_cache_.erase(evicted);
+    statement_cache_lru_.pop_back();
+  }
+
+  sqlite3_reset(statement->statement_);
+  sqlite3_clear_bindings(statement->statement_);
+  statement_cache_lru_.push_front(sql);
+  CachedStatement entry;
+  entry.idle = statement->statement_;
+  entry.lru_position = statement_cache_lru_.begin();
+  statement_cache_.emplace(sql, entry);
+  return true;
+}
+
+void DatabaseSync::ClearStatementCache() {
+  for (auto& entry : statement_cache_) sqlite3_finalize(entry.second.idle);
+  statement_cache_.clear();
+  statement_cache_lru_.clear();
+}
+
 void DatabaseSync::UntrackStatement(StatementSync* statement) {
   auto it = statements_.find(statement);
   if (it != statements_.end()) {
@@ -961,6 +1265,86 @@ void DatabaseSync::New(const FunctionCallbackInfo<Value>& args) {
 
       open_config.set_timeout(timeout_v.As<Int32>()->Value());
     }
+
+    Local<Value> cache_size_v;
+    if (!options
+             ->Get(env->context(),
+                   FIXED_ONE_BYTE_STRING(env->isolate(), "statementCacheSize"))
+             .ToLocal(&cache_size_v)) {
+      return;
+    }
+
+    if (!cache_size_v->IsUndefined()) {
+      if (!cache_size_v->IsInt32() || cache_size_v.As<Int32>()->Value() < 0) {
+        THROW_ERR_INVALID_ARG_TYPE(
+            env->isolate(),
+            "The \"options.statementCacheSize\" argument must be a "
+            "non-negative integer.");
+        return;
+      }
+
+      open_config.set_statement_cache_size(
+          cache_size_v.As<Int32>()->Value());
+    }
+
+    Local<Value> mmap_size_v;
+    if (!options
+             ->Get(env->context(),
+                   FIXED_ONE_BYTE_STRING(env->isolate(), "mmapSize"))
+             .ToLocal(&mmap_size_v)) {
+      return;
+    }
+
+    if (!mmap_size_v->IsUndefined()) {
+      std::optional<int64_t> mmap_size = GetMmapSize(mmap_size_v);
+      if (!mmap_size.has_value()) {
+        THROW_ERR_INVALID_ARG_TYPE(
+            env->isolate(),
+            "The \"options.mmapSize\" argument must be a non-negative "
+            "integer.");
+        return;
+      }
+
+      open_config.set_mmap_size(*mmap_size);
+    }
+
+    Local<Value> page_cache_size_v;
+    if (!options
+             ->Get(env->context(),
+                   FIXED_ONE_BYTE_STRING(env->isolate(), "cacheSize"))
+             .ToLocal(&page_cache_size_v)) {
+      return;
+    }
+
+    if (!page_cache_size_v->IsUndefined()) {
+      if (!page_cache_size_v->IsInt32()) {
+        THROW_ERR_INVALID_ARG_TYPE(
+            env->isolate(),
+            "The \"options.cacheSize\" argument must be an integer.");
+        return;
+      }
+
+      open_config.set_cache_size(page_cache_size_v.As<Int32>()->Value());
+    }
+
+    Local<Value> shared_cache_v;
+    if (!options
+             ->Get(env->context(),
+                   FIXED_ONE_BYTE_STRING(env->isolate(), "sharedCache"))
+             .ToLocal(&shared_cache_v)) {
+      return;
+    }
+
+    if (!shared_cache_v->IsUndefined()) {
+      if (!shared_cache_v->IsBoolean()) {
+        THROW_ERR_INVALID_ARG_TYPE(
+            env->isolate(),
+            "The \"options.sharedCache\" argument must be a boolean.");
+        return;
+      }
+
+      open_config.set_shared_cache(shared_cache_v.As<Boolean>()->Value());
+    }
   }
 
   new DatabaseSync(
@@ -993,6 +1377,8 @@ void DatabaseSync::Close(const FunctionCallbackInfo<Value>& args) {
   ASSIGN_OR_RETURN_UNWRAP(&db, args.This());
   Environment* env = Environment::GetCurrent(args);
   THROW_AND_RETURN_ON_BAD_STATE(env, !db->IsOpen(), "database is not open");
+  THROW_AND_RETURN_ON_BAD_STATE(
+      env, db->changeset_jobs_ > 0, "a changeset is being streamed");
   db->FinalizeStatements();
   db->DeleteSessions();
   int r = sqlite3_close_v2(db->connection_);
@@ -1013,15 +1399,51 @@ void DatabaseSync::Prepare(const FunctionCallbackInfo<Value>& args) {
   }
 
   Utf8Value sql(env->isolate(), args[0].As<String>());
-  sqlite3_stmt* s = nullptr;
-  int r = sqlite3_prepare_v2(db->connection_, *sql, -1, &s, 0);
-  CHECK_ERROR_OR_THROW(env->isolate(), db, r, SQLITE_OK, void());
+  // Every prepare() returns a new StatementSync, but it can reuse the
+  // sqlite3_stmt of a garbage collected one for the same SQL. While that
+  // statement is still in use, the SQL is compiled again.
+  const bool use_cache = db->open_config_.get_statement_cache_size() > 0;
+  sqlite3_stmt* s =
+      use_cache ? db->TakeCachedStatement(sql.ToString()) : nullptr;
+  if (s == nullptr) {
+    int r = sqlite3_prepare_v3(db->connection_,
+                               *sql,
+                               -1,
+                               use_cache ? SQLITE_PREPARE_PERSISTENT : 0,
+                               &s,
+                               0);
+    CHECK_ERROR_OR_THROW(env->isolate(), db, r, SQLITE_OK, void());
+  }
   BaseObjectPtr<StatementSync> stmt =
       StatementSync::Create(env, BaseObjectPtr<DatabaseSync>(db), s);
+  if (!stmt) {
+    sqlite3_finalize(s);
+    return;
+  }
   db->statements_.insert(stmt.get());
+  if (use_cache) stmt->cache_key_ = sql.ToString();
   args.GetReturnValue().Set(stmt->object());
 }
 
+void DatabaseSync::StatementCacheStats(
+    const FunctionCallbackInfo<Value>& args) {
+  DatabaseSync* db;
+  ASSIGN_OR_RETURN_UNWRAP(&db, args.This());
+  Environment* env = Environment::GetCurrent(args);
+  Isolate* isolate = env->isolate();
+
+  Local<Name> keys[] = {FIXED_ONE_BYTE_STRING(isolate, "hits"),
+                        FIXED_ONE_BYTE_STRING(isolate, "misses"),
+                        FIXED_ONE_BYTE_STRING(isolate, "size")};
+  Local<Value> values[] = {
+      Number::New(isolate, static_cast<double>(db->statement_cache_hits_)),
+      Number::New(isolate, static_cast<double>(db->statement_cache_misses_)),
+      Number::New(isolate, static_cast<double>(db->statement_cache_.size()))};
+  static_assert(arraysize(keys) == arraysize(values));
+  args.GetReturnValue().Set(Object::New(
+      isolate, Null(isolate), keys, values, arraysize(keys)));
+}
+
 void DatabaseSync::Exec(const FunctionCallbackInfo<Value>& args) {
   DatabaseSync* db;
   ASSIGN_OR_RETURN_UNWRAP(&db, args.This());
@@ -1044,6 +1466,8 @@ void DatabaseSync::CustomFunction(const FunctionCallbackInfo<Value>& args) {
   ASSIGN_OR_RETURN_UNWRAP(&db, args.This());
   Environment* env = Environment::GetCurrent(args);
   THROW_AND_RETURN_ON_BAD_STATE(env, !db->IsOpen(), "database is not open");
+  THROW_AND_RETURN_ON_BAD_STATE(
+      env, db->changeset_jobs_ > 0, "a changeset is being applied");
 
   if (!args[0]->IsString()) {
     THROW_ERR_INVALID_ARG_TYPE(env->isolate(),
@@ -1053,6 +1477,7 @@ void DatabaseSync::CustomFunction(const FunctionCallbackInfo<Value>& args) {
 
   int fn_index = args.Length() < 3 ? 1 : 2;
   bool use_bigint_args = false;
+  bool numeric_args = false;
   bool varargs = false;
   bool deterministic = false;
   bool direct_only = false;
@@ -1136,6 +1561,24 @@ void DatabaseSync::CustomFunction(const FunctionCallbackInfo<Value>& args) {
       }
       direct_only = direct_only_v.As<Boolean>()->Value();
     }
+
+    Local<Value> numeric_args_v;
+    if (!options
+             ->Get(env->context(),
+                   FIXED_ONE_BYTE_STRING(env->isolate(), "numericArguments"))
+             .ToLocal(&numeric_args_v)) {
+      return;
+    }
+
+    if (!numeric_args_v->IsUndefined()) {
+      if (!numeric_args_v->IsBoolean()) {
+        THROW_ERR_INVALID_ARG_TYPE(
+            env->isolate(),
+            "The \"options.numericArguments\" argument must be a boolean.");
+        return;
+      }
+      numeric_args = numeric_args_v.As<Boolean>()->Value();
+    }
   }
 
   if (!args[fn_index]->IsFunction()) {
@@ -1161,7 +1604,7 @@ void DatabaseSync::CustomFunction(const FunctionCallbackInfo<Value>& args) {
   }
 
   UserDefinedFunction* user_data =
-      new UserDefinedFunction(env, fn, db, use_bigint_args);
+      new UserDefinedFunction(env, fn, db, use_bigint_args, numeric_args);
   int text_rep = SQLITE_UTF8;
 
   if (deterministic) {
@@ -1182,6 +1625,7 @@ void DatabaseSync::CustomFunction(const FunctionCallbackInfo<Value>& args) {
                                      nullptr,
                                      UserDefinedFunction::xDestroy);
   CHECK_ERROR_OR_THROW(env->isolate(), db, r, SQLITE_OK, void());
+  db->has_user_functions_ = true;
 }
 
 void DatabaseSync::Location(const FunctionCallbackInfo<Value>& args) {
@@ -1219,6 +1663,8 @@ void DatabaseSync::AggregateFunction(const FunctionCallbackInfo<Value>& args) {
   ASSIGN_OR_RETURN_UNWRAP(&db, args.This());
   Environment* env = Environment::GetCurrent(args);
   THROW_AND_RETURN_ON_BAD_STATE(env, !db->IsOpen(), "database is not open");
+  THROW_AND_RETURN_ON_BAD_STATE(
+      env, db->changeset_jobs_ > 0, "a changeset is being applied");
   Utf8Value name(env->isolate(), args[0].As<String>());
   Local<Object> options = args[1].As<Object>();
   Local<Value> start_v;
@@ -1252,6 +1698,7 @@ void DatabaseSync::AggregateFunction(const FunctionCallbackInfo<Value>& args) {
   bool use_bigint_args = false;
   bool varargs = false;
   bool direct_only = false;
+  uint32_t batch_size = 0;
   Local<Value> use_bigint_args_v;
   Local<Function> inverseFunc = Local<Function>();
   if (!options
@@ -1323,6 +1770,33 @@ void DatabaseSync::AggregateFunction(const FunctionCallbackInfo<Value>& args) {
     inverseFunc = inverse_v.As<Function>();
   }
 
+  Local<Value> batch_size_v;
+  if (!options
+           ->Get(env->context(),
+                 FIXED_ONE_BYTE_STRING(env->isolate(), "batchSize"))
+           .ToLocal(&batch_size_v)) {
+    return;
+  }
+
+  if (!batch_size_v->IsUndefined()) {
+    if (!batch_size_v->IsUint32() || batch_size_v.As<Uint32>()->Value() == 0) {
+      THROW_ERR_INVALID_ARG_TYPE(
+          env->isolate(),
+          "The \"options.batchSize\" argument must be a positive integer.");
+      return;
+    }
+    if (!inverseFunc.IsEmpty()) {
+      // Window functions need the aggregate value after every row.
+      THROW_ERR_INVALID_ARG_VALUE(
+          env->isolate(),
+          "The \"options.batchSize\" and \"options.inverse\" arguments "
+          "cannot be used together.");
+      return;
+    }
+    batch_size = std::min(batch_size_v.As<Uint32>()->Value(),
+                          CustomAggregate::kMaxBatchSize);
+  }
+
   Local<Function> stepFunction = step_v.As<Function>();
   Local<Function> resultFunction =
       result_v->IsFunction() ? result_v.As<Function>() : Local<Function>();
@@ -1362,13 +1836,17 @@ void DatabaseSync::AggregateFunction(const FunctionCallbackInfo<Value>& args) {
                                                              start_v,
                                                              stepFunction,
                                                              inverseFunc,
-                                                             resultFunction),
-                                         CustomAggregate::xStep,
+                                                             resultFunction,
+                                                             batch_size),
+                                         batch_size > 0
+                                             ? CustomAggregate::xStepBatched
+                                             : CustomAggregate::xStep,
                                          CustomAggregate::xFinal,
                                          xValue,
                                          xInverse,
                                          CustomAggregate::xDestroy);
   CHECK_ERROR_OR_THROW(env->isolate(), db, r, SQLITE_OK, void());
+  db->has_user_functions_ = true;
 }
 
 void DatabaseSync::CreateSession(const FunctionCallbackInfo<Value>& args) {
@@ -1463,6 +1941,8 @@ void Backup(const FunctionCallbackInfo<Value>& args) {
   }
 
   int rate = 100;
+  uint32_t interval = 0;
+  uint32_t step_time = 0;
   std::string source_db = "main";
   std::string dest_db = "main";
   Local<Function> progressFunc = Local<Function>();
@@ -1490,6 +1970,44 @@ void Backup(const FunctionCallbackInfo<Value>& args) {
       rate = rate_v.As<Int32>()->Value();
     }
 
+    Local<Value> interval_v;
+    if (!options
+             ->Get(env->context(),
+                   FIXED_ONE_BYTE_STRING(env->isolate(), "interval"))
+             .ToLocal(&interval_v)) {
+      return;
+    }
+
+    if (!interval_v->IsUndefined()) {
+      if (!interval_v->IsUint32()) {
+        THROW_ERR_INVALID_ARG_TYPE(
+            env->isolate(),
+            "The \"options.interval\" argument must be a non-negative "
+            "integer.");
+        return;
+      }
+      interval = interval_v.As<Uint32>()->Value();
+    }
+
+    Local<Value> step_time_v;
+    if (!options
+             ->Get(env->context(),
+                   FIXED_ONE_BYTE_STRING(env->isolate(), "stepTime"))
+             .ToLocal(&step_time_v)) {
+      return;
+    }
+
+    if (!step_time_v->IsUndefined()) {
+      if (!step_time_v->IsUint32()) {
+        THROW_ERR_INVALID_ARG_TYPE(
+            env->isolate(),
+            "The \"options.stepTime\" argument must be a non-negative "
+            "integer.");
+        return;
+      }
+      step_time = step_time_v.As<Uint32>()->Value();
+    }
+
     Local<Value> source_v;
     if (!options->Get(env->context(), env->source_string())
              .ToLocal(&source_v)) {
@@ -1554,6 +2072,8 @@ void Backup(const FunctionCallbackInfo<Value>& args) {
                                  dest_path.value(),
                                  std::move(dest_db),
                                  rate,
+                                 interval,
+                                 step_time,
                                  progressFunc);
   db->AddBackup(job);
   job->ScheduleBackup();
@@ -1576,14 +2096,128 @@ static int xFilter(void* pCtx, const char* zTab) {
   return filterCallback(zTab) ? 1 : 0;
 }
 
-void DatabaseSync::ApplyChangeset(const FunctionCallbackInfo<Value>& args) {
-  conflictCallback = nullptr;
-  filterCallback = nullptr;
+// Applies a changeset that is passed in chunks on the thread pool, so that
+// the chunks neither have to be concatenated nor the event loop is blocked.
+// JavaScript can not be called from the thread pool, so conflicts are
+// resolved in the same way for all changes, and connections with
+// JavaScript functions, which triggers and constraints could call, are
+// refused.
+class ChangesetApplyJob : public ThreadPoolWork {
+ public:
+  struct Chunk {
+    std::shared_ptr<BackingStore> store;
+    size_t offset;
+    size_t length;
+  };
 
-  DatabaseSync* db;
-  ASSIGN_OR_RETURN_UNWRAP(&db, args.This());
-  Environment* env = Environment::GetCurrent(args);
-  THROW_AND_RETURN_ON_BAD_STATE(env, !db->IsOpen(), "database is not open");
+  ChangesetApplyJob(Environment* env,
+                    BaseObjectPtr<DatabaseSync> db,
+                    std::vector<Chunk>&& chunks,
+                    int on_conflict,
+                    std::set<std::string>&& tables,
+                    Local<Promise::Resolver> resolver)
+      : ThreadPoolWork(env, "node_sqlite3.ChangesetApplyJob"),
+        env_(env),
+        db_(std::move(db)),
+        chunks_(std::move(chunks)),
+        on_conflict_(on_conflict),
+        tables_(std::move(tables)) {
+    resolver_.Reset(env->isolate(), resolver);
+    db_->changeset_jobs_++;
+  }
+
+  void DoThreadPoolWork() override {
+    result_ = sqlite3changeset_apply_strm(db_->Connection(),
+                                          ReadInput,
+                                          this,
+                                          tables_.empty() ? nullptr : Filter,
+                                          Conflict,
+                                          this);
+  }
+
+  void AfterThreadPoolWork(int status) override {
+    std::unique_ptr<ChangesetApplyJob> self(this);
+    db_->changeset_jobs_--;
+
+    Isolate* isolate = env_->isolate();
+    HandleScope handle_scope(isolate);
+    Local<Context> context = env_->context();
+    Context::Scope context_scope(context);
+    Local<Promise::Resolver> resolver = resolver_.Get(isolate);
+    if (status == UV_ECANCELED) {
+      USE(resolver->Reject(
+          context, ERR_INVALID_STATE(isolate, "changeset was not applied")));
+    } else if (result_ == SQLITE_OK || result_ == SQLITE_ABORT) {
+      // Like applyChangeset(), false if a conflict aborted it.
+      USE(resolver->Resolve(context,
+                            Boolean::New(isolate, result_ == SQLITE_OK)));
+    } else {
+      Local<Object> e;
+      if (CreateSQLiteError(isolate, result_).ToLocal(&e)) {
+        USE(resolver->Reject(context, e));
+      }
+    }
+  }
+
+ private:
+  static int ReadInput(void* data, void* output, int* length) {
+    ChangesetApplyJob* job = static_cast<ChangesetApplyJob*>(data);
+    size_t n = 0;
+    while (n == 0 && job->next_chunk_ < job->chunks_.size()) {
+      const Chunk& chunk = job->chunks_[job->next_chunk_];
+      n = std::min(static_cast<size_t>(*length),
+                   chunk.length - job->chunk_position_);
+      memcpy(output,
+             static_cast<const char*>(chunk.store->Data()) + chunk.offset +
+                 job->chunk_position_,
+             n);
+      job->chunk_position_ += n;
+      if (job->chunk_position_ == chunk.length) {
+        job->next_chunk_++;
+        job->chunk_position_ = 0;
+      }
+    }
+    *length = static_cast<int>(n);
+    return SQLITE_OK;
+  }
+
+  static int Filter(void* data, const char* table) {
+    ChangesetApplyJob* job = static_cast<ChangesetApplyJob*>(data);
+    return job->tables_.contains(table) ? 1 : 0;
+  }
+
+  static int Conflict(void* data,
+                      int conflict_type,
+                      sqlite3_changeset_iter* iterator) {
+    ChangesetApplyJob* job = static_cast<ChangesetApplyJob*>(data);
+    // Only changes that conflict with existing rows can replace them.
+    if (job->on_conflict_ == SQLITE_CHANGESET_REPLACE &&
+        conflict_type != SQLITE_CHANGESET_DATA &&
+        conflict_type != SQLITE_CHANGESET_CONFLICT) {
+      return SQLITE_CHANGESET_OMIT;
+    }
+    return job->on_conflict_;
+  }
+
+  Environment* env_;
+  BaseObjectPtr<DatabaseSync> db_;
+  std::vector<Chunk> chunks_;
+  const int on_conflict_;
+  const std::set<std::string> tables_;
+  Global<Promise::Resolver> resolver_;
+  size_t next_chunk_ = 0;
+  size_t chunk_position_ = 0;
+  int result_ = SQLITE_OK;
+};
+
+void DatabaseSync::ApplyChangeset(const FunctionCallbackInfo<Value>& args) {
+  conflictCallback = nullptr;
+  filterCallback = nullptr;
+
+  DatabaseSync* db;
+  ASSIGN_OR_RETURN_UNWRAP(&db, args.This());
+  Environment* env = Environment::GetCurrent(args);
+  THROW_AND_RETURN_ON_BAD_STATE(env, !db->IsOpen(), "database is not open");
 
   if (!args[0]->IsUint8Array()) {
     THROW_ERR_INVALID_ARG_TYPE(
@@ -1689,6 +2323,122 @@ void DatabaseSync::ApplyChangeset(const FunctionCallbackInfo<Value>& args) {
   THROW_ERR_SQLITE_ERROR(env->isolate(), r);
 }
 
+// applyChangesetAsync(chunks[, options]) applies the changeset made up of
+// the Uint8Arrays in `chunks`, which must not be modified until the
+// returned promise settles. options.onConflict is one of the
+// SQLITE_CHANGESET_* resolutions and options.tables the names of the tables
+// to apply changes to, all by default. While the changeset is applied, other
+// calls on the connection wait for it, and no functions can be registered.
+void DatabaseSync::ApplyChangesetAsync(
+    const FunctionCallbackInfo<Value>& args) {
+  DatabaseSync* db;
+  ASSIGN_OR_RETURN_UNWRAP(&db, args.This());
+  Environment* env = Environment::GetCurrent(args);
+  Isolate* isolate = env->isolate();
+  THROW_AND_RETURN_ON_BAD_STATE(env, !db->IsOpen(), "database is not open");
+  THROW_AND_RETURN_ON_BAD_STATE(
+      env,
+      db->has_user_functions_,
+      "applyChangesetAsync() can not be used with user-defined functions");
+
+  if (!args[0]->IsArray()) {
+    THROW_ERR_INVALID_ARG_TYPE(
+        isolate, "The \"chunks\" argument must be an array of Uint8Arrays.");
+    return;
+  }
+
+  Local<Array> chunks_v = args[0].As<Array>();
+  std::vector<ChangesetApplyJob::Chunk> chunks;
+  chunks.reserve(chunks_v->Length());
+  for (uint32_t i = 0; i < chunks_v->Length(); i++) {
+    Local<Value> chunk_v;
+    if (!chunks_v->Get(env->context(), i).ToLocal(&chunk_v)) return;
+    if (!chunk_v->IsUint8Array()) {
+      THROW_ERR_INVALID_ARG_TYPE(
+          isolate, "The \"chunks\" argument must be an array of Uint8Arrays.");
+      return;
+    }
+    Local<ArrayBufferView> view = chunk_v.As<ArrayBufferView>();
+    chunks.push_back({view->Buffer()->GetBackingStore(),
+                      view->ByteOffset(),
+                      view->ByteLength()});
+  }
+
+  int on_conflict = SQLITE_CHANGESET_ABORT;
+  std::set<std::string> tables;
+  if (args.Length() > 1 && !args[1]->IsUndefined()) {
+    if (!args[1]->IsObject()) {
+      THROW_ERR_INVALID_ARG_TYPE(isolate,
+                                 "The \"options\" argument must be an object.");
+      return;
+    }
+
+    Local<Object> options = args[1].As<Object>();
+    Local<Value> conflict_v;
+    if (!options->Get(env->context(), env->onconflict_string())
+             .ToLocal(&conflict_v)) {
+      return;
+    }
+
+    if (!conflict_v->IsUndefined()) {
+      on_conflict =
+          conflict_v->IsInt32() ? conflict_v.As<Int32>()->Value() : -1;
+      if (on_conflict != SQLITE_CHANGESET_OMIT &&
+          on_conflict != SQLITE_CHANGESET_REPLACE &&
+          on_conflict != SQLITE_CHANGESET_ABORT) {
+        THROW_ERR_INVALID_ARG_TYPE(
+            isolate,
+            "The \"options.onConflict\" argument must be "
+            "SQLITE_CHANGESET_OMIT, SQLITE_CHANGESET_REPLACE or "
+            "SQLITE_CHANGESET_ABORT.");
+        return;
+      }
+    }
+
+    Local<Value> tables_v;
+    if (!options
+             ->Get(env->context(), FIXED_ONE_BYTE_STRING(isolate, "tables"))
+             .ToLocal(&tables_v)) {
+      return;
+    }
+
+    if (!tables_v->IsUndefined()) {
+      if (!tables_v->IsArray()) {
+        THROW_ERR_INVALID_ARG_TYPE(
+            isolate,
+            "The \"options.tables\" argument must be an array of strings.");
+        return;
+      }
+      Local<Array> tables_array = tables_v.As<Array>();
+      for (uint32_t i = 0; i < tables_array->Length(); i++) {
+        Local<Value> table_v;
+        if (!tables_array->Get(env->context(), i).ToLocal(&table_v)) return;
+        if (!table_v->IsString()) {
+          THROW_ERR_INVALID_ARG_TYPE(
+              isolate,
+              "The \"options.tables\" argument must be an array of strings.");
+          return;
+        }
+        tables.insert(Utf8Value(isolate, table_v).ToString());
+      }
+    }
+  }
+
+  Local<Promise::Resolver> resolver;
+  if (!Promise::Resolver::New(env->context()).ToLocal(&resolver)) {
+    return;
+  }
+
+  args.GetReturnValue().Set(resolver->GetPromise());
+  auto* job = new ChangesetApplyJob(env,
+                                    BaseObjectPtr<DatabaseSync>(db),
+                                    std::move(chunks),
+                                    on_conflict,
+                                    std::move(tables),
+                                    resolver);
+  job->ScheduleWork();
+}
+
 void DatabaseSync::EnableLoadExtension(
     const FunctionCallbackInfo<Value>& args) {
   DatabaseSync* db;
@@ -1771,7 +2521,11 @@ StatementSync::StatementSync(Environment* env,
 StatementSync::~StatementSync() {
   if (!IsFinalized()) {
     db_->UntrackStatement(this);
-    Finalize();
+    if (db_->ReleaseCachedStatement(this)) {
+      statement_ = nullptr;
+    } else {
+      Finalize();
+    }
   }
 }
 
@@ -1784,15 +2538,37 @@ inline bool StatementSync::IsFinalized() {
   return statement_ == nullptr;
 }
 
-bool StatementSync::BindParams(const FunctionCallbackInfo<Value>& args) {
+namespace {
+// The parameters of one row passed to runMany(), which have the same shape as
+// the arguments of run().
+class RowParams {
+ public:
+  RowParams(Isolate* isolate, const LocalVector<Value>& values)
+      : isolate_(isolate), values_(values) {}
+  int Length() const { return static_cast<int>(values_.size()); }
+  // Like FunctionCallbackInfo, returns undefined for missing parameters.
+  Local<Value> operator[](int i) const {
+    if (i >= Length()) return Undefined(isolate_);
+    return values_[i];
+  }
+
+ private:
+  Isolate* isolate_;
+  const LocalVector<Value>& values_;
+};
+}  // namespace
+
+template <typename Params>
+bool StatementSync::BindParams(const Params& args) {
   int r = sqlite3_clear_bindings(statement_);
   CHECK_ERROR_OR_THROW(env()->isolate(), db_.get(), r, SQLITE_OK, false);
 
   int anon_idx = 1;
   int anon_start = 0;
 
-  if (args[0]->IsObject() && !args[0]->IsArrayBufferView()) {
-    Local<Object> obj = args[0].As<Object>();
+  Local<Value> first = args[0];
+  if (first->IsObject() && !first->IsArrayBufferView()) {
+    Local<Object> obj = first.As<Object>();
     Local<Context> context = obj->GetIsolate()->GetCurrentContext();
     Local<Array> keys;
     if (!obj->GetOwnPropertyNames(context).ToLocal(&keys)) {
@@ -1939,7 +2715,13 @@ MaybeLocal<Name> StatementSync::ColumnNameToName(const int column) {
     return MaybeLocal<Name>();
   }
 
-  return String::NewFromUtf8(env()->isolate(), col_name).As<Name>();
+  // Column names are the keys of every row, so they are interned rather than
+  // created again for each row and each call.
+  Local<String> name;
+  if (!env()->isolate_data()->InternedString(col_name).ToLocal(&name)) {
+    return MaybeLocal<Name>();
+  }
+  return name.As<Name>();
 }
 
 void StatementSync::MemoryInfo(MemoryTracker* tracker) const {}
@@ -1959,6 +2741,15 @@ void StatementSync::All(const FunctionCallbackInfo<Value>& args) {
   }
 
   auto reset = OnScopeLeave([&]() { sqlite3_reset(stmt->statement_); });
+
+  if (stmt->return_columns_) {
+    Local<Value> columns;
+    if (stmt->StepToColumns().ToLocal(&columns)) {
+      args.GetReturnValue().Set(columns);
+    }
+    return;
+  }
+
   int num_cols = sqlite3_column_count(stmt->statement_);
   LocalVector<Value> rows(isolate);
 
@@ -2007,6 +2798,158 @@ void StatementSync::All(const FunctionCallbackInfo<Value>& args) {
   args.GetReturnValue().Set(Array::New(isolate, rows.data(), rows.size()));
 }
 
+// Steps through all remaining rows and returns one entry per column instead
+// of one per row. Columns holding only numbers (and NULLs, stored as NaN) are
+// filled straight into a Float64Array, or a BigInt64Array when reading
+// BigInts; any other column falls back to a plain array of values.
+MaybeLocal<Value> StatementSync::StepToColumns() {
+  Isolate* isolate = env()->isolate();
+  const int num_cols = sqlite3_column_count(statement_);
+
+  struct Column {
+    enum class Mode { kEmpty, kFloat64, kBigInt64, kValues };
+    Mode mode = Mode::kEmpty;
+    std::vector<double> doubles;
+    std::vector<int64_t> bigints;
+    std::optional<LocalVector<Value>> values;
+  };
+  std::vector<Column> columns(num_cols);
+  size_t row_count = 0;
+
+  // Materializes the numbers collected so far as JS values, so that the
+  // column can hold values of any type from now on.
+  auto to_values = [&](Column* column) {
+    column->values.emplace(isolate);
+    column->values->reserve(row_count + 1);
+    for (double d : column->doubles) {
+      column->values->emplace_back(
+          std::isnan(d) ? Null(isolate).As<Value>()
+                        : Number::New(isolate, d).As<Value>());
+    }
+    for (int64_t i : column->bigints) {
+      column->values->emplace_back(BigInt::New(isolate, i));
+    }
+    // All-NULL prefix of a column that has not picked a mode yet.
+    while (column->values->size() < row_count) {
+      column->values->emplace_back(Null(isolate));
+    }
+    column->doubles.clear();
+    column->bigints.clear();
+    column->mode = Column::Mode::kValues;
+  };
+
+  int r;
+  while ((r = sqlite3_step(statement_)) == SQLITE_ROW) {
+    for (int i = 0; i < num_cols; ++i) {
+      Column* column = &columns[i];
+      const int type = sqlite3_column_type(statement_, i);
+
+      if (column->mode == Column::Mode::kEmpty && type != SQLITE_NULL) {
+        if (type == SQLITE_FLOAT ||
+            (type == SQLITE_INTEGER && !use_big_ints_)) {
+          column->mode = Column::Mode::kFloat64;
+          column->doubles.resize(row_count, std::nan(""));
+        } else if (type == SQLITE_INTEGER && row_count == 0) {
+          column->mode = Column::Mode::kBigInt64;
+        } else {
+          to_values(column);
+        }
+      }
+
+      switch (column->mode) {
+        case Column::Mode::kEmpty:
+          continue;  // The NULL is filled in once the mode is known.
+        case Column::Mode::kFloat64:
+          if (type == SQLITE_NULL) {
+            column->doubles.push_back(std::nan(""));
+            continue;
+          } else if (type == SQLITE_FLOAT) {
+            column->doubles.push_back(sqlite3_column_double(statement_, i));
+            continue;
+          } else if (type == SQLITE_INTEGER && !use_big_ints_) {
+            sqlite3_int64 val = sqlite3_column_int64(statement_, i);
+            if (std::abs(val) > kMaxSafeJsInteger) {
+              THROW_ERR_OUT_OF_RANGE(
+                  isolate,
+                  "Value is too large to be represented as a "
+                  "JavaScript number: %" PRId64,
+                  val);
+              return MaybeLocal<Value>();
+            }
+            column->doubles.push_back(static_cast<double>(val));
+            continue;
+          }
+          to_values(column);
+          break;
+        case Column::Mode::kBigInt64:
+          if (type == SQLITE_INTEGER) {
+            column->bigints.push_back(sqlite3_column_int64(statement_, i));
+            continue;
+          }
+          to_values(column);
+          break;
+        case Column::Mode::kValues:
+          break;
+      }
+
+      Local<Value> val;
+      if (!ColumnToValue(i).ToLocal(&val)) return MaybeLocal<Value>();
+      column->values->emplace_back(val);
+    }
+    row_count++;
+  }
+
+  CHECK_ERROR_OR_THROW(isolate, db_.get(), r, SQLITE_DONE, MaybeLocal<Value>());
+
+  LocalVector<Value> results(isolate);
+  results.reserve(num_cols);
+  for (Column& column : columns) {
+    switch (column.mode) {
+      case Column::Mode::kFloat64: {
+        Local<ArrayBuffer> ab =
+            ArrayBuffer::New(isolate, row_count * sizeof(double));
+        if (row_count > 0) {
+          memcpy(ab->Data(), column.doubles.data(), row_count * sizeof(double));
+        }
+        results.emplace_back(Float64Array::New(ab, 0, row_count));
+        break;
+      }
+      case Column::Mode::kBigInt64: {
+        Local<ArrayBuffer> ab =
+            ArrayBuffer::New(isolate, row_count * sizeof(int64_t));
+        if (row_count > 0) {
+          memcpy(
+              ab->Data(), column.bigints.data(), row_count * sizeof(int64_t));
+        }
+        results.emplace_back(BigInt64Array::New(ab, 0, row_count));
+        break;
+      }
+      case Column::Mode::kEmpty:
+        to_values(&column);
+        [[fallthrough]];
+      case Column::Mode::kValues:
+        results.emplace_back(
+            Array::New(isolate, column.values->data(), column.values->size()));
+        break;
+    }
+  }
+
+  if (return_arrays_) {
+    return Array::New(isolate, results.data(), results.size()).As<Value>();
+  }
+
+  LocalVector<Name> keys(isolate);
+  keys.reserve(num_cols);
+  for (int i = 0; i < num_cols; ++i) {
+    Local<Name> key;
+    if (!ColumnNameToName(i).ToLocal(&key)) return MaybeLocal<Value>();
+    keys.emplace_back(key);
+  }
+  return Object::New(
+             isolate, Null(isolate), keys.data(), results.data(), num_cols)
+      .As<Value>();
+}
+
 void StatementSync::Iterate(const FunctionCallbackInfo<Value>& args) {
   StatementSync* stmt;
   ASSIGN_OR_RETURN_UNWRAP(&stmt, args.This());
@@ -2109,30 +3052,16 @@ void StatementSync::Get(const FunctionCallbackInfo<Value>& args) {
   }
 }
 
-void StatementSync::Run(const FunctionCallbackInfo<Value>& args) {
-  StatementSync* stmt;
-  ASSIGN_OR_RETURN_UNWRAP(&stmt, args.This());
-  Environment* env = Environment::GetCurrent(args);
-  THROW_AND_RETURN_ON_BAD_STATE(
-      env, stmt->IsFinalized(), "statement has been finalized");
-  int r = sqlite3_reset(stmt->statement_);
-  CHECK_ERROR_OR_THROW(env->isolate(), stmt->db_.get(), r, SQLITE_OK, void());
-
-  if (!stmt->BindParams(args)) {
-    return;
-  }
-
-  sqlite3_step(stmt->statement_);
-  r = sqlite3_reset(stmt->statement_);
-  CHECK_ERROR_OR_THROW(env->isolate(), stmt->db_.get(), r, SQLITE_OK, void());
+namespace {
+MaybeLocal<Object> CreateRunResult(Environment* env,
+                                   bool use_big_ints,
+                                   sqlite3_int64 last_insert_rowid,
+                                   sqlite3_int64 changes) {
   Local<Object> result = Object::New(env->isolate());
-  sqlite3_int64 last_insert_rowid =
-      sqlite3_last_insert_rowid(stmt->db_->Connection());
-  sqlite3_int64 changes = sqlite3_changes64(stmt->db_->Connection());
   Local<Value> last_insert_rowid_val;
   Local<Value> changes_val;
 
-  if (stmt->use_big_ints_) {
+  if (use_big_ints) {
     last_insert_rowid_val = BigInt::New(env->isolate(), last_insert_rowid);
     changes_val = BigInt::New(env->isolate(), changes);
   } else {
@@ -2147,93 +3076,443 @@ void StatementSync::Run(const FunctionCallbackInfo<Value>& args) {
           .IsNothing() ||
       result->Set(env->context(), env->changes_string(), changes_val)
           .IsNothing()) {
-    return;
+    return {};
   }
-
-  args.GetReturnValue().Set(result);
+  return result;
 }
 
-void StatementSync::Columns(const FunctionCallbackInfo<Value>& args) {
-  StatementSync* stmt;
-  ASSIGN_OR_RETURN_UNWRAP(&stmt, args.This());
-  Environment* env = Environment::GetCurrent(args);
-  THROW_AND_RETURN_ON_BAD_STATE(
-      env, stmt->IsFinalized(), "statement has been finalized");
-  int num_cols = sqlite3_column_count(stmt->statement_);
-  Isolate* isolate = env->isolate();
-  LocalVector<Value> cols(isolate);
-  LocalVector<Name> col_keys(isolate,
-                             {env->column_string(),
-                              env->database_string(),
-                              env->name_string(),
-                              env->table_string(),
-                              env->type_string()});
-  Local<Value> value;
-
-  cols.reserve(num_cols);
-  for (int i = 0; i < num_cols; ++i) {
-    LocalVector<Value> col_values(isolate);
-    col_values.reserve(col_keys.size());
-
-    if (!NullableSQLiteStringToValue(
-             isolate, sqlite3_column_origin_name(stmt->statement_, i))
-             .ToLocal(&value)) {
-      return;
-    }
-    col_values.emplace_back(value);
-
-    if (!NullableSQLiteStringToValue(
-             isolate, sqlite3_column_database_name(stmt->statement_, i))
-             .ToLocal(&value)) {
-      return;
-    }
-    col_values.emplace_back(value);
-
-    if (!stmt->ColumnNameToName(i).ToLocal(&value)) {
-      return;
-    }
-    col_values.emplace_back(value);
-
-    if (!NullableSQLiteStringToValue(
-             isolate, sqlite3_column_table_name(stmt->statement_, i))
-             .ToLocal(&value)) {
-      return;
-    }
-    col_values.emplace_back(value);
+// Runs a batch of rows in a savepoint, which works both inside and outside
+// of a transaction, so that the rows are written at once and a failing row
+// leaves the database unchanged. The savepoint is rolled back unless
+// Release() is called.
+class BatchSavepoint {
+ public:
+  explicit BatchSavepoint(DatabaseSync* db) : db_(db) {}
+  BatchSavepoint(const BatchSavepoint&) = delete;
+  BatchSavepoint& operator=(const BatchSavepoint&) = delete;
+
+  ~BatchSavepoint() {
+    if (!active_) return;
+    // Any error is already pending as an exception, so the result is not
+    // checked.
+    sqlite3_exec(db_->Connection(),
+                 "ROLLBACK TO node_sqlite_batch; RELEASE node_sqlite_batch",
+                 nullptr,
+                 nullptr,
+                 nullptr);
+  }
 
-    if (!NullableSQLiteStringToValue(
-             isolate, sqlite3_column_decltype(stmt->statement_, i))
-             .ToLocal(&value)) {
-      return;
-    }
-    col_values.emplace_back(value);
+  bool Begin(Isolate* isolate) {
+    int r = sqlite3_exec(db_->Connection(),
+                         "SAVEPOINT node_sqlite_batch",
+                         nullptr,
+                         nullptr,
+                         nullptr);
+    CHECK_ERROR_OR_THROW(isolate, db_, r, SQLITE_OK, false);
+    active_ = true;
+    return true;
+  }
 
-    Local<Object> column = Object::New(isolate,
-                                       Null(isolate),
-                                       col_keys.data(),
-                                       col_values.data(),
-                                       col_keys.size());
-    cols.emplace_back(column);
+  bool Release(Isolate* isolate) {
+    int r = sqlite3_exec(db_->Connection(),
+                         "RELEASE node_sqlite_batch",
+                         nullptr,
+                         nullptr,
+                         nullptr);
+    CHECK_ERROR_OR_THROW(isolate, db_, r, SQLITE_OK, false);
+    active_ = false;
+    return true;
   }
 
-  args.GetReturnValue().Set(Array::New(isolate, cols.data(), cols.size()));
-}
+ private:
+  DatabaseSync* db_;
+  bool active_ = false;
+};
+}  // namespace
 
-void StatementSync::SourceSQLGetter(const FunctionCallbackInfo<Value>& args) {
+void StatementSync::Run(const FunctionCallbackInfo<Value>& args) {
   StatementSync* stmt;
   ASSIGN_OR_RETURN_UNWRAP(&stmt, args.This());
   Environment* env = Environment::GetCurrent(args);
   THROW_AND_RETURN_ON_BAD_STATE(
       env, stmt->IsFinalized(), "statement has been finalized");
-  Local<String> sql;
-  if (!String::NewFromUtf8(env->isolate(), sqlite3_sql(stmt->statement_))
-           .ToLocal(&sql)) {
+  int r = sqlite3_reset(stmt->statement_);
+  CHECK_ERROR_OR_THROW(env->isolate(), stmt->db_.get(), r, SQLITE_OK, void());
+
+  if (!stmt->BindParams(args)) {
     return;
   }
-  args.GetReturnValue().Set(sql);
+
+  sqlite3_step(stmt->statement_);
+  r = sqlite3_reset(stmt->statement_);
+  CHECK_ERROR_OR_THROW(env->isolate(), stmt->db_.get(), r, SQLITE_OK, void());
+  Local<Object> result;
+  if (CreateRunResult(env,
+                      stmt->use_big_ints_,
+                      sqlite3_last_insert_rowid(stmt->db_->Connection()),
+                      sqlite3_changes64(stmt->db_->Connection()))
+          .ToLocal(&result)) {
+    args.GetReturnValue().Set(result);
+  }
 }
 
-void StatementSync::ExpandedSQLGetter(const FunctionCallbackInfo<Value>& args) {
+bool StatementSync::StepRow() {
+  sqlite3_step(statement_);
+  int r = sqlite3_reset(statement_);
+  CHECK_ERROR_OR_THROW(env()->isolate(), db_.get(), r, SQLITE_OK, false);
+  return true;
+}
+
+// runMany(rows) runs the statement once for every element of `rows`. An
+// array element is used as the list of arguments that would be passed to
+// run(), any other value as its only argument. All rows are run in a single
+// savepoint, i.e. either all of them or none are written. Returns the
+// rowid of the last insert and the total number of changes.
+void StatementSync::RunMany(const FunctionCallbackInfo<Value>& args) {
+  StatementSync* stmt;
+  ASSIGN_OR_RETURN_UNWRAP(&stmt, args.This());
+  Environment* env = Environment::GetCurrent(args);
+  Isolate* isolate = env->isolate();
+  Local<Context> context = env->context();
+  THROW_AND_RETURN_ON_BAD_STATE(
+      env, stmt->IsFinalized(), "statement has been finalized");
+  if (!args[0]->IsArray()) {
+    THROW_ERR_INVALID_ARG_TYPE(isolate,
+                               "The \"rows\" argument must be an array.");
+    return;
+  }
+  Local<Array> rows = args[0].As<Array>();
+  sqlite3* connection = stmt->db_->Connection();
+
+  int r = sqlite3_reset(stmt->statement_);
+  CHECK_ERROR_OR_THROW(isolate, stmt->db_.get(), r, SQLITE_OK, void());
+  BatchSavepoint savepoint(stmt->db_.get());
+  if (!savepoint.Begin(isolate)) return;
+  sqlite3_int64 total_changes = sqlite3_total_changes64(connection);
+
+  LocalVector<Value> params(isolate);
+  for (uint32_t i = 0; i < rows->Length(); i++) {
+    HandleScope scope(isolate);
+    Local<Value> row;
+    if (!rows->Get(context, i).ToLocal(&row)) return;
+    params.clear();
+    if (row->IsArray()) {
+      Local<Array> row_array = row.As<Array>();
+      for (uint32_t j = 0; j < row_array->Length(); j++) {
+        Local<Value> value;
+        if (!row_array->Get(context, j).ToLocal(&value)) return;
+        params.push_back(value);
+      }
+    } else {
+      params.push_back(row);
+    }
+    if (!stmt->BindParams(RowParams(isolate, params)) || !stmt->StepRow()) {
+      return;
+    }
+  }
+
+  total_changes = sqlite3_total_changes64(connection) - total_changes;
+  sqlite3_int64 last_insert_rowid = sqlite3_last_insert_rowid(connection);
+  if (!savepoint.Release(isolate)) return;
+  Local<Object> result;
+  if (CreateRunResult(
+          env, stmt->use_big_ints_, last_insert_rowid, total_changes)
+          .ToLocal(&result)) {
+    args.GetReturnValue().Set(result);
+  }
+}
+
+namespace {
+// A column passed to runColumns(). Typed arrays are read directly, other
+// arrays through BindValue().
+struct BatchColumn {
+  enum class Type {
+    kArray,
+    kFloat64,
+    kFloat32,
+    kInt8,
+    kUint8,
+    kInt16,
+    kUint16,
+    kInt32,
+    kUint32,
+    kBigInt64,
+    kBigUint64,
+  };
+
+  Type type = Type::kArray;
+  Local<Array> array;
+  // Keeps the memory alive even if the buffer is detached by a getter of
+  // another column.
+  std::shared_ptr<BackingStore> store;
+  const uint8_t* data = nullptr;
+  size_t length = 0;
+};
+
+bool GetBatchColumn(Local<Value> value, BatchColumn* column) {
+  if (value->IsArray()) {
+    column->array = value.As<Array>();
+    column->length = column->array->Length();
+    return true;
+  }
+  if (!value->IsTypedArray()) return false;
+
+  using Type = BatchColumn::Type;
+  if (value->IsFloat64Array()) {
+    column->type = Type::kFloat64;
+  } else if (value->IsFloat32Array()) {
+    column->type = Type::kFloat32;
+  } else if (value->IsInt8Array()) {
+    column->type = Type::kInt8;
+  } else if (value->IsUint8Array() || value->IsUint8ClampedArray()) {
+    column->type = Type::kUint8;
+  } else if (value->IsInt16Array()) {
+    column->type = Type::kInt16;
+  } else if (value->IsUint16Array()) {
+    column->type = Type::kUint16;
+  } else if (value->IsInt32Array()) {
+    column->type = Type::kInt32;
+  } else if (value->IsUint32Array()) {
+    column->type = Type::kUint32;
+  } else if (value->IsBigInt64Array()) {
+    column->type = Type::kBigInt64;
+  } else if (value->IsBigUint64Array()) {
+    column->type = Type::kBigUint64;
+  } else {
+    return false;
+  }
+  Local<TypedArray> typed_array = value.As<TypedArray>();
+  column->store = typed_array->Buffer()->GetBackingStore();
+  column->data =
+      static_cast<const uint8_t*>(column->store->Data()) +
+      typed_array->ByteOffset();
+  column->length = typed_array->Length();
+  return true;
+}
+
+template <typename T>
+T ReadElement(const BatchColumn& column, size_t index) {
+  T value;
+  memcpy(&value, column.data + index * sizeof(T), sizeof(T));
+  return value;
+}
+}  // namespace
+
+// runColumns(columns) runs the statement once per row of `columns`, which
+// holds one array or typed array per parameter. The column at index i is
+// bound to the parameter with index i + 1, and all columns must have the
+// same length. Elements of integer typed arrays are bound as integers and
+// elements of float typed arrays as doubles. As with runMany(), all rows
+// are run in a single savepoint.
+void StatementSync::RunColumns(const FunctionCallbackInfo<Value>& args) {
+  StatementSync* stmt;
+  ASSIGN_OR_RETURN_UNWRAP(&stmt, args.This());
+  Environment* env = Environment::GetCurrent(args);
+  Isolate* isolate = env->isolate();
+  Local<Context> context = env->context();
+  THROW_AND_RETURN_ON_BAD_STATE(
+      env, stmt->IsFinalized(), "statement has been finalized");
+  if (!args[0]->IsArray()) {
+    THROW_ERR_INVALID_ARG_TYPE(isolate,
+                               "The \"columns\" argument must be an array.");
+    return;
+  }
+  Local<Array> columns_array = args[0].As<Array>();
+  sqlite3* connection = stmt->db_->Connection();
+
+  int param_count = sqlite3_bind_parameter_count(stmt->statement_);
+  if (columns_array->Length() > static_cast<uint32_t>(param_count)) {
+    THROW_ERR_INVALID_ARG_VALUE(
+        isolate, "The statement has only %d parameters.", param_count);
+    return;
+  }
+
+  std::vector<BatchColumn> columns(columns_array->Length());
+  for (uint32_t i = 0; i < columns.size(); i++) {
+    Local<Value> value;
+    if (!columns_array->Get(context, i).ToLocal(&value)) return;
+    if (!GetBatchColumn(value, &columns[i])) {
+      THROW_ERR_INVALID_ARG_TYPE(
+          isolate, "Column %u must be an array or a typed array.", i);
+      return;
+    }
+    if (columns[i].length != columns[0].length) {
+      THROW_ERR_INVALID_ARG_VALUE(isolate,
+                                  "All columns must have the same length.");
+      return;
+    }
+  }
+  size_t row_count = columns.empty() ? 0 : columns[0].length;
+
+  int r = sqlite3_reset(stmt->statement_);
+  CHECK_ERROR_OR_THROW(isolate, stmt->db_.get(), r, SQLITE_OK, void());
+  r = sqlite3_clear_bindings(stmt->statement_);
+  CHECK_ERROR_OR_THROW(isolate, stmt->db_.get(), r, SQLITE_OK, void());
+  BatchSavepoint savepoint(stmt->db_.get());
+  if (!savepoint.Begin(isolate)) return;
+  sqlite3_int64 total_changes = sqlite3_total_changes64(connection);
+
+  using Type = BatchColumn::Type;
+  sqlite3_stmt* statement = stmt->statement_;
+  for (size_t row = 0; row < row_count; row++) {
+    HandleScope scope(isolate);
+    for (size_t i = 0; i < columns.size(); i++) {
+      const BatchColumn& column = columns[i];
+      int index = static_cast<int>(i) + 1;
+      switch (column.type) {
+        case Type::kArray: {
+          Local<Value> value;
+          if (!column.array->Get(context, row).ToLocal(&value) ||
+              !stmt->BindValue(value, index)) {
+            return;
+          }
+          continue;
+        }
+        case Type::kFloat64:
+          r = sqlite3_bind_double(
+              statement, index, ReadElement<double>(column, row));
+          break;
+        case Type::kFloat32:
+          r = sqlite3_bind_double(
+              statement, index, ReadElement<float>(column, row));
+          break;
+        case Type::kInt8:
+          r = sqlite3_bind_int(
+              statement, index, ReadElement<int8_t>(column, row));
+          break;
+        case Type::kUint8:
+          r = sqlite3_bind_int(
+              statement, index, ReadElement<uint8_t>(column, row));
+          break;
+        case Type::kInt16:
+          r = sqlite3_bind_int(
+              statement, index, ReadElement<int16_t>(column, row));
+          break;
+        case Type::kUint16:
+          r = sqlite3_bind_int(
+              statement, index, ReadElement<uint16_t>(column, row));
+          break;
+        case Type::kInt32:
+          r = sqlite3_bind_int(
+              statement, index, ReadElement<int32_t>(column, row));
+          break;
+        case Type::kUint32:
+          r = sqlite3_bind_int64(
+              statement, index, ReadElement<uint32_t>(column, row));
+          break;
+        case Type::kBigInt64:
+          r = sqlite3_bind_int64(
+              statement, index, ReadElement<int64_t>(column, row));
+          break;
+        case Type::kBigUint64: {
+          uint64_t value = ReadElement<uint64_t>(column, row);
+          if (value > static_cast<uint64_t>(INT64_MAX)) {
+            THROW_ERR_INVALID_ARG_VALUE(
+                isolate, "BigInt value is too large to bind.");
+            return;
+          }
+          r = sqlite3_bind_int64(
+              statement, index, static_cast<sqlite3_int64>(value));
+          break;
+        }
+      }
+      CHECK_ERROR_OR_THROW(isolate, stmt->db_.get(), r, SQLITE_OK, void());
+    }
+    if (!stmt->StepRow()) return;
+  }
+
+  total_changes = sqlite3_total_changes64(connection) - total_changes;
+  sqlite3_int64 last_insert_rowid = sqlite3_last_insert_rowid(connection);
+  if (!savepoint.Release(isolate)) return;
+  Local<Object> result;
+  if (CreateRunResult(
+          env, stmt->use_big_ints_, last_insert_rowid, total_changes)
+          .ToLocal(&result)) {
+    args.GetReturnValue().Set(result);
+  }
+}
+
+void StatementSync::Columns(const FunctionCallbackInfo<Value>& args) {
+  StatementSync* stmt;
+  ASSIGN_OR_RETURN_UNWRAP(&stmt, args.This());
+  Environment* env = Environment::GetCurrent(args);
+  THROW_AND_RETURN_ON_BAD_STATE(
+      env, stmt->IsFinalized(), "statement has been finalized");
+  int num_cols = sqlite3_column_count(stmt->statement_);
+  Isolate* isolate = env->isolate();
+  LocalVector<Value> cols(isolate);
+  LocalVector<Name> col_keys(isolate,
+                             {env->column_string(),
+                              env->database_string(),
+                              env->name_string(),
+                              env->table_string(),
+                              env->type_string()});
+  Local<Value> value;
+
+  cols.reserve(num_cols);
+  for (int i = 0; i < num_cols; ++i) {
+    LocalVector<Value> col_values(isolate);
+    col_values.reserve(col_keys.size());
+
+    if (!NullableSQLiteStringToValue(
+             isolate, sqlite3_column_origin_name(stmt->statement_, i))
+             .ToLocal(&value)) {
+      return;
+    }
+    col_values.emplace_back(value);
+
+    if (!NullableSQLiteStringToValue(
+             isolate, sqlite3_column_database_name(stmt->statement_, i))
+             .ToLocal(&value)) {
+      return;
+    }
+    col_values.emplace_back(value);
+
+    if (!stmt->ColumnNameToName(i).ToLocal(&value)) {
+      return;
+    }
+    col_values.emplace_back(value);
+
+    if (!NullableSQLiteStringToValue(
+             isolate, sqlite3_column_table_name(stmt->statement_, i))
+             .ToLocal(&value)) {
+      return;
+    }
+    col_values.emplace_back(value);
+
+    if (!NullableSQLiteStringToValue(
+             isolate, sqlite3_column_decltype(stmt->statement_, i))
+             .ToLocal(&value)) {
+      return;
+    }
+    col_values.emplace_back(value);
+
+    Local<Object> column = Object::New(isolate,
+                                       Null(isolate),
+                                       col_keys.data(),
+                                       col_values.data(),
+                                       col_keys.size());
+    cols.emplace_back(column);
+  }
+
+  args.GetReturnValue().Set(Array::New(isolate, cols.data(), cols.size()));
+}
+
+void StatementSync::SourceSQLGetter(const FunctionCallbackInfo<Value>& args) {
+  StatementSync* stmt;
+  ASSIGN_OR_RETURN_UNWRAP(&stmt, args.This());
+  Environment* env = Environment::GetCurrent(args);
+  THROW_AND_RETURN_ON_BAD_STATE(
+      env, stmt->IsFinalized(), "statement has been finalized");
+  Local<String> sql;
+  if (!String::NewFromUtf8(env->isolate(), sqlite3_sql(stmt->statement_))
+           .ToLocal(&sql)) {
+    return;
+  }
+  args.GetReturnValue().Set(sql);
+}
+
+void StatementSync::ExpandedSQLGetter(const FunctionCallbackInfo<Value>& args) {
   StatementSync* stmt;
   ASSIGN_OR_RETURN_UNWRAP(&stmt, args.This());
   Environment* env = Environment::GetCurrent(args);
@@ -2322,6 +3601,22 @@ void StatementSync::SetReturnArrays(const FunctionCallbackInfo<Value>& args) {
   stmt->return_arrays_ = args[0]->IsTrue();
 }
 
+void StatementSync::SetReturnColumns(const FunctionCallbackInfo<Value>& args) {
+  StatementSync* stmt;
+  ASSIGN_OR_RETURN_UNWRAP(&stmt, args.This());
+  Environment* env = Environment::GetCurrent(args);
+  THROW_AND_RETURN_ON_BAD_STATE(
+      env, stmt->IsFinalized(), "statement has been finalized");
+
+  if (!args[0]->IsBoolean()) {
+    THROW_ERR_INVALID_ARG_TYPE(
+        env->isolate(), "The \"returnColumns\" argument must be a boolean.");
+    return;
+  }
+
+  stmt->return_columns_ = args[0]->IsTrue();
+}
+
 void IllegalConstructor(const FunctionCallbackInfo<Value>& args) {
   THROW_ERR_ILLEGAL_CONSTRUCTOR(Environment::GetCurrent(args));
 }
@@ -2357,6 +3652,8 @@ Local<FunctionTemplate> StatementSync::GetConstructorTemplate(
     SetProtoMethod(isolate, tmpl, "all", StatementSync::All);
     SetProtoMethod(isolate, tmpl, "get", StatementSync::Get);
     SetProtoMethod(isolate, tmpl, "run", StatementSync::Run);
+    SetProtoMethod(isolate, tmpl, "runMany", StatementSync::RunMany);
+    SetProtoMethod(isolate, tmpl, "runColumns", StatementSync::RunColumns);
     SetProtoMethodNoSideEffect(
         isolate, tmpl, "columns", StatementSync::Columns);
     SetSideEffectFreeGetter(isolate,
@@ -2379,6 +3676,8 @@ Local<FunctionTemplate> StatementSync::GetConstructorTemplate(
         isolate, tmpl, "setReadBigInts", StatementSync::SetReadBigInts);
     SetProtoMethod(
         isolate, tmpl, "setReturnArrays", StatementSync::SetReturnArrays);
+    SetProtoMethod(
+        isolate, tmpl, "setReturnColumns", StatementSync::SetReturnColumns);
     env->set_sqlite_statement_sync_constructor_template(tmpl);
   }
   return tmpl;
@@ -2571,6 +3870,14 @@ Local<FunctionTemplate> Session::GetConstructorTemplate(Environment* env) {
                    Session::Changeset<sqlite3session_changeset>);
     SetProtoMethod(
         isolate, tmpl, "patchset", Session::Changeset<sqlite3session_patchset>);
+    SetProtoMethod(isolate,
+                   tmpl,
+                   "streamChangeset",
+                   Session::StreamChangeset<sqlite3session_changeset_strm>);
+    SetProtoMethod(isolate,
+                   tmpl,
+                   "streamPatchset",
+                   Session::StreamChangeset<sqlite3session_patchset_strm>);
     SetProtoMethod(isolate, tmpl, "close", Session::Close);
     env->set_sqlite_session_constructor_template(tmpl);
   }
@@ -2579,6 +3886,175 @@ Local<FunctionTemplate> Session::GetConstructorTemplate(Environment* env) {
 
 void Session::MemoryInfo(MemoryTracker* tracker) const {}
 
+constexpr size_t kDefaultChangesetChunkSize = 64 * 1024;
+
+// Generates the changeset or patchset of a session on the thread pool and
+// hands it to JavaScript in chunks while it is being generated, so that it
+// never has to be held in memory as a whole. Generating holds the lock of
+// the connection, so queries on the main thread wait until it is done.
+class ChangesetStreamJob : public ThreadPoolWork {
+ public:
+  ChangesetStreamJob(Environment* env,
+                     BaseObjectPtr<DatabaseSync> db,
+                     BaseObjectPtr<Session> session,
+                     Sqlite3ChangesetStreamFunc generate,
+                     size_t chunk_size,
+                     Local<Function> on_chunk,
+                     Local<Promise::Resolver> resolver)
+      : ThreadPoolWork(env, "node_sqlite3.ChangesetStreamJob"),
+        env_(env),
+        db_(std::move(db)),
+        session_(std::move(session)),
+        generate_(generate),
+        chunk_size_(chunk_size),
+        output_(std::make_shared<Output>()) {
+    on_chunk_.Reset(env->isolate(), on_chunk);
+    resolver_.Reset(env->isolate(), resolver);
+    output_->job = this;
+    session_->streaming_ = true;
+    db_->changeset_jobs_++;
+  }
+
+  ~ChangesetStreamJob() override { free(chunk_); }
+
+  void DoThreadPoolWork() override {
+    result_ = generate_(session_->session_, WriteOutput, this);
+    if (result_ == SQLITE_OK) PushChunk();
+  }
+
+  void AfterThreadPoolWork(int status) override {
+    std::unique_ptr<ChangesetStreamJob> self(this);
+    Deliver();
+    output_->job = nullptr;
+    session_->streaming_ = false;
+    db_->changeset_jobs_--;
+
+    Isolate* isolate = env_->isolate();
+    HandleScope handle_scope(isolate);
+    Local<Context> context = env_->context();
+    Context::Scope context_scope(context);
+    Local<Promise::Resolver> resolver = resolver_.Get(isolate);
+    if (status == UV_ECANCELED) {
+      USE(resolver->Reject(
+          context,
+          ERR_INVALID_STATE(isolate, "changeset stream was cancelled")));
+    } else if (!exception_.IsEmpty()) {
+      USE(resolver->Reject(context, exception_.Get(isolate)));
+    } else if (result_ != SQLITE_OK) {
+      Local<Object> e;
+      if (CreateSQLiteError(isolate, result_).ToLocal(&e)) {
+        USE(resolver->Reject(context, e));
+      }
+    } else {
+      USE(resolver->Resolve(context,
+                            Number::New(isolate, static_cast<double>(bytes_))));
+    }
+  }
+
+ private:
+  // The chunks that have been generated but not handed to JavaScript yet.
+  // Shared with the immediates that hand them over, which may run after the
+  // job is gone.
+  struct Output {
+    Mutex mutex;
+    std::vector<std::unique_ptr<BackingStore>> chunks;
+    bool flush_scheduled = false;
+    ChangesetStreamJob* job = nullptr;  // Only used on the main thread.
+  };
+
+  static int WriteOutput(void* data, const void* output, int length) {
+    ChangesetStreamJob* job = static_cast<ChangesetStreamJob*>(data);
+    if (job->cancelled_) return SQLITE_ABORT;
+    const char* input = static_cast<const char*>(output);
+    size_t remaining = length;
+    while (remaining > 0) {
+      if (job->chunk_ == nullptr) {
+        job->chunk_ = UncheckedMalloc<char>(job->chunk_size_);
+        if (job->chunk_ == nullptr) return SQLITE_NOMEM;
+      }
+      size_t n = std::min(remaining, job->chunk_size_ - job->chunk_length_);
+      memcpy(job->chunk_ + job->chunk_length_, input, n);
+      job->chunk_length_ += n;
+      input += n;
+      remaining -= n;
+      if (job->chunk_length_ == job->chunk_size_) job->PushChunk();
+    }
+    return SQLITE_OK;
+  }
+
+  void PushChunk() {
+    if (chunk_length_ == 0) return;
+    std::unique_ptr<BackingStore> store = ArrayBuffer::NewBackingStore(
+        chunk_,
+        chunk_length_,
+        [](void* data, size_t length, void* deleter_data) { free(data); },
+        nullptr);
+    chunk_ = nullptr;
+    chunk_length_ = 0;
+
+    bool schedule;
+    {
+      Mutex::ScopedLock lock(output_->mutex);
+      output_->chunks.push_back(std::move(store));
+      schedule = !output_->flush_scheduled;
+      output_->flush_scheduled = true;
+    }
+    if (schedule) {
+      env_->SetImmediateThreadsafe([output = output_](Environment* env) {
+        if (output->job != nullptr) output->job->Deliver();
+      });
+    }
+  }
+
+  void Deliver() {
+    std::vector<std::unique_ptr<BackingStore>> chunks;
+    {
+      Mutex::ScopedLock lock(output_->mutex);
+      chunks.swap(output_->chunks);
+      output_->flush_scheduled = false;
+    }
+    if (cancelled_ || !env_->can_call_into_js()) return;
+
+    Isolate* isolate = env_->isolate();
+    HandleScope handle_scope(isolate);
+    Local<Context> context = env_->context();
+    Context::Scope context_scope(context);
+    Local<Function> on_chunk = on_chunk_.Get(isolate);
+    for (auto& store : chunks) {
+      size_t length = store->ByteLength();
+      Local<ArrayBuffer> buffer = ArrayBuffer::New(isolate, std::move(store));
+      Local<Value> argv[] = {Uint8Array::New(buffer, 0, length)};
+      TryCatch try_catch(isolate);
+      if (on_chunk->Call(context, Null(isolate), arraysize(argv), argv)
+              .IsEmpty()) {
+        // Stops the generation, too.
+        cancelled_ = true;
+        if (try_catch.HasCaught() && try_catch.CanContinue()) {
+          exception_.Reset(isolate, try_catch.Exception());
+        }
+        return;
+      }
+      bytes_ += length;
+    }
+  }
+
+  Environment* env_;
+  BaseObjectPtr<DatabaseSync> db_;
+  BaseObjectPtr<Session> session_;
+  Sqlite3ChangesetStreamFunc generate_;
+  const size_t chunk_size_;
+  std::shared_ptr<Output> output_;
+  Global<Function> on_chunk_;
+  Global<Promise::Resolver> resolver_;
+  Global<Value> exception_;
+  std::atomic<bool> cancelled_{false};
+  // The chunk that is being filled, only used on the thread pool.
+  char* chunk_ = nullptr;
+  size_t chunk_length_ = 0;
+  int result_ = SQLITE_OK;
+  uint64_t bytes_ = 0;
+};
+
 template <Sqlite3ChangesetGenFunc sqliteChangesetFunc>
 void Session::Changeset(const FunctionCallbackInfo<Value>& args) {
   Session* session;
@@ -2604,6 +4080,72 @@ void Session::Changeset(const FunctionCallbackInfo<Value>& args) {
   args.GetReturnValue().Set(uint8Array);
 }
 
+// streamChangeset(onChunk[, options]) and streamPatchset() return a promise
+// that resolves to the size of the changeset once onChunk has been called
+// with all of its chunks.
+template <Sqlite3ChangesetStreamFunc sqliteChangesetFunc>
+void Session::StreamChangeset(const FunctionCallbackInfo<Value>& args) {
+  Session* session;
+  ASSIGN_OR_RETURN_UNWRAP(&session, args.This());
+  Environment* env = Environment::GetCurrent(args);
+  THROW_AND_RETURN_ON_BAD_STATE(
+      env, !session->database_->IsOpen(), "database is not open");
+  THROW_AND_RETURN_ON_BAD_STATE(
+      env, session->session_ == nullptr, "session is not open");
+  THROW_AND_RETURN_ON_BAD_STATE(
+      env, session->streaming_, "session is being streamed");
+
+  if (!args[0]->IsFunction()) {
+    THROW_ERR_INVALID_ARG_TYPE(
+        env->isolate(), "The \"onChunk\" argument must be a function.");
+    return;
+  }
+
+  size_t chunk_size = kDefaultChangesetChunkSize;
+  if (args.Length() > 1 && !args[1]->IsUndefined()) {
+    if (!args[1]->IsObject()) {
+      THROW_ERR_INVALID_ARG_TYPE(env->isolate(),
+                                 "The \"options\" argument must be an object.");
+      return;
+    }
+
+    Local<Value> chunk_size_v;
+    if (!args[1]
+             .As<Object>()
+             ->Get(env->context(),
+                   FIXED_ONE_BYTE_STRING(env->isolate(), "chunkSize"))
+             .ToLocal(&chunk_size_v)) {
+      return;
+    }
+
+    if (!chunk_size_v->IsUndefined()) {
+      if (!chunk_size_v->IsInt32() || chunk_size_v.As<Int32>()->Value() < 1) {
+        THROW_ERR_INVALID_ARG_TYPE(
+            env->isolate(),
+            "The \"options.chunkSize\" argument must be a positive integer.");
+        return;
+      }
+      chunk_size = chunk_size_v.As<Int32>()->Value();
+    }
+  }
+
+  Local<Promise::Resolver> resolver;
+  if (!Promise::Resolver::New(env->context()).ToLocal(&resolver)) {
+    return;
+  }
+
+  args.GetReturnValue().Set(resolver->GetPromise());
+  auto* job = new ChangesetStreamJob(
+      env,
+      BaseObjectPtr<DatabaseSync>(session->database_.get()),
+      BaseObjectPtr<Session>(session),
+      sqliteChangesetFunc,
+      chunk_size,
+      args[0].As<Function>(),
+      resolver);
+  job->ScheduleWork();
+}
+
 void Session::Close(const FunctionCallbackInfo<Value>& args) {
   Session* session;
   ASSIGN_OR_RETURN_UNWRAP(&session, args.This());
@@ -2612,6 +4154,8 @@ void Session::Close(const FunctionCallbackInfo<Value>& args) {
       env, !session->database_->IsOpen(), "database is not open");
   THROW_AND_RETURN_ON_BAD_STATE(
       env, session->session_ == nullptr, "session is not open");
+  THROW_AND_RETURN_ON_BAD_STATE(
+      env, session->streaming_, "session is being streamed");
 
   session->Delete();
 }
@@ -2623,14 +4167,845 @@ void Session::Delete() {
   session_ = nullptr;
 }
 
-void DefineConstants(Local<Object> target) {
-  NODE_DEFINE_CONSTANT(target, SQLITE_CHANGESET_OMIT);
-  NODE_DEFINE_CONSTANT(target, SQLITE_CHANGESET_REPLACE);
-  NODE_DEFINE_CONSTANT(target, SQLITE_CHANGESET_ABORT);
+// A value copied out of V8 or SQLite so that it can cross between the main
+// thread and the thread pool.
+using SQLiteValue = std::variant<std::monostate,  // NULL
+                                 double,
+                                 sqlite3_int64,
+                                 std::string,  // TEXT
+                                 std::vector<uint8_t>>;  // BLOB
+
+struct Database::Connection {
+  ~Connection() {
+    for (auto& entry : statements) sqlite3_finalize(entry.second);
+    sqlite3_close_v2(handle);
+  }
 
-  NODE_DEFINE_CONSTANT(target, SQLITE_CHANGESET_DATA);
-  NODE_DEFINE_CONSTANT(target, SQLITE_CHANGESET_NOTFOUND);
-  NODE_DEFINE_CONSTANT(target, SQLITE_CHANGESET_CONFLICT);
+  // Returns a cached prepared statement for `sql`, compiling it on first
+  // use. Statements are reused by every query run on this connection.
+  sqlite3_stmt* Prepare(const std::string& sql, int* result) {
+    auto it = statements.find(sql);
+    if (it != statements.end()) {
+      *result = SQLITE_OK;
+      return it->second;
+    }
+
+    sqlite3_stmt* stmt = nullptr;
+    *result = sqlite3_prepare_v3(handle,
+                                 sql.c_str(),
+                                 sql.size() + 1,
+                                 SQLITE_PREPARE_PERSISTENT,
+                                 &stmt,
+                                 nullptr);
+    if (*result != SQLITE_OK || stmt == nullptr) return nullptr;
+
+    if (statements.size() >= kMaxCachedStatements) {
+      for (auto& entry : statements) sqlite3_finalize(entry.second);
+      statements.clear();
+    }
+    statements.emplace(sql, stmt);
+    return stmt;
+  }
+
+  static constexpr size_t kMaxCachedStatements = 64;
+
+  sqlite3* handle = nullptr;
+  bool read_only = false;
+  std::unordered_map<std::string, sqlite3_stmt*> statements;
+};
+
+class DatabaseQueryJob : public ThreadPoolWork {
+ public:
+  DatabaseQueryJob(Environment* env,
+                   BaseObjectPtr<Database> db,
+                   Database::QueryKind kind,
+                   std::string sql)
+      : ThreadPoolWork(env, "node_sqlite3.DatabaseQueryJob"),
+        env_(env),
+        db_(std::move(db)),
+        kind_(kind),
+        sql_(std::move(sql)) {}
+
+  // Copies the statement parameters out of args, starting at `start`. As
+  // with StatementSync, a leading plain object provides named parameters and
+  // the remaining arguments are bound anonymously.
+  bool SetParams(const FunctionCallbackInfo<Value>& args, int start) {
+    if (start < args.Length() && args[start]->IsObject() &&
+        !args[start]->IsArrayBufferView()) {
+      Local<Object> obj = args[start].As<Object>();
+      Local<Context> context = env_->context();
+      Local<Array> keys;
+      if (!obj->GetOwnPropertyNames(context).ToLocal(&keys)) return false;
+
+      uint32_t len = keys->Length();
+      for (uint32_t j = 0; j < len; j++) {
+        Local<Value> key;
+        Local<Value> value;
+        if (!keys->Get(context, j).ToLocal(&key) ||
+            !obj->Get(context, key).ToLocal(&value)) {
+          return false;
+        }
+        Utf8Value utf8_key(env_->isolate(), key);
+        SQLiteValue param;
+        if (!ToSQLiteValue(value, named_params_.size() + 1, &param)) {
+          return false;
+        }
+        named_params_.emplace_back(utf8_key.ToString(), std::move(param));
+      }
+      start++;
+    }
+
+    for (int i = start; i < args.Length(); ++i) {
+      SQLiteValue param;
+      if (!ToSQLiteValue(args[i], i - start + 1, &param)) return false;
+      anonymous_params_.push_back(std::move(param));
+    }
+    return true;
+  }
+
+  void SetResolver(Local<Promise::Resolver> resolver) {
+    resolver_.Reset(env_->isolate(), resolver);
+  }
+
+  bool wants_writer() const {
+    return kind_ == Database::QueryKind::kRun ||
+           kind_ == Database::QueryKind::kExec || needs_writer_;
+  }
+
+  void Start(Database::Connection* connection) {
+    connection_ = connection;
+    ScheduleWork();
+  }
+
+  void DoThreadPoolWork() override {
+    sqlite3* db = connection_->handle;
+    if (kind_ == Database::QueryKind::kExec) {
+      error_code_ = sqlite3_exec(db, sql_.c_str(), nullptr, nullptr, nullptr);
+      if (error_code_ != SQLITE_OK) SaveError(db);
+      return;
+    }
+
+    sqlite3_stmt* stmt = connection_->Prepare(sql_, &error_code_);
+    if (stmt == nullptr) {
+      if (error_code_ != SQLITE_OK) SaveError(db);
+      return;
+    }
+
+    // Statements that turn out to write, such as INSERT ... RETURNING, have
+    // to be retried on the read-write connection.
+    if (connection_->read_only && !sqlite3_stmt_readonly(stmt)) {
+      needs_writer_ = true;
+      return;
+    }
+
+    auto reset = OnScopeLeave([&]() {
+      sqlite3_reset(stmt);
+      sqlite3_clear_bindings(stmt);
+    });
+    if (!Bind(stmt)) return;
+
+    int num_cols = sqlite3_column_count(stmt);
+    int r;
+    while ((r = sqlite3_step(stmt)) == SQLITE_ROW) {
+      // Like StatementSync::Run(), only step once and ignore any rows.
+      if (kind_ == Database::QueryKind::kRun) break;
+      if (column_names_.empty()) {
+        column_names_.reserve(num_cols);
+        for (int i = 0; i < num_cols; ++i) {
+          const char* name = sqlite3_column_name(stmt, i);
+          column_names_.emplace_back(name != nullptr ? name : "");
+        }
+      }
+      for (int i = 0; i < num_cols; ++i) {
+        values_.push_back(ColumnToSQLiteValue(stmt, i));
+      }
+      row_count_++;
+      if (kind_ == Database::QueryKind::kGet) break;
+    }
+
+    if (r != SQLITE_ROW && r != SQLITE_DONE) {
+      error_code_ = r;
+      SaveError(db);
+      return;
+    }
+
+    if (kind_ == Database::QueryKind::kRun) {
+      changes_ = sqlite3_changes64(db);
+      last_insert_rowid_ = sqlite3_last_insert_rowid(db);
+    }
+  }
+
+  void AfterThreadPoolWork(int status) override {
+    std::unique_ptr<DatabaseQueryJob> self(this);
+    BaseObjectPtr<Database> db = db_;
+    db->Release(connection_);
+    connection_ = nullptr;
+
+    if (status == 0 && needs_writer_) {
+      db->Enqueue(std::move(self));
+      db->Dispatch();
+      return;
+    }
+
+    {
+      Isolate* isolate = env_->isolate();
+      HandleScope handle_scope(isolate);
+      Local<Context> context = env_->context();
+      Context::Scope context_scope(context);
+      Local<Promise::Resolver> resolver = resolver_.Get(isolate);
+
+      TryCatch try_catch(isolate);
+      Local<Value> result;
+      if (status == UV_ECANCELED) {
+        result = ERR_INVALID_STATE(isolate, "query was cancelled");
+        USE(resolver->Reject(context, result));
+      } else if (!error_message_.empty() || error_code_ != SQLITE_OK) {
+        Local<Object> e;
+        if (CreateSQLiteError(isolate, error_code_, error_message_.c_str())
+                .ToLocal(&e)) {
+          USE(resolver->Reject(context, e));
+        } else if (try_catch.HasCaught() && try_catch.CanContinue()) {
+          USE(resolver->Reject(context, try_catch.Exception()));
+        }
+      } else if (ToResult().ToLocal(&result)) {
+        USE(resolver->Resolve(context, result));
+      } else if (try_catch.HasCaught() && try_catch.CanContinue()) {
+        USE(resolver->Reject(context, try_catch.Exception()));
+      }
+    }
+
+    self.reset();
+    db->Dispatch();
+  }
+
+ private:
+  bool ToSQLiteValue(Local<Value> value, size_t index, SQLiteValue* out) {
+    if (value->IsNumber()) {
+      *out = value.As<Number>()->Value();
+    } else if (value->IsString()) {
+      Utf8Value val(env_->isolate(), value.As<String>());
+      *out = val.ToString();
+    } else if (value->IsNull()) {
+      *out = std::monostate();
+    } else if (value->IsArrayBufferView()) {
+      ArrayBufferViewContents<uint8_t> buf(value);
+      *out = std::vector<uint8_t>(buf.data(), buf.data() + buf.length());
+    } else if (value->IsBigInt()) {
+      bool lossless;
+      int64_t as_int = value.As<BigInt>()->Int64Value(&lossless);
+      if (!lossless) {
+        THROW_ERR_INVALID_ARG_VALUE(env_, "BigInt value is too large to bind.");
+        return false;
+      }
+      *out = static_cast<sqlite3_int64>(as_int);
+    } else {
+      THROW_ERR_INVALID_ARG_TYPE(
+          env_->isolate(),
+          "Provided value cannot be bound to SQLite parameter %d.",
+          index);
+      return false;
+    }
+    return true;
+  }
+
+  static SQLiteValue ColumnToSQLiteValue(sqlite3_stmt* stmt, int column) {
+    switch (sqlite3_column_type(stmt, column)) {
+      case SQLITE_INTEGER:
+        return sqlite3_column_int64(stmt, column);
+      case SQLITE_FLOAT:
+        return sqlite3_column_double(stmt, column);
+      case SQLITE_TEXT: {
+        const char* text =
+            reinterpret_cast<const char*>(sqlite3_column_text(stmt, column));
+        return std::string(text, sqlite3_column_bytes(stmt, column));
+      }
+      case SQLITE_BLOB: {
+        auto data =
+            static_cast<const uint8_t*>(sqlite3_column_blob(stmt, column));
+        return std::vector<uint8_t>(
+            data, data + sqlite3_column_bytes(stmt, column));
+      }
+      case SQLITE_NULL:
+        return std::monostate();
+      default:
+        UNREACHABLE("Bad SQLite value");
+    }
+  }
+
+  bool BindValue(sqlite3_stmt* stmt, int index, const SQLiteValue& value) {
+    int r;
+    if (std::holds_alternative<double>(value)) {
+      r = sqlite3_bind_double(stmt, index, std::get<double>(value));
+    } else if (std::holds_alternative<sqlite3_int64>(value)) {
+      r = sqlite3_bind_int64(stmt, index, std::get<sqlite3_int64>(value));
+    } else if (std::holds_alternative<std::string>(value)) {
+      const std::string& text = std::get<std::string>(value);
+      r = sqlite3_bind_text(
+          stmt, index, text.data(), text.size(), SQLITE_STATIC);
+    } else if (std::holds_alternative<std::vector<uint8_t>>(value)) {
+      const std::vector<uint8_t>& blob = std::get<std::vector<uint8_t>>(value);
+      r = sqlite3_bind_blob(
+          stmt, index, blob.data(), blob.size(), SQLITE_STATIC);
+    } else {
+      r = sqlite3_bind_null(stmt, index);
+    }
+
+    if (r != SQLITE_OK) {
+      error_code_ = r;
+      SaveError(connection_->handle);
+      return false;
+    }
+    return true;
+  }
+
+  // The parameter values stay alive in this job until the statement has been
+  // reset, so they can be bound without copying.
+  bool Bind(sqlite3_stmt* stmt) {
+    for (const auto& [name, value] : named_params_) {
+      int index = sqlite3_bind_parameter_index(stmt, name.c_str());
+      // Like setAllowBareNamedParameters(true), accept names without their
+      // prefix character.
+      for (const char* prefix : {":", "$", "@"}) {
+        if (index != 0) break;
+        index = sqlite3_bind_parameter_index(stmt, (prefix + name).c_str());
+      }
+      if (index == 0) {
+        error_code_ = SQLITE_RANGE;
+        error_message_ = "Unknown named parameter '" + name + "'";
+        return false;
+      }
+      if (!BindValue(stmt, index, value)) return false;
+    }
+
+    int anon_idx = 1;
+    for (const SQLiteValue& value : anonymous_params_) {
+      while (sqlite3_bind_parameter_name(stmt, anon_idx) != nullptr) {
+        anon_idx++;
+      }
+      if (!BindValue(stmt, anon_idx++, value)) return false;
+    }
+    return true;
+  }
+
+  void SaveError(sqlite3* db) {
+    error_code_ = sqlite3_extended_errcode(db);
+    error_message_ = sqlite3_errmsg(db);
+  }
+
+  MaybeLocal<Value> ToJSValue(const SQLiteValue& value) {
+    Isolate* isolate = env_->isolate();
+    if (std::holds_alternative<double>(value)) {
+      return Number::New(isolate, std::get<double>(value));
+    } else if (std::holds_alternative<sqlite3_int64>(value)) {
+      sqlite3_int64 val = std::get<sqlite3_int64>(value);
+      if (db_->read_big_ints_) {
+        return BigInt::New(isolate, val);
+      } else if (std::abs(val) <= kMaxSafeJsInteger) {
+        return Number::New(isolate, val);
+      }
+      THROW_ERR_OUT_OF_RANGE(isolate,
+                             "Value is too large to be represented as a "
+                             "JavaScript number: %" PRId64,
+                             val);
+      return MaybeLocal<Value>();
+    } else if (std::holds_alternative<std::string>(value)) {
+      const std::string& text = std::get<std::string>(value);
+      return String::NewFromUtf8(
+                 isolate, text.data(), NewStringType::kNormal, text.size())
+          .As<Value>();
+    } else if (std::holds_alternative<std::vector<uint8_t>>(value)) {
+      const std::vector<uint8_t>& blob = std::get<std::vector<uint8_t>>(value);
+      auto store = ArrayBuffer::NewBackingStore(isolate, blob.size());
+      if (!blob.empty()) memcpy(store->Data(), blob.data(), blob.size());
+      auto ab = ArrayBuffer::New(isolate, std::move(store));
+      return Uint8Array::New(ab, 0, blob.size()).As<Value>();
+    }
+    return Null(isolate).As<Value>();
+  }
+
+  MaybeLocal<Value> ToResult() {
+    Isolate* isolate = env_->isolate();
+    Local<Context> context = env_->context();
+
+    if (kind_ == Database::QueryKind::kExec) {
+      return Undefined(isolate).As<Value>();
+    }
+
+    if (kind_ == Database::QueryKind::kRun) {
+      Local<Object> result = Object::New(isolate);
+      Local<Value> last_insert_rowid_val;
+      Local<Value> changes_val;
+      if (db_->read_big_ints_) {
+        last_insert_rowid_val = BigInt::New(isolate, last_insert_rowid_);
+        changes_val = BigInt::New(isolate, changes_);
+      } else {
+        last_insert_rowid_val = Number::New(isolate, last_insert_rowid_);
+        changes_val = Number::New(isolate, changes_);
+      }
+      if (result
+              ->Set(context,
+                    env_->last_insert_rowid_string(),
+                    last_insert_rowid_val)
+              .IsNothing() ||
+          result->Set(context, env_->changes_string(), changes_val)
+              .IsNothing()) {
+        return MaybeLocal<Value>();
+      }
+      return result;
+    }
+
+    if (kind_ == Database::QueryKind::kGet && row_count_ == 0) {
+      return Undefined(isolate).As<Value>();
+    }
+
+    const size_t num_cols = column_names_.size();
+    LocalVector<Name> keys(isolate);
+    keys.reserve(num_cols);
+    for (const std::string& name : column_names_) {
+      Local<String> key;
+      if (!String::NewFromUtf8(
+               isolate, name.data(), NewStringType::kNormal, name.size())
+               .ToLocal(&key)) {
+        return MaybeLocal<Value>();
+      }
+      keys.emplace_back(key);
+    }
+
+    LocalVector<Value> rows(isolate);
+    rows.reserve(row_count_);
+    LocalVector<Value> row_values(isolate);
+    row_values.reserve(num_cols);
+    for (size_t row = 0; row < row_count_; row++) {
+      row_values.clear();
+      for (size_t i = 0; i < num_cols; i++) {
+        Local<Value> val;
+        if (!ToJSValue(values_[row * num_cols + i]).ToLocal(&val)) {
+          return MaybeLocal<Value>();
+        }
+        row_values.emplace_back(val);
+      }
+      rows.emplace_back(Object::New(
+          isolate, Null(isolate), keys.data(), row_values.data(), num_cols));
+    }
+
+    if (kind_ == Database::QueryKind::kGet) return rows[0];
+    return Array::New(isolate, rows.data(), rows.size()).As<Value>();
+  }
+
+  Environment* env_;
+  BaseObjectPtr<Database> db_;
+  Database::QueryKind kind_;
+  std::string sql_;
+  Global<Promise::Resolver> resolver_;
+  Database::Connection* connection_ = nullptr;
+  bool needs_writer_ = false;
+
+  std::vector<std::pair<std::string, SQLiteValue>> named_params_;
+  std::vector<SQLiteValue> anonymous_params_;
+
+  int error_code_ = SQLITE_OK;
+  std::string error_message_;
+  std::vector<std::string> column_names_;
+  std::vector<SQLiteValue> values_;
+  size_t row_count_ = 0;
+  sqlite3_int64 changes_ = 0;
+  sqlite3_int64 last_insert_rowid_ = 0;
+};
+
+Database::Database(Environment* env,
+                   Local<Object> object,
+                   DatabaseOpenConfiguration&& open_config,
+                   bool read_big_ints)
+    : BaseObject(env, object),
+      open_config_(std::move(open_config)),
+      read_big_ints_(read_big_ints) {
+  MakeWeak();
+}
+
+Database::~Database() {
+  CloseConnections();
+}
+
+void Database::MemoryInfo(MemoryTracker* tracker) const {
+  tracker->TrackFieldWithSize(
+      "open_config", sizeof(open_config_), "DatabaseOpenConfiguration");
+  tracker->TrackFieldWithSize("connections",
+                              connections_.size() * sizeof(Connection),
+                              "Database::Connection");
+}
+
+inline bool Database::IsOpen() {
+  return writer_ != nullptr && !closing_;
+}
+
+// Sets `*wal` to whether `connection` uses write-ahead logging.
+static int IsWALMode(sqlite3* connection, bool* wal) {
+  sqlite3_stmt* stmt;
+  int r = sqlite3_prepare_v2(
+      connection, "PRAGMA journal_mode", -1, &stmt, nullptr);
+  if (r != SQLITE_OK) return r;
+  r = sqlite3_step(stmt);
+  if (r == SQLITE_ROW) {
+    const unsigned char* mode = sqlite3_column_text(stmt, 0);
+    *wal = mode != nullptr &&
+           sqlite3_stricmp(reinterpret_cast<const char*>(mode), "wal") == 0;
+    r = SQLITE_OK;
+  }
+  sqlite3_finalize(stmt);
+  return r == SQLITE_DONE ? SQLITE_OK : r;
+}
+
+bool Database::Open(int readers, bool enable_wal) {
+  Isolate* isolate = env()->isolate();
+  const std::string& location = open_config_.location();
+  // Every connection to an in-memory database would get its own, empty
+  // database, so only a single connection can be used for those.
+  if (location == ":memory:" || location.starts_with("file::memory:") ||
+      location.empty()) {
+    readers = 0;
+  }
+
+  for (int i = 0; i <= readers; i++) {
+    const bool read_only = i > 0 || open_config_.get_read_only();
+    auto connection = std::make_unique<Connection>();
+    connection->read_only = read_only;
+    int flags = SQLITE_OPEN_URI |
+                (read_only ? SQLITE_OPEN_READONLY
+                           : SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE);
+    if (open_config_.get_shared_cache()) flags |= SQLITE_OPEN_SHAREDCACHE;
+    int r = sqlite3_open_v2(
+        location.c_str(), &connection->handle, flags, nullptr);
+    if (r == SQLITE_OK) {
+      r = sqlite3_db_config(connection->handle,
+                            SQLITE_DBCONFIG_DQS_DML,
+                            static_cast<int>(open_config_.get_enable_dqs()),
+                            nullptr);
+    }
+    if (r == SQLITE_OK) {
+      r = sqlite3_db_config(connection->handle,
+                            SQLITE_DBCONFIG_DQS_DDL,
+                            static_cast<int>(open_config_.get_enable_dqs()),
+                            nullptr);
+    }
+    if (r == SQLITE_OK) {
+      r = sqlite3_db_config(
+          connection->handle,
+          SQLITE_DBCONFIG_ENABLE_FKEY,
+          static_cast<int>(open_config_.get_enable_foreign_keys()),
+          nullptr);
+    }
+    // The journal mode is stored in the database, so it is only changed on
+    // request.
+    if (r == SQLITE_OK && i == 0 && enable_wal && !read_only) {
+      r = sqlite3_exec(connection->handle,
+                       "PRAGMA journal_mode=WAL",
+                       nullptr,
+                       nullptr,
+                       nullptr);
+    }
+    // Without WAL, readers would block the writer and the other way around,
+    // so all queries go through the read-write connection then.
+    if (r == SQLITE_OK && i == 0 && readers > 0 && !read_only) {
+      bool wal = false;
+      r = IsWALMode(connection->handle, &wal);
+      if (!wal) readers = 0;
+    }
+    if (r == SQLITE_OK) {
+      r = ConfigurePageCache(connection->handle, open_config_);
+    }
+    if (r != SQLITE_OK) {
+      Local<Object> e;
+      if (connection->handle != nullptr &&
+          CreateSQLiteError(isolate, connection->handle).ToLocal(&e)) {
+        isolate->ThrowException(e);
+      } else {
+        THROW_ERR_SQLITE_ERROR(isolate, r);
+      }
+      CloseConnections();
+      return false;
+    }
+    sqlite3_busy_timeout(connection->handle, open_config_.get_timeout());
+
+    if (i == 0) {
+      writer_ = connection.get();
+    } else {
+      idle_readers_.push_back(connection.get());
+    }
+    connections_.push_back(std::move(connection));
+  }
+
+  return true;
+}
+
+void Database::CloseConnections() {
+  CHECK_EQ(running_, 0);
+  idle_readers_.clear();
+  writer_ = nullptr;
+  connections_.clear();
+}
+
+void Database::Enqueue(std::unique_ptr<DatabaseQueryJob> job) {
+  if (job->wants_writer()) {
+    pending_writes_.push_back(std::move(job));
+  } else {
+    pending_reads_.push_back(std::move(job));
+  }
+}
+
+void Database::Start(std::unique_ptr<DatabaseQueryJob> job,
+                     Connection* connection) {
+  running_++;
+  // The job owns itself until AfterThreadPoolWork().
+  job.release()->Start(connection);
+}
+
+void Database::Release(Connection* connection) {
+  CHECK_GT(running_, 0);
+  running_--;
+  if (connection == writer_) {
+    writer_busy_ = false;
+  } else {
+    idle_readers_.push_back(connection);
+  }
+}
+
+void Database::Dispatch() {
+  if (writer_ != nullptr && !writer_busy_ && !pending_writes_.empty()) {
+    writer_busy_ = true;
+    std::unique_ptr<DatabaseQueryJob> job = std::move(pending_writes_.front());
+    pending_writes_.pop_front();
+    Start(std::move(job), writer_);
+  }
+
+  while (!pending_reads_.empty()) {
+    Connection* connection;
+    if (!idle_readers_.empty()) {
+      connection = idle_readers_.back();
+      idle_readers_.pop_back();
+    } else if (writer_ != nullptr && !writer_busy_ &&
+               pending_writes_.empty()) {
+      // Lend the read-write connection to readers while nobody writes.
+      writer_busy_ = true;
+      connection = writer_;
+    } else {
+      break;
+    }
+    std::unique_ptr<DatabaseQueryJob> job = std::move(pending_reads_.front());
+    pending_reads_.pop_front();
+    Start(std::move(job), connection);
+  }
+
+  if (closing_ && running_ == 0 && pending_writes_.empty() &&
+      pending_reads_.empty() && !close_resolver_.IsEmpty()) {
+    CloseConnections();
+    Isolate* isolate = env()->isolate();
+    HandleScope handle_scope(isolate);
+    Local<Promise::Resolver> resolver = close_resolver_.Get(isolate);
+    close_resolver_.Reset();
+    USE(resolver->Resolve(env()->context(), Undefined(isolate)));
+  }
+}
+
+void Database::New(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  if (!args.IsConstructCall()) {
+    THROW_ERR_CONSTRUCT_CALL_REQUIRED(env);
+    return;
+  }
+
+  std::optional<std::string> location =
+      ValidateDatabasePath(env, args[0], "path");
+  if (!location.has_value()) {
+    return;
+  }
+
+  DatabaseOpenConfiguration open_config(std::move(location.value()));
+  bool read_big_ints = false;
+  int readers = 4;
+  bool enable_wal = false;
+  if (args.Length() > 1) {
+    if (!args[1]->IsObject()) {
+      THROW_ERR_INVALID_ARG_TYPE(env->isolate(),
+                                 "The \"options\" argument must be an object.");
+      return;
+    }
+
+    Local<Object> options = args[1].As<Object>();
+    auto get_boolean = [&](const char* name, bool* out) {
+      Local<Value> value;
+      if (!options
+               ->Get(env->context(), OneByteString(env->isolate(), name))
+               .ToLocal(&value)) {
+        return false;
+      }
+      if (value->IsUndefined()) return true;
+      if (!value->IsBoolean()) {
+        THROW_ERR_INVALID_ARG_TYPE(
+            env->isolate(),
+            "The \"options.%s\" argument must be a boolean.",
+            name);
+        return false;
+      }
+      *out = value.As<Boolean>()->Value();
+      return true;
+    };
+    auto get_int32 = [&](const char* name, int* out, int min) {
+      Local<Value> value;
+      if (!options
+               ->Get(env->context(), OneByteString(env->isolate(), name))
+               .ToLocal(&value)) {
+        return false;
+      }
+      if (value->IsUndefined()) return true;
+      if (!value->IsInt32() || value.As<Int32>()->Value() < min) {
+        THROW_ERR_INVALID_ARG_TYPE(
+            env->isolate(),
+            "The \"options.%s\" argument must be an integer >= %d.",
+            name,
+            min);
+        return false;
+      }
+      *out = value.As<Int32>()->Value();
+      return true;
+    };
+
+    bool read_only = open_config.get_read_only();
+    bool enable_foreign_keys = open_config.get_enable_foreign_keys();
+    bool enable_dqs = open_config.get_enable_dqs();
+    int timeout = open_config.get_timeout();
+    int64_t mmap_size = open_config.get_mmap_size();
+    int cache_size = open_config.get_cache_size();
+    bool shared_cache = open_config.get_shared_cache();
+    auto get_mmap_size = [&]() {
+      Local<Value> value;
+      if (!options
+               ->Get(env->context(),
+                     FIXED_ONE_BYTE_STRING(env->isolate(), "mmapSize"))
+               .ToLocal(&value)) {
+        return false;
+      }
+      if (value->IsUndefined()) return true;
+      std::optional<int64_t> size = GetMmapSize(value);
+      if (!size.has_value()) {
+        THROW_ERR_INVALID_ARG_TYPE(
+            env->isolate(),
+            "The \"options.mmapSize\" argument must be a non-negative "
+            "integer.");
+        return false;
+      }
+      mmap_size = *size;
+      return true;
+    };
+    Local<Value> readers_v;
+    if (!options
+             ->Get(env->context(),
+                   FIXED_ONE_BYTE_STRING(env->isolate(), "readers"))
+             .ToLocal(&readers_v)) {
+      return;
+    }
+    if (!get_boolean("readOnly", &read_only) ||
+        !get_boolean("enableForeignKeyConstraints", &enable_foreign_keys) ||
+        !get_boolean("enableDoubleQuotedStringLiterals", &enable_dqs) ||
+        !get_boolean("readBigInts", &read_big_ints) ||
+        !get_int32("timeout", &timeout, 0) ||
+        !get_int32("readers", &readers, 0) ||
+        !get_boolean("enableWAL", &enable_wal) ||
+        !get_mmap_size() ||
+        !get_int32("cacheSize", &cache_size, INT_MIN) ||
+        !get_boolean("sharedCache", &shared_cache)) {
+      return;
+    }
+    // Connections that share a cache lock each other out at the table
+    // level, so readers would fail with SQLITE_LOCKED_SHAREDCACHE while the
+    // writer is busy instead of running concurrently.
+    if (shared_cache && readers > 0) {
+      if (!readers_v->IsUndefined()) {
+        THROW_ERR_INVALID_ARG_VALUE(
+            env->isolate(),
+            "The \"options.readers\" argument must be 0 when "
+            "\"options.sharedCache\" is true.");
+        return;
+      }
+      readers = 0;
+    }
+    open_config.set_read_only(read_only);
+    open_config.set_enable_foreign_keys(enable_foreign_keys);
+    open_config.set_enable_dqs(enable_dqs);
+    open_config.set_timeout(timeout);
+    open_config.set_mmap_size(mmap_size);
+    open_config.set_cache_size(cache_size);
+    open_config.set_shared_cache(shared_cache);
+  }
+
+  Database* db =
+      new Database(env, args.This(), std::move(open_config), read_big_ints);
+  db->Open(readers, enable_wal);
+}
+
+template <Database::QueryKind kind>
+void Database::Query(const FunctionCallbackInfo<Value>& args) {
+  Database* db;
+  ASSIGN_OR_RETURN_UNWRAP(&db, args.This());
+  Environment* env = Environment::GetCurrent(args);
+  THROW_AND_RETURN_ON_BAD_STATE(env, !db->IsOpen(), "database is not open");
+
+  if (!args[0]->IsString()) {
+    THROW_ERR_INVALID_ARG_TYPE(env->isolate(),
+                               "The \"sql\" argument must be a string.");
+    return;
+  }
+
+  Utf8Value sql(env->isolate(), args[0].As<String>());
+  auto job = std::make_unique<DatabaseQueryJob>(
+      env, BaseObjectPtr<Database>(db), kind, sql.ToString());
+  if (kind != QueryKind::kExec && !job->SetParams(args, 1)) {
+    return;
+  }
+
+  Local<Promise::Resolver> resolver;
+  if (!Promise::Resolver::New(env->context()).ToLocal(&resolver)) {
+    return;
+  }
+  job->SetResolver(resolver);
+  args.GetReturnValue().Set(resolver->GetPromise());
+
+  db->Enqueue(std::move(job));
+  db->Dispatch();
+}
+
+void Database::Close(const FunctionCallbackInfo<Value>& args) {
+  Database* db;
+  ASSIGN_OR_RETURN_UNWRAP(&db, args.This());
+  Environment* env = Environment::GetCurrent(args);
+  THROW_AND_RETURN_ON_BAD_STATE(env, !db->IsOpen(), "database is not open");
+
+  Local<Promise::Resolver> resolver;
+  if (!Promise::Resolver::New(env->context()).ToLocal(&resolver)) {
+    return;
+  }
+  args.GetReturnValue().Set(resolver->GetPromise());
+
+  // Queries that were already accepted still run; the connections are
+  // closed once the last of them has settled.
+  db->closing_ = true;
+  db->close_resolver_.Reset(env->isolate(), resolver);
+  db->Dispatch();
+}
+
+void Database::IsOpenGetter(const FunctionCallbackInfo<Value>& args) {
+  Database* db;
+  ASSIGN_OR_RETURN_UNWRAP(&db, args.This());
+  args.GetReturnValue().Set(db->IsOpen());
+}
+
+void DefineConstants(Local<Object> target) {
+  NODE_DEFINE_CONSTANT(target, SQLITE_CHANGESET_OMIT);
+  NODE_DEFINE_CONSTANT(target, SQLITE_CHANGESET_REPLACE);
+  NODE_DEFINE_CONSTANT(target, SQLITE_CHANGESET_ABORT);
+
+  NODE_DEFINE_CONSTANT(target, SQLITE_CHANGESET_DATA);
+  NODE_DEFINE_CONSTANT(target, SQLITE_CHANGESET_NOTFOUND);
+  NODE_DEFINE_CONSTANT(target, SQLITE_CHANGESET_CONFLICT);
   NODE_DEFINE_CONSTANT(target, SQLITE_CHANGESET_CONSTRAINT);
   NODE_DEFINE_CONSTANT(target, SQLITE_CHANGESET_FOREIGN_KEY);
 }
@@ -2662,12 +5037,20 @@ static void Initialize(Local<Object> target,
       isolate, db_tmpl, "createSession", DatabaseSync::CreateSession);
   SetProtoMethod(
       isolate, db_tmpl, "applyChangeset", DatabaseSync::ApplyChangeset);
+  SetProtoMethod(isolate,
+                 db_tmpl,
+                 "applyChangesetAsync",
+                 DatabaseSync::ApplyChangesetAsync);
   SetProtoMethod(isolate,
                  db_tmpl,
                  "enableLoadExtension",
                  DatabaseSync::EnableLoadExtension);
   SetProtoMethod(
       isolate, db_tmpl, "loadExtension", DatabaseSync::LoadExtension);
+  SetProtoMethodNoSideEffect(isolate,
+                             db_tmpl,
+                             "statementCacheStats",
+                             DatabaseSync::StatementCacheStats);
   SetSideEffectFreeGetter(isolate,
                           db_tmpl,
                           FIXED_ONE_BYTE_STRING(isolate, "isOpen"),
@@ -2677,6 +5060,33 @@ static void Initialize(Local<Object> target,
                           FIXED_ONE_BYTE_STRING(isolate, "isTransaction"),
                           DatabaseSync::IsTransactionGetter);
   SetConstructorFunction(context, target, "DatabaseSync", db_tmpl);
+
+  Local<FunctionTemplate> async_db_tmpl =
+      NewFunctionTemplate(isolate, Database::New);
+  async_db_tmpl->InstanceTemplate()->SetInternalFieldCount(
+      Database::kInternalFieldCount);
+  SetProtoMethod(isolate,
+                 async_db_tmpl,
+                 "all",
+                 Database::Query<Database::QueryKind::kAll>);
+  SetProtoMethod(isolate,
+                 async_db_tmpl,
+                 "get",
+                 Database::Query<Database::QueryKind::kGet>);
+  SetProtoMethod(isolate,
+                 async_db_tmpl,
+                 "run",
+                 Database::Query<Database::QueryKind::kRun>);
+  SetProtoMethod(isolate,
+                 async_db_tmpl,
+                 "exec",
+                 Database::Query<Database::QueryKind::kExec>);
+  SetProtoMethod(isolate, async_db_tmpl, "close", Database::Close);
+  SetSideEffectFreeGetter(isolate,
+                          async_db_tmpl,
+                          FIXED_ONE_BYTE_STRING(isolate, "isOpen"),
+                          Database::IsOpenGetter);
+  SetConstructorFunction(context, target, "Database", async_db_tmpl);
   SetConstructorFunction(context,
                          target,
                          "StatementSync",
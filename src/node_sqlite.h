@@ -8,7 +8,11 @@
 #include "sqlite3.h"
 #include "util.h"
 
+#include <deque>
+#include <list>
 #include <map>
+#include <memory>
+#include <unordered_map>
 #include <unordered_set>
 
 namespace node {
@@ -39,12 +43,42 @@ class DatabaseOpenConfiguration {
 
   inline int get_timeout() { return timeout_; }
 
+  inline void set_statement_cache_size(int size) {
+    statement_cache_size_ = size;
+  }
+
+  inline int get_statement_cache_size() const { return statement_cache_size_; }
+
+  // Maps up to this many bytes of the database file into memory, so that
+  // connections in the same process, e.g. in different workers, read the
+  // pages from the operating system's page cache instead of copying them
+  // into their own caches. 0 disables memory-mapped I/O.
+  inline void set_mmap_size(int64_t size) { mmap_size_ = size; }
+
+  inline int64_t get_mmap_size() const { return mmap_size_; }
+
+  // The size of the page cache, as in PRAGMA cache_size: pages if positive,
+  // KiB if negative. 0 keeps SQLite's default.
+  inline void set_cache_size(int size) { cache_size_ = size; }
+
+  inline int get_cache_size() const { return cache_size_; }
+
+  // Whether connections to the same file in the process share one page
+  // cache, see https://sqlite.org/sharedcache.html.
+  inline void set_shared_cache(bool flag) { shared_cache_ = flag; }
+
+  inline bool get_shared_cache() const { return shared_cache_; }
+
  private:
   std::string location_;
   bool read_only_ = false;
   bool enable_foreign_keys_ = true;
   bool enable_dqs_ = false;
   int timeout_ = 0;
+  int statement_cache_size_ = 0;
+  int64_t mmap_size_ = 0;
+  int cache_size_ = 0;
+  bool shared_cache_ = false;
 };
 
 class StatementSync;
@@ -72,9 +106,13 @@ class DatabaseSync : public BaseObject {
       const v8::FunctionCallbackInfo<v8::Value>& args);
   static void CreateSession(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void ApplyChangeset(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void ApplyChangesetAsync(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
   static void EnableLoadExtension(
       const v8::FunctionCallbackInfo<v8::Value>& args);
   static void LoadExtension(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void StatementCacheStats(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
   void FinalizeStatements();
   void RemoveBackup(BackupJob* backup);
   void AddBackup(BackupJob* backup);
@@ -97,6 +135,18 @@ class DatabaseSync : public BaseObject {
   bool Open();
   void DeleteSessions();
 
+  // Opt-in LRU cache of prepared statements keyed by SQL text. An entry
+  // keeps the sqlite3_stmt of a garbage collected StatementSync around, so
+  // that the next prepare() of the same SQL skips compilation. Statements
+  // that are in use are never in the cache.
+  struct CachedStatement {
+    sqlite3_stmt* idle = nullptr;
+    std::list<std::string>::iterator lru_position;
+  };
+  sqlite3_stmt* TakeCachedStatement(const std::string& sql);
+  bool ReleaseCachedStatement(StatementSync* statement);
+  void ClearStatementCache();
+
   ~DatabaseSync() override;
   DatabaseOpenConfiguration open_config_;
   bool allow_load_extension_;
@@ -107,8 +157,21 @@ class DatabaseSync : public BaseObject {
   std::set<BackupJob*> backups_;
   std::set<sqlite3_session*> sessions_;
   std::unordered_set<StatementSync*> statements_;
-
+  std::unordered_map<std::string, CachedStatement> statement_cache_;
+  std::list<std::string> statement_cache_lru_;  // Most recently used first.
+  uint64_t statement_cache_hits_ = 0;
+  uint64_t statement_cache_misses_ = 0;
+  // Jobs that use the connection on the thread pool.
+  int changeset_jobs_ = 0;
+  // Whether JavaScript functions or aggregates are registered with the
+  // connection. Triggers and constraints can call them while a changeset is
+  // applied, which must then not happen on the thread pool.
+  bool has_user_functions_ = false;
+
+  friend class ChangesetApplyJob;
+  friend class ChangesetStreamJob;
   friend class Session;
+  friend class StatementSync;
 };
 
 class StatementSync : public BaseObject {
@@ -127,6 +190,8 @@ class StatementSync : public BaseObject {
   static void Iterate(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Get(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Run(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void RunMany(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void RunColumns(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Columns(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SourceSQLGetter(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void ExpandedSQLGetter(
@@ -137,6 +202,8 @@ class StatementSync : public BaseObject {
       const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetReadBigInts(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetReturnArrays(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetReturnColumns(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
   void Finalize();
   bool IsFinalized();
 
@@ -148,15 +215,26 @@ class StatementSync : public BaseObject {
   BaseObjectPtr<DatabaseSync> db_;
   sqlite3_stmt* statement_;
   bool return_arrays_ = false;
+  bool return_columns_ = false;
   bool use_big_ints_;
   bool allow_bare_named_params_;
   bool allow_unknown_named_params_;
   std::optional<std::map<std::string, std::string>> bare_named_params_;
-  bool BindParams(const v8::FunctionCallbackInfo<v8::Value>& args);
+  // The SQL of the statement if it can go into DatabaseSync's cache once
+  // it is garbage collected.
+  std::string cache_key_;
+  // |Params| is either the FunctionCallbackInfo of e.g. run() or a row of
+  // runMany(), anything with Length() and operator[].
+  template <typename Params>
+  bool BindParams(const Params& args);
   bool BindValue(const v8::Local<v8::Value>& value, const int index);
+  // Steps the bound statement once, discarding any rows it returns.
+  bool StepRow();
   v8::MaybeLocal<v8::Value> ColumnToValue(const int column);
   v8::MaybeLocal<v8::Name> ColumnNameToName(const int column);
+  v8::MaybeLocal<v8::Value> StepToColumns();
 
+  friend class DatabaseSync;
   friend class StatementSyncIterator;
 };
 
@@ -183,6 +261,8 @@ class StatementSyncIterator : public BaseObject {
 };
 
 using Sqlite3ChangesetGenFunc = int (*)(sqlite3_session*, int*, void**);
+using Sqlite3ChangesetStreamFunc =
+    int (*)(sqlite3_session*, int (*)(void*, const void*, int), void*);
 
 class Session : public BaseObject {
  public:
@@ -193,6 +273,8 @@ class Session : public BaseObject {
   ~Session() override;
   template <Sqlite3ChangesetGenFunc sqliteChangesetFunc>
   static void Changeset(const v8::FunctionCallbackInfo<v8::Value>& args);
+  template <Sqlite3ChangesetStreamFunc sqliteChangesetFunc>
+  static void StreamChangeset(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Close(const v8::FunctionCallbackInfo<v8::Value>& args);
   static v8::Local<v8::FunctionTemplate> GetConstructorTemplate(
       Environment* env);
@@ -208,6 +290,60 @@ class Session : public BaseObject {
   void Delete();
   sqlite3_session* session_;
   BaseObjectWeakPtr<DatabaseSync> database_;  // The Parent Database
+  bool streaming_ = false;
+
+  friend class ChangesetStreamJob;
+};
+
+class DatabaseQueryJob;
+
+// The asynchronous counterpart of DatabaseSync. Statements run on the libuv
+// thread pool against a small set of connections: a read-write connection
+// through which all writes are serialized and, for file databases in WAL mode,
+// a number of read-only connections that let readers proceed concurrently.
+class Database : public BaseObject {
+ public:
+  enum class QueryKind { kAll, kGet, kRun, kExec };
+
+  Database(Environment* env,
+           v8::Local<v8::Object> object,
+           DatabaseOpenConfiguration&& open_config,
+           bool read_big_ints);
+  void MemoryInfo(MemoryTracker* tracker) const override;
+  static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
+  template <QueryKind kind>
+  static void Query(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Close(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void IsOpenGetter(const v8::FunctionCallbackInfo<v8::Value>& args);
+  bool IsOpen();
+
+  SET_MEMORY_INFO_NAME(Database)
+  SET_SELF_SIZE(Database)
+
+ private:
+  struct Connection;
+
+  ~Database() override;
+  bool Open(int readers, bool enable_wal);
+  void CloseConnections();
+  void Enqueue(std::unique_ptr<DatabaseQueryJob> job);
+  void Dispatch();
+  void Start(std::unique_ptr<DatabaseQueryJob> job, Connection* connection);
+  void Release(Connection* connection);
+
+  DatabaseOpenConfiguration open_config_;
+  bool read_big_ints_;
+  bool closing_ = false;
+  std::vector<std::unique_ptr<Connection>> connections_;
+  Connection* writer_ = nullptr;
+  bool writer_busy_ = false;
+  std::vector<Connection*> idle_readers_;
+  std::deque<std::unique_ptr<DatabaseQueryJob>> pending_writes_;
+  std::deque<std::unique_ptr<DatabaseQueryJob>> pending_reads_;
+  size_t running_ = 0;
+  v8::Global<v8::Promise::Resolver> close_resolver_;
+
+  friend class DatabaseQueryJob;
 };
 
 class UserDefinedFunction {
@@ -215,7 +351,8 @@ class UserDefinedFunction {
   UserDefinedFunction(Environment* env,
                       v8::Local<v8::Function> fn,
                       DatabaseSync* db,
-                      bool use_bigint_args);
+                      bool use_bigint_args,
+                      bool numeric_args);
   ~UserDefinedFunction();
   static void xFunc(sqlite3_context* ctx, int argc, sqlite3_value** argv);
   static void xDestroy(void* self);
@@ -225,6 +362,7 @@ class UserDefinedFunction {
   v8::Global<v8::Function> fn_;
   DatabaseSync* db_;
   bool use_bigint_args_;
+  bool numeric_args_;
 };
 
 }  // namespace sqlite
@@ -0,0 +1,159 @@
+#include "node_startup_profile.h"
+#include "debug_utils-inl.h"
+#include "env-inl.h"
+#include "json_utils.h"
+#include "node_binding.h"
+#include "node_builtins.h"
+#include "node_perf.h"
+#include "node_realm-inl.h"
+#include "simdjson.h"
+#include "util-inl.h"
+
+#include <fstream>
+#include <set>
+
+namespace node {
+namespace startup_profile {
+
+namespace {
+
+constexpr int64_t kProfileVersion = 1;
+
+class ReadAheadTask : public v8::Task {
+ public:
+  explicit ReadAheadTask(std::vector<std::string>&& paths)
+      : paths_(std::move(paths)) {}
+
+  void Run() override {
+    std::string contents;
+    for (const std::string& path : paths_) {
+      USE(ReadFileSync(&contents, path.c_str()));
+    }
+  }
+
+ private:
+  std::vector<std::string> paths_;
+};
+
+bool ReadStringArray(simdjson::ondemand::value* value,
+                     std::vector<std::string>* out) {
+  simdjson::ondemand::array array;
+  if (value->get_array().get(array)) return false;
+  for (auto element : array) {
+    std::string_view str;
+    if (element.get_string().get(str)) return false;
+    out->emplace_back(str);
+  }
+  return true;
+}
+
+}  // anonymous namespace
+
+void Write(Environment* env, const std::string& path) {
+  Realm* realm = env->principal_realm();
+  std::set<std::string> builtins(realm->builtins_in_snapshot.begin(),
+                                 realm->builtins_in_snapshot.end());
+  builtins.insert(realm->builtins_with_cache.begin(),
+                  realm->builtins_with_cache.end());
+  builtins.insert(realm->builtins_without_cache.begin(),
+                  realm->builtins_without_cache.end());
+
+  std::ofstream out(path, std::ios::out | std::ios::binary);
+  if (!out.is_open()) {
+    Debug(env,
+          DebugCategory::CODE_CACHE,
+          "[startup profile] failed to open %s\n",
+          path);
+    return;
+  }
+  JSONWriter writer(out, false);
+  writer.json_start();
+  writer.json_keyvalue("version", kProfileVersion);
+  writer.json_arraystart("builtins");
+  for (const std::string& id : builtins) writer.json_element(id);
+  writer.json_arrayend();
+  writer.json_arraystart("bindings");
+  for (const node_module* mod : realm->internal_bindings) {
+    writer.json_element(mod->nm_modname);
+  }
+  writer.json_arrayend();
+  writer.json_arraystart("modules");
+  for (const std::string& filename : realm->cjs_modules_compiled) {
+    writer.json_element(filename);
+  }
+  writer.json_arrayend();
+  writer.json_objectstart("milestones");
+  const double* milestones =
+      env->performance_state()->milestones.GetNativeBuffer();
+  for (int i = performance::NODE_PERFORMANCE_MILESTONE_ENVIRONMENT;
+       i < performance::NODE_PERFORMANCE_MILESTONE_INVALID;
+       i++) {
+    if (milestones[i] < 0) continue;
+    writer.json_keyvalue(
+        performance::GetPerformanceMilestoneName(
+            static_cast<performance::PerformanceMilestone>(i)),
+        (milestones[i] - env->time_origin()) / 1e6);
+  }
+  writer.json_objectend();
+  writer.json_end();
+}
+
+bool Read(const std::string& path, StartupProfile* profile) {
+  std::string contents;
+  if (ReadFileSync(&contents, path.c_str()) < 0) return false;
+
+  simdjson::ondemand::parser parser;
+  simdjson::padded_string json(contents);
+  simdjson::ondemand::document document;
+  simdjson::ondemand::object object;
+  if (parser.iterate(json).get(document) || document.get_object().get(object)) {
+    return false;
+  }
+  for (auto field : object) {
+    std::string_view key;
+    simdjson::ondemand::value value;
+    if (field.unescaped_key().get(key) || field.value().get(value)) {
+      return false;
+    }
+    if (key == "version") {
+      int64_t version;
+      if (value.get_int64().get(version) || version != kProfileVersion) {
+        return false;
+      }
+    } else if (key == "builtins") {
+      if (!ReadStringArray(&value, &profile->builtins)) return false;
+    } else if (key == "bindings") {
+      if (!ReadStringArray(&value, &profile->bindings)) return false;
+    } else if (key == "modules") {
+      if (!ReadStringArray(&value, &profile->modules)) return false;
+    }
+  }
+  return true;
+}
+
+void Use(Environment* env, const std::string& path) {
+  StartupProfile profile;
+  if (!Read(path, &profile)) {
+    Debug(env,
+          DebugCategory::CODE_CACHE,
+          "[startup profile] ignoring invalid profile %s\n",
+          path);
+    return;
+  }
+  Debug(env,
+        DebugCategory::CODE_CACHE,
+        "[startup profile] using %s: %zu builtins, %zu modules\n",
+        path,
+        profile.builtins.size(),
+        profile.modules.size());
+  MultiIsolatePlatform* platform = env->isolate_data()->platform();
+  env->builtin_loader()->PrefetchBuiltins(platform, profile.builtins);
+  if (!profile.modules.empty()) {
+    platform->PostTaskOnWorkerThread(
+        v8::TaskPriority::kUserBlocking,
+        std::make_unique<ReadAheadTask>(std::move(profile.modules)));
+  }
+}
+
+}  // namespace startup_profile
+}  // namespace node
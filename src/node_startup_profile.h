@@ -0,0 +1,50 @@
+#ifndef SRC_NODE_STARTUP_PROFILE_H_
+#define SRC_NODE_STARTUP_PROFILE_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include <string>
+#include <vector>
+
+namespace node {
+
+class Environment;
+
+// Support for --startup-profile and --startup-profile-use. A startup profile
+// is a JSON file of the form
+//
+//   {
+//     "version": 1,
+//     "builtins": ["internal/modules/cjs/loader", ...],
+//     "bindings": ["fs", ...],
+//     "modules": ["/path/to/app/index.js", ...],
+//     "milestones": { "environment": 12.3, ... }
+//   }
+//
+// listing what the principal realm of the main thread loaded during a run,
+// with the performance milestones in milliseconds since the time origin.
+namespace startup_profile {
+
+struct StartupProfile {
+  std::vector<std::string> builtins;
+  std::vector<std::string> bindings;
+  std::vector<std::string> modules;
+};
+
+// Writes the profile of the current run of env to path.
+void Write(Environment* env, const std::string& path);
+
+// Returns false if the file cannot be read or is not a valid profile.
+bool Read(const std::string& path, StartupProfile* profile);
+
+// Warms up everything recorded in the profile at path on worker threads:
+// builtin sources and code cache are paged in and user modules are read
+// ahead into the OS page cache.
+void Use(Environment* env, const std::string& path);
+
+}  // namespace startup_profile
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_NODE_STARTUP_PROFILE_H_
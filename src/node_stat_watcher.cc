@@ -26,10 +26,14 @@
 #include "node_external_reference.h"
 #include "node_file-inl.h"
 #include "permission/permission.h"
+#include "threadpoolwork-inl.h"
 #include "util-inl.h"
 
+#include <algorithm>
 #include <cstring>
 #include <cstdlib>
+#include <memory>
+#include <vector>
 
 namespace node {
 
@@ -45,6 +49,165 @@ using v8::ObjectTemplate;
 using v8::Uint32;
 using v8::Value;
 
+// All active StatWatchers of a realm that poll at the same interval. On
+// every tick of the shared timer the paths of all members are stat'ed by a
+// single threadpool work item; the results are then handed back to the
+// watchers, which only call into JS when their file has changed.
+class StatWatcherGroup final {
+ public:
+  static void Add(StatWatcher* watcher);
+  static void Remove(StatWatcher* watcher);
+
+ private:
+  class PollWork;
+
+  StatWatcherGroup(fs::BindingData* binding_data, uint32_t interval);
+
+  void Poll();
+  void OnPollDone(const std::vector<BaseObjectPtr<StatWatcher>>& watchers,
+                  const std::vector<int>& results,
+                  const std::vector<uv_stat_t>& stats);
+  void MaybeDelete();
+
+  static void OnTimer(uv_timer_t* handle);
+
+  uv_timer_t timer_;
+  BaseObjectPtr<fs::BindingData> binding_data_;
+  const uint32_t interval_;
+  std::vector<StatWatcher*> watchers_;
+  bool in_flight_ = false;
+  // Set when watchers joined while a poll was in flight. They are
+  // stat'ed as soon as it is done to establish their baseline, as
+  // uv_fs_poll_start() does.
+  bool poll_again_ = false;
+};
+
+class StatWatcherGroup::PollWork final : public ThreadPoolWork {
+ public:
+  PollWork(Environment* env,
+           StatWatcherGroup* group,
+           std::vector<BaseObjectPtr<StatWatcher>>&& watchers)
+      : ThreadPoolWork(env, "fs_stat"),
+        group_(group),
+        watchers_(std::move(watchers)),
+        results_(watchers_.size()),
+        stats_(watchers_.size()) {
+    paths_.reserve(watchers_.size());
+    for (const auto& watcher : watchers_) paths_.push_back(watcher->path_);
+  }
+
+  void DoThreadPoolWork() override {
+    for (size_t i = 0; i < paths_.size(); i++) {
+      uv_fs_t req;
+      results_[i] = uv_fs_stat(nullptr, &req, paths_[i].c_str(), nullptr);
+      if (results_[i] == 0) stats_[i] = req.statbuf;
+      uv_fs_req_cleanup(&req);
+    }
+  }
+
+  void AfterThreadPoolWork(int status) override {
+    std::unique_ptr<PollWork> self(this);
+    if (status == UV_ECANCELED) {
+      std::fill(results_.begin(), results_.end(), UV_ECANCELED);
+    }
+    group_->OnPollDone(watchers_, results_, stats_);
+  }
+
+ private:
+  StatWatcherGroup* group_;
+  std::vector<BaseObjectPtr<StatWatcher>> watchers_;
+  std::vector<std::string> paths_;
+  std::vector<int> results_;
+  std::vector<uv_stat_t> stats_;
+};
+
+StatWatcherGroup::StatWatcherGroup(fs::BindingData* binding_data,
+                                   uint32_t interval)
+    : binding_data_(binding_data), interval_(interval) {
+  Environment* env = binding_data->env();
+  CHECK_EQ(0, uv_timer_init(env->event_loop(), &timer_));
+  // The watchers keep the loop alive, not the group.
+  uv_unref(reinterpret_cast<uv_handle_t*>(&timer_));
+  // uv_timer_start() does not accept a repeat of 0 as "every iteration".
+  const uint64_t repeat = interval == 0 ? 1 : interval;
+  CHECK_EQ(0, uv_timer_start(&timer_, OnTimer, repeat, repeat));
+}
+
+void StatWatcherGroup::Add(StatWatcher* watcher) {
+  fs::BindingData* binding_data = watcher->binding_data_.get();
+  StatWatcherGroup*& group =
+      binding_data->stat_watcher_groups[watcher->interval_];
+  if (group == nullptr) {
+    group = new StatWatcherGroup(binding_data, watcher->interval_);
+  }
+  group->watchers_.push_back(watcher);
+  if (group->in_flight_) {
+    group->poll_again_ = true;
+  } else {
+    group->Poll();
+  }
+}
+
+void StatWatcherGroup::Remove(StatWatcher* watcher) {
+  auto& groups = watcher->binding_data_->stat_watcher_groups;
+  auto it = groups.find(watcher->interval_);
+  if (it == groups.end()) return;
+  StatWatcherGroup* group = it->second;
+  auto& watchers = group->watchers_;
+  auto pos = std::find(watchers.begin(), watchers.end(), watcher);
+  if (pos == watchers.end()) return;
+  // Order does not matter, so avoid shifting the remaining watchers.
+  *pos = watchers.back();
+  watchers.pop_back();
+  group->MaybeDelete();
+}
+
+void StatWatcherGroup::Poll() {
+  CHECK(!in_flight_);
+  std::vector<BaseObjectPtr<StatWatcher>> watchers;
+  watchers.reserve(watchers_.size());
+  for (StatWatcher* watcher : watchers_) {
+    watchers.emplace_back(watcher);
+  }
+  in_flight_ = true;
+  poll_again_ = false;
+  Environment* env = binding_data_->env();
+  (new PollWork(env, this, std::move(watchers)))->ScheduleWork();
+}
+
+void StatWatcherGroup::OnPollDone(
+    const std::vector<BaseObjectPtr<StatWatcher>>& watchers,
+    const std::vector<int>& results,
+    const std::vector<uv_stat_t>& stats) {
+  in_flight_ = false;
+  for (size_t i = 0; i < watchers.size(); i++) {
+    // The watcher may have been closed while its file was stat'ed.
+    if (watchers[i]->IsHandleClosing()) continue;
+    watchers[i]->OnStat(results[i], &stats[i]);
+  }
+  if (poll_again_ && !watchers_.empty()) {
+    Poll();
+  } else {
+    MaybeDelete();
+  }
+}
+
+void StatWatcherGroup::MaybeDelete() {
+  if (in_flight_ || !watchers_.empty()) return;
+  binding_data_->stat_watcher_groups.erase(interval_);
+  binding_data_->env()->CloseHandle(&timer_, [](uv_timer_t* handle) {
+    StatWatcherGroup* group = ContainerOf(&StatWatcherGroup::timer_, handle);
+    delete group;
+  });
+}
+
+void StatWatcherGroup::OnTimer(uv_timer_t* handle) {
+  StatWatcherGroup* group = ContainerOf(&StatWatcherGroup::timer_, handle);
+  // Skip ticks while the previous poll is still running, like
+  // uv_fs_poll_t which only re-arms its timer once a stat completes.
+  if (!group->in_flight_) group->Poll();
+}
+
 void StatWatcher::CreatePerIsolateProperties(IsolateData* isolate_data,
                                              Local<ObjectTemplate> target) {
   Isolate* isolate = isolate_data->isolate();
@@ -69,30 +232,63 @@ StatWatcher::StatWatcher(fs::BindingData* binding_data,
                          bool use_bigint)
     : HandleWrap(binding_data->env(),
                  wrap,
-                 reinterpret_cast<uv_handle_t*>(&watcher_),
+                 reinterpret_cast<uv_handle_t*>(&timer_),
                  AsyncWrap::PROVIDER_STATWATCHER),
       use_bigint_(use_bigint),
       binding_data_(binding_data) {
-  CHECK_EQ(0, uv_fs_poll_init(env()->event_loop(), &watcher_));
+  // The timer is initialized by Start().
+  MarkAsUninitialized();
 }
 
+void StatWatcher::OnClose() {
+  StatWatcherGroup::Remove(this);
+}
 
-void StatWatcher::Callback(uv_fs_poll_t* handle,
-                           int status,
-                           const uv_stat_t* prev,
-                           const uv_stat_t* curr) {
-  StatWatcher* wrap = ContainerOf(&StatWatcher::watcher_, handle);
-  Environment* env = wrap->env();
+static bool StatEqual(const uv_stat_t* a, const uv_stat_t* b) {
+  return a->st_ctim.tv_nsec == b->st_ctim.tv_nsec &&
+         a->st_mtim.tv_nsec == b->st_mtim.tv_nsec &&
+         a->st_birthtim.tv_nsec == b->st_birthtim.tv_nsec &&
+         a->st_ctim.tv_sec == b->st_ctim.tv_sec &&
+         a->st_mtim.tv_sec == b->st_mtim.tv_sec &&
+         a->st_birthtim.tv_sec == b->st_birthtim.tv_sec &&
+         a->st_size == b->st_size && a->st_mode == b->st_mode &&
+         a->st_uid == b->st_uid && a->st_gid == b->st_gid &&
+         a->st_ino == b->st_ino && a->st_dev == b->st_dev &&
+         a->st_flags == b->st_flags && a->st_gen == b->st_gen;
+}
+
+void StatWatcher::OnStat(int status, const uv_stat_t* stat) {
+  if (status != 0) {
+    // Only report an error once, until the file can be stat'ed again.
+    if (poll_state_ != status) {
+      static const uv_stat_t zero_statbuf = {};
+      poll_state_ = status;
+      Emit(status, &statbuf_, &zero_statbuf);
+    }
+    return;
+  }
+
+  const uv_stat_t prev = statbuf_;
+  const bool changed = poll_state_ < 0 ||
+                       (poll_state_ != 0 && !StatEqual(&prev, stat));
+  statbuf_ = *stat;
+  poll_state_ = 1;
+  if (changed) Emit(0, &prev, stat);
+}
+
+void StatWatcher::Emit(int status,
+                       const uv_stat_t* prev,
+                       const uv_stat_t* curr) {
+  Environment* env = this->env();
   HandleScope handle_scope(env->isolate());
   Context::Scope context_scope(env->context());
 
-  Local<Value> arr = fs::FillGlobalStatsArray(
-      wrap->binding_data_.get(), wrap->use_bigint_, curr);
-  USE(fs::FillGlobalStatsArray(
-      wrap->binding_data_.get(), wrap->use_bigint_, prev, true));
+  Local<Value> arr =
+      fs::FillGlobalStatsArray(binding_data_.get(), use_bigint_, curr);
+  USE(fs::FillGlobalStatsArray(binding_data_.get(), use_bigint_, prev, true));
 
   Local<Value> argv[2] = { Integer::New(env->isolate(), status), arr };
-  wrap->MakeCallback(env->onchange_string(), arraysize(argv), argv);
+  MakeCallback(env->onchange_string(), arraysize(argv), argv);
 }
 
 
@@ -108,7 +304,7 @@ void StatWatcher::Start(const FunctionCallbackInfo<Value>& args) {
 
   StatWatcher* wrap;
   ASSIGN_OR_RETURN_UNWRAP(&wrap, args.This());
-  CHECK(!uv_is_active(wrap->GetHandle()));
+  CHECK(wrap->IsHandleClosing());  // Check that Start() has not been called.
 
   node::Utf8Value path(args.GetIsolate(), args[0]);
   CHECK_NOT_NULL(*path);
@@ -120,12 +316,16 @@ void StatWatcher::Start(const FunctionCallbackInfo<Value>& args) {
   CHECK(args[1]->IsUint32());
   const uint32_t interval = args[1].As<Uint32>()->Value();
 
-  // Note that uv_fs_poll_start does not return ENOENT, we are handling
-  // mostly memory errors here.
-  const int err = uv_fs_poll_start(&wrap->watcher_, Callback, *path, interval);
-  if (err != 0) {
-    args.GetReturnValue().Set(err);
-  }
+  Environment* env = wrap->env();
+  CHECK_EQ(0, uv_timer_init(env->event_loop(), &wrap->timer_));
+  CHECK_EQ(0,
+           uv_timer_start(
+               &wrap->timer_, [](uv_timer_t*) {}, UINT64_MAX, 0));
+  wrap->MarkAsInitialized();
+
+  wrap->path_ = *path;
+  wrap->interval_ = interval;
+  StatWatcherGroup::Add(wrap);
 }
 
 }  // namespace node
@@ -29,6 +29,8 @@
 #include "uv.h"
 #include "v8.h"
 
+#include <string>
+
 namespace node {
 namespace fs {
 class BindingData;
@@ -36,7 +38,13 @@ class BindingData;
 
 class Environment;
 class ExternalReferenceRegistry;
+class StatWatcherGroup;
 
+// Watches a file by periodically stat'ing it, like uv_fs_poll_t. Instead
+// of running its own timer and threadpool request, each watcher joins the
+// StatWatcherGroup of its interval, which stats all of its files in one
+// threadpool job per interval and only calls into JS for watchers whose
+// file changed.
 class StatWatcher : public HandleWrap {
  public:
   static void CreatePerIsolateProperties(IsolateData* isolate_data,
@@ -56,14 +64,26 @@ class StatWatcher : public HandleWrap {
   SET_SELF_SIZE(StatWatcher)
 
  private:
-  static void Callback(uv_fs_poll_t* handle,
-                       int status,
-                       const uv_stat_t* prev,
-                       const uv_stat_t* curr);
+  friend class StatWatcherGroup;
+
+  void OnClose() override;
+
+  // Called by the group with the result of stat'ing path_. Mirrors the
+  // change detection of uv_fs_poll_t.
+  void OnStat(int status, const uv_stat_t* stat);
+  void Emit(int status, const uv_stat_t* prev, const uv_stat_t* curr);
 
-  uv_fs_poll_t watcher_;
+  // Never fires. It is only started so that the watcher keeps the event
+  // loop alive while active, honoring ref() and unref().
+  uv_timer_t timer_;
   const bool use_bigint_;
   BaseObjectPtr<fs::BindingData> binding_data_;
+  std::string path_;
+  uint32_t interval_ = 0;
+  // 0 before the first stat, 1 after a successful stat, or the error code
+  // of the last failed stat.
+  int poll_state_ = 0;
+  uv_stat_t statbuf_ = {};
 };
 
 }  // namespace node
@@ -33,6 +33,8 @@ ProcessRunner::ProcessRunner(std::shared_ptr<InitializationResultImpl> result,
   child_stdio[2].data.fd = 2;
   options_.stdio = child_stdio;
   options_.exit_cb = ExitCallback;
+  output_[0].fd = 1;
+  output_[1].fd = 2;
 
 #ifdef _WIN32
   options_.flags |= UV_PROCESS_WINDOWS_VERBATIM_ARGUMENTS;
@@ -192,26 +194,138 @@ void ProcessRunner::ExitCallback(uv_process_t* handle,
                                  int64_t exit_status,
                                  int term_signal) {
   const auto self = static_cast<ProcessRunner*>(handle->data);
-  uv_close(reinterpret_cast<uv_handle_t*>(handle), nullptr);
+  uv_close(reinterpret_cast<uv_handle_t*>(handle), CloseCallback);
   self->OnExit(exit_status, term_signal);
 }
 
 void ProcessRunner::OnExit(int64_t exit_status, int term_signal) {
-  if (exit_status > 0) {
-    init_result->exit_code_ = ExitCode::kGenericUserError;
-  } else {
-    init_result->exit_code_ = ExitCode::kNoFailure;
+  succeeded_ = exit_status <= 0;
+}
+
+// CloseCallback reports completion once the process handle and any output
+// pipes have been closed, so that no output is lost.
+void ProcessRunner::CloseCallback(uv_handle_t* handle) {
+  const auto self = static_cast<ProcessRunner*>(handle->data);
+  CHECK_GT(self->open_handles_, 0);
+  if (--self->open_handles_ == 0 && self->on_done_) {
+    self->on_done_(self->succeeded_);
   }
 }
 
-void ProcessRunner::Run() {
+void ProcessRunner::AllocCallback(uv_handle_t* handle,
+                                  size_t suggested_size,
+                                  uv_buf_t* buf) {
+  const auto self = static_cast<ProcessRunner*>(handle->data);
+  *buf = uv_buf_init(self->read_buffer_, sizeof(self->read_buffer_));
+}
+
+void ProcessRunner::ReadCallback(uv_stream_t* stream,
+                                 ssize_t nread,
+                                 const uv_buf_t* buf) {
+  const auto self = static_cast<ProcessRunner*>(stream->data);
+  OutputStream* out =
+      stream == reinterpret_cast<uv_stream_t*>(&self->output_[0].pipe)
+          ? &self->output_[0]
+          : &self->output_[1];
+
+  if (nread < 0) {
+    // Terminate an unfinished last line so it does not run into the output
+    // of another script.
+    if (!out->pending.empty()) {
+      self->WriteOutput(out->fd,
+                        self->output_prefix_ + out->pending + "\n");
+      out->pending.clear();
+    }
+    uv_close(reinterpret_cast<uv_handle_t*>(stream), CloseCallback);
+    return;
+  }
+
+  self->OnOutput(out, buf->base, static_cast<size_t>(nread));
+}
+
+// OnOutput writes every complete line in `data` with the prefix in front of
+// it, using a single write per read so that lines of concurrently running
+// scripts never interleave mid-line.
+void ProcessRunner::OnOutput(OutputStream* out,
+                             const char* data,
+                             size_t length) {
+  std::string lines;
+  const char* end = data + length;
+  const char* start = data;
+  while (const char* newline = static_cast<const char*>(
+             memchr(start, '\n', end - start))) {
+    lines += output_prefix_;
+    lines += out->pending;
+    lines.append(start, newline + 1 - start);
+    out->pending.clear();
+    start = newline + 1;
+  }
+  out->pending.append(start, end - start);
+  WriteOutput(out->fd, lines);
+}
+
+void ProcessRunner::WriteOutput(int fd, std::string_view data) {
+  while (!data.empty()) {
+    uv_fs_t req;
+    uv_buf_t buf =
+        uv_buf_init(const_cast<char*>(data.data()),
+                    static_cast<unsigned int>(data.size()));
+    int r = uv_fs_write(loop_, &req, fd, &buf, 1, -1, nullptr);
+    uv_fs_req_cleanup(&req);
+    if (r <= 0) return;
+    data.remove_prefix(r);
+  }
+}
+
+void ProcessRunner::SetOutputPrefix(std::string_view prefix) {
+  output_prefix_ = prefix;
+}
+
+void ProcessRunner::Start(std::function<void(bool)> on_done) {
+  on_done_ = std::move(on_done);
+
   // keeps the string alive until destructor
   cwd = package_json_path_.parent_path().string();
   options_.cwd = cwd.c_str();
+
+  size_t pipe_count = 0;
+  if (!output_prefix_.empty()) {
+    for (OutputStream& out : output_) {
+      CHECK_EQ(uv_pipe_init(loop_, &out.pipe, 0), 0);
+      out.pipe.data = this;
+      uv_stdio_container_t* stdio = &child_stdio[out.fd];
+      stdio->flags =
+          static_cast<uv_stdio_flags>(UV_CREATE_PIPE | UV_WRITABLE_PIPE);
+      stdio->data.stream = reinterpret_cast<uv_stream_t*>(&out.pipe);
+      pipe_count++;
+    }
+  }
+  open_handles_ = pipe_count + 1;
+
   if (int r = uv_spawn(loop_, &process_, &options_)) {
     fprintf(stderr, "Error: %s\n", uv_strerror(r));
+    succeeded_ = false;
+    uv_close(reinterpret_cast<uv_handle_t*>(&process_), CloseCallback);
+    for (size_t i = 0; i < pipe_count; i++) {
+      uv_close(reinterpret_cast<uv_handle_t*>(&output_[i].pipe),
+               CloseCallback);
+    }
+    return;
+  }
+
+  for (size_t i = 0; i < pipe_count; i++) {
+    uv_stream_t* stream = reinterpret_cast<uv_stream_t*>(&output_[i].pipe);
+    if (uv_read_start(stream, AllocCallback, ReadCallback) != 0) {
+      uv_close(reinterpret_cast<uv_handle_t*>(stream), CloseCallback);
+    }
   }
+}
 
+void ProcessRunner::Run() {
+  Start([this](bool succeeded) {
+    init_result->exit_code_ =
+        succeeded ? ExitCode::kNoFailure : ExitCode::kGenericUserError;
+  });
   uv_run(loop_, UV_RUN_DEFAULT);
 }
 
@@ -250,8 +364,10 @@ FindPackageJson(const std::filesystem::path& cwd) {
 }
 
 void RunTask(const std::shared_ptr<InitializationResultImpl>& result,
-             std::string_view command_id,
-             const std::vector<std::string_view>& positional_args) {
+             const std::vector<std::string>& command_ids,
+             const std::vector<std::string_view>& positional_args,
+             bool parallel,
+             int64_t concurrency) {
   auto cwd = std::filesystem::current_path();
   auto package_json = FindPackageJson(cwd);
 
@@ -300,48 +416,94 @@ void RunTask(const std::shared_ptr<InitializationResultImpl>& result,
     return;
   }
 
-  // If the command_id is not found in the scripts object, throw an error.
-  std::string_view command;
-  if (auto command_error =
-          scripts_object[command_id].get_string().get(command)) {
-    if (command_error == simdjson::error_code::INCORRECT_TYPE) {
-      fprintf(stderr,
-              "Script \"%.*s\" is unexpectedly not a string for %s\n\n",
-              static_cast<int>(command_id.size()),
-              command_id.data(),
-              path.string().c_str());
-    } else {
-      fprintf(stderr,
-              "Missing script: \"%.*s\" for %s\n\n",
-              static_cast<int>(command_id.size()),
-              command_id.data(),
-              path.string().c_str());
-      fprintf(stderr, "Available scripts are:\n");
-
-      // Reset the object to iterate over it again
-      scripts_object.reset();
-      simdjson::ondemand::value value;
-      for (auto field : scripts_object) {
-        std::string_view key_str;
-        std::string_view value_str;
-        if (!field.unescaped_key().get(key_str) && !field.value().get(value) &&
-            !value.get_string().get(value_str)) {
-          fprintf(stderr,
-                  "  %.*s: %.*s\n",
-                  static_cast<int>(key_str.size()),
-                  key_str.data(),
-                  static_cast<int>(value_str.size()),
-                  value_str.data());
+  // Resolve every script before running any of them.
+  std::vector<std::string> commands;
+  for (std::string_view command_id : command_ids) {
+    // If the command_id is not found in the scripts object, throw an error.
+    std::string_view command;
+    if (auto command_error =
+            scripts_object[command_id].get_string().get(command)) {
+      if (command_error == simdjson::error_code::INCORRECT_TYPE) {
+        fprintf(stderr,
+                "Script \"%.*s\" is unexpectedly not a string for %s\n\n",
+                static_cast<int>(command_id.size()),
+                command_id.data(),
+                path.string().c_str());
+      } else {
+        fprintf(stderr,
+                "Missing script: \"%.*s\" for %s\n\n",
+                static_cast<int>(command_id.size()),
+                command_id.data(),
+                path.string().c_str());
+        fprintf(stderr, "Available scripts are:\n");
+
+        // Reset the object to iterate over it again
+        scripts_object.reset();
+        simdjson::ondemand::value value;
+        for (auto field : scripts_object) {
+          std::string_view key_str;
+          std::string_view value_str;
+          if (!field.unescaped_key().get(key_str) &&
+              !field.value().get(value) &&
+              !value.get_string().get(value_str)) {
+            fprintf(stderr,
+                    "  %.*s: %.*s\n",
+                    static_cast<int>(key_str.size()),
+                    key_str.data(),
+                    static_cast<int>(value_str.size()),
+                    value_str.data());
+          }
         }
       }
+      result->exit_code_ = ExitCode::kGenericUserError;
+      return;
     }
-    result->exit_code_ = ExitCode::kGenericUserError;
+    commands.emplace_back(command);
+  }
+
+  if (commands.size() == 1) {
+    auto runner = ProcessRunner(
+        result, path, command_ids[0], commands[0], path_env_var,
+        positional_args);
+    runner.Run();
     return;
   }
 
-  auto runner = ProcessRunner(
-      result, path, command_id, command, path_env_var, positional_args);
-  runner.Run();
+  std::vector<std::unique_ptr<ProcessRunner>> runners;
+  for (size_t i = 0; i < commands.size(); i++) {
+    runners.push_back(std::make_unique<ProcessRunner>(
+        result, path, command_ids[i], commands[i], path_env_var,
+        positional_args));
+    if (parallel) runners.back()->SetOutputPrefix("[" + command_ids[i] + "] ");
+  }
+
+  // Scripts are started in order as slots free up. Sequential runs use a
+  // single slot and stop at the first failure.
+  size_t limit = 1;
+  if (parallel) {
+    limit = concurrency > 0 ? static_cast<size_t>(concurrency)
+                            : runners.size();
+  }
+  size_t next = 0;
+  size_t running = 0;
+  bool failed = false;
+  std::function<void()> start_more = [&]() {
+    while (running < limit && next < runners.size() &&
+           (parallel || !failed)) {
+      ProcessRunner* runner = runners[next++].get();
+      running++;
+      runner->Start([&](bool succeeded) {
+        running--;
+        if (!succeeded) failed = true;
+        start_more();
+      });
+    }
+  };
+  start_more();
+  uv_run(uv_default_loop(), UV_RUN_DEFAULT);
+
+  result->exit_code_ =
+      failed ? ExitCode::kGenericUserError : ExitCode::kNoFailure;
 }
 
 // GetPositionalArgs returns the positional arguments from the command line.
@@ -9,10 +9,14 @@
 #include "uv.h"
 
 #include <filesystem>
+#include <functional>
 #include <optional>
 #include <string_view>
 #include <tuple>
 
+// Forward declare test fixture for `friend` declaration.
+class TaskRunnerTest;
+
 namespace node::task_runner {
 
 using PositionalArgs = std::vector<std::string_view>;
@@ -29,14 +33,46 @@ class ProcessRunner {
                 std::string_view command,
                 std::string_view path_env_var,
                 const PositionalArgs& positional_args);
+  // Spawns the process and runs the loop until it has exited.
   void Run();
+  // Spawns the process without running the loop. `on_done` is called with
+  // whether the script succeeded once the process and its output pipes have
+  // all been closed.
+  void Start(std::function<void(bool)> on_done);
+  // Pipes stdout and stderr through the parent, writing each line of output
+  // with `prefix` in front of it. Must be called before Start().
+  void SetOutputPrefix(std::string_view prefix);
+
   static void ExitCallback(uv_process_t* req,
                            int64_t exit_status,
                            int term_signal);
 
  private:
+  struct OutputStream {
+    uv_pipe_t pipe{};
+    int fd = -1;
+    // Bytes after the last newline, held back until the line is complete.
+    std::string pending;
+  };
+
+  static void CloseCallback(uv_handle_t* handle);
+  static void AllocCallback(uv_handle_t* handle,
+                            size_t suggested_size,
+                            uv_buf_t* buf);
+  static void ReadCallback(uv_stream_t* stream,
+                           ssize_t nread,
+                           const uv_buf_t* buf);
+  void OnOutput(OutputStream* out, const char* data, size_t length);
+  void WriteOutput(int fd, std::string_view data);
+
   uv_loop_t* loop_ = uv_default_loop();
   uv_process_t process_{};
+  OutputStream output_[2];  // stdout and stderr
+  std::string output_prefix_;
+  char read_buffer_[16 * 1024];
+  size_t open_handles_ = 0;
+  bool succeeded_ = false;
+  std::function<void(bool)> on_done_;
   uv_process_options_t options_{};
   uv_stdio_container_t child_stdio[3]{};
   std::shared_ptr<InitializationResultImpl> init_result;
@@ -63,6 +99,8 @@ class ProcessRunner {
   // Represents PATH environment variable that contains
   // all subdirectory paths appended with node_modules/.bin suffix.
   std::string path_env_var_;
+
+  friend class ::TaskRunnerTest;
 };
 
 // This function traverses up to the root directory.
@@ -79,9 +117,15 @@ class ProcessRunner {
 std::optional<std::tuple<std::filesystem::path, std::string, std::string>>
 FindPackageJson(const std::filesystem::path& cwd);
 
+// Runs the given package.json scripts. With `parallel`, up to `concurrency`
+// of them (all if zero) run at once and their output is prefixed with the
+// script name; otherwise they run one after another and the first failure
+// stops the rest.
 void RunTask(const std::shared_ptr<InitializationResultImpl>& result,
-             std::string_view command_id,
-             const PositionalArgs& positional_args);
+             const std::vector<std::string>& command_ids,
+             const PositionalArgs& positional_args,
+             bool parallel = false,
+             int64_t concurrency = 0);
 PositionalArgs GetPositionalArgs(const std::vector<std::string>& args);
 std::string EscapeShell(std::string_view command);
 
@@ -4,8 +4,12 @@
 
 #if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
 
+#include "node_mutex.h"
 #include "v8.h"
 
+#include <atomic>
+#include <memory>
+
 namespace node {
 
 // An external resource intended to be used with static lifetime.
@@ -50,14 +54,96 @@ using StaticExternalTwoByteResource =
                                uint16_t,
                                v8::String::ExternalStringResource>;
 
+// Decompresses the zstd frame of `compressed_size` bytes at `compressed` into
+// exactly `size` bytes at `out`. Aborts if the data is corrupted.
+void DecompressStaticResource(const uint8_t* compressed,
+                              size_t compressed_size,
+                              void* out,
+                              size_t size);
+
+// Like StaticExternalByteResource, for data that js2c compressed with zstd
+// (see the node_compress_builtins build option). The data is decompressed
+// when V8 reads the characters for the first time, e.g. to compile a function
+// that is not in the code cache, and then kept until the process exits.
+template <typename Char, typename IChar, typename Base>
+class StaticCompressedByteResource : public Base {
+  static_assert(sizeof(IChar) == sizeof(Char),
+                "incompatible interface and internal pointers");
+
+ public:
+  StaticCompressedByteResource(const uint8_t* compressed,
+                               size_t compressed_size,
+                               size_t length)
+      : compressed_(compressed),
+        compressed_size_(compressed_size),
+        length_(length) {}
+
+  // May be called from any thread, e.g. by concurrent compilation tasks.
+  const IChar* data() const override {
+    const Char* data = data_.load(std::memory_order_acquire);
+    if (data == nullptr) [[unlikely]] {
+      data = Decompress();
+    }
+    return reinterpret_cast<const IChar*>(data);
+  }
+  size_t length() const override { return length_; }
+
+  // Prevents V8 from reading the data when the string is created, so that
+  // sources of builtins that are loaded from the code cache stay compressed
+  // until they are needed.
+  bool IsCacheable() const override { return false; }
+
+  void Dispose() override {
+    // See StaticExternalByteResource::Dispose().
+  }
+
+  StaticCompressedByteResource(const StaticCompressedByteResource&) = delete;
+  StaticCompressedByteResource& operator=(
+      const StaticCompressedByteResource&) = delete;
+
+ private:
+  const Char* Decompress() const {
+    Mutex::ScopedLock lock(mutex_);
+    if (!decompressed_) {
+      auto decompressed = std::make_unique<Char[]>(length_);
+      DecompressStaticResource(compressed_,
+                               compressed_size_,
+                               decompressed.get(),
+                               length_ * sizeof(Char));
+      decompressed_ = std::move(decompressed);
+      data_.store(decompressed_.get(), std::memory_order_release);
+    }
+    return decompressed_.get();
+  }
+
+  const uint8_t* compressed_;
+  const size_t compressed_size_;
+  const size_t length_;
+  mutable Mutex mutex_;
+  mutable std::unique_ptr<Char[]> decompressed_;
+  mutable std::atomic<const Char*> data_{nullptr};
+};
+
+using StaticCompressedOneByteResource =
+    StaticCompressedByteResource<uint8_t,
+                                 char,
+                                 v8::String::ExternalOneByteStringResource>;
+using StaticCompressedTwoByteResource =
+    StaticCompressedByteResource<uint16_t,
+                                 uint16_t,
+                                 v8::String::ExternalStringResource>;
+
 // Similar to a v8::String, but it's independent from Isolates
 // and can be materialized in Isolates as external Strings
 // via ToStringChecked.
 class UnionBytes {
  public:
-  explicit UnionBytes(StaticExternalOneByteResource* one_byte_resource)
+  // The resources must be static, i.e. StaticExternalByteResource or
+  // StaticCompressedByteResource.
+  explicit UnionBytes(
+      v8::String::ExternalOneByteStringResource* one_byte_resource)
       : one_byte_resource_(one_byte_resource), two_byte_resource_(nullptr) {}
-  explicit UnionBytes(StaticExternalTwoByteResource* two_byte_resource)
+  explicit UnionBytes(v8::String::ExternalStringResource* two_byte_resource)
       : one_byte_resource_(nullptr), two_byte_resource_(two_byte_resource) {}
 
   UnionBytes(const UnionBytes&) = default;
@@ -69,9 +155,20 @@ class UnionBytes {
 
   v8::Local<v8::String> ToStringChecked(v8::Isolate* isolate) const;
 
+  // The raw bytes backing the string, which have static lifetime. For
+  // compressed resources, this decompresses the data.
+  const void* data() const {
+    return is_one_byte() ? static_cast<const void*>(one_byte_resource_->data())
+                         : two_byte_resource_->data();
+  }
+  size_t byte_length() const {
+    return is_one_byte() ? one_byte_resource_->length()
+                         : two_byte_resource_->length() * sizeof(uint16_t);
+  }
+
  private:
-  StaticExternalOneByteResource* one_byte_resource_;
-  StaticExternalTwoByteResource* two_byte_resource_;
+  v8::String::ExternalOneByteStringResource* one_byte_resource_;
+  v8::String::ExternalStringResource* two_byte_resource_;
 };
 
 }  // namespace node
@@ -21,6 +21,8 @@ namespace node {
 namespace url {
 
 using v8::CFunction;
+using v8::Array;
+using v8::ArrayBuffer;
 using v8::Context;
 using v8::FastApiCallbackOptions;
 using v8::FunctionCallbackInfo;
@@ -31,6 +33,7 @@ using v8::Object;
 using v8::ObjectTemplate;
 using v8::SnapshotCreator;
 using v8::String;
+using v8::Uint32Array;
 using v8::Value;
 
 void BindingData::MemoryInfo(MemoryTracker* tracker) const {
@@ -416,6 +419,123 @@ void BindingData::Parse(const FunctionCallbackInfo<Value>& args) {
   }
 }
 
+// Like parse(), but does not create the href string unless it differs from
+// the input. Writes the components to the shared buffer and returns
+// undefined if the input is not a valid URL, true if the href is the input
+// itself, or the href otherwise.
+// parseComponents(input[, base])
+void BindingData::ParseComponents(const FunctionCallbackInfo<Value>& args) {
+  CHECK_GE(args.Length(), 1);
+  CHECK(args[0]->IsString());  // input
+  // args[1] // base url
+
+  Realm* realm = Realm::GetCurrent(args);
+  BindingData* binding_data = realm->GetBindingData<BindingData>();
+  Isolate* isolate = realm->isolate();
+
+  Utf8Value input(isolate, args[0]);
+  ada::result<ada::url_aggregator> base;
+  ada::url_aggregator* base_pointer = nullptr;
+  if (args.Length() > 1 && args[1]->IsString()) {
+    Utf8Value base_input(isolate, args[1]);
+    base = ada::parse<ada::url_aggregator>(base_input.ToStringView());
+    if (!base) return;
+    base_pointer = &base.value();
+  }
+  auto out =
+      ada::parse<ada::url_aggregator>(input.ToStringView(), base_pointer);
+  if (!out) return;
+
+  binding_data->UpdateComponents(out->get_components(), out->type);
+
+  std::string_view href = out->get_href();
+  if (href == input.ToStringView()) {
+    return args.GetReturnValue().Set(true);
+  }
+  Local<Value> ret;
+  if (ToV8Value(realm->context(), href, isolate).ToLocal(&ret)) [[likely]] {
+    args.GetReturnValue().Set(ret);
+  }
+}
+
+// Parses many URLs against the same base in one call. Returns
+// [components, hrefs], where components holds kManyComponentsStride
+// entries per input: its components followed by its ParseComponentsStatus.
+// hrefs holds the href of every input for which it differs from the input.
+// parseManyComponents(inputs[, base])
+void BindingData::ParseManyComponents(
+    const FunctionCallbackInfo<Value>& args) {
+  CHECK_GE(args.Length(), 1);
+  CHECK(args[0]->IsArray());  // inputs
+  // args[1] // base url
+
+  Realm* realm = Realm::GetCurrent(args);
+  Isolate* isolate = realm->isolate();
+  Local<Context> context = realm->context();
+  Local<Array> inputs = args[0].As<Array>();
+  const uint32_t count = inputs->Length();
+
+  ada::result<ada::url_aggregator> base;
+  ada::url_aggregator* base_pointer = nullptr;
+  bool base_is_valid = true;
+  if (args.Length() > 1 && args[1]->IsString()) {
+    Utf8Value base_input(isolate, args[1]);
+    base = ada::parse<ada::url_aggregator>(base_input.ToStringView());
+    base_is_valid = base.has_value();
+    if (base_is_valid) base_pointer = &base.value();
+  }
+
+  Local<ArrayBuffer> buffer = ArrayBuffer::New(
+      isolate, sizeof(uint32_t) * kManyComponentsStride * count);
+  uint32_t* components = static_cast<uint32_t*>(buffer->Data());
+  Local<Array> hrefs = Array::New(isolate, count);
+
+  for (uint32_t i = 0; i < count; i++) {
+    uint32_t* out = components + i * kManyComponentsStride;
+    std::fill(out, out + kManyComponentsStride, 0);
+
+    Local<Value> value;
+    if (!inputs->Get(context, i).ToLocal(&value)) return;
+    if (!base_is_valid || !value->IsString()) continue;
+
+    Utf8Value input(isolate, value);
+    auto url =
+        ada::parse<ada::url_aggregator>(input.ToStringView(), base_pointer);
+    if (!url) continue;
+
+    const ada::url_components& parsed = url->get_components();
+    out[0] = parsed.protocol_end;
+    out[1] = parsed.username_end;
+    out[2] = parsed.host_start;
+    out[3] = parsed.host_end;
+    out[4] = parsed.port;
+    out[5] = parsed.pathname_start;
+    out[6] = parsed.search_start;
+    out[7] = parsed.hash_start;
+    out[8] = url->type;
+
+    std::string_view href = url->get_href();
+    if (href == input.ToStringView()) {
+      out[kURLComponentsLength] = kParseHrefIsInput;
+      continue;
+    }
+    out[kURLComponentsLength] = kParseHrefChanged;
+    Local<Value> href_value;
+    if (!ToV8Value(context, href, isolate).ToLocal(&href_value) ||
+        hrefs->Set(context, i, href_value).IsNothing()) {
+      return;
+    }
+  }
+  static_assert(kURLComponentsLength == 9,
+                "kURLComponentsLength should be up-to-date");
+
+  Local<Value> result[] = {
+      Uint32Array::New(buffer, 0, kManyComponentsStride * count),
+      hrefs,
+  };
+  args.GetReturnValue().Set(Array::New(isolate, result, arraysize(result)));
+}
+
 void BindingData::Update(const FunctionCallbackInfo<Value>& args) {
   CHECK(args[0]->IsString());    // href
   CHECK(args[1]->IsNumber());    // action type
@@ -520,6 +640,8 @@ void BindingData::CreatePerIsolateProperties(IsolateData* isolate_data,
   SetMethodNoSideEffect(isolate, target, "format", Format);
   SetMethodNoSideEffect(isolate, target, "getOrigin", GetOrigin);
   SetMethod(isolate, target, "parse", Parse);
+  SetMethod(isolate, target, "parseComponents", ParseComponents);
+  SetMethod(isolate, target, "parseManyComponents", ParseManyComponents);
   SetMethod(isolate, target, "pathToFileURL", PathToFileURL);
   SetMethod(isolate, target, "update", Update);
   SetFastMethodNoSideEffect(
@@ -541,6 +663,8 @@ void BindingData::RegisterExternalReferences(
   registry->Register(Format);
   registry->Register(GetOrigin);
   registry->Register(Parse);
+  registry->Register(ParseComponents);
+  registry->Register(ParseManyComponents);
   registry->Register(PathToFileURL);
   registry->Register(Update);
   registry->Register(CanParse);
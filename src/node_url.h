@@ -64,6 +64,9 @@ class BindingData : public SnapshotableObject {
   static void Format(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void GetOrigin(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Parse(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void ParseComponents(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void ParseManyComponents(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
   static void PathToFileURL(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Update(const v8::FunctionCallbackInfo<v8::Value>& args);
 
@@ -77,6 +80,18 @@ class BindingData : public SnapshotableObject {
 
  private:
   static constexpr size_t kURLComponentsLength = 9;
+  // Each URL parsed by ParseManyComponents() takes up its components plus
+  // one slot for its ParseComponentsStatus.
+  static constexpr size_t kManyComponentsStride = kURLComponentsLength + 1;
+
+  enum ParseComponentsStatus : uint32_t {
+    kParseFailed = 0,
+    // The href is identical to the input, so the offsets can be used on the
+    // input directly.
+    kParseHrefIsInput = 1,
+    kParseHrefChanged = 2,
+  };
+
   AliasedUint32Array url_components_buffer_;
 
   void UpdateComponents(const ada::url_components& components,
@@ -8,6 +8,9 @@
 #include "path.h"
 #include "util-inl.h"
 
+#include <algorithm>
+#include <variant>
+
 namespace node {
 using node::url_pattern::URLPatternRegexProvider;
 
@@ -58,6 +61,7 @@ using v8::DontDelete;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
 using v8::Global;
+using v8::Integer;
 using v8::Isolate;
 using v8::Local;
 using v8::LocalVector;
@@ -617,6 +621,233 @@ void URLPattern::HasRegexpGroups(const FunctionCallbackInfo<Value>& info) {
   info.GetReturnValue().Set(url_pattern->HasRegExpGroups());
 }
 
+// Reads the (input[, baseURL]) arguments shared by the exec() and test()
+// methods of URLPatternList. The string input, if any, is stored in
+// `input_storage`, which `input` then refers to.
+static bool GetPatternInput(
+    Environment* env,
+    const FunctionCallbackInfo<Value>& args,
+    ada::url_pattern_input* input,
+    std::string* input_storage,
+    std::optional<std::string>* base_url) {
+  if (args.Length() == 0 || args[0]->IsUndefined()) {
+    *input = ada::url_pattern_init{};
+  } else if (args[0]->IsString()) {
+    Utf8Value input_value(env->isolate(), args[0].As<String>());
+    *input_storage = input_value.ToString();
+    *input = std::string_view(*input_storage);
+  } else if (args[0]->IsObject()) {
+    auto maybe_input = URLPattern::URLPatternInit::FromJsObject(
+        env, args[0].As<Object>());
+    if (!maybe_input.has_value()) return false;
+    *input = std::move(*maybe_input);
+  } else {
+    THROW_ERR_INVALID_ARG_TYPE(
+        env, "URLPattern input needs to be a string or an object");
+    return false;
+  }
+
+  if (args.Length() > 1 && !args[1]->IsUndefined()) {
+    if (!args[1]->IsString()) {
+      THROW_ERR_INVALID_ARG_TYPE(env, "baseURL must be a string");
+      return false;
+    }
+    Utf8Value base_url_value(env->isolate(), args[1].As<String>());
+    *base_url = base_url_value.ToString();
+  }
+  return true;
+}
+
+URLPatternList::URLPatternList(
+    Environment* env,
+    Local<Object> object,
+    std::vector<BaseObjectPtr<URLPattern>>&& patterns)
+    : BaseObject(env, object), patterns_(std::move(patterns)) {
+  MakeWeak();
+  trie_.emplace_back();
+  for (size_t i = 0; i < patterns_.size(); i++) {
+    Insert(LiteralPathnamePrefix(patterns_[i]->url_pattern_),
+           static_cast<uint32_t>(i));
+  }
+}
+
+void URLPatternList::MemoryInfo(MemoryTracker* tracker) const {
+  tracker->TrackFieldWithSize("patterns",
+                              patterns_.size() * sizeof(patterns_[0]));
+  tracker->TrackFieldWithSize("trie", trie_.size() * sizeof(TrieNode));
+}
+
+std::string URLPatternList::LiteralPathnamePrefix(
+    const ada::url_pattern<URLPatternRegexProvider>& pattern) {
+  // Case-insensitive patterns would need case folding of the input.
+  if (pattern.ignore_case()) return {};
+  const std::string& source = pattern.pathname_component.pattern;
+  size_t end = source.find_first_of(":*(){}\\?+");
+  if (end == std::string::npos) return source;
+  // The character before a group may be its prefix, which is optional if
+  // the group is, as with the '/' in "/users/:id?". Leave it out.
+  if (end > 0) end--;
+  return source.substr(0, end);
+}
+
+void URLPatternList::Insert(std::string_view prefix, uint32_t index) {
+  uint32_t node = 0;
+  for (char c : prefix) {
+    uint32_t next = 0;
+    for (const auto& [child_char, child] : trie_[node].children) {
+      if (child_char == c) {
+        next = child;
+        break;
+      }
+    }
+    if (next == 0) {
+      next = static_cast<uint32_t>(trie_.size());
+      trie_[node].children.emplace_back(c, next);
+      // May reallocate, so do not hold references into trie_ across this.
+      trie_.emplace_back();
+    }
+    node = next;
+  }
+  trie_[node].patterns.push_back(index);
+}
+
+std::vector<uint32_t> URLPatternList::GetCandidates(
+    const ada::url_pattern_input& input,
+    const std::optional<std::string_view>& base_url) const {
+  std::vector<uint32_t> candidates;
+  auto all = [&] {
+    candidates.resize(patterns_.size());
+    for (size_t i = 0; i < candidates.size(); i++) {
+      candidates[i] = static_cast<uint32_t>(i);
+    }
+    return candidates;
+  };
+
+  // Only string inputs are resolved the same way the patterns resolve
+  // them; anything else, including invalid URLs, is left to the patterns.
+  if (!std::holds_alternative<std::string_view>(input)) return all();
+  std::optional<ada::url_aggregator> base;
+  if (base_url.has_value()) {
+    auto parsed_base = ada::parse<ada::url_aggregator>(*base_url);
+    if (!parsed_base) return all();
+    base = std::move(*parsed_base);
+  }
+  auto url = ada::parse<ada::url_aggregator>(std::get<std::string_view>(input),
+                                             base ? &*base : nullptr);
+  if (!url) return all();
+
+  std::string_view pathname = url->get_pathname();
+  uint32_t node = 0;
+  size_t depth = 0;
+  while (true) {
+    const TrieNode& current = trie_[node];
+    candidates.insert(
+        candidates.end(), current.patterns.begin(), current.patterns.end());
+    if (depth == pathname.size()) break;
+    uint32_t next = 0;
+    for (const auto& [child_char, child] : current.children) {
+      if (child_char == pathname[depth]) {
+        next = child;
+        break;
+      }
+    }
+    if (next == 0) break;
+    node = next;
+    depth++;
+  }
+  std::sort(candidates.begin(), candidates.end());
+  return candidates;
+}
+
+void URLPatternList::New(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  if (!args.IsConstructCall()) {
+    THROW_ERR_CONSTRUCT_CALL_REQUIRED(env);
+    return;
+  }
+  if (!args[0]->IsArray()) {
+    THROW_ERR_INVALID_ARG_TYPE(env, "patterns must be an array");
+    return;
+  }
+
+  Local<Context> context = env->context();
+  Local<Array> array = args[0].As<Array>();
+  Local<FunctionTemplate> pattern_tmpl =
+      env->url_pattern_constructor_template();
+  std::vector<BaseObjectPtr<URLPattern>> patterns;
+  patterns.reserve(array->Length());
+  for (uint32_t i = 0; i < array->Length(); i++) {
+    Local<Value> value;
+    if (!array->Get(context, i).ToLocal(&value)) return;
+    if (!pattern_tmpl->HasInstance(value)) {
+      THROW_ERR_INVALID_ARG_TYPE(env, "patterns must be URLPattern instances");
+      return;
+    }
+    patterns.emplace_back(Unwrap<URLPattern>(value.As<Object>()));
+  }
+
+  new URLPatternList(env, args.This(), std::move(patterns));
+}
+
+void URLPatternList::Exec(const FunctionCallbackInfo<Value>& args) {
+  URLPatternList* list;
+  ASSIGN_OR_RETURN_UNWRAP(&list, args.This());
+  Environment* env = Environment::GetCurrent(args);
+
+  ada::url_pattern_input input;
+  std::string input_storage;
+  std::optional<std::string> base_url;
+  if (!GetPatternInput(env, args, &input, &input_storage, &base_url)) return;
+  const bool all = args.Length() > 2 && args[2]->IsTrue();
+
+  std::optional<std::string_view> base_url_view =
+      base_url ? std::optional<std::string_view>(*base_url) : std::nullopt;
+  LocalVector<Value> results(env->isolate());
+  for (uint32_t index : list->GetCandidates(input, base_url_view)) {
+    auto result = list->patterns_[index]->url_pattern_.exec(
+        input, base_url_view ? &*base_url_view : nullptr);
+    if (!result) {
+      THROW_ERR_OPERATION_FAILED(env, "Failed to exec URLPattern");
+      return;
+    }
+    if (!result->has_value()) continue;
+    Local<Value> value;
+    if (!URLPattern::URLPatternResult::ToJSValue(env, result->value())
+             .ToLocal(&value)) {
+      return;
+    }
+    results.push_back(Integer::NewFromUnsigned(env->isolate(), index));
+    results.push_back(value);
+    if (!all) break;
+  }
+  args.GetReturnValue().Set(
+      Array::New(env->isolate(), results.data(), results.size()));
+}
+
+void URLPatternList::Test(const FunctionCallbackInfo<Value>& args) {
+  URLPatternList* list;
+  ASSIGN_OR_RETURN_UNWRAP(&list, args.This());
+  Environment* env = Environment::GetCurrent(args);
+
+  ada::url_pattern_input input;
+  std::string input_storage;
+  std::optional<std::string> base_url;
+  if (!GetPatternInput(env, args, &input, &input_storage, &base_url)) return;
+
+  std::optional<std::string_view> base_url_view =
+      base_url ? std::optional<std::string_view>(*base_url) : std::nullopt;
+  for (uint32_t index : list->GetCandidates(input, base_url_view)) {
+    auto result = list->patterns_[index]->url_pattern_.test(
+        input, base_url_view ? &*base_url_view : nullptr);
+    if (!result) {
+      THROW_ERR_OPERATION_FAILED(env, "Failed to test URLPattern");
+      return;
+    }
+    if (*result) return args.GetReturnValue().Set(index);
+  }
+  args.GetReturnValue().Set(-1);
+}
+
 static void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(URLPattern::New);
 #define URL_PATTERN_COMPONENT_GETTERS(uppercase_name, _)                       \
@@ -626,6 +857,9 @@ static void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(URLPattern::HasRegexpGroups);
   registry->Register(URLPattern::Exec);
   registry->Register(URLPattern::Test);
+  registry->Register(URLPatternList::New);
+  registry->Register(URLPatternList::Exec);
+  registry->Register(URLPatternList::Test);
 }
 
 static void Initialize(Local<Object> target,
@@ -668,6 +902,14 @@ static void Initialize(Local<Object> target,
   SetProtoMethodNoSideEffect(isolate, ctor_tmpl, "exec", URLPattern::Exec);
   SetProtoMethodNoSideEffect(isolate, ctor_tmpl, "test", URLPattern::Test);
   SetConstructorFunction(context, target, "URLPattern", ctor_tmpl);
+  env->set_url_pattern_constructor_template(ctor_tmpl);
+
+  auto list_tmpl = NewFunctionTemplate(isolate, URLPatternList::New);
+  list_tmpl->InstanceTemplate()->SetInternalFieldCount(
+      URLPatternList::kInternalFieldCount);
+  SetProtoMethodNoSideEffect(isolate, list_tmpl, "exec", URLPatternList::Exec);
+  SetProtoMethodNoSideEffect(isolate, list_tmpl, "test", URLPatternList::Test);
+  SetConstructorFunction(context, target, "URLPatternList", list_tmpl);
 }
 
 }  // namespace node::url_pattern
@@ -10,7 +10,10 @@
 #include <v8.h>
 
 #include <optional>
+#include <string>
 #include <string_view>
+#include <utility>
+#include <vector>
 
 namespace node::url_pattern {
 
@@ -91,6 +94,8 @@ class URLPattern : public BaseObject {
   };
 
  private:
+  friend class URLPatternList;
+
   ada::url_pattern<URLPatternRegexProvider> url_pattern_;
   // Getter methods
 #define URL_PATTERN_COMPONENT_GETTERS(name, _) v8::MaybeLocal<v8::Value> name();
@@ -112,6 +117,53 @@ class URLPattern : public BaseObject {
 #undef URL_PATTERN_CACHED_VALUES
 };
 
+// An ordered list of URLPatterns that is matched against a URL in a single
+// call. The literal prefixes of the patterns' pathnames are stored in a
+// trie, so only the patterns whose prefix matches the pathname of the URL
+// are evaluated; the others cannot match. Patterns without a usable prefix
+// are always evaluated.
+class URLPatternList : public BaseObject {
+ public:
+  URLPatternList(Environment* env,
+                 v8::Local<v8::Object> object,
+                 std::vector<BaseObjectPtr<URLPattern>>&& patterns);
+
+  // new URLPatternList(patterns)
+  static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
+  // list.exec(input[, baseURL], all) returns a flat array of
+  // [index, result] pairs for the first or all matching patterns.
+  static void Exec(const v8::FunctionCallbackInfo<v8::Value>& args);
+  // list.test(input[, baseURL]) returns the index of the first matching
+  // pattern, or -1.
+  static void Test(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  void MemoryInfo(MemoryTracker* tracker) const override;
+  SET_MEMORY_INFO_NAME(URLPatternList)
+  SET_SELF_SIZE(URLPatternList)
+
+  // Returns the literal text every pathname matched by `pattern` starts
+  // with, which may be empty.
+  static std::string LiteralPathnamePrefix(
+      const ada::url_pattern<URLPatternRegexProvider>& pattern);
+
+ private:
+  struct TrieNode {
+    std::vector<std::pair<char, uint32_t>> children;
+    // Indices of the patterns whose prefix ends at this node.
+    std::vector<uint32_t> patterns;
+  };
+
+  void Insert(std::string_view prefix, uint32_t index);
+  // Returns the indices, in ascending order, of the patterns that may
+  // match `input`.
+  std::vector<uint32_t> GetCandidates(
+      const ada::url_pattern_input& input,
+      const std::optional<std::string_view>& base_url) const;
+
+  std::vector<BaseObjectPtr<URLPattern>> patterns_;
+  std::vector<TrieNode> trie_;
+};
+
 }  // namespace node::url_pattern
 
 #endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
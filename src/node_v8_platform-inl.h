@@ -142,11 +142,22 @@ struct V8Platform {
       auto categories = std::views::split(
           per_process::cli_options->trace_event_categories, ","sv);
 
+      using Format = tracing::NodeTraceWriter::Format;
+      using Compression = tracing::NodeTraceWriter::Compression;
+      Format format = per_process::cli_options->trace_event_format == "perfetto"
+                          ? Format::kPerfetto
+                          : Format::kJSON;
+      Compression compression =
+          per_process::cli_options->trace_event_compression == "zstd"
+              ? Compression::kZstd
+              : Compression::kNone;
       tracing_file_writer_ = tracing_agent_->AddClient(
           convert_to_set(categories),
           std::unique_ptr<tracing::AsyncTraceWriter>(
               new tracing::NodeTraceWriter(
-                  per_process::cli_options->trace_event_file_pattern)),
+                  per_process::cli_options->trace_event_file_pattern,
+                  format,
+                  compression)),
           tracing::Agent::kUseDefaultCategories);
     }
   }
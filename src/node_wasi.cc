@@ -26,6 +26,16 @@ inline void Debug(const WASI& wasi, Args&&... args) {
     }                                                                          \
   } while (0)
 
+namespace {
+// Scatter/gather lists and poll subscriptions are almost always short, so
+// keep them on the stack instead of allocating a vector for every call.
+constexpr size_t kIovecStackSize = 16;
+constexpr size_t kPollStackSize = 16;
+
+template <typename T>
+using IovecBuffer = MaybeStackBuffer<T, kIovecStackSize>;
+}  // namespace
+
 using v8::Array;
 using v8::ArrayBuffer;
 using v8::BigInt;
@@ -666,19 +676,19 @@ uint32_t WASI::FdPread(WASI& wasi,
         offset,
         nread_ptr);
   CHECK_BOUNDS_OR_RETURN(
-      memory.size, iovs_ptr, iovs_len * UVWASI_SERDES_SIZE_iovec_t);
+      memory.size, iovs_ptr, size_t{iovs_len} * UVWASI_SERDES_SIZE_iovec_t);
   CHECK_BOUNDS_OR_RETURN(memory.size, nread_ptr, UVWASI_SERDES_SIZE_size_t);
-  std::vector<uvwasi_iovec_t> iovs(iovs_len);
+  IovecBuffer<uvwasi_iovec_t> iovs(iovs_len);
   uvwasi_errno_t err;
 
   err = uvwasi_serdes_readv_iovec_t(
-      memory.data, memory.size, iovs_ptr, iovs.data(), iovs_len);
+      memory.data, memory.size, iovs_ptr, iovs.out(), iovs_len);
   if (err != UVWASI_ESUCCESS) {
     return err;
   }
 
   uvwasi_size_t nread;
-  err = uvwasi_fd_pread(&wasi.uvw_, fd, iovs.data(), iovs_len, offset, &nread);
+  err = uvwasi_fd_pread(&wasi.uvw_, fd, iovs.out(), iovs_len, offset, &nread);
   if (err == UVWASI_ESUCCESS)
     uvwasi_serdes_write_size_t(memory.data, nread_ptr, nread);
 
@@ -726,20 +736,20 @@ uint32_t WASI::FdPwrite(WASI& wasi,
         offset,
         nwritten_ptr);
   CHECK_BOUNDS_OR_RETURN(
-      memory.size, iovs_ptr, iovs_len * UVWASI_SERDES_SIZE_ciovec_t);
+      memory.size, iovs_ptr, size_t{iovs_len} * UVWASI_SERDES_SIZE_ciovec_t);
   CHECK_BOUNDS_OR_RETURN(memory.size, nwritten_ptr, UVWASI_SERDES_SIZE_size_t);
-  std::vector<uvwasi_ciovec_t> iovs(iovs_len);
+  IovecBuffer<uvwasi_ciovec_t> iovs(iovs_len);
   uvwasi_errno_t err;
 
   err = uvwasi_serdes_readv_ciovec_t(
-      memory.data, memory.size, iovs_ptr, iovs.data(), iovs_len);
+      memory.data, memory.size, iovs_ptr, iovs.out(), iovs_len);
   if (err != UVWASI_ESUCCESS) {
     return err;
   }
 
   uvwasi_size_t nwritten;
   err = uvwasi_fd_pwrite(
-      &wasi.uvw_, fd, iovs.data(), iovs_len, offset, &nwritten);
+      &wasi.uvw_, fd, iovs.out(), iovs_len, offset, &nwritten);
   if (err == UVWASI_ESUCCESS)
     uvwasi_serdes_write_size_t(memory.data, nwritten_ptr, nwritten);
 
@@ -754,19 +764,19 @@ uint32_t WASI::FdRead(WASI& wasi,
                       uint32_t nread_ptr) {
   Debug(wasi, "fd_read(%d, %d, %d, %d)\n", fd, iovs_ptr, iovs_len, nread_ptr);
   CHECK_BOUNDS_OR_RETURN(
-      memory.size, iovs_ptr, iovs_len * UVWASI_SERDES_SIZE_iovec_t);
+      memory.size, iovs_ptr, size_t{iovs_len} * UVWASI_SERDES_SIZE_iovec_t);
   CHECK_BOUNDS_OR_RETURN(memory.size, nread_ptr, UVWASI_SERDES_SIZE_size_t);
-  std::vector<uvwasi_iovec_t> iovs(iovs_len);
+  IovecBuffer<uvwasi_iovec_t> iovs(iovs_len);
   uvwasi_errno_t err;
 
   err = uvwasi_serdes_readv_iovec_t(
-      memory.data, memory.size, iovs_ptr, iovs.data(), iovs_len);
+      memory.data, memory.size, iovs_ptr, iovs.out(), iovs_len);
   if (err != UVWASI_ESUCCESS) {
     return err;
   }
 
   uvwasi_size_t nread;
-  err = uvwasi_fd_read(&wasi.uvw_, fd, iovs.data(), iovs_len, &nread);
+  err = uvwasi_fd_read(&wasi.uvw_, fd, iovs.out(), iovs_len, &nread);
   if (err == UVWASI_ESUCCESS)
     uvwasi_serdes_write_size_t(memory.data, nread_ptr, nread);
 
@@ -855,19 +865,19 @@ uint32_t WASI::FdWrite(WASI& wasi,
         iovs_len,
         nwritten_ptr);
   CHECK_BOUNDS_OR_RETURN(
-      memory.size, iovs_ptr, iovs_len * UVWASI_SERDES_SIZE_ciovec_t);
+      memory.size, iovs_ptr, size_t{iovs_len} * UVWASI_SERDES_SIZE_ciovec_t);
   CHECK_BOUNDS_OR_RETURN(memory.size, nwritten_ptr, UVWASI_SERDES_SIZE_size_t);
-  std::vector<uvwasi_ciovec_t> iovs(iovs_len);
+  IovecBuffer<uvwasi_ciovec_t> iovs(iovs_len);
   uvwasi_errno_t err;
 
   err = uvwasi_serdes_readv_ciovec_t(
-      memory.data, memory.size, iovs_ptr, iovs.data(), iovs_len);
+      memory.data, memory.size, iovs_ptr, iovs.out(), iovs_len);
   if (err != UVWASI_ESUCCESS) {
     return err;
   }
 
   uvwasi_size_t nwritten;
-  err = uvwasi_fd_write(&wasi.uvw_, fd, iovs.data(), iovs_len, &nwritten);
+  err = uvwasi_fd_write(&wasi.uvw_, fd, iovs.out(), iovs_len, &nwritten);
   if (err == UVWASI_ESUCCESS)
     uvwasi_serdes_write_size_t(memory.data, nwritten_ptr, nwritten);
 
@@ -1128,12 +1138,16 @@ uint32_t WASI::PollOneoff(WASI& wasi,
         nsubscriptions,
         nevents_ptr);
   CHECK_BOUNDS_OR_RETURN(
-      memory.size, in_ptr, nsubscriptions * UVWASI_SERDES_SIZE_subscription_t);
+      memory.size,
+      in_ptr,
+      size_t{nsubscriptions} * UVWASI_SERDES_SIZE_subscription_t);
   CHECK_BOUNDS_OR_RETURN(
-      memory.size, out_ptr, nsubscriptions * UVWASI_SERDES_SIZE_event_t);
+      memory.size,
+      out_ptr,
+      size_t{nsubscriptions} * UVWASI_SERDES_SIZE_event_t);
   CHECK_BOUNDS_OR_RETURN(memory.size, nevents_ptr, UVWASI_SERDES_SIZE_size_t);
-  std::vector<uvwasi_subscription_t> in(nsubscriptions);
-  std::vector<uvwasi_event_t> out(nsubscriptions);
+  MaybeStackBuffer<uvwasi_subscription_t, kPollStackSize> in(nsubscriptions);
+  MaybeStackBuffer<uvwasi_event_t, kPollStackSize> out(nsubscriptions);
 
   for (uint32_t i = 0; i < nsubscriptions; ++i) {
     uvwasi_serdes_read_subscription_t(memory.data, in_ptr, &in[i]);
@@ -1142,11 +1156,12 @@ uint32_t WASI::PollOneoff(WASI& wasi,
 
   uvwasi_size_t nevents;
   uvwasi_errno_t err = uvwasi_poll_oneoff(
-      &wasi.uvw_, in.data(), out.data(), nsubscriptions, &nevents);
+      &wasi.uvw_, in.out(), out.out(), nsubscriptions, &nevents);
   if (err == UVWASI_ESUCCESS) {
     uvwasi_serdes_write_size_t(memory.data, nevents_ptr, nevents);
 
-    for (uint32_t i = 0; i < nsubscriptions; ++i) {
+    // Only the first `nevents` entries of `out` have been filled in.
+    for (uint32_t i = 0; i < nevents; ++i) {
       uvwasi_serdes_write_event_t(memory.data, out_ptr, &out[i]);
       out_ptr += UVWASI_SERDES_SIZE_event_t;
     }
@@ -1211,12 +1226,14 @@ uint32_t WASI::SockRecv(WASI& wasi,
         ro_datalen_ptr,
         ro_flags_ptr);
   CHECK_BOUNDS_OR_RETURN(
-      memory.size, ri_data_ptr, ri_data_len * UVWASI_SERDES_SIZE_iovec_t);
+      memory.size,
+      ri_data_ptr,
+      size_t{ri_data_len} * UVWASI_SERDES_SIZE_iovec_t);
   CHECK_BOUNDS_OR_RETURN(memory.size, ro_datalen_ptr, 4);
   CHECK_BOUNDS_OR_RETURN(memory.size, ro_flags_ptr, 4);
-  std::vector<uvwasi_iovec_t> ri_data(ri_data_len);
+  IovecBuffer<uvwasi_iovec_t> ri_data(ri_data_len);
   uvwasi_errno_t err = uvwasi_serdes_readv_iovec_t(
-      memory.data, memory.size, ri_data_ptr, ri_data.data(), ri_data_len);
+      memory.data, memory.size, ri_data_ptr, ri_data.out(), ri_data_len);
   if (err != UVWASI_ESUCCESS) {
     return err;
   }
@@ -1225,7 +1242,7 @@ uint32_t WASI::SockRecv(WASI& wasi,
   uvwasi_roflags_t ro_flags;
   err = uvwasi_sock_recv(&wasi.uvw_,
                          sock,
-                         ri_data.data(),
+                         ri_data.out(),
                          ri_data_len,
                          ri_flags,
                          &ro_datalen,
@@ -1253,19 +1270,21 @@ uint32_t WASI::SockSend(WASI& wasi,
         si_flags,
         so_datalen_ptr);
   CHECK_BOUNDS_OR_RETURN(
-      memory.size, si_data_ptr, si_data_len * UVWASI_SERDES_SIZE_ciovec_t);
+      memory.size,
+      si_data_ptr,
+      size_t{si_data_len} * UVWASI_SERDES_SIZE_ciovec_t);
   CHECK_BOUNDS_OR_RETURN(
       memory.size, so_datalen_ptr, UVWASI_SERDES_SIZE_size_t);
-  std::vector<uvwasi_ciovec_t> si_data(si_data_len);
+  IovecBuffer<uvwasi_ciovec_t> si_data(si_data_len);
   uvwasi_errno_t err = uvwasi_serdes_readv_ciovec_t(
-      memory.data, memory.size, si_data_ptr, si_data.data(), si_data_len);
+      memory.data, memory.size, si_data_ptr, si_data.out(), si_data_len);
   if (err != UVWASI_ESUCCESS) {
     return err;
   }
 
   uvwasi_size_t so_datalen;
   err = uvwasi_sock_send(
-      &wasi.uvw_, sock, si_data.data(), si_data_len, si_flags, &so_datalen);
+      &wasi.uvw_, sock, si_data.out(), si_data_len, si_flags, &so_datalen);
   if (err == UVWASI_ESUCCESS)
     uvwasi_serdes_write_size_t(memory.data, so_datalen_ptr, so_datalen);
 
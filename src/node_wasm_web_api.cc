@@ -1,14 +1,24 @@
 #include "node_wasm_web_api.h"
 
+#include "compile_cache.h"
+#include "env-inl.h"
 #include "memory_tracker-inl.h"
 #include "node_errors.h"
 #include "node_external_reference.h"
+#include "path.h"
+#include "util-inl.h"
+#include "zlib.h"
+
+#include <memory>
+#include <string>
+#include <vector>
 
 namespace node {
 namespace wasm_web_api {
 
 using v8::ArrayBuffer;
 using v8::ArrayBufferView;
+using v8::CompiledWasmModule;
 using v8::Context;
 using v8::Function;
 using v8::FunctionCallbackInfo;
@@ -20,6 +30,104 @@ using v8::Object;
 using v8::Value;
 using v8::WasmStreaming;
 
+namespace {
+
+// Compiled modules are cached in the compile cache directory, one file per
+// URL that they were fetched from:
+//   [uint32_t] magic number
+//   [uint32_t] size of the WebAssembly bytes the module was compiled from
+//   [uint32_t] hash of those bytes
+//   [uint32_t] size of the compiled module
+//   [uint32_t] hash of the compiled module
+//   .... the compiled module, as serialized by V8 ....
+// V8 rejects modules that were serialized by a different version by itself.
+constexpr uint32_t kModuleCacheMagicNumber = 0x8adf57a1;
+enum ModuleCacheHeader {
+  kMagicNumber,
+  kWasmSize,
+  kWasmHash,
+  kModuleSize,
+  kModuleHash,
+  kHeaderCount,
+};
+constexpr size_t kHeaderSize = kHeaderCount * sizeof(uint32_t);
+
+uint32_t Hash(uint32_t crc, const uint8_t* data, size_t size) {
+  return crc32(crc, reinterpret_cast<const Bytef*>(data), size);
+}
+
+uint32_t InitialHash() {
+  return crc32(0L, Z_NULL, 0);
+}
+
+std::string GetModuleCacheFilename(std::string_view cache_dir,
+                                   std::string_view url) {
+  char name[32];
+  snprintf(name,
+           sizeof(name),
+           "wasm-%08x",
+           Hash(InitialHash(),
+                reinterpret_cast<const uint8_t*>(url.data()),
+                url.size()));
+  return std::string(cache_dir) + kPathSeparator + name;
+}
+
+// Called by V8, possibly on a background thread and after the Environment
+// is gone, whenever more functions of the module have been compiled, e.g.
+// when they have been tiered up. The file is replaced in one go, so that
+// concurrent readers never see a partially written module.
+void WriteModuleCache(const std::string& filename,
+                      CompiledWasmModule* module) {
+  v8::OwnedBuffer serialized = module->Serialize();
+  v8::MemorySpan<const uint8_t> wasm = module->GetWireBytesRef();
+  if (serialized.size == 0 || wasm.size() > UINT32_MAX ||
+      serialized.size > UINT32_MAX) {
+    return;
+  }
+  uint32_t header[kHeaderCount];
+  header[kMagicNumber] = kModuleCacheMagicNumber;
+  header[kWasmSize] = static_cast<uint32_t>(wasm.size());
+  header[kWasmHash] = Hash(InitialHash(), wasm.data(), wasm.size());
+  header[kModuleSize] = static_cast<uint32_t>(serialized.size);
+  header[kModuleHash] =
+      Hash(InitialHash(), serialized.buffer.get(), serialized.size);
+
+  std::string filename_tmp = filename + ".XXXXXX";
+  uv_fs_t req;
+  int err = uv_fs_mkstemp(nullptr, &req, filename_tmp.c_str(), nullptr);
+  if (err < 0) {
+    uv_fs_req_cleanup(&req);
+    return;
+  }
+  uv_file file = static_cast<uv_file>(req.result);
+  filename_tmp = req.path;
+  uv_fs_req_cleanup(&req);
+
+  uv_buf_t bufs[] = {
+      uv_buf_init(reinterpret_cast<char*>(header), kHeaderSize),
+      uv_buf_init(const_cast<char*>(reinterpret_cast<const char*>(
+                      serialized.buffer.get())),
+                  serialized.size),
+  };
+  err = uv_fs_write(nullptr, &req, file, bufs, arraysize(bufs), 0, nullptr);
+  uv_fs_req_cleanup(&req);
+  int close_err = uv_fs_close(nullptr, &req, file, nullptr);
+  uv_fs_req_cleanup(&req);
+  if (err == static_cast<int>(kHeaderSize + serialized.size) &&
+      close_err == 0 &&
+      uv_fs_rename(
+          nullptr, &req, filename_tmp.c_str(), filename.c_str(), nullptr) ==
+          0) {
+    uv_fs_req_cleanup(&req);
+    return;
+  }
+  uv_fs_req_cleanup(&req);
+  uv_fs_unlink(nullptr, &req, filename_tmp.c_str(), nullptr);
+  uv_fs_req_cleanup(&req);
+}
+
+}  // namespace
+
 Local<Function> WasmStreamingObject::Initialize(Environment* env) {
   Local<Function> templ = env->wasm_streaming_object_constructor();
   if (!templ.IsEmpty()) {
@@ -70,6 +178,7 @@ MaybeLocal<Object> WasmStreamingObject::Create(
   CHECK_NOT_NULL(ptr);
   ptr->streaming_ = streaming;
   ptr->wasm_size_ = 0;
+  ptr->wasm_hash_ = InitialHash();
   return obj;
 }
 
@@ -88,6 +197,47 @@ void WasmStreamingObject::SetURL(const FunctionCallbackInfo<Value>& args) {
   CHECK(args[0]->IsString());
   Utf8Value url(Environment::GetCurrent(args)->isolate(), args[0]);
   obj->streaming_->SetUrl(url.out(), url.length());
+  obj->SetUpModuleCache(url.ToStringView());
+}
+
+void WasmStreamingObject::SetUpModuleCache(std::string_view url) {
+  // The URL is set before any bytes are pushed, which is when V8 accepts a
+  // compiled module. Modules without a URL, e.g. from a Response that was
+  // constructed from a buffer, are not cached.
+  if (!env()->use_compile_cache() || url.empty() || wasm_size_ != 0) {
+    return;
+  }
+  std::string filename =
+      GetModuleCacheFilename(env()->compile_cache_handler()->cache_dir(), url);
+
+  // V8 may read the compiled module until the compilation is done, so it is
+  // owned by the callback, which lives as long as the compilation.
+  auto cached = std::make_shared<std::string>();
+  if (ReadFileSync(cached.get(), filename.c_str()) == 0 &&
+      cached->size() >= kHeaderSize) {
+    uint32_t header[kHeaderCount];
+    memcpy(header, cached->data(), kHeaderSize);
+    const uint8_t* module =
+        reinterpret_cast<const uint8_t*>(cached->data()) + kHeaderSize;
+    size_t module_size = cached->size() - kHeaderSize;
+    if (header[kMagicNumber] == kModuleCacheMagicNumber &&
+        header[kModuleSize] == module_size &&
+        header[kModuleHash] == Hash(InitialHash(), module, module_size) &&
+        streaming_->SetCompiledModuleBytes(module, module_size)) {
+      has_cached_module_ = true;
+      cached_wasm_size_ = header[kWasmSize];
+      cached_wasm_hash_ = header[kWasmHash];
+    }
+  }
+  if (!has_cached_module_) {
+    cached.reset();
+  }
+
+  streaming_->SetMoreFunctionsCanBeSerializedCallback(
+      [filename = std::move(filename),
+       cached = std::move(cached)](CompiledWasmModule module) {
+        WriteModuleCache(filename, &module);
+      });
 }
 
 void WasmStreamingObject::Push(const FunctionCallbackInfo<Value>& args) {
@@ -121,9 +271,12 @@ void WasmStreamingObject::Push(const FunctionCallbackInfo<Value>& args) {
   }
 
   // Forward the data to V8. Internally, V8 will make a copy.
-  obj->streaming_->OnBytesReceived(static_cast<const uint8_t*>(bytes) + offset,
-                                   size);
+  const uint8_t* data = static_cast<const uint8_t*>(bytes) + offset;
+  obj->streaming_->OnBytesReceived(data, size);
   obj->wasm_size_ += size;
+  if (obj->has_cached_module_) {
+    obj->wasm_hash_ = Hash(obj->wasm_hash_, data, size);
+  }
 }
 
 void WasmStreamingObject::Finish(const FunctionCallbackInfo<Value>& args) {
@@ -132,7 +285,12 @@ void WasmStreamingObject::Finish(const FunctionCallbackInfo<Value>& args) {
   CHECK(obj->streaming_);
 
   CHECK_EQ(args.Length(), 0);
-  obj->streaming_->Finish();
+  // The cached module can only be used if the URL still serves the bytes it
+  // was compiled from.
+  bool can_use_cached_module = obj->has_cached_module_ &&
+                               obj->wasm_size_ == obj->cached_wasm_size_ &&
+                               obj->wasm_hash_ == obj->cached_wasm_hash_;
+  obj->streaming_->Finish(can_use_cached_module);
 }
 
 void WasmStreamingObject::Abort(const FunctionCallbackInfo<Value>& args) {
@@ -38,8 +38,19 @@ class WasmStreamingObject final : public BaseObject {
   static void Finish(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Abort(const v8::FunctionCallbackInfo<v8::Value>& args);
 
+  // Looks up the module compiled from `url` in an earlier run, and arranges
+  // for the module compiled now to be stored, if the compile cache is on.
+  void SetUpModuleCache(std::string_view url);
+
   std::shared_ptr<v8::WasmStreaming> streaming_;
   size_t wasm_size_ = 0;
+  // The hash of the bytes pushed so far.
+  uint32_t wasm_hash_ = 0;
+  // Set if a module compiled in an earlier run was passed to V8; it is only
+  // used if it was compiled from the same bytes.
+  bool has_cached_module_ = false;
+  uint32_t cached_wasm_size_ = 0;
+  uint32_t cached_wasm_hash_ = 0;
 };
 
 // This is a v8::WasmStreamingCallback implementation that must be passed to
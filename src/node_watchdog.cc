@@ -20,6 +20,9 @@
 // USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include <algorithm>
+#include <limits>
+#include <set>
+#include <utility>
 
 #include "async_wrap-inl.h"
 #include "debug_utils-inl.h"
@@ -39,63 +42,132 @@ using v8::Local;
 using v8::Object;
 using v8::Value;
 
-Watchdog::Watchdog(v8::Isolate* isolate, uint64_t ms, bool* timed_out)
-    : isolate_(isolate), timed_out_(timed_out) {
+// A single thread that watches the deadlines of all Watchdogs in the
+// process, so that running code with a timeout does not need to create a
+// thread and a loop every time.
+class WatchdogThread {
+ public:
+  static WatchdogThread* GetInstance() {
+    // Leaked on purpose, the thread runs until the process exits.
+    static WatchdogThread* instance = new WatchdogThread();
+    return instance;
+  }
+
+  void Arm(Watchdog* wd);
+  void Disarm(Watchdog* wd);
+
+ private:
+  WatchdogThread();
+
+  static void Run(void* arg);
+  static void OnTimer(uv_timer_t* timer);
+
+  // Starts the timer for the earliest deadline. Must be called on the
+  // watchdog thread.
+  void ArmTimer();
+
+  uv_thread_t thread_;
+  uv_loop_t loop_;
+  uv_async_t async_;
+  uv_timer_t timer_;
+
+  Mutex mutex_;
+  // Ordered by deadline; the first entry is the next one to expire.
+  std::set<std::pair<uint64_t, Watchdog*>> deadlines_;
+  // The deadline that the timer is, or is about to be, started for.
+  uint64_t timer_deadline_ = std::numeric_limits<uint64_t>::max();
+};
 
-  int rc;
-  rc = uv_loop_init(&loop_);
+WatchdogThread::WatchdogThread() {
+  int rc = uv_loop_init(&loop_);
   if (rc != 0) {
     UNREACHABLE("Failed to initialize uv loop.");
   }
 
   rc = uv_async_init(&loop_, &async_, [](uv_async_t* signal) {
-    Watchdog* w = ContainerOf(&Watchdog::async_, signal);
-    uv_stop(&w->loop_);
+    WatchdogThread* thread = ContainerOf(&WatchdogThread::async_, signal);
+    thread->ArmTimer();
   });
-
   CHECK_EQ(0, rc);
 
   rc = uv_timer_init(&loop_, &timer_);
   CHECK_EQ(0, rc);
 
-  rc = uv_timer_start(&timer_, &Watchdog::Timer, ms, 0);
-  CHECK_EQ(0, rc);
-
-  rc = uv_thread_create(&thread_, &Watchdog::Run, this);
+  rc = uv_thread_create(&thread_, &WatchdogThread::Run, this);
   CHECK_EQ(0, rc);
 }
 
+void WatchdogThread::Run(void* arg) {
+  WatchdogThread* thread = static_cast<WatchdogThread*>(arg);
+  // async_ keeps the loop alive forever.
+  uv_run(&thread->loop_, UV_RUN_DEFAULT);
+}
 
-Watchdog::~Watchdog() {
-  uv_async_send(&async_);
-  uv_thread_join(&thread_);
-
-  uv_close(reinterpret_cast<uv_handle_t*>(&async_), nullptr);
-
-  // UV_RUN_DEFAULT so that libuv has a chance to clean up.
-  uv_run(&loop_, UV_RUN_DEFAULT);
-
-  CheckedUvLoopClose(&loop_);
+void WatchdogThread::Arm(Watchdog* wd) {
+  bool wakeup = false;
+  {
+    Mutex::ScopedLock lock(mutex_);
+    deadlines_.emplace(wd->deadline_, wd);
+    // Timers of disarmed watchdogs are left running, so that back-to-back
+    // runs with the same timeout do not have to wake up the thread.
+    if (wd->deadline_ < timer_deadline_) {
+      timer_deadline_ = wd->deadline_;
+      wakeup = true;
+    }
+  }
+  if (wakeup) CHECK_EQ(0, uv_async_send(&async_));
 }
 
+void WatchdogThread::Disarm(Watchdog* wd) {
+  // Watchdogs expire with mutex_ held, so once this returns the timeout can
+  // no longer be reported to `wd`.
+  Mutex::ScopedLock lock(mutex_);
+  deadlines_.erase({wd->deadline_, wd});
+}
 
-void Watchdog::Run(void* arg) {
-  Watchdog* wd = static_cast<Watchdog*>(arg);
+void WatchdogThread::ArmTimer() {
+  Mutex::ScopedLock lock(mutex_);
+  if (deadlines_.empty()) {
+    uv_timer_stop(&timer_);
+    timer_deadline_ = std::numeric_limits<uint64_t>::max();
+    return;
+  }
+  timer_deadline_ = deadlines_.begin()->first;
+  uint64_t now = uv_hrtime();
+  // Round up, so that the timer does not fire before the deadline.
+  uint64_t timeout =
+      timer_deadline_ > now ? (timer_deadline_ - now + 999999) / 1000000 : 0;
+  uv_update_time(&loop_);
+  CHECK_EQ(0, uv_timer_start(&timer_, &WatchdogThread::OnTimer, timeout, 0));
+}
 
-  // UV_RUN_DEFAULT the loop will be stopped either by the async or the
-  // timer handle.
-  uv_run(&wd->loop_, UV_RUN_DEFAULT);
+void WatchdogThread::OnTimer(uv_timer_t* timer) {
+  WatchdogThread* thread = ContainerOf(&WatchdogThread::timer_, timer);
+  {
+    Mutex::ScopedLock lock(thread->mutex_);
+    uint64_t now = uv_hrtime();
+    auto& deadlines = thread->deadlines_;
+    while (!deadlines.empty() && deadlines.begin()->first <= now) {
+      Watchdog* wd = deadlines.begin()->second;
+      deadlines.erase(deadlines.begin());
+      *wd->timed_out_ = true;
+      wd->isolate()->TerminateExecution();
+    }
+  }
+  thread->ArmTimer();
+}
 
-  // Loop ref count reaches zero when both handles are closed.
-  // Close the timer handle on this side and let ~Watchdog() close async_
-  uv_close(reinterpret_cast<uv_handle_t*>(&wd->timer_), nullptr);
+Watchdog::Watchdog(v8::Isolate* isolate, uint64_t ms, bool* timed_out)
+    : isolate_(isolate), timed_out_(timed_out) {
+  uint64_t now = uv_hrtime();
+  constexpr uint64_t kMax = std::numeric_limits<uint64_t>::max();
+  deadline_ = ms < (kMax - now) / 1000000 ? now + ms * 1000000 : kMax;
+  WatchdogThread::GetInstance()->Arm(this);
 }
 
-void Watchdog::Timer(uv_timer_t* timer) {
-  Watchdog* w = ContainerOf(&Watchdog::timer_, timer);
-  *w->timed_out_ = true;
-  w->isolate()->TerminateExecution();
-  uv_stop(&w->loop_);
+
+Watchdog::~Watchdog() {
+  WatchdogThread::GetInstance()->Disarm(this);
 }
 
 
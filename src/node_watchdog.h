@@ -51,15 +51,12 @@ class Watchdog {
   v8::Isolate* isolate() { return isolate_; }
 
  private:
-  static void Run(void* arg);
-  static void Timer(uv_timer_t* timer);
+  friend class WatchdogThread;
 
   v8::Isolate* isolate_;
-  uv_thread_t thread_;
-  uv_loop_t loop_;
-  uv_async_t async_;
-  uv_timer_t timer_;
   bool* timed_out_;
+  // Absolute time in uv_hrtime() nanoseconds.
+  uint64_t deadline_;
 };
 
 class SigintWatchdogBase {
@@ -6,6 +6,7 @@
 #include "node.h"
 #include "node_errors.h"
 #include "node_mem-inl.h"
+#include "node_process-inl.h"
 #include "path.h"
 #include "sqlite3.h"
 #include "util-inl.h"
@@ -82,10 +83,25 @@ static void ThrowQuotaExceededException(Local<Context> context) {
   isolate->ThrowException(exception);
 }
 
+// Resets a cached statement after use, so that it does not keep a read
+// transaction open or refer to the memory of its bound parameters.
+class StatementResetScope {
+ public:
+  explicit StatementResetScope(sqlite3_stmt* stmt) : stmt_(stmt) {}
+  ~StatementResetScope() {
+    sqlite3_reset(stmt_);
+    sqlite3_clear_bindings(stmt_);
+  }
+
+ private:
+  sqlite3_stmt* stmt_;
+};
+
 Storage::Storage(Environment* env,
                  Local<Object> object,
-                 std::string_view location)
-    : BaseObject(env, object) {
+                 std::string_view location,
+                 bool batch_writes)
+    : BaseObject(env, object), batch_writes_(batch_writes) {
   MakeWeak();
   symbols_.Reset(env->isolate(), Map::New(env->isolate()));
   db_ = nullptr;
@@ -93,6 +109,9 @@ Storage::Storage(Environment* env,
 }
 
 Storage::~Storage() {
+  if (db_) Commit();
+  // The statements have to be finalized before the connection is closed.
+  for (auto& stmt : statements_) stmt = nullptr;
   db_ = nullptr;
 }
 
@@ -225,24 +244,75 @@ void Storage::New(const FunctionCallbackInfo<Value>& args) {
     ToNamespacedPath(env, &location);
   }
 
-  new Storage(env, args.This(), location.ToStringView());
+  // With batchWrites, the writes made during one event loop iteration are
+  // committed in a single transaction on the next iteration.
+  bool batch_writes = args.Length() > 2 && args[2]->IsTrue();
+
+  new Storage(env, args.This(), location.ToStringView(), batch_writes);
+}
+
+sqlite3_stmt* Storage::Prepare(StatementId id, std::string_view sql) {
+  stmt_unique_ptr& cached = statements_[static_cast<size_t>(id)];
+  if (!cached) {
+    sqlite3_stmt* s = nullptr;
+    int r = sqlite3_prepare_v3(db_.get(),
+                               sql.data(),
+                               sql.size(),
+                               SQLITE_PREPARE_PERSISTENT,
+                               &s,
+                               nullptr);
+    CHECK_ERROR_OR_THROW(env(), r, SQLITE_OK, nullptr);
+    cached = stmt_unique_ptr(s);
+  }
+  return cached.get();
+}
+
+Maybe<void> Storage::BeginWrite() {
+  if (!batch_writes_ || in_transaction_) {
+    return JustVoid();
+  }
+
+  int r = sqlite3_exec(db_.get(), "BEGIN IMMEDIATE", 0, 0, nullptr);
+  CHECK_ERROR_OR_THROW(env(), r, SQLITE_OK, Nothing<void>());
+  in_transaction_ = true;
+
+  // All writes made until the next event loop iteration are committed
+  // together.
+  env()->SetImmediate([self = BaseObjectWeakPtr<Storage>(this)](
+                          Environment* env) {
+    if (!self) return;
+    int r = self->Commit();
+    if (r != SQLITE_OK) {
+      ProcessEmitWarning(
+          env, "Failed to commit localStorage writes: %s", sqlite3_errstr(r));
+    }
+  });
+  return JustVoid();
+}
+
+int Storage::Commit() {
+  if (!in_transaction_) {
+    return SQLITE_OK;
+  }
+  in_transaction_ = false;
+  int r = sqlite3_exec(db_.get(), "COMMIT", 0, 0, nullptr);
+  if (r != SQLITE_OK && !sqlite3_get_autocommit(db_.get())) {
+    // Do not leave the transaction open for the writes that come next.
+    sqlite3_exec(db_.get(), "ROLLBACK", 0, 0, nullptr);
+  }
+  return r;
 }
 
 Maybe<void> Storage::Clear() {
-  if (!Open().IsJust()) {
+  if (!Open().IsJust() || !BeginWrite().IsJust()) {
     return Nothing<void>();
   }
 
   static constexpr std::string_view sql = "DELETE FROM nodejs_webstorage";
-  sqlite3_stmt* s = nullptr;
-  CHECK_ERROR_OR_THROW(
-      env(),
-      sqlite3_prepare_v2(db_.get(), sql.data(), sql.size(), &s, 0),
-      SQLITE_OK,
-      Nothing<void>());
-  auto stmt = stmt_unique_ptr(s);
-  CHECK_ERROR_OR_THROW(
-      env(), sqlite3_step(stmt.get()), SQLITE_DONE, Nothing<void>());
+  sqlite3_stmt* stmt = Prepare(StatementId::kClear, sql);
+  if (stmt == nullptr) return Nothing<void>();
+  StatementResetScope reset_scope(stmt);
+  CHECK_ERROR_OR_THROW(env(), sqlite3_step(stmt), SQLITE_DONE, Nothing<void>());
   return JustVoid();
 }
 
@@ -252,20 +322,20 @@ MaybeLocal<Array> Storage::Enumerate() {
   }
 
   static constexpr std::string_view sql = "SELECT key FROM nodejs_webstorage";
-  sqlite3_stmt* s = nullptr;
-  int r = sqlite3_prepare_v2(db_.get(), sql.data(), sql.size(), &s, 0);
-  CHECK_ERROR_OR_THROW(env(), r, SQLITE_OK, Local<Array>());
-  auto stmt = stmt_unique_ptr(s);
+  sqlite3_stmt* stmt = Prepare(StatementId::kEnumerate, sql);
+  if (stmt == nullptr) return Local<Array>();
+  StatementResetScope reset_scope(stmt);
   LocalVector<Value> values(env()->isolate());
   Local<Value> value;
-  while ((r = sqlite3_step(stmt.get())) == SQLITE_ROW) {
-    CHECK(sqlite3_column_type(stmt.get(), 0) == SQLITE_BLOB);
-    auto size = sqlite3_column_bytes(stmt.get(), 0) / sizeof(uint16_t);
-    if (!String::NewFromTwoByte(env()->isolate(),
-                                reinterpret_cast<const uint16_t*>(
-                                    sqlite3_column_blob(stmt.get(), 0)),
-                                NewStringType::kNormal,
-                                size)
+  int r;
+  while ((r = sqlite3_step(stmt)) == SQLITE_ROW) {
+    CHECK(sqlite3_column_type(stmt, 0) == SQLITE_BLOB);
+    auto size = sqlite3_column_bytes(stmt, 0) / sizeof(uint16_t);
+    if (!String::NewFromTwoByte(
+             env()->isolate(),
+             reinterpret_cast<const uint16_t*>(sqlite3_column_blob(stmt, 0)),
+             NewStringType::kNormal,
+             size)
              .ToLocal(&value)) {
       return Local<Array>();
     }
@@ -282,14 +352,12 @@ MaybeLocal<Value> Storage::Length() {
 
   static constexpr std::string_view sql =
       "SELECT count(*) FROM nodejs_webstorage";
-  sqlite3_stmt* s = nullptr;
-  int r = sqlite3_prepare_v2(db_.get(), sql.data(), sql.size(), &s, 0);
-  CHECK_ERROR_OR_THROW(env(), r, SQLITE_OK, Local<Value>());
-  auto stmt = stmt_unique_ptr(s);
-  CHECK_ERROR_OR_THROW(
-      env(), sqlite3_step(stmt.get()), SQLITE_ROW, Local<Value>());
-  CHECK(sqlite3_column_type(stmt.get(), 0) == SQLITE_INTEGER);
-  int result = sqlite3_column_int(stmt.get(), 0);
+  sqlite3_stmt* stmt = Prepare(StatementId::kLength, sql);
+  if (stmt == nullptr) return Local<Value>();
+  StatementResetScope reset_scope(stmt);
+  CHECK_ERROR_OR_THROW(env(), sqlite3_step(stmt), SQLITE_ROW, Local<Value>());
+  CHECK(sqlite3_column_type(stmt, 0) == SQLITE_INTEGER);
+  int result = sqlite3_column_int(stmt, 0);
   return Integer::New(env()->isolate(), result);
 }
 
@@ -305,23 +373,22 @@ MaybeLocal<Value> Storage::Load(Local<Name> key) {
 
   static constexpr std::string_view sql =
       "SELECT value FROM nodejs_webstorage WHERE key = ? LIMIT 1";
-  sqlite3_stmt* s = nullptr;
-  int r = sqlite3_prepare_v2(db_.get(), sql.data(), sql.size(), &s, 0);
-  CHECK_ERROR_OR_THROW(env(), r, SQLITE_OK, Local<Value>());
-  auto stmt = stmt_unique_ptr(s);
+  sqlite3_stmt* stmt = Prepare(StatementId::kLoad, sql);
+  if (stmt == nullptr) return Local<Value>();
+  StatementResetScope reset_scope(stmt);
   TwoByteValue utf16key(env()->isolate(), key);
   auto key_size = utf16key.length() * sizeof(uint16_t);
-  r = sqlite3_bind_blob(stmt.get(), 1, utf16key.out(), key_size, SQLITE_STATIC);
+  int r = sqlite3_bind_blob(stmt, 1, utf16key.out(), key_size, SQLITE_STATIC);
   CHECK_ERROR_OR_THROW(env(), r, SQLITE_OK, Local<Value>());
-  r = sqlite3_step(stmt.get());
+  r = sqlite3_step(stmt);
   if (r == SQLITE_ROW) {
-    CHECK(sqlite3_column_type(stmt.get(), 0) == SQLITE_BLOB);
-    auto size = sqlite3_column_bytes(stmt.get(), 0) / sizeof(uint16_t);
-    return String::NewFromTwoByte(env()->isolate(),
-                                  reinterpret_cast<const uint16_t*>(
-                                      sqlite3_column_blob(stmt.get(), 0)),
-                                  NewStringType::kNormal,
-                                  size)
+    CHECK(sqlite3_column_type(stmt, 0) == SQLITE_BLOB);
+    auto size = sqlite3_column_bytes(stmt, 0) / sizeof(uint16_t);
+    return String::NewFromTwoByte(
+               env()->isolate(),
+               reinterpret_cast<const uint16_t*>(sqlite3_column_blob(stmt, 0)),
+               NewStringType::kNormal,
+               size)
         .As<Value>();
   } else if (r != SQLITE_DONE) {
     THROW_SQLITE_ERROR(env(), r);
@@ -338,22 +405,21 @@ MaybeLocal<Value> Storage::LoadKey(const int index) {
 
   static constexpr std::string_view sql =
       "SELECT key FROM nodejs_webstorage LIMIT 1 OFFSET ?";
-  sqlite3_stmt* s = nullptr;
-  int r = sqlite3_prepare_v2(db_.get(), sql.data(), sql.size(), &s, 0);
-  CHECK_ERROR_OR_THROW(env(), r, SQLITE_OK, Local<Value>());
-  auto stmt = stmt_unique_ptr(s);
-  r = sqlite3_bind_int(stmt.get(), 1, index);
+  sqlite3_stmt* stmt = Prepare(StatementId::kLoadKey, sql);
+  if (stmt == nullptr) return Local<Value>();
+  StatementResetScope reset_scope(stmt);
+  int r = sqlite3_bind_int(stmt, 1, index);
   CHECK_ERROR_OR_THROW(env(), r, SQLITE_OK, Local<Value>());
 
-  r = sqlite3_step(stmt.get());
+  r = sqlite3_step(stmt);
   if (r == SQLITE_ROW) {
-    CHECK(sqlite3_column_type(stmt.get(), 0) == SQLITE_BLOB);
-    auto size = sqlite3_column_bytes(stmt.get(), 0) / sizeof(uint16_t);
-    return String::NewFromTwoByte(env()->isolate(),
-                                  reinterpret_cast<const uint16_t*>(
-                                      sqlite3_column_blob(stmt.get(), 0)),
-                                  NewStringType::kNormal,
-                                  size)
+    CHECK(sqlite3_column_type(stmt, 0) == SQLITE_BLOB);
+    auto size = sqlite3_column_bytes(stmt, 0) / sizeof(uint16_t);
+    return String::NewFromTwoByte(
+               env()->isolate(),
+               reinterpret_cast<const uint16_t*>(sqlite3_column_blob(stmt, 0)),
+               NewStringType::kNormal,
+               size)
         .As<Value>();
   } else if (r != SQLITE_DONE) {
     THROW_SQLITE_ERROR(env(), r);
@@ -370,22 +436,20 @@ Maybe<void> Storage::Remove(Local<Name> key) {
     return result.IsNothing() ? Nothing<void>() : JustVoid();
   }
 
-  if (!Open().IsJust()) {
+  if (!Open().IsJust() || !BeginWrite().IsJust()) {
     return Nothing<void>();
   }
 
   static constexpr std::string_view sql =
       "DELETE FROM nodejs_webstorage WHERE key = ?";
-  sqlite3_stmt* s = nullptr;
-  int r = sqlite3_prepare_v2(db_.get(), sql.data(), sql.size(), &s, 0);
-  CHECK_ERROR_OR_THROW(env(), r, SQLITE_OK, Nothing<void>());
-  auto stmt = stmt_unique_ptr(s);
+  sqlite3_stmt* stmt = Prepare(StatementId::kRemove, sql);
+  if (stmt == nullptr) return Nothing<void>();
+  StatementResetScope reset_scope(stmt);
   TwoByteValue utf16key(env()->isolate(), key);
   auto key_size = utf16key.length() * sizeof(uint16_t);
-  r = sqlite3_bind_blob(stmt.get(), 1, utf16key.out(), key_size, SQLITE_STATIC);
+  int r = sqlite3_bind_blob(stmt, 1, utf16key.out(), key_size, SQLITE_STATIC);
   CHECK_ERROR_OR_THROW(env(), r, SQLITE_OK, Nothing<void>());
-  CHECK_ERROR_OR_THROW(
-      env(), sqlite3_step(stmt.get()), SQLITE_DONE, Nothing<void>());
+  CHECK_ERROR_OR_THROW(env(), sqlite3_step(stmt), SQLITE_DONE, Nothing<void>());
   return JustVoid();
 }
 
@@ -401,7 +465,7 @@ Maybe<void> Storage::Store(Local<Name> key, Local<Value> value) {
     return Nothing<void>();
   }
 
-  if (!Open().IsJust()) {
+  if (!Open().IsJust() || !BeginWrite().IsJust()) {
     return Nothing<void>();
   }
 
@@ -409,21 +473,22 @@ Maybe<void> Storage::Store(Local<Name> key, Local<Value> value) {
       "INSERT INTO nodejs_webstorage (key, value) VALUES (?, ?)"
       "  ON CONFLICT (key) DO UPDATE SET value = EXCLUDED.value"
       "  WHERE EXCLUDED.key = key";
-  sqlite3_stmt* s = nullptr;
   TwoByteValue utf16key(env()->isolate(), key);
   TwoByteValue utf16val(env()->isolate(), val);
-  int r = sqlite3_prepare_v2(db_.get(), sql.data(), sql.size(), &s, 0);
-  CHECK_ERROR_OR_THROW(env(), r, SQLITE_OK, Nothing<void>());
-  auto stmt = stmt_unique_ptr(s);
+  sqlite3_stmt* stmt = Prepare(StatementId::kStore, sql);
+  if (stmt == nullptr) return Nothing<void>();
+  StatementResetScope reset_scope(stmt);
   auto key_size = utf16key.length() * sizeof(uint16_t);
-  r = sqlite3_bind_blob(stmt.get(), 1, utf16key.out(), key_size, SQLITE_STATIC);
+  int r = sqlite3_bind_blob(stmt, 1, utf16key.out(), key_size, SQLITE_STATIC);
   CHECK_ERROR_OR_THROW(env(), r, SQLITE_OK, Nothing<void>());
   auto val_size = utf16val.length() * sizeof(uint16_t);
-  r = sqlite3_bind_blob(stmt.get(), 2, utf16val.out(), val_size, SQLITE_STATIC);
+  r = sqlite3_bind_blob(stmt, 2, utf16val.out(), val_size, SQLITE_STATIC);
   CHECK_ERROR_OR_THROW(env(), r, SQLITE_OK, Nothing<void>());
 
-  r = sqlite3_step(stmt.get());
+  r = sqlite3_step(stmt);
   if (r == SQLITE_CONSTRAINT) {
+    // The quota triggers only abort this statement, so an open batch of
+    // writes is unaffected.
     ThrowQuotaExceededException(env()->context());
     return Nothing<void>();
   }
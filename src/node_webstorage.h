@@ -3,6 +3,7 @@
 
 #if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
 
+#include <array>
 #include "base_object.h"
 #include "node_mem.h"
 #include "sqlite3.h"
@@ -29,7 +30,8 @@ class Storage : public BaseObject {
  public:
   Storage(Environment* env,
           v8::Local<v8::Object> object,
-          std::string_view location);
+          std::string_view location,
+          bool batch_writes);
   void MemoryInfo(MemoryTracker* tracker) const override;
   static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
 
@@ -45,11 +47,32 @@ class Storage : public BaseObject {
   SET_SELF_SIZE(Storage)
 
  private:
+  enum class StatementId : size_t {
+    kClear,
+    kEnumerate,
+    kLength,
+    kLoad,
+    kLoadKey,
+    kRemove,
+    kStore,
+    kCount
+  };
+
   v8::Maybe<void> Open();
+  // Returns the cached statement for `id`, preparing it from `sql` on first
+  // use. Throws and returns nullptr on error.
+  sqlite3_stmt* Prepare(StatementId id, std::string_view sql);
+  // Starts the transaction that batches writes, if enabled.
+  v8::Maybe<void> BeginWrite();
+  int Commit();
 
   ~Storage() override;
   std::string location_;
   conn_unique_ptr db_;
+  std::array<stmt_unique_ptr, static_cast<size_t>(StatementId::kCount)>
+      statements_;
+  bool batch_writes_;
+  bool in_transaction_ = false;
   v8::Global<v8::Map> symbols_;
 };
 
@@ -3,9 +3,11 @@
 #include "debug_utils-inl.h"
 #include "histogram-inl.h"
 #include "memory_tracker-inl.h"
+#include "node_auto_tune.h"
 #include "node_buffer.h"
 #include "node_errors.h"
 #include "node_external_reference.h"
+#include "node_numa.h"
 #include "node_options-inl.h"
 #include "node_perf.h"
 #include "node_snapshot_builder.h"
@@ -13,10 +15,19 @@
 #include "util-inl.h"
 #include "v8-cppgc.h"
 
+#include <algorithm>
+#include <cerrno>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
+#ifndef _WIN32
+#include <fcntl.h>  // splice
+#include <poll.h>
+#include <unistd.h>
+#endif
+
 using node::kAllowedInEnvvar;
 using node::kDisallowedInEnvvar;
 using v8::Array;
@@ -27,6 +38,8 @@ using v8::Float64Array;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
 using v8::HandleScope;
+using v8::Int32;
+using v8::Int32Array;
 using v8::Integer;
 using v8::Isolate;
 using v8::Local;
@@ -40,6 +53,7 @@ using v8::ResourceConstraints;
 using v8::SealHandleScope;
 using v8::String;
 using v8::TryCatch;
+using v8::Uint32;
 using v8::Value;
 
 namespace node {
@@ -138,6 +152,327 @@ void Worker::UpdateResourceConstraints(ResourceConstraints* constraints) {
   }
 }
 
+bool Worker::CanUseWarmIsolate(const WarmIsolatePool* pool) const {
+  // The stack limit is reset on the worker thread anyway, but the other
+  // constraints are fixed once the isolate has been created.
+  return snapshot_data_ == pool->snapshot_data() &&
+         resource_limits_[kMaxYoungGenerationSizeMb] <= 0 &&
+         resource_limits_[kMaxOldGenerationSizeMb] <= 0 &&
+         resource_limits_[kCodeRangeSizeMb] <= 0 &&
+         // A warm isolate has already touched its heap on another thread.
+         numa_node_ < 0;
+}
+
+void Worker::ApplyPlacement() {
+  int err = 0;
+  if (numa_node_ >= 0) {
+    numa::MemoryPolicy policy = numa::MemoryPolicy::kNone;
+    switch (numa_policy_) {
+      case kNumaPolicyNone:
+        break;
+      case kNumaPolicyBind:
+        policy = numa::MemoryPolicy::kBind;
+        break;
+      case kNumaPolicyPreferred:
+        policy = numa::MemoryPolicy::kPreferred;
+        break;
+      case kNumaPolicyInterleave:
+        policy = numa::MemoryPolicy::kInterleave;
+        break;
+    }
+    if (cpu_affinity_.empty()) {
+      err = numa::BindCurrentThread(numa_node_, policy);
+    } else {
+      err = numa::SetCurrentThreadMemoryPolicy(numa_node_, policy);
+    }
+  }
+  if (err == 0 && !cpu_affinity_.empty())
+    err = numa::SetCurrentThreadAffinity(cpu_affinity_);
+  if (err != 0) {
+    Debug(this,
+          "Worker %llu could not apply its placement: %s",
+          thread_id_.id,
+          uv_strerror(err));
+  }
+}
+
+std::unique_ptr<WarmIsolate> WarmIsolate::Create(
+    MultiIsolatePlatform* platform, const SnapshotData* snapshot_data) {
+  auto warm = std::make_unique<WarmIsolate>();
+  warm->platform = platform;
+
+  auto loop = std::make_unique<uv_loop_t>();
+  if (uv_loop_init(loop.get()) != 0) return nullptr;
+  uv_loop_configure(loop.get(), UV_METRICS_IDLE_TIME);
+  warm->loop = std::move(loop);
+
+  warm->allocator = ArrayBufferAllocator::Create();
+  // This has to match what WorkerThreadData uses for Workers with the
+  // default resource limits.
+  Isolate::CreateParams params;
+  SetIsolateCreateParamsForNode(&params);
+  auto_tune::ConfigureWorkerHeap(&params.constraints);
+  params.array_buffer_allocator_shared = warm->allocator;
+  warm->isolate =
+      NewIsolate(&params, warm->loop.get(), platform, snapshot_data);
+  if (warm->isolate == nullptr) return nullptr;
+  SetIsolateUpForNode(warm->isolate);
+  warm->max_young_gen_size =
+      params.constraints.max_young_generation_size_in_bytes();
+  return warm;
+}
+
+WarmIsolate::~WarmIsolate() {
+  if (isolate != nullptr) {
+    bool platform_finished = false;
+    platform->AddIsolateFinishedCallback(isolate, [](void* data) {
+      *static_cast<bool*>(data) = true;
+    }, &platform_finished);
+    platform->DisposeIsolate(isolate);
+    while (!platform_finished) {
+      uv_run(loop.get(), UV_RUN_ONCE);
+    }
+  }
+  if (loop) {
+    CheckedUvLoopClose(loop.get());
+  }
+}
+
+WarmIsolatePool::WarmIsolatePool(MultiIsolatePlatform* platform,
+                                 const SnapshotData* snapshot_data)
+    : platform_(platform), snapshot_data_(snapshot_data) {}
+
+WarmIsolatePool::~WarmIsolatePool() {
+  std::optional<uv_thread_t> thread;
+  {
+    Mutex::ScopedLock lock(mutex_);
+    stopping_ = true;
+    thread = std::exchange(fill_thread_, std::nullopt);
+  }
+  if (thread.has_value()) CHECK_EQ(uv_thread_join(&thread.value()), 0);
+  // The remaining isolates are disposed of by ~WarmIsolate().
+}
+
+void WarmIsolatePool::SetSize(size_t size) {
+  std::deque<std::unique_ptr<WarmIsolate>> excess;
+  {
+    Mutex::ScopedLock lock(mutex_);
+    size_ = size;
+    while (ready_.size() > size_) {
+      excess.emplace_back(std::move(ready_.back()));
+      ready_.pop_back();
+    }
+    StartFillingLocked();
+  }
+  // Dispose of isolates that are no longer needed outside of the lock.
+}
+
+std::unique_ptr<WarmIsolate> WarmIsolatePool::Take() {
+  Mutex::ScopedLock lock(mutex_);
+  if (ready_.empty()) return nullptr;
+  std::unique_ptr<WarmIsolate> warm = std::move(ready_.front());
+  ready_.pop_front();
+  StartFillingLocked();
+  return warm;
+}
+
+void WarmIsolatePool::StartFillingLocked() {
+  if (filling_ || stopping_ || ready_.size() >= size_) return;
+  // A previous fill thread has finished (or is about to), reap it.
+  if (fill_thread_.has_value()) {
+    CHECK_EQ(uv_thread_join(&fill_thread_.value()), 0);
+    fill_thread_.reset();
+  }
+  filling_ = true;
+  uv_thread_t* tid = &fill_thread_.emplace();
+  int ret = uv_thread_create(tid, [](void* arg) {
+    uv_thread_setname("WarmIsolatePool");
+    static_cast<WarmIsolatePool*>(arg)->Fill();
+  }, this);
+  if (ret != 0) {
+    filling_ = false;
+    fill_thread_.reset();
+  }
+}
+
+void WarmIsolatePool::Fill() {
+  while (true) {
+    {
+      Mutex::ScopedLock lock(mutex_);
+      if (stopping_ || ready_.size() >= size_) {
+        filling_ = false;
+        return;
+      }
+    }
+    // Creating the isolate is the expensive part, do it without the lock.
+    std::unique_ptr<WarmIsolate> warm =
+        WarmIsolate::Create(platform_, snapshot_data_);
+    {
+      Mutex::ScopedLock lock(mutex_);
+      if (warm && !stopping_ && ready_.size() < size_) {
+        ready_.emplace_back(std::move(warm));
+        continue;
+      }
+      filling_ = false;
+    }
+    // Either creating the isolate failed or SetSize() has shrunk the pool in
+    // the meantime, in which case the isolate is disposed of here.
+    return;
+  }
+}
+
+// The read ends of the pipes and the state of the forwarding thread, which
+// owns and deletes this once both pipes have been closed and drained.
+struct StdioForwarder::Pipes {
+  ~Pipes();
+
+  void Run();
+  // Returns false once the Worker's end of the pipe has been closed.
+  bool Forward(int stream);
+
+  static constexpr size_t kChunkSize = 64 * 1024;
+
+  uv_file read_fds[2] = {-1, -1};
+  int out_fds[2] = {-1, -1};
+  bool use_splice[2] = {true, true};
+  // Set once the output has failed, e.g. because it has been closed. The
+  // pipe is still drained so that the Worker does not block on it.
+  bool discard[2] = {false, false};
+};
+
+std::unique_ptr<StdioForwarder> StdioForwarder::Create(int* err,
+                                                       int stdout_fd,
+                                                       int stderr_fd) {
+#ifdef _WIN32
+  *err = UV_ENOTSUP;
+  return nullptr;
+#else
+  std::unique_ptr<StdioForwarder> forwarder(new StdioForwarder());
+  auto pipes = std::make_unique<Pipes>();
+  pipes->out_fds[0] = stdout_fd;
+  pipes->out_fds[1] = stderr_fd;
+  for (int stream = 0; stream < 2; stream++) {
+    uv_file fds[2];
+    *err = uv_pipe(fds, 0, 0);
+    if (*err != 0) return nullptr;
+    pipes->read_fds[stream] = fds[0];
+    forwarder->write_fds_[stream] = fds[1];
+  }
+  uv_thread_t thread;
+  *err = uv_thread_create(
+      &thread,
+      [](void* arg) {
+        std::unique_ptr<Pipes> pipes(static_cast<Pipes*>(arg));
+        pipes->Run();
+      },
+      pipes.get());
+  if (*err != 0) return nullptr;
+  pipes.release();
+  CHECK_EQ(uv_thread_detach(&thread), 0);
+  return forwarder;
+#endif
+}
+
+StdioForwarder::~StdioForwarder() {
+  CloseWriteEnds();
+}
+
+void StdioForwarder::CloseWriteEnds() {
+#ifndef _WIN32
+  for (uv_file& fd : write_fds_) {
+    if (fd >= 0) close(fd);
+    fd = -1;
+  }
+#endif
+}
+
+StdioForwarder::Pipes::~Pipes() {
+#ifndef _WIN32
+  for (uv_file fd : read_fds) {
+    if (fd >= 0) close(fd);
+  }
+#endif
+}
+
+#ifndef _WIN32
+namespace {
+
+void WaitUntilWritable(int fd) {
+  pollfd pfd{fd, POLLOUT, 0};
+  while (poll(&pfd, 1, -1) < 0 && errno == EINTR) {
+  }
+}
+
+}  // anonymous namespace
+#endif
+
+void StdioForwarder::Pipes::Run() {
+#ifndef _WIN32
+  uv_thread_setname("WorkerStdio");
+  pollfd fds[2];
+  for (int stream = 0; stream < 2; stream++) {
+    fds[stream] = {read_fds[stream], POLLIN, 0};
+  }
+  int open = 2;
+  while (open > 0) {
+    if (poll(fds, 2, -1) < 0) {
+      if (errno == EINTR) continue;
+      break;
+    }
+    for (int stream = 0; stream < 2; stream++) {
+      if (fds[stream].fd < 0 || fds[stream].revents == 0) continue;
+      if (!Forward(stream)) {
+        // poll() ignores negative file descriptors.
+        fds[stream].fd = -1;
+        open--;
+      }
+    }
+  }
+#endif
+}
+
+bool StdioForwarder::Pipes::Forward(int stream) {
+#ifdef _WIN32
+  return false;
+#else
+  const int in = read_fds[stream];
+  const int out = out_fds[stream];
+#ifdef __linux__
+  if (use_splice[stream] && !discard[stream]) {
+    ssize_t n = splice(in, nullptr, out, nullptr, kChunkSize, 0);
+    if (n > 0) return true;
+    if (n == 0) return false;
+    if (errno == EINTR) return true;
+    if (errno == EAGAIN) {
+      WaitUntilWritable(out);
+      return true;
+    }
+    // E.g. outputs that were opened with O_APPEND can not be spliced to, copy
+    // through a buffer instead.
+    use_splice[stream] = false;
+  }
+#endif  // __linux__
+
+  char buffer[16 * 1024];
+  ssize_t n;
+  do {
+    n = read(in, buffer, sizeof(buffer));
+  } while (n < 0 && errno == EINTR);
+  if (n <= 0) return false;
+  for (ssize_t written = 0; written < n && !discard[stream];) {
+    ssize_t r = write(out, buffer + written, n - written);
+    if (r >= 0) {
+      written += r;
+    } else if (errno == EAGAIN) {
+      WaitUntilWritable(out);
+    } else if (errno != EINTR) {
+      discard[stream] = true;
+    }
+  }
+  return true;
+#endif  // _WIN32
+}
+
 // This class contains data that is only relevant to the child thread itself,
 // and only while it is running.
 // (Eventually, the Environment instance should probably also be moved here.)
@@ -145,34 +480,49 @@ class WorkerThreadData {
  public:
   explicit WorkerThreadData(Worker* w)
     : w_(w) {
-    int ret = uv_loop_init(&loop_);
-    if (ret != 0) {
-      char err_buf[128];
-      uv_err_name_r(ret, err_buf, sizeof(err_buf));
-      // TODO(joyeecheung): maybe this should be kBootstrapFailure instead?
-      w->Exit(ExitCode::kGenericUserError, "ERR_WORKER_INIT_FAILED", err_buf);
-      return;
-    }
-    loop_init_failed_ = false;
-    uv_loop_configure(&loop_, UV_METRICS_IDLE_TIME);
-
-    std::shared_ptr<ArrayBufferAllocator> allocator =
-        ArrayBufferAllocator::Create();
     Isolate::CreateParams params;
     SetIsolateCreateParamsForNode(&params);
+    auto_tune::ConfigureWorkerHeap(&params.constraints);
     w->UpdateResourceConstraints(&params.constraints);
-    params.array_buffer_allocator_shared = allocator;
-    Isolate* isolate =
-        NewIsolate(&params, &loop_, w->platform_, w->snapshot_data());
-    if (isolate == nullptr) {
-      // TODO(joyeecheung): maybe this should be kBootstrapFailure instead?
-      w->Exit(ExitCode::kGenericUserError,
-              "ERR_WORKER_INIT_FAILED",
-              "Failed to create new Isolate");
-      return;
-    }
 
-    SetIsolateUpForNode(isolate);
+    std::shared_ptr<ArrayBufferAllocator> allocator;
+    Isolate* isolate;
+    size_t max_young_gen_size;
+    if (std::unique_ptr<WarmIsolate> warm = std::move(w->warm_isolate_)) {
+      loop_ = std::move(warm->loop);
+      loop_init_failed_ = false;
+      allocator = std::move(warm->allocator);
+      isolate = std::exchange(warm->isolate, nullptr);
+      max_young_gen_size = warm->max_young_gen_size;
+    } else {
+      loop_ = std::make_unique<uv_loop_t>();
+      int ret = uv_loop_init(loop_.get());
+      if (ret != 0) {
+        char err_buf[128];
+        uv_err_name_r(ret, err_buf, sizeof(err_buf));
+        // TODO(joyeecheung): maybe this should be kBootstrapFailure instead?
+        w->Exit(ExitCode::kGenericUserError, "ERR_WORKER_INIT_FAILED", err_buf);
+        return;
+      }
+      loop_init_failed_ = false;
+      uv_loop_configure(loop_.get(), UV_METRICS_IDLE_TIME);
+
+      allocator = ArrayBufferAllocator::Create();
+      params.array_buffer_allocator_shared = allocator;
+      isolate =
+          NewIsolate(&params, loop_.get(), w->platform_, w->snapshot_data());
+      if (isolate == nullptr) {
+        // TODO(joyeecheung): maybe this should be kBootstrapFailure instead?
+        w->Exit(ExitCode::kGenericUserError,
+                "ERR_WORKER_INIT_FAILED",
+                "Failed to create new Isolate");
+        return;
+      }
+
+      SetIsolateUpForNode(isolate);
+      max_young_gen_size =
+          params.constraints.max_young_generation_size_in_bytes();
+    }
 
     // Be sure it's called before Environment::InitializeDiagnostics()
     // so that this callback stays when the callback of
@@ -189,7 +539,7 @@ class WorkerThreadData {
       HandleScope handle_scope(isolate);
       isolate_data_.reset(IsolateData::CreateIsolateData(
           isolate,
-          &loop_,
+          loop_.get(),
           w_->platform_,
           allocator.get(),
           w->snapshot_data()->AsEmbedderWrapper().get(),
@@ -197,8 +547,7 @@ class WorkerThreadData {
       CHECK(isolate_data_);
       CHECK(!isolate_data_->is_building_snapshot());
       isolate_data_->set_worker_context(w_);
-      isolate_data_->max_young_gen_size =
-          params.constraints.max_young_generation_size_in_bytes();
+      isolate_data_->max_young_gen_size = max_young_gen_size;
     }
 
     Mutex::ScopedLock lock(w_->mutex_);
@@ -234,11 +583,11 @@ class WorkerThreadData {
 
       // Wait until the platform has cleaned up all relevant resources.
       while (!platform_finished) {
-        uv_run(&loop_, UV_RUN_ONCE);
+        uv_run(loop_.get(), UV_RUN_ONCE);
       }
     }
     if (!loop_init_failed_) {
-      CheckedUvLoopClose(&loop_);
+      CheckedUvLoopClose(loop_.get());
     }
   }
 
@@ -246,7 +595,7 @@ class WorkerThreadData {
 
  private:
   Worker* const w_;
-  uv_loop_t loop_;
+  std::unique_ptr<uv_loop_t> loop_;
   bool loop_init_failed_ = true;
   DeleteFnPtr<IsolateData, FreeIsolateData> isolate_data_;
   const SnapshotData* snapshot_data_ = nullptr;
@@ -442,6 +791,7 @@ void Worker::JoinThread() {
     return;
   CHECK_EQ(uv_thread_join(&tid_.value()), 0);
   tid_.reset();
+  if (stdio_forwarder_) stdio_forwarder_->CloseWriteEnds();
 
   env()->remove_sub_worker_context(this);
 
@@ -707,6 +1057,91 @@ void Worker::New(const FunctionCallbackInfo<Value>& args) {
     worker->environment_flags_ |= EnvironmentFlags::kNoBrowserGlobals;
 }
 
+void Worker::SetPlacement(const FunctionCallbackInfo<Value>& args) {
+  Worker* w;
+  ASSIGN_OR_RETURN_UNWRAP(&w, args.This());
+  Environment* env = w->env();
+  Mutex::ScopedLock lock(w->mutex_);
+  CHECK(!w->tid_.has_value());
+
+  std::vector<int> cpus;
+  if (!args[0]->IsUndefined()) {
+    CHECK(args[0]->IsInt32Array());
+    Local<Int32Array> array = args[0].As<Int32Array>();
+    cpus.resize(array->Length());
+    array->CopyContents(cpus.data(), cpus.size() * sizeof(cpus[0]));
+    int mask_size = uv_cpumask_size();
+    if (mask_size < 0) {
+      return THROW_ERR_INVALID_ARG_VALUE(
+          env, "CPU affinity is not supported on this platform");
+    }
+    for (int cpu : cpus) {
+      if (cpu < 0 || cpu >= mask_size) {
+        return THROW_ERR_INVALID_ARG_VALUE(
+            env, "CPU %d is out of range (0-%d)", cpu, mask_size - 1);
+      }
+    }
+  }
+
+  CHECK(args[1]->IsInt32());
+  CHECK(args[2]->IsUint32());
+  int node = args[1].As<Int32>()->Value();
+  uint32_t policy = args[2].As<Uint32>()->Value();
+  CHECK_LE(policy, kNumaPolicyInterleave);
+  if (node >= 0) {
+    std::vector<numa::Node> topology = numa::GetTopology();
+    if (std::none_of(topology.begin(),
+                     topology.end(),
+                     [&](const numa::Node& n) { return n.id == node; })) {
+      return THROW_ERR_INVALID_ARG_VALUE(env, "Unknown NUMA node %d", node);
+    }
+  }
+
+  w->cpu_affinity_ = std::move(cpus);
+  w->numa_node_ = node;
+  w->numa_policy_ = static_cast<NumaPolicy>(policy);
+}
+
+void Worker::SetStdio(const FunctionCallbackInfo<Value>& args) {
+  Worker* w;
+  ASSIGN_OR_RETURN_UNWRAP(&w, args.This());
+  Environment* env = w->env();
+  Mutex::ScopedLock lock(w->mutex_);
+  CHECK(!w->tid_.has_value());
+
+  CHECK(args[0]->IsUint32());
+  uint32_t mode = args[0].As<Uint32>()->Value();
+  CHECK_LE(mode, kWorkerStdioPipe);
+
+  std::unique_ptr<StdioForwarder> forwarder;
+  if (mode == kWorkerStdioPipe) {
+    int err;
+    forwarder = StdioForwarder::Create(&err);
+    if (!forwarder) {
+      if (err == UV_ENOTSUP) {
+        return THROW_ERR_INVALID_ARG_VALUE(
+            env, "Stdio pipes are not supported on this platform");
+      }
+      return env->ThrowUVException(err, "pipe");
+    }
+  }
+
+  w->stdio_forwarder_ = std::move(forwarder);
+  switch (mode) {
+    case kWorkerStdioMessagePort:
+      w->stdio_fds_[0] = w->stdio_fds_[1] = -1;
+      break;
+    case kWorkerStdioInherit:
+      w->stdio_fds_[0] = 1;
+      w->stdio_fds_[1] = 2;
+      break;
+    case kWorkerStdioPipe:
+      w->stdio_fds_[0] = w->stdio_forwarder_->write_fd(0);
+      w->stdio_fds_[1] = w->stdio_forwarder_->write_fd(1);
+      break;
+  }
+}
+
 void Worker::StartThread(const FunctionCallbackInfo<Value>& args) {
   Worker* w;
   ASSIGN_OR_RETURN_UNWRAP(&w, args.This());
@@ -726,6 +1161,10 @@ void Worker::StartThread(const FunctionCallbackInfo<Value>& args) {
     w->resource_limits_[kStackSizeMb] = w->stack_size_ / kMB;
   }
 
+  WarmIsolatePool* pool = w->env()->warm_isolate_pool();
+  if (pool != nullptr && w->CanUseWarmIsolate(pool))
+    w->warm_isolate_ = pool->Take();
+
   uv_thread_options_t thread_options;
   thread_options.flags = UV_THREAD_HAS_STACK_SIZE;
   thread_options.stack_size = w->stack_size_;
@@ -739,6 +1178,9 @@ void Worker::StartThread(const FunctionCallbackInfo<Value>& args) {
     const uintptr_t stack_top = reinterpret_cast<uintptr_t>(&arg);
 
     uv_thread_setname(w->name_.c_str());
+    // Bind the thread before anything is allocated for its isolate, so that
+    // the heap ends up on the requested node.
+    w->ApplyPlacement();
     // Leave a few kilobytes just to make sure we're within limits and have
     // some space to do work in C++ land.
     w->stack_base_ = stack_top - (w->stack_size_ - kStackBufferSize);
@@ -1080,6 +1522,24 @@ void GetEnvMessagePort(const FunctionCallbackInfo<Value>& args) {
   }
 }
 
+// Keeps the given number of isolates ready for Workers started from this
+// Environment. 0 disposes of the pool.
+void SetWarmIsolatePoolSize(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsUint32());
+  uint32_t size = args[0].As<Uint32>()->Value();
+
+  if (size == 0) {
+    env->set_warm_isolate_pool(nullptr);
+    return;
+  }
+  if (env->warm_isolate_pool() == nullptr) {
+    env->set_warm_isolate_pool(std::make_unique<WarmIsolatePool>(
+        env->isolate_data()->platform(), env->isolate_data()->snapshot_data()));
+  }
+  env->warm_isolate_pool()->SetSize(size);
+}
+
 void CreateWorkerPerIsolateProperties(IsolateData* isolate_data,
                                       Local<ObjectTemplate> target) {
   Isolate* isolate = isolate_data->isolate();
@@ -1091,6 +1551,8 @@ void CreateWorkerPerIsolateProperties(IsolateData* isolate_data,
         Worker::kInternalFieldCount);
     w->Inherit(AsyncWrap::GetConstructorTemplate(isolate_data));
 
+    SetProtoMethod(isolate, w, "setPlacement", Worker::SetPlacement);
+    SetProtoMethod(isolate, w, "setStdio", Worker::SetStdio);
     SetProtoMethod(isolate, w, "startThread", Worker::StartThread);
     SetProtoMethod(isolate, w, "stopThread", Worker::StopThread);
     SetProtoMethod(isolate, w, "hasRef", Worker::HasRef);
@@ -1134,6 +1596,7 @@ void CreateWorkerPerIsolateProperties(IsolateData* isolate_data,
   }
 
   SetMethod(isolate, target, "getEnvMessagePort", GetEnvMessagePort);
+  SetMethod(isolate, target, "setWarmIsolatePoolSize", SetWarmIsolatePoolSize);
 }
 
 void CreateWorkerPerContextProperties(Local<Object> target,
@@ -1177,6 +1640,18 @@ void CreateWorkerPerContextProperties(Local<Object> target,
               FIXED_ONE_BYTE_STRING(isolate, "resourceLimits"),
               env->worker_context()->GetResourceLimits(isolate))
         .Check();
+
+    // The file descriptors to write stdout and stderr to instead of posting
+    // them to the parent.
+    if (worker->stdio_fd(0) >= 0) {
+      Local<Value> fds[] = {Integer::New(isolate, worker->stdio_fd(0)),
+                            Integer::New(isolate, worker->stdio_fd(1))};
+      target
+          ->Set(env->context(),
+                FIXED_ONE_BYTE_STRING(isolate, "stdioFds"),
+                Array::New(isolate, fds, arraysize(fds)))
+          .Check();
+    }
   }
 
   NODE_DEFINE_CONSTANT(target, kMaxYoungGenerationSizeMb);
@@ -1184,11 +1659,21 @@ void CreateWorkerPerContextProperties(Local<Object> target,
   NODE_DEFINE_CONSTANT(target, kCodeRangeSizeMb);
   NODE_DEFINE_CONSTANT(target, kStackSizeMb);
   NODE_DEFINE_CONSTANT(target, kTotalResourceLimitCount);
+  NODE_DEFINE_CONSTANT(target, kNumaPolicyNone);
+  NODE_DEFINE_CONSTANT(target, kNumaPolicyBind);
+  NODE_DEFINE_CONSTANT(target, kNumaPolicyPreferred);
+  NODE_DEFINE_CONSTANT(target, kNumaPolicyInterleave);
+  NODE_DEFINE_CONSTANT(target, kWorkerStdioMessagePort);
+  NODE_DEFINE_CONSTANT(target, kWorkerStdioInherit);
+  NODE_DEFINE_CONSTANT(target, kWorkerStdioPipe);
 }
 
 void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(GetEnvMessagePort);
+  registry->Register(SetWarmIsolatePoolSize);
   registry->Register(Worker::New);
+  registry->Register(Worker::SetPlacement);
+  registry->Register(Worker::SetStdio);
   registry->Register(Worker::StartThread);
   registry->Register(Worker::StopThread);
   registry->Register(Worker::HasRef);
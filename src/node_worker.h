@@ -3,8 +3,11 @@
 
 #if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
 
+#include <deque>
+#include <memory>
 #include <optional>
 #include <unordered_map>
+#include <vector>
 #include "node_exit_code.h"
 #include "node_messaging.h"
 #include "uv.h"
@@ -16,6 +19,97 @@ namespace worker {
 
 class WorkerThreadData;
 
+// An Isolate that has been created ahead of time by a WarmIsolatePool,
+// together with the event loop it is registered on with the platform.
+// If no Worker takes it over, it is disposed of when this is destroyed.
+struct WarmIsolate {
+  WarmIsolate() = default;
+  ~WarmIsolate();
+
+  WarmIsolate(const WarmIsolate&) = delete;
+  WarmIsolate& operator=(const WarmIsolate&) = delete;
+
+  static std::unique_ptr<WarmIsolate> Create(
+      MultiIsolatePlatform* platform, const SnapshotData* snapshot_data);
+
+  MultiIsolatePlatform* platform = nullptr;
+  std::unique_ptr<uv_loop_t> loop;
+  std::shared_ptr<ArrayBufferAllocator> allocator;
+  v8::Isolate* isolate = nullptr;
+  size_t max_young_gen_size = 0;
+};
+
+// Keeps a number of Isolates for Workers ready, creating them on a
+// background thread so that starting a Worker does not have to wait for the
+// heap to be set up and the isolate snapshot to be deserialized. Only Workers
+// that use the same snapshot and the default heap limits can take one.
+// Take() and SetSize() may be called from any thread.
+class WarmIsolatePool {
+ public:
+  WarmIsolatePool(MultiIsolatePlatform* platform,
+                  const SnapshotData* snapshot_data);
+  ~WarmIsolatePool();
+
+  WarmIsolatePool(const WarmIsolatePool&) = delete;
+  WarmIsolatePool& operator=(const WarmIsolatePool&) = delete;
+
+  // Keeps up to `size` isolates ready. The pool is refilled in the
+  // background after every Take().
+  void SetSize(size_t size);
+  // Returns nullptr if no isolate is ready yet.
+  std::unique_ptr<WarmIsolate> Take();
+
+  const SnapshotData* snapshot_data() const { return snapshot_data_; }
+
+ private:
+  // Must be called with mutex_ held.
+  void StartFillingLocked();
+  void Fill();
+
+  MultiIsolatePlatform* const platform_;
+  const SnapshotData* const snapshot_data_;
+
+  // This mutex protects access to all variables listed below it.
+  Mutex mutex_;
+  size_t size_ = 0;
+  std::deque<std::unique_ptr<WarmIsolate>> ready_;
+  bool filling_ = false;
+  bool stopping_ = false;
+  std::optional<uv_thread_t> fill_thread_;
+};
+
+// Copies what a Worker writes to its stdio pipes to the stdout and stderr of
+// the process on a thread of its own, so that neither MessagePorts nor the
+// parent's event loop are involved. On Linux, the data is spliced from the
+// pipes without being copied through user space.
+// The thread owns the read ends of the pipes and is not joined: it exits on
+// its own once the pipes are closed and drained, so destroying this does not
+// block when the output of the process is not being read.
+class StdioForwarder {
+ public:
+  // Returns nullptr and sets `*err` to a libuv error code on failure.
+  static std::unique_ptr<StdioForwarder> Create(int* err,
+                                                int stdout_fd = 1,
+                                                int stderr_fd = 2);
+  ~StdioForwarder();
+
+  StdioForwarder(const StdioForwarder&) = delete;
+  StdioForwarder& operator=(const StdioForwarder&) = delete;
+
+  int write_fd(int stream) const { return write_fds_[stream]; }
+
+  // Closes the Worker's ends of the pipes. The thread exits once it has
+  // copied what is left in them.
+  void CloseWriteEnds();
+
+ private:
+  struct Pipes;
+
+  StdioForwarder() = default;
+
+  uv_file write_fds_[2] = {-1, -1};
+};
+
 enum ResourceLimits {
   kMaxYoungGenerationSizeMb,
   kMaxOldGenerationSizeMb,
@@ -24,6 +118,27 @@ enum ResourceLimits {
   kTotalResourceLimitCount
 };
 
+// Memory policies accepted by Worker.prototype.setPlacement().
+enum NumaPolicy {
+  kNumaPolicyNone,
+  kNumaPolicyBind,
+  kNumaPolicyPreferred,
+  kNumaPolicyInterleave,
+};
+
+// How the stdout and stderr of a Worker reach the process, as accepted by
+// Worker.prototype.setStdio().
+enum WorkerStdio {
+  // Writes are posted to the parent as messages, which write them to its
+  // own process.stdout and process.stderr.
+  kWorkerStdioMessagePort,
+  // The Worker writes to the file descriptors of the process directly.
+  kWorkerStdioInherit,
+  // The Worker writes to pipes of its own, which a thread of the parent
+  // copies to the file descriptors of the process.
+  kWorkerStdioPipe,
+};
+
 // A worker thread, as represented in its parent thread.
 class Worker : public AsyncWrap {
  public:
@@ -62,11 +177,18 @@ class Worker : public AsyncWrap {
   bool is_stopped() const;
   const SnapshotData* snapshot_data() const { return snapshot_data_; }
   bool is_internal() const { return is_internal_; }
+  // The file descriptor that the worker writes stdout (0) or stderr (1) to,
+  // or -1 if they are posted to the parent as messages.
+  int stdio_fd(int stream) const { return stdio_fds_[stream]; }
+  // Whether this Worker can run on an isolate from `pool`.
+  bool CanUseWarmIsolate(const WarmIsolatePool* pool) const;
 
   static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void CloneParentEnvVars(
       const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetEnvVars(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetPlacement(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetStdio(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void StartThread(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void StopThread(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void HasRef(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -116,7 +238,20 @@ class Worker : public AsyncWrap {
   // Stack buffer size that is not available to the JS engine.
   static constexpr size_t kStackBufferSize = 192 * 1024;
 
+  // CPUs and NUMA node the thread is bound to when it starts. Empty and -1
+  // leave the placement to the operating system.
+  std::vector<int> cpu_affinity_;
+  int numa_node_ = -1;
+  NumaPolicy numa_policy_ = kNumaPolicyNone;
+  void ApplyPlacement();
+
+  int stdio_fds_[2] = {-1, -1};
+  std::unique_ptr<StdioForwarder> stdio_forwarder_;
+
   std::unique_ptr<MessagePortData> child_port_data_;
+  // Taken from the parent's WarmIsolatePool when the thread is started, and
+  // handed over to the WorkerThreadData on the worker thread.
+  std::unique_ptr<WarmIsolate> warm_isolate_;
   std::shared_ptr<KVStore> env_vars_;
   EmbedderPreloadCallback embedder_preload_;
 
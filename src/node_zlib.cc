@@ -42,21 +42,31 @@
 
 #include <cerrno>
 #include <cstdlib>
+#include <algorithm>
 #include <cstring>
 #include <atomic>
+#include <limits>
+#include <list>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace node {
 
+using v8::Array;
 using v8::ArrayBuffer;
 using v8::Context;
 using v8::Function;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
+using v8::Global;
 using v8::HandleScope;
 using v8::Int32;
 using v8::Integer;
 using v8::Isolate;
 using v8::Local;
+using v8::MaybeLocal;
 using v8::Object;
 using v8::Uint32Array;
 using v8::Value;
@@ -153,6 +163,12 @@ enum node_zlib_mode {
 constexpr uint8_t GZIP_HEADER_ID1 = 0x1f;
 constexpr uint8_t GZIP_HEADER_ID2 = 0x8b;
 
+// Input is split into blocks of this size when a one-shot deflate is run on
+// several threads; inputs smaller than kParallelDeflateMinInput are never
+// split since handing out the blocks costs more than it gains.
+constexpr size_t kParallelDeflateBlockSize = 128 * 1024;
+constexpr size_t kParallelDeflateMinInput = 4 * kParallelDeflateBlockSize;
+
 struct CompressionError {
   CompressionError(const char* message, const char* code, int err)
       : message(message),
@@ -189,12 +205,17 @@ class ZlibContext final : public MemoryRetainer {
             std::vector<unsigned char>&& dictionary);
   void SetAllocationFunctions(alloc_func alloc, free_func free, void* opaque);
   CompressionError SetParams(int level, int strategy);
+  // Allows a one-shot deflate/gzip of a large buffer to be split into blocks
+  // that are compressed on up to `threads` threads (pigz-style), helper
+  // threads joining the thread running the deflate.
+  inline void SetParallelism(uint32_t threads) { parallelism_ = threads; }
 
   SET_MEMORY_INFO_NAME(ZlibContext)
   SET_SELF_SIZE(ZlibContext)
 
   void MemoryInfo(MemoryTracker* tracker) const override {
     tracker->TrackField("dictionary", dictionary_);
+    tracker->TrackField("parallel_output", parallel_output_);
   }
 
   ZlibContext(const ZlibContext&) = delete;
@@ -204,6 +225,9 @@ class ZlibContext final : public MemoryRetainer {
   CompressionError ErrorForMessage(const char* message) const;
   CompressionError SetDictionary();
   bool InitZlib();
+  bool ShouldDeflateInParallel() const;
+  bool DeflateInParallel();
+  void DrainParallelOutput();
 
   Mutex mutex_;  // Protects zlib_init_done_.
   bool zlib_init_done_ = false;
@@ -217,6 +241,13 @@ class ZlibContext final : public MemoryRetainer {
   unsigned int gzip_id_bytes_read_ = 0;
   std::vector<unsigned char> dictionary_;
 
+  uint32_t parallelism_ = 1;
+  // Set once the whole input has been compressed in parallel; the result is
+  // then handed out from parallel_output_ across subsequent writes.
+  bool parallel_output_active_ = false;
+  std::vector<unsigned char> parallel_output_;
+  size_t parallel_output_offset_ = 0;
+
   z_stream strm_;
 };
 
@@ -258,6 +289,9 @@ class BrotliEncoderContext final : public BrotliContext {
                         void* opaque);
   CompressionError ResetStream();
   CompressionError SetParams(int key, uint32_t value);
+  CompressionError SetDictionary(const uint8_t* data,
+                                 size_t length,
+                                 int quality);
   CompressionError GetErrorInfo() const;
 
   SET_MEMORY_INFO_NAME(BrotliEncoderContext)
@@ -265,7 +299,11 @@ class BrotliEncoderContext final : public BrotliContext {
   SET_NO_MEMORY_INFO()  // state_ is covered through allocation tracking.
 
  private:
+  CompressionError AttachDictionary();
+
   bool last_result_ = false;
+  // Declared before state_ so that it outlives the encoder it is attached to.
+  std::shared_ptr<BrotliEncoderPreparedDictionary> dictionary_;
   DeleteFnPtr<BrotliEncoderState, BrotliEncoderDestroyInstance> state_;
 };
 
@@ -278,6 +316,9 @@ class BrotliDecoderContext final : public BrotliContext {
                         void* opaque);
   CompressionError ResetStream();
   CompressionError SetParams(int key, uint32_t value);
+  CompressionError SetDictionary(const uint8_t* data,
+                                 size_t length,
+                                 int quality);
   CompressionError GetErrorInfo() const;
 
   SET_MEMORY_INFO_NAME(BrotliDecoderContext)
@@ -288,9 +329,164 @@ class BrotliDecoderContext final : public BrotliContext {
   BrotliDecoderResult last_result_ = BROTLI_DECODER_RESULT_SUCCESS;
   BrotliDecoderErrorCode error_ = BROTLI_DECODER_NO_ERROR;
   std::string error_string_;
+  CompressionError AttachDictionary();
+
+  // Brotli does not copy raw dictionaries, so keep the bytes alive for as
+  // long as state_ refers to them.
+  std::shared_ptr<std::vector<uint8_t>> dictionary_;
   DeleteFnPtr<BrotliDecoderState, BrotliDecoderDestroyInstance> state_;
 };
 
+// Process-wide cache of digested dictionaries, keyed by their contents and
+// the level they were prepared for. Entries are shared by every stream in
+// every Environment, so worker threads serving the same dictionary digest
+// it only once. Traits provides Type, Create(data, length, level) and
+// Free(Type*).
+template <typename Traits>
+class SharedDictionaryCache {
+ public:
+  using Type = typename Traits::Type;
+
+  static std::shared_ptr<Type> Get(const uint8_t* data,
+                                   size_t length,
+                                   int level) {
+    std::string key(reinterpret_cast<const char*>(&level), sizeof(level));
+    key.append(reinterpret_cast<const char*>(data), length);
+
+    {
+      Mutex::ScopedLock lock(mutex_);
+      for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+        if (it->first != key) continue;
+        entries_.splice(entries_.begin(), entries_, it);
+        return it->second;
+      }
+    }
+
+    // Digest outside of the lock; if another thread raced us, the loser's
+    // copy is simply dropped once its last user is gone.
+    Type* raw = Traits::Create(data, length, level);
+    if (raw == nullptr) return {};
+    std::shared_ptr<Type> dictionary(raw, Traits::Free);
+
+    Mutex::ScopedLock lock(mutex_);
+    entries_.emplace_front(std::move(key), dictionary);
+    if (entries_.size() > kMaxEntries) entries_.pop_back();
+    return dictionary;
+  }
+
+ private:
+  static constexpr size_t kMaxEntries = 16;
+
+  static inline Mutex mutex_;
+  // Most recently used first.
+  static inline std::list<std::pair<std::string, std::shared_ptr<Type>>>
+      entries_;
+};
+
+struct ZstdCDictTraits {
+  using Type = ZSTD_CDict;
+  static Type* Create(const uint8_t* data, size_t length, int level) {
+    return ZSTD_createCDict(data, length, level);
+  }
+  static void Free(Type* cdict) { ZSTD_freeCDict(cdict); }
+};
+
+struct ZstdDDictTraits {
+  using Type = ZSTD_DDict;
+  static Type* Create(const uint8_t* data, size_t length, int level) {
+    return ZSTD_createDDict(data, length);
+  }
+  static void Free(Type* ddict) { ZSTD_freeDDict(ddict); }
+};
+
+struct BrotliPreparedDictionaryTraits {
+  using Type = BrotliEncoderPreparedDictionary;
+  static Type* Create(const uint8_t* data, size_t length, int quality) {
+    return BrotliEncoderPrepareDictionary(BROTLI_SHARED_DICTIONARY_RAW,
+                                          length,
+                                          data,
+                                          quality,
+                                          nullptr,
+                                          nullptr,
+                                          nullptr);
+  }
+  static void Free(Type* dictionary) {
+    BrotliEncoderDestroyPreparedDictionary(dictionary);
+  }
+};
+
+struct BrotliRawDictionaryTraits {
+  using Type = std::vector<uint8_t>;
+  static Type* Create(const uint8_t* data, size_t length, int quality) {
+    return new Type(data, data + length);
+  }
+  static void Free(Type* dictionary) { delete dictionary; }
+};
+
+// Process-wide free list of zstd contexts. Creating a context and letting it
+// grow its internal buffers is a noticeable part of compressing a small
+// payload, so streams hand their contexts back here when they are done.
+// Contexts are fully reset before they are reused.
+class ZstdContextPool {
+ public:
+  static ZSTD_CCtx* AcquireCCtx() {
+    {
+      Mutex::ScopedLock lock(mutex_);
+      if (!idle_cctxs_.empty()) {
+        ZSTD_CCtx* cctx = idle_cctxs_.back();
+        idle_cctxs_.pop_back();
+        return cctx;
+      }
+    }
+    return ZSTD_createCCtx();
+  }
+
+  static void Release(ZSTD_CCtx* cctx) {
+    if (cctx == nullptr) return;
+    ZSTD_CCtx_reset(cctx, ZSTD_reset_session_and_parameters);
+    {
+      Mutex::ScopedLock lock(mutex_);
+      if (idle_cctxs_.size() < kMaxIdleContexts) {
+        idle_cctxs_.push_back(cctx);
+        return;
+      }
+    }
+    ZSTD_freeCCtx(cctx);
+  }
+
+  static ZSTD_DCtx* AcquireDCtx() {
+    {
+      Mutex::ScopedLock lock(mutex_);
+      if (!idle_dctxs_.empty()) {
+        ZSTD_DCtx* dctx = idle_dctxs_.back();
+        idle_dctxs_.pop_back();
+        return dctx;
+      }
+    }
+    return ZSTD_createDCtx();
+  }
+
+  static void Release(ZSTD_DCtx* dctx) {
+    if (dctx == nullptr) return;
+    ZSTD_DCtx_reset(dctx, ZSTD_reset_session_and_parameters);
+    {
+      Mutex::ScopedLock lock(mutex_);
+      if (idle_dctxs_.size() < kMaxIdleContexts) {
+        idle_dctxs_.push_back(dctx);
+        return;
+      }
+    }
+    ZSTD_freeDCtx(dctx);
+  }
+
+ private:
+  static constexpr size_t kMaxIdleContexts = 16;
+
+  static inline Mutex mutex_;
+  static inline std::vector<ZSTD_CCtx*> idle_cctxs_;
+  static inline std::vector<ZSTD_DCtx*> idle_dctxs_;
+};
+
 class ZstdContext : public MemoryRetainer {
  public:
   ZstdContext() = default;
@@ -327,15 +523,19 @@ class ZstdCompressContext final : public ZstdContext {
   // Zstd specific:
   CompressionError Init(uint64_t pledged_src_size);
   CompressionError SetParameter(int key, int value);
+  CompressionError SetDictionary(const uint8_t* data,
+                                 size_t length,
+                                 int level);
 
-  // Wrap ZSTD_freeCCtx to remove the return type.
-  static void FreeZstd(ZSTD_CCtx* cctx) { ZSTD_freeCCtx(cctx); }
+  // Hand the context back to the shared pool instead of freeing it.
+  static void FreeZstd(ZSTD_CCtx* cctx) { ZstdContextPool::Release(cctx); }
 
   SET_MEMORY_INFO_NAME(ZstdCompressContext)
   SET_SELF_SIZE(ZstdCompressContext)
   SET_NO_MEMORY_INFO()
 
  private:
+  std::shared_ptr<ZSTD_CDict> cdict_;
   DeleteFnPtr<ZSTD_CCtx, ZstdCompressContext::FreeZstd> cctx_;
 
   uint64_t pledged_src_size_ = ZSTD_CONTENTSIZE_UNKNOWN;
@@ -352,15 +552,19 @@ class ZstdDecompressContext final : public ZstdContext {
   // Zstd specific:
   CompressionError Init(uint64_t pledged_src_size);
   CompressionError SetParameter(int key, int value);
+  CompressionError SetDictionary(const uint8_t* data,
+                                 size_t length,
+                                 int level);
 
-  // Wrap ZSTD_freeDCtx to remove the return type.
-  static void FreeZstd(ZSTD_DCtx* dctx) { ZSTD_freeDCtx(dctx); }
+  // Hand the context back to the shared pool instead of freeing it.
+  static void FreeZstd(ZSTD_DCtx* dctx) { ZstdContextPool::Release(dctx); }
 
   SET_MEMORY_INFO_NAME(ZstdDecompressContext)
   SET_SELF_SIZE(ZstdDecompressContext)
   SET_NO_MEMORY_INFO()
 
  private:
+  std::shared_ptr<ZSTD_DDict> ddict_;
   DeleteFnPtr<ZSTD_DCtx, ZstdDecompressContext::FreeZstd> dctx_;
 };
 
@@ -370,6 +574,7 @@ class CompressionStream : public AsyncWrap, public ThreadPoolWork {
   enum InternalFields {
     kCompressionStreamBaseField = AsyncWrap::kInternalFieldCount,
     kWriteJSCallback,
+    kWriteBatchJSCallback,
     kInternalFieldCount
   };
 
@@ -382,6 +587,7 @@ class CompressionStream : public AsyncWrap, public ThreadPoolWork {
 
   ~CompressionStream() override {
     CHECK(!write_in_progress_);
+    free(batch_output_);
     Close();
     CHECK_EQ(zlib_memory_, 0);
     CHECK_EQ(unreported_allocations_, 0);
@@ -495,6 +701,87 @@ class CompressionStream : public AsyncWrap, public ThreadPoolWork {
     ScheduleWork();
   }
 
+  // writeBatch(flush, chunks, callback) processes all of the Buffers in the
+  // `chunks` array and then flushes with `flush`, as a single piece of
+  // threadpool work instead of one write() per chunk. The output is collected
+  // in a buffer that grows as needed and is passed to `callback` as a single
+  // Buffer, or returned by writeBatchSync(flush, chunks). This is meant for
+  // compression; input after the end of a decompressed stream is dropped.
+  template <bool async>
+  static void WriteBatch(const FunctionCallbackInfo<Value>& args) {
+    Environment* env = Environment::GetCurrent(args);
+    Local<Context> context = env->context();
+    CompressionStream* ctx;
+    ASSIGN_OR_RETURN_UNWRAP(&ctx, args.This());
+
+    uint32_t flush;
+    if (!args[0]->Uint32Value(context).To(&flush)) return;
+    CHECK(args[1]->IsArray());
+    Local<Array> chunks = args[1].As<Array>();
+
+    std::vector<std::pair<const char*, uint32_t>> inputs;
+    inputs.reserve(chunks->Length());
+    for (uint32_t i = 0; i < chunks->Length(); i++) {
+      Local<Value> chunk;
+      if (!chunks->Get(context, i).ToLocal(&chunk)) return;
+      CHECK(Buffer::HasInstance(chunk));
+      size_t length = Buffer::Length(chunk);
+      CHECK_LE(length, std::numeric_limits<uint32_t>::max());
+      if (length == 0) continue;
+      inputs.emplace_back(Buffer::Data(chunk), static_cast<uint32_t>(length));
+    }
+
+    if constexpr (async) {
+      CHECK(args[2]->IsFunction());
+      ctx->object()->SetInternalField(kWriteBatchJSCallback,
+                                      args[2].As<Function>());
+      // Keeps the chunks alive until the work is done.
+      ctx->batch_chunks_.Reset(env->isolate(), chunks);
+    }
+
+    if (ctx->WriteBatch<async>(flush, std::move(inputs))) {
+      Local<Object> output;
+      if (ctx->TakeBatchOutput().ToLocal(&output))
+        args.GetReturnValue().Set(output);
+    }
+  }
+
+  // Returns whether the synchronous version is done without errors.
+  template <bool async>
+  bool WriteBatch(uint32_t flush,
+                  std::vector<std::pair<const char*, uint32_t>>&& inputs) {
+    AllocScope alloc_scope(this);
+
+    CHECK(init_done_ && "write before init");
+    CHECK(!closed_ && "already finalized");
+
+    CHECK_EQ(false, write_in_progress_);
+    CHECK_EQ(false, pending_close_);
+    write_in_progress_ = true;
+    batch_in_progress_ = true;
+    batch_inputs_ = std::move(inputs);
+    batch_flush_ = flush;
+    Ref();
+
+    if constexpr (!async) {
+      // sync version
+      AsyncWrap::env()->PrintSyncTrace();
+      DoThreadPoolWork();
+      batch_in_progress_ = false;
+      bool ok = CheckError();
+      if (ok)
+        write_in_progress_ = false;
+      else
+        ClearBatch();
+      Unref();
+      return ok;
+    }
+
+    // async version
+    ScheduleWork();
+    return false;
+  }
+
   void UpdateWriteResult() {
     ctx_.GetAfterWriteOffsets(&write_result_[1], &write_result_[0]);
   }
@@ -504,9 +791,74 @@ class CompressionStream : public AsyncWrap, public ThreadPoolWork {
   // for a single write() call, until all of the input bytes have
   // been consumed.
   void DoThreadPoolWork() override {
+    if (batch_in_progress_) {
+      DoBatchWork();
+      return;
+    }
     ctx_.DoThreadPoolWork();
   }
 
+  void DoBatchWork() {
+    // "No flush" is 0 for all of the supported libraries (Z_NO_FLUSH,
+    // BROTLI_OPERATION_PROCESS and ZSTD_e_continue).
+    constexpr uint32_t kNoFlush = 0;
+    for (const auto& [in, in_len] : batch_inputs_) {
+      if (!RunBatchStep(kNoFlush, in, in_len)) return;
+    }
+    RunBatchStep(batch_flush_, nullptr, 0);
+  }
+
+  // Runs the context until it has consumed `in` and has room left in the
+  // output, growing the output buffer whenever it fills up.
+  bool RunBatchStep(uint32_t flush, const char* in, uint32_t in_len) {
+    constexpr size_t kMinBatchOutputSpace = 16 * 1024;
+    while (true) {
+      if (batch_output_capacity_ - batch_output_size_ < kMinBatchOutputSpace) {
+        batch_output_capacity_ =
+            std::max(batch_output_capacity_ * 2,
+                     batch_output_size_ + kMinBatchOutputSpace);
+        batch_output_ = Realloc(batch_output_, batch_output_capacity_);
+      }
+      uint32_t out_len = static_cast<uint32_t>(
+          std::min<size_t>(batch_output_capacity_ - batch_output_size_,
+                           std::numeric_limits<uint32_t>::max()));
+      ctx_.SetBuffers(in, in_len, batch_output_ + batch_output_size_, out_len);
+      ctx_.SetFlush(flush);
+      ctx_.DoThreadPoolWork();
+      if (ctx_.GetErrorInfo().IsError()) return false;
+
+      uint32_t avail_in, avail_out;
+      ctx_.GetAfterWriteOffsets(&avail_in, &avail_out);
+      batch_output_size_ += out_len - avail_out;
+      in += in_len - avail_in;
+      in_len = avail_in;
+      if (avail_out != 0) return true;
+    }
+  }
+
+  // Hands the output of the last batch to JS and clears the batch.
+  MaybeLocal<Object> TakeBatchOutput() {
+    char* data = batch_output_;
+    size_t size = batch_output_size_;
+    batch_output_ = nullptr;
+    ClearBatch();
+    Isolate* isolate = AsyncWrap::env()->isolate();
+    if (size == 0) {
+      free(data);
+      return Buffer::New(isolate, 0);
+    }
+    return Buffer::New(isolate, Realloc(data, size), size);
+  }
+
+  void ClearBatch() {
+    batch_inputs_.clear();
+    batch_chunks_.Reset();
+    free(batch_output_);
+    batch_output_ = nullptr;
+    batch_output_size_ = 0;
+    batch_output_capacity_ = 0;
+  }
+
 
   bool CheckError() {
     const CompressionError err = ctx_.GetErrorInfo();
@@ -523,20 +875,39 @@ class CompressionStream : public AsyncWrap, public ThreadPoolWork {
     auto on_scope_leave = OnScopeLeave([&]() { Unref(); });
 
     write_in_progress_ = false;
+    bool batch = batch_in_progress_;
+    batch_in_progress_ = false;
+
+    Environment* env = AsyncWrap::env();
+    HandleScope handle_scope(env->isolate());
 
     if (status == UV_ECANCELED) {
+      if (batch) ClearBatch();
       Close();
       return;
     }
 
     CHECK_EQ(status, 0);
 
-    Environment* env = AsyncWrap::env();
-    HandleScope handle_scope(env->isolate());
     Context::Scope context_scope(env->context());
 
-    if (!CheckError())
+    if (!CheckError()) {
+      if (batch) ClearBatch();
       return;
+    }
+
+    if (batch) {
+      Local<Object> output;
+      if (!TakeBatchOutput().ToLocal(&output)) return;
+      Local<Value> cb = object()
+                            ->GetInternalField(kWriteBatchJSCallback)
+                            .template As<Value>();
+      Local<Value> argv[] = {output};
+      MakeCallback(cb.As<Function>(), arraysize(argv), argv);
+      if (pending_close_)
+        Close();
+      return;
+    }
 
     UpdateWriteResult();
 
@@ -583,6 +954,7 @@ class CompressionStream : public AsyncWrap, public ThreadPoolWork {
     tracker->TrackField("compression context", ctx_);
     tracker->TrackFieldWithSize("zlib_memory",
                                 zlib_memory_ + unreported_allocations_);
+    tracker->TrackFieldWithSize("batch_output", batch_output_capacity_);
   }
 
  protected:
@@ -673,6 +1045,14 @@ class CompressionStream : public AsyncWrap, public ThreadPoolWork {
   unsigned int refs_ = 0;
   uint32_t* write_result_ = nullptr;
   std::atomic<ssize_t> unreported_allocations_{0};
+  // State of the writeBatch() in progress.
+  bool batch_in_progress_ = false;
+  std::vector<std::pair<const char*, uint32_t>> batch_inputs_;
+  Global<Array> batch_chunks_;
+  uint32_t batch_flush_ = 0;
+  char* batch_output_ = nullptr;
+  size_t batch_output_size_ = 0;
+  size_t batch_output_capacity_ = 0;
   size_t zlib_memory_ = 0;
 
   CompressionContext ctx_;
@@ -705,9 +1085,9 @@ class ZlibStream final : public CompressionStream<ZlibContext> {
           "a version of npm (> 5.5.1 or < 5.4.0) or node-tar (> 4.0.1) "
           "that is compatible with Node.js 9 and above.\n");
     }
-    CHECK(args.Length() == 7 &&
+    CHECK((args.Length() == 7 || args.Length() == 8) &&
       "init(windowBits, level, memLevel, strategy, writeResult, writeCallback,"
-      " dictionary)");
+      " dictionary[, parallelism])");
 
     ZlibStream* wrap;
     ASSIGN_OR_RETURN_UNWRAP(&wrap, args.This());
@@ -753,6 +1133,12 @@ class ZlibStream final : public CompressionStream<ZlibContext> {
         AllocForZlib, FreeForZlib, static_cast<CompressionStream*>(wrap));
     wrap->context()->Init(level, window_bits, mem_level, strategy,
                           std::move(dictionary));
+
+    if (args.Length() == 8 && !args[7]->IsUndefined()) {
+      uint32_t parallelism;
+      if (!args[7]->Uint32Value(context).To(&parallelism)) return;
+      wrap->context()->SetParallelism(parallelism);
+    }
   }
 
   static void Params(const FunctionCallbackInfo<Value>& args) {
@@ -802,7 +1188,8 @@ class BrotliCompressionStream final :
   static void Init(const FunctionCallbackInfo<Value>& args) {
     BrotliCompressionStream* wrap;
     ASSIGN_OR_RETURN_UNWRAP(&wrap, args.This());
-    CHECK(args.Length() == 3 && "init(params, writeResult, writeCallback)");
+    CHECK((args.Length() == 3 || args.Length() == 4) &&
+          "init(params, writeResult, writeCallback[, dictionary])");
 
     CHECK(args[1]->IsUint32Array());
     uint32_t* write_result = reinterpret_cast<uint32_t*>(Buffer::Data(args[1]));
@@ -842,6 +1229,23 @@ class BrotliCompressionStream final :
         return;
       }
     }
+
+    if (args.Length() == 4 && args[3]->IsArrayBufferView()) {
+      int quality = BROTLI_DEFAULT_QUALITY;
+      if (len > BROTLI_PARAM_QUALITY &&
+          data[BROTLI_PARAM_QUALITY] != static_cast<uint32_t>(-1)) {
+        quality = data[BROTLI_PARAM_QUALITY];
+      }
+      ArrayBufferViewContents<uint8_t> dictionary(args[3]);
+      err = wrap->context()->SetDictionary(
+          dictionary.data(), dictionary.length(), quality);
+      if (err.IsError()) {
+        wrap->EmitError(err);
+        THROW_ERR_ZLIB_INITIALIZATION_FAILED(wrap->env(),
+                                             "Initialization failed");
+        return;
+      }
+    }
   }
 
   static void Params(const FunctionCallbackInfo<Value>& args) {
@@ -878,8 +1282,9 @@ class ZstdStream final : public CompressionStream<CompressionContext> {
     Environment* env = Environment::GetCurrent(args);
     Local<Context> context = env->context();
 
-    CHECK(args.Length() == 4 &&
-          "init(params, pledgedSrcSize, writeResult, writeCallback)");
+    CHECK((args.Length() == 4 || args.Length() == 5) &&
+          "init(params, pledgedSrcSize, writeResult, writeCallback"
+          "[, dictionary])");
     ZstdStream* wrap;
     ASSIGN_OR_RETURN_UNWRAP(&wrap, args.This());
 
@@ -928,6 +1333,23 @@ class ZstdStream final : public CompressionStream<CompressionContext> {
         return;
       }
     }
+
+    if (args.Length() == 5 && args[4]->IsArrayBufferView()) {
+      // A CDict fixes the compression level it was digested with.
+      int level = ZSTD_CLEVEL_DEFAULT;
+      if (len > ZSTD_c_compressionLevel &&
+          data[ZSTD_c_compressionLevel] != static_cast<uint32_t>(-1)) {
+        level = static_cast<int>(data[ZSTD_c_compressionLevel]);
+      }
+      ArrayBufferViewContents<uint8_t> dictionary(args[4]);
+      CompressionError err = wrap->context()->SetDictionary(
+          dictionary.data(), dictionary.length(), level);
+      if (err.IsError()) {
+        wrap->EmitError(err);
+        THROW_ERR_ZLIB_INITIALIZATION_FAILED(wrap->env(), err.message);
+        return;
+      }
+    }
   }
 
   static void Params(const FunctionCallbackInfo<Value>& args) {
@@ -968,6 +1390,8 @@ void ZlibContext::Close() {
   mode_ = NONE;
 
   dictionary_.clear();
+  parallel_output_active_ = false;
+  parallel_output_.clear();
 }
 
 
@@ -977,6 +1401,16 @@ void ZlibContext::DoThreadPoolWork() {
     return;
   }
 
+  if (parallel_output_active_) {
+    DrainParallelOutput();
+    return;
+  }
+
+  if (ShouldDeflateInParallel() && DeflateInParallel()) {
+    DrainParallelOutput();
+    return;
+  }
+
   const Bytef* next_expected_header_byte = nullptr;
 
   // If the avail_out is left at 0, then it means that it ran out
@@ -1131,6 +1565,251 @@ CompressionError ZlibContext::GetErrorInfo() const {
 }
 
 
+bool ZlibContext::ShouldDeflateInParallel() const {
+  if (mode_ != DEFLATE && mode_ != GZIP && mode_ != DEFLATERAW) return false;
+  // Only a stream that receives its entire input in the first write can be
+  // split up; anything else depends on the state of the serial deflater.
+  return parallelism_ > 1 && flush_ == Z_FINISH &&
+         strm_.total_in == 0 && strm_.total_out == 0 && dictionary_.empty() &&
+         strm_.avail_in >= kParallelDeflateMinInput;
+}
+
+
+// The blocks of one parallel deflate, shared by the thread running the
+// deflate and the helper threads. Every thread takes blocks until none are
+// left, so the deflate finishes even if no helper could be started.
+struct ParallelDeflate {
+  struct Block {
+    std::vector<unsigned char> out;
+    uLong check = 0;
+    int err = Z_OK;
+  };
+
+  ParallelDeflate(const Bytef* input,
+                  size_t input_length,
+                  int level,
+                  int window_bits,
+                  int mem_level,
+                  int strategy,
+                  bool gzip)
+      : input(input),
+        input_length(input_length),
+        level(level),
+        window_bits(window_bits),
+        mem_level(mem_level),
+        strategy(strategy),
+        gzip(gzip),
+        blocks((input_length + kParallelDeflateBlockSize - 1) /
+               kParallelDeflateBlockSize) {}
+
+  void Run() {
+    for (size_t i = next++; i < blocks.size(); i = next++) {
+      Compress(i);
+      Mutex::ScopedLock lock(mutex);
+      if (++done == blocks.size()) finished.Broadcast(lock);
+    }
+  }
+
+  void Wait() {
+    Mutex::ScopedLock lock(mutex);
+    while (done < blocks.size()) finished.Wait(lock);
+  }
+
+  void Compress(size_t i) {
+    Block* block = &blocks[i];
+    const size_t start = i * kParallelDeflateBlockSize;
+    const size_t length =
+        std::min(kParallelDeflateBlockSize, input_length - start);
+    const bool last = i + 1 == blocks.size();
+
+    z_stream strm{};
+    block->err = deflateInit2(
+        &strm, level, Z_DEFLATED, -window_bits, mem_level, strategy);
+    if (block->err != Z_OK) return;
+
+    if (start > 0) {
+      const size_t dictionary_length =
+          std::min(size_t{1} << window_bits, start);
+      block->err = deflateSetDictionary(
+          &strm, input + start - dictionary_length, dictionary_length);
+    }
+
+    if (block->err == Z_OK) {
+      // Leave room for the empty stored block a sync flush emits.
+      block->out.resize(deflateBound(&strm, length) + 16);
+      strm.next_in = const_cast<Bytef*>(input + start);
+      strm.avail_in = length;
+      strm.next_out = block->out.data();
+      strm.avail_out = block->out.size();
+      block->err = deflate(&strm, last ? Z_FINISH : Z_SYNC_FLUSH);
+      if (block->err == Z_STREAM_END ||
+          (block->err == Z_OK && !last && strm.avail_out > 0)) {
+        block->err = Z_OK;
+        block->out.resize(strm.total_out);
+      } else if (block->err == Z_OK) {
+        block->err = Z_BUF_ERROR;
+      }
+    }
+    deflateEnd(&strm);
+
+    if (block->err == Z_OK) {
+      block->check = gzip ? crc32(0, input + start, length)
+                          : adler32(1, input + start, length);
+    }
+  }
+
+  const Bytef* const input;
+  const size_t input_length;
+  const int level;
+  const int window_bits;
+  const int mem_level;
+  const int strategy;
+  const bool gzip;
+  std::vector<Block> blocks;
+  std::atomic<size_t> next{0};
+  Mutex mutex;
+  ConditionVariable finished;
+  size_t done = 0;
+};
+
+// Compresses the pending input as a sequence of independent raw deflate
+// blocks, each primed with the preceding window of input as its dictionary
+// and terminated with a sync flush so that they can be concatenated. The
+// per-block checksums are combined and wrapped in the zlib or gzip framing
+// the serial deflater would have produced. Returns false without consuming
+// any input if the streams could not be set up, so that the caller can fall
+// back to a regular deflate().
+//
+// Like the lanes of scrypt, the blocks are compressed by helper threads of
+// their own. A large input keeps every helper busy for as long as the whole
+// deflate takes, which on the V8 platform's workers would hold up GC tasks.
+bool ZlibContext::DeflateInParallel() {
+  const bool gzip = mode_ == GZIP;
+  int window_bits = mode_ == DEFLATERAW ? -window_bits_
+                                        : window_bits_ - (gzip ? 16 : 0);
+  // deflateInit2() silently upgrades a window of 256 bytes to 512 bytes.
+  window_bits = std::max(window_bits, 9);
+
+  const Bytef* input = strm_.next_in;
+  const size_t input_length = strm_.avail_in;
+  ParallelDeflate parallel(input,
+                           input_length,
+                           level_,
+                           window_bits,
+                           mem_level_,
+                           strategy_,
+                           gzip);
+  const size_t block_count = parallel.blocks.size();
+
+  std::vector<uv_thread_t> helpers(std::min<size_t>(
+      {parallelism_ - 1, block_count - 1, uv_available_parallelism() - 1}));
+  size_t started = 0;
+  for (; started < helpers.size(); started++) {
+    if (uv_thread_create(
+            &helpers[started],
+            [](void* arg) { static_cast<ParallelDeflate*>(arg)->Run(); },
+            &parallel) != 0) {
+      break;
+    }
+  }
+  parallel.Run();
+  parallel.Wait();
+  for (size_t i = 0; i < started; i++) CHECK_EQ(uv_thread_join(&helpers[i]), 0);
+  const std::vector<ParallelDeflate::Block>& blocks = parallel.blocks;
+
+  uLong check = gzip ? crc32(0, nullptr, 0) : adler32(0, nullptr, 0);
+  size_t output_length = 0;
+  for (size_t i = 0; i < block_count; i++) {
+    if (blocks[i].err != Z_OK) return false;
+    const size_t length =
+        std::min(kParallelDeflateBlockSize,
+                 input_length - i * kParallelDeflateBlockSize);
+    check = gzip ? crc32_combine(check, blocks[i].check, length)
+                 : adler32_combine(check, blocks[i].check, length);
+    output_length += blocks[i].out.size();
+  }
+
+  parallel_output_.clear();
+  parallel_output_.reserve(output_length + 18);
+  const int level = level_ == Z_DEFAULT_COMPRESSION ? 6 : level_;
+  if (gzip) {
+    // ID1, ID2, CM, FLG and a zero MTIME, as written by deflate() when no
+    // custom gzip header has been set.
+    parallel_output_.insert(parallel_output_.end(),
+                            {GZIP_HEADER_ID1,
+                             GZIP_HEADER_ID2,
+                             static_cast<unsigned char>(Z_DEFLATED),
+                             0, 0, 0, 0, 0});
+    parallel_output_.push_back(
+        level == 9 ? 2
+                   : (strategy_ >= Z_HUFFMAN_ONLY || level < 2 ? 4 : 0));
+#ifdef _WIN32
+    parallel_output_.push_back(10);  // OS: NTFS
+#else
+    parallel_output_.push_back(3);  // OS: Unix
+#endif
+  } else if (mode_ == DEFLATE) {
+    const unsigned level_flags =
+        strategy_ >= Z_HUFFMAN_ONLY || level < 2 ? 0
+        : level < 6                               ? 1
+        : level == 6                              ? 2
+                                                  : 3;
+    unsigned header = (Z_DEFLATED + ((window_bits - 8) << 4)) << 8;
+    header |= level_flags << 6;
+    header += 31 - (header % 31);
+    parallel_output_.push_back(header >> 8);
+    parallel_output_.push_back(header & 0xff);
+  }
+
+  for (const ParallelDeflate::Block& block : blocks) {
+    parallel_output_.insert(
+        parallel_output_.end(), block.out.begin(), block.out.end());
+  }
+
+  if (gzip) {
+    const uint32_t input_size = static_cast<uint32_t>(input_length);
+    for (int shift = 0; shift < 32; shift += 8)
+      parallel_output_.push_back((check >> shift) & 0xff);
+    for (int shift = 0; shift < 32; shift += 8)
+      parallel_output_.push_back((input_size >> shift) & 0xff);
+  } else if (mode_ == DEFLATE) {
+    for (int shift = 24; shift >= 0; shift -= 8)
+      parallel_output_.push_back((check >> shift) & 0xff);
+  }
+
+  strm_.next_in += input_length;
+  strm_.avail_in = 0;
+  strm_.total_in += input_length;
+  parallel_output_offset_ = 0;
+  parallel_output_active_ = true;
+  return true;
+}
+
+
+void ZlibContext::DrainParallelOutput() {
+  const size_t length =
+      std::min<size_t>(strm_.avail_out,
+                       parallel_output_.size() - parallel_output_offset_);
+  if (length > 0) {
+    memcpy(strm_.next_out,
+           parallel_output_.data() + parallel_output_offset_,
+           length);
+  }
+  strm_.next_out += length;
+  strm_.avail_out -= length;
+  strm_.total_out += length;
+  parallel_output_offset_ += length;
+
+  if (parallel_output_offset_ == parallel_output_.size()) {
+    std::vector<unsigned char>().swap(parallel_output_);
+    parallel_output_offset_ = 0;
+    err_ = Z_STREAM_END;
+  } else {
+    err_ = Z_OK;
+  }
+}
+
+
 CompressionError ZlibContext::ResetStream() {
   bool first_init_call = InitZlib();
   if (first_init_call && err_ != Z_OK) {
@@ -1138,6 +1817,9 @@ CompressionError ZlibContext::ResetStream() {
   }
 
   err_ = Z_OK;
+  parallel_output_active_ = false;
+  parallel_output_.clear();
+  parallel_output_offset_ = 0;
 
   switch (mode_) {
     case DEFLATE:
@@ -1371,7 +2053,34 @@ CompressionError BrotliEncoderContext::Init(brotli_alloc_func alloc,
 }
 
 CompressionError BrotliEncoderContext::ResetStream() {
-  return Init(alloc_, free_, alloc_opaque_);
+  CompressionError err = Init(alloc_, free_, alloc_opaque_);
+  if (err.IsError()) return err;
+  return AttachDictionary();
+}
+
+CompressionError BrotliEncoderContext::SetDictionary(const uint8_t* data,
+                                                     size_t length,
+                                                     int quality) {
+  dictionary_ =
+      SharedDictionaryCache<BrotliPreparedDictionaryTraits>::Get(
+          data, length, quality);
+  if (!dictionary_) {
+    return CompressionError("Could not prepare Brotli dictionary",
+                            "ERR_ZLIB_INITIALIZATION_FAILED",
+                            -1);
+  }
+  return AttachDictionary();
+}
+
+CompressionError BrotliEncoderContext::AttachDictionary() {
+  if (!dictionary_) return CompressionError {};
+  if (!BrotliEncoderAttachPreparedDictionary(state_.get(),
+                                             dictionary_.get())) {
+    return CompressionError("Setting dictionary failed",
+                            "ERR_BROTLI_PARAM_SET_FAILED",
+                            -1);
+  }
+  return CompressionError {};
 }
 
 CompressionError BrotliEncoderContext::SetParams(int key, uint32_t value) {
@@ -1436,7 +2145,30 @@ CompressionError BrotliDecoderContext::Init(brotli_alloc_func alloc,
 }
 
 CompressionError BrotliDecoderContext::ResetStream() {
-  return Init(alloc_, free_, alloc_opaque_);
+  CompressionError err = Init(alloc_, free_, alloc_opaque_);
+  if (err.IsError()) return err;
+  return AttachDictionary();
+}
+
+CompressionError BrotliDecoderContext::SetDictionary(const uint8_t* data,
+                                                     size_t length,
+                                                     int quality) {
+  dictionary_ =
+      SharedDictionaryCache<BrotliRawDictionaryTraits>::Get(data, length, 0);
+  return AttachDictionary();
+}
+
+CompressionError BrotliDecoderContext::AttachDictionary() {
+  if (!dictionary_) return CompressionError {};
+  if (!BrotliDecoderAttachDictionary(state_.get(),
+                                     BROTLI_SHARED_DICTIONARY_RAW,
+                                     dictionary_->size(),
+                                     dictionary_->data())) {
+    return CompressionError("Setting dictionary failed",
+                            "ERR_BROTLI_PARAM_SET_FAILED",
+                            -1);
+  }
+  return CompressionError {};
 }
 
 CompressionError BrotliDecoderContext::SetParams(int key, uint32_t value) {
@@ -1514,7 +2246,7 @@ CompressionError ZstdCompressContext::SetParameter(int key, int value) {
 
 CompressionError ZstdCompressContext::Init(uint64_t pledged_src_size) {
   pledged_src_size_ = pledged_src_size;
-  cctx_.reset(ZSTD_createCCtx());
+  cctx_.reset(ZstdContextPool::AcquireCCtx());
   if (!cctx_) {
     return CompressionError("Could not initialize zstd instance",
                             "ERR_ZLIB_INITIALIZATION_FAILED",
@@ -1525,6 +2257,21 @@ CompressionError ZstdCompressContext::Init(uint64_t pledged_src_size) {
     return CompressionError(
         "Could not set pledged src size", "ERR_ZLIB_INITIALIZATION_FAILED", -1);
   }
+  if (cdict_ && ZSTD_isError(ZSTD_CCtx_refCDict(cctx_.get(), cdict_.get()))) {
+    return CompressionError(
+        "Setting dictionary failed", "ERR_ZSTD_PARAM_SET_FAILED", -1);
+  }
+  return {};
+}
+
+CompressionError ZstdCompressContext::SetDictionary(const uint8_t* data,
+                                                    size_t length,
+                                                    int level) {
+  cdict_ = SharedDictionaryCache<ZstdCDictTraits>::Get(data, length, level);
+  if (!cdict_ || ZSTD_isError(ZSTD_CCtx_refCDict(cctx_.get(), cdict_.get()))) {
+    return CompressionError(
+        "Setting dictionary failed", "ERR_ZSTD_PARAM_SET_FAILED", -1);
+  }
   return {};
 }
 
@@ -1553,12 +2300,27 @@ CompressionError ZstdDecompressContext::SetParameter(int key, int value) {
 }
 
 CompressionError ZstdDecompressContext::Init(uint64_t pledged_src_size) {
-  dctx_.reset(ZSTD_createDCtx());
+  dctx_.reset(ZstdContextPool::AcquireDCtx());
   if (!dctx_) {
     return CompressionError("Could not initialize zstd instance",
                             "ERR_ZLIB_INITIALIZATION_FAILED",
                             -1);
   }
+  if (ddict_ && ZSTD_isError(ZSTD_DCtx_refDDict(dctx_.get(), ddict_.get()))) {
+    return CompressionError(
+        "Setting dictionary failed", "ERR_ZSTD_PARAM_SET_FAILED", -1);
+  }
+  return {};
+}
+
+CompressionError ZstdDecompressContext::SetDictionary(const uint8_t* data,
+                                                      size_t length,
+                                                      int level) {
+  ddict_ = SharedDictionaryCache<ZstdDDictTraits>::Get(data, length, 0);
+  if (!ddict_ || ZSTD_isError(ZSTD_DCtx_refDDict(dctx_.get(), ddict_.get()))) {
+    return CompressionError(
+        "Setting dictionary failed", "ERR_ZSTD_PARAM_SET_FAILED", -1);
+  }
   return {};
 }
 
@@ -1589,6 +2351,10 @@ struct MakeClass {
 
     SetProtoMethod(isolate, z, "write", Stream::template Write<true>);
     SetProtoMethod(isolate, z, "writeSync", Stream::template Write<false>);
+    SetProtoMethod(
+        isolate, z, "writeBatch", Stream::template WriteBatch<true>);
+    SetProtoMethod(
+        isolate, z, "writeBatchSync", Stream::template WriteBatch<false>);
     SetProtoMethod(isolate, z, "close", Stream::Close);
 
     SetProtoMethod(isolate, z, "init", Stream::Init);
@@ -1602,6 +2368,8 @@ struct MakeClass {
     registry->Register(Stream::New);
     registry->Register(Stream::template Write<true>);
     registry->Register(Stream::template Write<false>);
+    registry->Register(Stream::template WriteBatch<true>);
+    registry->Register(Stream::template WriteBatch<false>);
     registry->Register(Stream::Close);
     registry->Register(Stream::Init);
     registry->Register(Stream::Params);
@@ -1,11 +1,19 @@
 #include "path.h"
+#include <algorithm>
 #include <string>
 #include <vector>
 #include "env-inl.h"
+#include "node_external_reference.h"
 #include "node_internals.h"
 
 namespace node {
 
+using v8::Context;
+using v8::FunctionCallbackInfo;
+using v8::Local;
+using v8::Object;
+using v8::Value;
+
 #ifdef _WIN32
 constexpr bool IsPathSeparator(const char c) noexcept {
   return c == '\\' || c == '/';
@@ -16,9 +24,14 @@ constexpr bool IsPathSeparator(const char c) noexcept {
 }
 #endif  // _WIN32
 
-std::string NormalizeString(const std::string_view path,
-                            bool allowAboveRoot,
-                            const std::string_view separator) {
+constexpr bool IsPosixPathSeparator(const char c) noexcept {
+  return c == '/';
+}
+
+template <bool (*IsSeparator)(const char c) noexcept>
+static std::string NormalizeStringImpl(const std::string_view path,
+                                       bool allowAboveRoot,
+                                       const std::string_view separator) {
   std::string res;
   int lastSegmentLength = 0;
   int lastSlash = -1;
@@ -27,13 +40,13 @@ std::string NormalizeString(const std::string_view path,
   for (size_t i = 0; i <= path.size(); ++i) {
     if (i < path.size()) {
       code = path[i];
-    } else if (IsPathSeparator(code)) {
+    } else if (IsSeparator(code)) {
       break;
     } else {
       code = '/';
     }
 
-    if (IsPathSeparator(code)) {
+    if (IsSeparator(code)) {
       if (lastSlash == static_cast<int>(i - 1) || dots == 1) {
         // NOOP
       } else if (dots == 2) {
@@ -87,6 +100,227 @@ std::string NormalizeString(const std::string_view path,
   return res;
 }
 
+std::string NormalizeString(const std::string_view path,
+                            bool allowAboveRoot,
+                            const std::string_view separator) {
+  return NormalizeStringImpl<IsPathSeparator>(path, allowAboveRoot, separator);
+}
+
+namespace posix {
+
+std::string Normalize(std::string_view path) {
+  if (path.empty()) return ".";
+  const bool is_absolute = path.front() == '/';
+  const bool trailing_separator = path.back() == '/';
+  std::string normalized =
+      NormalizeStringImpl<IsPosixPathSeparator>(path, !is_absolute, "/");
+  if (normalized.empty()) {
+    if (is_absolute) return "/";
+    return trailing_separator ? "./" : ".";
+  }
+  if (trailing_separator) normalized += '/';
+  return is_absolute ? "/" + normalized : normalized;
+}
+
+std::string Join(const std::vector<std::string_view>& paths) {
+  std::string joined;
+  bool has_path = false;
+  for (std::string_view path : paths) {
+    if (path.empty()) continue;
+    if (has_path) joined += '/';
+    joined += path;
+    has_path = true;
+  }
+  if (!has_path) return ".";
+  return Normalize(joined);
+}
+
+bool ResolveNeedsCwd(const std::vector<std::string_view>& paths) {
+  return std::none_of(paths.begin(), paths.end(), [](std::string_view path) {
+    return !path.empty() && path.front() == '/';
+  });
+}
+
+std::string Resolve(std::string_view cwd,
+                    const std::vector<std::string_view>& paths) {
+  std::string resolved_path;
+  bool resolved_absolute = false;
+
+  for (int i = static_cast<int>(paths.size()) - 1;
+       i >= -1 && !resolved_absolute;
+       i--) {
+    std::string_view path = i >= 0 ? paths[i] : cwd;
+    if (path.empty()) continue;
+    resolved_path = std::string(path) + "/" + resolved_path;
+    resolved_absolute = path.front() == '/';
+  }
+
+  std::string normalized = NormalizeStringImpl<IsPosixPathSeparator>(
+      resolved_path, !resolved_absolute, "/");
+  if (resolved_absolute) return "/" + normalized;
+  return normalized.empty() ? "." : normalized;
+}
+
+std::string Relative(std::string_view cwd,
+                     std::string_view from_path,
+                     std::string_view to_path) {
+  if (from_path == to_path) return "";
+  const std::string from = Resolve(cwd, {from_path});
+  const std::string to = Resolve(cwd, {to_path});
+  if (from == to) return "";
+
+  // Both are absolute, so skip the leading '/'.
+  const size_t from_start = 1;
+  const size_t from_end = from.size();
+  const size_t from_len = from_end - from_start;
+  const size_t to_start = 1;
+  const size_t to_len = to.size() - to_start;
+
+  // Compare paths to find the longest common path from root.
+  const size_t length = std::min(from_len, to_len);
+  ptrdiff_t last_common_sep = -1;
+  size_t i = 0;
+  for (; i < length; i++) {
+    const char from_code = from[from_start + i];
+    if (from_code != to[to_start + i]) break;
+    if (from_code == '/') last_common_sep = i;
+  }
+  if (i == length) {
+    if (to_len > length) {
+      if (to[to_start + i] == '/') {
+        // `from` is the exact base path for `to`, e.g. from='/foo/bar';
+        // to='/foo/bar/baz'.
+        return to.substr(to_start + i + 1);
+      }
+      if (i == 0) {
+        // `from` is the root, e.g. from='/'; to='/foo'.
+        return to.substr(to_start + i);
+      }
+    } else if (from_len > length) {
+      if (from[from_start + i] == '/') {
+        // `to` is the exact base path for `from`, e.g. from='/foo/bar/baz';
+        // to='/foo/bar'.
+        last_common_sep = i;
+      } else if (i == 0) {
+        // `to` is the root, e.g. from='/foo/bar'; to='/'.
+        last_common_sep = 0;
+      }
+    }
+  }
+
+  // Generate the relative path based on the path difference between `to`
+  // and `from`.
+  const size_t common_end = static_cast<size_t>(last_common_sep + 1);
+  std::string out;
+  for (i = from_start + common_end; i <= from_end; i++) {
+    if (i == from_end || from[i] == '/') {
+      out += out.empty() ? ".." : "/..";
+    }
+  }
+  // Lastly, append the rest of the destination (`to`) path that comes after
+  // the common path parts.
+  return out + to.substr(to_start + common_end - 1);
+}
+
+}  // namespace posix
+
+namespace path {
+
+// The working directory as seen by path.posix, which on Windows is the
+// process cwd with '/' separators and without the drive.
+static std::string PosixCwd(Environment* env) {
+  std::string cwd = env->GetCwd(env->exec_path());
+#ifdef _WIN32
+  std::replace(cwd.begin(), cwd.end(), '\\', '/');
+  size_t first_separator = cwd.find('/');
+  if (first_separator != std::string::npos) cwd.erase(0, first_separator);
+#endif
+  return cwd;
+}
+
+// Arguments are Utf8Value-converted, so lone surrogates in the input are
+// replaced with U+FFFD, unlike in the JS implementation.
+static std::vector<std::string> GetPaths(
+    const FunctionCallbackInfo<Value>& args) {
+  std::vector<std::string> paths;
+  paths.reserve(args.Length());
+  for (int i = 0; i < args.Length(); i++) {
+    CHECK(args[i]->IsString());
+    paths.push_back(Utf8Value(args.GetIsolate(), args[i]).ToString());
+  }
+  return paths;
+}
+
+static void ReturnPath(const FunctionCallbackInfo<Value>& args,
+                       std::string_view path) {
+  Local<Value> ret;
+  if (ToV8Value(args.GetIsolate()->GetCurrentContext(),
+                path,
+                args.GetIsolate())
+          .ToLocal(&ret)) {
+    args.GetReturnValue().Set(ret);
+  }
+}
+
+// normalize(path)
+static void Normalize(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args[0]->IsString());
+  Utf8Value path(args.GetIsolate(), args[0]);
+  ReturnPath(args, posix::Normalize(path.ToStringView()));
+}
+
+// join(...paths)
+static void Join(const FunctionCallbackInfo<Value>& args) {
+  std::vector<std::string> paths = GetPaths(args);
+  ReturnPath(args,
+             posix::Join(std::vector<std::string_view>(paths.begin(),
+                                                       paths.end())));
+}
+
+// resolve(...paths)
+static void Resolve(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  std::vector<std::string> paths = GetPaths(args);
+  std::vector<std::string_view> views(paths.begin(), paths.end());
+  std::string cwd = posix::ResolveNeedsCwd(views) ? PosixCwd(env) : "";
+  ReturnPath(args, posix::Resolve(cwd, views));
+}
+
+// relative(from, to)
+static void Relative(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsString());
+  CHECK(args[1]->IsString());
+  Utf8Value from(args.GetIsolate(), args[0]);
+  Utf8Value to(args.GetIsolate(), args[1]);
+  std::string cwd;
+  if (posix::ResolveNeedsCwd({from.ToStringView()}) ||
+      posix::ResolveNeedsCwd({to.ToStringView()})) {
+    cwd = PosixCwd(env);
+  }
+  ReturnPath(args,
+             posix::Relative(cwd, from.ToStringView(), to.ToStringView()));
+}
+
+static void Initialize(Local<Object> target,
+                       Local<Value> unused,
+                       Local<Context> context,
+                       void* priv) {
+  SetMethodNoSideEffect(context, target, "normalize", Normalize);
+  SetMethodNoSideEffect(context, target, "join", Join);
+  SetMethodNoSideEffect(context, target, "resolve", Resolve);
+  SetMethodNoSideEffect(context, target, "relative", Relative);
+}
+
+static void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
+  registry->Register(Normalize);
+  registry->Register(Join);
+  registry->Register(Resolve);
+  registry->Register(Relative);
+}
+
+}  // namespace path
+
 #ifdef _WIN32
 constexpr bool IsWindowsDeviceRoot(const char c) noexcept {
   return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
@@ -273,10 +507,10 @@ std::string PathResolve(Environment* env,
 }
 #endif  // _WIN32
 
-void ToNamespacedPath(Environment* env, BufferValue* path) {
+void ToNamespacedPath(Environment* env, std::string* path) {
 #ifdef _WIN32
-  if (path->length() == 0) return;
-  std::string resolved_path = node::PathResolve(env, {path->ToStringView()});
+  if (path->empty()) return;
+  std::string resolved_path = node::PathResolve(env, {*path});
   if (resolved_path.size() <= 2) {
     return;
   }
@@ -288,35 +522,29 @@ void ToNamespacedPath(Environment* env, BufferValue* path) {
     if (resolved_path[1] == '\\') {
       if (resolved_path[2] != '?' && resolved_path[2] != '.') {
         // Matched non-long UNC root, convert the path to a long UNC path
-        std::string_view unc_prefix = R"(\\?\UNC\)";
-        size_t new_length = unc_prefix.size() + resolved_path.size() - 2;
-        path->AllocateSufficientStorage(new_length + 1);
-        path->SetLength(new_length);
-        memcpy(path->out(), unc_prefix.data(), unc_prefix.size());
-        memcpy(path->out() + unc_prefix.size(),
-               resolved_path.c_str() + 2,
-               resolved_path.size() - 2 + 1);
+        *path = R"(\\?\UNC\)" + resolved_path.substr(2);
         return;
       }
     }
   } else if (IsWindowsDeviceRoot(resolved_path[0]) && resolved_path[1] == ':' &&
              resolved_path[2] == '\\') {
     // Matched device root, convert the path to a long UNC path
-    std::string_view new_prefix = R"(\\?\)";
-    size_t new_length = new_prefix.size() + resolved_path.size();
-    path->AllocateSufficientStorage(new_length + 1);
-    path->SetLength(new_length);
-    memcpy(path->out(), new_prefix.data(), new_prefix.size());
-    memcpy(path->out() + new_prefix.size(),
-           resolved_path.c_str(),
-           resolved_path.size() + 1);
+    *path = R"(\\?\)" + resolved_path;
     return;
   }
 
-  size_t new_length = resolved_path.size();
-  path->AllocateSufficientStorage(new_length + 1);
-  path->SetLength(new_length);
-  memcpy(path->out(), resolved_path.c_str(), resolved_path.size() + 1);
+  *path = std::move(resolved_path);
+#endif
+}
+
+void ToNamespacedPath(Environment* env, BufferValue* path) {
+#ifdef _WIN32
+  if (path->length() == 0) return;
+  std::string namespaced_path = path->ToString();
+  ToNamespacedPath(env, &namespaced_path);
+  path->AllocateSufficientStorage(namespaced_path.size() + 1);
+  path->SetLength(namespaced_path.size());
+  memcpy(path->out(), namespaced_path.c_str(), namespaced_path.size() + 1);
 #endif
 }
 
@@ -333,4 +561,99 @@ void FromNamespacedPath(std::string* path) {
 #endif
 }
 
+namespace {
+
+// Matches the pattern from `pi` against the path from `si`. Wildcards try
+// every split of the rest of the path, so every (pi, si) pair that did not
+// match is remembered and not tried again. This keeps patterns such as
+// "a*a*a*a*b" polynomial instead of exponential in the length of the path.
+class GlobMatcher {
+ public:
+  GlobMatcher(std::string_view pattern, std::string_view path)
+      : pattern_(pattern),
+        path_(path),
+        failed_((pattern.size() + 1) * (path.size() + 1)) {}
+
+  bool Match(size_t pi, size_t si) {
+    const size_t state = pi * (path_.size() + 1) + si;
+    if (failed_[state]) return false;
+    if (MatchFrom(pi, si)) return true;
+    failed_[state] = true;
+    return false;
+  }
+
+ private:
+  bool MatchFrom(size_t pi, size_t si) {
+    std::string_view pattern = pattern_;
+    std::string_view path = path_;
+    while (pi < pattern.size()) {
+      char c = pattern[pi];
+      if (c == '*') {
+        bool globstar = pi + 1 < pattern.size() && pattern[pi + 1] == '*';
+        size_t next = pi + (globstar ? 2 : 1);
+        if (globstar && next < pattern.size() && pattern[next] == '/' &&
+            Match(next + 1, si)) {
+          return true;
+        }
+        for (size_t i = si; i <= path.size(); i++) {
+          if (Match(next, i)) return true;
+          if (i < path.size() && path[i] == '/' && !globstar) break;
+        }
+        return false;
+      }
+
+      if (si >= path.size()) return false;
+      char ch = path[si];
+      if (c == '?') {
+        if (ch == '/') return false;
+      } else if (c == '[') {
+        size_t j = pi + 1;
+        bool negate = j < pattern.size() &&
+                      (pattern[j] == '!' || pattern[j] == '^');
+        if (negate) j++;
+        bool matched = false;
+        bool first = true;
+        while (j < pattern.size() && (first || pattern[j] != ']')) {
+          first = false;
+          char lo = pattern[j];
+          char hi = lo;
+          if (j + 2 < pattern.size() && pattern[j + 1] == '-' &&
+              pattern[j + 2] != ']') {
+            hi = pattern[j + 2];
+            j += 2;
+          }
+          if (ch >= lo && ch <= hi) matched = true;
+          j++;
+        }
+        if (j >= pattern.size()) {
+          // Unterminated class, match '[' literally.
+          if (ch != '[') return false;
+        } else {
+          if (matched == negate || ch == '/') return false;
+          pi = j;
+        }
+      } else {
+        if (c == '\\' && pi + 1 < pattern.size()) c = pattern[++pi];
+        if (c != ch) return false;
+      }
+      pi++;
+      si++;
+    }
+    return si == path.size();
+  }
+
+  std::string_view pattern_;
+  std::string_view path_;
+  std::vector<bool> failed_;
+};
+
+}  // anonymous namespace
+
+bool GlobMatch(std::string_view pattern, std::string_view path) {
+  return GlobMatcher(pattern, path).Match(0, 0);
+}
+
 }  // namespace node
+
+NODE_BINDING_CONTEXT_AWARE_INTERNAL(path, node::path::Initialize)
+NODE_BINDING_EXTERNAL_REFERENCE(path, node::path::RegisterExternalReferences)
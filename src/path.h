@@ -19,13 +19,35 @@ std::string NormalizeString(const std::string_view path,
 std::string PathResolve(Environment* env,
                         const std::vector<std::string_view>& paths);
 
+// Implementations of the `path.posix` functions of the same names, which
+// are independent of the host platform. The cwd that Resolve() and
+// Relative() resolve relative paths against is only read when
+// ResolveNeedsCwd() returns true for the paths being resolved.
+namespace posix {
+std::string Normalize(std::string_view path);
+std::string Join(const std::vector<std::string_view>& paths);
+bool ResolveNeedsCwd(const std::vector<std::string_view>& paths);
+std::string Resolve(std::string_view cwd,
+                    const std::vector<std::string_view>& paths);
+std::string Relative(std::string_view cwd,
+                     std::string_view from,
+                     std::string_view to);
+}  // namespace posix
+
 #ifdef _WIN32
 constexpr bool IsWindowsDeviceRoot(const char c) noexcept;
 #endif  // _WIN32
 
+void ToNamespacedPath(Environment* env, std::string* path);
 void ToNamespacedPath(Environment* env, BufferValue* path);
 void FromNamespacedPath(std::string* path);
 
+// Matches a '/'-separated relative path against a glob pattern. Supports
+// `*` and `?` (which do not match '/'), `**` (which does, and also matches
+// zero directories when followed by '/'), `[...]` classes with ranges and
+// `!`/`^` negation, and `\` escapes.
+bool GlobMatch(std::string_view pattern, std::string_view path);
+
 }  // namespace node
 
 #endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
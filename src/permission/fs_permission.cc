@@ -51,28 +51,33 @@ void FreeRecursivelyNode(
   delete node;
 }
 
-bool is_tree_granted(
-    node::Environment* env,
-    const node::permission::FSPermission::RadixTree* granted_tree,
-    const std::string_view& param) {
-  std::string resolved_param = node::PathResolve(env, {param});
-#ifdef _WIN32
-  // Remove leading "\\?\" from UNC path
-  if (resolved_param.starts_with("\\\\?\\")) {
-    resolved_param.erase(0, 4);
+#ifndef _WIN32
+// Whether `path` is absolute and already in the form node::PathResolve()
+// produces, so it can be looked up without resolving (and copying) it.
+bool IsResolvedPath(std::string_view path) {
+  if (path.empty() || path[0] != '/') {
+    return false;
   }
-
-  // Remove leading "UNC\" from UNC path
-  if (resolved_param.starts_with("UNC\\")) {
-    resolved_param.erase(0, 4);
+  if (path.length() == 1) {
+    return true;
   }
-  // Remove leading "//" from UNC path
-  if (resolved_param.starts_with("//")) {
-    resolved_param.erase(0, 2);
+  if (path.back() == '/') {
+    return false;
   }
-#endif
-  return granted_tree->Lookup(resolved_param, true);
+  size_t segment_start = 1;
+  for (size_t i = 1; i <= path.length(); ++i) {
+    if (i < path.length() && path[i] != '/') {
+      continue;
+    }
+    std::string_view segment = path.substr(segment_start, i - segment_start);
+    if (segment.empty() || segment == "." || segment == "..") {
+      return false;
+    }
+    segment_start = i + 1;
+  }
+  return true;
 }
+#endif  // _WIN32
 
 void PrintTree(const node::permission::FSPermission::RadixTree::Node* node,
                size_t spaces = 0) {
@@ -121,6 +126,67 @@ namespace node {
 
 namespace permission {
 
+int FSPermission::LookupCache::Get(std::string_view path) const {
+  const Entry& entry = entries_[std::hash<std::string_view>{}(path) % kSize];
+  if (!entry.valid || entry.path != path) {
+    return -1;
+  }
+  return entry.granted ? 1 : 0;
+}
+
+void FSPermission::LookupCache::Set(std::string_view path, bool granted) {
+  Entry& entry = entries_[std::hash<std::string_view>{}(path) % kSize];
+  entry.path.assign(path.data(), path.length());
+  entry.granted = granted;
+  entry.valid = true;
+}
+
+void FSPermission::LookupCache::Clear() {
+  for (Entry& entry : entries_) {
+    entry.valid = false;
+  }
+}
+
+bool FSPermission::IsTreeGranted(Environment* env,
+                                 const RadixTree& tree,
+                                 LookupCache* cache,
+                                 std::string_view param) const {
+  std::string resolved_param;
+  std::string_view path;
+#ifndef _WIN32
+  if (IsResolvedPath(param)) {
+    path = param;
+  } else {
+    resolved_param = PathResolve(env, {param});
+    path = resolved_param;
+  }
+#else
+  resolved_param = PathResolve(env, {param});
+  // Remove leading "\\?\" from UNC path
+  if (resolved_param.starts_with("\\\\?\\")) {
+    resolved_param.erase(0, 4);
+  }
+
+  // Remove leading "UNC\" from UNC path
+  if (resolved_param.starts_with("UNC\\")) {
+    resolved_param.erase(0, 4);
+  }
+  // Remove leading "//" from UNC path
+  if (resolved_param.starts_with("//")) {
+    resolved_param.erase(0, 2);
+  }
+  path = resolved_param;
+#endif
+
+  int cached = cache->Get(path);
+  if (cached != -1) {
+    return cached == 1;
+  }
+  bool granted = tree.Lookup(path, true);
+  cache->Set(path, granted);
+  return granted;
+}
+
 // allow = '*'
 // allow = '/tmp/,/home/example.js'
 void FSPermission::Apply(Environment* env,
@@ -139,6 +205,8 @@ void FSPermission::Apply(Environment* env,
     }
     GrantAccess(scope, PathResolve(env, {res}));
   }
+  in_cache_.Clear();
+  out_cache_.Clear();
 }
 
 void FSPermission::GrantAccess(PermissionScope perm, const std::string& res) {
@@ -163,11 +231,11 @@ bool FSPermission::is_granted(Environment* env,
     case PermissionScope::kFileSystemRead:
       return !deny_all_in_ &&
              ((param.empty() && allow_all_in_) || allow_all_in_ ||
-              is_tree_granted(env, &granted_in_fs_, param));
+              IsTreeGranted(env, granted_in_fs_, &in_cache_, param));
     case PermissionScope::kFileSystemWrite:
       return !deny_all_out_ &&
              ((param.empty() && allow_all_out_) || allow_all_out_ ||
-              is_tree_granted(env, &granted_out_fs_, param));
+              IsTreeGranted(env, granted_out_fs_, &out_cache_, param));
     default:
       return false;
   }
@@ -186,7 +254,7 @@ bool FSPermission::RadixTree::Lookup(const std::string_view& s,
     return when_empty_return;
   }
   size_t parent_node_prefix_len = current_node->prefix.length();
-  const std::string path(s);
+  const std::string_view path = s;
   auto path_len = path.length();
 
   while (true) {
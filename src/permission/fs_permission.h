@@ -5,6 +5,8 @@
 
 #include "v8.h"
 
+#include <array>
+#include <string_view>
 #include <unordered_map>
 #include "permission/permission_base.h"
 #include "util.h"
@@ -77,7 +79,7 @@ class FSPermission final : public PermissionBase {
         return wildcard_child;
       }
 
-      Node* NextNode(const std::string& path, size_t idx) const {
+      Node* NextNode(std::string_view path, size_t idx) const {
         if (idx >= path.length()) {
           return nullptr;
         }
@@ -147,10 +149,37 @@ class FSPermission final : public PermissionBase {
   };
 
  private:
+  // Direct-mapped cache of recent decisions, keyed by the resolved path.
+  // Grants only change in Apply(), which clears it.
+  class LookupCache {
+   public:
+    static constexpr size_t kSize = 128;
+
+    // Returns 1 or 0 for a cached decision, or -1 on a miss.
+    int Get(std::string_view path) const;
+    void Set(std::string_view path, bool granted);
+    void Clear();
+
+   private:
+    struct Entry {
+      std::string path;
+      bool granted = false;
+      bool valid = false;
+    };
+    std::array<Entry, kSize> entries_;
+  };
+
   void GrantAccess(PermissionScope scope, const std::string& param);
+  bool IsTreeGranted(Environment* env,
+                     const RadixTree& tree,
+                     LookupCache* cache,
+                     std::string_view param) const;
+
   // fs granted on startup
   RadixTree granted_in_fs_;
   RadixTree granted_out_fs_;
+  mutable LookupCache in_cache_;
+  mutable LookupCache out_cache_;
 
   bool deny_all_in_ = true;
   bool deny_all_out_ = true;
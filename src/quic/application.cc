@@ -201,11 +201,12 @@ StreamPriority Session::Application::GetStreamPriority(const Stream& stream) {
   return StreamPriority::DEFAULT;
 }
 
-BaseObjectPtr<Packet> Session::Application::CreateStreamDataPacket() {
+BaseObjectPtr<Packet> Session::Application::CreateStreamDataPacket(
+    size_t packet_count) {
   return Packet::Create(env(),
                         session_->endpoint(),
                         session_->remote_address(),
-                        session_->max_packet_size(),
+                        session_->max_packet_size() * packet_count,
                         "stream data");
 }
 
@@ -256,16 +257,21 @@ void Session::Application::SendPendingData() {
   // The number of packets that have been sent in this call to SendPendingData.
   size_t packet_send_count = 0;
 
+  // All of the packets prepared in this call are written back to back into
+  // a single Packet, one segment per datagram, so that the endpoint can hand
+  // the whole burst to the kernel at once instead of making one send call
+  // per datagram.
   BaseObjectPtr<Packet> packet;
   uint8_t* pos = nullptr;
   uint8_t* begin = nullptr;
+  uint8_t* base = nullptr;
 
   auto ensure_packet = [&] {
     if (!packet) {
-      packet = CreateStreamDataPacket();
+      packet = CreateStreamDataPacket(max_packet_count);
       if (!packet) [[unlikely]]
         return false;
-      pos = begin = ngtcp2_vec(*packet).base;
+      pos = begin = base = ngtcp2_vec(*packet).base;
     }
     DCHECK(packet);
     DCHECK_NOT_NULL(pos);
@@ -273,6 +279,17 @@ void Session::Application::SendPendingData() {
     return true;
   };
 
+  // Sends the datagrams prepared so far, if any.
+  auto send_batch = [&] {
+    if (packet_send_count == 0) return packet->Done(UV_ECANCELED);
+    Debug(session_,
+          "Sending %zu packets with %zu bytes",
+          packet_send_count,
+          static_cast<size_t>(begin - base));
+    packet->Truncate(begin - base);
+    session_->Send(packet, path);
+  };
+
   // We're going to enter a loop here to prepare and send no more than
   // max_packet_count packets.
   for (;;) {
@@ -290,7 +307,7 @@ void Session::Application::SendPendingData() {
     // The stream_data is the next block of data from the application stream.
     if (GetStreamData(&stream_data) < 0) {
       Debug(session_, "Application failed to get stream data");
-      packet->Done(UV_ECANCELED);
+      send_batch();
       session_->SetLastError(QuicError::ForNgtcp2Error(NGTCP2_ERR_INTERNAL));
       return session_->Close(CloseMethod::SILENT);
     }
@@ -357,7 +374,7 @@ void Session::Application::SendPendingData() {
           if (ndatalen >= 0 && !StreamCommit(&stream_data, ndatalen)) {
             Debug(session_,
                   "Failed to commit stream data while writing packets");
-            packet->Done(UV_ECANCELED);
+            send_batch();
             session_->SetLastError(
                 QuicError::ForNgtcp2Error(NGTCP2_ERR_INTERNAL));
             return session_->Close(CloseMethod::SILENT);
@@ -371,11 +388,11 @@ void Session::Application::SendPendingData() {
       Debug(session_,
             "Application encountered error while writing packet: %s",
             ngtcp2_strerror(nwrite));
-      packet->Done(UV_ECANCELED);
+      send_batch();
       session_->SetLastError(QuicError::ForNgtcp2Error(nwrite));
       return session_->Close(CloseMethod::SILENT);
     } else if (ndatalen >= 0 && !StreamCommit(&stream_data, ndatalen)) {
-      packet->Done(UV_ECANCELED);
+      send_batch();
       session_->SetLastError(QuicError::ForNgtcp2Error(NGTCP2_ERR_INTERNAL));
       return session_->Close(CloseMethod::SILENT);
     }
@@ -387,34 +404,30 @@ void Session::Application::SendPendingData() {
       // sending again.
       if (stream_data.id >= 0) ResumeStream(stream_data.id);
 
-      // There might be a partial packet already prepared. If so, send it.
-      size_t datalen = pos - begin;
-      if (datalen) {
-        Debug(session_, "Sending packet with %zu bytes", datalen);
-        packet->Truncate(datalen);
-        session_->Send(packet, path);
-      } else {
-        packet->Done(UV_ECANCELED);
+      // There might be a partial packet already prepared. If so, send it
+      // along with the rest of the batch.
+      if (pos != begin) {
+        packet->AddSegment(pos - begin);
+        packet_send_count++;
+        begin = pos;
       }
-
+      send_batch();
       return;
     }
 
-    // At this point we have a packet prepared to send.
+    // At this point we have a packet prepared, add it to the batch.
     pos += nwrite;
-    size_t datalen = pos - begin;
-    Debug(session_, "Sending packet with %zu bytes", datalen);
-    packet->Truncate(datalen);
-    session_->Send(packet, path);
+    Debug(session_,
+          "Prepared packet with %zu bytes",
+          static_cast<size_t>(pos - begin));
+    packet->AddSegment(pos - begin);
+    begin = pos;
 
-    // If we have sent the maximum number of packets, we're done.
+    // If we have prepared the maximum number of packets, send them.
     if (++packet_send_count == max_packet_count) {
+      send_batch();
       return;
     }
-
-    // Prepare to loop back around to prepare a new packet.
-    packet.reset();
-    pos = begin = nullptr;
   }
 }
 
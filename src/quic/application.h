@@ -126,7 +126,9 @@ class Session::Application : public MemoryRetainer {
   inline const Session& session() const { return *session_; }
 
  private:
-  BaseObjectPtr<Packet> CreateStreamDataPacket();
+  // Creates a packet with room for packet_count datagrams of at most
+  // max_packet_size() bytes each.
+  BaseObjectPtr<Packet> CreateStreamDataPacket(size_t packet_count = 1);
 
   // Write the given stream_data into the buffer.
   ssize_t WriteVStream(PathStorage* path,
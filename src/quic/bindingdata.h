@@ -66,6 +66,7 @@ class Packet;
   V(ca, "ca")                                                                  \
   V(certs, "certs")                                                            \
   V(cc_algorithm, "cc")                                                        \
+  V(cid_routing, "cidRouting")                                                 \
   V(crl, "crl")                                                                \
   V(ciphers, "ciphers")                                                        \
   V(cubic, "cubic")                                                            \
@@ -116,6 +117,7 @@ class Packet;
   V(reno, "reno")                                                              \
   V(retry_token_expiration, "retryTokenExpiration")                            \
   V(reset_token_secret, "resetTokenSecret")                                    \
+  V(reuse_port, "reusePort")                                                   \
   V(rx_loss, "rxDiagnosticLoss")                                               \
   V(servername, "servername")                                                  \
   V(session, "Session")                                                        \
@@ -133,7 +135,8 @@ class Packet;
   V(validate_address, "validateAddress")                                       \
   V(verify_client, "verifyClient")                                             \
   V(verify_private_key, "verifyPrivateKey")                                    \
-  V(version, "version")
+  V(version, "version")                                                        \
+  V(worker_id, "workerId")
 
 // =============================================================================
 // The BindingState object holds state for the internalBinding('quic') binding
@@ -140,6 +140,28 @@ class RandomCIDFactory : public CID::Factory {
   mutable uint8_t pool_[kPoolSize];
   mutable Mutex mutex_;
 };
+
+class RoutedCIDFactory : public CID::Factory {
+ public:
+  explicit RoutedCIDFactory(uint8_t worker_id) : worker_id_(worker_id) {}
+  DISALLOW_COPY_AND_MOVE(RoutedCIDFactory)
+
+  CID Generate(size_t length_hint) const override {
+    ngtcp2_cid cid;
+    GenerateInto(&cid, length_hint);
+    return CID(cid);
+  }
+
+  CID GenerateInto(ngtcp2_cid* cid,
+                   size_t length_hint = CID::kMaxLength) const override {
+    CID::Factory::random().GenerateInto(cid, length_hint);
+    cid->data[0] = worker_id_;
+    return CID(cid);
+  }
+
+ private:
+  const uint8_t worker_id_;
+};
 }  // namespace
 
 const CID::Factory& CID::Factory::random() {
@@ -147,5 +169,14 @@ const CID::Factory& CID::Factory::random() {
   return instance;
 }
 
+std::unique_ptr<CID::Factory> CID::Factory::Routed(uint8_t worker_id) {
+  return std::make_unique<RoutedCIDFactory>(worker_id);
+}
+
+uint8_t CID::Factory::RoutedWorkerId(const CID& cid) {
+  DCHECK_GE(cid.length(), CID::kMinLength);
+  return static_cast<const uint8_t*>(cid)[0];
+}
+
 }  // namespace node::quic
 #endif  // HAVE_OPENSSL && NODE_OPENSSL_HAS_QUIC
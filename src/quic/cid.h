@@ -4,6 +4,7 @@
 #if HAVE_OPENSSL && NODE_OPENSSL_HAS_QUIC
 #include <memory_tracker.h>
 #include <ngtcp2/ngtcp2.h>
+#include <memory>
 #include <string>
 #include "defs.h"
 
@@ -117,6 +118,14 @@ class CID::Factory {
   // The default random CID generator instance.
   static const Factory& random();
 
+  // Returns a generator of random CIDs whose first byte is worker_id. It is
+  // used by endpoints that share a port across threads so that a packet can
+  // be routed to the worker owning its session by looking at its CID.
+  static std::unique_ptr<Factory> Routed(uint8_t worker_id);
+
+  // Returns the worker id encoded by a Routed() factory into cid.
+  static uint8_t RoutedWorkerId(const CID& cid);
+
   // TODO(@jasnell): This will soon also include additional implementations
   // of CID::Factory that implement the QUIC Load Balancers spec.
 };
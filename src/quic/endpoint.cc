@@ -16,6 +16,7 @@
 #include <uv.h>
 #include <v8.h>
 #include <limits>
+#include <vector>
 #include "application.h"
 #include "bindingdata.h"
 #include "defs.h"
@@ -24,8 +25,10 @@
 
 namespace node {
 
+using v8::ArrayBuffer;
 using v8::ArrayBufferView;
 using v8::BackingStore;
+using v8::BackingStoreInitializationMode;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
 using v8::HandleScope;
@@ -199,7 +202,8 @@ Maybe<Endpoint::Options> Endpoint::Options::From(Environment* env,
       !SET(rx_loss) || !SET(tx_loss) ||
 #endif
       !SET(udp_receive_buffer_size) || !SET(udp_send_buffer_size) ||
-      !SET(udp_ttl) || !SET(reset_token_secret) || !SET(token_secret)) {
+      !SET(udp_ttl) || !SET(reset_token_secret) || !SET(token_secret) ||
+      !SET(reuse_port) || !SET(cid_routing) || !SET(worker_id)) {
     return Nothing<Options>();
   }
 
@@ -270,6 +274,9 @@ std::string Endpoint::Options::ToString() const {
   res +=
       prefix + "udp send buffer size: " + std::to_string(udp_send_buffer_size);
   res += prefix + "udp ttl: " + std::to_string(udp_ttl);
+  res += prefix + "reuse port: " + boolToString(reuse_port);
+  res += prefix + "cid routing: " + boolToString(cid_routing);
+  res += prefix + "worker id: " + std::to_string(worker_id);
 
   res += indent.Close();
   return res;
@@ -318,7 +325,12 @@ class Endpoint::UDP::Impl final : public HandleWrap {
                    reinterpret_cast<uv_handle_t*>(&handle_),
                    PROVIDER_QUIC_UDP),
         endpoint_(endpoint) {
-    CHECK_EQ(uv_udp_init(endpoint->env()->event_loop(), &handle_), 0);
+    // With UV_UDP_RECVMMSG libuv reads up to kReceiveBatchSize datagrams
+    // with a single recvmmsg() call where the platform supports it.
+    CHECK_EQ(uv_udp_init_ex(endpoint->env()->event_loop(),
+                            &handle_,
+                            AF_UNSPEC | UV_UDP_RECVMMSG),
+             0);
     handle_.data = this;
   }
 
@@ -327,10 +339,27 @@ class Endpoint::UDP::Impl final : public HandleWrap {
   SET_SELF_SIZE(Impl)
 
  private:
+  // libuv splits the receive buffer into one slot of this size per datagram
+  // when reading with recvmmsg().
+  static constexpr size_t kReceiveSlotSize = 64 * 1024;
+  static constexpr size_t kReceiveBatchSize = 20;
+
   static void OnAlloc(uv_handle_t* handle,
                       size_t suggested_size,
                       uv_buf_t* buf) {
-    *buf = From(handle)->env()->allocate_managed_buffer(suggested_size);
+    auto impl = From(handle);
+    if (uv_udp_using_recvmmsg(&impl->handle_)) {
+      // The slab is reused for every batch. Each datagram is copied out of
+      // it into a buffer of its own size in OnReceive.
+      if (!impl->receive_slab_) {
+        impl->receive_slab_ =
+            std::make_unique<char[]>(kReceiveSlotSize * kReceiveBatchSize);
+      }
+      *buf = uv_buf_init(impl->receive_slab_.get(),
+                         kReceiveSlotSize * kReceiveBatchSize);
+      return;
+    }
+    *buf = impl->env()->allocate_managed_buffer(suggested_size);
   }
 
   static void OnReceive(uv_udp_t* handle,
@@ -338,27 +367,57 @@ class Endpoint::UDP::Impl final : public HandleWrap {
                         const uv_buf_t* buf,
                         const sockaddr* addr,
                         unsigned int flags) {
-    // Nothing to do in these cases. Specifically, if the nread
-    // is zero or we've received a partial packet, we're just
-    // going to ignore it.
-    if (nread == 0 || flags & UV_UDP_PARTIAL) return;
-
     auto impl = From(handle);
     DCHECK_NOT_NULL(impl);
     DCHECK_NOT_NULL(impl->endpoint_);
 
+    // The final callback for a recvmmsg() batch. Packets from the batch
+    // have all been processed, let the sessions send their responses.
+    if (flags & UV_UDP_MMSG_FREE) {
+      impl->endpoint_->EndReceiveBatch();
+      return;
+    }
+
+    const bool from_slab = impl->receive_slab_ &&
+                           buf->base >= impl->receive_slab_.get() &&
+                           buf->base < impl->receive_slab_.get() +
+                                           kReceiveSlotSize * kReceiveBatchSize;
+
+    // Nothing to do in these cases. Specifically, if the nread
+    // is zero or we've received a partial packet, we're just
+    // going to ignore it.
+    if (nread == 0 || flags & UV_UDP_PARTIAL) {
+      if (!from_slab) impl->env()->release_managed_buffer(*buf);
+      return;
+    }
+
     if (nread < 0) {
+      if (!from_slab) impl->env()->release_managed_buffer(*buf);
       impl->endpoint_->Destroy(CloseContext::RECEIVE_FAILURE,
                                static_cast<int>(nread));
       return;
     }
 
-    impl->endpoint_->Receive(uv_buf_init(buf->base, static_cast<size_t>(nread)),
+    if (!from_slab) {
+      impl->endpoint_->Receive(
+          uv_buf_init(buf->base, static_cast<size_t>(nread)),
+          SocketAddress(addr));
+      return;
+    }
+
+    if (flags & UV_UDP_MMSG_CHUNK) impl->endpoint_->BeginReceiveBatch();
+    std::shared_ptr<BackingStore> backing = ArrayBuffer::NewBackingStore(
+        impl->env()->isolate(),
+        nread,
+        BackingStoreInitializationMode::kUninitialized);
+    memcpy(backing->Data(), buf->base, nread);
+    impl->endpoint_->Receive(Store(std::move(backing), nread, 0),
                              SocketAddress(addr));
   }
 
   uv_udp_t handle_;
   Endpoint* endpoint_;
+  std::unique_ptr<char[]> receive_slab_;
 
   friend class UDP;
 };
@@ -382,6 +441,7 @@ int Endpoint::UDP::Bind(const Options& options) {
   int flags = 0;
   if (options.local_address->family() == AF_INET6 && options.ipv6_only)
     flags |= UV_UDP_IPV6ONLY;
+  if (options.reuse_port) flags |= UV_UDP_REUSEPORT;
   int err = uv_udp_bind(&impl_->handle_, options.local_address->data(), flags);
   int size;
 
@@ -475,6 +535,44 @@ int Endpoint::UDP::Send(const BaseObjectPtr<Packet>& packet) {
   if (is_closed_or_closing()) return UV_EBADF;
   uv_buf_t buf = *packet;
 
+  if (packet->segment_count() > 1) {
+    // The packet carries a batch of datagrams. All but the last one are
+    // handed to the kernel with a single uv_udp_try_send2() call, which
+    // uses sendmmsg() where available. The last datagram is sent below
+    // with the packet's own request so that the packet completes only once
+    // the whole batch has been sent.
+    std::vector<uv_buf_t> bufs = packet->segments();
+    buf = bufs.back();
+    bufs.pop_back();
+    size_t count = bufs.size();
+    std::vector<uv_buf_t*> buf_ptrs(count);
+    std::vector<unsigned int> nbufs(count, 1);
+    std::vector<sockaddr*> addrs(
+        count, const_cast<sockaddr*>(packet->destination().data()));
+    for (size_t n = 0; n < count; n++) buf_ptrs[n] = &bufs[n];
+    int sent = uv_udp_try_send2(&impl_->handle_,
+                                count,
+                                buf_ptrs.data(),
+                                nbufs.data(),
+                                addrs.data(),
+                                0);
+    // Whatever could not be sent synchronously, e.g. because of UV_EAGAIN
+    // or earlier sends still being queued, is queued one datagram at a
+    // time, in order, ahead of the last datagram.
+    for (size_t n = sent > 0 ? sent : 0; n < count; n++) {
+      auto single = Packet::Create(packet->env(),
+                                   nullptr,
+                                   packet->destination(),
+                                   bufs[n].len,
+                                   "batched datagram");
+      // Dropping a datagram here is recovered by QUIC loss detection.
+      if (!single) [[unlikely]]
+        continue;
+      memcpy(ngtcp2_vec(*single).base, bufs[n].base, bufs[n].len);
+      Send(single);
+    }
+  }
+
   // We don't use the default implementation of Dispatch because the packet
   // itself is going to be reset and added to a freelist to be reused. The
   // default implementation of Dispatch will cause the packet to be deleted,
@@ -619,6 +717,8 @@ Endpoint::Endpoint(Environment* env,
       addrLRU_(options_.address_lru_size) {
   MakeWeak();
   udp_.Unref();
+  if (options_.cid_routing)
+    cid_factory_ = CID::Factory::Routed(options_.worker_id);
   STAT_RECORD_TIMESTAMP(Stats, created_at);
   IF_QUIC_DEBUG(env) {
     Debug(this, "Endpoint created. Options %s", options.ToString());
@@ -635,6 +735,18 @@ Endpoint::Endpoint(Environment* env,
   defineProperty(env->stats_string(), stats_.GetArrayBuffer());
 }
 
+Endpoint::~Endpoint() {
+  // Endpoints that are never destroyed explicitly, e.g. when the
+  // Environment is torn down, must not stay reachable by other threads.
+  LeaveRoutingGroup();
+}
+
+void Endpoint::LeaveRoutingGroup() {
+  if (!routing_group_) return;
+  routing_group_->Leave(options_.worker_id, this);
+  routing_group_.reset();
+}
+
 SocketAddress Endpoint::local_address() const {
   DCHECK(!is_closed() && !is_closing());
   return udp_.local_address();
@@ -770,7 +882,7 @@ void Endpoint::Send(const BaseObjectPtr<Packet>& packet) {
     Destroy(CloseContext::SEND_FAILURE, err);
   }
   STAT_INCREMENT_N(Stats, bytes_sent, packet->length());
-  STAT_INCREMENT(Stats, packets_sent);
+  STAT_INCREMENT_N(Stats, packets_sent, packet->segment_count());
 }
 
 void Endpoint::SendRetry(const PathDescriptor& options) {
@@ -888,6 +1000,15 @@ bool Endpoint::Start() {
       Destroy(CloseContext::BIND_FAILURE, err);
       return false;
     }
+    if (options_.cid_routing) {
+      routing_group_ =
+          RoutingGroup::Join(local_address(), options_.worker_id, this);
+      if (!routing_group_) {
+        Debug(this, "Worker id %d is already in use", options_.worker_id);
+        Destroy(CloseContext::BIND_FAILURE, UV_EADDRINUSE);
+        return false;
+      }
+    }
     state_->bound = 1;
   }
 
@@ -932,6 +1053,7 @@ void Endpoint::Listen(const Session::Options& options) {
       options,
       std::move(context),
   };
+  if (cid_factory_) server_state_->options.cid_factory = cid_factory_.get();
   if (Start()) {
     Debug(this, "Listening with options %s", server_state_->options);
     state_->listening = 1;
@@ -945,7 +1067,10 @@ BaseObjectPtr<Session> Endpoint::Connect(
   // If starting fails, the endpoint will be destroyed.
   if (!Start()) return {};
 
-  Session::Config config(env(), options, local_address(), remote_address);
+  Session::Options session_options = options;
+  if (cid_factory_) session_options.cid_factory = cid_factory_.get();
+  Session::Config config(
+      env(), session_options, local_address(), remote_address);
 
   Debug(this,
         "Connecting to %s with options %s and config %s [has 0rtt ticket? %s]",
@@ -1034,6 +1159,8 @@ void Endpoint::Destroy(CloseContext context, int status) {
     session.second->Close(Session::CloseMethod::SILENT);
   sessions.clear();
   DCHECK(sessions_.empty());
+  EndReceiveBatch();
+  LeaveRoutingGroup();
   token_map_.clear();
   dcid_to_scid_.clear();
 
@@ -1061,6 +1188,16 @@ void Endpoint::CloseGracefully() {
 
 void Endpoint::Receive(const uv_buf_t& buf,
                        const SocketAddress& remote_address) {
+  std::shared_ptr<BackingStore> backing = env()->release_managed_buffer(buf);
+  if (!backing) [[unlikely]] {
+    // At this point something bad happened and we need to treat this as a fatal
+    // case. There's likely no way to test this specific condition reliably.
+    return Destroy(CloseContext::RECEIVE_FAILURE, UV_ENOMEM);
+  }
+  Receive(Store(std::move(backing), buf.len, 0), remote_address);
+}
+
+void Endpoint::Receive(Store&& store, const SocketAddress& remote_address) {
   const auto receive = [&](Session* session,
                            Store&& store,
                            const SocketAddress& local_address,
@@ -1070,6 +1207,7 @@ void Endpoint::Receive(const uv_buf_t& buf,
     DCHECK_NOT_NULL(session);
     DCHECK(!session->is_destroyed());
     size_t len = store.length();
+    if (in_receive_batch_) AddToReceiveBatch(session);
     if (session->Receive(std::move(store), local_address, remote_address)) {
       STAT_INCREMENT_N(Stats, bytes_received, len);
       STAT_INCREMENT(Stats, packets_received);
@@ -1471,21 +1609,15 @@ void Endpoint::Receive(const uv_buf_t& buf,
   //   return;
   // }
 
-  Debug(this, "Received %zu-byte packet from %s", buf.len, remote_address);
+  Debug(this,
+        "Received %zu-byte packet from %s",
+        store.length(),
+        remote_address);
 
-  // The managed buffer here contains the received packet. We do not yet know
+  // The store here contains the received packet. We do not yet know
   // at this point if it is a valid QUIC packet. We need to do some basic
   // checks. It is critical at this point that we do as little work as possible
   // to avoid a DOS vector.
-  std::shared_ptr<BackingStore> backing = env()->release_managed_buffer(buf);
-  if (!backing) [[unlikely]] {
-    // At this point something bad happened and we need to treat this as a fatal
-    // case. There's likely no way to test this specific condition reliably.
-    return Destroy(CloseContext::RECEIVE_FAILURE, UV_ENOMEM);
-  }
-
-  Store store(std::move(backing), buf.len, 0);
-
   ngtcp2_vec vec = store;
   ngtcp2_version_cid pversion_cid;
 
@@ -1549,6 +1681,16 @@ void Endpoint::Receive(const uv_buf_t& buf,
     // No existing session.
     Debug(this, "No existing session for dcid %s", dcid);
 
+    // With CID routing, a short header packet whose dcid was issued by
+    // another Endpoint sharing the port was steered here by the kernel,
+    // most likely because the peer's address changed. Hand it over.
+    if (routing_group_ && !scid &&
+        routing_group_->Forward(
+            options_.worker_id, dcid, store, remote_address)) {
+      Debug(this, "Forwarded packet for dcid %s", dcid);
+      return;
+    }
+
     // Handle possible reception of a stateless reset token... If it is a
     // stateless reset, the packet will be handled with no additional action
     // necessary here. We want to return immediately without committing any
@@ -1593,6 +1735,27 @@ void Endpoint::PacketDone(int status) {
   if (state_->closing == 1) MaybeDestroy();
 }
 
+void Endpoint::BeginReceiveBatch() {
+  in_receive_batch_ = true;
+}
+
+void Endpoint::AddToReceiveBatch(Session* session) {
+  for (const auto& entry : receive_batch_) {
+    if (entry.first.get() == session) return;
+  }
+  receive_batch_.emplace_back(
+      BaseObjectPtr<Session>(session),
+      std::make_unique<Session::SendPendingDataScope>(session));
+}
+
+void Endpoint::EndReceiveBatch() {
+  in_receive_batch_ = false;
+  // Releasing the scopes sends the pending data of each session that has
+  // received packets in this batch.
+  auto batch = std::move(receive_batch_);
+  receive_batch_.clear();
+}
+
 void Endpoint::IncrementSocketAddressCounter(const SocketAddress& addr) {
   addrLRU_.Upsert(addr)->active_connections++;
 }
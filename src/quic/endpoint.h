@@ -10,9 +10,13 @@
 #include <uv.h>
 #include <v8.h>
 #include <algorithm>
+#include <memory>
 #include <optional>
+#include <utility>
+#include <vector>
 #include "bindingdata.h"
 #include "packet.h"
+#include "routing.h"
 #include "session.h"
 #include "sessionticket.h"
 #include "tokens.h"
@@ -134,6 +138,19 @@ class Endpoint final : public AsyncWrap, public Packet::Listener {
     // Setting to 0 uses the default.
     uint8_t udp_ttl = 0;
 
+    // When reuse_port is set the UDP port is bound with UV_UDP_REUSEPORT so
+    // that Endpoints on several threads can share it, with the kernel
+    // load balancing incoming packets between them.
+    bool reuse_port = false;
+
+    // With cid_routing, the Endpoint joins the RoutingGroup of its local
+    // address and issues CIDs that identify it by worker_id. Short header
+    // packets for sessions owned by another member of the group are
+    // forwarded to that member. Every Endpoint sharing the port has to use
+    // a distinct worker_id.
+    bool cid_routing = false;
+    uint8_t worker_id = 0;
+
     void MemoryInfo(MemoryTracker* tracker) const override;
     SET_MEMORY_INFO_NAME(Endpoint::Config)
     SET_SELF_SIZE(Options)
@@ -155,6 +172,7 @@ class Endpoint final : public AsyncWrap, public Packet::Listener {
   Endpoint(Environment* env,
            v8::Local<v8::Object> object,
            const Endpoint::Options& options);
+  ~Endpoint() override;
 
   inline operator Packet::Listener*() {
     return this;
@@ -311,6 +329,7 @@ class Endpoint final : public AsyncWrap, public Packet::Listener {
   };
 
   void Destroy(CloseContext context = CloseContext::CLOSE, int status = 0);
+  void LeaveRoutingGroup();
 
   // A graceful close will destroy the endpoint once all existing sessions
   // have ended normally. Creating new sessions (inbound or outbound) will
@@ -370,6 +389,15 @@ class Endpoint final : public AsyncWrap, public Packet::Listener {
   static void FastRef(v8::Local<v8::Object> receiver, bool on);
 
   void Receive(const uv_buf_t& buf, const SocketAddress& from);
+  void Receive(Store&& store, const SocketAddress& from);
+
+  // Datagrams read with a single recvmmsg() call form a receive batch. Every
+  // session that receives packets during the batch is held inside a
+  // SendPendingDataScope until EndReceiveBatch(), so that each session
+  // processes the whole burst with ngtcp2 before it writes its response.
+  void BeginReceiveBatch();
+  void AddToReceiveBatch(Session* session);
+  void EndReceiveBatch();
 
   AliasedStruct<Stats> stats_;
   AliasedStruct<State> state_;
@@ -410,8 +438,18 @@ class Endpoint final : public AsyncWrap, public Packet::Listener {
   CloseContext close_context_ = CloseContext::CLOSE;
   int close_status_ = 0;
 
+  // Set when options_.cid_routing is enabled.
+  std::unique_ptr<CID::Factory> cid_factory_;
+  std::shared_ptr<RoutingGroup> routing_group_;
+
+  bool in_receive_batch_ = false;
+  std::vector<std::pair<BaseObjectPtr<Session>,
+                        std::unique_ptr<Session::SendPendingDataScope>>>
+      receive_batch_;
+
   friend class UDP;
   friend class Packet;
+  friend class RoutingGroup;
   friend class Session;
 };
 
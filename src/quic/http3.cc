@@ -767,7 +767,48 @@ class Http3ApplicationImpl final : public Session::Application {
                                              uint32_t* pflags,
                                              void* conn_user_data,
                                              void* stream_user_data) {
-    return NGTCP2_SUCCESS;
+    NGHTTP3_CALLBACK_SCOPE(app);
+    auto stream = app.session().FindStream(stream_id);
+    if (!stream) return NGHTTP3_ERR_CALLBACK_FAILURE;
+
+    // The body is handed to nghttp3 as the vectors of the stream's outbound
+    // DataQueue, without copying it. nghttp3 keeps referencing them until
+    // on_acked_stream_data is called, so they are committed right away.
+    size_t count = 0;
+    size_t amount = 0;
+    bool fin = false;
+    auto next = [&](int status,
+                    const ngtcp2_vec* data,
+                    size_t len,
+                    bob::Done done) {
+      switch (status) {
+        case bob::Status::STATUS_BLOCK:
+          // Fall through
+        case bob::Status::STATUS_WAIT:
+          return;
+        case bob::Status::STATUS_EOS:
+          fin = true;
+          return;
+      }
+      if (status < 0) return;
+      count = std::min(len, veccnt);
+      for (size_t n = 0; n < count; n++) {
+        vec[n].base = data[n].base;
+        vec[n].len = data[n].len;
+        amount += data[n].len;
+      }
+    };
+
+    int ret = stream->Pull(std::move(next),
+                           bob::Options::OPTIONS_SYNC,
+                           reinterpret_cast<ngtcp2_vec*>(vec),
+                           veccnt,
+                           veccnt);
+    if (ret < 0) return NGHTTP3_ERR_CALLBACK_FAILURE;
+    if (count == 0 && !fin) return NGHTTP3_ERR_WOULDBLOCK;
+    if (fin) *pflags |= NGHTTP3_DATA_FLAG_EOF;
+    if (amount > 0) stream->Commit(amount);
+    return static_cast<nghttp3_ssize>(count);
   }
 
   static int on_acked_stream_data(nghttp3_conn* conn,
@@ -776,7 +817,11 @@ class Http3ApplicationImpl final : public Session::Application {
                                   void* conn_user_data,
                                   void* stream_user_data) {
     NGHTTP3_CALLBACK_SCOPE(app);
-    return app.AcknowledgeStreamData(stream_id, static_cast<size_t>(datalen))
+    // nghttp3 has already accounted for the acknowledgement, so release the
+    // body data of the stream directly. AcknowledgeStreamData() of this class
+    // would hand the bytes to nghttp3 again, which calls back into here.
+    return app.Session::Application::AcknowledgeStreamData(
+               stream_id, static_cast<size_t>(datalen))
                ? NGTCP2_SUCCESS
                : NGHTTP3_ERR_CALLBACK_FAILURE;
   }
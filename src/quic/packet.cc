@@ -11,6 +11,7 @@
 #include <uv.h>
 #include <v8.h>
 #include <string>
+#include <vector>
 #include "bindingdata.h"
 #include "cid.h"
 #include "defs.h"
@@ -28,7 +29,7 @@ namespace quic {
 namespace {
 static constexpr size_t kRandlen = NGTCP2_MIN_STATELESS_RESET_RANDLEN * 5;
 static constexpr size_t kMinStatelessResetLen = 41;
-static constexpr size_t kMaxFreeList = 100;
+static constexpr size_t kMaxFreeList = 1024;
 }  // namespace
 
 std::string PathDescriptor::ToString() const {
@@ -49,8 +50,11 @@ struct Packet::Data final : public MemoryRetainer {
 
   // The diagnostic_label_ is used only as a debugging tool when
   // logging debug information about the packet. It identifies
-  // the purpose of the packet.
-  const std::string diagnostic_label_;
+  // the purpose of the packet. Labels are always string literals.
+  std::string_view diagnostic_label_;
+
+  // Lengths of the individual datagrams when the packet carries a batch.
+  std::vector<size_t> segments_;
 
   void MemoryInfo(MemoryTracker* tracker) const override {
     tracker->TrackFieldWithSize("data", data_.length());
@@ -63,6 +67,21 @@ struct Packet::Data final : public MemoryRetainer {
     data_.AllocateSufficientStorage(length);
   }
 
+  // Storage that lives inline in Data, i.e. at most one path MTU worth, is
+  // kept when a packet goes back to the freelist so that steady state
+  // sending does not allocate.
+  bool IsReusable() const { return !data_.IsAllocated(); }
+
+  // Prepares recycled storage for a new packet of the given length.
+  // Returns false if the storage is too small.
+  bool Reset(size_t length, std::string_view diagnostic_label) {
+    if (length > data_.capacity()) return false;
+    data_.SetLength(length);
+    diagnostic_label_ = diagnostic_label;
+    segments_.clear();
+    return true;
+  }
+
   size_t length() const { return data_.length(); }
   operator uv_buf_t() {
     return uv_buf_init(reinterpret_cast<char*>(data_.out()), data_.length());
@@ -70,7 +89,12 @@ struct Packet::Data final : public MemoryRetainer {
   operator ngtcp2_vec() { return ngtcp2_vec{data_.out(), data_.length()}; }
 
   std::string ToString() const {
-    return diagnostic_label_ + ", " + std::to_string(length());
+    std::string res =
+        std::string(diagnostic_label_) + ", " + std::to_string(length());
+    if (segments_.size() > 1) {
+      res += " in " + std::to_string(segments_.size()) + " datagrams";
+    }
+    return res;
   }
 };
 
@@ -96,6 +120,30 @@ void Packet::Truncate(size_t len) {
   data_->data_.SetLength(len);
 }
 
+void Packet::AddSegment(size_t len) {
+  DCHECK(data_);
+  data_->segments_.push_back(len);
+}
+
+size_t Packet::segment_count() const {
+  if (!data_ || data_->segments_.empty()) return 1;
+  return data_->segments_.size();
+}
+
+std::vector<uv_buf_t> Packet::segments() const {
+  if (!data_ || data_->segments_.empty()) return {*this};
+  std::vector<uv_buf_t> bufs;
+  bufs.reserve(data_->segments_.size());
+  char* base = reinterpret_cast<char*>(data_->data_.out());
+  size_t offset = 0;
+  for (size_t len : data_->segments_) {
+    DCHECK_LE(offset + len, data_->length());
+    bufs.push_back(uv_buf_init(base + offset, len));
+    offset += len;
+  }
+  return bufs;
+}
+
 Local<FunctionTemplate> Packet::GetConstructorTemplate(Environment* env) {
   auto& state = BindingData::Get(env);
   Local<FunctionTemplate> tmpl = state.packet_constructor_template();
@@ -114,7 +162,8 @@ BaseObjectPtr<Packet> Packet::Create(Environment* env,
                                      const SocketAddress& destination,
                                      size_t length,
                                      const char* diagnostic_label) {
-  if (BindingData::Get(env).packet_freelist.empty()) {
+  auto& binding = BindingData::Get(env);
+  if (binding.packet_freelist.empty()) {
     Local<Object> obj;
     if (!GetConstructorTemplate(env)
              ->InstanceTemplate()
@@ -127,10 +176,13 @@ BaseObjectPtr<Packet> Packet::Create(Environment* env,
         env, listener, obj, destination, length, diagnostic_label);
   }
 
-  return FromFreeList(env,
-                      std::make_shared<Data>(length, diagnostic_label),
-                      listener,
-                      destination);
+  // Reuse the storage the recycled packet kept, if it is large enough.
+  auto recycled =
+      static_cast<Packet*>(binding.packet_freelist.back().get())->data_;
+  if (!recycled || !recycled->Reset(length, diagnostic_label)) {
+    recycled = std::make_shared<Data>(length, diagnostic_label);
+  }
+  return FromFreeList(env, std::move(recycled), listener, destination);
 }
 
 BaseObjectPtr<Packet> Packet::Clone() const {
@@ -211,7 +263,9 @@ void Packet::Done(int status) {
 
   Debug(this, "Returning packet to freelist");
   listener_ = nullptr;
-  data_.reset();
+  // Keep the storage for the next packet unless it is still shared with a
+  // clone or was allocated on the heap for a larger batch.
+  if (data_ && (data_.use_count() > 1 || !data_->IsReusable())) data_.reset();
   Reset();
   binding.packet_freelist.push_back(std::move(self));
 }
@@ -12,6 +12,7 @@
 #include <uv.h>
 #include <v8.h>
 #include <string>
+#include <vector>
 #include "bindingdata.h"
 #include "cid.h"
 #include "data.h"
@@ -89,6 +90,15 @@ class Packet final : public ReqWrap<uv_udp_send_t> {
   // tells us how many of the packets bytes were used.
   void Truncate(size_t len);
 
+  // A packet can also carry a batch of datagrams for the same destination
+  // laid out back to back in its storage. AddSegment() records the length
+  // of the next datagram in the batch. A packet without recorded segments
+  // is a single datagram.
+  void AddSegment(size_t len);
+  size_t segment_count() const;
+  // Returns one buffer per datagram carried by the packet.
+  std::vector<uv_buf_t> segments() const;
+
   static BaseObjectPtr<Packet> Create(
       Environment* env,
       Listener* listener,
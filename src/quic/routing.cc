@@ -0,0 +1,114 @@
+#if HAVE_OPENSSL && NODE_OPENSSL_HAS_QUIC
+
+#include "routing.h"
+#include <env-inl.h>
+#include <node_mutex.h>
+#include <node_sockaddr-inl.h>
+#include <util-inl.h>
+#include <uv.h>
+#include <v8.h>
+#include "endpoint.h"
+
+namespace node {
+
+using v8::ArrayBuffer;
+using v8::BackingStore;
+using v8::BackingStoreInitializationMode;
+
+namespace quic {
+
+namespace {
+// All groups in the process, by local address. Groups are owned by their
+// members, the map only holds weak references.
+Mutex groups_mutex;
+std::unordered_map<std::string, std::weak_ptr<RoutingGroup>> groups;
+}  // namespace
+
+RoutingGroup::RoutingGroup(std::string key) : key_(std::move(key)) {}
+
+RoutingGroup::~RoutingGroup() {
+  Mutex::ScopedLock lock(groups_mutex);
+  auto it = groups.find(key_);
+  if (it != groups.end() && it->second.expired()) groups.erase(it);
+}
+
+std::shared_ptr<RoutingGroup> RoutingGroup::Join(
+    const SocketAddress& local_address, uint8_t worker_id, Endpoint* endpoint) {
+  std::shared_ptr<RoutingGroup> group;
+  {
+    Mutex::ScopedLock lock(groups_mutex);
+    std::string key = local_address.ToString();
+    auto& entry = groups[key];
+    group = entry.lock();
+    if (!group) {
+      group = std::make_shared<RoutingGroup>(key);
+      entry = group;
+    }
+  }
+
+  Mutex::ScopedLock lock(group->mutex_);
+  if (!group->members_.emplace(worker_id, Member{endpoint->env(), endpoint})
+           .second) {
+    return nullptr;
+  }
+  return group;
+}
+
+void RoutingGroup::Leave(uint8_t worker_id, Endpoint* endpoint) {
+  Mutex::ScopedLock lock(mutex_);
+  auto it = members_.find(worker_id);
+  if (it != members_.end() && it->second.endpoint == endpoint)
+    members_.erase(it);
+}
+
+bool RoutingGroup::Forward(uint8_t worker_id,
+                           const CID& dcid,
+                           const Store& store,
+                           const SocketAddress& remote_address) {
+  if (dcid.length() < CID::kMinLength) return false;
+  uint8_t target = CID::Factory::RoutedWorkerId(dcid);
+  if (target == worker_id) return false;
+
+  Mutex::ScopedLock lock(mutex_);
+  auto it = members_.find(target);
+  if (it == members_.end()) return false;
+
+  // The packet is copied since the receive buffer belongs to this thread.
+  // The target is looked up again on its own thread, it may have left the
+  // group in the meantime.
+  ngtcp2_vec vec = store;
+  std::vector<uint8_t> data(vec.base, vec.base + vec.len);
+  it->second.env->SetImmediateThreadsafe(
+      [self = shared_from_this(),
+       target,
+       data = std::move(data),
+       remote_address](Environment* env) mutable {
+        self->Deliver(env, target, std::move(data), remote_address);
+      });
+  return true;
+}
+
+void RoutingGroup::Deliver(Environment* env,
+                           uint8_t worker_id,
+                           std::vector<uint8_t> data,
+                           const SocketAddress& remote_address) {
+  Endpoint* endpoint = nullptr;
+  {
+    Mutex::ScopedLock lock(mutex_);
+    auto it = members_.find(worker_id);
+    if (it == members_.end() || it->second.env != env) return;
+    endpoint = it->second.endpoint;
+  }
+
+  std::shared_ptr<BackingStore> backing = ArrayBuffer::NewBackingStore(
+      env->isolate(),
+      data.size(),
+      BackingStoreInitializationMode::kUninitialized);
+  memcpy(backing->Data(), data.data(), data.size());
+  endpoint->Receive(Store(std::move(backing), data.size()), remote_address);
+}
+
+}  // namespace quic
+}  // namespace node
+
+#endif  // HAVE_OPENSSL && NODE_OPENSSL_HAS_QUIC
@@ -0,0 +1,72 @@
+#pragma once
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+#if HAVE_OPENSSL && NODE_OPENSSL_HAS_QUIC
+
+#include <env.h>
+#include <node_mutex.h>
+#include <node_sockaddr.h>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "cid.h"
+#include "data.h"
+
+namespace node::quic {
+
+class Endpoint;
+
+// A RoutingGroup links the Endpoints of different threads that are bound to
+// the same local address with SO_REUSEPORT. The kernel spreads the packets
+// across the group by hashing the 4-tuple, so a packet can reach an Endpoint
+// that does not own its session, most commonly after the peer's address has
+// changed. Endpoints in a group issue CIDs that carry their worker id in the
+// first byte (see CID::Factory::Routed()), which lets the Endpoint that
+// received such a packet hand it over to the owner's thread.
+class RoutingGroup final : public std::enable_shared_from_this<RoutingGroup> {
+ public:
+  // Adds endpoint to the group of its bound local_address, creating the
+  // group if necessary. Returns nullptr if another member of the group
+  // already uses worker_id.
+  static std::shared_ptr<RoutingGroup> Join(const SocketAddress& local_address,
+                                            uint8_t worker_id,
+                                            Endpoint* endpoint);
+
+  // Removes endpoint, the member with worker_id. Must be called on the
+  // member's thread before the Endpoint goes away.
+  void Leave(uint8_t worker_id, Endpoint* endpoint);
+
+  // Passes the packet on to the member that issued dcid. Returns false if
+  // dcid was issued by worker_id itself or by no current member, in which
+  // case the caller keeps processing the packet.
+  bool Forward(uint8_t worker_id,
+               const CID& dcid,
+               const Store& store,
+               const SocketAddress& remote_address);
+
+  explicit RoutingGroup(std::string key);
+  ~RoutingGroup();
+  DISALLOW_COPY_AND_MOVE(RoutingGroup)
+
+ private:
+  struct Member {
+    Environment* env;
+    Endpoint* endpoint;
+  };
+
+  // Runs on the target member's thread.
+  void Deliver(Environment* env,
+               uint8_t worker_id,
+               std::vector<uint8_t> data,
+               const SocketAddress& remote_address);
+
+  const std::string key_;
+  Mutex mutex_;
+  std::unordered_map<uint8_t, Member> members_;
+};
+
+}  // namespace node::quic
+
+#endif  // HAVE_OPENSSL && NODE_OPENSSL_HAS_QUIC
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
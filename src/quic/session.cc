@@ -2294,12 +2294,16 @@ void Session::UpdateTimer() {
     return OnTimeout();
   }
 
-  auto timeout = (expiry - now) / NGTCP2_MILLISECONDS;
+  // The expiry includes the time at which ngtcp2's pacer allows the next
+  // packet to be sent, so the timer also drives the paced sending of stream
+  // data. It is rounded up since the timer only has millisecond resolution:
+  // firing early would just run SendPendingData() without being allowed to
+  // send anything, while ngtcp2 compensates for a late timer by allowing a
+  // slightly larger burst.
+  auto timeout =
+      (expiry - now + NGTCP2_MILLISECONDS - 1) / NGTCP2_MILLISECONDS;
   Debug(this, "Updating timeout to %zu milliseconds", timeout);
-
-  // If timeout is zero here, it means our timer is less than a millisecond
-  // off from expiry. Let's bump the timer to 1.
-  impl_->timer_.Update(timeout == 0 ? 1 : timeout);
+  impl_->timer_.Update(timeout);
 }
 
 void Session::DatagramStatus(uint64_t datagramId, quic::DatagramStatus status) {
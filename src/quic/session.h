@@ -72,11 +72,13 @@ class Session final : public AsyncWrap, private SessionTicket::AppData::Source {
     // Only relevant if the selected application supports headers.
     uint64_t max_header_length = DEFAULT_MAX_HEADER_LENGTH;
 
-    // HTTP/3 specific options.
+    // HTTP/3 specific options. The QPACK dynamic table is enabled by
+    // default, like the HPACK one of HTTP/2, so that header fields repeated
+    // across requests are not sent as literals every time.
     uint64_t max_field_section_size = 0;
-    uint64_t qpack_max_dtable_capacity = 0;
-    uint64_t qpack_encoder_max_dtable_capacity = 0;
-    uint64_t qpack_blocked_streams = 0;
+    uint64_t qpack_max_dtable_capacity = 4096;
+    uint64_t qpack_encoder_max_dtable_capacity = 4096;
+    uint64_t qpack_blocked_streams = 100;
 
     bool enable_connect_protocol = true;
     bool enable_datagrams = true;
@@ -171,10 +173,11 @@ class Session final : public AsyncWrap, private SessionTicket::AppData::Source {
 
     // There are several common congestion control algorithms that ngtcp2 uses
     // to determine how it manages the flow control window: RENO, CUBIC, and
-    // BBR. The details of how each works is not relevant here. The choice of
-    // which to use by default is arbitrary and we can choose whichever we'd
-    // like. Additional performance profiling will be needed to determine which
-    // is the better of the two for our needs.
+    // BBR (which is BBRv2 in ngtcp2). The details of how each works is not
+    // relevant here. The choice of which to use by default is arbitrary and we
+    // can choose whichever we'd like. Additional performance profiling will be
+    // needed to determine which is the better of the two for our needs. All of
+    // them pace the packets sent, see Session::UpdateTimer().
     ngtcp2_cc_algo cc_algorithm = CC_ALGO_CUBIC;
 
     void MemoryInfo(MemoryTracker* tracker) const override;
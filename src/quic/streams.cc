@@ -429,7 +429,7 @@ class Stream::Outbound final : public MemoryRetainer {
     // otherwise, return whatever is in the uncommitted queue.
     if (eos_) {
       if (uncommitted_ > 0) {
-        PullUncommitted(std::move(next));
+        PullUncommitted(std::move(next), data, count);
         return bob::Status::STATUS_CONTINUE;
       }
       std::move(next)(bob::Status::STATUS_EOS, nullptr, 0, [](int) {});
@@ -441,7 +441,7 @@ class Stream::Outbound final : public MemoryRetainer {
     // uncommitted bytes currently in the queue rather than reading more from
     // the queue.
     if (uncommitted_ >= kDefaultMaxPacketLength) {
-      PullUncommitted(std::move(next));
+      PullUncommitted(std::move(next), data, count);
       return bob::Status::STATUS_CONTINUE;
     }
 
@@ -539,7 +539,7 @@ class Stream::Outbound final : public MemoryRetainer {
         // If the read returns eos, and there are uncommitted bytes in the
         // queue, we'll set eos_ to true and return the current set of
         // uncommitted bytes.
-        PullUncommitted(std::move(next));
+        PullUncommitted(std::move(next), data, count);
         return bob::STATUS_CONTINUE;
       }
       // If the read returns eos, and there are no uncommitted bytes in the
@@ -552,7 +552,7 @@ class Stream::Outbound final : public MemoryRetainer {
       // If the read returns blocked, and there are uncommitted bytes in the
       // queue, we'll return the current set of uncommitted bytes.
       if (uncommitted_ > 0) {
-        PullUncommitted(std::move(next));
+        PullUncommitted(std::move(next), data, count);
         return bob::Status::STATUS_CONTINUE;
       }
       // If the read returns blocked, and there are no uncommitted bytes in the
@@ -571,7 +571,7 @@ class Stream::Outbound final : public MemoryRetainer {
     }
 
     DCHECK_EQ(ret, bob::Status::STATUS_CONTINUE);
-    PullUncommitted(std::move(next));
+    PullUncommitted(std::move(next), data, count);
     return bob::Status::STATUS_CONTINUE;
   }
 
@@ -591,20 +591,30 @@ class Stream::Outbound final : public MemoryRetainer {
     ~OnComplete() { std::move(done)(0); }
   };
 
-  void PullUncommitted(bob::Next<ngtcp2_vec> next) {
+  // The vectors point into the buffers held by the entries, so the data is
+  // never copied before it is written into a packet. If the caller provided
+  // the storage for the vectors, they are written there directly, as many of
+  // them as fit.
+  void PullUncommitted(bob::Next<ngtcp2_vec> next,
+                       ngtcp2_vec* data,
+                       size_t count) {
     MaybeStackBuffer<ngtcp2_vec, 16> chunks;
-    chunks.AllocateSufficientStorage(count_);
+    if (data == nullptr || count == 0) {
+      chunks.AllocateSufficientStorage(count_);
+      data = chunks.out();
+      count = count_;
+    }
     auto head = commit_head_;
     size_t n = 0;
-    while (head != nullptr && n < count_) {
+    while (head != nullptr && n < count) {
       // There might only be one byte here but there should never be zero.
       DCHECK_LT(head->offset, head->buf.len);
-      chunks[n].base = head->buf.base + head->offset;
-      chunks[n].len = head->buf.len - head->offset;
+      data[n].base = head->buf.base + head->offset;
+      data[n].len = head->buf.len - head->offset;
       head = head->next.get();
       n++;
     }
-    std::move(next)(bob::Status::STATUS_CONTINUE, chunks.out(), n, [](int) {});
+    std::move(next)(bob::Status::STATUS_CONTINUE, data, n, [](int) {});
   }
 
   void MarkErrored() {
@@ -28,6 +28,8 @@
 #include "string_bytes.h"
 #include "util-inl.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <cstring>
 #include "nbytes.h"
 
@@ -53,45 +55,56 @@ using v8::Object;
 using v8::String;
 using v8::Value;
 
-void SyncProcessOutputBuffer::OnAlloc(size_t suggested_size,
-                                      uv_buf_t* buf) const {
-  if (used() == kBufferSize)
-    *buf = uv_buf_init(nullptr, 0);
-  else
-    *buf = uv_buf_init(data_ + used(), available());
+SyncProcessOutputBuffer::~SyncProcessOutputBuffer() {
+  free(data_);
 }
 
 
-void SyncProcessOutputBuffer::OnRead(const uv_buf_t* buf, size_t nread) {
-  // If we hand out the same chunk twice, this should catch it.
-  CHECK_EQ(buf->base, data_ + used());
-  used_ += static_cast<unsigned int>(nread);
-}
-
+void SyncProcessOutputBuffer::OnAlloc(size_t limit, uv_buf_t* buf) {
+  if (used_ == capacity_) {
+    size_t capacity = capacity_ == 0 ? kInitialSize : capacity_ * 2;
+    if (capacity - used_ > limit)
+      capacity = used_ + limit;
+    char* data = UncheckedRealloc(data_, capacity);
+    if (data == nullptr) {
+      // libuv reports UV_ENOBUFS to the read callback.
+      *buf = uv_buf_init(nullptr, 0);
+      return;
+    }
+    data_ = data;
+    capacity_ = capacity;
+  }
 
-size_t SyncProcessOutputBuffer::Copy(char* dest) const {
-  if (dest != nullptr) memcpy(dest, data_, used());
-  return used();
+  // Use unsigned int because that's what `uv_buf_init` takes.
+  size_t available = std::min<size_t>(capacity_ - used_, 1u << 30);
+  *buf = uv_buf_init(data_ + used_, static_cast<unsigned int>(available));
 }
 
 
-unsigned int SyncProcessOutputBuffer::available() const {
-  return sizeof data_ - used();
+void SyncProcessOutputBuffer::OnRead(const uv_buf_t* buf, size_t nread) {
+  // If we hand out the same chunk twice, this should catch it.
+  CHECK_EQ(buf->base, data_ + used_);
+  CHECK_LE(used_ + nread, capacity_);
+  used_ += nread;
 }
 
 
-unsigned int SyncProcessOutputBuffer::used() const {
+size_t SyncProcessOutputBuffer::used() const {
   return used_;
 }
 
 
-SyncProcessOutputBuffer* SyncProcessOutputBuffer::next() const {
-  return next_;
-}
-
-
-void SyncProcessOutputBuffer::set_next(SyncProcessOutputBuffer* next) {
-  next_ = next;
+char* SyncProcessOutputBuffer::Release() {
+  if (used_ > 0 && used_ < capacity_) {
+    // Return the slack to the allocator. If that fails, the larger
+    // allocation is still valid.
+    char* data = UncheckedRealloc(data_, used_);
+    if (data != nullptr) data_ = data;
+  }
+  char* data = data_;
+  data_ = nullptr;
+  capacity_ = used_ = 0;
+  return data;
 }
 
 
@@ -104,9 +117,6 @@ SyncProcessStdioPipe::SyncProcessStdioPipe(SyncProcessRunner* process_handler,
       writable_(writable),
       input_buffer_(input_buffer),
 
-      first_output_buffer_(nullptr),
-      last_output_buffer_(nullptr),
-
       uv_pipe_(),
       write_req_(),
       shutdown_req_(),
@@ -118,14 +128,6 @@ SyncProcessStdioPipe::SyncProcessStdioPipe(SyncProcessRunner* process_handler,
 
 SyncProcessStdioPipe::~SyncProcessStdioPipe() {
   CHECK(lifecycle_ == kUninitialized || lifecycle_ == kClosed);
-
-  SyncProcessOutputBuffer* buf;
-  SyncProcessOutputBuffer* next;
-
-  for (buf = first_output_buffer_; buf != nullptr; buf = next) {
-    next = buf->next();
-    delete buf;
-  }
 }
 
 
@@ -186,15 +188,11 @@ void SyncProcessStdioPipe::Close() {
   lifecycle_ = kClosing;
 }
 
-MaybeLocal<Object> SyncProcessStdioPipe::GetOutputAsBuffer(
-    Environment* env) const {
-  size_t length = OutputLength();
-  Local<Object> js_buffer;
-  if (!Buffer::New(env, length).ToLocal(&js_buffer)) {
-    return MaybeLocal<Object>();
-  }
-  CopyOutput(Buffer::Data(js_buffer));
-  return js_buffer;
+MaybeLocal<Object> SyncProcessStdioPipe::GetOutputAsBuffer(Environment* env) {
+  size_t length = output_.used();
+  if (length == 0)
+    return Buffer::New(env, 0);
+  return Buffer::New(env, output_.Release(), length);
 }
 
 bool SyncProcessStdioPipe::readable() const {
@@ -236,45 +234,15 @@ uv_handle_t* SyncProcessStdioPipe::uv_handle() const {
 }
 
 
-size_t SyncProcessStdioPipe::OutputLength() const {
-  SyncProcessOutputBuffer* buf;
-  size_t size = 0;
-
-  for (buf = first_output_buffer_; buf != nullptr; buf = buf->next())
-    size += buf->used();
-
-  return size;
-}
-
-
-void SyncProcessStdioPipe::CopyOutput(char* dest) const {
-  SyncProcessOutputBuffer* buf;
-  size_t offset = 0;
-
-  for (buf = first_output_buffer_; buf != nullptr; buf = buf->next())
-    offset += buf->Copy(dest + offset);
-}
-
-
 void SyncProcessStdioPipe::OnAlloc(size_t suggested_size, uv_buf_t* buf) {
   // This function assumes that libuv will never allocate two buffers for the
   // same stream at the same time. There's an assert in
   // SyncProcessOutputBuffer::OnRead that would fail if this assumption was
   // ever violated.
-
-  if (last_output_buffer_ == nullptr) {
-    // Allocate the first capture buffer.
-    first_output_buffer_ = new SyncProcessOutputBuffer();
-    last_output_buffer_ = first_output_buffer_;
-
-  } else if (last_output_buffer_->available() == 0) {
-    // The current capture buffer is full so get us a new one.
-    SyncProcessOutputBuffer* buf = new SyncProcessOutputBuffer();
-    last_output_buffer_->set_next(buf);
-    last_output_buffer_ = buf;
-  }
-
-  last_output_buffer_->OnAlloc(suggested_size, buf);
+  //
+  // Leave room for one byte beyond maxBuffer so that overflow is detected.
+  size_t remaining = process_handler_->RemainingBufferSize();
+  output_.OnAlloc(remaining == SIZE_MAX ? remaining : remaining + 1, buf);
 }
 
 
@@ -288,8 +256,10 @@ void SyncProcessStdioPipe::OnRead(const uv_buf_t* buf, ssize_t nread) {
     uv_read_stop(uv_stream());
 
   } else {
-    last_output_buffer_->OnRead(buf, nread);
-    process_handler_->IncrementBufferSizeAndCheckOverflow(nread);
+    // Output beyond maxBuffer is dropped, not copied out later.
+    output_.OnRead(buf,
+                   process_handler_->IncrementBufferSizeAndCheckOverflow(
+                       static_cast<size_t>(nread)));
   }
 }
 
@@ -641,13 +611,28 @@ void SyncProcessRunner::Kill() {
 }
 
 
-void SyncProcessRunner::IncrementBufferSizeAndCheckOverflow(ssize_t length) {
-  buffered_output_size_ += length;
+size_t SyncProcessRunner::RemainingBufferSize() const {
+  if (!(max_buffer_ > 0) || max_buffer_ >= static_cast<double>(SIZE_MAX))
+    return SIZE_MAX;
+  size_t max_buffer = static_cast<size_t>(max_buffer_);
+  return buffered_output_size_ < max_buffer
+             ? max_buffer - buffered_output_size_
+             : 0;
+}
+
 
-  if (max_buffer_ > 0 && buffered_output_size_ > max_buffer_) {
-    SetError(UV_ENOBUFS);
-    Kill();
+size_t SyncProcessRunner::IncrementBufferSizeAndCheckOverflow(size_t length) {
+  size_t remaining = RemainingBufferSize();
+  if (length <= remaining) {
+    buffered_output_size_ += length;
+    return length;
   }
+
+  // Keep the output up to maxBuffer and drop the rest.
+  buffered_output_size_ += remaining;
+  SetError(UV_ENOBUFS);
+  Kill();
+  return remaining;
 }
 
 
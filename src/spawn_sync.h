@@ -36,29 +36,33 @@ class SyncProcessStdioPipe;
 class SyncProcessRunner;
 
 
+// Captures the output of one stdio pipe in a single malloc()ed buffer that
+// grows geometrically. The buffer is handed to the resulting JS Buffer as
+// is, so there is no final copy.
 class SyncProcessOutputBuffer {
-  static const unsigned int kBufferSize = 65536;
+  static const size_t kInitialSize = 65536;
 
  public:
   inline SyncProcessOutputBuffer() = default;
+  inline ~SyncProcessOutputBuffer();
 
-  inline void OnAlloc(size_t suggested_size, uv_buf_t* buf) const;
-  inline void OnRead(const uv_buf_t* buf, size_t nread);
+  SyncProcessOutputBuffer(const SyncProcessOutputBuffer&) = delete;
+  SyncProcessOutputBuffer& operator=(const SyncProcessOutputBuffer&) = delete;
 
-  inline size_t Copy(char* dest) const;
+  // `limit` is the number of further bytes worth keeping; the buffer never
+  // grows past that.
+  inline void OnAlloc(size_t limit, uv_buf_t* buf);
+  inline void OnRead(const uv_buf_t* buf, size_t nread);
 
-  inline unsigned int available() const;
-  inline unsigned int used() const;
+  inline size_t used() const;
 
-  inline SyncProcessOutputBuffer* next() const;
-  inline void set_next(SyncProcessOutputBuffer* next);
+  // Shrinks the allocation to used() and transfers ownership to the caller.
+  inline char* Release();
 
  private:
-  // Use unsigned int because that's what `uv_buf_init` takes.
-  mutable char data_[kBufferSize];
-  unsigned int used_ = 0;
-
-  SyncProcessOutputBuffer* next_ = nullptr;
+  char* data_ = nullptr;
+  size_t capacity_ = 0;
+  size_t used_ = 0;
 };
 
 
@@ -82,7 +86,7 @@ class SyncProcessStdioPipe {
   int Start();
   void Close();
 
-  v8::MaybeLocal<v8::Object> GetOutputAsBuffer(Environment* env) const;
+  v8::MaybeLocal<v8::Object> GetOutputAsBuffer(Environment* env);
 
   inline bool readable() const;
   inline bool writable() const;
@@ -93,9 +97,6 @@ class SyncProcessStdioPipe {
   inline uv_handle_t* uv_handle() const;
 
  private:
-  inline size_t OutputLength() const;
-  inline void CopyOutput(char* dest) const;
-
   inline void OnAlloc(size_t suggested_size, uv_buf_t* buf);
   inline void OnRead(const uv_buf_t* buf, ssize_t nread);
   inline void OnWriteDone(int result);
@@ -120,8 +121,7 @@ class SyncProcessStdioPipe {
   bool writable_;
   uv_buf_t input_buffer_;
 
-  SyncProcessOutputBuffer* first_output_buffer_;
-  SyncProcessOutputBuffer* last_output_buffer_;
+  SyncProcessOutputBuffer output_;
 
   mutable uv_pipe_t uv_pipe_;
   uv_write_t write_req_;
@@ -162,7 +162,8 @@ class SyncProcessRunner {
   void CloseKillTimer();
 
   void Kill();
-  void IncrementBufferSizeAndCheckOverflow(ssize_t length);
+  size_t RemainingBufferSize() const;
+  size_t IncrementBufferSizeAndCheckOverflow(size_t length);
 
   void OnExit(int64_t exit_status, int term_signal);
   void OnKillTimerTimeout();
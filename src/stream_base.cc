@@ -32,7 +32,9 @@ using v8::HandleScope;
 using v8::Integer;
 using v8::Isolate;
 using v8::Local;
+using v8::LocalVector;
 using v8::MaybeLocal;
+using v8::NewStringType;
 using v8::Object;
 using v8::PropertyAttribute;
 using v8::ReadOnly;
@@ -161,7 +163,13 @@ int StreamBase::UseUserBuffer(const FunctionCallbackInfo<Value>& args) {
   CHECK(Buffer::HasInstance(args[0]));
 
   uv_buf_t buf = uv_buf_init(Buffer::Data(args[0]), Buffer::Length(args[0]));
-  PushStreamListener(new CustomBufferJSListener(buf));
+  bool ring = args[1]->IsTrue();
+  PushStreamListener(new CustomBufferJSListener(buf, ring));
+  return 0;
+}
+
+int StreamBase::UseLineReader(const FunctionCallbackInfo<Value>& args) {
+  PushStreamListener(new LineSplittingJSListener());
   return 0;
 }
 
@@ -310,28 +318,83 @@ int StreamBase::WriteBuffer(const FunctionCallbackInfo<Value>& args) {
   buf.len = Buffer::Length(args[1]);
 
   uv_stream_t* send_handle = nullptr;
+  int err = GetSendHandle(args[2], req_wrap_obj, &send_handle);
+  if (err != 0) return err;
 
-  if (args[2]->IsObject() && IsIPCPipe()) {
-    Local<Object> send_handle_obj = args[2].As<Object>();
+  StreamWriteResult res = Write(&buf, 1, send_handle, req_wrap_obj);
+  SetWriteResult(res);
 
-    HandleWrap* wrap;
-    ASSIGN_OR_RETURN_UNWRAP(&wrap, send_handle_obj, UV_EINVAL);
-    send_handle = reinterpret_cast<uv_stream_t*>(wrap->GetHandle());
-    // Reference LibuvStreamWrap instance to prevent it from being garbage
-    // collected before `AfterWrite` is called.
-    if (req_wrap_obj->Set(env->context(),
-                          env->handle_string(),
-                          send_handle_obj).IsNothing()) {
-      return -1;
-    }
+  return res.err;
+}
+
+int StreamBase::WriteFramed(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Isolate* isolate = env->isolate();
+  Local<Context> context = env->context();
+
+  CHECK(args[0]->IsObject());
+  CHECK(args[1]->IsArray());
+
+  Local<Object> req_wrap_obj = args[0].As<Object>();
+  Local<Array> messages = args[1].As<Array>();
+  size_t count = messages->Length();
+  CHECK_GT(count, 0);
+
+  constexpr size_t kFrameHeaderSize = sizeof(uint32_t);
+  // All headers share one allocation that lives as long as the write.
+  std::unique_ptr<BackingStore> headers = ArrayBuffer::NewBackingStore(
+      isolate,
+      count * kFrameHeaderSize,
+      BackingStoreInitializationMode::kUninitialized);
+  uint8_t* header = static_cast<uint8_t*>(headers->Data());
+  MaybeStackBuffer<uv_buf_t, 32> bufs(count * 2);
+
+  for (size_t i = 0; i < count; i++, header += kFrameHeaderSize) {
+    Local<Value> message;
+    if (!messages->Get(context, i).ToLocal(&message)) return -1;
+    CHECK(Buffer::HasInstance(message));
+    size_t length = Buffer::Length(message);
+    if (length > UINT32_MAX) return UV_ENOBUFS;
+    header[0] = static_cast<uint8_t>(length >> 24);
+    header[1] = static_cast<uint8_t>(length >> 16);
+    header[2] = static_cast<uint8_t>(length >> 8);
+    header[3] = static_cast<uint8_t>(length);
+    bufs[i * 2] = uv_buf_init(reinterpret_cast<char*>(header),
+                              kFrameHeaderSize);
+    bufs[i * 2 + 1] = uv_buf_init(Buffer::Data(message), length);
   }
 
-  StreamWriteResult res = Write(&buf, 1, send_handle, req_wrap_obj);
-  SetWriteResult(res);
+  uv_stream_t* send_handle = nullptr;
+  int err = GetSendHandle(args[2], req_wrap_obj, &send_handle);
+  if (err != 0) return err;
 
+  StreamWriteResult res =
+      Write(*bufs, bufs.length(), send_handle, req_wrap_obj);
+  SetWriteResult(res);
+  if (res.wrap != nullptr) res.wrap->SetBackingStore(std::move(headers));
   return res.err;
 }
 
+int StreamBase::GetSendHandle(Local<Value> value,
+                              Local<Object> req_wrap_obj,
+                              uv_stream_t** send_handle) {
+  if (!value->IsObject() || !IsIPCPipe()) return 0;
+  Environment* env = stream_env();
+  Local<Object> send_handle_obj = value.As<Object>();
+
+  HandleWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap, send_handle_obj, UV_EINVAL);
+  *send_handle = reinterpret_cast<uv_stream_t*>(wrap->GetHandle());
+  // Reference LibuvStreamWrap instance to prevent it from being garbage
+  // collected before `AfterWrite` is called.
+  if (req_wrap_obj->Set(env->context(),
+                        env->handle_string(),
+                        send_handle_obj).IsNothing()) {
+    return -1;
+  }
+  return 0;
+}
+
 
 template <enum encoding enc>
 int StreamBase::WriteString(const FunctionCallbackInfo<Value>& args) {
@@ -462,12 +525,26 @@ MaybeLocal<Value> StreamBase::CallJSOnreadMethod(ssize_t nread,
     }
   }
 
+  return CallJSOnread(
+      nread,
+      offset,
+      ab.IsEmpty() ? Undefined(env->isolate()).As<Value>() : ab.As<Value>());
+}
+
+MaybeLocal<Value> StreamBase::CallJSOnreadMethodWithLines(ssize_t nread,
+                                                          Local<Array> lines) {
+  DCHECK_EQ(static_cast<int32_t>(nread), nread);
+  return CallJSOnread(nread, 0, lines);
+}
+
+MaybeLocal<Value> StreamBase::CallJSOnread(ssize_t nread,
+                                           size_t offset,
+                                           Local<Value> data) {
+  Environment* env = env_;
   env->stream_base_state()[kReadBytesOrError] = static_cast<int32_t>(nread);
   env->stream_base_state()[kArrayBufferOffset] = offset;
 
-  Local<Value> argv[] = {
-    ab.IsEmpty() ? Undefined(env->isolate()).As<Value>() : ab.As<Value>()
-  };
+  Local<Value> argv[] = {data};
 
   AsyncWrap* wrap = GetAsyncWrap();
   CHECK_NOT_NULL(wrap);
@@ -569,8 +646,11 @@ void StreamBase::AddMethods(IsolateData* isolate_data,
   SetProtoMethod(isolate, t, "shutdown", JSMethod<&StreamBase::Shutdown>);
   SetProtoMethod(
       isolate, t, "useUserBuffer", JSMethod<&StreamBase::UseUserBuffer>);
+  SetProtoMethod(
+      isolate, t, "useLineReader", JSMethod<&StreamBase::UseLineReader>);
   SetProtoMethod(isolate, t, "writev", JSMethod<&StreamBase::Writev>);
   SetProtoMethod(isolate, t, "writeBuffer", JSMethod<&StreamBase::WriteBuffer>);
+  SetProtoMethod(isolate, t, "writeFramed", JSMethod<&StreamBase::WriteFramed>);
   SetProtoMethod(isolate,
                  t,
                  "writeAsciiString",
@@ -609,8 +689,10 @@ void StreamBase::RegisterExternalReferences(
   registry->Register(JSMethod<&StreamBase::ReadStopJS>);
   registry->Register(JSMethod<&StreamBase::Shutdown>);
   registry->Register(JSMethod<&StreamBase::UseUserBuffer>);
+  registry->Register(JSMethod<&StreamBase::UseLineReader>);
   registry->Register(JSMethod<&StreamBase::Writev>);
   registry->Register(JSMethod<&StreamBase::WriteBuffer>);
+  registry->Register(JSMethod<&StreamBase::WriteFramed>);
   registry->Register(JSMethod<&StreamBase::WriteString<ASCII>>);
   registry->Register(JSMethod<&StreamBase::WriteString<UTF8>>);
   registry->Register(JSMethod<&StreamBase::WriteString<UCS2>>);
@@ -717,9 +799,47 @@ void EmitToJSStreamListener::OnStreamRead(ssize_t nread, const uv_buf_t& buf_) {
 
 
 uv_buf_t CustomBufferJSListener::OnStreamAlloc(size_t suggested_size) {
-  return buffer_;
+  if (!ring_) return buffer_;
+
+  size_t offset = pending_offset_ + pending_length_;
+  // Wrap around once the rest of the buffer is smaller than what the stream
+  // would like to read, unless nothing has been read into the buffer yet.
+  if (buffer_.len - offset < suggested_size && offset > 0) {
+    FlushRingReads();
+    pending_offset_ = 0;
+    offset = 0;
+  }
+  return uv_buf_init(buffer_.base + offset,
+                     static_cast<unsigned int>(buffer_.len - offset));
 }
 
+void CustomBufferJSListener::SetBuffer(Local<Value> next_buf) {
+  buffer_.base = Buffer::Data(next_buf);
+  buffer_.len = Buffer::Length(next_buf);
+  pending_offset_ = 0;
+  pending_length_ = 0;
+}
+
+void CustomBufferJSListener::FlushRingReads() {
+  if (pending_length_ == 0 || stream_ == nullptr) return;
+
+  StreamBase* stream = static_cast<StreamBase*>(stream_);
+  Environment* env = stream->stream_env();
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+
+  size_t offset = pending_offset_;
+  size_t length = pending_length_;
+  pending_offset_ += length;
+  pending_length_ = 0;
+
+  MaybeLocal<Value> ret = stream->CallJSOnreadMethod(
+      length, Local<ArrayBuffer>(), offset, StreamBase::SKIP_NREAD_CHECKS);
+  Local<Value> next_buf_v;
+  if (ret.ToLocal(&next_buf_v) && !next_buf_v->IsUndefined()) {
+    SetBuffer(next_buf_v);
+  }
+}
 
 void CustomBufferJSListener::OnStreamRead(ssize_t nread, const uv_buf_t& buf) {
   CHECK_NOT_NULL(stream_);
@@ -729,6 +849,27 @@ void CustomBufferJSListener::OnStreamRead(ssize_t nread, const uv_buf_t& buf) {
   HandleScope handle_scope(env->isolate());
   Context::Scope context_scope(env->context());
 
+  if (ring_) {
+    if (nread > 0) {
+      CHECK_EQ(buf.base, buffer_.base + pending_offset_ + pending_length_);
+      pending_length_ += nread;
+      if (!flush_scheduled_) {
+        flush_scheduled_ = true;
+        BaseObjectPtr<AsyncWrap> strong_ref{stream->GetAsyncWrap()};
+        env->SetImmediate([this, strong_ref](Environment* env) {
+          flush_scheduled_ = false;
+          FlushRingReads();
+        });
+      }
+      return;
+    }
+    // Pass along what has been read before the error or EOF.
+    FlushRingReads();
+    if (nread == 0) return;
+    stream->CallJSOnreadMethod(nread, Local<ArrayBuffer>());
+    return;
+  }
+
   // In the case that there's an error and buf is null, return immediately.
   // This can happen on unices when POLLHUP is received and UV_EOF is returned
   // or when getting an error while performing a UV_HANDLE_ZERO_READ on Windows.
@@ -745,12 +886,79 @@ void CustomBufferJSListener::OnStreamRead(ssize_t nread, const uv_buf_t& buf) {
                              StreamBase::SKIP_NREAD_CHECKS);
   Local<Value> next_buf_v;
   if (ret.ToLocal(&next_buf_v) && !next_buf_v->IsUndefined()) {
-    buffer_.base = Buffer::Data(next_buf_v);
-    buffer_.len = Buffer::Length(next_buf_v);
+    SetBuffer(next_buf_v);
   }
 }
 
 
+uv_buf_t LineSplittingJSListener::OnStreamAlloc(size_t suggested_size) {
+  if (suggested_size > buffer_size_) {
+    buffer_ = std::make_unique<char[]>(suggested_size);
+    buffer_size_ = suggested_size;
+  }
+  return uv_buf_init(buffer_.get(), buffer_size_);
+}
+
+void LineSplittingJSListener::OnStreamRead(ssize_t nread,
+                                           const uv_buf_t& buf) {
+  CHECK_NOT_NULL(stream_);
+
+  StreamBase* stream = static_cast<StreamBase*>(stream_);
+  Environment* env = stream->stream_env();
+  Isolate* isolate = env->isolate();
+  HandleScope handle_scope(isolate);
+  Context::Scope context_scope(env->context());
+
+  auto to_string = [&](std::string_view line) {
+    if (line.ends_with('\r')) line.remove_suffix(1);
+    return String::NewFromUtf8(
+        isolate, line.data(), NewStringType::kNormal, line.size());
+  };
+
+  if (nread <= 0) {
+    if (nread == 0) return;
+    // Pass along the last line if the data does not end with a line break.
+    if (nread == UV_EOF && !partial_line_.empty()) {
+      std::string last_line = std::move(partial_line_);
+      partial_line_.clear();
+      Local<Value> line;
+      if (!to_string(last_line).ToLocal(&line) ||
+          stream
+              ->CallJSOnreadMethodWithLines(last_line.size(),
+                                           Array::New(isolate, &line, 1))
+              .IsEmpty()) {
+        return;
+      }
+    }
+    stream->CallJSOnreadMethod(nread, Local<ArrayBuffer>());
+    return;
+  }
+
+  CHECK_EQ(buf.base, buffer_.get());
+  std::string_view data(buf.base, nread);
+  LocalVector<Value> lines(isolate);
+  size_t start = 0;
+  size_t end;
+  while ((end = data.find('\n', start)) != std::string_view::npos) {
+    std::string_view line = data.substr(start, end - start);
+    if (!partial_line_.empty()) {
+      partial_line_.append(line);
+      line = partial_line_;
+    }
+    Local<String> str;
+    if (!to_string(line).ToLocal(&str)) return;
+    lines.push_back(str);
+    partial_line_.clear();
+    start = end + 1;
+  }
+  partial_line_.append(data.substr(start));
+  if (lines.empty()) return;
+
+  stream->CallJSOnreadMethodWithLines(
+      nread, Array::New(isolate, lines.data(), lines.size()));
+}
+
+
 void ReportWritesToJSStreamListener::OnStreamAfterReqFinished(
     StreamReq* req_wrap, int status) {
   StreamBase* stream = static_cast<StreamBase*>(stream_);
@@ -203,16 +203,53 @@ class EmitToJSStreamListener : public ReportWritesToJSStreamListener {
 
 // An alternative listener that uses a custom, user-provided buffer
 // for reading data.
+//
+// In ring mode, successive reads go into successive regions of the buffer,
+// and JS is called once per event loop iteration with the offset and length
+// of everything that was read since the last call, instead of once per read.
+// Once the space at the end of the buffer runs low, the data read so far is
+// passed to JS and reading wraps around to the start of the buffer. As in the
+// default mode, JS has to consume the data before its onread callback returns.
 class CustomBufferJSListener : public ReportWritesToJSStreamListener {
  public:
   uv_buf_t OnStreamAlloc(size_t suggested_size) override;
   void OnStreamRead(ssize_t nread, const uv_buf_t& buf) override;
   void OnStreamDestroy() override { delete this; }
 
-  explicit CustomBufferJSListener(uv_buf_t buffer) : buffer_(buffer) {}
+  explicit CustomBufferJSListener(uv_buf_t buffer, bool ring = false)
+      : buffer_(buffer), ring_(ring) {}
 
  private:
+  // Calls JS with the data read in ring mode that has not been passed to JS
+  // yet, if any.
+  void FlushRingReads();
+  void SetBuffer(v8::Local<v8::Value> next_buf);
+
   uv_buf_t buffer_;
+  bool ring_;
+  // The region of buffer_ that holds data that has not been passed to JS yet.
+  size_t pending_offset_ = 0;
+  size_t pending_length_ = 0;
+  bool flush_scheduled_ = false;
+};
+
+
+// A listener that splits what is read into lines and passes each read to JS
+// as an array of strings instead of an ArrayBuffer, so that line-by-line
+// iteration does not have to allocate a Buffer per chunk and split it in JS.
+// All reads go into one native buffer that is reused. A line that is not
+// complete at the end of a read is kept until a later read completes it, or
+// passed along on EOF. Lines end at "\n" or "\r\n", which are stripped.
+class LineSplittingJSListener : public ReportWritesToJSStreamListener {
+ public:
+  uv_buf_t OnStreamAlloc(size_t suggested_size) override;
+  void OnStreamRead(ssize_t nread, const uv_buf_t& buf) override;
+  void OnStreamDestroy() override { delete this; }
+
+ private:
+  std::unique_ptr<char[]> buffer_;
+  size_t buffer_size_ = 0;
+  std::string partial_line_;
 };
 
 
@@ -332,6 +369,10 @@ class StreamBase : public StreamResource {
       v8::Local<v8::ArrayBuffer> ab,
       size_t offset = 0,
       StreamBaseJSChecks checks = DONT_SKIP_NREAD_CHECKS);
+  // Like CallJSOnreadMethod(), passing an array of the lines that were read,
+  // see LineSplittingJSListener.
+  v8::MaybeLocal<v8::Value> CallJSOnreadMethodWithLines(
+      ssize_t nread, v8::Local<v8::Array> lines);
 
   // This is named `stream_env` to avoid name clashes, because a lot of
   // subclasses are also `BaseObject`s.
@@ -385,9 +426,22 @@ class StreamBase : public StreamResource {
   int Shutdown(const v8::FunctionCallbackInfo<v8::Value>& args);
   int Writev(const v8::FunctionCallbackInfo<v8::Value>& args);
   int WriteBuffer(const v8::FunctionCallbackInfo<v8::Value>& args);
+  // writeFramed(req, messages[, handle]) writes a batch of buffers as one
+  // write, each preceded by its length as a big-endian uint32, the framing
+  // used by IPC channels with `serialization: 'advanced'`. As with writev(),
+  // the payloads are not copied and the caller keeps them alive until the
+  // write completes. An optional handle is sent along with the batch.
+  int WriteFramed(const v8::FunctionCallbackInfo<v8::Value>& args);
   template <enum encoding enc>
   int WriteString(const v8::FunctionCallbackInfo<v8::Value>& args);
   int UseUserBuffer(const v8::FunctionCallbackInfo<v8::Value>& args);
+  // useLineReader() makes the stream pass arrays of lines to onread, see
+  // LineSplittingJSListener.
+  int UseLineReader(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  int GetSendHandle(v8::Local<v8::Value> value,
+                    v8::Local<v8::Object> req_wrap_obj,
+                    uv_stream_t** send_handle);
 
   static void GetFD(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void GetExternal(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -413,6 +467,9 @@ class StreamBase : public StreamResource {
   EmitToJSStreamListener default_listener_;
 
   void SetWriteResult(const StreamWriteResult& res);
+  v8::MaybeLocal<v8::Value> CallJSOnread(ssize_t nread,
+                                         size_t offset,
+                                         v8::Local<v8::Value> data);
   static void AddAccessor(v8::Isolate* isolate,
                           v8::Local<v8::Signature> sig,
                           enum v8::PropertyAttribute attributes,
@@ -438,7 +495,10 @@ class StreamBase : public StreamResource {
 // constructors’s (Environment*, Local<Object>, AsyncWrap::Provider) signature
 // and be a subclass of `AsyncWrap`.
 template <typename OtherBase>
-class SimpleShutdownWrap : public ShutdownWrap, public OtherBase {
+class SimpleShutdownWrap
+    : public ShutdownWrap,
+      public OtherBase,
+      public ThreadLocalFreeList<SimpleShutdownWrap<OtherBase>> {
  public:
   SimpleShutdownWrap(StreamBase* stream,
                      v8::Local<v8::Object> req_wrap_obj);
@@ -455,7 +515,9 @@ class SimpleShutdownWrap : public ShutdownWrap, public OtherBase {
 };
 
 template <typename OtherBase>
-class SimpleWriteWrap : public WriteWrap, public OtherBase {
+class SimpleWriteWrap : public WriteWrap,
+                        public OtherBase,
+                        public ThreadLocalFreeList<SimpleWriteWrap<OtherBase>> {
  public:
   SimpleWriteWrap(StreamBase* stream,
                   v8::Local<v8::Object> req_wrap_obj);
@@ -1,6 +1,8 @@
 #include "stream_pipe.h"
 #include "stream_base-inl.h"
+#include "stream_wrap.h"
 #include "node_buffer.h"
+#include "node_file.h"
 #include "util-inl.h"
 
 namespace node {
@@ -32,6 +34,16 @@ StreamPipe::StreamPipe(StreamBase* source,
   sink->PushStreamListener(&writable_listener_);
 
   uses_wants_write_ = sink->HasWantsWrite();
+
+#ifndef _WIN32
+  AsyncWrap::ProviderType source_type = source->GetAsyncWrap()->provider_type();
+  AsyncWrap::ProviderType sink_type = sink->GetAsyncWrap()->provider_type();
+  if (source_type == AsyncWrap::PROVIDER_FILEHANDLE &&
+      (sink_type == AsyncWrap::PROVIDER_TCPWRAP ||
+       sink_type == AsyncWrap::PROVIDER_PIPEWRAP)) {
+    sendfile_fd_ = sink->GetFD();
+  }
+#endif
 }
 
 StreamPipe::~StreamPipe() {
@@ -154,6 +166,46 @@ void StreamPipe::ProcessData(size_t nread,
   }
 }
 
+bool StreamPipe::ShouldSendFile() {
+  if (sendfile_fd_ < 0 || source_destroyed_ || sink_destroyed_)
+    return false;
+  if (skip_sendfile_once_) {
+    skip_sendfile_once_ = false;
+    return false;
+  }
+  // Bypassing the sink's write queue is only safe while it is empty.
+  LibuvStreamWrap* sink_wrap = static_cast<LibuvStreamWrap*>(sink());
+  return sink_wrap->stream()->write_queue_size == 0;
+}
+
+void StreamPipe::SendFile(size_t size) {
+  fs::FileHandle* file = static_cast<fs::FileHandle*>(source());
+  // Both have to outlive the request, even if the pipe is closed meanwhile.
+  BaseObjectPtr<StreamPipe> strong_ref{this};
+  BaseObjectPtr<fs::FileHandle> file_ref{file};
+  pending_writes_++;
+  int err = file->SendFile(sendfile_fd_, size, [this, strong_ref, file_ref](
+                                                   ssize_t result) {
+    // A destroyed sink has already given up on its pending writes.
+    if (sink_destroyed_) return;
+    is_reading_ = false;
+    if (result == UV_EAGAIN || result == 0) {
+      // The socket buffer is full, or the end of the file was reached.
+      skip_sendfile_once_ = true;
+    } else if (result < 0) {
+      // Let the copying path surface the failure, if it is persistent.
+      sendfile_fd_ = -1;
+    }
+    HandleScope handle_scope(env()->isolate());
+    writable_listener_.OnStreamAfterWrite(nullptr, 0);
+  });
+  if (err < 0) {
+    pending_writes_--;
+    sendfile_fd_ = -1;
+    source()->ReadStart();
+  }
+}
+
 void StreamPipe::WritableListener::OnStreamAfterWrite(WriteWrap* w,
                                                       int status) {
   StreamPipe* pipe = ContainerOf(&StreamPipe::writable_listener_, this);
@@ -226,7 +278,10 @@ void StreamPipe::WritableListener::OnStreamWantsWrite(size_t suggested_size) {
   InternalCallbackScope callback_scope(pipe,
       InternalCallbackScope::kSkipTaskQueues);
   pipe->is_reading_ = true;
-  pipe->source()->ReadStart();
+  if (pipe->ShouldSendFile())
+    pipe->SendFile(suggested_size);
+  else
+    pipe->source()->ReadStart();
 }
 
 uv_buf_t StreamPipe::WritableListener::OnStreamAlloc(size_t suggested_size) {
@@ -46,7 +46,18 @@ class StreamPipe : public AsyncWrap {
   // `OnStreamWantsWrite()` support.
   size_t wanted_data_ = 0;
 
+  // When the source is a FileHandle and the sink is a plain libuv stream
+  // (TCP or pipe, but not e.g. TLS), data is moved with sendfile(2) instead
+  // of being read into and written from userland buffers. -1 if unused.
+  int sendfile_fd_ = -1;
+  // Set after a sendfile(2) attempt could not make progress, so that the next
+  // chunk uses the copying path, which waits for the sink to become writable
+  // and takes care of EOF and error reporting.
+  bool skip_sendfile_once_ = false;
+
   void ProcessData(size_t nread, std::unique_ptr<v8::BackingStore> bs);
+  bool ShouldSendFile();
+  void SendFile(size_t size);
 
   class ReadableListener : public StreamListener {
    public:
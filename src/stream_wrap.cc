@@ -35,6 +35,8 @@
 
 #include <cstring>  // memcpy()
 #include <climits>  // INT_MAX
+#include <unordered_map>
+#include <unordered_set>
 
 
 namespace node {
@@ -58,6 +60,15 @@ using v8::ReadOnly;
 using v8::Signature;
 using v8::Value;
 
+namespace {
+// For every Environment, the wraps whose cork window has been opened. A
+// single AtExit() callback per Environment flushes the writes they still
+// hold back.
+Mutex corked_wraps_mutex;
+std::unordered_map<Environment*, std::unordered_set<LibuvStreamWrap*>>
+    corked_wraps;
+}  // namespace
+
 void IsConstructCallCallback(const FunctionCallbackInfo<Value>& args) {
   CHECK(args.IsConstructCall());
   StreamReq::ResetObject(args.This());
@@ -116,6 +127,7 @@ void LibuvStreamWrap::RegisterExternalReferences(
   registry->Register(IsConstructCallCallback);
   registry->Register(GetWriteQueueSize);
   registry->Register(SetBlocking);
+  registry->Register(SetCorkWindow);
   StreamBase::RegisterExternalReferences(registry);
 }
 
@@ -133,6 +145,11 @@ LibuvStreamWrap::LibuvStreamWrap(Environment* env,
 }
 
 
+LibuvStreamWrap::~LibuvStreamWrap() {
+  StopFlushingAtExit();
+}
+
+
 Local<FunctionTemplate> LibuvStreamWrap::GetConstructorTemplate(
     Environment* env) {
   Local<FunctionTemplate> tmpl = env->libuv_stream_wrap_ctor_template();
@@ -154,6 +171,7 @@ Local<FunctionTemplate> LibuvStreamWrap::GetConstructorTemplate(
         Local<FunctionTemplate>(),
         static_cast<PropertyAttribute>(ReadOnly | DontDelete));
     SetProtoMethod(isolate, tmpl, "setBlocking", SetBlocking);
+    SetProtoMethod(isolate, tmpl, "setCorkWindow", SetCorkWindow);
     StreamBase::AddMethods(env, tmpl);
     env->set_libuv_stream_wrap_ctor_template(tmpl);
   }
@@ -304,7 +322,8 @@ void LibuvStreamWrap::GetWriteQueueSize(
     return;
   }
 
-  uint32_t write_queue_size = wrap->stream()->write_queue_size;
+  uint32_t write_queue_size =
+      wrap->stream()->write_queue_size + wrap->corked_bytes_;
   info.GetReturnValue().Set(write_queue_size);
 }
 
@@ -321,6 +340,28 @@ void LibuvStreamWrap::SetBlocking(const FunctionCallbackInfo<Value>& args) {
   args.GetReturnValue().Set(uv_stream_set_blocking(wrap->stream(), enable));
 }
 
+void LibuvStreamWrap::SetCorkWindow(const FunctionCallbackInfo<Value>& args) {
+  LibuvStreamWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap, args.This());
+
+  CHECK_GT(args.Length(), 0);
+  wrap->cork_window_ = args[0]->IsTrue();
+  if (wrap->cork_window_ && !wrap->flush_at_exit_) {
+    Environment* env = wrap->env();
+    Mutex::ScopedLock lock(corked_wraps_mutex);
+    auto [it, inserted] = corked_wraps.try_emplace(env);
+    if (inserted) env->AtExit(FlushCorkedWritesAtExit, env);
+    it->second.insert(wrap);
+    wrap->flush_at_exit_ = true;
+  }
+  if (!wrap->cork_window_) {
+    // Writes that are already held back keep their order relative to the
+    // ones that follow, which will now go straight to libuv.
+    wrap->FlushCorkedWrites();
+    wrap->StopFlushingAtExit();
+  }
+}
+
 typedef SimpleShutdownWrap<ReqWrap<uv_shutdown_t>> LibuvShutdownWrap;
 typedef SimpleWriteWrap<ReqWrap<uv_write_t>> LibuvWriteWrap;
 
@@ -334,6 +375,8 @@ WriteWrap* LibuvStreamWrap::CreateWriteWrap(Local<Object> object) {
 
 
 int LibuvStreamWrap::DoShutdown(ShutdownWrap* req_wrap_) {
+  // uv_shutdown() waits for queued writes, so make sure it can see them.
+  FlushCorkedWrites();
   LibuvShutdownWrap* req_wrap = static_cast<LibuvShutdownWrap*>(req_wrap_);
   return req_wrap->Dispatch(uv_shutdown, stream(), AfterUvShutdown);
 }
@@ -394,6 +437,18 @@ int LibuvStreamWrap::DoWrite(WriteWrap* req_wrap,
                              size_t count,
                              uv_stream_t* send_handle) {
   LibuvWriteWrap* w = static_cast<LibuvWriteWrap*>(req_wrap);
+  if (cork_window_ && send_handle == nullptr) {
+    corked_bufs_.insert(corked_bufs_.end(), bufs, bufs + count);
+    for (size_t i = 0; i < count; i++) corked_bytes_ += bufs[i].len;
+    // Keep the write alive like Dispatch() would, until it is completed
+    // together with the rest of the batch.
+    w->ClearWeak();
+    corked_writes_.push_back(w);
+    ScheduleCorkedWritesFlush();
+    return 0;
+  }
+
+  FlushCorkedWrites();
   return w->Dispatch(uv_write2,
                      stream(),
                      bufs,
@@ -402,7 +457,79 @@ int LibuvStreamWrap::DoWrite(WriteWrap* req_wrap,
                      AfterUvWrite);
 }
 
+void LibuvStreamWrap::ScheduleCorkedWritesFlush() {
+  if (corked_flush_scheduled_) return;
+  corked_flush_scheduled_ = true;
+  BaseObjectPtr<LibuvStreamWrap> strong_ref{this};
+  env()->SetImmediate([strong_ref](Environment* env) {
+    strong_ref->corked_flush_scheduled_ = false;
+    strong_ref->FlushCorkedWrites();
+  });
+}
+
+void LibuvStreamWrap::FlushCorkedWrites() {
+  if (corked_writes_.empty()) return;
+
+  std::vector<WriteWrap*> writes = std::move(corked_writes_);
+  std::vector<uv_buf_t> bufs = std::move(corked_bufs_);
+  corked_writes_.clear();
+  corked_bufs_.clear();
+  corked_bytes_ = 0;
+
+  // The last write carries the uv_write_t for the whole batch. uv_write()
+  // copies the buffer descriptors, so `bufs` does not need to outlive it.
+  LibuvWriteWrap* carrier = static_cast<LibuvWriteWrap*>(writes.back());
+  writes.pop_back();
+  int err = UV_EBADF;
+  if (IsAlive() && !IsClosing()) {
+    err = carrier->Dispatch(uv_write2,
+                            stream(),
+                            bufs.data(),
+                            bufs.size(),
+                            nullptr,
+                            AfterUvWrite);
+  }
+  if (err == 0) {
+    if (!writes.empty())
+      corked_batches_.emplace_back(carrier, std::move(writes));
+    return;
+  }
+
+  // This may be running from inside a write or shutdown call, so report the
+  // failure asynchronously, the same way libuv reports write errors.
+  writes.push_back(carrier);
+  env()->SetImmediate([writes = std::move(writes), err](Environment* env) {
+    HandleScope scope(env->isolate());
+    Context::Scope context_scope(env->context());
+    for (WriteWrap* w : writes) w->Done(err);
+  });
+}
 
+void LibuvStreamWrap::StopFlushingAtExit() {
+  if (!flush_at_exit_) return;
+  flush_at_exit_ = false;
+  Mutex::ScopedLock lock(corked_wraps_mutex);
+  auto it = corked_wraps.find(env());
+  if (it != corked_wraps.end()) it->second.erase(this);
+}
+
+void LibuvStreamWrap::FlushCorkedWritesAtExit(void* arg) {
+  Environment* env = static_cast<Environment*>(arg);
+  std::unordered_set<LibuvStreamWrap*> wraps;
+  {
+    Mutex::ScopedLock lock(corked_wraps_mutex);
+    auto it = corked_wraps.find(env);
+    if (it == corked_wraps.end()) return;
+    wraps = std::move(it->second);
+    corked_wraps.erase(it);
+  }
+  // Writes to stdio pipes and TTYs are synchronous on POSIX, so they are
+  // complete when this returns.
+  for (LibuvStreamWrap* wrap : wraps) {
+    wrap->flush_at_exit_ = false;
+    wrap->FlushCorkedWrites();
+  }
+}
 
 void LibuvStreamWrap::AfterUvWrite(uv_write_t* req, int status) {
   LibuvWriteWrap* req_wrap = static_cast<LibuvWriteWrap*>(
@@ -410,6 +537,18 @@ void LibuvStreamWrap::AfterUvWrite(uv_write_t* req, int status) {
   CHECK_NOT_NULL(req_wrap);
   HandleScope scope(req_wrap->env()->isolate());
   Context::Scope context_scope(req_wrap->env()->context());
+
+  // Writes that were coalesced into this one complete first, in the order
+  // in which they were issued.
+  LibuvStreamWrap* wrap = static_cast<LibuvStreamWrap*>(req_wrap->stream());
+  if (!wrap->corked_batches_.empty() &&
+      wrap->corked_batches_.front().first == req_wrap) {
+    std::vector<WriteWrap*> writes =
+        std::move(wrap->corked_batches_.front().second);
+    wrap->corked_batches_.pop_front();
+    for (WriteWrap* w : writes) w->Done(status);
+  }
+
   req_wrap->Done(status);
 }
 
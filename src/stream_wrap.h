@@ -28,6 +28,10 @@
 #include "handle_wrap.h"
 #include "v8.h"
 
+#include <deque>
+#include <utility>
+#include <vector>
+
 namespace node {
 
 class Environment;
@@ -52,7 +56,9 @@ class LibuvStreamWrap : public HandleWrap, public StreamBase {
   // Resource implementation
   int DoShutdown(ShutdownWrap* req_wrap) override;
   int DoTryWrite(uv_buf_t** bufs, size_t* count) override;
-  inline bool HasDoTryWrite() const override { return true; }
+  // While the cork window is open, writes must not bypass the ones that are
+  // already being held back.
+  inline bool HasDoTryWrite() const override { return !cork_window_; }
   int DoWrite(WriteWrap* w,
               uv_buf_t* bufs,
               size_t count,
@@ -85,6 +91,7 @@ class LibuvStreamWrap : public HandleWrap, public StreamBase {
                   v8::Local<v8::Object> object,
                   uv_stream_t* stream,
                   AsyncWrap::ProviderType provider);
+  ~LibuvStreamWrap() override;
 
   AsyncWrap* GetAsyncWrap() override;
 
@@ -103,6 +110,12 @@ class LibuvStreamWrap : public HandleWrap, public StreamBase {
   static void GetWriteQueueSize(
       const v8::FunctionCallbackInfo<v8::Value>& info);
   static void SetBlocking(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetCorkWindow(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  void ScheduleCorkedWritesFlush();
+  void FlushCorkedWrites();
+  void StopFlushingAtExit();
+  static void FlushCorkedWritesAtExit(void* arg);
 
   // Callbacks for libuv
   void OnUvAlloc(size_t suggested_size, uv_buf_t* buf);
@@ -113,6 +126,24 @@ class LibuvStreamWrap : public HandleWrap, public StreamBase {
 
   uv_stream_t* const stream_;
 
+  // While the cork window is open, writes issued during one turn of the event
+  // loop are held back and handed to libuv as a single uv_write() with all of
+  // their buffers once the current callbacks have run. The buffers are not
+  // copied; they are kept alive by their WriteWraps like for any other write.
+  bool cork_window_ = false;
+  bool corked_flush_scheduled_ = false;
+  size_t corked_bytes_ = 0;
+  std::vector<uv_buf_t> corked_bufs_;
+  std::vector<WriteWrap*> corked_writes_;
+  // For every coalesced uv_write() in flight, the WriteWrap that carries the
+  // uv_write_t and the other writes that complete together with it.
+  std::deque<std::pair<WriteWrap*, std::vector<WriteWrap*>>> corked_batches_;
+  // Whether the wrap is in the set of wraps of its Environment whose writes
+  // are flushed by an AtExit() callback, so that writes that are still held
+  // back when the process exits, e.g. through process.exit() or an uncaught
+  // exception, are handed to libuv instead of being lost.
+  bool flush_at_exit_ = false;
+
 #ifdef _WIN32
   // We don't always have an FD that we could look up on the stream_
   // object itself on Windows. However, for some cases, we open handles
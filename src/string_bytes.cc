@@ -22,6 +22,7 @@
 #include "string_bytes.h"
 
 #include "env-inl.h"
+#include "hex_encoding.h"
 #include "nbytes.h"
 #include "node_buffer.h"
 #include "node_errors.h"
@@ -41,6 +42,7 @@
 
 namespace node {
 
+using v8::BackingStore;
 using v8::ExternalMemoryAccounter;
 using v8::HandleScope;
 using v8::Isolate;
@@ -194,6 +196,36 @@ MaybeLocal<Value> ExternTwoByteString::NewSimpleFromCopy(Isolate* isolate,
   return str;
 }
 
+// An external one-byte string that points into a BackingStore and keeps it
+// alive, instead of owning a copy of the data.
+class BackingStoreOneByteString : public String::ExternalOneByteStringResource {
+ public:
+  BackingStoreOneByteString(Isolate* isolate,
+                            std::shared_ptr<BackingStore> store,
+                            size_t offset,
+                            size_t length)
+      : isolate_(isolate),
+        store_(std::move(store)),
+        data_(static_cast<const char*>(store_->Data()) + offset),
+        length_(length) {
+    external_memory_accounter_.Increase(isolate_, length_);
+  }
+
+  ~BackingStoreOneByteString() override {
+    external_memory_accounter_.Decrease(isolate_, length_);
+  }
+
+  const char* data() const override { return data_; }
+  size_t length() const override { return length_; }
+
+ private:
+  Isolate* isolate_;
+  ExternalMemoryAccounter external_memory_accounter_;
+  std::shared_ptr<BackingStore> store_;
+  const char* data_;
+  size_t length_;
+};
+
 }  // anonymous namespace
 
 static size_t keep_buflen_in_range(size_t len) {
@@ -360,14 +392,14 @@ size_t StringBytes::Write(Isolate* isolate,
     }
     case HEX:
       if (input_view.is_one_byte()) {
-        nbytes =
-            nbytes::HexDecode(buf,
-                              buflen,
-                              reinterpret_cast<const char*>(input_view.data8()),
-                              input_view.length());
+        nbytes = hex_encoding::Decode(
+            buf,
+            buflen,
+            reinterpret_cast<const char*>(input_view.data8()),
+            input_view.length());
       } else {
         String::Value value(isolate, str);
-        nbytes = nbytes::HexDecode(buf, buflen, *value, value.length());
+        nbytes = hex_encoding::Decode(buf, buflen, *value, value.length());
       }
       break;
 
@@ -481,6 +513,47 @@ Maybe<size_t> StringBytes::Size(Isolate* isolate,
   UNREACHABLE();
 }
 
+size_t StringBytes::EncodedSize(size_t buflen, enum encoding encoding) {
+  switch (encoding) {
+    case ASCII:
+    case LATIN1:
+      return buflen;
+    case BASE64:
+      return simdutf::base64_length_from_binary(buflen);
+    case BASE64URL:
+      return simdutf::base64_length_from_binary(buflen, simdutf::base64_url);
+    case HEX:
+      return buflen * 2;
+    default:
+      UNREACHABLE("unsupported encoding");
+  }
+}
+
+size_t StringBytes::EncodeInto(const char* buf,
+                               size_t buflen,
+                               enum encoding encoding,
+                               char* dst,
+                               size_t dstlen) {
+  CHECK_GE(dstlen, EncodedSize(buflen, encoding));
+
+  switch (encoding) {
+    case ASCII:
+      nbytes::ForceAscii(buf, dst, buflen);
+      return buflen;
+    case LATIN1:
+      memcpy(dst, buf, buflen);
+      return buflen;
+    case BASE64:
+      return simdutf::binary_to_base64(buf, buflen, dst);
+    case BASE64URL:
+      return simdutf::binary_to_base64(buf, buflen, dst, simdutf::base64_url);
+    case HEX:
+      return hex_encoding::Encode(buf, buflen, dst, dstlen);
+    default:
+      UNREACHABLE("unsupported encoding");
+  }
+}
+
 #define CHECK_BUFLEN_IN_RANGE(len)                                             \
   do {                                                                         \
     if ((len) > Buffer::kMaxLength) {                                          \
@@ -542,47 +615,18 @@ MaybeLocal<Value> StringBytes::Encode(Isolate* isolate,
       buflen = keep_buflen_in_range(buflen);
       return ExternOneByteString::NewFromCopy(isolate, buf, buflen);
 
-    case BASE64: {
-      buflen = keep_buflen_in_range(buflen);
-      size_t dlen = simdutf::base64_length_from_binary(buflen);
-      char* dst = node::UncheckedMalloc(dlen);
-      if (dst == nullptr) {
-        isolate->ThrowException(node::ERR_MEMORY_ALLOCATION_FAILED(isolate));
-        return MaybeLocal<Value>();
-      }
-
-      size_t written = simdutf::binary_to_base64(buf, buflen, dst);
-      CHECK_EQ(written, dlen);
-
-      return ExternOneByteString::New(isolate, dst, dlen);
-    }
-
-    case BASE64URL: {
-      buflen = keep_buflen_in_range(buflen);
-      size_t dlen =
-          simdutf::base64_length_from_binary(buflen, simdutf::base64_url);
-      char* dst = node::UncheckedMalloc(dlen);
-      if (dst == nullptr) {
-        isolate->ThrowException(node::ERR_MEMORY_ALLOCATION_FAILED(isolate));
-        return MaybeLocal<Value>();
-      }
-
-      size_t written =
-          simdutf::binary_to_base64(buf, buflen, dst, simdutf::base64_url);
-      CHECK_EQ(written, dlen);
-
-      return ExternOneByteString::New(isolate, dst, dlen);
-    }
-
+    case BASE64:
+    case BASE64URL:
     case HEX: {
       buflen = keep_buflen_in_range(buflen);
-      size_t dlen = buflen * 2;
+      size_t dlen = EncodedSize(buflen, encoding);
       char* dst = node::UncheckedMalloc(dlen);
       if (dst == nullptr) {
         isolate->ThrowException(node::ERR_MEMORY_ALLOCATION_FAILED(isolate));
         return MaybeLocal<Value>();
       }
-      size_t written = nbytes::HexEncode(buf, buflen, dst, dlen);
+
+      size_t written = EncodeInto(buf, buflen, encoding, dst, dlen);
       CHECK_EQ(written, dlen);
 
       return ExternOneByteString::New(isolate, dst, dlen);
@@ -626,6 +670,36 @@ MaybeLocal<Value> StringBytes::Encode(Isolate* isolate,
   }
 }
 
+MaybeLocal<Value> StringBytes::EncodeLatin1External(
+    Isolate* isolate,
+    std::shared_ptr<BackingStore> store,
+    size_t offset,
+    size_t length) {
+  CHECK_LE(offset, store->ByteLength());
+  CHECK_LE(length, store->ByteLength() - offset);
+  CHECK_BUFLEN_IN_RANGE(length);
+
+  length = keep_buflen_in_range(length);
+  if (length < EXTERN_APEX) {
+    return ExternOneByteString::NewFromCopy(
+        isolate, static_cast<const char*>(store->Data()) + offset, length);
+  }
+
+  auto* resource = new BackingStoreOneByteString(
+      isolate, std::move(store), offset, length);
+  Local<String> str;
+  if (!String::NewExternalOneByte(isolate, resource).ToLocal(&str)) {
+    delete resource;
+    isolate->ThrowException(node::ERR_STRING_TOO_LONG(isolate));
+    return MaybeLocal<Value>();
+  }
+  return str;
+}
+
+bool StringBytes::IsExternalLatin1Length(size_t length) {
+  return keep_buflen_in_range(length) >= EXTERN_APEX;
+}
+
 MaybeLocal<Value> StringBytes::Encode(Isolate* isolate,
                                       const uint16_t* buf,
                                       size_t buflen) {
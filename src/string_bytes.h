@@ -29,6 +29,7 @@
 #include "v8.h"
 #include "env-inl.h"
 
+#include <memory>
 #include <string>
 
 namespace node {
@@ -83,6 +84,34 @@ class StringBytes {
                                           size_t buflen,
                                           enum encoding encoding);
 
+  // Number of characters EncodeInto() writes for `buflen` input bytes.
+  // Computed without looking at the data.
+  static size_t EncodedSize(size_t buflen, enum encoding encoding);
+
+  // Encode the bytes in the src as ASCII, LATIN1, HEX, BASE64 or BASE64URL
+  // text directly into `dst`, which must have room for EncodedSize()
+  // characters. Returns the number of characters written.
+  static size_t EncodeInto(const char* buf,
+                           size_t buflen,
+                           enum encoding encoding,
+                           char* dst,
+                           size_t dstlen);
+
+  // Like Encode(..., LATIN1), but once `length` is large enough for the
+  // string to be stored externally, the string points into `store` and
+  // keeps it alive instead of copying the data. The caller must make sure
+  // that nothing writes to the store afterwards, e.g. by detaching the
+  // ArrayBuffer it came from.
+  static v8::MaybeLocal<v8::Value> EncodeLatin1External(
+      v8::Isolate* isolate,
+      std::shared_ptr<v8::BackingStore> store,
+      size_t offset,
+      size_t length);
+
+  // Whether EncodeLatin1External() keeps a string of `length` bytes in the
+  // store rather than copying it.
+  static bool IsExternalLatin1Length(size_t length);
+
   // Warning: This reverses endianness on BE platforms, even though the
   // signature using uint16_t implies that it should not.
   // However, the brokenness is already public API and can't therefore
@@ -5,6 +5,7 @@
 #include "node_buffer.h"
 #include "node_errors.h"
 #include "node_external_reference.h"
+#include "simdutf.h"
 #include "string_bytes.h"
 #include "util.h"
 
@@ -14,8 +15,12 @@ using v8::Context;
 using v8::FunctionCallbackInfo;
 using v8::Integer;
 using v8::Isolate;
+using v8::JustVoid;
 using v8::Local;
+using v8::LocalVector;
+using v8::Maybe;
 using v8::MaybeLocal;
+using v8::Nothing;
 using v8::Object;
 using v8::String;
 using v8::Value;
@@ -24,6 +29,31 @@ namespace node {
 
 namespace {
 
+// Transcodes valid UTF-8 in bulk with simdutf instead of V8's per-character
+// decoder. Invalid input still goes through V8 so that replacement
+// characters are inserted exactly as before.
+MaybeLocal<String> MakeUtf8String(Isolate* isolate,
+                                  const char* data,
+                                  size_t length) {
+  if (simdutf::validate_ascii(data, length)) {
+    return String::NewFromOneByte(isolate,
+                                  reinterpret_cast<const uint8_t*>(data),
+                                  v8::NewStringType::kNormal,
+                                  length);
+  }
+  // A UTF-8 sequence never yields more UTF-16 code units than it has bytes.
+  MaybeStackBuffer<char16_t, 1024> utf16(length);
+  size_t written = simdutf::convert_utf8_to_utf16(data, length, utf16.out());
+  if (written == 0) {
+    return String::NewFromUtf8(
+        isolate, data, v8::NewStringType::kNormal, length);
+  }
+  return String::NewFromTwoByte(isolate,
+                                reinterpret_cast<const uint16_t*>(utf16.out()),
+                                v8::NewStringType::kNormal,
+                                written);
+}
+
 MaybeLocal<String> MakeString(Isolate* isolate,
                               const char* data,
                               size_t length,
@@ -32,8 +62,7 @@ MaybeLocal<String> MakeString(Isolate* isolate,
   if (encoding == UTF8) {
     MaybeLocal<String> utf8_string;
     if (length <= static_cast<size_t>(v8::String::kMaxLength)) {
-      utf8_string = String::NewFromUtf8(
-          isolate, data, v8::NewStringType::kNormal, length);
+      utf8_string = MakeUtf8String(isolate, data, length);
     }
     if (utf8_string.IsEmpty()) {
       isolate->ThrowException(node::ERR_STRING_TOO_LONG(isolate));
@@ -53,13 +82,60 @@ MaybeLocal<String> MakeString(Isolate* isolate,
   return ret.FromMaybe(Local<Value>()).As<String>();
 }
 
+// Finds line breaks with memchr(), which the C library vectorizes. The
+// position of the next "\r" is remembered between calls, so input without
+// carriage returns is only scanned for them once.
+class LineBreakScanner {
+ public:
+  LineBreakScanner(const char* data, size_t length, size_t start)
+      : data_(data),
+        length_(length),
+        pos_(start),
+        next_lf_(Find('\n', start)),
+        next_cr_(Find('\r', start)) {}
+
+  // Returns false if there is no further line break. Otherwise, `*end` is set
+  // to the end of the current line and `*next` to the start of the next one.
+  bool Next(size_t* end, size_t* next) {
+    if (next_lf_ < pos_) next_lf_ = Find('\n', pos_);
+    if (next_cr_ < pos_) next_cr_ = Find('\r', pos_);
+    size_t line_break = std::min(next_lf_, next_cr_);
+    if (line_break == length_) return false;
+    *end = line_break;
+    *next = line_break + 1;
+    if (data_[line_break] == '\r' && line_break + 1 < length_ &&
+        data_[line_break + 1] == '\n') {
+      (*next)++;
+    }
+    pos_ = *next;
+    return true;
+  }
+
+ private:
+  size_t Find(char c, size_t from) const {
+    if (from >= length_) return length_;
+    const void* ptr = memchr(data_ + from, c, length_ - from);
+    return ptr == nullptr ? length_ : static_cast<const char*>(ptr) - data_;
+  }
+
+  const char* data_;
+  size_t length_;
+  size_t pos_;
+  size_t next_lf_;
+  size_t next_cr_;
+};
+
 }  // anonymous namespace
 
 
 MaybeLocal<String> StringDecoder::DecodeData(Isolate* isolate,
                                              const char* data,
                                              size_t* nread_ptr) {
-  Local<String> prepend, body;
+  // A character from the previous chunk that was finished by this one. It is
+  // decoded together with the rest of the chunk, so that each chunk produces
+  // a single string instead of a concatenation.
+  char prepend[kIncompleteCharactersEnd];
+  size_t prepend_length = 0;
 
   size_t nread = *nread_ptr;
 
@@ -108,14 +184,10 @@ MaybeLocal<String> StringDecoder::DecodeData(Isolate* isolate,
       state_[kBufferedBytes] += found_bytes;
 
       if (MissingBytes() == 0) [[likely]] {
-        // If no more bytes are missing, create a small string that we
-        // will later prepend.
-        if (!MakeString(isolate,
-                        IncompleteCharacterBuffer(),
-                        BufferedBytes(),
-                        Encoding()).ToLocal(&prepend)) {
-          return MaybeLocal<String>();
-        }
+        // If no more bytes are missing, keep the finished character so that
+        // we can prepend it to the main body.
+        prepend_length = BufferedBytes();
+        memcpy(prepend, IncompleteCharacterBuffer(), prepend_length);
 
         *nread_ptr += BufferedBytes();
         // No more buffered bytes.
@@ -126,8 +198,8 @@ MaybeLocal<String> StringDecoder::DecodeData(Isolate* isolate,
     // It could be that trying to finish the previous chunk already
     // consumed all data that we received in this chunk.
     if (nread == 0) [[unlikely]] {
-      body = !prepend.IsEmpty() ? prepend : String::Empty(isolate);
-      prepend = Local<String>();
+      if (prepend_length == 0) return String::Empty(isolate);
+      return MakeString(isolate, prepend, prepend_length, Encoding());
     } else {
       // If not, that means is no character left to finish at this point.
       DCHECK_EQ(MissingBytes(), 0);
@@ -208,18 +280,17 @@ MaybeLocal<String> StringDecoder::DecodeData(Isolate* isolate,
         memcpy(IncompleteCharacterBuffer(), data + nread, BufferedBytes());
       }
 
-      if (nread > 0) {
-        if (!MakeString(isolate, data, nread, Encoding()).ToLocal(&body))
-          return MaybeLocal<String>();
-      } else {
-        body = String::Empty(isolate);
+      if (prepend_length == 0) {
+        if (nread == 0) return String::Empty(isolate);
+        return MakeString(isolate, data, nread, Encoding());
       }
-    }
-
-    if (prepend.IsEmpty()) {
-      return body;
-    } else {
-      return String::Concat(isolate, prepend, body);
+      // The finished character ends on a character boundary (or, for base64,
+      // a 3-byte group boundary), so decoding it together with the body gives
+      // the same result as decoding both separately and concatenating.
+      MaybeStackBuffer<char, 1024> joined(prepend_length + nread);
+      memcpy(joined.out(), prepend, prepend_length);
+      memcpy(joined.out() + prepend_length, data, nread);
+      return MakeString(isolate, joined.out(), joined.length(), Encoding());
     }
   } else {
     CHECK(Encoding() == ASCII || Encoding() == HEX || Encoding() == LATIN1);
@@ -254,6 +325,45 @@ MaybeLocal<String> StringDecoder::FlushData(Isolate* isolate) {
   return ret;
 }
 
+Maybe<void> StringDecoder::DecodeLines(Isolate* isolate,
+                                       const char* data,
+                                       size_t nread,
+                                       bool skip_leading_line_feed,
+                                       LocalVector<Value>* lines) {
+  CHECK(Encoding() == UTF8 || Encoding() == ASCII || Encoding() == LATIN1);
+
+  size_t start = 0;
+  if (skip_leading_line_feed && nread > 0 && data[0] == '\n') start = 1;
+
+  LineBreakScanner scanner(data, nread, start);
+  size_t end;
+  size_t next;
+  while (scanner.Next(&end, &next)) {
+    size_t length = end - start;
+    Local<String> line;
+    if (!DecodeData(isolate, data + start, &length).ToLocal(&line)) {
+      return Nothing<void>();
+    }
+    if (BufferedBytes() > 0) {
+      // The line ended inside of a character. Decoding the whole chunk
+      // would have produced replacement characters for it, so flush it.
+      Local<String> rest;
+      if (!FlushData(isolate).ToLocal(&rest)) return Nothing<void>();
+      line = String::Concat(isolate, line, rest);
+    }
+    lines->push_back(line);
+    start = next;
+  }
+
+  size_t length = nread - start;
+  Local<String> rest;
+  if (!DecodeData(isolate, data + start, &length).ToLocal(&rest)) {
+    return Nothing<void>();
+  }
+  lines->push_back(rest);
+  return JustVoid();
+}
+
 namespace {
 
 void DecodeData(const FunctionCallbackInfo<Value>& args) {
@@ -272,6 +382,32 @@ void DecodeData(const FunctionCallbackInfo<Value>& args) {
   }
 }
 
+// decodeLines(decoder, chunk, skipLeadingLineFeed) returns the decoded lines
+// of `chunk`. The last element is the unterminated rest, see
+// StringDecoder::DecodeLines().
+void DecodeLines(const FunctionCallbackInfo<Value>& args) {
+  Isolate* isolate = args.GetIsolate();
+  StringDecoder* decoder =
+      reinterpret_cast<StringDecoder*>(Buffer::Data(args[0]));
+  CHECK_NOT_NULL(decoder);
+
+  CHECK(args[1]->IsArrayBufferView());
+  CHECK(args[2]->IsBoolean());
+  ArrayBufferViewContents<char> content(args[1].As<ArrayBufferView>());
+
+  LocalVector<Value> lines(isolate);
+  if (decoder
+          ->DecodeLines(isolate,
+                        content.data(),
+                        content.length(),
+                        args[2]->IsTrue(),
+                        &lines)
+          .IsNothing()) {
+    return;
+  }
+  args.GetReturnValue().Set(Array::New(isolate, lines.data(), lines.size()));
+}
+
 void FlushData(const FunctionCallbackInfo<Value>& args) {
   StringDecoder* decoder =
       reinterpret_cast<StringDecoder*>(Buffer::Data(args[0]));
@@ -324,6 +460,7 @@ void InitializeStringDecoder(Local<Object> target,
               Integer::New(isolate, sizeof(StringDecoder))).Check();
 
   SetMethod(context, target, "decode", DecodeData);
+  SetMethod(context, target, "decodeLines", DecodeLines);
   SetMethod(context, target, "flush", FlushData);
 }
 
@@ -332,6 +469,7 @@ void InitializeStringDecoder(Local<Object> target,
 void RegisterStringDecoderExternalReferences(
     ExternalReferenceRegistry* registry) {
   registry->Register(DecodeData);
+  registry->Register(DecodeLines);
   registry->Register(FlushData);
 }
 
@@ -29,6 +29,19 @@ class StringDecoder {
   // string contains more data.
   v8::MaybeLocal<v8::String> FlushData(v8::Isolate* isolate);
 
+  // Decode `data` and split it into lines at "\n", "\r\n" and lone "\r",
+  // like readline does. Every element appended to `lines` but the last one
+  // was terminated by a line break; the last one is the unterminated rest of
+  // the chunk and may be empty. If `skip_leading_line_feed` is set, a "\n" at
+  // the start of `data` completes a "\r\n" split across chunks. Only valid
+  // for encodings in which line break bytes cannot be part of a character,
+  // i.e. UTF8, ASCII and LATIN1.
+  v8::Maybe<void> DecodeLines(v8::Isolate* isolate,
+                              const char* data,
+                              size_t nread,
+                              bool skip_leading_line_feed,
+                              v8::LocalVector<v8::Value>* lines);
+
   enum Fields {
     kIncompleteCharactersStart = 0,
     kIncompleteCharactersEnd = 4,
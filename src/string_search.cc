@@ -0,0 +1,247 @@
+#include "string_search.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#include "util.h"  // CHECK(), which nbytes.h relies on.
+
+#include "nbytes.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <emmintrin.h>
+#define NODE_STRING_SEARCH_SSE2 1
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define NODE_STRING_SEARCH_NEON 1
+#endif
+
+namespace node {
+namespace string_search {
+
+namespace {
+
+// Longer needles are left to nbytes, whose Boyer-Moore-Horspool search skips
+// ahead by up to the needle length and wins over scanning every position.
+constexpr size_t kMaxVectorizedNeedleLength = 64;
+
+// Each Ops type describes one vector width and character size:
+// - kLanes: number of characters per vector.
+// - kStride: number of mask bits per lane, only the lowest one is set.
+// - MatchMask(): for every lane, whether the characters loaded at `a` and
+//   `b` are `x` and `y` respectively.
+#if NODE_STRING_SEARCH_SSE2
+struct Sse2Ops8 {
+  using Char = uint8_t;
+  using Vec = __m128i;
+  static constexpr size_t kLanes = 16;
+  static constexpr int kStride = 1;
+  static Vec Splat(Char c) { return _mm_set1_epi8(static_cast<char>(c)); }
+  static Vec Load(const Char* p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+  }
+  static uint64_t MatchMask(Vec a, Vec x, Vec b, Vec y) {
+    return static_cast<uint32_t>(_mm_movemask_epi8(
+        _mm_and_si128(_mm_cmpeq_epi8(a, x), _mm_cmpeq_epi8(b, y))));
+  }
+};
+
+struct Sse2Ops16 {
+  using Char = uint16_t;
+  using Vec = __m128i;
+  static constexpr size_t kLanes = 8;
+  static constexpr int kStride = 2;
+  static Vec Splat(Char c) { return _mm_set1_epi16(static_cast<int16_t>(c)); }
+  static Vec Load(const Char* p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+  }
+  static uint64_t MatchMask(Vec a, Vec x, Vec b, Vec y) {
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_and_si128(
+               _mm_cmpeq_epi16(a, x), _mm_cmpeq_epi16(b, y)))) &
+           0x5555;
+  }
+};
+
+using Ops8 = Sse2Ops8;
+using Ops16 = Sse2Ops16;
+#elif NODE_STRING_SEARCH_NEON
+struct NeonOps8 {
+  using Char = uint8_t;
+  using Vec = uint8x16_t;
+  static constexpr size_t kLanes = 16;
+  static constexpr int kStride = 4;
+  static Vec Splat(Char c) { return vdupq_n_u8(c); }
+  static Vec Load(const Char* p) { return vld1q_u8(p); }
+  static uint64_t MatchMask(Vec a, Vec x, Vec b, Vec y) {
+    uint8x16_t eq = vandq_u8(vceqq_u8(a, x), vceqq_u8(b, y));
+    // Narrow every byte to a nibble, there is no movemask on NEON.
+    uint8x8_t nibbles = vshrn_n_u16(vreinterpretq_u16_u8(eq), 4);
+    return vget_lane_u64(vreinterpret_u64_u8(nibbles), 0) &
+           0x1111111111111111ULL;
+  }
+};
+
+struct NeonOps16 {
+  using Char = uint16_t;
+  using Vec = uint16x8_t;
+  static constexpr size_t kLanes = 8;
+  static constexpr int kStride = 8;
+  static Vec Splat(Char c) { return vdupq_n_u16(c); }
+  static Vec Load(const Char* p) { return vld1q_u16(p); }
+  static uint64_t MatchMask(Vec a, Vec x, Vec b, Vec y) {
+    uint16x8_t eq = vandq_u16(vceqq_u16(a, x), vceqq_u16(b, y));
+    uint8x8_t bytes = vmovn_u16(eq);
+    return vget_lane_u64(vreinterpret_u64_u8(bytes), 0) &
+           0x0101010101010101ULL;
+  }
+};
+
+using Ops8 = NeonOps8;
+using Ops16 = NeonOps16;
+#endif
+
+#if NODE_STRING_SEARCH_SSE2 || NODE_STRING_SEARCH_NEON
+template <typename Char>
+inline bool MatchesAt(const Char* haystack,
+                      size_t pos,
+                      const Char* needle,
+                      size_t needle_length) {
+  return memcmp(haystack + pos, needle, needle_length * sizeof(Char)) == 0;
+}
+
+// Compares two vectors per step: one at the candidate start positions and
+// one at the positions of the last needle character, and only checks the
+// full needle where both match. See http://0x80.pl/articles/simd-strfind.html
+template <typename Ops>
+size_t VectorizedSearch(const typename Ops::Char* haystack,
+                        size_t haystack_length,
+                        const typename Ops::Char* needle,
+                        size_t needle_length,
+                        size_t start_index,
+                        bool is_forward) {
+  using Char = typename Ops::Char;
+  constexpr size_t kLanes = Ops::kLanes;
+  const size_t last = needle_length - 1;
+  // The last position at which the needle fits.
+  const size_t max_pos = haystack_length - needle_length;
+  const auto first_char = Ops::Splat(needle[0]);
+  const auto last_char = Ops::Splat(needle[last]);
+  const Char first = needle[0];
+
+  if (is_forward) {
+    size_t pos = start_index;
+    for (; pos + kLanes - 1 <= max_pos; pos += kLanes) {
+      uint64_t mask = Ops::MatchMask(Ops::Load(haystack + pos),
+                                     first_char,
+                                     Ops::Load(haystack + pos + last),
+                                     last_char);
+      while (mask != 0) {
+        size_t candidate = pos + std::countr_zero(mask) / Ops::kStride;
+        if (MatchesAt(haystack, candidate, needle, needle_length))
+          return candidate;
+        mask &= mask - 1;
+      }
+    }
+    for (; pos <= max_pos; pos++) {
+      if (haystack[pos] == first &&
+          MatchesAt(haystack, pos, needle, needle_length)) {
+        return pos;
+      }
+    }
+    return haystack_length;
+  }
+
+  // One past the last position that may match.
+  size_t end = std::min(start_index, max_pos) + 1;
+  while (end >= kLanes) {
+    size_t block = end - kLanes;
+    uint64_t mask = Ops::MatchMask(Ops::Load(haystack + block),
+                                   first_char,
+                                   Ops::Load(haystack + block + last),
+                                   last_char);
+    while (mask != 0) {
+      int bit = 63 - std::countl_zero(mask);
+      size_t candidate = block + bit / Ops::kStride;
+      if (MatchesAt(haystack, candidate, needle, needle_length))
+        return candidate;
+      mask &= ~(uint64_t{1} << bit);
+    }
+    end = block;
+  }
+  while (end > 0) {
+    end--;
+    if (haystack[end] == first &&
+        MatchesAt(haystack, end, needle, needle_length)) {
+      return end;
+    }
+  }
+  return haystack_length;
+}
+#endif
+
+template <typename Ops, typename Char>
+size_t Search(const Char* haystack,
+              size_t haystack_length,
+              const Char* needle,
+              size_t needle_length,
+              size_t start_index,
+              bool is_forward) {
+#if NODE_STRING_SEARCH_SSE2 || NODE_STRING_SEARCH_NEON
+  // Single characters are found with memchr() and friends by nbytes.
+  if (needle_length >= 2 && needle_length <= kMaxVectorizedNeedleLength &&
+      haystack_length >= needle_length &&
+      (!is_forward || start_index <= haystack_length - needle_length)) {
+    return VectorizedSearch<Ops>(haystack,
+                                 haystack_length,
+                                 needle,
+                                 needle_length,
+                                 start_index,
+                                 is_forward);
+  }
+#endif
+  return nbytes::SearchString(haystack,
+                              haystack_length,
+                              needle,
+                              needle_length,
+                              start_index,
+                              is_forward);
+}
+
+}  // anonymous namespace
+
+#if !(NODE_STRING_SEARCH_SSE2 || NODE_STRING_SEARCH_NEON)
+// Unused, Search() always ends up in nbytes.
+using Ops8 = void;
+using Ops16 = void;
+#endif
+
+size_t SearchString(const uint8_t* haystack,
+                    size_t haystack_length,
+                    const uint8_t* needle,
+                    size_t needle_length,
+                    size_t start_index,
+                    bool is_forward) {
+  return Search<Ops8>(haystack,
+                      haystack_length,
+                      needle,
+                      needle_length,
+                      start_index,
+                      is_forward);
+}
+
+size_t SearchString(const uint16_t* haystack,
+                    size_t haystack_length,
+                    const uint16_t* needle,
+                    size_t needle_length,
+                    size_t start_index,
+                    bool is_forward) {
+  return Search<Ops16>(haystack,
+                       haystack_length,
+                       needle,
+                       needle_length,
+                       start_index,
+                       is_forward);
+}
+
+}  // namespace string_search
+}  // namespace node
@@ -0,0 +1,37 @@
+#ifndef SRC_STRING_SEARCH_H_
+#define SRC_STRING_SEARCH_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include <cstddef>
+#include <cstdint>
+
+namespace node {
+namespace string_search {
+
+// Drop-in replacements for nbytes::SearchString() that use a vectorized
+// first-and-last character filter for short, multi-character needles on
+// SSE2 (x86-64) and NEON (arm64), and fall back to nbytes otherwise.
+//
+// Returns the start of the first match at or after `start_index` if
+// `is_forward` is true, or of the last match at or before `start_index`
+// otherwise. Returns `haystack_length` if there is no match.
+size_t SearchString(const uint8_t* haystack,
+                    size_t haystack_length,
+                    const uint8_t* needle,
+                    size_t needle_length,
+                    size_t start_index,
+                    bool is_forward);
+size_t SearchString(const uint16_t* haystack,
+                    size_t haystack_length,
+                    const uint16_t* needle,
+                    size_t needle_length,
+                    size_t start_index,
+                    bool is_forward);
+
+}  // namespace string_search
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_STRING_SEARCH_H_
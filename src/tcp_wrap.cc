@@ -33,16 +33,30 @@
 #include "util-inl.h"
 
 #include <cstdlib>
+#include <vector>
+#ifndef _WIN32
+#include <unistd.h>  // dup()
+#endif
+#ifndef _WIN32
+#include <netinet/in.h>
+#include <netinet/tcp.h>  // TCP_DEFER_ACCEPT, TCP_FASTOPEN
+#endif
+#ifdef __linux__
+#include <linux/filter.h>
+#include <sys/socket.h>
+#endif
 
 
 namespace node {
 
+using v8::Array;
 using v8::Boolean;
 using v8::Context;
 using v8::EscapableHandleScope;
 using v8::Function;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
+using v8::HandleScope;
 using v8::Int32;
 using v8::Integer;
 using v8::Isolate;
@@ -95,6 +109,7 @@ void TCPWrap::Initialize(Local<Object> target,
   SetProtoMethod(isolate, t, "connect", Connect);
   SetProtoMethod(isolate, t, "bind6", Bind6);
   SetProtoMethod(isolate, t, "connect6", Connect6);
+  SetProtoMethod(isolate, t, "connectMulti", ConnectMulti);
   SetProtoMethod(isolate,
                  t,
                  "getsockname",
@@ -105,6 +120,11 @@ void TCPWrap::Initialize(Local<Object> target,
                  GetSockOrPeerName<TCPWrap, uv_tcp_getpeername>);
   SetProtoMethod(isolate, t, "setNoDelay", SetNoDelay);
   SetProtoMethod(isolate, t, "setKeepAlive", SetKeepAlive);
+  SetProtoMethod(
+      isolate, t, "setReusePortCpuSteering", SetReusePortCpuSteering);
+  SetProtoMethod(isolate, t, "setAcceptBatchSize", SetAcceptBatchSize);
+  SetProtoMethod(isolate, t, "setDeferAccept", SetDeferAccept);
+  SetProtoMethod(isolate, t, "setFastOpen", SetFastOpen);
   SetProtoMethod(isolate, t, "reset", Reset);
 
 #ifdef _WIN32
@@ -139,11 +159,16 @@ void TCPWrap::RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(Connect);
   registry->Register(Bind6);
   registry->Register(Connect6);
+  registry->Register(ConnectMulti);
 
   registry->Register(GetSockOrPeerName<TCPWrap, uv_tcp_getsockname>);
   registry->Register(GetSockOrPeerName<TCPWrap, uv_tcp_getpeername>);
   registry->Register(SetNoDelay);
   registry->Register(SetKeepAlive);
+  registry->Register(SetReusePortCpuSteering);
+  registry->Register(SetAcceptBatchSize);
+  registry->Register(SetDeferAccept);
+  registry->Register(SetFastOpen);
   registry->Register(Reset);
 #ifdef _WIN32
   registry->Register(SetSimultaneousAccepts);
@@ -268,6 +293,99 @@ void TCPWrap::Bind(
   args.GetReturnValue().Set(err);
 }
 
+// setReusePortCpuSteering(groupSize) attaches a classic BPF program to the
+// SO_REUSEPORT group of a bound socket that picks the listener by the CPU
+// that received the connection, i.e. the socket at index
+// `cpu % groupSize` in the order in which the sockets joined the group.
+// Combined with per-CPU workers this keeps each connection on one CPU.
+void TCPWrap::SetReusePortCpuSteering(const FunctionCallbackInfo<Value>& args) {
+  TCPWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(
+      &wrap, args.This(), args.GetReturnValue().Set(UV_EBADF));
+  CHECK(args[0]->IsUint32());
+  const uint32_t group_size = args[0].As<Uint32>()->Value();
+  if (group_size == 0) return args.GetReturnValue().Set(UV_EINVAL);
+
+#if defined(__linux__) && defined(SO_ATTACH_REUSEPORT_CBPF)
+  uv_os_fd_t fd;
+  int err = uv_fileno(reinterpret_cast<uv_handle_t*>(&wrap->handle_), &fd);
+  if (err == 0) {
+    struct sock_filter code[] = {
+        // A = the CPU the packet was received on
+        {BPF_LD | BPF_W | BPF_ABS,
+         0,
+         0,
+         static_cast<uint32_t>(SKF_AD_OFF + SKF_AD_CPU)},
+        // A = A % group_size
+        {BPF_ALU | BPF_MOD | BPF_K, 0, 0, group_size},
+        // return A
+        {BPF_RET | BPF_A, 0, 0, 0},
+    };
+    struct sock_fprog program = {arraysize(code), code};
+    if (setsockopt(fd,
+                   SOL_SOCKET,
+                   SO_ATTACH_REUSEPORT_CBPF,
+                   &program,
+                   sizeof(program)) != 0) {
+      err = uv_translate_sys_error(errno);
+    }
+  }
+  args.GetReturnValue().Set(err);
+#else
+  args.GetReturnValue().Set(UV_ENOTSUP);
+#endif
+}
+
+// setDeferAccept(seconds) sets TCP_DEFER_ACCEPT on a listening socket so
+// that a connection is only reported once the peer has sent data, or the
+// timeout has expired. Only supported on Linux.
+void TCPWrap::SetDeferAccept(const FunctionCallbackInfo<Value>& args) {
+  TCPWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(
+      &wrap, args.This(), args.GetReturnValue().Set(UV_EBADF));
+  CHECK(args[0]->IsUint32());
+  const int seconds = static_cast<int>(args[0].As<Uint32>()->Value());
+
+#if defined(__linux__) && defined(TCP_DEFER_ACCEPT)
+  uv_os_fd_t fd;
+  int err = uv_fileno(reinterpret_cast<uv_handle_t*>(&wrap->handle_), &fd);
+  if (err == 0 &&
+      setsockopt(
+          fd, IPPROTO_TCP, TCP_DEFER_ACCEPT, &seconds, sizeof(seconds)) != 0) {
+    err = uv_translate_sys_error(errno);
+  }
+  args.GetReturnValue().Set(err);
+#else
+  args.GetReturnValue().Set(UV_ENOTSUP);
+#endif
+}
+
+// setFastOpen(queueLength) enables TCP Fast Open on a bound socket, with
+// at most queueLength pending connections that have not completed the
+// handshake yet. It has to be called before listen().
+void TCPWrap::SetFastOpen(const FunctionCallbackInfo<Value>& args) {
+  TCPWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(
+      &wrap, args.This(), args.GetReturnValue().Set(UV_EBADF));
+  CHECK(args[0]->IsUint32());
+  const int queue_length = static_cast<int>(args[0].As<Uint32>()->Value());
+
+#if defined(TCP_FASTOPEN) && !defined(_WIN32)
+  uv_os_fd_t fd;
+  int err = uv_fileno(reinterpret_cast<uv_handle_t*>(&wrap->handle_), &fd);
+  if (err == 0 && setsockopt(fd,
+                             IPPROTO_TCP,
+                             TCP_FASTOPEN,
+                             &queue_length,
+                             sizeof(queue_length)) != 0) {
+    err = uv_translate_sys_error(errno);
+  }
+  args.GetReturnValue().Set(err);
+#else
+  args.GetReturnValue().Set(UV_ENOTSUP);
+#endif
+}
+
 void TCPWrap::Bind(const FunctionCallbackInfo<Value>& args) {
   Bind<sockaddr_in>(args, AF_INET, uv_ip4_addr);
 }
@@ -360,6 +478,253 @@ void TCPWrap::Connect(const FunctionCallbackInfo<Value>& args,
 
   args.GetReturnValue().Set(err);
 }
+
+// Happy Eyeballs (RFC 8305) style connection racing. Each attempt uses its
+// own uv_tcp_t. A new attempt is started when the previous one fails or after
+// `attempt_delay` milliseconds, whichever comes first. The socket of the
+// first attempt that connects is handed over to the TCPWrap's own, still
+// unopened, handle and all other attempts are cancelled, so JS sees a single
+// completion of `req` exactly like with connect(). Also like with connect(),
+// failing to start any attempt is reported synchronously instead.
+class TCPWrap::MultiConnect {
+ public:
+  MultiConnect(TCPWrap* wrap,
+               ConnectWrap* req_wrap,
+               std::vector<sockaddr_storage>&& addresses,
+               uint64_t attempt_delay)
+      : wrap_(wrap),
+        req_wrap_(req_wrap),
+        addresses_(std::move(addresses)),
+        attempt_delay_(attempt_delay) {
+    Environment* env = wrap->env();
+    CHECK_EQ(uv_timer_init(env->event_loop(), &timer_), 0);
+    timer_.data = this;
+    env->AddCleanupHook(CleanupHook, this);
+    wrap->multi_connect_ = this;
+  }
+
+  // Returns the error of the last attempt if none of them could be started,
+  // in which case `req` is not called back.
+  int Start() {
+    starting_ = true;
+    StartNextAttempt();
+    starting_ = false;
+    return finished_ ? last_error_ : 0;
+  }
+
+  // Called when the TCPWrap is closed. Like a plain connect() that is
+  // cancelled by closing the handle, the request does not complete then.
+  void Cancel() { Finish(UV_ECANCELED, false); }
+
+ private:
+  struct Attempt {
+    MultiConnect* owner;
+    uv_tcp_t handle;
+    uv_connect_t req;
+  };
+
+  static void CleanupHook(void* data) {
+    // The Environment is going away, do not call into JS.
+    static_cast<MultiConnect*>(data)->Finish(UV_ECANCELED, false);
+  }
+
+  void StartNextAttempt() {
+    Environment* env = wrap_->env();
+    while (!finished_ && next_ < addresses_.size()) {
+      const sockaddr* addr =
+          reinterpret_cast<const sockaddr*>(&addresses_[next_++]);
+      Attempt* attempt = new Attempt{this, {}, {}};
+      CHECK_EQ(uv_tcp_init(env->event_loop(), &attempt->handle), 0);
+      attempt->handle.data = attempt;
+      int err =
+          uv_tcp_connect(&attempt->req, &attempt->handle, addr, OnConnect);
+      if (err != 0) {
+        last_error_ = err;
+        CloseAttempt(attempt);
+        continue;
+      }
+      attempts_.push_back(attempt);
+      if (next_ < addresses_.size()) {
+        uv_timer_start(&timer_, OnTimer, attempt_delay_, 0);
+      }
+      return;
+    }
+    if (!finished_ && attempts_.empty()) Finish(last_error_, !starting_);
+  }
+
+  static void OnTimer(uv_timer_t* timer) {
+    static_cast<MultiConnect*>(timer->data)->StartNextAttempt();
+  }
+
+  static void OnConnect(uv_connect_t* req, int status) {
+    Attempt* attempt = static_cast<Attempt*>(req->handle->data);
+    MultiConnect* self = attempt->owner;
+    if (self->finished_) return;  // Cancelled, closed by Finish().
+
+    std::erase(self->attempts_, attempt);
+    // Finish() is called when the TCPWrap is closed, but the handle can
+    // start closing in other ways, too.
+    if (uv_is_closing(reinterpret_cast<uv_handle_t*>(&self->wrap_->handle_))) {
+      self->CloseAttempt(attempt);
+      return self->Finish(UV_ECANCELED, false);
+    }
+    if (status == 0) {
+      // The attempt's handle is closed below, keep its socket alive.
+      uv_os_fd_t fd;
+      status =
+          uv_fileno(reinterpret_cast<uv_handle_t*>(&attempt->handle), &fd);
+      if (status == 0) {
+        int dup_fd = dup(fd);
+        status = dup_fd < 0 ? uv_translate_sys_error(errno)
+                            : uv_tcp_open(&self->wrap_->handle_, dup_fd);
+        if (status != 0 && dup_fd >= 0) close(dup_fd);
+      }
+      self->CloseAttempt(attempt);
+      return self->Finish(status, true);
+    }
+
+    self->last_error_ = status;
+    self->CloseAttempt(attempt);
+    uv_timer_stop(&self->timer_);
+    self->StartNextAttempt();
+  }
+
+  void CloseAttempt(Attempt* attempt) {
+    pending_closes_++;
+    wrap_->env()->CloseHandle(&attempt->handle, [](uv_tcp_t* handle) {
+      Attempt* attempt = static_cast<Attempt*>(handle->data);
+      MultiConnect* self = attempt->owner;
+      delete attempt;
+      self->OnHandleClosed();
+    });
+  }
+
+  void OnHandleClosed() {
+    if (--pending_closes_ == 0 && finished_) delete this;
+  }
+
+  void Finish(int status, bool call_js) {
+    if (finished_) return;
+    finished_ = true;
+    Environment* env = wrap_->env();
+    env->RemoveCleanupHook(CleanupHook, this);
+    if (wrap_->multi_connect_ == this) wrap_->multi_connect_ = nullptr;
+
+    for (Attempt* attempt : attempts_) CloseAttempt(attempt);
+    attempts_.clear();
+    pending_closes_++;
+    env->CloseHandle(&timer_, [](uv_timer_t* handle) {
+      static_cast<MultiConnect*>(handle->data)->OnHandleClosed();
+    });
+
+    TRACE_EVENT_NESTABLE_ASYNC_END1(TRACING_CATEGORY_NODE2(net, native),
+                                    "connect",
+                                    req_wrap_.get(),
+                                    "status",
+                                    status);
+
+    // Delete req_wrap_ once the last reference to it goes away.
+    req_wrap_->Detach();
+    if (!call_js || !env->can_call_into_js()) return;
+
+    HandleScope handle_scope(env->isolate());
+    Context::Scope context_scope(env->context());
+    uv_stream_t* stream = reinterpret_cast<uv_stream_t*>(&wrap_->handle_);
+    const bool connected = status == 0;
+    Local<Value> argv[5] = {
+        Integer::New(env->isolate(), status),
+        wrap_->object(),
+        req_wrap_->object(),
+        Boolean::New(env->isolate(), connected && uv_is_readable(stream)),
+        Boolean::New(env->isolate(), connected && uv_is_writable(stream))};
+
+    req_wrap_->MakeCallback(env->oncomplete_string(), arraysize(argv), argv);
+  }
+
+  BaseObjectPtr<TCPWrap> wrap_;
+  BaseObjectPtr<ConnectWrap> req_wrap_;
+  std::vector<sockaddr_storage> addresses_;
+  const uint64_t attempt_delay_;
+  uv_timer_t timer_;
+  std::vector<Attempt*> attempts_;
+  size_t next_ = 0;
+  size_t pending_closes_ = 0;
+  int last_error_ = UV_ECONNREFUSED;
+  bool starting_ = false;
+  bool finished_ = false;
+};
+
+void TCPWrap::ConnectMulti(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  TCPWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(
+      &wrap, args.This(), args.GetReturnValue().Set(UV_EBADF));
+
+  CHECK(args[0]->IsObject());  // req
+  CHECK(args[1]->IsArray());   // addresses
+  CHECK(args[2]->IsUint32());  // port
+  CHECK(args[3]->IsUint32());  // attemptDelay
+
+#ifdef _WIN32
+  // Handing a connected socket over to another handle relies on dup().
+  return args.GetReturnValue().Set(UV_ENOTSUP);
+#else
+  // The winning socket is adopted by uv_tcp_open(), so the handle must not
+  // have a socket yet, e.g. from bind().
+  uv_os_fd_t fd;
+  if (uv_fileno(reinterpret_cast<uv_handle_t*>(&wrap->handle_), &fd) !=
+      UV_EBADF) {
+    return args.GetReturnValue().Set(UV_EISCONN);
+  }
+
+  Local<Object> req_wrap_obj = args[0].As<Object>();
+  Local<Array> list = args[1].As<Array>();
+  const int port = static_cast<int>(args[2].As<Uint32>()->Value());
+  const uint64_t attempt_delay = args[3].As<Uint32>()->Value();
+
+  std::vector<sockaddr_storage> addresses(list->Length());
+  for (uint32_t i = 0; i < list->Length(); i++) {
+    Local<Value> value;
+    if (!list->Get(env->context(), i).ToLocal(&value)) return;
+    CHECK(value->IsString());
+    node::Utf8Value ip_address(env->isolate(), value);
+    int err = uv_ip4_addr(*ip_address,
+                          port,
+                          reinterpret_cast<sockaddr_in*>(&addresses[i]));
+    if (err != 0) {
+      err = uv_ip6_addr(*ip_address,
+                        port,
+                        reinterpret_cast<sockaddr_in6*>(&addresses[i]));
+    }
+    if (err != 0) return args.GetReturnValue().Set(err);
+  }
+  if (addresses.empty()) return args.GetReturnValue().Set(UV_EINVAL);
+
+  AsyncHooks::DefaultTriggerAsyncIdScope trigger_scope(wrap);
+  ConnectWrap* req_wrap =
+      new ConnectWrap(env, req_wrap_obj, AsyncWrap::PROVIDER_TCPCONNECTWRAP);
+  TRACE_EVENT_NESTABLE_ASYNC_BEGIN2(TRACING_CATEGORY_NODE2(net, native),
+                                    "connect",
+                                    req_wrap,
+                                    "addresses",
+                                    addresses.size(),
+                                    "port",
+                                    port);
+  // Deletes itself once all of its handles are closed.
+  MultiConnect* connect = new MultiConnect(
+      wrap, req_wrap, std::move(addresses), attempt_delay);
+  int err = connect->Start();
+
+  args.GetReturnValue().Set(err);
+#endif  // _WIN32
+}
+
+void TCPWrap::Close(Local<Value> close_callback) {
+  if (multi_connect_ != nullptr) multi_connect_->Cancel();
+  ConnectionWrap::Close(close_callback);
+}
+
 void TCPWrap::Reset(const FunctionCallbackInfo<Value>& args) {
   TCPWrap* wrap;
   ASSIGN_OR_RETURN_UNWRAP(
@@ -372,6 +737,7 @@ void TCPWrap::Reset(const FunctionCallbackInfo<Value>& args) {
 
 int TCPWrap::Reset(Local<Value> close_callback) {
   if (state_ != kInitialized) return 0;
+  if (multi_connect_ != nullptr) multi_connect_->Cancel();
 
   int err = uv_tcp_close_reset(&handle_, OnClose);
   state_ = kClosing;
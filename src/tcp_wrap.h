@@ -61,6 +61,10 @@ class TCPWrap : public ConnectionWrap<TCPWrap, uv_tcp_t> {
     }
   }
 
+  // Also cancels a pending connectMulti().
+  void Close(
+      v8::Local<v8::Value> close_callback = v8::Local<v8::Value>()) override;
+
  private:
   typedef uv_tcp_t HandleType;
 
@@ -74,6 +78,10 @@ class TCPWrap : public ConnectionWrap<TCPWrap, uv_tcp_t> {
   static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetNoDelay(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetKeepAlive(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetReusePortCpuSteering(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetDeferAccept(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetFastOpen(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Bind(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Bind6(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Listen(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -82,6 +90,10 @@ class TCPWrap : public ConnectionWrap<TCPWrap, uv_tcp_t> {
   template <typename T>
   static void Connect(const v8::FunctionCallbackInfo<v8::Value>& args,
       std::function<int(const char* ip_address, T* addr)> uv_ip_addr);
+  // connectMulti(req, addresses, port, attemptDelay) races connections to
+  // a list of addresses and completes req once, see MultiConnect.
+  static void ConnectMulti(const v8::FunctionCallbackInfo<v8::Value>& args);
+  class MultiConnect;
   static void Open(const v8::FunctionCallbackInfo<v8::Value>& args);
   template <typename T>
   static void Bind(
@@ -95,6 +107,8 @@ class TCPWrap : public ConnectionWrap<TCPWrap, uv_tcp_t> {
   static void SetSimultaneousAccepts(
       const v8::FunctionCallbackInfo<v8::Value>& args);
 #endif
+
+  MultiConnect* multi_connect_ = nullptr;
 };
 
 
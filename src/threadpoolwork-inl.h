@@ -34,32 +34,46 @@ void ThreadPoolWork::ScheduleWork() {
   env_->IncreaseWaitingRequestCounter();
   TRACE_EVENT_NESTABLE_ASYNC_BEGIN0(
       TRACING_CATEGORY_NODE2(threadpoolwork, async), type_, this);
+  scheduled_at_ = uv_hrtime();
+  started_at_ = 0;
+  env_->thread_pool_work_queue()->Schedule(this);
+}
+
+void ThreadPoolWork::Submit() {
   int status = uv_queue_work(
       env_->event_loop(),
       &work_req_,
       [](uv_work_t* req) {
         ThreadPoolWork* self = ContainerOf(&ThreadPoolWork::work_req_, req);
+        self->started_at_ = uv_hrtime();
         TRACE_EVENT_BEGIN0(TRACING_CATEGORY_NODE2(threadpoolwork, sync),
                            self->type_);
         self->DoThreadPoolWork();
+        self->finished_at_ = uv_hrtime();
         TRACE_EVENT_END0(TRACING_CATEGORY_NODE2(threadpoolwork, sync),
                          self->type_);
       },
       [](uv_work_t* req, int status) {
         ThreadPoolWork* self = ContainerOf(&ThreadPoolWork::work_req_, req);
-        self->env_->DecreaseWaitingRequestCounter();
-        TRACE_EVENT_NESTABLE_ASYNC_END1(
-            TRACING_CATEGORY_NODE2(threadpoolwork, async),
-            self->type_,
-            self,
-            "result",
-            status);
-        self->AfterThreadPoolWork(status);
+        self->env_->thread_pool_work_queue()->OnWorkDone(self);
+        self->Finish(status);
       });
   CHECK_EQ(status, 0);
 }
 
+void ThreadPoolWork::Finish(int status) {
+  env_->DecreaseWaitingRequestCounter();
+  TRACE_EVENT_NESTABLE_ASYNC_END1(
+      TRACING_CATEGORY_NODE2(threadpoolwork, async),
+      type_,
+      this,
+      "result",
+      status);
+  AfterThreadPoolWork(status);
+}
+
 int ThreadPoolWork::CancelWork() {
+  if (env_->thread_pool_work_queue()->Cancel(this)) return 0;
   return uv_cancel(reinterpret_cast<uv_req_t*>(&work_req_));
 }
 
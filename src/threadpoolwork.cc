@@ -0,0 +1,115 @@
+#include "threadpoolwork.h"
+
+#include <algorithm>
+
+#include "env-inl.h"
+#include "histogram-inl.h"
+#include "threadpoolwork-inl.h"
+
+namespace node {
+
+ThreadPoolWorkKind GetThreadPoolWorkKind(std::string_view type) {
+  if (type == "crypto") return ThreadPoolWorkKind::kCrypto;
+  if (type == "crypto_kdf") return ThreadPoolWorkKind::kCryptoKdf;
+  if (type == "zlib") return ThreadPoolWorkKind::kZlib;
+  if (type == "node_api") return ThreadPoolWorkKind::kNodeApi;
+  if (type.starts_with("node_sqlite3.")) return ThreadPoolWorkKind::kSQLite;
+  return ThreadPoolWorkKind::kOther;
+}
+
+std::optional<ThreadPoolWorkKind> ParseThreadPoolWorkKind(
+    std::string_view name) {
+#define V(Kind, kind_name)                                                     \
+  if (name == kind_name) return ThreadPoolWorkKind::Kind;
+  THREADPOOL_WORK_KINDS(V)
+#undef V
+  return std::nullopt;
+}
+
+void ThreadPoolWorkQueue::Schedule(ThreadPoolWork* work) {
+  Lane* lane = &lanes_[static_cast<size_t>(work->kind())];
+  lane->stats.scheduled++;
+  if (lane->pending.empty() &&
+      (lane->stats.limit == 0 || lane->stats.running < lane->stats.limit)) {
+    lane->stats.running++;
+    work->Submit();
+    return;
+  }
+  if (work->urgent_) {
+    lane->pending.push_front(work);
+  } else {
+    lane->pending.push_back(work);
+  }
+}
+
+bool ThreadPoolWorkQueue::Cancel(ThreadPoolWork* work) {
+  Lane* lane = &lanes_[static_cast<size_t>(work->kind())];
+  auto it = std::find(lane->pending.begin(), lane->pending.end(), work);
+  if (it == lane->pending.end()) return false;
+  lane->pending.erase(it);
+  // Like uv_cancel(), completion is reported asynchronously.
+  env_->SetImmediate([work](Environment* env) { work->Finish(UV_ECANCELED); });
+  return true;
+}
+
+void ThreadPoolWorkQueue::OnWorkDone(ThreadPoolWork* work) {
+  Lane* lane = &lanes_[static_cast<size_t>(work->kind())];
+  CHECK_GT(lane->stats.running, 0);
+  lane->stats.running--;
+  lane->stats.completed++;
+  uint64_t wait = work->wait_time();
+  lane->stats.total_wait_ns += wait;
+  lane->stats.max_wait_ns = std::max(lane->stats.max_wait_ns, wait);
+  // Work that was cancelled before it started has no timings.
+  if (lane->histograms.queue_time && work->started_at_ != 0) {
+    lane->histograms.queue_time->Record(wait);
+    lane->histograms.run_time->Record(work->run_time());
+  }
+  Drain(lane);
+}
+
+void ThreadPoolWorkQueue::SetLimit(ThreadPoolWorkKind kind, uint32_t limit) {
+  Lane* lane = &lanes_[static_cast<size_t>(kind)];
+  lane->stats.limit = limit;
+  Drain(lane);
+}
+
+const ThreadPoolWorkQueue::Histograms& ThreadPoolWorkQueue::EnableHistograms(
+    ThreadPoolWorkKind kind) {
+  Lane* lane = &lanes_[static_cast<size_t>(kind)];
+  if (!lane->histograms.queue_time) {
+    lane->histograms.queue_time =
+        std::make_shared<Histogram>(Histogram::Options{});
+    lane->histograms.run_time =
+        std::make_shared<Histogram>(Histogram::Options{});
+  }
+  return lane->histograms;
+}
+
+void ThreadPoolWorkQueue::DisableHistograms(ThreadPoolWorkKind kind) {
+  lanes_[static_cast<size_t>(kind)].histograms = {};
+}
+
+void ThreadPoolWorkQueue::Drain(Lane* lane) {
+  while (!lane->pending.empty() &&
+         (lane->stats.limit == 0 || lane->stats.running < lane->stats.limit)) {
+    ThreadPoolWork* work = lane->pending.front();
+    lane->pending.pop_front();
+    lane->stats.running++;
+    work->Submit();
+  }
+}
+
+void ThreadPoolWorkQueue::GetStats(double* fields) const {
+  for (const Lane& lane : lanes_) {
+    *fields++ = lane.stats.limit;
+    *fields++ = lane.stats.running;
+    *fields++ = static_cast<double>(lane.pending.size());
+    *fields++ = static_cast<double>(lane.stats.scheduled);
+    *fields++ = static_cast<double>(lane.stats.completed);
+    *fields++ = lane.stats.total_wait_ns / 1e6;
+    *fields++ = lane.stats.max_wait_ns / 1e6;
+  }
+}
+
+}  // namespace node
@@ -0,0 +1,115 @@
+#ifndef SRC_THREADPOOLWORK_H_
+#define SRC_THREADPOOLWORK_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <string_view>
+
+namespace node {
+
+class Environment;
+class Histogram;
+class ThreadPoolWork;
+
+// The kinds of ThreadPoolWork that can be limited independently, derived
+// from the type name passed to the ThreadPoolWork constructor.
+#define THREADPOOL_WORK_KINDS(V)                                               \
+  V(kCrypto, "crypto")                                                         \
+  V(kCryptoKdf, "crypto_kdf")                                                  \
+  V(kZlib, "zlib")                                                             \
+  V(kNodeApi, "node_api")                                                      \
+  V(kNodeApiBulk, "node_api_bulk")                                             \
+  V(kSQLite, "sqlite")                                                         \
+  V(kOther, "other")
+
+enum class ThreadPoolWorkKind : uint8_t {
+#define V(Kind, name) Kind,
+  THREADPOOL_WORK_KINDS(V)
+#undef V
+  kCount
+};
+
+constexpr size_t kThreadPoolWorkKindCount =
+    static_cast<size_t>(ThreadPoolWorkKind::kCount);
+
+ThreadPoolWorkKind GetThreadPoolWorkKind(std::string_view type);
+std::optional<ThreadPoolWorkKind> ParseThreadPoolWorkKind(
+    std::string_view name);
+
+// Per-Environment admission control in front of the libuv threadpool.
+// Every kind of work can be limited to a number of items submitted to libuv
+// at a time, the rest waits here in FIFO order. This keeps e.g. a burst of
+// pbkdf2 or gzip jobs from occupying all libuv threads and starving fs and
+// DNS requests, which use the pool directly. A limit of 0 means unlimited.
+// Only used on the thread of the Environment.
+class ThreadPoolWorkQueue {
+ public:
+  struct Stats {
+    uint32_t limit = 0;
+    uint32_t running = 0;
+    uint64_t scheduled = 0;
+    uint64_t completed = 0;
+    // Time from ScheduleWork() until a libuv thread picked the work up.
+    uint64_t total_wait_ns = 0;
+    uint64_t max_wait_ns = 0;
+  };
+
+  // Nanosecond histograms of the time work spends waiting for a thread
+  // (ScheduleWork() until DoThreadPoolWork() starts, including the time
+  // spent in this queue) and running on it.
+  struct Histograms {
+    std::shared_ptr<Histogram> queue_time;
+    std::shared_ptr<Histogram> run_time;
+  };
+
+  // The fields reported by GetStats() for each kind.
+  static constexpr size_t kStatsFieldCount = 7;
+
+  explicit ThreadPoolWorkQueue(Environment* env) : env_(env) {}
+
+  ThreadPoolWorkQueue(const ThreadPoolWorkQueue&) = delete;
+  ThreadPoolWorkQueue& operator=(const ThreadPoolWorkQueue&) = delete;
+
+  void Schedule(ThreadPoolWork* work);
+  // Returns false if the work is not waiting here, i.e. it has already been
+  // submitted to libuv.
+  bool Cancel(ThreadPoolWork* work);
+  // Called when work submitted to libuv has finished or was cancelled.
+  void OnWorkDone(ThreadPoolWork* work);
+
+  // Raising the limit submits waiting work right away, lowering it only
+  // affects work that has not been submitted yet.
+  void SetLimit(ThreadPoolWorkKind kind, uint32_t limit);
+  // Writes kStatsFieldCount fields for every kind into |fields|: limit,
+  // running, queued, scheduled, completed, total and max wait time in
+  // milliseconds.
+  void GetStats(double* fields) const;
+
+  // Histograms are only recorded into while enabled. Enabling them again
+  // returns the existing histograms.
+  const Histograms& EnableHistograms(ThreadPoolWorkKind kind);
+  void DisableHistograms(ThreadPoolWorkKind kind);
+
+ private:
+  struct Lane {
+    Stats stats;
+    std::deque<ThreadPoolWork*> pending;
+    Histograms histograms;
+  };
+
+  void Drain(Lane* lane);
+
+  Environment* env_;
+  std::array<Lane, kThreadPoolWorkKindCount> lanes_;
+};
+
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_THREADPOOLWORK_H_
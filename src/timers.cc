@@ -1,26 +1,356 @@
 #include "timers.h"
 
+#include "async_wrap-inl.h"
 #include "env-inl.h"
+#include "handle_wrap.h"
 #include "node_debug.h"
 #include "node_external_reference.h"
 #include "util-inl.h"
 #include "v8.h"
 
+#include <algorithm>
 #include <cstdint>
 
 namespace node {
 namespace timers {
 
+using v8::Array;
 using v8::Context;
 using v8::Function;
 using v8::FunctionCallbackInfo;
+using v8::FunctionTemplate;
+using v8::Global;
+using v8::HandleScope;
 using v8::Isolate;
 using v8::Local;
+using v8::LocalVector;
 using v8::Number;
 using v8::Object;
 using v8::ObjectTemplate;
 using v8::Value;
 
+TimerWheel::TimerWheel(uint64_t now) : now_(now) {
+  std::fill(std::begin(heads_), std::end(heads_), kNone);
+}
+
+TimerWheel::Id TimerWheel::Add(uint64_t expiry) {
+  uint32_t index;
+  if (!free_.empty()) {
+    index = free_.back();
+    free_.pop_back();
+  } else {
+    CHECK_LT(nodes_.size(), kNone);
+    index = static_cast<uint32_t>(nodes_.size());
+    nodes_.push_back({0, 0, kNone, kNone, kNone});
+  }
+  Node& node = nodes_[index];
+  node.expiry = std::max(expiry, now_ + 1);
+  Insert(index);
+  size_++;
+  return (static_cast<Id>(node.generation) << 32) | index;
+}
+
+bool TimerWheel::Cancel(Id id) {
+  uint64_t index = id & 0xffffffff;
+  if (index >= nodes_.size()) return false;
+  Node& node = nodes_[index];
+  if (node.slot == kNone || node.generation != (id >> 32)) return false;
+  Unlink(index);
+  Release(index);
+  return true;
+}
+
+void TimerWheel::Insert(uint32_t index) {
+  Node& node = nodes_[index];
+  uint64_t delta = node.expiry - now_;
+  uint32_t slot = kOverflowSlot;
+  for (int level = 0; level < kLevels; level++) {
+    if ((delta >> (kSlotBits * (level + 1))) == 0) {
+      slot = level * kSlots +
+             ((node.expiry >> (kSlotBits * level)) & (kSlots - 1));
+      break;
+    }
+  }
+  node.slot = slot;
+  node.prev = kNone;
+  node.next = heads_[slot];
+  if (node.next != kNone) nodes_[node.next].prev = index;
+  heads_[slot] = index;
+}
+
+void TimerWheel::Unlink(uint32_t index) {
+  Node& node = nodes_[index];
+  if (node.prev != kNone)
+    nodes_[node.prev].next = node.next;
+  else
+    heads_[node.slot] = node.next;
+  if (node.next != kNone) nodes_[node.next].prev = node.prev;
+  node.slot = kNone;
+}
+
+void TimerWheel::Release(uint32_t index) {
+  Node& node = nodes_[index];
+  node.generation = (node.generation + 1) & kGenerationMask;
+  free_.push_back(index);
+  size_--;
+}
+
+// Re-buckets every timer of a slot now that the wheel has reached it. Each
+// timer lands on a finer level, or expires if it is due at this very tick.
+void TimerWheel::Cascade(uint32_t slot, std::vector<Id>* expired) {
+  uint32_t index = heads_[slot];
+  heads_[slot] = kNone;
+  while (index != kNone) {
+    uint32_t next = nodes_[index].next;
+    if (nodes_[index].expiry <= now_) {
+      expired->push_back(
+          (static_cast<Id>(nodes_[index].generation) << 32) | index);
+      nodes_[index].slot = kNone;
+      Release(index);
+    } else {
+      Insert(index);
+    }
+    index = next;
+  }
+}
+
+void TimerWheel::Advance(uint64_t now, std::vector<Id>* expired) {
+  while (now_ < now) {
+    // Nothing can expire while the wheel is empty, so skip ahead.
+    if (size_ == 0) {
+      now_ = now;
+      return;
+    }
+    now_++;
+    for (int level = 1; level < kLevels; level++) {
+      if ((now_ & ((uint64_t{1} << (kSlotBits * level)) - 1)) != 0) break;
+      Cascade(level * kSlots + ((now_ >> (kSlotBits * level)) & (kSlots - 1)),
+              expired);
+      if (level == kLevels - 1) Cascade(kOverflowSlot, expired);
+    }
+    Cascade(now_ & (kSlots - 1), expired);
+  }
+}
+
+namespace {
+
+// JS-facing owner of a TimerWheel. One uv_timer_t ticks the wheel at the
+// configured resolution while it contains timers, and the identifiers of
+// expired timers are handed to the callback in one array per tick.
+class TimerWheelWrap : public HandleWrap {
+ public:
+  static void New(const FunctionCallbackInfo<Value>& args) {
+    CHECK(args.IsConstructCall());
+    CHECK(args[0]->IsUint32());
+    CHECK(args[1]->IsFunction());
+    Environment* env = Environment::GetCurrent(args);
+    uint32_t resolution = std::max(args[0].As<v8::Uint32>()->Value(), 1u);
+    new TimerWheelWrap(env, args.This(), resolution, args[1].As<Function>());
+  }
+
+  // add(delay) returns the identifier of a new timer that expires no
+  // earlier than `delay` milliseconds from now.
+  static void Add(const FunctionCallbackInfo<Value>& args) {
+    TimerWheelWrap* wrap;
+    ASSIGN_OR_RETURN_UNWRAP(&wrap, args.This());
+    CHECK(args[0]->IsNumber());
+    double delay = std::max(args[0].As<Number>()->Value(), 0.0);
+    uint64_t now = uv_now(wrap->env()->event_loop());
+    uint64_t deadline = now + static_cast<uint64_t>(delay);
+    uint64_t expiry =
+        (deadline + wrap->resolution_ - 1) / wrap->resolution_;
+    // An empty wheel is not ticked, so bring it up to date first.
+    if (wrap->wheel_.size() == 0)
+      wrap->wheel_.Advance(now / wrap->resolution_, &wrap->expired_);
+    TimerWheel::Id id = wrap->wheel_.Add(expiry);
+    if (wrap->wheel_.size() == 1 && !wrap->IsHandleClosing()) {
+      uv_timer_start(
+          &wrap->handle_, OnTick, wrap->resolution_, wrap->resolution_);
+    }
+    args.GetReturnValue().Set(static_cast<double>(id));
+  }
+
+  static void Cancel(const FunctionCallbackInfo<Value>& args) {
+    TimerWheelWrap* wrap;
+    ASSIGN_OR_RETURN_UNWRAP(&wrap, args.This());
+    CHECK(args[0]->IsNumber());
+    double value = args[0].As<Number>()->Value();
+    bool cancelled = value >= 0 && value < 9007199254740992.0 &&
+                     wrap->wheel_.Cancel(static_cast<TimerWheel::Id>(value));
+    if (wrap->wheel_.size() == 0) uv_timer_stop(&wrap->handle_);
+    args.GetReturnValue().Set(cancelled);
+  }
+
+  static void Size(const FunctionCallbackInfo<Value>& args) {
+    TimerWheelWrap* wrap;
+    ASSIGN_OR_RETURN_UNWRAP(&wrap, args.This());
+    args.GetReturnValue().Set(static_cast<double>(wrap->wheel_.size()));
+  }
+
+  SET_NO_MEMORY_INFO()
+  SET_MEMORY_INFO_NAME(TimerWheelWrap)
+  SET_SELF_SIZE(TimerWheelWrap)
+
+ private:
+  TimerWheelWrap(Environment* env,
+                 Local<Object> object,
+                 uint32_t resolution,
+                 Local<Function> callback)
+      : HandleWrap(env,
+                   object,
+                   reinterpret_cast<uv_handle_t*>(&handle_),
+                   AsyncWrap::PROVIDER_TIMERWHEEL),
+        resolution_(resolution),
+        wheel_(uv_now(env->event_loop()) / resolution),
+        callback_(env->isolate(), callback) {
+    CHECK_EQ(uv_timer_init(env->event_loop(), &handle_), 0);
+  }
+
+  static void OnTick(uv_timer_t* handle) {
+    TimerWheelWrap* wrap = ContainerOf(&TimerWheelWrap::handle_, handle);
+    Environment* env = wrap->env();
+    wrap->expired_.clear();
+    wrap->wheel_.Advance(uv_now(env->event_loop()) / wrap->resolution_,
+                         &wrap->expired_);
+    if (wrap->wheel_.size() == 0) uv_timer_stop(&wrap->handle_);
+    if (wrap->expired_.empty()) return;
+
+    HandleScope handle_scope(env->isolate());
+    Context::Scope context_scope(env->context());
+    LocalVector<Value> ids(env->isolate());
+    ids.reserve(wrap->expired_.size());
+    for (TimerWheel::Id id : wrap->expired_)
+      ids.push_back(Number::New(env->isolate(), static_cast<double>(id)));
+    Local<Value> arg = Array::New(env->isolate(), ids.data(), ids.size());
+    wrap->MakeCallback(wrap->callback_.Get(env->isolate()), 1, &arg);
+  }
+
+  uv_timer_t handle_;
+  const uint32_t resolution_;
+  TimerWheel wheel_;
+  std::vector<TimerWheel::Id> expired_;
+  Global<Function> callback_;
+};
+
+}  // anonymous namespace
+
+// Fires deadlines that do not need the precision of regular timers, such as
+// those of AbortSignal.timeout(). All of them share one unref'd uv_timer_t
+// and one TimerWheel whose ticks are `resolution` milliseconds long, so a
+// deadline fires at most one tick late, never early, and all deadlines that
+// fall into the same tick are delivered to JS in a single call.
+class DeadlineScheduler {
+ public:
+  DeadlineScheduler(BindingData* binding,
+                    Local<Function> callback,
+                    uint32_t resolution)
+      : env_(binding->env()),
+        resolution_(resolution),
+        wheel_(uv_now(env_->event_loop()) / resolution),
+        receiver_(env_->isolate(), binding->object()),
+        callback_(env_->isolate(), callback) {
+    CHECK_EQ(uv_timer_init(env_->event_loop(), &timer_), 0);
+    uv_unref(reinterpret_cast<uv_handle_t*>(&timer_));
+    env_->AddCleanupHook(Cleanup, this);
+  }
+
+  TimerWheel::Id Schedule(double delay) {
+    uint64_t now = uv_now(env_->event_loop());
+    uint64_t deadline = now + static_cast<uint64_t>(std::max(delay, 0.0));
+    if (wheel_.size() == 0) {
+      wheel_.Advance(now / resolution_, &expired_);
+      uv_timer_start(&timer_, OnTick, resolution_, resolution_);
+    }
+    return wheel_.Add((deadline + resolution_ - 1) / resolution_);
+  }
+
+  bool Cancel(TimerWheel::Id id) {
+    bool cancelled = wheel_.Cancel(id);
+    if (wheel_.size() == 0) uv_timer_stop(&timer_);
+    return cancelled;
+  }
+
+ private:
+  static void Cleanup(void* data) {
+    DeadlineScheduler* scheduler = static_cast<DeadlineScheduler*>(data);
+    scheduler->env_->CloseHandle(&scheduler->timer_, [](uv_timer_t* handle) {
+      DeadlineScheduler* scheduler =
+          ContainerOf(&DeadlineScheduler::timer_, handle);
+      delete scheduler;
+    });
+  }
+
+  static void OnTick(uv_timer_t* handle) {
+    DeadlineScheduler* scheduler =
+        ContainerOf(&DeadlineScheduler::timer_, handle);
+    Environment* env = scheduler->env_;
+    scheduler->expired_.clear();
+    uint64_t now = uv_now(env->event_loop());
+    scheduler->wheel_.Advance(now / scheduler->resolution_,
+                              &scheduler->expired_);
+    if (scheduler->wheel_.size() == 0) uv_timer_stop(&scheduler->timer_);
+    if (scheduler->expired_.empty() || !env->can_call_into_js()) return;
+
+    Isolate* isolate = env->isolate();
+    HandleScope handle_scope(isolate);
+    Context::Scope context_scope(env->context());
+    LocalVector<Value> ids(isolate);
+    ids.reserve(scheduler->expired_.size());
+    for (TimerWheel::Id id : scheduler->expired_)
+      ids.push_back(Number::New(isolate, static_cast<double>(id)));
+    Local<Value> arg = Array::New(isolate, ids.data(), ids.size());
+
+    Local<Object> receiver = scheduler->receiver_.Get(isolate);
+    InternalCallbackScope scope(env, receiver, {0, 0});
+    if (scheduler->callback_.Get(isolate)
+            ->Call(env->context(), receiver, 1, &arg)
+            .IsEmpty()) {
+      scope.MarkAsFailed();
+    }
+  }
+
+  Environment* env_;
+  uv_timer_t timer_;
+  const uint32_t resolution_;
+  TimerWheel wheel_;
+  std::vector<TimerWheel::Id> expired_;
+  Global<Object> receiver_;
+  Global<Function> callback_;
+};
+
+// setupDeadlines(callback, resolution)
+void BindingData::SetupDeadlines(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args[0]->IsFunction());
+  CHECK(args[1]->IsUint32());
+  BindingData* binding = Realm::GetBindingData<BindingData>(args);
+  CHECK_NULL(binding->deadlines_);
+  uint32_t resolution = std::max(args[1].As<v8::Uint32>()->Value(), 1u);
+  binding->deadlines_ =
+      new DeadlineScheduler(binding, args[0].As<Function>(), resolution);
+}
+
+// scheduleDeadline(delay) returns an identifier that is passed to the
+// deadline callback once `delay` milliseconds have passed.
+void BindingData::ScheduleDeadline(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args[0]->IsNumber());
+  BindingData* binding = Realm::GetBindingData<BindingData>(args);
+  CHECK_NOT_NULL(binding->deadlines_);
+  TimerWheel::Id id =
+      binding->deadlines_->Schedule(args[0].As<Number>()->Value());
+  args.GetReturnValue().Set(static_cast<double>(id));
+}
+
+void BindingData::CancelDeadline(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args[0]->IsNumber());
+  BindingData* binding = Realm::GetBindingData<BindingData>(args);
+  CHECK_NOT_NULL(binding->deadlines_);
+  double value = args[0].As<Number>()->Value();
+  bool cancelled = value >= 0 && value < 9007199254740992.0 &&
+                   binding->deadlines_->Cancel(
+                       static_cast<TimerWheel::Id>(value));
+  args.GetReturnValue().Set(cancelled);
+}
+
 void BindingData::SetupTimers(const FunctionCallbackInfo<Value>& args) {
   CHECK(args[0]->IsFunction());
   CHECK(args[1]->IsFunction());
@@ -138,6 +468,20 @@ void BindingData::CreatePerIsolateProperties(IsolateData* isolate_data,
   Isolate* isolate = isolate_data->isolate();
 
   SetMethod(isolate, target, "setupTimers", SetupTimers);
+
+  Local<FunctionTemplate> wheel =
+      NewFunctionTemplate(isolate, TimerWheelWrap::New);
+  wheel->InstanceTemplate()->SetInternalFieldCount(
+      TimerWheelWrap::kInternalFieldCount);
+  wheel->Inherit(HandleWrap::GetConstructorTemplate(isolate_data));
+  SetProtoMethod(isolate, wheel, "add", TimerWheelWrap::Add);
+  SetProtoMethod(isolate, wheel, "cancel", TimerWheelWrap::Cancel);
+  SetProtoMethod(isolate, wheel, "size", TimerWheelWrap::Size);
+  SetConstructorFunction(isolate, target, "TimerWheel", wheel);
+
+  SetMethod(isolate, target, "setupDeadlines", SetupDeadlines);
+  SetMethod(isolate, target, "scheduleDeadline", ScheduleDeadline);
+  SetMethod(isolate, target, "cancelDeadline", CancelDeadline);
   SetFastMethod(
       isolate, target, "getLibuvNow", SlowGetLibuvNow, &fast_get_libuv_now_);
   SetFastMethod(isolate,
@@ -183,6 +527,13 @@ void BindingData::CreatePerContextProperties(Local<Object> target,
 void BindingData::RegisterTimerExternalReferences(
     ExternalReferenceRegistry* registry) {
   registry->Register(SetupTimers);
+  registry->Register(TimerWheelWrap::New);
+  registry->Register(TimerWheelWrap::Add);
+  registry->Register(TimerWheelWrap::Cancel);
+  registry->Register(TimerWheelWrap::Size);
+  registry->Register(SetupDeadlines);
+  registry->Register(ScheduleDeadline);
+  registry->Register(CancelDeadline);
 
   registry->Register(SlowGetLibuvNow);
   registry->Register(FastGetLibuvNow);
@@ -4,12 +4,71 @@
 #if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
 
 #include <cinttypes>
+#include <vector>
 #include "node_snapshotable.h"
 
 namespace node {
 class ExternalReferenceRegistry;
 
 namespace timers {
+
+// A hierarchical timing wheel. Timers are kept in four levels of 256 slots,
+// where a slot on level n covers 256^n ticks; timers are moved to a finer
+// level when the wheel reaches their slot. Adding and cancelling a timer is
+// O(1), and advancing the wheel is O(1) per tick plus O(1) per expired or
+// re-bucketed timer, independent of the total number of timers.
+// Times are expressed in ticks; the caller decides how long a tick is.
+class TimerWheel {
+ public:
+  // Identifiers stay below 2^53 so that they can be passed to JS as Numbers.
+  using Id = uint64_t;
+
+  explicit TimerWheel(uint64_t now = 0);
+
+  // Schedules a timer that expires at the given tick. Timers that are
+  // already due expire on the next call to Advance().
+  Id Add(uint64_t expiry);
+  // Returns false if the timer does not exist or has already expired.
+  bool Cancel(Id id);
+  // Moves the wheel forward to `now` and appends the identifiers of all
+  // timers that expired on the way to `expired`, in expiry order.
+  void Advance(uint64_t now, std::vector<Id>* expired);
+
+  size_t size() const { return size_; }
+  uint64_t now() const { return now_; }
+
+ private:
+  static constexpr uint32_t kNone = UINT32_MAX;
+  static constexpr int kLevels = 4;
+  static constexpr int kSlotBits = 8;
+  static constexpr uint32_t kSlots = 1 << kSlotBits;
+  // Far-future timers that do not fit on the wheel are kept in one extra
+  // list that is re-examined each time the top level turns.
+  static constexpr uint32_t kOverflowSlot = kLevels * kSlots;
+  static constexpr uint32_t kGenerationMask = (1 << 21) - 1;
+
+  struct Node {
+    uint64_t expiry;
+    uint32_t generation;
+    uint32_t prev;
+    uint32_t next;
+    uint32_t slot;  // kNone while the node is on the free list
+  };
+
+  void Insert(uint32_t index);
+  void Unlink(uint32_t index);
+  void Release(uint32_t index);
+  void Cascade(uint32_t slot, std::vector<Id>* expired);
+
+  std::vector<Node> nodes_;
+  std::vector<uint32_t> free_;
+  uint32_t heads_[kOverflowSlot + 1];
+  uint64_t now_;
+  size_t size_ = 0;
+};
+
+class DeadlineScheduler;
+
 class BindingData : public SnapshotableObject {
  public:
   BindingData(Realm* env, v8::Local<v8::Object> obj);
@@ -50,6 +109,11 @@ class BindingData : public SnapshotableObject {
                                      bool ref);
   static void ToggleImmediateRefImpl(BindingData* data, bool ref);
 
+  static void SetupDeadlines(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void ScheduleDeadline(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void CancelDeadline(const v8::FunctionCallbackInfo<v8::Value>& args);
+
   static void CreatePerIsolateProperties(IsolateData* isolate_data,
                                          v8::Local<v8::ObjectTemplate> target);
   static void CreatePerContextProperties(v8::Local<v8::Object> target,
@@ -64,6 +128,10 @@ class BindingData : public SnapshotableObject {
   static v8::CFunction fast_schedule_timers_;
   static v8::CFunction fast_toggle_timer_ref_;
   static v8::CFunction fast_toggle_immediate_ref_;
+
+  // Coalesces deadlines such as AbortSignal.timeout(), created lazily by
+  // setupDeadlines() and owned by the Environment cleanup hooks.
+  DeadlineScheduler* deadlines_ = nullptr;
 };
 
 }  // namespace timers
@@ -1,34 +1,75 @@
 #include "tracing/node_trace_buffer.h"
 
 #include <memory>
+#include <thread>
 #include "util-inl.h"
 
 namespace node {
 namespace tracing {
 
+namespace {
+
+std::atomic<uint64_t> next_generation{1};
+
+// The chunk the current thread is filling.
+struct ThreadChunk {
+  const InternalTraceBuffer* buffer = nullptr;
+  uint64_t generation = 0;
+  size_t index = 0;
+};
+
+thread_local ThreadChunk thread_chunk;
+
+}  // namespace
+
 InternalTraceBuffer::InternalTraceBuffer(size_t max_chunks, uint32_t id,
                                          Agent* agent)
     : flushing_(false), max_chunks_(max_chunks),
-      agent_(agent), id_(id) {
+      agent_(agent), generation_(next_generation++), id_(id) {
   chunks_.resize(max_chunks);
 }
 
-TraceObject* InternalTraceBuffer::AddTraceEvent(uint64_t* handle) {
+size_t InternalTraceBuffer::ReserveChunk(uint64_t* generation) {
   Mutex::ScopedLock scoped_lock(mutex_);
-  // Create new chunk if last chunk is full or there is no chunk.
-  if (total_chunks_ == 0 || chunks_[total_chunks_ - 1]->IsFull()) {
-    auto& chunk = chunks_[total_chunks_++];
-    if (chunk) {
-      chunk->Reset(current_chunk_seq_++);
-    } else {
-      chunk = std::make_unique<TraceBufferChunk>(current_chunk_seq_++);
+  *generation = generation_.load(std::memory_order_relaxed);
+  size_t index = total_chunks_.load(std::memory_order_relaxed);
+  if (index == max_chunks_) return max_chunks_;
+  auto& chunk = chunks_[index];
+  if (chunk) {
+    chunk->Reset(current_chunk_seq_++);
+  } else {
+    chunk = std::make_unique<TraceBufferChunk>(current_chunk_seq_++);
+  }
+  total_chunks_.store(index + 1, std::memory_order_release);
+  return index;
+}
+
+TraceObject* InternalTraceBuffer::AddTraceEvent(uint64_t* handle) {
+  ThreadChunk& current = thread_chunk;
+  while (true) {
+    writers_.fetch_add(1, std::memory_order_seq_cst);
+    uint64_t generation = generation_.load(std::memory_order_seq_cst);
+    if (current.buffer == this && current.generation == generation &&
+        !chunks_[current.index]->IsFull()) {
+      auto& chunk = chunks_[current.index];
+      size_t event_index;
+      TraceObject* trace_object = chunk->AddTraceEvent(&event_index);
+      *handle = MakeHandle(current.index, chunk->seq(), event_index);
+      writers_.fetch_sub(1, std::memory_order_release);
+      return trace_object;
     }
+    writers_.fetch_sub(1, std::memory_order_release);
+
+    // The thread has no usable chunk in this generation, take a new one.
+    size_t index = ReserveChunk(&generation);
+    if (index == max_chunks_) {
+      current.buffer = nullptr;
+      return nullptr;
+    }
+    current.buffer = this;
+    current.generation = generation;
+    current.index = index;
   }
-  auto& chunk = chunks_[total_chunks_ - 1];
-  size_t event_index;
-  TraceObject* trace_object = chunk->AddTraceEvent(&event_index);
-  *handle = MakeHandle(total_chunks_ - 1, chunk->seq(), event_index);
-  return trace_object;
 }
 
 TraceObject* InternalTraceBuffer::GetEventByHandle(uint64_t handle) {
@@ -40,7 +81,8 @@ TraceObject* InternalTraceBuffer::GetEventByHandle(uint64_t handle) {
   size_t chunk_index, event_index;
   uint32_t buffer_id, chunk_seq;
   ExtractHandle(handle, &buffer_id, &chunk_index, &chunk_seq, &event_index);
-  if (buffer_id != id_ || chunk_index >= total_chunks_) {
+  if (buffer_id != id_ ||
+      chunk_index >= total_chunks_.load(std::memory_order_relaxed)) {
     // Either the chunk belongs to the other buffer, or is outside the current
     // range of chunks loaded in memory (the latter being true suggests that
     // the chunk has already been flushed and is no longer in memory.)
@@ -57,9 +99,16 @@ TraceObject* InternalTraceBuffer::GetEventByHandle(uint64_t handle) {
 void InternalTraceBuffer::Flush(bool blocking) {
   {
     Mutex::ScopedLock scoped_lock(mutex_);
-    if (total_chunks_ > 0) {
+    size_t total_chunks = total_chunks_.load(std::memory_order_relaxed);
+    if (total_chunks > 0) {
       flushing_ = true;
-      for (size_t i = 0; i < total_chunks_; ++i) {
+      // Retire the chunks held by writer threads, then wait for those that
+      // already passed the generation check to finish adding their event.
+      generation_.store(next_generation++, std::memory_order_seq_cst);
+      while (writers_.load(std::memory_order_seq_cst) != 0) {
+        std::this_thread::yield();
+      }
+      for (size_t i = 0; i < total_chunks; ++i) {
         auto& chunk = chunks_[i];
         for (size_t j = 0; j < chunk->size(); ++j) {
           TraceObject* trace_event = chunk->GetEventAt(j);
@@ -71,7 +120,7 @@ void InternalTraceBuffer::Flush(bool blocking) {
           }
         }
       }
-      total_chunks_ = 0;
+      total_chunks_.store(0, std::memory_order_release);
       flushing_ = false;
     }
   }
@@ -121,15 +170,19 @@ NodeTraceBuffer::~NodeTraceBuffer() {
 }
 
 TraceObject* NodeTraceBuffer::AddTraceEvent(uint64_t* handle) {
-  // If the buffer is full, attempt to perform a flush.
-  if (!TryLoadAvailableBuffer()) {
-    // Assign a value of zero as the trace event handle.
-    // This is equivalent to calling InternalTraceBuffer::MakeHandle(0, 0, 0),
-    // and will cause GetEventByHandle to return NULL if passed as an argument.
-    *handle = 0;
-    return nullptr;
+  // If the buffer is full, attempt to perform a flush. The buffer may also
+  // run out of chunks after the check, in which case we retry once with the
+  // other buffer.
+  for (int attempt = 0; attempt < 2; attempt++) {
+    if (!TryLoadAvailableBuffer()) break;
+    TraceObject* trace_object = current_buf_.load()->AddTraceEvent(handle);
+    if (trace_object != nullptr) return trace_object;
   }
-  return current_buf_.load()->AddTraceEvent(handle);
+  // Assign a value of zero as the trace event handle.
+  // This is equivalent to calling InternalTraceBuffer::MakeHandle(0, 0, 0),
+  // and will cause GetEventByHandle to return NULL if passed as an argument.
+  *handle = 0;
+  return nullptr;
 }
 
 TraceObject* NodeTraceBuffer::GetEventByHandle(uint64_t handle) {
@@ -17,21 +17,31 @@ using v8::platform::tracing::TraceObject;
 // forward declaration
 class NodeTraceBuffer;
 
+// Each thread that adds trace events reserves a whole chunk under |mutex_|
+// and then fills it without locking, so the lock is taken once per
+// TraceBufferChunk::kChunkSize events instead of once per event.
+// A flush starts a new generation, which makes threads drop the chunks they
+// hold, and waits for the writers that are still inside a chunk to leave.
 class InternalTraceBuffer {
  public:
   InternalTraceBuffer(size_t max_chunks, uint32_t id, Agent* agent);
 
+  // Returns nullptr if all chunks have been handed out.
   TraceObject* AddTraceEvent(uint64_t* handle);
   TraceObject* GetEventByHandle(uint64_t handle);
   void Flush(bool blocking);
   bool IsFull() const {
-    return total_chunks_ == max_chunks_ && chunks_[total_chunks_ - 1]->IsFull();
+    return total_chunks_.load(std::memory_order_acquire) == max_chunks_;
   }
   bool IsFlushing() const {
     return flushing_;
   }
 
  private:
+  // Returns the index of a newly reserved chunk and the generation it
+  // belongs to, or max_chunks_ if full.
+  size_t ReserveChunk(uint64_t* generation);
+
   uint64_t MakeHandle(size_t chunk_index, uint32_t chunk_seq,
                       size_t event_index) const;
   void ExtractHandle(uint64_t handle, uint32_t* buffer_id, size_t* chunk_index,
@@ -43,7 +53,13 @@ class InternalTraceBuffer {
   size_t max_chunks_;
   Agent* agent_;
   std::vector<std::unique_ptr<TraceBufferChunk>> chunks_;
-  size_t total_chunks_ = 0;
+  std::atomic<size_t> total_chunks_{0};
+  // Number of threads currently adding an event to all chunks handed out in
+  // this generation. A flush waits for it to drop to zero.
+  std::atomic<size_t> writers_{0};
+  // Unique across all buffers, so that a stale thread-local reservation is
+  // never mistaken for a current one.
+  std::atomic<uint64_t> generation_;
   uint32_t current_chunk_seq_ = 1;
   uint32_t id_;
 };
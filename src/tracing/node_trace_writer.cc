@@ -1,5 +1,6 @@
 #include "tracing/node_trace_writer.h"
 
+#include "tracing/perfetto_trace_writer.h"
 #include "util-inl.h"
 
 #include <fcntl.h>
@@ -8,8 +9,12 @@
 namespace node {
 namespace tracing {
 
-NodeTraceWriter::NodeTraceWriter(const std::string& log_file_pattern)
-    : log_file_pattern_(log_file_pattern) {}
+NodeTraceWriter::NodeTraceWriter(const std::string& log_file_pattern,
+                                 Format format,
+                                 Compression compression)
+    : log_file_pattern_(log_file_pattern),
+      format_(format),
+      compression_(compression) {}
 
 void NodeTraceWriter::InitializeOnThread(uv_loop_t* loop) {
   CHECK_NULL(tracing_loop_);
@@ -58,6 +63,9 @@ NodeTraceWriter::~NodeTraceWriter() {
   while (!exited_) {
     exit_cond_.Wait(scoped_lock);
   }
+  if (zstd_context_ != nullptr) {
+    ZSTD_freeCCtx(zstd_context_);
+  }
 }
 
 void replace_substring(std::string* target,
@@ -101,34 +109,44 @@ void NodeTraceWriter::AppendTraceEvent(TraceObject* trace_event) {
   // If this is the first trace event, open a new file for streaming.
   if (total_traces_ == 0) {
     OpenNewFileForStreaming();
-    // Constructing a new JSONTraceWriter object appends "{\"traceEvents\":["
-    // to stream_.
-    // In other words, the constructor initializes the serialization stream
-    // to a state where we can start writing trace events to it.
-    // Repeatedly constructing and destroying json_trace_writer_ allows
-    // us to use V8's JSON writer instead of implementing our own.
-    json_trace_writer_.reset(TraceWriter::CreateJSONTraceWriter(stream_));
+    if (format_ == Format::kPerfetto) {
+      // Perfetto traces are a plain sequence of packets without a header.
+      trace_writer_ = std::make_unique<PerfettoTraceWriter>(stream_);
+    } else {
+      // Constructing a new JSONTraceWriter object appends
+      // "{\"traceEvents\":[" to stream_.
+      // In other words, the constructor initializes the serialization stream
+      // to a state where we can start writing trace events to it.
+      // Repeatedly constructing and destroying trace_writer_ allows
+      // us to use V8's JSON writer instead of implementing our own.
+      trace_writer_.reset(TraceWriter::CreateJSONTraceWriter(stream_));
+    }
   }
   ++total_traces_;
-  json_trace_writer_->AppendTraceEvent(trace_event);
+  trace_writer_->AppendTraceEvent(trace_event);
 }
 
 void NodeTraceWriter::FlushPrivate() {
   std::string str;
   int highest_request_id;
+  bool end_of_file = false;
   {
     Mutex::ScopedLock stream_scoped_lock(stream_mutex_);
     if (total_traces_ >= kTracesPerFile) {
       total_traces_ = 0;
       // Destroying the member JSONTraceWriter object appends "]}" to
       // stream_ - in other words, ending a JSON file.
-      json_trace_writer_.reset();
+      trace_writer_.reset();
+      end_of_file = true;
     }
     // str() makes a copy of the contents of the stream.
     str = stream_.str();
     stream_.str("");
     stream_.clear();
   }
+  if (compression_ == Compression::kZstd && (!str.empty() || end_of_file)) {
+    str = Compress(str, end_of_file);
+  }
   {
     Mutex::ScopedLock request_scoped_lock(request_mutex_);
     highest_request_id = num_write_requests_;
@@ -136,14 +154,42 @@ void NodeTraceWriter::FlushPrivate() {
   WriteToFile(std::move(str), highest_request_id);
 }
 
+std::string NodeTraceWriter::Compress(const std::string& str,
+                                      bool end_of_file) {
+  if (zstd_context_ == nullptr) {
+    zstd_context_ = ZSTD_createCCtx();
+    CHECK_NOT_NULL(zstd_context_);
+  }
+  std::string result;
+  std::vector<char> out(ZSTD_CStreamOutSize());
+  ZSTD_inBuffer input = {str.data(), str.size(), 0};
+  // Flushing after every part keeps what is on disk decodable even if the
+  // process dies before the frame is ended.
+  ZSTD_EndDirective mode = end_of_file ? ZSTD_e_end : ZSTD_e_flush;
+  size_t remaining;
+  do {
+    ZSTD_outBuffer output = {out.data(), out.size(), 0};
+    remaining = ZSTD_compressStream2(zstd_context_, &output, &input, mode);
+    if (ZSTD_isError(remaining)) {
+      fprintf(stderr,
+              "Could not compress trace events: %s\n",
+              ZSTD_getErrorName(remaining));
+      ZSTD_CCtx_reset(zstd_context_, ZSTD_reset_session_only);
+      return result;
+    }
+    result.append(out.data(), output.pos);
+  } while (remaining != 0);
+  return result;
+}
+
 void NodeTraceWriter::Flush(bool blocking) {
   Mutex::ScopedLock scoped_lock(request_mutex_);
   {
     // We need to lock the mutexes here in a nested fashion; stream_mutex_
-    // protects json_trace_writer_, and without request_mutex_ there might be
+    // protects trace_writer_, and without request_mutex_ there might be
     // a time window in which the stream state changes?
     Mutex::ScopedLock stream_mutex_lock(stream_mutex_);
-    if (!json_trace_writer_)
+    if (!trace_writer_)
       return;
   }
   int request_id = ++num_write_requests_;
@@ -0,0 +1,187 @@
+#include "tracing/perfetto_trace_writer.h"
+
+#include <cstring>
+#include "tracing/trace_event_common.h"
+
+namespace node {
+namespace tracing {
+
+using v8::platform::tracing::TracingController;
+
+namespace {
+
+// Field numbers from protos/perfetto/trace/trace.proto,
+// trace_packet.proto and chrome/chrome_trace_event.proto.
+constexpr uint32_t kTracePacket = 1;              // Trace.packet
+constexpr uint32_t kPacketChromeEvents = 5;       // TracePacket.chrome_events
+constexpr uint32_t kBundleTraceEvents = 1;        // ChromeEventBundle
+constexpr uint32_t kEventName = 1;
+constexpr uint32_t kEventTimestamp = 2;
+constexpr uint32_t kEventPhase = 3;
+constexpr uint32_t kEventThreadId = 4;
+constexpr uint32_t kEventDuration = 5;
+constexpr uint32_t kEventThreadDuration = 6;
+constexpr uint32_t kEventScope = 7;
+constexpr uint32_t kEventId = 8;
+constexpr uint32_t kEventFlags = 9;
+constexpr uint32_t kEventCategoryGroupName = 10;
+constexpr uint32_t kEventProcessId = 11;
+constexpr uint32_t kEventThreadTimestamp = 12;
+constexpr uint32_t kEventBindId = 13;
+constexpr uint32_t kEventArgs = 14;
+constexpr uint32_t kArgName = 1;
+constexpr uint32_t kArgBool = 2;
+constexpr uint32_t kArgUint = 3;
+constexpr uint32_t kArgInt = 4;
+constexpr uint32_t kArgDouble = 5;
+constexpr uint32_t kArgString = 6;
+constexpr uint32_t kArgPointer = 7;
+constexpr uint32_t kArgJson = 8;
+
+enum WireType : uint32_t {
+  kVarInt = 0,
+  kFixed64 = 1,
+  kLengthDelimited = 2,
+};
+
+void AppendVarInt(std::string* out, uint64_t value) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<char>(value));
+}
+
+void AppendTag(std::string* out, uint32_t field, WireType type) {
+  AppendVarInt(out, (static_cast<uint64_t>(field) << 3) | type);
+}
+
+void AppendVarIntField(std::string* out, uint32_t field, uint64_t value) {
+  AppendTag(out, field, kVarInt);
+  AppendVarInt(out, value);
+}
+
+// int32/int64 fields are encoded as the two's complement of the 64-bit value.
+void AppendIntField(std::string* out, uint32_t field, int64_t value) {
+  AppendVarIntField(out, field, static_cast<uint64_t>(value));
+}
+
+void AppendDoubleField(std::string* out, uint32_t field, double value) {
+  AppendTag(out, field, kFixed64);
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  for (int i = 0; i < 8; i++) {
+    out->push_back(static_cast<char>(bits & 0xff));
+    bits >>= 8;
+  }
+}
+
+void AppendBytesField(std::string* out,
+                      uint32_t field,
+                      const char* data,
+                      size_t length) {
+  AppendTag(out, field, kLengthDelimited);
+  AppendVarInt(out, length);
+  out->append(data, length);
+}
+
+void AppendStringField(std::string* out, uint32_t field, const char* value) {
+  AppendBytesField(out, field, value, strlen(value));
+}
+
+void AppendMessageField(std::string* out,
+                        uint32_t field,
+                        const std::string& message) {
+  AppendBytesField(out, field, message.data(), message.size());
+}
+
+}  // namespace
+
+void PerfettoTraceWriter::AppendTraceEvent(TraceObject* trace_event) {
+  event_.clear();
+  AppendStringField(&event_, kEventName, trace_event->name());
+  AppendIntField(&event_, kEventTimestamp, trace_event->ts());
+  AppendIntField(&event_, kEventPhase, trace_event->phase());
+  AppendIntField(&event_, kEventThreadId, trace_event->tid());
+  AppendIntField(&event_, kEventProcessId, trace_event->pid());
+  AppendStringField(
+      &event_,
+      kEventCategoryGroupName,
+      TracingController::GetCategoryGroupName(
+          trace_event->category_enabled_flag()));
+  if (trace_event->phase() == TRACE_EVENT_PHASE_COMPLETE) {
+    AppendIntField(&event_, kEventDuration, trace_event->duration());
+    AppendIntField(&event_, kEventThreadDuration, trace_event->cpu_duration());
+  }
+  if (trace_event->tts() != 0) {
+    AppendIntField(&event_, kEventThreadTimestamp, trace_event->tts());
+  }
+  if (trace_event->scope() != nullptr) {
+    AppendStringField(&event_, kEventScope, trace_event->scope());
+  }
+  if (trace_event->flags() &
+      (TRACE_EVENT_FLAG_HAS_ID | TRACE_EVENT_FLAG_HAS_LOCAL_ID |
+       TRACE_EVENT_FLAG_HAS_GLOBAL_ID)) {
+    AppendVarIntField(&event_, kEventId, trace_event->id());
+  }
+  if (trace_event->bind_id() != 0) {
+    AppendVarIntField(&event_, kEventBindId, trace_event->bind_id());
+  }
+  AppendVarIntField(&event_, kEventFlags, trace_event->flags());
+
+  const char** arg_names = trace_event->arg_names();
+  const uint8_t* arg_types = trace_event->arg_types();
+  TraceObject::ArgValue* arg_values = trace_event->arg_values();
+  auto* arg_convertables = trace_event->arg_convertables();
+  for (int i = 0; i < trace_event->num_args(); i++) {
+    arg_.clear();
+    AppendStringField(&arg_, kArgName, arg_names[i]);
+    const TraceObject::ArgValue& value = arg_values[i];
+    switch (arg_types[i]) {
+      case TRACE_VALUE_TYPE_BOOL:
+        AppendVarIntField(&arg_, kArgBool, value.as_uint ? 1 : 0);
+        break;
+      case TRACE_VALUE_TYPE_UINT:
+        AppendVarIntField(&arg_, kArgUint, value.as_uint);
+        break;
+      case TRACE_VALUE_TYPE_INT:
+        AppendIntField(&arg_, kArgInt, value.as_int);
+        break;
+      case TRACE_VALUE_TYPE_DOUBLE:
+        AppendDoubleField(&arg_, kArgDouble, value.as_double);
+        break;
+      case TRACE_VALUE_TYPE_POINTER:
+        AppendVarIntField(&arg_,
+                          kArgPointer,
+                          reinterpret_cast<uintptr_t>(value.as_pointer));
+        break;
+      case TRACE_VALUE_TYPE_STRING:
+      case TRACE_VALUE_TYPE_COPY_STRING:
+        AppendStringField(&arg_,
+                          kArgString,
+                          value.as_string != nullptr ? value.as_string : "");
+        break;
+      case TRACE_VALUE_TYPE_CONVERTABLE: {
+        std::string json;
+        arg_convertables[i]->AppendAsTraceFormat(&json);
+        AppendMessageField(&arg_, kArgJson, json);
+        break;
+      }
+      default:
+        continue;
+    }
+    AppendMessageField(&event_, kEventArgs, arg_);
+  }
+
+  // Trace { TracePacket { ChromeEventBundle { ChromeTraceEvent } } }
+  arg_.clear();
+  AppendMessageField(&arg_, kBundleTraceEvents, event_);
+  packet_.clear();
+  AppendMessageField(&packet_, kPacketChromeEvents, arg_);
+  event_.clear();
+  AppendMessageField(&event_, kTracePacket, packet_);
+  stream_.write(event_.data(), event_.size());
+}
+
+}  // namespace tracing
+}  // namespace node
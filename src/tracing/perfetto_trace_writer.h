@@ -0,0 +1,39 @@
+#ifndef SRC_TRACING_PERFETTO_TRACE_WRITER_H_
+#define SRC_TRACING_PERFETTO_TRACE_WRITER_H_
+
+#include <ostream>
+#include <string>
+
+#include "libplatform/v8-tracing.h"
+
+namespace node {
+namespace tracing {
+
+using v8::platform::tracing::TraceObject;
+using v8::platform::tracing::TraceWriter;
+
+// Serializes trace events as a stream of Perfetto TracePacket messages
+// (https://perfetto.dev/docs/reference/trace-packet-proto). Each event is
+// written as a legacy ChromeTraceEvent inside a ChromeEventBundle, which
+// carries the same information as the JSON format. Since a trace is just a
+// sequence of packets, the output can be cut and concatenated at any event
+// boundary and needs no header or footer.
+class PerfettoTraceWriter : public TraceWriter {
+ public:
+  explicit PerfettoTraceWriter(std::ostream& stream) : stream_(stream) {}
+
+  void AppendTraceEvent(TraceObject* trace_event) override;
+  void Flush() override {}
+
+ private:
+  std::ostream& stream_;
+  // Reused across events to avoid reallocating.
+  std::string event_;
+  std::string arg_;
+  std::string packet_;
+};
+
+}  // namespace tracing
+}  // namespace node
+
+#endif  // SRC_TRACING_PERFETTO_TRACE_WRITER_H_
@@ -170,6 +170,22 @@ enum CategoryGroupEnabledFlags {
       category_group, INTERNAL_TRACE_EVENT_UID(atomic),                    \
       INTERNAL_TRACE_EVENT_UID(category_group_enabled));
 
+// Returns whether the literal `category_group` is enabled. Like the
+// TRACE_EVENT macros, this looks up the enabled state once and caches the
+// pointer to it in a static, so the check is a single load when tracing is
+// off. Use it instead of TRACE_EVENT_API_GET_CATEGORY_GROUP_ENABLED() to
+// guard trace events on hot paths. If NODE_NO_HOT_PATH_TRACING is defined,
+// the check is false at compile time and the guarded code is compiled out.
+#ifdef NODE_NO_HOT_PATH_TRACING
+#define TRACE_EVENT_CATEGORY_ENABLED(category_group) false
+#else
+#define TRACE_EVENT_CATEGORY_ENABLED(category_group)                         \
+  ([]() -> bool {                                                            \
+    INTERNAL_TRACE_EVENT_GET_CATEGORY_INFO(category_group);                  \
+    return *INTERNAL_TRACE_EVENT_UID(category_group_enabled) != 0;           \
+  }())
+#endif
+
 // Implementation detail: internal macro to create static category and add
 // event if the category is enabled.
 #define INTERNAL_TRACE_EVENT_ADD(phase, category_group, name, flags, ...)    \
@@ -35,6 +35,7 @@ using errors::TryCatchScope;
 using v8::Array;
 using v8::ArrayBuffer;
 using v8::BackingStore;
+using v8::BackingStoreInitializationMode;
 using v8::Boolean;
 using v8::Context;
 using v8::DontDelete;
@@ -54,6 +55,11 @@ using v8::Undefined;
 using v8::Value;
 
 namespace {
+// Size of each datagram slot libuv carves out of the receive buffer when
+// reading with recvmmsg(), and the number of slots it uses at most.
+constexpr size_t kRecvSlotSize = 64 * 1024;
+constexpr size_t kRecvBatchSize = 20;
+
 template <int (*fn)(uv_udp_t*, int)>
 void SetLibuvInt32(const FunctionCallbackInfo<Value>& args) {
   UDPWrap* wrap = BaseObject::Unwrap<UDPWrap>(args.This());
@@ -72,7 +78,8 @@ void SetLibuvInt32(const FunctionCallbackInfo<Value>& args) {
 }
 }  // namespace
 
-class SendWrap : public ReqWrap<uv_udp_send_t> {
+class SendWrap : public ReqWrap<uv_udp_send_t>,
+                 public ThreadLocalFreeList<SendWrap> {
  public:
   SendWrap(Environment* env, Local<Object> req_wrap_obj, bool have_callback);
   inline bool have_callback() const;
@@ -140,7 +147,7 @@ void UDPWrapBase::RegisterExternalReferences(
   registry->Register(RecvStop);
 }
 
-UDPWrap::UDPWrap(Environment* env, Local<Object> object)
+UDPWrap::UDPWrap(Environment* env, Local<Object> object, bool recvmmsg)
     : HandleWrap(env,
                  object,
                  reinterpret_cast<uv_handle_t*>(&handle_),
@@ -148,7 +155,9 @@ UDPWrap::UDPWrap(Environment* env, Local<Object> object)
   object->SetAlignedPointerInInternalField(
       UDPWrapBase::kUDPWrapBaseField, static_cast<UDPWrapBase*>(this));
 
-  int r = uv_udp_init(env->event_loop(), &handle_);
+  int r = uv_udp_init_ex(env->event_loop(),
+                         &handle_,
+                         AF_UNSPEC | (recvmmsg ? UV_UDP_RECVMMSG : 0));
   CHECK_EQ(r, 0);  // can't fail anyway
 
   set_listener(this);
@@ -187,6 +196,8 @@ void UDPWrap::Initialize(Local<Object> target,
   SetProtoMethod(isolate, t, "bind6", Bind6);
   SetProtoMethod(isolate, t, "connect6", Connect6);
   SetProtoMethod(isolate, t, "send6", Send6);
+  SetProtoMethod(isolate, t, "trySendBatch", TrySendBatch);
+  SetProtoMethod(isolate, t, "trySendBatch6", TrySendBatch6);
   SetProtoMethod(isolate, t, "disconnect", Disconnect);
   SetProtoMethod(isolate,
                  t,
@@ -249,6 +260,8 @@ void UDPWrap::RegisterExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(Bind6);
   registry->Register(Connect6);
   registry->Register(Send6);
+  registry->Register(TrySendBatch);
+  registry->Register(TrySendBatch6);
   registry->Register(Disconnect);
   registry->Register(GetSockOrPeerName<UDPWrap, uv_udp_getpeername>);
   registry->Register(GetSockOrPeerName<UDPWrap, uv_udp_getsockname>);
@@ -269,7 +282,7 @@ void UDPWrap::RegisterExternalReferences(ExternalReferenceRegistry* registry) {
 void UDPWrap::New(const FunctionCallbackInfo<Value>& args) {
   CHECK(args.IsConstructCall());
   Environment* env = Environment::GetCurrent(args);
-  new UDPWrap(env, args.This());
+  new UDPWrap(env, args.This(), args[0]->IsTrue());
 }
 
 
@@ -657,6 +670,97 @@ void UDPWrap::Send6(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// trySendBatch(buffers, count[, ports, addresses]) sends one datagram per
+// buffer without queueing, with as few system calls as the platform allows
+// (sendmmsg() where available). `ports` and `addresses` hold the
+// destination of each datagram and are omitted for connected sockets.
+// Returns the number of datagrams that were sent, which may be less than
+// `count` if the socket buffer is full, or a negative error code if none
+// was. The remaining datagrams have to be sent with send().
+void UDPWrap::DoTrySendBatch(const FunctionCallbackInfo<Value>& args,
+                             int family) {
+  Environment* env = Environment::GetCurrent(args);
+
+  UDPWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(
+      &wrap, args.This(), args.GetReturnValue().Set(UV_EBADF));
+
+  CHECK(args.Length() == 2 || args.Length() == 4);
+  CHECK(args[0]->IsArray());
+  CHECK(args[1]->IsUint32());
+
+  bool sendto = args.Length() == 4;
+  if (sendto) {
+    CHECK(args[2]->IsArray());
+    CHECK(args[3]->IsArray());
+  }
+
+  if (wrap->IsHandleClosing()) return args.GetReturnValue().Set(UV_EBADF);
+  // Let send() exercise the asynchronous path.
+  if (env->options()->test_udp_no_try_send) [[unlikely]] {
+    return args.GetReturnValue().Set(0);
+  }
+
+  Local<Array> chunks = args[0].As<Array>();
+  uint32_t count = args[1].As<Uint32>()->Value();
+  if (count == 0) return args.GetReturnValue().Set(0);
+
+  MaybeStackBuffer<uv_buf_t, 64> bufs(count);
+  MaybeStackBuffer<uv_buf_t*, 64> buf_ptrs(count);
+  MaybeStackBuffer<unsigned int, 64> nbufs(count);
+  MaybeStackBuffer<sockaddr*, 64> addrs(count);
+  std::vector<sockaddr_storage> addr_storage(sendto ? count : 0);
+
+  for (uint32_t i = 0; i < count; i++) {
+    Local<Value> chunk;
+    if (!chunks->Get(env->context(), i).ToLocal(&chunk)) return;
+    CHECK(Buffer::HasInstance(chunk));
+    bufs[i] = uv_buf_init(Buffer::Data(chunk), Buffer::Length(chunk));
+    buf_ptrs[i] = &bufs[i];
+    nbufs[i] = 1;
+    addrs[i] = nullptr;
+  }
+
+  if (sendto) {
+    Local<Array> ports = args[2].As<Array>();
+    Local<Array> addresses = args[3].As<Array>();
+    for (uint32_t i = 0; i < count; i++) {
+      Local<Value> port;
+      Local<Value> address;
+      if (!ports->Get(env->context(), i).ToLocal(&port) ||
+          !addresses->Get(env->context(), i).ToLocal(&address)) {
+        return;
+      }
+      CHECK(port->IsUint32());
+      CHECK(address->IsString());
+      node::Utf8Value address_value(env->isolate(), address);
+      int err = sockaddr_for_family(family,
+                                    address_value.out(),
+                                    port.As<Uint32>()->Value(),
+                                    &addr_storage[i]);
+      if (err != 0) return args.GetReturnValue().Set(err);
+      addrs[i] = reinterpret_cast<sockaddr*>(&addr_storage[i]);
+    }
+  }
+
+  int err = uv_udp_try_send2(
+      &wrap->handle_, count, buf_ptrs.out(), nbufs.out(), addrs.out(), 0);
+  // Nothing could be sent right away, let the caller queue the datagrams.
+  if (err == UV_EAGAIN || err == UV_ENOSYS) err = 0;
+  args.GetReturnValue().Set(err);
+}
+
+
+void UDPWrap::TrySendBatch(const FunctionCallbackInfo<Value>& args) {
+  DoTrySendBatch(args, AF_INET);
+}
+
+
+void UDPWrap::TrySendBatch6(const FunctionCallbackInfo<Value>& args) {
+  DoTrySendBatch(args, AF_INET6);
+}
+
+
 AsyncWrap* UDPWrap::GetAsyncWrap() {
   return this;
 }
@@ -719,6 +823,13 @@ void UDPWrap::OnAlloc(uv_handle_t* handle,
 }
 
 uv_buf_t UDPWrap::OnAlloc(size_t suggested_size) {
+  if (uv_udp_using_recvmmsg(&handle_)) {
+    // libuv splits the buffer into one slot per datagram. The slab is reused
+    // for every batch, datagrams are copied out of it in OnRecvBatch().
+    if (!recv_slab_)
+      recv_slab_ = std::make_unique<char[]>(kRecvSlotSize * kRecvBatchSize);
+    return uv_buf_init(recv_slab_.get(), kRecvSlotSize * kRecvBatchSize);
+  }
   return env()->allocate_managed_buffer(suggested_size);
 }
 
@@ -735,6 +846,9 @@ void UDPWrap::OnRecv(ssize_t nread,
                      const uv_buf_t& buf_,
                      const sockaddr* addr,
                      unsigned int flags) {
+  if (uv_udp_using_recvmmsg(&handle_))
+    return OnRecvBatch(nread, buf_, addr, flags);
+
   Environment* env = this->env();
   Isolate* isolate = env->isolate();
   std::unique_ptr<BackingStore> bs = env->release_managed_buffer(buf_);
@@ -805,6 +919,97 @@ void UDPWrap::OnRecv(ssize_t nread,
   MakeCallback(env->onmessage_string(), arraysize(argv), argv);
 }
 
+void UDPWrap::OnRecvBatch(ssize_t nread,
+                          const uv_buf_t& buf,
+                          const sockaddr* addr,
+                          unsigned int flags) {
+  // The final callback of a recvmmsg() batch.
+  if (flags & UV_UDP_MMSG_FREE) return FlushRecvBatch();
+  if (nread == 0 && addr == nullptr) return;
+
+  if (nread < 0) {
+    FlushRecvBatch();
+    if (IsHandleClosing()) return;
+    Environment* env = this->env();
+    Isolate* isolate = env->isolate();
+    HandleScope handle_scope(isolate);
+    Context::Scope context_scope(env->context());
+    Local<Value> argv[] = {Integer::New(isolate, static_cast<int32_t>(nread)),
+                           object(),
+                           Undefined(isolate),
+                           Undefined(isolate)};
+    MakeCallback(env->onmessage_string(), arraysize(argv), argv);
+    return;
+  }
+
+  BatchedMessage message;
+  message.store = ArrayBuffer::NewBackingStore(
+      env()->isolate(), nread, BackingStoreInitializationMode::kUninitialized);
+  if (nread > 0) memcpy(message.store->Data(), buf.base, nread);
+  memcpy(&message.address, addr, SocketAddress::GetLength(addr));
+  recv_batch_.push_back(std::move(message));
+
+  // A datagram that was not read by recvmmsg() is not followed by a
+  // UV_UDP_MMSG_FREE callback, deliver it right away.
+  if (!(flags & UV_UDP_MMSG_CHUNK)) FlushRecvBatch();
+}
+
+void UDPWrap::FlushRecvBatch() {
+  if (recv_batch_.empty()) return;
+
+  Environment* env = this->env();
+  Isolate* isolate = env->isolate();
+  HandleScope handle_scope(isolate);
+  Context::Scope context_scope(env->context());
+
+  std::vector<BatchedMessage> batch = std::move(recv_batch_);
+  recv_batch_.clear();
+
+  Local<Value> argv[] = {
+      Integer::New(isolate, static_cast<int32_t>(batch.size())),
+      object(),
+      Undefined(isolate),
+      Undefined(isolate)};
+
+  std::vector<Local<Value>> buffers;
+  std::vector<Local<Value>> addresses;
+  buffers.reserve(batch.size());
+  addresses.reserve(batch.size());
+  {
+    bool has_caught = false;
+    {
+      TryCatchScope try_catch(env);
+      for (BatchedMessage& message : batch) {
+        Local<ArrayBuffer> ab =
+            ArrayBuffer::New(isolate, std::move(message.store));
+        const sockaddr* addr =
+            reinterpret_cast<const sockaddr*>(&message.address);
+        Local<Object> buffer;
+        Local<Object> address;
+        if (!Buffer::New(env, ab, 0, ab->ByteLength()).ToLocal(&buffer) ||
+            !AddressToJS(env, addr).ToLocal(&address)) {
+          DCHECK(try_catch.HasCaught() && !try_catch.HasTerminated());
+          argv[2] = try_catch.Exception();
+          DCHECK(!argv[2].IsEmpty());
+          has_caught = true;
+          break;
+        }
+        buffers.push_back(buffer);
+        addresses.push_back(address);
+      }
+    }
+    if (has_caught) {
+      DCHECK(!argv[2].IsEmpty());
+      MakeCallback(env->onerror_string(), arraysize(argv), argv);
+      return;
+    }
+  }
+
+  argv[2] = Array::New(isolate, buffers.data(), buffers.size());
+  argv[3] = Array::New(isolate, addresses.data(), addresses.size());
+  MakeCallback(env->onmessage_string(), arraysize(argv), argv);
+}
+
 MaybeLocal<Object> UDPWrap::Instantiate(Environment* env,
                                         AsyncWrap* parent,
                                         UDPWrap::SocketType type) {
@@ -30,6 +30,9 @@
 #include "uv.h"
 #include "v8.h"
 
+#include <memory>
+#include <vector>
+
 namespace node {
 
 class ExternalReferenceRegistry;
@@ -138,6 +141,8 @@ class UDPWrap final : public HandleWrap,
   static void Bind6(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Connect6(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Send6(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void TrySendBatch(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void TrySendBatch6(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Disconnect(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void AddMembership(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void DropMembership(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -189,7 +194,7 @@ class UDPWrap final : public HandleWrap,
             int (*F)(const typename T::HandleType*, sockaddr*, int*)>
   friend void GetSockOrPeerName(const v8::FunctionCallbackInfo<v8::Value>&);
 
-  UDPWrap(Environment* env, v8::Local<v8::Object> object);
+  UDPWrap(Environment* env, v8::Local<v8::Object> object, bool recvmmsg);
 
   static void DoBind(const v8::FunctionCallbackInfo<v8::Value>& args,
                      int family);
@@ -197,6 +202,8 @@ class UDPWrap final : public HandleWrap,
                      int family);
   static void DoSend(const v8::FunctionCallbackInfo<v8::Value>& args,
                      int family);
+  static void DoTrySendBatch(const v8::FunctionCallbackInfo<v8::Value>& args,
+                             int family);
   static void SetMembership(const v8::FunctionCallbackInfo<v8::Value>& args,
                             uv_membership membership);
   static void SetSourceMembership(
@@ -212,10 +219,28 @@ class UDPWrap final : public HandleWrap,
                      const struct sockaddr* addr,
                      unsigned int flags);
 
+  // A handle created with `new UDP(true)` reads with recvmmsg() where
+  // available. The datagrams of each batch are then delivered with a single
+  // onmessage(count, handle, buffers, rinfos) call, where buffers and rinfos
+  // are arrays of the same length.
+  void OnRecvBatch(ssize_t nread,
+                   const uv_buf_t& buf,
+                   const sockaddr* addr,
+                   unsigned int flags);
+  void FlushRecvBatch();
+
+  struct BatchedMessage {
+    std::unique_ptr<v8::BackingStore> store;
+    sockaddr_storage address;
+  };
+
   uv_udp_t handle_;
 
   bool current_send_has_callback_;
   v8::Local<v8::Object> current_send_req_wrap_;
+
+  std::unique_ptr<char[]> recv_slab_;
+  std::vector<BatchedMessage> recv_batch_;
 };
 
 int sockaddr_for_family(int address_family,
@@ -33,6 +33,7 @@
 #include "node_v8_platform-inl.h"
 #include "string_bytes.h"
 #include "v8-value.h"
+#include "zstd.h"
 
 #ifdef _WIN32
 #include <io.h>  // _S_IREAD _S_IWRITE
@@ -618,6 +619,28 @@ void SetProtoMethod(v8::Isolate* isolate,
   t->SetClassName(name_string);  // NODE_SET_PROTOTYPE_METHOD() compatibility.
 }
 
+void SetFastProtoMethod(v8::Isolate* isolate,
+                        Local<v8::FunctionTemplate> that,
+                        const std::string_view name,
+                        v8::FunctionCallback slow_callback,
+                        const v8::CFunction* c_function) {
+  Local<v8::Signature> signature = v8::Signature::New(isolate, that);
+  Local<v8::FunctionTemplate> t =
+      NewFunctionTemplate(isolate,
+                          slow_callback,
+                          signature,
+                          v8::ConstructorBehavior::kThrow,
+                          v8::SideEffectType::kHasSideEffect,
+                          c_function);
+  // kInternalized strings are created in the old space.
+  const v8::NewStringType type = v8::NewStringType::kInternalized;
+  Local<v8::String> name_string =
+      v8::String::NewFromUtf8(isolate, name.data(), type, name.size())
+          .ToLocalChecked();
+  that->PrototypeTemplate()->Set(name_string, t);
+  t->SetClassName(name_string);
+}
+
 void SetProtoMethodNoSideEffect(v8::Isolate* isolate,
                                 Local<v8::FunctionTemplate> that,
                                 const std::string_view name,
@@ -699,6 +722,17 @@ void SetConstructorFunction(Isolate* isolate,
   that->Set(name, tmpl);
 }
 
+void DecompressStaticResource(const uint8_t* compressed,
+                              size_t compressed_size,
+                              void* out,
+                              size_t size) {
+  size_t result = ZSTD_decompress(out, size, compressed, compressed_size);
+  // The data was compressed by js2c at build time, so a mismatch means that
+  // the binary has been corrupted.
+  CHECK(!ZSTD_isError(result));
+  CHECK_EQ(result, size);
+}
+
 Local<String> UnionBytes::ToStringChecked(Isolate* isolate) const {
   if (is_one_byte()) {
     return String::NewExternalOneByte(isolate, one_byte_resource_)
@@ -510,6 +510,54 @@ class MaybeStackBuffer {
   T buf_st_[kStackStorageSize];
 };
 
+// Gives T a thread-local free list of up to kMaxFree blocks that `new` and
+// `delete` use before falling back to the global allocator. This is meant for
+// objects that are created and destroyed at a high rate on one thread, such
+// as request wraps: each Environment runs on a single thread, so the list is
+// effectively per-Environment. Subclasses of T with a different size bypass
+// the list. The blocks are released when the thread exits.
+template <typename T, size_t kMaxFree = 64>
+class ThreadLocalFreeList {
+ public:
+  static void* operator new(size_t size) {
+    FreeList& list = free_list_;
+    if (size == sizeof(T) && list.count > 0) return list.blocks[--list.count];
+    return ::operator new(size);
+  }
+
+  static void operator delete(void* ptr, size_t size) {
+    FreeList& list = free_list_;
+    if (size == sizeof(T) && !list.released && list.count < kMaxFree) {
+      if (list.count == 0) RegisterRelease();
+      list.blocks[list.count++] = ptr;
+      return;
+    }
+    ::operator delete(ptr);
+  }
+
+ private:
+  // Trivially destructible, so that it remains usable for objects that are
+  // deleted after the release at thread exit has run.
+  struct FreeList {
+    void* blocks[kMaxFree];
+    size_t count;
+    bool released;
+  };
+
+  static void RegisterRelease() {
+    struct Release {
+      ~Release() {
+        FreeList& list = free_list_;
+        while (list.count > 0) ::operator delete(list.blocks[--list.count]);
+        list.released = true;
+      }
+    };
+    thread_local Release release;
+  }
+
+  static inline thread_local FreeList free_list_{};
+};
+
 // Provides access to an ArrayBufferView's storage, either the original,
 // or for small data, a copy of it. This object's lifetime is bound to the
 // original ArrayBufferView's lifetime.
@@ -907,6 +955,13 @@ void SetProtoMethod(v8::Isolate* isolate,
                     const std::string_view name,
                     v8::FunctionCallback callback);
 
+// Like SetProtoMethod(), with a Fast API implementation of the method.
+void SetFastProtoMethod(v8::Isolate* isolate,
+                        v8::Local<v8::FunctionTemplate> that,
+                        const std::string_view name,
+                        v8::FunctionCallback slow_callback,
+                        const v8::CFunction* c_function);
+
 void SetInstanceMethod(v8::Isolate* isolate,
                        v8::Local<v8::FunctionTemplate> that,
                        const std::string_view name,
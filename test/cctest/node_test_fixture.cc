@@ -48,5 +48,51 @@ void NodeTestEnvironment::TearDown() {
   NodeZeroIsolateTestFixture::tracing_agent.reset(nullptr);
 }
 
+std::string EnvironmentTestFixture::RunScript(const Env& env,
+                                              const char* script) {
+  v8::Isolate* isolate = NodeTestFixture::isolate_;
+  v8::Local<v8::Context> context = env.context();
+  v8::TryCatch try_catch(isolate);
+  auto start = [&](const node::StartExecutionCallbackInfo& info)
+      -> v8::MaybeLocal<v8::Value> {
+    v8::Local<v8::Value> id =
+        v8::String::NewFromUtf8Literal(isolate, "internal/test/binding");
+    v8::Local<v8::Value> binding;
+    v8::Local<v8::Value> internal_binding;
+    if (!info.native_require->Call(context, v8::Null(isolate), 1, &id)
+             .ToLocal(&binding) ||
+        !binding.As<v8::Object>()
+             ->Get(context,
+                   v8::String::NewFromUtf8Literal(isolate, "internalBinding"))
+             .ToLocal(&internal_binding)) {
+      return {};
+    }
+    v8::ScriptCompiler::Source source(
+        v8::String::NewFromUtf8(isolate, script).ToLocalChecked());
+    v8::Local<v8::String> params[] = {
+        v8::String::NewFromUtf8Literal(isolate, "require"),
+        v8::String::NewFromUtf8Literal(isolate, "internalBinding")};
+    v8::Local<v8::Function> fn;
+    if (!v8::ScriptCompiler::CompileFunction(
+             context, &source, node::arraysize(params), params)
+             .ToLocal(&fn)) {
+      return {};
+    }
+    v8::Local<v8::Value> argv[] = {info.native_require, internal_binding};
+    return fn->Call(context, v8::Null(isolate), node::arraysize(argv), argv);
+  };
+  v8::Local<v8::Value> result;
+  if (node::LoadEnvironment(*env, start).IsEmpty() ||
+      node::SpinEventLoop(*env).IsNothing() ||
+      !context->Global()
+           ->Get(context, v8::String::NewFromUtf8Literal(isolate, "result"))
+           .ToLocal(&result)) {
+    if (!try_catch.HasCaught()) return "<no result>";
+    result = try_catch.Exception();
+  }
+  v8::String::Utf8Value utf8(isolate, result);
+  return *utf8 != nullptr ? *utf8 : "<no result>";
+}
+
 ::testing::Environment* const node_env =
 ::testing::AddGlobalTestEnvironment(new NodeTestEnvironment());
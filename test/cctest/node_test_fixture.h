@@ -3,6 +3,7 @@
 
 #include <cstdlib>
 #include <memory>
+#include <string>
 #include "gtest/gtest.h"
 #include "node.h"
 #include "node_platform.h"
@@ -190,6 +191,12 @@ class EnvironmentTestFixture : public NodeTestFixture {
     v8::Local<v8::Context> context_;
     node::Environment* environment_;
   };
+
+  // Runs `script` as the main script of `env` until the event loop is empty.
+  // The script is called with `require`, which loads builtin modules, and
+  // with `internalBinding`. Returns the value that the script stores in
+  // globalThis.result as a string, or the exception it throws.
+  static std::string RunScript(const Env& env, const char* script);
 };
 
 #endif  // TEST_CCTEST_NODE_TEST_FIXTURE_H_
@@ -0,0 +1,69 @@
+#include "node_auto_tune.h"
+
+#include "gtest/gtest.h"
+
+using node::auto_tune::ComputeTuning;
+using node::auto_tune::Limits;
+using node::auto_tune::Tuning;
+
+constexpr uint64_t kMB = 1024 * 1024;
+
+TEST(AutoTuneTest, SizesHeapForMemoryLimit) {
+  Tuning tuning = ComputeTuning(Limits{512 * kMB, 2});
+  EXPECT_EQ(tuning.heap.max_young_generation_size, 3 * (3 * kMB / 2));
+  EXPECT_EQ(tuning.heap.max_old_generation_size,
+            384 * kMB - tuning.heap.max_young_generation_size);
+
+  // The semi-space is capped.
+  tuning = ComputeTuning(Limits{8192 * kMB, 2});
+  EXPECT_EQ(tuning.heap.max_young_generation_size, 48 * kMB);
+  EXPECT_EQ(tuning.heap.max_old_generation_size, 6144 * kMB - 48 * kMB);
+
+  tuning = ComputeTuning(Limits{32 * kMB, 2});
+  EXPECT_EQ(tuning.heap.max_young_generation_size, 3 * kMB);
+  EXPECT_EQ(tuning.heap.max_old_generation_size, 21 * kMB);
+
+  tuning = ComputeTuning(Limits{16 * kMB, 2});
+  EXPECT_EQ(tuning.heap.max_old_generation_size, 16 * kMB);
+}
+
+TEST(AutoTuneTest, CapsHeapAtV8Maximum) {
+  Tuning tuning = ComputeTuning(Limits{64 * 1024 * kMB, 2, 4096 * kMB});
+  EXPECT_EQ(tuning.heap.max_old_generation_size, 4096 * kMB);
+  EXPECT_EQ(tuning.heap.max_young_generation_size, 48 * kMB);
+
+  tuning = ComputeTuning(Limits{512 * kMB, 2, 4096 * kMB});
+  EXPECT_EQ(tuning.heap.max_old_generation_size,
+            384 * kMB - tuning.heap.max_young_generation_size);
+}
+
+TEST(AutoTuneTest, GivesWorkersAShareOfTheHeap) {
+  Tuning tuning = ComputeTuning(Limits{2048 * kMB, 2});
+  EXPECT_EQ(tuning.worker_heap.max_young_generation_size, 3 * (3 * kMB / 2));
+  EXPECT_EQ(tuning.worker_heap.max_old_generation_size,
+            384 * kMB - tuning.worker_heap.max_young_generation_size);
+
+  tuning = ComputeTuning(Limits{32 * kMB, 2});
+  EXPECT_EQ(tuning.worker_heap.max_old_generation_size, 16 * kMB);
+}
+
+TEST(AutoTuneTest, LeavesHeapToV8WithoutMemoryLimit) {
+  Tuning tuning = ComputeTuning(Limits{0, 4, 4096 * kMB});
+  EXPECT_EQ(tuning.heap.max_old_generation_size, 0u);
+  EXPECT_EQ(tuning.heap.max_young_generation_size, 0u);
+  EXPECT_EQ(tuning.worker_heap.max_old_generation_size, 0u);
+  EXPECT_EQ(tuning.worker_heap.max_young_generation_size, 0u);
+}
+
+TEST(AutoTuneTest, SizesThreadPoolsForCpus) {
+  Tuning tuning = ComputeTuning(Limits{0, 1});
+  EXPECT_EQ(tuning.threadpool_size, 2u);
+  EXPECT_EQ(tuning.platform_worker_count, 1);
+
+  tuning = ComputeTuning(Limits{0, 8});
+  EXPECT_EQ(tuning.threadpool_size, 8u);
+  EXPECT_EQ(tuning.platform_worker_count, 7);
+
+  tuning = ComputeTuning(Limits{0, 4096});
+  EXPECT_EQ(tuning.threadpool_size, 1024u);
+}
@@ -0,0 +1,46 @@
+#include "cares_wrap.h"
+#include "util-inl.h"
+
+#include "gtest/gtest.h"
+
+#include <cstring>
+
+using node::cares_wrap::SetQueryCacheOptions;
+
+namespace {
+
+// Returns the maximum TTL of the query cache of a channel initialized with
+// `max_cache_ttl`.
+unsigned int QueryCacheMaxTtl(int64_t max_cache_ttl) {
+  EXPECT_EQ(ares_library_init(ARES_LIB_INIT_ALL), ARES_SUCCESS);
+  ares_options options;
+  memset(&options, 0, sizeof(options));
+  int optmask = SetQueryCacheOptions(&options, max_cache_ttl);
+  ares_channel channel;
+  EXPECT_EQ(ares_init_options(&channel, &options, optmask), ARES_SUCCESS);
+
+  ares_options saved;
+  int saved_optmask;
+  EXPECT_EQ(ares_save_options(channel, &saved, &saved_optmask), ARES_SUCCESS);
+  EXPECT_NE(saved_optmask & ARES_OPT_QUERY_CACHE, 0);
+  unsigned int ttl = saved.qcache_max_ttl;
+  ares_destroy_options(&saved);
+  ares_destroy(channel);
+  ares_library_cleanup();
+  return ttl;
+}
+
+}  // namespace
+
+TEST(CaresWrapTest, KeepsDefaultQueryCache) {
+  ares_options options;
+  memset(&options, 0, sizeof(options));
+  EXPECT_EQ(SetQueryCacheOptions(&options, -1), 0);
+  EXPECT_EQ(QueryCacheMaxTtl(-1), 3600u);
+}
+
+TEST(CaresWrapTest, SetsQueryCacheMaxTtl) {
+  EXPECT_EQ(QueryCacheMaxTtl(60), 60u);
+  // A TTL of 0 disables the cache.
+  EXPECT_EQ(QueryCacheMaxTtl(0), 0u);
+}
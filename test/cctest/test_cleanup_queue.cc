@@ -0,0 +1,75 @@
+#include "cleanup_queue-inl.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using node::CleanupQueue;
+
+namespace {
+
+struct Recorder {
+  CleanupQueue* queue;
+  std::vector<int> ran;
+};
+
+struct Hook {
+  Recorder* recorder;
+  int id;
+  Hook* remove = nullptr;  // Removed from the queue when this hook runs.
+  Hook* add = nullptr;     // Added to the queue when this hook runs.
+};
+
+void RunHook(void* arg) {
+  Hook* hook = static_cast<Hook*>(arg);
+  hook->recorder->ran.push_back(hook->id);
+  if (hook->remove != nullptr)
+    hook->recorder->queue->Remove(RunHook, hook->remove);
+  if (hook->add != nullptr) hook->recorder->queue->Add(RunHook, hook->add);
+}
+
+}  // namespace
+
+TEST(CleanupQueueTest, DrainsInReverseInsertionOrder) {
+  CleanupQueue queue;
+  Recorder recorder{&queue, {}};
+  std::vector<Hook> hooks;
+  for (int i = 0; i < 100; i++) hooks.push_back({&recorder, i});
+  for (Hook& hook : hooks) queue.Add(RunHook, &hook);
+  // Remove enough hooks to compact the queue in between.
+  for (int i = 0; i < 100; i += 3) queue.Remove(RunHook, &hooks[i]);
+  for (int i = 0; i < 100; i += 3) queue.Remove(RunHook, &hooks[i]);
+  queue.Add(RunHook, &hooks[0]);
+
+  queue.Drain();
+  EXPECT_TRUE(queue.empty());
+
+  std::vector<int> expected{0};
+  for (int i = 99; i >= 0; i--) {
+    if (i % 3 != 0) expected.push_back(i);
+  }
+  EXPECT_EQ(recorder.ran, expected);
+}
+
+TEST(CleanupQueueTest, HooksChangingTheQueue) {
+  CleanupQueue queue;
+  Recorder recorder{&queue, {}};
+  Hook first{&recorder, 1};
+  Hook second{&recorder, 2};
+  Hook third{&recorder, 3};
+  Hook late{&recorder, 4};
+  // `third` runs first, removes `second` and schedules `late`.
+  third.remove = &second;
+  third.add = &late;
+  queue.Add(RunHook, &first);
+  queue.Add(RunHook, &second);
+  queue.Add(RunHook, &third);
+
+  queue.Drain();
+  EXPECT_EQ(recorder.ran, (std::vector<int>{3, 1}));
+  // Hooks added while draining run on the next drain.
+  EXPECT_FALSE(queue.empty());
+  queue.Drain();
+  EXPECT_EQ(recorder.ran, (std::vector<int>{3, 1, 4}));
+  EXPECT_TRUE(queue.empty());
+}
@@ -0,0 +1,48 @@
+#include "crypto/crypto_keygen.h"
+#include "node_test_fixture.h"
+#include "openssl/evp.h"
+#include "gtest/gtest.h"
+
+#include <string>
+
+using node::crypto::KeyPairPool;
+
+class KeyPairPoolTest : public NodeZeroIsolateTestFixture {
+ protected:
+  static ncrypto::EVPKeyPointer Generate() {
+    return ncrypto::EVPKeyPointer(EVP_EC_gen("P-256"));
+  }
+
+  static ncrypto::EVPKeyPointer Take(const std::string& params) {
+    return KeyPairPool::GetInstance()->Take(platform.get(), params, Generate);
+  }
+
+  // Waits for the refill tasks posted by Take().
+  static void WaitForAvailable(uint64_t available) {
+    while (KeyPairPool::GetInstance()->GetStats().available < available) {
+      uv_sleep(1);
+    }
+  }
+};
+
+TEST_F(KeyPairPoolTest, RefillsQueues) {
+  KeyPairPool* pool = KeyPairPool::GetInstance();
+  pool->SetDepth(2);
+  ASSERT_TRUE(pool->enabled());
+  KeyPairPool::Stats before = pool->GetStats();
+
+  EXPECT_FALSE(Take("test:p256"));
+  WaitForAvailable(before.available + 2);
+  EXPECT_TRUE(Take("test:p256"));
+  EXPECT_TRUE(Take("test:p256"));
+  WaitForAvailable(before.available + 2);
+
+  KeyPairPool::Stats after = pool->GetStats();
+  EXPECT_EQ(after.hits - before.hits, 2u);
+  EXPECT_EQ(after.misses - before.misses, 1u);
+  EXPECT_EQ(after.generated - before.generated, 4u);
+
+  pool->SetDepth(0);
+  EXPECT_FALSE(pool->enabled());
+  EXPECT_EQ(pool->GetStats().available, 0u);
+}
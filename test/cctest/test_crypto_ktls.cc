@@ -0,0 +1,109 @@
+#include "node.h"
+
+#include <string>
+#include "gtest/gtest.h"
+#include "node_test_fixture.h"
+
+using v8::HandleScope;
+
+// Mirrors the condition under which crypto_tls.cc can program kernel TLS.
+#if defined(__linux__) && __has_include(<linux/tls.h>)
+#define KTLS_REQUESTED "true"
+#else
+#define KTLS_REQUESTED "false"
+#endif
+
+class KTLSTest : public EnvironmentTestFixture {};
+
+// Connects a TLS 1.2 client that asked for kernel TLS to a server using a
+// pre-shared key, so that no certificates are needed, and has the server
+// check what the client sent. Whether the kernel actually takes over depends
+// on the cipher and on the tls module being available, but the data must
+// arrive intact either way. The result is
+// `<enableKTLS() before the handshake>,<after it>,<server verdict>`.
+#define CONNECT                                                               \
+  "const tls = require('tls');\n"                                             \
+  "const psk = Buffer.alloc(32, 7);\n"                                        \
+  "const payload = Buffer.alloc(200000);\n"                                   \
+  "for (let i = 0; i < payload.length; i++) payload[i] = i % 251;\n"          \
+  "function connect(ciphers) {\n"                                             \
+  "  return new Promise((resolve, reject) => {\n"                             \
+  "    const options = { ciphers, maxVersion: 'TLSv1.2' };\n"                 \
+  "    const server = tls.createServer({\n"                                   \
+  "      ...options, pskCallback: () => psk,\n"                               \
+  "    }, (socket) => {\n"                                                    \
+  "      const chunks = [];\n"                                                \
+  "      let received = 0;\n"                                                 \
+  "      socket.on('error', () => {});\n"                                     \
+  "      socket.on('data', (chunk) => {\n"                                    \
+  "        chunks.push(chunk);\n"                                             \
+  "        received += chunk.length;\n"                                       \
+  "        if (received < payload.length) return;\n"                          \
+  "        const data = Buffer.concat(chunks);\n"                             \
+  "        socket.end(data.equals(payload) ? 'ok' : 'mismatch');\n"           \
+  "      });\n"                                                               \
+  "    });\n"                                                                 \
+  "    server.on('tlsClientError', reject);\n"                                \
+  "    server.listen(0, '127.0.0.1', () => {\n"                               \
+  "      const client = tls.connect({\n"                                      \
+  "        ...options,\n"                                                     \
+  "        host: '127.0.0.1',\n"                                              \
+  "        port: server.address().port,\n"                                    \
+  "        checkServerIdentity: () => undefined,\n"                           \
+  "        pskCallback: () => ({ psk, identity: 'cctest' }),\n"               \
+  "      });\n"                                                               \
+  "      const results = [client._handle.enableKTLS()];\n"                    \
+  "      let reply = '';\n"                                                   \
+  "      client.on('secureConnect', () => {\n"                                \
+  "        results.push(client._handle.enableKTLS());\n"                      \
+  "        client.write(payload.subarray(0, 1000));\n"                        \
+  "        client.write(payload.subarray(1000));\n"                           \
+  "      });\n"                                                               \
+  "      client.setEncoding('utf8');\n"                                       \
+  "      client.on('data', (chunk) => reply += chunk);\n"                     \
+  "      client.on('error', reject);\n"                                       \
+  "      client.on('close', () => {\n"                                        \
+  "        server.close();\n"                                                 \
+  "        resolve([...results, reply].join());\n"                            \
+  "      });\n"                                                               \
+  "    });\n"                                                                 \
+  "  });\n"                                                                   \
+  "}\n"                                                                       \
+  "function report(promise) {\n"                                              \
+  "  promise.then((result) => globalThis.result = result,\n"                  \
+  "               (err) => globalThis.result = `${err}`);\n"                  \
+  "}\n"
+
+TEST_F(KTLSTest, AES128GCM) {
+  const HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env{handle_scope, argv};
+
+  EXPECT_EQ(RunScript(env,
+                      CONNECT
+                      "report(connect('PSK-AES128-GCM-SHA256'));\n"),
+            KTLS_REQUESTED ",false,ok");
+}
+
+TEST_F(KTLSTest, AES256GCM) {
+  const HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env{handle_scope, argv};
+
+  EXPECT_EQ(RunScript(env,
+                      CONNECT
+                      "report(connect('PSK-AES256-GCM-SHA384'));\n"),
+            KTLS_REQUESTED ",false,ok");
+}
+
+// Ciphers the kernel is not handed fall back to OpenSSL.
+TEST_F(KTLSTest, UnsupportedCipher) {
+  const HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env{handle_scope, argv};
+
+  EXPECT_EQ(RunScript(env,
+                      CONNECT
+                      "report(connect('PSK-CHACHA20-POLY1305'));\n"),
+            KTLS_REQUESTED ",false,ok");
+}
@@ -0,0 +1,56 @@
+#include "node.h"
+
+#include <string>
+#include "gtest/gtest.h"
+#include "node_test_fixture.h"
+
+using v8::HandleScope;
+
+class CryptoRandomTest : public EnvironmentTestFixture {};
+
+// Defines `fill(count, size)`, which fills `count` buffers of `size` bytes
+// with secureRandomFill() and returns the number of distinct ones.
+#define FILL_SCRIPT                                                           \
+  "const { secureRandomFill } = internalBinding('crypto');\n"                 \
+  "function fill(count, size) {\n"                                            \
+  "  const seen = new Set();\n"                                               \
+  "  for (let i = 0; i < count; i++) {\n"                                     \
+  "    const buffer = new Uint8Array(size);\n"                                \
+  "    secureRandomFill(buffer, 0, size);\n"                                  \
+  "    seen.add(Buffer.from(buffer).toString('hex'));\n"                      \
+  "  }\n"                                                                     \
+  "  return seen.size;\n"                                                     \
+  "}\n"
+
+// More requests than fit into one block of the pool, requests that are too
+// large for it, and a request for part of a buffer.
+TEST_F(CryptoRandomTest, SecureRandomFill) {
+  const HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env{handle_scope, argv};
+
+  EXPECT_EQ(RunScript(env,
+                      FILL_SCRIPT
+                      "const buffer = new Uint8Array(8);\n"
+                      "secureRandomFill(buffer, 4, 4);\n"
+                      "globalThis.result = [\n"
+                      "  fill(1000, 16),\n"
+                      "  fill(10, 1024),\n"
+                      "  buffer.subarray(0, 4).every((byte) => byte === 0),\n"
+                      "].join();\n"),
+            "1000,10,true");
+}
+
+// Every Environment has a pool of its own, including several Environments on
+// the same thread.
+TEST_F(CryptoRandomTest, SecureRandomFillPerEnvironment) {
+  const HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env first{handle_scope, argv};
+  EXPECT_EQ(RunScript(first, FILL_SCRIPT "globalThis.result = fill(300, 16);"),
+            "300");
+
+  Env second{handle_scope, argv};
+  EXPECT_EQ(RunScript(second, FILL_SCRIPT "globalThis.result = fill(300, 16);"),
+            "300");
+}
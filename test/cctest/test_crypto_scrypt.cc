@@ -0,0 +1,75 @@
+#include "crypto/crypto_scrypt.h"
+#include "node_test_fixture.h"
+
+#include <cstring>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#ifndef OPENSSL_NO_SCRYPT
+
+using node::crypto::ByteSource;
+using node::crypto::ScryptConfig;
+using node::crypto::ScryptParallel;
+using node::crypto::ScryptParallelism;
+
+class ScryptTest : public NodeZeroIsolateTestFixture {
+ protected:
+  static void Configure(ScryptConfig* config,
+                        uint32_t N,
+                        uint32_t r,
+                        uint32_t p) {
+    config->mode = node::crypto::kCryptoJobSync;
+    config->pass = ByteSource::Foreign(kPass, strlen(kPass));
+    config->salt = ByteSource::Foreign(kSalt, strlen(kSalt));
+    config->N = N;
+    config->r = r;
+    config->p = p;
+    config->maxmem = 0;
+    config->length = 64;
+  }
+
+  static std::string Sequential(const ScryptConfig& config) {
+    auto dp = ncrypto::scrypt(
+        ncrypto::Buffer<const char>{kPass, strlen(kPass)},
+        ncrypto::Buffer<const unsigned char>{
+            reinterpret_cast<const unsigned char*>(kSalt), strlen(kSalt)},
+        config.N,
+        config.r,
+        config.p,
+        config.maxmem,
+        config.length);
+    CHECK(dp);
+    return std::string(static_cast<const char*>(dp.get()), dp.size());
+  }
+
+  static constexpr const char* kPass = "password";
+  static constexpr const char* kSalt = "NaCl";
+};
+
+TEST_F(ScryptTest, ParallelMatchesSequential) {
+  for (uint32_t p : {2, 3, 16}) {
+    ScryptConfig config;
+    Configure(&config, 1024, 8, p);
+    std::string expected = Sequential(config);
+    for (size_t threads : {1, 2, 4}) {
+      ByteSource out;
+      ASSERT_TRUE(ScryptParallel(config, threads, &out));
+      EXPECT_EQ(std::string(out.data<char>(), out.size()), expected)
+          << "p=" << p << " threads=" << threads;
+    }
+  }
+}
+
+TEST_F(ScryptTest, ParallelismRespectsMaxmem) {
+  ScryptConfig config;
+  Configure(&config, 16384, 8, 4);
+  EXPECT_EQ(ScryptParallelism(config, 8), 1u);  // 16 MiB per lane.
+  config.maxmem = 128 * 1024 * 1024;
+  EXPECT_EQ(ScryptParallelism(config, 8), 4u);
+  EXPECT_EQ(ScryptParallelism(config, 3), 3u);
+  config.p = 1;
+  EXPECT_EQ(ScryptParallelism(config, 8), 1u);
+}
+
+#endif  // OPENSSL_NO_SCRYPT
@@ -0,0 +1,52 @@
+#include "crypto/crypto_sig.h"
+#include "ncrypto.h"
+#include "openssl/evp.h"
+#include "gtest/gtest.h"
+
+#include <cstring>
+#include <memory>
+
+using node::crypto::ByteSource;
+using node::crypto::DSASigEnc;
+using node::crypto::KeyObjectData;
+using node::crypto::SignConfiguration;
+using node::crypto::SignContext;
+
+namespace {
+
+std::unique_ptr<SignContext::Prototype> MakePrototype(
+    SignConfiguration::Mode mode, KeyObjectData key) {
+  const ncrypto::EVPKeyPointer& pkey = key.GetAsymmetricKey();
+  auto ctx = ncrypto::EVPMDCtxPointer::New();
+  CHECK(ctx);
+  if (mode == SignConfiguration::Mode::Sign) {
+    CHECK(ctx.signInit(pkey, ncrypto::Digest::SHA256).has_value());
+  } else {
+    CHECK(ctx.verifyInit(pkey, ncrypto::Digest::SHA256).has_value());
+  }
+  return std::make_unique<SignContext::Prototype>(
+      mode, std::move(key), DSASigEnc::DER,
+      std::move(ctx));
+}
+
+}  // namespace
+
+TEST(SignContextTest, SignsWithCopiesOfThePrototype) {
+  ncrypto::EVPKeyPointer pkey(EVP_EC_gen("P-256"));
+  ASSERT_TRUE(pkey);
+  KeyObjectData key = KeyObjectData::CreateAsymmetric(
+      node::crypto::kKeyTypePrivate, std::move(pkey));
+  auto signer = MakePrototype(SignConfiguration::Mode::Sign, key);
+  auto verifier = MakePrototype(SignConfiguration::Mode::Verify, key);
+
+  for (const char* message : {"first", "second", "first"}) {
+    ByteSource data = ByteSource::Foreign(message, strlen(message));
+    ByteSource signature;
+    ASSERT_TRUE(signer->Sign(nullptr, data, &signature));
+    EXPECT_GT(signature.size(), 0u);
+    EXPECT_TRUE(verifier->Verify(data, signature));
+
+    ByteSource other = ByteSource::Foreign("other", 5);
+    EXPECT_FALSE(verifier->Verify(other, signature));
+  }
+}
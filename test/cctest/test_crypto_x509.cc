@@ -0,0 +1,97 @@
+#include "crypto/crypto_x509.h"
+#include "ncrypto.h"
+#include "openssl/evp.h"
+#include "openssl/x509.h"
+#include "gtest/gtest.h"
+
+#include <memory>
+#include <optional>
+#include <string>
+
+using node::crypto::ManagedX509;
+
+namespace {
+
+// Creates a self-signed certificate with the given common name.
+ncrypto::X509Pointer MakeCertificate(const char* common_name) {
+  EVP_PKEY* pkey = EVP_EC_gen("P-256");
+  CHECK_NOT_NULL(pkey);
+  ncrypto::X509Pointer cert(X509_new());
+  X509_set_version(cert.get(), 2);
+  ASN1_INTEGER_set(X509_get_serialNumber(cert.get()), 1);
+  X509_gmtime_adj(X509_getm_notBefore(cert.get()), 0);
+  X509_gmtime_adj(X509_getm_notAfter(cert.get()), 3600);
+  X509_NAME* name = X509_get_subject_name(cert.get());
+  X509_NAME_add_entry_by_txt(
+      name,
+      "CN",
+      MBSTRING_ASC,
+      reinterpret_cast<const unsigned char*>(common_name),
+      -1,
+      -1,
+      0);
+  X509_set_issuer_name(cert.get(), name);
+  X509_set_pubkey(cert.get(), pkey);
+  CHECK_GT(X509_sign(cert.get(), pkey, EVP_sha256()), 0);
+  EVP_PKEY_free(pkey);
+  return cert;
+}
+
+std::string ToDer(const ncrypto::X509Pointer& cert) {
+  unsigned char* der = nullptr;
+  int len = i2d_X509(cert.get(), &der);
+  CHECK_GT(len, 0);
+  std::string result(reinterpret_cast<char*>(der), len);
+  OPENSSL_free(der);
+  return result;
+}
+
+}  // namespace
+
+TEST(X509Cache, SharesEntriesForTheSameCertificate) {
+  ncrypto::X509Pointer cert = MakeCertificate("cache.example");
+  std::string der = ToDer(cert);
+  ncrypto::Buffer<const unsigned char> buffer{
+      .data = reinterpret_cast<const unsigned char*>(der.data()),
+      .len = der.size(),
+  };
+
+  std::shared_ptr<ManagedX509> first = ManagedX509::GetOrCreate(cert.view());
+  ASSERT_TRUE(first);
+  EXPECT_EQ(ManagedX509::GetOrCreate(cert.view()), first);
+
+  // Parsing the same certificate returns the entry, too.
+  std::optional<int> error;
+  EXPECT_EQ(ManagedX509::Parse(buffer, &error), first);
+  EXPECT_EQ(ManagedX509::Parse(buffer, &error), first);
+  EXPECT_FALSE(error.has_value());
+
+  std::shared_ptr<ManagedX509> other =
+      ManagedX509::GetOrCreate(MakeCertificate("other.example"));
+  EXPECT_NE(other, first);
+}
+
+TEST(X509Cache, ComputesFieldsOnce) {
+  std::shared_ptr<ManagedX509> cert =
+      ManagedX509::GetOrCreate(MakeCertificate("fields.example"));
+  const std::string* subject = cert->GetField(ManagedX509::Field::kSubject);
+  ASSERT_NE(subject, nullptr);
+  EXPECT_EQ(*subject, "CN=fields.example");
+  EXPECT_EQ(cert->GetField(ManagedX509::Field::kSubject), subject);
+
+  const std::string* fingerprint =
+      cert->GetField(ManagedX509::Field::kFingerprint256);
+  ASSERT_NE(fingerprint, nullptr);
+  EXPECT_EQ(fingerprint->size(), 32u * 3 - 1);
+  EXPECT_EQ(*fingerprint,
+            cert->view().getFingerprint(ncrypto::Digest::SHA256).value());
+
+  // The certificate has no extensions.
+  EXPECT_EQ(cert->GetField(ManagedX509::Field::kSubjectAltName), nullptr);
+}
+
+TEST(X509Cache, ReportsParseErrors) {
+  const unsigned char garbage[] = "not a certificate";
+  std::optional<int> error;
+  EXPECT_FALSE(ManagedX509::Parse({garbage, sizeof(garbage)}, &error));
+}
@@ -0,0 +1,79 @@
+#include "encoding_binding.h"
+#include "util-inl.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+#include "node_test_fixture.h"
+
+using node::encoding_binding::Utf8StreamDecoder;
+using v8::Context;
+using v8::HandleScope;
+using v8::Local;
+using v8::Value;
+
+class Utf8StreamDecoderTest : public NodeTestFixture {
+ protected:
+  // Decodes `chunks` as one stream, the last chunk flushing the decoder.
+  std::string Decode(Utf8StreamDecoder* decoder,
+                     std::initializer_list<std::string> chunks) {
+    std::string result;
+    size_t index = 0;
+    for (const std::string& chunk : chunks) {
+      const bool flush = ++index == chunks.size();
+      Local<Value> value;
+      if (!decoder->Decode(isolate_,
+                           chunk.data(),
+                           chunk.size(),
+                           false,
+                           false,
+                           flush)
+               .ToLocal(&value)) {
+        ADD_FAILURE() << "Decode() failed";
+        return result;
+      }
+      result += *node::Utf8Value(isolate_, value);
+    }
+    return result;
+  }
+};
+
+// Splits 2-, 3- and 4-byte sequences at every position, and checks that
+// the state carried over between the chunks is intact by decoding the
+// stream twice with the same decoder.
+TEST_F(Utf8StreamDecoderTest, SplitSequences) {
+  const HandleScope handle_scope(isolate_);
+  Local<Context> context = Context::New(isolate_);
+  Context::Scope context_scope(context);
+
+  for (const std::string sequence : {"\xC3\xA9", "\xE2\x82\xAC",
+                                     "\xF0\x9F\x98\x80"}) {
+    const std::string text = "a" + sequence + "b";
+    Utf8StreamDecoder decoder;
+    for (size_t split = 0; split <= text.size(); split++) {
+      EXPECT_EQ(Decode(&decoder, {text.substr(0, split), text.substr(split)}),
+                text)
+          << "split at " << split << " of " << text.size();
+    }
+
+    for (size_t i = 1; i < sequence.size(); i++) {
+      EXPECT_EQ(Decode(&decoder,
+                       {sequence.substr(0, i),
+                        sequence.substr(i, 1),
+                        sequence.substr(i + 1)}),
+                sequence)
+          << "split at " << i << " of " << sequence.size();
+    }
+  }
+}
+
+// An incomplete sequence at the end of the stream becomes U+FFFD.
+TEST_F(Utf8StreamDecoderTest, FlushIncompleteSequence) {
+  const HandleScope handle_scope(isolate_);
+  Local<Context> context = Context::New(isolate_);
+  Context::Scope context_scope(context);
+
+  Utf8StreamDecoder decoder;
+  EXPECT_EQ(Decode(&decoder, {"a\xF0\x9F", "\x98"}), "a\xEF\xBF\xBD");
+  EXPECT_EQ(Decode(&decoder, {"\xF0\x9F\x98\x80"}), "\xF0\x9F\x98\x80");
+}
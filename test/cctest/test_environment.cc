@@ -288,6 +288,24 @@ TEST_F(EnvironmentTest, AtExitRunsJS) {
   EXPECT_TRUE(called_at_exit_js);
 }
 
+TEST_F(EnvironmentTest, InternedStrings) {
+  const v8::HandleScope handle_scope(isolate_);
+  node::IsolateData* isolate_data = EnvironmentTestFixture::isolate_data_;
+
+  v8::Local<v8::String> first =
+      isolate_data->InternedString("column").ToLocalChecked();
+  v8::Local<v8::String> second =
+      isolate_data->InternedString("column").ToLocalChecked();
+  EXPECT_TRUE(first == second);
+  EXPECT_EQ(*node::Utf8Value(isolate_, first), std::string("column"));
+
+  // Strings that are too long to be kept are still returned.
+  std::string long_value(node::IsolateData::kMaxInternedStringLength + 1, 'x');
+  v8::Local<v8::String> long_string =
+      isolate_data->InternedString(long_value).ToLocalChecked();
+  EXPECT_EQ(static_cast<size_t>(long_string->Length()), long_value.size());
+}
+
 TEST_F(EnvironmentTest, MultipleEnvironmentsPerIsolate) {
   const v8::HandleScope handle_scope(isolate_);
   const Argv argv;
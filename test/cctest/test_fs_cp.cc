@@ -0,0 +1,110 @@
+#include "node.h"
+
+#include <string>
+#include "gtest/gtest.h"
+#include "node_test_fixture.h"
+
+using v8::HandleScope;
+
+// Creating symlinks needs extra privileges on Windows.
+#ifndef _WIN32
+
+class FsCpTest : public EnvironmentTestFixture {};
+
+// Creates a scratch directory `tmp` and `cp(src, dest, flags)`, which
+// copies with the native cpRecursive() and resolves once it is done.
+#define CP_SCRIPT                                                             \
+  "const fs = require('fs');\n"                                               \
+  "const os = require('os');\n"                                               \
+  "const path = require('path');\n"                                           \
+  "const { FSReqCallback, cpRecursive } = internalBinding('fs');\n"           \
+  "const kForce = 1 << 0;\n"                                                  \
+  "const kDereference = 1 << 2;\n"                                            \
+  "const tmp = fs.mkdtempSync(path.join(os.tmpdir(), 'cctest-cp-'));\n"       \
+  "function cp(src, dest, flags) {\n"                                         \
+  "  return new Promise((resolve, reject) => {\n"                             \
+  "    const req = new FSReqCallback();\n"                                    \
+  "    req.oncomplete = (err) => err ? reject(err) : resolve();\n"            \
+  "    cpRecursive(src, dest, flags, 0, 1, undefined, req);\n"                \
+  "  });\n"                                                                   \
+  "}\n"                                                                       \
+  "function report(promise) {\n"                                              \
+  "  promise.then((result) => globalThis.result = result,\n"                  \
+  "               (err) => globalThis.result = `${err}`)\n"                   \
+  "    .finally(() => fs.rmSync(tmp, { recursive: true }));\n"                \
+  "}\n"
+
+// A symlink at the destination is replaced, not written through, unless
+// the copy dereferences symlinks.
+TEST_F(FsCpTest, DoesNotWriteThroughDestinationSymlink) {
+  const HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env{handle_scope, argv};
+
+  EXPECT_EQ(RunScript(env,
+                      CP_SCRIPT
+                      "const src = path.join(tmp, 'src');\n"
+                      "const dest = path.join(tmp, 'dest');\n"
+                      "const victim = path.join(tmp, 'victim');\n"
+                      "fs.mkdirSync(src);\n"
+                      "fs.mkdirSync(dest);\n"
+                      "fs.writeFileSync(path.join(src, 'file'), 'new');\n"
+                      "fs.writeFileSync(victim, 'old');\n"
+                      "fs.symlinkSync(victim, path.join(dest, 'file'));\n"
+                      "report(cp(src, dest, kForce).then(() => [\n"
+                      "  fs.readFileSync(victim, 'utf8'),\n"
+                      "  fs.lstatSync(path.join(dest, 'file')).isFile(),\n"
+                      "  fs.readFileSync(path.join(dest, 'file'), 'utf8'),\n"
+                      "].join()));\n"),
+            "old,true,new");
+}
+
+// Relative symlink targets are resolved against the directory of the link
+// and normalized.
+TEST_F(FsCpTest, NormalizesRelativeSymlinkTargets) {
+  const HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env{handle_scope, argv};
+
+  EXPECT_EQ(RunScript(env,
+                      CP_SCRIPT
+                      "const src = path.join(tmp, 'src');\n"
+                      "const dest = path.join(tmp, 'dest');\n"
+                      "fs.mkdirSync(path.join(src, 'dir'), {\n"
+                      "  recursive: true,\n"
+                      "});\n"
+                      "fs.writeFileSync(path.join(src, 'target'), 'x');\n"
+                      "fs.symlinkSync('../target',\n"
+                      "               path.join(src, 'dir', 'link'));\n"
+                      "report(cp(src, dest, 0).then(() => {\n"
+                      "  const target =\n"
+                      "      fs.readlinkSync(path.join(dest, 'dir', 'link'));\n"
+                      "  return `${target === path.join(src, 'target')}`;\n"
+                      "}));\n"),
+            "true");
+}
+
+// With dereferencing, a symlink to a directory is copied as a directory.
+TEST_F(FsCpTest, DereferencesDirectorySymlinks) {
+  const HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env{handle_scope, argv};
+
+  EXPECT_EQ(RunScript(env,
+                      CP_SCRIPT
+                      "const src = path.join(tmp, 'src');\n"
+                      "const dest = path.join(tmp, 'dest');\n"
+                      "const outside = path.join(tmp, 'outside');\n"
+                      "fs.mkdirSync(src);\n"
+                      "fs.mkdirSync(outside);\n"
+                      "fs.writeFileSync(path.join(outside, 'file'), 'x');\n"
+                      "fs.symlinkSync(outside, path.join(src, 'dir'));\n"
+                      "report(cp(src, dest, kDereference).then(() => [\n"
+                      "  fs.lstatSync(path.join(dest, 'dir')).isDirectory(),\n"
+                      "  fs.readFileSync(path.join(dest, 'dir', 'file'),\n"
+                      "                  'utf8'),\n"
+                      "].join()));\n"),
+            "true,x");
+}
+
+#endif  // _WIN32
@@ -0,0 +1,81 @@
+#include "util-inl.h"
+
+#include "hex_encoding.h"
+#include "nbytes.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+std::string RandomBytes(size_t length, std::mt19937* rng) {
+  std::string bytes(length, '\0');
+  for (char& c : bytes) c = static_cast<char>((*rng)() & 0xff);
+  return bytes;
+}
+
+}  // anonymous namespace
+
+TEST(HexEncodingTest, EncodeMatchesNbytes) {
+  std::mt19937 rng(42);
+  for (size_t length = 0; length < 100; length++) {
+    std::string src = RandomBytes(length, &rng);
+    std::string expected = nbytes::HexEncode(src.data(), src.size());
+    std::string actual(length * 2, '\0');
+    EXPECT_EQ(node::hex_encoding::Encode(
+                  src.data(), src.size(), actual.data(), actual.size()),
+              length * 2);
+    EXPECT_EQ(actual, expected);
+  }
+}
+
+TEST(HexEncodingTest, DecodeRoundTrips) {
+  std::mt19937 rng(7);
+  for (size_t length = 0; length < 100; length++) {
+    std::string src = RandomBytes(length, &rng);
+    std::string hex = nbytes::HexEncode(src.data(), src.size());
+    for (char& c : hex) {
+      if (rng() & 1) c = toupper(c);
+    }
+    std::string actual(length, '\0');
+    EXPECT_EQ(node::hex_encoding::Decode(
+                  actual.data(), actual.size(), hex.data(), hex.size()),
+              length);
+    EXPECT_EQ(actual, src);
+  }
+}
+
+TEST(HexEncodingTest, DecodeStopsAtInvalidPair) {
+  const std::string valid(64, 'a');
+  for (size_t pos = 0; pos < valid.size(); pos++) {
+    for (char bad : {'g', 'G', '/', ':', '@', '`', '\x80', '\xff', ' '}) {
+      std::string hex = valid;
+      hex[pos] = bad;
+      std::vector<char> expected(32), actual(32);
+      size_t expected_length = nbytes::HexDecode(
+          expected.data(), expected.size(), hex.data(), hex.size());
+      size_t actual_length = node::hex_encoding::Decode(
+          actual.data(), actual.size(), hex.data(), hex.size());
+      EXPECT_EQ(actual_length, pos / 2);
+      EXPECT_EQ(actual_length, expected_length);
+      expected.resize(expected_length);
+      actual.resize(actual_length);
+      EXPECT_EQ(actual, expected);
+    }
+  }
+}
+
+TEST(HexEncodingTest, DecodeRespectsOutputLength) {
+  const std::string hex(96, 'f');
+  std::vector<char> out(48, 0);
+  EXPECT_EQ(node::hex_encoding::Decode(out.data(), 20, hex.data(), hex.size()),
+            20u);
+  EXPECT_EQ(out[19], '\xff');
+  EXPECT_EQ(out[20], 0);
+  // A trailing odd character is ignored.
+  EXPECT_EQ(node::hex_encoding::Decode(out.data(), out.size(), hex.data(), 35),
+            17u);
+}
@@ -0,0 +1,104 @@
+#include "node.h"
+
+#include <string>
+#include "gtest/gtest.h"
+#include "node_test_fixture.h"
+
+using v8::HandleScope;
+
+class ModulesTest : public EnvironmentTestFixture {};
+
+// Writes `json` as the "exports" (or "imports") field of a new package.json
+// and resolves `key` against it. The expected results are those of
+// packageExportsResolve() and packageImportsResolve() of the ESM resolver.
+#define RESOLVE                                                               \
+  "const { mkdtempSync, writeFileSync } = require('fs');\n"                   \
+  "const { tmpdir } = require('os');\n"                                       \
+  "const { join } = require('path');\n"                                       \
+  "const { resolvePackageMap } = internalBinding('modules');\n"               \
+  "function resolve(json, key, isImports = false) {\n"                        \
+  "  const dir = mkdtempSync(join(tmpdir(), 'node-cctest-modules-'));\n"      \
+  "  const file = join(dir, 'package.json');\n"                               \
+  "  const field = isImports ? 'imports' : 'exports';\n"                      \
+  "  writeFileSync(file, `{\"name\": \"pkg\", \"${field}\": ${json}}`);\n"    \
+  "  return JSON.stringify(resolvePackageMap(file, key, isImports));\n"       \
+  "}\n"
+
+TEST_F(ModulesTest, ResolvesMostSpecificPattern) {
+  const HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env{handle_scope, argv};
+
+  EXPECT_EQ(RunScript(env,
+                      RESOLVE
+                      "globalThis.result = [\n"
+                      "  resolve('{\"./*\": \"./any/*\", "
+                      "\"./feature/*\": \"./f/*.js\"}', './feature/x'),\n"
+                      "  resolve('{\"./feature\": \"./f.js\"}', './other'),\n"
+                      "].join(' ');\n"),
+            "[\"./f/*.js\",\"x\",\"./feature/*\"] null");
+}
+
+TEST_F(ModulesTest, IgnoresKeysWithSeveralPatterns) {
+  const HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env{handle_scope, argv};
+
+  EXPECT_EQ(RunScript(env,
+                      RESOLVE
+                      "globalThis.result = [\n"
+                      "  resolve('{\"./a/*/b/*\": \"./x/*.js\", "
+                      "\"./a/*\": \"./y/*.js\"}', './a/1/b/2'),\n"
+                      "  resolve('{\"./*/*\": \"./z.js\"}', './x/y'),\n"
+                      "  resolve('{\"#*/*\": \"./z.js\"}', '#x/y', true),\n"
+                      "].join(' ');\n"),
+            "[\"./y/*.js\",\"1/b/2\",\"./a/*\"] null null");
+}
+
+TEST_F(ModulesTest, KeepsLastOfDuplicateKeys) {
+  const HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env{handle_scope, argv};
+
+  EXPECT_EQ(RunScript(env,
+                      RESOLVE
+                      "globalThis.result = [\n"
+                      "  resolve('{\"./a\": \"./first.js\", "
+                      "\"./a\": \"./last.js\"}', './a'),\n"
+                      "  resolve('{\"./p/*\": \"./1/*\", "
+                      "\"./p/*\": \"./2/*\"}', './p/q'),\n"
+                      "  resolve('{\"#dep\": \"./a.js\", "
+                      "\"#dep\": \"./b.js\"}', '#dep', true),\n"
+                      "].join(' ');\n"),
+            "[\"./last.js\",null,\"./a\"] "
+            "[\"./2/*\",\"q\",\"./p/*\"] "
+            "[\"./b.js\",null,\"#dep\"]");
+}
+
+// Like EXPORTS_PATTERN, findPath() treats a leading "@" that does not start a
+// valid scope as part of an unscoped package name and hands packages with an
+// "exports" field back to the JS resolver.
+TEST_F(ModulesTest, FindPathMatchesExportsPattern) {
+  const HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env{handle_scope, argv};
+
+  EXPECT_EQ(RunScript(env,
+                      "const fs = require('fs');\n"
+                      "const { tmpdir } = require('os');\n"
+                      "const { join } = require('path');\n"
+                      "const { findPath } = internalBinding('modules');\n"
+                      "const dir = fs.mkdtempSync("
+                      "join(tmpdir(), 'node-cctest-modules-'));\n"
+                      "for (const name of ['@foo', '@a']) {\n"
+                      "  fs.mkdirSync(join(dir, name));\n"
+                      "  fs.writeFileSync(join(dir, name, 'package.json'),\n"
+                      "                   '{\"exports\": \"./x.js\"}');\n"
+                      "}\n"
+                      "globalThis.result = ['@foo', '@a/.b', '%foo']\n"
+                      "  .map((request) => findPath(request, [dir], "
+                      "['.js'], 0))\n"
+                      "  .join();\n"
+                      "fs.rmSync(dir, { recursive: true });\n"),
+            "0,0,false");
+}
@@ -0,0 +1,95 @@
+#include "node.h"
+
+#include <string>
+#include "gtest/gtest.h"
+#include "node_test_fixture.h"
+
+using v8::HandleScope;
+
+class HttpParserTest : public EnvironmentTestFixture {};
+
+// Has a server send a chunked response in a single write and parses it off
+// the client socket with kZeroCopyBody, so that the body chunks of one read
+// are views into the same slab. The result is
+// `<body intact>,<some chunks shared an ArrayBuffer>`.
+TEST_F(HttpParserTest, ZeroCopyBodyChunksOfOneRead) {
+  const HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env{handle_scope, argv};
+  EXPECT_EQ(
+      RunScript(
+          env,
+          "const net = require('net');\n"
+          "const { HTTPParser } = internalBinding('http_parser');\n"
+          "const parts = [0, 1, 2, 3].map((i) =>\n"
+          "  Buffer.alloc(10000, 97 + i));\n"
+          "const response = Buffer.concat([\n"
+          "  Buffer.from('HTTP/1.1 200 OK\\r\\n' +\n"
+          "              'Transfer-Encoding: chunked\\r\\n\\r\\n'),\n"
+          "  ...parts.flatMap((part) => [\n"
+          "    Buffer.from(`${part.length.toString(16)}\\r\\n`),\n"
+          "    part,\n"
+          "    Buffer.from('\\r\\n'),\n"
+          "  ]),\n"
+          "  Buffer.from('0\\r\\n\\r\\n'),\n"
+          "]);\n"
+          "const server = net.createServer((socket) => {\n"
+          "  socket.end(response);\n"
+          "});\n"
+          "server.listen(0, '127.0.0.1', () => {\n"
+          "  const client = net.connect(server.address().port, '127.0.0.1');\n"
+          "  const chunks = [];\n"
+          "  const parser = new HTTPParser();\n"
+          "  parser.initialize(HTTPParser.RESPONSE, {}, 0, 0, undefined,\n"
+          "                    HTTPParser.kZeroCopyBody);\n"
+          "  parser[HTTPParser.kOnBody] = (chunk) => chunks.push(chunk);\n"
+          "  parser[HTTPParser.kOnMessageComplete] = () => {\n"
+          "    const body = Buffer.concat(chunks);\n"
+          "    const shared = chunks.some((chunk, i) =>\n"
+          "      i > 0 && chunk.buffer === chunks[i - 1].buffer);\n"
+          "    globalThis.result = `${body.equals(Buffer.concat(parts))},` +\n"
+          "                        `${shared}`;\n"
+          "    client.destroy();\n"
+          "    server.close();\n"
+          "  };\n"
+          "  client.on('connect', () => parser.consume(client._handle));\n"
+          "});\n"),
+      "true,true");
+}
+
+TEST_F(HttpParserTest, SerializeHeadValidatesHeaders) {
+  const HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env{handle_scope, argv};
+  EXPECT_EQ(
+      RunScript(
+          env,
+          "const { serializeHead } = internalBinding('http_parser');\n"
+          "function serialize(headers, body) {\n"
+          "  try {\n"
+          "    return JSON.stringify(\n"
+          "        serializeHead(200, 'OK', headers, 0, body)\n"
+          "            .toString('latin1'));\n"
+          "  } catch (err) {\n"
+          "    return err.code;\n"
+          "  }\n"
+          "}\n"
+          "const body = new Uint8Array([97, 98, 99]);\n"
+          "const headers = ['X-A', 'v'];\n"
+          "// Detaches the body while the headers are read.\n"
+          "Object.defineProperty(headers, 1, {\n"
+          "  get() { body.buffer.transfer(); return 'v'; },\n"
+          "});\n"
+          "globalThis.result = [\n"
+          "  serialize(['X-A', '\\u00e9']),\n"
+          "  serialize(['Bad Name', 'v']),\n"
+          "  serialize(['', 'v']),\n"
+          "  serialize(['X-A', '\\u0100']),\n"
+          "  serialize(['X-A', 'a\\r\\nb']),\n"
+          "  serialize(headers, body),\n"
+          "].join(' ');\n"),
+      "\"HTTP/1.1 200 OK\\r\\nX-A: \xc3\xa9\\r\\n\\r\\n\" "
+      "ERR_INVALID_HTTP_TOKEN ERR_INVALID_HTTP_TOKEN "
+      "ERR_INVALID_ARG_VALUE ERR_INVALID_ARG_VALUE "
+      "\"HTTP/1.1 200 OK\\r\\nX-A: v\\r\\n\\r\\n\"");
+}
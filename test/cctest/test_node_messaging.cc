@@ -0,0 +1,79 @@
+#include "node_messaging.h"
+
+#include <string>
+#include "gtest/gtest.h"
+#include "node_test_fixture.h"
+
+using node::OneByteString;
+using node::worker::TransferList;
+using node::worker::Message;
+using v8::Context;
+using v8::HandleScope;
+using v8::Local;
+using v8::Object;
+using v8::ObjectTemplate;
+using v8::String;
+using v8::TryCatch;
+using v8::Value;
+
+class MessagingTest : public EnvironmentTestFixture {};
+
+// Objects with internal fields that are not BaseObjects are cloned as
+// ordinary objects, except in plain data mode, where V8 hands them to
+// WriteHostObject().
+TEST_F(MessagingTest, PlainDataRejectsOtherObjectsWithInternalFields) {
+  const HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env{handle_scope, argv};
+  Local<Context> context = env.context();
+
+  Local<ObjectTemplate> object_template = ObjectTemplate::New(isolate_);
+  object_template->SetInternalFieldCount(1);
+  Local<Object> object =
+      object_template->NewInstance(context).ToLocalChecked();
+  const TransferList transfer_list;
+
+  {
+    TryCatch try_catch(isolate_);
+    Message message;
+    EXPECT_TRUE(message.Serialize(*env, context, object, transfer_list)
+                    .FromMaybe(false));
+    EXPECT_FALSE(try_catch.HasCaught());
+  }
+
+  {
+    TryCatch try_catch(isolate_);
+    Message message;
+    EXPECT_TRUE(message
+                    .Serialize(*env,
+                               context,
+                               object,
+                               transfer_list,
+                               Local<Object>(),
+                               0,
+                               true)
+                    .IsNothing());
+    ASSERT_TRUE(try_catch.HasCaught());
+    Local<Value> name;
+    ASSERT_TRUE(try_catch.Exception()
+                    .As<Object>()
+                    ->Get(context, OneByteString(isolate_, "name"))
+                    .ToLocal(&name));
+    EXPECT_EQ(std::string(*String::Utf8Value(isolate_, name)),
+              "DataCloneError");
+  }
+
+  // A plain object is cloned in both modes.
+  {
+    Message message;
+    EXPECT_TRUE(message
+                    .Serialize(*env,
+                               context,
+                               Object::New(isolate_),
+                               transfer_list,
+                               Local<Object>(),
+                               0,
+                               true)
+                    .FromMaybe(false));
+  }
+}
@@ -2,10 +2,26 @@
 #include "node_task_runner.h"
 #include "node_test_fixture.h"
 
+#include <string>
 #include <tuple>
 #include <vector>
 
-class TaskRunnerTest : public EnvironmentTestFixture {};
+using node::task_runner::ProcessRunner;
+
+class TaskRunnerTest : public EnvironmentTestFixture {
+ protected:
+  static void SetStdoutFd(ProcessRunner* runner, int fd) {
+    runner->output_[0].fd = fd;
+  }
+
+  static void OnStdout(ProcessRunner* runner, std::string_view data) {
+    runner->OnOutput(&runner->output_[0], data.data(), data.size());
+  }
+
+  static const std::string& PendingStdout(const ProcessRunner& runner) {
+    return runner.output_[0].pending;
+  }
+};
 
 TEST_F(TaskRunnerTest, EscapeShell) {
   std::vector<std::pair<std::string, std::string>> expectations = {
@@ -41,3 +57,38 @@ TEST_F(TaskRunnerTest, EscapeShell) {
     EXPECT_EQ(node::task_runner::EscapeShell(input), expected);
   }
 }
+
+TEST_F(TaskRunnerTest, OnOutputPrefixesCompleteLines) {
+  uv_file fds[2];
+  ASSERT_EQ(uv_pipe(fds, 0, 0), 0);
+
+  ProcessRunner runner(nullptr, "package.json", "test", "echo", "", {});
+  runner.SetOutputPrefix("[test] ");
+  SetStdoutFd(&runner, fds[1]);
+
+  // Partial lines are held back until their newline arrives.
+  OnStdout(&runner, "one\ntw");
+  EXPECT_EQ(PendingStdout(runner), "tw");
+  OnStdout(&runner, "o\n\nthr");
+  EXPECT_EQ(PendingStdout(runner), "thr");
+
+  const std::string expected = "[test] one\n[test] two\n[test] \n";
+  std::string output(expected.size(), '\0');
+  size_t offset = 0;
+  while (offset < output.size()) {
+    uv_fs_t req;
+    unsigned int size = static_cast<unsigned int>(output.size() - offset);
+    uv_buf_t buf = uv_buf_init(&output[offset], size);
+    int r = uv_fs_read(nullptr, &req, fds[0], &buf, 1, -1, nullptr);
+    uv_fs_req_cleanup(&req);
+    ASSERT_GT(r, 0);
+    offset += r;
+  }
+  EXPECT_EQ(output, expected);
+
+  for (uv_file fd : fds) {
+    uv_fs_t req;
+    uv_fs_close(nullptr, &req, fd, nullptr);
+    uv_fs_req_cleanup(&req);
+  }
+}
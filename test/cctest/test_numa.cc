@@ -0,0 +1,40 @@
+#include "node_numa.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using node::numa::ParseCpuList;
+
+TEST(NumaTest, ParseCpuList) {
+  std::vector<int> cpus;
+  EXPECT_TRUE(ParseCpuList("0-3,8,10-11\n", &cpus));
+  EXPECT_EQ(cpus, (std::vector<int>{0, 1, 2, 3, 8, 10, 11}));
+
+  EXPECT_TRUE(ParseCpuList("5", &cpus));
+  EXPECT_EQ(cpus, std::vector<int>{5});
+
+  // Nodes without CPUs have an empty list.
+  EXPECT_TRUE(ParseCpuList("\n", &cpus));
+  EXPECT_TRUE(cpus.empty());
+
+  EXPECT_FALSE(ParseCpuList("3-1", &cpus));
+  EXPECT_FALSE(ParseCpuList("1,", &cpus));
+  EXPECT_FALSE(ParseCpuList("1,,2", &cpus));
+  EXPECT_FALSE(ParseCpuList("a-b", &cpus));
+  EXPECT_FALSE(ParseCpuList("-1", &cpus));
+}
+
+TEST(NumaTest, SaveAndRestoreMemoryPolicy) {
+  using node::numa::GetCurrentThreadMemoryPolicy;
+  using node::numa::SavedMemoryPolicy;
+  SavedMemoryPolicy saved;
+  // Not available everywhere, e.g. outside of Linux or under seccomp.
+  if (GetCurrentThreadMemoryPolicy(&saved) != 0) return;
+  EXPECT_EQ(node::numa::RestoreCurrentThreadMemoryPolicy(saved), 0);
+
+  SavedMemoryPolicy restored;
+  ASSERT_EQ(GetCurrentThreadMemoryPolicy(&restored), 0);
+  EXPECT_EQ(restored.mode, saved.mode);
+  EXPECT_EQ(restored.nodes, saved.nodes);
+}
@@ -93,3 +93,71 @@ TEST_F(PathTest, ToNamespacedPath) {
   EXPECT_EQ(data.ToStringView(), "hello world");  // Input should not be mutated
 #endif
 }
+
+TEST(GlobMatchTest, Basic) {
+  using node::GlobMatch;
+  EXPECT_TRUE(GlobMatch("*.js", "index.js"));
+  EXPECT_FALSE(GlobMatch("*.js", "lib/index.js"));
+  EXPECT_TRUE(GlobMatch("lib/?ndex.js", "lib/index.js"));
+  EXPECT_FALSE(GlobMatch("?", "/"));
+  EXPECT_TRUE(GlobMatch("**/*.js", "index.js"));
+  EXPECT_TRUE(GlobMatch("**/*.js", "lib/internal/index.js"));
+  EXPECT_TRUE(GlobMatch("lib/**", "lib/internal/index.js"));
+  EXPECT_TRUE(GlobMatch("**/node_modules", "a/b/node_modules"));
+  EXPECT_FALSE(GlobMatch("**/node_modules", "a/node_modules/b"));
+  EXPECT_TRUE(GlobMatch("file[0-9].txt", "file7.txt"));
+  EXPECT_FALSE(GlobMatch("file[!0-9].txt", "file7.txt"));
+  EXPECT_TRUE(GlobMatch("file[!0-9].txt", "fileA.txt"));
+  EXPECT_TRUE(GlobMatch("[]]", "]"));
+  EXPECT_TRUE(GlobMatch("a[b", "a[b"));
+  EXPECT_TRUE(GlobMatch("\\*", "*"));
+  EXPECT_FALSE(GlobMatch("\\*", "a"));
+  EXPECT_TRUE(GlobMatch("", ""));
+  EXPECT_FALSE(GlobMatch("", "a"));
+}
+
+// Failed wildcard splits are not retried, so this returns immediately.
+TEST(GlobMatchTest, PathologicalPattern) {
+  using node::GlobMatch;
+  std::string pattern;
+  for (int i = 0; i < 30; i++) pattern += "a*";
+  std::string path(100, 'a');
+  EXPECT_FALSE(GlobMatch(pattern + "b", path));
+  EXPECT_TRUE(GlobMatch(pattern + "b", path + "b"));
+  EXPECT_FALSE(GlobMatch("**/" + pattern + "b", "x/y/" + path));
+}
+
+TEST(PathPosixTest, NormalizeJoinResolveRelative) {
+  namespace posix = node::posix;
+  EXPECT_EQ(posix::Normalize("./fixtures///b/../b/c.js"), "fixtures/b/c.js");
+  EXPECT_EQ(posix::Normalize("/foo/../../../bar"), "/bar");
+  EXPECT_EQ(posix::Normalize("a//b//../b"), "a/b");
+  EXPECT_EQ(posix::Normalize(""), ".");
+  EXPECT_EQ(posix::Normalize("bar/"), "bar/");
+  EXPECT_EQ(posix::Normalize("a\\b/../c"), "c");
+
+  EXPECT_EQ(posix::Join({"/foo", "bar", "baz/asdf", "quux", ".."}),
+            "/foo/bar/baz/asdf");
+  EXPECT_EQ(posix::Join({"", ""}), ".");
+  EXPECT_EQ(posix::Join({}), ".");
+
+  EXPECT_FALSE(posix::ResolveNeedsCwd({"a", "/b"}));
+  EXPECT_FALSE(posix::ResolveNeedsCwd({"/a", "b"}));
+  EXPECT_TRUE(posix::ResolveNeedsCwd({"a", "b"}));
+  EXPECT_EQ(posix::Resolve("/cwd", {"/var/lib", "../", "file/"}),
+            "/var/file");
+  EXPECT_EQ(posix::Resolve("/cwd", {"a/b/c/", "../../.."}), "/cwd");
+  EXPECT_EQ(posix::Resolve("/cwd", {"."}), "/cwd");
+  EXPECT_EQ(posix::Resolve("/", {"."}), "/");
+
+  EXPECT_EQ(posix::Relative("/cwd", "/var/lib", "/var"), "..");
+  EXPECT_EQ(posix::Relative("/cwd", "/var/lib", "/var/apache"), "../apache");
+  EXPECT_EQ(posix::Relative("/cwd", "/var/", "/var/lib"), "lib");
+  EXPECT_EQ(posix::Relative("/cwd", "/foo/test", "/foo/test/bar/package.json"),
+            "bar/package.json");
+  EXPECT_EQ(posix::Relative("/cwd", "/a", "/b"), "../b");
+  EXPECT_EQ(posix::Relative("/cwd", "/", "/foo"), "foo");
+  EXPECT_EQ(posix::Relative("/cwd", "/foo", "/"), "..");
+  EXPECT_EQ(posix::Relative("/cwd", "a", "/cwd/a/b"), "b");
+  EXPECT_EQ(posix::Relative("/cwd", "/page1/page2/foo", "/"), "../../..");
+}
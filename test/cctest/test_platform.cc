@@ -2,6 +2,7 @@
 #include "libplatform/libplatform.h"
 
 #include <string>
+#include <vector>
 #include "gtest/gtest.h"
 #include "node_test_fixture.h"
 
@@ -60,6 +61,36 @@ TEST_F(PlatformTest, SkipNewTasksInFlushForegroundTasks) {
   EXPECT_FALSE(platform->FlushForegroundTasks(isolate_));
 }
 
+// This task records its id when it runs.
+class RecordingTask : public v8::Task {
+ public:
+  RecordingTask(int id, std::vector<int>* order) : id_(id), order_(order) {}
+
+  // v8::Task implementation
+  void Run() final { order_->push_back(id_); }
+
+ private:
+  int id_;
+  std::vector<int>* order_;
+};
+
+TEST_F(PlatformTest, BestEffortTasksRunAfterOtherLanes) {
+  v8::Isolate::Scope isolate_scope(isolate_);
+  const v8::HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env {handle_scope, argv};
+  std::vector<int> order;
+  platform->GetForegroundTaskRunner(isolate_, v8::TaskPriority::kBestEffort)
+      ->PostTask(std::make_unique<RecordingTask>(1, &order));
+  platform->GetForegroundTaskRunner(isolate_, v8::TaskPriority::kUserVisible)
+      ->PostTask(std::make_unique<RecordingTask>(2, &order));
+  platform->GetForegroundTaskRunner(isolate_, v8::TaskPriority::kUserBlocking)
+      ->PostTask(std::make_unique<RecordingTask>(3, &order));
+  EXPECT_TRUE(platform->FlushForegroundTasks(isolate_));
+  EXPECT_EQ(order, (std::vector<int>{3, 2, 1}));
+  EXPECT_FALSE(platform->FlushForegroundTasks(isolate_));
+}
+
 // Tests the registration of an abstract `IsolatePlatformDelegate` instance as
 // opposed to the more common `uv_loop_s*` version of `RegisterIsolate`.
 TEST_F(NodeZeroIsolateTestFixture, IsolatePlatformDelegateTest) {
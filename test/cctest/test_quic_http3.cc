@@ -0,0 +1,120 @@
+#if HAVE_OPENSSL && NODE_OPENSSL_HAS_QUIC
+#include <gtest/gtest.h>
+#include <nghttp3/nghttp3.h>
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <string_view>
+
+namespace {
+
+// The body of a request as Http3ApplicationImpl hands it to nghttp3: it is
+// passed out by the read_data callback without being copied, and comes back
+// through acked_stream_data once the peer has acknowledged it, which is when
+// the stream may release it. acked_stream_data must do so without handing
+// the bytes to nghttp3_conn_add_ack_offset() again, which would call it back
+// before nghttp3 has moved on.
+struct Body {
+  std::string data;
+  size_t read = 0;
+  uint64_t acked = 0;
+  int ack_depth = 0;
+  int max_ack_depth = 0;
+  nghttp3_conn* conn = nullptr;
+};
+
+nghttp3_ssize ReadData(nghttp3_conn* conn,
+                       int64_t stream_id,
+                       nghttp3_vec* vec,
+                       size_t veccnt,
+                       uint32_t* pflags,
+                       void* conn_user_data,
+                       void* stream_user_data) {
+  Body* body = static_cast<Body*>(conn_user_data);
+  *pflags |= NGHTTP3_DATA_FLAG_EOF;
+  if (body->read == body->data.size()) return 0;
+  vec[0].base = reinterpret_cast<uint8_t*>(body->data.data()) + body->read;
+  vec[0].len = body->data.size() - body->read;
+  body->read = body->data.size();
+  return 1;
+}
+
+int AckedStreamData(nghttp3_conn* conn,
+                    int64_t stream_id,
+                    uint64_t datalen,
+                    void* conn_user_data,
+                    void* stream_user_data) {
+  Body* body = static_cast<Body*>(conn_user_data);
+  body->max_ack_depth = std::max(body->max_ack_depth, ++body->ack_depth);
+  body->acked += datalen;
+  body->ack_depth--;
+  return 0;
+}
+
+nghttp3_nv MakeHeader(std::string_view name, std::string_view value) {
+  return nghttp3_nv{
+      reinterpret_cast<uint8_t*>(const_cast<char*>(name.data())),
+      reinterpret_cast<uint8_t*>(const_cast<char*>(value.data())),
+      name.size(),
+      value.size(),
+      NGHTTP3_NV_FLAG_NONE};
+}
+
+}  // namespace
+
+TEST(Http3, AcknowledgesRequestBody) {
+  Body body;
+  body.data = std::string(100000, 'x');
+
+  nghttp3_callbacks callbacks{};
+  callbacks.acked_stream_data = AckedStreamData;
+  nghttp3_settings settings;
+  nghttp3_settings_default(&settings);
+  nghttp3_conn* conn;
+  ASSERT_EQ(nghttp3_conn_client_new(
+                &conn, &callbacks, &settings, nghttp3_mem_default(), &body),
+            0);
+  body.conn = conn;
+  ASSERT_EQ(nghttp3_conn_bind_control_stream(conn, 2), 0);
+  ASSERT_EQ(nghttp3_conn_bind_qpack_streams(conn, 6, 10), 0);
+
+  const nghttp3_nv headers[] = {
+      MakeHeader(":method", "POST"),
+      MakeHeader(":scheme", "https"),
+      MakeHeader(":authority", "localhost"),
+      MakeHeader(":path", "/"),
+  };
+  const nghttp3_data_reader reader{ReadData};
+  ASSERT_EQ(nghttp3_conn_submit_request(
+                conn, 0, headers, std::size(headers), &reader, nullptr),
+            0);
+
+  // Send everything and have the peer acknowledge the request stream.
+  uint64_t request_written = 0;
+  bool request_finished = false;
+  for (int i = 0; i < 100; i++) {
+    int64_t stream_id = -1;
+    int fin = 0;
+    nghttp3_vec vec[16];
+    nghttp3_ssize count = nghttp3_conn_writev_stream(
+        conn, &stream_id, &fin, vec, std::size(vec));
+    ASSERT_GE(count, 0);
+    if (stream_id < 0) break;
+    const uint64_t length = nghttp3_vec_len(vec, count);
+    ASSERT_EQ(nghttp3_conn_add_write_offset(conn, stream_id, length), 0);
+    if (stream_id == 0) {
+      request_written += length;
+      if (fin) request_finished = true;
+    }
+  }
+  ASSERT_TRUE(request_finished);
+  EXPECT_EQ(body.read, body.data.size());
+  ASSERT_EQ(nghttp3_conn_add_ack_offset(conn, 0, request_written), 0);
+
+  // Only the body is reported, in full and without recursion.
+  EXPECT_EQ(body.acked, body.data.size());
+  EXPECT_EQ(body.max_ack_depth, 1);
+
+  nghttp3_conn_del(conn);
+}
+#endif  // HAVE_OPENSSL && NODE_OPENSSL_HAS_QUIC
@@ -0,0 +1,164 @@
+#include "node.h"
+
+#include <string>
+#include "gtest/gtest.h"
+#include "node_test_fixture.h"
+
+// memfd and the futexes are Linux-only.
+#if defined(__linux__)
+
+using v8::HandleScope;
+
+class ShmTest : public EnvironmentTestFixture {};
+
+// Collects the codes of the errors that the functions in `calls` throw.
+#define COLLECT_ERRORS                                                        \
+  "function collectErrors(calls) {\n"                                         \
+  "  return calls.map((call) => {\n"                                          \
+  "    try {\n"                                                               \
+  "      call();\n"                                                           \
+  "      return 'ok';\n"                                                      \
+  "    } catch (err) {\n"                                                     \
+  "      return err.code;\n"                                                  \
+  "    }\n"                                                                   \
+  "  }).join();\n"                                                            \
+  "}\n"
+
+TEST_F(ShmTest, NamedObject) {
+  const HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env{handle_scope, argv};
+
+  EXPECT_EQ(RunScript(env,
+                      "const shm = internalBinding('shm');\n"
+                      "const { closeSync } = require('fs');\n"
+                      "const name = `/node-cctest-shm-${process.pid}`;\n"
+                      "const fd = shm.open(name, 4096, true);\n"
+                      "const writer = new Int32Array(shm.map(fd, 4096));\n"
+                      "closeSync(fd);\n"
+                      "writer[1] = 42;\n"
+                      "const fd2 = shm.open(name, 0, false);\n"
+                      "const reader = new Int32Array(shm.map(fd2, 4096));\n"
+                      "closeSync(fd2);\n"
+                      "shm.unlink(name);\n"
+                      "globalThis.result = `${reader[1]}`;\n"),
+            "42");
+}
+
+TEST_F(ShmTest, ValidatesNames) {
+  const HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env{handle_scope, argv};
+
+  EXPECT_EQ(RunScript(env,
+                      COLLECT_ERRORS
+                      "const shm = internalBinding('shm');\n"
+                      "globalThis.result = collectErrors([\n"
+                      "  () => shm.open('no-slash', 4096, true),\n"
+                      "  () => shm.open('/', 4096, true),\n"
+                      "  () => shm.open('/a/b', 4096, true),\n"
+                      "  () => shm.open('/..', 4096, true),\n"
+                      "  () => shm.open('/' + 'x'.repeat(300), 4096, true),\n"
+                      "  () => shm.unlink('/../etc/passwd'),\n"
+                      "]);\n"),
+            "ERR_INVALID_ARG_VALUE,ERR_INVALID_ARG_VALUE,"
+            "ERR_INVALID_ARG_VALUE,ERR_INVALID_ARG_VALUE,"
+            "ERR_INVALID_ARG_VALUE,ERR_INVALID_ARG_VALUE");
+}
+
+TEST_F(ShmTest, ValidatesSizes) {
+  const HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env{handle_scope, argv};
+
+  EXPECT_EQ(RunScript(env,
+                      COLLECT_ERRORS
+                      "const shm = internalBinding('shm');\n"
+                      "globalThis.result = collectErrors([\n"
+                      "  () => shm.createAnonymous(0),\n"
+                      "  () => shm.createAnonymous(-1),\n"
+                      "  () => shm.createAnonymous(1.5),\n"
+                      "  () => shm.createAnonymous(NaN),\n"
+                      "  () => shm.createAnonymous(2 ** 64),\n"
+                      "  () => shm.open('/node-cctest-shm', -4096, true),\n"
+                      "]);\n"),
+            "ERR_OUT_OF_RANGE,ERR_OUT_OF_RANGE,ERR_OUT_OF_RANGE,"
+            "ERR_OUT_OF_RANGE,ERR_OUT_OF_RANGE,ERR_OUT_OF_RANGE");
+}
+
+TEST_F(ShmTest, MapsOnlyWithinTheObject) {
+  const HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env{handle_scope, argv};
+
+  // Mapping past the end of the object would raise SIGBUS on access.
+  EXPECT_EQ(RunScript(env,
+                      COLLECT_ERRORS
+                      "const shm = internalBinding('shm');\n"
+                      "const fd = shm.createAnonymous(4096);\n"
+                      "globalThis.result = collectErrors([\n"
+                      "  () => shm.map(fd, 8192),\n"
+                      "  () => shm.map(fd, 0),\n"
+                      "  () => shm.map(fd, 4096),\n"
+                      "  () => shm.map(fd, 100),\n"
+                      "]);\n"
+                      "require('fs').closeSync(fd);\n"),
+            "ERR_OUT_OF_RANGE,ERR_OUT_OF_RANGE,ok,ok");
+}
+
+TEST_F(ShmTest, WaitAndNotify) {
+  const HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env{handle_scope, argv};
+
+  EXPECT_EQ(RunScript(env,
+                      COLLECT_ERRORS
+                      "const shm = internalBinding('shm');\n"
+                      "const fd = shm.createAnonymous(4096);\n"
+                      "const buffer = shm.map(fd, 4096);\n"
+                      "require('fs').closeSync(fd);\n"
+                      "const results = [\n"
+                      "  shm.wait(buffer, 0, 1, 0) === shm.kWaitNotEqual,\n"
+                      "  shm.wait(buffer, 0, 0, 10) === shm.kWaitTimedOut,\n"
+                      "  shm.notify(buffer, 0, 1) === 0,\n"
+                      "];\n"
+                      "globalThis.result = results.join() + ' ' +\n"
+                      "    collectErrors([\n"
+                      "      () => shm.wait(buffer, 2, 0, 0),\n"
+                      "      () => shm.wait(buffer, 4096, 0, 0),\n"
+                      "    ]);\n"),
+            "true,true,true ERR_OUT_OF_RANGE,ERR_OUT_OF_RANGE");
+}
+
+TEST_F(ShmTest, TerminatingAWorkerInterruptsWait) {
+  const HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env{handle_scope, argv};
+
+  EXPECT_EQ(RunScript(env,
+                      "const shm = internalBinding('shm');\n"
+                      "const { Worker } = require('worker_threads');\n"
+                      "const fd = shm.createAnonymous(4096);\n"
+                      "const buffer = shm.map(fd, 4096);\n"
+                      "require('fs').closeSync(fd);\n"
+                      "const worker = new Worker(`\n"
+                      "  const { internalBinding } =\n"
+                      "      require('internal/test/binding');\n"
+                      "  const { parentPort, workerData } =\n"
+                      "      require('worker_threads');\n"
+                      "  parentPort.postMessage('waiting');\n"
+                      "  internalBinding('shm').wait(workerData, 0, 0, -1);\n"
+                      "`, {\n"
+                      "  eval: true,\n"
+                      "  workerData: buffer,\n"
+                      "  execArgv: ['--expose-internals'],\n"
+                      "});\n"
+                      "worker.once('message', () => setTimeout(() => {\n"
+                      "  worker.terminate().then(() => {\n"
+                      "    globalThis.result = 'terminated';\n"
+                      "  });\n"
+                      "}, 100));\n"),
+            "terminated");
+}
+
+#endif  // defined(__linux__)
@@ -215,3 +215,44 @@ TEST(SocketAddressBlockList, Simple) {
   CHECK(!bl.Apply(addr1));
   CHECK(bl.Apply(addr2));
 }
+
+TEST(SocketAddressBlockList, SubnetsAndRanges) {
+  SocketAddressBlockList bl;
+
+  auto make = [](int family, const char* address) {
+    sockaddr_storage storage;
+    SocketAddress::ToSockAddr(family, address, 0, &storage);
+    return std::make_shared<SocketAddress>(
+        reinterpret_cast<const sockaddr*>(&storage));
+  };
+
+  bl.AddSocketAddressMask(make(AF_INET, "192.168.0.0"), 16);
+  bl.AddSocketAddressMask(make(AF_INET6, "2001:db8::"), 32);
+  bl.AddSocketAddressRange(make(AF_INET, "10.0.0.10"),
+                           make(AF_INET, "10.0.0.20"));
+  bl.AddSocketAddressRange(make(AF_INET, "10.0.0.15"),
+                           make(AF_INET, "10.0.0.30"));
+  bl.AddSocketAddressRange(make(AF_INET6, "fe80::1"),
+                           make(AF_INET6, "fe80::ff"));
+
+  CHECK(bl.Apply(make(AF_INET, "192.168.255.1")));
+  CHECK(bl.Apply(make(AF_INET6, "::ffff:192.168.1.1")));
+  CHECK(!bl.Apply(make(AF_INET, "192.169.0.1")));
+  CHECK(bl.Apply(make(AF_INET6, "2001:db8:ffff::1")));
+  CHECK(!bl.Apply(make(AF_INET6, "2001:db9::1")));
+
+  CHECK(bl.Apply(make(AF_INET, "10.0.0.10")));
+  CHECK(bl.Apply(make(AF_INET, "10.0.0.25")));
+  CHECK(bl.Apply(make(AF_INET, "10.0.0.30")));
+  CHECK(bl.Apply(make(AF_INET6, "::ffff:10.0.0.12")));
+  CHECK(!bl.Apply(make(AF_INET, "10.0.0.9")));
+  CHECK(!bl.Apply(make(AF_INET, "10.0.0.31")));
+
+  CHECK(bl.Apply(make(AF_INET6, "fe80::80")));
+  CHECK(!bl.Apply(make(AF_INET6, "fe80::100")));
+
+  // IPv4 addresses only match IPv6 rules through their mapped form.
+  bl.AddSocketAddressMask(make(AF_INET6, "::"), 1);
+  CHECK(bl.Apply(make(AF_INET, "1.2.3.4")));
+  CHECK_EQ(bl.size(), 6u);
+}
@@ -0,0 +1,92 @@
+#include "node_source_map.h"
+#include "gtest/gtest.h"
+
+#include <optional>
+#include <string>
+
+using node::source_map::MappingEntry;
+using node::source_map::MappingIndex;
+
+namespace {
+
+void ExpectEntry(const MappingEntry* entry,
+                 int32_t generated_line,
+                 int32_t generated_column,
+                 int32_t source,
+                 int32_t original_line,
+                 int32_t original_column,
+                 int32_t name) {
+  ASSERT_NE(entry, nullptr);
+  EXPECT_EQ(entry->generated_line, generated_line);
+  EXPECT_EQ(entry->generated_column, generated_column);
+  EXPECT_EQ(entry->source, source);
+  EXPECT_EQ(entry->original_line, original_line);
+  EXPECT_EQ(entry->original_column, original_column);
+  EXPECT_EQ(entry->name, name);
+}
+
+}  // namespace
+
+TEST(SourceMapTest, DecodesMappings) {
+  // Fields are relative to the previous segment, columns to the previous
+  // segment on the same line.
+  std::optional<MappingIndex> index =
+      MappingIndex::Decode("AAAA,CAAC;AAED,gBCAAA,E;;A");
+  ASSERT_TRUE(index.has_value());
+  const auto& entries = index->entries();
+  ASSERT_EQ(entries.size(), 6u);
+  ExpectEntry(&entries[0], 0, 0, 0, 0, 0, -1);
+  ExpectEntry(&entries[1], 0, 1, 0, 0, 1, -1);
+  ExpectEntry(&entries[2], 1, 0, 0, 2, 0, -1);
+  ExpectEntry(&entries[3], 1, 16, 1, 2, 0, 0);
+  ExpectEntry(&entries[4], 1, 18, -1, -1, -1, -1);
+  ExpectEntry(&entries[5], 3, 0, -1, -1, -1, -1);
+}
+
+TEST(SourceMapTest, FindsEntries) {
+  std::optional<MappingIndex> index = MappingIndex::Decode("EAAA,IAAC;AACA");
+  ASSERT_TRUE(index.has_value());
+  EXPECT_EQ(index->Find(0, 0), nullptr);
+  ExpectEntry(index->Find(0, 2), 0, 2, 0, 0, 0, -1);
+  ExpectEntry(index->Find(0, 5), 0, 2, 0, 0, 0, -1);
+  ExpectEntry(index->Find(0, 6), 0, 6, 0, 0, 1, -1);
+  ExpectEntry(index->Find(0, 1000), 0, 6, 0, 0, 1, -1);
+  ExpectEntry(index->Find(1, 0), 1, 0, 0, 1, 1, -1);
+  ExpectEntry(index->Find(5, 5), 1, 0, 0, 1, 1, -1);
+}
+
+TEST(SourceMapTest, SortsSegmentsOfALine) {
+  std::optional<MappingIndex> index = MappingIndex::Decode("IAAA,FAAC");
+  ASSERT_TRUE(index.has_value());
+  ExpectEntry(index->Find(0, 3), 0, 2, 0, 0, 1, -1);
+  ExpectEntry(index->Find(0, 4), 0, 4, 0, 0, 0, -1);
+}
+
+TEST(SourceMapTest, RejectsInvalidMappings) {
+  EXPECT_FALSE(MappingIndex::Decode("AA").has_value());
+  EXPECT_FALSE(MappingIndex::Decode("AAAAAA").has_value());
+  EXPECT_FALSE(MappingIndex::Decode("A!AA").has_value());
+  EXPECT_FALSE(MappingIndex::Decode("g").has_value());
+}
+
+TEST(SourceMapTest, RejectsOverflowingMappings) {
+  // "+/////D" is the largest column, 2^31 - 1.
+  EXPECT_TRUE(MappingIndex::Decode("+/////D").has_value());
+  EXPECT_FALSE(MappingIndex::Decode("+/////D,C").has_value());
+  EXPECT_FALSE(MappingIndex::Decode("A+/////DAA,ACAA").has_value());
+}
+
+TEST(SourceMapTest, RoundTripsSerializedEntries) {
+  std::optional<MappingIndex> index = MappingIndex::Decode("AAAA,CAAC;AAED");
+  ASSERT_TRUE(index.has_value());
+  std::optional<MappingIndex> copy =
+      MappingIndex::Deserialize(index->Serialize());
+  ASSERT_TRUE(copy.has_value());
+  ASSERT_EQ(copy->entries().size(), 3u);
+  ExpectEntry(copy->Find(1, 0), 1, 0, 0, 2, 0, -1);
+
+  std::string data = index->Serialize();
+  EXPECT_FALSE(MappingIndex::Deserialize(data.substr(0, 10)).has_value());
+  data[0] ^= 1;
+  EXPECT_FALSE(MappingIndex::Deserialize(data).has_value());
+}
@@ -0,0 +1,298 @@
+#include "node.h"
+
+#include <string>
+#include "gtest/gtest.h"
+#include "node_test_fixture.h"
+
+using v8::HandleScope;
+
+class SqliteTest : public EnvironmentTestFixture {};
+
+// Creates `source` with a table and `changeset`, which inserts two rows
+// into it.
+#define CHANGESET_SCRIPT                                                      \
+  "const { DatabaseSync } = require('sqlite');\n"                             \
+  "const schema = 'CREATE TABLE t(k INTEGER PRIMARY KEY, v TEXT)';\n"         \
+  "const source = new DatabaseSync(':memory:');\n"                            \
+  "source.exec(schema);\n"                                                    \
+  "const session = source.createSession();\n"                                 \
+  "source.exec(\"INSERT INTO t VALUES (1, 'a'), (2, 'b')\");\n"               \
+  "const changeset = session.changeset();\n"                                  \
+  "const target = new DatabaseSync(':memory:');\n"                            \
+  "target.exec(schema);\n"
+
+TEST_F(SqliteTest, ApplyChangesetAsync) {
+  const HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env{handle_scope, argv};
+
+  EXPECT_EQ(RunScript(env,
+                      CHANGESET_SCRIPT
+                      "const half = changeset.length >> 1;\n"
+                      "target.applyChangesetAsync([\n"
+                      "  changeset.subarray(0, half),\n"
+                      "  changeset.subarray(half),\n"
+                      "]).then((applied) => {\n"
+                      "  const rows = target.prepare('SELECT v FROM t')\n"
+                      "      .all();\n"
+                      "  globalThis.result =\n"
+                      "      `${applied} ${rows.map((r) => r.v).join()}`;\n"
+                      "});\n"),
+            "true a,b");
+}
+
+TEST_F(SqliteTest, ApplyChangesetAsyncRefusesUserFunctions) {
+  const HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env{handle_scope, argv};
+
+  // A trigger could call the function on the thread pool.
+  EXPECT_EQ(RunScript(env,
+                      CHANGESET_SCRIPT
+                      "target.function('f', () => 1);\n"
+                      "try {\n"
+                      "  target.applyChangesetAsync([changeset]);\n"
+                      "  globalThis.result = 'applied';\n"
+                      "} catch (err) {\n"
+                      "  globalThis.result = err.code;\n"
+                      "}\n"),
+            "ERR_INVALID_STATE");
+}
+
+TEST_F(SqliteTest, ApplyChangesetAsyncBlocksFunctionRegistration) {
+  const HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env{handle_scope, argv};
+
+  EXPECT_EQ(RunScript(env,
+                      CHANGESET_SCRIPT
+                      "const applied =\n"
+                      "    target.applyChangesetAsync([changeset]);\n"
+                      "const errors = [];\n"
+                      "for (const register of [\n"
+                      "  () => target.function('f', () => 1),\n"
+                      "  () => target.aggregate('g', {\n"
+                      "    start: 0, step: () => 0,\n"
+                      "  }),\n"
+                      "  () => target.close(),\n"
+                      "]) {\n"
+                      "  try {\n"
+                      "    register();\n"
+                      "  } catch (err) {\n"
+                      "    errors.push(err.code);\n"
+                      "  }\n"
+                      "}\n"
+                      "applied.then(() => {\n"
+                      "  target.function('f', () => 1);\n"
+                      "  globalThis.result = errors.join();\n"
+                      "});\n"),
+            "ERR_INVALID_STATE,ERR_INVALID_STATE,ERR_INVALID_STATE");
+}
+
+TEST_F(SqliteTest, ApplyChangesetAsyncValidatesArguments) {
+  const HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env{handle_scope, argv};
+
+  EXPECT_EQ(RunScript(env,
+                      CHANGESET_SCRIPT
+                      "const errors = [];\n"
+                      "for (const args of [\n"
+                      "  [changeset],\n"
+                      "  [[changeset, 'x']],\n"
+                      "  [[changeset], { onConflict: 42 }],\n"
+                      "  [[changeset], { tables: 't' }],\n"
+                      "]) {\n"
+                      "  try {\n"
+                      "    target.applyChangesetAsync(...args);\n"
+                      "  } catch (err) {\n"
+                      "    errors.push(err.code);\n"
+                      "  }\n"
+                      "}\n"
+                      "globalThis.result = errors.join();\n"),
+            "ERR_INVALID_ARG_TYPE,ERR_INVALID_ARG_TYPE,"
+            "ERR_INVALID_ARG_TYPE,ERR_INVALID_ARG_TYPE");
+}
+
+// Defines `location`, a path for a new database file, and `cleanUp()`,
+// which removes it.
+#define DATABASE_FILE_SCRIPT(name)                                            \
+  "const fs = require('fs');\n"                                               \
+  "const location = require('path').join(require('os').tmpdir(),\n"          \
+  "    `node-cctest-" name "-${process.pid}.db`);\n"                          \
+  "function cleanUp() {\n"                                                    \
+  "  for (const suffix of ['', '-wal', '-shm', '-journal'])\n"                \
+  "    fs.rmSync(location + suffix, { force: true });\n"                      \
+  "}\n"                                                                       \
+  "cleanUp();\n"                                                              \
+  "const { Database, DatabaseSync } = internalBinding('sqlite');\n"
+
+TEST_F(SqliteTest, DatabaseKeepsJournalMode) {
+  const HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env{handle_scope, argv};
+
+  // Opening a database must not rewrite its journal mode on disk.
+  EXPECT_EQ(RunScript(env,
+                      DATABASE_FILE_SCRIPT("keep-journal")
+                      "const db = new Database(location, { readers: 2 });\n"
+                      "db.exec('CREATE TABLE t(v INTEGER)')\n"
+                      "  .then(() => db.run('INSERT INTO t VALUES (1)'))\n"
+                      "  .then(() => db.get('SELECT v FROM t'))\n"
+                      "  .then(async (row) => {\n"
+                      "    await db.close();\n"
+                      "    const wal = fs.existsSync(location + '-wal');\n"
+                      "    const sync = new DatabaseSync(location);\n"
+                      "    const { journal_mode } =\n"
+                      "        sync.prepare('PRAGMA journal_mode').get();\n"
+                      "    sync.close();\n"
+                      "    cleanUp();\n"
+                      "    globalThis.result = `${row.v} ${journal_mode} "
+                      "${wal}`;\n"
+                      "  });\n"),
+            "1 delete false");
+}
+
+TEST_F(SqliteTest, DatabaseEnablesWAL) {
+  const HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env{handle_scope, argv};
+
+  EXPECT_EQ(RunScript(env,
+                      DATABASE_FILE_SCRIPT("enable-wal")
+                      "const db = new Database(location,\n"
+                      "    { readers: 2, enableWAL: true });\n"
+                      "db.exec('CREATE TABLE t(v INTEGER)')\n"
+                      "  .then(() => Promise.all([1, 2, 3].map((v) =>\n"
+                      "    db.run('INSERT INTO t VALUES (?)', v))))\n"
+                      "  .then(() => Promise.all([\n"
+                      "    db.get('PRAGMA journal_mode'),\n"
+                      "    // More reads than readers queue up.\n"
+                      "    ...[1, 2, 3, 4].map(() =>\n"
+                      "      db.get('SELECT sum(v) AS s FROM t')),\n"
+                      "  ]))\n"
+                      "  .then(async ([mode, ...sums]) => {\n"
+                      "    await db.close();\n"
+                      "    cleanUp();\n"
+                      "    globalThis.result = `${mode.journal_mode} ` +\n"
+                      "        sums.map((row) => row.s).join();\n"
+                      "  });\n"),
+            "wal 6,6,6,6");
+}
+
+TEST_F(SqliteTest, DatabaseValidatesOptions) {
+  const HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env{handle_scope, argv};
+
+  EXPECT_EQ(RunScript(env,
+                      "const { Database } = internalBinding('sqlite');\n"
+                      "const errors = [];\n"
+                      "for (const options of [\n"
+                      "  { readers: -1 },\n"
+                      "  { readers: 1.5 },\n"
+                      "  { enableWAL: 'yes' },\n"
+                      "]) {\n"
+                      "  try {\n"
+                      "    new Database(':memory:', options);\n"
+                      "  } catch (err) {\n"
+                      "    errors.push(err.code);\n"
+                      "  }\n"
+                      "}\n"
+                      "globalThis.result = errors.join();\n"),
+            "ERR_INVALID_ARG_TYPE,ERR_INVALID_ARG_TYPE,ERR_INVALID_ARG_TYPE");
+}
+
+TEST_F(SqliteTest, DatabaseRejectsFailedQueries) {
+  const HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env{handle_scope, argv};
+
+  EXPECT_EQ(RunScript(env,
+                      "const { Database } = internalBinding('sqlite');\n"
+                      "const db = new Database(':memory:');\n"
+                      "db.all('SELECT * FROM missing').then(\n"
+                      "  () => { globalThis.result = 'resolved'; },\n"
+                      "  async (err) => {\n"
+                      "    await db.close();\n"
+                      "    globalThis.result = `${err.code} ${db.isOpen}`;\n"
+                      "  });\n"),
+            "ERR_SQLITE_ERROR false");
+}
+
+TEST_F(SqliteTest, StatementCacheDoesNotShareLiveStatements) {
+  const HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env{handle_scope, argv};
+
+  // Both statements are in use, so neither may be handed out again.
+  EXPECT_EQ(RunScript(env,
+                      "const { DatabaseSync } = require('sqlite');\n"
+                      "const db = new DatabaseSync(':memory:', {\n"
+                      "  statementCacheSize: 4,\n"
+                      "});\n"
+                      "db.exec('CREATE TABLE t(v INTEGER)');\n"
+                      "db.exec('INSERT INTO t VALUES (1), (2)');\n"
+                      "const sql = 'SELECT v FROM t ORDER BY v';\n"
+                      "const a = db.prepare(sql);\n"
+                      "const b = db.prepare(sql);\n"
+                      "const first = a.iterate().next().value.v;\n"
+                      "const all = b.all().map((row) => row.v).join();\n"
+                      "const { hits, misses } = db.statementCacheStats();\n"
+                      "globalThis.result =\n"
+                      "    `${a !== b} ${first} ${all} ${hits} ${misses}`;\n"),
+            "true 1 1,2 0 2");
+}
+
+TEST_F(SqliteTest, DatabaseSharedCacheAndMmapSize) {
+  const HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env{handle_scope, argv};
+
+  // Readers of a shared cache would only lock each other out. mmapSize
+  // takes sizes beyond 32 bits.
+  EXPECT_EQ(RunScript(env,
+                      "const { Database } = internalBinding('sqlite');\n"
+                      "const results = [];\n"
+                      "function attempt(options) {\n"
+                      "  try {\n"
+                      "    return new Database(':memory:', options);\n"
+                      "  } catch (err) {\n"
+                      "    results.push(err.code);\n"
+                      "  }\n"
+                      "}\n"
+                      "attempt({ sharedCache: true, readers: 2 });\n"
+                      "attempt({ mmapSize: -1 });\n"
+                      "attempt({ mmapSize: 1.5 });\n"
+                      "const big = attempt({ mmapSize: 2 ** 32 });\n"
+                      "const shared = attempt({ sharedCache: true });\n"
+                      "shared.get('SELECT 1 AS v').then(async (row) => {\n"
+                      "  results.push(row.v);\n"
+                      "  await Promise.all([shared.close(), big.close()]);\n"
+                      "  globalThis.result = results.join();\n"
+                      "});\n"),
+            "ERR_INVALID_ARG_VALUE,ERR_INVALID_ARG_TYPE,"
+            "ERR_INVALID_ARG_TYPE,1");
+}
+
+TEST_F(SqliteTest, AggregateClampsBatchSize) {
+  const HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env{handle_scope, argv};
+
+  // The largest accepted batchSize must not reserve memory for all of it.
+  EXPECT_EQ(RunScript(env,
+                      "const { DatabaseSync } = require('sqlite');\n"
+                      "const db = new DatabaseSync(':memory:');\n"
+                      "db.exec('CREATE TABLE t(v INTEGER)');\n"
+                      "db.exec('INSERT INTO t VALUES (1), (2), (3)');\n"
+                      "db.aggregate('batched', {\n"
+                      "  start: 0,\n"
+                      "  batchSize: 2 ** 32 - 1,\n"
+                      "  step: (acc, values) =>\n"
+                      "      values.reduce((a, b) => a + b, acc),\n"
+                      "});\n"
+                      "const sql = 'SELECT batched(v) AS v FROM t';\n"
+                      "globalThis.result = db.prepare(sql).get().v;\n"),
+            "6");
+}
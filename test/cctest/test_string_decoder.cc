@@ -0,0 +1,41 @@
+#include "string_decoder.h"
+
+#include <string>
+#include "gtest/gtest.h"
+#include "node_test_fixture.h"
+
+using v8::HandleScope;
+
+class StringDecoderTest : public EnvironmentTestFixture {};
+
+TEST_F(StringDecoderTest, DecodeLines) {
+  const HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env{handle_scope, argv};
+
+  // Chunks split "\r\n" and a three byte character between them, the last
+  // one ends a line in the middle of a character.
+  EXPECT_EQ(RunScript(env,
+                      "const { decodeLines, encodings, kEncodingField, kSize }"
+                      " =\n"
+                      "    internalBinding('string_decoder');\n"
+                      "const decoder = Buffer.alloc(kSize);\n"
+                      "decoder[kEncodingField] = encodings.indexOf('utf8');\n"
+                      "const chunks = [\n"
+                      "  [Buffer.from('one\\r\\ntwo\\rthree\\n'), false],\n"
+                      "  [Buffer.from([0xe2, 0x82]), false],\n"
+                      "  [Buffer.from([0xac, 0x78, 0x0d]), false],\n"
+                      "  [Buffer.from('\\nfour'), true],\n"
+                      "  [Buffer.from('\\n'), false],\n"
+                      "  [Buffer.from([0xe2, 0x0a, 0x35]), false],\n"
+                      "];\n"
+                      "globalThis.result = JSON.stringify(chunks.map(\n"
+                      "    ([chunk, skip]) => decodeLines(decoder, chunk, "
+                      "skip)));\n"),
+            "[[\"one\",\"two\",\"three\",\"\"],"
+            "[\"\"],"
+            "[\"\xe2\x82\xacx\",\"\"],"
+            "[\"four\"],"
+            "[\"\",\"\"],"
+            "[\"\xef\xbf\xbd\",\"5\"]]");
+}
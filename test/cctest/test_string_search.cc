@@ -0,0 +1,85 @@
+#include "util-inl.h"
+
+#include "nbytes.h"
+#include "string_search.h"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using node::string_search::SearchString;
+
+namespace {
+
+// Compares against nbytes for all start indices in both directions.
+template <typename Char>
+void ExpectSameAsNbytes(const std::vector<Char>& haystack,
+                        const std::vector<Char>& needle) {
+  for (size_t start = 0; start <= haystack.size(); start++) {
+    for (bool is_forward : {true, false}) {
+      size_t expected = nbytes::SearchString(haystack.data(),
+                                             haystack.size(),
+                                             needle.data(),
+                                             needle.size(),
+                                             start,
+                                             is_forward);
+      size_t actual = SearchString(haystack.data(),
+                                   haystack.size(),
+                                   needle.data(),
+                                   needle.size(),
+                                   start,
+                                   is_forward);
+      EXPECT_EQ(expected, actual)
+          << "haystack length " << haystack.size() << ", needle length "
+          << needle.size() << ", start " << start << ", forward "
+          << is_forward;
+    }
+  }
+}
+
+template <typename Char>
+void RunRandomized(unsigned seed) {
+  std::mt19937 rng(seed);
+  // A small alphabet produces many partial matches.
+  std::uniform_int_distribution<int> character('a', 'c');
+  for (size_t haystack_length : {0, 1, 7, 15, 16, 17, 31, 33, 100, 257}) {
+    std::vector<Char> haystack(haystack_length);
+    for (Char& c : haystack) c = static_cast<Char>(character(rng));
+    for (size_t needle_length : {2, 3, 5, 16, 40}) {
+      std::vector<Char> needle(needle_length);
+      if (haystack_length >= needle_length && rng() % 2 == 0) {
+        // Take the needle from the haystack so that there is a match.
+        size_t at = rng() % (haystack_length - needle_length + 1);
+        std::copy_n(haystack.begin() + at, needle_length, needle.begin());
+      } else {
+        for (Char& c : needle) c = static_cast<Char>(character(rng));
+      }
+      ExpectSameAsNbytes(haystack, needle);
+    }
+  }
+}
+
+}  // namespace
+
+TEST(StringSearchTest, OneByteMatchesNbytes) {
+  for (unsigned seed = 0; seed < 20; seed++) RunRandomized<uint8_t>(seed);
+}
+
+TEST(StringSearchTest, TwoByteMatchesNbytes) {
+  for (unsigned seed = 0; seed < 20; seed++) RunRandomized<uint16_t>(seed);
+}
+
+TEST(StringSearchTest, FindsMatchesAtBothEnds) {
+  std::vector<uint8_t> haystack(100, 'x');
+  haystack[0] = 'a';
+  haystack[1] = 'b';
+  haystack[98] = 'a';
+  haystack[99] = 'b';
+  const uint8_t needle[] = {'a', 'b'};
+  EXPECT_EQ(SearchString(haystack.data(), 100, needle, 2, 0, true), 0u);
+  EXPECT_EQ(SearchString(haystack.data(), 100, needle, 2, 1, true), 98u);
+  EXPECT_EQ(SearchString(haystack.data(), 100, needle, 2, 99, false), 98u);
+  EXPECT_EQ(SearchString(haystack.data(), 100, needle, 2, 97, false), 0u);
+}
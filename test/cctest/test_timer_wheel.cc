@@ -0,0 +1,95 @@
+#include "timers.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using node::timers::TimerWheel;
+
+TEST(TimerWheelTest, ExpiresInOrder) {
+  TimerWheel wheel(100);
+  TimerWheel::Id late = wheel.Add(400);
+  TimerWheel::Id early = wheel.Add(101);
+  TimerWheel::Id middle = wheel.Add(356);
+  EXPECT_EQ(wheel.size(), 3u);
+
+  std::vector<TimerWheel::Id> expired;
+  wheel.Advance(355, &expired);
+  EXPECT_EQ(expired, std::vector<TimerWheel::Id>{early});
+
+  expired.clear();
+  wheel.Advance(1000, &expired);
+  EXPECT_EQ(expired, (std::vector<TimerWheel::Id>{middle, late}));
+  EXPECT_EQ(wheel.size(), 0u);
+}
+
+TEST(TimerWheelTest, PastTimersExpireOnNextAdvance) {
+  TimerWheel wheel(50);
+  TimerWheel::Id id = wheel.Add(10);
+  std::vector<TimerWheel::Id> expired;
+  wheel.Advance(50, &expired);
+  EXPECT_TRUE(expired.empty());
+  wheel.Advance(51, &expired);
+  EXPECT_EQ(expired, std::vector<TimerWheel::Id>{id});
+}
+
+TEST(TimerWheelTest, Cancel) {
+  TimerWheel wheel;
+  TimerWheel::Id id = wheel.Add(70000);
+  TimerWheel::Id other = wheel.Add(70000);
+  EXPECT_TRUE(wheel.Cancel(id));
+  EXPECT_FALSE(wheel.Cancel(id));
+  EXPECT_EQ(wheel.size(), 1u);
+
+  // The slot of a cancelled timer is reused with a different identifier.
+  TimerWheel::Id reused = wheel.Add(5);
+  EXPECT_NE(reused, id);
+  EXPECT_FALSE(wheel.Cancel(id));
+
+  std::vector<TimerWheel::Id> expired;
+  wheel.Advance(80000, &expired);
+  EXPECT_EQ(expired, (std::vector<TimerWheel::Id>{reused, other}));
+  EXPECT_FALSE(wheel.Cancel(other));
+}
+
+TEST(TimerWheelTest, MatchesReference) {
+  std::mt19937_64 rng(42);
+  TimerWheel wheel(12345);
+  std::multimap<uint64_t, TimerWheel::Id> reference;
+  std::vector<TimerWheel::Id> expired;
+  uint64_t now = 12345;
+
+  for (int round = 0; round < 2000; round++) {
+    for (int i = 0; i < 20; i++) {
+      // Mix of delays hitting every level of the wheel.
+      uint64_t delay = rng() % (uint64_t{1} << (rng() % 23));
+      uint64_t expiry = now + 1 + delay;
+      reference.emplace(expiry, wheel.Add(expiry));
+    }
+    if (!reference.empty() && rng() % 4 == 0) {
+      auto it = reference.begin();
+      std::advance(it, rng() % reference.size());
+      EXPECT_TRUE(wheel.Cancel(it->second));
+      reference.erase(it);
+    }
+
+    now += rng() % 3000;
+    expired.clear();
+    wheel.Advance(now, &expired);
+
+    std::vector<TimerWheel::Id> expected;
+    while (!reference.empty() && reference.begin()->first <= now) {
+      expected.push_back(reference.begin()->second);
+      reference.erase(reference.begin());
+    }
+    std::sort(expected.begin(), expected.end());
+    std::sort(expired.begin(), expired.end());
+    ASSERT_EQ(expired, expected);
+    EXPECT_EQ(wheel.size(), reference.size());
+  }
+}
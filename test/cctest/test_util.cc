@@ -8,6 +8,7 @@
 #include "v8-function-callback.h"
 #include "v8-primitive.h"
 #include "v8.h"
+#include "zstd.h"
 
 using node::Calloc;
 using node::Malloc;
@@ -261,6 +262,41 @@ TEST_F(UtilTest, MaybeStackBuffer) {
   }
 }
 
+namespace {
+struct Pooled : public node::ThreadLocalFreeList<Pooled, 2> {
+  virtual ~Pooled() = default;
+  char data[32];
+};
+struct LargerPooled : public Pooled {
+  char more[32];
+};
+}  // namespace
+
+TEST_F(UtilTest, ThreadLocalFreeList) {
+  Pooled* a = new Pooled();
+  Pooled* b = new Pooled();
+  Pooled* c = new Pooled();
+  delete a;
+  delete b;
+  // Only two blocks are kept, the third one is freed.
+  delete c;
+  Pooled* d = new Pooled();
+  Pooled* e = new Pooled();
+  EXPECT_EQ(d, b);
+  EXPECT_EQ(e, a);
+
+  // Subclasses of a different size do not use the list.
+  delete d;
+  Pooled* larger = new LargerPooled();
+  EXPECT_NE(larger, d);
+  delete larger;
+  Pooled* f = new Pooled();
+  EXPECT_EQ(f, d);
+
+  delete e;
+  delete f;
+}
+
 TEST_F(UtilTest, SPrintF) {
   // %d, %u and %s all do the same thing. The actual C++ type is used to infer
   // the right representation.
@@ -355,3 +391,26 @@ TEST_F(UtilTest, DetermineSpecificErrorType) {
       node::DetermineSpecificErrorType(*env, v8::Uint32::New(isolate_, 255)),
       "type number (255)");
 }
+
+TEST_F(UtilTest, StaticCompressedByteResource) {
+  const v8::HandleScope handle_scope(isolate_);
+  static const std::string source = "function f() { return 'compressed'; }";
+  static std::vector<uint8_t> compressed(ZSTD_compressBound(source.size()));
+  size_t compressed_size = ZSTD_compress(compressed.data(),
+                                         compressed.size(),
+                                         source.data(),
+                                         source.size(),
+                                         ZSTD_CLEVEL_DEFAULT);
+  ASSERT_FALSE(ZSTD_isError(compressed_size));
+
+  // V8 does not dispose the resource, so it must outlive the isolate.
+  static node::StaticCompressedOneByteResource resource(
+      compressed.data(), compressed_size, source.size());
+  node::UnionBytes bytes(&resource);
+  EXPECT_EQ(bytes.byte_length(), source.size());
+
+  v8::Local<v8::String> str = bytes.ToStringChecked(isolate_);
+  EXPECT_EQ(str->Length(), static_cast<int>(source.size()));
+  EXPECT_EQ(*node::Utf8Value(isolate_, str), source);
+  EXPECT_EQ(resource.data(), resource.data());
+}
@@ -0,0 +1,47 @@
+#include "node_test_fixture.h"
+#include "node_watchdog.h"
+#include "gtest/gtest.h"
+
+using node::Watchdog;
+using v8::Context;
+using v8::HandleScope;
+using v8::Local;
+using v8::Script;
+using v8::String;
+using v8::TryCatch;
+
+class WatchdogTest : public NodeTestFixture {
+ protected:
+  // Runs `source` with a timeout of `ms`, returns whether it timed out.
+  bool RunWithTimeout(const char* source, uint64_t ms) {
+    HandleScope handle_scope(isolate_);
+    Local<Context> context = Context::New(isolate_);
+    Context::Scope context_scope(context);
+    TryCatch try_catch(isolate_);
+    Local<Script> script =
+        Script::Compile(context,
+                        String::NewFromUtf8(isolate_, source).ToLocalChecked())
+            .ToLocalChecked();
+    bool timed_out = false;
+    {
+      Watchdog wd(isolate_, ms, &timed_out);
+      node::USE(script->Run(context));
+    }
+    if (timed_out) isolate_->CancelTerminateExecution();
+    return timed_out;
+  }
+};
+
+TEST_F(WatchdogTest, TerminatesExecution) {
+  EXPECT_TRUE(RunWithTimeout("while (true) {}", 10));
+  // The thread keeps serving later watchdogs.
+  EXPECT_TRUE(RunWithTimeout("while (true) {}", 10));
+}
+
+TEST_F(WatchdogTest, DisarmsOnDestruction) {
+  for (int i = 0; i < 1000; i++) {
+    EXPECT_FALSE(RunWithTimeout("1 + 1", 1000));
+  }
+  // Only the watchdog of the running code expires.
+  EXPECT_TRUE(RunWithTimeout("while (true) {}", 20));
+}
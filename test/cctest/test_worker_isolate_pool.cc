@@ -0,0 +1,100 @@
+#include "node_worker.h"
+
+#include <memory>
+#include "gtest/gtest.h"
+#include "node_test_fixture.h"
+#include "uv.h"
+
+using node::worker::WarmIsolate;
+using node::worker::WarmIsolatePool;
+using v8::HandleScope;
+
+class WarmIsolatePoolTest : public EnvironmentTestFixture {
+ protected:
+  // The pool fills up in the background, give it some time.
+  static std::unique_ptr<WarmIsolate> TakeWhenReady(WarmIsolatePool* pool) {
+    for (int i = 0; i < 3000; i++) {
+      std::unique_ptr<WarmIsolate> warm = pool->Take();
+      if (warm) return warm;
+      uv_sleep(10);
+    }
+    return nullptr;
+  }
+};
+
+TEST_F(WarmIsolatePoolTest, CreatesIsolatesInTheBackground) {
+  WarmIsolatePool pool(platform.get(), nullptr);
+  // Nothing is created before a size is set.
+  EXPECT_EQ(pool.Take(), nullptr);
+
+  pool.SetSize(2);
+  std::unique_ptr<WarmIsolate> first = TakeWhenReady(&pool);
+  ASSERT_NE(first, nullptr);
+  EXPECT_NE(first->isolate, nullptr);
+  EXPECT_NE(first->loop, nullptr);
+  EXPECT_NE(first->allocator, nullptr);
+  EXPECT_EQ(first->platform, platform.get());
+
+  // Taking an isolate refills the pool.
+  std::unique_ptr<WarmIsolate> second = TakeWhenReady(&pool);
+  ASSERT_NE(second, nullptr);
+  EXPECT_NE(second->isolate, first->isolate);
+}
+
+TEST_F(WarmIsolatePoolTest, ShrinksToTheNewSize) {
+  WarmIsolatePool pool(platform.get(), nullptr);
+  pool.SetSize(1);
+  ASSERT_NE(TakeWhenReady(&pool), nullptr);
+
+  // An isolate that is being created for the refill is not kept either.
+  pool.SetSize(0);
+  EXPECT_EQ(pool.Take(), nullptr);
+  uv_sleep(100);
+  EXPECT_EQ(pool.Take(), nullptr);
+}
+
+TEST_F(WarmIsolatePoolTest, DisposesOfIsolatesWhileFilling) {
+  // The destructor waits for the isolate being created and disposes of the
+  // ones that were not taken.
+  auto pool = std::make_unique<WarmIsolatePool>(platform.get(), nullptr);
+  pool->SetSize(4);
+  pool.reset();
+}
+
+TEST_F(WarmIsolatePoolTest, StartsWorkers) {
+  const HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env{handle_scope, argv};
+
+  // Workers with heap limits of their own can not use a warm isolate and
+  // create theirs as usual.
+  EXPECT_EQ(RunScript(env,
+                      "const { setWarmIsolatePoolSize } = "
+                      "internalBinding('worker');\n"
+                      "const { Worker } = require('worker_threads');\n"
+                      "setWarmIsolatePoolSize(2);\n"
+                      "const code = 'require(\"worker_threads\")"
+                      ".parentPort.postMessage(process.argv.length)';\n"
+                      "const results = [];\n"
+                      "function start(options) {\n"
+                      "  return new Promise((resolve, reject) => {\n"
+                      "    const worker = new Worker(code, {\n"
+                      "      eval: true, ...options });\n"
+                      "    worker.on('message', (m) => results.push(m > 0));\n"
+                      "    worker.on('error', reject);\n"
+                      "    worker.on('exit', resolve);\n"
+                      "  });\n"
+                      "}\n"
+                      "start({})\n"
+                      "  .then(() => start({}))\n"
+                      "  .then(() => start({ resourceLimits: {\n"
+                      "    maxOldGenerationSizeMb: 64 } }))\n"
+                      "  .then(() => {\n"
+                      "    setWarmIsolatePoolSize(0);\n"
+                      "    globalThis.result = results.join();\n"
+                      "  }, (err) => {\n"
+                      "    setWarmIsolatePoolSize(0);\n"
+                      "    globalThis.result = `${err}`;\n"
+                      "  });\n"),
+            "true,true,true");
+}
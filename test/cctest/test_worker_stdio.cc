@@ -0,0 +1,98 @@
+#include "node_worker.h"
+
+#include <memory>
+#include <string>
+#include "gtest/gtest.h"
+#include "uv.h"
+
+// Worker stdio pipes are not available on Windows.
+#ifndef _WIN32
+
+#include <fcntl.h>
+#include <unistd.h>
+
+using node::worker::StdioForwarder;
+
+namespace {
+
+// Reads exactly `size` bytes from `fd`.
+std::string ReadExactly(int fd, size_t size) {
+  std::string data(size, '\0');
+  size_t offset = 0;
+  while (offset < size) {
+    ssize_t n = read(fd, &data[offset], size - offset);
+    if (n <= 0) break;
+    offset += n;
+  }
+  data.resize(offset);
+  return data;
+}
+
+void WriteAll(int fd, const std::string& data) {
+  size_t offset = 0;
+  while (offset < data.size()) {
+    ssize_t n = write(fd, data.data() + offset, data.size() - offset);
+    ASSERT_GT(n, 0);
+    offset += n;
+  }
+}
+
+}  // anonymous namespace
+
+TEST(WorkerStdioTest, ForwardsBothStreams) {
+  uv_file out[2];
+  uv_file err_out[2];
+  ASSERT_EQ(uv_pipe(out, 0, 0), 0);
+  ASSERT_EQ(uv_pipe(err_out, 0, 0), 0);
+
+  int err;
+  std::unique_ptr<StdioForwarder> forwarder =
+      StdioForwarder::Create(&err, out[1], err_out[1]);
+  ASSERT_NE(forwarder, nullptr);
+  WriteAll(forwarder->write_fd(0), "stdout data");
+  WriteAll(forwarder->write_fd(1), "stderr data");
+  forwarder.reset();
+
+  // What was written before the forwarder was destroyed is still copied.
+  EXPECT_EQ(ReadExactly(out[0], 11), "stdout data");
+  EXPECT_EQ(ReadExactly(err_out[0], 11), "stderr data");
+
+  for (uv_file fd : {out[0], out[1], err_out[0], err_out[1]}) close(fd);
+}
+
+// Destroying the forwarder must not wait for an output that is not being
+// read, e.g. a full pipe to a stalled process.
+TEST(WorkerStdioTest, DoesNotBlockOnStalledOutput) {
+  uv_file out[2];
+  ASSERT_EQ(uv_pipe(out, 0, 0), 0);
+  uv_file err_out[2];
+  ASSERT_EQ(uv_pipe(err_out, 0, 0), 0);
+
+  // Fill the output pipe.
+  int flags = fcntl(out[1], F_GETFL);
+  ASSERT_EQ(fcntl(out[1], F_SETFL, flags | O_NONBLOCK), 0);
+  size_t filled = 0;
+  char chunk[4096] = {};
+  for (;;) {
+    ssize_t n = write(out[1], chunk, sizeof(chunk));
+    if (n <= 0) break;
+    filled += n;
+  }
+  ASSERT_EQ(fcntl(out[1], F_SETFL, flags), 0);
+
+  int err;
+  std::unique_ptr<StdioForwarder> forwarder =
+      StdioForwarder::Create(&err, out[1], err_out[1]);
+  ASSERT_NE(forwarder, nullptr);
+  WriteAll(forwarder->write_fd(0), "x");
+  forwarder.reset();
+
+  // Once the output is read again, the rest still arrives.
+  std::string data = ReadExactly(out[0], filled + 1);
+  ASSERT_EQ(data.size(), filled + 1);
+  EXPECT_EQ(data.back(), 'x');
+
+  for (uv_file fd : {out[0], out[1], err_out[0], err_out[1]}) close(fd);
+}
+
+#endif  // _WIN32
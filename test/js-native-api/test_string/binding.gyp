@@ -10,5 +10,14 @@
         "NAPI_VERSION=10",
       ],
     },
+    {
+      "target_name": "test_external_string_utf8",
+      "sources": [
+        "test_external_string_utf8.c",
+      ],
+      "defines": [
+        "NAPI_EXPERIMENTAL",
+      ],
+    },
   ],
 }
@@ -0,0 +1,82 @@
+#include <js_native_api.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../common.h"
+#include "../entry_point.h"
+
+static uint32_t finalize_count = 0;
+
+static void free_string(node_api_basic_env env, void* data, void* hint) {
+  free(data);
+  finalize_count++;
+}
+
+// createExternalUtf8(str, autoLength) returns [string, copied] for an
+// external string created from a copy of the UTF-8 bytes of `str`.
+static napi_value CreateExternalUtf8(napi_env env, napi_callback_info info) {
+  size_t argc = 2;
+  napi_value args[2];
+  NODE_API_CALL(env, napi_get_cb_info(env, info, &argc, args, NULL, NULL));
+  NODE_API_ASSERT(env, argc == 2, "Wrong number of arguments");
+
+  bool auto_length;
+  NODE_API_CALL(env, napi_get_value_bool(env, args[1], &auto_length));
+
+  size_t length;
+  NODE_API_CALL(env,
+                napi_get_value_string_utf8(env, args[0], NULL, 0, &length));
+  char* string_copy = malloc(length + 1);
+  NODE_API_ASSERT(env, string_copy != NULL, "Out of memory");
+  napi_status status = napi_get_value_string_utf8(
+      env, args[0], string_copy, length + 1, NULL);
+  if (status != napi_ok) {
+    free(string_copy);
+    NODE_API_CALL(env, status);
+  }
+
+  napi_value string;
+  // Initialize to the value that the ASCII cases must not report.
+  bool copied = true;
+  status = node_api_create_external_string_utf8(
+      env,
+      string_copy,
+      auto_length ? NAPI_AUTO_LENGTH : length,
+      free_string,
+      NULL,
+      &string,
+      &copied);
+  if (status != napi_ok) {
+    free(string_copy);
+    NODE_API_CALL(env, status);
+  }
+
+  napi_value result;
+  napi_value copied_value;
+  NODE_API_CALL(env, napi_create_array_with_length(env, 2, &result));
+  NODE_API_CALL(env, napi_get_boolean(env, copied, &copied_value));
+  NODE_API_CALL(env, napi_set_element(env, result, 0, string));
+  NODE_API_CALL(env, napi_set_element(env, result, 1, copied_value));
+  return result;
+}
+
+static napi_value GetFinalizeCount(napi_env env, napi_callback_info info) {
+  napi_value result;
+  NODE_API_CALL(env, napi_create_uint32(env, finalize_count, &result));
+  return result;
+}
+
+EXTERN_C_START
+napi_value Init(napi_env env, napi_value exports) {
+  napi_property_descriptor properties[] = {
+      DECLARE_NODE_API_PROPERTY("createExternalUtf8", CreateExternalUtf8),
+      DECLARE_NODE_API_PROPERTY("getFinalizeCount", GetFinalizeCount),
+  };
+
+  NODE_API_CALL(
+      env,
+      napi_define_properties(
+          env, exports, sizeof(properties) / sizeof(*properties), properties));
+
+  return exports;
+}
+EXTERN_C_END
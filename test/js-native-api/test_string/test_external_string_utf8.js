@@ -0,0 +1,30 @@
+'use strict';
+const common = require('../../common');
+const assert = require('assert');
+
+const {
+  createExternalUtf8,
+  getFinalizeCount,
+} = require(`./build/${common.buildType}/test_external_string_utf8`);
+
+// ASCII input is referenced without copying it.
+for (const str of ['', 'hello world', '?!@#$%^&*()_+-=[]{}/.,<>\'"\\']) {
+  assert.deepStrictEqual(createExternalUtf8(str, false), [str, false]);
+  assert.deepStrictEqual(createExternalUtf8(str, true), [str, false]);
+}
+assert.strictEqual(getFinalizeCount(), 0);
+
+// Anything else is decoded into a copy, and the original is finalized
+// before the call returns.
+const nonAsciiCases = [
+  '¡¢£¤¥¦§¨©ª«¬®¯°±²³´µ¶·¸¹º»¼½¾¿',
+  '\u{2003}\u{2101}\u{2001}\u{202}\u{2011}',
+  'ascii prefix \u{1f600}',
+];
+for (const str of nonAsciiCases) {
+  for (const autoLength of [false, true]) {
+    const count = getFinalizeCount();
+    assert.deepStrictEqual(createExternalUtf8(str, autoLength), [str, true]);
+    assert.strictEqual(getFinalizeCount(), count + 1);
+  }
+}
@@ -0,0 +1,58 @@
+#include "microbench.h"
+#include "node_sockaddr-inl.h"
+
+#include <memory>
+#include <string>
+
+using node::SocketAddress;
+using node::SocketAddressBlockList;
+using node::microbench::DoNotOptimize;
+
+namespace {
+
+std::shared_ptr<SocketAddress> MakeAddress(int family, const std::string& ip) {
+  sockaddr_storage storage;
+  SocketAddress::ToSockAddr(family, ip.c_str(), 0, &storage);
+  return std::make_shared<SocketAddress>(
+      reinterpret_cast<const sockaddr*>(&storage));
+}
+
+// 1000 /24 subnets, 1000 single addresses and 100 ranges.
+void FillBlockList(SocketAddressBlockList* list) {
+  for (int i = 0; i < 1000; i++) {
+    std::string subnet = "10." + std::to_string(i / 256) + "." +
+                         std::to_string(i % 256) + ".0";
+    list->AddSocketAddressMask(MakeAddress(AF_INET, subnet), 24);
+    std::string address = "172.16." + std::to_string(i / 256) + "." +
+                          std::to_string(i % 256);
+    list->AddSocketAddress(MakeAddress(AF_INET, address));
+  }
+  for (int i = 0; i < 100; i++) {
+    std::string prefix = "192.168." + std::to_string(i) + ".";
+    list->AddSocketAddressRange(MakeAddress(AF_INET, prefix + "10"),
+                                MakeAddress(AF_INET, prefix + "20"));
+  }
+}
+
+}  // namespace
+
+MICROBENCH(BlockList_Apply_Hit) {
+  SocketAddressBlockList list;
+  FillBlockList(&list);
+  auto address = MakeAddress(AF_INET, "10.3.200.77");
+  while (state.KeepRunning()) DoNotOptimize(list.Apply(address));
+}
+
+MICROBENCH(BlockList_Apply_Miss) {
+  SocketAddressBlockList list;
+  FillBlockList(&list);
+  auto address = MakeAddress(AF_INET, "8.8.8.8");
+  while (state.KeepRunning()) DoNotOptimize(list.Apply(address));
+}
+
+MICROBENCH(BlockList_Apply_IPv6Miss) {
+  SocketAddressBlockList list;
+  FillBlockList(&list);
+  auto address = MakeAddress(AF_INET6, "2001:db8::1");
+  while (state.KeepRunning()) DoNotOptimize(list.Apply(address));
+}
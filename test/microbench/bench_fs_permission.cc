@@ -0,0 +1,39 @@
+#include "microbench.h"
+#include "permission/fs_permission.h"
+
+#include <string>
+
+using node::microbench::DoNotOptimize;
+using RadixTree = node::permission::FSPermission::RadixTree;
+
+namespace {
+
+void FillTree(RadixTree* tree) {
+  for (int i = 0; i < 200; i++) {
+    tree->Insert("/srv/app/releases/" + std::to_string(i) + "/node_modules");
+    tree->Insert("/var/lib/app/tenant-" + std::to_string(i) + "/*");
+  }
+}
+
+}  // namespace
+
+MICROBENCH(FSPermission_Lookup_Granted) {
+  RadixTree tree;
+  FillTree(&tree);
+  std::string path = "/srv/app/releases/123/node_modules/pkg/index.js";
+  while (state.KeepRunning()) DoNotOptimize(tree.Lookup(path));
+}
+
+MICROBENCH(FSPermission_Lookup_Wildcard) {
+  RadixTree tree;
+  FillTree(&tree);
+  std::string path = "/var/lib/app/tenant-77/uploads/2024/file.bin";
+  while (state.KeepRunning()) DoNotOptimize(tree.Lookup(path));
+}
+
+MICROBENCH(FSPermission_Lookup_Denied) {
+  RadixTree tree;
+  FillTree(&tree);
+  std::string path = "/etc/passwd";
+  while (state.KeepRunning()) DoNotOptimize(tree.Lookup(path));
+}
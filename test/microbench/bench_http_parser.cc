@@ -0,0 +1,70 @@
+#include "llhttp.h"
+#include "microbench.h"
+
+#include <cstring>
+#include <string>
+
+using node::microbench::DoNotOptimize;
+
+namespace {
+
+const char kRequest[] =
+    "GET /api/v1/users/12345?fields=name,email HTTP/1.1\r\n"
+    "Host: example.com\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64) Gecko/20100101\r\n"
+    "Accept: application/json\r\n"
+    "Accept-Encoding: gzip, deflate, br\r\n"
+    "Cookie: session=0123456789abcdef; theme=dark\r\n"
+    "Connection: keep-alive\r\n"
+    "\r\n";
+
+int CountHeaderField(llhttp_t* parser, const char*, size_t) {
+  (*static_cast<size_t*>(parser->data))++;
+  return 0;
+}
+
+int CountBody(llhttp_t* parser, const char*, size_t length) {
+  *static_cast<size_t*>(parser->data) += length;
+  return 0;
+}
+
+}  // namespace
+
+// Parses keep-alive requests on one connection, with the callbacks that
+// node_http_parser needs to collect the header fields.
+MICROBENCH(HttpParser_Request) {
+  llhttp_settings_t settings;
+  llhttp_settings_init(&settings);
+  settings.on_header_field = CountHeaderField;
+  llhttp_t parser;
+  llhttp_init(&parser, HTTP_REQUEST, &settings);
+  size_t fields = 0;
+  parser.data = &fields;
+  const size_t length = strlen(kRequest);
+  while (state.KeepRunning()) {
+    llhttp_errno_t err = llhttp_execute(&parser, kRequest, length);
+    DoNotOptimize(err);
+  }
+  DoNotOptimize(fields);
+  state.SetBytesProcessed(state.iterations() * length);
+}
+
+MICROBENCH(HttpParser_ChunkedBody) {
+  std::string response = "HTTP/1.1 200 OK\r\n"
+                         "Transfer-Encoding: chunked\r\n\r\n";
+  for (int i = 0; i < 64; i++)
+    response += "400\r\n" + std::string(1024, 'x') + "\r\n";
+  response += "0\r\n\r\n";
+  llhttp_settings_t settings;
+  llhttp_settings_init(&settings);
+  settings.on_body = CountBody;
+  llhttp_t parser;
+  size_t body_bytes = 0;
+  while (state.KeepRunning()) {
+    llhttp_init(&parser, HTTP_RESPONSE, &settings);
+    parser.data = &body_bytes;
+    DoNotOptimize(llhttp_execute(&parser, response.data(), response.size()));
+  }
+  DoNotOptimize(body_bytes);
+  state.SetBytesProcessed(state.iterations() * response.size());
+}
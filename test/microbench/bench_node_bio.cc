@@ -0,0 +1,25 @@
+#if HAVE_OPENSSL
+
+#include "crypto/crypto_bio.h"
+#include "microbench.h"
+
+#include <vector>
+
+using node::crypto::NodeBIO;
+using node::microbench::DoNotOptimize;
+
+// Moves TLS-record-sized chunks through a NodeBIO, as TLSWrap does for the
+// encrypted side of a connection.
+MICROBENCH(NodeBIO_WriteRead_16K) {
+  ncrypto::BIOPointer bio = NodeBIO::New();
+  NodeBIO* node_bio = NodeBIO::FromBIO(bio.get());
+  std::vector<char> chunk(16 * 1024 + 5, 'x');
+  std::vector<char> out(chunk.size());
+  while (state.KeepRunning()) {
+    node_bio->Write(chunk.data(), chunk.size());
+    DoNotOptimize(node_bio->Read(out.data(), out.size()));
+  }
+  state.SetBytesProcessed(state.iterations() * chunk.size());
+}
+
+#endif  // HAVE_OPENSSL
@@ -0,0 +1,69 @@
+#include "microbench.h"
+#include "nbytes.h"
+#include "simdutf.h"
+#include "string_search.h"
+
+#include <string>
+#include <vector>
+
+using node::microbench::DoNotOptimize;
+
+namespace {
+
+std::string MakeInput(size_t length) {
+  std::string input(length, '\0');
+  uint32_t seed = 1;
+  for (char& c : input) {
+    seed = seed * 1103515245 + 12345;
+    c = static_cast<char>(seed >> 16);
+  }
+  return input;
+}
+
+}  // namespace
+
+// The primitives behind StringBytes::Encode() and StringBytes::Write().
+MICROBENCH(StringBytes_HexEncode_64K) {
+  std::string input = MakeInput(64 * 1024);
+  std::vector<char> output(input.size() * 2);
+  while (state.KeepRunning()) {
+    DoNotOptimize(nbytes::HexEncode(
+        input.data(), input.size(), output.data(), output.size()));
+  }
+  state.SetBytesProcessed(state.iterations() * input.size());
+}
+
+MICROBENCH(StringBytes_Base64Encode_64K) {
+  std::string input = MakeInput(64 * 1024);
+  std::vector<char> output(simdutf::base64_length_from_binary(input.size()));
+  while (state.KeepRunning()) {
+    DoNotOptimize(
+        simdutf::binary_to_base64(input.data(), input.size(), output.data()));
+  }
+  state.SetBytesProcessed(state.iterations() * input.size());
+}
+
+MICROBENCH(StringBytes_Base64Decode_64K) {
+  std::string input = MakeInput(64 * 1024);
+  std::vector<char> encoded(simdutf::base64_length_from_binary(input.size()));
+  simdutf::binary_to_base64(input.data(), input.size(), encoded.data());
+  std::vector<char> output(input.size());
+  while (state.KeepRunning()) {
+    size_t length = output.size();
+    DoNotOptimize(simdutf::base64_to_binary_safe(
+        encoded.data(), encoded.size(), output.data(), length));
+  }
+  state.SetBytesProcessed(state.iterations() * encoded.size());
+}
+
+MICROBENCH(StringSearch_OneByte_64K) {
+  std::string haystack(64 * 1024, 'a');
+  haystack.replace(haystack.size() - 16, 6, "needle");
+  const uint8_t* data = reinterpret_cast<const uint8_t*>(haystack.data());
+  while (state.KeepRunning()) {
+    DoNotOptimize(node::string_search::SearchString(
+        data, haystack.size(), reinterpret_cast<const uint8_t*>("needle"), 6,
+        0, true));
+  }
+  state.SetBytesProcessed(state.iterations() * haystack.size());
+}
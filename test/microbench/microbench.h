@@ -0,0 +1,96 @@
+#ifndef TEST_MICROBENCH_MICROBENCH_H_
+#define TEST_MICROBENCH_MICROBENCH_H_
+
+// A minimal harness for microbenchmarks of native internals. Benchmarks are
+// registered with MICROBENCH() and run by node_microbench, which picks the
+// number of iterations so that each benchmark runs for a fixed minimum time
+// and reports the time per iteration.
+//
+//   MICROBENCH(StringSearch_Short) {
+//     std::string haystack = ...;  // Setup is not timed.
+//     while (state.KeepRunning()) {
+//       DoNotOptimize(Search(haystack, "needle"));
+//     }
+//     state.SetBytesProcessed(state.iterations() * haystack.size());
+//   }
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "uv.h"
+
+namespace node {
+namespace microbench {
+
+class State {
+ public:
+  explicit State(uint64_t iterations)
+      : remaining_(iterations), iterations_(iterations) {}
+
+  // Returns true until the requested number of iterations has run. The clock
+  // starts on the first call, so setup before the loop is not measured.
+  inline bool KeepRunning() {
+    if (start_ns_ == 0) start_ns_ = uv_hrtime();
+    if (remaining_ > 0) {
+      remaining_--;
+      return true;
+    }
+    if (end_ns_ == 0) end_ns_ = uv_hrtime();
+    return false;
+  }
+
+  uint64_t iterations() const { return iterations_; }
+  uint64_t elapsed_ns() const { return end_ns_ - start_ns_; }
+
+  // Optional throughput information, reported as MB/s.
+  void SetBytesProcessed(uint64_t bytes) { bytes_processed_ = bytes; }
+  uint64_t bytes_processed() const { return bytes_processed_; }
+
+ private:
+  uint64_t remaining_;
+  const uint64_t iterations_;
+  uint64_t start_ns_ = 0;
+  uint64_t end_ns_ = 0;
+  uint64_t bytes_processed_ = 0;
+};
+
+using BenchmarkFunction = void (*)(State& state);  // NOLINT(runtime/references)
+
+struct Benchmark {
+  const char* name;
+  BenchmarkFunction fn;
+};
+
+std::vector<Benchmark>* Registry();
+
+struct Registrar {
+  Registrar(const char* name, BenchmarkFunction fn) {
+    Registry()->push_back({name, fn});
+  }
+};
+
+// Keeps the compiler from optimizing away the computation of `value`.
+template <typename T>
+inline void DoNotOptimize(const T& value) {
+#if defined(__GNUC__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  const volatile void* volatile sink = &value;
+  (void)sink;
+#endif
+}
+
+}  // namespace microbench
+}  // namespace node
+
+#define MICROBENCH(name)                                                       \
+  static void MicroBench_##name(                                               \
+      node::microbench::State& state); /* NOLINT(runtime/references) */        \
+  static node::microbench::Registrar microbench_registrar_##name(              \
+      #name, MicroBench_##name);                                               \
+  static void MicroBench_##name(                                               \
+      node::microbench::State& state) /* NOLINT(runtime/references) */
+
+#endif  // TEST_MICROBENCH_MICROBENCH_H_
@@ -0,0 +1,121 @@
+#include "microbench.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace node {
+namespace microbench {
+
+std::vector<Benchmark>* Registry() {
+  static std::vector<Benchmark> registry;
+  return &registry;
+}
+
+namespace {
+
+struct Result {
+  uint64_t iterations;
+  double ns_per_iteration;
+  double mb_per_second;
+};
+
+Result Run(const Benchmark& benchmark, uint64_t min_time_ns) {
+  uint64_t iterations = 1;
+  for (;;) {
+    State state(iterations);
+    benchmark.fn(state);
+    uint64_t elapsed = std::max<uint64_t>(state.elapsed_ns(), 1);
+    if (elapsed >= min_time_ns || iterations >= (uint64_t{1} << 40)) {
+      Result result;
+      result.iterations = iterations;
+      result.ns_per_iteration = static_cast<double>(elapsed) / iterations;
+      result.mb_per_second =
+          state.bytes_processed() == 0
+              ? 0
+              : state.bytes_processed() / (elapsed / 1e9) / (1024 * 1024);
+      return result;
+    }
+    // Aim a little past the minimum time, but grow by at most 10x per step
+    // so that a noisy first run does not overshoot by much.
+    double scale = 1.4 * min_time_ns / elapsed;
+    uint64_t next = static_cast<uint64_t>(iterations * std::min(scale, 10.0));
+    iterations = std::max(next, iterations + 1);
+  }
+}
+
+void PrintUsage(const char* argv0) {
+  fprintf(stderr,
+          "Usage: %s [--filter=<substring>] [--min-time=<ms>] [--json] "
+          "[--list]\n",
+          argv0);
+}
+
+}  // namespace
+}  // namespace microbench
+}  // namespace node
+
+int main(int argc, char** argv) {
+  using node::microbench::Benchmark;
+  using node::microbench::Registry;
+  using node::microbench::Result;
+
+  const char* filter = "";
+  uint64_t min_time_ms = 500;
+  bool json = false;
+  bool list = false;
+  for (int i = 1; i < argc; i++) {
+    if (strncmp(argv[i], "--filter=", 9) == 0) {
+      filter = argv[i] + 9;
+    } else if (strncmp(argv[i], "--min-time=", 11) == 0) {
+      min_time_ms = strtoull(argv[i] + 11, nullptr, 10);
+    } else if (strcmp(argv[i], "--json") == 0) {
+      json = true;
+    } else if (strcmp(argv[i], "--list") == 0) {
+      list = true;
+    } else {
+      node::microbench::PrintUsage(argv[0]);
+      return 1;
+    }
+  }
+
+  std::vector<Benchmark> benchmarks = *Registry();
+  std::sort(benchmarks.begin(),
+            benchmarks.end(),
+            [](const Benchmark& a, const Benchmark& b) {
+              return strcmp(a.name, b.name) < 0;
+            });
+
+  if (!json && !list) {
+    printf("%-40s %14s %14s %12s\n", "benchmark", "iterations", "ns/iter",
+           "MB/s");
+  }
+  for (const Benchmark& benchmark : benchmarks) {
+    if (strstr(benchmark.name, filter) == nullptr) continue;
+    if (list) {
+      printf("%s\n", benchmark.name);
+      continue;
+    }
+    Result result =
+        node::microbench::Run(benchmark, min_time_ms * 1000 * 1000);
+    if (json) {
+      // One object per line, so that runs can be diffed and compared.
+      printf("{\"name\":\"%s\",\"iterations\":%" PRIu64
+             ",\"ns_per_iteration\":%.3f,\"mb_per_second\":%.3f}\n",
+             benchmark.name,
+             result.iterations,
+             result.ns_per_iteration,
+             result.mb_per_second);
+    } else if (result.mb_per_second > 0) {
+      printf("%-40s %14" PRIu64 " %14.2f %12.1f\n", benchmark.name,
+             result.iterations, result.ns_per_iteration, result.mb_per_second);
+    } else {
+      printf("%-40s %14" PRIu64 " %14.2f %12s\n", benchmark.name,
+             result.iterations, result.ns_per_iteration, "-");
+    }
+    fflush(stdout);
+  }
+  return 0;
+}
@@ -0,0 +1,8 @@
+{
+  "targets": [
+    {
+      "target_name": "test_async_work_batch",
+      "sources": [ "test_async_work_batch.c" ]
+    }
+  ]
+}
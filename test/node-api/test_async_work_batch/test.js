@@ -0,0 +1,19 @@
+'use strict';
+const common = require('../../common');
+const assert = require('assert');
+const binding = require(`./build/${common.buildType}/test_async_work_batch`);
+
+// Every work is completed exactly once, possibly several per callback.
+const count = 32;
+const outputs = [];
+binding.Test(count, common.mustCallAtLeast((batch) => {
+  assert.ok(batch.length > 0);
+  outputs.push(...batch);
+  if (outputs.length === count) {
+    outputs.sort((a, b) => a - b);
+    assert.deepStrictEqual(outputs,
+                           Array.from({ length: count }, (_, i) => i * 2));
+  }
+}, 1));
+
+process.on('exit', () => assert.strictEqual(outputs.length, count));
@@ -0,0 +1,100 @@
+#define NAPI_EXPERIMENTAL
+#include <node_api.h>
+#include "../../js-native-api/common.h"
+
+#define MAX_WORKS 64
+
+typedef struct {
+  int32_t input;
+  int32_t output;
+  napi_async_work work;
+} job;
+
+static job jobs[MAX_WORKS];
+static napi_ref callback_ref;
+static size_t pending;
+
+static void Execute(napi_env env, void* data) {
+  job* j = (job*)data;
+  j->output = j->input * 2;
+}
+
+// Calls the JS callback once per batch with the outputs of its works.
+static void CompleteBatch(napi_env env,
+                          const napi_status* status,
+                          void** data,
+                          size_t count) {
+  napi_value outputs;
+  NODE_API_CALL_RETURN_VOID(env, napi_create_array(env, &outputs));
+  for (size_t i = 0; i < count; i++) {
+    job* j = (job*)data[i];
+    NODE_API_ASSERT_RETURN_VOID(env, status[i] == napi_ok, "Work failed.");
+    napi_value output;
+    NODE_API_CALL_RETURN_VOID(env, napi_create_int32(env, j->output, &output));
+    NODE_API_CALL_RETURN_VOID(
+        env, napi_set_element(env, outputs, (uint32_t)i, output));
+    NODE_API_CALL_RETURN_VOID(env, napi_delete_async_work(env, j->work));
+  }
+  pending -= count;
+
+  napi_value callback, global, result;
+  NODE_API_CALL_RETURN_VOID(
+      env, napi_get_reference_value(env, callback_ref, &callback));
+  NODE_API_CALL_RETURN_VOID(env, napi_get_global(env, &global));
+  NODE_API_CALL_RETURN_VOID(
+      env, napi_call_function(env, global, callback, 1, &outputs, &result));
+  if (pending == 0) {
+    NODE_API_CALL_RETURN_VOID(env, napi_delete_reference(env, callback_ref));
+  }
+}
+
+// Test(count, callback) queues `count` works with alternating priorities.
+static napi_value Test(napi_env env, napi_callback_info info) {
+  size_t argc = 2;
+  napi_value argv[2];
+  NODE_API_CALL(env, napi_get_cb_info(env, info, &argc, argv, NULL, NULL));
+  NODE_API_ASSERT(env, argc == 2, "Expected two arguments.");
+
+  uint32_t count;
+  NODE_API_CALL(env, napi_get_value_uint32(env, argv[0], &count));
+  NODE_API_ASSERT(env, count <= MAX_WORKS, "Too many works.");
+  NODE_API_CALL(env, napi_create_reference(env, argv[1], 1, &callback_ref));
+
+  napi_value resource_name;
+  NODE_API_CALL(env,
+                napi_create_string_utf8(
+                    env, "TestBatch", NAPI_AUTO_LENGTH, &resource_name));
+
+  static const node_api_async_work_priority priorities[] = {
+      node_api_async_work_priority_default,
+      node_api_async_work_priority_high,
+      node_api_async_work_priority_low,
+  };
+  pending = count;
+  for (uint32_t i = 0; i < count; i++) {
+    jobs[i].input = (int32_t)i;
+    NODE_API_CALL(env,
+                  node_api_create_async_work_batched(env,
+                                                     NULL,
+                                                     resource_name,
+                                                     Execute,
+                                                     CompleteBatch,
+                                                     &jobs[i],
+                                                     &jobs[i].work));
+    NODE_API_CALL(env,
+                  node_api_queue_async_work_with_priority(
+                      env, jobs[i].work, priorities[i % 3]));
+  }
+  return NULL;
+}
+
+NAPI_MODULE_INIT() {
+  napi_property_descriptor properties[] = {
+      DECLARE_NODE_API_PROPERTY("Test", Test),
+  };
+  NODE_API_CALL(
+      env,
+      napi_define_properties(
+          env, exports, sizeof(properties) / sizeof(*properties), properties));
+  return exports;
+}
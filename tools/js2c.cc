@@ -13,6 +13,9 @@
 #include "executable_wrapper.h"
 #include "simdutf.h"
 #include "uv.h"
+#ifdef NODE_JS2C_COMPRESS
+#include "zstd.h"
+#endif
 
 #if defined(_WIN32)
 #include <io.h>  // _S_IREAD _S_IWRITE
@@ -446,6 +449,81 @@ enum class CodeType {
   kLatin1,  // Code points are all within 0-255
   kTwoByte,
 };
+
+#ifdef NODE_JS2C_COMPRESS
+// If NODE_JS2C_COMPRESS is defined (i.e. node_compress_builtins is set), the
+// Latin-1 or UTF16 data is compressed with zstd and only decompressed by the
+// binary when V8 reads the source for the first time:
+// static const uint8_t fs_raw[] = {
+//  ....
+// };
+//
+// static StaticCompressedOneByteResource fs_resource(fs_raw, 567, 1234);
+template <typename T>
+Fragment GetCompressedDefinition(const std::vector<char>& code,
+                                 const std::string& var) {
+  constexpr bool is_two_byte = std::is_same_v<T, uint16_t>;
+  constexpr const char* resource_type = is_two_byte
+                                            ? "StaticCompressedTwoByteResource"
+                                            : "StaticCompressedOneByteResource";
+
+  const void* data = code.data();
+  size_t count = code.size();
+  size_t byte_length = code.size();
+  std::vector<uint16_t> utf16_codepoints;
+  if constexpr (is_two_byte) {
+    utf16_codepoints.resize(
+        simdutf::utf16_length_from_utf8(code.data(), code.size()));
+    count = simdutf::convert_utf8_to_utf16(
+        code.data(),
+        code.size(),
+        reinterpret_cast<char16_t*>(utf16_codepoints.data()));
+    assert(count != 0);
+    data = utf16_codepoints.data();
+    byte_length = count * sizeof(uint16_t);
+  }
+
+  std::vector<uint8_t> compressed(ZSTD_compressBound(byte_length));
+  size_t compressed_size = ZSTD_compress(compressed.data(),
+                                         compressed.size(),
+                                         data,
+                                         byte_length,
+                                         ZSTD_maxCLevel());
+  if (ZSTD_isError(compressed_size)) {
+    fprintf(stderr,
+            "Cannot compress %s: %s\n",
+            var.c_str(),
+            ZSTD_getErrorName(compressed_size));
+    abort();
+  }
+  Debug("Compressed %zu bytes to %zu bytes\n", byte_length, compressed_size);
+
+  // 0-255 and a ",".
+  constexpr size_t unit = 4;
+  size_t def_size = 512 + compressed_size * unit;
+  Fragment result(def_size, 0);
+  int cur = snprintf(result.data(),
+                     def_size,
+                     "static const uint8_t %s_raw[] = {\n",
+                     var.c_str());
+  for (size_t i = 0; i < compressed_size; ++i) {
+    std::string_view str = GetCode(compressed[i]);
+    memcpy(result.data() + cur, str.data(), str.size());
+    cur += str.size();
+  }
+  cur += snprintf(result.data() + cur,
+                  result.size() - cur,
+                  "\n};\n\nstatic %s %s_resource(%s_raw, %zu, %zu);\n",
+                  resource_type,
+                  var.c_str(),
+                  var.c_str(),
+                  compressed_size,
+                  count);
+  result.resize(cur);
+  return result;
+}
+#endif  // NODE_JS2C_COMPRESS
+
 template <typename T>
 Fragment GetDefinitionImpl(const std::vector<char>& code,
                            const std::string& var,
@@ -453,6 +531,10 @@ Fragment GetDefinitionImpl(const std::vector<char>& code,
   constexpr bool is_two_byte = std::is_same_v<T, uint16_t>;
   static_assert(is_two_byte || std::is_same_v<T, char>);
 
+#ifdef NODE_JS2C_COMPRESS
+  return GetCompressedDefinition<T>(code, var);
+#endif
+
   size_t count = is_two_byte
                      ? simdutf::utf16_length_from_utf8(code.data(), code.size())
                      : code.size();